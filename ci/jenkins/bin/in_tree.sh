@@ -27,7 +27,8 @@ autoreconf -fi
     --enable-werror \
     --enable-experimental-plugins \
     --enable-example-plugins \
-    --enable-wccp
+    --enable-wccp \
+    --enable-coroutines
 
 ${ATS_MAKE} -j5 V=1
 #${ATS_MAKE} check VERBOSE=Y
@@ -62,6 +62,13 @@ public:
     produce(data);
   }
 
+  // Pass the blocks on as they are, rather than copying them to consume() and to the output.
+  void
+  consumeBlocks(TSIOBufferReader reader) override
+  {
+    produce(reader, INT64_MAX);
+  }
+
   void
   handleInputComplete() override
   {
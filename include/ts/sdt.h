@@ -30,11 +30,15 @@
 #define ATS_PROBE(probe) DTRACE_PROBE(trafficserver, probe)
 #define ATS_PROBE1(probe, param1) DTRACE_PROBE1(trafficserver, probe, param1)
 #define ATS_PROBE2(probe, param1, param2) DTRACE_PROBE2(trafficserver, probe, param1, param2)
+#define ATS_PROBE3(probe, param1, param2, param3) DTRACE_PROBE3(trafficserver, probe, param1, param2, param3)
+#define ATS_PROBE4(probe, param1, param2, param3, param4) DTRACE_PROBE4(trafficserver, probe, param1, param2, param3, param4)
 
 #else
 
 #define ATS_PROBE(...)
 #define ATS_PROBE1(...)
 #define ATS_PROBE2(...)
+#define ATS_PROBE3(...)
+#define ATS_PROBE4(...)
 
 #endif
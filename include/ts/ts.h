@@ -1227,6 +1227,14 @@ tsapi TSReturnCode TSMgmtSourceGet(const char *var_name, TSMgmtSource *source);
 tsapi TSReturnCode TSMgmtConfigFileAdd(const char *parent, const char *fileName);
 tsapi TSReturnCode TSMgmtDataTypeGet(const char *var_name, TSRecordDataType *result);
 
+/* Records looked up once by name, for reads on hot paths */
+tsapi TSReturnCode TSMgmtRecordFind(const char *var_name, TSMgmtRecord *record);
+tsapi TSReturnCode TSMgmtRecordIntGet(TSMgmtRecord record, TSMgmtInt *result);
+tsapi TSReturnCode TSMgmtRecordCounterGet(TSMgmtRecord record, TSMgmtCounter *result);
+tsapi TSReturnCode TSMgmtRecordFloatGet(TSMgmtRecord record, TSMgmtFloat *result);
+tsapi TSReturnCode TSMgmtRecordStringGet(TSMgmtRecord record, TSMgmtString *result);
+tsapi unsigned int TSMgmtRecordGenerationGet(TSMgmtRecord record);
+
 /* --------------------------------------------------------------------------
    Continuations */
 tsapi TSCont TSContCreate(TSEventFunc funcp, TSMutex mutexp);
@@ -1240,6 +1248,7 @@ tsapi TSAction TSContScheduleEveryOnThread(TSCont contp, TSHRTime every /* milli
 tsapi TSReturnCode TSContThreadAffinitySet(TSCont contp, TSEventThread ethread);
 tsapi TSEventThread TSContThreadAffinityGet(TSCont contp);
 tsapi void TSContThreadAffinityClear(TSCont contp);
+tsapi void TSContThreadAgnosticSet(TSCont contp, bool agnostic);
 tsapi TSAction TSHttpSchedule(TSCont contp, TSHttpTxn txnp, TSHRTime timeout);
 tsapi int TSContCall(TSCont contp, TSEvent event, void *edata);
 tsapi TSMutex TSContMutexGet(TSCont contp);
@@ -1250,6 +1259,8 @@ tsapi void TSLifecycleHookAdd(TSLifecycleHookID id, TSCont contp);
 /* --------------------------------------------------------------------------
    HTTP hooks */
 tsapi void TSHttpHookAdd(TSHttpHookID id, TSCont contp);
+/* A global hook called in place, without locking or reenabling: TS_ERROR for hooks it cannot be on. */
+tsapi TSReturnCode TSHttpFastHookAdd(TSHttpHookID id, TSHttpFastHookFunc funcp, void *data);
 
 /* --------------------------------------------------------------------------
    HTTP sessions */
@@ -1303,6 +1314,11 @@ tsapi int TSVConnIsSsl(TSVConn sslp);
 /* Returns 1 if a certificate was provided in the TLS handshake, 0 otherwise.
  */
 tsapi int TSVConnProvidedSslCert(TSVConn sslp);
+/* Copies the last sample of the struct tcp_info of the connection into info, at most *lenp bytes
+   of it, and sets *lenp to the number copied. Fails if there is no sample, e.g. the platform has
+   no TCP_INFO. Only the thread of the connection may call this.
+ */
+tsapi TSReturnCode TSVConnTcpInfoGet(TSVConn vconnp, void *info, int *lenp);
 
 tsapi TSSslSession TSSslSessionGet(const TSSslSessionID *session_id);
 tsapi int TSSslSessionGetBuffer(const TSSslSessionID *session_id, char *buffer, int *len_ptr);
@@ -2049,6 +2065,31 @@ tsapi int64_t TSIOBufferWaterMarkGet(TSIOBuffer bufp);
 tsapi void TSIOBufferWaterMarkSet(TSIOBuffer bufp, int64_t water_mark);
 
 tsapi void TSIOBufferDestroy(TSIOBuffer bufp);
+
+/**
+    Creates an account for the memory of TSIOBuffers used by a plugin.
+    A buffer charges its account for the data blocks it allocates until
+    the blocks are freed, which can be after the buffer is destroyed.
+
+    @param name identifies the account, it must stay valid as long as the
+      account is in use.
+    @return new TSIOBufferAccount.
+
+ */
+tsapi TSIOBufferAccount TSIOBufferAccountCreate(const char *name);
+tsapi void TSIOBufferAccountDestroy(TSIOBufferAccount account);
+/**
+    Charges the data blocks that @a bufp allocates from now on to
+    @a account, or stops charging them if @a account is null.
+
+ */
+tsapi void TSIOBufferAccountSet(TSIOBuffer bufp, TSIOBufferAccount account);
+/**
+    Gets the number of bytes of buffer memory currently charged to
+    @a account.
+
+ */
+tsapi int64_t TSIOBufferAccountBytesGet(TSIOBufferAccount account);
 tsapi TSIOBufferBlock TSIOBufferStart(TSIOBuffer bufp);
 tsapi int64_t TSIOBufferCopy(TSIOBuffer bufp, TSIOBufferReader readerp, int64_t length, int64_t offset);
 
@@ -2125,6 +2166,16 @@ tsapi void TSStatIntSet(int the_stat, TSMgmtInt value);
 
 tsapi TSReturnCode TSStatFindName(const char *name, int *idp);
 
+/* Histograms of integer values, in log-linear buckets. A histogram is exposed as the records
+   <name>.count, <name>.sum, <name>.p50, <name>.p90, <name>.p99 and <name>.p999. */
+tsapi int TSStatHistogramCreate(const char *the_name);
+tsapi void TSStatHistogramRecord(int the_histogram, TSMgmtInt value);
+tsapi TSReturnCode TSStatHistogramFindName(const char *name, int *idp);
+/* Copy the counts of up to nbuckets buckets, as of the last sync. Returns the number of buckets copied. */
+tsapi int TSStatHistogramBucketsGet(int the_histogram, TSMgmtInt *counts, int nbuckets);
+tsapi int TSStatHistogramBucketCount(void);
+tsapi TSMgmtInt TSStatHistogramBucketLowerBound(int bucket);
+
 /* --------------------------------------------------------------------------
    tracing api */
 
@@ -2471,6 +2522,8 @@ tsapi TSReturnCode TSHttpTxnCachedRespModifiableGet(TSHttpTxn txnp, TSMBuffer *b
 tsapi TSReturnCode TSHttpTxnCacheLookupStatusSet(TSHttpTxn txnp, int cachelookup);
 tsapi TSReturnCode TSHttpTxnCacheLookupUrlGet(TSHttpTxn txnp, TSMBuffer bufp, TSMLoc obj);
 tsapi TSReturnCode TSHttpTxnCacheLookupUrlSet(TSHttpTxn txnp, TSMBuffer bufp, TSMLoc obj);
+/* Probe the cache directory for the lookup URL obj, with the cache generation of the txn, without opening a read */
+tsapi TSReturnCode TSHttpTxnCacheLookupUrlProbe(TSHttpTxn txnp, TSMBuffer bufp, TSMLoc obj, int *maybe_cached);
 tsapi TSReturnCode TSHttpTxnPrivateSessionSet(TSHttpTxn txnp, int private_session);
 tsapi int TSHttpTxnBackgroundFillStarted(TSHttpTxn txnp);
 tsapi int TSHttpTxnIsWebsocket(TSHttpTxn txnp);
@@ -2478,6 +2531,9 @@ tsapi int TSHttpTxnIsWebsocket(TSHttpTxn txnp);
 /* Get the Txn's (HttpSM's) unique identifier, which is a sequence number since server start) */
 tsapi uint64_t TSHttpTxnIdGet(TSHttpTxn txnp);
 
+/* Allocate size bytes, aligned to 16, that are freed when the transaction ends */
+tsapi void *TSHttpTxnArenaAlloc(TSHttpTxn txnp, size_t size);
+
 /* Get the Ssn's unique identifier */
 tsapi int64_t TSHttpSsnIdGet(TSHttpSsn ssnp);
 
@@ -2501,6 +2557,18 @@ tsapi TSReturnCode TSBase64Encode(const char *str, size_t str_len, char *dst, si
 */
 tsapi TSReturnCode TSHttpTxnMilestoneGet(TSHttpTxn txnp, TSMilestonesType milestone, TSHRTime *time);
 
+/**
+   Return the thread CPU time spent in the handlers of the transaction so far, in nanoseconds.
+   It is only measured with proxy.config.http.transaction_cpu_time enabled.
+
+   @param txnp the transaction pointer
+   @param time a pointer to a TSHRTime where we will store the CPU time
+
+   @return @c TS_SUCCESS if the CPU time of the transaction is measured, TS_ERROR otherwise
+
+*/
+tsapi TSReturnCode TSHttpTxnCpuTimeGet(TSHttpTxn txnp, TSHRTime *time);
+
 /**
   Test whether a request / response header pair would be cacheable under the current
   configuration. This would typically be used in TS_HTTP_READ_RESPONSE_HDR_HOOK, when
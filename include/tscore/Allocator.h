@@ -39,10 +39,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdio>
+#include <mutex>
 #include <new>
 #include <cstdlib>
 #include "tscore/ink_queue.h"
 #include "tscore/ink_defs.h"
+#include "tscore/ink_memory.h"
 #include "tscore/ink_resource.h"
 #include <execinfo.h>
 
@@ -59,7 +63,7 @@ public:
   void *
   alloc_void()
   {
-    return ink_freelist_new(this->fl);
+    return ink_freelist_new(this->node_freelist());
   }
 
   /**
@@ -70,7 +74,7 @@ public:
   void
   free_void(void *ptr)
   {
-    ink_freelist_free(this->fl, ptr);
+    ink_freelist_free(this->node_freelist(), ptr);
   }
 
   /**
@@ -83,7 +87,7 @@ public:
   void
   free_void_bulk(void *head, void *tail, size_t num_item)
   {
-    ink_freelist_free_bulk(this->fl, head, tail, num_item);
+    ink_freelist_free_bulk(this->node_freelist(), head, tail, num_item);
   }
 
   Allocator() { fl = nullptr; }
@@ -108,8 +112,47 @@ public:
     ink_freelist_madvise_init(&this->fl, name, element_size, chunk_size, alignment, advice);
   }
 
+  /** Allocate the memory of the allocator from @a arena, nullptr for the default. Before it allocates anything. */
+  void
+  set_arena(jearena::Arena *arena)
+  {
+    fl->arena = arena;
+  }
+
 protected:
+  /** The freelist for the NUMA node of the calling thread.
+      Items are returned to the list of the node of the thread that frees them, which for the per
+      thread caching of the proxy allocators is nearly always the node they came from.
+  */
+  InkFreeList *
+  node_freelist()
+  {
+    int node = ink_thread_numa_node;
+    if (likely(node <= 0)) {
+      return fl;
+    }
+    InkFreeList *f = node_fl[node].load(std::memory_order_acquire);
+    return likely(f != nullptr) ? f : this->create_node_freelist(node);
+  }
+
+  InkFreeList *
+  create_node_freelist(int node)
+  {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    InkFreeList *f = node_fl[node].load(std::memory_order_relaxed);
+    if (f == nullptr) {
+      size_t len = strlen(fl->name) + 16;
+      char *name = static_cast<char *>(ats_malloc(len));
+      snprintf(name, len, "%s[node %d]", fl->name, node);
+      f = ink_freelist_clone(fl, name);
+      node_fl[node].store(f, std::memory_order_release);
+    }
+    return f;
+  }
+
   InkFreeList *fl;
+  std::atomic<InkFreeList *> node_fl[INK_FREELIST_MAX_NODES] = {}; ///< Lazily created lists for NUMA nodes other than 0.
 };
 
 /**
@@ -128,7 +171,7 @@ public:
   C *
   alloc()
   {
-    void *ptr = ink_freelist_new(this->fl);
+    void *ptr = ink_freelist_new(this->node_freelist());
 
     memcpy(ptr, (void *)&this->proto.typeObject, sizeof(C));
     return (C *)ptr;
@@ -142,7 +185,7 @@ public:
   void
   free(C *ptr)
   {
-    ink_freelist_free(this->fl, ptr);
+    ink_freelist_free(this->node_freelist(), ptr);
   }
 
   /**
@@ -155,7 +198,7 @@ public:
   void
   free_bulk(C *head, C *tail, size_t num_item)
   {
-    ink_freelist_free_bulk(this->fl, head, tail, num_item);
+    ink_freelist_free_bulk(this->node_freelist(), head, tail, num_item);
   }
 
   /**
@@ -33,7 +33,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdarg>
+#include <cstdint>
 #include "ink_mutex.h"
 #include "Regex.h"
 #include "ink_apidefs.h"
@@ -108,6 +110,18 @@ struct DiagsConfigState {
 //
 //////////////////////////////////////////////////////////////////////////////
 
+/** The activation of the tag of a diagnostic callsite, cached by each thread that reaches it.
+
+    Resolving a tag matches it against the activated tag regexes under the tag table lock. A callsite
+    does that the first time a thread reaches it, when the tags are reconfigured, or when its tag is
+    not the one it resolved, the tag being compared as a pointer.
+*/
+struct DiagsTagCache {
+  const char *tag     = nullptr;
+  uint64_t generation = 0; ///< Of the tag tables the activation was resolved against, 0 for never.
+  bool activated      = false;
+};
+
 class Diags
 {
 public:
@@ -158,6 +172,21 @@ public:
 
   bool tag_activated(const char *tag, DiagsTagType mode = DiagsTagType_Debug) const;
 
+  /// tag_activated(), resolved once for the callsite of @a cache until the tags are reconfigured.
+  bool
+  tag_activated(const char *tag, DiagsTagType mode, DiagsTagCache &cache) const
+  {
+    uint64_t generation = tag_generation.load(std::memory_order_acquire);
+
+    if (likely(cache.tag == tag && cache.generation == generation)) {
+      return cache.activated;
+    }
+    cache.activated  = tag_activated(tag, mode);
+    cache.tag        = tag;
+    cache.generation = generation;
+    return cache.activated;
+  }
+
   /////////////////////////////
   // raw printing interfaces //
   /////////////////////////////
@@ -235,6 +264,9 @@ private:
   mutable ink_mutex tag_table_lock; // prevents reconfig/read races
   DFA *activated_tags[2];           // 1 table for debug, 1 for action
 
+  /// Bumped when the tag tables of any Diags change, for the callsites to resolve their tags again.
+  static std::atomic<uint64_t> tag_generation;
+
   // These are the default logfile permissions
   int diags_logfile_perm  = -1;
   int output_logfile_perm = -1;
@@ -315,32 +347,30 @@ extern inkcoreapi Diags *diags;
 
 #if TS_USE_DIAGS
 
-#define Diag(tag, ...)                                 \
-  do {                                                 \
-    if (unlikely(diags->on())) {                       \
-      const SourceLocation loc = MakeSourceLocation(); \
-      diags->log(tag, DL_Diag, &loc, __VA_ARGS__);     \
-    }                                                  \
+// Each callsite caches the activation of its tag, see DiagsTagCache.
+#define DiagsTagLog(tag, flag, level, ...)                                            \
+  do {                                                                                \
+    if (unlikely(diags->on())) {                                                      \
+      static thread_local DiagsTagCache diags_tag_cache;                              \
+      if ((flag) || diags->tag_activated(tag, DiagsTagType_Debug, diags_tag_cache)) { \
+        const SourceLocation loc = MakeSourceLocation();                              \
+        diags->print(tag, level, &loc, __VA_ARGS__);                                  \
+      }                                                                               \
+    }                                                                                 \
   } while (0)
 
-#define Debug(tag, ...)                                \
-  do {                                                 \
-    if (unlikely(diags->on())) {                       \
-      const SourceLocation loc = MakeSourceLocation(); \
-      diags->log(tag, DL_Debug, &loc, __VA_ARGS__);    \
-    }                                                  \
-  } while (0)
+#define Diag(tag, ...) DiagsTagLog(tag, false, DL_Diag, __VA_ARGS__)
+#define Debug(tag, ...) DiagsTagLog(tag, false, DL_Debug, __VA_ARGS__)
+#define SpecificDebug(flag, tag, ...) DiagsTagLog(tag, flag, DL_Debug, __VA_ARGS__)
 
-#define SpecificDebug(flag, tag, ...)                                                                       \
-  do {                                                                                                      \
-    if (unlikely(diags->on())) {                                                                            \
-      const SourceLocation loc = MakeSourceLocation();                                                      \
-      flag ? diags->print(tag, DL_Debug, &loc, __VA_ARGS__) : diags->log(tag, DL_Debug, &loc, __VA_ARGS__); \
-    }                                                                                                       \
-  } while (0)
+#define DiagsTagSet(_t, _mode)                              \
+  (diags->on(_mode) && [](const char *t) {                  \
+    static thread_local DiagsTagCache diags_tag_cache;      \
+    return diags->tag_activated(t, _mode, diags_tag_cache); \
+  }(_t))
 
-#define is_debug_tag_set(_t) unlikely(diags->on(_t, DiagsTagType_Debug))
-#define is_action_tag_set(_t) unlikely(diags->on(_t, DiagsTagType_Action))
+#define is_debug_tag_set(_t) unlikely(DiagsTagSet(_t, DiagsTagType_Debug))
+#define is_action_tag_set(_t) unlikely(DiagsTagSet(_t, DiagsTagType_Action))
 #define debug_tag_assert(_t, _a) (is_debug_tag_set(_t) ? (ink_release_assert(_a), 0) : 0)
 #define action_tag_assert(_t, _a) (is_action_tag_set(_t) ? (ink_release_assert(_a), 0) : 0)
 #define is_diags_on(_t) unlikely(diags->on(_t))
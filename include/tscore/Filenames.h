@@ -45,6 +45,7 @@ namespace filename
   ///////////////////////////////////////////////////////////////////
   // Various other file names
   constexpr const char *RECORDS_STATS = "records.snap";
+  constexpr const char *STATS_SEGMENT = "stats.segment";
 
 } // namespace filename
 } // namespace ts
@@ -0,0 +1,179 @@
+/** @file
+
+  Log linear histogram for latency values.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Values below 2^S are counted exactly. Above that each power of two is split into 2^S buckets,
+  which keeps the relative error of a reported value below 2^-S, in the manner of an HDR
+  histogram. Values at or above 2^R are counted in the last bucket.
+
+  Recording is a bit scan and an increment, there is no locking. A histogram is meant to be
+  written by a single thread, other threads may read it with the understanding that counts can be
+  slightly behind.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ts
+{
+/** Histogram of unsigned values.
+    @tparam R Range bits, values up to 2^R are distinguished.
+    @tparam S Sub-bucket bits, the precision within each power of two.
+*/
+template <int R, int S> class Histogram
+{
+  static_assert(S > 0 && R > S && R < 64, "Histogram value range must be larger than its precision");
+
+public:
+  static constexpr int N_SUB_BUCKETS = 1 << S;
+  static constexpr int N_GROUPS      = R - S + 1;
+  static constexpr int N_BUCKETS     = N_GROUPS * N_SUB_BUCKETS;
+  static constexpr uint64_t MAX      = (uint64_t(1) << R) - 1; ///< Largest distinguished value.
+
+  /// Count one instance of @a v.
+  void
+  record(uint64_t v)
+  {
+    ++_bucket[index(v)];
+  }
+
+  /// Bucket index for @a v.
+  static int
+  index(uint64_t v)
+  {
+    if (v < N_SUB_BUCKETS) {
+      return static_cast<int>(v);
+    }
+    if (v > MAX) {
+      return N_BUCKETS - 1;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int g   = msb - S + 1;
+    return g * N_SUB_BUCKETS + static_cast<int>((v >> (msb - S)) - N_SUB_BUCKETS);
+  }
+
+  /// Smallest value counted in bucket @a idx.
+  static uint64_t
+  lower_bound(int idx)
+  {
+    int g   = idx >> S;
+    int sub = idx & (N_SUB_BUCKETS - 1);
+    return g == 0 ? sub : uint64_t(sub + N_SUB_BUCKETS) << (g - 1);
+  }
+
+  /// Largest value counted in bucket @a idx.
+  static uint64_t
+  upper_bound(int idx)
+  {
+    return idx == N_BUCKETS - 1 ? UINT64_MAX : lower_bound(idx + 1) - 1;
+  }
+
+  /// Number of values recorded.
+  uint64_t
+  count() const
+  {
+    uint64_t n = 0;
+    for (auto c : _bucket) {
+      n += c;
+    }
+    return n;
+  }
+
+  uint64_t
+  bucket(int idx) const
+  {
+    return _bucket[idx];
+  }
+
+  /** The value at or below which @a q (0 .. 1) of the recorded values lie.
+      This is the upper bound of the bucket containing that value, clipped to @c MAX. Returns 0
+      if the histogram is empty.
+  */
+  uint64_t
+  percentile(double q) const
+  {
+    uint64_t total = this->count();
+    if (total == 0) {
+      return 0;
+    }
+    // Rank of the requested value, 1 based, rounded up so that q == 1 is the largest value.
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+    if (static_cast<double>(rank) < q * static_cast<double>(total) || rank == 0) {
+      ++rank;
+    }
+    uint64_t seen = 0;
+    for (int idx = 0; idx < N_BUCKETS; ++idx) {
+      seen += _bucket[idx];
+      if (seen >= rank) {
+        return idx == N_BUCKETS - 1 ? MAX : upper_bound(idx);
+      }
+    }
+    return MAX;
+  }
+
+  /// Upper bound of the highest occupied bucket, 0 if empty.
+  uint64_t
+  max() const
+  {
+    for (int idx = N_BUCKETS - 1; idx >= 0; --idx) {
+      if (_bucket[idx]) {
+        return idx == N_BUCKETS - 1 ? MAX : upper_bound(idx);
+      }
+    }
+    return 0;
+  }
+
+  void
+  clear()
+  {
+    for (auto &c : _bucket) {
+      c = 0;
+    }
+  }
+
+  Histogram &
+  operator+=(Histogram const &that)
+  {
+    for (int idx = 0; idx < N_BUCKETS; ++idx) {
+      _bucket[idx] += that._bucket[idx];
+    }
+    return *this;
+  }
+
+  /// Remove the counts of @a that, which must be an earlier copy of this histogram.
+  Histogram &
+  operator-=(Histogram const &that)
+  {
+    for (int idx = 0; idx < N_BUCKETS; ++idx) {
+      _bucket[idx] -= that._bucket[idx];
+    }
+    return *this;
+  }
+
+protected:
+  uint64_t _bucket[N_BUCKETS] = {0};
+};
+
+} // namespace ts
@@ -24,7 +24,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "tscore/ink_platform.h"
 #include "tscore/ink_defs.h"
@@ -94,6 +96,10 @@ namespace detail
     of disjoint ranges. Marking and unmarking can take O(log n) and
     may require memory allocation / deallocation although this is
     minimized.
+
+    Once a map is built, @c compile copies its ranges into sorted flat
+    arrays that @c contains searches instead of the tree, touching a
+    few cache lines rather than a node per level.
 */
 
 class IpMap
@@ -351,6 +357,34 @@ public:
   */
   self_type &clear();
 
+  /** Compile the map for lookups.
+
+      The ranges, and their client data, are copied into sorted arrays which @c contains then
+      searches. Marking, unmarking, filling or clearing the map drops the compiled form, which
+      must be compiled again, as does setting the data of a node through an iterator.
+
+      @return This object.
+  */
+  self_type &compile();
+
+  /// @return @c true if the map is compiled.
+  bool
+  is_compiled() const
+  {
+    return _compiled;
+  }
+
+  /// An IPv6 address as a pair of integers, for the compiled form.
+  struct Ip6Key {
+    uint64_t _hi;
+    uint64_t _lo;
+  };
+  /// The end of a compiled range, and its client data.
+  template <typename K> struct CompiledRange {
+    K _max;
+    void *_data;
+  };
+
   /// Iterator for first element.
   iterator begin() const;
   /// Iterator past last element.
@@ -381,6 +415,15 @@ protected:
 
   ts::detail::Ip4Map *_m4 = nullptr; ///< Map of IPv4 addresses.
   ts::detail::Ip6Map *_m6 = nullptr; ///< Map of IPv6 addresses.
+
+  /// Drop the compiled form, the map changed.
+  void uncompile();
+
+  bool _compiled = false;                          ///< The compiled form is valid.
+  std::vector<in_addr_t> _c4_min;                  ///< Start of the IPv4 ranges (host order), sorted.
+  std::vector<CompiledRange<in_addr_t>> _c4_range; ///< End and data of the IPv4 ranges.
+  std::vector<Ip6Key> _c6_min;                     ///< Start of the IPv6 ranges, sorted.
+  std::vector<CompiledRange<Ip6Key>> _c6_range;    ///< End and data of the IPv6 ranges.
 };
 
 inline IpMap &
@@ -32,6 +32,9 @@
 #if (JEMALLOC_VERSION_MAJOR == 5) && defined(MADV_DONTDUMP)
 #define JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED 1
 #endif /* MADV_DONTDUMP */
+#if (JEMALLOC_VERSION_MAJOR == 5)
+#define JEMALLOC_ARENA_SUPPORTED 1
+#endif
 #endif /* TS_HAS_JEMALLOC */
 
 namespace jearena
@@ -85,4 +88,85 @@ private:
  */
 JemallocNodumpAllocator &globalJemallocNodumpAllocator();
 
+/**
+ * A dedicated arena for the memory of a subsystem, so that what it takes from
+ * the system, and how fragmented that is, can be told apart from the rest of
+ * the process in the stats of the arena.
+ *
+ * The extents of the arena are advised MADV_HUGEPAGE when the arenas are
+ * enabled on huge pages, and MADV_DONTDUMP if the arena is created so. Each
+ * thread allocates through a tcache of its own for the arena.
+ *
+ * The memory may be freed with deallocate() or with ats_free(), jemalloc
+ * returns it to its arena either way. Without jemalloc 5, or until enable() is
+ * called, get() returns nullptr and the subsystems allocate as they did.
+ */
+class Arena
+{
+public:
+  static constexpr int MAX_ARENAS = 16;
+
+  struct Stats {
+    size_t allocated = 0; ///< Bytes allocated by the subsystem.
+    size_t active    = 0; ///< Bytes of the pages holding allocations.
+    size_t dirty     = 0; ///< Bytes of the unused pages not given back to the system yet.
+    size_t resident  = 0; ///< Bytes of the arena in memory, with its metadata.
+    size_t mapped    = 0; ///< Bytes mapped by the arena.
+  };
+
+  /**
+   * Let get() create arenas, on transparent huge pages if @a hugepages. Only
+   * before the subsystems are initialized.
+   *
+   * @return False if the arenas are not supported in this build.
+   */
+  static bool enable(bool hugepages);
+
+  /** The arena named @a name, created the first time, or nullptr if the arenas are not enabled. */
+  static Arena *get(const char *name, bool dontdump = false);
+
+  /** Call @a f with each arena, after refreshing the jemalloc stats. */
+  template <typename F>
+  static void
+  for_each(F &&f)
+  {
+    refresh_stats();
+    for (int i = 0; i < count(); ++i) {
+      f(*at(i));
+    }
+  }
+
+  void *allocate(size_t size, size_t alignment = 0);
+  void deallocate(void *ptr);
+
+  const char *
+  name() const
+  {
+    return name_;
+  }
+
+  /** The stats of the arena, as of the last refresh. False if they could not be read. */
+  bool stats(Stats &stats) const;
+
+private:
+  Arena(const char *name, unsigned index, bool dontdump);
+
+  static int count();
+  static Arena *at(int i);
+  static void refresh_stats();
+  int flags();
+
+  const char *name_;
+  unsigned index_;
+  bool dontdump_;
+  int slot_; ///< Of the arena in the tcaches of the threads.
+
+#if JEMALLOC_ARENA_SUPPORTED
+  static extent_hooks_t extent_hooks_;
+  static extent_alloc_t *original_alloc_;
+  static void *alloc(extent_hooks_t *extent, void *new_addr, size_t size, size_t alignment, bool *zero, bool *commit,
+                     unsigned arena_ind);
+#endif /* JEMALLOC_ARENA_SUPPORTED */
+};
+
 } /* namespace jearena */
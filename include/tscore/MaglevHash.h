@@ -0,0 +1,60 @@
+/** @file
+
+  A Maglev lookup table of consistent hash nodes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "ConsistentHash.h"
+#include <cstdint>
+#include <vector>
+
+/*
+  A Maglev lookup table, a prime number of slots that the nodes take in turns, each in the order of its own
+  permutation of the slots, as often as its weight, until the table is full. A hash value is looked up by a
+  single index, and the slots after it give the other nodes, as the ring of ATSConsistentHash does.
+
+  The table is built once every node is inserted. Caller is responsible for freeing node memory.
+ */
+
+struct ATSMaglevHash {
+  ATSMaglevHash(ATSHash64 *h = nullptr);
+  void insert(ATSConsistentHashNode *node, float weight = 1.0, ATSHash64 *h = nullptr);
+  void build();
+  ATSConsistentHashNode *lookup_by_hashval(uint64_t hashval, uint32_t *pos) const;
+  ATSConsistentHashNode *lookup_next(uint32_t *pos, bool *w = nullptr) const;
+  size_t
+  size() const
+  {
+    return table.size();
+  }
+
+private:
+  struct Member {
+    ATSConsistentHashNode *node;
+    float weight;
+    uint64_t hashval; // of the node name, for its permutation
+  };
+
+  ATSHash64 *hash;
+  std::vector<Member> members;
+  std::vector<uint32_t> table; // index of the member in each slot
+};
@@ -55,6 +55,7 @@ public:
   Regex()              = default;
   Regex(Regex const &) = delete; // No copying.
   Regex(Regex &&that) noexcept;
+  Regex &operator=(Regex &&that) noexcept;
   ~Regex();
 
   /** Compile the @a pattern into a regular expression.
@@ -94,6 +95,16 @@ public:
   int get_capture_count();
 
 private:
+  friend class DFA;
+
+  /** Execute the regular expression, for the name of the last @c (*MARK) on the matching path.
+   *
+   * @param str String to match against.
+   * @param mark Set to the name of the mark, @c nullptr if none was passed.
+   * @return The result of @c pcre_exec, not negative if the pattern matched.
+   */
+  int exec_mark(std::string_view const &str, const char *&mark) const;
+
   pcre *regex             = nullptr;
   pcre_extra *regex_extra = nullptr;
 };
@@ -102,6 +113,13 @@ private:
  *
  * This contains a set of patterns (which may be of size 1) and matches if any of the patterns
  * match.
+ *
+ * Anchored patterns are also compiled together, as one alternation with a @c (*MARK) naming the
+ * index of each pattern, so that a string is matched against all of them in a single pass rather
+ * than against one pattern after the other. The alternatives are tried in order at the start of the
+ * string, so the first pattern to match is the same either way. Patterns that would mean something
+ * else in the alternation (back references, subroutine calls, verbs) keep the whole set matched one
+ * pattern at a time.
  */
 class DFA
 {
@@ -138,5 +156,12 @@ private:
    */
   bool build(std::string_view const &pattern, unsigned flags = 0);
 
+  /** Compile the patterns into the single pass alternation, if they can be.
+   *
+   * @param flags Regular expression compilation flags.
+   */
+  void combine(unsigned flags);
+
   std::vector<Pattern> _patterns;
+  Regex _combined; ///< All of the patterns, as one alternation, if they could be combined.
 };
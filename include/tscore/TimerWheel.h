@@ -0,0 +1,247 @@
+/** @file
+
+  Hierarchical timing wheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Elements are kept in intrusive lists, one per slot, in @c N_LEVELS wheels of @c N_SLOTS slots each.
+  A slot of level @a n covers @c N_SLOTS^n ticks. Insert and remove are O(1), advancing the wheel
+  costs one step per occupied level 0 slot plus one per cascade that has work to do.
+
+  The element type is accessed through @a T, which must provide
+
+  @code
+    static ink_hrtime at(C const *);    // Expiration time, must not change while the element is queued.
+    static int tag(C const *);          // Stored tag, values are 0 .. TAG_OVERFLOW.
+    static void set_tag(C *, int);
+    static bool expire_early(C const *); // Move the element to the ready list at the next cascade.
+  @endcode
+
+  The tag and the expiration time are enough to find the list an element is in, the wheel stores
+  nothing else per element.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tscore/ink_hrtime.h"
+#include "tscore/List.h"
+
+template <class C, class L, class T> class TimerWheel
+{
+public:
+  static constexpr int SLOT_BITS    = 6;
+  static constexpr int N_SLOTS      = 1 << SLOT_BITS;
+  static constexpr int N_LEVELS     = 5;
+  static constexpr int TAG_READY    = N_LEVELS;
+  static constexpr int TAG_OVERFLOW = N_LEVELS + 1;
+
+  using List = Queue<C, L>;
+
+  /// Construct a wheel with a resolution of @a tick, starting at @a now.
+  TimerWheel(ink_hrtime tick, ink_hrtime now) : _tick(tick), _cur(now / tick) {}
+
+  /// Add @a c to the wheel.
+  void
+  insert(C *c)
+  {
+    uint64_t at = static_cast<uint64_t>(std::max<ink_hrtime>(T::at(c), 0) / _tick);
+    if (at < _cur) {
+      T::set_tag(c, TAG_READY);
+      _ready.enqueue(c);
+      return;
+    }
+
+    uint64_t delta = at - _cur;
+    for (int level = 0; level < N_LEVELS; ++level) {
+      if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        int slot = (at >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+        T::set_tag(c, level);
+        _slot[level][slot].enqueue(c);
+        _bits[level] |= uint64_t(1) << slot;
+        return;
+      }
+    }
+    T::set_tag(c, TAG_OVERFLOW);
+    _overflow.enqueue(c);
+  }
+
+  /// Remove @a c, which must be in the wheel.
+  void
+  remove(C *c)
+  {
+    int level = T::tag(c);
+    if (level == TAG_READY) {
+      _ready.remove(c);
+    } else if (level == TAG_OVERFLOW) {
+      _overflow.remove(c);
+    } else {
+      uint64_t at = static_cast<uint64_t>(std::max<ink_hrtime>(T::at(c), 0) / _tick);
+      int slot    = (at >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+      _slot[level][slot].remove(c);
+      if (_slot[level][slot].empty()) {
+        _bits[level] &= ~(uint64_t(1) << slot);
+      }
+    }
+  }
+
+  /// Move everything that expires at or before @a now to the ready list.
+  void
+  advance(ink_hrtime now)
+  {
+    uint64_t target = now / _tick;
+
+    // The clock went back (time of day adjustment), place everything again relative to @a now
+    // rather than holding it for the length of the step.
+    if (target + N_SLOTS < _cur) {
+      rebase(target);
+      return;
+    }
+
+    while (_cur <= target) {
+      int idx = _cur & (N_SLOTS - 1);
+      if (idx == 0) {
+        cascade();
+      }
+      if (_bits[0] & (uint64_t(1) << idx)) {
+        _bits[0] &= ~(uint64_t(1) << idx);
+        while (C *c = _slot[0][idx].dequeue()) {
+          T::set_tag(c, TAG_READY);
+          _ready.enqueue(c);
+        }
+      }
+      ++_cur;
+      _cur = std::min(next_stop(), target + 1);
+    }
+  }
+
+  /// Take the next element off the ready list.
+  C *
+  pop_ready()
+  {
+    return _ready.dequeue();
+  }
+
+  /** The earliest time at which the wheel needs to be advanced.
+      Returns @a now if the ready list is not empty, and @a never if the wheel is empty.
+  */
+  ink_hrtime
+  next_expiry(ink_hrtime now, ink_hrtime never) const
+  {
+    if (!_ready.empty()) {
+      return now;
+    }
+    uint64_t t = next_stop();
+    return t == UINT64_MAX ? never : static_cast<ink_hrtime>(t) * _tick;
+  }
+
+  bool
+  empty() const
+  {
+    return _ready.empty() && _overflow.empty() && !(_bits[0] | _bits[1] | _bits[2] | _bits[3] | _bits[4]);
+  }
+
+private:
+  /// The first tick at or after @a _cur with either an occupied level 0 slot or a cascade that has work.
+  uint64_t
+  next_stop() const
+  {
+    uint64_t stop = UINT64_MAX;
+    if (uint64_t bits = _bits[0] >> (_cur & (N_SLOTS - 1)); bits) {
+      stop = _cur + __builtin_ctzll(bits);
+    } else if (_bits[0]) {
+      stop = align(1); // Only slots of the next rotation are occupied.
+    }
+    // Nothing moves down before the next rotation of the lowest level that holds anything.
+    for (int level = 1; level <= N_LEVELS; ++level) {
+      if (level == N_LEVELS ? !_overflow.empty() : _bits[level] != 0) {
+        stop = std::min(stop, align(level));
+        break;
+      }
+    }
+    return stop;
+  }
+
+  /// The first tick at or after @a _cur that starts a rotation of level @a level - 1.
+  uint64_t
+  align(int level) const
+  {
+    uint64_t step = uint64_t(1) << (SLOT_BITS * level);
+    return (_cur + step - 1) & ~(step - 1);
+  }
+
+  /// Distribute the higher level slots that come due at @a _cur down a level, called at each rotation of level 0.
+  void
+  cascade()
+  {
+    for (int level = 1; level < N_LEVELS; ++level) {
+      int idx = (_cur >> (SLOT_BITS * level)) & (N_SLOTS - 1);
+      _bits[level] &= ~(uint64_t(1) << idx);
+      redistribute(_slot[level][idx]);
+      if (idx != 0) {
+        return;
+      }
+    }
+    // Every level rolled over, the far future list may now be in range.
+    redistribute(_overflow);
+  }
+
+  void
+  redistribute(List &l)
+  {
+    List q = l;
+    l.clear();
+    while (C *c = q.dequeue()) {
+      if (T::expire_early(c)) {
+        T::set_tag(c, TAG_READY);
+        _ready.enqueue(c);
+      } else {
+        insert(c);
+      }
+    }
+  }
+
+  void
+  rebase(uint64_t target)
+  {
+    List all;
+    for (int level = 0; level < N_LEVELS; ++level) {
+      for (int slot = 0; slot < N_SLOTS; ++slot) {
+        all.append(_slot[level][slot]);
+        _slot[level][slot].clear();
+      }
+      _bits[level] = 0;
+    }
+    all.append(_overflow);
+    _overflow.clear();
+    _cur = target;
+    redistribute(all);
+  }
+
+  ink_hrtime _tick;
+  uint64_t _cur;                  ///< Next tick to be processed.
+  uint64_t _bits[N_LEVELS] = {0}; ///< Occupied slots per level.
+  List _slot[N_LEVELS][N_SLOTS];
+  List _ready;
+  List _overflow;
+};
@@ -0,0 +1,39 @@
+/** @file
+
+  CRC32C (Castagnoli) checksums
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+  The CRC32C of the @a len bytes at @a data, continuing the CRC32C @a crc of the bytes before them.
+
+  The CRC is computed with the SSE4.2 @c crc32 instruction on x86-64 processors that have it,
+  checked at run time, and with the ARMv8 CRC instructions on AArch64 builds targeting them.
+  Other processors use a table driven implementation, several times slower.
+*/
+uint32_t ink_crc32c(const void *data, size_t len, uint32_t crc = 0);
+
+/// The table driven implementation of @c ink_crc32c, whatever the processor.
+uint32_t ink_crc32c_sw(const void *data, size_t len, uint32_t crc = 0);
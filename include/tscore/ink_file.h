@@ -114,6 +114,23 @@ struct ink_device_geometry {
 
 bool ink_file_get_geometry(int fd, ink_device_geometry &geometry);
 
+struct ink_device_queue {
+  bool rotational; // The device has to seek, as far as the kernel knows.
+  unsigned depth;  // Number of requests the device queue holds, 0 if unknown.
+};
+
+// Get the request queue of the block device holding fd, which may be a device or a file. Only Linux reports it.
+bool ink_file_get_device_queue(int fd, ink_device_queue &queue);
+
+/**
+ Return the number of cache stripes a span of size bytes on a device with this queue is split into.
+
+ Each stripe has its own lock and writer, so a solid state device gets a stripe per processor, at
+ most one for every 8 requests its queue holds and none smaller than min_stripe_size. A rotational
+ device gets a single stripe, more would only make it seek between them.
+ */
+int ink_device_stripe_count(const ink_device_queue &queue, uint64_t size, uint64_t min_stripe_size, int processors);
+
 // Return the value of pathconf(path, _PC_NAME_MAX), or the closest approximation.
 size_t ink_file_namemax(const char *path);
 
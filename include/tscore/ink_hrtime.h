@@ -32,6 +32,7 @@
 
 #include "tscore/ink_config.h"
 #include "tscore/ink_assert.h"
+#include <atomic>
 #include <ctime>
 #include <cstdint>
 #include <sys/time.h>
@@ -224,9 +225,75 @@ ink_hrtime_to_timeval(ink_hrtime t)
    which translates to (365 + 0.25)369*24*60*60 seconds   */
 #define NT_TIMEBASE_DIFFERENCE_100NSECS 116444736000000000i64
 
+#if defined(__x86_64__)
+#define INK_HRTIME_TSC_SUPPORTED 1
+#else
+#define INK_HRTIME_TSC_SUPPORTED 0
+#endif
+
+#if INK_HRTIME_TSC_SUPPORTED
+/*
+   The time stamp counter clock
+
+   Where the CPU has an invariant TSC, one that ticks at a constant rate in every state and is in
+   sync between the cores, ink_get_hrtime_internal() can read the counter rather than call
+   clock_gettime. The counter is mapped to CLOCK_REALTIME from an anchor, a counter value and the
+   time it was read at, and the rate of the counter. The first thread to read the clock a second
+   after the anchor was taken takes it again from clock_gettime, and corrects the rate from the
+   time elapsed since the previous one: the time read stays within microseconds of the system
+   clock, and follows its adjustments after at most a second.
+*/
+struct InkHrtimeTscAnchor {
+  std::atomic<uint64_t> sequence{0}; ///< odd while the anchor is being taken
+  std::atomic<uint64_t> tsc{0};      ///< the counter at the anchor
+  std::atomic<ink_hrtime> time{0};   ///< the time at the anchor
+  std::atomic<uint64_t> mult{0};     ///< nanoseconds per tick, with 32 bits of fraction
+  std::atomic<bool> updating{false}; ///< whether a thread is taking the anchor
+  uint64_t period = 0;               ///< the ticks after which the anchor is taken again
+};
+
+extern InkHrtimeTscAnchor ink_hrtime_tsc_anchor;
+extern std::atomic<bool> ink_hrtime_tsc_enabled;
+
+/// Take the anchor again, unless another thread is, and return the time from clock_gettime.
+ink_hrtime ink_hrtime_tsc_reanchor();
+
+static inline ink_hrtime
+ink_hrtime_tsc_now()
+{
+  InkHrtimeTscAnchor &anchor = ink_hrtime_tsc_anchor;
+  uint64_t sequence          = anchor.sequence.load(std::memory_order_acquire);
+  uint64_t tsc               = anchor.tsc.load(std::memory_order_relaxed);
+  ink_hrtime time            = anchor.time.load(std::memory_order_relaxed);
+  uint64_t mult              = anchor.mult.load(std::memory_order_relaxed);
+  uint64_t ticks             = __builtin_ia32_rdtsc() - tsc;
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // Within a period of the anchor, the product of the ticks and the rate fits in 64 bits.
+  if (!(sequence & 1) && anchor.sequence.load(std::memory_order_relaxed) == sequence && ticks < anchor.period) {
+    return time + static_cast<ink_hrtime>((ticks * mult) >> 32);
+  }
+  return ink_hrtime_tsc_reanchor();
+}
+#endif
+
+/** Use the time stamp counter clock for ink_get_hrtime_internal(), if the CPU has an invariant TSC.
+
+    This calibrates the counter against clock_gettime, for about 50 milliseconds, and must be called
+    before the threads are started.
+
+    @return @c true if the counter is used, @c false if the time still comes from clock_gettime.
+*/
+bool ink_hrtime_tsc_init();
+
 static inline ink_hrtime
 ink_get_hrtime_internal()
 {
+#if INK_HRTIME_TSC_SUPPORTED
+  if (ink_hrtime_tsc_enabled.load(std::memory_order_acquire)) {
+    return ink_hrtime_tsc_now();
+  }
+#endif
 #if defined(freebsd) || HAVE_CLOCK_GETTIME
   timespec ts;
   clock_gettime(CLOCK_REALTIME, &ts);
@@ -167,12 +167,23 @@ union head_p {
 #error "unsupported processor"
 #endif
 
+namespace jearena
+{
+class Arena;
+}
+
 struct _InkFreeList {
   head_p head;
   const char *name;
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  /* Thread magazines, see ink_freelist_new() */
+  head_p depot;                          ///< Full magazines, linked through the second word of their first item.
+  uint32_t index;                        ///< Of the slot of the list in the magazines of each thread.
+  uint32_t magazine_size;                ///< Items in a full magazine, 0 if the list has no magazines.
+  uint64_t retired_hits, retired_misses; ///< Magazine counts of the threads that exited.
+  jearena::Arena *arena;                 ///< Of the chunks and, with malloc, the items, nullptr for the default.
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -190,13 +201,41 @@ InkFreeList *ink_freelist_create(const char *name, uint32_t type_size, uint32_t
 inkcoreapi void ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment);
 inkcoreapi void ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size,
                                           uint32_t alignment, int advice);
+/** Create a freelist with the parameters of @a f, named @a name.
+    This is used for the per NUMA node lists of an allocator. Unlike @c ink_freelist_init this can
+    be called after startup, but calls must be serialized by the caller.
+*/
+inkcoreapi InkFreeList *ink_freelist_clone(const InkFreeList *f, const char *name);
 inkcoreapi void *ink_freelist_new(InkFreeList *f);
 inkcoreapi void ink_freelist_free(InkFreeList *f, void *item);
 inkcoreapi void ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
-void ink_freelists_dump(FILE *f);
+inkcoreapi void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
 
+/** Thread magazines.
+
+    Each thread keeps two magazines, stacks of free items, of each freelist: it allocates from and
+    frees to them without touching the list. Full magazines are exchanged with a depot of the list
+    in one operation, and only when both magazines of the thread are empty (or full) is the depot
+    used, so that a thread moving back and forth across a magazine boundary stays on its own
+    magazines. The depot is per list, so per NUMA node for the allocators that keep a list per node.
+*/
+/// Most items in a magazine.
+static constexpr uint32_t INK_FREELIST_MAGAZINE_ITEMS = 32;
+/// Most bytes of items in a magazine, lists of larger items get smaller magazines.
+static constexpr uint32_t INK_FREELIST_MAGAZINE_BYTES = 32 * 1024;
+/// Freelists past that many have no magazines.
+static constexpr uint32_t INK_FREELIST_MAX_MAGAZINE_LISTS = 1024;
+
+/// Most NUMA nodes for which allocators keep separate freelists.
+static constexpr int INK_FREELIST_MAX_NODES = 8;
+/** NUMA node of the calling thread, for picking a freelist.
+    This is -1, meaning the default freelist, unless the thread was bound to a node and allocators
+    are partitioned by node.
+*/
+extern thread_local int ink_thread_numa_node;
+
 struct InkAtomicList {
   InkAtomicList() {}
   head_p head{};
@@ -216,6 +255,11 @@ struct InkAtomicList {
 inkcoreapi void ink_atomiclist_init(InkAtomicList *l, const char *name, uint32_t offset_to_next);
 
 inkcoreapi void *ink_atomiclist_push(InkAtomicList *l, void *item);
+/** Push the items from @a head to @a tail, already linked through their next pointers, at once.
+    A later pop returns @a head first, as if the items had been pushed one by one starting at @a tail.
+    Returns the previous head of the list, as @c ink_atomiclist_push does.
+*/
+inkcoreapi void *ink_atomiclist_push_chain(InkAtomicList *l, void *head, void *tail);
 void *ink_atomiclist_pop(InkAtomicList *l);
 inkcoreapi void *ink_atomiclist_popall(InkAtomicList *l);
 /*
@@ -0,0 +1,147 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+/**
+ * @file IOBufferView.h
+ */
+
+#pragma once
+
+#include "ts/apidefs.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace atscppapi
+{
+/**
+ * @brief A view of the data of a TSIOBufferReader, block by block, without copying it.
+ *
+ * Each block is a std::string_view of the memory of the buffer, valid until the reader is consumed
+ * past it or the buffer is destroyed. A token, a tag or a line may span blocks: one that is cut by
+ * the end of a block continues at the start of the next.
+ *
+ * \code
+ * for (std::string_view block : IOBufferReaderView(reader)) {
+ *   scan(block);
+ * }
+ * \endcode
+ */
+class IOBufferReaderView
+{
+public:
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::string_view *;
+    using reference         = const std::string_view &;
+
+    iterator() = default;
+
+    reference
+    operator*() const
+    {
+      return view_;
+    }
+    pointer
+    operator->() const
+    {
+      return &view_;
+    }
+
+    iterator &operator++();
+    iterator
+    operator++(int)
+    {
+      iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool
+    operator==(const iterator &that) const
+    {
+      return block_ == that.block_ && view_.data() == that.view_.data();
+    }
+    bool
+    operator!=(const iterator &that) const
+    {
+      return !(*this == that);
+    }
+
+  private:
+    friend class IOBufferReaderView;
+    iterator(TSIOBufferReader reader, TSIOBufferBlock block, int64_t left);
+    void load(); // the view of the block, or of the next block that has data
+
+    TSIOBufferReader reader_ = nullptr;
+    TSIOBufferBlock block_   = nullptr; ///< nullptr at the end
+    int64_t left_            = 0;       ///< bytes of the view from this block on
+    std::string_view view_;
+  };
+
+  /// A view of the first @a length bytes @a reader has, or all of them.
+  explicit IOBufferReaderView(TSIOBufferReader reader, int64_t length = INT64_MAX);
+
+  iterator begin() const;
+  iterator
+  end() const
+  {
+    return iterator();
+  }
+
+  /// The number of bytes in the view.
+  int64_t size() const;
+
+private:
+  TSIOBufferReader reader_;
+  int64_t length_;
+};
+
+/**
+ * Move the first @a length bytes of @a reader to @a out, without copying them: the blocks are shared
+ * by both buffers, and consumed from the reader.
+ *
+ * @return the number of bytes moved, less than @a length if the reader has less.
+ */
+int64_t moveBlocks(TSIOBuffer out, TSIOBufferReader reader, int64_t length);
+
+/**
+ * Append @a length bytes of @a reader, from @a offset, to @a out, without copying them. The reader is
+ * left as it is.
+ *
+ * @return the number of bytes cloned.
+ */
+int64_t cloneBlocks(TSIOBuffer out, TSIOBufferReader reader, int64_t length, int64_t offset = 0);
+
+/**
+ * Move the first @a offset bytes of @a reader to @a out, write @a with, and consume the @a length
+ * bytes that follow: the bytes at @a offset are replaced, or @a with is inserted if @a length is 0.
+ * Only @a with is copied. What follows is left in the reader, so that a body can be rewritten by
+ * replacements from its start, with offsets from where the previous one left the reader.
+ *
+ * @return the number of bytes written to @a out, or -1 if the reader has fewer than @a offset +
+ * @a length bytes, and nothing was done.
+ */
+int64_t replaceAt(TSIOBuffer out, TSIOBufferReader reader, int64_t offset, int64_t length, std::string_view with);
+
+} // namespace atscppapi
@@ -96,6 +96,14 @@ public:
    */
   virtual void consume(std::string_view data) = 0;
 
+  /**
+   * The data that arrived, in the blocks of @a reader. Override this rather than consume() to look
+   * at the data in place, see IOBufferReaderView, and to pass it on without copying it with
+   * produce(TSIOBufferReader, int64_t). What is left in the reader is dropped after the call. The
+   * default copies the data to call consume().
+   */
+  virtual void consumeBlocks(TSIOBufferReader reader);
+
   /**
    * Call this method if you wish to pause the transformation.
    */
@@ -126,6 +134,13 @@ protected:
    */
   size_t produce(std::string_view);
 
+  /**
+   * Produce the first @a length bytes of @a reader, moving its blocks to the output rather than
+   * copying them. For a request transformation, whose output is kept until it is complete, they are
+   * copied. Returns the number of bytes consumed from the reader.
+   */
+  size_t produce(TSIOBufferReader reader, int64_t length);
+
   /**
    * This is the method that you must call when you're done producing output for
    * the downstream TransformationPlugin.
@@ -138,6 +153,9 @@ protected:
 private:
   TransformationPluginState *state_; /** Internal state for a TransformationPlugin */
   size_t doProduce(std::string_view);
+  size_t doProduce(TSIOBufferReader reader, int64_t length);
+  bool startOutput();
+  void reenableOutput();
   static int resumeCallback(TSCont cont, TSEvent event, void *edata); /** Resume callback*/
 };
 
@@ -29,8 +29,21 @@
 
 #include "P_AIO.h"
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 #define AIO_PERIOD -HRTIME_MSECONDS(10)
+#if AIO_MODE == AIO_MODE_IO_URING
+#include <atomic>
+
+RecInt aio_io_uring_entries        = 1024;
+RecInt aio_io_uring_register_files = 1;
+
+static ink_mutex aio_fixed_mutex;
+static int aio_fixed_fds[AIO_URING_MAX_FILES];
+static std::atomic<int> aio_fixed_count{0};
+
+// IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE, level) from linux/ioprio.h, which not every libc provides.
+#define AIO_IOPRIO_BE(level) ((2 << 13) | (level))
+#endif
 #else
 
 #define MAX_DISKS_POSSIBLE 100
@@ -48,9 +61,12 @@ int num_filedes = 1;
 static ink_mutex insert_mutex;
 
 int thread_is_created = 0;
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 RecInt cache_config_threads_per_disk = 12;
 RecInt api_config_threads_per_disk   = 12;
+#if AIO_MODE == AIO_MODE_THREAD
+static RecInt aio_per_numa_node = 0;
+#endif
 
 RecRawStatBlock *aio_rsb      = nullptr;
 Continuation *aio_err_callbck = nullptr;
@@ -108,6 +124,23 @@ aio_stats_cb(const char * /* name ATS_UNUSED */, RecDataT data_type, RecData *da
   return 0;
 }
 
+// The requests queued or in progress on the disks, as of the sync.
+static int
+aio_queued_stats_cb(const char * /* name ATS_UNUSED */, RecDataT /* data_type ATS_UNUSED */, RecData *data,
+                    RecRawStatBlock * /* rsb ATS_UNUSED */, int /* id ATS_UNUSED */)
+{
+  int64_t queued = 0;
+#if AIO_MODE == AIO_MODE_THREAD
+  for (int i = 0; i < num_filedes; ++i) {
+    if (aio_reqs[i] != nullptr) {
+      queued += __atomic_load_n(&aio_reqs[i]->requests_queued, __ATOMIC_RELAXED);
+    }
+  }
+#endif
+  data->rec_int = queued;
+  return 0;
+}
+
 #ifdef AIO_STATS
 /* total number of requests received - for debugging */
 static int num_requests = 0;
@@ -158,14 +191,24 @@ ink_aio_init(ts::ModuleVersion v)
                      (int)AIO_STAT_KB_READ_PER_SEC, aio_stats_cb);
   RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.KB_write_per_sec", RECD_FLOAT, RECP_PERSISTENT,
                      (int)AIO_STAT_KB_WRITE_PER_SEC, aio_stats_cb);
-#if AIO_MODE != AIO_MODE_NATIVE
+  RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.aio.background_read_wait", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)AIO_STAT_BACKGROUND_READ_WAIT, RecRawStatSyncSum);
+  RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.aio.queued", RECD_INT, RECP_NON_PERSISTENT, (int)AIO_STAT_QUEUED,
+                     aio_queued_stats_cb);
+#if AIO_MODE == AIO_MODE_THREAD
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
   ink_mutex_init(&insert_mutex);
+  REC_ReadConfigInteger(aio_per_numa_node, "proxy.config.allocator.per_numa_node");
 #endif
   REC_ReadConfigInteger(cache_config_threads_per_disk, "proxy.config.cache.threads_per_disk");
 #if TS_USE_LINUX_NATIVE_AIO
   Warning("Running with Linux AIO, there are known issues with this feature");
 #endif
+#if AIO_MODE == AIO_MODE_IO_URING
+  ink_mutex_init(&aio_fixed_mutex);
+  REC_ReadConfigInteger(aio_io_uring_entries, "proxy.config.aio.io_uring.entries");
+  REC_ReadConfigInteger(aio_io_uring_register_files, "proxy.config.aio.io_uring.register_files");
+#endif
 }
 
 int
@@ -178,13 +221,47 @@ ink_aio_start()
   return 0;
 }
 
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_IO_URING
+void
+ink_aio_register_fd(int /* fd ATS_UNUSED */)
+{
+}
+#endif
+
+#if AIO_MODE == AIO_MODE_THREAD
 
 static void *aio_thread_main(void *arg);
 
+/** The NUMA node of the device behind @a fildes, -1 if unknown.
+    The kernel reports it for the device of a whole disk, a partition takes the node of its disk.
+*/
+static int
+aio_disk_numa_node(int fildes)
+{
+  struct stat st;
+  if (fildes < 0 || fstat(fildes, &st) != 0) {
+    return -1;
+  }
+  dev_t dev = S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+  char path[PATH_NAME_MAX];
+  int node = -1;
+  for (char const *fmt : {"/sys/dev/block/%u:%u/device/numa_node", "/sys/dev/block/%u:%u/../device/numa_node"}) {
+    snprintf(path, sizeof(path), fmt, major(dev), minor(dev));
+    if (FILE *f = fopen(path, "r"); f != nullptr) {
+      if (fscanf(f, "%d", &node) != 1) {
+        node = -1;
+      }
+      fclose(f);
+      break;
+    }
+  }
+  return node;
+}
+
 struct AIOThreadInfo : public Continuation {
   AIO_Reqs *req;
   int sleep_wait;
+  int node = -1; ///< NUMA node to run on, -1 to run anywhere.
 
   int
   start(int event, Event *e)
@@ -192,13 +269,30 @@ struct AIOThreadInfo : public Continuation {
     (void)event;
     (void)e;
 #if TS_USE_HWLOC
+    hwloc_obj_t obj = nullptr;
+    while (node >= 0 && (obj = hwloc_get_next_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, obj)) != nullptr &&
+           obj->os_index != static_cast<unsigned>(node)) {
+    }
+    if (obj != nullptr) {
+      // Serve the disk from the processors and memory closest to it.
+      hwloc_set_cpubind(ink_get_topology(), obj->cpuset, HWLOC_CPUBIND_THREAD);
+#if HWLOC_API_VERSION >= 0x20000
+      hwloc_set_membind(ink_get_topology(), obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET);
+#else
+      hwloc_set_membind_nodeset(ink_get_topology(), obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_THREAD);
+#endif
+      if (obj->logical_index < static_cast<unsigned>(INK_FREELIST_MAX_NODES)) {
+        ink_thread_numa_node = obj->logical_index;
+      }
+    } else {
 #if HWLOC_API_VERSION >= 0x20000
-    hwloc_set_membind(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
-                      HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET);
+      hwloc_set_membind(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
+                        HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET);
 #else
-    hwloc_set_membind_nodeset(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
-                              HWLOC_MEMBIND_THREAD);
+      hwloc_set_membind_nodeset(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()),
+                                HWLOC_MEMBIND_INTERLEAVE, HWLOC_MEMBIND_THREAD);
 #endif
+    }
 #endif
     aio_thread_main(this);
     delete this;
@@ -251,12 +345,14 @@ aio_init_fildes(int fildes, int fromAPI = 0)
   size_t stacksize;
 
   REC_ReadConfigInteger(stacksize, "proxy.config.thread.default.stacksize");
+  int node = aio_per_numa_node ? aio_disk_numa_node(fildes) : -1;
   for (i = 0; i < thread_num; i++) {
     if (i == (thread_num - 1)) {
       thr_info = new AIOThreadInfo(request, 1);
     } else {
       thr_info = new AIOThreadInfo(request, 0);
     }
+    thr_info->node = node;
     snprintf(thr_name, MAX_THREAD_NAME_LENGTH, "[ET_AIO %d:%d]", i, fildes);
     ink_assert(eventProcessor.spawn_thread(thr_info, thr_name, stacksize));
   }
@@ -277,7 +373,30 @@ aio_insert(AIOCallback *op, AIO_Reqs *req)
   num_requests++;
   req->queued++;
 #endif
-  req->aio_todo.enqueue(op);
+  req->aio_todo[op->priority].enqueue(op);
+}
+
+/* take the next request off the queues, the highest priority class first unless a request of a
+   lower class has waited for AIO_PRIORITY_MAX_WAIT already. */
+static AIOCallback *
+aio_next(AIO_Reqs *req)
+{
+  int next = 0;
+  while (next < AIO_PRIORITY_COUNT && !req->aio_todo[next].head) {
+    next++;
+  }
+  if (next == AIO_PRIORITY_COUNT) {
+    return nullptr;
+  }
+  ink_hrtime now = Thread::get_hrtime_updated();
+  for (int i = next + 1; i < AIO_PRIORITY_COUNT; i++) {
+    AIOCallbackInternal *op = static_cast<AIOCallbackInternal *>(req->aio_todo[i].head);
+    if (op && now - op->queued_at > AIO_PRIORITY_MAX_WAIT) {
+      next = i;
+      break;
+    }
+  }
+  return req->aio_todo[next].pop();
 }
 
 /* move the request from the atomic list to the queue */
@@ -311,6 +430,8 @@ aio_queue_req(AIOCallbackInternal *op, int fromAPI = 0)
   AIO_Reqs *req  = op->aio_req;
   op->link.next  = nullptr;
   op->link.prev  = nullptr;
+  op->queued_at  = Thread::get_hrtime_updated();
+  AIO_PROBE_SUBMIT(op);
 #ifdef AIO_STATS
   ink_atomic_increment((int *)&data->num_req, 1);
 #endif
@@ -451,7 +572,7 @@ aio_thread_main(void *arg)
       current_req = my_aio_req;
       /* check if any pending requests on the atomic list */
       aio_move(my_aio_req);
-      if (!(op = my_aio_req->aio_todo.pop())) {
+      if (!(op = aio_next(my_aio_req))) {
         break;
       }
 #ifdef AIO_STATS
@@ -467,8 +588,18 @@ aio_thread_main(void *arg)
         aio_num_read++;
         aio_bytes_read += op->aiocb.aio_nbytes;
       }
+      bool background = op->priority >= AIO_PRIORITY_EVACUATE;
+      if (background) {
+        ink_atomic_increment(&current_req->background, 1);
+      } else if (op->priority == AIO_PRIORITY_READ && current_req->background > 0) {
+        ink_hrtime wait = Thread::get_hrtime_updated() - static_cast<AIOCallbackInternal *>(op)->queued_at;
+        RecIncrRawStat(aio_rsb, thr_info->mutex->thread_holding, AIO_STAT_BACKGROUND_READ_WAIT, ink_hrtime_to_usec(wait));
+      }
       ink_mutex_release(&current_req->aio_mutex);
       cache_op((AIOCallbackInternal *)op);
+      if (background) {
+        ink_atomic_increment(&current_req->background, -1);
+      }
       ink_atomic_increment(&current_req->requests_queued, -1);
 #ifdef AIO_STATS
       ink_atomic_increment((int *)&current_req->pending, -1);
@@ -491,7 +622,7 @@ aio_thread_main(void *arg)
   }
   return nullptr;
 }
-#else
+#elif AIO_MODE == AIO_MODE_NATIVE
 int
 DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
 {
@@ -569,6 +700,7 @@ ink_aio_read(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
 #ifdef HAVE_EVENTFD
   io_set_eventfd(&op->aiocb, t->evfd);
 #endif
+  AIO_PROBE_SUBMIT(op);
   t->diskHandler->ready_list.enqueue(op);
 
   return 1;
@@ -583,6 +715,7 @@ ink_aio_write(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
 #ifdef HAVE_EVENTFD
   io_set_eventfd(&op->aiocb, t->evfd);
 #endif
+  AIO_PROBE_SUBMIT(op);
   t->diskHandler->ready_list.enqueue(op);
 
   return 1;
@@ -602,6 +735,7 @@ ink_aio_readv(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
 #ifdef HAVE_EVENTFD
     io_set_eventfd(&op->aiocb, t->evfd);
 #endif
+    AIO_PROBE_SUBMIT(io);
     dh->ready_list.enqueue(io);
     ++sz;
     io = io->then;
@@ -632,6 +766,7 @@ ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
 #ifdef HAVE_EVENTFD
     io_set_eventfd(&op->aiocb, t->evfd);
 #endif
+    AIO_PROBE_SUBMIT(io);
     dh->ready_list.enqueue(io);
     ++sz;
     io = io->then;
@@ -647,4 +782,294 @@ ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
   }
   return 1;
 }
-#endif // AIO_MODE != AIO_MODE_NATIVE
+#else // AIO_MODE == AIO_MODE_IO_URING
+
+/* Descriptors registered through ink_aio_register_fd. Entries are only ever appended, so an entry
+   below @c aio_fixed_count can be read without the mutex. */
+
+void
+ink_aio_register_fd(int fd)
+{
+  if (!aio_io_uring_register_files || fd < 0) {
+    return;
+  }
+  ink_scoped_mutex_lock lock(aio_fixed_mutex);
+  int n = aio_fixed_count.load(std::memory_order_relaxed);
+  for (int i = 0; i < n; ++i) {
+    if (aio_fixed_fds[i] == fd) {
+      return;
+    }
+  }
+  if (n >= AIO_URING_MAX_FILES) {
+    Debug("aio", "not registering fd %d, the registered file table is full", fd);
+    return;
+  }
+  aio_fixed_fds[n] = fd;
+  aio_fixed_count.store(n + 1, std::memory_order_release);
+}
+
+DiskHandler::DiskHandler()
+{
+  SET_HANDLER(&DiskHandler::startAIOEvent);
+  ink_mutex_init(&remote_mutex);
+  for (int &fd : fixed_fds) {
+    fd = -1;
+  }
+
+  int ret = io_uring_queue_init(aio_io_uring_entries, &ring, 0);
+  if (ret < 0) {
+    Fatal("io_uring_queue_init(%" PRId64 ") failed: %s (%d)", aio_io_uring_entries, strerror(-ret), -ret);
+  }
+  ring_ok = true;
+
+  if (aio_io_uring_register_files) {
+    // Register a sparse table up front, spans are filled in as they are registered.
+    if ((ret = io_uring_register_files(&ring, fixed_fds, AIO_URING_MAX_FILES)) < 0) {
+      Debug("aio", "io_uring_register_files failed: %s (%d), not using registered files", strerror(-ret), -ret);
+      n_fixed = -1;
+    }
+  } else {
+    n_fixed = -1;
+  }
+}
+
+DiskHandler::~DiskHandler()
+{
+  if (ring_ok) {
+    io_uring_queue_exit(&ring);
+  }
+  ink_mutex_destroy(&remote_mutex);
+}
+
+void
+DiskHandler::sync_fixed_files()
+{
+  int count = aio_fixed_count.load(std::memory_order_acquire);
+  if (n_fixed < 0 || fixed_generation == count) {
+    return;
+  }
+  for (; n_fixed < count; ++n_fixed) {
+    int fd  = aio_fixed_fds[n_fixed];
+    int ret = io_uring_register_files_update(&ring, n_fixed, &fd, 1);
+    if (ret < 0) {
+      Debug("aio", "io_uring_register_files_update(%d) failed: %s (%d)", fd, strerror(-ret), -ret);
+      break;
+    }
+    fixed_fds[n_fixed] = fd;
+  }
+  fixed_generation = count;
+}
+
+int
+DiskHandler::fixed_index(int fd) const
+{
+  for (int i = 0; i < n_fixed; ++i) {
+    if (fixed_fds[i] == fd) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool
+DiskHandler::prep(AIOCallbackInternal *op)
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+  if (sqe == nullptr) {
+    return false;
+  }
+
+  // aio_result holds the bytes done so far, so a short transfer is resumed where it stopped.
+  ink_aiocb *a = &op->aiocb;
+  char *buf    = static_cast<char *>(a->aio_buf) + op->aio_result;
+  size_t len   = a->aio_nbytes - op->aio_result;
+  off_t offset = a->aio_offset + op->aio_result;
+  int idx      = fixed_index(a->aio_fildes);
+  int fd       = idx >= 0 ? idx : a->aio_fildes;
+
+  if (a->aio_lio_opcode == LIO_READ) {
+    io_uring_prep_read(sqe, fd, buf, len, offset);
+  } else {
+    io_uring_prep_write(sqe, fd, buf, len, offset);
+  }
+  // The kernel orders the queue only for the schedulers that honor priorities, in the best effort class.
+  sqe->ioprio = AIO_IOPRIO_BE(op->priority * 2);
+  if (idx >= 0) {
+    sqe->flags |= IOSQE_FIXED_FILE;
+  }
+  io_uring_sqe_set_data(sqe, op);
+  ++in_flight;
+  return true;
+}
+
+void
+DiskHandler::complete(AIOCallbackInternal *op)
+{
+  AIOCallbackInternal *head = op->aio_head;
+  if (--head->aio_pending > 0) {
+    return;
+  }
+
+  EThread *t  = trigger_event->ethread;
+  head->mutex = head->action.mutex;
+  if (head->thread != AIO_CALLBACK_THREAD_ANY && head->thread != AIO_CALLBACK_THREAD_AIO && head->thread != t) {
+    head->thread->schedule_imm(head);
+    return;
+  }
+  MUTEX_TRY_LOCK(lock, head->mutex, t);
+  if (!lock.is_locked()) {
+    t->schedule_imm(head);
+  } else {
+    head->handleEvent(EVENT_NONE, nullptr);
+  }
+}
+
+int
+DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  SET_HANDLER(&DiskHandler::mainAIOEvent);
+  e->schedule_every(AIO_PERIOD);
+  trigger_event = e;
+  // Completions post to the thread's eventfd, which wakes the network poll.
+#if HAVE_EVENTFD
+  io_uring_register_eventfd(&ring, e->ethread->evfd);
+#endif
+  return EVENT_CONT;
+}
+
+int
+DiskHandler::mainAIOEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  AIOCallback *op = nullptr;
+
+  if (!remote_list.empty()) {
+    ink_scoped_mutex_lock lock(remote_mutex);
+    while ((op = remote_list.dequeue()) != nullptr) {
+      ready_list.enqueue(op);
+    }
+  }
+
+  sync_fixed_files();
+
+  while ((op = ready_list.head) != nullptr) {
+    if (!prep(static_cast<AIOCallbackInternal *>(op))) {
+      break; // submission ring is full, the rest goes out on the next pass.
+    }
+    ready_list.dequeue();
+  }
+  if (in_flight > 0) {
+    io_uring_submit(&ring);
+  }
+
+  Que(AIOCallback, link) complete_list;
+  struct io_uring_cqe *cqes[MAX_AIO_EVENTS];
+  unsigned count;
+  while ((count = io_uring_peek_batch_cqe(&ring, cqes, MAX_AIO_EVENTS)) > 0) {
+    for (unsigned i = 0; i < count; ++i) {
+      auto *cb = static_cast<AIOCallbackInternal *>(io_uring_cqe_get_data(cqes[i]));
+      int res  = cqes[i]->res;
+      --in_flight;
+
+      if (res == -EINTR || res == -EAGAIN) {
+        ready_list.enqueue(cb);
+        continue;
+      }
+      if (res <= 0) {
+        if (res < 0) {
+          Warning("cache disk operation failed %s %d %d", (cb->aiocb.aio_lio_opcode == LIO_READ) ? "READ" : "WRITE", res, -res);
+        }
+        cb->aio_result = res < 0 ? res : cb->aio_result;
+        complete_list.enqueue(cb);
+        continue;
+      }
+      cb->aio_result += res;
+      if (cb->aio_result < static_cast<int64_t>(cb->aiocb.aio_nbytes)) {
+        ready_list.enqueue(cb); // short transfer, resubmit the remainder.
+      } else {
+        complete_list.enqueue(cb);
+      }
+    }
+    io_uring_cq_advance(&ring, count);
+  }
+
+  while ((op = complete_list.dequeue()) != nullptr) {
+    complete(static_cast<AIOCallbackInternal *>(op));
+  }
+  return EVENT_CONT;
+}
+
+static int
+aio_queue_uring(AIOCallback *op, int opcode)
+{
+  auto *head        = static_cast<AIOCallbackInternal *>(op);
+  head->aio_pending = 0;
+  // Only the head of a chain completes, with the callback.
+  AIO_PROBE_SUBMIT(head);
+
+  Que(AIOCallback, link) q;
+  for (AIOCallback *io = op; io; io = io->then) {
+    auto *cb                 = static_cast<AIOCallbackInternal *>(io);
+    cb->aiocb.aio_lio_opcode = opcode;
+    cb->aio_result           = 0;
+    cb->aio_head             = head;
+    cb->link.next            = nullptr;
+    cb->link.prev            = nullptr;
+    ++head->aio_pending;
+    if (opcode == LIO_WRITE) {
+      aio_num_write++;
+      aio_bytes_written += cb->aiocb.aio_nbytes;
+    } else {
+      aio_num_read++;
+      aio_bytes_read += cb->aiocb.aio_nbytes;
+    }
+    q.enqueue(cb);
+  }
+
+  EThread *t = this_ethread();
+  if (t && t->diskHandler) {
+    while ((op = q.dequeue()) != nullptr) {
+      t->diskHandler->ready_list.enqueue(op);
+    }
+    return 1;
+  }
+
+  // Not on a thread with a ring (e.g. a task thread or startup), hand it to an ET_NET thread.
+  static std::atomic<unsigned> next_thread{0};
+  int n_netthreads = eventProcessor.thread_group[ET_NET]._count;
+  ink_release_assert(n_netthreads > 0);
+  EThread *target = eventProcessor.thread_group[ET_NET]._thread[next_thread++ % n_netthreads];
+  ink_release_assert(target->diskHandler);
+  {
+    ink_scoped_mutex_lock lock(target->diskHandler->remote_mutex);
+    while ((op = q.dequeue()) != nullptr) {
+      target->diskHandler->remote_list.enqueue(op);
+    }
+  }
+  target->tail_cb->signalActivity();
+  return 1;
+}
+
+int
+ink_aio_read(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  return aio_queue_uring(op, LIO_READ);
+}
+
+int
+ink_aio_write(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  return aio_queue_uring(op, LIO_WRITE);
+}
+
+int
+ink_aio_readv(AIOCallback *op, int fromAPI)
+{
+  return ink_aio_read(op, fromAPI);
+}
+
+int
+ink_aio_writev(AIOCallback *op, int fromAPI)
+{
+  return ink_aio_write(op, fromAPI);
+}
+#endif // AIO_MODE == AIO_MODE_THREAD
@@ -40,9 +40,12 @@ static constexpr ts::ModuleVersion AIO_MODULE_PUBLIC_VERSION(1, 0, ts::ModuleVer
 
 #define AIO_MODE_THREAD 0
 #define AIO_MODE_NATIVE 1
+#define AIO_MODE_IO_URING 2
 
 #if TS_USE_LINUX_NATIVE_AIO
 #define AIO_MODE AIO_MODE_NATIVE
+#elif TS_USE_LINUX_IO_URING
+#define AIO_MODE AIO_MODE_IO_URING
 #else
 #define AIO_MODE AIO_MODE_THREAD
 #endif
@@ -77,7 +80,9 @@ struct ink_aiocb {
   int aio__pad[1];        /* extension padding */
 };
 
+#if AIO_MODE == AIO_MODE_THREAD
 bool ink_aio_thread_num_set(int thread_num);
+#endif
 
 #endif
 
@@ -85,12 +90,25 @@ bool ink_aio_thread_num_set(int thread_num);
 #define AIO_CALLBACK_THREAD_ANY ((EThread *)0) // any regular event thread
 #define AIO_CALLBACK_THREAD_AIO ((EThread *)-1)
 
+/** The I/O priority classes, in the order queued operations on a busy disk are started.
+    An operation of a lower class that has waited for AIO_PRIORITY_MAX_WAIT goes ahead of the
+    others, so background work is slowed down but never starved.
+ */
+enum AIOPriority {
+  AIO_PRIORITY_READ,     ///< Foreground reads of documents.
+  AIO_PRIORITY_WRITE,    ///< Aggregation writes, and the evacuation reads they wait for.
+  AIO_PRIORITY_EVACUATE, ///< Background evacuation reads.
+  AIO_PRIORITY_SYNC,     ///< Directory syncs.
+  AIO_PRIORITY_COUNT
+};
+
 struct AIOCallback : public Continuation {
   // set before calling aio_read/aio_write
   ink_aiocb aiocb;
   Action action;
-  EThread *thread   = AIO_CALLBACK_THREAD_ANY;
-  AIOCallback *then = nullptr;
+  EThread *thread      = AIO_CALLBACK_THREAD_ANY;
+  AIOCallback *then    = nullptr;
+  AIOPriority priority = AIO_PRIORITY_READ;
   // set on return from aio_read/aio_write
   int64_t aio_result = 0;
 
@@ -135,6 +153,50 @@ struct DiskHandler : public Continuation {
 };
 #endif
 
+#if AIO_MODE == AIO_MODE_IO_URING
+
+#include <liburing.h>
+
+#define MAX_AIO_EVENTS 1024
+#define AIO_URING_MAX_FILES 64
+
+struct AIOCallbackInternal;
+
+/** Per thread io_uring submission and completion for the cache disk path.
+
+    Operations issued on an EThread that owns a DiskHandler are queued on that thread's ring and
+    their completions are processed on the same thread, as part of the thread's polled (negative)
+    events. The ring's eventfd is the thread's @c evfd, so a completion wakes the thread out of its
+    network poll. Operations issued from a thread without a DiskHandler are handed to one of the
+    ET_NET threads through @c remote_list.
+ */
+struct DiskHandler : public Continuation {
+  Event *trigger_event = nullptr;
+  struct io_uring ring;
+  bool ring_ok = false;
+  Que(AIOCallback, link) ready_list;
+  ink_mutex remote_mutex;
+  Que(AIOCallback, link) remote_list; ///< Operations queued from other threads, under @c remote_mutex.
+  int in_flight = 0;                  ///< SQEs submitted and not yet completed.
+
+  /// Registered file table, see ink_aio_register_fd.
+  int fixed_fds[AIO_URING_MAX_FILES];
+  int n_fixed          = 0;
+  int fixed_generation = -1;
+
+  int startAIOEvent(int event, Event *e);
+  int mainAIOEvent(int event, Event *e);
+  DiskHandler();
+  ~DiskHandler() override;
+
+private:
+  void sync_fixed_files();
+  int fixed_index(int fd) const;
+  bool prep(AIOCallbackInternal *op);
+  void complete(AIOCallbackInternal *op);
+};
+#endif
+
 void ink_aio_init(ts::ModuleVersion version);
 int ink_aio_start();
 void ink_aio_set_callback(Continuation *error_callback);
@@ -145,4 +207,6 @@ int ink_aio_write(AIOCallback *op, int fromAPI = 0);
 int ink_aio_readv(AIOCallback *op,
                   int fromAPI = 0); // fromAPI is a boolean to indicate if this is from a API call such as upload proxy feature
 int ink_aio_writev(AIOCallback *op, int fromAPI = 0);
+/// Declare @a fd a long lived descriptor (a cache span) that AIO may register with the kernel.
+void ink_aio_register_fd(int fd);
 AIOCallback *new_AIOCallback();
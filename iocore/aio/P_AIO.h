@@ -32,6 +32,12 @@
 
 #include "P_EventSystem.h"
 #include "I_AIO.h"
+#include "ts/sdt.h"
+
+// The probe of a disk operation as it is submitted, its pointer pairs it with its aio_complete.
+#define AIO_PROBE_SUBMIT(_op)                                                                         \
+  ATS_PROBE4(aio_submit, _op, (_op)->aiocb.aio_fildes, static_cast<int64_t>((_op)->aiocb.aio_nbytes), \
+             static_cast<int64_t>((_op)->aiocb.aio_offset))
 
 // for debugging
 // #define AIO_STATS 1
@@ -74,13 +80,25 @@ AIOVec::mainEvent(int /* event */, Event *)
   return EVENT_ERROR;
 }
 
-#else /* AIO_MODE != AIO_MODE_NATIVE */
+#elif AIO_MODE == AIO_MODE_IO_URING
+
+struct AIOCallbackInternal : public AIOCallback {
+  AIOCallbackInternal *aio_head = nullptr; ///< First operation of the @c then chain, it receives the callback.
+  int aio_pending               = 0;       ///< On the head, operations of the chain still in flight.
+
+  int io_complete(int event, void *data);
+
+  AIOCallbackInternal() { SET_HANDLER(&AIOCallbackInternal::io_complete); }
+};
+
+#else /* AIO_MODE == AIO_MODE_THREAD */
 
 struct AIO_Reqs;
 
 struct AIOCallbackInternal : public AIOCallback {
   AIO_Reqs *aio_req     = nullptr;
   ink_hrtime sleep_time = 0;
+  ink_hrtime queued_at  = 0; /* when the request was queued, for AIO_PRIORITY_MAX_WAIT */
   SLINK(AIOCallbackInternal, alink); /* for AIO_Reqs::aio_temp_list */
 
   int io_complete(int event, void *data);
@@ -88,10 +106,12 @@ struct AIOCallbackInternal : public AIOCallback {
   AIOCallbackInternal() { SET_HANDLER(&AIOCallbackInternal::io_complete); }
 };
 
+#define AIO_PRIORITY_MAX_WAIT HRTIME_MSECONDS(100)
+
 struct AIO_Reqs {
-  Que(AIOCallback, link) aio_todo; /* queue for AIO operations */
-                                   /* Atomic list to temporarily hold the request if the
-                                      lock for a particular queue cannot be acquired */
+  Que(AIOCallback, link) aio_todo[AIO_PRIORITY_COUNT]; /* queues for AIO operations, one per priority class */
+  /* Atomic list to temporarily hold the request if the
+     lock for a particular queue cannot be acquired */
   ASLL(AIOCallbackInternal, alink) aio_temp_list;
   ink_mutex aio_mutex;
   ink_cond aio_cond;
@@ -100,6 +120,7 @@ struct AIO_Reqs {
   int queued          = 0; /* total number of aio_todo requests */
   int filedes         = 0; /* the file descriptor for the requests */
   int requests_queued = 0;
+  int background      = 0; /* evacuation and sync requests being served */
 };
 
 #endif // AIO_MODE == AIO_MODE_NATIVE
@@ -109,6 +130,7 @@ AIOCallbackInternal::io_complete(int event, void *data)
 {
   (void)event;
   (void)data;
+  ATS_PROBE2(aio_complete, this, aio_result);
   if (aio_err_callbck && !ok()) {
     AIOCallback *err_op          = new AIOCallbackInternal();
     err_op->aiocb.aio_fildes     = this->aiocb.aio_fildes;
@@ -147,6 +169,8 @@ enum aio_stat_enum {
   AIO_STAT_KB_READ_PER_SEC,
   AIO_STAT_WRITE_PER_SEC,
   AIO_STAT_KB_WRITE_PER_SEC,
+  AIO_STAT_BACKGROUND_READ_WAIT,
+  AIO_STAT_QUEUED,
   AIO_STAT_COUNT
 };
 extern RecRawStatBlock *aio_rsb;
@@ -38,6 +38,12 @@
 #include "tscore/hugepages.h"
 
 #include <atomic>
+#include <memory>
+#include <vector>
+
+#if HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 
 constexpr ts::VersionNumber CACHE_DB_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION);
 
@@ -58,30 +64,53 @@ static short int const CACHE_DB_MAJOR_VERSION_COMPATIBLE = 21;
 
 // Configuration
 
-int64_t cache_config_ram_cache_size            = AUTO_SIZE_RAM_CACHE;
-int cache_config_ram_cache_algorithm           = 1;
-int cache_config_ram_cache_compress            = 0;
-int cache_config_ram_cache_compress_percent    = 90;
-int cache_config_ram_cache_use_seen_filter     = 1;
-int cache_config_http_max_alts                 = 3;
-int cache_config_dir_sync_frequency            = 60;
-int cache_config_permit_pinning                = 0;
-int cache_config_select_alternate              = 1;
-int cache_config_max_doc_size                  = 0;
-int cache_config_min_average_object_size       = ESTIMATED_OBJECT_SIZE;
-int64_t cache_config_ram_cache_cutoff          = AGG_SIZE;
-int cache_config_max_disk_errors               = 5;
-int cache_config_hit_evacuate_percent          = 10;
-int cache_config_hit_evacuate_size_limit       = 0;
-int cache_config_force_sector_size             = 0;
-int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
-int cache_config_agg_write_backlog             = AGG_SIZE * 2;
-int cache_config_enable_checksum               = 0;
-int cache_config_alt_rewrite_max_size          = 4096;
-int cache_config_read_while_writer             = 0;
-int cache_config_mutex_retry_delay             = 2;
-int cache_read_while_writer_retry_delay        = 50;
-int cache_config_read_while_writer_max_retries = 10;
+int64_t cache_config_ram_cache_size             = AUTO_SIZE_RAM_CACHE;
+int cache_config_ram_cache_algorithm            = 1;
+int cache_config_ram_cache_compress             = 0;
+int cache_config_ram_cache_compress_percent     = 90;
+int cache_config_ram_cache_use_seen_filter      = 1;
+int cache_config_ram_cache_shards               = 1;
+int cache_config_ram_cache_persist_interval     = 0;
+int64_t cache_config_ram_cache_prefetch_rate    = 8388608;
+int cache_config_admission_min_requests         = 0;
+int cache_config_admission_counters             = 1048576;
+int cache_config_tier_promote_reads             = 2;
+int cache_config_tier_promote_ram_hits          = 1;
+int64_t cache_config_tier_max_doc_size          = 0;
+int cache_config_startup_ready_percent          = 100;
+int64_t cache_config_evacuate_background_window = 33554432;
+int64_t cache_config_evacuate_background_rate   = 8388608;
+int64_t cache_config_read_ahead_size            = 4194304;
+int64_t cache_config_read_ahead_min_object_size = 16777216;
+int64_t cache_config_agg_write_buffer_size      = AGG_SIZE;
+int cache_config_agg_write_buffers              = 1;
+int cache_config_span_stripes                   = 0;
+int64_t cache_config_span_min_stripe_size       = 17179869184;
+int cache_config_http_max_alts                  = 3;
+int cache_config_dir_sync_frequency             = 60;
+int cache_config_permit_pinning                 = 0;
+int cache_config_select_alternate               = 1;
+int cache_config_max_doc_size                   = 0;
+int cache_config_min_average_object_size        = ESTIMATED_OBJECT_SIZE;
+int64_t cache_config_ram_cache_cutoff           = AGG_SIZE;
+int cache_config_max_disk_errors                = 5;
+int cache_config_hit_evacuate_percent           = 10;
+int cache_config_hit_evacuate_size_limit        = 0;
+int cache_config_force_sector_size              = 0;
+int cache_config_target_fragment_size           = DEFAULT_TARGET_FRAGMENT_SIZE;
+int cache_config_target_fragment_size_max       = 0;
+int cache_config_agg_write_backlog              = AGG_SIZE * 2;
+int cache_config_enable_checksum                = 1;
+int cache_config_alt_rewrite_max_size           = 4096;
+int cache_config_read_while_writer              = 0;
+int cache_config_mutex_retry_delay              = 2;
+int cache_read_while_writer_retry_delay         = 50;
+int cache_config_read_while_writer_max_retries  = 10;
+int cache_config_read_while_writer_fill_wait    = 100;
+int cache_config_scan_rate                      = 131072;
+char cache_config_tag_header[256]               = "";
+int cache_config_tag_header_len                 = 0;
+int cache_config_tag_index_entries              = 1048576;
 
 // Globals
 
@@ -104,6 +133,8 @@ int CacheProcessor::auto_clear_flag      = 0;
 CacheProcessor cacheProcessor;
 Vol **gvol             = nullptr;
 std::atomic<int> gnvol = 0;
+// Volumes are added to gvol one at a time, and not while cacheInitialized() sets up the others.
+static ink_mutex gvol_mutex = PTHREAD_MUTEX_INITIALIZER;
 ClassAllocator<CacheVC> cacheVConnectionAllocator("cacheVConnection");
 ClassAllocator<EvacuationBlock> evacuationBlockAllocator("evacuationBlock");
 ClassAllocator<CacheRemoveCont> cacheRemoveContAllocator("cacheRemoveCont");
@@ -457,6 +488,19 @@ CacheVC::set_http_info(CacheHTTPInfo *ainfo)
     f.allow_empty_doc = 0;
   }
 
+  if (vol && vol->tags) {
+    uint64_t tags[CacheTagIndex::MAX_TAGS];
+    int ntags      = 0;
+    MIMEField *tag = ainfo->m_alt->m_response_hdr.field_find(cache_config_tag_header, cache_config_tag_header_len);
+    for (; tag; tag = tag->m_next_dup) {
+      int len           = 0;
+      const char *value = tag->value_get(&len);
+      ntags += CacheTagIndex::parse(std::string_view(value, len), tags + ntags, CacheTagIndex::MAX_TAGS - ntags);
+    }
+    // documents written again without tags are dropped from the index as well
+    CACHE_SUM_DYN_STAT(cache_tag_index_evicted_stat, vol->tags->insert(first_key, tags, ntags, vol));
+  }
+
   alternate.copy_shallow(ainfo);
   ainfo->clear();
 }
@@ -558,6 +602,33 @@ CacheProcessor::start(int, size_t)
 
 static const int DEFAULT_CACHE_OPTIONS = (O_RDWR);
 
+// The span of the memory volume @a config_vol, in an anonymous file of its size, -1 if it can not be made.
+static int
+open_memory_span(ConfigVol *config_vol, Span *sd)
+{
+  off_t skip = ROUND_TO_STORE_BLOCK(START_POS);
+
+  sd->blocks            = ((static_cast<int64_t>(config_vol->size) << 20) + skip) / STORE_BLOCK_SIZE;
+  sd->hw_sector_size    = STORE_BLOCK_SIZE;
+  sd->forced_volume_num = config_vol->number;
+  sd->pathname          = ats_strdup(("memory.volume_" + std::to_string(config_vol->number)).c_str());
+
+#if HAVE_MEMFD_CREATE
+  int fd = memfd_create(sd->pathname, MFD_CLOEXEC);
+  if (fd >= 0 && ftruncate(fd, sd->size()) < 0) {
+    close(fd);
+    fd = -1;
+  }
+  if (fd < 0) {
+    Warning("unable to allocate %" PRId64 " bytes for memory volume %d: %s", sd->size(), config_vol->number, strerror(errno));
+  }
+  return fd;
+#else
+  Warning("memory volume %d is not supported on this platform", config_vol->number);
+  return -1;
+#endif
+}
+
 int
 CacheProcessor::start_internal(int flags)
 {
@@ -574,7 +645,7 @@ CacheProcessor::start_internal(int flags)
   ink_assert((int)TS_EVENT_CACHE_SCAN_OPERATION_FAILED == (int)CACHE_EVENT_SCAN_OPERATION_FAILED);
   ink_assert((int)TS_EVENT_CACHE_SCAN_DONE == (int)CACHE_EVENT_SCAN_DONE);
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   int etype            = ET_NET;
   int n_netthreads     = eventProcessor.n_threads_for_type[etype];
   EThread **netthreads = eventProcessor.eventthread[etype];
@@ -590,9 +661,19 @@ CacheProcessor::start_internal(int flags)
   check                = (flags & PROCESSOR_CHECK) != 0;
   start_done           = 0;
 
+  config_volumes.read_config_file();
+
+  // The memory volumes each have a span of their own, after those of storage.config.
+  std::vector<std::unique_ptr<Span>> memory_spans;
+  for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+    if (config_vol->memory && !check) {
+      memory_spans.emplace_back(new Span);
+    }
+  }
+
   /* read the config file and create the data structures corresponding
      to the file */
-  gndisks = theCacheStore.n_disks;
+  gndisks = theCacheStore.n_disks + memory_spans.size();
   gdisks  = static_cast<CacheDisk **>(ats_malloc(gndisks * sizeof(CacheDisk *)));
 
   // Temporaries to carry values between loops
@@ -608,8 +689,6 @@ CacheProcessor::start_internal(int flags)
   gndisks = 0;
   ink_aio_set_callback(new AIO_Callback_handler());
 
-  config_volumes.read_config_file();
-
   /*
    create CacheDisk objects for each span in the configuration file and store in gdisks
    */
@@ -704,6 +783,25 @@ CacheProcessor::start_internal(int flags)
       close(fd);
     }
   }
+  int span_disks   = gndisks;
+  auto memory_span = memory_spans.begin();
+  for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+    if (!config_vol->memory || check) {
+      continue;
+    }
+    Span *sd = (memory_span++)->get();
+    int fd   = open_memory_span(config_vol, sd);
+    if (fd >= 0) {
+      paths[gndisks]                     = sd->pathname.get();
+      gdisks[gndisks]                    = new CacheDisk();
+      gdisks[gndisks]->memory            = true;
+      gdisks[gndisks]->forced_volume_num = sd->forced_volume_num;
+      sector_sizes[gndisks]              = sd->hw_sector_size;
+      fds[gndisks]                       = fd;
+      sds[gndisks]                       = sd;
+      gndisks++;
+    }
+  }
 
   // Before we kick off asynchronous operations, make sure sufficient disks are available and we don't just shutdown
   // Exiting with background threads in operation will likely cause a seg fault
@@ -722,15 +820,15 @@ CacheProcessor::start_internal(int flags)
       Warning("unable to open cache disk(s): Cache Disabled\n");
       return -1; // pointless, AFAICT this is ignored.
     }
-  } else if (this->waitForCache() == 3 && static_cast<unsigned int>(gndisks) < theCacheStore.n_disks_in_config) {
+  } else if (this->waitForCache() == 3 && static_cast<unsigned int>(span_disks) < theCacheStore.n_disks_in_config) {
     CacheProcessor::initialized = CACHE_INIT_FAILED;
     if (cb_after_init) {
       cb_after_init();
     }
-    Emergency("Cache initialization failed - only %d out of %d disks were valid and all were required.", gndisks,
+    Emergency("Cache initialization failed - only %d out of %d disks were valid and all were required.", span_disks,
               theCacheStore.n_disks_in_config);
-  } else if (this->waitForCache() == 2 && static_cast<unsigned int>(gndisks) < theCacheStore.n_disks_in_config) {
-    Warning("Cache initialization incomplete - only %d out of %d disks were valid.", gndisks, theCacheStore.n_disks_in_config);
+  } else if (this->waitForCache() == 2 && static_cast<unsigned int>(span_disks) < theCacheStore.n_disks_in_config) {
+    Warning("Cache initialization incomplete - only %d out of %d disks were valid.", span_disks, theCacheStore.n_disks_in_config);
   }
 
   // If we got here, we have enough disks to proceed
@@ -739,10 +837,12 @@ CacheProcessor::start_internal(int flags)
     ink_release_assert(sds[j] != nullptr); // Defeat clang-analyzer
     off_t skip     = ROUND_TO_STORE_BLOCK((sd->offset < START_POS ? START_POS + sd->alignment : sd->offset));
     int64_t blocks = sd->blocks - (skip >> STORE_BLOCK_SHIFT);
+    // A memory span starts out empty.
+    bool disk_clear = clear || gdisks[j]->memory;
 #if AIO_MODE == AIO_MODE_NATIVE
-    eventProcessor.schedule_imm(new DiskInit(gdisks[j], paths[j], blocks, skip, sector_sizes[j], fds[j], clear));
+    eventProcessor.schedule_imm(new DiskInit(gdisks[j], paths[j], blocks, skip, sector_sizes[j], fds[j], disk_clear));
 #else
-    gdisks[j]->open(paths[j], blocks, skip, sector_sizes[j], fds[j], clear);
+    gdisks[j]->open(paths[j], blocks, skip, sector_sizes[j], fds[j], disk_clear);
 #endif
 
     Debug("cache_hosting", "Disk: %d:%s, blocks: %" PRId64 "", gndisks, paths[j], blocks);
@@ -818,6 +918,11 @@ CacheProcessor::diskInitialized()
     CacheVol *cp = cp_list.head;
     for (; cp; cp = cp->link.next) {
       cp->vol_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+      for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+        if (config_vol->cachep == cp) {
+          cp->tier = config_vol->tier;
+        }
+      }
       char vol_stat_str_prefix[256];
       snprintf(vol_stat_str_prefix, sizeof(vol_stat_str_prefix), "proxy.process.cache.volume_%d", cp->vol_number);
       register_cache_stats(cp->vol_rsb, vol_stat_str_prefix);
@@ -858,6 +963,58 @@ CacheProcessor::diskInitialized()
   }
 }
 
+static RamCache *
+new_vol_ram_cache()
+{
+  if (cache_config_ram_cache_shards > 1) {
+    return new_RamCacheSharded(cache_config_ram_cache_algorithm, cache_config_ram_cache_shards);
+  }
+  switch (cache_config_ram_cache_algorithm) {
+  default:
+  case RAM_CACHE_ALGORITHM_CLFUS:
+    return new_RamCacheCLFUS();
+  case RAM_CACHE_ALGORITHM_LRU:
+    return new_RamCacheLRU();
+  }
+}
+
+// A vol recovered after the cache started serving from the others gets what cacheInitialized()
+// gave those, its share of the RAM cache and its part of the totals.
+static void
+vol_late_initialized(Vol *vol)
+{
+  ProxyMutex *mutex = this_ethread()->mutex.get();
+
+  vol->ram_cache = new_vol_ram_cache();
+  if (vol->cache_vol->ramcache_enabled) {
+    int64_t ram_cache_bytes = vol->dirlen() * DEFAULT_RAM_CACHE_MULTIPLIER;
+    if (cache_config_ram_cache_size != AUTO_SIZE_RAM_CACHE) {
+      ram_cache_bytes = static_cast<int64_t>(cache_config_ram_cache_size *
+                                             (static_cast<double>(vol->len >> STORE_BLOCK_SHIFT) / vol->cache->cache_size));
+    }
+    vol->ram_cache->init(ram_cache_bytes, vol);
+    CACHE_VOL_SUM_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
+  }
+
+  uint64_t total_cache_bytes = vol->len - vol->dirlen();
+  uint64_t total_direntries  = vol->buckets * vol->segments * DIR_DEPTH;
+  uint64_t used_direntries   = dir_entries_used(vol);
+  CACHE_VOL_SUM_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
+  CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, total_direntries);
+  CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, used_direntries);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_direntries_total_stat, total_direntries);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_direntries_used_stat, used_direntries);
+
+  if (vol->header->version < cacheProcessor.min_stripe_version) {
+    cacheProcessor.min_stripe_version = vol->header->version;
+  }
+  if (cacheProcessor.max_stripe_version < vol->header->version) {
+    cacheProcessor.max_stripe_version = vol->header->version;
+  }
+}
+
 void
 CacheProcessor::cacheInitialized()
 {
@@ -921,15 +1078,7 @@ CacheProcessor::cacheInitialized()
     if (gnvol) {
       // new ram_caches, with algorithm from the config
       for (i = 0; i < gnvol; i++) {
-        switch (cache_config_ram_cache_algorithm) {
-        default:
-        case RAM_CACHE_ALGORITHM_CLFUS:
-          gvol[i]->ram_cache = new_RamCacheCLFUS();
-          break;
-        case RAM_CACHE_ALGORITHM_LRU:
-          gvol[i]->ram_cache = new_RamCacheLRU();
-          break;
-        }
+        gvol[i]->ram_cache = new_vol_ram_cache();
       }
       // let us calculate the Size
       if (cache_config_ram_cache_size == AUTO_SIZE_RAM_CACHE) {
@@ -1023,16 +1172,43 @@ CacheProcessor::cacheInitialized()
       case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
         Fatal("lzma not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+        Fatal("lz4 not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+        Fatal("zstd not available for RAM cache compression");
 #endif
         break;
       }
 
+      // Admission filters are per volume, each counts the misses of the documents stored in it.
+      for (CacheVol *cp = cp_list.head; cp; cp = cp->link.next) {
+        int min_requests = cache_config_admission_min_requests;
+        for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+          if (config_vol->cachep == cp && config_vol->admission_min_requests >= 0) {
+            min_requests = config_vol->admission_min_requests;
+          }
+        }
+        if (min_requests > 1) {
+          cp->admission = new CacheAdmissionFilter(cache_config_admission_counters, min_requests);
+          Debug("cache_init", "volume %d admits documents after %d requests", cp->vol_number, min_requests);
+        }
+      }
+
+      cache_tier = CacheTier::create();
+
       GLOBAL_CACHE_SET_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_total_stat, total_direntries);
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_used_stat, used_direntries);
       if (!check) {
         dir_sync_init();
+        ram_cache_persist_init();
       }
       cache_init_ok = 1;
     } else {
@@ -1121,6 +1297,12 @@ CacheProcessor::scan(Continuation *cont, char *hostname, int host_len, int KB_pe
   return caches[CACHE_FRAG_TYPE_HTTP]->scan(cont, hostname, host_len, KB_per_second);
 }
 
+Action *
+CacheProcessor::scan_parallel(Continuation *cont, int flags, int KB_per_second)
+{
+  return caches[CACHE_FRAG_TYPE_HTTP]->scan_parallel(cont, flags, KB_per_second);
+}
+
 int
 CacheProcessor::IsCacheEnabled()
 {
@@ -1269,6 +1451,14 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   // successive approximation, directory/meta data eats up some storage
   start = dir_skip;
   vol_init_data(this);
+  delete[] dir_segment_seq;
+  dir_segment_seq = new std::atomic<uint32_t>[segments]();
+  // Nothing is known about either on-disk copy yet, the first sync of each writes it whole.
+  delete[] dir_segment_dirty;
+  dir_segment_dirty = new std::atomic<uint8_t>[segments];
+  for (int i = 0; i < segments; ++i) {
+    dir_segment_dirty[i].store(DIR_SYNC_ALL_COPIES, std::memory_order_relaxed);
+  }
   data_blocks         = (len - (start - skip)) / STORE_BLOCK_SIZE;
   hit_evacuate_window = (data_blocks * cache_config_hit_evacuate_percent) / 100;
 
@@ -1291,6 +1481,8 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   dir    = reinterpret_cast<Dir *>(raw_dir + this->headerlen());
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+  // The hosting tables can place documents on this vol from now on, see Cache::vol_initialized().
+  ink_atomic_increment(&cache->total_started_vol, 1);
 
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
@@ -1537,7 +1729,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
              sync serial and less than (header->sync_serial + 2) then
              continue;
 
-             3. If the position we are recovering from is within AGG_SIZE
+             3. If the position we are recovering from is within agg_size
              from the disk end, then we can't trust this document. The
              aggregation buffer might have been larger than the remaining space
              at the end and we decided to wrap around instead of writing
@@ -1559,7 +1751,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
           // (doc->sync_serial < last_sync_serial) ||
           // (doc->sync_serial > header->sync_serial + 1).
           // if we are too close to the end, wrap around
-          else if (recover_pos - (e - s) > (skip + len) - AGG_SIZE) {
+          else if (recover_pos - (e - s) > (skip + len) - agg_size) {
             recover_wrapped     = true;
             recover_pos         = start;
             io.aiocb.aio_nbytes = RECOVERY_SIZE;
@@ -1571,10 +1763,10 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
           goto Ldone;
         } else {
           // doc->magic != DOC_MAGIC
-          // If we are in the danger zone - recover_pos is within AGG_SIZE
+          // If we are in the danger zone - recover_pos is within agg_size
           // from the end, then wrap around
           recover_pos -= e - s;
-          if (recover_pos > (skip + len) - AGG_SIZE) {
+          if (recover_pos > (skip + len) - agg_size) {
             recover_wrapped     = true;
             recover_pos         = start;
             io.aiocb.aio_nbytes = RECOVERY_SIZE;
@@ -1777,10 +1969,18 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
-    int vol_no = gnvol++;
+    ink_scoped_mutex_lock lock(gvol_mutex);
+    int vol_no = gnvol;
     ink_assert(!gvol[vol_no]);
     gvol[vol_no] = this;
+    gnvol        = vol_no + 1;
     SET_HANDLER(&Vol::aggWrite);
+    if (CacheProcessor::initialized == CACHE_INITIALIZED) {
+      vol_late_initialized(this);
+    }
+    tags  = CacheTagIndex::open(this);
+    ready = true;
+    start_background_evacuation();
     if (fd == -1) {
       cache->vol_initialized(false);
     } else {
@@ -1926,7 +2126,18 @@ Cache::vol_initialized(bool result)
   if (result) {
     ink_atomic_increment(&total_good_nvol, 1);
   }
-  if (total_nvol == ink_atomic_increment(&total_initialized_vol, 1) + 1) {
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_startup_volumes_recovered_stat, 1);
+  int initialized = ink_atomic_increment(&total_initialized_vol, 1) + 1;
+  if (ready != CACHE_INITIALIZING) {
+    // serving from the vols recovered earlier already
+    if (total_nvol == initialized) {
+      Note("all %d cache volumes recovered", total_nvol);
+    }
+    return;
+  }
+  // Vols still recovering are in the hosting tables, their documents miss until they are ready.
+  if (total_nvol == initialized ||
+      (total_started_vol == total_nvol && total_good_nvol * 100 >= total_nvol * cache_config_startup_ready_percent)) {
     open_done();
   }
 }
@@ -2104,7 +2315,8 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
             cp->vols[vol_no]->cache_vol = cp;
             blocks                      = q->b->len;
 
-            bool vol_clear = clear || d->cleared || q->new_block;
+            // the tier does not survive restarts, see CacheTier.cc
+            bool vol_clear = clear || d->cleared || q->new_block || cp->tier || d->memory;
 #if AIO_MODE == AIO_MODE_NATIVE
             eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
 #else
@@ -2118,6 +2330,7 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
       total_nvol += vol_no;
     }
   }
+  GLOBAL_CACHE_SET_DYN_STAT(cache_startup_volumes_total_stat, total_nvol);
   if (total_nvol == 0) {
     return open_done();
   }
@@ -2146,7 +2359,7 @@ CacheVC::is_pread_capable()
 
 #define STORE_COLLISION 1
 
-static void
+void
 unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
 {
   using UnmarshalFunc           = int(char *buf, int len, RefCountObj *block_ref);
@@ -2237,20 +2450,15 @@ CacheVC::handleReadDone(int event, Event *e)
       if (!f.doc_from_ram_cache) {
         f.not_from_ram_cache = 1;
       }
-      if (cache_config_enable_checksum && doc->checksum != DOC_NO_CHECKSUM) {
-        // verify that the checksum matches
-        uint32_t checksum = 0;
-        for (char *b = doc->hdr(); b < reinterpret_cast<char *>(doc) + doc->len; b++) {
-          checksum += *b;
-        }
-        ink_assert(checksum == doc->checksum);
-        if (checksum != doc->checksum) {
-          Note("cache: checksum error for [%" PRIu64 " %" PRIu64 "] len %d, hlen %d, disk %s, offset %" PRIu64 " size %zu",
-               doc->first_key.b[0], doc->first_key.b[1], doc->len, doc->hlen, vol->path, (uint64_t)io.aiocb.aio_offset,
-               (size_t)io.aiocb.aio_nbytes);
-          doc->magic = DOC_CORRUPT;
-          okay       = 0;
-        }
+      if (cache_config_enable_checksum && !doc->checksum_ok()) {
+        Note("cache: checksum error for [%" PRIu64 " %" PRIu64 "] len %d, hlen %d, disk %s, offset %" PRIu64 " size %zu",
+             doc->first_key.b[0], doc->first_key.b[1], doc->len, doc->hlen, vol->path, (uint64_t)io.aiocb.aio_offset,
+             (size_t)io.aiocb.aio_nbytes);
+        CACHE_INCREMENT_DYN_STAT(cache_checksum_mismatch_stat);
+        // the fragment is not read again, the readers of the document give up on it
+        dir_delete(read_key, vol, &dir);
+        doc->magic = DOC_CORRUPT;
+        okay       = 0;
       }
       (void)e; // Avoid compiler warnings
       bool http_copy_hdr = false;
@@ -2304,6 +2512,20 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 
   f.doc_from_ram_cache = false;
 
+  // check the fragments read ahead
+  if (read_ahead.head) {
+    if (CacheReadAhead *ra = read_ahead_find()) {
+      SET_HANDLER(&CacheVC::handleReadDone);
+      if (!ra->done) {
+        ra->waited          = true;
+        io.aiocb.aio_fildes = vol->fd; // in progress until ra completes
+        return EVENT_CONT;
+      }
+      read_ahead_take(ra);
+      return EVENT_RETURN;
+    }
+  }
+
   // check ram cache
   ink_assert(vol->mutex->thread_holding == this_ethread());
   int64_t o           = dir_offset(&dir);
@@ -2320,11 +2542,9 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    buf       = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = vol->agg_data(vol->vol_offset(&dir), io.aiocb.aio_nbytes);
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -2369,7 +2589,11 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
-  Vol *vol          = key_to_vol(key, hostname, host_len);
+  Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_LOOKUP_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
   ProxyMutex *mutex = cont->mutex.get();
   CacheVC *c        = new_CacheVC(cont);
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
@@ -2481,14 +2705,23 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
-  Ptr<ProxyMutex> mutex;
   if (!cont) {
     cont = new_CacheRemoveCont();
   }
 
+  return remove_from(cont, key_to_vol(key, hostname, host_len), key, type);
+}
+
+Action *
+Cache::remove_from(Continuation *cont, Vol *vol, const CacheKey *key, CacheFragType type)
+{
+  Ptr<ProxyMutex> mutex;
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_REMOVE_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2686,9 +2919,10 @@ fillExclusiveDisks(CacheVol *cp)
     /* Now, volumes have been either deleted or did not exist to begin with so we need to create them. */
 
     int64_t size_diff = gdisks[i]->num_usable_blocks;
+    int made          = 0;
     DiskVolBlock *dpb;
     do {
-      dpb = gdisks[i]->create_volume(volume_number, size_diff, cp->scheme);
+      dpb = gdisks[i]->create_volume(volume_number, gdisks[i]->stripe_blocks(size_diff, made++), cp->scheme);
       if (dpb) {
         if (!cp->disk_vols[i]) {
           cp->disk_vols[i] = gdisks[i]->get_diskvol(volume_number);
@@ -2735,6 +2969,7 @@ cplist_reconfigure()
       if (gdisks[i]->cleared) {
         uint64_t free_space = gdisks[i]->free_space * STORE_BLOCK_SIZE;
         int vols            = (free_space / MAX_VOL_SIZE) + 1;
+        vols                = std::max<int64_t>(vols, std::min<int64_t>(gdisks[i]->stripes, free_space / VOL_BLOCK_SIZE));
         for (int p = 0; p < vols; p++) {
           off_t b = gdisks[i]->free_space / (vols - p);
           Debug("cache_hosting", "blocks = %" PRId64, (int64_t)b);
@@ -2997,8 +3232,8 @@ create_volume(int volume_number, off_t size_in_blocks, int scheme, CacheVol *cp)
   curr_vol       = i;
   for (i = 0; i < gndisks; i++) {
     if (sp[i] > 0) {
-      while (sp[i] > 0) {
-        DiskVolBlock *p = gdisks[i]->create_volume(volume_number, sp[i], scheme);
+      for (int made = 0; sp[i] > 0; made++) {
+        DiskVolBlock *p = gdisks[i]->create_volume(volume_number, gdisks[i]->stripe_blocks(sp[i], made), scheme);
         ink_assert(p && (p->len >= (unsigned int)blocks_per_vol));
         sp[i] -= p->len;
         cp->num_vols++;
@@ -3085,6 +3320,27 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("ram_cache.bytes_used", cache_ram_cache_bytes_stat);
   REG_INT("ram_cache.hits", cache_ram_cache_hits_stat);
   REG_INT("ram_cache.misses", cache_ram_cache_misses_stat);
+  REG_INT("ram_cache.compress.bytes_in", cache_ram_cache_compress_bytes_in_stat);
+  REG_INT("ram_cache.compress.bytes_out", cache_ram_cache_compress_bytes_out_stat);
+  REG_INT("ram_cache.compress.time", cache_ram_cache_compress_time_stat);
+  REG_INT("ram_cache.decompress.time", cache_ram_cache_decompress_time_stat);
+  REG_INT("ram_cache.prefetch.objects", cache_ram_cache_prefetch_objects_stat);
+  REG_INT("ram_cache.prefetch.bytes", cache_ram_cache_prefetch_bytes_stat);
+  REG_INT("admission.admitted", cache_admission_admitted_stat);
+  REG_INT("admission.rejected", cache_admission_rejected_stat);
+  REG_INT("tier.hits", cache_tier_hits_stat);
+  REG_INT("tier.promote.active", cache_tier_promote_active_stat);
+  REG_INT("tier.promote.success", cache_tier_promote_success_stat);
+  REG_INT("tier.promote.failure", cache_tier_promote_failure_stat);
+  REG_INT("tag_index.evicted", cache_tag_index_evicted_stat);
+  REG_INT("tag_index.invalidated", cache_tag_index_invalidated_stat);
+  REG_INT("startup.volumes_total", cache_startup_volumes_total_stat);
+  REG_INT("startup.volumes_recovered", cache_startup_volumes_recovered_stat);
+  REG_INT("evacuate.bytes", cache_evacuate_bytes_stat);
+  REG_INT("evacuate.background.bytes", cache_evacuate_background_bytes_stat);
+  REG_INT("read_ahead.bytes", cache_read_ahead_bytes_stat);
+  REG_INT("read_ahead.wasted", cache_read_ahead_wasted_stat);
+  REG_INT("read_while_writer.fill", cache_read_while_writer_fill_stat);
   REG_INT("pread_count", cache_pread_count_stat);
   REG_INT("percent_full", cache_percent_full_stat);
   REG_INT("lookup.active", cache_lookup_active_stat);
@@ -3093,6 +3349,8 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("read.active", cache_read_active_stat);
   REG_INT("read.success", cache_read_success_stat);
   REG_INT("read.failure", cache_read_failure_stat);
+  REG_INT("read.lockless_miss", cache_read_lockless_miss_stat);
+  REG_INT("checksum.mismatch", cache_checksum_mismatch_stat);
   REG_INT("write.active", cache_write_active_stat);
   REG_INT("write.success", cache_write_success_stat);
   REG_INT("write.failure", cache_write_failure_stat);
@@ -3115,8 +3373,11 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("frags_per_doc.1", cache_single_fragment_document_count_stat);
   REG_INT("frags_per_doc.2", cache_two_fragment_document_count_stat);
   REG_INT("frags_per_doc.3+", cache_three_plus_plus_fragment_document_count_stat);
+  REG_INT("write.fragments", cache_write_fragments_stat);
+  REG_INT("write.large_fragment_docs", cache_write_large_fragment_document_stat);
   REG_INT("read_busy.success", cache_read_busy_success_stat);
   REG_INT("read_busy.failure", cache_read_busy_failure_stat);
+  REG_INT("lock_retry", cache_lock_retry_stat);
   REG_INT("write_bytes_stat", cache_write_bytes_stat);
   REG_INT("vector_marshals", cache_hdr_vector_marshal_stat);
   REG_INT("hdr_marshals", cache_hdr_marshal_stat);
@@ -3161,6 +3422,23 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_shards, "proxy.config.cache.ram_cache.shards");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_persist_interval, "proxy.config.cache.ram_cache.persist.interval");
+  REC_EstablishStaticConfigInteger(cache_config_ram_cache_prefetch_rate, "proxy.config.cache.ram_cache.persist.prefetch_rate");
+  REC_EstablishStaticConfigInt32(cache_config_admission_min_requests, "proxy.config.cache.admission.min_requests");
+  REC_EstablishStaticConfigInt32(cache_config_admission_counters, "proxy.config.cache.admission.counters");
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_reads, "proxy.config.cache.tier.promote_reads");
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_ram_hits, "proxy.config.cache.tier.promote_ram_hits");
+  REC_EstablishStaticConfigInteger(cache_config_tier_max_doc_size, "proxy.config.cache.tier.max_doc_size");
+  REC_EstablishStaticConfigInt32(cache_config_startup_ready_percent, "proxy.config.cache.startup.ready_percent");
+  REC_EstablishStaticConfigInteger(cache_config_evacuate_background_window, "proxy.config.cache.evacuate.background.window");
+  REC_EstablishStaticConfigInteger(cache_config_evacuate_background_rate, "proxy.config.cache.evacuate.background.rate");
+  REC_EstablishStaticConfigInteger(cache_config_read_ahead_size, "proxy.config.cache.read_ahead.size");
+  REC_EstablishStaticConfigInteger(cache_config_read_ahead_min_object_size, "proxy.config.cache.read_ahead.min_object_size");
+  REC_EstablishStaticConfigInteger(cache_config_agg_write_buffer_size, "proxy.config.cache.agg_write.buffer_size");
+  REC_EstablishStaticConfigInt32(cache_config_agg_write_buffers, "proxy.config.cache.agg_write.buffers");
+  REC_EstablishStaticConfigInt32(cache_config_span_stripes, "proxy.config.cache.span.stripes");
+  REC_EstablishStaticConfigInteger(cache_config_span_min_stripe_size, "proxy.config.cache.span.min_stripe_size");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3191,6 +3469,18 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_read_while_writer_retry_delay, "proxy.config.cache.read_while_writer_retry.delay");
   Debug("cache_init", "proxy.config.cache.read_while_writer_retry.delay = %dms", cache_read_while_writer_retry_delay);
 
+  REC_EstablishStaticConfigInt32(cache_config_read_while_writer_fill_wait, "proxy.config.cache.read_while_writer.fill_wait");
+  Debug("cache_init", "proxy.config.cache.read_while_writer.fill_wait = %dms", cache_config_read_while_writer_fill_wait);
+
+  REC_EstablishStaticConfigInt32(cache_config_scan_rate, "proxy.config.cache.scan_rate");
+  Debug("cache_init", "proxy.config.cache.scan_rate = %dKB/s", cache_config_scan_rate);
+
+  REC_ReadConfigString(cache_config_tag_header, "proxy.config.cache.tag_index.header", sizeof(cache_config_tag_header));
+  cache_config_tag_header_len = strlen(cache_config_tag_header);
+  REC_EstablishStaticConfigInt32(cache_config_tag_index_entries, "proxy.config.cache.tag_index.entries");
+  Debug("cache_init", "proxy.config.cache.tag_index.header = '%s', %d entries", cache_config_tag_header,
+        cache_config_tag_index_entries);
+
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_percent, "proxy.config.cache.hit_evacuate_percent");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_percent = %d", cache_config_hit_evacuate_percent);
 
@@ -3206,6 +3496,7 @@ ink_cache_init(ts::ModuleVersion v)
   if (cache_config_target_fragment_size == 0 || cache_config_target_fragment_size - sizeof(Doc) > MAX_FRAG_SIZE) {
     cache_config_target_fragment_size = DEFAULT_TARGET_FRAGMENT_SIZE;
   }
+  REC_EstablishStaticConfigInt32(cache_config_target_fragment_size_max, "proxy.config.cache.target_fragment_size_max");
 
   REC_EstablishStaticConfigInt32(cache_config_max_disk_errors, "proxy.config.cache.max_disk_errors");
   Debug("cache_init", "proxy.config.cache.max_disk_errors = %d", cache_config_max_disk_errors);
@@ -3259,6 +3550,37 @@ CacheProcessor::remove(Continuation *cont, const HttpCacheKey *key, CacheFragTyp
   return caches[frag_type]->remove(cont, &key->hash, frag_type, key->hostname, key->hostlen);
 }
 
+bool
+CacheProcessor::maybe_cached(const HttpCacheKey *key)
+{
+  if (CACHE_INITIALIZED != initialized) {
+    return false;
+  }
+
+  Vol *vol = caches[CACHE_FRAG_TYPE_HTTP]->key_to_vol(&key->hash, key->hostname, key->hostlen);
+  return vol->ready && vol->maybe_contains(&key->hash);
+}
+
+bool
+CacheProcessor::admit(const HttpCacheKey *key)
+{
+  if (CACHE_INITIALIZED != initialized) {
+    return true;
+  }
+
+  Vol *vol = caches[CACHE_FRAG_TYPE_HTTP]->key_to_vol(&key->hash, key->hostname, key->hostlen);
+  if (vol->cache_vol->admission == nullptr) {
+    return true;
+  }
+
+  if (vol->cache_vol->admission->admit(key->hash)) {
+    CACHE_SUM_DYN_STAT_THREAD(cache_admission_admitted_stat, 1);
+    return true;
+  }
+  CACHE_SUM_DYN_STAT_THREAD(cache_admission_rejected_stat, 1);
+  return false;
+}
+
 CacheDisk *
 CacheProcessor::find_by_path(const char *path, int len)
 {
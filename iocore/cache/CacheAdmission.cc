@@ -0,0 +1,127 @@
+/** @file
+
+  TinyLFU admission filter for cache writes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_CacheAdmission.h"
+
+#include <algorithm>
+
+CacheAdmissionFilter::CacheAdmissionFilter(uint32_t counters, int min_requests) : _min_requests(min_requests)
+{
+  uint32_t width = 64;
+  while (width < counters && width < MAX_WIDTH) {
+    width <<= 1;
+  }
+  _mask            = width - 1;
+  _doorkeeper_mask = (static_cast<uint64_t>(width) << DOORKEEPER_BITS_LN) - 1;
+  _sample_size     = static_cast<uint64_t>(width) * SAMPLE_MULTIPLIER;
+  _counters.reset(new std::atomic<uint8_t>[static_cast<size_t>(width) * DEPTH]());
+  _doorkeeper.reset(new std::atomic<uint64_t>[(_doorkeeper_mask + 1) / 64]());
+}
+
+// The keys are cryptographic hashes, so splitting them gives independent indexes.
+size_t
+CacheAdmissionFilter::_counter_index(const CryptoHash &key, int row) const
+{
+  return static_cast<size_t>(row) * (_mask + 1) + (((key.u64[0] + row * (key.u64[1] | 1)) >> 16) & _mask);
+}
+
+uint64_t
+CacheAdmissionFilter::_doorkeeper_bit(const CryptoHash &key, int probe) const
+{
+  return ((key.u64[1] + probe * (key.u64[0] | 1)) >> 8) & _doorkeeper_mask;
+}
+
+bool
+CacheAdmissionFilter::_doorkeeper_contains(const CryptoHash &key) const
+{
+  for (int probe = 0; probe < DOORKEEPER_PROBES; ++probe) {
+    uint64_t bit = _doorkeeper_bit(key, probe);
+    if (!(_doorkeeper[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+CacheAdmissionFilter::_sketch_estimate(const CryptoHash &key) const
+{
+  int count = MAX_COUNT;
+  for (int row = 0; row < DEPTH; ++row) {
+    count = std::min<int>(count, _counters[_counter_index(key, row)].load(std::memory_order_relaxed));
+  }
+  return count;
+}
+
+int
+CacheAdmissionFilter::estimate(const CryptoHash &key) const
+{
+  if (!_doorkeeper_contains(key)) {
+    return 0;
+  }
+  return _sketch_estimate(key) + 1;
+}
+
+bool
+CacheAdmissionFilter::admit(const CryptoHash &key)
+{
+  int requests = 1;
+
+  if (!_doorkeeper_contains(key)) {
+    for (int probe = 0; probe < DOORKEEPER_PROBES; ++probe) {
+      uint64_t bit = _doorkeeper_bit(key, probe);
+      _doorkeeper[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+    }
+  } else {
+    // Conservative update, only the counters at the minimum grow, which keeps the estimates of
+    // keys sharing the other counters from being inflated.
+    int count = _sketch_estimate(key);
+    if (count < MAX_COUNT) {
+      for (int row = 0; row < DEPTH; ++row) {
+        std::atomic<uint8_t> &counter = _counters[_counter_index(key, row)];
+        uint8_t expected              = count;
+        counter.compare_exchange_strong(expected, count + 1, std::memory_order_relaxed);
+      }
+    }
+    requests = count + 2;
+  }
+
+  // Exactly one caller sees any given count, so exactly one ages the filter each time it fills.
+  if (_requests.fetch_add(1, std::memory_order_relaxed) + 1 == _sample_size) {
+    _age();
+  }
+
+  return requests >= _min_requests;
+}
+
+void
+CacheAdmissionFilter::_age()
+{
+  for (size_t i = 0, n = static_cast<size_t>(_mask + 1) * DEPTH; i < n; ++i) {
+    _counters[i].store(_counters[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+  }
+  for (size_t i = 0, n = (_doorkeeper_mask + 1) / 64; i < n; ++i) {
+    _doorkeeper[i].store(0, std::memory_order_relaxed);
+  }
+  _requests.fetch_sub(_sample_size / 2, std::memory_order_relaxed);
+}
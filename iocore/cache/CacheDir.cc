@@ -98,13 +98,26 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   od->move_resident_alt     = false;
   od->reading_vec           = false;
   od->writing_vec           = false;
+  od->fill_waiters.clear();
+  od->fill_pos = 0;
   dir_clear(&od->first_dir);
   cont->od           = od;
   cont->write_vector = &od->vector;
   bucket[b].push(od);
+  bucket_entries[b].fetch_add(1, std::memory_order_release);
   return 1;
 }
 
+/*
+   Tell, without the volume lock, whether a writer may have @a key open.
+   A false result held at some point during the call.
+   */
+bool
+OpenDir::maybe_open(const CryptoHash *key) const
+{
+  return bucket_entries[key->slice32(0) % OPEN_DIR_BUCKETS].load(std::memory_order_acquire) != 0;
+}
+
 int
 OpenDir::signal_readers(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -137,13 +150,19 @@ OpenDir::close_write(CacheVC *cont)
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
   cont->od->writers.remove(cont);
   cont->od->num_writers--;
+  // the readers of this writer find it done
+  cont->od->fill_wake(cont->mutex->thread_holding);
   if (!cont->od->writers.head) {
     unsigned int h = cont->first_key.slice32(0);
     int b          = h % OPEN_DIR_BUCKETS;
     bucket[b].remove(cont->od);
+    bucket_entries[b].fetch_sub(1, std::memory_order_release);
     delayed_readers.append(cont->od->readers);
     signal_readers(0, nullptr);
     cont->od->vector.clear();
+    for (auto &data : cont->od->fill) {
+      data.clear();
+    }
     THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
   cont->od = nullptr;
@@ -174,6 +193,35 @@ OpenDirEntry::wait(CacheVC *cont, int msec)
   return EVENT_CONT;
 }
 
+IOBufferData *
+OpenDirEntry::fill_find(const CacheKey *key)
+{
+  for (auto &data : fill) {
+    if (data && reinterpret_cast<Doc *>(data->data())->key == *key) {
+      return data.get();
+    }
+  }
+  return nullptr;
+}
+
+/*
+   Wake the readers waiting for a fragment, those busy on another thread
+   still have their retry timer.
+   */
+void
+OpenDirEntry::fill_wake(EThread *t)
+{
+  CacheVC *c = nullptr;
+  while ((c = fill_waiters.dequeue())) {
+    c->fill_wait = nullptr;
+    CACHE_TRY_LOCK(lock, c->mutex, t);
+    if (lock.is_locked()) {
+      c->cancel_trigger();
+      c->trigger = t->schedule_imm_local(c, EVENT_INTERVAL);
+    }
+  }
+}
+
 //
 // Cache Directory
 //
@@ -214,6 +262,7 @@ dir_bucket_loop_check(Dir *start_dir, Dir *seg)
 void
 dir_init_segment(int s, Vol *d)
 {
+  DirSegmentWriteGuard guard(d, s);
   d->header->freelist[s] = 0;
   Dir *seg               = d->dir_segment(s);
   int l, b;
@@ -379,6 +428,7 @@ dir_clean_bucket(Dir *b, int s, Vol *vol)
 void
 dir_clean_segment(int s, Vol *d)
 {
+  DirSegmentWriteGuard guard(d, s);
   Dir *seg = d->dir_segment(s);
   for (int64_t i = 0; i < d->buckets; i++) {
     dir_clean_bucket(dir_bucket(i, seg), s, d);
@@ -401,6 +451,7 @@ dir_clear_range(off_t start, off_t end, Vol *vol)
   for (off_t i = 0; i < vol->buckets * DIR_DEPTH * vol->segments; i++) {
     Dir *e = dir_index(vol, i);
     if (!dir_token(e) && dir_offset(e) >= static_cast<int64_t>(start) && dir_offset(e) < static_cast<int64_t>(end)) {
+      DirSegmentWriteGuard guard(vol, i / (vol->buckets * DIR_DEPTH));
       CACHE_DEC_DIR_USED(vol->mutex);
       dir_set_offset(e, 0); // delete
     }
@@ -424,6 +475,7 @@ check_bucket_not_contains(Dir *b, Dir *e, Dir *seg)
 void
 freelist_clean(int s, Vol *vol)
 {
+  DirSegmentWriteGuard guard(vol, s);
   dir_clean_segment(s, vol);
   if (vol->header->freelist[s]) {
     return;
@@ -532,6 +584,29 @@ dir_free_entry(Dir *e, int s, Vol *d)
   d->header->freelist[s] = eo;
 }
 
+/*
+   Rule out a key from its bucket alone. When no used row of the bucket
+   carries the tag and no used row links out of the bucket, the chain is
+   confined to those rows and cannot hold the key. The rows share one or
+   two cache lines and the loop has no early exit, so this costs a few
+   wide compares instead of a dependent load per chain link.
+   */
+static inline bool
+dir_bucket_excludes(Dir *b, Dir *seg, uint32_t tag)
+{
+  Dir *end     = dir_bucket_row(b, DIR_DEPTH);
+  bool match   = false;
+  bool escapes = false;
+  for (int l = 0; l < DIR_DEPTH; ++l) {
+    Dir *e    = dir_bucket_row(b, l);
+    Dir *n    = next_dir(e, seg);
+    bool used = dir_offset(e) != 0;
+    match |= used & (dir_tag(e) == tag);
+    escapes |= used & (n != nullptr) & ((n <= b) | (n >= end));
+  }
+  return !match & !escapes;
+}
+
 int
 dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
 {
@@ -548,7 +623,10 @@ dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
 #endif
 Lagain:
   e = dir_bucket(b, seg);
-  if (dir_offset(e)) {
+  if (!collision && dir_bucket_excludes(e, seg, DIR_MASK_TAG(key->slice32(2)))) {
+    e = nullptr;
+  }
+  if (e && dir_offset(e)) {
     do {
       if (dir_compare_tag(e, key)) {
         ink_assert(dir_offset(e));
@@ -576,6 +654,7 @@ Lagain:
           ink_assert(dir_offset(e) * CACHE_BLOCK_SIZE < d->len);
           return 1;
         } else { // delete the invalid entry
+          DirSegmentWriteGuard guard(d, s);
           CACHE_DEC_DIR_USED(d->mutex);
           e = dir_delete_entry(e, p, s, d);
           continue;
@@ -599,17 +678,55 @@ Lagain:
   return 0;
 }
 
+/*
+   Probe the directory without the volume lock, for open_read to turn away
+   misses when the lock is busy. Only tags are compared, since checking that
+   an entry is valid needs the volume header. A false result is a bucket with
+   no matching tag that did not change while it was read; any match, and any
+   concurrent change to the segment, gives true and the caller has to probe
+   again under the lock.
+   */
+bool
+dir_probe_maybe_present(const CacheKey *key, Vol *d)
+{
+  int s                      = key->slice32(0) % d->segments;
+  int b                      = key->slice32(1) % d->buckets;
+  Dir *seg                   = d->dir_segment(s);
+  std::atomic<uint32_t> &seq = d->dir_segment_seq[s];
+  uint32_t before            = seq.load(std::memory_order_acquire);
+
+  if (before & 1) {
+    return true;
+  }
+
+  bool found = false;
+  Dir *e     = dir_bucket(b, seg);
+  if (dir_offset(e) && !dir_bucket_excludes(e, seg, DIR_MASK_TAG(key->slice32(2)))) {
+    // A chain read while it changes can be anything, bound the walk by the segment size.
+    for (int steps = d->buckets * DIR_DEPTH; e && !found; e = next_dir(e, seg)) {
+      if (--steps < 0) {
+        return true;
+      }
+      found = dir_compare_tag(e, key);
+    }
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return found || seq.load(std::memory_order_relaxed) != before;
+}
+
 int
 dir_insert(const CacheKey *key, Vol *d, Dir *to_part)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
   int s  = key->slice32(0) % d->segments, l;
   int bi = key->slice32(1) % d->buckets;
-  ink_assert(dir_approx_size(to_part) <= MAX_FRAG_SIZE + sizeof(Doc));
+  ink_assert(dir_approx_size(to_part) <= AGG_MAX_SIZE);
   Dir *seg = d->dir_segment(s);
   Dir *e   = nullptr;
   Dir *b   = dir_bucket(bi, seg);
   Vol *vol = d;
+  DirSegmentWriteGuard guard(d, s);
 #if defined(DEBUG) && defined(DO_CHECK_DIR_FAST)
   unsigned int t = DIR_MASK_TAG(key->slice32(2));
   Dir *col       = b;
@@ -669,9 +786,10 @@ dir_overwrite(const CacheKey *key, Vol *d, Dir *dir, Dir *overwrite, bool must_o
   bool loop_possible = true;
 #endif
   Vol *vol = d;
+  DirSegmentWriteGuard guard(d, s);
   CHECK_DIR(d);
 
-  ink_assert((unsigned int)dir_approx_size(dir) <= (unsigned int)(MAX_FRAG_SIZE + sizeof(Doc))); // XXX - size should be unsigned
+  ink_assert((unsigned int)dir_approx_size(dir) <= (unsigned int)AGG_MAX_SIZE); // XXX - size should be unsigned
 Lagain:
   // find entry to overwrite
   e = b;
@@ -754,6 +872,7 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
       }
 #endif
       if (dir_compare_tag(e, key) && dir_offset(e) == dir_offset(del)) {
+        DirSegmentWriteGuard guard(d, s);
         CACHE_DEC_DIR_USED(d->mutex);
         dir_delete_entry(e, p, s, d);
         CHECK_DIR(d);
@@ -896,6 +1015,7 @@ CacheSync::aio_write(int fd, char *b, int n, off_t o)
   io.aiocb.aio_buf    = b;
   io.action           = this;
   io.thread           = AIO_CALLBACK_THREAD_ANY;
+  io.priority         = AIO_PRIORITY_SYNC;
   ink_assert(ink_aio_write(&io) >= 0);
 }
 
@@ -949,6 +1069,10 @@ sync_cache_dir_on_shutdown()
     MUTEX_TAKE_LOCK(gvol[i]->mutex, t);
     Vol *d = gvol[i];
 
+    if (d->tags) {
+      d->tags->sync(true);
+    }
+
     if (DISK_BAD(d->disk)) {
       Debug("cache_dir_sync", "Dir %s: ignoring -- bad disk", d->hash_text.get());
       continue;
@@ -965,6 +1089,15 @@ sync_cache_dir_on_shutdown()
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
+    // writes still in flight may not complete before the process exits, repeat them
+    for (int i = 0; i < d->agg_writes_in_flight; i++) {
+      AggWriteBuffer *w = &d->agg_buffers[(d->agg_write_head + i) % d->agg_buffer_count];
+      ssize_t n         = w->io.aiocb.aio_nbytes;
+      if (pwrite(d->fd, w->buffer, n, w->io.aiocb.aio_offset) != n) {
+        ink_assert(!"flushing agg buffer failed");
+      }
+      d->header->write_serial++;
+    }
     if (d->agg_buf_pos) {
       Debug("cache_dir_sync", "Dir %s: flushing agg buffer first", d->hash_text.get());
 
@@ -1029,6 +1162,55 @@ sync_cache_dir_on_shutdown()
   }
 }
 
+/*
+   Collect the pieces of the directory that the on-disk copy 'copy' is
+   missing and snapshot them into 'buf' at their directory offsets. The
+   header goes first and the footer last, so that a sync that does not
+   complete leaves a copy whose header and footer serials differ and which
+   recovery ignores. In between are the free lists and every segment that
+   changed since this copy was last written; segments share store blocks,
+   so the neighbours of a dirty segment are written with it.
+   */
+static void
+dir_sync_plan(Vol *vol, uint8_t copy, char *buf, std::vector<std::pair<off_t, size_t>> &ranges)
+{
+  off_t footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  off_t dirstart  = vol->headerlen();
+  off_t seglen    = vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+
+  auto add = [&ranges](off_t o, off_t e) {
+    o = std::max(o, ranges.back().first + static_cast<off_t>(ranges.back().second));
+    while (o < e) {
+      std::pair<off_t, size_t> &last = ranges.back();
+      // Never grow the header write, it has to land before everything else.
+      if (ranges.size() > 1 && last.first + static_cast<off_t>(last.second) == o && last.second < SYNC_MAX_WRITE) {
+        size_t l = std::min<size_t>(e - o, SYNC_MAX_WRITE - last.second);
+        last.second += l;
+        o += l;
+      } else {
+        size_t l = std::min<size_t>(e - o, SYNC_MAX_WRITE);
+        ranges.emplace_back(o, l);
+        o += l;
+      }
+    }
+  };
+
+  ranges.clear();
+  ranges.emplace_back(0, footerlen);
+  add(footerlen, dirstart);
+  for (int s = 0; s < vol->segments; ++s) {
+    if (vol->dir_segment_dirty[s].fetch_and(~copy, std::memory_order_relaxed) & copy) {
+      off_t o = dirstart + s * seglen;
+      add(o - o % STORE_BLOCK_SIZE, ROUND_TO_STORE_BLOCK(o + seglen));
+    }
+  }
+  ranges.emplace_back(vol->dirlen() - footerlen, footerlen);
+
+  for (auto const &[o, l] : ranges) {
+    memcpy(buf + o, vol->raw_dir + o, l);
+  }
+}
+
 int
 CacheSync::mainEvent(int event, Event *e)
 {
@@ -1065,6 +1247,11 @@ Lrestart:
     // AIO Thread
     if (io.aio_result != static_cast<int64_t>(io.aiocb.aio_nbytes)) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
+      // The pieces not written are still owed to this copy.
+      uint8_t copy = 1 << (vol->header->sync_serial & 1);
+      for (int s = 0; s < vol->segments; ++s) {
+        vol->dir_segment_dirty[s].fetch_or(copy, std::memory_order_relaxed);
+      }
       event = EVENT_NONE;
       goto Ldone;
     }
@@ -1087,11 +1274,11 @@ Lrestart:
     // recompute hit_evacuate_window
     vol->hit_evacuate_window = (vol->data_blocks * cache_config_hit_evacuate_percent) / 100;
 
-    if (DISK_BAD(vol->disk)) {
+    // A memory volume starts out empty, its directory is not written.
+    if (DISK_BAD(vol->disk) || vol->disk->memory) {
       goto Ldone;
     }
 
-    int headerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
     size_t dirlen = vol->dirlen();
     if (!writepos) {
       // start
@@ -1102,11 +1289,14 @@ Lrestart:
          than necessary.
          The dirty bit it set in dir_insert, dir_overwrite and dir_delete_entry
        */
+      if (vol->tags) {
+        vol->tags->sync(false);
+      }
       if (!vol->header->dirty) {
         Debug("cache_dir_sync", "Dir %s not dirty", vol->hash_text.get());
         goto Ldone;
       }
-      if (vol->is_io_in_progress() || vol->agg_buf_pos) {
+      if (vol->is_io_in_progress() || vol->agg_buf_pos || vol->agg_writes_in_flight) {
         Debug("cache_dir_sync", "Dir %s: waiting for agg buffer", vol->hash_text.get());
         vol->dir_sync_waiting = true;
         if (!vol->is_io_in_progress()) {
@@ -1138,29 +1328,18 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      dir_sync_plan(vol, 1 << (vol->header->sync_serial & 1), buf, ranges);
+      range_idx                 = 0;
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
     off_t start = vol->skip + (B ? dirlen : 0);
 
-    if (!writepos) {
-      // write header
-      aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
-    } else if (writepos < static_cast<off_t>(dirlen) - headerlen) {
-      // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > static_cast<off_t>(dirlen) - headerlen) {
-        l = dirlen - headerlen - writepos;
-      }
-      aio_write(vol->fd, buf + writepos, l, start + writepos);
+    if (range_idx < ranges.size()) {
+      // write the header, the changed parts of the body, then the footer
+      auto [o, l] = ranges[range_idx++];
+      aio_write(vol->fd, buf + o, l, start + o);
       writepos += l;
-    } else if (writepos < static_cast<off_t>(dirlen)) {
-      ink_assert(writepos == (off_t)dirlen - headerlen);
-      // write footer
-      aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
     } else {
       vol->dir_sync_in_progress = false;
       CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
@@ -1172,7 +1351,9 @@ Lrestart:
   }
 Ldone:
   // done
-  writepos = 0;
+  writepos  = 0;
+  range_idx = 0;
+  ranges.clear();
   ++vol_idx;
   goto Lrestart;
 }
@@ -1497,6 +1678,10 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
     if (!dir_probe(&key, d, &dir, &last_collision)) {
       ret = REGRESSION_TEST_FAILED;
     }
+    // The lockless check may report false positives but never a false negative
+    if (!dir_probe_maybe_present(&key, d)) {
+      ret = REGRESSION_TEST_FAILED;
+    }
   }
   us = (Thread::get_hrtime_updated() - ttime) / HRTIME_USECOND;
   // On windows us is sometimes 0. I don't know why.
@@ -64,6 +64,7 @@ CacheDisk::open(char *s, off_t blocks, off_t askip, int ahw_sector_size, int fil
   len                 = blocks;
   io.aiocb.aio_fildes = fd;
   io.action           = this;
+  ink_aio_register_fd(fd);
   // determine header size and hence start point by successive approximation
   uint64_t l;
   for (int i = 0; i < 3; i++) {
@@ -84,6 +85,15 @@ CacheDisk::open(char *s, off_t blocks, off_t askip, int ahw_sector_size, int fil
   header = static_cast<DiskHeader *>(ats_memalign(ats_pagesize(), header_len));
   memset(header, 0, header_len);
 
+  ink_device_queue queue;
+  if (cache_config_span_stripes > 0) {
+    stripes = cache_config_span_stripes;
+  } else if (ink_file_get_device_queue(fd, queue)) {
+    stripes = ink_device_stripe_count(queue, num_usable_blocks * STORE_BLOCK_SIZE, cache_config_span_min_stripe_size,
+                                      ink_number_of_processors());
+  }
+  Debug("cache_init", "span %s: %d stripes per volume", path, stripes);
+
   // traffic server was asked to clear the cache, i.e., auto clear cache flag is set
   if (clear) {
     if (read_only_p) {
@@ -244,6 +254,20 @@ CacheDisk::syncDone(int event, void * /* data ATS_UNUSED */)
 }
 
 /* size is in store blocks */
+/* The size of the next stripe to create when @a blocks are still to be allocated to a volume
+   on this span, after @a made stripes were created for it. */
+off_t
+CacheDisk::stripe_blocks(off_t blocks, int made) const
+{
+  off_t chunks = blocks / STORE_BLOCKS_PER_VOL;
+  off_t left   = std::min<off_t>(stripes - made, chunks);
+
+  if (left <= 1) {
+    return blocks;
+  }
+  return (chunks / left) * STORE_BLOCKS_PER_VOL;
+}
+
 DiskVolBlock *
 CacheDisk::create_volume(int number, off_t size_in_blocks, int scheme)
 {
@@ -431,7 +431,8 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols    = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
+    // the tier only receives copies of documents from the other volumes
+    if (cachep->scheme == type && !cachep->tier) {
       Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
@@ -652,13 +653,16 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     line_num++;
 
     char *end;
-    char *line_end        = nullptr;
-    const char *err       = nullptr;
-    int volume_number     = 0;
-    CacheType scheme      = CACHE_NONE_TYPE;
-    int size              = 0;
-    int in_percent        = 0;
-    bool ramcache_enabled = true;
+    char *line_end             = nullptr;
+    const char *err            = nullptr;
+    int volume_number          = 0;
+    CacheType scheme           = CACHE_NONE_TYPE;
+    int size                   = 0;
+    int in_percent             = 0;
+    bool ramcache_enabled      = true;
+    bool tier                  = false;
+    bool memory                = false;
+    int admission_min_requests = -1;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -758,6 +762,40 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "tier") == 0) { // match tier
+        tmp += 5;
+        if (!strcasecmp(tmp, "false")) {
+          tmp += 5;
+          tier = false;
+        } else if (!strcasecmp(tmp, "true")) {
+          tmp += 4;
+          tier = true;
+        } else {
+          err = "Unexpected end of line";
+          break;
+        }
+      } else if (strcasecmp(tmp, "memory") == 0) { // match memory
+        tmp += 7;
+        if (!strcasecmp(tmp, "false")) {
+          tmp += 5;
+          memory = false;
+        } else if (!strcasecmp(tmp, "true")) {
+          tmp += 4;
+          memory = true;
+        } else {
+          err = "Unexpected end of line";
+          break;
+        }
+      } else if (strcasecmp(tmp, "admission") == 0) { // match admission
+        tmp += 10;
+        if (!ParseRules::is_digit(*tmp)) {
+          err = "Bad admission value";
+          break;
+        }
+        admission_min_requests = atoi(tmp);
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
       }
 
       // ends here
@@ -766,6 +804,10 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       }
     }
 
+    if (!err && memory && in_percent) {
+      err = "A memory volume needs an absolute size";
+    }
+
     if (err) {
       RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "%s discarding %s entry at line %d : %s", matcher_name, config_file_path, line_num,
                        err);
@@ -780,10 +822,13 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         configp->in_percent = false;
       }
-      configp->scheme           = scheme;
-      configp->size             = size;
-      configp->cachep           = nullptr;
-      configp->ramcache_enabled = ramcache_enabled;
+      configp->scheme                 = scheme;
+      configp->size                   = size;
+      configp->cachep                 = nullptr;
+      configp->ramcache_enabled       = ramcache_enabled && !memory; // the volume is in RAM already
+      configp->tier                   = tier;
+      configp->memory                 = memory;
+      configp->admission_min_requests = admission_min_requests;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
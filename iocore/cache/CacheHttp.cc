@@ -59,6 +59,7 @@ CacheHTTPInfoVector::insert(CacheHTTPInfo *info, int index)
   }
 
   data(index).alternate.copy_shallow(info);
+  data[index].vary_state = 0;
   return index;
 }
 
@@ -214,7 +215,8 @@ CacheHTTPInfoVector::unmarshal(const char *buf, int length, RefCountObj *block_p
     info.m_alt = (HTTPCacheAlt *)buf;
     buf += tmp;
 
-    data(xcount).alternate = info;
+    data(xcount).alternate  = info;
+    data[xcount].vary_state = 0;
     xcount++;
   }
 
@@ -242,7 +244,8 @@ CacheHTTPInfoVector::get_handles(const char *buf, int length, RefCountObj *block
     }
     buf += tmp;
 
-    data(xcount).alternate = info;
+    data(xcount).alternate  = info;
+    data[xcount].vary_state = 0;
     xcount++;
   }
 
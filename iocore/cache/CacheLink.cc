@@ -33,8 +33,14 @@ Cache::link(Continuation *cont, const CacheKey *from, const CacheKey *to, CacheF
 
   ink_assert(caches[type] == this);
 
+  Vol *vol = key_to_vol(from, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_LINK_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
+
   CacheVC *c         = new_CacheVC(cont);
-  c->vol             = key_to_vol(from, hostname, host_len);
+  c->vol             = vol;
   c->write_len       = sizeof(*to); // so that the earliest_key will be used
   c->f.use_first_key = 1;
   c->first_key       = *from;
@@ -84,6 +90,10 @@ Cache::deref(Continuation *cont, const CacheKey *key, CacheFragType type, const
   ink_assert(caches[type] == this);
 
   Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_DEREF_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
   Dir result;
   Dir *last_collision = nullptr;
   CacheVC *c          = nullptr;
@@ -155,7 +165,7 @@ CacheVC::derefRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   return free_CacheVC(this);
 
 Lcollision : {
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (!lock.is_locked()) {
     mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
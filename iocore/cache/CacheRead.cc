@@ -35,12 +35,21 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   ink_assert(caches[type] == this);
 
   Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NOT_READY);
+    return ACTION_RESULT_DONE;
+  }
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
+    if (!lock.is_locked() && !vol->maybe_contains(key)) {
+      // A miss is decided without the lock, don't reschedule it just to find out again.
+      CACHE_INCREMENT_DYN_STAT(cache_read_lockless_miss_stat);
+      goto Lmiss;
+    }
     if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
       c = new_CacheVC(cont);
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
@@ -101,17 +110,35 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   ink_assert(caches[type] == this);
 
   Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->ready) {
+    cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NOT_READY);
+    return ACTION_RESULT_DONE;
+  }
   Dir result, *last_collision = nullptr;
-  ProxyMutex *mutex = cont->mutex.get();
-  OpenDirEntry *od  = nullptr;
-  CacheVC *c        = nullptr;
+  ProxyMutex *mutex  = cont->mutex.get();
+  OpenDirEntry *od   = nullptr;
+  CacheVC *c         = nullptr;
+  Vol *tier_fallback = nullptr;
+  Vol *tier_vol      = cache_tier ? cache_tier->lookup(key, mutex->thread_holding) : nullptr;
+
+  if (tier_vol) {
+    tier_fallback = vol;
+    vol           = tier_vol;
+    CACHE_INCREMENT_DYN_STAT(cache_tier_hits_stat);
+  }
 
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
+    if (!lock.is_locked() && !vol->maybe_contains(key)) {
+      // A miss is decided without the lock, don't reschedule it just to find out again.
+      CACHE_INCREMENT_DYN_STAT(cache_read_lockless_miss_stat);
+      goto Lmiss;
+    }
     if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
       c            = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
+      c->tier_fallback                        = tier_fallback;
       c->vio.op                               = VIO::READ;
       c->base_stat                            = cache_read_active_stat;
       CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
@@ -313,14 +340,20 @@ CacheVC::openReadFromWriter(int event, Event *e)
   cancel_trigger();
   intptr_t err = ECACHE_DOC_BUSY;
   DDebug("cache_read_agg", "%p: key: %X In openReadFromWriter", this, first_key.slice32(1));
-  if (_action.cancelled) {
+  if (_action.cancelled && !fill_wait) {
     od = nullptr; // only open for read so no need to close
     return free_CacheVC(this);
   }
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
   }
+  writer_unwait();
+  if (_action.cancelled) {
+    MUTEX_RELEASE(lock);
+    od = nullptr;
+    return free_CacheVC(this);
+  }
   od = vol->open_read(&first_key); // recheck in case the lock failed
   if (!od) {
     MUTEX_RELEASE(lock);
@@ -343,7 +376,7 @@ CacheVC::openReadFromWriter(int event, Event *e)
     } else if (ret == EVENT_CONT) {
       ink_assert(!write_vc);
       if (writer_lock_retry < cache_config_read_while_writer_max_retries) {
-        VC_SCHED_WRITER_RETRY();
+        VC_SCHED_WRITER_WAIT();
       } else {
         return openReadFromWriterFailure(CACHE_EVENT_OPEN_READ_FAILED, (Event *)-err);
       }
@@ -380,7 +413,7 @@ CacheVC::openReadFromWriter(int event, Event *e)
     }
     DDebug("cache_read_agg", "%p: key: %X writer: closed:%d, fragment:%d, retry: %d", this, first_key.slice32(1), write_vc->closed,
            write_vc->fragment, writer_lock_retry);
-    VC_SCHED_WRITER_RETRY();
+    VC_SCHED_WRITER_WAIT();
   }
 
   CACHE_TRY_LOCK(writer_lock, write_vc->mutex, mutex->thread_holding);
@@ -531,10 +564,11 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
     }
     set_io_not_in_progress();
   }
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
   }
+  writer_unwait();
   if (f.hit_evacuate && dir_valid(vol, &first_dir) && closed > 0) {
     if (f.single_fragment) {
       vol->force_evacuate_head(&first_dir, dir_pinned(&first_dir));
@@ -558,10 +592,11 @@ CacheVC::openReadReadDone(int event, Event *e)
   }
   set_io_not_in_progress();
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
+    writer_unwait();
     if (event == AIO_EVENT_DONE && !io.ok()) {
       goto Lerror;
     }
@@ -606,7 +641,7 @@ CacheVC::openReadReadDone(int event, Event *e)
       }
       if (writer_lock_retry < cache_config_read_while_writer_max_retries) {
         DDebug("cache_read_agg", "%p: key: %X ReadRead retrying: %d", this, first_key.slice32(1), (int)vio.ndone);
-        VC_SCHED_WRITER_RETRY(); // wait for writer
+        VC_SCHED_WRITER_WAIT(); // wait for writer
       } else {
         DDebug("cache_read_agg", "%p: key: %X ReadRead retries exhausted, bailing..: %d", this, first_key.slice32(1),
                (int)vio.ndone);
@@ -640,7 +675,7 @@ LreadMain:
 }
 
 int
-CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+CacheVC::openReadMain(int event, Event *e)
 {
   cancel_trigger();
   Doc *doc         = reinterpret_cast<Doc *>(buf->data());
@@ -749,7 +784,7 @@ CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 
       doc->magic = DOC_CORRUPT;
 
-      CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+      CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
       if (!lock.is_locked()) {
         SET_HANDLER(&CacheVC::openReadDirDelete);
         VC_SCHED_LOCK_RETRY();
@@ -801,14 +836,30 @@ Lread : {
   // EVENT_IMMEDIATE events. So, we have to cancel that trigger and set
   // a new EVENT_INTERVAL event.
   cancel_trigger();
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (!lock.is_locked()) {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_LOCK_RETRY();
   }
+  writer_unwait();
+  if (write_vc) {
+    // the writer may still hold the fragment, shared by all its readers
+    OpenDirEntry *cod  = vol->open_read(&first_key);
+    IOBufferData *data = cod ? cod->fill_find(&key) : nullptr;
+    if (data) {
+      MUTEX_RELEASE(lock);
+      CACHE_INCREMENT_DYN_STAT(cache_read_while_writer_fill_stat);
+      buf = data;
+      fragment++;
+      doc_pos = reinterpret_cast<Doc *>(buf->data())->prefix_len();
+      next_CacheKey(&key, &key);
+      return openReadMain(event, e);
+    }
+  }
   if (dir_probe(&key, vol, &dir, &last_collision)) {
     SET_HANDLER(&CacheVC::openReadReadDone);
     int ret = do_read_call(&key);
+    read_ahead_issue();
     if (ret == EVENT_RETURN) {
       goto Lcallreturn;
     }
@@ -828,7 +879,7 @@ Lread : {
     }
     DDebug("cache_read_agg", "%p: key: %X ReadMain retrying: %d", this, first_key.slice32(1), (int)vio.ndone);
     SET_HANDLER(&CacheVC::openReadMain);
-    VC_SCHED_WRITER_RETRY();
+    VC_SCHED_WRITER_WAIT();
   }
   if (is_action_tag_set("cache")) {
     ink_release_assert(false);
@@ -861,7 +912,7 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
     return free_CacheVC(this);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
@@ -1009,7 +1060,7 @@ CacheVC::openReadVecWrite(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */
     return openWriteCloseDir(EVENT_IMMEDIATE, nullptr);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
@@ -1064,7 +1115,7 @@ CacheVC::openReadStartHead(int event, Event *e)
     return free_CacheVC(this);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
@@ -1201,6 +1252,9 @@ CacheVC::openReadStartHead(int event, Event *e)
 
     first_buf = buf;
     vol->begin_read(this);
+    if (cache_tier) {
+      cache_tier->promote(this, doc);
+    }
 
     goto Lsuccess;
 
@@ -1231,6 +1285,17 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
   }
 Ldone:
+  if (tier_fallback && err == ECACHE_NO_DOC) {
+    // the tier entry was a collision or has been overwritten, read the document from its own volume
+    CACHE_DECREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+    vol            = tier_fallback;
+    tier_fallback  = nullptr;
+    key            = first_key;
+    last_collision = nullptr;
+    buf.clear();
+    CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+    return handleEvent(EVENT_IMMEDIATE, nullptr);
+  }
   if (!f.lookup) {
     CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
     _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-err);
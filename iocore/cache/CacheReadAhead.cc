@@ -0,0 +1,164 @@
+/** @file
+
+  Reading the fragments of large documents ahead of their readers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+ClassAllocator<CacheReadAhead> cacheReadAheadAllocator("cacheReadAhead");
+
+static void
+free_CacheReadAhead(CacheReadAhead *ra)
+{
+  ra->buf.clear();
+  ra->io.action.continuation = nullptr;
+  ra->io.action.mutex        = nullptr;
+  ra->io.mutex.clear();
+  ra->mutex.clear();
+  ra->owner  = nullptr;
+  ra->done   = false;
+  ra->waited = false;
+  cacheReadAheadAllocator.free(ra);
+}
+
+int
+CacheReadAhead::readDone(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  done = true;
+  if (!owner) {
+    free_CacheReadAhead(this);
+    return EVENT_DONE;
+  }
+  ink_hrtime latency        = Thread::get_hrtime() - issued;
+  owner->read_ahead_latency = owner->read_ahead_latency ? (3 * owner->read_ahead_latency + latency) / 4 : latency;
+  if (waited) {
+    CacheVC *vc = owner;
+    vc->read_ahead_take(this);
+    vc->handleEvent(AIO_EVENT_DONE, nullptr);
+  }
+  return EVENT_DONE;
+}
+
+// Keep the fragments after @c key in flight, as much of them as the reader drains in twice the
+// time a fragment takes to read, and at least the next one. Called with the volume locked.
+void
+CacheVC::read_ahead_issue()
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (!cache_config_read_ahead_size || write_vc || frag_type != CACHE_FRAG_TYPE_HTTP || !alternate.valid() ||
+      doc_len < static_cast<uint64_t>(cache_config_read_ahead_min_object_size)) {
+    return;
+  }
+
+  int64_t target     = cache_config_read_ahead_size;
+  ink_hrtime elapsed = Thread::get_hrtime() - start_time;
+  if (read_ahead_latency && vio.ndone && elapsed > 0) {
+    double rate = static_cast<double>(vio.ndone) / elapsed;
+    target      = std::min(target, static_cast<int64_t>(rate * 2 * read_ahead_latency));
+  }
+
+  // @c key is the fragment after @c fragment, the queue holds the ones after it in order.
+  int nfrags = alternate.get_frag_offset_count() + 1;
+  int next   = fragment + 2;
+  CacheKey k = key;
+  for (CacheReadAhead *ra = read_ahead.head; ra; ra = ra->link.next) {
+    k = ra->key;
+    next++;
+  }
+  for (; next < nfrags && (!read_ahead.head || read_ahead_bytes < target); next++) {
+    Dir frag_dir, *collision = nullptr;
+    next_CacheKey(&k, &k);
+    if (!dir_probe(&k, vol, &frag_dir, &collision) || dir_agg_buf_valid(vol, &frag_dir)) {
+      break;
+    }
+    CacheReadAhead *ra      = cacheReadAheadAllocator.alloc();
+    ra->mutex               = mutex;
+    ra->owner               = this;
+    ra->key                 = k;
+    ra->offset              = dir_offset(&frag_dir);
+    ra->io.aiocb.aio_fildes = vol->fd;
+    ra->io.aiocb.aio_offset = vol->vol_offset(&frag_dir);
+    ra->io.aiocb.aio_nbytes = dir_approx_size(&frag_dir);
+    if (static_cast<off_t>(ra->io.aiocb.aio_offset + ra->io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
+      ra->io.aiocb.aio_nbytes = vol->skip + vol->len - ra->io.aiocb.aio_offset;
+    }
+    ra->buf              = new_IOBufferData(iobuffer_size_to_index(ra->io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    ra->io.aiocb.aio_buf = ra->buf->data();
+    ra->io.action        = ra;
+    ra->io.thread        = mutex->thread_holding->tt == DEDICATED ? AIO_CALLBACK_THREAD_ANY : mutex->thread_holding;
+    ra->issued           = Thread::get_hrtime();
+    read_ahead.enqueue(ra);
+    read_ahead_bytes += ra->io.aiocb.aio_nbytes;
+    CACHE_SUM_DYN_STAT(cache_read_ahead_bytes_stat, ra->io.aiocb.aio_nbytes);
+    ink_assert(ink_aio_read(&ra->io) >= 0);
+  }
+}
+
+static void
+read_ahead_drop(CacheVC *vc, CacheReadAhead *ra)
+{
+  ProxyMutex *mutex = vc->mutex.get();
+  Vol *vol          = vc->vol;
+  vc->read_ahead.remove(ra);
+  vc->read_ahead_bytes -= ra->io.aiocb.aio_nbytes;
+  CACHE_SUM_DYN_STAT(cache_read_ahead_wasted_stat, ra->io.aiocb.aio_nbytes);
+  if (ra->done) {
+    free_CacheReadAhead(ra);
+  } else {
+    ra->owner = nullptr;
+  }
+}
+
+// The fragment read ahead for @c read_key at @c dir, dropping those the reader skipped.
+CacheReadAhead *
+CacheVC::read_ahead_find()
+{
+  CacheReadAhead *ra;
+  while ((ra = read_ahead.head)) {
+    if (ra->key == *read_key && ra->offset == dir_offset(&dir)) {
+      return ra;
+    }
+    read_ahead_drop(this, ra);
+  }
+  return nullptr;
+}
+
+// Use the completed read of @a ra as if it were this CacheVC's own.
+void
+CacheVC::read_ahead_take(CacheReadAhead *ra)
+{
+  ink_assert(ra->done && ra->owner == this);
+  read_ahead.remove(ra);
+  read_ahead_bytes -= ra->io.aiocb.aio_nbytes;
+  buf                 = ra->buf;
+  io.aiocb.aio_offset = ra->io.aiocb.aio_offset;
+  io.aiocb.aio_nbytes = ra->io.aiocb.aio_nbytes;
+  io.aio_result       = ra->io.aio_result;
+  free_CacheReadAhead(ra);
+}
+
+void
+CacheVC::read_ahead_cancel()
+{
+  while (read_ahead.head) {
+    read_ahead_drop(this, read_ahead.head);
+  }
+}
@@ -0,0 +1,230 @@
+/** @file
+
+  Cache scans requested through the management API, reported to a file in the log directory
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "P_Cache.h"
+#include "tscore/Regex.h"
+#include "tscpp/util/TextView.h"
+
+namespace
+{
+const char SCAN_REPORT_FILE[] = "cache_scan.log";
+
+// Only one report is written at a time.
+std::atomic<bool> scan_in_progress{false};
+} // namespace
+
+/**
+  A scan started by @c traffic_ctl @c cache @c scan. Its options are @c name=value lines:
+
+  - @c url, a regular expression the URL of an alternate must match.
+  - @c min_size and @c max_size, in bytes, of the alternates or, scanning the directory, of its entries.
+  - @c min_age and @c max_age, in seconds since the response was received.
+  - @c rate, the read rate in KB/s, @c proxy.config.cache.scan_rate if 0.
+  - @c directory, to only go through the directory, which has no URL or age.
+  - @c remove, to remove the matching alternates from the cache.
+
+  The matching alternates are written one per line to @c cache_scan.log, with their size and age,
+  followed by a summary of the scan.
+*/
+struct CacheScanReport : public Continuation {
+  Regex url;
+  bool match_url      = false;
+  int64_t min_size    = 0;
+  int64_t max_size    = INT64_MAX;
+  int64_t min_age     = 0;
+  int64_t max_age     = INT64_MAX;
+  int rate            = 0;
+  bool directory      = false;
+  bool remove         = false;
+  FILE *out           = nullptr;
+  time_t start        = 0;
+  int64_t visited     = 0;
+  int64_t matched     = 0;
+  int64_t matched_len = 0;
+
+  CacheScanReport() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheScanReport::startEvent); }
+
+  ~CacheScanReport() override
+  {
+    if (out) {
+      fclose(out);
+    }
+    scan_in_progress = false;
+  }
+
+  bool parse(ts::TextView options);
+  int startEvent(int event, void *data);
+  int scanEvent(int event, void *data);
+
+  bool
+  size_matches(int64_t size) const
+  {
+    return size >= min_size && size <= max_size;
+  }
+};
+
+bool
+CacheScanReport::parse(ts::TextView options)
+{
+  while (options) {
+    ts::TextView value = options.take_prefix_at('\n');
+    ts::TextView name  = value.take_prefix_at('=');
+    if (name.empty()) {
+      continue;
+    }
+    if (name == "url") {
+      std::string pattern{value};
+      if (!url.compile(pattern.c_str())) {
+        Error("cache scan: invalid URL regular expression '%s'", pattern.c_str());
+        return false;
+      }
+      match_url = true;
+    } else if (name == "min_size") {
+      min_size = ts::svtoi(value);
+    } else if (name == "max_size") {
+      max_size = ts::svtoi(value);
+    } else if (name == "min_age") {
+      min_age = ts::svtoi(value);
+    } else if (name == "max_age") {
+      max_age = ts::svtoi(value);
+    } else if (name == "rate") {
+      rate = ts::svtoi(value);
+    } else if (name == "directory") {
+      directory = ts::svtoi(value) != 0;
+    } else if (name == "remove") {
+      remove = ts::svtoi(value) != 0;
+    } else {
+      Error("cache scan: unknown option '%.*s'", static_cast<int>(name.size()), name.data());
+      return false;
+    }
+  }
+  if (directory && (match_url || remove || min_age || max_age != INT64_MAX)) {
+    Error("cache scan: a directory scan only filters on sizes");
+    return false;
+  }
+  return true;
+}
+
+int
+CacheScanReport::startEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  std::string path = RecConfigReadLogDir() + "/" + SCAN_REPORT_FILE;
+  out              = fopen(path.c_str(), "w");
+  if (!out) {
+    Error("cache scan: cannot open %s: %s", path.c_str(), strerror(errno));
+    delete this;
+    return EVENT_DONE;
+  }
+
+  Note("cache scan started, reporting to %s", path.c_str());
+  start = time(nullptr);
+  SET_HANDLER(&CacheScanReport::scanEvent);
+  cacheProcessor.scan_parallel(this, directory ? CACHE_SCAN_DIR : CACHE_SCAN_HEADERS, rate ? rate : cache_config_scan_rate);
+  return EVENT_DONE;
+}
+
+int
+CacheScanReport::scanEvent(int event, void *data)
+{
+  switch (event) {
+  case CACHE_EVENT_SCAN:
+    return EVENT_CONT;
+
+  case CACHE_EVENT_SCAN_DIR: {
+    CacheScanDirEntry *entry = static_cast<CacheScanDirEntry *>(data);
+    visited++;
+    if (size_matches(entry->size)) {
+      matched++;
+      matched_len += entry->size;
+    }
+    return CACHE_SCAN_RESULT_CONTINUE;
+  }
+
+  case CACHE_EVENT_SCAN_OBJECT: {
+    HTTPInfo *alt = static_cast<HTTPInfo *>(data);
+    int64_t size  = alt->object_size_get();
+    int64_t age   = start - alt->response_received_time_get();
+    visited++;
+    if (!size_matches(size) || age < min_age || age > max_age) {
+      return CACHE_SCAN_RESULT_CONTINUE;
+    }
+    int url_len   = 0;
+    char *url_str = alt->request_get()->url_string_get(nullptr, &url_len);
+    if (match_url && !url.exec(std::string_view(url_str, url_len))) {
+      ats_free(url_str);
+      return CACHE_SCAN_RESULT_CONTINUE;
+    }
+    fprintf(out, "%" PRId64 "\t%" PRId64 "\t%.*s\n", size, age, url_len, url_str);
+    ats_free(url_str);
+    matched++;
+    matched_len += size;
+    return remove ? CACHE_SCAN_RESULT_DELETE : CACHE_SCAN_RESULT_CONTINUE;
+  }
+
+  case CACHE_EVENT_SCAN_OPERATION_BLOCKED:
+    return CACHE_SCAN_RESULT_CONTINUE;
+
+  case CACHE_EVENT_SCAN_OPERATION_FAILED:
+    return CACHE_SCAN_RESULT_CONTINUE;
+
+  case CACHE_EVENT_SCAN_DONE:
+    fprintf(out, "# %s %" PRId64 " %s in %ld seconds, %" PRId64 " matched for %" PRId64 " bytes%s%s\n",
+            directory ? "visited" : "scanned", visited, directory ? "directory entries" : "alternates",
+            static_cast<long>(time(nullptr) - start), matched, matched_len, remove ? ", removed" : "",
+            data ? ", some volumes could not be read" : "");
+    Note("cache scan done, %" PRId64 " of %" PRId64 " matched", matched, visited);
+    break;
+
+  case CACHE_EVENT_SCAN_FAILED:
+  default:
+    fprintf(out, "# scan failed, the cache is not ready\n");
+    Error("cache scan failed, the cache is not ready");
+    break;
+  }
+  delete this;
+  return EVENT_DONE;
+}
+
+void
+cache_scan_request(std::string_view options)
+{
+  // the management message is null terminated
+  while (!options.empty() && options.back() == '\0') {
+    options.remove_suffix(1);
+  }
+  bool expected = false;
+  if (!scan_in_progress.compare_exchange_strong(expected, true)) {
+    Warning("cache scan already in progress, request ignored");
+    return;
+  }
+  CacheScanReport *report = new CacheScanReport();
+  if (!report->parse(options)) {
+    delete report;
+    return;
+  }
+  eventProcessor.schedule_imm(report, ET_CALL);
+}
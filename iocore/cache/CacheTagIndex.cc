@@ -0,0 +1,383 @@
+/** @file
+
+  An index from the tags of cached documents, such as surrogate keys, to their cache keys
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "P_Cache.h"
+#include "tscore/HashFNV.h"
+#include "tscpp/util/TextView.h"
+
+namespace
+{
+// Removals of a single invalidation in flight at once.
+constexpr size_t PURGE_BATCH = 64;
+
+bool
+is_tag_separator(char c)
+{
+  return c == ',' || ParseRules::is_ws(c);
+}
+} // namespace
+
+uint64_t
+CacheTagIndex::hash(std::string_view tag)
+{
+  ATSHash64FNV1a h;
+  h.update(tag.data(), tag.size());
+  h.final();
+  return h.get();
+}
+
+int
+CacheTagIndex::parse(std::string_view value, uint64_t *tags, int max)
+{
+  ts::TextView text{value};
+  int n = 0;
+  while (text && n < max) {
+    ts::TextView tag = text.ltrim_if(&is_tag_separator).take_prefix_if(&is_tag_separator);
+    if (tag.empty()) {
+      continue;
+    }
+    uint64_t h = hash(tag);
+    if (std::find(tags, tags + n, h) == tags + n) {
+      tags[n++] = h;
+    }
+  }
+  return n;
+}
+
+size_t
+CacheTagIndex::mapped_size(uint32_t capacity, uint32_t buckets)
+{
+  return sizeof(Header) + 2 * sizeof(uint32_t) * buckets + sizeof(Entry) * (static_cast<size_t>(capacity) + 1);
+}
+
+CacheTagIndex *
+CacheTagIndex::open(const char *path, uint32_t capacity, time_t stamp)
+{
+  uint32_t buckets = 1;
+  while (buckets < capacity / 2) {
+    buckets <<= 1;
+  }
+  size_t size = mapped_size(capacity, buckets);
+
+  int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    Warning("cache tag index: cannot open %s: %s", path, strerror(errno));
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (static_cast<size_t>(st.st_size) != size && ftruncate(fd, size) < 0)) {
+    Warning("cache tag index: cannot size %s to %zu bytes: %s", path, size, strerror(errno));
+    ::close(fd);
+    return nullptr;
+  }
+  void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    Warning("cache tag index: cannot map %s: %s", path, strerror(errno));
+    ::close(fd);
+    return nullptr;
+  }
+
+  CacheTagIndex *index = new CacheTagIndex();
+  index->_fd           = fd;
+  index->_map          = map;
+  index->_map_size     = size;
+  index->_header       = static_cast<Header *>(map);
+  index->_tag_heads    = reinterpret_cast<uint32_t *>(index->_header + 1);
+  index->_key_heads    = index->_tag_heads + buckets;
+  index->_entries      = reinterpret_cast<Entry *>(index->_key_heads + buckets);
+
+  Header const *h = index->_header;
+  if (h->magic != MAGIC || h->version != VERSION || h->stamp != stamp || h->capacity != capacity || h->buckets != buckets ||
+      h->open) {
+    Note("cache tag index %s reset%s", path, h->magic == MAGIC && h->open ? " after an unclean shutdown" : "");
+    index->reset(capacity, buckets, stamp);
+  } else {
+    Note("cache tag index %s has %u entries", path, h->count);
+  }
+  index->_header->open = 1;
+  return index;
+}
+
+CacheTagIndex *
+CacheTagIndex::open(Vol *vol)
+{
+  if (!cache_config_tag_header_len || cache_config_tag_index_entries <= 0 || vol->fd == -1) {
+    return nullptr;
+  }
+  char hex[CRYPTO_HASH_SIZE * 2 + 1];
+  std::string path = RecConfigReadRuntimeDir() + "/cache_tags_" + vol->hash_id.toHexStr(hex);
+  return open(path.c_str(), cache_config_tag_index_entries, vol->header->create_time);
+}
+
+CacheTagIndex::~CacheTagIndex()
+{
+  munmap(_map, _map_size);
+  ::close(_fd);
+}
+
+void
+CacheTagIndex::reset(uint32_t capacity, uint32_t buckets, time_t stamp)
+{
+  memset(_tag_heads, 0, 2 * sizeof(uint32_t) * buckets);
+  for (uint32_t i = 1; i <= capacity; i++) {
+    _entries[i].by_tag.prev = FREE;
+    _entries[i].by_tag.next = i < capacity ? i + 1 : 0;
+  }
+  _header->magic     = MAGIC;
+  _header->version   = VERSION;
+  _header->stamp     = stamp;
+  _header->capacity  = capacity;
+  _header->buckets   = buckets;
+  _header->free_head = capacity ? 1 : 0;
+  _header->count     = 0;
+  _header->cursor    = 0;
+  _header->open      = 0;
+}
+
+void
+CacheTagIndex::link(uint32_t i, Link Entry::*chain, uint32_t *heads, uint32_t bucket)
+{
+  Link &l = _entries[i].*chain;
+  l.prev  = 0;
+  l.next  = heads[bucket];
+  if (l.next) {
+    (_entries[l.next].*chain).prev = i;
+  }
+  heads[bucket] = i;
+}
+
+void
+CacheTagIndex::unlink(uint32_t i, Link Entry::*chain, uint32_t *heads, uint32_t bucket)
+{
+  Link &l = _entries[i].*chain;
+  if (l.prev) {
+    (_entries[l.prev].*chain).next = l.next;
+  } else {
+    heads[bucket] = l.next;
+  }
+  if (l.next) {
+    (_entries[l.next].*chain).prev = l.prev;
+  }
+}
+
+void
+CacheTagIndex::release(uint32_t i)
+{
+  Entry &e = _entries[i];
+  unlink(i, &Entry::by_tag, _tag_heads, tag_bucket(e.tag));
+  unlink(i, &Entry::by_key, _key_heads, key_bucket(e.key));
+  e.by_tag.prev      = FREE;
+  e.by_tag.next      = _header->free_head;
+  _header->free_head = i;
+  _header->count--;
+}
+
+// The table being full, every entry is in use: reclaim the first one of a document the
+// volume dropped or, failing that, the one under the cursor.
+uint32_t
+CacheTagIndex::alloc(Vol *vol, int *evicted)
+{
+  if (!_header->free_head) {
+    if (!_header->capacity) {
+      return 0;
+    }
+    uint32_t victim = 0;
+    bool stale      = false;
+    for (int n = 0; n < RECLAIM_PROBES && !stale; n++) {
+      uint32_t i      = _header->cursor % _header->capacity + 1;
+      _header->cursor = i;
+      if (!victim) {
+        victim = i;
+      }
+      if (vol && !dir_probe_maybe_present(&_entries[i].key, vol)) {
+        victim = i;
+        stale  = true;
+      }
+    }
+    if (!stale) {
+      ++*evicted;
+    }
+    release(victim);
+  }
+  uint32_t i         = _header->free_head;
+  _header->free_head = _entries[i].by_tag.next;
+  _header->count++;
+  return i;
+}
+
+int
+CacheTagIndex::insert(const CryptoHash &key, const uint64_t *tags, int ntags, Vol *vol)
+{
+  std::lock_guard<std::mutex> guard(_lock);
+
+  uint32_t bucket = key_bucket(key);
+  for (uint32_t i = _key_heads[bucket], next; i; i = next) {
+    next = _entries[i].by_key.next;
+    if (_entries[i].key == key) {
+      release(i);
+    }
+  }
+
+  int evicted = 0;
+  for (int t = 0; t < ntags; t++) {
+    uint32_t i = alloc(vol, &evicted);
+    if (!i) {
+      break;
+    }
+    Entry &e = _entries[i];
+    e.tag    = tags[t];
+    e.key    = key;
+    link(i, &Entry::by_tag, _tag_heads, tag_bucket(e.tag));
+    link(i, &Entry::by_key, _key_heads, bucket);
+  }
+  return evicted;
+}
+
+void
+CacheTagIndex::collect(uint64_t tag, std::vector<CryptoHash> &keys)
+{
+  std::lock_guard<std::mutex> guard(_lock);
+
+  for (uint32_t i = _tag_heads[tag_bucket(tag)], next; i; i = next) {
+    next = _entries[i].by_tag.next;
+    if (_entries[i].tag == tag) {
+      keys.push_back(_entries[i].key);
+      release(i);
+    }
+  }
+}
+
+void
+CacheTagIndex::sync(bool shutdown)
+{
+  if (shutdown) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _header->open = 0;
+  }
+  if (msync(_map, _map_size, shutdown ? MS_SYNC : MS_ASYNC) < 0) {
+    Warning("cache tag index: write back failed: %s", strerror(errno));
+  }
+}
+
+uint32_t
+CacheTagIndex::count() const
+{
+  return _header->count;
+}
+
+// Removes the documents of an invalidated tag, a batch at a time.
+struct CacheTagPurge : public Continuation {
+  std::string tag;
+  std::vector<CryptoHash> keys;
+  std::vector<Vol *> vols;
+  size_t next     = 0;
+  size_t pending  = 0;
+  int64_t removed = 0;
+  bool issuing    = false;
+
+  CacheTagPurge(std::string_view atag) : Continuation(new_ProxyMutex()), tag(atag) { SET_HANDLER(&CacheTagPurge::purgeEvent); }
+
+  int
+  purgeEvent(int event, void * /* data ATS_UNUSED */)
+  {
+    switch (event) {
+    case CACHE_EVENT_REMOVE:
+      removed++;
+      pending--;
+      break;
+    case CACHE_EVENT_REMOVE_FAILED:
+      pending--;
+      break;
+    default:
+      break;
+    }
+    // removals may call back before returning
+    if (issuing) {
+      return EVENT_DONE;
+    }
+    issuing = true;
+    while (pending < PURGE_BATCH && next < keys.size()) {
+      pending++;
+      caches[CACHE_FRAG_TYPE_HTTP]->remove_from(this, vols[next], &keys[next], CACHE_FRAG_TYPE_HTTP);
+      next++;
+    }
+    issuing = false;
+    if (!pending && next == keys.size()) {
+      Note("cache tag '%s' invalidated, %" PRId64 " of %zu documents removed", tag.c_str(), removed, keys.size());
+      delete this;
+    }
+    return EVENT_DONE;
+  }
+};
+
+int64_t
+CacheProcessor::invalidate_tag(std::string_view tag)
+{
+  if (!cache_config_tag_header_len || !IsCacheReady(CACHE_FRAG_TYPE_HTTP)) {
+    return 0;
+  }
+  uint64_t hash        = CacheTagIndex::hash(tag);
+  CacheTagPurge *purge = new CacheTagPurge(tag);
+  for (int i = 0; i < gnvol; i++) {
+    Vol *vol = gvol[i];
+    if (!vol->tags) {
+      continue;
+    }
+    size_t start = purge->keys.size();
+    vol->tags->collect(hash, purge->keys);
+    purge->vols.resize(purge->keys.size(), vol);
+    CACHE_SUM_DYN_STAT_THREAD(cache_tag_index_invalidated_stat, purge->keys.size() - start);
+  }
+
+  int64_t n = purge->keys.size();
+  if (n == 0) {
+    delete purge;
+  } else {
+    eventProcessor.schedule_imm(purge, ET_CALL);
+  }
+  return n;
+}
+
+void
+cache_tag_invalidate_request(std::string_view tags)
+{
+  ts::TextView text{tags};
+  while (text) {
+    ts::TextView tag = text.take_prefix_at('\n').trim_if(&ParseRules::is_ws);
+    // the management message is null terminated
+    tag.rtrim('\0');
+    if (tag.empty()) {
+      continue;
+    }
+    int64_t n = cacheProcessor.invalidate_tag(tag);
+    Note("cache tag '%.*s' invalidation requested, %" PRId64 " documents", static_cast<int>(tag.size()), tag.data(), n);
+  }
+}
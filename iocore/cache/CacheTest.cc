@@ -24,6 +24,7 @@
 
 #include "P_Cache.h"
 #include "P_CacheTest.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <cstdlib>
@@ -160,6 +161,7 @@ CacheTestSM::event_handler(int event, void *data)
     cache_vc      = static_cast<CacheVConnection *>(data);
     return EVENT_CONT;
 
+  case CACHE_EVENT_SCAN_DIR:
   case CACHE_EVENT_SCAN_OBJECT:
     return CACHE_SCAN_RESULT_CONTINUE;
 
@@ -170,10 +172,8 @@ CacheTestSM::event_handler(int event, void *data)
     return CACHE_SCAN_RESULT_CONTINUE;
 
   case CACHE_EVENT_SCAN_DONE:
-    return EVENT_CONT;
-
   case CACHE_EVENT_SCAN_FAILED:
-    return EVENT_CONT;
+    goto Lcancel_next;
 
   case AIO_EVENT_DONE:
     goto Lnext;
@@ -397,6 +397,10 @@ EXCLUSIVE_REGRESSION_TEST(cache)(RegressionTest *t, int /* atype ATS_UNUSED */,
   pread_test.nbytes               = 100;
   pread_test.key                  = large_write_test.key;
 
+  CACHE_SM(t, scan_test, { cacheProcessor.scan_parallel(this, CACHE_SCAN_DIR | CACHE_SCAN_HEADERS, 0); });
+  scan_test.expect_initial_event = CACHE_EVENT_SCAN;
+  scan_test.expect_event         = CACHE_EVENT_SCAN_DONE;
+
   // clang-format off
   r_sequential(t,
       write_test.clone(),
@@ -411,6 +415,7 @@ EXCLUSIVE_REGRESSION_TEST(cache)(RegressionTest *t, int /* atype ATS_UNUSED */,
       replace_read_test.clone(),
       large_write_test.clone(),
       pread_test.clone(),
+      scan_test.clone(),
       nullptr)
   ->run(pstatus);
   // clang-format on
@@ -673,3 +678,169 @@ REGRESSION_TEST(ram_cache)(RegressionTest *t, int level, int *pstatus)
     }
   }
 }
+
+REGRESSION_TEST(ram_cache_hot_set)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  *pstatus = REGRESSION_TEST_PASSED;
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  CacheKey key;
+  Vol *vol = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+  std::vector<Ptr<IOBufferData>> data;
+  auto hash_of = [](int i) {
+    CryptoHash hash;
+    hash.u64[0] = (static_cast<uint64_t>(i) << 32) + i;
+    hash.u64[1] = (static_cast<uint64_t>(i) << 32) + i;
+    return hash;
+  };
+
+  // 20 entries, the first 5 of which are hit 3 times.
+  RamCache *cache = new_RamCacheCLFUS(new_ProxyMutex());
+  cache->init(1 << 20, vol);
+  for (int i = 0; i < 20; i++) {
+    IOBufferData *d = THREAD_ALLOC(ioDataAllocator, this_thread());
+    d->alloc(BUFFER_SIZE_INDEX_16K);
+    data.push_back(make_ptr(d));
+    CryptoHash hash = hash_of(i);
+    cache->put(&hash, d, 1 << 14, false, i);
+    for (int j = 0; j < (i < 5 ? 3 : 0); j++) {
+      Ptr<IOBufferData> got;
+      cache->get(&hash, &got, i);
+    }
+  }
+  std::vector<RamCacheHotEntry> entries;
+  cache->hot_set(entries, 10);
+  int hot = 0;
+  for (const RamCacheHotEntry &e : entries) {
+    hot += e.resident && e.hits >= 3 && e.auxkey < 5;
+  }
+  if (entries.size() != 10 || hot != 5) {
+    rprintf(t, "hot set of %zu entries, %d of the hottest\n", entries.size(), hot);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // A seeded entry is admitted on its first put, with the hits it had.
+  RamCache *warm = new_RamCacheCLFUS(new_ProxyMutex());
+  warm->init(1 << 20, vol);
+  for (const RamCacheHotEntry &e : entries) {
+    warm->seed(e);
+  }
+  CryptoHash hash = hash_of(0);
+  Ptr<IOBufferData> got;
+  std::vector<RamCacheHotEntry> warmed;
+  warm->put(&hash, data[0].get(), 1 << 14, false, 0);
+  warm->hot_set(warmed, 20);
+  auto found = std::find_if(warmed.begin(), warmed.end(), [](const RamCacheHotEntry &e) { return e.resident; });
+  if (!warm->get(&hash, &got, 0) || warmed.size() != 10 || found == warmed.end() || found->hits < 4) {
+    rprintf(t, "seeded entry not admitted with its hits\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  delete cache;
+  delete warm;
+}
+
+REGRESSION_TEST(cache_admission)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  CacheAdmissionFilter filter(4096, 3);
+  CryptoHash popular;
+  char buff[32];
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  CryptoContext().hash_immediate(popular, "popular", 7);
+  if (filter.admit(popular) || filter.admit(popular) || !filter.admit(popular)) {
+    rprintf(t, "popular document not admitted on its third request\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // Documents requested once must not get in, whatever is already counted.
+  int admitted = 0;
+  for (int i = 0; i < 4096; i++) {
+    CryptoHash hash;
+    snprintf(buff, sizeof(buff), "once-%d", i);
+    CryptoContext().hash_immediate(hash, buff, strlen(buff));
+    admitted += filter.admit(hash);
+  }
+  rprintf(t, "CacheAdmission one-off documents admitted %d\n", admitted);
+  if (admitted > 0) {
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  if (!filter.admit(popular) || filter.estimate(popular) < 3) {
+    rprintf(t, "popular document forgotten, estimate %d\n", filter.estimate(popular));
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+}
+
+REGRESSION_TEST(cache_tag_index)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  char path[] = "/tmp/cache_tag_index_XXXXXX";
+  int fd      = mkstemp(path);
+  char buff[32];
+
+  *pstatus = REGRESSION_TEST_PASSED;
+  if (fd < 0) {
+    rprintf(t, "cannot create %s\n", path);
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  close(fd);
+
+  uint64_t tags[CacheTagIndex::MAX_TAGS];
+  if (CacheTagIndex::parse(" product-1, ,section-2 product-1", tags, CacheTagIndex::MAX_TAGS) != 2 ||
+      tags[0] != CacheTagIndex::hash("product-1") || tags[1] != CacheTagIndex::hash("section-2")) {
+    rprintf(t, "tags not parsed\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // 100 documents of section-2, every tenth also of product-1.
+  CacheTagIndex *index = CacheTagIndex::open(path, 256, 42);
+  std::vector<CryptoHash> keys;
+  for (int i = 0; i < 100; i++) {
+    CryptoHash key;
+    snprintf(buff, sizeof(buff), "doc-%d", i);
+    CryptoContext().hash_immediate(key, buff, strlen(buff));
+    index->insert(key, i % 10 ? tags + 1 : tags, i % 10 ? 1 : 2, nullptr);
+  }
+  index->collect(tags[0], keys);
+  if (keys.size() != 10 || index->count() != 100) {
+    rprintf(t, "product-1 has %zu documents, %u entries left\n", keys.size(), index->count());
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // Tags are replaced when a document is written again, and survive a clean shutdown.
+  index->insert(keys[0], tags, 1, nullptr);
+  index->sync(true);
+  delete index;
+  index = CacheTagIndex::open(path, 256, 42);
+  keys.clear();
+  index->collect(tags[1], keys);
+  if (keys.size() != 99 || index->count() != 1) {
+    rprintf(t, "section-2 has %zu documents, %u entries left\n", keys.size(), index->count());
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  // A full table reuses entries, an index left open is reset.
+  int evicted = 0;
+  for (int i = 0; i < 300; i++) {
+    CryptoHash key;
+    snprintf(buff, sizeof(buff), "more-%d", i);
+    CryptoContext().hash_immediate(key, buff, strlen(buff));
+    evicted += index->insert(key, tags + 1, 1, nullptr);
+  }
+  if (index->count() != 256 || evicted != 45) {
+    rprintf(t, "full index has %u entries, %d evicted\n", index->count(), evicted);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  delete index;
+  index = CacheTagIndex::open(path, 256, 42);
+  if (index->count() != 0) {
+    rprintf(t, "index not reset after an unclean shutdown\n");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  delete index;
+  unlink(path);
+}
@@ -0,0 +1,223 @@
+/** @file
+
+  A second cache level on fast storage, holding copies of documents read often from the other volumes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+CacheTier *cache_tier = nullptr;
+
+extern Queue<CacheVol> cp_list;
+
+// Delete every entry carrying the tag of @a key. Entries of other keys sharing the tag go as well,
+// which only costs the tier a copy it can promote again.
+static void
+tier_dir_delete(const CacheKey *key, Vol *vol)
+{
+  Dir dir, *last_collision = nullptr;
+  while (dir_probe(key, vol, &dir, &last_collision)) {
+    dir_delete(key, vol, &dir);
+    last_collision = nullptr;
+  }
+}
+
+// Invalidates a copy whose tier volume was busy when its document was written.
+struct CacheTierInvalidate : public Continuation {
+  CacheKey key;
+  Vol *vol;
+
+  CacheTierInvalidate(Vol *avol, const CacheKey *akey) : Continuation(avol->mutex.get()), key(*akey), vol(avol)
+  {
+    SET_HANDLER(&CacheTierInvalidate::invalidate_event);
+  }
+
+  int
+  invalidate_event(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    tier_dir_delete(&key, vol);
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
+CacheTier *
+CacheTier::create()
+{
+  int n = 0;
+  for (CacheVol *cp = cp_list.head; cp; cp = cp->link.next) {
+    if (cp->tier) {
+      n += cp->num_vols;
+    }
+  }
+  if (n == 0) {
+    return nullptr;
+  }
+
+  CacheTier *tier = new CacheTier();
+  tier->vols      = static_cast<Vol **>(ats_malloc(n * sizeof(Vol *)));
+  for (CacheVol *cp = cp_list.head; cp; cp = cp->link.next) {
+    for (int i = 0; cp->tier && i < cp->num_vols; i++) {
+      if (cp->vols[i]) {
+        tier->vols[tier->num_vols++] = cp->vols[i];
+      }
+    }
+  }
+  if (tier->num_vols == 0) {
+    ats_free(tier->vols);
+    delete tier;
+    return nullptr;
+  }
+  if (cache_config_tier_promote_reads > 1) {
+    tier->reads = new CacheAdmissionFilter(cache_config_admission_counters, cache_config_tier_promote_reads);
+  }
+  return tier;
+}
+
+// Reads are still answered by the document's own volume when the tier volume is busy.
+Vol *
+CacheTier::lookup(const CacheKey *key, EThread *thread)
+{
+  Vol *vol = key_to_vol(key);
+  if (!vol->ready || !dir_probe_maybe_present(key, vol)) {
+    return nullptr;
+  }
+
+  Dir dir, *last_collision = nullptr;
+  CACHE_TRY_VOL_LOCK(lock, vol, thread);
+  if (!lock.is_locked() || !dir_probe(key, vol, &dir, &last_collision)) {
+    return nullptr;
+  }
+  return vol;
+}
+
+void
+CacheTier::promote(CacheVC *reader, Doc *doc)
+{
+  Vol *from = reader->vol;
+  ink_assert(from->mutex->thread_holding == this_ethread());
+
+  if (cache_config_tier_promote_reads == 0 || from->cache_vol->tier || reader->frag_type != CACHE_FRAG_TYPE_HTTP ||
+      reader->vector.count() != 1 || (reader->f.doc_from_ram_cache && !cache_config_tier_promote_ram_hits) ||
+      (cache_config_tier_max_doc_size && doc->total_len > static_cast<uint64_t>(cache_config_tier_max_doc_size))) {
+    return;
+  }
+  // Only copy the current version, nothing writing a new one and no newer head in the directory.
+  Dir head, *last_collision = nullptr;
+  if (from->open_read(&reader->first_key) || !dir_probe(&reader->first_key, from, &head, &last_collision) ||
+      dir_offset(&head) != dir_offset(&reader->dir)) {
+    return;
+  }
+  if (reads && !reads->admit(reader->first_key)) {
+    return;
+  }
+
+  Vol *vol          = key_to_vol(&reader->first_key);
+  ProxyMutex *mutex = from->mutex.get();
+  if (!vol->ready || dir_probe_maybe_present(&reader->first_key, vol)) {
+    return;
+  }
+  // The vector in the buffer has been unmarshalled in place, it goes to the tier marshalled again.
+  if (doc->hlen && reader->vector.marshal_length() != static_cast<int>(doc->hlen)) {
+    CACHE_INCREMENT_DYN_STAT(cache_tier_promote_failure_stat);
+    return;
+  }
+
+  CacheVC *c   = new_CacheVC(from);
+  c->base_stat = cache_tier_promote_active_stat;
+  CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  c->buf    = new_IOBufferData(iobuffer_size_to_index(doc->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  Doc *copy = reinterpret_cast<Doc *>(c->buf->data());
+  memcpy(static_cast<void *>(copy), doc, doc->len);
+  if (doc->hlen) {
+    reader->vector.marshal(copy->hdr(), copy->hlen);
+  }
+  if (cache_config_enable_checksum) {
+    copy->set_checksum();
+  }
+
+  c->vol         = vol;
+  c->mutex       = vol->mutex;
+  c->first_key   = c->key = reader->first_key;
+  c->f.evacuator = 1;
+  c->tier_epoch  = epoch(&c->first_key);
+  dir_clear(&c->overwrite_dir);
+  dir_set_head(&c->overwrite_dir, true);
+  dir_set_approx_size(&c->overwrite_dir, vol->round_to_approx_size(doc->len));
+  SET_CONTINUATION_HANDLER(c, &CacheVC::promoteWrite);
+  eventProcessor.schedule_imm(c, ET_CALL);
+}
+
+void
+CacheTier::invalidate(const CacheKey *key)
+{
+  epochs[key->slice32(0) % EPOCH_SLOTS].fetch_add(1);
+
+  Vol *vol = key_to_vol(key);
+  // a tier vol still starting up is cleared anyway
+  if (!vol->ready || !dir_probe_maybe_present(key, vol)) {
+    return;
+  }
+  MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+  if (lock.is_locked()) {
+    tier_dir_delete(key, vol);
+  } else {
+    eventProcessor.schedule_imm(new CacheTierInvalidate(vol, key), ET_CALL);
+  }
+}
+
+// The copy goes through the aggregation buffer like an evacuated document: agg_copy() writes the
+// buffer as it is and fills in the offset of the directory entry prepared in overwrite_dir.
+int
+CacheVC::promoteWrite(int event, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  Doc *doc = reinterpret_cast<Doc *>(buf->data());
+  agg_len  = vol->round_to_approx_size(doc->len);
+
+  Dir existing;
+  if (agg_len > static_cast<uint32_t>(vol->agg_size) || vol->agg_todo_size > cache_config_agg_write_backlog ||
+      dir_probe(&first_key, vol, &existing, &last_collision)) {
+    CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_FAILURE);
+    return free_CacheVC(this);
+  }
+
+  vol->agg_todo_size += agg_len;
+  SET_HANDLER(&CacheVC::promoteDocDone);
+  vol->agg.enqueue(this);
+  if (!vol->is_io_in_progress()) {
+    return vol->aggWrite(event, this);
+  }
+  return EVENT_CONT;
+}
+
+int
+CacheVC::promoteDocDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (cache_tier->epoch(&first_key) == tier_epoch) {
+    dir_insert(&first_key, vol, &dir);
+    closed = 1;
+  } else {
+    // written or removed meanwhile, the copy is left unreferenced in the log
+    CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_FAILURE);
+  }
+  return free_CacheVC(this);
+}
@@ -50,6 +50,88 @@ Cache::scan(Continuation *cont, const char *hostname, int host_len, int KB_per_s
   return &c->_action;
 }
 
+// Runs a CacheVC per vol for a parallel scan, forwarding their events to the caller with a single
+// CACHE_EVENT_SCAN_DONE once the last one is done. It shares the caller's mutex with the CacheVCs.
+struct CacheScanAll : public Continuation {
+  Action action;
+  int pending;
+  void *result = nullptr;
+
+  CacheScanAll(Continuation *cont, int vols) : Continuation(cont->mutex), pending(vols)
+  {
+    action = cont;
+    SET_HANDLER(&CacheScanAll::scanEvent);
+  }
+
+  int
+  scanEvent(int event, void *data)
+  {
+    switch (event) {
+    case CACHE_EVENT_SCAN_DIR:
+    case CACHE_EVENT_SCAN_OBJECT:
+    case CACHE_EVENT_SCAN_OPERATION_FAILED:
+      if (action.cancelled) {
+        return EVENT_DONE;
+      }
+      return action.continuation->handleEvent(event, data);
+    case CACHE_EVENT_SCAN_OPERATION_BLOCKED:
+      if (action.cancelled) {
+        return CACHE_SCAN_RESULT_CONTINUE;
+      }
+      return action.continuation->handleEvent(event, data);
+    default:
+      // CACHE_EVENT_SCAN_DONE, with the error of a vol that could not be read
+      if (data && !result) {
+        result = data;
+      }
+      if (--pending == 0) {
+        if (!action.cancelled) {
+          action.continuation->handleEvent(CACHE_EVENT_SCAN_DONE, result);
+        }
+        delete this;
+      }
+      return EVENT_DONE;
+    }
+  }
+};
+
+Action *
+Cache::scan_parallel(Continuation *cont, int flags, int KB_per_second)
+{
+  int nvols = 0;
+  for (int i = 0; i < gnvol; i++) {
+    nvols += !gvol[i]->cache_vol->tier; // tier volumes only hold copies
+  }
+  if (!CacheProcessor::IsCacheReady(CACHE_FRAG_TYPE_HTTP) || !nvols || !(flags & (CACHE_SCAN_DIR | CACHE_SCAN_HEADERS))) {
+    cont->handleEvent(CACHE_EVENT_SCAN_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
+
+  CacheScanAll *all = new CacheScanAll(cont, nvols);
+  for (int i = 0; i < gnvol; i++) {
+    if (gvol[i]->cache_vol->tier) {
+      continue;
+    }
+    CacheVC *c         = new_CacheVC(all);
+    c->vol             = gvol[i];
+    c->scan_flags      = flags;
+    c->base_stat       = cache_scan_active_stat;
+    c->scan_msec_delay = KB_per_second > 0 ? static_cast<int>(SCAN_BUF_SIZE / 1024 * nvols * 1000 / KB_per_second) : 0;
+    c->offset          = 0;
+    if (flags & CACHE_SCAN_HEADERS) {
+      c->buf = new_IOBufferData(BUFFER_SIZE_FOR_XMALLOC(SCAN_BUF_SIZE), MEMALIGNED);
+    }
+    if (flags & CACHE_SCAN_DIR) {
+      SET_CONTINUATION_HANDLER(c, &CacheVC::scanDir);
+    } else {
+      SET_CONTINUATION_HANDLER(c, &CacheVC::scanObject);
+    }
+    eventProcessor.schedule_imm(c, ET_CALL);
+  }
+  cont->handleEvent(CACHE_EVENT_SCAN, nullptr);
+  return &all->action;
+}
+
 int
 CacheVC::scanVol(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -57,6 +139,10 @@ CacheVC::scanVol(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (_action.cancelled) {
     return free_CacheVC(this);
   }
+  if (scan_flags) { // parallel scans stop at the end of their vol
+    _action.continuation->handleEvent(CACHE_EVENT_SCAN_DONE, nullptr);
+    return free_CacheVC(this);
+  }
   CacheHostRecord *rec = &theCache->hosttable->gen_host_rec;
   if (host_len) {
     CacheHostResult res;
@@ -157,6 +243,57 @@ make_vol_map(Vol *d)
   return vol_map;
 }
 
+// Visit the directory of a parallel scan a segment at a time, then go on with the documents.
+int
+CacheVC::scanDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  if (_action.cancelled) {
+    return free_CacheVC(this);
+  }
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+    return EVENT_CONT;
+  }
+
+  if (scan_segment < vol->segments) {
+    Dir *seg = vol->dir_segment(scan_segment);
+    for (int b = 0; b < vol->buckets; b++) {
+      Dir *e = dir_bucket(b, seg);
+      if (dir_bucket_loop_fix(e, scan_segment, vol)) {
+        break;
+      }
+      for (; e; e = next_dir(e, seg)) {
+        if (!dir_offset(e) || !dir_valid(vol, e) || !dir_agg_valid(vol, e)) {
+          continue;
+        }
+        CacheScanDirEntry entry;
+        entry.volume = vol->cache_vol->vol_number;
+        entry.tag    = dir_tag(e);
+        entry.head   = dir_head(e);
+        entry.pinned = dir_pinned(e);
+        entry.offset = vol->vol_offset(e);
+        entry.size   = dir_approx_size(e);
+        if (_action.continuation->handleEvent(CACHE_EVENT_SCAN_DIR, &entry) == EVENT_DONE) {
+          return free_CacheVC(this);
+        }
+      }
+    }
+    scan_segment++;
+    trigger = mutex->thread_holding->schedule_imm_local(this);
+    return EVENT_CONT;
+  }
+
+  if (scan_flags & CACHE_SCAN_HEADERS) {
+    fragment = 0;
+    SET_HANDLER(&CacheVC::scanObject);
+    return scanObject(EVENT_IMMEDIATE, nullptr);
+  }
+  _action.continuation->handleEvent(CACHE_EVENT_SCAN_DONE, nullptr);
+  return free_CacheVC(this);
+}
+
 int
 CacheVC::scanObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -176,7 +313,7 @@ CacheVC::scanObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
     return free_CacheVC(this);
   }
 
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (!lock.is_locked()) {
     Debug("cache_scan_truss", "delay %p:scanObject", this);
     mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
@@ -374,6 +511,12 @@ Lread:
     io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
   }
   offset = 0;
+  if (scan_flags && scan_msec_delay) {
+    // parallel scans pace their reads rather than their vols
+    SET_HANDLER(&CacheVC::scanRead);
+    trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(scan_msec_delay));
+    return EVENT_CONT;
+  }
   ink_assert(ink_aio_read(&io) >= 0);
   Debug("cache_scan_truss", "read %p:scanObject %" PRId64 " %zu", this, (int64_t)io.aiocb.aio_offset, (size_t)io.aiocb.aio_nbytes);
   return EVENT_CONT;
@@ -385,6 +528,19 @@ Lcancel:
   return free_CacheVC(this);
 }
 
+int
+CacheVC::scanRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  if (_action.cancelled) {
+    return free_CacheVC(this);
+  }
+  SET_HANDLER(&CacheVC::scanObject);
+  ink_assert(ink_aio_read(&io) >= 0);
+  Debug("cache_scan_truss", "read %p:scanRead %" PRId64 " %zu", this, (int64_t)io.aiocb.aio_offset, (size_t)io.aiocb.aio_nbytes);
+  return EVENT_CONT;
+}
+
 int
 CacheVC::scanRemoveDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -415,7 +571,7 @@ CacheVC::scanOpenWrite(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   int ret = 0;
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       Debug("cache_scan", "vol->mutex %p:scanOpenWrite", this);
       VC_SCHED_LOCK_RETRY();
@@ -490,7 +646,7 @@ CacheVC::scanUpdateDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   Debug("cache_scan_truss", "inside %p:scanUpdateDone", this);
   cancel_trigger();
   // get volume lock
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
   if (lock.is_locked()) {
     // insert a directory entry for the previous fragment
     dir_overwrite(&first_key, vol, &dir, &od->first_dir, false);
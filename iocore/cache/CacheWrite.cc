@@ -27,6 +27,41 @@
 #define UINT_WRAP_GTE(_x, _y) (((_x) - (_y)) < INT_MAX) // exploit overflow
 #define UINT_WRAP_LT(_x, _y) (((_x) - (_y)) >= INT_MAX) // exploit overflow
 
+static inline int
+target_fragment_size()
+{
+  uint64_t value = cache_config_target_fragment_size - sizeof(Doc);
+  ink_release_assert(value <= MAX_FRAG_SIZE);
+  return value;
+}
+
+// An object known to span more than this many fragments of the target size takes larger ones.
+static constexpr int64_t LARGE_OBJECT_FRAGMENTS = 8;
+
+// The fragment size of an object of @a size bytes on @a vol, INT64_MAX if not known: the target
+// size, doubled for a large object up to proxy.config.cache.target_fragment_size_max and to what
+// the aggregation buffer of the volume takes, each doubling halving its Doc, directory entries and seeks.
+static int64_t
+object_fragment_size(Vol *vol, int64_t size)
+{
+  int64_t frag = target_fragment_size();
+  if (!cache_config_target_fragment_size_max || size == INT64_MAX) {
+    return frag;
+  }
+  int64_t limit = std::min<int64_t>(cache_config_target_fragment_size_max, vol->agg_size) - sizeof(Doc);
+  while (frag < limit && size > frag * LARGE_OBJECT_FRAGMENTS) {
+    frag = std::min(frag * 2, limit);
+  }
+  return frag;
+}
+
+// The largest fragment of @a vc, whose target may be larger than those of the default aggregation buffer.
+static inline int64_t
+max_fragment_size(const CacheVC *vc)
+{
+  return std::max<int64_t>(MAX_FRAG_SIZE, vc->frag_size);
+}
+
 // Given a key, finds the index of the alternate which matches
 // used to get the alternate which is actually present in the document
 int
@@ -62,7 +97,7 @@ CacheVC::updateVector(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   int ret = 0;
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked() || od->writing_vec) {
       VC_SCHED_LOCK_RETRY();
     }
@@ -193,8 +228,8 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
   POP_HANDLER;
   agg_len = vol->round_to_approx_size(write_len + header_len + frag_len + sizeof(Doc));
   vol->agg_todo_size += agg_len;
-  bool agg_error = (agg_len > AGG_SIZE || header_len + sizeof(Doc) > MAX_FRAG_SIZE ||
-                    (!f.readers && (vol->agg_todo_size > cache_config_agg_write_backlog + AGG_SIZE) && write_len));
+  bool agg_error = (agg_len > static_cast<uint32_t>(vol->agg_size) || header_len + sizeof(Doc) > MAX_FRAG_SIZE ||
+                    (!f.readers && (vol->agg_todo_size > cache_config_agg_write_backlog + vol->agg_size) && write_len));
 #ifdef CACHE_AGG_FAIL_RATE
   agg_error = agg_error || ((uint32_t)mutex->thread_holding->generator.random() < (uint32_t)(UINT_MAX * CACHE_AGG_FAIL_RATE));
 #endif
@@ -211,7 +246,7 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
     }
     return handleEvent(AIO_EVENT_DONE, nullptr);
   }
-  ink_assert(agg_len <= AGG_SIZE);
+  ink_assert(agg_len <= static_cast<uint32_t>(vol->agg_size));
   if (f.evac_vector) {
     vol->agg.push(this);
   } else {
@@ -250,6 +285,32 @@ iobufferblock_memcpy(char *p, int len, IOBufferBlock *ab, int offset)
   return p;
 }
 
+/*
+   Keep a copy of the fragment the writer @a c just inserted in the
+   directory, the readers following it take the fragment from here
+   rather than reading it back from the disk each.
+   */
+void
+OpenDirEntry::fill_add(CacheVC *c)
+{
+  ink_assert(c->vol->mutex->thread_holding == this_ethread());
+  uint32_t len       = sizeof(Doc) + c->write_len;
+  IOBufferData *data = new_IOBufferData(iobuffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  Doc *doc           = reinterpret_cast<Doc *>(data->data());
+  memset(static_cast<void *>(doc), 0, sizeof(Doc));
+  doc->magic     = DOC_MAGIC;
+  doc->len       = len;
+  doc->total_len = c->total_len;
+  doc->first_key = c->first_key;
+  doc->key       = c->key;
+  doc->doc_type  = c->frag_type;
+  doc->v_major   = CACHE_DB_MAJOR_VERSION;
+  doc->v_minor   = CACHE_DB_MINOR_VERSION;
+  iobufferblock_memcpy(doc->data(), c->write_len, c->blocks.get(), c->offset);
+  fill[fill_pos] = data;
+  fill_pos       = (fill_pos + 1) % OPEN_DIR_FILL_FRAGMENTS;
+}
+
 EvacuationBlock *
 Vol::force_evacuate_head(Dir *evac_dir, int pinned)
 {
@@ -280,8 +341,8 @@ Vol::scan_for_pinned_documents()
 {
   if (cache_config_permit_pinning) {
     // we can't evacuate anything between header->write_pos and
-    // header->write_pos + AGG_SIZE.
-    int ps                = this->offset_to_vol_offset(header->write_pos + AGG_SIZE);
+    // header->write_pos + agg_size.
+    int ps                = this->offset_to_vol_offset(header->write_pos + agg_size);
     int pe                = this->offset_to_vol_offset(header->write_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
     int vol_end_offset    = this->offset_to_vol_offset(len + skip);
     int before_end_of_vol = pe < vol_end_offset;
@@ -308,54 +369,96 @@ Vol::scan_for_pinned_documents()
   }
 }
 
+void
+Vol::agg_buffers_init()
+{
+  agg_size         = std::clamp<int64_t>(cache_config_agg_write_buffer_size, AGG_SIZE, AGG_MAX_SIZE);
+  agg_buffer_count = std::clamp(cache_config_agg_write_buffers, 1, AGG_MAX_BUFFERS);
+  agg_buffers      = new AggWriteBuffer[agg_buffer_count];
+  for (int i = 0; i < agg_buffer_count; i++) {
+    agg_buffers[i].vol    = this;
+    agg_buffers[i].mutex  = mutex;
+    agg_buffers[i].buffer = static_cast<char *>(ats_memalign(ats_pagesize(), agg_size));
+    memset(agg_buffers[i].buffer, 0, agg_size);
+  }
+  agg_buffer = agg_buffers[0].buffer;
+}
+
+// The copy of the @a n bytes at @a pos in the aggregation buffers, see vol_in_phase_agg_buf_valid().
+char *
+Vol::agg_data(off_t pos, size_t n)
+{
+  if (pos >= header->write_pos) {
+    ink_assert(pos + n <= static_cast<size_t>(header->write_pos + agg_buf_pos));
+    return agg_buffer + (pos - header->write_pos);
+  }
+  for (int i = 0; i < agg_writes_in_flight; i++) {
+    AggWriteBuffer *w = &agg_buffers[(agg_write_head + i) % agg_buffer_count];
+    off_t o           = w->io.aiocb.aio_offset;
+    if (pos >= o && pos < static_cast<off_t>(o + w->io.aiocb.aio_nbytes)) {
+      ink_assert(pos + n <= o + w->io.aiocb.aio_nbytes);
+      return w->buffer + (pos - o);
+    }
+  }
+  ink_assert(!"not in the aggregation buffers");
+  return nullptr;
+}
+
 /* NOTE:: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
    eventProcessor.schedule_xxx().
    */
 int
-Vol::aggWriteDone(int event, Event *e)
+AggWriteBuffer::writeDone(int event, Event * /* e ATS_UNUSED */)
 {
-  cancel_trigger();
-
+  if (event == AIO_EVENT_DONE) {
+    done = true; // not on a lock retry, the buffer may be written again by then
+  }
   // ensure we have the cacheDirSync lock if we intend to call it later
   // retaking the current mutex recursively is a NOOP
-  CACHE_TRY_LOCK(lock, dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
+  CACHE_TRY_LOCK(lock, vol->dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
   }
-  if (io.ok()) {
-    header->last_write_pos = header->write_pos;
-    header->write_pos += io.aiocb.aio_nbytes;
-    ink_assert(header->write_pos >= start);
-    DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
-           header->last_write_pos);
-    ink_assert(header->write_pos == header->agg_pos);
-    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
-      periodic_scan();
-    }
-    agg_buf_pos = 0;
-    header->write_serial++;
-  } else {
-    // delete all the directory entries that we inserted
-    // for fragments is this aggregation buffer
-    Debug("cache_disk_error", "Write error on disk %s\n \
+  return vol->aggWriteDone(AIO_EVENT_DONE, nullptr);
+}
+
+// Writes complete in any order, they are accounted for in the order they were issued, so that
+// write_serial only counts writes whose predecessors are all on disk.
+int
+Vol::aggWriteDone(int event, Event *e)
+{
+  ink_assert(mutex->thread_holding == this_ethread());
+  while (agg_writes_in_flight && agg_buffers[agg_write_head].done) {
+    AggWriteBuffer *w = &agg_buffers[agg_write_head];
+    if (w->io.ok()) {
+      DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(),
+             (uint64_t)(w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes), (uint64_t)w->io.aiocb.aio_offset);
+      header->write_serial++;
+    } else {
+      // delete all the directory entries that we inserted
+      // for fragments is this aggregation buffer
+      Debug("cache_disk_error", "Write error on disk %s\n \
               write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
-          hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
-          (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
-          (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
-    Dir del_dir;
-    dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
-      dir_set_offset(&del_dir, header->write_pos + done);
-      dir_delete(&doc->key, this, &del_dir);
-      done += round_to_approx_size(doc->len);
+            hash_text.get(), (uint64_t)w->io.aiocb.aio_offset, (uint64_t)w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes,
+            (uint64_t)w->io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
+            (uint64_t)(w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
+      Dir del_dir;
+      dir_clear(&del_dir);
+      for (int done = 0; done < static_cast<int>(w->io.aiocb.aio_nbytes);) {
+        Doc *doc = reinterpret_cast<Doc *>(w->buffer + done);
+        dir_set_offset(&del_dir, offset_to_vol_offset(w->io.aiocb.aio_offset + done));
+        dir_delete(&doc->key, this, &del_dir);
+        done += round_to_approx_size(doc->len);
+      }
     }
-    agg_buf_pos = 0;
+    w->done        = false;
+    agg_write_head = (agg_write_head + 1) % agg_buffer_count;
+    agg_writes_in_flight--;
   }
-  set_io_not_in_progress();
+  agg_buffer = agg_buffers[(agg_write_head + agg_writes_in_flight) % agg_buffer_count].buffer;
   // callback ready sync CacheVCs
   CacheVC *c = nullptr;
   while ((c = sync.dequeue())) {
@@ -366,11 +469,11 @@ Vol::aggWriteDone(int event, Event *e)
       break;
     }
   }
-  if (dir_sync_waiting) {
+  if (dir_sync_waiting && !agg_writes_in_flight) {
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
+  if ((agg.head || sync.head) && !is_io_in_progress()) {
     return aggWrite(event, e);
   }
   return EVENT_CONT;
@@ -585,8 +688,8 @@ evacuate_fragments(CacheKey *key, CacheKey *earliest_key, int force, Vol *vol)
   return i;
 }
 
-int
-Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
+void
+Vol::evacuate_enqueue(CacheVC *evacuator)
 {
   // push to front of aggregation write list, so it is written first
 
@@ -598,45 +701,49 @@ Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
   for (; cur && cur->f.evacuator; cur = (CacheVC *)cur->link.next) {
     after = cur;
   }
-  ink_assert(evacuator->agg_len <= AGG_SIZE);
+  ink_assert(evacuator->agg_len <= static_cast<uint32_t>(agg_size));
   agg.insert(evacuator, after);
-  return aggWrite(event, e);
 }
 
 int
-Vol::evacuateDocReadDone(int event, Event *e)
+Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
+{
+  evacuate_enqueue(evacuator);
+  return aggWrite(event, e);
+}
+
+// Sort out which document @\a evacuator read, @return @c false if it need not be written again.
+bool
+Vol::evacuate_doc_read(CacheVC *evacuator)
 {
-  cancel_trigger();
-  if (event != AIO_EVENT_DONE) {
-    return EVENT_DONE;
-  }
-  ink_assert(is_io_in_progress());
-  set_io_not_in_progress();
   ink_assert(mutex->thread_holding == this_ethread());
-  Doc *doc = reinterpret_cast<Doc *>(doc_evacuator->buf->data());
+  Doc *doc = reinterpret_cast<Doc *>(evacuator->buf->data());
   CacheKey next_key;
   EvacuationBlock *b = nullptr;
   if (doc->magic != DOC_MAGIC) {
-    Debug("cache_evac", "DOC magic: %X %d", (int)dir_tag(&doc_evacuator->overwrite_dir),
-          (int)dir_offset(&doc_evacuator->overwrite_dir));
+    Debug("cache_evac", "DOC magic: %X %d", (int)dir_tag(&evacuator->overwrite_dir), (int)dir_offset(&evacuator->overwrite_dir));
     ink_assert(doc->magic == DOC_MAGIC);
-    goto Ldone;
+    return false;
   }
-  DDebug("cache_evac", "evacuateDocReadDone %X offset %d", (int)doc->key.slice32(0),
-         (int)dir_offset(&doc_evacuator->overwrite_dir));
+  DDebug("cache_evac", "evacuateDocReadDone %X offset %d", (int)doc->key.slice32(0), (int)dir_offset(&evacuator->overwrite_dir));
 
-  b = evacuate[dir_evac_bucket(&doc_evacuator->overwrite_dir)].head;
+  b = evacuate[dir_evac_bucket(&evacuator->overwrite_dir)].head;
   while (b) {
-    if (dir_offset(&b->dir) == dir_offset(&doc_evacuator->overwrite_dir)) {
+    if (dir_offset(&b->dir) == dir_offset(&evacuator->overwrite_dir)) {
       break;
     }
     b = b->link.next;
   }
   if (!b) {
-    goto Ldone;
+    return false;
   }
   if ((b->f.pinned && !b->readers) && doc->pinned < static_cast<uint32_t>(Thread::get_hrtime() / HRTIME_SECOND)) {
-    goto Ldone;
+    return false;
+  }
+  // A fragment written with a larger aggregation buffer than the volume has now is not written again.
+  if (round_to_approx_size(doc->len) > static_cast<uint32_t>(agg_size)) {
+    Debug("cache_evac", "fragment of %u bytes too large to evacuate", doc->len);
+    return false;
   }
 
   if (dir_head(&b->dir) && b->f.evacuate_head) {
@@ -644,23 +751,23 @@ Vol::evacuateDocReadDone(int event, Event *e)
     // if its a head (vector), evacuation is real simple...we just
     // need to write this vector down and overwrite the directory entry.
     if (dir_compare_tag(&b->dir, &doc->first_key)) {
-      doc_evacuator->key = doc->first_key;
-      b->evac_frags.key  = doc->first_key;
+      evacuator->key    = doc->first_key;
+      b->evac_frags.key = doc->first_key;
       DDebug("cache_evac", "evacuating vector %X offset %d", (int)doc->first_key.slice32(0),
-             (int)dir_offset(&doc_evacuator->overwrite_dir));
+             (int)dir_offset(&evacuator->overwrite_dir));
       b->f.unused = 57;
     } else {
       // if its an earliest fragment (alternate) evacuation, things get
       // a little tricky. We have to propagate the earliest key to the next
       // fragments for this alternate. The last fragment to be evacuated
       // fixes up the lookaside buffer.
-      doc_evacuator->key          = doc->key;
-      doc_evacuator->earliest_key = doc->key;
-      b->evac_frags.key           = doc->key;
-      b->evac_frags.earliest_key  = doc->key;
-      b->earliest_evacuator       = doc_evacuator;
+      evacuator->key             = doc->key;
+      evacuator->earliest_key    = doc->key;
+      b->evac_frags.key          = doc->key;
+      b->evac_frags.earliest_key = doc->key;
+      b->earliest_evacuator      = evacuator;
       DDebug("cache_evac", "evacuating earliest %X %X evac: %p offset: %d", (int)b->evac_frags.key.slice32(0),
-             (int)doc->key.slice32(0), doc_evacuator, (int)dir_offset(&doc_evacuator->overwrite_dir));
+             (int)doc->key.slice32(0), evacuator, (int)dir_offset(&evacuator->overwrite_dir));
       b->f.unused = 67;
     }
   } else {
@@ -671,10 +778,10 @@ Vol::evacuateDocReadDone(int event, Event *e)
     }
     if (!ek) {
       b->f.unused = 77;
-      goto Ldone;
+      return false;
     }
-    doc_evacuator->key          = ek->key;
-    doc_evacuator->earliest_key = ek->earliest_key;
+    evacuator->key          = ek->key;
+    evacuator->earliest_key = ek->earliest_key;
     DDebug("cache_evac", "evacuateDocReadDone key: %X earliest: %X", (int)ek->key.slice32(0), (int)ek->earliest_key.slice32(0));
     b->f.unused = 87;
   }
@@ -684,17 +791,30 @@ Vol::evacuateDocReadDone(int event, Event *e)
   // Cache::open_write).
   if (!dir_head(&b->dir) || !dir_compare_tag(&b->dir, &doc->first_key)) {
     next_CacheKey(&next_key, &doc->key);
-    evacuate_fragments(&next_key, &doc_evacuator->earliest_key, !b->readers, this);
+    evacuate_fragments(&next_key, &evacuator->earliest_key, !b->readers, this);
+  }
+  return true;
+}
+
+int
+Vol::evacuateDocReadDone(int event, Event *e)
+{
+  cancel_trigger();
+  if (event != AIO_EVENT_DONE) {
+    return EVENT_DONE;
+  }
+  ink_assert(is_io_in_progress());
+  set_io_not_in_progress();
+  if (evacuate_doc_read(doc_evacuator)) {
+    return evacuateWrite(doc_evacuator, event, e);
   }
-  return evacuateWrite(doc_evacuator, event, e);
-Ldone:
   free_CacheVC(doc_evacuator);
   doc_evacuator = nullptr;
   return aggWrite(event, e);
 }
 
-int
-Vol::evac_range(off_t low, off_t high, int evac_phase)
+EvacuationBlock *
+Vol::evac_next(off_t low, off_t high, int evac_phase)
 {
   off_t s = this->offset_to_vol_offset(low);
   off_t e = this->offset_to_vol_offset(high);
@@ -716,26 +836,158 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
       }
     }
     if (first) {
-      first->f.done       = 1;
-      io.aiocb.aio_fildes = fd;
-      io.aiocb.aio_nbytes = dir_approx_size(&first->dir);
-      io.aiocb.aio_offset = this->vol_offset(&first->dir);
-      if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
-        io.aiocb.aio_nbytes = skip + len - io.aiocb.aio_offset;
-      }
-      doc_evacuator                = new_DocEvacuator(io.aiocb.aio_nbytes, this);
-      doc_evacuator->overwrite_dir = first->dir;
+      return first;
+    }
+  }
+  return nullptr;
+}
+
+int
+Vol::evac_range(off_t low, off_t high, int evac_phase)
+{
+  EvacuationBlock *first = evac_next(low, high, evac_phase);
+  if (!first) {
+    return 0;
+  }
+  first->f.done       = 1;
+  io.aiocb.aio_fildes = fd;
+  io.aiocb.aio_nbytes = dir_approx_size(&first->dir);
+  io.aiocb.aio_offset = this->vol_offset(&first->dir);
+  if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
+    io.aiocb.aio_nbytes = skip + len - io.aiocb.aio_offset;
+  }
+  doc_evacuator                = new_DocEvacuator(io.aiocb.aio_nbytes, this);
+  doc_evacuator->overwrite_dir = first->dir;
+  {
+    Vol *vol = this;
+    CACHE_SUM_DYN_STAT(cache_evacuate_bytes_stat, io.aiocb.aio_nbytes);
+  }
+
+  io.aiocb.aio_buf = doc_evacuator->buf->data();
+  io.action        = this;
+  io.thread        = AIO_CALLBACK_THREAD_ANY;
+  io.priority      = AIO_PRIORITY_WRITE; // the aggregation write waits for it
+  DDebug("cache_evac", "evac_range evacuating %X %d", (int)dir_tag(&first->dir), (int)dir_offset(&first->dir));
+  SET_HANDLER(&Vol::evacuateDocReadDone);
+  ink_assert(ink_aio_read(&io) >= 0);
+  return -1;
+}
+
+/*
+  Reads the documents to evacuate from the part of the volume ahead of the range aggWrite()
+  evacuates itself, one at a time and at most proxy.config.cache.evacuate.background.rate bytes
+  a second, with the lowest AIO priority so they do not delay reads of the cache.  A document it
+  read joins the aggregation queue like any other evacuated document, and the write head waits
+  for a read still in flight ahead of it.  What it did not get to is left to aggWrite().
+*/
+struct BackgroundEvacuator : public Continuation {
+  static constexpr ink_hrtime PERIOD = HRTIME_MSECONDS(50);
 
-      io.aiocb.aio_buf = doc_evacuator->buf->data();
-      io.action        = this;
-      io.thread        = AIO_CALLBACK_THREAD_ANY;
-      DDebug("cache_evac", "evac_range evacuating %X %d", (int)dir_tag(&first->dir), (int)dir_offset(&first->dir));
-      SET_HANDLER(&Vol::evacuateDocReadDone);
-      ink_assert(ink_aio_read(&io) >= 0);
-      return -1;
+  Vol *vol;
+  AIOCallbackInternal io;
+  CacheVC *evacuator = nullptr;
+  int64_t budget     = 0;
+
+  explicit BackgroundEvacuator(Vol *avol) : Continuation(avol->mutex.get()), vol(avol)
+  {
+    SET_HANDLER(&BackgroundEvacuator::mainEvent);
+    io.aiocb.aio_fildes = vol->fd;
+    io.action           = this;
+    io.thread           = AIO_CALLBACK_THREAD_ANY;
+    io.priority         = AIO_PRIORITY_EVACUATE;
+  }
+
+  /// Whether a read is in flight over part of [@a low, @a high).
+  bool
+  reads_within(off_t low, off_t high) const
+  {
+    return evacuator && static_cast<off_t>(io.aiocb.aio_offset) < high &&
+           static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > low;
+  }
+
+  EvacuationBlock *
+  next_block() const
+  {
+    off_t end  = vol->skip + vol->len;
+    off_t low  = vol->header->write_pos + vol->agg_buf_pos + EVACUATION_SIZE;
+    off_t high = low + cache_config_evacuate_background_window;
+
+    EvacuationBlock *b = nullptr;
+    if (low < end) {
+      b = vol->evac_next(low, std::min(high, end), !vol->header->phase);
     }
+    if (!b && high > end) {
+      // documents of the current phase, written since the volume last wrapped
+      off_t wrapped = std::min<off_t>(vol->start + (high - end), vol->header->write_pos);
+      b             = vol->evac_next(vol->start + std::max<off_t>(low - end, 0), wrapped, vol->header->phase);
+    }
+    return b;
   }
-  return 0;
+
+  void
+  read_next()
+  {
+    int64_t quantum = cache_config_evacuate_background_rate * PERIOD / HRTIME_SECOND;
+    EvacuationBlock *b;
+    if (evacuator || (quantum && budget <= 0) || !(b = next_block())) {
+      return;
+    }
+    b->f.done           = 1;
+    io.aiocb.aio_nbytes = dir_approx_size(&b->dir);
+    io.aiocb.aio_offset = vol->vol_offset(&b->dir);
+    if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
+      io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
+    }
+    evacuator                = new_DocEvacuator(io.aiocb.aio_nbytes, vol);
+    evacuator->overwrite_dir = b->dir;
+    io.aiocb.aio_buf         = evacuator->buf->data();
+    budget -= io.aiocb.aio_nbytes;
+    DDebug("cache_evac", "background evacuating %X %d", (int)dir_tag(&b->dir), (int)dir_offset(&b->dir));
+    ink_assert(ink_aio_read(&io) >= 0);
+  }
+
+  int
+  mainEvent(int event, void * /* data ATS_UNUSED */)
+  {
+    ink_assert(vol->mutex->thread_holding == this_ethread());
+    if (event == AIO_EVENT_DONE) {
+      CacheVC *c = evacuator;
+      evacuator  = nullptr;
+      {
+        ProxyMutex *mutex = vol->mutex.get();
+        CACHE_SUM_DYN_STAT(cache_evacuate_background_bytes_stat, io.aiocb.aio_nbytes);
+      }
+      if (io.ok() && vol->evacuate_doc_read(c)) {
+        vol->evacuate_enqueue(c);
+      } else {
+        free_CacheVC(c);
+      }
+      if (!vol->is_io_in_progress()) {
+        vol->aggWrite(event, nullptr);
+      }
+    } else {
+      int64_t quantum = cache_config_evacuate_background_rate * PERIOD / HRTIME_SECOND;
+      budget          = std::min(budget + quantum, quantum);
+    }
+    read_next();
+    return EVENT_CONT;
+  }
+};
+
+bool
+Vol::background_reads_within(off_t low, off_t high) const
+{
+  return background_evacuator && background_evacuator->reads_within(low, high);
+}
+
+void
+Vol::start_background_evacuation()
+{
+  if (cache_config_evacuate_background_window <= 0 || fd < 0 || background_evacuator) {
+    return;
+  }
+  background_evacuator = new BackgroundEvacuator(this);
+  eventProcessor.schedule_every(background_evacuator, BackgroundEvacuator::PERIOD, ET_CALL);
 }
 
 static int
@@ -764,12 +1016,12 @@ agg_copy(char *p, CacheVC *vc)
     doc->doc_type    = vc->frag_type;
     doc->v_major     = CACHE_DB_MAJOR_VERSION;
     doc->v_minor     = CACHE_DB_MINOR_VERSION;
-    doc->unused      = 0; // force this for forward compatibility.
     doc->total_len   = vc->total_len;
     doc->first_key   = vc->first_key;
     doc->sync_serial = vol->header->sync_serial;
-    vc->write_serial = doc->write_serial = vol->header->write_serial;
+    vc->write_serial = doc->write_serial = vol->agg_write_serial();
     doc->checksum                        = DOC_NO_CHECKSUM;
+    doc->checksum_type                   = DOC_CHECKSUM_SUM;
     if (vc->pin_in_cache) {
       dir_set_pinned(&vc->dir, 1);
       doc->pinned = static_cast<uint32_t>(Thread::get_hrtime() / HRTIME_SECOND) + vc->pin_in_cache;
@@ -853,10 +1105,7 @@ agg_copy(char *p, CacheVC *vc)
 #endif
     }
     if (cache_config_enable_checksum) {
-      doc->checksum = 0;
-      for (char *b = doc->hdr(); b < reinterpret_cast<char *>(doc) + doc->len; b++) {
-        doc->checksum += *b;
-      }
+      doc->set_checksum();
     }
     if (vc->frag_type == CACHE_FRAG_TYPE_HTTP && vc->f.single_fragment) {
       ink_assert(doc->hlen);
@@ -879,7 +1128,7 @@ agg_copy(char *p, CacheVC *vc)
     }
 
     doc->sync_serial  = vc->vol->header->sync_serial;
-    doc->write_serial = vc->vol->header->write_serial;
+    doc->write_serial = vc->vol->agg_write_serial();
 
     memcpy(p, doc, doc->len);
 
@@ -984,14 +1233,17 @@ Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
   CacheVC *c;
 
   cancel_trigger();
+  if (agg_writes_in_flight == agg_buffer_count) {
+    return EVENT_CONT; // aggWriteDone() calls back when a buffer is free
+  }
 
 Lagain:
   // calculate length of aggregated write
   for (c = static_cast<CacheVC *>(agg.head); c;) {
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
-    ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    ink_assert(writelen <= agg_size);
+    if (agg_buf_pos + writelen > agg_size || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
     DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
@@ -1015,10 +1267,12 @@ Lagain:
     c = n;
   }
 
+  off_t end;
+
   // if we got nothing...
   if (!agg_buf_pos) {
     if (!agg.head && !sync.head) { // nothing to get
-      return EVENT_CONT;
+      goto Lwait;
     }
     if (header->write_pos == start) {
       // write aggregation too long, bad bad, punt on everything.
@@ -1031,15 +1285,22 @@ Lagain:
       }
       return EVENT_CONT;
     }
-    // start back
+    // start back, once the writes before the end are done
     if (agg.head) {
+      if (agg_writes_in_flight) {
+        goto Lwait;
+      }
       agg_wrap();
       goto Lagain;
     }
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
+  end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
+  if (background_reads_within(header->write_pos, end) ||
+      (end > skip + len && background_reads_within(start, start + (end - (skip + len))))) {
+    goto Lwait;
+  }
   if (evac_range(header->write_pos, end, !header->phase) < 0) {
     goto Lwait;
   }
@@ -1051,7 +1312,7 @@ Lagain:
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buf_pos < agg_size / 2 && !agg.head && !sync.head && !dir_sync_waiting) {
     goto Lwait;
   }
 
@@ -1065,25 +1326,44 @@ Lagain:
     d->magic        = DOC_MAGIC;
     d->len          = l;
     d->sync_serial  = header->sync_serial;
-    d->write_serial = header->write_serial;
+    d->write_serial = agg_write_serial();
   }
 
-  // set write limit
-  header->agg_pos = header->write_pos + agg_buf_pos;
+  {
+    AggWriteBuffer *w = &agg_buffers[(agg_write_head + agg_writes_in_flight) % agg_buffer_count];
+    ink_assert(w->buffer == agg_buffer && !w->done);
+    w->io.aiocb.aio_fildes = fd;
+    w->io.aiocb.aio_offset = header->write_pos;
+    w->io.aiocb.aio_buf    = agg_buffer;
+    w->io.aiocb.aio_nbytes = agg_buf_pos;
+    w->io.action           = w;
+    /*
+      Callback on AIO thread so that we can issue a new write ASAP
+      as all writes are serialized in the volume.  This is not necessary
+      for reads proceed independently.
+     */
+    w->io.thread   = AIO_CALLBACK_THREAD_AIO;
+    w->io.priority = AIO_PRIORITY_WRITE;
 
-  io.aiocb.aio_fildes = fd;
-  io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
-  io.action           = this;
-  /*
-    Callback on AIO thread so that we can issue a new write ASAP
-    as all writes are serialized in the volume.  This is not necessary
-    for reads proceed independently.
-   */
-  io.thread = AIO_CALLBACK_THREAD_AIO;
-  SET_HANDLER(&Vol::aggWriteDone);
-  ink_aio_write(&io);
+    // The write position moves past the buffer now, its documents are read from memory until
+    // the write is done, see vol_in_phase_agg_buf_valid().
+    header->last_write_pos = header->write_pos;
+    header->write_pos += agg_buf_pos;
+    ink_assert(header->write_pos >= start);
+    // set write limit
+    header->agg_pos = header->write_pos;
+    agg_writes_in_flight++;
+    agg_buffer  = agg_buffers[(agg_write_head + agg_writes_in_flight) % agg_buffer_count].buffer;
+    agg_buf_pos = 0;
+    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
+      periodic_scan();
+    }
+    ink_aio_write(&w->io);
+  }
+  // fill the next buffer meanwhile
+  if (agg.head && agg_writes_in_flight < agg_buffer_count) {
+    goto Lagain;
+  }
 
 Lwait:
   int ret = EVENT_CONT;
@@ -1102,7 +1382,7 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
 {
   cancel_trigger();
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       SET_HANDLER(&CacheVC::openWriteCloseDir);
       ink_assert(!is_io_in_progress());
@@ -1135,6 +1415,7 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
   // size of the document
   if ((closed == 1) && (total_len > 0 || f.allow_empty_doc)) {
     DDebug("cache_stats", "Fragment = %d", fragment);
+    CACHE_SUM_DYN_STAT(cache_write_fragments_stat, fragment + 1);
     switch (fragment) {
     case 0:
       CACHE_INCREMENT_DYN_STAT(cache_single_fragment_document_count_stat);
@@ -1165,7 +1446,7 @@ CacheVC::openWriteCloseHeadDone(int event, Event *e)
     return EVENT_CONT;
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_LOCK_RETRY_EVENT();
     }
@@ -1244,7 +1525,7 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     return openWriteCloseDir(event, e);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, this_ethread());
+    CACHE_TRY_VOL_LOCK(lock, vol, this_ethread());
     if (!lock.is_locked()) {
       VC_LOCK_RETRY_EVENT();
     }
@@ -1264,10 +1545,7 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
     if (length) {
-      write_len = length;
-      if (write_len > MAX_FRAG_SIZE) {
-        write_len = MAX_FRAG_SIZE;
-      }
+      write_len = std::min<int64_t>(length, max_fragment_size(this));
       if ((ret = do_write_call()) == EVENT_RETURN) {
         goto Lcallreturn;
       }
@@ -1304,12 +1582,9 @@ CacheVC::openWriteClose(int event, Event *e)
         return openWriteCloseDir(event, e);
       }
     }
-    if (length && (fragment || length > static_cast<int>(MAX_FRAG_SIZE))) {
+    if (length && (fragment || length > max_fragment_size(this))) {
       SET_HANDLER(&CacheVC::openWriteCloseDataDone);
-      write_len = length;
-      if (write_len > MAX_FRAG_SIZE) {
-        write_len = MAX_FRAG_SIZE;
-      }
+      write_len = std::min<int64_t>(length, max_fragment_size(this));
       return do_write_lock_call();
     } else {
       return openWriteCloseHead(event, e);
@@ -1338,7 +1613,7 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     return calluser(VC_EVENT_ERROR);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_LOCK_RETRY_EVENT();
     }
@@ -1358,6 +1633,13 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
     DDebug("cache_insert", "WriteDone: %X, %X, %d", key.slice32(0), first_key.slice32(0), write_len);
+    if (od) {
+      // the readers following this writer start with the earliest fragment, they read it anyway
+      if (f.readers && fragment > 1) {
+        od->fill_add(this);
+      }
+      od->fill_wake(mutex->thread_holding);
+    }
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
   }
@@ -1368,14 +1650,6 @@ CacheVC::openWriteWriteDone(int event, Event *e)
   return openWriteMain(event, e);
 }
 
-static inline int
-target_fragment_size()
-{
-  uint64_t value = cache_config_target_fragment_size - sizeof(Doc);
-  ink_release_assert(value <= MAX_FRAG_SIZE);
-  return value;
-}
-
 int
 CacheVC::openWriteMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -1401,17 +1675,24 @@ Lagain:
       return EVENT_CONT;
     }
   }
+  if (!frag_size) {
+    frag_size = object_fragment_size(vol, vio.nbytes);
+    if (frag_size > target_fragment_size()) {
+      CACHE_INCREMENT_DYN_STAT(cache_write_large_fragment_document_stat);
+    }
+  }
   int64_t ntodo       = static_cast<int64_t>(vio.ntodo() + length);
   int64_t total_avail = vio.buffer.reader()->read_avail();
   int64_t avail       = total_avail;
   int64_t towrite     = avail + length;
+  int64_t max_frag    = max_fragment_size(this);
   if (towrite > ntodo) {
     avail -= (towrite - ntodo);
     towrite = ntodo;
   }
-  if (towrite > static_cast<int>(MAX_FRAG_SIZE)) {
-    avail -= (towrite - MAX_FRAG_SIZE);
-    towrite = MAX_FRAG_SIZE;
+  if (towrite > max_frag) {
+    avail -= (towrite - max_frag);
+    towrite = max_frag;
   }
   if (!blocks && towrite) {
     blocks = vio.buffer.reader()->block;
@@ -1423,12 +1704,12 @@ Lagain:
     total_len += avail;
   }
   length = static_cast<uint64_t>(towrite);
-  if (length > target_fragment_size() && (length < target_fragment_size() + target_fragment_size() / 4)) {
-    write_len = target_fragment_size();
+  if (length > frag_size && (length < frag_size + frag_size / 4)) {
+    write_len = frag_size;
   } else {
     write_len = length;
   }
-  bool not_writing = towrite != ntodo && towrite < target_fragment_size();
+  bool not_writing = towrite != ntodo && towrite < frag_size;
   if (!called_user) {
     if (not_writing) {
       called_user = 1;
@@ -1479,7 +1760,7 @@ CacheVC::openWriteOverwrite(int event, Event *e)
     goto Ldone;
   }
 Lcollision : {
-  CACHE_TRY_LOCK(lock, vol->mutex, this_ethread());
+  CACHE_TRY_VOL_LOCK(lock, vol, this_ethread());
   if (!lock.is_locked()) {
     VC_LOCK_RETRY_EVENT();
   }
@@ -1512,7 +1793,7 @@ CacheVC::openWriteStartDone(int event, Event *e)
     set_io_not_in_progress();
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, vol, mutex->thread_holding);
     if (!lock.is_locked()) {
       VC_LOCK_RETRY_EVENT();
     }
@@ -1778,7 +2059,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   c->pin_in_cache = static_cast<uint32_t>(apin_in_cache);
 
   {
-    CACHE_TRY_LOCK(lock, c->vol->mutex, cont->mutex->thread_holding);
+    CACHE_TRY_VOL_LOCK(lock, c->vol, cont->mutex->thread_holding);
     if (lock.is_locked()) {
       if ((err = c->vol->open_write(c, if_writers, cache_config_http_max_alts > 1 ? cache_config_http_max_alts : 0)) > 0) {
         goto Lfailure;
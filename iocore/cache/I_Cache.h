@@ -23,8 +23,11 @@
 
 #pragma once
 
+#include <string_view>
+
 #include "tscore/ink_platform.h"
 #include "I_EventSystem.h"
+#include "I_Coroutine.h"
 #include "I_AIO.h"
 #include "I_CacheDefs.h"
 #include "I_Store.h"
@@ -45,8 +48,18 @@ static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 #define CACHE_COMPRESSION_FASTLZ 1
 #define CACHE_COMPRESSION_LIBZ 2
 #define CACHE_COMPRESSION_LIBLZMA 3
-
-enum { RAM_HIT_COMPRESS_NONE = 1, RAM_HIT_COMPRESS_FASTLZ, RAM_HIT_COMPRESS_LIBZ, RAM_HIT_COMPRESS_LIBLZMA, RAM_HIT_LAST_ENTRY };
+#define CACHE_COMPRESSION_LZ4 4
+#define CACHE_COMPRESSION_ZSTD 5
+
+enum {
+  RAM_HIT_COMPRESS_NONE = 1,
+  RAM_HIT_COMPRESS_FASTLZ,
+  RAM_HIT_COMPRESS_LIBZ,
+  RAM_HIT_COMPRESS_LIBLZMA,
+  RAM_HIT_COMPRESS_LZ4,
+  RAM_HIT_COMPRESS_ZSTD,
+  RAM_HIT_LAST_ENTRY
+};
 
 struct CacheVC;
 struct CacheDisk;
@@ -59,6 +72,16 @@ typedef HTTPHdr CacheHTTPHdr;
 typedef URL CacheURL;
 typedef HTTPInfo CacheHTTPInfo;
 
+/// A directory entry, as passed with @c CACHE_EVENT_SCAN_DIR.
+struct CacheScanDirEntry {
+  int volume;     ///< Number of the volume in volume.config.
+  uint16_t tag;   ///< Bits of the fragment key checked by directory probes.
+  bool head;      ///< First fragment of a document, carrying its headers.
+  bool pinned;    ///< Pinned in the cache.
+  int64_t offset; ///< Byte offset of the fragment on its disk.
+  int64_t size;   ///< Approximate size of the fragment.
+};
+
 struct CacheProcessor : public Processor {
   CacheProcessor()
     : min_stripe_version(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION),
@@ -84,6 +107,23 @@ struct CacheProcessor : public Processor {
   inkcoreapi Action *remove(Continuation *cont, const CacheKey *key, CacheFragType frag_type = CACHE_FRAG_TYPE_NONE,
                             const char *hostname = nullptr, int host_len = 0);
   Action *scan(Continuation *cont, char *hostname = nullptr, int host_len = 0, int KB_per_second = SCAN_KB_PER_SECOND);
+  /** Scan all the volumes at once, @a KB_per_second being the disk read rate over all of them.
+
+      @a cont receives @c CACHE_EVENT_SCAN, then @c CACHE_EVENT_SCAN_DIR with a @c CacheScanDirEntry for
+      each directory entry if @a flags has @c CACHE_SCAN_DIR, and @c CACHE_EVENT_SCAN_OBJECT for each
+      alternate if it has @c CACHE_SCAN_HEADERS, then a single @c CACHE_EVENT_SCAN_DONE. The volumes are
+      walked concurrently but the events are serialized by the mutex of @a cont, which the volume
+      locks are held under, so handlers should not block. Alternates can be answered any
+      @c CacheScanResult but @c CACHE_SCAN_RESULT_UPDATE, directory entries only
+      @c CACHE_SCAN_RESULT_CONTINUE or @c CACHE_SCAN_RESULT_DONE.
+  */
+  Action *scan_parallel(Continuation *cont, int flags, int KB_per_second);
+  /** Remove the documents tagged @a tag in the header named by @c proxy.config.cache.tag_index.header.
+
+      The documents are found in the tag index of the volumes and removed in the background.
+      @return The number of documents found.
+  */
+  int64_t invalidate_tag(std::string_view tag);
   Action *lookup(Continuation *cont, const HttpCacheKey *key, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
   inkcoreapi Action *open_read(Continuation *cont, const HttpCacheKey *key, CacheHTTPHdr *request,
                                const OverridableHttpConfigParams *params, time_t pin_in_cache = (time_t)0,
@@ -91,6 +131,14 @@ struct CacheProcessor : public Processor {
   Action *open_write(Continuation *cont, int expected_size, const HttpCacheKey *key, CacheHTTPHdr *request, CacheHTTPInfo *old_info,
                      time_t pin_in_cache = (time_t)0, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
   Action *remove(Continuation *cont, const HttpCacheKey *key, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
+  /// Count a miss for @a key against its volume's admission filter. @return @c false if the response should not be written.
+  bool admit(const HttpCacheKey *key);
+  /** Whether @a key may have a document, from the directory of its volume alone: nothing is read and no lock is taken.
+
+      @c false is a sure miss. @c true may still be a miss, for a tag collision or a document not valid anymore, but
+      is a match in the directory or in the open readers and writers of the volume.
+  */
+  bool maybe_cached(const HttpCacheKey *key);
   Action *link(Continuation *cont, CacheKey *from, CacheKey *to, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP,
                char *hostname = nullptr, int host_len = 0);
 
@@ -216,3 +264,29 @@ struct CacheVConnection : public VConnection {
 void ink_cache_init(ts::ModuleVersion version);
 extern inkcoreapi CacheProcessor cacheProcessor;
 extern Continuation *cacheRegexDeleteCont;
+
+/// Start the scan of the management API request @a options, reported to cache_scan.log.
+void cache_scan_request(std::string_view options);
+
+/// Invalidate the tags of the management API request @a tags, one per line.
+void cache_tag_invalidate_request(std::string_view tags);
+
+#if TS_HAS_COROUTINES
+namespace ts
+{
+/// Await opening @a key for reading, which completes with @c CACHE_EVENT_OPEN_READ and the cache VConnection or a failure.
+inline auto
+cache_open_read(const CacheKey &key, CacheFragType frag_type = CACHE_FRAG_TYPE_NONE)
+{
+  return await_event([&key, frag_type](Continuation *cont) { cacheProcessor.open_read(cont, &key, frag_type); });
+}
+
+/// Await opening @a key for writing, which completes with @c CACHE_EVENT_OPEN_WRITE and the cache VConnection or a failure.
+inline auto
+cache_open_write(CacheKey &key, CacheFragType frag_type = CACHE_FRAG_TYPE_NONE, int expected_size = CACHE_EXPECTED_SIZE)
+{
+  return await_event(
+    [&key, frag_type, expected_size](Continuation *cont) { cacheProcessor.open_write(cont, &key, frag_type, expected_size); });
+}
+} // namespace ts
+#endif
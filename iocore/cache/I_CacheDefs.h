@@ -89,6 +89,7 @@ enum CacheEventType {
   CACHE_EVENT_SCAN_OPERATION_BLOCKED = CACHE_EVENT_EVENTS_START + 23,
   CACHE_EVENT_SCAN_OPERATION_FAILED  = CACHE_EVENT_EVENTS_START + 24,
   CACHE_EVENT_SCAN_DONE              = CACHE_EVENT_EVENTS_START + 25,
+  CACHE_EVENT_SCAN_DIR               = CACHE_EVENT_EVENTS_START + 26,
   //////////////////////////
   // Internal error codes //
   //////////////////////////
@@ -106,6 +107,12 @@ enum CacheScanResult {
   CACHE_SCAN_RESULT_RETRY
 };
 
+// What CacheProcessor::scan_parallel() visits.
+enum CacheScanFlags {
+  CACHE_SCAN_DIR     = 0x01, // every directory entry, without any disk read
+  CACHE_SCAN_HEADERS = 0x02, // every alternate, read from disk
+};
+
 enum CacheDataType {
   CACHE_DATA_HTTP_INFO = VCONNECTION_CACHE_DATA_BASE,
   CACHE_DATA_KEY,
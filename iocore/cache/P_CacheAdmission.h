@@ -0,0 +1,82 @@
+/** @file
+
+  TinyLFU admission filter for cache writes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "tscore/CryptoHash.h"
+
+/**
+  Approximate request counts for documents missing from the cache, used to write a document only
+  once it has been asked for a few times, so that one-off requests do not push popular documents
+  out of the cache.
+
+  A doorkeeper Bloom filter absorbs the first request for each key, so the long tail of keys
+  requested once never reaches the count-min sketch behind it. The sketch holds small saturating
+  counters in a few rows, a key's count is the smallest of its counters. Once as many requests
+  have been counted as ten times its width, all counters are halved and the doorkeeper cleared,
+  so counts follow the recent popularity of documents.
+
+  All operations are lock free and may be called from any thread; concurrent updates can lose
+  an increment now and then, which only makes the counts more approximate.
+*/
+class CacheAdmissionFilter
+{
+public:
+  /// @a counters is the width of each sketch row, rounded up to a power of 2.
+  CacheAdmissionFilter(uint32_t counters, int min_requests);
+
+  CacheAdmissionFilter(const CacheAdmissionFilter &) = delete;
+  CacheAdmissionFilter &operator=(const CacheAdmissionFilter &) = delete;
+
+  /// Count a request for @a key, which missed the cache. @return @c true if the response should be written.
+  bool admit(const CryptoHash &key);
+
+  /// The approximate number of requests counted for @a key.
+  int estimate(const CryptoHash &key) const;
+
+private:
+  static constexpr int DEPTH              = 4;
+  static constexpr int DOORKEEPER_PROBES  = 4;
+  static constexpr uint8_t MAX_COUNT      = 15;
+  static constexpr int SAMPLE_MULTIPLIER  = 10;
+  static constexpr int DOORKEEPER_BITS_LN = 6; // log2 of the doorkeeper bits per sketch column
+  static constexpr uint32_t MAX_WIDTH     = 1U << 28;
+
+  size_t _counter_index(const CryptoHash &key, int row) const;
+  uint64_t _doorkeeper_bit(const CryptoHash &key, int probe) const;
+  bool _doorkeeper_contains(const CryptoHash &key) const;
+  int _sketch_estimate(const CryptoHash &key) const;
+  void _age();
+
+  uint32_t _mask;
+  uint64_t _doorkeeper_mask;
+  int _min_requests;
+  uint64_t _sample_size;
+  std::unique_ptr<std::atomic<uint8_t>[]> _counters;
+  std::unique_ptr<std::atomic<uint64_t>[]> _doorkeeper;
+  std::atomic<uint64_t> _requests{0};
+};
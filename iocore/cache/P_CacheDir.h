@@ -25,8 +25,11 @@
 
 #include "P_CacheHttp.h"
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 struct Vol;
-struct InterimCacheVol;
 struct CacheVC;
 
 /*
@@ -54,6 +57,8 @@ struct CacheVC;
 
 #define SYNC_MAX_WRITE (2 * 1024 * 1024)
 #define SYNC_DELAY HRTIME_MSECONDS(500)
+// The directory is kept on disk in two copies, written alternately by the periodic sync.
+#define DIR_SYNC_ALL_COPIES 3
 #define DO_NOT_REMOVE_THIS 0
 
 // Debugging Options
@@ -106,6 +111,7 @@ struct CacheVC;
 // OpenDir
 
 #define OPEN_DIR_BUCKETS 256
+#define OPEN_DIR_FILL_FRAGMENTS 2 // fragments kept for the readers following a writer
 
 struct EvacuationBlock;
 typedef uint32_t DirInfo;
@@ -217,6 +223,7 @@ struct FreeDir {
 // is deleted/inserted into the vector just before writing the vector disk
 // (CacheVC::updateVector).
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
+LINK_FORWARD_DECLARATION(CacheVC, fill_link)    // forward declaration
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
   DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
@@ -233,10 +240,16 @@ struct OpenDirEntry {
   bool move_resident_alt;                          // if set, single_doc_dir is inserted.
   bool reading_vec;                                // somebody is currently reading the vector
   bool writing_vec;                                // somebody is currently writing the vector
+  Queue<CacheVC, Link_CacheVC_fill_link> fill_waiters; // readers waiting for the writers' next fragment
+  Ptr<IOBufferData> fill[OPEN_DIR_FILL_FRAGMENTS];     // last fragments written, shared by the readers
+  int fill_pos;                                        // next slot of fill to replace
 
   LINK(OpenDirEntry, link);
 
   int wait(CacheVC *c, int msec);
+  void fill_add(CacheVC *writer);
+  IOBufferData *fill_find(const CacheKey *key);
+  void fill_wake(EThread *t);
 
   bool
   has_multiple_writers()
@@ -248,10 +261,13 @@ struct OpenDirEntry {
 struct OpenDir : public Continuation {
   Queue<CacheVC, Link_CacheVC_opendir_link> delayed_readers;
   DLL<OpenDirEntry> bucket[OPEN_DIR_BUCKETS];
+  // Number of entries in each bucket, readable without the volume lock.
+  std::atomic<uint32_t> bucket_entries[OPEN_DIR_BUCKETS] = {};
 
   int open_write(CacheVC *c, int allow_if_writers, int max_writers);
   int close_write(CacheVC *c);
   OpenDirEntry *open_read(const CryptoHash *key);
+  bool maybe_open(const CryptoHash *key) const;
   int signal_readers(int event, Event *e);
 
   OpenDir();
@@ -263,13 +279,20 @@ struct CacheSync : public Continuation {
   size_t buflen  = 0;
   bool buf_huge  = false;
   off_t writepos = 0;
+  // Block aligned (offset, length) pieces of the directory to write in this sync, in order.
+  std::vector<std::pair<off_t, size_t>> ranges;
+  size_t range_idx = 0;
   AIOCallbackInternal io;
   Event *trigger        = nullptr;
   ink_hrtime start_time = 0;
   int mainEvent(int event, Event *e);
   void aio_write(int fd, char *b, int n, off_t o);
 
-  CacheSync() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheSync::mainEvent); }
+  CacheSync() : Continuation(new_ProxyMutex())
+  {
+    SET_HANDLER(&CacheSync::mainEvent);
+    thread_agnostic = true;
+  }
 };
 
 // Global Functions
@@ -277,6 +300,7 @@ struct CacheSync : public Continuation {
 void vol_init_dir(Vol *d);
 int dir_token_probe(const CacheKey *, Vol *, Dir *);
 int dir_probe(const CacheKey *, Vol *, Dir *, Dir **);
+bool dir_probe_maybe_present(const CacheKey *key, Vol *d);
 int dir_insert(const CacheKey *key, Vol *d, Dir *to_part);
 int dir_overwrite(const CacheKey *key, Vol *d, Dir *to_part, Dir *overwrite, bool must_overwrite = true);
 int dir_delete(const CacheKey *key, Vol *d, Dir *del);
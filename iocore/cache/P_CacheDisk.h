@@ -95,7 +95,9 @@ struct CacheDisk : public Continuation {
   DiskVol *free_blocks    = nullptr;
   int num_errors          = 0;
   int cleared             = 0;
+  int stripes             = 1; ///< Stripes a volume is split into on this span when it is allocated.
   bool read_only_p        = false;
+  bool memory             = false; ///< The span of a memory volume, which starts out empty every time.
   bool online             = true; /* flag marking cache disk online or offline (because of too many failures or by the operator). */
 
   // Extra configuration values
@@ -115,6 +117,7 @@ struct CacheDisk : public Continuation {
   int sync();
   int syncDone(int event, void *data);
   DiskVolBlock *create_volume(int number, off_t size, int scheme);
+  off_t stripe_blocks(off_t blocks, int made) const;
   int delete_volume(int number);
   int delete_all_volumes();
   void update_header();
@@ -177,6 +177,9 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  bool tier                  = false;
+  bool memory                = false; // on a span of memory of its own, see CacheProcessor::start_internal
+  int admission_min_requests = -1; // proxy.config.cache.admission.min_requests
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
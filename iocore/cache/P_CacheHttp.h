@@ -40,6 +40,12 @@ enum {
 
 struct vec_info {
   CacheHTTPInfo alternate;
+  /// Hash of the values of the request fields named by the Vary of the alternate, and of the names
+  /// themselves, set by HttpTransactCache::SelectFromAlternates() the first time it looks at the
+  /// alternate. Reset whenever @a alternate changes.
+  uint64_t vary_fingerprint = 0;
+  uint64_t vary_names       = 0;
+  int8_t vary_state         = 0; // 0: not computed, 1: set, -1: the alternate has no usable Vary
 };
 
 struct CacheHTTPInfoVector {
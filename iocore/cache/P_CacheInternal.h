@@ -25,6 +25,7 @@
 
 #include "tscore/ink_platform.h"
 #include "tscore/InkErrno.h"
+#include "ts/sdt.h"
 
 #include "HTTP.h"
 #include "P_CacheHttp.h"
@@ -64,14 +65,23 @@ struct EvacuationBlock;
   CACHE_MUTEX_RELEASE(_l)
 #endif
 
+// Try the lock of a stripe, with a probe saying whether it was taken.
+#define CACHE_TRY_VOL_LOCK(_l, _vol, _t) \
+  CACHE_TRY_LOCK(_l, (_vol)->mutex, _t); \
+  ATS_PROBE2(cache_vol_lock, (_vol)->hash_text.get(), _l.is_locked())
+
 #define VC_LOCK_RETRY_EVENT()                                                                                         \
   do {                                                                                                                \
+    if (vol)                                                                                                          \
+      CACHE_INCREMENT_DYN_STAT(cache_lock_retry_stat);                                                                \
     trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), event); \
     return EVENT_CONT;                                                                                                \
   } while (0)
 
 #define VC_SCHED_LOCK_RETRY()                                                                                  \
   do {                                                                                                         \
+    if (vol)                                                                                                   \
+      CACHE_INCREMENT_DYN_STAT(cache_lock_retry_stat);                                                         \
     trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay)); \
     return EVENT_CONT;                                                                                         \
   } while (0)
@@ -95,6 +105,18 @@ struct EvacuationBlock;
     return EVENT_CONT;                                                    \
   } while (0)
 
+// Wait for the writer to add the next fragment, with a timer in case it never does.
+#define VC_SCHED_WRITER_WAIT()                                                                                           \
+  do {                                                                                                                   \
+    if (!writer_wait()) {                                                                                                \
+      VC_SCHED_WRITER_RETRY();                                                                                           \
+    }                                                                                                                    \
+    ink_assert(!trigger);                                                                                                \
+    writer_lock_retry++;                                                                                                 \
+    trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(cache_config_read_while_writer_fill_wait)); \
+    return EVENT_CONT;                                                                                                   \
+  } while (0)
+
 // cache stats definitions
 enum {
   cache_bytes_used_stat,
@@ -105,6 +127,27 @@ enum {
   cache_direntries_used_stat,
   cache_ram_cache_hits_stat,
   cache_ram_cache_misses_stat,
+  cache_ram_cache_compress_bytes_in_stat,
+  cache_ram_cache_compress_bytes_out_stat,
+  cache_ram_cache_compress_time_stat,
+  cache_ram_cache_decompress_time_stat,
+  cache_ram_cache_prefetch_objects_stat,
+  cache_ram_cache_prefetch_bytes_stat,
+  cache_admission_admitted_stat,
+  cache_admission_rejected_stat,
+  cache_tier_hits_stat,
+  cache_tier_promote_active_stat,
+  cache_tier_promote_success_stat,
+  cache_tier_promote_failure_stat,
+  cache_tag_index_evicted_stat,
+  cache_tag_index_invalidated_stat,
+  cache_startup_volumes_total_stat,
+  cache_startup_volumes_recovered_stat,
+  cache_evacuate_bytes_stat,
+  cache_evacuate_background_bytes_stat,
+  cache_read_ahead_bytes_stat,
+  cache_read_ahead_wasted_stat,
+  cache_read_while_writer_fill_stat,
   cache_pread_count_stat,
   cache_percent_full_stat,
   cache_lookup_active_stat,
@@ -113,6 +156,8 @@ enum {
   cache_read_active_stat,
   cache_read_success_stat,
   cache_read_failure_stat,
+  cache_read_lockless_miss_stat,
+  cache_checksum_mismatch_stat,
   cache_write_active_stat,
   cache_write_success_stat,
   cache_write_failure_stat,
@@ -133,8 +178,11 @@ enum {
   cache_single_fragment_document_count_stat,
   cache_two_fragment_document_count_stat,
   cache_three_plus_plus_fragment_document_count_stat,
+  cache_write_fragments_stat,
+  cache_write_large_fragment_document_stat,
   cache_read_busy_success_stat,
   cache_read_busy_failure_stat,
+  cache_lock_retry_stat,
   cache_gc_bytes_evacuated_stat,
   cache_gc_frags_evacuated_stat,
   cache_write_bytes_stat,
@@ -219,13 +267,36 @@ extern int cache_config_agg_write_backlog;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
 extern int cache_config_ram_cache_use_seen_filter;
+extern int cache_config_ram_cache_shards;
+extern int cache_config_ram_cache_persist_interval;
+extern int64_t cache_config_ram_cache_prefetch_rate;
+extern int cache_config_admission_min_requests;
+extern int cache_config_admission_counters;
+extern int cache_config_tier_promote_reads;
+extern int cache_config_tier_promote_ram_hits;
+extern int cache_config_startup_ready_percent;
+extern int64_t cache_config_evacuate_background_window;
+extern int64_t cache_config_evacuate_background_rate;
+extern int64_t cache_config_read_ahead_size;
+extern int64_t cache_config_read_ahead_min_object_size;
+extern int64_t cache_config_agg_write_buffer_size;
+extern int cache_config_agg_write_buffers;
+extern int cache_config_span_stripes;
+extern int64_t cache_config_span_min_stripe_size;
+extern int64_t cache_config_tier_max_doc_size;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
 extern int cache_config_force_sector_size;
 extern int cache_config_target_fragment_size;
+extern int cache_config_target_fragment_size_max;
 extern int cache_config_mutex_retry_delay;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_read_while_writer_fill_wait;
+extern int cache_config_scan_rate;
+extern char cache_config_tag_header[];
+extern int cache_config_tag_header_len;
+extern int cache_config_tag_index_entries;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -301,6 +372,8 @@ struct CacheVC : public CacheVConnection {
   }
 
   bool writer_done();
+  bool writer_wait();
+  void writer_unwait();
   int calluser(int event);
   int callcont(int event);
   int die();
@@ -309,6 +382,10 @@ struct CacheVC : public CacheVConnection {
   int handleReadDone(int event, Event *e);
   int handleRead(int event, Event *e);
   int do_read_call(CacheKey *akey);
+  void read_ahead_issue();
+  CacheReadAhead *read_ahead_find();
+  void read_ahead_take(CacheReadAhead *ra);
+  void read_ahead_cancel();
   int handleWrite(int event, Event *e);
   int handleWriteLock(int event, Event *e);
   int do_write_call();
@@ -350,7 +427,9 @@ struct CacheVC : public CacheVConnection {
   int derefRead(int event, Event *e);
 
   int scanVol(int event, Event *e);
+  int scanDir(int event, Event *e);
   int scanObject(int event, Event *e);
+  int scanRead(int event, Event *e);
   int scanUpdateDone(int event, Event *e);
   int scanOpenWrite(int event, Event *e);
   int scanRemoveDone(int event, Event *e);
@@ -372,6 +451,8 @@ struct CacheVC : public CacheVConnection {
   }
   int evacuateDocDone(int event, Event *e);
   int evacuateReadHead(int event, Event *e);
+  int promoteWrite(int event, Event *e);
+  int promoteDocDone(int event, Event *e);
 
   void cancel_trigger();
   int64_t get_object_size() override;
@@ -468,13 +549,23 @@ struct CacheVC : public CacheVConnection {
   uint64_t doc_len;      // total_length (of the selected alternate for HTTP)
   uint64_t update_len;
   int fragment;
+  int64_t frag_size; // target fragment size of the object written, 0 until its first fragment
   int scan_msec_delay;
+  int scan_flags;   // CacheScanFlags of a scan of this vol only, 0 for the scans of all vols in turn
+  int scan_segment; // next directory segment to visit
   CacheVC *write_vc;
   char *hostname;
   int host_len;
   int header_to_write_len;
   void *header_to_write;
   short writer_lock_retry;
+  Vol *tier_fallback;  // the document's own volume, while reading a copy from the tier
+  uint32_t tier_epoch; // epoch of the key when a promotion to the tier was decided
+  Que(CacheReadAhead, link) read_ahead; // fragments after the one being read, in order
+  int64_t read_ahead_bytes;             // read or being read in read_ahead
+  ink_hrtime read_ahead_latency;        // average time a fragment took to read
+  OpenDirEntry *fill_wait;              // entry of the writer this reader waits on, under the vol lock
+  LINK(CacheVC, fill_link);
   union {
     uint32_t flags;
     struct {
@@ -537,6 +628,7 @@ extern CacheSync *cacheDirSync;
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
+void unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay);
 
 // inline Functions
 
@@ -606,6 +698,10 @@ free_CacheVC(CacheVC *cont)
   if (cont->scan_vol_map) {
     ats_free(cont->scan_vol_map);
   }
+  if (cont->read_ahead.head) {
+    cont->read_ahead_cancel();
+  }
+  ink_assert(!cont->fill_wait);
   memset((char *)&cont->vio, 0, cont->size_to_init);
 #ifdef CACHE_STAT_PAGES
   ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
@@ -754,6 +850,29 @@ CacheVC::writer_done()
   return false;
 }
 
+// Queue for the writer's next fragment, @return false if the writer has gone.
+TS_INLINE bool
+CacheVC::writer_wait()
+{
+  if (!fill_wait) {
+    fill_wait = vol->open_read(&first_key);
+    if (!fill_wait) {
+      return false;
+    }
+    fill_wait->fill_waiters.enqueue(this);
+  }
+  return true;
+}
+
+TS_INLINE void
+CacheVC::writer_unwait()
+{
+  if (fill_wait) {
+    fill_wait->fill_waiters.remove(this);
+    fill_wait = nullptr;
+  }
+}
+
 TS_INLINE int
 Vol::close_write(CacheVC *cont)
 {
@@ -771,6 +890,9 @@ Vol::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
 {
   Vol *vol       = this;
   bool agg_error = false;
+  if (!ready) {
+    return ECACHE_NOT_READY; // still recovering, see Cache::vol_initialized()
+  }
   if (!cont->f.remove) {
     agg_error = (!cont->f.update && agg_todo_size > cache_config_agg_write_backlog);
 #ifdef CACHE_AGG_FAIL_RATE
@@ -782,6 +904,9 @@ Vol::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
     return ECACHE_WRITE_FAIL;
   }
   if (open_dir.open_write(cont, allow_if_writers, max_writers)) {
+    if (cache_tier && !cache_vol->tier) {
+      cache_tier->invalidate(&cont->first_key);
+    }
 #ifdef CACHE_STAT_PAGES
     ink_assert(cont->mutex->thread_holding == this_ethread());
     ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
@@ -976,6 +1101,7 @@ struct Cache {
   int64_t cache_size        = 0; // in store block size
   CacheHostTable *hosttable = nullptr;
   int total_initialized_vol = 0;
+  int total_started_vol     = 0; // vols whose size and place are known, see Vol::init()
   CacheType scheme          = CACHE_NONE_TYPE;
 
   int open(bool reconfigure, bool fix);
@@ -987,7 +1113,10 @@ struct Cache {
                                 time_t pin_in_cache = (time_t)0, const char *hostname = nullptr, int host_len = 0);
   inkcoreapi Action *remove(Continuation *cont, const CacheKey *key, CacheFragType type = CACHE_FRAG_TYPE_HTTP,
                             const char *hostname = nullptr, int host_len = 0);
+  // remove the document @a key from @a vol, the volume it was hosted on
+  Action *remove_from(Continuation *cont, Vol *vol, const CacheKey *key, CacheFragType type);
   Action *scan(Continuation *cont, const char *hostname = nullptr, int host_len = 0, int KB_per_second = 2500);
+  Action *scan_parallel(Continuation *cont, int flags, int KB_per_second);
 
   Action *open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request, const OverridableHttpConfigParams *params,
                     CacheFragType type, const char *hostname, int host_len);
@@ -1035,3 +1164,4 @@ cache_hash(const CryptoHash &hash)
 }
 
 LINK_DEFINITION(CacheVC, opendir_link)
+LINK_DEFINITION(CacheVC, fill_link)
@@ -0,0 +1,56 @@
+/** @file
+
+  Reading the fragments of large documents ahead of their readers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "P_AIO.h"
+#include "I_CacheDefs.h"
+
+struct CacheVC;
+
+/**
+  A fragment of a large document read before its reader asks for it. A CacheVC reading a
+  document of at least proxy.config.cache.read_ahead.min_object_size keeps reads of the next
+  fragments in flight, so the disk seeks for them while the reader drains the current one.
+  handleRead() then takes the fragment from here, or waits for the read already in flight,
+  instead of starting a read of its own.
+
+  A fragment still in flight when its reader goes away or moves elsewhere in the document is
+  released when the read completes.
+*/
+struct CacheReadAhead : public Continuation {
+  CacheKey key;
+  int64_t offset = 0; ///< dir_offset() of the fragment
+  Ptr<IOBufferData> buf;
+  AIOCallbackInternal io;
+  CacheVC *owner    = nullptr; ///< @c nullptr once the reader dropped the fragment
+  ink_hrtime issued = 0;
+  bool done         = false;
+  bool waited       = false; ///< the owner waits in handleReadDone() for the read
+
+  LINK(CacheReadAhead, link);
+
+  CacheReadAhead() : Continuation(nullptr) { SET_HANDLER(&CacheReadAhead::readDone); }
+
+  int readDone(int event, void *data);
+};
@@ -0,0 +1,153 @@
+/** @file
+
+  An index from the tags of cached documents, such as surrogate keys, to their cache keys
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "tscore/CryptoHash.h"
+
+struct Vol;
+
+/**
+  Each volume with documents carrying tags, in the response header named by
+  @c proxy.config.cache.tag_index.header, maps the hashes of the tags to the cache keys
+  of these documents. The index is a fixed table of entries, one per tag of a document,
+  chained both by tag and by cache key, so that the documents of a tag are found and
+  dropped from the index in time proportional to their number. The table is a file
+  mapped in the runtime directory, written back with the directory of the volume. It is
+  reset when its volume was cleared, or when the server did not shut down cleanly since
+  the chains may have been left half updated.
+
+  The index only grows stale: an entry outlives the document it was made for until the
+  tag is invalidated or its slot is reused, neither of which removes anything else. When
+  the table is full the slots of documents no longer in the directory are reused first.
+*/
+class CacheTagIndex
+{
+public:
+  /// The most tags of a document that are indexed.
+  static constexpr int MAX_TAGS = 32;
+
+  /// The hash of @a tag in the index.
+  static uint64_t hash(std::string_view tag);
+
+  /// Hash the tags of a header @a value, separated by white space or commas, into @a tags.
+  /// @return The number of tags, at most @a max, without duplicates.
+  static int parse(std::string_view value, uint64_t *tags, int max);
+
+  /**
+    Map the index at @a path holding @a capacity entries.
+    The index is reset unless it was written for a volume created at @a stamp.
+    @return @c nullptr if the file could not be mapped.
+  */
+  static CacheTagIndex *open(const char *path, uint32_t capacity, time_t stamp);
+
+  /// Map the index of @a vol, @return @c nullptr if the volume has no index.
+  static CacheTagIndex *open(Vol *vol);
+
+  ~CacheTagIndex();
+
+  /**
+    Index the document @a key of @a vol with @a ntags @a tags, replacing its previous tags.
+    @a vol, if given, tells the slots of documents it has dropped.
+    @return The number of entries of documents still in the volume that were evicted.
+  */
+  int insert(const CryptoHash &key, const uint64_t *tags, int ntags, Vol *vol);
+
+  /// Append the keys of the documents tagged @a tag to @a keys, dropping them from the index.
+  void collect(uint64_t tag, std::vector<CryptoHash> &keys);
+
+  /// Write the table back to its file, waiting for the write and marking it closed at @a shutdown.
+  void sync(bool shutdown);
+
+  /// The number of entries in use.
+  uint32_t count() const;
+
+private:
+  struct Link {
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  /// Entry 0 is never used, it stands for the end of the chains.
+  struct Entry {
+    uint64_t tag;
+    CryptoHash key;
+    Link by_tag; ///< free entries are chained through @c by_tag.next, with @c by_tag.prev set to @c FREE
+    Link by_key;
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    int64_t stamp;
+    uint32_t capacity;
+    uint32_t buckets; ///< a power of two
+    uint32_t free_head;
+    uint32_t count;
+    uint32_t cursor; ///< where the next full table reclaim starts
+    uint32_t open;   ///< mapped by a running server, an index not closed cleanly is reset
+  };
+
+  static constexpr uint32_t MAGIC   = 0x54414758; // "TAGX"
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t FREE    = UINT32_MAX;
+  /// The most entries looked at for a document no longer in its volume when the table is full.
+  static constexpr int RECLAIM_PROBES = 64;
+
+  CacheTagIndex() = default;
+
+  static size_t mapped_size(uint32_t capacity, uint32_t buckets);
+
+  void reset(uint32_t capacity, uint32_t buckets, time_t stamp);
+  uint32_t alloc(Vol *vol, int *evicted);
+  void release(uint32_t i);
+  void link(uint32_t i, Link Entry::*chain, uint32_t *heads, uint32_t bucket);
+  void unlink(uint32_t i, Link Entry::*chain, uint32_t *heads, uint32_t bucket);
+
+  uint32_t
+  tag_bucket(uint64_t tag) const
+  {
+    return static_cast<uint32_t>(tag ^ (tag >> 32)) & (_header->buckets - 1);
+  }
+
+  uint32_t
+  key_bucket(const CryptoHash &key) const
+  {
+    return static_cast<uint32_t>(key.fold()) & (_header->buckets - 1);
+  }
+
+  std::mutex _lock;
+  int _fd              = -1;
+  void *_map           = nullptr;
+  size_t _map_size     = 0;
+  Header *_header      = nullptr;
+  uint32_t *_tag_heads = nullptr;
+  uint32_t *_key_heads = nullptr;
+  Entry *_entries      = nullptr;
+};
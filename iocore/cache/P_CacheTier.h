@@ -0,0 +1,84 @@
+/** @file
+
+  A second cache level on fast storage, holding copies of documents read often from the other volumes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "I_CacheDefs.h"
+
+struct Vol;
+struct CacheVC;
+struct Doc;
+class CacheAdmissionFilter;
+class EThread;
+
+/**
+  The volumes marked @c tier=true in volume.config, typically on NVMe spans, form a second cache
+  level behind the RAM cache. Hosting never places documents on them. Instead single fragment
+  documents read often enough from their own volume are copied to a tier volume, which then
+  answers the reads for them. The tier is inclusive: the document stays in its volume, and a copy
+  only leaves the tier when the tier log wraps over it, so nothing is ever written back.
+
+  Every write or removal of a document drops its tier copy. Promotions are asynchronous, so each
+  one records the epoch of its key's slot when it is decided and is discarded if a write bumped
+  that epoch before the copy was inserted in the tier directory.
+
+  Invalidations are not persisted, the tier volumes are cleared when the cache starts.
+*/
+struct CacheTier {
+  static constexpr int EPOCH_SLOTS = 4096;
+
+  /// Build the tier from the tier volumes, @return @c nullptr if there are none.
+  static CacheTier *create();
+
+  /// The tier volume a copy of @a key is kept on.
+  Vol *
+  key_to_vol(const CacheKey *key) const
+  {
+    return vols[key->slice32(1) % num_vols];
+  }
+
+  /// The tier volume holding a copy of @a key, or @c nullptr if none was found without waiting.
+  Vol *lookup(const CacheKey *key, EThread *thread);
+
+  /// Copy the document @a reader just read from its (locked) volume to the tier, if it qualifies.
+  void promote(CacheVC *reader, Doc *doc);
+
+  /// Drop any copy of @a key, called before it is written or removed.
+  void invalidate(const CacheKey *key);
+
+  uint32_t
+  epoch(const CacheKey *key) const
+  {
+    return epochs[key->slice32(0) % EPOCH_SLOTS].load();
+  }
+
+  Vol **vols                  = nullptr;
+  int num_vols                = 0;
+  CacheAdmissionFilter *reads = nullptr; // nullptr promotes on the first read
+  std::atomic<uint32_t> epochs[EPOCH_SLOTS]{};
+};
+
+extern CacheTier *cache_tier;
@@ -25,6 +25,8 @@
 
 #include <atomic>
 
+#include "tscore/ink_crc32c.h"
+
 #define CACHE_BLOCK_SHIFT 9
 #define CACHE_BLOCK_SIZE (1 << CACHE_BLOCK_SHIFT) // 512, smallest sector size
 #define ROUND_TO_STORE_BLOCK(_x) INK_ALIGN((_x), STORE_BLOCK_SIZE)
@@ -36,8 +38,9 @@
 #define VOL_MAGIC 0xF1D0F00D
 #define START_BLOCKS 16 // 8k, STORE_BLOCK_SIZE
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
-#define AGG_SIZE (4 * 1024 * 1024)     // 4MB
-#define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
+#define AGG_SIZE (4 * 1024 * 1024)     // 4MB, the largest fragment of a volume with the default aggregation buffer
+#define AGG_MAX_SIZE (4 * AGG_SIZE)    // 16MB, the largest aggregation buffer
+#define AGG_MAX_BUFFERS 3
 #define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
@@ -66,13 +69,18 @@
 #define DOC_MAGIC ((uint32_t)0x5F129B13)
 #define DOC_CORRUPT ((uint32_t)0xDEADBABE)
 #define DOC_NO_CHECKSUM ((uint32_t)0xA0B0C0D0)
+#define DOC_CHECKSUM_SUM 0    // the sum of the bytes, written by older versions, unless DOC_NO_CHECKSUM
+#define DOC_CHECKSUM_CRC32C 1 // the CRC32C of the header and the data
 
 struct Cache;
 struct Vol;
 struct CacheDisk;
 struct VolInitInfo;
+struct BackgroundEvacuator;
 struct DiskVol;
 struct CacheVol;
+class CacheAdmissionFilter;
+class CacheTagIndex;
 
 struct VolHeaderFooter {
   unsigned int magic;
@@ -119,6 +127,19 @@ struct EvacuationBlock {
   LINK(EvacuationBlock, link);
 };
 
+// An aggregation buffer and the write of its contents.
+struct AggWriteBuffer : public Continuation {
+  Vol *vol     = nullptr;
+  char *buffer = nullptr;
+  AIOCallbackInternal io;
+  bool done = false;
+
+  AggWriteBuffer() : Continuation(nullptr) { SET_HANDLER(&AggWriteBuffer::writeDone); }
+  ~AggWriteBuffer() override { ats_memalign_free(buffer); }
+
+  int writeDone(int event, Event *e);
+};
+
 struct Vol : public Continuation {
   char *path = nullptr;
   ats_scoped_str hash_text;
@@ -131,6 +152,12 @@ struct Vol : public Continuation {
   VolHeaderFooter *footer = nullptr;
   int segments            = 0;
   off_t buckets           = 0;
+
+  // Per segment sequence numbers, odd while the segment is being changed. See DirSegmentWriteGuard.
+  std::atomic<uint32_t> *dir_segment_seq = nullptr;
+  // Per segment mask of the on-disk directory copies that are behind memory, bit N for copy N.
+  std::atomic<uint8_t> *dir_segment_dirty = nullptr;
+
   off_t recover_pos       = 0;
   off_t prev_recover_pos  = 0;
   off_t scan_pos          = 0;
@@ -144,18 +171,27 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
+  char *agg_buffer  = nullptr; // the buffer being filled
   int agg_todo_size = 0;
   int agg_buf_pos   = 0;
+  int agg_size      = AGG_SIZE;
+
+  // The agg_writes_in_flight buffers from agg_write_head on are being written, in order.
+  AggWriteBuffer *agg_buffers = nullptr;
+  int agg_buffer_count        = 1;
+  int agg_write_head          = 0;
+  int agg_writes_in_flight    = 0;
 
   Event *trigger = nullptr;
 
   OpenDir open_dir;
   RamCache *ram_cache            = nullptr;
+  CacheTagIndex *tags            = nullptr; // nullptr if the tags of the documents are not indexed
   int evacuate_size              = 0;
   DLL<EvacuationBlock> *evacuate = nullptr;
   DLL<EvacuationBlock> lookaside[LOOKASIDE_SIZE];
-  CacheVC *doc_evacuator = nullptr;
+  CacheVC *doc_evacuator                    = nullptr;
+  BackgroundEvacuator *background_evacuator = nullptr;
 
   VolInitInfo *init_info = nullptr;
 
@@ -169,6 +205,8 @@ struct Vol : public Continuation {
   bool dir_sync_waiting      = false;
   bool dir_sync_in_progress  = false;
   bool writing_end_marker    = false;
+  // directory recovered, documents of the vol miss until then if the cache started serving early
+  std::atomic<bool> ready = false;
 
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
@@ -188,6 +226,8 @@ struct Vol : public Continuation {
   // currently http handles a write-lock failure by retrying the read
   OpenDirEntry *open_read(const CryptoHash *key);
   OpenDirEntry *open_read_lock(CryptoHash *key, EThread *t);
+  // Without the volume lock, false if there is neither a writer nor a directory entry for key
+  bool maybe_contains(const CryptoHash *key);
   int close_read(CacheVC *cont);
   int close_read_lock(CacheVC *cont);
 
@@ -230,12 +270,26 @@ struct Vol : public Continuation {
   int aggWriteDone(int event, Event *e);
   int aggWrite(int event, void *e);
   void agg_wrap();
+  void agg_buffers_init();
+  char *agg_data(off_t pos, size_t n);
+
+  /// The write serial of the buffer being filled, once the writes in flight are done.
+  uint32_t
+  agg_write_serial() const
+  {
+    return header->write_serial + agg_writes_in_flight;
+  }
 
   int evacuateWrite(CacheVC *evacuator, int event, Event *e);
   int evacuateDocReadDone(int event, Event *e);
   int evacuateDoc(int event, Event *e);
+  void evacuate_enqueue(CacheVC *evacuator);
+  bool evacuate_doc_read(CacheVC *evacuator);
 
+  EvacuationBlock *evac_next(off_t start, off_t end, int evac_phase);
   int evac_range(off_t start, off_t end, int evac_phase);
+  void start_background_evacuation();
+  bool background_reads_within(off_t low, off_t high) const;
   void periodic_scan();
   void scan_for_pinned_documents();
   void evacuate_cleanup_blocks(int i);
@@ -264,12 +318,53 @@ struct Vol : public Continuation {
   Vol() : Continuation(new_ProxyMutex())
   {
     open_dir.mutex = mutex;
-    agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
-    memset(agg_buffer, 0, AGG_SIZE);
+    agg_buffers_init();
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_memalign_free(agg_buffer); }
+  ~Vol() override
+  {
+    delete[] agg_buffers;
+    delete[] dir_segment_seq;
+    delete[] dir_segment_dirty;
+  }
+};
+
+/**
+  Marks a directory segment as changing for the lifetime of the guard, so that lockless
+  probes (dir_probe_maybe_present) reading it meanwhile know to discard what they saw.
+
+  Writers hold the volume lock, which serializes them. A guard nested in another one for the
+  same segment leaves the marking to the outer guard. The guard also marks the segment as
+  needing a write to both on-disk directory copies at the next syncs.
+*/
+class DirSegmentWriteGuard
+{
+public:
+  DirSegmentWriteGuard(Vol *vol, int s) : _seq(vol->dir_segment_seq[s])
+  {
+    vol->dir_segment_dirty[s].store(DIR_SYNC_ALL_COPIES, std::memory_order_relaxed);
+    uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _outer       = !(seq & 1);
+    if (_outer) {
+      _seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+  }
+
+  ~DirSegmentWriteGuard()
+  {
+    if (_outer) {
+      _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+  }
+
+  DirSegmentWriteGuard(const DirSegmentWriteGuard &) = delete;
+  DirSegmentWriteGuard &operator=(const DirSegmentWriteGuard &) = delete;
+
+private:
+  std::atomic<uint32_t> &_seq;
+  bool _outer;
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -279,13 +374,15 @@ struct AIO_Callback_handler : public Continuation {
 };
 
 struct CacheVol {
-  int vol_number        = -1;
-  int scheme            = 0;
-  off_t size            = 0;
-  int num_vols          = 0;
-  bool ramcache_enabled = true;
-  Vol **vols            = nullptr;
-  DiskVol **disk_vols   = nullptr;
+  int vol_number                  = -1;
+  int scheme                      = 0;
+  off_t size                      = 0;
+  int num_vols                    = 0;
+  bool ramcache_enabled           = true;
+  bool tier                       = false; // holds copies of documents read often from the other volumes
+  Vol **vols                      = nullptr;
+  DiskVol **disk_vols             = nullptr;
+  CacheAdmissionFilter *admission = nullptr; // nullptr writes every cacheable miss
   LINK(CacheVol, link);
   // per volume stats
   RecRawStatBlock *vol_rsb = nullptr;
@@ -307,11 +404,11 @@ struct Doc {
   CryptoHash first_key; ///< first key in object.
   CryptoHash key;       ///< Key for this doc.
 #endif
-  uint32_t hlen;         ///< Length of this header.
-  uint32_t doc_type : 8; ///< Doc type - indicates the format of this structure and its content.
-  uint32_t v_major : 8;  ///< Major version number.
-  uint32_t v_minor : 8;  ///< Minor version number.
-  uint32_t unused : 8;   ///< Unused, forced to zero.
+  uint32_t hlen;              ///< Length of this header.
+  uint32_t doc_type : 8;      ///< Doc type - indicates the format of this structure and its content.
+  uint32_t v_major : 8;       ///< Major version number.
+  uint32_t v_minor : 8;       ///< Minor version number.
+  uint32_t checksum_type : 8; ///< How @c checksum was computed, zero in older versions.
   uint32_t sync_serial;
   uint32_t write_serial;
   uint32_t pinned; // pinned until
@@ -326,6 +423,8 @@ struct Doc {
   int no_data_in_fragment();
   char *hdr();
   char *data();
+  void set_checksum(); ///< Set @c checksum to the CRC32C of the header and the data.
+  bool checksum_ok();  ///< @c true unless the header or the data do not match @c checksum.
 };
 
 // Global Data
@@ -373,7 +472,7 @@ Vol::vol_out_of_phase_valid(Dir *e)
 TS_INLINE int
 Vol::vol_out_of_phase_agg_valid(Dir *e)
 {
-  return (dir_offset(e) - 1 >= ((this->header->agg_pos - this->start + AGG_SIZE) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 >= ((this->header->agg_pos - this->start + this->agg_size) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE int
@@ -409,7 +508,9 @@ Vol::vol_offset_to_offset(off_t pos)
 TS_INLINE int
 Vol::vol_in_phase_agg_buf_valid(Dir *e)
 {
-  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+  // the writes in flight end at write_pos, they never span a wrap
+  off_t low = this->agg_writes_in_flight ? this->agg_buffers[this->agg_write_head].io.aiocb.aio_offset : this->header->write_pos;
+  return (this->vol_offset(e) >= low && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
 }
 // length of the partition not including the offset of location 0.
 TS_INLINE off_t
@@ -436,6 +537,29 @@ Doc::single_fragment()
   return data_len() == total_len;
 }
 
+TS_INLINE void
+Doc::set_checksum()
+{
+  checksum_type = DOC_CHECKSUM_CRC32C;
+  checksum      = ink_crc32c(hdr(), len - sizeof(Doc));
+}
+
+TS_INLINE bool
+Doc::checksum_ok()
+{
+  if (checksum_type == DOC_CHECKSUM_CRC32C) {
+    return ink_crc32c(hdr(), len - sizeof(Doc)) == checksum;
+  }
+  if (checksum == DOC_NO_CHECKSUM) {
+    return true;
+  }
+  uint32_t sum = 0;
+  for (char *b = hdr(); b < reinterpret_cast<char *>(this) + len; b++) {
+    sum += *b;
+  }
+  return sum == checksum;
+}
+
 TS_INLINE char *
 Doc::hdr()
 {
@@ -501,11 +625,17 @@ Vol::open_read(const CryptoHash *key)
   return open_dir.open_read(key);
 }
 
+TS_INLINE bool
+Vol::maybe_contains(const CryptoHash *key)
+{
+  return open_dir.maybe_open(key) || dir_probe_maybe_present(key, this);
+}
+
 TS_INLINE int
 Vol::within_hit_evacuate_window(Dir *xdir)
 {
   off_t oft       = dir_offset(xdir) - 1;
-  off_t write_off = (header->write_pos + AGG_SIZE - start) / CACHE_BLOCK_SIZE;
+  off_t write_off = (header->write_pos + agg_size - start) / CACHE_BLOCK_SIZE;
   off_t delta     = oft - write_off;
   if (delta >= 0)
     return delta < hit_evacuate_window;
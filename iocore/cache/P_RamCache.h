@@ -23,8 +23,26 @@
 
 #pragma once
 
+#include <vector>
+
 #include "I_Cache.h"
 
+// An entry of a RAM cache as it is persisted across restarts, see RamCachePersist.cc
+struct RamCacheHotEntry {
+  CryptoHash key;
+  uint64_t auxkey = 0; // dir_offset() of the fragment
+  uint32_t hits   = 0;
+  uint32_t size   = 0;     // memory used by the entry
+  bool resident   = false; // held in memory rather than only remembered in the history
+
+  // the CLFUS value of the entry, the higher the more worth keeping
+  double
+  value() const
+  {
+    return static_cast<double>(hits + 1) / (size + 256);
+  }
+};
+
 // Generic Ram Cache interface
 
 class RamCache
@@ -37,8 +55,26 @@ public:
   virtual int64_t size() const                                                                               = 0;
 
   virtual void init(int64_t max_bytes, Vol *vol) = 0;
+
+  // appends at most max of the most valuable entries, resident or in the history, to entries
+  virtual void
+  hot_set(std::vector<RamCacheHotEntry> & /* entries ATS_UNUSED */, size_t /* max ATS_UNUSED */)
+  {
+  }
+  // remembers the hits of an entry not in memory, the next put of its key is judged on them
+  virtual void
+  seed(const RamCacheHotEntry & /* entry ATS_UNUSED */)
+  {
+  }
+
   virtual ~RamCache(){};
 };
 
 RamCache *new_RamCacheLRU();
-RamCache *new_RamCacheCLFUS();
+// The CLFUS compressor takes the given mutex, or the volume mutex if none
+RamCache *new_RamCacheCLFUS(ProxyMutex *mutex = nullptr);
+// Partitions the cache by key into shards of the given algorithm, see RamCacheSharded.cc
+RamCache *new_RamCacheSharded(int algorithm, int shards);
+
+// Starts persisting the hot set of the RAM cache of every volume and warming it up from the last one
+void ram_cache_persist_init();
@@ -27,18 +27,36 @@
 #include "P_Cache.h"
 #include "I_Tasks.h"
 #include "tscore/fastlz.h"
+#include "tscore/JeAllocator.h"
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
 #ifdef HAVE_LZMA_H
 #include <lzma.h>
 #endif
+#ifdef HAVE_LZ4_H
+#include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+#ifdef HAVE_ZDICT_H
+#include <zdict.h>
+#endif
+
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #define REQUIRED_COMPRESSION 0.9 // must get to this size or declared incompressible
 #define REQUIRED_SHRINK 0.8      // must get to this size or keep original buffer (with padding)
 #define HISTORY_HYSTERIA 10      // extra temporary history
 #define ENTRY_OVERHEAD 256       // per-entry overhead to consider when computing cache value/size
 #define LZMA_BASE_MEMLIMIT (64 * 1024 * 1024)
+#define ZSTD_LEVEL 3                     // the zstd default, fast with a ratio close to libz
+#define ZSTD_DICTIONARY_SIZE (64 * 1024) // trained from the first entries compressed
+#define ZSTD_DICTIONARY_SAMPLES 512      // entries sampled to train the dictionary
+#define ZSTD_DICTIONARY_SAMPLE_SIZE 4096 // leading bytes of each entry sampled, where the headers are
 //#define CHECK_ACOUNTING 1 // very expensive double checking of all sizes
 
 #define REQUEUE_HITS(_h) ((_h) ? ((_h)-1) : 0)
@@ -73,6 +91,7 @@ class RamCacheCLFUS : public RamCache
 {
 public:
   RamCacheCLFUS() {}
+  explicit RamCacheCLFUS(ProxyMutex *m) : mutex(m) {}
 
   // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
   int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey = 0) override;
@@ -81,11 +100,15 @@ public:
   int64_t size() const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
+  void hot_set(std::vector<RamCacheHotEntry> &entries, size_t max) override;
+  void seed(const RamCacheHotEntry &entry) override;
 
   void compress_entries(EThread *thread, int do_at_most = INT_MAX);
 
   // TODO move it to private.
   Vol *vol = nullptr; // for stats
+  // Serializes the compressor with the users of the cache, the volume mutex unless set at construction.
+  Ptr<ProxyMutex> mutex;
 private:
   int64_t _max_bytes = 0;
   int64_t _bytes     = 0;
@@ -107,6 +130,19 @@ private:
   RamCacheCLFUSEntry *_destroy(RamCacheCLFUSEntry *e);
   void _requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims);
   void _tick(); // move CLOCK on history
+
+#ifdef HAVE_ZSTD_H
+  // The zstd dictionary is trained once, from samples the compressor takes of the entries it
+  // compresses first, and shared by the whole cache afterwards. Entries compressed before it
+  // exists carry no dictionary id and decompress without it. The samples belong to the compressor.
+  ZSTD_CDict *_zstd_cdict = nullptr;
+  ZSTD_DDict *_zstd_ddict = nullptr;
+  std::string _zstd_samples;
+  std::vector<size_t> _zstd_sample_sizes;
+  bool _zstd_sampling = true;
+
+  void _zstd_sample(const char *data, uint32_t len);
+#endif
 };
 
 int64_t
@@ -152,6 +188,16 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
   case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
     Warning("lzma not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+    Warning("lz4 not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+    Warning("zstd not available for RAM cache compression");
 #endif
     break;
   }
@@ -163,6 +209,15 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
 
 ClassAllocator<RamCacheCLFUSEntry> ramCacheCLFUSEntryAllocator("RamCacheCLFUSEntry");
 
+// The copies and the compressed or decompressed objects the RAM cache keeps, from its arena if there
+// is one. ats_free() frees them either way.
+static char *
+ram_cache_alloc(size_t size)
+{
+  static jearena::Arena *arena = jearena::Arena::get("ramcache");
+  return static_cast<char *>(arena ? arena->allocate(size) : ats_malloc(size));
+}
+
 static const int bucket_sizes[] = {127,      251,      509,       1021,      2039,      4093,       8191,      16381,   32749,
                                    65521,    131071,   262139,    524287,    1048573,   2097143,    4194301,   8388593, 16777213,
                                    33554393, 67108859, 134217689, 268435399, 536870909, 1073741789, 2147483647};
@@ -200,6 +255,9 @@ RamCacheCLFUS::init(int64_t abytes, Vol *avol)
   ink_assert(avol != nullptr);
   vol              = avol;
   this->_max_bytes = abytes;
+  if (!mutex) {
+    mutex = vol->mutex;
+  }
   DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
   if (!this->_max_bytes) {
     return;
@@ -210,6 +268,63 @@ RamCacheCLFUS::init(int64_t abytes, Vol *avol)
   }
 }
 
+#ifdef HAVE_ZSTD_H
+// Compression contexts are reused by each thread, compressing and decompressing happens outside of any lock.
+static size_t
+zstd_compress(char *dst, size_t capacity, const char *src, size_t len, const ZSTD_CDict *cdict)
+{
+  static thread_local ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  if (cdict) {
+    return ZSTD_compress_usingCDict(cctx, dst, capacity, src, len, cdict);
+  }
+  return ZSTD_compressCCtx(cctx, dst, capacity, src, len, ZSTD_LEVEL);
+}
+
+static size_t
+zstd_decompress(char *dst, size_t capacity, const char *src, size_t len, const ZSTD_DDict *ddict)
+{
+  static thread_local ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  if (ZSTD_getDictID_fromFrame(src, len) != 0) {
+    return ddict ? ZSTD_decompress_usingDDict(dctx, dst, capacity, src, len, ddict) : 0;
+  }
+  return ZSTD_decompressDCtx(dctx, dst, capacity, src, len);
+}
+
+void
+RamCacheCLFUS::_zstd_sample(const char *data, uint32_t len)
+{
+#ifdef HAVE_ZDICT_H
+  if (!_zstd_sampling) {
+    return;
+  }
+  size_t l = std::min<size_t>(len, ZSTD_DICTIONARY_SAMPLE_SIZE);
+  _zstd_samples.append(data, l);
+  _zstd_sample_sizes.push_back(l);
+  if (_zstd_sample_sizes.size() < ZSTD_DICTIONARY_SAMPLES) {
+    return;
+  }
+
+  // One attempt only, content that does not train a dictionary will not later either.
+  _zstd_sampling = false;
+  std::string dictionary(ZSTD_DICTIONARY_SIZE, '\0');
+  size_t n = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), _zstd_samples.data(), _zstd_sample_sizes.data(),
+                                   _zstd_sample_sizes.size());
+  if (ZDICT_isError(n)) {
+    Debug("ram_cache", "no zstd dictionary: %s", ZDICT_getErrorName(n));
+  } else {
+    Debug("ram_cache", "trained a %zu byte zstd dictionary for %s", n, vol->hash_text.get());
+    _zstd_ddict = ZSTD_createDDict(dictionary.data(), n);
+    _zstd_cdict = ZSTD_createCDict(dictionary.data(), n, ZSTD_LEVEL);
+  }
+  std::string().swap(_zstd_samples);
+  std::vector<size_t>().swap(_zstd_sample_sizes);
+#else
+  (void)data;
+  (void)len;
+#endif
+}
+#endif
+
 #ifdef CHECK_ACOUNTING
 static void
 check_accounting(RamCacheCLFUS *c)
@@ -254,7 +369,8 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
         e->hits++;
         uint32_t ram_hit_state = RAM_HIT_COMPRESS_NONE;
         if (e->flag_bits.compressed) {
-          b = static_cast<char *>(ats_malloc(e->len));
+          ink_hrtime start = Thread::get_hrtime_updated();
+          b                = ram_cache_alloc(e->len);
           switch (e->flag_bits.compressed) {
           default:
             goto Lfailed;
@@ -288,8 +404,28 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
             ram_hit_state = RAM_HIT_COMPRESS_LIBLZMA;
             break;
           }
+#endif
+#ifdef HAVE_LZ4_H
+          case CACHE_COMPRESSION_LZ4: {
+            int l = static_cast<int>(e->len);
+            if (l != LZ4_decompress_safe(e->data->data(), b, e->compressed_len, l)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_LZ4;
+            break;
+          }
+#endif
+#ifdef HAVE_ZSTD_H
+          case CACHE_COMPRESSION_ZSTD: {
+            if (e->len != zstd_decompress(b, e->len, e->data->data(), e->compressed_len, this->_zstd_ddict)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_ZSTD;
+            break;
+          }
 #endif
           }
+          CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_decompress_time_stat, Thread::get_hrtime_updated() - start);
           IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
           data->_mem_type    = DEFAULT_ALLOC;
           if (!e->flag_bits.copy) { // don't bother if we have to copy anyway
@@ -304,6 +440,12 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
           (*ret_data) = data;
         } else {
           IOBufferData *data = e->data.get();
+          if (e->flag_bits.copy && e->flag_bits.incompressible) {
+            // Entries are put with copy only to keep them marshalled for the compressor. Once it has given up on one,
+            // hand out the stored buffer and let the reader unmarshal it in place, as for entries put without copy, so
+            // later hits neither copy nor unmarshal it again.
+            e->flag_bits.copy = 0;
+          }
           if (e->flag_bits.copy) {
             data = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
             ::memcpy(data->data(), e->data->data(), e->len);
@@ -415,7 +557,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
     return;
   }
   ink_assert(vol != nullptr);
-  MUTEX_TAKE_LOCK(vol->mutex, thread);
+  MUTEX_TAKE_LOCK(mutex, thread);
   if (!this->_compressed) {
     this->_compressed  = this->_lru[0].head;
     this->_ncompressed = 0;
@@ -451,15 +593,26 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       case CACHE_COMPRESSION_LIBLZMA:
         l = e->len;
         break;
+#endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4:
+        l = static_cast<uint32_t>(LZ4_compressBound(e->len));
+        break;
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD:
+        l = static_cast<uint32_t>(ZSTD_compressBound(e->len));
+        break;
 #endif
       }
       // store transient data for lock release
       Ptr<IOBufferData> edata = e->data;
       uint32_t elen           = e->len;
       CryptoHash key          = e->key;
-      MUTEX_UNTAKE_LOCK(vol->mutex, thread);
-      b           = static_cast<char *>(ats_malloc(l));
-      bool failed = false;
+      MUTEX_UNTAKE_LOCK(mutex, thread);
+      b                = static_cast<char *>(ats_malloc(l));
+      bool failed      = false;
+      ink_hrtime start = Thread::get_hrtime_updated();
       switch (ctype) {
       default:
         goto Lfailed;
@@ -492,9 +645,37 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         l = static_cast<int>(pos);
         break;
       }
+#endif
+#ifdef HAVE_LZ4_H
+      case CACHE_COMPRESSION_LZ4: {
+        int ll = LZ4_compress_default(edata->data(), b, static_cast<int>(elen), static_cast<int>(l));
+        if (ll <= 0) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        break;
+      }
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD: {
+        size_t ll = zstd_compress(b, l, edata->data(), elen, this->_zstd_cdict);
+        if (ZSTD_isError(ll)) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        if (!this->_zstd_cdict) {
+          this->_zstd_sample(edata->data(), elen);
+        }
+        break;
+      }
 #endif
       }
-      MUTEX_TAKE_LOCK(vol->mutex, thread);
+      if (!failed) {
+        CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_compress_time_stat, Thread::get_hrtime_updated() - start);
+        CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_compress_bytes_in_stat, elen);
+        CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_compress_bytes_out_stat, l);
+      }
+      MUTEX_TAKE_LOCK(mutex, thread);
       // see if the entry is till around
       {
         if (failed) {
@@ -522,7 +703,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       }
       if (l < e->len) {
         e->flag_bits.compressed = cache_config_ram_cache_compress;
-        bb                      = static_cast<char *>(ats_malloc(l));
+        bb                      = ram_cache_alloc(l);
         memcpy(bb, b, l);
         ats_free(b);
         e->compressed_len = l;
@@ -533,7 +714,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       } else {
         ats_free(b);
         e->flag_bits.compressed = 0;
-        bb                      = static_cast<char *>(ats_malloc(e->len));
+        bb                      = ram_cache_alloc(e->len);
         memcpy(bb, e->data->data(), e->len);
         int64_t delta = (static_cast<int64_t>(e->len)) - static_cast<int64_t>(e->size);
         this->_bytes += delta;
@@ -558,7 +739,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
     this->_compressed = e->lru_link.next;
     this->_ncompressed++;
   }
-  MUTEX_UNTAKE_LOCK(vol->mutex, thread);
+  MUTEX_UNTAKE_LOCK(mutex, thread);
   return;
 }
 
@@ -607,7 +788,7 @@ RamCacheCLFUS::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy,
         e->size = size;
         e->data = data;
       } else {
-        char *b = static_cast<char *>(ats_malloc(len));
+        char *b = ram_cache_alloc(len);
         memcpy(b, data->data(), len);
         e->data            = new_xmalloc_IOBufferData(b, len);
         e->data->_mem_type = DEFAULT_ALLOC;
@@ -716,7 +897,7 @@ Linsert:
   if (!copy) {
     e->data = data;
   } else {
-    char *b = static_cast<char *>(ats_malloc(len));
+    char *b = ram_cache_alloc(len);
     memcpy(b, data->data(), len);
     e->data            = new_xmalloc_IOBufferData(b, len);
     e->data->_mem_type = DEFAULT_ALLOC;
@@ -766,9 +947,58 @@ RamCacheCLFUS::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_au
   return 0;
 }
 
+void
+RamCacheCLFUS::hot_set(std::vector<RamCacheHotEntry> &entries, size_t max)
+{
+  size_t start = entries.size();
+  for (int i = 0; i < 2; i++) {
+    forl_LL(RamCacheCLFUSEntry, e, this->_lru[i])
+    {
+      RamCacheHotEntry h;
+      h.key      = e->key;
+      h.auxkey   = e->auxkey;
+      h.hits     = static_cast<uint32_t>(std::min<uint64_t>(e->hits, UINT32_MAX));
+      h.size     = e->size;
+      h.resident = !e->flag_bits.lru;
+      entries.push_back(h);
+    }
+  }
+  if (entries.size() - start > max) {
+    auto by_value = [](const RamCacheHotEntry &a, const RamCacheHotEntry &b) { return a.value() > b.value(); };
+    std::nth_element(entries.begin() + start, entries.begin() + start + max, entries.end(), by_value);
+    entries.resize(start + max);
+  }
+}
+
+// A seeded entry joins the history as if it had been victimized, the CLOCK ages it like any other.
+void
+RamCacheCLFUS::seed(const RamCacheHotEntry &entry)
+{
+  if (!this->_max_bytes) {
+    return;
+  }
+  uint32_t i = entry.key.slice32(3) % this->_nbuckets;
+  for (RamCacheCLFUSEntry *e = this->_bucket[i].head; e; e = e->hash_link.next) {
+    if (e->key == entry.key) {
+      return;
+    }
+  }
+  RamCacheCLFUSEntry *e = THREAD_ALLOC(ramCacheCLFUSEntryAllocator, this_ethread());
+  e->key                = entry.key;
+  e->auxkey             = entry.auxkey;
+  e->hits               = entry.hits;
+  e->size               = entry.size;
+  e->flags              = 0;
+  e->flag_bits.lru      = 1;
+  this->_bucket[i].push(e);
+  this->_lru[1].enqueue(e);
+  this->_history++;
+  DDebug("ram_cache", "seed %X %" PRId64 " size %d hits %" PRId64, entry.key.slice32(3), entry.auxkey, e->size, e->hits);
+}
+
 RamCache *
-new_RamCacheCLFUS()
+new_RamCacheCLFUS(ProxyMutex *mutex)
 {
-  RamCacheCLFUS *r = new RamCacheCLFUS;
+  RamCacheCLFUS *r = mutex ? new RamCacheCLFUS(mutex) : new RamCacheCLFUS;
   return r;
 }
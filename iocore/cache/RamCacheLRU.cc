@@ -45,6 +45,8 @@ struct RamCacheLRU : public RamCache {
   int64_t size() const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
+  void hot_set(std::vector<RamCacheHotEntry> &entries, size_t max) override;
+  void seed(const RamCacheHotEntry &entry) override;
 
   // private
   uint16_t *seen = nullptr;
@@ -116,6 +118,31 @@ RamCacheLRU::init(int64_t abytes, Vol *avol)
   resize_hashtable();
 }
 
+// The most recently used entries, the LRU keeps no hits.
+void
+RamCacheLRU::hot_set(std::vector<RamCacheHotEntry> &entries, size_t max)
+{
+  size_t n = 0;
+  for (RamCacheLRUEntry *e = lru.tail; e && n < max; e = e->lru_link.prev, n++) {
+    RamCacheHotEntry h;
+    h.key      = e->key;
+    h.auxkey   = e->auxkey;
+    h.size     = e->data->block_size();
+    h.resident = true;
+    entries.push_back(h);
+  }
+}
+
+// Only the seen filter remembers keys, mark the key seen so that its next put is not filtered.
+void
+RamCacheLRU::seed(const RamCacheHotEntry &entry)
+{
+  if (!max_bytes || !seen) {
+    return;
+  }
+  seen[entry.key.slice32(3) % nbuckets] = entry.key.slice32(3) >> 16;
+}
+
 int
 RamCacheLRU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
 {
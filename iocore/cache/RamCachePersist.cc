@@ -0,0 +1,282 @@
+/** @file
+
+  Persistence of the hot set of the RAM caches across restarts
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "P_Cache.h"
+
+namespace
+{
+constexpr uint32_t PERSIST_MAGIC   = 0x52414d48; // "RAMH"
+constexpr uint32_t PERSIST_VERSION = 1;
+
+// The most entries persisted for a volume, the most valuable ones.
+constexpr size_t PERSIST_MAX_ENTRIES = 262144;
+
+struct PersistHeader {
+  uint32_t magic;
+  uint32_t version;
+  int64_t stamp; ///< create_time of the volume
+  uint64_t count;
+};
+
+std::string
+persist_path(Vol *vol)
+{
+  char hex[CRYPTO_HASH_SIZE * 2 + 1];
+  return RecConfigReadRuntimeDir() + "/ram_cache_" + vol->hash_id.toHexStr(hex);
+}
+
+// Read the hot set last persisted for @a vol, the most valuable entries first.
+bool
+persist_load(Vol *vol, std::vector<RamCacheHotEntry> &entries)
+{
+  std::string path = persist_path(vol);
+  FILE *in         = fopen(path.c_str(), "r");
+  if (!in) {
+    return false;
+  }
+  PersistHeader h;
+  bool ok = fread(&h, sizeof(h), 1, in) == 1 && h.magic == PERSIST_MAGIC && h.version == PERSIST_VERSION &&
+            h.stamp == vol->header->create_time && h.count <= PERSIST_MAX_ENTRIES;
+  if (ok) {
+    entries.resize(h.count);
+    ok = fread(entries.data(), sizeof(RamCacheHotEntry), h.count, in) == h.count;
+  }
+  fclose(in);
+  if (!ok) {
+    Note("RAM cache hot set %s ignored, it is not one of this volume", path.c_str());
+    entries.clear();
+  }
+  return ok;
+}
+
+bool
+persist_save(Vol *vol, const std::vector<RamCacheHotEntry> &entries)
+{
+  std::string path = persist_path(vol);
+  std::string tmp  = path + ".tmp";
+  FILE *out        = fopen(tmp.c_str(), "w");
+  if (!out) {
+    Warning("RAM cache hot set: cannot open %s: %s", tmp.c_str(), strerror(errno));
+    return false;
+  }
+  PersistHeader h{PERSIST_MAGIC, PERSIST_VERSION, vol->header->create_time, entries.size()};
+  bool ok = fwrite(&h, sizeof(h), 1, out) == 1 &&
+            fwrite(entries.data(), sizeof(RamCacheHotEntry), entries.size(), out) == entries.size();
+  ok = fclose(out) == 0 && ok;
+  if (!ok || rename(tmp.c_str(), path.c_str()) < 0) {
+    Warning("RAM cache hot set: cannot write %s: %s", path.c_str(), strerror(errno));
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+/*
+  Warms the RAM cache of a volume up from the hot set it last persisted. The history of the RAM
+  cache is seeded with the hits of every entry first, a batch at a time, then the fragments that
+  were in memory are read back, the most valuable first, one at a time and at most
+  proxy.config.cache.ram_cache.persist.prefetch_rate bytes a second, with the priority of the
+  background evacuation. A fragment is only put in the RAM cache if the directory still has it
+  where it was, and what is read is checked like any read of the cache.
+*/
+struct RamCacheWarmer : public Continuation {
+  static constexpr ink_hrtime PERIOD = HRTIME_MSECONDS(50);
+  static constexpr size_t SEED_BATCH = 4096;
+
+  Vol *vol;
+  std::vector<RamCacheHotEntry> entries;
+  size_t seeded             = 0;
+  size_t next               = 0;
+  size_t prefetched         = 0;
+  int64_t budget            = 0;
+  RamCacheHotEntry *reading = nullptr;
+  Event *periodic           = nullptr;
+  Ptr<IOBufferData> buf;
+  AIOCallbackInternal io;
+
+  RamCacheWarmer(Vol *avol, std::vector<RamCacheHotEntry> &&aentries)
+    : Continuation(avol->mutex.get()), vol(avol), entries(std::move(aentries))
+  {
+    SET_HANDLER(&RamCacheWarmer::mainEvent);
+    io.aiocb.aio_fildes = vol->fd;
+    io.action           = this;
+    io.thread           = AIO_CALLBACK_THREAD_ANY;
+    io.priority         = AIO_PRIORITY_EVACUATE;
+  }
+
+  void
+  seed_next()
+  {
+    size_t end = std::min(entries.size(), seeded + SEED_BATCH);
+    for (; seeded < end; seeded++) {
+      vol->ram_cache->seed(entries[seeded]);
+    }
+  }
+
+  void
+  read_next()
+  {
+    int64_t quantum = cache_config_ram_cache_prefetch_rate * PERIOD / HRTIME_SECOND;
+    while (!reading && next < entries.size() && (!quantum || budget > 0)) {
+      RamCacheHotEntry *h = &entries[next++];
+      if (!h->resident) {
+        continue;
+      }
+      Dir dir, *last_collision = nullptr;
+      CacheKey key             = h->key;
+      bool found               = false;
+      while (!found && dir_probe(&key, vol, &dir, &last_collision)) {
+        found = static_cast<uint64_t>(dir_offset(&dir)) == h->auxkey;
+      }
+      if (!found || dir_agg_buf_valid(vol, &dir)) {
+        continue;
+      }
+      io.aiocb.aio_offset = vol->vol_offset(&dir);
+      io.aiocb.aio_nbytes = dir_approx_size(&dir);
+      if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
+        io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
+      }
+      buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      io.aiocb.aio_buf = buf->data();
+      budget -= io.aiocb.aio_nbytes;
+      reading = h;
+      ink_assert(ink_aio_read(&io) >= 0);
+    }
+  }
+
+  void
+  read_done()
+  {
+    Doc *doc = reinterpret_cast<Doc *>(buf->data());
+    if (io.ok() && doc->magic == DOC_MAGIC && (doc->key == reading->key || doc->first_key == reading->key) &&
+        doc->len <= io.aiocb.aio_nbytes && (!cache_config_enable_checksum || doc->checksum_ok())) {
+      // as in CacheVC::handleReadDone(), HTTP headers are unmarshaled unless the entry is copied for compression
+      bool copy = cache_config_ram_cache_compress && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen;
+      int okay  = 1;
+      if (!copy && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen) {
+        unmarshal_helper(doc, buf, okay);
+      }
+      if (okay && vol->ram_cache->put(&reading->key, buf.get(), doc->len, copy, reading->auxkey)) {
+        prefetched++;
+        CACHE_INCREMENT_DYN_STAT(cache_ram_cache_prefetch_objects_stat);
+        CACHE_SUM_DYN_STAT(cache_ram_cache_prefetch_bytes_stat, doc->len);
+      }
+    }
+    buf.clear();
+    reading = nullptr;
+  }
+
+  int
+  mainEvent(int event, void *data)
+  {
+    ink_assert(vol->mutex->thread_holding == this_ethread());
+    if (event == AIO_EVENT_DONE) {
+      read_done();
+    } else {
+      int64_t quantum = cache_config_ram_cache_prefetch_rate * PERIOD / HRTIME_SECOND;
+      periodic        = static_cast<Event *>(data);
+      budget          = std::min(budget + quantum, quantum);
+      seed_next();
+    }
+    if (seeded == entries.size()) {
+      read_next();
+      if (!reading && next == entries.size()) {
+        Note("RAM cache of %s warmed up, %zu of %zu entries read back", vol->hash_text.get(), prefetched, entries.size());
+        periodic->cancel();
+        delete this;
+        return EVENT_DONE;
+      }
+    }
+    return EVENT_CONT;
+  }
+};
+
+/*
+  Writes the hot set of the RAM cache of a volume, the entries in memory and in the history with
+  their hits, to a file in the runtime directory every proxy.config.cache.ram_cache.persist.interval
+  seconds. The file is named after the hash of the volume and stamped with its creation time, a
+  file left for a volume since cleared is ignored. Restarting, the volume is warmed up from it.
+*/
+struct RamCachePersist : public Continuation {
+  Vol *vol;
+
+  explicit RamCachePersist(Vol *avol) : Continuation(new_ProxyMutex()), vol(avol) { SET_HANDLER(&RamCachePersist::startEvent); }
+
+  int
+  startEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    std::vector<RamCacheHotEntry> entries;
+    if (persist_load(vol, entries) && !entries.empty()) {
+      Note("RAM cache of %s warming up from %zu entries", vol->hash_text.get(), entries.size());
+      eventProcessor.schedule_every(new RamCacheWarmer(vol, std::move(entries)), RamCacheWarmer::PERIOD, ET_CALL);
+    }
+    SET_HANDLER(&RamCachePersist::saveEvent);
+    eventProcessor.schedule_in(this, HRTIME_SECONDS(cache_config_ram_cache_persist_interval), ET_TASK);
+    return EVENT_DONE;
+  }
+
+  int
+  saveEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    std::vector<RamCacheHotEntry> entries;
+    {
+      // the snapshot is taken under the volume lock, the file written without it
+      MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+      if (!lock.is_locked()) {
+        eventProcessor.schedule_in(this, HRTIME_MSECONDS(10), ET_TASK);
+        return EVENT_DONE;
+      }
+      vol->ram_cache->hot_set(entries, PERSIST_MAX_ENTRIES);
+    }
+    auto by_value = [](const RamCacheHotEntry &a, const RamCacheHotEntry &b) { return a.value() > b.value(); };
+    std::sort(entries.begin(), entries.end(), by_value);
+    entries.resize(std::min(entries.size(), PERSIST_MAX_ENTRIES));
+    if (persist_save(vol, entries)) {
+      Debug("ram_cache", "hot set of %s persisted, %zu entries", vol->hash_text.get(), entries.size());
+    }
+    eventProcessor.schedule_in(this, HRTIME_SECONDS(cache_config_ram_cache_persist_interval), ET_TASK);
+    return EVENT_DONE;
+  }
+};
+
+void
+ram_cache_persist_init()
+{
+  if (cache_config_ram_cache_persist_interval <= 0) {
+    return;
+  }
+  for (int i = 0; i < gnvol; i++) {
+    Vol *vol = gvol[i];
+    if (vol->fd == -1 || !vol->ram_cache || !vol->cache_vol->ramcache_enabled) {
+      continue;
+    }
+    eventProcessor.schedule_imm(new RamCachePersist(vol), ET_TASK);
+  }
+}
@@ -0,0 +1,167 @@
+/** @file
+
+  A RAM cache partitioned into independently locked shards
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+// Each key belongs to one shard, an independent RAM cache of the configured algorithm holding an
+// equal part of the volume's RAM cache budget. Every shard has its own mutex, which also serializes
+// the CLFUS compressor of that shard, so compressing entries no longer holds the volume mutex and
+// only ever delays the keys of a single shard.
+//
+// Lookups never wait: a shard busy with its compressor answers a miss, and an insert into a busy
+// shard is dropped, as the RAM cache is only a hint. Fixups are always applied, since they keep an
+// entry in step with its directory entry.
+class RamCacheSharded : public RamCache
+{
+public:
+  RamCacheSharded(int algorithm, int nshards);
+  ~RamCacheSharded() override;
+
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
+  int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
+  int64_t size() const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+  void hot_set(std::vector<RamCacheHotEntry> &entries, size_t max) override;
+  void seed(const RamCacheHotEntry &entry) override;
+
+  Vol *vol = nullptr; // for stats
+private:
+  struct Shard {
+    Ptr<ProxyMutex> mutex;
+    RamCache *cache = nullptr;
+  };
+
+  Shard &_shard_of(const CryptoHash *key);
+
+  Shard *_shards = nullptr;
+  int _nshards   = 0;
+};
+
+RamCacheSharded::RamCacheSharded(int algorithm, int nshards) : _shards(new Shard[nshards]), _nshards(nshards)
+{
+  for (int i = 0; i < _nshards; ++i) {
+    _shards[i].mutex = new_ProxyMutex();
+    switch (algorithm) {
+    default:
+    case RAM_CACHE_ALGORITHM_CLFUS:
+      _shards[i].cache = new_RamCacheCLFUS(_shards[i].mutex.get());
+      break;
+    case RAM_CACHE_ALGORITHM_LRU:
+      _shards[i].cache = new_RamCacheLRU();
+      break;
+    }
+  }
+}
+
+RamCacheSharded::~RamCacheSharded()
+{
+  for (int i = 0; i < _nshards; ++i) {
+    delete _shards[i].cache;
+  }
+  delete[] _shards;
+}
+
+RamCacheSharded::Shard &
+RamCacheSharded::_shard_of(const CryptoHash *key)
+{
+  // The shard caches pick their hash buckets from slice32(3), use a different part of the key.
+  return _shards[key->slice32(2) % _nshards];
+}
+
+void
+RamCacheSharded::init(int64_t max_bytes, Vol *avol)
+{
+  ink_assert(avol != nullptr);
+  vol = avol;
+  for (int i = 0; i < _nshards; ++i) {
+    _shards[i].cache->init(max_bytes / _nshards, vol);
+  }
+}
+
+int
+RamCacheSharded::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
+{
+  Shard &shard = _shard_of(key);
+  MUTEX_TRY_LOCK(lock, shard.mutex, this_ethread());
+  if (!lock.is_locked()) {
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+    return 0;
+  }
+  return shard.cache->get(key, ret_data, auxkey);
+}
+
+int
+RamCacheSharded::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint64_t auxkey)
+{
+  Shard &shard = _shard_of(key);
+  MUTEX_TRY_LOCK(lock, shard.mutex, this_ethread());
+  if (!lock.is_locked()) {
+    return 0;
+  }
+  return shard.cache->put(key, data, len, copy, auxkey);
+}
+
+int
+RamCacheSharded::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
+{
+  Shard &shard = _shard_of(key);
+  SCOPED_MUTEX_LOCK(lock, shard.mutex, this_ethread());
+  return shard.cache->fixup(key, old_auxkey, new_auxkey);
+}
+
+// Each shard gives its share of the most valuable entries, under its lock.
+void
+RamCacheSharded::hot_set(std::vector<RamCacheHotEntry> &entries, size_t max)
+{
+  for (int i = 0; i < _nshards; ++i) {
+    SCOPED_MUTEX_LOCK(lock, _shards[i].mutex, this_ethread());
+    _shards[i].cache->hot_set(entries, max / _nshards + 1);
+  }
+}
+
+void
+RamCacheSharded::seed(const RamCacheHotEntry &entry)
+{
+  Shard &shard = _shard_of(&entry.key);
+  SCOPED_MUTEX_LOCK(lock, shard.mutex, this_ethread());
+  shard.cache->seed(entry);
+}
+
+// Read without the shard locks, like the unsharded caches it is an estimate for reporting.
+int64_t
+RamCacheSharded::size() const
+{
+  int64_t s = 0;
+  for (int i = 0; i < _nshards; ++i) {
+    s += _shards[i].cache->size();
+  }
+  return s;
+}
+
+RamCache *
+new_RamCacheSharded(int algorithm, int shards)
+{
+  return new RamCacheSharded(algorithm, shards);
+}
@@ -0,0 +1,151 @@
+/** @file
+
+  Benchmarks of the cache directory, the probes and inserts of the volume directory in memory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include "main.h"
+
+// Defined in Cache.cc, which only clears a directory on the way to the disk.
+void vol_clear_init(Vol *d);
+
+namespace
+{
+// A volume of 1GB has some 134k entries at the default average object size.
+constexpr off_t VOL_SIZE = static_cast<off_t>(1) << 30;
+// The keys inserted, about half of the entries, not to have the inserts evict each other.
+constexpr int KEYS = 65536;
+
+/** A volume with its directory in memory and no disk behind it, set up as Vol::init does.
+
+    It lives for the whole run, it is not freed.
+ */
+Vol *
+synthetic_vol()
+{
+  Vol *d               = new Vol;
+  CacheDisk *disk      = new CacheDisk;
+  CacheVol *cache_vol  = new CacheVol;
+  disk->hw_sector_size = STORE_BLOCK_SIZE;
+  cache_vol->vol_rsb   = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  d->disk              = disk;
+  d->cache_vol         = cache_vol;
+  d->len               = VOL_SIZE;
+  d->skip              = ROUND_TO_STORE_BLOCK(START_POS);
+  d->start             = d->skip;
+
+  // The successive approximation of vol_init_data, the directory takes from the data.
+  for (int i = 0; i < 3; ++i) {
+    off_t total_entries = (d->len - (d->start - d->skip)) / cache_config_min_average_object_size;
+    off_t total_buckets = total_entries / DIR_DEPTH;
+    d->segments         = (total_buckets + (((1 << 16) - 1) / DIR_DEPTH)) / ((1 << 16) / DIR_DEPTH);
+    d->buckets          = (total_buckets + d->segments - 1) / d->segments;
+    d->start            = d->skip + 2 * d->dirlen();
+  }
+
+  size_t dir_len       = d->dirlen();
+  d->dir_segment_seq   = new std::atomic<uint32_t>[d->segments]();
+  d->dir_segment_dirty = new std::atomic<uint8_t>[d->segments]();
+  d->raw_dir           = static_cast<char *>(ats_memalign(ats_pagesize(), dir_len));
+  d->dir               = reinterpret_cast<Dir *>(d->raw_dir + d->headerlen());
+  d->header            = reinterpret_cast<VolHeaderFooter *>(d->raw_dir);
+  d->footer            = reinterpret_cast<VolHeaderFooter *>(d->raw_dir + dir_len - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+
+  return d;
+}
+
+// Empty the directory, then have it written past its start so that the entries inserted are valid.
+void
+clear_vol(Vol *d)
+{
+  vol_clear_init(d);
+  d->header->agg_pos = d->header->write_pos += 1024;
+}
+
+std::vector<CacheKey>
+random_keys(int n, uint64_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::vector<CacheKey> keys(n);
+  for (auto &key : keys) {
+    key.u64[0] = rng();
+    key.u64[1] = rng();
+  }
+  return keys;
+}
+} // namespace
+
+TEST_CASE("Cache directory", "[cache][dir][benchmark]")
+{
+  // The stats of the directory, which the listener does not set up as it does not start the cache.
+  ink_cache_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+
+  Vol *d          = synthetic_vol();
+  EThread *thread = this_ethread();
+  MUTEX_TRY_LOCK(lock, d->mutex, thread);
+  REQUIRE(lock.is_locked());
+
+  std::vector<CacheKey> present = random_keys(KEYS, 1);
+  std::vector<CacheKey> absent  = random_keys(KEYS, 2);
+
+  Dir dir;
+  dir_clear(&dir);
+  dir_set_phase(&dir, 0);
+  dir_set_head(&dir, true);
+  dir_set_offset(&dir, 1);
+
+  // Each sample starts from an empty directory, the inserts of a sample are those of a filling volume.
+  BENCHMARK_ADVANCED("dir_insert")(Catch::Benchmark::Chronometer meter)
+  {
+    clear_vol(d);
+    meter.measure([&](int i) { return dir_insert(&present[i % KEYS], d, &dir); });
+  };
+
+  clear_vol(d);
+  for (auto const &key : present) {
+    dir_insert(&key, d, &dir);
+  }
+
+  // The probes of a lookup, what dir_probe sees of a hit, of a miss, and what the lockless check
+  // of a miss costs before it.
+  BENCHMARK_ADVANCED("dir_probe, present")(Catch::Benchmark::Chronometer meter)
+  {
+    meter.measure([&](int i) {
+      Dir result, *last_collision = nullptr;
+      return dir_probe(&present[i % KEYS], d, &result, &last_collision);
+    });
+  };
+
+  BENCHMARK_ADVANCED("dir_probe, absent")(Catch::Benchmark::Chronometer meter)
+  {
+    meter.measure([&](int i) {
+      Dir result, *last_collision = nullptr;
+      return dir_probe(&absent[i % KEYS], d, &result, &last_collision);
+    });
+  };
+
+  BENCHMARK_ADVANCED("dir_probe_maybe_present, absent")(Catch::Benchmark::Chronometer meter)
+  {
+    meter.measure([&](int i) { return dir_probe_maybe_present(&absent[i % KEYS], d); });
+  };
+}
@@ -55,11 +55,21 @@ char *dns_local_ipv4                 = nullptr;
 int dns_thread                       = 0;
 int dns_prefer_ipv6                  = 0;
 DNS_CONN_MODE dns_conn_mode          = DNS_CONN_MODE::UDP_ONLY;
+int dns_tls_port                     = 853;
+int dns_tls_verify                   = 1;
+char *dns_tls_ca_file                = nullptr;
 
 namespace
 {
 const int tcp_data_length_offset = 2;
 
+// All the queries go over the persistent TCP, or TLS, connections, none over UDP.
+inline bool
+is_stream_only()
+{
+  return dns_conn_mode == DNS_CONN_MODE::TCP_ONLY || dns_conn_mode == DNS_CONN_MODE::TLS_ONLY;
+}
+
 // Currently only used for A and AAAA.
 inline const char *
 QtypeName(int qtype)
@@ -221,6 +231,9 @@ DNSProcessor::start(int, size_t stacksize)
   int dns_conn_mode_i = 0;
   REC_EstablishStaticConfigInt32(dns_conn_mode_i, "proxy.config.dns.connection_mode");
   dns_conn_mode = static_cast<DNS_CONN_MODE>(dns_conn_mode_i);
+  REC_EstablishStaticConfigInt32(dns_tls_port, "proxy.config.dns.tls.port");
+  REC_EstablishStaticConfigInt32(dns_tls_verify, "proxy.config.dns.tls.verify");
+  REC_ReadConfigStringAlloc(dns_tls_ca_file, "proxy.config.dns.tls.ca_file");
 
   if (dns_thread > 0) {
     // TODO: Hmmm, should we just get a single thread some other way?
@@ -451,7 +464,7 @@ DNSEntry::init(const char *x, int len, int qtype_arg, Continuation *acont, DNSPr
 void
 DNSHandler::open_cons(sockaddr const *target, bool failed, int icon)
 {
-  if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+  if (!is_stream_only()) {
     open_con(target, failed, icon, false);
   }
   if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -487,6 +500,14 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     target = &ip.sa;
   }
   DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon];
+  bool over_tls          = over_tcp && dns_conn_mode == DNS_CONN_MODE::TLS_ONLY;
+  IpEndpoint tls_target;
+  if (over_tls) {
+    // the name servers are configured with the port of plain DNS
+    ats_ip_copy(&tls_target, target);
+    tls_target.port() = htons(dns_tls_port);
+    target            = &tls_target.sa;
+  }
 
   Debug("dns", "open_con: opening connection %s", ats_ip_nptop(target, ip_text, sizeof ip_text));
 
@@ -498,6 +519,7 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
                                 .setNonBlockingConnect(true)
                                 .setNonBlockingIo(true)
                                 .setUseTcp(over_tcp)
+                                .setUseTls(over_tls)
                                 .setBindRandomPort(true)
                                 .setLocalIpv6(&local_ipv6.sa)
                                 .setLocalIpv4(&local_ipv4.sa)) < 0) {
@@ -512,7 +534,8 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     return;
   } else {
     ns_down[icon] = 0;
-    if (cur_con.eio.start(pd, &cur_con, EVENTIO_READ) < 0) {
+    // the TLS handshake starts once the connection is writable
+    if (cur_con.eio.start(pd, &cur_con, over_tls ? EVENTIO_READ | EVENTIO_WRITE : EVENTIO_READ) < 0) {
       Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
     } else {
       cur_con.num = icon;
@@ -643,7 +666,7 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
   if (reopen && ((t - last_primary_reopen) > DNS_PRIMARY_REOPEN_PERIOD)) {
     Debug("dns", "retry_named: reopening DNS connection for index %d", ndx);
     last_primary_reopen = t;
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (!is_stream_only()) {
       udpcon[ndx].close();
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -651,15 +674,15 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
     }
     open_cons(&m_res->nsaddr_list[ndx].sa, true, ndx);
   }
-  bool over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx].fd;
+  bool over_tcp      = is_stream_only();
+  DNSConnection &con = over_tcp ? tcpcon[ndx] : udpcon[ndx];
   unsigned char buffer[MAX_DNS_REQUEST_LEN];
   Debug("dns", "trying to resolve '%s' from DNS connection, ndx %d", try_server_names[try_servers], ndx);
   int r       = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
   try_servers = (try_servers + 1) % countof(try_server_names);
   ink_assert(r >= 0);
   if (r >= 0) { // looking for a bounce
-    int res = socketManager.send(con_fd, buffer, r, 0);
+    int res = con.send(buffer, r);
     Debug("dns", "ping result = %d", res);
   }
 }
@@ -675,8 +698,8 @@ DNSHandler::try_primary_named(bool reopen)
   }
   if ((t - last_primary_retry) > DNS_PRIMARY_RETRY_PERIOD) {
     unsigned char buffer[MAX_DNS_REQUEST_LEN];
-    bool over_tcp      = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0].fd;
+    bool over_tcp      = is_stream_only();
+    DNSConnection &con = over_tcp ? tcpcon[0] : udpcon[0];
     last_primary_retry = t;
     Debug("dns", "trying to resolve '%s' from primary DNS connection", try_server_names[try_servers]);
     int r = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -689,7 +712,7 @@ DNSHandler::try_primary_named(bool reopen)
     }
     ink_assert(r >= 0);
     if (r >= 0) { // looking for a bounce
-      int res = socketManager.send(con_fd, buffer, r, 0);
+      int res = con.send(buffer, r);
       Debug("dns", "ping result = %d", res);
     }
   }
@@ -741,7 +764,7 @@ DNSHandler::failover()
     }
     switch_named(name_server);
   } else {
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (!is_stream_only()) {
       udpcon[0].close();
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -825,6 +848,18 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       int res;
       IpEndpoint from_ip;
       socklen_t from_length = sizeof(from_ip);
+      if (dnsc->ssl && !dnsc->tls_ready) {
+        res = dnsc->handshake();
+        if (res < 0) {
+          goto Lerror;
+        }
+        if (!res) {
+          break;
+        }
+        Debug("dns", "TLS handshake with name server %d done", dnsc->num);
+        DNS_INCREMENT_DYN_STAT(dns_tls_handshakes_stat);
+        dnsc->eio.modify(-EVENTIO_WRITE);
+      }
       if (dnsc->opt._use_tcp) {
         if (dnsc->tcp_data.buf_ptr == nullptr) {
           dnsc->tcp_data.buf_ptr = make_ptr(dnsBufAllocator.alloc());
@@ -832,7 +867,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         if (dnsc->tcp_data.total_length == 0) {
           // see if TS gets a two-byte size
           uint16_t tmp = 0;
-          res          = socketManager.recv(dnsc->fd, &tmp, sizeof(tmp), MSG_PEEK);
+          res          = dnsc->recv(&tmp, sizeof(tmp), true);
           if (res == -EAGAIN || res == 1) {
             break;
           }
@@ -840,7 +875,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
             goto Lerror;
           }
           // reading total size
-          res = socketManager.recv(dnsc->fd, &(dnsc->tcp_data.total_length), sizeof(dnsc->tcp_data.total_length), 0);
+          res = dnsc->recv(&(dnsc->tcp_data.total_length), sizeof(dnsc->tcp_data.total_length));
           if (res == -EAGAIN) {
             break;
           }
@@ -854,7 +889,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         }
         // continue reading data
         void *buf_start = (char *)dnsc->tcp_data.buf_ptr->buf + dnsc->tcp_data.done_reading;
-        res             = socketManager.recv(dnsc->fd, buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading, 0);
+        res             = dnsc->recv(buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading);
         if (res == -EAGAIN) {
           break;
         }
@@ -884,6 +919,9 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       if (res <= 0) {
       Lerror:
         Debug("dns", "named error: %d", res);
+        if (dnsc->ssl && !dnsc->tls_ready) {
+          DNS_INCREMENT_DYN_STAT(dns_tls_handshake_failures_stat);
+        }
         if (dns_ns_rr) {
           rr_failure(dnsc->num);
         } else if (dnsc->num == name_server) {
@@ -1047,7 +1085,7 @@ write_dns(DNSHandler *h, bool tcp_retry)
     return;
   }
   h->in_write_dns = true;
-  bool over_tcp   = (dns_conn_mode == DNS_CONN_MODE::TCP_ONLY) || ((dns_conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
+  bool over_tcp   = is_stream_only() || ((dns_conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
   // Debug("dns", "in_flight: %d, dns_max_dns_in_flight: %d", h->in_flight, dns_max_dns_in_flight);
   if (h->in_flight < dns_max_dns_in_flight) {
     DNSEntry *e = h->entries.head;
@@ -1134,14 +1172,15 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
     h->release_query_id(e->id[dns_retries - e->retries]);
   }
   e->id[dns_retries - e->retries] = i;
-  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udpcon[h->name_server].fd;
-  Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con_fd);
+  DNSConnection &con             = over_tcp ? h->tcpcon[h->name_server] : h->udpcon[h->name_server];
+  Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con.fd);
 
-  int s = socketManager.send(con_fd, buffer, r, 0);
+  int s = con.send(buffer, r);
   if (s != r) {
     Debug("dns", "send() failed: qname = %s, %d != %d, nameserver= %d", e->qname, s, r, h->name_server);
     // changed if condition from 'r < 0' to 's < 0' - 8/2001 pas
-    if (s < 0) {
+    // a TLS connection still in its handshake takes the query later
+    if (s < 0 && !(s == -EAGAIN && con.ssl && !con.tls_ready)) {
       if (dns_ns_rr) {
         h->rr_failure(h->name_server);
       } else {
@@ -1451,6 +1490,59 @@ DNSEntry::postOneEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   return EVENT_DONE;
 }
 
+/** The TTL of a negative answer, of its SOA capped by the minimum of the SOA as in RFC 2308.
+    @return 0 if the authority section has no SOA.
+*/
+static uint32_t
+negative_ttl(HEADER *h, int len)
+{
+  u_char *cp  = reinterpret_cast<u_char *>(h) + HFIXEDSZ;
+  u_char *eom = reinterpret_cast<u_char *>(h) + len;
+  int n;
+  for (int i = ntohs(h->qdcount); i > 0; i--) {
+    if ((n = dn_skipname(cp, eom)) < 0) {
+      return 0;
+    }
+    cp += n + QFIXEDSZ;
+  }
+  int answers = ntohs(h->ancount);
+  int records = answers + ntohs(h->nscount);
+  for (int i = 0; i < records && cp < eom; i++) {
+    if ((n = dn_skipname(cp, eom)) < 0 || cp + n + RRFIXEDSZ > eom) {
+      return 0;
+    }
+    cp += n;
+    uint16_t type, rdlen;
+    uint32_t ttl;
+    NS_GET16(type, cp);
+    cp += NS_INT16SZ; // class
+    NS_GET32(ttl, cp);
+    NS_GET16(rdlen, cp);
+    u_char *end = cp + rdlen;
+    if (end > eom) {
+      return 0;
+    }
+    if (type == T_SOA && i >= answers) {
+      // MNAME and RNAME, then SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM
+      for (int name = 0; name < 2; name++) {
+        if ((n = dn_skipname(cp, end)) < 0) {
+          return 0;
+        }
+        cp += n;
+      }
+      if (cp + 5 * NS_INT32SZ > end) {
+        return 0;
+      }
+      cp += 4 * NS_INT32SZ;
+      uint32_t minimum;
+      NS_GET32(minimum, cp);
+      return std::min(ttl, minimum);
+    }
+    cp = end;
+  }
+  return 0;
+}
+
 /** Decode the reply from "named". */
 static bool
 dns_process(DNSHandler *handler, HostEnt *buf, int len)
@@ -1792,6 +1884,8 @@ dns_process(DNSHandler *handler, HostEnt *buf, int len)
 Lerror:;
   DNS_INCREMENT_DYN_STAT(dns_lookup_fail_stat);
   buf->good = false;
+  // the negative caching time of a name or of a type it does not have
+  buf->ttl = (h->rcode == NXDOMAIN || (h->rcode == NOERROR && !h->ancount)) ? negative_ttl(h, len) : 0;
   dns_result(handler, e, buf, retry, tcp_retry);
   return server_ok;
 }
@@ -1842,6 +1936,12 @@ ink_dns_init(ts::ModuleVersion v)
   RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.max_retries_exceeded", RECD_INT, RECP_PERSISTENT,
                      (int)dns_max_retries_exceeded_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.tls_handshakes", RECD_INT, RECP_PERSISTENT,
+                     (int)dns_tls_handshakes_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.tls_handshake_failures", RECD_INT, RECP_PERSISTENT,
+                     (int)dns_tls_handshake_failures_stat, RecRawStatSyncSum);
+
   RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.in_flight", RECD_INT, RECP_NON_PERSISTENT, (int)dns_in_flight_stat,
                      RecRawStatSyncSum);
 }
@@ -27,6 +27,9 @@
   Commonality across all platforms -- move out as required.
 
 **************************************************************************/
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
 #include "P_DNS.h"
 #include "P_DNSConnection.h"
 #include "P_DNSProcessor.h"
@@ -44,6 +47,54 @@
 
 DNSConnection::Options const DNSConnection::DEFAULT_OPTIONS;
 
+namespace
+{
+// The client context of the DNS over TLS connections, made with the first of them.
+SSL_CTX *
+dns_tls_context()
+{
+  static SSL_CTX *ctx = nullptr;
+  if (ctx) {
+    return ctx;
+  }
+  ctx = SSL_CTX_new(TLS_client_method());
+  if (!ctx) {
+    Error("DNS over TLS: cannot create the TLS context");
+    return nullptr;
+  }
+  SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+  SSL_CTX_set_mode(ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+  if (dns_tls_ca_file && *dns_tls_ca_file) {
+    if (!SSL_CTX_load_verify_locations(ctx, dns_tls_ca_file, nullptr)) {
+      Error("DNS over TLS: cannot load the CA certificates of %s", dns_tls_ca_file);
+    }
+  } else {
+    SSL_CTX_set_default_verify_paths(ctx);
+  }
+  SSL_CTX_set_verify(ctx, dns_tls_verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+  return ctx;
+}
+
+// Map the result @a n of a TLS call to the return of a socket call.
+int
+dns_tls_result(SSL *ssl, int n)
+{
+  if (n > 0) {
+    return n;
+  }
+  switch (SSL_get_error(ssl, n)) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    return -EAGAIN;
+  case SSL_ERROR_ZERO_RETURN:
+    return 0;
+  default:
+    ERR_clear_error();
+    return -EIO;
+  }
+}
+} // namespace
+
 //
 // Functions
 //
@@ -63,6 +114,12 @@ int
 DNSConnection::close()
 {
   eio.stop();
+  if (ssl) {
+    SSL_free(ssl);
+    ssl = nullptr;
+  }
+  tls_ready = false;
+  tls_pending.clear();
   // don't close any of the standards
   if (fd >= 2) {
     int fd_save = fd;
@@ -199,6 +256,19 @@ DNSConnection::connect(sockaddr const *addr, Options const &opt)
   ats_ip_copy(&ip.sa, addr);
   res = ::connect(fd, addr, ats_ip_size(addr));
 
+  if (opt._use_tls && (!res || ((res < 0) && (errno == EINPROGRESS || errno == EWOULDBLOCK)))) {
+    SSL_CTX *ctx = dns_tls_context();
+    if (!ctx || !(ssl = SSL_new(ctx))) {
+      res = -ENOMEM;
+      goto Lerror;
+    }
+    SSL_set_fd(ssl, fd);
+    SSL_set_connect_state(ssl);
+    // name servers are addresses, their certificates must be issued for them
+    ip_text_buffer ipb;
+    X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), ats_ip_ntop(addr, ipb, sizeof(ipb)));
+  }
+
   if (!res || ((res < 0) && (errno == EINPROGRESS || errno == EWOULDBLOCK))) {
     if (!opt._non_blocking_connect && opt._non_blocking_io) {
       if ((res = safe_nonblocking(fd)) < 0) {
@@ -219,3 +289,67 @@ Lerror:
   }
   return res;
 }
+
+int
+DNSConnection::handshake()
+{
+  if (tls_ready) {
+    return 1;
+  }
+  int res = dns_tls_result(ssl, SSL_do_handshake(ssl));
+  if (res > 0) {
+    tls_ready = true;
+    return 1;
+  }
+  if (res == -EAGAIN) {
+    return 0;
+  }
+  ip_port_text_buffer ipb;
+  Warning("DNS over TLS: handshake with %s failed: %s", ats_ip_nptop(&ip.sa, ipb, sizeof(ipb)),
+          SSL_get_verify_result(ssl) != X509_V_OK ? X509_verify_cert_error_string(SSL_get_verify_result(ssl)) : "connection error");
+  return res ? res : -ECONNRESET;
+}
+
+int
+DNSConnection::recv(void *buf, int len, bool peek)
+{
+  if (!ssl) {
+    return socketManager.recv(fd, buf, len, peek ? MSG_PEEK : 0);
+  }
+  if (!tls_ready) {
+    int res = handshake();
+    if (res <= 0) {
+      return res ? res : -EAGAIN;
+    }
+  }
+  return dns_tls_result(ssl, peek ? SSL_peek(ssl, buf, len) : SSL_read(ssl, buf, len));
+}
+
+int
+DNSConnection::send(const void *buf, int len)
+{
+  if (!ssl) {
+    return socketManager.send(fd, const_cast<void *>(buf), len, 0);
+  }
+  if (!tls_ready) {
+    int res = handshake();
+    if (res <= 0) {
+      return res ? res : -EAGAIN;
+    }
+  }
+  // an interrupted write must be done again with the same data
+  if (!tls_pending.empty()) {
+    int res = dns_tls_result(ssl, SSL_write(ssl, tls_pending.data(), tls_pending.size()));
+    if (res <= 0) {
+      return res ? res : -ECONNRESET;
+    }
+    tls_pending.clear();
+  }
+  int res = dns_tls_result(ssl, SSL_write(ssl, buf, len));
+  if (res == -EAGAIN) {
+    // the query goes with the next write
+    tls_pending.assign(static_cast<const char *>(buf), len);
+    return len;
+  }
+  return res ? res : -ECONNRESET;
+}
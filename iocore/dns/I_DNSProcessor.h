@@ -42,7 +42,7 @@ const int DNS_HOSTBUF_SIZE     = MAX_DNS_RESPONSE_LEN;
 */
 struct HostEnt : RefCountObj {
   struct hostent ent = {.h_name = nullptr, .h_aliases = nullptr, .h_addrtype = 0, .h_length = 0, .h_addr_list = nullptr};
-  uint32_t ttl       = 0;
+  uint32_t ttl       = 0; ///< of the answers, or of the SOA of a negative answer
   int packet_size    = 0;
   char buf[MAX_DNS_RESPONSE_LEN]         = {0};
   u_char *host_aliases[DNS_MAX_ALIASES]  = {nullptr};
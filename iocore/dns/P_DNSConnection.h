@@ -30,6 +30,10 @@
 
 #pragma once
 
+#include <string>
+
+#include <openssl/ssl.h>
+
 #include "I_EventSystem.h"
 #include "I_DNSProcessor.h"
 
@@ -37,7 +41,7 @@
 // Connection
 //
 struct DNSHandler;
-enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY };
+enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY, TLS_ONLY };
 
 struct DNSConnection {
   /// Options for connecting.
@@ -53,6 +57,9 @@ struct DNSConnection {
     /// Use TCP if @c true, use UDP if @c false.
     /// Default: @c false.
     bool _use_tcp = false;
+    /// Use TLS over TCP if @c true.
+    /// Default: @c false.
+    bool _use_tls = false;
     /// Bind to a random port.
     /// Default: @c true.
     bool _bind_random_port = true;
@@ -66,6 +73,7 @@ struct DNSConnection {
     Options();
 
     self &setUseTcp(bool p);
+    self &setUseTls(bool p);
     self &setNonBlockingConnect(bool p);
     self &setNonBlockingIo(bool p);
     self &setBindRandomPort(bool p);
@@ -96,7 +104,23 @@ struct DNSConnection {
     }
   } tcp_data;
 
+  /// The TLS session of a DNS over TLS connection, @c nullptr otherwise.
+  SSL *ssl = nullptr;
+  /// The TLS handshake is done, queries can be sent.
+  bool tls_ready = false;
+  /// A query an interrupted TLS write left, written again first.
+  std::string tls_pending;
+
   int connect(sockaddr const *addr, Options const &opt = DEFAULT_OPTIONS);
+  /**
+    Receive, through the TLS session if there is one.
+    @return The number of bytes read, 0 if the connection was closed, -errno on error, -EAGAIN if there is nothing yet.
+  */
+  int recv(void *buf, int len, bool peek = false);
+  /// Send a whole query, through the TLS session if there is one, @return as @c recv.
+  int send(const void *buf, int len);
+  /// Progress the TLS handshake, @return 1 if it is done, 0 if it goes on, -errno on error.
+  int handshake();
   /*
                 bool non_blocking_connect = NON_BLOCKING_CONNECT,
                 bool use_tcp = CONNECT_WITH_TCP, bool non_blocking = NON_BLOCKING, bool bind_random_port = BIND_ANY_PORT);
@@ -131,6 +155,12 @@ DNSConnection::Options::setUseTcp(bool p)
   return *this;
 }
 inline DNSConnection::Options &
+DNSConnection::Options::setUseTls(bool p)
+{
+  _use_tls = p;
+  return *this;
+}
+inline DNSConnection::Options &
 DNSConnection::Options::setBindRandomPort(bool p)
 {
   _bind_random_port = p;
@@ -49,6 +49,9 @@ extern int dns_failover_number;
 extern int dns_failover_period;
 extern int dns_failover_try_period;
 extern int dns_max_dns_in_flight;
+extern int dns_tls_port;
+extern int dns_tls_verify;
+extern char *dns_tls_ca_file;
 extern unsigned int dns_sequence_number;
 
 //
@@ -85,6 +88,8 @@ enum DNS_Stats {
   dns_retries_stat,
   dns_max_retries_exceeded_stat,
   dns_in_flight_stat,
+  dns_tls_handshakes_stat,
+  dns_tls_handshake_failures_stat,
   DNS_Stat_Count
 };
 
@@ -114,7 +114,7 @@ SplitDNSConfig::startup()
 {
   // startup just check gsplit_dns_enabled
   REC_ReadConfigInt32(gsplit_dns_enabled, "proxy.config.dns.splitDNS.enabled");
-  SplitDNSConfig::splitDNSUpdate = new ConfigUpdateHandler<SplitDNSConfig>();
+  SplitDNSConfig::splitDNSUpdate = new ConfigUpdateHandler<SplitDNSConfig>("splitdns");
   SplitDNSConfig::splitDNSUpdate->attach("proxy.config.cache.splitdns.filename");
 }
 
@@ -0,0 +1,86 @@
+/** @file
+
+  Frame allocation for the coroutine adapters.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "I_Coroutine.h"
+
+// This does not need coroutine support from the compiler, so the core can provide it to plugins
+// built with a newer language level.
+
+Allocator coroutineFrameAllocator[COROUTINE_FRAME_SIZE_CLASSES] = {
+  {"coroutineFrameAllocator[128]", 128, 64, 16},   {"coroutineFrameAllocator[256]", 256, 64, 16},
+  {"coroutineFrameAllocator[512]", 512, 32, 16},   {"coroutineFrameAllocator[1024]", 1024, 32, 16},
+  {"coroutineFrameAllocator[2048]", 2048, 16, 16}, {"coroutineFrameAllocator[4096]", 4096, 16, 16},
+};
+
+namespace
+{
+/// Size class for a frame of @a size bytes, COROUTINE_FRAME_SIZE_CLASSES if it is too large for any.
+int
+frame_size_class(size_t size)
+{
+  int idx = 0;
+  while (idx < COROUTINE_FRAME_SIZE_CLASSES && (size_t(128) << idx) < size) {
+    ++idx;
+  }
+  return idx;
+}
+} // namespace
+
+namespace ts
+{
+namespace coroutine
+{
+  void *
+  frame_alloc(size_t size)
+  {
+    int idx = frame_size_class(size);
+    if (idx == COROUTINE_FRAME_SIZE_CLASSES) {
+      return ats_malloc(size);
+    }
+    EThread *t = this_ethread();
+    return t ? thread_alloc(coroutineFrameAllocator[idx], t->coroutineFrameAllocator[idx]) :
+               coroutineFrameAllocator[idx].alloc_void();
+  }
+
+  void
+  frame_free(void *ptr, size_t size)
+  {
+    int idx = frame_size_class(size);
+    if (idx == COROUTINE_FRAME_SIZE_CLASSES) {
+      ats_free(ptr);
+      return;
+    }
+    EThread *t = this_ethread();
+    if (t == nullptr || cmd_disable_pfreelist) {
+      coroutineFrameAllocator[idx].free_void(ptr);
+      return;
+    }
+    ProxyAllocator &l = t->coroutineFrameAllocator[idx];
+    *static_cast<void **>(ptr) = l.freelist;
+    l.freelist                 = ptr;
+    if (++l.allocated > thread_freelist_high_watermark) {
+      thread_freeup(coroutineFrameAllocator[idx], l);
+    }
+  }
+} // namespace coroutine
+} // namespace ts
@@ -34,7 +34,8 @@ void
 ink_event_system_init(ts::ModuleVersion v)
 {
   ink_release_assert(v.check(EVENT_SYSTEM_MODULE_INTERNAL_VERSION));
-  int iobuffer_advice = 0;
+  int iobuffer_advice               = 0;
+  RecInt iobuffer_thread_cache_size = 0;
 
   // For backwards compatibility make sure to allow thread_freelist_size
   // This needs to change in 6.0
@@ -51,5 +52,7 @@ ink_event_system_init(ts::ModuleVersion v)
   }
 #endif
 
-  init_buffer_allocators(iobuffer_advice);
+  REC_ReadConfigInteger(iobuffer_thread_cache_size, "proxy.config.allocator.iobuf_thread_cache_size");
+
+  init_buffer_allocators(iobuffer_advice, iobuffer_thread_cache_size);
 }
@@ -27,11 +27,14 @@
 **************************************************************************/
 #include "tscore/ink_defs.h"
 #include "P_EventSystem.h"
+#include "tscore/JeAllocator.h"
 
 //
 // General Buffer Allocator
 //
 inkcoreapi Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
+inkcoreapi int ioBufThreadCacheHigh[DEFAULT_BUFFER_SIZES];
+inkcoreapi int ioBufThreadCacheLow[DEFAULT_BUFFER_SIZES];
 inkcoreapi ClassAllocator<MIOBuffer> ioAllocator("ioAllocator", DEFAULT_BUFFER_NUMBER);
 inkcoreapi ClassAllocator<IOBufferData> ioDataAllocator("ioDataAllocator", DEFAULT_BUFFER_NUMBER);
 inkcoreapi ClassAllocator<IOBufferBlock> ioBlockAllocator("ioBlockAllocator", DEFAULT_BUFFER_NUMBER);
@@ -42,9 +45,13 @@ int64_t max_iobuffer_size           = DEFAULT_BUFFER_SIZES - 1;
 //
 // Initialization
 //
+static_assert(DEFAULT_BUFFER_SIZES == IOBUFFER_SIZE_CLASSES, "Thread buffer caches do not match the buffer sizes");
+
 void
-init_buffer_allocators(int iobuffer_advice)
+init_buffer_allocators(int iobuffer_advice, int64_t thread_cache_bytes)
 {
+  jearena::Arena *arena = jearena::Arena::get("iobuffer", iobuffer_advice != 0);
+
   for (int i = 0; i < DEFAULT_BUFFER_SIZES; i++) {
     int64_t s = DEFAULT_BUFFER_BASE_SIZE * ((static_cast<int64_t>(1)) << i);
     int64_t a = DEFAULT_BUFFER_ALIGNMENT;
@@ -56,6 +63,15 @@ init_buffer_allocators(int iobuffer_advice)
     auto name = new char[64];
     snprintf(name, 64, "ioBufAllocator[%d]", i);
     ioBufAllocator[i].re_init(name, s, n, a, iobuffer_advice);
+    ioBufAllocator[i].set_arena(arena);
+
+    // The thread cache of the size is a magazine of up to this many buffers. A full one goes back
+    // to the allocator half at a time, so the global freelist sees a batch instead of each free.
+    int64_t high = thread_cache_bytes > 0 ? thread_cache_bytes / s : thread_freelist_high_watermark;
+    high         = std::max<int64_t>(4, std::min<int64_t>(high, thread_freelist_high_watermark));
+
+    ioBufThreadCacheHigh[i] = high;
+    ioBufThreadCacheLow[i]  = high / 2;
   }
 }
 
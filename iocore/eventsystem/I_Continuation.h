@@ -174,6 +174,15 @@ public:
   */
   ContFlags control_flags;
 
+  /**
+    Set if this continuation does not depend on the thread it runs on.
+
+    Immediate events for such a continuation are not pinned to a thread
+    and, if work stealing is enabled, may be run by an idle thread of the
+    same type instead of the thread they were scheduled on.
+  */
+  bool thread_agnostic = false;
+
   EThread *thread_affinity = nullptr;
 
   bool
@@ -0,0 +1,360 @@
+/** @file
+
+  Coroutine adapters for continuation based interfaces.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A function returning @c ts::Task is a coroutine that can @c co_await the operations of the event
+  system instead of being written as a state machine of handlers.
+
+  @code
+    ts::Task
+    fetch(CacheKey key)
+    {
+      auto [event, data] = co_await ts::cache_open_read(key);
+      if (event != CACHE_EVENT_OPEN_READ) {
+        co_return;
+      }
+      CacheVC *vc = static_cast<CacheVC *>(data);
+      ...
+      co_await ts::sleep_for(HRTIME_MSECONDS(10));
+    }
+  @endcode
+
+  A task starts on the calling thread, which must be an event thread, and always resumes on that
+  thread. It has a mutex of its own, held while the coroutine body runs, which is the mutex of the
+  continuation through which it receives callbacks. That continuation is part of the coroutine frame
+  and the frame is allocated from the per thread freelists, so an await costs no allocation beyond
+  what the awaited operation itself does.
+
+  A task runs until it returns, there is no cancellation. Like any continuation it must not return
+  while another object can still call it back, e.g. it must close the VConnections it opened.
+
+  The coroutine types need compiler support for coroutines, which configure turns on where the
+  compiler has it (@c --enable-coroutines, e.g. @c -fcoroutines for GCC). Without it the core only
+  provides the frame allocation and @c TS_HAS_COROUTINES is not defined.
+ */
+
+#pragma once
+
+#include "I_EventSystem.h"
+
+extern Allocator coroutineFrameAllocator[COROUTINE_FRAME_SIZE_CLASSES];
+
+namespace ts
+{
+namespace coroutine
+{
+  /// Allocate a coroutine frame of @a size bytes from the freelists of the current thread.
+  void *frame_alloc(size_t size);
+  /// Free a frame allocated by @c frame_alloc, @a size must be the size it was allocated with.
+  void frame_free(void *ptr, size_t size);
+} // namespace coroutine
+} // namespace ts
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define TS_HAS_COROUTINES 1
+
+#include <coroutine>
+
+namespace ts
+{
+/// The event and data a continuation was called back with.
+struct EventResult {
+  int event  = EVENT_NONE;
+  void *data = nullptr;
+};
+
+class Awaiter;
+
+/// Return type of a coroutine that runs on the event system.
+class Task
+{
+public:
+  /// The continuation a task receives callbacks through.
+  class Driver : public Continuation
+  {
+  public:
+    Driver() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Driver::handle_event); }
+
+    /// Start @a a and return whether the task has to wait for its completion.
+    bool wait(Awaiter *a);
+
+    std::coroutine_handle<> handle;
+    EThread *thread = nullptr;
+
+  private:
+    int handle_event(int event, void *data);
+
+    Awaiter *_waiting = nullptr;
+    Event *_resume    = nullptr; ///< Pending event that resumes the task on its thread.
+    bool _starting    = false;
+  };
+
+  struct promise_type {
+    Driver driver;
+
+    static void *
+    operator new(size_t size)
+    {
+      return coroutine::frame_alloc(size);
+    }
+
+    static void
+    operator delete(void *ptr, size_t size)
+    {
+      coroutine::frame_free(ptr, size);
+    }
+
+    Task
+    get_return_object()
+    {
+      driver.handle = std::coroutine_handle<promise_type>::from_promise(*this);
+      driver.thread = this_ethread();
+      ink_release_assert(driver.thread != nullptr);
+      return {};
+    }
+
+    /// Run the body up to its first suspension with the task mutex held.
+    struct Start {
+      bool
+      await_ready() const noexcept
+      {
+        return false;
+      }
+
+      void
+      await_suspend(std::coroutine_handle<promise_type> h)
+      {
+        // The frame can be gone once the body returns, keep what the lock needs off it.
+        Ptr<ProxyMutex> m = h.promise().driver.mutex;
+        SCOPED_MUTEX_LOCK(lock, m, this_ethread());
+        h.resume();
+      }
+
+      void
+      await_resume() const noexcept
+      {
+      }
+    };
+
+    Start
+    initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never
+    final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void
+    return_void()
+    {
+    }
+
+    void
+    unhandled_exception()
+    {
+      ink_release_assert(!"unhandled exception in a coroutine");
+    }
+  };
+};
+
+/** Base for the awaitable operations of a task.
+    A subclass starts the operation with the task continuation as its callback and may filter the
+    events that complete it.
+*/
+class Awaiter
+{
+public:
+  virtual ~Awaiter() = default;
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<Task::promise_type> h)
+  {
+    return h.promise().driver.wait(this);
+  }
+
+  EventResult
+  await_resume() const noexcept
+  {
+    return result;
+  }
+
+  /// Start the operation, calling back @a cont.
+  virtual void start(Continuation *cont) = 0;
+
+  /** Whether the callback with @a event and @a data completes the operation.
+      This is called in the callback, on whichever thread made it.
+  */
+  virtual bool
+  accept(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    return true;
+  }
+
+  EventResult result;
+};
+
+inline bool
+Task::Driver::wait(Awaiter *a)
+{
+  _waiting  = a;
+  _starting = true;
+  a->start(this);
+  _starting = false;
+  // Not waiting any more if it completed before returning, the task continues without suspending.
+  return _waiting != nullptr;
+}
+
+inline int
+Task::Driver::handle_event(int event, void *data)
+{
+  if (_resume != nullptr && data == _resume) {
+    _resume = nullptr;
+    handle.resume(); // Can destroy the frame, and this with it.
+    return EVENT_DONE;
+  }
+  if (_waiting == nullptr || !_waiting->accept(event, data)) {
+    return EVENT_CONT; // Nothing waits for this, or it does not complete the operation.
+  }
+  _waiting->result = {event, data};
+  _waiting         = nullptr;
+  if (_starting) {
+    return EVENT_DONE;
+  }
+  if (this_ethread() != thread) {
+    _resume = thread->schedule_imm(this);
+    return EVENT_DONE;
+  }
+  handle.resume();
+  return EVENT_DONE;
+}
+
+/// Awaiter for an operation started by calling a function with the callback continuation.
+template <class F> class EventAwaiter : public Awaiter
+{
+public:
+  explicit EventAwaiter(F &&f) : _f(std::forward<F>(f)) {}
+
+  void
+  start(Continuation *cont) override
+  {
+    _f(cont);
+  }
+
+private:
+  F _f;
+};
+
+/** Await the first callback of an operation.
+    @a f is called with the continuation to call back, e.g.
+    @code
+      auto [event, data] = co_await ts::await_event([&](Continuation *c) { processor.do_something(c); });
+    @endcode
+*/
+template <class F>
+EventAwaiter<F>
+await_event(F &&f)
+{
+  return EventAwaiter<F>(std::forward<F>(f));
+}
+
+/// Resume after @a delay, on the task thread.
+class sleep_for : public Awaiter
+{
+public:
+  explicit sleep_for(ink_hrtime delay) : _delay(delay) {}
+
+  void
+  start(Continuation *cont) override
+  {
+    this_ethread()->schedule_in(cont, _delay);
+  }
+
+private:
+  ink_hrtime _delay;
+};
+
+/** Await the completion of an IO operation on a VConnection.
+    This completes with the first event that is not @c VC_EVENT_READ_READY or @c
+    VC_EVENT_WRITE_READY, e.g. @c VC_EVENT_READ_COMPLETE or @c VC_EVENT_EOS, with the VIO as the
+    data. The buffer must be able to take the transfer, nothing consumes it meanwhile.
+
+    The VIO keeps the task as its continuation. Later events on it are dropped unless something
+    again waits for them.
+*/
+class VIOAwaiter : public Awaiter
+{
+public:
+  /// Read up to @a nbytes from @a vc into @a buf.
+  VIOAwaiter(VConnection *vc, int64_t nbytes, MIOBuffer *buf) : _vc(vc), _nbytes(nbytes), _writer(buf) {}
+  /// Write @a nbytes from @a reader to @a vc.
+  VIOAwaiter(VConnection *vc, int64_t nbytes, IOBufferReader *reader) : _vc(vc), _nbytes(nbytes), _reader(reader) {}
+
+  void
+  start(Continuation *cont) override
+  {
+    if (_writer) {
+      _vc->do_io_read(cont, _nbytes, _writer);
+    } else {
+      _vc->do_io_write(cont, _nbytes, _reader);
+    }
+  }
+
+  bool
+  accept(int event, void *) override
+  {
+    return event != VC_EVENT_READ_READY && event != VC_EVENT_WRITE_READY;
+  }
+
+private:
+  VConnection *_vc;
+  int64_t _nbytes;
+  MIOBuffer *_writer      = nullptr;
+  IOBufferReader *_reader = nullptr;
+};
+
+/// Await the completion of reading @a nbytes from @a vc.
+inline VIOAwaiter
+do_io_read(VConnection *vc, int64_t nbytes, MIOBuffer *buf)
+{
+  return {vc, nbytes, buf};
+}
+
+/// Await the completion of writing @a nbytes to @a vc.
+inline VIOAwaiter
+do_io_write(VConnection *vc, int64_t nbytes, IOBufferReader *reader)
+{
+  return {vc, nbytes, reader};
+}
+
+} // namespace ts
+#endif
@@ -24,9 +24,12 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "tscore/ink_rand.h"
 #include "tscore/I_Version.h"
+#include "tscore/Histogram.h"
 #include "I_Thread.h"
 #include "I_PriorityEventQueue.h"
 #include "I_ProtectedQueue.h"
@@ -51,6 +54,29 @@ enum ThreadType {
   DEDICATED,
 };
 
+/** Immediate events to be scheduled on one thread together.
+    The events are handed over by @c EThread::schedule_batch with a single enqueue and at most one
+    wake up of the thread, however many there are.
+*/
+class EventBatch
+{
+public:
+  /// Add an immediate event for @a c, which is returned as @c EThread::schedule_imm would.
+  Event *add(Continuation *c, int callback_event = EVENT_IMMEDIATE, void *cookie = nullptr);
+
+  bool
+  empty() const
+  {
+    return _head == nullptr;
+  }
+
+private:
+  friend class EThread;
+  // Linked through Event::link.next newest first, the order of the external event queue.
+  Event *_head = nullptr;
+  Event *_tail = nullptr;
+};
+
 /**
   Event System specific type of thread.
 
@@ -127,6 +153,15 @@ public:
   */
   Event *schedule_imm(Continuation *c, int callback_event = EVENT_IMMEDIATE, void *cookie = nullptr);
 
+  /**
+    Schedules the events of @a batch on this EThread. They are called
+    back in the order they were added. This is the same as calling
+    schedule_imm for each, but with far less cross thread traffic when
+    there are many. @a batch is empty afterwards.
+
+  */
+  void schedule_batch(EventBatch &batch);
+
   /**
     Schedules the continuation on this EThread to receive an event
     at the given timeout.
@@ -315,9 +350,19 @@ public:
   ProtectedQueue EventQueueExternal;
   PriorityEventQueue EventQueue;
 
+  /** Immediate events for thread agnostic continuations.
+      These are run by this thread, or taken by an idle thread of the same group when work stealing is enabled.
+  */
+  InkAtomicList stealable;
+  std::atomic<int> stealable_count{0};
+
+  /// Put @a e, which must be assigned to this thread, on the stealable list.
+  void enqueue_stealable(Event *e);
+
   static constexpr int NO_ETHREAD_ID = -1;
   int id                             = NO_ETHREAD_ID;
   unsigned int event_types           = 0;
+  int numa_node                      = -1; ///< NUMA node the thread is bound to, -1 if it spans several or is not bound.
   bool is_event_type(EventType et);
   void set_event_type(EventType et);
 
@@ -328,6 +373,7 @@ public:
   void process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count);
   void process_event(Event *e, int calling_code);
   void free_event(Event *e);
+  int steal_events();
   LoopTailHandler *tail_cb = &DEFAULT_TAIL_HANDLER;
 
 #if HAVE_EVENTFD
@@ -398,8 +444,11 @@ public:
       Events() {}
     } _events;
 
-    int _count = 0; ///< # of times the loop executed.
-    int _wait  = 0; ///< # of timed wait for events
+    int _count    = 0; ///< # of times the loop executed.
+    int _wait     = 0; ///< # of timed wait for events
+    int _stolen   = 0; ///< # of events taken from other threads.
+    int _external = 0; ///< # of events received from other threads.
+    int _wakeups  = 0; ///< # of signals other threads sent to wake this one.
 
     /// Add @a that to @a this data.
     /// This embodies the custom logic per member concerning whether each is a sum, min, or max.
@@ -430,6 +479,9 @@ public:
     STAT_LOOP_WAIT,       ///< # of loops that did a conditional wait.
     STAT_LOOP_TIME_MIN,   ///< Shortest time spent in loop.
     STAT_LOOP_TIME_MAX,   ///< Longest time spent in loop.
+    STAT_LOOP_STOLEN,     ///< # of events stolen from other threads.
+    STAT_LOOP_EXTERNAL,   ///< # of events received from other threads.
+    STAT_LOOP_WAKEUPS,    ///< # of wake up signals received from other threads.
     N_EVENT_STATS         ///< NOT A VALID STAT INDEX - # of different stat types.
   };
 
@@ -444,6 +496,22 @@ public:
 
   /// Process the last 1000s of data and write out the summaries to @a summary.
   void summarize_stats(EventMetrics summary[N_EVENT_TIMESCALES]);
+
+  /// Latency distribution, in microseconds.
+  using LatencyHistogram = ts::Histogram<30, 3>;
+
+  /** Latency distributions for this thread since it started.
+      These are only written by this thread. The stats sync publishes percentiles of the change
+      since the previous sync.
+  */
+  struct LatencyHistograms {
+    LatencyHistogram loop;     ///< Duration of each loop, including the wait for activity.
+    LatencyHistogram lateness; ///< Time between the scheduled and actual dispatch of timed events.
+    LatencyHistogram handler;  ///< Time spent in each event handler call, see @c thread_handler_timing.
+  } latency;
+
+  /// Time this thread spent blocked waiting for activity since it started, only written by this thread.
+  ink_hrtime idle_time = 0;
   /// Back up the metric pointer, wrapping as needed.
   EventMetrics *
   prev(EventMetrics volatile *current)
@@ -477,3 +545,6 @@ operator new(size_t, ink_dummy_for_new *p)
 extern EThread *this_ethread();
 
 extern int thread_max_heartbeat_mseconds;
+extern int thread_work_stealing;
+extern int thread_handler_timing;
+extern int thread_slow_handler_mseconds;
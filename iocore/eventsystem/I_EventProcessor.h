@@ -330,6 +330,15 @@ public:
   Event *schedule(Event *e, EventType etype);
   EThread *assign_thread(EventType etype);
   EThread *assign_affinity_by_type(Continuation *cont, EventType etype);
+  /** Pick a thread of type @a etype on the NUMA node of processor @a cpu.
+      This is @c assign_thread unless threads are partitioned by NUMA node (@c
+      proxy.config.allocator.per_numa_node) and the node of @a cpu has a thread of that type.
+  */
+  EThread *assign_thread_near_cpu(EventType etype, int cpu);
+  /** The OS processor @a t is bound to, -1 if it is not bound to a single one.
+      This follows from @c proxy.config.exec_thread.affinity and is known before @a t starts.
+  */
+  int cpu_of_thread(EThread *t) const;
 
   EThread *all_dthreads[MAX_EVENT_THREADS];
   int n_dthreads       = 0; // No. of dedicated threads
@@ -46,6 +46,8 @@
 #include "tscore/ink_assert.h"
 #include "tscore/ink_resource.h"
 
+#include <atomic>
+
 struct MIOBufferAccessor;
 
 class MIOBuffer;
@@ -110,8 +112,81 @@ enum AllocType {
 #define BUFFER_SIZE_INDEX_FOR_CONSTANT_SIZE(_size) (_size + DEFAULT_BUFFER_SIZES)
 
 inkcoreapi extern Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
+/// Number of buffers of each size a thread keeps, and keeps after returning a batch.
+inkcoreapi extern int ioBufThreadCacheHigh[DEFAULT_BUFFER_SIZES];
+inkcoreapi extern int ioBufThreadCacheLow[DEFAULT_BUFFER_SIZES];
+
+/** Set up the buffer allocators.
+    @a thread_cache_bytes is how much memory of each buffer size a thread keeps for reuse.
+*/
+void init_buffer_allocators(int iobuffer_advice, int64_t thread_cache_bytes = 0);
+
+/** Accounting of the buffer memory used on behalf of an owner, e.g. a transaction or a session.
+    Buffers tagged with an account charge it for the data blocks they allocate, until the data is
+    freed. Data can be freed on any thread and can outlive the owner, so the count is atomic and the
+    account is reference counted.
+
+    An account can have a parent, e.g. the session of a transaction, which is charged as well.
+*/
+class IOBufferAccount : public RefCountObj
+{
+public:
+  /// @a name must outlive the account, @a limit is the cap in bytes, 0 for none.
+  explicit IOBufferAccount(const char *name, int64_t limit = 0, IOBufferAccount *parent = nullptr)
+    : name(name), limit(limit), _parent(parent)
+  {
+  }
+
+  void
+  charge(int64_t bytes)
+  {
+    int64_t n = _bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (n > _peak.load(std::memory_order_relaxed)) {
+      _peak.store(n, std::memory_order_relaxed); // A racing update can lose, it is only for reporting.
+    }
+    if (_parent) {
+      _parent->charge(bytes);
+    }
+  }
+
+  void
+  release(int64_t bytes)
+  {
+    _bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    if (_parent) {
+      _parent->release(bytes);
+    }
+  }
 
-void init_buffer_allocators(int iobuffer_advice);
+  /// Bytes of buffer memory currently charged.
+  int64_t
+  bytes() const
+  {
+    return _bytes.load(std::memory_order_relaxed);
+  }
+
+  /// Largest value of @c bytes so far.
+  int64_t
+  peak() const
+  {
+    return _peak.load(std::memory_order_relaxed);
+  }
+
+  /// Whether this account or one of its parents is above its limit.
+  bool
+  over_limit() const
+  {
+    return (limit > 0 && this->bytes() > limit) || (_parent && _parent->over_limit());
+  }
+
+  const char *name;
+  int64_t limit;
+
+private:
+  Ptr<IOBufferAccount> _parent;
+  std::atomic<int64_t> _bytes{0};
+  std::atomic<int64_t> _peak{0};
+};
 
 /**
   A reference counted wrapper around fast allocated or malloced memory.
@@ -225,6 +300,16 @@ public:
 
   const char *_location = nullptr;
 
+  /**
+    Charge the memory of this IOBufferData to @a account until it is
+    deallocated.
+
+  */
+  void set_account(IOBufferAccount *account);
+
+  /// The account charged for the memory, if any.
+  Ptr<IOBufferAccount> _account;
+
   /**
     Constructor. Initializes state for a IOBufferData object. Do not use
     this method. Use one of the functions with the 'new_' prefix instead.
@@ -1211,6 +1296,23 @@ public:
     water_mark = 0;
   }
 
+  /** Free the blocks of an empty buffer but keep its readers.
+      The readers continue with the next block written, which is allocated at @a next_size_index
+      only when something is written. This lets an idle buffer hold no memory.
+  */
+  void
+  release_blocks(int64_t next_size_index)
+  {
+    _writer = nullptr;
+    for (auto &reader : readers) {
+      if (reader.allocated()) {
+        reader.block        = nullptr;
+        reader.start_offset = 0;
+      }
+    }
+    size_index = next_size_index;
+  }
+
   int64_t size_index;
 
   /**
@@ -1228,6 +1330,13 @@ public:
 
   const char *_location = nullptr;
 
+  /**
+    Account charged for the blocks this buffer allocates from now on.
+    Blocks appended from elsewhere stay charged to their own account.
+
+  */
+  Ptr<IOBufferAccount> _account;
+
   MIOBuffer(void *b, int64_t bufsize, int64_t aWater_mark);
   // cppcheck-suppress noExplicitConstructor; allow implicit conversion
   MIOBuffer(int64_t default_size_index);
@@ -1286,7 +1395,7 @@ private:
   IOBufferReader *entry = nullptr;
 };
 
-extern MIOBuffer *new_MIOBuffer_internal(const char *loc, int64_t size_index);
+extern MIOBuffer *new_MIOBuffer_internal(const char *loc, int64_t size_index, IOBufferAccount *account = nullptr);
 
 class MIOBuffer_tracker
 {
@@ -1295,13 +1404,13 @@ class MIOBuffer_tracker
 public:
   explicit MIOBuffer_tracker(const char *_loc) : loc(_loc) {}
   MIOBuffer *
-  operator()(int64_t size_index)
+  operator()(int64_t size_index, IOBufferAccount *account = nullptr)
   {
-    return new_MIOBuffer_internal(loc, size_index);
+    return new_MIOBuffer_internal(loc, size_index, account);
   }
 };
 
-extern MIOBuffer *new_empty_MIOBuffer_internal(const char *loc, int64_t size_index);
+extern MIOBuffer *new_empty_MIOBuffer_internal(const char *loc, int64_t size_index, IOBufferAccount *account = nullptr);
 
 class Empty_MIOBuffer_tracker
 {
@@ -1310,9 +1419,9 @@ class Empty_MIOBuffer_tracker
 public:
   explicit Empty_MIOBuffer_tracker(const char *_loc) : loc(_loc) {}
   MIOBuffer *
-  operator()(int64_t size_index)
+  operator()(int64_t size_index, IOBufferAccount *account = nullptr)
   {
-    return new_empty_MIOBuffer_internal(loc, size_index);
+    return new_empty_MIOBuffer_internal(loc, size_index, account);
   }
 };
 
@@ -26,6 +26,7 @@
 #include "tscore/ink_platform.h"
 #include "tscore/Diags.h"
 #include "I_Thread.h"
+#include "I_LockProfile.h"
 
 #define MAX_LOCK_TIME HRTIME_MSECONDS(200)
 #define THREAD_MUTEX_THREAD_HOLDING (-1024 * 1024)
@@ -181,6 +182,11 @@ public:
 
   int nthread_holding;
 
+  /// The profile of the site that created the mutex, @c nullptr if it is not profiled.
+  LockProfile *profile;
+  /// When the mutex was taken, if this acquire is sampled for its hold time, 0 otherwise.
+  ink_hrtime profile_held;
+
 #ifdef DEBUG
   ink_hrtime hold_time;
   SourceLocation srcloc;
@@ -214,6 +220,8 @@ public:
   {
     thread_holding  = nullptr;
     nthread_holding = 0;
+    profile         = nullptr;
+    profile_held    = 0;
 #ifdef DEBUG
     hold_time = 0;
     handler   = nullptr;
@@ -262,6 +270,9 @@ Mutex_trylock(
   ink_assert(t == reinterpret_cast<EThread *>(this_thread()));
   if (m->thread_holding != t) {
     if (!ink_mutex_try_acquire(&m->the_mutex)) {
+      if (m->profile) {
+        m->profile->try_failed(t);
+      }
 #ifdef DEBUG
       lock_waiting(m->srcloc, m->handler);
 #ifdef LOCK_CONTENTION_PROFILING
@@ -274,6 +285,9 @@ Mutex_trylock(
       return false;
     }
     m->thread_holding = t;
+    if (m->profile) {
+      m->profile->acquired(m, t);
+    }
 #ifdef DEBUG
     m->srcloc    = location;
     m->handler   = ahandler;
@@ -318,7 +332,11 @@ Mutex_lock(
 {
   ink_assert(t != nullptr);
   if (m->thread_holding != t) {
-    ink_mutex_acquire(&m->the_mutex);
+    if (m->profile) {
+      m->profile->acquire(m, t);
+    } else {
+      ink_mutex_acquire(&m->the_mutex);
+    }
     m->thread_holding = t;
     ink_assert(m->thread_holding);
 #ifdef DEBUG
@@ -372,6 +390,9 @@ Mutex_unlock(ProxyMutex *m, EThread *t)
       m->srcloc  = SourceLocation(nullptr, nullptr, 0);
       m->handler = nullptr;
 #endif // DEBUG
+      if (m->profile_held) {
+        m->profile->released(m, t);
+      }
       ink_assert(m->thread_holding);
       m->thread_holding = nullptr;
       ink_mutex_release(&m->the_mutex);
@@ -604,14 +625,19 @@ ProxyMutex::free()
   ProxyMutex class. It provides you with faster allocation than
   that of the normal constructor.
 
+  @param file The file of the call, the site the mutex is profiled under.
+  @param line The line of the call.
+
   @return A pointer to a ProxyMutex object appropriate for the build
     environment.
 
 */
 inline ProxyMutex *
-new_ProxyMutex()
+new_ProxyMutex(const char *file = __builtin_FILE(), int line = __builtin_LINE())
 {
   ProxyMutex *m = mutexAllocator.alloc();
   m->init();
+  m->profile      = LockProfile::get(file, line);
+  m->profile_held = 0;
   return m;
 }
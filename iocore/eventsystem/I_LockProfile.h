@@ -0,0 +1,76 @@
+/** @file
+
+  The contention profile of the ProxyMutex, by the call site that created them.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+class EThread;
+class ProxyMutex;
+
+/**
+  With @c proxy.config.lock.profile, counts for each call site that creates mutexes, named after
+  its file without the suffix and its line, @c proxy.process.lock.<file>.<line>.<stat>:
+
+  - @c acquires, the times the mutexes were taken, by a lock or a try lock that got them.
+  - @c try_failures, the try locks that did not get them.
+  - @c waits, the locks that blocked, and @c wait_time the nanoseconds they blocked for.
+  - @c holds, one in @c proxy.config.lock.profile of the acquires, and @c hold_time the
+    nanoseconds the mutexes were held for then.
+
+  All the mutexes created at a site share its stats, such as those of the cache volumes, or of the
+  transactions. A site gets its stats as it first creates a mutex, with the profile enabled at
+  startup; the mutexes created before, in static constructors, are not profiled. The cost for the
+  others is a test of the mutex as it is taken and released.
+*/
+class LockProfile
+{
+public:
+  /// Read the configuration and allocate the stats, before the threads start.
+  static void init();
+
+  /// The profile of the mutexes created at @a file and @a line, @c nullptr if not profiled.
+  static LockProfile *get(const char *file, int line);
+
+  /// Block until the mutex @a m is taken, accounting for the wait.
+  void acquire(ProxyMutex *m, EThread *t);
+
+  /// The mutex @a m was taken by @a t, by a lock or a try lock.
+  void acquired(ProxyMutex *m, EThread *t);
+
+  /// A try lock of a mutex failed.
+  void try_failed(EThread *t);
+
+  /// The mutex @a m, which was sampled as it was taken, is about to be released.
+  void released(ProxyMutex *m, EThread *t);
+
+private:
+  enum { ACQUIRES, TRY_FAILURES, WAITS, WAIT_TIME, HOLDS, HOLD_TIME, STATS };
+
+  /// The most sites, those that first create a mutex are profiled.
+  static constexpr int MAX_SITES = 256;
+
+  static LockProfile *create(const char *site);
+
+  explicit LockProfile(int base) : _base(base) {}
+
+  int _base; ///< The id of the first stat
+};
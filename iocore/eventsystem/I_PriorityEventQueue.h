@@ -1,6 +1,6 @@
 /** @file
 
-  Queue of Events sorted by the "at_timeout" field
+  Queue of Events sorted by the "timeout_at" field
 
   @section license License
 
@@ -24,65 +24,52 @@
 #pragma once
 
 #include "tscore/ink_platform.h"
+#include "tscore/TimerWheel.h"
 #include "I_Event.h"
 
-// <5ms, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120
-#define N_PQ_LIST 10
-#define PQ_BUCKET_TIME(_i) (HRTIME_MSECONDS(5) << (_i))
+// Resolution of the event timer wheel.
+#define PQ_TICK HRTIME_MSECONDS(1)
 
 class EThread;
 
+/** Timed events of a thread, kept in a hierarchical timing wheel.
+
+    Insert and cancel are constant time. An event comes out of @c dequeue_ready once the tick
+    containing its @c timeout_at has been reached, that is at most @c PQ_TICK early.
+*/
 struct PriorityEventQueue {
-  Que(Event, link) after[N_PQ_LIST];
+  struct EventTimerTraits {
+    static ink_hrtime
+    at(Event const *e)
+    {
+      return e->timeout_at;
+    }
+    static int
+    tag(Event const *e)
+    {
+      return e->in_heap;
+    }
+    static void
+    set_tag(Event *e, int tag)
+    {
+      e->in_heap = tag;
+    }
+    // Hand cancelled events back at the next cascade so they are freed without waiting for the timeout.
+    static bool
+    expire_early(Event const *e)
+    {
+      return e->cancelled;
+    }
+  };
+
+  TimerWheel<Event, Event::Link_link, EventTimerTraits> wheel;
   ink_hrtime last_check_time;
-  uint32_t last_check_buckets;
 
   void
-  enqueue(Event *e, ink_hrtime now)
+  enqueue(Event *e, ink_hrtime /* now ATS_UNUSED */)
   {
-    ink_hrtime t = e->timeout_at - now;
-    int i        = 0;
-    // equivalent but faster
-    if (t <= PQ_BUCKET_TIME(3)) {
-      if (t <= PQ_BUCKET_TIME(1)) {
-        if (t <= PQ_BUCKET_TIME(0)) {
-          i = 0;
-        } else {
-          i = 1;
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(2)) {
-          i = 2;
-        } else {
-          i = 3;
-        }
-      }
-    } else {
-      if (t <= PQ_BUCKET_TIME(7)) {
-        if (t <= PQ_BUCKET_TIME(5)) {
-          if (t <= PQ_BUCKET_TIME(4)) {
-            i = 4;
-          } else {
-            i = 5;
-          }
-        } else {
-          if (t <= PQ_BUCKET_TIME(6)) {
-            i = 6;
-          } else {
-            i = 7;
-          }
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(8)) {
-          i = 8;
-        } else {
-          i = 9;
-        }
-      }
-    }
     e->in_the_priority_queue = 1;
-    e->in_heap               = i;
-    after[i].enqueue(e);
+    wheel.insert(e);
   }
 
   void
@@ -90,14 +77,13 @@ struct PriorityEventQueue {
   {
     ink_assert(e->in_the_priority_queue);
     e->in_the_priority_queue = 0;
-    after[e->in_heap].remove(e);
+    wheel.remove(e);
   }
 
   Event *
-  dequeue_ready(ink_hrtime t)
+  dequeue_ready(ink_hrtime /* t ATS_UNUSED */)
   {
-    (void)t;
-    Event *e = after[0].dequeue();
+    Event *e = wheel.pop_ready();
     if (e) {
       ink_assert(e->in_the_priority_queue);
       e->in_the_priority_queue = 0;
@@ -110,12 +96,7 @@ struct PriorityEventQueue {
   ink_hrtime
   earliest_timeout()
   {
-    for (int i = 0; i < N_PQ_LIST; i++) {
-      if (after[i].head) {
-        return last_check_time + (PQ_BUCKET_TIME(i) / 2);
-      }
-    }
-    return last_check_time + HRTIME_FOREVER;
+    return wheel.next_expiry(last_check_time, last_check_time + HRTIME_FOREVER);
   }
 
   PriorityEventQueue();
@@ -34,22 +34,43 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
 struct ProtectedQueue {
   void enqueue(Event *e);
+  /** Enqueue the events from @a head to @a tail, linked newest first, for the same thread.
+      This is one atomic push and at most one signal for the whole chain.
+  */
+  void enqueue_chain(Event *head, Event *tail);
   void signal();
   int try_signal();             // Use non blocking lock and if acquired, signal
   void enqueue_local(Event *e); // Safe when called from the same thread
   void remove(Event *e);
   Event *dequeue_local();
-  void dequeue_external();       // Dequeue any external events.
+  int dequeue_external();        // Dequeue any external events, returns the number moved to the local queue.
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
 
+  /** Announce that the consumer is about to block.
+      Returns @c false if external events arrived in the meantime and the consumer should not block.
+      Must be followed by @c end_wait once the consumer is running again.
+  */
+  bool begin_wait();
+  void end_wait();
+  /** Check whether an enqueue must wake the consumer.
+      At most one caller per @c begin_wait gets @c true, every other enqueue in the same burst is
+      picked up by the consumer without a signal.
+  */
+  bool claim_wakeup();
+
   InkAtomicList al;
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
 
+  std::atomic<bool> waiting{false}; ///< Consumer is blocked, or about to block, in the tail handler.
+  std::atomic<int> wakeups{0};      ///< Signals sent to the consumer, collected by the owning thread.
+
   ProtectedQueue();
 };
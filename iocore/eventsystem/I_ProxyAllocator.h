@@ -111,6 +111,8 @@ thread_freeup(ClassAllocator<C> &a, ProxyAllocator &l)
 
 void *thread_alloc(Allocator &a, ProxyAllocator &l);
 void thread_freeup(Allocator &a, ProxyAllocator &l);
+/// Return items to @a a in one batch until @a l holds @a low_watermark.
+void thread_freeup(Allocator &a, ProxyAllocator &l, int low_watermark);
 
 #define THREAD_ALLOC(_a, _t) thread_alloc(::_a, _t->_a)
 #define THREAD_ALLOC_INIT(_a, _t) thread_alloc_init(::_a, _t->_a)
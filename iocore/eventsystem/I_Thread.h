@@ -71,6 +71,12 @@
 class ProxyMutex;
 
 constexpr int MAX_THREAD_NAME_LENGTH = 16;
+/// Number of frame sizes, from 128 bytes doubling, for which coroutine frames are kept in freelists.
+constexpr int COROUTINE_FRAME_SIZE_CLASSES = 6;
+/// Number of IOBuffer data sizes, DEFAULT_BUFFER_SIZES in I_IOBuffer.h.
+constexpr int IOBUFFER_SIZE_CLASSES = 15;
+/// Number of header string heap sizes, from HdrStrHeap::DEFAULT_SIZE doubling, kept in freelists.
+constexpr int HDR_STR_HEAP_SIZE_CLASSES = 4;
 
 /// The signature of a function to be called by a thread.
 using ThreadFunction = std::function<void()>;
@@ -127,8 +133,9 @@ public:
   ProxyAllocator quicSendStreamAllocator;
   ProxyAllocator quicReceiveStreamAllocator;
   ProxyAllocator httpServerSessionAllocator;
+  ProxyAllocator fetchSMAllocator;
   ProxyAllocator hdrHeapAllocator;
-  ProxyAllocator strHeapAllocator;
+  ProxyAllocator strHeapAllocator[HDR_STR_HEAP_SIZE_CLASSES];
   ProxyAllocator cacheVConnectionAllocator;
   ProxyAllocator openDirEntryAllocator;
   ProxyAllocator ramCacheCLFUSEntryAllocator;
@@ -137,6 +144,8 @@ public:
   ProxyAllocator ioDataAllocator;
   ProxyAllocator ioAllocator;
   ProxyAllocator ioBlockAllocator;
+  ProxyAllocator coroutineFrameAllocator[COROUTINE_FRAME_SIZE_CLASSES];
+  ProxyAllocator ioBufAllocator[IOBUFFER_SIZE_CLASSES];
 
   /** Start the underlying thread.
 
@@ -154,13 +163,20 @@ public:
       at least every 10ms and generally more frequently.
       @note The cached copy shared among threads which means the cached copy is updated
       for all threads if any thread updates it.
+
+      On an event thread, the cached time is never older than the start of the current pass of the
+      event loop of that thread, which fetches the time as it starts: it is behind the actual time
+      by at most the time the handlers before in the pass took. Use it for timestamps, such as the
+      milestones and the log entries, and @c get_hrtime_updated to measure what takes less than a
+      pass of the loop.
   */
   static ink_hrtime get_hrtime();
 
   /** Get the operating system high resolution time.
 
       Get the current time at high resolution from the operating system.  This is more expensive
-      than @c get_hrtime and should be used only where very precise timing is required.
+      than @c get_hrtime and should be used only where very precise timing is required. With
+      proxy.config.system.tsc_clock, the time is read from the time stamp counter of the CPU.
 
       @note This also updates the cached time.
   */
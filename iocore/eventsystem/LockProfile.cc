@@ -0,0 +1,152 @@
+/** @file
+
+  The contention profile of the ProxyMutex, by the call site that created them.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "P_EventSystem.h"
+#include "I_LockProfile.h"
+
+namespace
+{
+RecRawStatBlock *lock_rsb = nullptr;
+
+// One in this many acquires is sampled for its hold time.
+int lock_sample = 0;
+
+// The profiles of the sites, created under the lock, and the first free stat.
+std::mutex site_lock;
+std::map<std::string, LockProfile *> site_profiles;
+int site_next_stat = 0;
+
+// A site with no stats, out of room.
+LockProfile *const UNACCOUNTED = reinterpret_cast<LockProfile *>(uintptr_t(1));
+
+// The profiles of the sites seen by this thread, and the acquires left until the next sample.
+thread_local std::map<std::pair<const char *, int>, LockProfile *> thread_profiles;
+thread_local int thread_sample_countdown = 0;
+
+// P_CacheVol.h and 318 as P_CacheVol.318.
+std::string
+site_name(const char *file, int line)
+{
+  std::string_view name = file;
+  if (auto slash = name.rfind('/'); slash != name.npos) {
+    name.remove_prefix(slash + 1);
+  }
+  if (auto dot = name.find('.'); dot != name.npos && dot > 0) {
+    name = name.substr(0, dot);
+  }
+  return std::string(name) + '.' + std::to_string(line);
+}
+} // namespace
+
+void
+LockProfile::init()
+{
+  REC_ReadConfigInteger(lock_sample, "proxy.config.lock.profile");
+  if (lock_sample > 0) {
+    lock_rsb = RecAllocateRawStatBlock(MAX_SITES * STATS);
+    if (!lock_rsb) {
+      Warning("cannot allocate the lock profile stats");
+    }
+  }
+}
+
+LockProfile *
+LockProfile::create(const char *site)
+{
+  static const char *const stat_names[STATS] = {"acquires", "try_failures", "waits", "wait_time", "holds", "hold_time"};
+
+  if (site_next_stat + STATS > MAX_SITES * STATS) {
+    Warning("no room left for the lock profile of %s", site);
+    return UNACCOUNTED;
+  }
+  int base = site_next_stat;
+  site_next_stat += STATS;
+  for (int i = 0; i < STATS; i++) {
+    char stat[256];
+    snprintf(stat, sizeof(stat), "proxy.process.lock.%s.%s", site, stat_names[i]);
+    RecRegisterRawStat(lock_rsb, RECT_PROCESS, stat, RECD_COUNTER, RECP_NON_PERSISTENT, base + i,
+                       i == WAIT_TIME || i == HOLD_TIME ? RecRawStatSyncSum : RecRawStatSyncCount);
+  }
+  return new LockProfile(base);
+}
+
+LockProfile *
+LockProfile::get(const char *file, int line)
+{
+  if (!lock_rsb || !file) {
+    return nullptr;
+  }
+  LockProfile *&profile = thread_profiles[{file, line}];
+  if (!profile) {
+    std::string site = site_name(file, line);
+    std::lock_guard<std::mutex> guard(site_lock);
+    LockProfile *&shared = site_profiles[site];
+    if (!shared) {
+      shared = create(site.c_str());
+    }
+    profile = shared;
+  }
+  return profile == UNACCOUNTED ? nullptr : profile;
+}
+
+void
+LockProfile::acquire(ProxyMutex *m, EThread *t)
+{
+  // Only the locks that block read the clock.
+  if (!ink_mutex_try_acquire(&m->the_mutex)) {
+    ink_hrtime start = Thread::get_hrtime_updated();
+    ink_mutex_acquire(&m->the_mutex);
+    RecIncrRawStat(lock_rsb, t, _base + WAITS, 1);
+    RecIncrRawStat(lock_rsb, t, _base + WAIT_TIME, Thread::get_hrtime_updated() - start);
+  }
+  acquired(m, t);
+}
+
+void
+LockProfile::acquired(ProxyMutex *m, EThread *t)
+{
+  RecIncrRawStat(lock_rsb, t, _base + ACQUIRES, 1);
+  if (--thread_sample_countdown <= 0) {
+    thread_sample_countdown = lock_sample;
+    m->profile_held         = Thread::get_hrtime_updated();
+  }
+}
+
+void
+LockProfile::try_failed(EThread *t)
+{
+  RecIncrRawStat(lock_rsb, t, _base + TRY_FAILURES, 1);
+}
+
+void
+LockProfile::released(ProxyMutex *m, EThread *t)
+{
+  RecIncrRawStat(lock_rsb, t, _base + HOLDS, 1);
+  RecIncrRawStat(lock_rsb, t, _base + HOLD_TIME, Thread::get_hrtime_updated() - m->profile_held);
+  m->profile_held = 0;
+}
@@ -223,6 +223,28 @@ new_IOBufferData_internal(const char *loc, int64_t size_index, AllocType type)
   return d;
 }
 
+// Buffer memory of the fast allocated sizes goes through a cache of the current thread.
+TS_INLINE void *
+iobuffer_thread_alloc(int64_t size_index)
+{
+  return thread_alloc(ioBufAllocator[size_index], this_thread()->ioBufAllocator[size_index]);
+}
+
+TS_INLINE void
+iobuffer_thread_free(int64_t size_index, void *p)
+{
+  if (cmd_disable_pfreelist) {
+    ioBufAllocator[size_index].free_void(p);
+    return;
+  }
+  ProxyAllocator &l        = this_thread()->ioBufAllocator[size_index];
+  *static_cast<void **>(p) = l.freelist;
+  l.freelist               = p;
+  if (++l.allocated > ioBufThreadCacheHigh[size_index]) {
+    thread_freeup(ioBufAllocator[size_index], l, ioBufThreadCacheLow[size_index]);
+  }
+}
+
 // IRIX has a compiler bug which prevents this function
 // from being compiled correctly at -O3
 // so it is DUPLICATED in IOBuffer.cc
@@ -239,7 +261,7 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   switch (type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)iobuffer_thread_alloc(size_index);
       // coverity[dead_error_condition]
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_memalign(ats_pagesize(), index_to_buffer_size(size_index));
@@ -248,7 +270,7 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)iobuffer_thread_alloc(size_index);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_malloc(BUFFER_SIZE_FOR_XMALLOC(size_index));
     }
@@ -262,10 +284,14 @@ TS_INLINE void
 IOBufferData::dealloc()
 {
   iobuffer_mem_dec(_location, _size_index);
+  if (_account) {
+    _account->release(block_size());
+    _account = nullptr;
+  }
   switch (_mem_type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      iobuffer_thread_free(_size_index, _data);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ::free((void *)_data);
     }
@@ -273,7 +299,7 @@ IOBufferData::dealloc()
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      iobuffer_thread_free(_size_index, _data);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ats_free(_data);
     }
@@ -284,6 +310,16 @@ IOBufferData::dealloc()
   _mem_type   = NO_ALLOC;
 }
 
+TS_INLINE void
+IOBufferData::set_account(IOBufferAccount *account)
+{
+  ink_assert(!_account);
+  if (account && BUFFER_SIZE_ALLOCATED(_size_index)) {
+    _account = account;
+    account->charge(block_size());
+  }
+}
+
 TS_INLINE void
 IOBufferData::free()
 {
@@ -665,10 +701,11 @@ MIOBuffer::~MIOBuffer()
 }
 
 TS_INLINE MIOBuffer *
-new_MIOBuffer_internal(const char *location, int64_t size_index)
+new_MIOBuffer_internal(const char *location, int64_t size_index, IOBufferAccount *account)
 {
   MIOBuffer *b = THREAD_ALLOC(ioAllocator, this_thread());
   b->_location = location;
+  b->_account  = account;
   b->alloc(size_index);
   b->water_mark = 0;
   return b;
@@ -677,24 +714,27 @@ new_MIOBuffer_internal(const char *location, int64_t size_index)
 TS_INLINE void
 free_MIOBuffer(MIOBuffer *mio)
 {
-  mio->_writer = nullptr;
+  mio->_writer  = nullptr;
+  mio->_account = nullptr;
   mio->dealloc_all_readers();
   THREAD_FREE(mio, ioAllocator, this_thread());
 }
 
 TS_INLINE MIOBuffer *
-new_empty_MIOBuffer_internal(const char *location, int64_t size_index)
+new_empty_MIOBuffer_internal(const char *location, int64_t size_index, IOBufferAccount *account)
 {
   MIOBuffer *b  = THREAD_ALLOC(ioAllocator, this_thread());
   b->size_index = size_index;
   b->water_mark = 0;
   b->_location  = location;
+  b->_account   = account;
   return b;
 }
 
 TS_INLINE void
 free_empty_MIOBuffer(MIOBuffer *mio)
 {
+  mio->_account = nullptr;
   THREAD_FREE(mio, ioAllocator, this_thread());
 }
 
@@ -837,6 +877,7 @@ MIOBuffer::append_block(int64_t asize_index)
   ink_assert(BUFFER_SIZE_ALLOCATED(asize_index));
   IOBufferBlock *b = new_IOBufferBlock_internal(_location);
   b->alloc(asize_index);
+  b->data->set_account(_account.get());
   append_block_internal(b);
   return;
 }
@@ -980,6 +1021,7 @@ MIOBuffer::alloc(int64_t i)
 {
   _writer = new_IOBufferBlock_internal(_location);
   _writer->alloc(i);
+  _writer->data->set_account(_account.get());
   size_index = i;
   init_readers();
 }
@@ -81,6 +81,35 @@ ProtectedQueue::remove(Event *e)
   e->in_the_prot_queue = 0;
 }
 
+TS_INLINE bool
+ProtectedQueue::begin_wait()
+{
+  waiting.store(true, std::memory_order_seq_cst);
+  // Pairs with the push in enqueue, either the producer sees the flag or we see its event.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!INK_ATOMICLIST_EMPTY(al)) {
+    waiting.store(false, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+TS_INLINE void
+ProtectedQueue::end_wait()
+{
+  waiting.store(false, std::memory_order_relaxed);
+}
+
+TS_INLINE bool
+ProtectedQueue::claim_wakeup()
+{
+  if (waiting.load() && waiting.exchange(false)) {
+    wakeups.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
 TS_INLINE Event *
 ProtectedQueue::dequeue_local()
 {
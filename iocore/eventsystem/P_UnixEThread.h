@@ -45,6 +45,57 @@ EThread::schedule_imm(Continuation *cont, int callback_event, void *cookie)
   return schedule(e->init(cont, 0, 0));
 }
 
+TS_INLINE Event *
+EventBatch::add(Continuation *cont, int callback_event, void *cookie)
+{
+  Event *e          = ::eventAllocator.alloc();
+  e->callback_event = callback_event;
+  e->cookie         = cookie;
+  e->init(cont, 0, 0);
+  e->link.next = _head;
+  _head        = e;
+  if (_tail == nullptr) {
+    _tail = e;
+  }
+  return e;
+}
+
+TS_INLINE void
+EThread::schedule_batch(EventBatch &batch)
+{
+  Event *head = batch._head;
+  Event *tail = batch._tail;
+  batch._head = batch._tail = nullptr;
+  if (head == nullptr) {
+    return;
+  }
+
+  if (tt != REGULAR || this == this_ethread()) {
+    // Nothing to save, schedule them one at a time, oldest first.
+    SLL<Event, Event::Link_link> q;
+    while (head) {
+      Event *next = head->link.next;
+      q.push(head);
+      head = next;
+    }
+    while ((head = q.pop())) {
+      schedule(head);
+    }
+    return;
+  }
+
+  for (Event *e = head; e; e = e->link.next) {
+    e->ethread = this;
+    if (e->continuation->mutex) {
+      e->mutex = e->continuation->mutex;
+    } else {
+      e->mutex = e->continuation->mutex = this->mutex;
+    }
+    e->continuation->control_flags.set_flags(get_cont_flags().get_flags());
+  }
+  EventQueueExternal.enqueue_chain(head, tail);
+}
+
 TS_INLINE Event *
 EThread::schedule_at(Continuation *cont, ink_hrtime t, int callback_event, void *cookie)
 {
@@ -99,7 +99,11 @@ EventProcessor::schedule(Event *e, EventType etype)
 
   EThread *affinity_thread = e->continuation->getThreadAffinity();
   EThread *curr_thread     = this_ethread();
-  if (affinity_thread != nullptr && affinity_thread->is_event_type(etype)) {
+  bool stealable           = thread_work_stealing && e->continuation->thread_agnostic && !e->timeout_at && !e->period;
+  if (stealable) {
+    // Not pinned, any thread of the group may end up running it.
+    e->ethread = (curr_thread != nullptr && curr_thread->is_event_type(etype)) ? curr_thread : assign_thread(etype);
+  } else if (affinity_thread != nullptr && affinity_thread->is_event_type(etype)) {
     e->ethread = affinity_thread;
   } else {
     // Is the current thread eligible?
@@ -117,7 +121,9 @@ EventProcessor::schedule(Event *e, EventType etype)
     e->mutex = e->continuation->mutex;
   }
 
-  if (curr_thread != nullptr && e->ethread == curr_thread) {
+  if (stealable) {
+    e->ethread->enqueue_stealable(e);
+  } else if (curr_thread != nullptr && e->ethread == curr_thread) {
     e->ethread->EventQueueExternal.enqueue_local(e);
   } else {
     e->ethread->EventQueueExternal.enqueue(e);
@@ -55,15 +55,40 @@ ProtectedQueue::enqueue(Event *e)
     EThread *inserting_thread = this_ethread();
     // queue e->ethread in the list of threads to be signalled
     // inserting_thread == 0 means it is not a regular EThread
-    if (inserting_thread != e_ethread) {
+    // A consumer that is not blocked drains the list before it next waits, so only wake it if it
+    // announced it is going to sleep. This keeps a burst to a single signal.
+    if (inserting_thread != e_ethread && claim_wakeup()) {
       e_ethread->tail_cb->signalActivity();
     }
   }
 }
 
 void
+ProtectedQueue::enqueue_chain(Event *head, Event *tail)
+{
+  EThread *e_ethread = tail->ethread;
+  for (Event *e = head;; e = e->link.next) {
+    ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
+    ink_assert(e->ethread == e_ethread);
+    e->in_the_prot_queue = 1;
+    if (e == tail) {
+      break;
+    }
+  }
+  bool was_empty = (ink_atomiclist_push_chain(&al, head, tail) == nullptr);
+
+  if (was_empty) {
+    EThread *inserting_thread = this_ethread();
+    if (inserting_thread != e_ethread && claim_wakeup()) {
+      e_ethread->tail_cb->signalActivity();
+    }
+  }
+}
+
+int
 ProtectedQueue::dequeue_external()
 {
+  int n    = 0;
   Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
   // invert the list, to preserve order
   SLL<Event, Event::Link_link> l, t;
@@ -73,6 +98,7 @@ ProtectedQueue::dequeue_external()
   }
   // insert into localQueue
   while ((e = l.pop())) {
+    ++n;
     if (!e->cancelled) {
       localQueue.enqueue(e);
     } else {
@@ -80,6 +106,7 @@ ProtectedQueue::dequeue_external()
       eventAllocator.free(e);
     }
   }
+  return n;
 }
 
 void
@@ -92,7 +119,9 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
   if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
-    timespec ts = ink_hrtime_to_timespec(timeout);
+    timespec ts      = ink_hrtime_to_timespec(timeout);
+    ink_hrtime start = Thread::get_hrtime_updated();
     ink_cond_timedwait(&might_have_data, &lock, &ts);
+    this_ethread()->idle_time += Thread::get_hrtime_updated() - start;
   }
 }
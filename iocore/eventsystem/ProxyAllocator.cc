@@ -40,11 +40,17 @@ thread_alloc(Allocator &a, ProxyAllocator &l)
 
 void
 thread_freeup(Allocator &a, ProxyAllocator &l)
+{
+  thread_freeup(a, l, thread_freelist_low_watermark);
+}
+
+void
+thread_freeup(Allocator &a, ProxyAllocator &l, int low_watermark)
 {
   void *head   = l.freelist;
   void *tail   = l.freelist;
   size_t count = 0;
-  while (l.freelist && l.allocated > thread_freelist_low_watermark) {
+  while (l.freelist && l.allocated > low_watermark) {
     tail       = l.freelist;
     l.freelist = *static_cast<void **>(l.freelist);
     --(l.allocated);
@@ -57,5 +63,5 @@ thread_freeup(Allocator &a, ProxyAllocator &l)
     a.free_void_bulk(head, tail, count);
   }
 
-  ink_assert(l.allocated >= thread_freelist_low_watermark);
+  ink_assert(l.allocated >= low_watermark);
 }
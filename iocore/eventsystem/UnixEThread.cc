@@ -45,11 +45,19 @@ struct AIOCallback;
 char const *const EThread::STAT_NAME[] = {"proxy.process.eventloop.count",      "proxy.process.eventloop.events",
                                           "proxy.process.eventloop.events.min", "proxy.process.eventloop.events.max",
                                           "proxy.process.eventloop.wait",       "proxy.process.eventloop.time.min",
-                                          "proxy.process.eventloop.time.max"};
+                                          "proxy.process.eventloop.time.max",   "proxy.process.eventloop.stolen",
+                                          "proxy.process.eventloop.external",   "proxy.process.eventloop.wakeups"};
 
 int const EThread::SAMPLE_COUNT[N_EVENT_TIMESCALES] = {10, 100, 1000};
 
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
+int thread_work_stealing          = 0;
+int thread_handler_timing         = 0;
+int thread_slow_handler_mseconds  = 0;
+
+// Upper bound on the events taken from one victim per loop, so a stealing thread does not drain a
+// busy thread and leave it idle in turn.
+static constexpr int STEAL_BATCH = 8;
 
 // To define a class inherits from Thread:
 //   1) Define an independent ink_thread_key
@@ -71,7 +79,14 @@ static bool ethread_initialized ATS_UNUSED = ([]() -> bool {
   ink_thread_key_create(&ethread_key, nullptr);
   return true;
 })();
+
+void
+init_stealable(InkAtomicList *l)
+{
+  Event e;
+  ink_atomiclist_init(l, "EThread::stealable", (char *)&e.link.next - (char *)&e);
 }
+} // namespace
 
 void
 EThread::set_specific()
@@ -83,11 +98,13 @@ EThread::set_specific()
 EThread::EThread()
 {
   memset(thread_private, 0, PER_THREAD_DATA);
+  init_stealable(&stealable);
 }
 
 EThread::EThread(ThreadType att, int anid) : id(anid), tt(att)
 {
   memset(thread_private, 0, PER_THREAD_DATA);
+  init_stealable(&stealable);
 #if HAVE_EVENTFD
   evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
   if (evfd < 0) {
@@ -117,6 +134,7 @@ EThread::EThread(ThreadType att, Event *e) : tt(att), start_event(e)
 {
   ink_assert(att == DEDICATED);
   memset(thread_private, 0, PER_THREAD_DATA);
+  init_stealable(&stealable);
 }
 
 // Provide a destructor so that SDK functions which create and destroy
@@ -161,7 +179,26 @@ EThread::process_event(Event *e, int calling_code)
     // Restore the client IP debugging flags
     set_cont_flags(e->continuation->control_flags);
 
-    e->continuation->handleEvent(calling_code, e);
+    if (thread_handler_timing) {
+      // The continuation may be gone after the call, name it up front.
+#ifdef DEBUG
+      char const *name = c_temp->handler_name ? c_temp->handler_name : typeid(*c_temp).name();
+#else
+      char const *name = typeid(*c_temp).name();
+#endif
+      ink_hrtime start = Thread::get_hrtime_updated();
+      e->continuation->handleEvent(calling_code, e);
+      ink_hrtime spent = Thread::get_hrtime_updated() - start;
+      if (spent > 0) {
+        latency.handler.record(spent / HRTIME_USECOND);
+        if (thread_slow_handler_mseconds > 0 && spent >= HRTIME_MSECONDS(thread_slow_handler_mseconds)) {
+          Warning("event thread %d: handler %s took %" PRId64 " ms for event %d", id, name, ink_hrtime_to_msec(spent),
+                  calling_code);
+        }
+      }
+    } else {
+      e->continuation->handleEvent(calling_code, e);
+    }
     ink_assert(!e->in_the_priority_queue);
     ink_assert(c_temp == e->continuation);
     MUTEX_RELEASE(lock);
@@ -180,13 +217,87 @@ EThread::process_event(Event *e, int calling_code)
   }
 }
 
+void
+EThread::enqueue_stealable(Event *e)
+{
+  ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
+  ink_assert(e->ethread == this);
+  e->in_the_prot_queue = 1;
+  ++stealable_count;
+  if (ink_atomiclist_push(&stealable, e) == nullptr && this_ethread() != this && EventQueueExternal.claim_wakeup()) {
+    tail_cb->signalActivity();
+  }
+}
+
+int
+EThread::steal_events()
+{
+  int stolen = 0;
+
+  for (int type = 0; type < eventProcessor.n_thread_groups && stolen == 0; ++type) {
+    if (!is_event_type(type)) {
+      continue;
+    }
+    EventProcessor::ThreadGroupDescriptor *tg = &eventProcessor.thread_group[type];
+    int n                                     = tg->_count;
+    if (n < 2) {
+      continue;
+    }
+    // Start at a random sibling so idle threads do not all pile onto the same victim.
+    int start = generator.random() % n;
+    for (int i = 0; i < n && stolen == 0; ++i) {
+      EThread *victim = tg->_thread[(start + i) % n];
+      // Only from a thread of exactly the same types, so an event never runs on a thread of a type it was not scheduled for.
+      if (victim == this || victim->event_types != event_types || victim->stealable_count.load(std::memory_order_relaxed) <= 0) {
+        continue;
+      }
+      Event *e;
+      while (stolen < STEAL_BATCH && (e = static_cast<Event *>(ink_atomiclist_pop(&victim->stealable))) != nullptr) {
+        --victim->stealable_count;
+        e->in_the_prot_queue = 0;
+        e->ethread           = this;
+        ++stolen;
+        if (e->cancelled) {
+          free_event(e);
+        } else {
+          process_event(e, e->callback_event);
+        }
+      }
+    }
+  }
+  if (stolen) {
+    Debug("iocore_thread_steal", "[thread %d] stole %d events", id, stolen);
+  }
+  return stolen;
+}
+
 void
 EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count)
 {
   Event *e;
 
+  // Run what has not been stolen from this thread, oldest first. These are immediate events, or timed
+  // ones that were already due.
+  if (stealable_count.load(std::memory_order_relaxed) > 0) {
+    SLL<Event, Event::Link_link> l, t;
+    t.head = static_cast<Event *>(ink_atomiclist_popall(&stealable));
+    while ((e = t.pop())) {
+      --stealable_count;
+      e->in_the_prot_queue = 0;
+      l.push(e);
+    }
+    while ((e = l.pop())) {
+      ++(*ev_count);
+      if (e->cancelled) {
+        free_event(e);
+      } else {
+        process_event(e, e->callback_event);
+      }
+    }
+  }
+
   // Move events from the external thread safe queues to the local queue.
-  EventQueueExternal.dequeue_external();
+  current_metric->_external += EventQueueExternal.dequeue_external();
 
   // execute all the available external events that have
   // already been dequeued
@@ -268,8 +379,13 @@ EThread::execute_regular()
         ink_assert(e->timeout_at > 0);
         if (e->cancelled) {
           free_event(e);
+        } else if (thread_work_stealing && e->continuation->thread_agnostic) {
+          // Due, but an idle sibling may run it while this thread works through the rest.
+          latency.lateness.record(std::max<ink_hrtime>(cur_time - e->timeout_at, 0) / HRTIME_USECOND);
+          enqueue_stealable(e);
         } else {
           done_one = true;
+          latency.lateness.record(std::max<ink_hrtime>(cur_time - e->timeout_at, 0) / HRTIME_USECOND);
           process_event(e, e->callback_event);
         }
       }
@@ -300,7 +416,32 @@ EThread::execute_regular()
       sleep_time = 0;
     }
 
-    tail_cb->waitForActivity(sleep_time);
+    // Nothing to do here, help out a sibling that has a backlog before going to sleep.
+    if (thread_work_stealing && ev_count == 0) {
+      int stolen = steal_events();
+      if (stolen > 0) {
+        ev_count += stolen;
+        current_metric->_stolen += stolen;
+        sleep_time = 0;
+      }
+    }
+    if (stealable_count.load(std::memory_order_relaxed) > 0) {
+      sleep_time = 0;
+    }
+
+    // Producers only signal a thread that is going to block, check the queues once more after saying so.
+    if (sleep_time > 0 && EventQueueExternal.begin_wait()) {
+      if (stealable_count.load() > 0) {
+        sleep_time = 0;
+      }
+      tail_cb->waitForActivity(sleep_time);
+      EventQueueExternal.end_wait();
+    } else {
+      tail_cb->waitForActivity(0);
+    }
+    if (EventQueueExternal.wakeups.load(std::memory_order_relaxed) > 0) {
+      current_metric->_wakeups += EventQueueExternal.wakeups.exchange(0, std::memory_order_relaxed);
+    }
 
     // loop cleanup
     loop_finish_time = Thread::get_hrtime_updated();
@@ -310,6 +451,7 @@ EThread::execute_regular()
     // tried using the monotonic clock to get around this but it was *very* stuttery (up to hundreds
     // of milliseconds), far too much to be actually used.
     if (delta > 0) {
+      latency.loop.record(delta / HRTIME_USECOND);
       if (delta > current_metric->_loop_time._max) {
         current_metric->_loop_time._max = delta;
       }
@@ -385,6 +527,9 @@ EThread::EventMetrics::operator+=(EventMetrics const &that)
   this->_loop_time._max = std::max(this->_loop_time._max, that._loop_time._max);
   this->_count += that._count;
   this->_wait += that._wait;
+  this->_stolen += that._stolen;
+  this->_external += that._external;
+  this->_wakeups += that._wakeups;
   return *this;
 }
 
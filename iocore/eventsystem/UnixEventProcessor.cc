@@ -29,6 +29,8 @@
 #endif
 #include <hwloc.h>
 #endif
+#include <algorithm>
+#include <vector>
 #include "tscore/ink_defs.h"
 #include "tscore/hugepages.h"
 
@@ -50,6 +52,10 @@ public:
   /// @internal This is the external entry point and is different depending on
   /// whether HWLOC is enabled.
   void *alloc_stack(EThread *t, size_t stacksize);
+  /// NUMA node of processor @a cpu, or -1 if threads are not partitioned by node.
+  int node_of_cpu(int cpu) const;
+  /// OS processor thread @a t is bound to, or -1 if it is not bound to a single one.
+  int cpu_of_thread(EThread *t) const;
 
 protected:
   /// Allocate a hugepage stack.
@@ -65,6 +71,7 @@ private:
   hwloc_obj_type_t obj_type = HWLOC_OBJ_MACHINE;
   int obj_count             = 0;
   char const *obj_name      = nullptr;
+  std::vector<int> cpu_node; ///< NUMA node by OS processor index, empty unless allocators are partitioned by node.
 #endif
 };
 
@@ -112,12 +119,140 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
     rsb->global[id + EThread::STAT_LOOP_EVENTS_MAX]->sum   = m->_events._max;
     rsb->global[id + EThread::STAT_LOOP_EVENTS_MAX]->count = 1;
     RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_EVENTS_MAX);
+
+    rsb->global[id + EThread::STAT_LOOP_STOLEN]->sum   = m->_stolen;
+    rsb->global[id + EThread::STAT_LOOP_STOLEN]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_STOLEN);
+    rsb->global[id + EThread::STAT_LOOP_EXTERNAL]->sum   = m->_external;
+    rsb->global[id + EThread::STAT_LOOP_EXTERNAL]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_EXTERNAL);
+    rsb->global[id + EThread::STAT_LOOP_WAKEUPS]->sum   = m->_wakeups;
+    rsb->global[id + EThread::STAT_LOOP_WAKEUPS]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_WAKEUPS);
+  }
+
+  ink_mutex_release(&(rsb->mutex));
+  return REC_ERR_OKAY;
+}
+
+/// Latency histograms of a thread, and the values published for each.
+struct LatencyStat {
+  char const *name;
+  EThread::LatencyHistogram EThread::LatencyHistograms::*histogram;
+};
+constexpr LatencyStat LATENCY_STATS[] = {
+  {"loop", &EThread::LatencyHistograms::loop},
+  {"lateness", &EThread::LatencyHistograms::lateness},
+  {"handler", &EThread::LatencyHistograms::handler},
+};
+constexpr int N_LATENCY_STATS = sizeof(LATENCY_STATS) / sizeof(*LATENCY_STATS);
+
+struct LatencyQuantile {
+  char const *name;
+  double q;
+};
+// Process wide values, the last entry is the maximum.
+constexpr LatencyQuantile LATENCY_QUANTILES[] = {{"p50", 0.5}, {"p99", 0.99}, {"p999", 0.999}, {"max", 1.0}};
+constexpr int N_LATENCY_QUANTILES             = sizeof(LATENCY_QUANTILES) / sizeof(*LATENCY_QUANTILES);
+// Per thread values, enough to see which thread has the tail.
+constexpr LatencyQuantile LATENCY_THREAD_QUANTILES[] = {{"p999", 0.999}, {"max", 1.0}};
+constexpr int N_LATENCY_THREAD_QUANTILES             = sizeof(LATENCY_THREAD_QUANTILES) / sizeof(*LATENCY_THREAD_QUANTILES);
+// Per thread stats, the latency values and then the percentage of the time the thread was busy.
+constexpr int N_THREAD_STATS = N_LATENCY_STATS * N_LATENCY_THREAD_QUANTILES + 1;
+
+/// Thread histograms and idle times as of the previous sync, the published values cover the change since then.
+EThread::LatencyHistograms *latency_snapshot = nullptr;
+ink_hrtime *idle_snapshot                    = nullptr;
+ink_hrtime latency_snapshot_at               = 0;
+int latency_thread_count                     = 0;
+
+int
+EventLatencyStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int)
+{
+  auto publish = [rsb](int id, uint64_t value) {
+    rsb->global[id]->sum   = value;
+    rsb->global[id]->count = 1;
+    RecRawStatUpdateSum(rsb, id);
+  };
+  EThread::LatencyHistogram total[N_LATENCY_STATS];
+  EThread::LatencyHistograms delta;
+  EventProcessor::ThreadGroupDescriptor *tg = &eventProcessor.thread_group[ET_CALL];
+  int n                                     = std::min(tg->_count, latency_thread_count);
+
+  ink_mutex_acquire(&(rsb->mutex));
+
+  ink_hrtime now      = Thread::get_hrtime_updated();
+  ink_hrtime elapsed  = now - latency_snapshot_at;
+  latency_snapshot_at = now;
+
+  for (int i = 0; i < n; ++i) {
+    int base = N_LATENCY_STATS * N_LATENCY_QUANTILES + i * N_THREAD_STATS;
+
+    // Racy read of the thread's counters. Like the loop metrics, being slightly behind is fine.
+    delta = tg->_thread[i]->latency;
+    for (int s = 0; s < N_LATENCY_STATS; ++s) {
+      auto &h    = delta.*LATENCY_STATS[s].histogram;
+      auto &prev = latency_snapshot[i].*LATENCY_STATS[s].histogram;
+      auto cur   = h;
+      h -= prev;
+      prev = cur;
+      total[s] += h;
+      int id = base + s * N_LATENCY_THREAD_QUANTILES;
+      for (int v = 0; v < N_LATENCY_THREAD_QUANTILES; ++v) {
+        publish(id + v, h.percentile(LATENCY_THREAD_QUANTILES[v].q));
+      }
+    }
+
+    ink_hrtime idle   = tg->_thread[i]->idle_time;
+    ink_hrtime waited = idle - idle_snapshot[i];
+    idle_snapshot[i]  = idle;
+    if (elapsed > 0) {
+      publish(base + N_THREAD_STATS - 1, 100 - std::clamp<int64_t>(waited * 100 / elapsed, 0, 100));
+    }
+  }
+
+  for (int s = 0; s < N_LATENCY_STATS; ++s) {
+    for (int v = 0; v < N_LATENCY_QUANTILES; ++v) {
+      publish(s * N_LATENCY_QUANTILES + v, total[s].percentile(LATENCY_QUANTILES[v].q));
+    }
   }
 
   ink_mutex_release(&(rsb->mutex));
   return REC_ERR_OKAY;
 }
 
+void
+register_latency_stats(int n_threads)
+{
+  RecRawStatBlock *rsb =
+    RecAllocateRawStatBlock(N_LATENCY_STATS * N_LATENCY_QUANTILES + n_threads * N_THREAD_STATS);
+  char name[256];
+  int id = 0;
+
+  for (auto const &stat : LATENCY_STATS) {
+    for (auto const &quantile : LATENCY_QUANTILES) {
+      snprintf(name, sizeof(name), "proxy.process.eventloop.latency.%s.%s", stat.name, quantile.name);
+      RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id++, NULL);
+    }
+  }
+  for (int i = 0; i < n_threads; ++i) {
+    for (auto const &stat : LATENCY_STATS) {
+      for (auto const &quantile : LATENCY_THREAD_QUANTILES) {
+        snprintf(name, sizeof(name), "proxy.process.eventloop.thread.%d.latency.%s.%s", i, stat.name, quantile.name);
+        RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id++, NULL);
+      }
+    }
+    snprintf(name, sizeof(name), "proxy.process.eventloop.thread.%d.busy", i);
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id++, NULL);
+  }
+
+  latency_snapshot     = new EThread::LatencyHistograms[n_threads];
+  idle_snapshot        = new ink_hrtime[n_threads]();
+  latency_snapshot_at  = Thread::get_hrtime_updated();
+  latency_thread_count = n_threads;
+  RecRegisterRawStatSyncCb(name, EventLatencyStatSync, rsb, 0);
+}
+
 /// This is a wrapper used to convert a static function into a continuation. The function pointer is
 /// passed in the cookie. For this reason the class is used as a singleton.
 /// @internal This is the implementation for @c schedule_spawn... overloads.
@@ -181,6 +316,27 @@ ThreadAffinityInitializer::init()
 
   obj_count = hwloc_get_nbobjs_by_type(ink_get_topology(), obj_type);
   Debug("iocore_thread", "Affinity: %d %ss: %d PU: %d", affinity, obj_name, obj_count, ink_number_of_processors());
+
+  int per_numa_node = 0;
+  REC_ReadConfigInteger(per_numa_node, "proxy.config.allocator.per_numa_node");
+  int n_nodes = hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE);
+  if (per_numa_node && n_nodes > 1 && obj_count > 0) {
+    if (n_nodes > INK_FREELIST_MAX_NODES) {
+      Warning("%d NUMA nodes, only the first %d get their own allocator freelists", n_nodes, INK_FREELIST_MAX_NODES);
+    }
+    for (int i = 0; i < n_nodes; ++i) {
+      hwloc_obj_t node = hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, i);
+      unsigned cpu;
+      hwloc_bitmap_foreach_begin(cpu, node->cpuset)
+      {
+        if (cpu >= cpu_node.size()) {
+          cpu_node.resize(cpu + 1, -1);
+        }
+        cpu_node[cpu] = node->logical_index;
+      }
+      hwloc_bitmap_foreach_end();
+    }
+  }
 }
 
 int
@@ -200,6 +356,18 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Debug("iocore_thread", "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+
+    // A thread confined to one node takes its memory from the freelists of that node.
+    if (!cpu_node.empty() && hwloc_get_nbobjs_inside_cpuset_by_type(ink_get_topology(), obj->cpuset, HWLOC_OBJ_NODE) == 1) {
+      hwloc_obj_t node =
+        hwloc_get_next_obj_covering_cpuset_by_type(ink_get_topology(), obj->cpuset, HWLOC_OBJ_NODE, nullptr);
+      if (node != nullptr) {
+        t->numa_node = node->logical_index;
+        if (t->numa_node < INK_FREELIST_MAX_NODES) {
+          ink_thread_numa_node = t->numa_node;
+        }
+      }
+    }
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
@@ -262,6 +430,25 @@ ThreadAffinityInitializer::alloc_stack(EThread *t, size_t stacksize)
   return this->obj_count > 0 ? this->alloc_numa_stack(t, stacksize) : this->alloc_hugepage_stack(stacksize);
 }
 
+int
+ThreadAffinityInitializer::node_of_cpu(int cpu) const
+{
+  return cpu >= 0 && static_cast<size_t>(cpu) < cpu_node.size() ? cpu_node[cpu] : -1;
+}
+
+int
+ThreadAffinityInitializer::cpu_of_thread(EThread *t) const
+{
+  // Same object set_affinity binds the thread to, which does not depend on the thread having started.
+  if (obj_count > 0) {
+    hwloc_obj_t obj = hwloc_get_obj_by_type(ink_get_topology(), obj_type, t->id % obj_count);
+    if (obj != nullptr && hwloc_bitmap_weight(obj->cpuset) == 1) {
+      return hwloc_bitmap_first(obj->cpuset);
+    }
+  }
+  return -1;
+}
+
 #else
 
 void
@@ -281,6 +468,18 @@ ThreadAffinityInitializer::alloc_stack(EThread *, size_t stacksize)
   return this->alloc_hugepage_stack(stacksize);
 }
 
+int
+ThreadAffinityInitializer::node_of_cpu(int) const
+{
+  return -1;
+}
+
+int
+ThreadAffinityInitializer::cpu_of_thread(EThread *) const
+{
+  return -1;
+}
+
 #endif // TS_USE_HWLOC
 
 EventProcessor::EventProcessor() : thread_initializer(this)
@@ -451,6 +650,7 @@ EventProcessor::start(int n_event_threads, size_t stacksize)
 
   // Name must be that of a stat, pick one at random since we do all of them in one pass/callback.
   RecRegisterRawStatSyncCb(name, EventMetricStatSync, rsb, 0);
+  register_latency_stats(n_event_threads);
 
   this->spawn_event_threads(ET_CALL, n_event_threads, stacksize);
 
@@ -505,6 +705,29 @@ EventProcessor::has_tg_started(int etype)
   return thread_group[etype]._started == thread_group[etype]._count;
 }
 
+EThread *
+EventProcessor::assign_thread_near_cpu(EventType etype, int cpu)
+{
+  int node = Thread_Affinity_Initializer.node_of_cpu(cpu);
+  if (node >= 0) {
+    ThreadGroupDescriptor *tg = &thread_group[etype];
+    // Round robin over the threads of the group, taking the first one found on the node.
+    for (int i = 0; i < tg->_count; ++i) {
+      EThread *t = tg->_thread[++tg->_next_round_robin % tg->_count];
+      if (t->numa_node == node) {
+        return t;
+      }
+    }
+  }
+  return assign_thread(etype);
+}
+
+int
+EventProcessor::cpu_of_thread(EThread *t) const
+{
+  return Thread_Affinity_Initializer.cpu_of_thread(t);
+}
+
 void
 thread_started(EThread *t)
 {
@@ -0,0 +1,203 @@
+/** @file
+
+  Benchmarks of the event system, the cross thread scheduling and the queue of the external events.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "P_EventSystem.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+#define TEST_THREADS 2
+
+namespace
+{
+// The events each run sends, enough for the cost of a run not to be that of its start.
+constexpr int EVENTS = 16384;
+
+// Lets the main thread wait for the event threads to be done with a run.
+class Latch
+{
+public:
+  void
+  reset()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done = false;
+  }
+
+  void
+  signal()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done = true;
+    _cv.notify_one();
+  }
+
+  void
+  wait()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _done; });
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _done = false;
+};
+
+// Bounces between two event threads, each hop is a schedule_imm to the other one, waking it up.
+struct PingPong : public Continuation {
+  PingPong(EThread *a, EThread *b) : Continuation(new_ProxyMutex()), threads{a, b} { SET_HANDLER(&PingPong::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (--remaining <= 0) {
+      latch.signal();
+    } else {
+      threads[remaining & 1]->schedule_imm(this);
+    }
+    return EVENT_DONE;
+  }
+
+  void
+  run(int hops)
+  {
+    remaining = hops;
+    latch.reset();
+    threads[0]->schedule_imm(this);
+    latch.wait();
+  }
+
+  EThread *threads[2];
+  int remaining = 0;
+  Latch latch;
+};
+
+// Counts the events it is called back for, up to the number a run sends.
+struct Counter : public Continuation {
+  Counter() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Counter::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (++count == EVENTS) {
+      latch.signal();
+    }
+    return EVENT_DONE;
+  }
+
+  int count = 0;
+  Latch latch;
+};
+} // namespace
+
+TEST_CASE("EventSystem schedule_imm", "[iocore][benchmark]")
+{
+  EThread *a = eventProcessor.thread_group[ET_CALL]._thread[0];
+  EThread *b = eventProcessor.thread_group[ET_CALL]._thread[1];
+
+  // A hop is a wake up of an idle thread, the round trip latency is twice the time per hop.
+  PingPong ping_pong(a, b);
+  BENCHMARK("schedule_imm ping pong, 1000 hops")
+  {
+    ping_pong.run(1000);
+    return ping_pong.remaining;
+  };
+
+  // A burst from another thread, it takes a single wake up and the events are dispatched back to back.
+  Counter counter;
+  BENCHMARK("schedule_imm throughput, 16384 events")
+  {
+    counter.count = 0;
+    counter.latch.reset();
+    for (int i = 0; i < EVENTS; ++i) {
+      a->schedule_imm(&counter);
+    }
+    counter.latch.wait();
+    return counter.count;
+  };
+}
+
+TEST_CASE("ProtectedQueue contention", "[iocore][benchmark]")
+{
+  // The producers push to the atomic list of the queue as the threads scheduling to an event thread
+  // do, the consumer drains it as the event loop does. Starting the producers is part of a run.
+  for (int producers : {1, 2, 4, 8}) {
+    std::unique_ptr<Event[]> events(new Event[producers * EVENTS]);
+    ProtectedQueue queue;
+
+    BENCHMARK("ProtectedQueue, " + std::to_string(producers) + " producers")
+    {
+      std::vector<std::thread> threads;
+      for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+          for (int i = p * EVENTS; i < (p + 1) * EVENTS; ++i) {
+            queue.enqueue(&events[i]);
+          }
+        });
+      }
+      int received = 0;
+      while (received < producers * EVENTS) {
+        queue.dequeue_external();
+        while (queue.dequeue_local()) {
+          ++received;
+        }
+      }
+      for (auto &t : threads) {
+        t.join();
+      }
+      return received;
+    };
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -0,0 +1,173 @@
+/** @file
+
+  Benchmarks of the IOBuffer, its allocators by size class and thread count, and the MIOBuffer.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+#include "tscore/ink_queue.h"
+
+#include "P_EventSystem.h"
+#include "RecordsConfig.h"
+
+#include "diags.i"
+
+#define TEST_THREADS 1
+
+namespace
+{
+// Each thread of a run allocates this many items, a batch at a time, then frees the batch.
+constexpr int ALLOCATIONS = 4096;
+constexpr int BATCH       = 16;
+
+const int THREAD_COUNTS[] = {1, 2, 4, 8};
+const int SIZE_INDEXES[]  = {BUFFER_SIZE_INDEX_128, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_4K, BUFFER_SIZE_INDEX_32K};
+
+// Run @a fn on @a n threads at once, starting them is part of the run.
+template <typename F>
+void
+on_threads(int n, F const &fn)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n; ++i) {
+    threads.emplace_back(fn);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+// Allocate a batch and free it, as the buffers of a burst of transactions come and go.
+template <typename Alloc, typename Free>
+void
+churn(Alloc const &alloc, Free const &free)
+{
+  void *items[BATCH];
+  for (int i = 0; i < ALLOCATIONS; i += BATCH) {
+    for (auto &item : items) {
+      item = alloc();
+    }
+    for (auto item : items) {
+      free(item);
+    }
+  }
+}
+
+std::string
+size_name(int size_index)
+{
+  return std::to_string(BUFFER_SIZE_FOR_INDEX(size_index)) + " bytes";
+}
+} // namespace
+
+TEST_CASE("ioBufAllocator", "[iocore][benchmark]")
+{
+  // The global freelists, which the threads without a cache and the cache refills share.
+  for (int size_index : SIZE_INDEXES) {
+    Allocator &a = ioBufAllocator[size_index];
+    for (int n : THREAD_COUNTS) {
+      BENCHMARK("ioBufAllocator " + size_name(size_index) + ", " + std::to_string(n) + " threads")
+      {
+        on_threads(n, [&] { churn([&] { return a.alloc_void(); }, [&](void *p) { a.free_void(p); }); });
+        return n;
+      };
+    }
+  }
+
+  // The cache of the event thread, what the buffers of a transaction go through.
+  for (int size_index : SIZE_INDEXES) {
+    BENCHMARK("iobuffer_thread_alloc " + size_name(size_index))
+    {
+      churn([&] { return iobuffer_thread_alloc(size_index); }, [&](void *p) { iobuffer_thread_free(size_index, p); });
+      return size_index;
+    };
+  }
+}
+
+TEST_CASE("ink_freelist", "[iocore][benchmark]")
+{
+  // A freelist of small objects, as a ClassAllocator has, under more and more threads.
+  InkFreeList *fl = ink_freelist_create("benchmark", 64, 256, 8);
+  for (int n : THREAD_COUNTS) {
+    BENCHMARK("ink_freelist 64 bytes, " + std::to_string(n) + " threads")
+    {
+      on_threads(n, [&] { churn([&] { return ink_freelist_new(fl); }, [&](void *p) { ink_freelist_free(fl, p); }); });
+      return n;
+    };
+  }
+}
+
+TEST_CASE("MIOBuffer", "[iocore][benchmark]")
+{
+  // A response of 64KB written a segment at a time, read by a reader and a clone of it, as a tunnel
+  // with a cache write and a client does.
+  constexpr int64_t SEGMENT = 1460;
+  constexpr int64_t LENGTH  = 65536;
+  char segment[SEGMENT];
+  memset(segment, 'x', sizeof(segment));
+
+  for (int size_index : {BUFFER_SIZE_INDEX_4K, BUFFER_SIZE_INDEX_32K}) {
+    BENCHMARK("MIOBuffer write, clone, consume 64KB, " + size_name(size_index) + " blocks")
+    {
+      MIOBuffer *b      = new_MIOBuffer(size_index);
+      IOBufferReader *r = b->alloc_reader();
+      for (int64_t written = 0; written < LENGTH; written += SEGMENT) {
+        b->write(segment, std::min(SEGMENT, LENGTH - written));
+      }
+      IOBufferReader *c = r->clone();
+      int64_t n         = c->read_avail();
+      c->consume(n);
+      r->consume(r->read_avail());
+      free_MIOBuffer(b);
+      return n;
+    };
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    LibRecordsConfigInit();
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
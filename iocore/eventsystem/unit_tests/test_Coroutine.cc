@@ -0,0 +1,273 @@
+/** @file
+
+  Catch based unit tests for the coroutine adapters
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "I_EventSystem.h"
+#include "I_Coroutine.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+#if !TS_HAS_COROUTINES
+#error "test_Coroutine is only built with coroutine support, see --enable-coroutines"
+#endif
+
+#define TEST_THREADS 2
+
+namespace
+{
+constexpr int TEST_EVENT = EVENT_CALL;
+
+EThread *
+event_thread(int i)
+{
+  return eventProcessor.thread_group[ET_CALL]._thread[i];
+}
+
+/// What a task saw, checked by the test thread once @a done is set.
+struct Outcome {
+  std::atomic<bool> done{false};
+  EThread *started_on   = nullptr;
+  bool same_thread      = true;
+  bool mutex_held       = true;
+  bool completed_inline = false;
+  int event             = EVENT_NONE;
+  void *data            = nullptr;
+  ink_hrtime slept      = 0;
+};
+
+/// Completes as it starts, keeping the continuation of the task for the test to look at.
+struct Probe : public ts::Awaiter {
+  Continuation *cont = nullptr;
+
+  void
+  start(Continuation *c) override
+  {
+    cont = c;
+    c->handleEvent(TEST_EVENT, nullptr);
+  }
+};
+
+/// Calls back the task from another thread, the way a processor completing on its own thread does.
+ts::Task
+await_other_thread(Outcome &o)
+{
+  o.started_on       = this_ethread();
+  auto [event, data] = co_await ts::await_event([](Continuation *c) { event_thread(1)->schedule_imm(c, TEST_EVENT); });
+  o.same_thread      = this_ethread() == o.started_on;
+  o.event            = event;
+  o.data             = data;
+  o.done             = true;
+}
+
+/// Completes before the await returns, the task continues without suspending.
+ts::Task
+await_immediate(Outcome &o)
+{
+  o.started_on       = this_ethread();
+  auto [event, data] = co_await ts::await_event([](Continuation *c) { c->handleEvent(TEST_EVENT, nullptr); });
+  o.same_thread      = this_ethread() == o.started_on;
+  o.event            = event;
+  o.data             = data;
+}
+
+ts::Task
+sleep_twice(Outcome &o)
+{
+  o.started_on = this_ethread();
+  Probe probe;
+  co_await probe;
+  ink_hrtime start = Thread::get_hrtime_updated();
+  for (int i = 0; i < 2; ++i) {
+    co_await ts::sleep_for(HRTIME_MSECONDS(20));
+    o.same_thread = o.same_thread && this_ethread() == o.started_on;
+    o.mutex_held  = o.mutex_held && probe.cont->mutex->thread_holding == this_ethread();
+  }
+  o.slept = Thread::get_hrtime_updated() - start;
+  o.done  = true;
+}
+
+/// A VConnection that reads by calling back from another thread, first with READ_READY.
+struct FakeVC : public VConnection {
+  VIO vio;
+
+  FakeVC() : VConnection(new_ProxyMutex()) { SET_HANDLER(&FakeVC::deliver); }
+
+  VIO *
+  do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf) override
+  {
+    vio.op = VIO::READ;
+    vio.set_continuation(c);
+    vio.nbytes    = nbytes;
+    vio.ndone     = 0;
+    vio.vc_server = this;
+    vio.buffer.writer_for(buf);
+    event_thread(1)->schedule_imm(this);
+    return &vio;
+  }
+
+  VIO *
+  do_io_write(Continuation *, int64_t, IOBufferReader *, bool) override
+  {
+    return nullptr;
+  }
+
+  void
+  do_io_close(int) override
+  {
+  }
+
+  void
+  do_io_shutdown(ShutdownHowTo_t) override
+  {
+  }
+
+  int
+  deliver(int, void *)
+  {
+    SCOPED_MUTEX_LOCK(lock, vio.mutex, this_ethread());
+    vio.buffer.writer()->write("hello", 5);
+    vio.ndone = 5;
+    vio.cont->handleEvent(VC_EVENT_READ_READY, &vio);
+    vio.cont->handleEvent(VC_EVENT_READ_COMPLETE, &vio);
+    return EVENT_DONE;
+  }
+};
+
+ts::Task
+read_vc(Outcome &o, FakeVC *vc, MIOBuffer *buf)
+{
+  o.started_on       = this_ethread();
+  auto [event, data] = co_await ts::do_io_read(vc, 5, buf);
+  o.same_thread      = this_ethread() == o.started_on;
+  o.event            = event;
+  o.data             = data;
+  o.done             = true;
+}
+
+/// Runs @a f on the first event thread, where the task it starts lives.
+template <class F>
+void
+run_on_thread(F f)
+{
+  struct Starter : public Continuation {
+    F f;
+    explicit Starter(F fn) : Continuation(new_ProxyMutex()), f(fn) { SET_HANDLER(&Starter::start); }
+    int
+    start(int, Event *)
+    {
+      f();
+      delete this;
+      return EVENT_DONE;
+    }
+  };
+  event_thread(0)->schedule_imm(new Starter(f));
+}
+
+void
+wait_for(Outcome &o)
+{
+  for (int i = 0; i < 500 && !o.done; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(o.done);
+}
+} // namespace
+
+TEST_CASE("Coroutine", "[iocore][coroutine]")
+{
+  SECTION("a callback from another thread resumes the task on its own thread")
+  {
+    Outcome o;
+    run_on_thread([&o]() { await_other_thread(o); });
+    wait_for(o);
+    REQUIRE(o.started_on == event_thread(0));
+    REQUIRE(o.same_thread);
+    REQUIRE(o.event == TEST_EVENT);
+    REQUIRE(o.data != nullptr); // The Event of schedule_imm
+  }
+
+  SECTION("a synchronous completion does not suspend")
+  {
+    Outcome o;
+    run_on_thread([&o]() {
+      await_immediate(o);
+      o.completed_inline = o.event == TEST_EVENT;
+      o.done             = true;
+    });
+    wait_for(o);
+    REQUIRE(o.completed_inline);
+    REQUIRE(o.same_thread);
+  }
+
+  SECTION("timers resume on the task thread with its mutex held")
+  {
+    Outcome o;
+    run_on_thread([&o]() { sleep_twice(o); });
+    wait_for(o);
+    REQUIRE(o.same_thread);
+    REQUIRE(o.mutex_held);
+    REQUIRE(o.slept >= HRTIME_MSECONDS(40));
+  }
+
+  SECTION("a VIO completes with the first event that is not READY")
+  {
+    Outcome o;
+    FakeVC vc;
+    MIOBuffer *buf         = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    IOBufferReader *reader = buf->alloc_reader();
+    run_on_thread([&o, &vc, buf]() { read_vc(o, &vc, buf); });
+    wait_for(o);
+    REQUIRE(o.same_thread);
+    REQUIRE(o.event == VC_EVENT_READ_COMPLETE);
+    REQUIRE(o.data == &vc.vio);
+    REQUIRE(reader->read_avail() == 5);
+    free_MIOBuffer(buf);
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -0,0 +1,187 @@
+/** @file
+
+  Catch based unit tests for scheduling batches of events on a thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "I_EventSystem.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+#define TEST_THREADS 2
+
+namespace
+{
+constexpr int N_EVENTS = 32;
+
+int order[N_EVENTS];
+std::atomic<int> fired{0};
+std::atomic<int> wrong_thread{0};
+
+EThread *
+event_thread(int i)
+{
+  return eventProcessor.thread_group[ET_CALL]._thread[i];
+}
+
+// Records the order it was called back in.
+struct Recorder : public Continuation {
+  int index;
+  EThread *expected;
+
+  Recorder(int i, EThread *t) : Continuation(new_ProxyMutex()), index(i), expected(t) { SET_HANDLER(&Recorder::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (this_ethread() != expected) {
+      ++wrong_thread;
+    }
+    order[fired++] = index;
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
+// Keeps its thread from looking at its event queue until released.
+struct Blocker : public Continuation {
+  std::atomic<bool> blocking{false};
+  std::atomic<bool> release{false};
+
+  Blocker() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Blocker::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    blocking = true;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return EVENT_DONE;
+  }
+};
+
+// Schedules a batch on the thread it runs on.
+struct LocalBatch : public Continuation {
+  LocalBatch() : Continuation(new_ProxyMutex()) { SET_HANDLER(&LocalBatch::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    EThread *t = this_ethread();
+    EventBatch batch;
+    for (int i = 0; i < N_EVENTS; ++i) {
+      batch.add(new Recorder(i, t));
+    }
+    t->schedule_batch(batch);
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
+void
+wait_for_events()
+{
+  for (int i = 0; i < 500 && fired < N_EVENTS; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(fired == N_EVENTS);
+  REQUIRE(wrong_thread == 0);
+  for (int i = 0; i < N_EVENTS; ++i) {
+    REQUIRE(order[i] == i);
+  }
+}
+} // namespace
+
+TEST_CASE("EventBatch", "[iocore]")
+{
+  fired        = 0;
+  wrong_thread = 0;
+
+  SECTION("a batch from another thread is queued at once and called back in order")
+  {
+    EThread *t = event_thread(1);
+    Blocker blocker;
+    t->schedule_imm(&blocker);
+    for (int i = 0; i < 500 && !blocker.blocking; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(blocker.blocking);
+
+    EventBatch batch;
+    Event *events[N_EVENTS];
+    for (int i = 0; i < N_EVENTS; ++i) {
+      events[i] = batch.add(new Recorder(i, t));
+    }
+    t->schedule_batch(batch);
+    REQUIRE(batch.empty());
+
+    // One enqueue, the whole batch is a single chain on top of the external queue, newest first.
+    Event *e = static_cast<Event *>(TO_PTR(FREELIST_POINTER(t->EventQueueExternal.al.head)));
+    for (int i = N_EVENTS - 1; i >= 0; --i, e = e->link.next) {
+      REQUIRE(e == events[i]);
+      REQUIRE(e->ethread == t);
+    }
+
+    blocker.release = true;
+    wait_for_events();
+  }
+
+  SECTION("a batch from its own thread is called back in order")
+  {
+    event_thread(0)->schedule_imm(new LocalBatch());
+    wait_for_events();
+  }
+
+  SECTION("an empty batch does nothing")
+  {
+    EventBatch batch;
+    event_thread(1)->schedule_batch(batch);
+    REQUIRE(batch.empty());
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -330,6 +330,43 @@ TEST_CASE("MIOBuffer", "[iocore]")
   }
 }
 
+TEST_CASE("IOBufferAccount", "[iocore]")
+{
+  Ptr<IOBufferAccount> session = make_ptr(new IOBufferAccount("session", 8192));
+  Ptr<IOBufferAccount> txn     = make_ptr(new IOBufferAccount("txn", 0, session.get()));
+  char buf[4096]               = {0};
+
+  MIOBuffer *miob        = new_MIOBuffer(BUFFER_SIZE_INDEX_4K, txn.get());
+  IOBufferReader *miob_r = miob->alloc_reader();
+  MIOBuffer *clone       = new_empty_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  clone->alloc_reader();
+
+  CHECK(txn->bytes() == 4096);
+  CHECK(session->bytes() == 4096);
+  CHECK(session->over_limit() == false);
+
+  miob->write(buf, 4096);
+  miob->write(buf, 4096);
+  miob->write(buf, 1);
+  CHECK(txn->bytes() == 12288);
+  CHECK(session->bytes() == 12288);
+  CHECK(txn->over_limit() == true); ///< the limit of the parent applies
+
+  // Blocks shared with another buffer stay charged until both are done with them
+  clone->write(miob_r, 4096);
+  miob_r->consume(8192);
+  CHECK(txn->bytes() == 8192);
+  CHECK(txn->over_limit() == false);
+
+  free_MIOBuffer(clone);
+  CHECK(txn->bytes() == 4096);
+  CHECK(txn->peak() == 12288);
+
+  free_MIOBuffer(miob);
+  CHECK(txn->bytes() == 0);
+  CHECK(session->bytes() == 0);
+}
+
 struct EventProcessorListener : Catch::TestEventListenerBase {
   using TestEventListenerBase::TestEventListenerBase;
 
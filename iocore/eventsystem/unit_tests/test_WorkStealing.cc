@@ -0,0 +1,137 @@
+/** @file
+
+  Catch based unit tests for the work stealing between event threads
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "I_EventSystem.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+#define TEST_THREADS 2
+
+namespace
+{
+constexpr int N_JOBS = 16;
+
+std::atomic<int> jobs_done{0};
+std::atomic<int> jobs_moved{0};
+std::atomic<int> pinned_moved{0};
+std::atomic<bool> blocker_done{false};
+
+// Records whether it ran on the thread that scheduled it.
+struct Job : public Continuation {
+  EThread *scheduled_on;
+  std::atomic<int> &moved;
+
+  Job(EThread *t, bool agnostic, std::atomic<int> &m) : Continuation(new_ProxyMutex()), scheduled_on(t), moved(m)
+  {
+    SET_HANDLER(&Job::handle);
+    thread_agnostic = agnostic;
+  }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (this_ethread() != scheduled_on) {
+      ++moved;
+    }
+    ++jobs_done;
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
+// Keeps its thread busy after scheduling the jobs there, so only another thread can run them in the meantime.
+struct Blocker : public Continuation {
+  bool agnostic;
+
+  explicit Blocker(bool a) : Continuation(new_ProxyMutex()), agnostic(a) { SET_HANDLER(&Blocker::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    EThread *t = this_ethread();
+    for (int i = 0; i < N_JOBS; ++i) {
+      eventProcessor.schedule_imm(new Job(t, agnostic, agnostic ? jobs_moved : pinned_moved), ET_CALL);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    blocker_done = true;
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
+void
+run_blocker(bool agnostic)
+{
+  jobs_done    = 0;
+  blocker_done = false;
+  eventProcessor.thread_group[ET_CALL]._thread[0]->schedule_imm(new Blocker(agnostic));
+  for (int i = 0; i < 500 && (jobs_done < N_JOBS || !blocker_done); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(jobs_done == N_JOBS);
+}
+} // namespace
+
+TEST_CASE("WorkStealing", "[iocore]")
+{
+  SECTION("thread agnostic events are run by an idle thread")
+  {
+    run_blocker(true);
+    REQUIRE(jobs_moved > 0);
+  }
+
+  SECTION("other events stay on their thread")
+  {
+    run_blocker(false);
+    REQUIRE(pinned_moved == 0);
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    thread_work_stealing = 1;
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
@@ -24,11 +24,15 @@
 #include "Main.h"
 #include "P_HostDB.h"
 #include "P_RefCountCacheSerializer.h"
+#include "P_RefCountCacheJournal.h"
 #include "tscore/I_Layout.h"
 #include "Show.h"
 #include "tscore/Tokenizer.h"
 #include "tscore/ink_apidefs.h"
+#include "tscore/JeAllocator.h"
+#include "ts/sdt.h"
 
+#include <atomic>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -50,6 +54,10 @@ unsigned int hostdb_ip_stale_interval          = HOST_DB_IP_STALE;
 unsigned int hostdb_ip_timeout_interval        = HOST_DB_IP_TIMEOUT;
 unsigned int hostdb_ip_fail_timeout_interval   = HOST_DB_IP_FAIL_TIMEOUT;
 unsigned int hostdb_serve_stale_but_revalidate = 0;
+unsigned int hostdb_refresh_ahead_hits         = 0;
+unsigned int hostdb_refresh_ahead_ttl_pct      = 80;
+unsigned int hostdb_refresh_ahead_rate         = 100;
+unsigned int hostdb_negative_max_ttl           = 0;
 unsigned int hostdb_hostfile_check_interval    = 86400; // 1 day
 // Epoch timestamp of the current hosts file check.
 ink_time_t hostdb_current_interval = 0;
@@ -69,6 +77,7 @@ static_assert(sizeof(HostDBApplicationInfo::allotment) == sizeof(HostDBApplicati
               "Generic storage for HostDBApplicationInfo is smaller than the union storage.");
 
 ClassAllocator<HostDBContinuation> hostDBContAllocator("hostDBContAllocator");
+Allocator hostDBInfoAllocator[DEFAULT_BUFFER_SIZES];
 
 // Static configuration information
 
@@ -252,12 +261,73 @@ HostDBCache::is_pending_dns_for_hash(const CryptoHash &hash)
   return false;
 }
 
+void
+HostDBCache::put(HostDBInfo *r, int size)
+{
+  RefCountCache<HostDBInfo> *cache = refcountcache;
+  if (negative_cache) {
+    // a record is in one of the caches, the failed ones cannot evict the others
+    cache = r->is_failed() ? negative_cache : refcountcache;
+    (cache == refcountcache ? negative_cache : refcountcache)->erase(r->key);
+  }
+  cache->put(r->key, r, size, r->expiry_time());
+  publish(r, size);
+}
+
+void
+HostDBCache::publish(HostDBInfo *r, int size)
+{
+  if (fast_table) {
+    if (r->is_failed()) {
+      fast_table->erase(r->key);
+    } else {
+      fast_table->put(r);
+    }
+  }
+  if (journal) {
+    if (negative_cache && r->is_failed()) {
+      journal->erase(r->key);
+    } else {
+      journal->put(r->key, r, size, r->expiry_time());
+    }
+  }
+}
+
+void
+HostDBCache::erase(uint64_t key)
+{
+  refcountcache->erase(key);
+  if (negative_cache) {
+    negative_cache->erase(key);
+  }
+  if (fast_table) {
+    fast_table->erase(key);
+  }
+  if (journal) {
+    journal->erase(key);
+  }
+}
+
 HostDBCache *
 HostDBProcessor::cache()
 {
   return &hostDB;
 }
 
+// Releases the records taken from the lock free table once no lookup can have them.
+struct HostDBFastTableReclaim : public Continuation {
+  static constexpr ink_hrtime PERIOD = HRTIME_MSECONDS(100);
+
+  HostDBFastTableReclaim() : Continuation(new_ProxyMutex()) { SET_HANDLER(&HostDBFastTableReclaim::reclaimEvent); }
+
+  int
+  reclaimEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    hostDB.fast_table->reclaim();
+    return EVENT_CONT;
+  }
+};
+
 struct HostDBBackgroundTask : public Continuation {
   int frequency;
   ink_hrtime start_time;
@@ -287,6 +357,7 @@ HostDBBackgroundTask::wait_event(int, void *)
   return EVENT_DONE;
 }
 
+// With a journal, the snapshot is only written again once the journal is larger than it.
 struct HostDBSync : public HostDBBackgroundTask {
   std::string storage_path;
   std::string full_path;
@@ -295,13 +366,36 @@ struct HostDBSync : public HostDBBackgroundTask {
   int
   sync_event(int, void *) override
   {
-    SET_HANDLER(&HostDBSync::wait_event);
-    start_time = Thread::get_hrtime();
+    start_time                                = Thread::get_hrtime();
+    RefCountCacheJournal<HostDBInfo> *journal = hostDBProcessor.cache()->journal;
+    if (journal) {
+      SCOPED_MUTEX_LOCK(lock, journal->mutex, this_ethread());
+      struct stat st;
+      if (stat(this->full_path.c_str(), &st) == 0 && journal->size() < st.st_size) {
+        return this->wait_event(EVENT_NONE, nullptr);
+      }
+      int error = journal->rotate();
+      if (error != 0) {
+        Warning("Unable to rotate the journal of %s: %s", this->full_path.c_str(), strerror(-error));
+      }
+    }
+    SET_HANDLER(&HostDBSync::sync_done);
 
     new RefCountCacheSerializer<HostDBInfo>(this, hostDBProcessor.cache()->refcountcache, this->frequency, this->storage_path,
                                             this->full_path);
     return EVENT_DONE;
   }
+
+  int
+  sync_done(int event, Event *e)
+  {
+    RefCountCacheJournal<HostDBInfo> *journal = hostDBProcessor.cache()->journal;
+    if (journal && e->cookie) {
+      SCOPED_MUTEX_LOCK(lock, journal->mutex, this_ethread());
+      journal->compacted();
+    }
+    return this->wait_event(event, e);
+  }
 };
 
 int
@@ -340,6 +434,19 @@ HostDBCache::start(int flags)
   this->refcountcache = new RefCountCache<HostDBInfo>(hostdb_partitions, hostdb_max_size, hostdb_max_count, HostDBInfo::version(),
                                                       "proxy.process.hostdb.cache.");
 
+  int negative_max_count = 0;
+  REC_ReadConfigInt32(negative_max_count, "proxy.config.hostdb.negative.max_count");
+  if (negative_max_count > 0) {
+    // room for the longest names, the partitions are locked with those of the cache
+    int64_t negative_max_size = static_cast<int64_t>(negative_max_count) * (sizeof(HostDBInfo) + MAXDNAME);
+    negative_max_size         = std::min<int64_t>(negative_max_size, INT_MAX);
+    this->negative_cache      = new RefCountCache<HostDBInfo>(hostdb_partitions, negative_max_size, negative_max_count,
+                                                         HostDBInfo::version(), "proxy.process.hostdb.negative_cache.");
+    for (int i = 0; i < hostdb_partitions; i++) {
+      this->negative_cache->get_partition(i).lock = this->refcountcache->get_partition(i).lock;
+    }
+  }
+
   //
   // Load and sync HostDB, if we've asked for it.
   //
@@ -371,9 +478,25 @@ HostDBCache::start(int flags)
       Warning("Error loading cache from %s: %d", full_path, load_ret);
     }
 
+    int journal = 1;
+    REC_ReadConfigInt32(journal, "proxy.config.cache.hostdb.journal");
+    if (journal) {
+      this->journal = new RefCountCacheJournal<HostDBInfo>(this->refcountcache, std::string(full_path) + ".journal");
+      this->journal->load(HostDBInfo::unmarshall);
+      this->journal->start();
+    }
+
     eventProcessor.schedule_imm(new HostDBSync(hostdb_sync_frequency, storage_path, full_path), ET_TASK);
   }
 
+  int lockfree_lookups = 1;
+  REC_ReadConfigInt32(lockfree_lookups, "proxy.config.hostdb.lockfree_lookups");
+  if (lockfree_lookups) {
+    // twice the records of the cache, the records of a window are then seldom evicted for room
+    this->fast_table = new HostDBFastTable(2 * static_cast<size_t>(hostdb_max_count > 0 ? hostdb_max_count : DEFAULT_HOST_DB_SIZE));
+    eventProcessor.schedule_every(new HostDBFastTableReclaim(), HostDBFastTableReclaim::PERIOD, ET_TASK);
+  }
+
   this->pending_dns       = new Queue<HostDBContinuation, Continuation::Link_link>[hostdb_partitions];
   this->remoteHostDBQueue = new Queue<HostDBContinuation, Continuation::Link_link>[hostdb_partitions];
   return 0;
@@ -393,6 +516,16 @@ HostDBProcessor::start(int, size_t)
 
   if (auto_clear_hostdb_flag) {
     hostDB.refcountcache->clear();
+    if (hostDB.negative_cache) {
+      hostDB.negative_cache->clear();
+    }
+    if (hostDB.fast_table) {
+      hostDB.fast_table->clear();
+    }
+    if (hostDB.journal) {
+      SCOPED_MUTEX_LOCK(lock, hostDB.journal->mutex, this_ethread());
+      hostDB.journal->clear();
+    }
   }
 
   statPagesManager.register_http("hostdb", register_ShowHostDB);
@@ -411,6 +544,10 @@ HostDBProcessor::start(int, size_t)
   REC_EstablishStaticConfigInt32U(hostdb_ip_stale_interval, "proxy.config.hostdb.verify_after");
   REC_EstablishStaticConfigInt32U(hostdb_ip_fail_timeout_interval, "proxy.config.hostdb.fail.timeout");
   REC_EstablishStaticConfigInt32U(hostdb_serve_stale_but_revalidate, "proxy.config.hostdb.serve_stale_for");
+  REC_EstablishStaticConfigInt32U(hostdb_refresh_ahead_hits, "proxy.config.hostdb.refresh_ahead.hits");
+  REC_EstablishStaticConfigInt32U(hostdb_refresh_ahead_ttl_pct, "proxy.config.hostdb.refresh_ahead.ttl_pct");
+  REC_EstablishStaticConfigInt32U(hostdb_refresh_ahead_rate, "proxy.config.hostdb.refresh_ahead.rate");
+  REC_EstablishStaticConfigInt32U(hostdb_negative_max_ttl, "proxy.config.hostdb.negative.max_ttl");
   REC_EstablishStaticConfigInt32U(hostdb_hostfile_check_interval, "proxy.config.hostdb.host_file.interval");
   REC_EstablishStaticConfigInt32U(hostdb_round_robin_max_count, "proxy.config.hostdb.round_robin_max_count");
 
@@ -482,7 +619,7 @@ reply_to_cont(Continuation *cont, HostDBInfo *r, bool is_srv = false)
       ink_assert(!"missing hostname");
       cont->handleEvent(is_srv ? EVENT_SRV_LOOKUP : EVENT_HOST_DB_LOOKUP, nullptr);
       Warning("bogus entry deleted from HostDB: missing hostname");
-      hostDB.refcountcache->erase(r->key);
+      hostDB.erase(r->key);
       return false;
     }
     Debug("hostdb", "hostname = %s", r->hostname());
@@ -493,7 +630,7 @@ reply_to_cont(Continuation *cont, HostDBInfo *r, bool is_srv = false)
       ink_assert(!"missing round-robin");
       cont->handleEvent(is_srv ? EVENT_SRV_LOOKUP : EVENT_HOST_DB_LOOKUP, nullptr);
       Warning("bogus entry deleted from HostDB: missing round-robin");
-      hostDB.refcountcache->erase(r->key);
+      hostDB.erase(r->key);
       return false;
     }
     ip_text_buffer ipb;
@@ -541,6 +678,21 @@ db_mark_for(IpAddr const &ip)
   return ip.isIp6() ? HOSTDB_MARK_IPV6 : HOSTDB_MARK_IPV4;
 }
 
+// Take one of the proxy.config.hostdb.refresh_ahead.rate refreshes ahead allowed each second.
+static bool
+refresh_ahead_allowed()
+{
+  static std::atomic<ink_time_t> second{0};
+  static std::atomic<unsigned int> count{0};
+
+  ink_time_t now  = hostdb_current_interval;
+  ink_time_t last = second.load(std::memory_order_relaxed);
+  if (last != now && second.compare_exchange_strong(last, now)) {
+    count = 0;
+  }
+  return !hostdb_refresh_ahead_rate || ++count <= hostdb_refresh_ahead_rate;
+}
+
 Ptr<HostDBInfo>
 probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
 {
@@ -554,14 +706,22 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
   uint64_t folded_hash = hash.hash.fold();
 
   // get the item from cache
-  Ptr<HostDBInfo> r = hostDB.refcountcache->get(folded_hash);
+  unsigned int hits = 0;
+  Ptr<HostDBInfo> r = hostDB.refcountcache->get(folded_hash, &hits);
+  if (!r && hostDB.negative_cache) {
+    r = hostDB.negative_cache->get(folded_hash);
+  }
   // If there was nothing in the cache-- this is a miss
   if (r.get() == nullptr) {
     return r;
   }
+  if (r->refreshed_ahead) {
+    HOSTDB_INCREMENT_DYN_STAT(hostdb_refresh_ahead_hits_stat);
+  }
 
   // If the dns response was failed, and we've hit the failed timeout, lets stop returning it
-  if (r->is_failed() && r->is_ip_fail_timeout()) {
+  // a failed record has its own TTL with negative caching
+  if (r->is_failed() && (hostdb_negative_max_ttl ? r->is_ip_timeout() : r->is_ip_fail_timeout())) {
     return make_ptr((HostDBInfo *)nullptr);
     // if we aren't ignoring timeouts, and we are past it-- then remove the item
   } else if (!ignore_timeout && r->is_ip_timeout() && !r->serve_stale_but_revalidate()) {
@@ -570,7 +730,8 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
   }
 
   // If the record is stale, but we want to revalidate-- lets start that up
-  if ((!ignore_timeout && r->is_ip_stale() && !r->reverse_dns) || (r->is_ip_timeout() && r->serve_stale_but_revalidate())) {
+  if ((!ignore_timeout && r->is_ip_stale() && !r->reverse_dns && !r->is_failed()) ||
+      (r->is_ip_timeout() && r->serve_stale_but_revalidate())) {
     if (hostDB.is_pending_dns_for_hash(hash.hash)) {
       Debug("hostdb", "stale %u %u %u, using it and pending to refresh it", r->ip_interval(), r->ip_timestamp,
             r->ip_timeout_interval);
@@ -582,6 +743,52 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
     copt.host_res_style = host_res_style_for(r->ip());
     c->init(hash, copt);
     c->do_dns();
+  } else if (!ignore_timeout && !r->is_failed() && r->is_ip_refresh_ahead(hits) && !hostDB.is_pending_dns_for_hash(hash.hash)) {
+    // hot and close to expire, re-resolve it before the next lookup has to wait for it
+    if (!refresh_ahead_allowed()) {
+      HOSTDB_INCREMENT_DYN_STAT(hostdb_refresh_ahead_throttled_stat);
+      return r;
+    }
+    Debug("hostdb", "hot %u %u %u with %u hits, refreshing it ahead", r->ip_interval(), r->ip_timestamp, r->ip_timeout_interval,
+          hits);
+    HOSTDB_INCREMENT_DYN_STAT(hostdb_refresh_ahead_stat);
+    HostDBContinuation *c = hostDBContAllocator.alloc();
+    HostDBContinuation::Options copt;
+    copt.host_res_style = host_res_style_for(r->ip());
+    c->init(hash, copt);
+    c->refresh_ahead = true;
+    c->do_dns();
+  }
+  return r;
+}
+
+// How long to keep a failed lookup, the @a failures th in a row of its name. With negative caching, the
+// TTL of the SOA of a negative answer, or the fail timeout for the others, doubled with every failure
+// after the first up to proxy.config.hostdb.negative.max_ttl, as RFC 2308 suggests for the names that
+// keep failing.
+static unsigned int
+negative_ttl(HostEnt *e, unsigned int failures)
+{
+  if (!hostdb_negative_max_ttl) {
+    return hostdb_ip_fail_timeout_interval;
+  }
+  uint64_t ttl = (e && e->ttl) ? e->ttl : std::max(hostdb_ip_fail_timeout_interval, 1u);
+  ttl <<= std::min(failures - 1, 16u);
+  return std::min(ttl, static_cast<uint64_t>(hostdb_negative_max_ttl));
+}
+
+// The record of @a hash from the lock free table, if it can be served as is: a record to
+// refresh or to fail over from is left to probe().
+static Ptr<HostDBInfo>
+fast_probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash)
+{
+  Ptr<HostDBInfo> r = hostDB.fast_table->get(hash.hash.fold());
+  if (!r || r->is_failed() || r->is_ip_timeout() || (r->is_ip_stale() && !r->reverse_dns) || r->is_ip_refresh_ahead_window() ||
+      r->is_srv != (hash.db_mark == HOSTDB_MARK_SRV)) {
+    return Ptr<HostDBInfo>();
+  }
+  if (r->refreshed_ahead) {
+    HOSTDB_INCREMENT_DYN_STAT(hostdb_refresh_ahead_hits_stat);
   }
   return r;
 }
@@ -606,6 +813,7 @@ HostDBContinuation::insert(unsigned int attl)
   Debug("hostdb", "inserting for: %.*s: (hash: %" PRIx64 ") now: %u timeout: %u ttl: %u", hash.host_len, hash.host_name,
         folded_hash, r->ip_timestamp, r->ip_timeout_interval, attl);
 
+  // published by lookup_done() once it is filled in
   hostDB.refcountcache->put(folded_hash, r, 0, r->expiry_time());
   return r;
 }
@@ -651,6 +859,20 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
   if (!force_dns) {
     MUTEX_TRY_LOCK(lock, cont->mutex, thread);
     bool loop = lock.is_locked();
+    if (loop && hostDB.fast_table) {
+      if (Ptr<HostDBInfo> r = fast_probe(mutex, hash)) {
+        Debug("hostdb", "immediate lock free answer (hash: %" PRIx64 ")", r->key);
+        HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
+        HOSTDB_INCREMENT_DYN_STAT(hostdb_lockfree_hits_stat);
+        ATS_PROBE2(hostdb_lookup_hit, hash.host_name, hash.host_len);
+        if (cb_process_result) {
+          (cont->*cb_process_result)(r.get());
+        } else {
+          reply_to_cont(cont, r.get());
+        }
+        return ACTION_RESULT_DONE;
+      }
+    }
     while (loop) {
       loop = false; // Only loop on explicit set for retry.
       // find the partition lock
@@ -675,6 +897,11 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
               Debug("hostdb", "immediate answer for %s", hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>");
             }
             HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
+            ATS_PROBE2(hostdb_lookup_hit, hash.host_name, hash.host_len);
+            if (hostDB.fast_table && !r->is_failed()) {
+              // the records loaded from disk are published on their first lookup
+              hostDB.fast_table->put(r.get());
+            }
             if (cb_process_result) {
               (cont->*cb_process_result)(r.get());
             } else {
@@ -698,6 +925,7 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
     Debug("hostdb", "delaying (force=%d) answer for %s [timeout %d]", force_dns,
           hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>", opt.timeout);
   }
+  ATS_PROBE2(hostdb_lookup_miss, hash.host_name, hash.host_len);
 
 Lretry:
   // Otherwise, create a continuation to do a deeper probe in the background
@@ -958,6 +1186,7 @@ HostDBContinuation::lookup_done(IpAddr const &ip, const char *aname, bool around
                                 HostDBInfo *r)
 {
   ink_assert(this_ethread() == hostDB.refcountcache->lock_for_key(hash.hash.fold())->thread_holding);
+  bool inserted = r == nullptr;
   if (!ip.isValid() || !aname || !aname[0]) {
     if (is_byname()) {
       Debug("hostdb", "lookup_done() failed for '%.*s'", hash.host_len, hash.host_name);
@@ -967,11 +1196,12 @@ HostDBContinuation::lookup_done(IpAddr const &ip, const char *aname, bool around
       ip_text_buffer b;
       Debug("hostdb", "failed for %s", hash.ip.toString(b, sizeof b));
     }
+    unsigned int fail_ttl = ttl_seconds ? ttl_seconds : hostdb_ip_fail_timeout_interval;
     if (r == nullptr) {
-      r = insert(hostdb_ip_fail_timeout_interval);
+      r = insert(fail_ttl);
     } else {
       r->ip_timestamp        = hostdb_current_interval;
-      r->ip_timeout_interval = std::clamp(hostdb_ip_fail_timeout_interval, 1u, HOST_DB_MAX_TTL);
+      r->ip_timeout_interval = std::clamp(fail_ttl, 1u, HOST_DB_MAX_TTL);
     }
 
     r->round_robin     = false;
@@ -980,6 +1210,9 @@ HostDBContinuation::lookup_done(IpAddr const &ip, const char *aname, bool around
     r->reverse_dns     = !is_byname() && !is_srv();
 
     r->set_failed();
+    if (inserted) {
+      hostDB.publish(r, 0);
+    }
     return r;
 
   } else {
@@ -1047,6 +1280,9 @@ HostDBContinuation::lookup_done(IpAddr const &ip, const char *aname, bool around
   }
 
   ink_assert(!r->round_robin || !r->reverse_dns);
+  if (inserted) {
+    hostDB.publish(r, 0);
+  }
   return r;
 }
 
@@ -1148,9 +1384,11 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     int ttl_seconds = failed ? 0 : e->ttl; // ebalsa: moving to second accuracy
 
     Ptr<HostDBInfo> old_r = probe(mutex, hash, false);
+    // the failures in a row of the name, for its backoff
+    unsigned int failures = (old_r && old_r->is_failed()) ? std::min(old_r->fail_count + 1u, 15u) : 1;
     // If the DNS lookup failed with NXDOMAIN, remove the old record
     if (e && e->isNameError() && old_r) {
-      hostDB.refcountcache->erase(old_r->key);
+      hostDB.erase(old_r->key);
       old_r = nullptr;
       Debug("hostdb", "Removing the old record when the DNS lookup failed with NXDOMAIN");
     }
@@ -1197,6 +1435,10 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
       first_record = e->ent.h_addr_list[0];
     } // else first is 0.
 
+    if (failed) {
+      ttl_seconds = negative_ttl(e, failures);
+    }
+
     IpAddr tip; // temp storage if needed.
 
     // In the event that the lookup failed (SOA response-- for example) we want to use hash.host_name, since it'll be ""
@@ -1222,7 +1464,8 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     // which is okay with being served stale-- lets continue to serve the stale record as long as
     // the record is willing to be served.
     bool serve_stale = false;
-    if (failed && old_r && old_r->serve_stale_but_revalidate()) {
+    // a failed refresh ahead keeps the record, it is retried on the next lookups until it expires
+    if (failed && old_r && (old_r->serve_stale_but_revalidate() || (refresh_ahead && !old_r->is_ip_timeout()))) {
       r->free();
       r           = old_r.get();
       serve_stale = true;
@@ -1336,7 +1579,9 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     ink_assert(failed || !r->round_robin || r->app.rr.offset);
 
     if (!serve_stale) {
-      hostDB.refcountcache->put(hash.hash.fold(), r, allocSize, r->expiry_time());
+      r->refreshed_ahead = refresh_ahead && !failed;
+      r->fail_count      = r->is_failed() ? failures : 0;
+      hostDB.put(r, allocSize);
     } else {
       Warning("Fallback to serving stale record, skip re-update of hostdb for %s", aname);
     }
@@ -1551,6 +1796,8 @@ HostDBContinuation::remove_trigger_pending_dns()
     c = n;
   }
   EThread *thread = this_ethread();
+  // A popular name can have many waiters, hand them over with one batch per thread.
+  std::vector<std::pair<EThread *, EventBatch>> batches;
   while ((c = qq.dequeue())) {
     // resume all queued HostDBCont in the thread associated with the netvc to avoid nethandler locking issues.
     EThread *affinity_thread = c->getThreadAffinity();
@@ -1560,9 +1807,16 @@ HostDBContinuation::remove_trigger_pending_dns()
       if (c->timeout) {
         c->timeout->cancel();
       }
-      c->timeout = eventProcessor.schedule_imm(c);
+      auto spot = std::find_if(batches.begin(), batches.end(), [=](auto const &b) { return b.first == affinity_thread; });
+      if (spot == batches.end()) {
+        spot = batches.emplace(batches.end(), affinity_thread, EventBatch());
+      }
+      c->timeout = spot->second.add(c);
     }
   }
+  for (auto &[t, batch] : batches) {
+    t->schedule_batch(batch);
+  }
 }
 
 //
@@ -2069,6 +2323,17 @@ ink_hostdb_init(ts::ModuleVersion v)
 
   init_called = 1;
   // do one time stuff
+  jearena::Arena *arena = jearena::Arena::get("hostdb");
+  for (int i = 0; i < DEFAULT_BUFFER_SIZES; i++) {
+    int64_t s = DEFAULT_BUFFER_BASE_SIZE * ((static_cast<int64_t>(1)) << i);
+    int n     = i <= BUFFER_SIZE_INDEX_8K ? DEFAULT_BUFFER_NUMBER : DEFAULT_HUGE_BUFFER_NUMBER;
+
+    auto name = new char[64];
+    snprintf(name, 64, "hostDBInfoAllocator[%d]", i);
+    hostDBInfoAllocator[i].re_init(name, s, n, 16, 0);
+    hostDBInfoAllocator[i].set_arena(arena);
+  }
+
   // create a stat block for HostDBStats
   hostdb_rsb = RecAllocateRawStatBlock(static_cast<int>(HostDB_Stat_Count));
 
@@ -2094,6 +2359,18 @@ ink_hostdb_init(ts::ModuleVersion v)
   RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.insert_duplicate_to_pending_dns", RECD_INT, RECP_PERSISTENT,
                      (int)hostdb_insert_duplicate_to_pending_dns_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead_throttled", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_throttled_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead_hits", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_hits_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.lockfree_hits", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_lockfree_hits_stat, RecRawStatSyncSum);
+
   ts_host_res_global_init();
 }
 
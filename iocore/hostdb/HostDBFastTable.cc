@@ -0,0 +1,205 @@
+/** @file
+
+  A table of the HostDB records read without locks
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_HostDB.h"
+#include "P_HostDBFastTable.h"
+
+namespace
+{
+// the reader of this thread, there is a single table in a process
+thread_local void *this_reader = nullptr;
+
+void
+release(HostDBInfo *r)
+{
+  if (r->refcount_dec() == 0) {
+    r->free();
+  }
+}
+} // namespace
+
+HostDBFastTable::HostDBFastTable(size_t capacity)
+{
+  size_t n = PROBES;
+  while (n < capacity) {
+    n <<= 1;
+  }
+  _slots.reset(new std::atomic<HostDBInfo *>[n]);
+  for (size_t i = 0; i < n; i++) {
+    _slots[i] = nullptr;
+  }
+  _mask = n - 1;
+}
+
+HostDBFastTable::~HostDBFastTable()
+{
+  clear();
+  for (Retired &t : _retired) {
+    release(t.r);
+  }
+  for (Reader *reader = _readers; reader;) {
+    Reader *next = reader->next;
+    delete reader;
+    reader = next;
+  }
+}
+
+HostDBFastTable::Reader *
+HostDBFastTable::reader()
+{
+  if (!this_reader) {
+    Reader *r = new Reader;
+    r->next   = _readers.load();
+    while (!_readers.compare_exchange_weak(r->next, r)) {
+    }
+    this_reader = r;
+  }
+  return static_cast<Reader *>(this_reader);
+}
+
+HostDBFastTable::Guard::Guard(HostDBFastTable &table) : _reader(table.reader())
+{
+  // before any slot is read
+  _reader->epoch.store(table._epoch.load());
+}
+
+HostDBFastTable::Guard::~Guard()
+{
+  _reader->epoch.store(0, std::memory_order_release);
+}
+
+Ptr<HostDBInfo>
+HostDBFastTable::get(uint64_t key)
+{
+  Guard guard(*this);
+  for (unsigned i = 0; i < PROBES; i++) {
+    HostDBInfo *r = _slots[slot_of(key, i)].load();
+    if (r && r->key == key) {
+      return make_ptr(r);
+    }
+  }
+  return Ptr<HostDBInfo>();
+}
+
+void
+HostDBFastTable::put(HostDBInfo *r)
+{
+  uint64_t key = r->key;
+  r->refcount_inc();
+  // the writers of a key hold the lock of its partition, only the writers of other keys race for the slots
+  for (unsigned i = 0; i < PROBES; i++) {
+    std::atomic<HostDBInfo *> &slot = _slots[slot_of(key, i)];
+    HostDBInfo *old                 = slot.load();
+    if (old == r) {
+      release(r);
+      return;
+    }
+    while (old && old->key == key) {
+      if (slot.compare_exchange_strong(old, r)) {
+        retire(old);
+        return;
+      }
+    }
+  }
+  for (unsigned i = 0; i < PROBES; i++) {
+    HostDBInfo *empty = nullptr;
+    if (_slots[slot_of(key, i)].compare_exchange_strong(empty, r)) {
+      return;
+    }
+  }
+  // the window is full, the record of another key makes room
+  HostDBInfo *old = _slots[slot_of(key, (key >> 32) % PROBES)].exchange(r);
+  if (old) {
+    retire(old);
+  }
+}
+
+void
+HostDBFastTable::erase(uint64_t key)
+{
+  for (unsigned i = 0; i < PROBES; i++) {
+    std::atomic<HostDBInfo *> &slot = _slots[slot_of(key, i)];
+    HostDBInfo *old                 = slot.load();
+    if (old && old->key == key && slot.compare_exchange_strong(old, nullptr)) {
+      retire(old);
+    }
+  }
+}
+
+void
+HostDBFastTable::clear()
+{
+  for (size_t i = 0; i <= _mask; i++) {
+    HostDBInfo *old = _slots[i].exchange(nullptr);
+    if (old) {
+      retire(old);
+    }
+  }
+}
+
+void
+HostDBFastTable::retire(HostDBInfo *r)
+{
+  // after the record left its slot
+  uint64_t epoch = _epoch.load();
+  std::lock_guard<std::mutex> lock(_retired_lock);
+  _retired.push_back({epoch, r});
+}
+
+size_t
+HostDBFastTable::reclaim()
+{
+  std::vector<Retired> retired;
+  {
+    std::lock_guard<std::mutex> lock(_retired_lock);
+    if (_retired.empty()) {
+      return 0;
+    }
+    retired.swap(_retired);
+  }
+
+  // a lookup that can have a record retired in an epoch started in that epoch or before
+  uint64_t oldest = _epoch.fetch_add(1) + 1;
+  for (Reader *reader = _readers.load(); reader; reader = reader->next) {
+    uint64_t epoch = reader->epoch.load();
+    if (epoch && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+
+  size_t n = 0;
+  std::vector<Retired> kept;
+  for (Retired &t : retired) {
+    if (t.epoch < oldest) {
+      release(t.r);
+      n++;
+    } else {
+      kept.push_back(t);
+    }
+  }
+  if (!kept.empty()) {
+    std::lock_guard<std::mutex> lock(_retired_lock);
+    _retired.insert(_retired.end(), kept.begin(), kept.end());
+  }
+  return n;
+}
@@ -29,6 +29,7 @@
 #include "tscore/ink_align.h"
 #include "tscore/ink_resolver.h"
 #include "I_EventSystem.h"
+#include "I_Coroutine.h"
 #include "SRV.h"
 #include "P_RefCountCache.h"
 
@@ -60,9 +61,14 @@ extern unsigned int hostdb_ip_stale_interval;
 extern unsigned int hostdb_ip_timeout_interval;
 extern unsigned int hostdb_ip_fail_timeout_interval;
 extern unsigned int hostdb_serve_stale_but_revalidate;
+extern unsigned int hostdb_refresh_ahead_hits;
+extern unsigned int hostdb_refresh_ahead_ttl_pct;
+extern unsigned int hostdb_refresh_ahead_rate;
 extern unsigned int hostdb_round_robin_max_count;
 
 extern int hostdb_max_iobuf_index;
+/// The records, by the same size classes as the IOBuffers, apart from them for their memory to be told apart.
+extern Allocator hostDBInfoAllocator[DEFAULT_BUFFER_SIZES];
 
 static inline unsigned int
 makeHostHash(const char *string)
@@ -147,7 +153,7 @@ struct HostDBInfo : public RefCountObj {
     size += sizeof(HostDBInfo);
     int iobuffer_index = iobuffer_size_to_index(size, hostdb_max_iobuf_index);
     ink_release_assert(iobuffer_index >= 0);
-    void *ptr = ioBufAllocator[iobuffer_index].alloc_void();
+    void *ptr = hostDBInfoAllocator[iobuffer_index].alloc_void();
     memset(ptr, 0, size);
     HostDBInfo *ret      = new (ptr) HostDBInfo();
     ret->_iobuffer_index = iobuffer_index;
@@ -159,7 +165,7 @@ struct HostDBInfo : public RefCountObj {
   {
     ink_release_assert(from_alloc());
     Debug("hostdb", "freeing %d bytes at [%p]", (1 << (7 + _iobuffer_index)), this);
-    ioBufAllocator[_iobuffer_index].free_void((void *)(this));
+    hostDBInfoAllocator[_iobuffer_index].free_void((void *)(this));
   }
 
   /// Effectively the @c object_version for cache data.
@@ -242,6 +248,22 @@ struct HostDBInfo : public RefCountObj {
     return ip_timeout_interval >= 2 * hostdb_ip_stale_interval && ip_interval() >= hostdb_ip_stale_interval;
   }
 
+  /// Old enough to be re-resolved before it expires, if it is hot.
+  bool
+  is_ip_refresh_ahead_window() const
+  {
+    uint64_t age = static_cast<uint64_t>(ip_interval()) * 100;
+    return hostdb_refresh_ahead_hits && !reverse_dns &&
+           age >= static_cast<uint64_t>(ip_timeout_interval) * hostdb_refresh_ahead_ttl_pct && !is_ip_timeout();
+  }
+
+  /// Hot enough, with @a hits lookups, and old enough to be re-resolved before it expires.
+  bool
+  is_ip_refresh_ahead(unsigned int hits) const
+  {
+    return hits >= hostdb_refresh_ahead_hits && is_ip_refresh_ahead_window();
+  }
+
   bool
   is_ip_timeout() const
   {
@@ -347,6 +369,8 @@ struct HostDBInfo : public RefCountObj {
 
   unsigned int round_robin : 1;     // This is the root of a round robin block
   unsigned int round_robin_elt : 1; // This is an address in a round robin block
+  unsigned int refreshed_ahead : 1; // Re-resolved before the previous record expired
+  unsigned int fail_count : 4;      // Consecutive failed resolutions of a failed record, for its backoff
 
   HostDBInfo() : _iobuffer_index{-1} {}
 
@@ -549,3 +573,49 @@ void run_HostDBTest();
 extern inkcoreapi HostDBProcessor hostDBProcessor;
 
 void ink_hostdb_init(ts::ModuleVersion version);
+
+#if TS_HAS_COROUTINES
+namespace ts
+{
+/** Await a lookup of @a hostname.
+    The result is the entry, holding a reference so it stays valid after the callback, or empty if
+    the name could not be resolved.
+*/
+class HostDBAwaiter : public Awaiter
+{
+public:
+  HostDBAwaiter(const char *hostname, int len, HostDBProcessor::Options const &opt) : _hostname(hostname), _len(len), _opt(opt) {}
+
+  void
+  start(Continuation *cont) override
+  {
+    hostDBProcessor.getbyname_re(cont, _hostname, _len, _opt);
+  }
+
+  bool
+  accept(int /* event ATS_UNUSED */, void *data) override
+  {
+    _info = Ptr<HostDBInfo>(static_cast<HostDBInfo *>(data));
+    return true;
+  }
+
+  Ptr<HostDBInfo>
+  await_resume()
+  {
+    return std::move(_info);
+  }
+
+private:
+  const char *_hostname;
+  int _len;
+  HostDBProcessor::Options _opt;
+  Ptr<HostDBInfo> _info;
+};
+
+inline HostDBAwaiter
+hostdb_getbyname(const char *hostname, int len, HostDBProcessor::Options const &opt = HostDBProcessor::DEFAULT_OPTIONS)
+{
+  return {hostname, len, opt};
+}
+} // namespace ts
+#endif
@@ -40,6 +40,7 @@
 // HostDB files
 #include "P_DNS.h"
 #include "P_RefCountCache.h"
+#include "P_HostDBFastTable.h"
 #include "P_HostDBProcessor.h"
 
 static constexpr ts::ModuleVersion HOSTDB_MODULE_INTERNAL_VERSION{HOSTDB_MODULE_PUBLIC_VERSION, ts::ModuleVersion::PRIVATE};
@@ -0,0 +1,119 @@
+/** @file
+
+  A table of the HostDB records read without locks
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "tscore/Ptr.h"
+
+struct HostDBInfo;
+
+/**
+  The records of the HostDB cache, mirrored in an open addressing table of atomic pointers
+  so that the lookups of the net threads take no lock. The records are published in the
+  table by the writers of the cache, under the lock of their partition, and looked up in
+  a window of @c PROBES slots from the hash of their key. A record is taken from the table
+  by replacing it, and only released once no lookup started before that runs any more,
+  which epochs tell: a lookup marks its thread with the epoch it started in, a record taken
+  is stamped with the epoch it was taken in and released when every thread in a lookup is
+  in a later epoch.
+
+  The table only has a record while the cache has it, except for the records the cache
+  drops to make room, which are served until they expire or their slot is taken. The
+  lookups check the record returned as they would one of the cache.
+*/
+class HostDBFastTable
+{
+public:
+  /// The slots looked at from the hash of a key.
+  static constexpr unsigned PROBES = 8;
+
+  /// A table of at least @a capacity slots.
+  explicit HostDBFastTable(size_t capacity);
+  ~HostDBFastTable();
+
+  /// @return The record of @a key, without taking a lock.
+  Ptr<HostDBInfo> get(uint64_t key);
+
+  /// Publish @a r, the record of its key, replacing the previous one.
+  void put(HostDBInfo *r);
+
+  /// Take the record of @a key from the table.
+  void erase(uint64_t key);
+
+  /// Take every record from the table.
+  void clear();
+
+  /// Release the records taken that no lookup can have any more, @return how many.
+  size_t reclaim();
+
+private:
+  /// The epoch of a thread in a lookup, 0 if it is not in one.
+  struct Reader {
+    std::atomic<uint64_t> epoch{0};
+    Reader *next = nullptr;
+  };
+
+  struct Retired {
+    uint64_t epoch;
+    HostDBInfo *r;
+  };
+
+public:
+  /** Marks the thread in a lookup while in scope, which @c get does. No record taken from
+      the table meanwhile is released. Guards of a thread do not nest.
+  */
+  class Guard
+  {
+  public:
+    explicit Guard(HostDBFastTable &table);
+    ~Guard();
+
+  private:
+    Reader *_reader;
+  };
+
+private:
+  size_t
+  slot_of(uint64_t key, unsigned i) const
+  {
+    return (key + i) & _mask;
+  }
+
+  Reader *reader();
+  void retire(HostDBInfo *r);
+
+  std::unique_ptr<std::atomic<HostDBInfo *>[]> _slots;
+  size_t _mask = 0;
+
+  std::atomic<uint64_t> _epoch{1};
+  std::atomic<Reader *> _readers{nullptr};
+
+  std::mutex _retired_lock;
+  std::vector<Retired> _retired;
+};
@@ -141,6 +141,10 @@ enum HostDB_Stats {
   hostdb_ttl_expires_stat, // D == TTL Expires
   hostdb_re_dns_on_reload_stat,
   hostdb_insert_duplicate_to_pending_dns_stat,
+  hostdb_refresh_ahead_stat,
+  hostdb_refresh_ahead_throttled_stat,
+  hostdb_refresh_ahead_hits_stat,
+  hostdb_lockfree_hits_stat,
   HostDB_Stat_Count
 };
 
@@ -180,6 +184,8 @@ struct CmpConstBuffferCaseInsensitive {
 // Our own typedef for the host file mapping
 typedef std::map<ts::ConstBuffer, IpAddr, CmpConstBuffferCaseInsensitive> HostsFileMap;
 // A to hold a ref-counted map
+template <class C> class RefCountCacheJournal;
+
 struct RefCountedHostsFileMap : public RefCountObj {
   HostsFileMap hosts_file_map;
   ats_scoped_str HostFileText;
@@ -194,6 +200,19 @@ struct HostDBCache {
   Ptr<RefCountedHostsFileMap> hosts_file_ptr;
   // TODO: make ATS call a close() method or something on shutdown (it does nothing of the sort today)
   RefCountCache<HostDBInfo> *refcountcache = nullptr;
+  /// The failed records, apart so that they cannot evict the others, @c nullptr if they are not.
+  RefCountCache<HostDBInfo> *negative_cache = nullptr;
+  /// The records of @a refcountcache looked up without locks, @c nullptr if disabled.
+  HostDBFastTable *fast_table = nullptr;
+  /// The changes of @a refcountcache since its last snapshot, @c nullptr if not persisted.
+  RefCountCacheJournal<HostDBInfo> *journal = nullptr;
+
+  /// Put @a r in the cache and publish it in the table.
+  void put(HostDBInfo *r, int size);
+  /// Publish @a r, put in the cache before it was filled in, with @a size bytes after it.
+  void publish(HostDBInfo *r, int size);
+  /// Drop the record of @a key from the cache and the table.
+  void erase(uint64_t key);
 
   // TODO configurable number of items in the cache
   Queue<HostDBContinuation, Continuation::Link_link> *pending_dns = nullptr;
@@ -452,6 +471,7 @@ struct HostDBContinuation : public Continuation {
   unsigned int missing : 1;
   unsigned int force_dns : 1;
   unsigned int round_robin : 1;
+  unsigned int refresh_ahead : 1; ///< re-resolving a record that has not expired yet
 
   int probeEvent(int event, Event *e);
   int iterateEvent(int event, Event *e);
@@ -499,7 +519,7 @@ struct HostDBContinuation : public Continuation {
   int make_get_message(char *buf, int len);
   int make_put_message(HostDBInfo *r, Continuation *c, char *buf, int len);
 
-  HostDBContinuation() : missing(false), force_dns(DEFAULT_OPTIONS.force_dns), round_robin(false)
+  HostDBContinuation() : missing(false), force_dns(DEFAULT_OPTIONS.force_dns), round_robin(false), refresh_ahead(false)
   {
     ink_zero(hash_host_name_store);
     ink_zero(hash.hash);
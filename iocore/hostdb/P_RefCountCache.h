@@ -33,6 +33,9 @@
 
 #include "tscore/I_Version.h"
 #include <unistd.h>
+#include <climits>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define REFCOUNT_CACHE_EVENT_SYNC REFCOUNT_CACHE_EVENT_EVENTS_START
 
@@ -79,6 +82,7 @@ public:
   RefCountCacheHashEntry *_prev{nullptr};
   PriorityQueueEntry<RefCountCacheHashEntry *> *expiry_entry = nullptr;
   RefCountCacheItemMeta meta;
+  unsigned int hits = 0; ///< lookups of the item since it was put, not persisted with @a meta
 
   // Need a no-argument constructor to use the classAllocator
   RefCountCacheHashEntry() : item(Ptr<RefCountObj>()), meta(0, 0) {}
@@ -87,6 +91,7 @@ public:
   {
     this->item = make_ptr(i);
     this->meta = RefCountCacheItemMeta(key, size, expire_time);
+    this->hits = 0;
   }
 
   // make these values comparable -- so we can sort them
@@ -155,7 +160,7 @@ public:
   using hash_type = IntrusiveHashMap<RefCountCacheLinkage>;
 
   RefCountCachePartition(unsigned int part_num, uint64_t max_size, unsigned int max_items, RecRawStatBlock *rsb = nullptr);
-  Ptr<C> get(uint64_t key);
+  Ptr<C> get(uint64_t key, unsigned int *hits = nullptr);
   void put(uint64_t key, C *item, int size = 0, int expire_time = 0);
   void erase(uint64_t key, ink_time_t expiry_time = -1);
 
@@ -195,12 +200,18 @@ RefCountCachePartition<C>::RefCountCachePartition(unsigned int part_num, uint64_
 
 template <class C>
 Ptr<C>
-RefCountCachePartition<C>::get(uint64_t key)
+RefCountCachePartition<C>::get(uint64_t key, unsigned int *hits)
 {
   this->metric_inc(refcountcache_total_lookups_stat, 1);
   if (auto it = this->item_map.find(key); it != this->item_map.end()) {
     // found
     this->metric_inc(refcountcache_total_hits_stat, 1);
+    if (it->hits < UINT_MAX) {
+      ++it->hits;
+    }
+    if (hits) {
+      *hits = it->hits;
+    }
     return make_ptr(static_cast<C *>(it->item.get()));
   } else {
     return Ptr<C>();
@@ -401,7 +412,8 @@ public:
   ~RefCountCache();
 
   // User interface to the cache
-  Ptr<C> get(uint64_t key);
+  /// Get the item of @a key, counting the lookup in its @a hits since it was put.
+  Ptr<C> get(uint64_t key, unsigned int *hits = nullptr);
   void put(uint64_t key, C *item, int size = 0, ink_time_t expiry_time = -1);
   void erase(uint64_t key);
   void clear();
@@ -482,9 +494,9 @@ template <class C> RefCountCache<C>::~RefCountCache()
 
 template <class C>
 Ptr<C>
-RefCountCache<C>::get(uint64_t key)
+RefCountCache<C>::get(uint64_t key, unsigned int *hits)
 {
-  return this->partitions[this->partition_for_key(key)]->get(key);
+  return this->partitions[this->partition_for_key(key)]->get(key, hits);
 }
 
 template <class C>
@@ -565,11 +577,13 @@ RefCountCache<C>::clear()
 }
 
 // Fill `cache` with items in file `filepath` using `load_func` to unmarshall the record.
+// An item of size 0 is one erased, as journaled by RefCountCacheJournal. The file is mapped rather than
+// read an item at a time, and `loaded_size`, if set, is the size of the file up to the last complete item.
 // Errors are -1
 template <typename CacheEntryType>
 int
 LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::string &dirname, const std::string &filepath,
-                          CacheEntryType *(*load_func)(char *, unsigned int))
+                          CacheEntryType *(*load_func)(char *, unsigned int), int64_t *loaded_size = nullptr)
 {
   // If we have no load method, then we can't load anything so lets just stop right here
   if (load_func == nullptr) {
@@ -582,39 +596,56 @@ LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::strin
     return -1;
   }
 
-  // read in the header
-  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
-  int read_ret                  = read(fd, (char *)&tmpHeader, sizeof(RefCountCacheHeader));
-  if (read_ret != sizeof(RefCountCacheHeader)) {
+  struct stat st;
+  if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(RefCountCacheHeader)) {
     socketManager.close(fd);
-    Warning("Error reading cache header from disk (expected %ld): %d", sizeof(RefCountCacheHeader), read_ret);
+    Warning("Error reading cache header from disk (expected %ld): %s", sizeof(RefCountCacheHeader), filepath.c_str());
     return -1;
   }
+  size_t file_size = st.st_size;
+  // private and writable, the load function may unmarshall in place
+  char *base = static_cast<char *>(mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+  socketManager.close(fd);
+  if (base == MAP_FAILED) {
+    Warning("Unable to map file %s; [Error]: %s", filepath.c_str(), strerror(errno));
+    return -1;
+  }
+  madvise(base, file_size, MADV_SEQUENTIAL);
+
+  // read in the header
+  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
+  memcpy(static_cast<void *>(&tmpHeader), base, sizeof(RefCountCacheHeader));
   if (!cache.get_header().compatible(&tmpHeader)) {
-    socketManager.close(fd);
+    munmap(base, file_size);
     Warning("Incompatible cache at %s, not loading.", filepath.c_str());
     return -1; // TODO: specific code for incompatible
   }
 
+  ink_time_t now                 = ink_time();
+  size_t offset                  = sizeof(RefCountCacheHeader);
   RefCountCacheItemMeta tmpValue = RefCountCacheItemMeta(0, 0);
-  while (true) { // TODO: better loop
-    read_ret = read(fd, (char *)&tmpValue, sizeof(tmpValue));
-    if (read_ret != sizeof(tmpValue)) {
-      break;
-    }
-    char buf[tmpValue.size];
-    read_ret = read(fd, (char *)&buf, tmpValue.size);
-    if (read_ret != (int)tmpValue.size) {
-      Warning("Encountered error reading item from cache: %d", read_ret);
+  while (offset + sizeof(tmpValue) <= file_size) {
+    memcpy(static_cast<void *>(&tmpValue), base + offset, sizeof(tmpValue));
+    if (tmpValue.size > file_size - offset - sizeof(tmpValue)) {
+      Warning("Encountered truncated item in cache file %s", filepath.c_str());
       break;
     }
+    char *buf = base + offset + sizeof(tmpValue);
+    offset += sizeof(tmpValue) + tmpValue.size;
 
-    CacheEntryType *newItem = load_func((char *)&buf, tmpValue.size);
+    if (tmpValue.size == 0 || (tmpValue.expiry_time >= 0 && tmpValue.expiry_time < now)) {
+      cache.erase(tmpValue.key);
+      continue;
+    }
+    CacheEntryType *newItem = load_func(buf, tmpValue.size);
     if (newItem != nullptr) {
-      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType));
+      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType), tmpValue.expiry_time);
     }
-  };
+  }
 
-  socketManager.close(fd);
+  munmap(base, file_size);
+  if (loaded_size) {
+    *loaded_size = offset;
+  }
   return 0;
 }
@@ -0,0 +1,284 @@
+/** @file
+
+  A journal of the changes of a RefCountCache, appended to between its snapshots
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "P_RefCountCache.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// This continuation appends the items put in a RefCountCache, and the keys erased from it, to a
+// journal file, in the format of the RefCountCacheSerializer snapshot with an erased key written
+// as an item of size 0. The changes are copied when they are made, under the lock of their
+// partition, and written every PERIOD on ET_TASK. Loading the snapshot then the journal gets the
+// cache back, so the snapshot only needs to be written again, compacting the journal, once the
+// journal is larger than it:
+//    - rotate(): the journal is moved aside, a new one started
+//    - the snapshot is written, with every item of the cache
+//    - compacted(): the journal moved aside is now in the snapshot, it is removed
+//
+// Until compacted() the journal moved aside is loaded before the new one, and a rotation while it is
+// still there keeps the current journal, so a failed snapshot loses nothing. Changes that could not
+// be written are dropped whole and make the journal look larger than any snapshot.
+template <class C> class RefCountCacheJournal : public Continuation
+{
+public:
+  static constexpr ink_hrtime PERIOD = HRTIME_SECONDS(1);
+
+  RefCountCacheJournal(RefCountCache<C> *cc, std::string filename);
+  ~RefCountCacheJournal() override;
+
+  // Replay the journals into the cache and open the journal for appending, 0 or -errno
+  int load(C *(*load_func)(char *, unsigned int));
+  // Write the changes every PERIOD
+  void start();
+
+  // Journal the `item` put for `key`, or the `key` erased, the lock of its partition held
+  void put(uint64_t key, C *item, int size, ink_time_t expiry_time);
+  void erase(uint64_t key);
+
+  // Write the changes copied so far, 0 or -errno
+  int flush();
+  // Move the journal aside for a snapshot, 0 or -errno
+  int rotate();
+  // The snapshot was written, the journal moved aside is in it
+  void compacted();
+  // The cache was cleared, only the next snapshot can tell
+  void clear();
+
+  // Bytes in the journals, INT64_MAX if changes were lost since the last snapshot
+  int64_t size() const;
+
+private:
+  int flush_event(int event, Event *e);
+  int open_journal(int64_t valid_size);
+  void append(int part, const RefCountCacheItemMeta &meta, const void *data);
+
+  struct Pending {
+    std::mutex lock;
+    std::string bytes;
+  };
+
+  RefCountCache<C> *cache;
+  std::string filename;
+  std::string old_filename;
+  std::unique_ptr<Pending[]> pending; // per partition
+
+  int fd               = -1;
+  int64_t journal_size = 0;
+  int64_t old_size     = -1;    // -1 if no journal is moved aside
+  bool lost            = false; // changes could not be written, the next snapshot must be
+};
+
+template <class C>
+RefCountCacheJournal<C>::RefCountCacheJournal(RefCountCache<C> *cc, std::string filename)
+  : Continuation(new_ProxyMutex()), cache(cc), filename(std::move(filename)), pending(new Pending[cc->partition_count()])
+{
+  this->old_filename = this->filename + ".old";
+  SET_HANDLER(&RefCountCacheJournal::flush_event);
+}
+
+template <class C> RefCountCacheJournal<C>::~RefCountCacheJournal()
+{
+  if (this->fd != -1) {
+    socketManager.close(this->fd);
+  }
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::load(C *(*load_func)(char *, unsigned int))
+{
+  int64_t valid_size = 0;
+  if (access(this->old_filename.c_str(), F_OK) == 0 &&
+      LoadRefCountCacheFromPath<C>(*this->cache, "", this->old_filename, load_func, &this->old_size) != 0) {
+    this->old_size = -1;
+  }
+  if (access(this->filename.c_str(), F_OK) == 0 &&
+      LoadRefCountCacheFromPath<C>(*this->cache, "", this->filename, load_func, &valid_size) != 0) {
+    valid_size = 0;
+  }
+  return this->open_journal(valid_size);
+}
+
+// Open the journal, appending after its `valid_size` first bytes, creating it if there are none
+template <class C>
+int
+RefCountCacheJournal<C>::open_journal(int64_t valid_size)
+{
+  this->fd = socketManager.open(this->filename.c_str(), O_RDWR | O_CREAT, 0644);
+  if (this->fd < 0) {
+    int error = -errno;
+    Warning("Unable to open journal %s: %s", this->filename.c_str(), strerror(errno));
+    this->fd = -1;
+    return error;
+  }
+  // drop an item torn by a crash, the items appended after it would be lost
+  if (ftruncate(this->fd, valid_size) < 0 || lseek(this->fd, valid_size, SEEK_SET) < 0) {
+    return -errno;
+  }
+  this->journal_size = valid_size;
+  if (valid_size == 0) {
+    const RefCountCacheHeader &header = this->cache->get_header();
+    if (socketManager.write(this->fd, (char *)&header, sizeof(header)) != sizeof(header)) {
+      return -EIO;
+    }
+    this->journal_size = sizeof(header);
+  }
+  return 0;
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::start()
+{
+  eventProcessor.schedule_every(this, PERIOD, ET_TASK);
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::append(int part, const RefCountCacheItemMeta &meta, const void *data)
+{
+  Pending &p = this->pending[part];
+  std::lock_guard<std::mutex> lock(p.lock);
+  p.bytes.append(reinterpret_cast<const char *>(&meta), sizeof(meta));
+  p.bytes.append(static_cast<const char *>(data), meta.size);
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::put(uint64_t key, C *item, int size, ink_time_t expiry_time)
+{
+  // as RefCountCachePartition::put() accounts for it, which the snapshot writes
+  RefCountCacheItemMeta meta(key, size + sizeof(C), expiry_time);
+  this->append(this->cache->partition_for_key(key), meta, item);
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::erase(uint64_t key)
+{
+  RefCountCacheItemMeta meta(key, 0, 0);
+  this->append(this->cache->partition_for_key(key), meta, nullptr);
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::flush()
+{
+  int error = 0;
+  std::string bytes;
+  for (size_t i = 0; i < this->cache->partition_count(); i++) {
+    {
+      std::lock_guard<std::mutex> lock(this->pending[i].lock);
+      bytes.swap(this->pending[i].bytes);
+    }
+    size_t written = 0;
+    while (this->fd != -1 && error == 0 && written < bytes.size()) {
+      int ret = socketManager.write(this->fd, bytes.data() + written, bytes.size() - written);
+      if (ret <= 0) {
+        error = ret < 0 ? ret : -EIO;
+        // an item torn in the middle of the journal would hide the ones after it
+        if (ftruncate(this->fd, this->journal_size) < 0 || lseek(this->fd, this->journal_size, SEEK_SET) < 0) {
+          socketManager.close(this->fd);
+          this->fd = -1;
+        }
+      } else {
+        written += ret;
+      }
+    }
+    if (this->fd == -1 || error != 0) {
+      this->lost = this->lost || !bytes.empty();
+    } else {
+      this->journal_size += bytes.size();
+    }
+    bytes.clear();
+  }
+  return this->fd == -1 ? -EBADF : error;
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::flush_event(int /* event */, Event * /* e */)
+{
+  int error = this->flush();
+  if (error != 0 && error != -EBADF) {
+    // the next snapshot writes what was lost
+    Warning("Error writing journal %s: %s", this->filename.c_str(), strerror(-error));
+  }
+  return EVENT_CONT;
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::rotate()
+{
+  if (this->old_size >= 0) {
+    // the last snapshot failed, what is moved aside is not in any yet
+    return 0;
+  }
+  if (this->fd != -1) {
+    socketManager.close(this->fd);
+    this->fd = -1;
+  }
+  if (rename(this->filename.c_str(), this->old_filename.c_str()) != 0) {
+    int error = -errno;
+    this->open_journal(this->journal_size);
+    return error;
+  }
+  this->old_size = this->journal_size;
+  return this->open_journal(0);
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::compacted()
+{
+  if (this->old_size >= 0) {
+    unlink(this->old_filename.c_str());
+    this->old_size = -1;
+  }
+  this->lost = false;
+}
+
+template <class C>
+void
+RefCountCacheJournal<C>::clear()
+{
+  for (size_t i = 0; i < this->cache->partition_count(); i++) {
+    std::lock_guard<std::mutex> lock(this->pending[i].lock);
+    this->pending[i].bytes.clear();
+  }
+  this->lost = true;
+}
+
+template <class C>
+int64_t
+RefCountCacheJournal<C>::size() const
+{
+  return this->lost ? INT64_MAX : this->journal_size + std::max<int64_t>(this->old_size, 0);
+}
@@ -74,6 +74,7 @@ private:
 
   int total_items;
   int64_t total_size;
+  bool synced = false; // the file was written and moved in place
 
   RecRawStatBlock *rsb;
 };
@@ -119,8 +120,9 @@ template <class C> RefCountCacheSerializer<C>::~RefCountCacheSerializer()
   // Note that we have to do the unlink before we send the completion event, otherwise
   // we could unlink the sync file out from under another serializer.
 
-  // Schedule off the REFCOUNT event, so the continuation gets properly locked
-  this_ethread()->schedule_imm(cont, REFCOUNT_CACHE_EVENT_SYNC);
+  // Schedule off the REFCOUNT event, so the continuation gets properly locked, with a non null cookie
+  // if the cache was synced
+  this_ethread()->schedule_imm(cont, REFCOUNT_CACHE_EVENT_SYNC, this->synced ? cont : nullptr);
 }
 
 template <class C>
@@ -296,7 +298,8 @@ RefCountCacheSerializer<C>::finalize_sync()
   // this point anyway.
   socketManager.close(dirfd);
   socketManager.close(this->fd);
-  this->fd = -1;
+  this->fd     = -1;
+  this->synced = true;
 
   if (this->rsb) {
     RecSetRawStatCount(this->rsb, refcountcache_last_sync_time, Thread::get_hrtime() / HRTIME_SECOND);
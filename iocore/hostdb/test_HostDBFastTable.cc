@@ -0,0 +1,248 @@
+/** @file
+
+  Catch based unit tests for the lock free table of the HostDB records
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "P_HostDB.h"
+#include "P_HostDBFastTable.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+// Normally from HostDB.cc, which this test does not link.
+int hostdb_max_iobuf_index = BUFFER_SIZE_INDEX_32K;
+Allocator hostDBInfoAllocator[DEFAULT_BUFFER_SIZES];
+
+namespace
+{
+// There is a single table in a process, its slots are one probe window.
+HostDBFastTable &
+table()
+{
+  static HostDBFastTable t(HostDBFastTable::PROBES);
+  return t;
+}
+
+/// A record of @a key, with a reference of the test.
+HostDBInfo *
+record(uint64_t key)
+{
+  HostDBInfo *r = HostDBInfo::alloc();
+  r->key        = key;
+  r->refcount_inc();
+  return r;
+}
+
+/// Drop the reference of the test to @a r.
+void
+release(HostDBInfo *r)
+{
+  if (r->refcount_dec() == 0) {
+    r->free();
+  }
+}
+
+void
+empty_table()
+{
+  table().clear();
+  table().reclaim();
+}
+} // namespace
+
+TEST_CASE("HostDBFastTable", "[hostdb]")
+{
+  HostDBFastTable &t = table();
+  empty_table();
+
+  SECTION("put, replace and erase")
+  {
+    HostDBInfo *r1 = record(1);
+    HostDBInfo *r2 = record(1);
+
+    REQUIRE(t.get(1).get() == nullptr);
+    t.put(r1);
+    REQUIRE(t.get(1).get() == r1);
+    REQUIRE(r1->refcount() == 2);
+
+    // Publishing the same record again changes nothing.
+    t.put(r1);
+    REQUIRE(r1->refcount() == 2);
+
+    // The record replaced stays referenced by the table until reclaimed.
+    t.put(r2);
+    REQUIRE(t.get(1).get() == r2);
+    REQUIRE(r1->refcount() == 2);
+    REQUIRE(t.reclaim() == 1);
+    REQUIRE(r1->refcount() == 1);
+
+    t.erase(1);
+    REQUIRE(t.get(1).get() == nullptr);
+    REQUIRE(t.reclaim() == 1);
+    REQUIRE(r2->refcount() == 1);
+    REQUIRE(t.reclaim() == 0);
+
+    release(r1);
+    release(r2);
+  }
+
+  SECTION("a record taken while a lookup runs is kept until it is done")
+  {
+    HostDBInfo *r = record(2);
+    t.put(r);
+
+    std::mutex m;
+    std::condition_variable cv;
+    bool in_lookup = false;
+    bool done      = false;
+
+    std::thread reader([&]() {
+      HostDBFastTable::Guard guard(t);
+      std::unique_lock<std::mutex> lock(m);
+      in_lookup = true;
+      cv.notify_all();
+      cv.wait(lock, [&] { return done; });
+    });
+
+    {
+      std::unique_lock<std::mutex> lock(m);
+      cv.wait(lock, [&] { return in_lookup; });
+    }
+    t.erase(2);
+    REQUIRE(t.reclaim() == 0);
+    REQUIRE(t.reclaim() == 0);
+    REQUIRE(r->refcount() == 2);
+
+    {
+      std::lock_guard<std::mutex> lock(m);
+      done = true;
+    }
+    cv.notify_all();
+    reader.join();
+
+    REQUIRE(t.reclaim() == 1);
+    REQUIRE(r->refcount() == 1);
+    release(r);
+  }
+
+  SECTION("a full probe window makes room")
+  {
+    std::vector<HostDBInfo *> records;
+    for (uint64_t key = 0; key < HostDBFastTable::PROBES; ++key) {
+      records.push_back(record(key));
+      t.put(records.back());
+    }
+    for (uint64_t key = 0; key < HostDBFastTable::PROBES; ++key) {
+      REQUIRE(t.get(key).get() == records[key]);
+    }
+
+    HostDBInfo *extra = record(HostDBFastTable::PROBES);
+    t.put(extra);
+    REQUIRE(t.get(HostDBFastTable::PROBES).get() == extra);
+    int missing = 0;
+    for (uint64_t key = 0; key < HostDBFastTable::PROBES; ++key) {
+      if (t.get(key).get() == nullptr) {
+        ++missing;
+      }
+    }
+    REQUIRE(missing == 1);
+    REQUIRE(t.reclaim() == 1);
+
+    empty_table();
+    for (HostDBInfo *r : records) {
+      REQUIRE(r->refcount() == 1);
+      release(r);
+    }
+    release(extra);
+  }
+
+  SECTION("lookups run concurrently with the writes and reclaims")
+  {
+    constexpr int N_READERS = 4;
+    constexpr int N_WRITES  = 20000;
+    std::atomic<bool> writing{true};
+    std::atomic<int> wrong{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < N_READERS; ++i) {
+      readers.emplace_back([&]() {
+        while (writing) {
+          for (uint64_t key = 0; key < 2 * HostDBFastTable::PROBES; ++key) {
+            Ptr<HostDBInfo> r = t.get(key);
+            // A record released under a lookup would be back in the freelist, soon the record of another key.
+            if (r && r->key != key) {
+              ++wrong;
+            }
+          }
+        }
+      });
+    }
+
+    for (int i = 0; i < N_WRITES; ++i) {
+      uint64_t key  = i % (2 * HostDBFastTable::PROBES);
+      HostDBInfo *r = HostDBInfo::alloc();
+      r->key        = key;
+      if (i % 3 == 0) {
+        t.erase(key);
+      } else {
+        t.put(r);
+      }
+      if (i % 16 == 0) {
+        t.reclaim();
+      }
+      if (r->refcount() == 0) {
+        r->free(); // not put
+      }
+    }
+    writing = false;
+    for (auto &th : readers) {
+      th.join();
+    }
+    empty_table();
+    REQUIRE(wrong == 0);
+  }
+}
+
+struct HostDBFastTableListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+
+    for (int i = 0; i < DEFAULT_BUFFER_SIZES; i++) {
+      hostDBInfoAllocator[i].re_init("hostDBInfoAllocator", DEFAULT_BUFFER_BASE_SIZE * (static_cast<int64_t>(1) << i), 16, 16, 0);
+    }
+  }
+};
+
+CATCH_REGISTER_LISTENER(HostDBFastTableListener);
@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <RefCountCache.cc>
+#include <P_RefCountCacheJournal.h>
 #include <I_EventSystem.h>
 #include "tscore/I_Layout.h"
 #include <diags.i>
@@ -197,6 +198,95 @@ testclear()
   return ret;
 }
 
+int
+testhits()
+{
+  int ret           = 0;
+  unsigned int hits = 0;
+
+  RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(4);
+
+  // Every lookup of an item counts, until it is put again
+  cache->put(1, ExampleStruct::alloc());
+  cache->get(1);
+  cache->get(1, &hits);
+  ret |= hits != 2;
+  cache->put(1, ExampleStruct::alloc());
+  cache->get(1, &hits);
+  ret |= hits != 1;
+
+  // A missing item leaves the count alone
+  ret |= cache->get(2, &hits).get() != nullptr;
+  ret |= hits != 1;
+
+  delete cache;
+
+  return ret;
+}
+
+int
+testjournal()
+{
+  int ret          = 0;
+  std::string path = "/tmp/hostdb_cache_journal";
+  unlink(path.c_str());
+  unlink((path + ".old").c_str());
+
+  RefCountCache<ExampleStruct> *cache           = new RefCountCache<ExampleStruct>(4);
+  RefCountCacheJournal<ExampleStruct> *journal = new RefCountCacheJournal<ExampleStruct>(cache, path);
+  ret |= journal->load(ExampleStruct::unmarshall) != 0;
+  for (int i = 0; i < 10; i++) {
+    ExampleStruct *tmp = ExampleStruct::alloc();
+    tmp->idx           = i;
+    cache->put(i, tmp);
+    journal->put(i, tmp, 0, -1);
+  }
+  cache->erase(3);
+  journal->erase(3);
+  ret |= journal->flush() != 0;
+
+  // The journal moved aside is loaded before the new one
+  ret |= journal->rotate() != 0;
+  ExampleStruct *tmp = ExampleStruct::alloc();
+  tmp->idx           = 42;
+  cache->put(4, tmp);
+  journal->put(4, tmp, 0, -1);
+  ret |= journal->flush() != 0;
+  delete journal;
+
+  RefCountCache<ExampleStruct> *loaded = new RefCountCache<ExampleStruct>(4);
+  journal                              = new RefCountCacheJournal<ExampleStruct>(loaded, path);
+  ret |= journal->load(ExampleStruct::unmarshall) != 0;
+  ret |= loaded->count() != 9;
+  ret |= loaded->get(3).get() != nullptr;
+  ret |= loaded->get(4).get() == nullptr || loaded->get(4)->idx != 42;
+  ret |= loaded->get(5).get() == nullptr || loaded->get(5)->idx != 5;
+  int64_t size = journal->size();
+  delete journal;
+  delete loaded;
+
+  // An item torn at the end of the journal is dropped
+  FILE *out = fopen(path.c_str(), "a");
+  fwrite("torn", 4, 1, out);
+  fclose(out);
+  loaded  = new RefCountCache<ExampleStruct>(4);
+  journal = new RefCountCacheJournal<ExampleStruct>(loaded, path);
+  ret |= journal->load(ExampleStruct::unmarshall) != 0;
+  ret |= loaded->count() != 9;
+  ret |= journal->size() != size;
+
+  // Compacted, the journal moved aside is gone
+  journal->compacted();
+  ret |= access((path + ".old").c_str(), F_OK) == 0;
+
+  delete journal;
+  delete loaded;
+  delete cache;
+  unlink(path.c_str());
+
+  return ret;
+}
+
 int
 test()
 {
@@ -215,6 +305,14 @@ test()
   ret |= testRefcounting();
   printf("refcount ret %d\n", ret);
 
+  printf("Testing hits\n");
+  ret |= testhits();
+  printf("hits ret %d\n", ret);
+
+  printf("Testing journal\n");
+  ret |= testjournal();
+  printf("journal ret %d\n", ret);
+
   // Initialize our cache
   int cachePartitions                 = 4;
   RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(cachePartitions);
@@ -0,0 +1,144 @@
+/** @file
+
+  Rate limit of new inbound connections per client address.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "AcceptRateLimiter.h"
+
+#include <algorithm>
+
+AcceptRateLimiter accept_rate_limiter;
+
+namespace
+{
+/// Mask of the leading @a bits of a 64 bit value.
+uint64_t
+prefix_mask(int bits)
+{
+  return bits <= 0 ? 0 : bits >= 64 ? ~uint64_t(0) : ~uint64_t(0) << (64 - bits);
+}
+
+uint64_t
+hash_key(uint64_t hi, uint64_t lo)
+{
+  uint64_t h = hi * 0x9e3779b97f4a7c15ULL ^ lo;
+  h ^= h >> 32;
+  h *= 0xd6e8feb86659fd93ULL;
+  h ^= h >> 32;
+  return h;
+}
+} // namespace
+
+AcceptRateLimiter::~AcceptRateLimiter()
+{
+  if (_initialized) {
+    for (auto &shard : _shards) {
+      ink_mutex_destroy(&shard.mutex);
+    }
+  }
+}
+
+void
+AcceptRateLimiter::configure(double rate, double burst, int ipv4_prefix, int ipv6_prefix, int capacity)
+{
+  if (!_initialized) {
+    for (auto &shard : _shards) {
+      ink_mutex_init(&shard.mutex);
+    }
+    _initialized = true;
+  }
+
+  _rate  = rate > 0 ? rate / HRTIME_SECOND : 0;
+  _burst = std::max(burst, 1.0);
+
+  ipv4_prefix   = std::clamp(ipv4_prefix, 0, 32);
+  ipv6_prefix   = std::clamp(ipv6_prefix, 0, 128);
+  _ipv4_mask    = 0xffffffff00000000ULL | prefix_mask(ipv4_prefix) >> 32;
+  _ipv6_mask_hi = prefix_mask(ipv6_prefix);
+  _ipv6_mask_lo = prefix_mask(ipv6_prefix - 64);
+
+  uint32_t n = 1;
+  while (n < static_cast<uint32_t>(std::max(capacity / N_SHARDS, N_PROBES))) {
+    n <<= 1;
+  }
+  _shard_mask = n - 1;
+  for (auto &shard : _shards) {
+    shard.buckets.reset(_rate > 0 ? new Bucket[n] : nullptr);
+  }
+}
+
+AcceptRateLimiter::Key
+AcceptRateLimiter::key_of(sockaddr const *addr) const
+{
+  Key key;
+  if (ats_is_ip4(addr)) {
+    key.lo = (uint64_t(0xffff) << 32 | ntohl(ats_ip4_addr_cast(addr))) & _ipv4_mask;
+  } else {
+    uint8_t const *b = ats_ip_addr8_cast(addr);
+    for (int i = 0; i < 8; ++i) {
+      key.hi = key.hi << 8 | b[i];
+      key.lo = key.lo << 8 | b[i + 8];
+    }
+    key.hi &= _ipv6_mask_hi;
+    key.lo &= _ipv6_mask_lo;
+  }
+  return key;
+}
+
+bool
+AcceptRateLimiter::admit(sockaddr const *addr, ink_hrtime now)
+{
+  if (_rate <= 0 || !ats_is_ip(addr)) {
+    return true;
+  }
+
+  Key key     = this->key_of(addr);
+  uint64_t h  = hash_key(key.hi, key.lo);
+  Shard &s    = _shards[h % N_SHARDS];
+  uint32_t i  = static_cast<uint32_t>(h / N_SHARDS);
+  Bucket *lru = nullptr;
+
+  ink_scoped_mutex_lock lock(s.mutex);
+  for (int probe = 0; probe < N_PROBES; ++probe) {
+    Bucket &b = s.buckets[(i + probe) & _shard_mask];
+    if (b.last != 0 && b.key == key) {
+      if (now > b.last) {
+        b.tokens = std::min(_burst, b.tokens + static_cast<double>(now - b.last) * _rate);
+        b.last   = now;
+      }
+      if (b.tokens < 1) {
+        return false;
+      }
+      b.tokens -= 1;
+      return true;
+    }
+    // An unused slot is the least recently used. A bucket that is full again is older than any
+    // that is not, so this always takes one of those before dropping a bucket still in use.
+    if (lru == nullptr || b.last < lru->last) {
+      lru = &b;
+    }
+  }
+  // First connection of this prefix, or its bucket was dropped.
+  lru->key    = key;
+  lru->last   = now;
+  lru->tokens = _burst - 1;
+  return true;
+}
@@ -0,0 +1,107 @@
+/** @file
+
+  Rate limit of new inbound connections per client address.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Each client prefix has a token bucket that fills at the configured rate up to the burst, an
+  accepted connection takes a token. The buckets are in a fixed size open addressing table split in
+  shards with a lock each, so that the accept path neither allocates nor contends much. A bucket
+  that would be full again is as good as no bucket, so its slot is reused for another prefix. If
+  the table is full the least recently used bucket of the probed slots is dropped, which lets that
+  prefix start over with a full bucket.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "tscore/ink_hrtime.h"
+#include "tscore/ink_inet.h"
+#include "tscore/ink_mutex.h"
+
+class AcceptRateLimiter
+{
+public:
+  static constexpr int N_SHARDS = 64; ///< Number of independently locked parts of the table.
+  static constexpr int N_PROBES = 8;  ///< Slots looked at for a prefix.
+
+  AcceptRateLimiter() = default;
+  ~AcceptRateLimiter();
+
+  /** Set the limit, dropping all buckets.
+      @param rate Connections per second of a client prefix, 0 to not limit.
+      @param burst Connections a client prefix can make at once.
+      @param ipv4_prefix Number of leading bits of an IPv4 address that make the client prefix.
+      @param ipv6_prefix Number of leading bits of an IPv6 address that make the client prefix.
+      @param capacity Number of client prefixes tracked, rounded up to a power of two per shard.
+      This must not be called while connections are accepted.
+  */
+  void configure(double rate, double burst, int ipv4_prefix, int ipv6_prefix, int capacity);
+
+  bool
+  is_enabled() const
+  {
+    return _rate > 0;
+  }
+
+  /// Take a token for a new connection from @a addr at @a now, return @c false if there is none.
+  bool admit(sockaddr const *addr, ink_hrtime now);
+
+private:
+  struct Key {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool
+    operator==(Key const &that) const
+    {
+      return hi == that.hi && lo == that.lo;
+    }
+  };
+
+  struct Bucket {
+    Key key;
+    ink_hrtime last = 0; ///< Time of the last refill, 0 if the slot is unused.
+    double tokens   = 0;
+  };
+
+  struct alignas(64) Shard {
+    ink_mutex mutex;
+    std::unique_ptr<Bucket[]> buckets;
+  };
+
+  /// Client prefix of @a addr, IPv4 addresses as their IPv4 mapped IPv6 address.
+  Key key_of(sockaddr const *addr) const;
+
+  double _rate           = 0; ///< Tokens per nanosecond.
+  double _burst          = 0;
+  uint64_t _ipv4_mask    = 0;
+  uint64_t _ipv6_mask_hi = 0;
+  uint64_t _ipv6_mask_lo = 0;
+  uint32_t _shard_mask   = 0; ///< Number of buckets of a shard less one.
+  Shard _shards[N_SHARDS];
+  bool _initialized = false;
+};
+
+/// The limit of the inbound connections, see @c proxy.config.net.per_client.accept_rate.
+extern AcceptRateLimiter accept_rate_limiter;
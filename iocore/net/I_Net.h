@@ -56,6 +56,10 @@ static constexpr int NO_FD = -1;
 
 // All in milli-seconds
 extern int net_config_poll_timeout;
+extern int net_config_poll_backend;
+extern int net_config_busy_poll_usec;         // In micro-seconds
+extern int net_config_sock_busy_poll_usec_in; // In micro-seconds
+extern int net_config_zerocopy_min_block_size;
 extern int net_event_period;
 extern int net_accept_period;
 extern int net_retry_delay;
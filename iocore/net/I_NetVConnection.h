@@ -35,6 +35,7 @@
 #include "tscore/List.h"
 #include "I_IOBuffer.h"
 #include "I_Socks.h"
+#include "I_TcpInfo.h"
 #include "ts/apidefs.h"
 #include "YamlSNIConfig.h"
 #include "tscpp/util/TextView.h"
@@ -621,6 +622,34 @@ public:
    */
   virtual void trapWriteBufferEmpty(int event = VC_EVENT_WRITE_READY);
 
+  /** Move the data read from @a producer to this connection without copying it through user space.
+
+      The read VIO of @a producer and the write VIO of this connection keep their meaning, the
+      bytes read show up only as progress of the VIOs and never in the read buffer. The write
+      VIO sends what is in its buffer first. The coupling lasts until the read of @a producer is
+      complete or either connection is closed.
+
+      @return @c true if set up, @c false if either connection does not support it.
+   */
+  virtual bool
+  splice_from(NetVConnection * /* producer ATS_UNUSED */)
+  {
+    return false;
+  }
+
+  /** The last sample of the TCP_INFO of the connection, @c nullptr if there is none.
+
+      The first call samples it, the NetHandler of the connection then refreshes it every
+      @c proxy.config.net.tcp_info.interval with those of the other connections asked for, for as
+      long as the connection is open. Only the thread of the connection may call this, the sample
+      is valid until the connection is closed.
+   */
+  virtual const TcpInfo *
+  get_tcp_info()
+  {
+    return nullptr;
+  }
+
   /** Returns local sockaddr storage. */
   sockaddr const *get_local_addr();
 
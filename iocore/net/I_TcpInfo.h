@@ -0,0 +1,53 @@
+/** @file
+
+  Samples of the TCP_INFO of a connection
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/socket.h>
+#include "tscore/ink_hrtime.h"
+
+/**
+  What the kernel reports of a TCP connection, as of @a sampled_at, see @c NetVConnection::get_tcp_info.
+
+  This header does not include the platform definition of @c struct @c tcp_info, which @c linux/tcp.h
+  and @c netinet/tcp.h both have. The fields the core uses are copied out of it, the struct itself
+  is kept as the kernel filled it for the plugins, which include the one they like.
+*/
+struct TcpInfo {
+  /// Room for the @c struct @c tcp_info of the kernel, which grows with its versions.
+  static constexpr socklen_t RAW_SIZE = 256;
+
+  ink_hrtime sampled_at  = 0; ///< 0 if the last sample failed
+  ink_hrtime rtt         = 0; ///< Smoothed round trip time
+  ink_hrtime rtt_var     = 0; ///< Its mean deviation
+  uint32_t snd_cwnd      = 0; ///< Congestion window, in segments
+  uint32_t snd_mss       = 0;
+  uint32_t total_retrans = 0;
+  uint64_t delivery_rate = 0; ///< Bytes per second, 0 if the platform does not report it
+
+  alignas(8) unsigned char raw[RAW_SIZE]; ///< The @c struct @c tcp_info, @a raw_len bytes of it
+  socklen_t raw_len = 0;
+
+  /// Sample the TCP_INFO of @a fd at @a now. Returns false if the platform has no TCP_INFO or the call failed.
+  bool sample(int fd, ink_hrtime now);
+};
@@ -29,16 +29,21 @@
 ************************************************************************/
 
 #include "P_Net.h"
+#include "AcceptRateLimiter.h"
 #include <utility>
 
 RecRawStatBlock *net_rsb = nullptr;
 
 // All in milli-seconds
-int net_config_poll_timeout = -1; // This will get set via either command line or records.config.
-int net_event_period        = 10;
-int net_accept_period       = 10;
-int net_retry_delay         = 10;
-int net_throttle_delay      = 50; /* milliseconds */
+int net_config_poll_timeout            = -1; // This will get set via either command line or records.config.
+int net_config_poll_backend            = 0;  // PollBackend, see P_UnixPollDescriptor.h
+int net_config_busy_poll_usec          = 0;
+int net_config_sock_busy_poll_usec_in  = 0;
+int net_config_zerocopy_min_block_size = 0;
+int net_event_period                   = 10;
+int net_accept_period                  = 10;
+int net_retry_delay                    = 10;
+int net_throttle_delay                 = 50; /* milliseconds */
 
 // For the in/out congestion control: ToDo: this probably would be better as ports: specifications
 std::string_view net_ccp_in;
@@ -56,6 +61,18 @@ configure_net()
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
   REC_ReadConfigInteger(net_accept_period, "proxy.config.net.accept_period");
+  REC_ReadConfigInteger(net_config_poll_backend, "proxy.config.net.poll_backend");
+  REC_ReadConfigInteger(net_config_busy_poll_usec, "proxy.config.net.busy_poll_usec");
+  REC_ReadConfigInteger(net_config_sock_busy_poll_usec_in, "proxy.config.net.sock_busy_poll_usec_in");
+  REC_ReadConfigInteger(net_config_zerocopy_min_block_size, "proxy.config.net.zerocopy_min_block_size");
+
+  int accept_rate = 0, accept_burst = 0, ipv4_prefix = 32, ipv6_prefix = 64, table_size = 0;
+  REC_ReadConfigInteger(accept_rate, "proxy.config.net.per_client.accept_rate");
+  REC_ReadConfigInteger(accept_burst, "proxy.config.net.per_client.accept_burst");
+  REC_ReadConfigInteger(ipv4_prefix, "proxy.config.net.per_client.ipv4_prefix_length");
+  REC_ReadConfigInteger(ipv6_prefix, "proxy.config.net.per_client.ipv6_prefix_length");
+  REC_ReadConfigInteger(table_size, "proxy.config.net.per_client.table_size");
+  accept_rate_limiter.configure(accept_rate, accept_burst, ipv4_prefix, ipv6_prefix, table_size);
 
   // This is kinda fugly, but better than it was before (on every connection in and out)
   // Note that these would need to be ats_free()'d if we ever want to clean that up, but
@@ -95,6 +112,14 @@ register_net_stats()
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
+    {"proxy.process.net.keep_alive_evictions.connections", net_keep_alive_evicted_connections_stat},
+    {"proxy.process.net.keep_alive_evictions.memory", net_keep_alive_evicted_memory_stat},
+    {"proxy.process.net.active_queue_evictions.timeout", net_active_queue_evicted_timeout_stat},
+    {"proxy.process.net.busy_poll.hits", net_busy_poll_hits_stat},
+    {"proxy.process.net.busy_poll.misses", net_busy_poll_misses_stat},
+    {"proxy.process.net.zerocopy.writes", net_zerocopy_writes_stat},
+    {"proxy.process.net.zerocopy.copied", net_zerocopy_copied_stat},
+    {"proxy.process.net.tcp_info.samples", net_tcp_info_samples_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
     {"proxy.process.socks.connections_unsuccessful", socks_connections_unsuccessful_stat},
   };
@@ -142,6 +167,8 @@ register_net_stats()
                      (int)net_connections_throttled_in_stat, RecRawStatSyncSum);
   RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.net.connections_throttled_out", RECD_INT, RECP_PERSISTENT,
                      (int)net_connections_throttled_out_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.net.connections_rate_limited_in", RECD_INT, RECP_PERSISTENT,
+                     (int)net_connections_rate_limited_in_stat, RecRawStatSyncSum);
   RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.net.max.requests_throttled_in", RECD_INT, RECP_PERSISTENT,
                      (int)net_requests_max_throttled_in_stat, RecRawStatSyncSum);
 }
@@ -60,6 +60,12 @@ public:
   virtual Ptr<ProxyMutex> &get_mutex()   = 0;
   virtual ContFlags &get_control_flags() = 0;
 
+  // Sample the TCP_INFO again, for the NetEvents of NetHandler::tcp_info_list.
+  virtual void
+  sample_tcp_info(ink_hrtime /* now ATS_UNUSED */)
+  {
+  }
+
   EventIO ep{};
   NetState read{};
   NetState write{};
@@ -73,16 +79,22 @@ public:
   ink_hrtime next_activity_timeout_at   = 0;
   ink_hrtime submit_time                = 0;
 
+  ink_hrtime queued_at        = 0;  ///< When this was last put in the keep-alive or active queue.
+  int64_t queued_bytes        = 0;  ///< Buffer memory held when this was put in the queue.
+  ink_hrtime timeout_check_at = 0;  ///< When the InactivityCop looks at this next.
+  int timeout_tag             = -1; ///< Position in NetHandler::timeout_wheel, negative if not in it.
+
   bool default_inactivity_timeout = false;
 
   LINK(NetEvent, open_link);
-  LINK(NetEvent, cop_link);
+  LINK(NetEvent, timeout_link);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
   SLINKM(NetEvent, write, enable_link)
   LINK(NetEvent, keep_alive_queue_link);
   LINK(NetEvent, active_queue_link);
+  LINK(NetEvent, tcp_info_link);
 
   union {
     unsigned int flags = 0;
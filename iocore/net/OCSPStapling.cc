@@ -22,13 +22,25 @@
 #include "P_OCSPStapling.h"
 #if TS_USE_TLS_OCSP
 
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <openssl/bio.h>
 #include <openssl/ssl.h>
 #include <openssl/ocsp.h>
 #include "P_Net.h"
+#include "P_HostDB.h"
 #include "P_SSLConfig.h"
 #include "P_SSLUtils.h"
 #include "SSLStats.h"
+#include "HTTP.h"
+#include "tscore/I_Layout.h"
+#include "tscore/ink_rand.h"
 
 // Maximum OCSP stapling response size.
 // This should be the response for a single certificate and will typically include the responder certificate chain,
@@ -47,6 +59,8 @@ struct certinfo {
   bool is_prefetched;
   bool is_expire;
   time_t expire_time;
+  time_t refresh_time; // When the response is due for a refresh, before it expires
+  bool is_refreshing;  // Queued or in flight, only the refresher threads access it
 };
 
 /*
@@ -143,8 +157,36 @@ end:
   return issuer;
 }
 
+// When to refresh a response fetched at @a fetched: between half and three quarters of its lifetime, that is the cache
+// timeout or the time to the nextUpdate of the response if it comes first. The jitter spreads the refreshes of the
+// certificates loaded at once over the period, the staple is refreshed before it expires.
+static time_t
+stapling_refresh_time(OCSP_RESPONSE *rsp, certinfo *cinf, time_t fetched)
+{
+  static thread_local InkRand rand(ink_get_hrtime_internal() ^ reinterpret_cast<uintptr_t>(&rand));
+
+  time_t now      = time(nullptr);
+  time_t lifetime = SSLConfigParams::ssl_ocsp_cache_timeout;
+
+  OCSP_BASICRESP *bs = cinf->cid ? OCSP_response_get1_basic(rsp) : nullptr;
+  if (bs) {
+    int status, reason, days, secs;
+    ASN1_GENERALIZEDTIME *rev, *thisupd, *nextupd = nullptr;
+    if (OCSP_resp_find_status(bs, cinf->cid, &status, &reason, &rev, &thisupd, &nextupd) && nextupd &&
+        ASN1_TIME_diff(&days, &secs, nullptr, nextupd)) {
+      lifetime = std::min(lifetime, now - fetched + days * 86400 + secs);
+    }
+    OCSP_BASICRESP_free(bs);
+  }
+
+  if (lifetime <= 0) {
+    return fetched;
+  }
+  return fetched + lifetime / 2 + static_cast<time_t>(rand.drandom() * (lifetime / 4));
+}
+
 static bool
-stapling_cache_response(OCSP_RESPONSE *rsp, certinfo *cinf)
+stapling_cache_response(OCSP_RESPONSE *rsp, certinfo *cinf, time_t fetched)
 {
   unsigned char resp_der[MAX_STAPLING_DER];
   unsigned char *p;
@@ -163,17 +205,98 @@ stapling_cache_response(OCSP_RESPONSE *rsp, certinfo *cinf)
     return false;
   }
 
+  time_t refresh_time = stapling_refresh_time(rsp, cinf, fetched);
+
   ink_mutex_acquire(&cinf->stapling_mutex);
   memcpy(cinf->resp_der, resp_der, resp_derlen);
-  cinf->resp_derlen = resp_derlen;
-  cinf->is_expire   = false;
-  cinf->expire_time = time(nullptr) + SSLConfigParams::ssl_ocsp_cache_timeout;
+  cinf->resp_derlen  = resp_derlen;
+  cinf->is_expire    = false;
+  cinf->expire_time  = fetched + SSLConfigParams::ssl_ocsp_cache_timeout;
+  cinf->refresh_time = refresh_time;
   ink_mutex_release(&cinf->stapling_mutex);
 
   Debug("ssl_ocsp", "stapling_cache_response: success to cache response");
   return true;
 }
 
+// The file of the response persisted for @a cinf, named by the SHA1 hash of its certificate.
+static std::string
+stapling_persist_file(const certinfo *cinf)
+{
+  char name[sizeof(cinf->idx) * 2 + 1];
+  for (unsigned i = 0; i < sizeof(cinf->idx); ++i) {
+    snprintf(name + 2 * i, 3, "%02x", cinf->idx[i]);
+  }
+  return Layout::relative_to(SSLConfigParams::ssl_ocsp_persist_dir, std::string(name) + ".der");
+}
+
+// Write the cached response of @a cinf to its file, through a rename for a restart not to find it half written.
+static void
+stapling_persist_response(certinfo *cinf)
+{
+  unsigned char resp_der[MAX_STAPLING_DER];
+  unsigned int resp_derlen;
+
+  ink_mutex_acquire(&cinf->stapling_mutex);
+  memcpy(resp_der, cinf->resp_der, cinf->resp_derlen);
+  resp_derlen = cinf->resp_derlen;
+  ink_mutex_release(&cinf->stapling_mutex);
+
+  std::string path = stapling_persist_file(cinf);
+  std::string tmp  = path + ".tmp";
+  int fd           = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    Warning("cannot persist the OCSP response of %s to %s: %s", cinf->certname, tmp.c_str(), strerror(errno));
+    return;
+  }
+  bool written = write(fd, resp_der, resp_derlen) == static_cast<ssize_t>(resp_derlen);
+  if (close(fd) != 0 || !written || rename(tmp.c_str(), path.c_str()) != 0) {
+    Warning("cannot persist the OCSP response of %s to %s: %s", cinf->certname, path.c_str(), strerror(errno));
+    unlink(tmp.c_str());
+    return;
+  }
+  Debug("ssl_ocsp", "persisted the OCSP response of %s to %s", cinf->certname, path.c_str());
+}
+
+// Cache the response persisted for @a cinf by a previous run, if it is still valid. The refresh is due as if it had been
+// fetched when the file was written.
+static bool
+stapling_load_response(certinfo *cinf)
+{
+  std::string path = stapling_persist_file(cinf);
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0 || st.st_mtime + SSLConfigParams::ssl_ocsp_cache_timeout < time(nullptr)) {
+    return false;
+  }
+
+  bool loaded        = false;
+  OCSP_RESPONSE *rsp = nullptr;
+  OCSP_BASICRESP *bs = nullptr;
+  BIO *rsp_bio       = BIO_new_file(path.c_str(), "r");
+  if (rsp_bio) {
+    rsp = d2i_OCSP_RESPONSE_bio(rsp_bio, nullptr);
+    BIO_free(rsp_bio);
+  }
+  if (rsp && OCSP_response_status(rsp) == OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+    bs = OCSP_response_get1_basic(rsp);
+  }
+  if (bs) {
+    int status, reason;
+    ASN1_GENERALIZEDTIME *rev, *thisupd, *nextupd;
+    if (OCSP_resp_find_status(bs, cinf->cid, &status, &reason, &rev, &thisupd, &nextupd) &&
+        OCSP_check_validity(thisupd, nextupd, 300, -1)) {
+      loaded = stapling_cache_response(rsp, cinf, st.st_mtime);
+    }
+    OCSP_BASICRESP_free(bs);
+  }
+  if (rsp) {
+    OCSP_RESPONSE_free(rsp);
+  }
+
+  Debug("ssl_ocsp", "%s the persisted OCSP response of %s from %s", loaded ? "loaded" : "discarded", cinf->certname, path.c_str());
+  return loaded;
+}
+
 bool
 ssl_stapling_init_cert(SSL_CTX *ctx, X509 *cert, const char *certname, const char *rsp_file)
 {
@@ -212,6 +335,8 @@ ssl_stapling_init_cert(SSL_CTX *ctx, X509 *cert, const char *certname, const cha
   cinf->is_prefetched = rsp_file ? true : false;
   cinf->is_expire     = true;
   cinf->expire_time   = 0;
+  cinf->refresh_time  = 0;
+  cinf->is_refreshing = false;
 
   if (cinf->is_prefetched) {
     Debug("ssl_ocsp", "using OCSP prefetched response file %s", rsp_file);
@@ -225,7 +350,7 @@ ssl_stapling_init_cert(SSL_CTX *ctx, X509 *cert, const char *certname, const cha
       goto err;
     }
 
-    if (!stapling_cache_response(rsp, cinf)) {
+    if (!stapling_cache_response(rsp, cinf, time(nullptr))) {
       Error("stapling_refresh_response: can not cache response");
       goto err;
     } else {
@@ -261,6 +386,11 @@ ssl_stapling_init_cert(SSL_CTX *ctx, X509 *cert, const char *certname, const cha
     goto err;
   }
 
+  // A response of the previous run staples until the first refresh.
+  if (!cinf->is_prefetched && SSLConfigParams::ssl_ocsp_persist_dir) {
+    stapling_load_response(cinf);
+  }
+
   map->insert(std::make_pair(cert, cinf));
   SSL_CTX_set_ex_data(ctx, ssl_stapling_index, map);
 
@@ -352,173 +482,400 @@ stapling_check_response(certinfo *cinf, OCSP_RESPONSE *rsp)
   return SSL_TLSEXT_ERR_OK;
 }
 
-static OCSP_RESPONSE *
-query_responder(BIO *b, char *host, char *path, OCSP_REQUEST *req, int req_timeout)
-{
-  ink_hrtime start, end;
-  OCSP_RESPONSE *resp = nullptr;
-  OCSP_REQ_CTX *ctx;
-  int rv;
+class OCSPRefresher;
+
+// The event type of the threads that the refresh runs on.
+static EventType ocsp_event_type = ET_CALL;
 
-  start = Thread::get_hrtime();
-  end   = ink_hrtime_add(start, ink_hrtime_from_sec(req_timeout));
+/**
+  The refresh of the response of a certificate, a POST of its OCSP request to the responder over a
+  NetVConnection of its own, as OpenSSL would send it. Only the local refresher is the client, the
+  request does not go through a transaction, its remapping or its plugins.
 
-  ctx = OCSP_sendreq_new(b, path, nullptr, -1);
-  OCSP_REQ_CTX_add1_header(ctx, "Host", host);
-  OCSP_REQ_CTX_set1_req(ctx, req);
+  It ends on a thread of the refresher, which persists the response and starts the next refresh.
+ */
+class OCSPRequest : public Continuation
+{
+public:
+  OCSPRequest(OCSPRefresher *refresher, shared_SSL_CTX ctx, certinfo *cinf)
+    : Continuation(new_ProxyMutex()), _refresher(refresher), _ctx(std::move(ctx)), _cinf(cinf)
+  {
+  }
+
+  void start();
+
+private:
+  int state_lookup(int event, void *data);
+  int state_connect(int event, void *data);
+  int state_transfer(int event, void *data);
+  int state_done(int event, void *data);
+
+  bool build_request();
+  void connect(IpEndpoint const &addr);
+  bool process_response();
+  void finish(bool success);
+
+  /// The most read from the responder, the header of its response fits in the rest.
+  static constexpr int64_t MAX_RESPONSE = MAX_STAPLING_DER + 4096;
+
+  OCSPRefresher *_refresher;
+  shared_SSL_CTX _ctx; ///< Keeps @a _cinf alive through a reload of the certificates
+  certinfo *_cinf;
+
+  char *_host = nullptr;
+  char *_port = nullptr;
+  char *_path = nullptr;
+
+  MIOBuffer *_request_buffer  = nullptr;
+  IOBufferReader *_request    = nullptr;
+  MIOBuffer *_response_buffer = nullptr;
+  IOBufferReader *_response   = nullptr;
+  NetVConnection *_vc         = nullptr;
+  bool _success               = false;
+};
 
-  do {
-    rv = OCSP_sendreq_nbio(&resp, ctx);
-    ink_hrtime_sleep(HRTIME_MSECONDS(1));
-  } while ((rv == -1) && BIO_should_retry(b) && (Thread::get_hrtime() < end));
+/**
+  Refreshes the responses of all the certificates, on the threads of @c ocsp_event_type. Each
+  scan queues the certificates whose refresh is due, most overdue first, and at most
+  @c proxy.config.ssl.ocsp.max_concurrent_requests of their requests are in flight at once.
+ */
+class OCSPRefresher : public Continuation
+{
+public:
+  OCSPRefresher() : Continuation(new_ProxyMutex()) { SET_HANDLER(&OCSPRefresher::state_refresh); }
+
+  int
+  state_refresh(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    scan();
+    launch();
+    return EVENT_CONT;
+  }
+
+  /// The request of @a cinf is done, called with the lock of the refresher held.
+  void
+  request_done(certinfo *cinf)
+  {
+    cinf->is_refreshing = false;
+    --_in_flight;
+    launch();
+  }
+
+private:
+  struct Pending {
+    shared_SSL_CTX ctx;
+    certinfo *cinf;
+    time_t refresh_time;
+  };
+
+  void scan();
+  void launch();
+
+  std::deque<Pending> _pending;
+  int _in_flight = 0;
+};
 
-  OCSP_REQ_CTX_free(ctx);
+void
+OCSPRequest::start()
+{
+  SCOPED_MUTEX_LOCK(lock, mutex, this_ethread());
 
-  if (rv == 1) {
-    return resp;
+  if (!build_request()) {
+    finish(false);
+    return;
   }
 
-  Error("failed to connect to OCSP server; host=%s path=%s", host, path);
+  IpAddr ip;
+  if (ip.load(_host) == 0) {
+    connect(IpEndpoint().assign(ip, htons(atoi(_port))));
+    return;
+  }
 
-  return nullptr;
+  HostDBProcessor::Options opt;
+  opt.port = atoi(_port);
+  SET_HANDLER(&OCSPRequest::state_lookup);
+  hostDBProcessor.getbyname_re(this, _host, strlen(_host), opt);
 }
 
-static OCSP_RESPONSE *
-process_responder(OCSP_REQUEST *req, char *host, char *path, char *port, int req_timeout)
+bool
+OCSPRequest::build_request()
 {
-  BIO *cbio           = nullptr;
-  OCSP_RESPONSE *resp = nullptr;
-  cbio                = BIO_new_connect(host);
-  if (!cbio) {
-    goto end;
+  int ssl_flag = 0;
+  if (!OCSP_parse_url(_cinf->uri, &_host, &_port, &_path, &ssl_flag)) {
+    Debug("ssl_ocsp", "OCSPRequest: OCSP_parse_url failed; uri=%s", _cinf->uri);
+    return false;
   }
-  if (port) {
-    BIO_set_conn_port(cbio, port);
+  Debug("ssl_ocsp", "OCSPRequest: querying responder; host=%s port=%s path=%s", _host, _port, _path);
+
+  OCSP_REQUEST *req = OCSP_REQUEST_new();
+  OCSP_CERTID *id   = OCSP_CERTID_dup(_cinf->cid);
+  if (!req || !id || !OCSP_request_add0_id(req, id)) {
+    OCSP_CERTID_free(id);
+    OCSP_REQUEST_free(req);
+    return false;
   }
 
-  BIO_set_nbio(cbio, 1);
-  if (BIO_do_connect(cbio) <= 0 && !BIO_should_retry(cbio)) {
-    Debug("ssl_ocsp", "process_responder: failed to connect to OCSP server; host=%s port=%s path=%s", host, port, path);
-    goto end;
+  unsigned char *der = nullptr;
+  int der_len        = i2d_OCSP_REQUEST(req, &der);
+  OCSP_REQUEST_free(req);
+  if (der_len <= 0) {
+    return false;
   }
-  resp = query_responder(cbio, host, path, req, req_timeout);
 
-end:
-  if (cbio) {
-    BIO_free_all(cbio);
+  // HTTP/1.0 has the responder close the connection after its response, which is not chunked.
+  char header[1024];
+  int header_len = snprintf(header, sizeof(header),
+                            "POST %s HTTP/1.0\r\nHost: %s\r\nContent-Type: application/ocsp-request\r\nContent-Length: %d\r\n\r\n",
+                            _path, _host, der_len);
+  if (header_len <= 0 || header_len >= static_cast<int>(sizeof(header))) {
+    OPENSSL_free(der);
+    return false;
   }
-  return resp;
+
+  _request_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  _request        = _request_buffer->alloc_reader();
+  _request_buffer->write(header, header_len);
+  _request_buffer->write(der, der_len);
+  OPENSSL_free(der);
+  return true;
 }
 
-static bool
-stapling_refresh_response(certinfo *cinf, OCSP_RESPONSE **prsp)
+int
+OCSPRequest::state_lookup(int event, void *data)
 {
-  bool rv           = true;
-  OCSP_REQUEST *req = nullptr;
-  OCSP_CERTID *id   = nullptr;
-  char *host = nullptr, *port = nullptr, *path = nullptr;
-  int ssl_flag        = 0;
-  int response_status = 0;
+  ink_assert(event == EVENT_HOST_DB_LOOKUP);
 
-  *prsp = nullptr;
-
-  if (!OCSP_parse_url(cinf->uri, &host, &port, &path, &ssl_flag)) {
-    Debug("ssl_ocsp", "stapling_refresh_response: OCSP_parse_url failed; uri=%s", cinf->uri);
-    goto err;
+  HostDBInfo *info = static_cast<HostDBInfo *>(data);
+  if (info && info->round_robin) {
+    HostDBRoundRobin *rr = info->rr();
+    info                 = rr && rr->good > 0 ? &rr->info(rr->current++ % rr->good) : nullptr;
   }
+  if (!info || info->is_failed()) {
+    Error("failed to resolve OCSP server; host=%s", _host);
+    finish(false);
+    return EVENT_DONE;
+  }
+
+  IpEndpoint addr;
+  addr.assign(info->ip());
+  addr.port() = htons(atoi(_port));
+  connect(addr);
+  return EVENT_DONE;
+}
 
-  Debug("ssl_ocsp", "stapling_refresh_response: querying responder; host=%s port=%s path=%s", host, port, path);
+void
+OCSPRequest::connect(IpEndpoint const &addr)
+{
+  NetVCOptions opt;
+  opt.f_blocking_connect = false;
+  opt.ip_family          = addr.family();
 
-  req = OCSP_REQUEST_new();
-  if (!req) {
-    goto err;
+  SET_HANDLER(&OCSPRequest::state_connect);
+  netProcessor.connect_re(this, &addr.sa, &opt);
+}
+
+int
+OCSPRequest::state_connect(int event, void *data)
+{
+  if (event != NET_EVENT_OPEN) {
+    Error("failed to connect to OCSP server; host=%s port=%s path=%s", _host, _port, _path);
+    finish(false);
+    return EVENT_DONE;
   }
-  id = OCSP_CERTID_dup(cinf->cid);
-  if (!id) {
-    goto err;
+
+  _vc = static_cast<NetVConnection *>(data);
+  _vc->set_active_timeout(HRTIME_SECONDS(SSLConfigParams::ssl_ocsp_request_timeout));
+  _vc->set_inactivity_timeout(HRTIME_SECONDS(SSLConfigParams::ssl_ocsp_request_timeout));
+
+  _response_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  _response        = _response_buffer->alloc_reader();
+
+  SET_HANDLER(&OCSPRequest::state_transfer);
+  _vc->do_io_write(this, _request->read_avail(), _request);
+  _vc->do_io_read(this, MAX_RESPONSE + 1, _response_buffer);
+  return EVENT_DONE;
+}
+
+int
+OCSPRequest::state_transfer(int event, void *data)
+{
+  switch (event) {
+  case VC_EVENT_WRITE_READY:
+  case VC_EVENT_WRITE_COMPLETE:
+  case VC_EVENT_READ_READY:
+    static_cast<VIO *>(data)->reenable();
+    break;
+  case VC_EVENT_EOS:
+    finish(process_response());
+    break;
+  case VC_EVENT_READ_COMPLETE:
+    Error("OCSP response too big; host=%s port=%s path=%s", _host, _port, _path);
+    finish(false);
+    break;
+  default:
+    Error("failed to query OCSP server; host=%s port=%s path=%s event=%d", _host, _port, _path, event);
+    finish(false);
+    break;
   }
-  if (!OCSP_request_add0_id(req, id)) {
-    goto err;
+  return EVENT_DONE;
+}
+
+bool
+OCSPRequest::process_response()
+{
+  HTTPParser parser;
+  HTTPHdr hdr;
+  int bytes_used = 0;
+
+  http_parser_init(&parser);
+  hdr.create(HTTP_TYPE_RESPONSE);
+  ParseResult result = hdr.parse_resp(&parser, _response, &bytes_used, true);
+  HTTPStatus status  = result == PARSE_RESULT_DONE ? hdr.status_get() : HTTP_STATUS_NONE;
+  hdr.destroy();
+  http_parser_clear(&parser);
+
+  if (status != HTTP_STATUS_OK) {
+    Error("OCSP server error; host=%s port=%s path=%s http_status=%d", _host, _port, _path, status);
+    return false;
   }
 
-  *prsp = process_responder(req, host, path, port, SSLConfigParams::ssl_ocsp_request_timeout);
-  if (*prsp == nullptr) {
-    goto done;
+  // What is left after the header is the body.
+  unsigned char der[MAX_RESPONSE];
+  int64_t der_len        = _response->read_avail();
+  const unsigned char *p = der;
+  _response->memcpy(der, der_len);
+  OCSP_RESPONSE *rsp = d2i_OCSP_RESPONSE(nullptr, &p, der_len);
+  if (!rsp) {
+    Error("cannot parse OCSP response; host=%s port=%s path=%s", _host, _port, _path);
+    return false;
   }
 
-  response_status = OCSP_response_status(*prsp);
+  int response_status = OCSP_response_status(rsp);
   if (response_status == OCSP_RESPONSE_STATUS_SUCCESSFUL) {
-    Debug("ssl_ocsp", "stapling_refresh_response: query response received");
-    stapling_check_response(cinf, *prsp);
+    Debug("ssl_ocsp", "OCSPRequest: query response received");
+    stapling_check_response(_cinf, rsp);
   } else {
-    Error("stapling_refresh_response: responder response error; host=%s port=%s path=%s response_status=%d", host, port, path,
+    Error("OCSPRequest: responder response error; host=%s port=%s path=%s response_status=%d", _host, _port, _path,
           response_status);
   }
 
-  if (!stapling_cache_response(*prsp, cinf)) {
-    Error("stapling_refresh_response: can not cache response");
+  bool cached = stapling_cache_response(rsp, _cinf, time(nullptr));
+  OCSP_RESPONSE_free(rsp);
+  if (!cached) {
+    Error("OCSPRequest: can not cache response");
+  }
+  return cached;
+}
+
+void
+OCSPRequest::finish(bool success)
+{
+  if (_vc) {
+    _vc->do_io_close();
+    _vc = nullptr;
+  }
+  if (_request_buffer) {
+    free_MIOBuffer(_request_buffer);
+    _request_buffer = nullptr;
+  }
+  if (_response_buffer) {
+    free_MIOBuffer(_response_buffer);
+    _response_buffer = nullptr;
+  }
+
+  if (success) {
+    Debug("ssl_ocsp", "Successfully refreshed OCSP for %s certificate. url=%s", _cinf->certname, _cinf->uri);
+    SSL_INCREMENT_DYN_STAT(ssl_ocsp_refreshed_cert_stat);
   } else {
-    Debug("ssl_ocsp", "stapling_refresh_response: successful refresh OCSP response");
+    Error("Failed to refresh OCSP for %s certificate. url=%s", _cinf->certname, _cinf->uri);
+    SSL_INCREMENT_DYN_STAT(ssl_ocsp_refresh_cert_failure_stat);
   }
-  goto done;
 
-err:
-  rv = false;
-  Error("stapling_refresh_response: failed to refresh OCSP response");
+  // The file is written on the refresher threads, not where the response was read.
+  _success = success;
+  SET_HANDLER(&OCSPRequest::state_done);
+  eventProcessor.schedule_imm(this, ocsp_event_type);
+}
 
-done:
-  if (req) {
-    OCSP_REQUEST_free(req);
+int
+OCSPRequest::state_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  if (_success && SSLConfigParams::ssl_ocsp_persist_dir) {
+    stapling_persist_response(_cinf);
   }
-  if (*prsp) {
-    OCSP_RESPONSE_free(*prsp);
+
+  {
+    SCOPED_MUTEX_LOCK(lock, _refresher->mutex, this_ethread());
+    _refresher->request_done(_cinf);
   }
-  OPENSSL_free(host);
-  OPENSSL_free(path);
-  OPENSSL_free(port);
-  return rv;
+
+  OPENSSL_free(_host);
+  OPENSSL_free(_port);
+  OPENSSL_free(_path);
+  delete this;
+  return EVENT_DONE;
 }
 
 void
-ocsp_update()
+OCSPRefresher::scan()
 {
-  shared_SSL_CTX ctx;
-  OCSP_RESPONSE *resp = nullptr;
-  time_t current_time;
+  std::vector<Pending> due;
+  time_t current_time = time(nullptr);
 
   SSLCertificateConfig::scoped_config certLookup;
   const unsigned ctxCount = certLookup->count();
 
   for (unsigned i = 0; i < ctxCount; i++) {
     SSLCertContext *cc = certLookup->get(i);
-    if (cc) {
-      ctx = cc->getCtx();
-      if (ctx) {
-        certinfo *cinf    = nullptr;
-        certinfo_map *map = stapling_get_cert_info(ctx.get());
-        if (map) {
-          // Walk over all certs associated with this CTX
-          for (auto &iter : *map) {
-            cinf = iter.second;
-            ink_mutex_acquire(&cinf->stapling_mutex);
-            current_time = time(nullptr);
-            if (cinf->resp_derlen == 0 || cinf->is_expire || cinf->expire_time < current_time) {
-              ink_mutex_release(&cinf->stapling_mutex);
-              if (stapling_refresh_response(cinf, &resp)) {
-                Debug("Successfully refreshed OCSP for %s certificate. url=%s", cinf->certname, cinf->uri);
-                SSL_INCREMENT_DYN_STAT(ssl_ocsp_refreshed_cert_stat);
-              } else {
-                Error("Failed to refresh OCSP for %s certificate. url=%s", cinf->certname, cinf->uri);
-                SSL_INCREMENT_DYN_STAT(ssl_ocsp_refresh_cert_failure_stat);
-              }
-            } else {
-              ink_mutex_release(&cinf->stapling_mutex);
-            }
-          }
-        }
+    shared_SSL_CTX ctx = cc ? cc->getCtx() : nullptr;
+    certinfo_map *map  = ctx ? stapling_get_cert_info(ctx.get()) : nullptr;
+    if (!map) {
+      continue;
+    }
+    // Walk over all certs associated with this CTX
+    for (auto &iter : *map) {
+      certinfo *cinf = iter.second;
+      if (cinf->is_refreshing) {
+        continue;
+      }
+      ink_mutex_acquire(&cinf->stapling_mutex);
+      time_t refresh_time = cinf->refresh_time;
+      bool is_due         = cinf->resp_derlen == 0 || cinf->is_expire || refresh_time <= current_time;
+      ink_mutex_release(&cinf->stapling_mutex);
+      if (is_due) {
+        cinf->is_refreshing = true;
+        due.push_back({ctx, cinf, refresh_time});
       }
     }
   }
+
+  std::sort(due.begin(), due.end(), [](Pending const &a, Pending const &b) { return a.refresh_time < b.refresh_time; });
+  _pending.insert(_pending.end(), due.begin(), due.end());
+  Debug("ssl_ocsp", "OCSP refresh: %zu due, %zu pending, %d in flight", due.size(), _pending.size(), _in_flight);
+}
+
+void
+OCSPRefresher::launch()
+{
+  int max_in_flight = std::max(1, SSLConfigParams::ssl_ocsp_max_concurrent_requests);
+
+  while (_in_flight < max_in_flight && !_pending.empty()) {
+    Pending next = std::move(_pending.front());
+    _pending.pop_front();
+    ++_in_flight;
+    (new OCSPRequest(this, std::move(next.ctx), next.cinf))->start();
+  }
+}
+
+void
+ocsp_start(EventType etype)
+{
+  ocsp_event_type = etype;
+
+  // The first scan runs right away, the threads of the network are already running.
+  OCSPRefresher *refresher = new OCSPRefresher();
+  eventProcessor.schedule_imm(refresher, etype);
+  eventProcessor.schedule_every(refresher, HRTIME_SECONDS(SSLConfigParams::ssl_ocsp_update_period), etype);
 }
 
 // RFC 6066 Section-8: Certificate Status Request
@@ -58,7 +58,16 @@ enum Net_Stats {
   net_tcp_accept_stat,
   net_connections_throttled_in_stat,
   net_connections_throttled_out_stat,
+  net_connections_rate_limited_in_stat,
   net_requests_max_throttled_in_stat,
+  net_keep_alive_evicted_connections_stat,
+  net_keep_alive_evicted_memory_stat,
+  net_active_queue_evicted_timeout_stat,
+  net_busy_poll_hits_stat,
+  net_busy_poll_misses_stat,
+  net_zerocopy_writes_stat,
+  net_zerocopy_copied_stat,
+  net_tcp_info_samples_stat,
   Net_Stat_Count
 };
 
@@ -89,6 +89,7 @@ struct NetAccept : public Continuation {
   Ptr<NetAcceptAction> action_;
   SSLNextProtocolAccept *snpa = nullptr;
   EventIO ep;
+  bool listening = false; ///< The socket was set up by init_accept_per_thread.
 
   HttpProxyPort *proxyPort = nullptr;
   NetProcessor::AcceptOptions opt;
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "tscore/ink_config.h"
+#include "I_EventSystem.h"
 
 #if TS_USE_TLS_OCSP
 #include <openssl/ssl.h>
@@ -29,6 +30,6 @@
 
 void ssl_stapling_ex_init();
 bool ssl_stapling_init_cert(SSL_CTX *ctx, X509 *cert, const char *certname, const char *rsp_file);
-void ocsp_update();
+void ocsp_start(EventType etype);
 int ssl_callback_ocsp_stapling(SSL *);
 #endif
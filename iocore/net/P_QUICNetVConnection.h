@@ -293,7 +293,8 @@ private:
   void _schedule_packet_write_ready(bool delay = false);
   void _unschedule_packet_write_ready();
   void _close_packet_write_ready(Event *data);
-  Event *_packet_write_ready = nullptr;
+  Event *_packet_write_ready        = nullptr;
+  ink_hrtime _pacing_next_send_time = 0; ///< When the pacing rate allows the next datagram out
 
   void _schedule_closing_timeout(ink_hrtime interval);
   void _unschedule_closing_timeout();
@@ -316,8 +317,8 @@ private:
   uint32_t _minimum_quic_packet_size();
   uint64_t _maximum_stream_frame_data_size();
 
-  Ptr<IOBufferBlock> _store_frame(Ptr<IOBufferBlock> parent_block, size_t &size_added, uint64_t &max_frame_size, QUICFrame &frame,
-                                  std::vector<QUICSentPacketInfo::FrameInfo> &frames);
+  void _store_frame(Ptr<IOBufferBlock> &first_block, Ptr<IOBufferBlock> &last_block, size_t &size_added, uint64_t &max_frame_size,
+                    QUICFrame &frame, std::vector<QUICSentPacketInfo::FrameInfo> &frames);
   QUICPacketUPtr _packetize_frames(uint8_t *packet_buf, QUICEncryptionLevel level, uint64_t max_packet_size,
                                    std::vector<QUICSentPacketInfo::FrameInfo> &frames);
   void _packetize_closing_frame();
@@ -390,7 +391,7 @@ private:
 
   std::unique_ptr<QUICContext> _context;
 
-  std::shared_ptr<QLog::QLogListener> _qlog;
+  std::shared_ptr<QUICCallback> _qlog;
 };
 
 typedef int (QUICNetVConnection::*QUICNetVConnHandler)(int, void *);
@@ -25,6 +25,10 @@
 
 #include <openssl/ssl.h>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 #include "ProxyConfig.h"
 
 struct SSLConfigParams;
@@ -77,6 +81,51 @@ using shared_SSLMultiCertConfigParams = std::shared_ptr<SSLMultiCertConfigParams
 using shared_SSL_CTX                  = std::shared_ptr<SSL_CTX>;
 using shared_ssl_ticket_key_block     = std::shared_ptr<ssl_ticket_key_block>;
 
+/** Deferred creation of the @c SSL_CTX of a certificate.
+
+    With @c proxy.config.ssl.server.multicert.lazy_load only the names of a certificate are indexed
+    when the configuration loads, the context is made by the first handshake that selects it. The
+    contexts made this way are limited in number, when there are too many the least recently used
+    ones are dropped to be made again if they are selected again. This is shared by the contexts of
+    all the names of the certificate.
+*/
+class SSLCertLazyContext
+{
+public:
+  using Loader = std::function<SSL_CTX *()>;
+
+  explicit SSLCertLazyContext(Loader loader) : _loader(std::move(loader)) {}
+  ~SSLCertLazyContext();
+
+  /// The context, made if there is none yet.
+  /// @return The context, @c nullptr if it failed to load.
+  shared_SSL_CTX get();
+
+  /// The context if it is made, @c nullptr if not.
+  shared_SSL_CTX
+  current() const
+  {
+    return std::atomic_load(&_ctx);
+  }
+
+  /// Set the number of contexts kept, 0 to keep all of them.
+  static void set_limit(unsigned limit);
+
+private:
+  /// Add to the made contexts, dropping others if there are too many.
+  void _track();
+  void _untrack();
+
+  Loader _loader;
+  std::mutex _load_mutex; ///< Only one thread makes the context.
+  shared_SSL_CTX _ctx;    ///< Only accessed with the atomic shared pointer functions.
+  bool _failed = false;   ///< Loading failed, do not try again until the configuration is reloaded.
+  std::atomic<bool> _referenced{false};
+  size_t _slot = SIZE_MAX; ///< Index in the made contexts, @c SIZE_MAX if not in them.
+};
+
+using shared_SSLCertLazyContext = std::shared_ptr<SSLCertLazyContext>;
+
 /** A certificate context.
 
     This holds data about a certificate and how it is used by the SSL logic. Current this is mainly
@@ -90,21 +139,17 @@ using shared_ssl_ticket_key_block     = std::shared_ptr<ssl_ticket_key_block>;
 */
 struct SSLCertContext {
 private:
-  mutable std::mutex ctx_mutex;
-  shared_SSL_CTX ctx;
+  shared_SSL_CTX ctx; ///< Only accessed with the atomic shared pointer functions.
 
 public:
-  SSLCertContext() : ctx_mutex(), ctx(nullptr), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr) {}
+  SSLCertContext() : ctx(nullptr), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr) {}
   explicit SSLCertContext(SSL_CTX *c)
-    : ctx_mutex(), ctx(c, SSL_CTX_free), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr)
-  {
-  }
-  SSLCertContext(shared_SSL_CTX sc, shared_SSLMultiCertConfigParams u)
-    : ctx_mutex(), ctx(sc), opt(u->opt), userconfig(u), keyblock(nullptr)
+    : ctx(c, SSL_CTX_free), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr)
   {
   }
+  SSLCertContext(shared_SSL_CTX sc, shared_SSLMultiCertConfigParams u) : ctx(sc), opt(u->opt), userconfig(u), keyblock(nullptr) {}
   SSLCertContext(shared_SSL_CTX sc, shared_SSLMultiCertConfigParams u, shared_ssl_ticket_key_block kb)
-    : ctx_mutex(), ctx(sc), opt(u->opt), userconfig(u), keyblock(kb)
+    : ctx(sc), opt(u->opt), userconfig(u), keyblock(kb)
   {
   }
   SSLCertContext(SSLCertContext const &other);
@@ -112,13 +157,18 @@ public:
   ~SSLCertContext() {}
 
   /// Threadsafe Functions to get and set shared SSL_CTX pointer
+  /// A deferred context is returned by @c getCtx only if it is made already.
   shared_SSL_CTX getCtx();
   void setCtx(shared_SSL_CTX sc);
   void release();
 
+  /// Get the SSL_CTX, making a deferred context if needed. Use this to select the context for a handshake.
+  shared_SSL_CTX loadCtx();
+
   SSLCertContextOption opt                   = SSLCertContextOption::OPT_NONE; ///< Special handling option.
   shared_SSLMultiCertConfigParams userconfig = nullptr;                        ///< User provided settings
   shared_ssl_ticket_key_block keyblock       = nullptr;                        ///< session keys associated with this address
+  shared_SSLCertLazyContext lazy             = nullptr;                        ///< Set if the SSL_CTX is made on demand
 };
 
 struct SSLCertLookup : public ConfigInfo {
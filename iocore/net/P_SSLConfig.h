@@ -76,6 +76,9 @@ struct SSLConfigParams : public ConfigInfo {
   char *cipherSuite;
   char *client_cipherSuite;
   int configExitOnLoadError;
+  int configLazyLoad;
+  int configLazyLoadMaxContexts;
+  int configLoadThreads;
   int clientCertLevel;
   int verify_depth;
   int ssl_session_cache; // SSL_SESSION_CACHE_MODE
@@ -110,11 +113,14 @@ struct SSLConfigParams : public ConfigInfo {
   static int ssl_maxrecord;
   static int ssl_misc_max_iobuffer_size_index;
   static bool ssl_allow_client_renegotiation;
+  static bool ssl_ktls_enabled;
 
   static bool ssl_ocsp_enabled;
   static int ssl_ocsp_cache_timeout;
   static int ssl_ocsp_request_timeout;
   static int ssl_ocsp_update_period;
+  static int ssl_ocsp_max_concurrent_requests;
+  static char *ssl_ocsp_persist_dir;
   static int ssl_handshake_timeout_in;
   char *ssl_ocsp_response_path_only;
 
@@ -162,8 +168,10 @@ struct SSLConfig {
   static void startup();
   static void reconfigure();
   static SSLConfigParams *acquire();
+  static SSLConfigParams *peek();
   static void release(SSLConfigParams *params);
   typedef ConfigProcessor::scoped_config<SSLConfig, SSLConfigParams> scoped_config;
+  typedef ConfigProcessor::epoch_config<SSLConfig, SSLConfigParams> epoch_config;
 
 private:
   static int configid;
@@ -173,9 +181,11 @@ struct SSLCertificateConfig {
   static bool startup();
   static bool reconfigure();
   static SSLCertLookup *acquire();
+  static SSLCertLookup *peek();
   static void release(SSLCertLookup *params);
 
   typedef ConfigProcessor::scoped_config<SSLCertificateConfig, SSLCertLookup> scoped_config;
+  typedef ConfigProcessor::epoch_config<SSLCertificateConfig, SSLCertLookup> epoch_config;
 
 private:
   static int configid;
@@ -203,6 +213,12 @@ struct SSLTicketKeyConfig {
     return static_cast<SSLTicketParams *>(configProcessor.get(configid));
   }
 
+  static SSLTicketParams *
+  peek()
+  {
+    return static_cast<SSLTicketParams *>(configProcessor.peek(configid));
+  }
+
   static void
   release(SSLTicketParams *params)
   {
@@ -212,6 +228,7 @@ struct SSLTicketKeyConfig {
   }
 
   typedef ConfigProcessor::scoped_config<SSLTicketKeyConfig, SSLTicketParams> scoped_config;
+  typedef ConfigProcessor::epoch_config<SSLTicketKeyConfig, SSLTicketParams> epoch_config;
 
 private:
   static int configid;
@@ -73,3 +73,6 @@ public:
 };
 
 extern SSLNetProcessor ssl_NetProcessor;
+
+/// Threads that run inbound TLS handshakes, this is @c ET_NET unless @c proxy.config.ssl.handshake_threads is set.
+extern EventType ET_TLS;
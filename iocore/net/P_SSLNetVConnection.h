@@ -77,6 +77,7 @@
 #define SSL_DEF_TLS_RECORD_MSEC_THRESHOLD 1000
 
 struct SSLCertLookup;
+struct SSLHandshakeTiming;
 
 typedef enum {
   SSL_HOOK_OP_DEFAULT,                     ///< Null / initialization value. Do normal processing.
@@ -113,6 +114,26 @@ public:
     return retval;
   }
 
+  bool
+  supports_splice_read() const override
+  {
+    return false;
+  }
+
+  /// With the kernel encrypting what is written, the socket takes plain data.
+  bool
+  supports_splice_write() const override
+  {
+    return ktls_send;
+  }
+
+  /// The kernel TLS layer copies what is sent and gives no completions.
+  bool
+  supports_zerocopy() const override
+  {
+    return !ktls_send;
+  }
+
   bool
   getSSLHandShakeComplete() const override
   {
@@ -127,6 +148,7 @@ public:
 
   int sslServerHandShakeEvent(int &err);
   int sslClientHandShakeEvent(int &err);
+  int handshakeMigrateEvent(int event, Event *e);
   void net_read_io(NetHandler *nh, EThread *lthread) override;
   int64_t load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs) override;
   void do_io_close(int lerrno = -1) override;
@@ -363,10 +385,13 @@ public:
   int populate(Connection &con, Continuation *c, void *arg) override;
 
   SSL *ssl                         = nullptr;
-  ink_hrtime sslHandshakeBeginTime = 0;
-  ink_hrtime sslHandshakeEndTime   = 0;
-  ink_hrtime sslLastWriteTime      = 0;
-  int64_t sslTotalBytesSent        = 0;
+  ink_hrtime sslHandshakeBeginTime  = 0;
+  ink_hrtime sslHandshakeEndTime    = 0;
+  ink_hrtime sslHandshakeAcceptTime = 0; ///< Time spent in SSLAccept by the handshake so far.
+  ink_hrtime sslAsyncWaitBeginTime  = 0; ///< Start of the wait for an asynchronous job, 0 if not waiting.
+  ink_hrtime sslLastWriteTime       = 0;
+  int64_t sslTotalBytesSent         = 0;
+  bool ktls_send                    = false; ///< The kernel encrypts what is written to the socket.
 
   // The serverName is either a pointer to the (null-terminated) name fetched from the
   // SSL object or the empty string.
@@ -525,8 +550,11 @@ private:
   std::unique_ptr<char[]> _ca_cert_dir;
 
   EventIO async_ep{};
+  SSLHandshakeTiming *async_wait_timing = nullptr; ///< Counts this handshake while it waits for an asynchronous job.
 
 private:
+  void _end_async_wait(ink_hrtime now);
+  void _move_to_net_thread(NetHandler *nh);
   void _make_ssl_connection(SSL_CTX *ctx);
   void _bindSSLObject();
   void _unbindSSLObject();
@@ -116,9 +116,11 @@ struct SNIConfig {
   static void startup();
   static void reconfigure();
   static SNIConfigParams *acquire();
+  static SNIConfigParams *peek();
   static void release(SNIConfigParams *params);
 
   typedef ConfigProcessor::scoped_config<SNIConfig, SNIConfigParams> scoped_config;
+  typedef ConfigProcessor::epoch_config<SNIConfig, SNIConfigParams> epoch_config;
 
   static bool TestClientAction(const char *servername, const IpEndpoint &ep, int &enforcement_policy);
 
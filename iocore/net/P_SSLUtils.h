@@ -83,14 +83,39 @@ public:
   static void clear_pw_references(SSL_CTX *ssl_ctx);
 
 protected:
+  /// The contexts of one line of ssl_multicert.config, made before they are indexed.
+  struct PendingCert {
+    /// A context for the names of only one of the certificates.
+    struct Unique {
+      CertLoadData data;
+      std::set<std::string> names;
+      shared_SSL_CTX ctx;
+    };
+
+    shared_SSLMultiCertConfigParams settings;
+    CertLoadData data;
+    std::set<std::string> common_names;
+    shared_SSL_CTX ctx;
+    std::vector<Unique> unique;
+    bool lazy       = false; ///< The contexts are made on demand.
+    bool cert_valid = true;  ///< All the certificates passed @c check_server_cert_now.
+  };
+
   const SSLConfigParams *_params;
 
   bool _store_single_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams &sslMultCertSettings, shared_SSL_CTX ctx,
                              std::set<std::string> &names);
+  bool _store_lazy_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams &sslMultCertSettings,
+                           CertLoadData const &data, std::set<std::string> const &names);
 
 private:
   virtual const char *_debug_tag() const;
+  /// Whether contexts may be made on demand, see proxy.config.ssl.server.multicert.lazy_load.
+  virtual bool _can_defer_ctx() const;
   bool _store_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams &ssl_multi_cert_params);
+  void _prepare_ssl_ctx(PendingCert &pending);
+  void _prepare_ssl_ctxs(std::vector<PendingCert> &pending);
+  bool _store_pending_ssl_ctx(SSLCertLookup *lookup, PendingCert &pending);
   virtual void _set_handshake_callbacks(SSL_CTX *ctx);
 };
 
@@ -99,6 +124,11 @@ private:
 SSL_CTX *SSLCreateServerContext(const SSLConfigParams *params, const SSLMultiCertConfigParams *sslMultiCertSettings,
                                 const char *cert_path = nullptr, const char *key_path = nullptr);
 
+// Call SSLConfigParams::load_ssl_file_cb and SSLConfigParams::init_ssl_ctx_cb if set. Certificates may load on
+// several threads, these make sure the callbacks are made one at a time.
+void SSLNotifyFileLoaded(const char *path);
+void SSLNotifyCtxInitialized(SSL_CTX *ctx, bool server);
+
 // Release SSL_CTX and the associated data. This works for both
 // client and server contexts and gracefully accepts nullptr.
 // Used by TS API (TSSslContextDestroy)
@@ -273,20 +273,34 @@ public:
 
 class UDPQueue
 {
+  static constexpr int SEND_BATCH_PACKETS = 64;
+  static constexpr int SEND_BATCH_IOVS    = 256;
+
   PacketQueue pipeInfo{};
   ink_hrtime last_report  = 0;
   ink_hrtime last_service = 0;
   int packets             = 0;
   int added               = 0;
 
+  // Packets to be sent together by FlushBatch, all of them on the same connection.
+  UDPPacketInternal *batch[SEND_BATCH_PACKETS];
+  int batch_len  = 0;
+  int batch_iovs = 0;
+
 public:
   // Outgoing UDP Packet Queue
   ASLL(UDPPacketInternal, alink) outQueue;
 
+  // Whether packets of the same size to the same destination are sent as one segmented datagram.
+  bool gso = false;
+
   void service(UDPNetHandler *);
 
   void SendPackets();
   void SendUDPPacket(UDPPacketInternal *p, int32_t pktLen);
+  // Send @a p with the batch, which takes ownership of it.
+  void BatchUDPPacket(UDPPacketInternal *p);
+  void FlushBatch();
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
@@ -317,6 +331,9 @@ public:
   ink_hrtime nextCheck;
   ink_hrtime lastCheck;
 
+  // Receive buffers for a batch of datagrams, allocated on first use.
+  char *read_buffers = nullptr;
+
   int startNetEvent(int event, Event *data);
   int mainNetEvent(int event, Event *data);
 
@@ -89,6 +89,9 @@ struct EventIO {
   EventLoop event_loop = nullptr; ///< the assigned event loop
   bool syscall         = true;    ///< if false, disable all functionality (for QUIC)
   int type             = 0;       ///< class identifier of union data.
+#if TS_USE_LINUX_IO_URING
+  int uring_slot = -1; ///< poll request slot when the event loop uses io_uring.
+#endif
   union {
     Continuation *c;
     NetEvent *ne;
@@ -141,6 +144,7 @@ struct EventIO {
 #include "P_DNSConnection.h"
 #include "P_UnixUDPConnection.h"
 #include "P_UnixPollDescriptor.h"
+#include "tscore/TimerWheel.h"
 #include <limits>
 
 class NetEvent;
@@ -265,13 +269,43 @@ public:
   QueM(NetEvent, NetState, read, ready_link) read_ready_list;
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
-  DList(NetEvent, cop_link) cop_list;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
+  /// Idle connections, least recently used first.
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
   uint32_t keep_alive_queue_size = 0;
+  int64_t keep_alive_queue_bytes = 0; ///< Sum of @c NetEvent::queued_bytes of @c keep_alive_queue.
   Que(NetEvent, active_queue_link) active_queue;
   uint32_t active_queue_size = 0;
+  int64_t active_queue_bytes = 0; ///< Sum of @c NetEvent::queued_bytes of @c active_queue.
+  /// The connections whose TCP_INFO was asked for, sampled again every @c Config::tcp_info_interval.
+  Que(NetEvent, tcp_info_link) tcp_info_list;
+  ink_hrtime tcp_info_sampled_at = 0;
+
+  struct TimeoutTraits {
+    static ink_hrtime
+    at(NetEvent const *ne)
+    {
+      return ne->timeout_check_at;
+    }
+    static int
+    tag(NetEvent const *ne)
+    {
+      return ne->timeout_tag;
+    }
+    static void
+    set_tag(NetEvent *ne, int tag)
+    {
+      ne->timeout_tag = tag;
+    }
+    static bool
+    expire_early(NetEvent const *ne)
+    {
+      return ne->closed;
+    }
+  };
+  /// The NetEvents of open_list, by the time the InactivityCop has to look at them next.
+  TimerWheel<NetEvent, NetEvent::Link_timeout_link, TimeoutTraits> timeout_wheel{HRTIME_SECONDS(1), Thread::get_hrtime_updated()};
 
   /// configuration settings for managing the active and keep-alive queues
   struct Config {
@@ -281,6 +315,8 @@ public:
     uint32_t transaction_no_activity_timeout_in = 0;
     uint32_t keep_alive_no_activity_timeout_in  = 0;
     uint32_t default_inactivity_timeout         = 0;
+    uint32_t max_connection_memory_in           = 0; ///< Megabytes.
+    uint32_t tcp_info_interval                  = 0; ///< Milliseconds.
 
     /** Return the address of the first value in this struct.
 
@@ -305,8 +341,9 @@ public:
   Config config; ///< Per thread copy of the @c global_config
   // Active and keep alive queue values that depend on other configuration values.
   // These are never updated directly, they are computed from other config values.
-  uint32_t max_connections_per_thread_in = 0;
-  uint32_t max_requests_per_thread_in    = 0;
+  uint32_t max_connections_per_thread_in     = 0;
+  uint32_t max_requests_per_thread_in        = 0;
+  int64_t max_connection_bytes_per_thread_in = 0;
   /// Number of configuration items in @c Config.
   static constexpr int CONFIG_ITEM_COUNT = sizeof(Config) / sizeof(uint32_t);
   /// Which members of @c Config the per thread values depend on.
@@ -321,6 +358,7 @@ public:
   int waitForActivity(ink_hrtime timeout) override;
   void process_enabled_list();
   void process_ready_list();
+  void sample_tcp_info();
   void manage_keep_alive_queue();
   bool manage_active_queue(NetEvent *ne, bool ignore_queue_size);
   void add_to_keep_alive_queue(NetEvent *ne);
@@ -355,7 +393,7 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a NetEvent.
-    Put the ne into open_list. All NetEvents in the open_list is checked for timeout by InactivityCop.
+    Put the ne into open_list. All NetEvents in the open_list are checked for timeout by InactivityCop.
     Only be called when holding the mutex of this NetHandler and must call startIO(ne) first.
 
     @param ne NetEvent to be managed by InactivityCop
@@ -363,13 +401,22 @@ public:
   void startCop(NetEvent *ne);
   /**
     Stop to handle active timeout and inactivity on a NetEvent.
-    Remove the ne from open_list and cop_list.
+    Remove the ne from open_list and timeout_wheel.
     Also remove the ne from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
     @param ne NetEvent to be released.
    */
   void stopCop(NetEvent *ne);
+  /**
+    Make sure the InactivityCop looks at @a ne no later than @a at.
+    A check is only ever moved earlier here, a deadline that moved later is picked up when the
+    current check comes due.
+
+    @param ne NetEvent in open_list.
+    @param at Time of the check.
+   */
+  void schedule_timeout_check(NetEvent *ne, ink_hrtime at);
 
   // Signal the epoll_wait to terminate.
   void signalActivity() override;
@@ -384,7 +431,20 @@ public:
   NetHandler();
 
 private:
-  void _close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count);
+  bool _close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count);
+  /// Whether the connections of this thread are over the connection count or memory limits.
+  bool _over_connection_limits() const;
+
+  /** Poll without blocking for a while before blocking, see @c net_config_busy_poll_usec.
+      The spin time adapts. It shrinks when spinning finds nothing, and grows when a block is
+      woken sooner than the configured limit.
+
+      @return @c true if the poll was done, @c false if the caller should poll with @a timeout.
+  */
+  bool _busy_poll(PollCont *p, ink_hrtime &timeout);
+  /// Fraction of the busy poll limit a growing spin budget starts at.
+  static constexpr int BUSY_POLL_GROW_START = 8;
+  ink_hrtime _busy_poll_budget = HRTIME_USECONDS(net_config_busy_poll_usec); ///< Current spin time.
 
   /// Static method used as the callback for runtime configuration updates.
   static int update_nethandler_config(const char *name, RecDataT, RecData data, void *);
@@ -652,6 +712,16 @@ EventIO::start_common(EventLoop l, int afd, int e)
 
   fd         = afd;
   event_loop = l;
+#if TS_USE_LINUX_IO_URING
+  if (event_loop->uring_enabled) {
+    if (uring_slot >= 0) {
+      errno = EEXIST;
+      return -1;
+    }
+    uring_slot = event_loop->uring_arm(fd, e, this);
+    return uring_slot < 0 ? -1 : 0;
+  }
+#endif
 #if TS_USE_EPOLL
   struct epoll_event ev;
   memset(&ev, 0, sizeof(ev));
@@ -817,6 +887,16 @@ EventIO::stop()
   }
   if (event_loop) {
     int retval = 0;
+#if TS_USE_LINUX_IO_URING
+    if (event_loop->uring_enabled) {
+      if (uring_slot >= 0) {
+        retval     = event_loop->uring_disarm(uring_slot);
+        uring_slot = -1;
+      }
+      event_loop = nullptr;
+      return retval;
+    }
+#endif
 #if TS_USE_EPOLL
     struct epoll_event ev;
     memset(&ev, 0, sizeof(struct epoll_event));
@@ -887,6 +967,8 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  // Look at it on the next run, to apply the default inactivity timeout if it has none.
+  schedule_timeout_check(ne, Thread::get_hrtime());
 }
 
 TS_INLINE void
@@ -895,7 +977,24 @@ NetHandler::stopCop(NetEvent *ne)
   ink_release_assert(ne->nh == this);
 
   open_list.remove(ne);
-  cop_list.remove(ne);
+  if (ne->timeout_tag >= 0) {
+    timeout_wheel.remove(ne);
+    ne->timeout_tag = -1;
+  }
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
+  tcp_info_list.remove(ne);
+}
+
+TS_INLINE void
+NetHandler::schedule_timeout_check(NetEvent *ne, ink_hrtime at)
+{
+  if (ne->timeout_tag >= 0) {
+    if (ne->timeout_check_at <= at) {
+      return;
+    }
+    timeout_wheel.remove(ne);
+  }
+  ne->timeout_check_at = at;
+  timeout_wheel.insert(ne);
 }
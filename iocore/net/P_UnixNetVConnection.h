@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "tscore/ink_sock.h"
 #include "I_NetVConnection.h"
 #include "P_UnixNetState.h"
@@ -104,6 +106,25 @@ struct OOB_callback : public Continuation {
 
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
 
+/** Pipe through which the reads of one connection are handed to the writes of another.
+    It belongs to the consumer, the producer only refers to it while the coupling lasts.
+*/
+struct NetSplice {
+  int fd[2]                    = {-1, -1};
+  int64_t capacity             = 0; ///< Size of the pipe.
+  int64_t in_pipe              = 0; ///< Bytes in the pipe not yet written out.
+  UnixNetVConnection *producer = nullptr;
+  UnixNetVConnection *consumer = nullptr;
+  bool producer_blocked        = false; ///< The producer stopped reading because the pipe is full.
+};
+
+/// Buffers of zero copy sends that the kernel has not confirmed yet, by send sequence number.
+struct NetZeroCopy {
+  std::deque<std::pair<uint32_t, Ptr<IOBufferData>>> pending;
+  uint32_t next_seq = 0;
+  bool usable       = true; ///< The socket takes zero copy sends.
+};
+
 class UnixNetVConnection : public NetVConnection, public NetEvent
 {
 public:
@@ -158,6 +179,8 @@ public:
 
   SOCKET get_socket() override;
 
+  const TcpInfo *get_tcp_info() override;
+
   ~UnixNetVConnection() override;
 
   /////////////////////////////////////////////////////////////////
@@ -204,6 +227,38 @@ public:
     return false;
   }
 
+  /// Whether what is read from the socket is the data as is, so that it can be spliced out of it.
+  virtual bool
+  supports_splice_read() const
+  {
+    return true;
+  }
+
+  /// Whether what is written to the socket is sent as the data, so that it can be spliced into it.
+  virtual bool
+  supports_splice_write() const
+  {
+    return true;
+  }
+
+  /// Whether sends on the socket complete with notifications when made without copying.
+  virtual bool
+  supports_zerocopy() const
+  {
+    return true;
+  }
+
+  bool splice_from(NetVConnection *producer) override;
+  /// Drop the coupling set up by @c splice_from, from either end.
+  void splice_detach();
+
+  /// Whether the pipe of a coupling this connection consumes has bytes to write.
+  bool
+  splice_pending() const
+  {
+    return splice && splice->consumer == this && splice->in_pipe > 0;
+  }
+
   // NetEvent
   virtual void net_read_io(NetHandler *nh, EThread *lthread) override;
   virtual void net_write_io(NetHandler *nh, EThread *lthread) override;
@@ -243,6 +298,8 @@ public:
     return this->control_flags;
   }
 
+  void sample_tcp_info(ink_hrtime now) override;
+
   virtual int64_t load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs);
   void readDisable(NetHandler *nh);
   void readSignalError(NetHandler *nh, int err);
@@ -267,6 +324,9 @@ public:
   OOB_callback *oob_ptr    = nullptr;
   bool from_accept_thread  = false;
   NetAccept *accept_object = nullptr;
+  NetSplice *splice        = nullptr;
+  NetZeroCopy *zerocopy    = nullptr;
+  TcpInfo *tcp_info        = nullptr; ///< Since @c get_tcp_info was first called
 
   int startEvent(int event, Event *e);
   int acceptEvent(int event, Event *e);
@@ -295,6 +355,16 @@ public:
 private:
   virtual void *_prepareForMigration();
   virtual NetProcessor *_getNetProcessor();
+
+  /// Have the InactivityCop look at this no later than the timeouts that were just set.
+  void _reschedule_timeout_check();
+
+  /// Whether large blocks can be sent without copying, set the socket up for it on first use.
+  bool _zerocopy_enable();
+  /// Release the buffers of zero copy sends the kernel has completed.
+  void _zerocopy_reap();
+  /// Drop the zero copy state when the connection goes away.
+  void _zerocopy_release();
 };
 
 extern ClassAllocator<UnixNetVConnection> netVCAllocator;
@@ -358,6 +428,7 @@ UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
   active_timeout_in        = timeout_in;
   next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  _reschedule_timeout_check();
 }
 
 inline void
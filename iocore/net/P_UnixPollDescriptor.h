@@ -31,6 +31,11 @@
 
 #include "tscore/ink_platform.h"
 
+#if TS_USE_LINUX_IO_URING
+#include <liburing.h>
+#include <vector>
+#endif
+
 #if TS_USE_KQUEUE
 #include <sys/event.h>
 #define INK_EVP_IN 0x001
@@ -44,6 +49,12 @@
 
 typedef struct pollfd Pollfd;
 
+/// Values for proxy.config.net.poll_backend.
+enum PollBackend {
+  POLL_BACKEND_DEFAULT  = 0, ///< The compiled in interface (epoll, kqueue or port).
+  POLL_BACKEND_IO_URING = 1, ///< io_uring multishot poll, Linux only.
+};
+
 struct PollDescriptor {
   int result; // result of poll
 #if TS_USE_EPOLL
@@ -58,8 +69,48 @@ struct PollDescriptor {
 #if TS_USE_PORT
   int port_fd;
 #endif
+#if TS_USE_LINUX_IO_URING
+  /** io_uring readiness backend.
+
+      Each armed descriptor is a multishot @c IORING_OP_POLL_ADD request. Arming and disarming only
+      queue SQEs, which are flushed together with the wait in @c uring_wait, so the per descriptor
+      @c epoll_ctl calls and the @c epoll_wait collapse into a single @c io_uring_enter per loop.
+      Completions are reaped in batches into @c ePoll_Triggered_Events so the consumers of
+      @c get_ev_events / @c get_ev_data are unchanged.
+
+      The SQE user data is an index into @c uring_slots rather than the @c EventIO pointer. A slot
+      is only recycled after the kernel posts the final CQE for the request, so completions that
+      race with @c EventIO::stop are dropped instead of touching freed memory.
+
+      The submission ring is not thread safe, all of this is only called from the thread that
+      owns the descriptor.
+   */
+  struct UringSlot {
+    void *data    = nullptr; ///< The @c EventIO, or @c nullptr once disarmed.
+    int fd        = -1;
+    uint32_t mask = 0;     ///< poll mask, for re-arming if the kernel terminates the multishot.
+    bool armed    = false; ///< a poll request is outstanding in the kernel.
+    int32_t next  = -1;    ///< free list link.
+  };
+
+  bool uring_enabled = false;
+  struct io_uring uring;
+  std::vector<UringSlot> uring_slots;
+  int32_t uring_free = -1;
+  std::vector<int32_t> uring_retry; ///< slots whose removal or re-arm found no free SQE.
+
+  /// Start watching @a fd for @a events (epoll flags), returns the slot or -1 on error.
+  int uring_arm(int fd, uint32_t events, void *data);
+  /// Stop watching the descriptor in @a slot. Late completions for it are discarded.
+  int uring_disarm(int slot);
+  /// Submit queued requests, wait up to @a timeout_ms (forever if negative) for completions and reap them.
+  int uring_wait(int timeout_ms);
+#endif
 
   PollDescriptor() { init(); }
+#if TS_USE_LINUX_IO_URING
+  ~PollDescriptor();
+#endif
 #if TS_USE_EPOLL
 #define get_ev_port(a) ((a)->epoll_fd)
 #define get_ev_events(a, x) ((a)->ePoll_Triggered_Events[(x)].events)
@@ -117,6 +168,12 @@ struct PollDescriptor {
   }
 
 private:
+#if TS_USE_LINUX_IO_URING
+  struct io_uring_sqe *uring_get_sqe();
+  bool uring_init();
+  void uring_requeue(int32_t slot);
+#endif
+
   void
   init()
   {
@@ -127,6 +184,9 @@ private:
     memset(ePoll_Triggered_Events, 0, sizeof(ePoll_Triggered_Events));
     memset(pfd, 0, sizeof(pfd));
 #endif
+#if TS_USE_LINUX_IO_URING
+    uring_enabled = uring_init();
+#endif
 #if TS_USE_KQUEUE
     kqueue_fd = kqueue();
     memset(kq_Triggered_Events, 0, sizeof(kq_Triggered_Events));
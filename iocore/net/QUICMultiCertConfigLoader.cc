@@ -153,9 +153,7 @@ QUICMultiCertConfigLoader::init_server_ssl_ctx(SSLMultiCertConfigLoader::CertLoa
 
   SSL_CTX_set_alpn_select_cb(ctx, QUICMultiCertConfigLoader::ssl_select_next_protocol, nullptr);
 
-  if (SSLConfigParams::init_ssl_ctx_cb) {
-    SSLConfigParams::init_ssl_ctx_cb(ctx, true);
-  }
+  SSLNotifyCtxInitialized(ctx, true);
 
   return ctx;
 
@@ -252,3 +250,10 @@ QUICMultiCertConfigLoader::_debug_tag() const
 {
   return "quic";
 }
+
+bool
+QUICMultiCertConfigLoader::_can_defer_ctx() const
+{
+  // The QUIC handshake takes the context from the lookup without going through SSLCertContext::loadCtx().
+  return false;
+}
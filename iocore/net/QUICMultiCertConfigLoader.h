@@ -52,6 +52,7 @@ public:
 
 private:
   const char *_debug_tag() const override;
+  bool _can_defer_ctx() const override;
   virtual void _set_handshake_callbacks(SSL_CTX *ssl_ctx) override;
   static int ssl_select_next_protocol(SSL *ssl, const unsigned char **out, unsigned char *outlen, const unsigned char *in,
                                       unsigned inlen, void *);
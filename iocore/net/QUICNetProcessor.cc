@@ -79,7 +79,7 @@ QUICNetProcessor::createNetAccept(const NetProcessor::AcceptOptions &opt)
 {
   if (this->_ctable == nullptr) {
     QUICConfig::scoped_config params;
-    this->_ctable = new QUICConnectionTable(params->connection_table_size());
+    this->_ctable = new QUICConnectionTable(params->connection_table_size(), params->lb_server_id(), params->lb_server_id_len());
     this->_rtable = new QUICResetTokenTable();
   }
   return (NetAccept *)new QUICPacketHandlerIn(opt, *this->_ctable, *this->_rtable);
@@ -140,10 +140,18 @@ QUICNetProcessor::connect_re(Continuation *cont, sockaddr const *remote_addr, Ne
   PollCont *pc       = get_UDPPollCont(con->ethread);
   PollDescriptor *pd = pc->pollDescriptor;
 
-  errno   = 0;
-  int res = con->ep.start(pd, con, EVENTIO_READ);
-  if (res < 0) {
-    Debug("udpnet", "Error: %s (%d)", strerror(errno), errno);
+#if TS_USE_LINUX_IO_URING
+  // As in UDPBind, the thread of an io_uring event loop starts the connection itself.
+  if (pd->uring_enabled) {
+    con->ethread->tail_cb->signalActivity();
+  } else
+#endif
+  {
+    errno   = 0;
+    int res = con->ep.start(pd, con, EVENTIO_READ);
+    if (res < 0) {
+      Debug("udpnet", "Error: %s (%d)", strerror(errno), errno);
+    }
   }
 
   // Setup QUICNetVConnection
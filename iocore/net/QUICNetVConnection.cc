@@ -37,7 +37,7 @@
 #include "QUICMultiCertConfigLoader.h"
 #include "QUICTLS.h"
 
-#include "QUICNewRenoCongestionController.h"
+#include "QUICCongestionController.h"
 
 #include "QUICStats.h"
 #include "QUICGlobals.h"
@@ -71,7 +71,9 @@ static constexpr uint32_t UDP_HEADER_SIZE             = 8;
 static constexpr uint32_t MAX_PACKET_OVERHEAD         = 62; ///< Max long header len without length of token field of Initial packet
 static constexpr uint32_t MINIMUM_INITIAL_PACKET_SIZE = 1200;
 static constexpr ink_hrtime WRITE_READY_INTERVAL      = HRTIME_MSECONDS(2);
+static constexpr ink_hrtime PACING_QUANTUM            = HRTIME_MSECONDS(1); ///< How far ahead of the pacing schedule a burst may go
 static constexpr uint32_t PACKET_PER_EVENT            = 256;
+static constexpr uint32_t RECV_PACKET_PER_EVENT       = 64; ///< Leave the rest of received packets for the next NetHandler loop
 static constexpr uint32_t MAX_CONSECUTIVE_STREAMS     = 8; ///< Interrupt sending STREAM frames to send ACK frame
 // static constexpr uint32_t MIN_PKT_PAYLOAD_LEN         = 3; ///< Minimum payload length for sampling for header protection
 
@@ -275,7 +277,11 @@ QUICNetVConnection::init(QUICVersion version, QUICConnectionId peer_cid, QUICCon
   this->_original_quic_connection_id = original_cid;
   this->_first_quic_connection_id    = first_cid;
   this->_retry_source_connection_id  = retry_cid;
-  this->_quic_connection_id.randomize();
+  if (ctable) {
+    this->_quic_connection_id = ctable->issue_connection_id(this->thread);
+  } else {
+    this->_quic_connection_id.randomize();
+  }
   this->_initial_source_connection_id = this->_quic_connection_id;
 
   if (ctable) {
@@ -310,7 +316,7 @@ QUICNetVConnection::_init_submodules()
   });
   this->_path_manager          = new QUICPathManagerImpl(*this, *this->_path_validator);
   this->_context               = std::make_unique<QUICContext>(&this->_rtt_measure, this, &this->_pp_key_info, this->_path_manager);
-  this->_congestion_controller = new QUICNewRenoCongestionController(*_context);
+  this->_congestion_controller = QUICCongestionController::create(*_context);
   this->_rtt_measure.init(this->_context->ld_config());
   this->_loss_detector =
     new QUICLossDetector(*_context, this->_congestion_controller, &this->_rtt_measure, this->_pinger, this->_padder);
@@ -480,11 +486,18 @@ QUICNetVConnection::start()
   this->_frame_dispatcher->add_handler(this->_path_validator);
   this->_frame_dispatcher->add_handler(this->_handshake_handler);
 
-  // regist qlog
+  // regist qlog, the ring keeps the last events only and writes them for the connections worth a look
   if (this->_context->config()->qlog_dir() != nullptr) {
-    this->_qlog = std::make_unique<QLog::QLogListener>(*this->_context, this->_original_quic_connection_id.hex());
-    this->_qlog->last_trace().set_vantage_point(
-      {"ats", QLog::Trace::VantagePointType::server, QLog::Trace::VantagePointType::server});
+    QLog::Trace::VantagePoint vp{"ats", QLog::Trace::VantagePointType::server, QLog::Trace::VantagePointType::server};
+    if (uint32_t ring_size = this->_context->config()->qlog_ring_size(); ring_size > 0) {
+      auto qlog = std::make_shared<QLog::QLogRingListener>(*this->_context, this->_original_quic_connection_id.hex(), ring_size);
+      qlog->set_vantage_point(vp);
+      this->_qlog = qlog;
+    } else {
+      auto qlog = std::make_shared<QLog::QLogListener>(*this->_context, this->_original_quic_connection_id.hex());
+      qlog->last_trace().set_vantage_point(vp);
+      this->_qlog = qlog;
+    }
     this->_context->regist_callback(this->_qlog);
   }
 }
@@ -1396,10 +1409,21 @@ QUICNetVConnection::_state_connection_established_receive_packet()
 {
   QUICConnectionErrorUPtr error = nullptr;
   QUICPacketCreationResult result;
+  uint32_t packet_count = 0;
 
   // Receive a QUIC packet
   net_activity(this, this_ethread());
+  this->_loss_detector->begin_batch();
   do {
+    if (packet_count++ >= RECV_PACKET_PER_EVENT) {
+      // Give other connections on this thread a chance, the NetHandler calls net_read_io() again on the next loop
+      int isin = ink_atomic_swap(&this->read.in_enabled_list, 1);
+      if (!isin) {
+        get_NetHandler(this_ethread())->read_enable_list.push(this);
+      }
+      break;
+    }
+
     uint8_t packet_buf[QUICPacket::MAX_INSTANCE_SIZE];
     QUICPacketUPtr packet = this->_dequeue_recv_packet(packet_buf, result);
     if (result == QUICPacketCreationResult::FAILED) {
@@ -1409,9 +1433,9 @@ QUICNetVConnection::_state_connection_established_receive_packet()
       // - It could be just an error on lower layer
       continue;
     } else if (result == QUICPacketCreationResult::NO_PACKET) {
-      return error;
+      break;
     } else if (result == QUICPacketCreationResult::NOT_READY) {
-      return error;
+      break;
     } else if (result == QUICPacketCreationResult::IGNORED) {
       continue;
     }
@@ -1436,6 +1460,8 @@ QUICNetVConnection::_state_connection_established_receive_packet()
     }
 
   } while (error == nullptr && (result == QUICPacketCreationResult::SUCCESS || result == QUICPacketCreationResult::IGNORED));
+  this->_loss_detector->end_batch();
+
   return error;
 }
 
@@ -1500,6 +1526,7 @@ QUICNetVConnection::_state_common_send_packet()
 {
   uint32_t packet_count = 0;
   uint32_t error        = 0;
+  this->_loss_detector->begin_batch();
   while (error == 0 && packet_count < PACKET_PER_EVENT) {
     uint32_t window = this->_congestion_controller->credit();
 
@@ -1507,6 +1534,13 @@ QUICNetVConnection::_state_common_send_packet()
       break;
     }
 
+    // The event timers can't fire for every datagram, so datagrams go out in bursts of one quantum of the pacing rate
+    uint64_t pacing_rate = this->_congestion_controller->pacing_rate();
+    ink_hrtime now       = Thread::get_hrtime();
+    if (pacing_rate && this->_pacing_next_send_time > now + PACING_QUANTUM) {
+      break;
+    }
+
     Ptr<IOBufferBlock> udp_payload(new_IOBufferBlock());
     uint32_t udp_payload_len = std::min(window, this->_pmtu);
     udp_payload->alloc(iobuffer_size_to_index(udp_payload_len, BUFFER_SIZE_INDEX_32K));
@@ -1578,17 +1612,25 @@ QUICNetVConnection::_state_common_send_packet()
 
     if (written) {
       this->_packet_handler->send_packet(this, udp_payload);
+      if (pacing_rate) {
+        this->_pacing_next_send_time = std::max(this->_pacing_next_send_time, now) + written * HRTIME_SECOND / pacing_rate;
+      }
     } else {
       udp_payload->dealloc();
       break;
     }
   }
+  this->_loss_detector->end_batch();
 
   if (packet_count) {
     this->_context->trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_controller->congestion_window(),
                             this->_congestion_controller->bytes_in_flight(), this->_congestion_controller->current_ssthresh());
 
     QUIC_INCREMENT_DYN_STAT_EX(QUICStats::total_packets_sent_stat, packet_count);
+    QUIC_INCREMENT_DYN_STAT_EX(QUICStats::congestion_window_stat, this->_congestion_controller->congestion_window());
+    if (uint64_t pacing_rate = this->_congestion_controller->pacing_rate(); pacing_rate) {
+      QUIC_INCREMENT_DYN_STAT_EX(QUICStats::pacing_rate_stat, pacing_rate);
+    }
     net_activity(this, this_ethread());
   }
 
@@ -1614,9 +1656,9 @@ QUICNetVConnection::_state_closing_send_packet()
   return nullptr;
 }
 
-Ptr<IOBufferBlock>
-QUICNetVConnection::_store_frame(Ptr<IOBufferBlock> parent_block, size_t &size_added, uint64_t &max_frame_size, QUICFrame &frame,
-                                 std::vector<QUICSentPacketInfo::FrameInfo> &frames)
+void
+QUICNetVConnection::_store_frame(Ptr<IOBufferBlock> &first_block, Ptr<IOBufferBlock> &last_block, size_t &size_added,
+                                 uint64_t &max_frame_size, QUICFrame &frame, std::vector<QUICSentPacketInfo::FrameInfo> &frames)
 {
   Ptr<IOBufferBlock> new_block = frame.to_io_buffer_block(max_frame_size);
 
@@ -1625,11 +1667,13 @@ QUICNetVConnection::_store_frame(Ptr<IOBufferBlock> parent_block, size_t &size_a
     size_added += tmp->size();
   }
 
-  if (parent_block == nullptr) {
-    parent_block = new_block;
+  // The chain starts at the first frame, there is no empty block in front of it
+  if (first_block == nullptr) {
+    first_block = new_block;
   } else {
-    parent_block->next = new_block;
+    last_block->next = new_block;
   }
+  last_block = new_block;
 
   // frame should be stored because it's created with max_frame_size
   ink_assert(size_added != 0);
@@ -1644,10 +1688,9 @@ QUICNetVConnection::_store_frame(Ptr<IOBufferBlock> parent_block, size_t &size_a
 
   frames.emplace_back(frame.id(), frame.generated_by());
 
-  while (parent_block->next) {
-    parent_block = parent_block->next;
+  while (last_block->next) {
+    last_block = last_block->next;
   }
-  return parent_block;
 }
 
 QUICPacketUPtr
@@ -1666,13 +1709,11 @@ QUICNetVConnection::_packetize_frames(uint8_t *packet_buf, QUICEncryptionLevel l
   }
   max_frame_size = std::min(max_frame_size, this->_maximum_stream_frame_data_size());
 
-  bool probing                   = false;
-  int frame_count                = 0;
-  size_t len                     = 0;
-  Ptr<IOBufferBlock> first_block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
-  Ptr<IOBufferBlock> last_block  = first_block;
-  first_block->alloc(iobuffer_size_to_index(0, BUFFER_SIZE_INDEX_32K));
-  first_block->fill(0);
+  bool probing    = false;
+  int frame_count = 0;
+  size_t len      = 0;
+  Ptr<IOBufferBlock> first_block;
+  Ptr<IOBufferBlock> last_block;
 
   uint32_t seq_num   = this->_seq_num++;
   size_t size_added  = 0;
@@ -1712,7 +1753,7 @@ QUICNetVConnection::_packetize_frames(uint8_t *packet_buf, QUICEncryptionLevel l
                        this->_remote_flow_controller->current_limit());
           ink_assert(ret == 0);
         }
-        last_block = this->_store_frame(last_block, size_added, max_frame_size, *frame, frames);
+        this->_store_frame(first_block, last_block, size_added, max_frame_size, *frame, frames);
         len += size_added;
 
         // FIXME ACK frame should have priority
@@ -1765,11 +1806,9 @@ QUICNetVConnection::_packetize_closing_frame()
   size_t size_added       = 0;
   uint64_t max_frame_size = static_cast<uint64_t>(max_size);
   std::vector<QUICSentPacketInfo::FrameInfo> frames;
-  Ptr<IOBufferBlock> first_block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
-  Ptr<IOBufferBlock> last_block  = first_block;
-  first_block->alloc(iobuffer_size_to_index(0, BUFFER_SIZE_INDEX_32K));
-  first_block->fill(0);
-  last_block = this->_store_frame(last_block, size_added, max_frame_size, *frame, frames);
+  Ptr<IOBufferBlock> first_block;
+  Ptr<IOBufferBlock> last_block;
+  this->_store_frame(first_block, last_block, size_added, max_frame_size, *frame, frames);
 
   QUICEncryptionLevel level = this->_hs_protocol->current_encryption_level();
   ink_assert(level != QUICEncryptionLevel::ZERO_RTT);
@@ -1986,7 +2025,13 @@ QUICNetVConnection::_schedule_packet_write_ready(bool delay)
   if (!this->_packet_write_ready) {
     QUICConVVVDebug("Schedule %s event", QUICDebugNames::quic_event(QUIC_EVENT_PACKET_WRITE_READY));
     if (delay) {
-      this->_packet_write_ready = this->thread->schedule_in(this, WRITE_READY_INTERVAL, QUIC_EVENT_PACKET_WRITE_READY, nullptr);
+      // Come back when the pacing schedule allows the next datagram, if that's sooner
+      ink_hrtime interval = WRITE_READY_INTERVAL;
+      ink_hrtime now      = Thread::get_hrtime();
+      if (this->_pacing_next_send_time > now) {
+        interval = std::min(interval, this->_pacing_next_send_time - now);
+      }
+      this->_packet_write_ready = this->thread->schedule_in(this, interval, QUIC_EVENT_PACKET_WRITE_READY, nullptr);
     } else {
       this->_packet_write_ready = this->thread->schedule_imm(this, QUIC_EVENT_PACKET_WRITE_READY, nullptr);
     }
@@ -32,14 +32,16 @@
 #include "tscore/BufferWriter.h"
 #include "tscore/bwf_std_format.h"
 #include "tscore/TestBox.h"
+#include "tscore/ParseRules.h"
 
 #include "I_EventSystem.h"
 
 #include "P_SSLUtils.h"
 #include "P_SSLConfig.h"
 #include "SSLSessionTicket.h"
+#include "SSLStats.h"
 
-#include <unordered_map>
+#include <cstring>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -126,11 +128,54 @@ private:
     LINK(ContextRef, link); ///< Require by @c Trie
   };
 
+  /** Open addressing table of lower case names to indices in @a ctx_store.
+
+      The names are kept together in one buffer and a slot has the hash and the location of its
+      name, so that a lookup reads one slot array and compares one name. The hash is taken over the
+      name from its end, which makes the hash of every parent domain a by product of hashing the
+      full name. This is only changed while the configuration loads, the lookups do not write.
+  */
+  class NameIndex
+  {
+  public:
+    /// @return The index for @a name, -1 if there is none.
+    int find(std::string_view name, uint32_t hash) const;
+
+    /// Add @a idx for @a name unless there is an index for it already.
+    /// @return The index for @a name.
+    int insert(std::string_view name, uint32_t hash, int idx);
+
+    template <typename F>
+    void
+    for_each(F &&f) const
+    {
+      for (auto const &slot : slots) {
+        if (slot.idx >= 0) {
+          f(std::string_view{names.data() + slot.offset, slot.len}, slot.idx);
+        }
+      }
+    }
+
+  private:
+    struct Slot {
+      uint32_t hash   = 0;
+      uint32_t offset = 0; ///< Of the name in @a names.
+      uint32_t len    = 0;
+      int idx         = -1; ///< -1 if the slot is unused.
+    };
+
+    void grow();
+
+    std::vector<Slot> slots;
+    std::string names;
+    size_t n_used = 0;
+  };
+
   /// We can only match one layer with the wildcards
   /// This table stores the wildcarded subdomain
-  std::unordered_map<std::string, int> wilddomains;
+  NameIndex wilddomains;
   /// Contexts stored by IP address or FQDN
-  std::unordered_map<std::string, int> hostnames;
+  NameIndex hostnames;
   /// List for cleanup.
   /// Exactly one pointer to each SSL context is stored here.
   std::vector<SSLCertContext> ctx_store;
@@ -156,6 +201,29 @@ transform_lower(std::string_view src, ts::MemSpan<char> dst)
   auto final = std::transform(src.begin(), src.end(), dst.data(), [](char c) -> char { return std::tolower(c); });
   *final++   = '\0';
 }
+
+constexpr uint32_t NAME_HASH_INIT  = 2166136261U;
+constexpr uint32_t NAME_HASH_PRIME = 16777619U;
+
+/** Hash of @a name, case insensitive and from its last character to the first.
+ *
+ * @param name The name.
+ * @param parent Set to the hash of the part of @a name after its first '.', if not @c nullptr.
+ * @return The hash of @a name.
+ */
+inline uint32_t
+name_hash(std::string_view name, uint32_t *parent = nullptr)
+{
+  uint32_t h = NAME_HASH_INIT;
+  for (size_t i = name.size(); i-- > 0;) {
+    char c = ParseRules::ink_tolower(name[i]);
+    if (c == '.' && parent) {
+      *parent = h;
+    }
+    h = (h ^ static_cast<uint8_t>(c)) * NAME_HASH_PRIME;
+  }
+  return h;
+}
 } // namespace
 
 // Zero out and free the heap space allocated for ticket keys to avoid leaking secrets.
@@ -253,8 +321,8 @@ SSLCertContext::SSLCertContext(SSLCertContext const &other)
   opt        = other.opt;
   userconfig = other.userconfig;
   keyblock   = other.keyblock;
-  std::lock_guard<std::mutex> lock(other.ctx_mutex);
-  ctx = other.ctx;
+  lazy       = other.lazy;
+  ctx        = std::atomic_load(&other.ctx);
 }
 
 SSLCertContext &
@@ -264,8 +332,8 @@ SSLCertContext::operator=(SSLCertContext const &other)
     this->opt        = other.opt;
     this->userconfig = other.userconfig;
     this->keyblock   = other.keyblock;
-    std::lock_guard<std::mutex> lock(other.ctx_mutex);
-    this->ctx = other.ctx;
+    this->lazy       = other.lazy;
+    std::atomic_store(&this->ctx, std::atomic_load(&other.ctx));
   }
   return *this;
 }
@@ -273,15 +341,121 @@ SSLCertContext::operator=(SSLCertContext const &other)
 shared_SSL_CTX
 SSLCertContext::getCtx()
 {
-  std::lock_guard<std::mutex> lock(ctx_mutex);
-  return ctx;
+  shared_SSL_CTX sc = std::atomic_load(&ctx);
+  if (!sc && lazy) {
+    sc = lazy->current();
+  }
+  return sc;
+}
+
+shared_SSL_CTX
+SSLCertContext::loadCtx()
+{
+  shared_SSL_CTX sc = std::atomic_load(&ctx);
+  if (!sc && lazy) {
+    sc = lazy->get();
+  }
+  return sc;
 }
 
 void
 SSLCertContext::setCtx(shared_SSL_CTX sc)
 {
-  std::lock_guard<std::mutex> lock(ctx_mutex);
-  ctx = std::move(sc);
+  std::atomic_store(&ctx, std::move(sc));
+}
+
+namespace
+{
+/// The deferred contexts that are made, see @c SSLCertLazyContext.
+struct LazyContexts {
+  std::mutex mutex;
+  std::vector<SSLCertLazyContext *> made;
+  size_t hand    = 0; ///< Of the clock that picks the contexts to drop.
+  unsigned limit = 0;
+} lazy_contexts;
+} // namespace
+
+SSLCertLazyContext::~SSLCertLazyContext()
+{
+  this->_untrack();
+}
+
+shared_SSL_CTX
+SSLCertLazyContext::get()
+{
+  _referenced.store(true, std::memory_order_relaxed);
+  if (shared_SSL_CTX sc = std::atomic_load(&_ctx); sc) {
+    return sc;
+  }
+
+  // Other handshakes that select this wait for the first one to make the context.
+  std::lock_guard<std::mutex> lock(_load_mutex);
+  shared_SSL_CTX sc = std::atomic_load(&_ctx);
+  if (sc || _failed) {
+    return sc;
+  }
+  sc.reset(_loader(), SSL_CTX_free);
+  if (!sc) {
+    _failed = true;
+    SSL_INCREMENT_DYN_STAT(ssl_lazy_cert_load_failed_stat);
+    return sc;
+  }
+  SSL_INCREMENT_DYN_STAT(ssl_lazy_cert_loaded_stat);
+  std::atomic_store(&_ctx, sc);
+  this->_track();
+  return sc;
+}
+
+void
+SSLCertLazyContext::set_limit(unsigned limit)
+{
+  std::lock_guard<std::mutex> lock(lazy_contexts.mutex);
+  lazy_contexts.limit = limit;
+}
+
+void
+SSLCertLazyContext::_track()
+{
+  std::lock_guard<std::mutex> lock(lazy_contexts.mutex);
+  auto &made = lazy_contexts.made;
+
+  // A clock over the made contexts approximates least recently used without a shared list to
+  // update on every handshake. Connections that use a dropped context keep it until they close.
+  while (lazy_contexts.limit && made.size() >= lazy_contexts.limit) {
+    if (lazy_contexts.hand >= made.size()) {
+      lazy_contexts.hand = 0;
+    }
+    SSLCertLazyContext *lc = made[lazy_contexts.hand];
+    if (lc->_referenced.exchange(false, std::memory_order_relaxed)) {
+      ++lazy_contexts.hand;
+      continue;
+    }
+    std::atomic_store(&lc->_ctx, shared_SSL_CTX{});
+    lc->_slot = SIZE_MAX;
+    if (lazy_contexts.hand != made.size() - 1) {
+      made[lazy_contexts.hand]        = made.back();
+      made[lazy_contexts.hand]->_slot = lazy_contexts.hand;
+    }
+    made.pop_back();
+    SSL_INCREMENT_DYN_STAT(ssl_lazy_cert_evicted_stat);
+  }
+  _slot = made.size();
+  made.push_back(this);
+}
+
+void
+SSLCertLazyContext::_untrack()
+{
+  std::lock_guard<std::mutex> lock(lazy_contexts.mutex);
+  auto &made = lazy_contexts.made;
+  if (_slot != SIZE_MAX) {
+    if (_slot != made.size() - 1) {
+      made[_slot]        = made.back();
+      made[_slot]->_slot = _slot;
+    }
+    made.pop_back();
+    _slot = SIZE_MAX;
+  }
 }
 
 SSLCertLookup::SSLCertLookup() : ssl_storage(new SSLContextStorage()), ssl_default(nullptr), is_valid(true) {}
@@ -381,22 +555,18 @@ SSLContextStorage::insert(const char *name, int idx)
       subdomain = nullptr;
     }
     if (subdomain) {
-      if (auto it = this->wilddomains.find(subdomain); it != this->wilddomains.end()) {
-        Debug("ssl", "previously indexed '%s' with SSL_CTX #%d, cannot index it with SSL_CTX #%d now", lower_case_name, it->second,
-              idx);
+      if (int prev = this->wilddomains.insert(subdomain, name_hash(subdomain), idx); prev != idx) {
+        Debug("ssl", "previously indexed '%s' with SSL_CTX #%d, cannot index it with SSL_CTX #%d now", lower_case_name, prev, idx);
         idx = -1;
       } else {
-        this->wilddomains.emplace(subdomain, idx);
         Debug("ssl", "indexed '%s' with SSL_CTX %p [%d]", lower_case_name, ctx.get(), idx);
       }
     }
   } else {
-    if (auto it = this->hostnames.find(lower_case_name); it != this->hostnames.end() && idx != it->second) {
-      Debug("ssl", "previously indexed '%s' with SSL_CTX %d, cannot index it with SSL_CTX #%d now", lower_case_name, it->second,
-            idx);
+    if (int prev = this->hostnames.insert(lower_case_name, name_hash(lower_case_name), idx); prev != idx) {
+      Debug("ssl", "previously indexed '%s' with SSL_CTX %d, cannot index it with SSL_CTX #%d now", lower_case_name, prev, idx);
       idx = -1;
     } else {
-      this->hostnames.emplace(lower_case_name, idx);
       Debug("ssl", "indexed '%s' with SSL_CTX %p [%d]", lower_case_name, ctx.get(), idx);
     }
   }
@@ -406,31 +576,88 @@ SSLContextStorage::insert(const char *name, int idx)
 void
 SSLContextStorage::printWildDomains() const
 {
-  for (auto &&it : this->wilddomains) {
-    Debug("ssl", "Stored wilddomain %s", it.first.c_str());
+  this->wilddomains.for_each(
+    [](std::string_view name, int) { Debug("ssl", "Stored wilddomain %.*s", static_cast<int>(name.size()), name.data()); });
+}
+
+int
+SSLContextStorage::NameIndex::find(std::string_view name, uint32_t hash) const
+{
+  if (slots.empty()) {
+    return -1;
+  }
+  size_t mask = slots.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    Slot const &slot = slots[i];
+    if (slot.idx < 0) {
+      return -1;
+    }
+    // The stored names are lower case.
+    if (slot.hash == hash && slot.len == name.size() && strncasecmp(names.data() + slot.offset, name.data(), name.size()) == 0) {
+      return slot.idx;
+    }
+  }
+}
+
+int
+SSLContextStorage::NameIndex::insert(std::string_view name, uint32_t hash, int idx)
+{
+  if (int prev = this->find(name, hash); prev >= 0) {
+    return prev;
+  }
+  // Keep the table at most half full so that misses end quickly.
+  if ((n_used + 1) * 2 > slots.size()) {
+    this->grow();
+  }
+  size_t mask = slots.size() - 1;
+  size_t i    = hash & mask;
+  while (slots[i].idx >= 0) {
+    i = (i + 1) & mask;
+  }
+  slots[i].hash   = hash;
+  slots[i].offset = names.size();
+  slots[i].len    = name.size();
+  slots[i].idx    = idx;
+  names.append(name.data(), name.size());
+  ++n_used;
+  return idx;
+}
+
+void
+SSLContextStorage::NameIndex::grow()
+{
+  std::vector<Slot> prev(std::max<size_t>(slots.size() * 2, 64));
+  prev.swap(slots);
+  size_t mask = slots.size() - 1;
+  for (auto const &slot : prev) {
+    if (slot.idx >= 0) {
+      size_t i = slot.hash & mask;
+      while (slots[i].idx >= 0) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = slot;
+    }
   }
 }
 
 SSLCertContext *
 SSLContextStorage::lookup(const char *name)
 {
-  // First look for an exact name match
-  if (auto it = this->hostnames.find(name); it != this->hostnames.end()) {
-    return &(this->ctx_store[it->second]);
-  }
-  // Try lower casing it
-  char lower_case_name[TS_MAX_HOST_NAME_LEN + 1];
-  transform_lower(name, lower_case_name);
-  if (auto it_lower = this->hostnames.find(lower_case_name); it_lower != this->hostnames.end()) {
-    return &(this->ctx_store[it_lower->second]);
+  // One pass over the name hashes it and, as the names are hashed from the end, the domain after
+  // its first label for a wildcard match.
+  std::string_view fqdn{name};
+  uint32_t parent_hash = 0;
+  uint32_t hash        = name_hash(fqdn, &parent_hash);
+
+  // First look for an exact name match, in any case.
+  if (int idx = this->hostnames.find(fqdn, hash); idx >= 0) {
+    return &(this->ctx_store[idx]);
   }
 
   // Then strip off the top domain name and look for a wildcard domain match
-  const char *subdomain = index(lower_case_name, '.');
-  if (subdomain) {
-    ++subdomain; // Move beyond the '.'
-    if (auto it = this->wilddomains.find(subdomain); it != this->wilddomains.end()) {
-      return &(this->ctx_store[it->second]);
+  if (auto dot = fqdn.find('.'); dot != std::string_view::npos) {
+    if (int idx = this->wilddomains.find(fqdn.substr(dot + 1), parent_hash); idx >= 0) {
+      return &(this->ctx_store[idx]);
     }
   }
   return nullptr;
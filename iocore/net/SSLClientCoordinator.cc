@@ -43,7 +43,7 @@ SSLClientCoordinator::startup()
   // The SSLConfig must have its configuration loaded before the SNIConfig.
   // The SSLConfig owns the client cert context storage and the SNIConfig will load
   // into it.
-  sslClientUpdate.reset(new ConfigUpdateHandler<SSLClientCoordinator>());
+  sslClientUpdate.reset(new ConfigUpdateHandler<SSLClientCoordinator>("ssl_client"));
   sslClientUpdate->attach("proxy.config.ssl.client.cert.path");
   sslClientUpdate->attach("proxy.config.ssl.client.cert.filename");
   sslClientUpdate->attach("proxy.config.ssl.client.private_key.path");
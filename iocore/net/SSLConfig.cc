@@ -56,10 +56,13 @@ int SSLTicketKeyConfig::configid                            = 0;
 int SSLConfigParams::ssl_maxrecord                          = 0;
 int SSLConfigParams::ssl_misc_max_iobuffer_size_index       = 8;
 bool SSLConfigParams::ssl_allow_client_renegotiation        = false;
+bool SSLConfigParams::ssl_ktls_enabled                      = false;
 bool SSLConfigParams::ssl_ocsp_enabled                      = false;
 int SSLConfigParams::ssl_ocsp_cache_timeout                 = 3600;
 int SSLConfigParams::ssl_ocsp_request_timeout               = 10;
 int SSLConfigParams::ssl_ocsp_update_period                 = 60;
+int SSLConfigParams::ssl_ocsp_max_concurrent_requests       = 32;
+char *SSLConfigParams::ssl_ocsp_persist_dir                 = nullptr;
 int SSLConfigParams::ssl_handshake_timeout_in               = 0;
 size_t SSLConfigParams::session_cache_number_buckets        = 1024;
 bool SSLConfigParams::session_cache_skip_on_lock_contention = false;
@@ -120,6 +123,9 @@ SSLConfigParams::reset()
   ssl_session_cache_timeout            = 0;
   ssl_session_cache_auto_clear         = 1;
   configExitOnLoadError                = 1;
+  configLazyLoad                       = 0;
+  configLazyLoadMaxContexts            = 0;
+  configLoadThreads                    = 1;
 }
 
 void
@@ -305,6 +311,9 @@ SSLConfigParams::initialize()
 
   configFilePath = ats_stringdup(RecConfigReadConfigPath("proxy.config.ssl.server.multicert.filename"));
   REC_ReadConfigInteger(configExitOnLoadError, "proxy.config.ssl.server.multicert.exit_on_load_fail");
+  REC_ReadConfigInteger(configLazyLoad, "proxy.config.ssl.server.multicert.lazy_load");
+  REC_ReadConfigInteger(configLazyLoadMaxContexts, "proxy.config.ssl.server.multicert.lazy_load.max_contexts");
+  REC_ReadConfigInteger(configLoadThreads, "proxy.config.ssl.server.multicert.load_threads");
 
   REC_ReadConfigStringAlloc(ssl_server_private_key_path, "proxy.config.ssl.server.private_key.path");
   set_paths_helper(ssl_server_private_key_path, nullptr, &serverKeyPathOnly, nullptr);
@@ -341,6 +350,16 @@ SSLConfigParams::initialize()
   REC_EstablishStaticConfigInt32(ssl_ocsp_cache_timeout, "proxy.config.ssl.ocsp.cache_timeout");
   REC_EstablishStaticConfigInt32(ssl_ocsp_request_timeout, "proxy.config.ssl.ocsp.request_timeout");
   REC_EstablishStaticConfigInt32(ssl_ocsp_update_period, "proxy.config.ssl.ocsp.update_period");
+  REC_EstablishStaticConfigInt32(ssl_ocsp_max_concurrent_requests, "proxy.config.ssl.ocsp.max_concurrent_requests");
+  // Restart only, the refresh threads keep using the first one.
+  if (!ssl_ocsp_persist_dir) {
+    char *persist_dir = nullptr;
+    REC_ReadConfigStringAlloc(persist_dir, "proxy.config.ssl.ocsp.persist_dir");
+    if (persist_dir && *persist_dir) {
+      ssl_ocsp_persist_dir = ats_stringdup(Layout::relative_to(Layout::get()->runtimedir, persist_dir));
+    }
+    ats_free(persist_dir);
+  }
   REC_ReadConfigStringAlloc(ssl_ocsp_response_path, "proxy.config.ssl.ocsp.response.path");
   set_paths_helper(ssl_ocsp_response_path, nullptr, &ssl_ocsp_response_path_only, nullptr);
   ats_free(ssl_ocsp_response_path);
@@ -409,6 +428,7 @@ SSLConfigParams::initialize()
   REC_ReadConfigStringAlloc(client_groups_list, "proxy.config.ssl.client.groups_list");
 
   REC_ReadConfigInt32(ssl_allow_client_renegotiation, "proxy.config.ssl.allow_client_renegotiation");
+  REC_ReadConfigInt32(ssl_ktls_enabled, "proxy.config.ssl.ktls.enabled");
 
   REC_ReadConfigInt32(ssl_misc_max_iobuffer_size_index, "proxy.config.ssl.misc.io.max_buffer_index");
 
@@ -449,6 +469,12 @@ SSLConfig::acquire()
   return static_cast<SSLConfigParams *>(configProcessor.get(configid));
 }
 
+SSLConfigParams *
+SSLConfig::peek()
+{
+  return static_cast<SSLConfigParams *>(configProcessor.peek(configid));
+}
+
 void
 SSLConfig::release(SSLConfigParams *params)
 {
@@ -458,7 +484,7 @@ SSLConfig::release(SSLConfigParams *params)
 bool
 SSLCertificateConfig::startup()
 {
-  sslCertUpdate.reset(new ConfigUpdateHandler<SSLCertificateConfig>());
+  sslCertUpdate.reset(new ConfigUpdateHandler<SSLCertificateConfig>("ssl_multicert"));
   sslCertUpdate->attach("proxy.config.ssl.server.multicert.filename");
   sslCertUpdate->attach("proxy.config.ssl.server.cert.path");
   sslCertUpdate->attach("proxy.config.ssl.server.private_key.path");
@@ -518,6 +544,12 @@ SSLCertificateConfig::acquire()
   return static_cast<SSLCertLookup *>(configProcessor.get(configid));
 }
 
+SSLCertLookup *
+SSLCertificateConfig::peek()
+{
+  return static_cast<SSLCertLookup *>(configProcessor.peek(configid));
+}
+
 void
 SSLCertificateConfig::release(SSLCertLookup *lookup)
 {
@@ -599,7 +631,7 @@ SSLTicketParams::LoadTicketData(char *ticket_data, int ticket_data_len)
 void
 SSLTicketKeyConfig::startup()
 {
-  sslTicketKey.reset(new ConfigUpdateHandler<SSLTicketKeyConfig>());
+  sslTicketKey.reset(new ConfigUpdateHandler<SSLTicketKeyConfig>("ssl_ticket_key"));
 
   sslTicketKey->attach("proxy.config.ssl.server.ticket_key.filename");
   SSLConfig::scoped_config params;
@@ -35,20 +35,7 @@
 
 SSLNetProcessor ssl_NetProcessor;
 NetProcessor &sslNetProcessor = ssl_NetProcessor;
-
-#if TS_USE_TLS_OCSP
-struct OCSPContinuation : public Continuation {
-  int
-  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
-  {
-    ocsp_update();
-
-    return EVENT_CONT;
-  }
-
-  OCSPContinuation() : Continuation(new_ProxyMutex()) { SET_HANDLER(&OCSPContinuation::mainEvent); }
-};
-#endif /* TS_USE_TLS_OCSP */
+EventType ET_TLS              = ET_NET;
 
 void
 SSLNetProcessor::cleanup()
@@ -71,18 +58,23 @@ SSLNetProcessor::start(int, size_t stacksize)
   // Acquire a SSLConfigParams instance *after* we start SSL up.
   // SSLConfig::scoped_config params;
 
+  int handshake_threads = 0;
+  REC_ReadConfigInteger(handshake_threads, "proxy.config.ssl.handshake_threads");
+  if (handshake_threads > 0) {
+    ET_TLS                                  = eventProcessor.register_event_type("ET_TLS");
+    NetHandler::active_thread_types[ET_TLS] = true;
+    eventProcessor.schedule_spawn(&initialize_thread_for_net, ET_TLS);
+    eventProcessor.spawn_event_threads(ET_TLS, handshake_threads, stacksize);
+  }
+
   // Initialize SSL statistics. This depends on an initial set of certificates being loaded above.
   SSLInitializeStatistics();
 
 #if TS_USE_TLS_OCSP
   if (SSLConfigParams::ssl_ocsp_enabled) {
-    // Call the update initially to get things populated
-    Note("Initial OCSP refresh started");
-    ocsp_update();
-    Note("Initial OCSP refresh finished");
-
+    // The refresh runs in the background, until its first responses the persisted ones are stapled.
     EventType ET_OCSP = eventProcessor.spawn_event_threads("ET_OCSP", 1, stacksize);
-    eventProcessor.schedule_every(new OCSPContinuation(), HRTIME_SECONDS(SSLConfigParams::ssl_ocsp_update_period), ET_OCSP);
+    ocsp_start(ET_OCSP);
   }
 #endif /* TS_USE_TLS_OCSP */
 
@@ -94,7 +86,13 @@ SSLNetProcessor::start(int, size_t stacksize)
 NetAccept *
 SSLNetProcessor::createNetAccept(const NetProcessor::AcceptOptions &opt)
 {
-  return (NetAccept *)new SSLNetAccept(opt);
+  if (opt.etype != ET_NET || ET_TLS == ET_NET) {
+    return (NetAccept *)new SSLNetAccept(opt);
+  }
+  // Hand the new connections to the handshake threads, they move to ET_NET once the handshake is done.
+  NetProcessor::AcceptOptions tls_opt = opt;
+  tls_opt.etype                       = ET_TLS;
+  return (NetAccept *)new SSLNetAccept(tls_opt);
 }
 
 NetVConnection *
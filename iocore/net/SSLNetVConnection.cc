@@ -42,6 +42,7 @@
 #include "SSLStats.h"
 #include "SSLInternal.h"
 #include "P_ALPNSupport.h"
+#include "ts/sdt.h"
 
 #include <climits>
 #include <string>
@@ -54,6 +55,10 @@ using namespace std::literals;
 #endif
 
 // This is missing from BoringSSL
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send)
+#define TS_HAS_KTLS 1
+#endif
+
 #ifndef BIO_eof
 #define BIO_eof(b) (int)BIO_ctrl(b, BIO_CTRL_EOF, 0, nullptr)
 #endif
@@ -170,7 +175,13 @@ SSLNetVConnection::_make_ssl_connection(SSL_CTX *ctx)
     } else {
       this->initialize_handshake_buffers();
       BIO *rbio = BIO_new(BIO_s_mem());
+#if TS_HAS_KTLS
+      // Only a socket BIO can hand the keys to the kernel.
+      BIO *wbio = SSLConfigParams::ssl_ktls_enabled ? BIO_new_socket(this->get_socket(), BIO_NOCLOSE) :
+                                                      BIO_new_fd(this->get_socket(), BIO_NOCLOSE);
+#else
       BIO *wbio = BIO_new_fd(this->get_socket(), BIO_NOCLOSE);
+#endif
       BIO_set_mem_eof_return(wbio, -1);
       SSL_set_bio(ssl, rbio, wbio);
 
@@ -637,6 +648,11 @@ SSLNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
       writeReschedule(nh);
     } else if (ret == EVENT_DONE) {
       Debug("ssl", "ssl handshake EVENT_DONE ntodo=%" PRId64, ntodo);
+      if (ET_TLS != ET_NET && lthread->is_event_type(ET_TLS)) {
+        // Don't run the session on the handshake thread, continue on a net thread.
+        this->_move_to_net_thread(nh);
+        return;
+      }
       // If this was driven by a zero length read, signal complete when
       // the handshake is complete. Otherwise set up for continuing read
       // operations.
@@ -760,7 +776,8 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
     Debug("ssl", "now=%" PRId64 " lastwrite=%" PRId64 " msec_since_last_write=%d", now, sslLastWriteTime, msec_since_last_write);
   }
 
-  if (HttpProxyPort::TRANSPORT_BLIND_TUNNEL == this->attributes) {
+  // With kTLS the records are made by the kernel, the data goes to the socket as is.
+  if (HttpProxyPort::TRANSPORT_BLIND_TUNNEL == this->attributes || ktls_send) {
     return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
   }
 
@@ -941,10 +958,15 @@ SSLNetVConnection::clear()
   TLSSessionResumptionSupport::clear();
   TLSSNISupport::_clear();
 
+  if (sslAsyncWaitBeginTime) {
+    this->_end_async_wait(0);
+  }
   sslHandshakeStatus          = SSL_HANDSHAKE_ONGOING;
   sslHandshakeBeginTime       = 0;
+  sslHandshakeAcceptTime      = 0;
   sslLastWriteTime            = 0;
   sslTotalBytesSent           = 0;
+  ktls_send                   = false;
   sslClientRenegotiationAbort = false;
 
   curHook         = nullptr;
@@ -1001,14 +1023,15 @@ SSLNetVConnection::sslStartHandShake(int event, int &err)
   }
   if (sslHandshakeBeginTime == 0) {
     sslHandshakeBeginTime = Thread::get_hrtime();
+    ATS_PROBE2(ssl_handshake_start, this, event == SSL_EVENT_CLIENT);
     // net_activity will not be triggered until after the handshake
     set_inactivity_timeout(HRTIME_SECONDS(SSLConfigParams::ssl_handshake_timeout_in));
   }
-  SSLConfig::scoped_config params;
+  SSLConfig::epoch_config params;
   switch (event) {
   case SSL_EVENT_SERVER:
     if (this->ssl == nullptr) {
-      SSLCertificateConfig::scoped_config lookup;
+      SSLCertificateConfig::epoch_config lookup;
       IpEndpoint dst;
       int namelen = sizeof(dst);
       if (0 != safe_getsockname(this->get_socket(), &dst.sa, &namelen)) {
@@ -1065,7 +1088,7 @@ SSLNetVConnection::sslStartHandShake(int event, int &err)
     if (this->ssl == nullptr) {
       // Making the check here instead of later, so we only
       // do this setting immediately after we create the SSL object
-      SNIConfig::scoped_config sniParam;
+      SNIConfig::epoch_config sniParam;
       const char *serverKey = this->options.sni_servername;
       if (!serverKey) {
         ats_ip_ntop(this->get_remote_addr(), buff, INET6_ADDRSTRLEN);
@@ -1239,9 +1262,19 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
     } // Still data in the BIO
   }
 
+  ink_hrtime accept_begin = ink_get_hrtime_internal();
+  if (sslAsyncWaitBeginTime) {
+    this->_end_async_wait(accept_begin);
+  }
   ssl_error_t ssl_error = SSLAccept(ssl);
+  ink_hrtime accept_end = ink_get_hrtime_internal();
+  sslHandshakeAcceptTime += accept_end - accept_begin;
 #if TS_USE_TLS_ASYNC
   if (ssl_error == SSL_ERROR_WANT_ASYNC) {
+    if (sslAsyncWaitBeginTime == 0 && (async_wait_timing = get_SSLHandshakeTiming(this_ethread())) != nullptr) {
+      sslAsyncWaitBeginTime = accept_end;
+      ++async_wait_timing->async_jobs;
+    }
     // Do we need to set up the async eventfd?  Or is it already registered?
     if (async_ep.fd < 0) {
       size_t numfds;
@@ -1297,15 +1330,28 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
     }
 
     sslHandshakeStatus = SSL_HANDSHAKE_DONE;
+    ATS_PROBE3(ssl_handshake_end, this, false, SSL_session_reused(ssl));
 
     if (sslHandshakeBeginTime) {
       sslHandshakeEndTime                 = Thread::get_hrtime();
       const ink_hrtime ssl_handshake_time = sslHandshakeEndTime - sslHandshakeBeginTime;
 
-      Debug("ssl", "ssl handshake time:%" PRId64, ssl_handshake_time);
+      Debug("ssl", "ssl handshake time:%" PRId64 " in SSL_accept:%" PRId64, ssl_handshake_time, sslHandshakeAcceptTime);
       SSL_INCREMENT_DYN_STAT_EX(ssl_total_handshake_time_stat, ssl_handshake_time);
       SSL_INCREMENT_DYN_STAT(ssl_total_success_handshake_count_in_stat);
     }
+    if (SSLHandshakeTiming *timing = get_SSLHandshakeTiming(this_ethread()); timing) {
+      (SSL_session_reused(ssl) ? timing->resumed : timing->full).record(ink_hrtime_to_usec(sslHandshakeAcceptTime));
+    }
+#if TS_HAS_KTLS
+    // OpenSSL turns on kTLS if the kernel supports the negotiated cipher, otherwise the session
+    // stays with encryption in user space.
+    if (SSLConfigParams::ssl_ktls_enabled) {
+      ktls_send = BIO_get_ktls_send(SSL_get_wbio(ssl));
+      SSL_INCREMENT_DYN_STAT(ktls_send ? ssl_ktls_tx_sessions_stat : ssl_ktls_tx_fallback_stat);
+      Debug("ssl", "kTLS transmit %s for cipher %s", ktls_send ? "enabled" : "not available", SSL_get_cipher_name(ssl));
+    }
+#endif
     {
       const unsigned char *proto = nullptr;
       unsigned len               = 0;
@@ -1395,6 +1441,91 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
   }
 }
 
+/// Stop counting the wait for an asynchronous job, recording it unless @a now is 0.
+void
+SSLNetVConnection::_end_async_wait(ink_hrtime now)
+{
+  if (now) {
+    async_wait_timing->async_wait.record(ink_hrtime_to_usec(now - sslAsyncWaitBeginTime));
+  }
+  --async_wait_timing->async_jobs;
+  async_wait_timing     = nullptr;
+  sslAsyncWaitBeginTime = 0;
+}
+
+/*
+ * Take the VC off the handshake thread and pass it to a net thread, which picks up
+ * where net_read_io left off once the handshake was done.
+ *
+ * Like a VC accepted on a thread, the VC then has the mutex of the NetHandler of its new
+ * thread, and so do the VIOs and continuations that were using the mutex of the VC.
+ */
+void
+SSLNetVConnection::_move_to_net_thread(NetHandler *nh)
+{
+  nh->stopCop(this);
+  nh->stopIO(this);
+  this->thread = eventProcessor.assign_thread(ET_NET);
+  SSLVCDebug(this, "moving to net thread %p after the handshake", this->thread);
+
+  Ptr<ProxyMutex> old_mutex = this->mutex;
+  this->mutex               = get_NetHandler(this->thread)->mutex;
+  for (VIO *vio : {&read.vio, &write.vio}) {
+    if (vio->mutex == old_mutex) {
+      vio->mutex = this->mutex;
+    }
+    if (vio->cont && vio->cont->mutex == old_mutex) {
+      vio->cont->mutex = this->mutex;
+    }
+  }
+
+  SET_HANDLER(&SSLNetVConnection::handshakeMigrateEvent);
+  this->thread->schedule_imm(this);
+}
+
+int
+SSLNetVConnection::handshakeMigrateEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  ink_assert(thread == this_ethread());
+  NetHandler *h = get_NetHandler(thread);
+  ink_release_assert(mutex == h->mutex);
+
+  MUTEX_TRY_LOCK(hlock, h->mutex, e->ethread);
+  MUTEX_TRY_LOCK(rlock, read.vio.mutex ? read.vio.mutex : e->ethread->mutex, e->ethread);
+  if (!hlock.is_locked() || !rlock.is_locked() || (read.vio.mutex && rlock.get_mutex() != read.vio.mutex.get())) {
+    thread->schedule_in(this, HRTIME_MSECONDS(net_retry_delay));
+    return EVENT_DONE;
+  }
+
+  SET_HANDLER((NetVConnHandler)&UnixNetVConnection::mainEvent);
+  if (h->startIO(this) < 0) {
+    // Let the state machine close it, the NetHandler frees it then.
+    this->nh = h;
+    h->startCop(this);
+    readSignalError(h, EIO);
+    return EVENT_DONE;
+  }
+  h->startCop(this);
+
+  // The edges the old poll descriptor saw are lost, assume both sides are ready and let the
+  // ready lists find out.
+  write.triggered = 1;
+  if (write.enabled) {
+    h->write_ready_list.in_or_enqueue(this);
+  }
+
+  // Same as the end of the handshake in net_read_io, a closed VC is freed by the ready list.
+  if (!this->closed && read.vio.ntodo() <= 0) {
+    readSignalDone(VC_EVENT_READ_COMPLETE, h);
+  } else {
+    read.triggered = 1;
+    if (read.enabled || this->closed) {
+      h->read_ready_list.in_or_enqueue(this);
+    }
+  }
+  return EVENT_DONE;
+}
+
 int
 SSLNetVConnection::sslClientHandShakeEvent(int &err)
 {
@@ -1453,6 +1584,7 @@ SSLNetVConnection::sslClientHandShakeEvent(int &err)
     SSL_INCREMENT_DYN_STAT(ssl_total_success_handshake_count_out_stat);
 
     sslHandshakeStatus = SSL_HANDSHAKE_DONE;
+    ATS_PROBE3(ssl_handshake_end, this, true, SSL_session_reused(ssl));
     return EVENT_DONE;
 
   case SSL_ERROR_WANT_WRITE:
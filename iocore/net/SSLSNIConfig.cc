@@ -207,6 +207,12 @@ SNIConfig::acquire()
   return (SNIConfigParams *)configProcessor.get(configid);
 }
 
+SNIConfigParams *
+SNIConfig::peek()
+{
+  return (SNIConfigParams *)configProcessor.peek(configid);
+}
+
 void
 SNIConfig::release(SNIConfigParams *params)
 {
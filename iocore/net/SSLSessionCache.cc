@@ -23,6 +23,7 @@
 #include "SSLSessionCache.h"
 #include "SSLStats.h"
 
+#include <algorithm>
 #include <cstring>
 
 #define SSLSESSIONCACHE_STRINGIFY0(x) #x
@@ -73,6 +74,18 @@ SSLSessionCache::getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_ses
           target_bucket, bucket, buf, hash);
   }
 
+  // A copy this thread made earlier is good as long as the session was not replaced or removed since.
+  SSLSessionFrontCache::Entry &entry = SSLSessionFrontCache::entry(sid);
+  if (entry.version != 0 && entry.bucket == bucket && entry.session_id == sid && bucket->slotVersion(entry.slot) == entry.version) {
+    Debug("ssl.session_cache.get", "SessionCache found session in the thread cache");
+    const unsigned char *loc = entry.asn1_data;
+    *sess                    = d2i_SSL_SESSION(nullptr, &loc, entry.len_asn1_data);
+    if (data != nullptr) {
+      *data = &entry.exdata;
+    }
+    return true;
+  }
+
   return bucket->getSession(sid, sess, data);
 }
 
@@ -113,6 +126,93 @@ SSLSessionCache::insertSession(const SSLSessionID &sid, SSL_SESSION *sess, SSL *
   bucket->insertSession(sid, sess, ssl);
 }
 
+SSLSessionFrontCache::Entry &
+SSLSessionFrontCache::entry(const SSLSessionID &sid)
+{
+  static thread_local Entry entries[N_ENTRIES];
+  // Use other bits of the hash than the bucket selection does.
+  return entries[(sid.hash() * 0x9E3779B97F4A7C15ULL) >> 58];
+}
+
+void
+SSLSessionBucket::allocate()
+{
+  nslots     = std::max<size_t>(SSLConfigParams::session_cache_max_bucket_size, 1);
+  uint32_t n = 1;
+  // Keep the index at most half full so that probe sequences stay short.
+  while (n < 2 * nslots) {
+    n <<= 1;
+  }
+  slots.reset(new Slot[nslots]);
+  index.reset(new int32_t[n]);
+  std::fill(index.get(), index.get() + n, NO_SLOT);
+  index_mask = n - 1;
+}
+
+uint32_t
+SSLSessionBucket::find(const SSLSessionID &sid) const
+{
+  uint32_t pos = home(sid);
+  while (index[pos] != NO_SLOT && !(slots[index[pos]].session_id == sid)) {
+    pos = (pos + 1) & index_mask;
+  }
+  return pos;
+}
+
+void
+SSLSessionBucket::erase(uint32_t pos)
+{
+  Slot &slot         = slots[index[pos]];
+  slot.len_asn1_data = 0;
+  slot.referenced.store(false, std::memory_order_relaxed);
+  slot.version.fetch_add(1, std::memory_order_release);
+  --used;
+
+  // Move later entries of the probe sequence back into the hole, unless that would put them
+  // before their home position.
+  uint32_t hole = pos;
+  index[hole]   = NO_SLOT;
+  for (uint32_t j = (pos + 1) & index_mask; index[j] != NO_SLOT; j = (j + 1) & index_mask) {
+    uint32_t h = home(slots[index[j]].session_id);
+    if (((j - h) & index_mask) >= ((j - hole) & index_mask)) {
+      index[hole] = index[j];
+      index[j]    = NO_SLOT;
+      hole        = j;
+    }
+  }
+}
+
+int32_t
+SSLSessionBucket::takeSlot()
+{
+  if (static_cast<uint32_t>(free_slot) < nslots) {
+    return free_slot++;
+  }
+  for (;;) {
+    int32_t s  = clock_hand;
+    Slot &slot = slots[s];
+    clock_hand = (clock_hand + 1) % nslots;
+    if (slot.len_asn1_data == 0) {
+      return s;
+    }
+    if (slot.referenced.exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    if (ssl_rsb) {
+      SSL_INCREMENT_DYN_STAT(ssl_session_cache_eviction);
+    }
+    erase(find(slot.session_id));
+    return s;
+  }
+}
+
+uint64_t
+SSLSessionBucket::slotVersion(int slot) const
+{
+  // The slots are never reallocated, a thread that saw a session in them can look without the lock.
+  return slots && static_cast<uint32_t>(slot) < nslots ? slots[slot].version.load(std::memory_order_acquire) : 0;
+}
+
 void
 SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess, SSL *ssl)
 {
@@ -129,22 +229,15 @@ SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess, SSL *
     Debug("ssl.session_cache", "Inserting session '%s' to bucket %p.", buf, this);
   }
 
-  Ptr<IOBufferData> buf;
-  Ptr<IOBufferData> buf_exdata;
-  size_t len_exdata = sizeof(ssl_session_cache_exdata);
-  buf               = new_IOBufferData(buffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-  ink_release_assert(static_cast<size_t>(buf->block_size()) >= len);
-  unsigned char *loc = reinterpret_cast<unsigned char *>(buf->data());
+  // Serialize before taking the lock, the slot is only written with the lock held.
+  unsigned char asn1_data[SSL_MAX_SESSION_SIZE];
+  unsigned char *loc = asn1_data;
   i2d_SSL_SESSION(sess, &loc);
-  buf_exdata = new_IOBufferData(buffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-  ink_release_assert(static_cast<size_t>(buf_exdata->block_size()) >= len_exdata);
-  ssl_session_cache_exdata *exdata = reinterpret_cast<ssl_session_cache_exdata *>(buf_exdata->data());
+  ssl_session_cache_exdata exdata;
   // This could be moved to a function in charge of populating exdata
-  exdata->curve  = (ssl == nullptr) ? 0 : SSLGetCurveNID(ssl);
+  exdata.curve   = (ssl == nullptr) ? 0 : SSLGetCurveNID(ssl);
   ink_hrtime now = Thread::get_hrtime_updated();
 
-  ats_scoped_obj<SSLSession> ssl_session(new SSLSession(id, buf, len, buf_exdata, now));
-
   std::unique_lock lock(mutex, std::try_to_lock);
   if (!lock.owns_lock()) {
     if (ssl_rsb) {
@@ -157,22 +250,28 @@ SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess, SSL *
   }
 
   PRINT_BUCKET("insertSession before")
-  if (bucket_data.size() >= SSLConfigParams::session_cache_max_bucket_size) {
-    if (ssl_rsb) {
-      SSL_INCREMENT_DYN_STAT(ssl_session_cache_eviction);
-    }
-    removeOldestSession(lock);
+  if (!slots) {
+    this->allocate();
   }
 
   // Don't insert if it is already there
-  if (bucket_data.find(id) != bucket_data.end()) {
+  if (index[find(id)] != NO_SLOT) {
     return;
   }
 
-  /* do the actual insert */
-  auto node           = ssl_session.release();
-  bucket_data[id]     = node;
-  bucket_data_ts[now] = node;
+  int32_t s = takeSlot();
+  // Taking the slot may have moved entries of the index.
+  uint32_t pos       = find(id);
+  Slot &slot         = slots[s];
+  slot.session_id    = id;
+  slot.time_stamp    = now;
+  slot.exdata        = exdata;
+  slot.len_asn1_data = len;
+  memcpy(slot.asn1_data, asn1_data, len);
+  slot.referenced.store(false, std::memory_order_relaxed);
+  slot.version.fetch_add(1, std::memory_order_release);
+  index[pos] = s;
+  ++used;
 
   PRINT_BUCKET("insertSession after")
 }
@@ -192,14 +291,17 @@ SSLSessionBucket::getSessionBuffer(const SSLSessionID &id, char *buffer, int &le
     lock.lock();
   }
 
-  auto node = bucket_data.find(id);
-  if (buffer && node != bucket_data.end()) {
-    true_len                 = node->second->len_asn1_data;
-    const unsigned char *loc = reinterpret_cast<const unsigned char *>(node->second->asn1_data->data());
+  if (!buffer || !slots) {
+    return 0;
+  }
+  uint32_t pos = find(id);
+  if (index[pos] != NO_SLOT) {
+    Slot &slot = slots[index[pos]];
+    true_len   = slot.len_asn1_data;
     if (true_len < len) {
       len = true_len;
     }
-    memcpy(buffer, loc, len);
+    memcpy(buffer, slot.asn1_data, len);
     return true_len;
   }
   return 0;
@@ -229,16 +331,29 @@ SSLSessionBucket::getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_ses
 
   PRINT_BUCKET("getSession")
 
-  auto node = bucket_data.find(id);
-  if (node == bucket_data.end()) {
+  uint32_t pos = slots ? find(id) : 0;
+  if (!slots || index[pos] == NO_SLOT) {
     Debug("ssl.session_cache", "Session with id '%s' not found in bucket %p.", buf, this);
     return false;
   }
-  const unsigned char *loc = reinterpret_cast<const unsigned char *>(node->second->asn1_data->data());
-  *sess                    = d2i_SSL_SESSION(nullptr, &loc, node->second->len_asn1_data);
+
+  // Copy the session to the thread cache, and decode it from there without the lock.
+  Slot &slot = slots[index[pos]];
+  slot.referenced.store(true, std::memory_order_relaxed);
+  SSLSessionFrontCache::Entry &entry = SSLSessionFrontCache::entry(id);
+  entry.session_id                   = id;
+  entry.bucket                       = this;
+  entry.slot                         = index[pos];
+  entry.version                      = slot.version.load(std::memory_order_relaxed);
+  entry.exdata                       = slot.exdata;
+  entry.len_asn1_data                = slot.len_asn1_data;
+  memcpy(entry.asn1_data, slot.asn1_data, slot.len_asn1_data);
+  lock.unlock();
+
+  const unsigned char *loc = entry.asn1_data;
+  *sess                    = d2i_SSL_SESSION(nullptr, &loc, entry.len_asn1_data);
   if (data != nullptr) {
-    ssl_session_cache_exdata *exdata = reinterpret_cast<ssl_session_cache_exdata *>(node->second->extra_data->data());
-    *data                            = exdata;
+    *data = &entry.exdata;
   }
   return true;
 }
@@ -251,43 +366,31 @@ void inline SSLSessionBucket::print(const char *ref_str) const
   }
 
   fprintf(stderr, "-------------- BUCKET %p (%s) ----------------\n", this, ref_str);
-  fprintf(stderr, "Current Size: %ld, Max Size: %zd\n", bucket_data.size(), SSLConfigParams::session_cache_max_bucket_size);
+  fprintf(stderr, "Current Size: %u, Max Size: %zd\n", used, SSLConfigParams::session_cache_max_bucket_size);
   fprintf(stderr, "Bucket: \n");
 
-  for (auto &x : bucket_data) {
-    char s_buf[2 * x.second->session_id.len + 1];
-    x.second->session_id.toString(s_buf, sizeof(s_buf));
-    fprintf(stderr, "  %s\n", s_buf);
+  for (uint32_t s = 0; slots && s < nslots; ++s) {
+    if (slots[s].len_asn1_data) {
+      char s_buf[2 * slots[s].session_id.len + 1];
+      slots[s].session_id.toString(s_buf, sizeof(s_buf));
+      fprintf(stderr, "  %s\n", s_buf);
+    }
   }
 }
 
-void inline SSLSessionBucket::removeOldestSession(const std::unique_lock<std::shared_mutex> &lock)
-{
-  // Caller must hold the bucket shared_mutex with unique_lock.
-  ink_assert(lock.owns_lock());
-
-  PRINT_BUCKET("removeOldestSession before")
-
-  auto node = bucket_data_ts.begin();
-  bucket_data.erase(node->second->session_id);
-  bucket_data_ts.erase(node);
-
-  PRINT_BUCKET("removeOldestSession after")
-}
-
 void
 SSLSessionBucket::removeSession(const SSLSessionID &id)
 {
   // We can't bail on contention here because this session MUST be removed.
   std::unique_lock lock(mutex);
 
-  auto node = bucket_data.find(id);
-
   PRINT_BUCKET("removeSession before")
 
-  if (node != bucket_data.end()) {
-    bucket_data_ts.erase(node->second->time_stamp);
-    bucket_data.erase(node);
+  if (slots) {
+    uint32_t pos = find(id);
+    if (index[pos] != NO_SLOT) {
+      erase(pos);
+    }
   }
 
   PRINT_BUCKET("removeSession after")
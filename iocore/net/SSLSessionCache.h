@@ -29,6 +29,8 @@
 #include "P_SSLUtils.h"
 #include "ts/apidefs.h"
 #include <openssl/ssl.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 
@@ -79,7 +81,8 @@ struct SSLSessionID : public TSSslSessionID {
     if (other.len)
       memcpy(bytes, other.bytes, other.len);
 
-    len = other.len;
+    len        = other.len;
+    hash_value = other.hash_value;
     return *this;
   }
 
@@ -118,8 +121,10 @@ struct SSLSessionID : public TSSslSessionID {
       // however we need to combine them if the length is longer than 64bits
       if (len >= sizeof(uint64_t)) {
         uint64_t seed = 0;
-        for (uint64_t i = 0; i < len; i += sizeof(uint64_t)) {
-          hash_combine(seed, static_cast<uint64_t>(bytes[i]));
+        for (uint64_t i = 0; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+          uint64_t word;
+          memcpy(&word, bytes + i, sizeof(word));
+          hash_combine(seed, word);
         }
         hash_value = seed;
       } else if (len) {
@@ -143,24 +148,12 @@ struct SSLSessionIDHash {
   }
 };
 
-class SSLSession
-{
-public:
-  SSLSessionID session_id;
-  Ptr<IOBufferData> asn1_data; /* this is the ASN1 representation of the SSL_CTX */
-  size_t len_asn1_data;
-  Ptr<IOBufferData> extra_data;
-  ink_hrtime time_stamp;
-
-  SSLSession(const SSLSessionID &id, const Ptr<IOBufferData> &ssl_asn1_data, size_t len_asn1, Ptr<IOBufferData> &exdata,
-             ink_hrtime ts)
-    : session_id(id), asn1_data(ssl_asn1_data), len_asn1_data(len_asn1), extra_data(exdata), time_stamp(ts)
-  {
-  }
-
-  LINK(SSLSession, link);
-};
+/** A part of the session cache with its own lock.
 
+    The sessions are kept in slots allocated with the bucket, found through an open addressing
+    index of slot numbers. When the bucket is full the slot to reuse is picked by a clock sweep,
+    skipping once the slots that were used since the last pass.
+*/
 class SSLSessionBucket
 {
 public:
@@ -171,14 +164,49 @@ public:
   int getSessionBuffer(const SSLSessionID &sid, char *buffer, int &len);
   void removeSession(const SSLSessionID &sid);
 
+  /// A session in the bucket.
+  struct Slot {
+    SSLSessionID session_id{nullptr, 0};
+    ink_hrtime time_stamp = 0;
+    ssl_session_cache_exdata exdata;
+    size_t len_asn1_data = 0; ///< Size of the ASN1 representation of the session, 0 if the slot is free.
+    unsigned char asn1_data[SSL_MAX_SESSION_SIZE];
+    std::atomic<bool> referenced{false}; ///< Used since the clock last passed.
+    /// Changed whenever the slot is reused or cleared, so that copies of it can tell they are stale.
+    std::atomic<uint64_t> version{0};
+  };
+
+  /// The version of @a slot, 0 if the bucket has no such slot.
+  uint64_t slotVersion(int slot) const;
+
 private:
+  static constexpr int32_t NO_SLOT = -1;
+
   /* these method must be used while hold the lock */
   void print(const char *) const;
-  void removeOldestSession(const std::unique_lock<std::shared_mutex> &lock);
+  void allocate();
+  /// Position of @a sid in the index, or of the free position where it would go.
+  uint32_t find(const SSLSessionID &sid) const;
+  /// Clear the slot at index position @a pos and close the gap it leaves in the index.
+  void erase(uint32_t pos);
+  /// Pick a slot for a new session, evicting a session if there is no free one.
+  int32_t takeSlot();
+
+  uint32_t
+  home(const SSLSessionID &sid) const
+  {
+    // The bucket has been picked by the low bits.
+    return static_cast<uint32_t>((sid.hash() * 0x9E3779B97F4A7C15ULL) >> 32) & index_mask;
+  }
 
   mutable std::shared_mutex mutex;
-  std::unordered_map<SSLSessionID, SSLSession *, SSLSessionIDHash> bucket_data;
-  std::map<ink_hrtime, SSLSession *> bucket_data_ts;
+  std::unique_ptr<Slot[]> slots;
+  std::unique_ptr<int32_t[]> index; ///< Slot numbers, @c NO_SLOT for free positions.
+  uint32_t index_mask = 0;
+  uint32_t nslots     = 0;
+  uint32_t used       = 0;
+  uint32_t clock_hand = 0;
+  int32_t free_slot   = 0; ///< Slots from this one up have never been used.
 };
 
 class SSLSessionCache
@@ -198,3 +226,24 @@ private:
   SSLSessionBucket *session_bucket = nullptr;
   size_t nbuckets;
 };
+
+/// Sessions recently found in the shared cache by the current thread.
+class SSLSessionFrontCache
+{
+public:
+  static constexpr int N_ENTRIES = 64;
+
+  /// Copy of a session, valid while the slot it was copied from has @a version.
+  struct Entry {
+    SSLSessionID session_id{nullptr, 0};
+    const SSLSessionBucket *bucket = nullptr;
+    int32_t slot                   = 0;
+    uint64_t version               = 0;
+    ssl_session_cache_exdata exdata;
+    size_t len_asn1_data = 0;
+    unsigned char asn1_data[SSL_MAX_SESSION_SIZE];
+  };
+
+  /// The entry for @a sid, which may hold another session.
+  static Entry &entry(const SSLSessionID &sid);
+};
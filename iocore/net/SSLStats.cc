@@ -24,12 +24,120 @@
 #include "SSLStats.h"
 
 #include <openssl/err.h>
+#include <vector>
 
+#include "P_EventSystem.h"
+#include "I_Net.h"
+#include "P_SSLNetProcessor.h"
 #include "P_SSLConfig.h"
 #include "P_SSLUtils.h"
 
 RecRawStatBlock *ssl_rsb = nullptr;
 std::unordered_map<std::string, intptr_t> cipher_map;
+int ssl_handshake_timing_offset = -1;
+
+namespace
+{
+struct HandshakeTimingStat {
+  char const *name;
+  SSLHandshakeTiming::Histogram SSLHandshakeTiming::*histogram;
+};
+constexpr HandshakeTimingStat HANDSHAKE_TIMING_STATS[] = {
+  {"full", &SSLHandshakeTiming::full},
+  {"resumed", &SSLHandshakeTiming::resumed},
+  {"client_hello", &SSLHandshakeTiming::client_hello},
+  {"cert", &SSLHandshakeTiming::cert},
+  {"async_wait", &SSLHandshakeTiming::async_wait},
+};
+constexpr int N_HANDSHAKE_TIMING_STATS = sizeof(HANDSHAKE_TIMING_STATS) / sizeof(*HANDSHAKE_TIMING_STATS);
+
+struct HandshakeTimingQuantile {
+  char const *name;
+  double q;
+};
+constexpr HandshakeTimingQuantile HANDSHAKE_TIMING_QUANTILES[] = {{"p50", 0.5}, {"p99", 0.99}, {"max", 1.0}};
+constexpr int N_HANDSHAKE_TIMING_QUANTILES = sizeof(HANDSHAKE_TIMING_QUANTILES) / sizeof(*HANDSHAKE_TIMING_QUANTILES);
+
+/// Id of the process wide count of handshakes waiting for asynchronous jobs, the per thread counts follow.
+constexpr int ASYNC_JOBS_STAT = N_HANDSHAKE_TIMING_STATS * N_HANDSHAKE_TIMING_QUANTILES;
+
+/// Threads that run handshakes, the net threads followed by any dedicated handshake threads.
+std::vector<EThread *> handshake_timing_threads;
+/// Thread histograms as of the previous sync, the published values cover the change since then.
+SSLHandshakeTiming::Histogram (*handshake_timing_snapshot)[N_HANDSHAKE_TIMING_STATS] = nullptr;
+
+int
+SSLHandshakeTimingStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int)
+{
+  auto publish = [rsb](int id, int64_t value) {
+    rsb->global[id]->sum   = value;
+    rsb->global[id]->count = 1;
+    RecRawStatUpdateSum(rsb, id);
+  };
+  SSLHandshakeTiming::Histogram total[N_HANDSHAKE_TIMING_STATS];
+  int n              = handshake_timing_threads.size();
+  int64_t async_jobs = 0;
+
+  ink_mutex_acquire(&(rsb->mutex));
+
+  for (int i = 0; i < n; ++i) {
+    SSLHandshakeTiming *timing = get_SSLHandshakeTiming(handshake_timing_threads[i]);
+    for (int s = 0; s < N_HANDSHAKE_TIMING_STATS; ++s) {
+      // Racy read of the thread's counters, being slightly behind is fine.
+      auto cur   = timing->*HANDSHAKE_TIMING_STATS[s].histogram;
+      auto delta = cur;
+      delta -= handshake_timing_snapshot[i][s];
+      handshake_timing_snapshot[i][s] = cur;
+      total[s] += delta;
+    }
+    int64_t jobs = timing->async_jobs.load(std::memory_order_relaxed);
+    publish(ASYNC_JOBS_STAT + 1 + i, jobs);
+    async_jobs += jobs;
+  }
+
+  for (int s = 0; s < N_HANDSHAKE_TIMING_STATS; ++s) {
+    for (int v = 0; v < N_HANDSHAKE_TIMING_QUANTILES; ++v) {
+      publish(s * N_HANDSHAKE_TIMING_QUANTILES + v, total[s].percentile(HANDSHAKE_TIMING_QUANTILES[v].q));
+    }
+  }
+  publish(ASYNC_JOBS_STAT, async_jobs);
+
+  ink_mutex_release(&(rsb->mutex));
+  return REC_ERR_OKAY;
+}
+
+void
+register_handshake_timing_stats()
+{
+  auto add_threads = [](EventType etype) {
+    EventProcessor::ThreadGroupDescriptor *tg = &eventProcessor.thread_group[etype];
+    handshake_timing_threads.insert(handshake_timing_threads.end(), tg->_thread, tg->_thread + tg->_count);
+  };
+  add_threads(ET_NET);
+  if (ET_TLS != ET_NET) {
+    add_threads(ET_TLS);
+  }
+  int n_threads        = handshake_timing_threads.size();
+  RecRawStatBlock *rsb = RecAllocateRawStatBlock(ASYNC_JOBS_STAT + 1 + n_threads);
+  char name[256];
+  int id = 0;
+
+  for (auto const &stat : HANDSHAKE_TIMING_STATS) {
+    for (auto const &quantile : HANDSHAKE_TIMING_QUANTILES) {
+      snprintf(name, sizeof(name), "proxy.process.ssl.handshake.%s.%s", stat.name, quantile.name);
+      RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id++, nullptr);
+    }
+  }
+  RecRegisterRawStat(rsb, RECT_PROCESS, "proxy.process.ssl.async_jobs_outstanding", RECD_INT, RECP_NON_PERSISTENT, id++, nullptr);
+  for (int i = 0; i < n_threads; ++i) {
+    snprintf(name, sizeof(name), "proxy.process.ssl.thread.%d.async_jobs_outstanding", i);
+    RecRegisterRawStat(rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, id++, nullptr);
+  }
+
+  handshake_timing_snapshot = new SSLHandshakeTiming::Histogram[n_threads][N_HANDSHAKE_TIMING_STATS];
+  RecRegisterRawStatSyncCb(name, SSLHandshakeTimingStatSync, rsb, 0);
+}
+} // namespace
 
 static int
 SSLRecRawStatSyncCount(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
@@ -78,6 +186,12 @@ SSLInitializeStatistics()
   ssl_rsb = RecAllocateRawStatBlock(static_cast<int>(Ssl_Stat_Count));
   ink_assert(ssl_rsb != nullptr);
 
+  // The net threads are running already, their private data is zeroed so the timing needs no set up.
+  ssl_handshake_timing_offset = eventProcessor.allocate(sizeof(SSLHandshakeTiming));
+  if (ssl_handshake_timing_offset >= 0) {
+    register_handshake_timing_stats();
+  }
+
   // SSL client errors.
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.user_agent_other_errors", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_user_agent_other_errors_stat, RecRawStatSyncSum);
@@ -181,6 +295,18 @@ SSLInitializeStatistics()
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.redo_record_size_count", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_total_dyn_redo_tls_record_count, RecRawStatSyncCount);
 
+  // kTLS
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls_tx_sessions", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_tx_sessions_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls_tx_fallback", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_tx_fallback_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.lazy_cert_loaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_lazy_cert_loaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.lazy_cert_load_failed", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_lazy_cert_load_failed_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.lazy_cert_evicted", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_lazy_cert_evicted_stat, RecRawStatSyncCount);
+
   // error stats
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ssl_error_syscall", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_error_syscall, RecRawStatSyncCount);
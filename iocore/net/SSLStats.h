@@ -23,9 +23,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 
+#include "tscore/Histogram.h"
 #include "records/I_RecProcess.h"
+#include "I_EThread.h"
 #include "SSLDiags.h"
 
 /* Stats should only be accessed using these macros */
@@ -85,6 +88,11 @@ enum SSL_Stats {
   ssl_session_cache_lock_contention,
   ssl_session_cache_new_session,
   ssl_early_data_received_count, // how many times we received early data
+  ssl_ktls_tx_sessions_stat,     // sessions the kernel encrypts for
+  ssl_ktls_tx_fallback_stat,     // sessions kTLS was asked for but not available
+  ssl_lazy_cert_loaded_stat,      // deferred certificate contexts made
+  ssl_lazy_cert_load_failed_stat, // deferred certificate contexts that failed to load
+  ssl_lazy_cert_evicted_stat,     // deferred certificate contexts dropped to stay under the limit
 
   /* error stats */
   ssl_error_syscall,
@@ -113,6 +121,56 @@ enum SSL_Stats {
   Ssl_Stat_Count
 };
 
+/** The cost of the inbound handshakes on a thread, in microseconds.
+
+    This is in the private data of the thread and only the thread records into it, the stats sync
+    publishes percentiles of the change since the previous sync as for the event loop latency. The
+    thread data starts zeroed, which is a valid empty instance, so it is not constructed.
+ */
+struct SSLHandshakeTiming {
+  using Histogram = ts::Histogram<30, 3>;
+
+  Histogram full;                  ///< Time spent in SSL_accept by a full handshake, all the calls together.
+  Histogram resumed;               ///< Time spent in SSL_accept by a resumed handshake.
+  Histogram client_hello;          ///< ClientHello processing, with the sni.yaml actions and the plugin hooks.
+  Histogram cert;                  ///< Certificate selection, with making a deferred context.
+  Histogram async_wait;            ///< Time a handshake waited for an asynchronous crypto job.
+  std::atomic<int64_t> async_jobs; ///< Handshakes started on this thread that wait for an asynchronous job.
+};
+
+/// Offset of the @c SSLHandshakeTiming in the thread private data, -1 if there is none.
+extern int ssl_handshake_timing_offset;
+
+inline SSLHandshakeTiming *
+get_SSLHandshakeTiming(EThread *t)
+{
+  if (t == nullptr || ssl_handshake_timing_offset < 0) {
+    return nullptr;
+  }
+  return static_cast<SSLHandshakeTiming *>(ETHREAD_GET_PTR(t, ssl_handshake_timing_offset));
+}
+
+/// Record the time from construction to destruction in a handshake timing histogram of this thread.
+class SSLHandshakePhaseTimer
+{
+public:
+  explicit SSLHandshakePhaseTimer(SSLHandshakeTiming::Histogram SSLHandshakeTiming::*histogram)
+    : _histogram(histogram), _begin(ink_get_hrtime_internal())
+  {
+  }
+
+  ~SSLHandshakePhaseTimer()
+  {
+    if (SSLHandshakeTiming *timing = get_SSLHandshakeTiming(this_ethread()); timing) {
+      (timing->*_histogram).record(ink_hrtime_to_usec(ink_get_hrtime_internal() - _begin));
+    }
+  }
+
+private:
+  SSLHandshakeTiming::Histogram SSLHandshakeTiming::*_histogram;
+  ink_hrtime _begin;
+};
+
 extern RecRawStatBlock *ssl_rsb;
 extern std::unordered_map<std::string, intptr_t> cipher_map;
 
@@ -44,6 +44,8 @@
 #include "SSLDiags.h"
 #include "SSLStats.h"
 
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <unistd.h>
 #include <termios.h>
@@ -284,7 +286,7 @@ set_context_cert(SSL *ssl)
   if (likely(servername)) {
     cc = lookup->find(const_cast<char *>(servername));
     if (cc) {
-      ctx = cc->getCtx();
+      ctx = cc->loadCtx();
     }
     if (cc && ctx && SSLCertContextOption::OPT_TUNNEL == cc->opt && netvc->get_is_transparent()) {
       netvc->attributes = HttpProxyPort::TRANSPORT_BLIND_TUNNEL;
@@ -364,6 +366,7 @@ ssl_verify_client_callback(int preverify_ok, X509_STORE_CTX *ctx)
 static int
 ssl_client_hello_callback(SSL *s, int *al, void *arg)
 {
+  SSLHandshakePhaseTimer timer(&SSLHandshakeTiming::client_hello);
   TLSSNISupport *snis = TLSSNISupport::getInstance(s);
   if (snis) {
     snis->on_client_hello(s, al, arg);
@@ -418,6 +421,7 @@ ssl_cert_callback(SSL *ssl, void * /*arg*/)
   // Do the common certificate lookup only once.  If we pause
   // and restart processing, do not execute the common logic again
   if (!netvc->calledHooks(TS_EVENT_SSL_CERT)) {
+    SSLHandshakePhaseTimer timer(&SSLHandshakeTiming::cert);
     retval = set_context_cert(ssl);
     if (retval != 1) {
       return retval;
@@ -444,6 +448,9 @@ ssl_servername_callback(SSL *ssl, int *al, void *arg)
 {
   TLSSNISupport *snis = TLSSNISupport::getInstance(ssl);
   if (snis) {
+#if !TS_USE_HELLO_CB
+    SSLHandshakePhaseTimer timer(&SSLHandshakeTiming::client_hello);
+#endif
     snis->on_servername(ssl, al, arg);
 #if !TS_USE_HELLO_CB
     // Only call the SNI actions here if not already performed in the HELLO_CB
@@ -919,9 +926,7 @@ SSLPrivateKeyHandler(SSL_CTX *ctx, const SSLConfigParams *params, const std::str
         SSLError("failed to load server private key from %s", (const char *)completeServerKeyPath);
         return false;
       }
-      if (SSLConfigParams::load_ssl_file_cb) {
-        SSLConfigParams::load_ssl_file_cb(completeServerKeyPath);
-      }
+      SSLNotifyFileLoaded(completeServerKeyPath);
     } else {
       SSLError("empty SSL private key path in %s", ts::filename::RECORDS);
       return false;
@@ -1191,6 +1196,12 @@ SSLMultiCertConfigLoader::init_server_ssl_ctx(CertLoadData const &data, const SS
   SSL_CTX_set_options(ctx, SSL_OP_SAFARI_ECDHE_ECDSA_BUG);
 #endif
 
+#ifdef SSL_OP_ENABLE_KTLS
+  if (SSLConfigParams::ssl_ktls_enabled) {
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+  }
+#endif
+
   if (sslMultCertSettings) {
     if (sslMultCertSettings->dialog) {
       passphrase_cb_userdata ud(params, sslMultCertSettings->dialog, sslMultCertSettings->first_cert, sslMultCertSettings->key);
@@ -1328,9 +1339,7 @@ SSLMultiCertConfigLoader::init_server_ssl_ctx(CertLoadData const &data, const SS
   SSL_CTX_set_next_protos_advertised_cb(ctx, SSLNetVConnection::advertise_next_protocol, nullptr);
   SSL_CTX_set_alpn_select_cb(ctx, SSLNetVConnection::select_next_protocol, nullptr);
 
-  if (SSLConfigParams::init_ssl_ctx_cb) {
-    SSLConfigParams::init_ssl_ctx_cb(ctx, true);
-  }
+  SSLNotifyCtxInitialized(ctx, true);
 
   return ctx;
 
@@ -1383,60 +1392,157 @@ SSLCreateServerContext(const SSLConfigParams *params, const SSLMultiCertConfigPa
 bool
 SSLMultiCertConfigLoader::_store_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams &sslMultCertSettings)
 {
-  bool retval = true;
+  PendingCert pending;
+  pending.settings = sslMultCertSettings;
+  this->_prepare_ssl_ctx(pending);
+  return this->_store_pending_ssl_ctx(lookup, pending);
+}
+
+/**
+   Load the certificates of one line and make its SSL_CTXs. This does not touch the lookup, so that lines can be
+   prepared on several threads at once.
+ */
+void
+SSLMultiCertConfigLoader::_prepare_ssl_ctx(PendingCert &pending)
+{
   std::vector<X509 *> cert_list;
-  std::set<std::string> common_names;
   std::unordered_map<int, std::set<std::string>> unique_names;
-  SSLMultiCertConfigLoader::CertLoadData data;
+  const SSLMultiCertConfigParams *sslMultCertSettings = pending.settings.get();
 
   const SSLConfigParams *params = this->_params;
 
-  this->load_certs_and_cross_reference_names(cert_list, data, params, sslMultCertSettings.get(), common_names, unique_names);
+  this->load_certs_and_cross_reference_names(cert_list, pending.data, params, sslMultCertSettings, pending.common_names,
+                                             unique_names);
 
   int i = 0;
   for (auto cert : cert_list) {
-    const char *current_cert_name = data.cert_names_list[i].c_str();
+    const char *current_cert_name = pending.data.cert_names_list[i].c_str();
     if (0 > SSLMultiCertConfigLoader::check_server_cert_now(cert, current_cert_name)) {
       /* At this point, we know cert is bad, and we've already printed a
          descriptive reason as to why cert is bad to the log file */
       Debug(this->_debug_tag(), "Marking certificate as NOT VALID: %s", current_cert_name);
-      lookup->is_valid = false;
+      pending.cert_valid = false;
     }
     i++;
   }
 
-  shared_SSL_CTX ctx(this->init_server_ssl_ctx(data, sslMultCertSettings.get(), common_names), SSL_CTX_free);
+  // Only contexts selected by the server name can wait for the first handshake.
+  pending.lazy = this->_params->configLazyLoad && this->_can_defer_ctx() && sslMultCertSettings && !sslMultCertSettings->addr &&
+                 sslMultCertSettings->opt != SSLCertContextOption::OPT_TUNNEL;
 
-  if (!ctx || !sslMultCertSettings || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, ctx, common_names)) {
-    retval = false;
-    std::string names;
-    for (auto name : data.cert_names_list) {
-      names.append(name);
-      names.append(" ");
-    }
-    Warning("(%s) Failed to insert SSL_CTX for certificate %s entries for names already made", this->_debug_tag(), names.c_str());
+  if (!pending.lazy) {
+    pending.ctx.reset(this->init_server_ssl_ctx(pending.data, sslMultCertSettings, pending.common_names), SSL_CTX_free);
   }
 
-  for (auto iter = unique_names.begin(); retval && iter != unique_names.end(); ++iter) {
+  for (auto iter = unique_names.begin(); (pending.lazy || pending.ctx) && iter != unique_names.end(); ++iter) {
     size_t i = iter->first;
 
-    SSLMultiCertConfigLoader::CertLoadData single_data;
-    single_data.cert_names_list.push_back(data.cert_names_list[i]);
-    if (i < data.key_list.size()) {
-      single_data.key_list.push_back(data.key_list[i]);
+    PendingCert::Unique &single = pending.unique.emplace_back();
+    single.names                = std::move(iter->second);
+    single.data.cert_names_list.push_back(pending.data.cert_names_list[i]);
+    if (i < pending.data.key_list.size()) {
+      single.data.key_list.push_back(pending.data.key_list[i]);
     }
-    single_data.ca_list.push_back(i < data.ca_list.size() ? data.ca_list[i] : "");
-    single_data.ocsp_list.push_back(i < data.ocsp_list.size() ? data.ocsp_list[i] : "");
+    single.data.ca_list.push_back(i < pending.data.ca_list.size() ? pending.data.ca_list[i] : "");
+    single.data.ocsp_list.push_back(i < pending.data.ocsp_list.size() ? pending.data.ocsp_list[i] : "");
 
-    shared_SSL_CTX unique_ctx(this->init_server_ssl_ctx(single_data, sslMultCertSettings.get(), iter->second), SSL_CTX_free);
-    if (!unique_ctx || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, unique_ctx, iter->second)) {
-      retval = false;
+    if (!pending.lazy) {
+      single.ctx.reset(this->init_server_ssl_ctx(single.data, sslMultCertSettings, single.names), SSL_CTX_free);
     }
   }
 
   for (auto &i : cert_list) {
     X509_free(i);
   }
+}
+
+/**
+   Prepare all the lines on proxy.config.ssl.server.multicert.load_threads threads. Lines with a passphrase dialog are
+   prepared on this thread, as the builtin dialog reads from the terminal.
+ */
+void
+SSLMultiCertConfigLoader::_prepare_ssl_ctxs(std::vector<PendingCert> &pending)
+{
+  struct Work {
+    SSLMultiCertConfigLoader *loader;
+    std::vector<PendingCert *> todo;
+    std::atomic<size_t> next{0};
+
+    void
+    run()
+    {
+      for (size_t i; (i = next++) < todo.size();) {
+        loader->_prepare_ssl_ctx(*todo[i]);
+      }
+    }
+
+    static void *
+    thread_main(void *arg)
+    {
+      // The SSL code counts stats and errors in the EThread it runs on.
+      EThread *thread = new EThread;
+      thread->set_specific();
+      static_cast<Work *>(arg)->run();
+      delete thread;
+      return nullptr;
+    }
+  } work;
+
+  work.loader = this;
+  for (auto &p : pending) {
+    if (p.settings->dialog) {
+      this->_prepare_ssl_ctx(p);
+    } else {
+      work.todo.push_back(&p);
+    }
+  }
+
+  size_t n_threads = std::min<size_t>(std::max(this->_params->configLoadThreads, 1), work.todo.size());
+  std::vector<ink_thread> threads(n_threads > 1 ? n_threads - 1 : 0);
+  for (auto &t : threads) {
+    ink_thread_create(&t, &Work::thread_main, &work, 0, 0, nullptr);
+  }
+  work.run();
+  for (auto &t : threads) {
+    ink_thread_join(t);
+  }
+}
+
+/**
+   Index the SSL_CTXs of a prepared line, in the order of the lines so that the first line for a name wins.
+ */
+bool
+SSLMultiCertConfigLoader::_store_pending_ssl_ctx(SSLCertLookup *lookup, PendingCert &pending)
+{
+  bool retval = true;
+
+  if (!pending.cert_valid) {
+    lookup->is_valid = false;
+  }
+
+  if (pending.lazy) {
+    retval = this->_store_lazy_ssl_ctx(lookup, pending.settings, pending.data, pending.common_names);
+  } else {
+    retval =
+      pending.ctx && pending.settings && this->_store_single_ssl_ctx(lookup, pending.settings, pending.ctx, pending.common_names);
+  }
+
+  if (!retval) {
+    std::string names;
+    for (auto name : pending.data.cert_names_list) {
+      names.append(name);
+      names.append(" ");
+    }
+    Warning("(%s) Failed to insert SSL_CTX for certificate %s entries for names already made", this->_debug_tag(), names.c_str());
+  }
+
+  for (auto iter = pending.unique.begin(); retval && iter != pending.unique.end(); ++iter) {
+    if (pending.lazy) {
+      retval = this->_store_lazy_ssl_ctx(lookup, pending.settings, iter->data, iter->names);
+    } else if (!iter->ctx || !this->_store_single_ssl_ctx(lookup, pending.settings, iter->ctx, iter->names)) {
+      retval = false;
+    }
+  }
 
   return retval;
 }
@@ -1484,9 +1590,7 @@ SSLMultiCertConfigLoader::_store_single_ssl_ctx(SSLCertLookup *lookup, const sha
   }
 
   if (inserted) {
-    if (SSLConfigParams::init_ssl_ctx_cb) {
-      SSLConfigParams::init_ssl_ctx_cb(ctx.get(), true);
-    }
+    SSLNotifyCtxInitialized(ctx.get(), true);
   }
 
   if (!inserted) {
@@ -1496,6 +1600,49 @@ SSLMultiCertConfigLoader::_store_single_ssl_ctx(SSLCertLookup *lookup, const sha
   return ctx.get();
 }
 
+/**
+   Index the names of a certificate whose SSL_CTX is made by the first handshake that selects it, see
+   proxy.config.ssl.server.multicert.lazy_load.
+ */
+bool
+SSLMultiCertConfigLoader::_store_lazy_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams &sslMultCertSettings,
+                                              CertLoadData const &data, std::set<std::string> const &names)
+{
+  bool inserted = false;
+  auto lazy     = std::make_shared<SSLCertLazyContext>([sslMultCertSettings, data, names = names]() mutable -> SSL_CTX * {
+    // Made long after the load, so use the configuration that is current then.
+    SSLConfig::scoped_config params;
+    SSLMultiCertConfigLoader loader(params);
+    SSL_CTX *ctx = loader.init_server_ssl_ctx(data, sslMultCertSettings.get(), names);
+    if (ctx == nullptr) {
+      Error("failed to load deferred certificate %s", data.cert_names_list.empty() ? "" : data.cert_names_list[0].c_str());
+      return nullptr;
+    }
+    // As for the contexts made at load, which use the session ticket key block of the default context.
+    if (sslMultCertSettings->session_ticket_enabled != 0) {
+      ticket_block_free(ssl_context_enable_tickets(ctx, nullptr));
+    }
+    SSLNotifyCtxInitialized(ctx, true);
+    return ctx;
+  });
+
+  for (auto const &sni_name : names) {
+    SSLCertContext cc(shared_SSL_CTX{}, sslMultCertSettings);
+    cc.lazy = lazy;
+    if (SSLMultiCertConfigLoader::index_certificate(lookup, cc, sni_name.c_str())) {
+      inserted = true;
+    }
+  }
+
+  return inserted;
+}
+
+bool
+SSLMultiCertConfigLoader::_can_defer_ctx() const
+{
+  return true;
+}
+
 static bool
 ssl_extract_certificate(const matcher_line *line_info, SSLMultiCertConfigParams *sslMultCertSettings)
 {
@@ -1600,6 +1747,10 @@ SSLMultiCertConfigLoader::load(SSLCertLookup *lookup)
   REC_ReadConfigInteger(elevate_setting, "proxy.config.ssl.cert.load_elevated");
   ElevateAccess elevate_access(elevate_setting ? ElevateAccess::FILE_PRIVILEGE : 0);
 
+  SSLCertLazyContext::set_limit(params->configLazyLoadMaxContexts);
+
+  std::vector<PendingCert> pending;
+
   line = tokLine(content.data(), &tok_state);
   while (line != nullptr) {
     line_num++;
@@ -1622,7 +1773,7 @@ SSLMultiCertConfigLoader::load(SSLCertLookup *lookup)
         if (ssl_extract_certificate(&line_info, sslMultiCertSettings.get())) {
           // There must be a certificate specified unless the tunnel action is set
           if (sslMultiCertSettings->cert || sslMultiCertSettings->opt != SSLCertContextOption::OPT_TUNNEL) {
-            this->_store_ssl_ctx(lookup, sslMultiCertSettings);
+            pending.emplace_back().settings = sslMultiCertSettings;
           } else {
             Warning("No ssl_cert_name specified and no tunnel action set");
           }
@@ -1633,6 +1784,12 @@ SSLMultiCertConfigLoader::load(SSLCertLookup *lookup)
     line = tokLine(nullptr, &tok_state);
   }
 
+  // Make the contexts of all the lines before any is indexed, the lookup is not used until all are.
+  this->_prepare_ssl_ctxs(pending);
+  for (auto &p : pending) {
+    this->_store_pending_ssl_ctx(lookup, p);
+  }
+
   // We *must* have a default context even if it can't possibly work. The default context is used to
   // bootstrap the SSL handshake so that we can subsequently do the SNI lookup to switch to the real
   // context.
@@ -1648,6 +1805,26 @@ SSLMultiCertConfigLoader::load(SSLCertLookup *lookup)
   return true;
 }
 
+static std::mutex ssl_notify_mutex;
+
+void
+SSLNotifyFileLoaded(const char *path)
+{
+  if (SSLConfigParams::load_ssl_file_cb) {
+    std::lock_guard<std::mutex> lock(ssl_notify_mutex);
+    SSLConfigParams::load_ssl_file_cb(path);
+  }
+}
+
+void
+SSLNotifyCtxInitialized(SSL_CTX *ctx, bool server)
+{
+  if (SSLConfigParams::init_ssl_ctx_cb) {
+    std::lock_guard<std::mutex> lock(ssl_notify_mutex);
+    SSLConfigParams::init_ssl_ctx_cb(ctx, server);
+  }
+}
+
 // Release SSL_CTX and the associated data. This works for both
 // client and server contexts and gracefully accepts nullptr.
 void
@@ -1978,9 +2155,7 @@ SSLMultiCertConfigLoader::load_certs_and_cross_reference_names(std::vector<X509
     }
 
     cert_list.push_back(cert);
-    if (SSLConfigParams::load_ssl_file_cb) {
-      SSLConfigParams::load_ssl_file_cb(completeServerCertPath.c_str());
-    }
+    SSLNotifyFileLoaded(completeServerCertPath.c_str());
 
     std::set<std::string> name_set;
     // Grub through the names in the certs
@@ -2112,9 +2287,7 @@ SSLMultiCertConfigLoader::load_certs(SSL_CTX *ctx, SSLMultiCertConfigLoader::Cer
       return false;
     }
 
-    if (SSLConfigParams::load_ssl_file_cb) {
-      SSLConfigParams::load_ssl_file_cb(completeServerCertPath.c_str());
-    }
+    SSLNotifyFileLoaded(completeServerCertPath.c_str());
 
     // Must load all the intermediate certificates before starting the next chain
 
@@ -2127,9 +2300,7 @@ SSLMultiCertConfigLoader::load_certs(SSL_CTX *ctx, SSLMultiCertConfigLoader::Cer
         SSLError("failed to load global certificate chain from %s", (const char *)completeServerCertChainPath);
         return false;
       }
-      if (SSLConfigParams::load_ssl_file_cb) {
-        SSLConfigParams::load_ssl_file_cb(completeServerCertChainPath);
-      }
+      SSLNotifyFileLoaded(completeServerCertChainPath);
     }
 
     // Now, load any additional certificate chains specified in this entry.
@@ -2141,9 +2312,7 @@ SSLMultiCertConfigLoader::load_certs(SSL_CTX *ctx, SSLMultiCertConfigLoader::Cer
           SSLError("failed to load certificate chain from %s", (const char *)completeServerCertChainPath);
           return false;
         }
-        if (SSLConfigParams::load_ssl_file_cb) {
-          SSLConfigParams::load_ssl_file_cb(completeServerCertChainPath);
-        }
+        SSLNotifyFileLoaded(completeServerCertChainPath);
       }
     }
 #if TS_USE_TLS_OCSP
@@ -58,7 +58,7 @@ int
 TLSSNISupport::perform_sni_action()
 {
   const char *servername = this->_get_sni_server_name();
-  SNIConfig::scoped_config params;
+  SNIConfig::epoch_config params;
   if (const auto &actions = params->get(servername); !actions.first) {
     Debug("ssl_sni", "%s not available in the map", servername);
   } else {
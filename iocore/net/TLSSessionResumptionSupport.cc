@@ -91,9 +91,8 @@ TLSSessionResumptionSupport::processSessionTicket(SSL *ssl, unsigned char *keyna
                                                   HMAC_CTX *hctx, int enc)
 #endif
 {
-  SSLConfig::scoped_config config;
-  SSLCertificateConfig::scoped_config lookup;
-  SSLTicketKeyConfig::scoped_config params;
+  SSLCertificateConfig::epoch_config lookup;
+  SSLTicketKeyConfig::epoch_config params;
 
   // Get the IP address to look up the keyblock
   const IpEndpoint &ip           = this->_getLocalEndpoint();
@@ -0,0 +1,76 @@
+/** @file
+
+  Samples of the TCP_INFO of a connection
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <netinet/in.h>
+// The struct of linux/tcp.h has the fields of the newer kernels, it can't be included with netinet/tcp.h.
+#if HAVE_STRUCT_LINUX_TCP_INFO
+#include <linux/tcp.h>
+#else
+#include <netinet/tcp.h>
+#endif
+
+#include "I_TcpInfo.h"
+
+bool
+TcpInfo::sample(int fd, ink_hrtime now)
+{
+#if defined(TCP_INFO) && defined(HAVE_STRUCT_TCP_INFO)
+  static_assert(sizeof(struct tcp_info) <= RAW_SIZE, "TcpInfo::raw is smaller than struct tcp_info");
+
+  socklen_t len = RAW_SIZE;
+  if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, raw, &len) != 0) {
+    sampled_at = 0;
+    raw_len    = 0;
+    return false;
+  }
+  raw_len = len;
+
+  // An older kernel fills less of the struct than the headers have, the rest reads as 0.
+  struct tcp_info info;
+  memset(&info, 0, sizeof(info));
+  memcpy(&info, raw, std::min<size_t>(len, sizeof(info)));
+
+  sampled_at = now;
+  rtt        = HRTIME_USECONDS(info.tcpi_rtt);
+  rtt_var    = HRTIME_USECONDS(info.tcpi_rttvar);
+  snd_cwnd   = info.tcpi_snd_cwnd;
+  snd_mss    = info.tcpi_snd_mss;
+#if !defined(freebsd) || defined(__GLIBC__)
+  total_retrans = info.tcpi_total_retrans;
+#else
+  total_retrans = info.tcpi_snd_rexmitpack;
+#endif
+#if HAVE_STRUCT_TCP_INFO_DELIVERY_RATE
+  delivery_rate = info.tcpi_delivery_rate;
+#endif
+  return true;
+#else
+  (void)fd;
+  (void)now;
+  return false;
+#endif
+}
@@ -22,6 +22,9 @@
  */
 
 #include "P_Net.h"
+#include "ts/sdt.h"
+
+#include <algorithm>
 
 using namespace std::literals;
 
@@ -35,13 +38,26 @@ ink_hrtime last_transient_accept_error;
 
 NetHandler::Config NetHandler::global_config;
 std::bitset<std::numeric_limits<unsigned int>::digits> NetHandler::active_thread_types;
-const std::bitset<NetHandler::CONFIG_ITEM_COUNT> NetHandler::config_value_affects_per_thread_value{0x3};
+const std::bitset<NetHandler::CONFIG_ITEM_COUNT> NetHandler::config_value_affects_per_thread_value{0x43};
 
 extern "C" void fd_reify(struct ev_loop *);
 
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
 // loops through the list of NetEvents and calls the timeouts
+// When to look at @a ne again after a check at @a now.
+static ink_hrtime
+next_timeout_check(NetEvent *ne, ink_hrtime now)
+{
+  ink_hrtime at = ne->next_inactivity_timeout_at;
+  if (ne->next_activity_timeout_at && (at == 0 || ne->next_activity_timeout_at < at)) {
+    at = ne->next_activity_timeout_at;
+  }
+  // Without a deadline keep looking every second, read or write may get enabled and need the
+  // default inactivity timeout. An expired one is signaled again a second later if it is not reset.
+  return std::max(at, now + HRTIME_SECONDS(1));
+}
+
 class InactivityCop : public Continuation
 {
 public:
@@ -54,13 +70,17 @@ public:
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
+    // Only the NetEvents whose check has come due are looked at, activity just moves the deadline
+    // and is picked up here when the old one passes.
+    nh.timeout_wheel.advance(now);
+    while (NetEvent *ne = nh.timeout_wheel.pop_ready()) {
+      ne->timeout_tag = -1;
+
       // If we cannot get the lock don't stop just keep cleaning
       MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
       if (!lock.is_locked()) {
         NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+        nh.schedule_timeout_check(ne, now + HRTIME_SECONDS(1));
         continue;
       }
 
@@ -80,6 +100,9 @@ public:
         NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
       }
 
+      // Put it back before the callback, which may free it.
+      nh.schedule_timeout_check(ne, next_timeout_check(ne, now));
+
       if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
         if (ne->is_default_inactivity_timeout()) {
           // track the connections that timed out due to default inactivity
@@ -100,21 +123,9 @@ public:
         ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
       }
     }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
 
-    // Cleanup the active and keep-alive queues periodically
-    nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
+    // Expired connections in the active queue were signaled above, only trim the keep-alive queue
+    // if it is over its limit.
     nh.manage_keep_alive_queue();
 
     return 0;
@@ -173,6 +184,14 @@ PollCont::do_poll(ink_hrtime timeout)
   }
 // wait for fd's to trigger, or don't wait if timeout is 0
 #if TS_USE_EPOLL
+#if TS_USE_LINUX_IO_URING
+  if (pollDescriptor->uring_enabled) {
+    pollDescriptor->result = pollDescriptor->uring_wait(poll_timeout);
+    NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] io_uring fd: %d, timeout: %d, results: %d", pollDescriptor->uring.ring_fd,
+             poll_timeout, pollDescriptor->result);
+    return;
+  }
+#endif
   pollDescriptor->result =
     epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, POLL_DESCRIPTOR_SIZE, poll_timeout);
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] epoll_fd: %d, timeout: %d, results: %d", pollDescriptor->epoll_fd,
@@ -294,6 +313,12 @@ NetHandler::update_nethandler_config(const char *str, RecDataT, RecData data, vo
   } else if (name == "proxy.config.net.default_inactivity_timeout"sv) {
     updated_member = &NetHandler::global_config.default_inactivity_timeout;
     Debug("net_queue", "proxy.config.net.default_inactivity_timeout updated to %" PRId64, data.rec_int);
+  } else if (name == "proxy.config.net.max_connection_memory_in"sv) {
+    updated_member = &NetHandler::global_config.max_connection_memory_in;
+    Debug("net_queue", "proxy.config.net.max_connection_memory_in updated to %" PRId64, data.rec_int);
+  } else if (name == "proxy.config.net.tcp_info.interval"sv) {
+    updated_member = &NetHandler::global_config.tcp_info_interval;
+    Debug("net_queue", "proxy.config.net.tcp_info.interval updated to %" PRId64, data.rec_int);
   }
 
   if (updated_member) {
@@ -329,6 +354,8 @@ NetHandler::init_for_process()
   REC_ReadConfigInt32(global_config.transaction_no_activity_timeout_in, "proxy.config.net.transaction_no_activity_timeout_in");
   REC_ReadConfigInt32(global_config.keep_alive_no_activity_timeout_in, "proxy.config.net.keep_alive_no_activity_timeout_in");
   REC_ReadConfigInt32(global_config.default_inactivity_timeout, "proxy.config.net.default_inactivity_timeout");
+  REC_ReadConfigInt32(global_config.max_connection_memory_in, "proxy.config.net.max_connection_memory_in");
+  REC_ReadConfigInt32(global_config.tcp_info_interval, "proxy.config.net.tcp_info.interval");
 
   RecRegisterConfigUpdateCb("proxy.config.net.max_connections_in", update_nethandler_config, nullptr);
   RecRegisterConfigUpdateCb("proxy.config.net.max_requests_in", update_nethandler_config, nullptr);
@@ -336,6 +363,8 @@ NetHandler::init_for_process()
   RecRegisterConfigUpdateCb("proxy.config.net.transaction_no_activity_timeout_in", update_nethandler_config, nullptr);
   RecRegisterConfigUpdateCb("proxy.config.net.keep_alive_no_activity_timeout_in", update_nethandler_config, nullptr);
   RecRegisterConfigUpdateCb("proxy.config.net.default_inactivity_timeout", update_nethandler_config, nullptr);
+  RecRegisterConfigUpdateCb("proxy.config.net.max_connection_memory_in", update_nethandler_config, nullptr);
+  RecRegisterConfigUpdateCb("proxy.config.net.tcp_info.interval", update_nethandler_config, nullptr);
 
   Debug("net_queue", "proxy.config.net.max_connections_in updated to %d", global_config.max_connections_in);
   Debug("net_queue", "proxy.config.net.max_requests_in updated to %d", global_config.max_requests_in);
@@ -345,6 +374,8 @@ NetHandler::init_for_process()
   Debug("net_queue", "proxy.config.net.keep_alive_no_activity_timeout_in updated to %d",
         global_config.keep_alive_no_activity_timeout_in);
   Debug("net_queue", "proxy.config.net.default_inactivity_timeout updated to %d", global_config.default_inactivity_timeout);
+  Debug("net_queue", "proxy.config.net.max_connection_memory_in updated to %d", global_config.max_connection_memory_in);
+  Debug("net_queue", "proxy.config.net.tcp_info.interval updated to %d", global_config.tcp_info_interval);
 }
 
 //
@@ -404,6 +435,7 @@ NetHandler::process_ready_list()
 {
   NetEvent *ne = nullptr;
 
+  ATS_PROBE(net_ready_list_begin);
 #if defined(USE_EDGE_TRIGGER)
   // NetEvent *
   while ((ne = read_ready_list.dequeue())) {
@@ -461,6 +493,7 @@ NetHandler::process_ready_list()
       ne->ep.modify(-EVENTIO_WRITE);
   }
 #endif /* !USE_EDGE_TRIGGER */
+  ATS_PROBE(net_ready_list_end);
 }
 
 //
@@ -494,19 +527,20 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   // Polling event by PollCont
   PollCont *p = get_PollCont(this->thread);
-  p->do_poll(timeout);
+  if (!_busy_poll(p, timeout)) {
+    ink_hrtime start = Thread::get_hrtime_updated();
+    p->do_poll(timeout);
+    this->thread->idle_time += Thread::get_hrtime_updated() - start;
+  }
 
   // Get & Process polling result
   PollDescriptor *pd = get_PollDescriptor(this->thread);
   NetEvent *ne       = nullptr;
+  ATS_PROBE2(net_poll_wakeup, pd->result, timeout);
   for (int x = 0; x < pd->result; x++) {
     epd = static_cast<EventIO *> get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       ne = epd->data.ne;
-      // Remove triggered NetEvent from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(ne)) {
-        cop_list.remove(ne);
-      }
       if (get_ev_events(pd, x) & (EVENTIO_READ | EVENTIO_ERROR)) {
         ne->read.triggered = 1;
         if (!read_ready_list.in(ne)) {
@@ -547,10 +581,82 @@ NetHandler::waitForActivity(ink_hrtime timeout)
   pd->result = 0;
 
   process_ready_list();
+  sample_tcp_info();
 
   return EVENT_CONT;
 }
 
+// There is no call that reads the TCP_INFO of many sockets at once, the connections that want it
+// are sampled together instead, once an interval, after the reads and writes of the loop.
+void
+NetHandler::sample_tcp_info()
+{
+  if (tcp_info_list.empty()) {
+    return;
+  }
+  ink_hrtime now = Thread::get_hrtime();
+  if (now - tcp_info_sampled_at < HRTIME_MSECONDS(config.tcp_info_interval)) {
+    return;
+  }
+  tcp_info_sampled_at = now;
+
+  int64_t samples = 0;
+  for (NetEvent *ne = tcp_info_list.head; ne != nullptr; ne = ne->tcp_info_link.next) {
+    if (!ne->closed) {
+      ne->sample_tcp_info(now);
+      ++samples;
+    }
+  }
+  NET_SUM_DYN_STAT(net_tcp_info_samples_stat, samples);
+}
+
+bool
+NetHandler::_busy_poll(PollCont *p, ink_hrtime &timeout)
+{
+  // Only spin if the loop was going to block, and only for the part of the wait that is worth it.
+  if (net_config_busy_poll_usec <= 0 || timeout <= 0) {
+    return false;
+  }
+  ink_hrtime const limit = HRTIME_USECONDS(net_config_busy_poll_usec);
+  ink_hrtime const start = Thread::get_hrtime_updated();
+
+  if (_busy_poll_budget > 0) {
+    ProtectedQueue &q  = thread->EventQueueExternal;
+    PollDescriptor *pd = get_PollDescriptor(thread);
+    ink_hrtime end     = start + std::min(_busy_poll_budget, timeout);
+    // While spinning the queue is watched directly, producers need not write the eventfd.
+    q.end_wait();
+    do {
+      p->do_poll(0);
+      if (pd->result > 0 || !INK_ATOMICLIST_EMPTY(q.al) || thread->stealable_count.load(std::memory_order_relaxed) > 0) {
+        NET_INCREMENT_DYN_STAT(net_busy_poll_hits_stat);
+        return true;
+      }
+    } while (Thread::get_hrtime_updated() < end);
+
+    // Spinning for the full budget did not pay off, spend less next time.
+    NET_INCREMENT_DYN_STAT(net_busy_poll_misses_stat);
+    _busy_poll_budget /= 2;
+    if (_busy_poll_budget < limit / BUSY_POLL_GROW_START) {
+      _busy_poll_budget = 0;
+    }
+    if (!q.begin_wait()) {
+      return true; // Something was queued as we gave up, don't block.
+    }
+    timeout = std::max<ink_hrtime>(timeout - (Thread::get_hrtime_updated() - start), 0);
+  }
+
+  // Block, and if there was activity sooner than the limit, spinning would have caught it.
+  ink_hrtime blocked = Thread::get_hrtime_updated();
+  p->do_poll(timeout);
+  blocked = Thread::get_hrtime_updated() - blocked;
+  thread->idle_time += blocked;
+  if (blocked < limit && get_PollDescriptor(thread)->result > 0) {
+    _busy_poll_budget = std::min(limit, std::max(_busy_poll_budget * 2, limit / BUSY_POLL_GROW_START));
+  }
+  return true;
+}
+
 void
 NetHandler::signalActivity()
 {
@@ -566,6 +672,26 @@ NetHandler::signalActivity()
 #endif
 }
 
+namespace
+{
+/// Number of least recently used idle connections compared for each eviction.
+constexpr int KEEP_ALIVE_EVICTION_BATCH = 8;
+
+/// Buffer memory of @a ne, the space of its read buffer and the data waiting in its write buffer.
+int64_t
+netevent_buffered_bytes(NetEvent *ne)
+{
+  int64_t bytes = 0;
+  if (MIOBuffer *buf = ne->read.vio.buffer.writer(); buf != nullptr) {
+    bytes += buf->max_read_avail() + buf->current_write_avail();
+  }
+  if (IOBufferReader *reader = ne->write.vio.buffer.reader(); reader != nullptr) {
+    bytes += reader->read_avail();
+  }
+  return bytes;
+}
+} // namespace
+
 bool
 NetHandler::manage_active_queue(NetEvent *enabling_ne, bool ignore_queue_size = false)
 {
@@ -602,7 +728,9 @@ NetHandler::manage_active_queue(NetEvent *enabling_ne, bool ignore_queue_size =
     }
     if ((ne->inactivity_timeout_in && ne->next_inactivity_timeout_at <= now) ||
         (ne->active_timeout_in && ne->next_activity_timeout_at <= now)) {
-      _close_ne(ne, now, handle_event, closed, total_idle_time, total_idle_count);
+      if (_close_ne(ne, now, handle_event, closed, total_idle_time, total_idle_count)) {
+        NET_INCREMENT_DYN_STAT(net_active_queue_evicted_timeout_stat);
+      }
     }
     if (ignore_queue_size == false && max_requests_per_thread_in > active_queue_size) {
       return true;
@@ -623,8 +751,18 @@ NetHandler::configure_per_thread_values()
   int threads                   = eventProcessor.thread_group[ET_NET]._count;
   max_connections_per_thread_in = config.max_connections_in / threads;
   max_requests_per_thread_in    = config.max_requests_in / threads;
+  max_connection_bytes_per_thread_in = (static_cast<int64_t>(config.max_connection_memory_in) << 20) / threads;
   Debug("net_queue", "max_connections_per_thread_in updated to %d threads: %d", max_connections_per_thread_in, threads);
   Debug("net_queue", "max_requests_per_thread_in updated to %d threads: %d", max_requests_per_thread_in, threads);
+  Debug("net_queue", "max_connection_bytes_per_thread_in updated to %" PRId64 " threads: %d", max_connection_bytes_per_thread_in,
+        threads);
+}
+
+bool
+NetHandler::_over_connection_limits() const
+{
+  return (max_connections_per_thread_in && active_queue_size + keep_alive_queue_size > max_connections_per_thread_in) ||
+         (max_connection_bytes_per_thread_in && active_queue_bytes + keep_alive_queue_bytes > max_connection_bytes_per_thread_in);
 }
 
 void
@@ -633,45 +771,65 @@ NetHandler::manage_keep_alive_queue()
   uint32_t total_connections_in = active_queue_size + keep_alive_queue_size;
   ink_hrtime now                = Thread::get_hrtime();
 
-  Debug("v_net_queue", "max_connections_per_thread_in: %d total_connections_in: %d active_queue_size: %d keep_alive_queue_size: %d",
-        max_connections_per_thread_in, total_connections_in, active_queue_size, keep_alive_queue_size);
+  Debug("v_net_queue",
+        "max_connections_per_thread_in: %d total_connections_in: %d active_queue_size: %d keep_alive_queue_size: %d "
+        "max_connection_bytes_per_thread_in: %" PRId64 " active_queue_bytes: %" PRId64 " keep_alive_queue_bytes: %" PRId64,
+        max_connections_per_thread_in, total_connections_in, active_queue_size, keep_alive_queue_size,
+        max_connection_bytes_per_thread_in, active_queue_bytes, keep_alive_queue_bytes);
 
-  if (!max_connections_per_thread_in || total_connections_in <= max_connections_per_thread_in) {
+  if (!_over_connection_limits()) {
     return;
   }
 
-  // loop over the non-active connections and try to close them
-  NetEvent *ne_next    = nullptr;
+  // Close idle connections, in batches of the least recently used ones. Within a batch the
+  // connection idle longest relative to the memory it holds goes first, so that a large idle
+  // buffer does not outlive many small ones.
+  NetEvent *ne         = keep_alive_queue.head;
   int closed           = 0;
   int handle_event     = 0;
   int total_idle_time  = 0;
   int total_idle_count = 0;
-  for (NetEvent *ne = keep_alive_queue.head; ne != nullptr; ne = ne_next) {
-    ne_next = ne->keep_alive_queue_link.next;
-    _close_ne(ne, now, handle_event, closed, total_idle_time, total_idle_count);
 
-    total_connections_in = active_queue_size + keep_alive_queue_size;
-    if (total_connections_in <= max_connections_per_thread_in) {
-      break;
+  auto weight = [now](NetEvent const *x) {
+    return static_cast<double>((now - x->queued_at) / HRTIME_MSECOND + 1) * static_cast<double>(x->queued_bytes / 1024 + 1);
+  };
+  while (ne != nullptr) {
+    NetEvent *batch[KEEP_ALIVE_EVICTION_BATCH];
+    int n = 0;
+    for (; ne != nullptr && n < KEEP_ALIVE_EVICTION_BATCH; ne = ne->keep_alive_queue_link.next) {
+      batch[n++] = ne;
+    }
+    std::sort(batch, batch + n, [&weight](NetEvent const *x, NetEvent const *y) { return weight(x) > weight(y); });
+    for (int i = 0; i < n; ++i) {
+      bool over_memory =
+        max_connection_bytes_per_thread_in && active_queue_bytes + keep_alive_queue_bytes > max_connection_bytes_per_thread_in;
+      if (_close_ne(batch[i], now, handle_event, closed, total_idle_time, total_idle_count)) {
+        NET_INCREMENT_DYN_STAT(over_memory ? net_keep_alive_evicted_memory_stat : net_keep_alive_evicted_connections_stat);
+      }
+      if (!_over_connection_limits()) {
+        ne = nullptr;
+        break;
+      }
     }
   }
 
+  total_connections_in = active_queue_size + keep_alive_queue_size;
   if (total_idle_count > 0) {
-    Debug("net_queue", "max cons: %d active: %d idle: %d already closed: %d, close event: %d mean idle: %d",
-          max_connections_per_thread_in, total_connections_in, keep_alive_queue_size, closed, handle_event,
+    Debug("net_queue", "max cons: %d active: %d idle: %d idle bytes: %" PRId64 " already closed: %d, close event: %d mean idle: %d",
+          max_connections_per_thread_in, total_connections_in, keep_alive_queue_size, keep_alive_queue_bytes, closed, handle_event,
           total_idle_time / total_idle_count);
   }
 }
 
-void
+bool
 NetHandler::_close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count)
 {
   if (ne->get_thread() != this_ethread()) {
-    return;
+    return false;
   }
   MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
   if (!lock.is_locked()) {
-    return;
+    return false;
   }
   ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
   if (diff > 0) {
@@ -701,6 +859,7 @@ NetHandler::_close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &clos
       }
     }
   }
+  return true;
 }
 
 void
@@ -712,11 +871,15 @@ NetHandler::add_to_keep_alive_queue(NetEvent *ne)
   if (keep_alive_queue.in(ne)) {
     // already in the keep-alive queue, move the head
     keep_alive_queue.remove(ne);
+    keep_alive_queue_bytes -= ne->queued_bytes;
   } else {
     // in the active queue or no queue, new to this queue
     remove_from_active_queue(ne);
     ++keep_alive_queue_size;
   }
+  ne->queued_at    = Thread::get_hrtime();
+  ne->queued_bytes = netevent_buffered_bytes(ne);
+  keep_alive_queue_bytes += ne->queued_bytes;
   keep_alive_queue.enqueue(ne);
 
   // if keep-alive queue is over size then close connections
@@ -732,6 +895,7 @@ NetHandler::remove_from_keep_alive_queue(NetEvent *ne)
   if (keep_alive_queue.in(ne)) {
     keep_alive_queue.remove(ne);
     --keep_alive_queue_size;
+    keep_alive_queue_bytes -= ne->queued_bytes;
   }
 }
 
@@ -753,6 +917,7 @@ NetHandler::add_to_active_queue(NetEvent *ne)
   if (active_queue.in(ne)) {
     // already in the active queue, move the head
     active_queue.remove(ne);
+    active_queue_bytes -= ne->queued_bytes;
   } else {
     if (active_queue_full) {
       // there is no room left in the queue
@@ -763,6 +928,9 @@ NetHandler::add_to_active_queue(NetEvent *ne)
     remove_from_keep_alive_queue(ne);
     ++active_queue_size;
   }
+  ne->queued_at    = Thread::get_hrtime();
+  ne->queued_bytes = netevent_buffered_bytes(ne);
+  active_queue_bytes += ne->queued_bytes;
   active_queue.enqueue(ne);
 
   return true;
@@ -777,5 +945,6 @@ NetHandler::remove_from_active_queue(NetEvent *ne)
   if (active_queue.in(ne)) {
     active_queue.remove(ne);
     --active_queue_size;
+    active_queue_bytes -= ne->queued_bytes;
   }
 }
@@ -24,6 +24,11 @@
 #include <tscore/TSSystemState.h>
 
 #include "P_Net.h"
+#include "AcceptRateLimiter.h"
+
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+#include <linux/filter.h>
+#endif
 
 #ifdef ROUNDUP
 #undef ROUNDUP
@@ -43,6 +48,51 @@ safe_delay(int msec)
   socketManager.poll(nullptr, 0, msec);
 }
 
+// Have the kernel busy poll the device queue of an accepted socket, see proxy.config.net.sock_busy_poll_usec_in.
+static void
+set_busy_poll(int fd)
+{
+#ifdef SO_BUSY_POLL
+  int usec = net_config_sock_busy_poll_usec_in;
+  if (usec > 0 && safe_setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, reinterpret_cast<char *>(&usec), sizeof(usec)) < 0) {
+    Debug("iocore_net_accept", "setsockopt(SO_BUSY_POLL) failed on fd %d: %s", fd, strerror(errno));
+  }
+#else
+  (void)fd;
+#endif
+}
+
+// Whether to accept a connection from @a con, closing it with a reset if its client is over its rate.
+static bool
+admit_connection(NetAccept *na, Connection &con)
+{
+  if (na->opt.backdoor || accept_rate_limiter.admit(&con.addr.sa, ink_get_hrtime_internal())) {
+    return true;
+  }
+  // Abort rather than close, so that the refused connection leaves no TIME_WAIT state behind.
+  struct linger l = {1, 0};
+  safe_setsockopt(con.fd, SOL_SOCKET, SO_LINGER, reinterpret_cast<char *>(&l), sizeof(l));
+  con.close();
+  NET_SUM_GLOBAL_DYN_STAT(net_connections_rate_limited_in_stat, 1);
+  return false;
+}
+
+// The processor that handled the packets of an accepted socket, -1 if the kernel does not tell.
+static int
+incoming_cpu(int fd)
+{
+#ifdef SO_INCOMING_CPU
+  int cpu = -1;
+  int len = sizeof(cpu);
+  if (safe_getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, reinterpret_cast<char *>(&cpu), &len) == 0) {
+    return cpu;
+  }
+#else
+  (void)fd;
+#endif
+  return -1;
+}
+
 //
 // General case network connection accept code
 //
@@ -81,6 +131,9 @@ net_accept(NetAccept *na, void *ep, bool blockable)
       goto Ldone;
     }
     NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+    if (!admit_connection(na, con)) {
+      continue;
+    }
 
     vc = static_cast<UnixNetVConnection *>(na->getNetProcessor()->allocate_vc(e->ethread));
     if (!vc) {
@@ -95,6 +148,7 @@ net_accept(NetAccept *na, void *ep, bool blockable)
     vc->action_     = *na->action_;
     vc->set_is_transparent(na->opt.f_inbound_transparent);
     vc->set_is_proxy_protocol(na->opt.f_proxy_protocol);
+    set_busy_poll(vc->con.fd);
     vc->set_context(NET_VCONNECTION_IN);
     if (na->opt.f_mptcp) {
       vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
@@ -121,7 +175,7 @@ net_accept(NetAccept *na, void *ep, bool blockable)
         vc->handleEvent(EVENT_NONE, e);
       }
     } else {
-      t = eventProcessor.assign_thread(na->opt.etype);
+      t = eventProcessor.assign_thread_near_cpu(na->opt.etype, incoming_cpu(vc->con.fd));
       h = get_NetHandler(t);
       // Assign NetHandler->mutex to NetVC
       vc->mutex = h->mutex;
@@ -201,13 +255,55 @@ NetAccept::init_accept(EThread *t)
   t->schedule_every(this, period);
 }
 
+namespace
+{
+/** Steer new connections to the socket of the thread bound to the processor that received them.
+    @a cpus has the processor of each socket in the SO_REUSEPORT group of @a fd, by position, -1
+    for a thread not bound to a single processor. Connections received on other processors keep
+    the kernel's hash selection.
+*/
+void
+attach_listen_steering(int fd, const std::vector<int> &cpus)
+{
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  std::vector<sock_filter> code;
+  code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (unsigned idx = 0; idx < cpus.size(); ++idx) {
+    if (cpus[idx] >= 0) {
+      code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpus[idx]), 0, 1));
+      code.push_back(BPF_STMT(BPF_RET | BPF_K, idx));
+    }
+  }
+  // Out of range of the group, which makes the kernel fall back to the hash.
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+
+  if (code.size() == 2) {
+    Warning("proxy.config.exec_thread.listen_steering is set but no thread is bound to a single processor");
+    return;
+  }
+  sock_fprog prog;
+  prog.len    = code.size();
+  prog.filter = code.data();
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+    Warning("unable to attach the listen steering program: %d, %s", errno, strerror(errno));
+  } else {
+    Debug("iocore_net_accept", "steering connections over %zu listen sockets by processor", cpus.size());
+  }
+#else
+  (void)fd;
+  (void)cpus;
+  Warning("proxy.config.exec_thread.listen_steering is not supported on this platform");
+#endif
+}
+} // namespace
+
 int
 NetAccept::accept_per_thread(int event, void *ep)
 {
   int listen_per_thread = 0;
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
 
-  if (listen_per_thread == 1) {
+  if (listen_per_thread == 1 && !listening) {
     if (do_listen(NON_BLOCKING)) {
       Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
       return -1;
@@ -232,9 +328,11 @@ NetAccept::init_accept_per_thread()
 {
   int i, n;
   int listen_per_thread = 0;
+  int listen_steering   = 0;
 
   ink_assert(opt.etype >= 0);
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(listen_steering, "proxy.config.exec_thread.listen_steering");
 
   if (listen_per_thread == 0) {
     if (do_listen(NON_BLOCKING)) {
@@ -246,10 +344,29 @@ NetAccept::init_accept_per_thread()
   SET_HANDLER((NetAcceptHandler)&NetAccept::accept_per_thread);
   n = eventProcessor.thread_group[opt.etype]._count;
 
+  // Steering needs the position of each socket in the SO_REUSEPORT group to be that of its thread,
+  // so the sockets are created here in thread order rather than by each thread as it starts.
+  std::vector<int> cpus;
+  if (listen_per_thread == 1 && listen_steering) {
+    for (i = 0; i < n; i++) {
+      cpus.push_back(eventProcessor.cpu_of_thread(eventProcessor.thread_group[opt.etype]._thread[i]));
+    }
+  }
+
   for (i = 0; i < n; i++) {
     NetAccept *a = (i < n - 1) ? clone() : this;
     EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
+    if (!cpus.empty()) {
+      if (a->do_listen(NON_BLOCKING)) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+        return;
+      }
+      a->listening = true;
+      if (i == 0) {
+        attach_listen_steering(a->server.fd, cpus);
+      }
+    }
     t->schedule_imm(a);
   }
 }
@@ -325,6 +442,9 @@ NetAccept::do_blocking_accept(EThread *t)
     }
 
     NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+    if (!admit_connection(this, con)) {
+      continue;
+    }
 
     // Use 'nullptr' to Bypass thread allocator
     vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(nullptr);
@@ -343,6 +463,7 @@ NetAccept::do_blocking_accept(EThread *t)
     vc->options.packet_tos  = opt.packet_tos;
     vc->options.ip_family   = opt.ip_family;
     vc->apply_options();
+    set_busy_poll(vc->con.fd);
     vc->set_context(NET_VCONNECTION_IN);
     if (opt.f_mptcp) {
       vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
@@ -356,7 +477,7 @@ NetAccept::do_blocking_accept(EThread *t)
 #endif
     SET_CONTINUATION_HANDLER(vc, (NetVConnHandler)&UnixNetVConnection::acceptEvent);
 
-    EThread *localt = eventProcessor.assign_thread(opt.etype);
+    EThread *localt = eventProcessor.assign_thread_near_cpu(opt.etype, incoming_cpu(vc->con.fd));
     NetHandler *h   = get_NetHandler(localt);
     // Assign NetHandler->mutex to NetVC
     vc->mutex = h->mutex;
@@ -434,6 +555,9 @@ NetAccept::acceptFastEvent(int event, void *ep)
       }
       Debug("iocore_net", "accepted a new socket: %d", fd);
       NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+      if (!admit_connection(this, con)) {
+        continue;
+      }
       if (opt.send_bufsize > 0) {
         if (unlikely(socketManager.set_sndbuf_size(fd, opt.send_bufsize))) {
           bufsz = ROUNDUP(opt.send_bufsize, 1024);
@@ -493,6 +617,7 @@ NetAccept::acceptFastEvent(int event, void *ep)
     vc->options.packet_tos  = opt.packet_tos;
     vc->options.ip_family   = opt.ip_family;
     vc->apply_options();
+    set_busy_poll(vc->con.fd);
     vc->set_context(NET_VCONNECTION_IN);
     if (opt.f_mptcp) {
       vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
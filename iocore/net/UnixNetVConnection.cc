@@ -27,6 +27,12 @@
 #include "Log.h"
 
 #include <termios.h>
+#include <algorithm>
+
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && __has_include(<linux/errqueue.h>)
+#include <linux/errqueue.h>
+#define TS_HAS_ZEROCOPY 1
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
@@ -181,6 +187,118 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+#ifdef SPLICE_F_MOVE
+// Read from a producer of a splice coupling into its pipe. The bytes count as read
+// but never show up in the read buffer.
+static void
+read_to_pipe(NetHandler *nh, UnixNetVConnection *vc, EThread *thread, int64_t ntodo)
+{
+  NetState *s       = &vc->read;
+  NetSplice *sp     = vc->splice;
+  ProxyMutex *mutex = thread->mutex.get();
+  int64_t toread    = std::min(ntodo, sp->capacity - sp->in_pipe);
+
+  if (toread > 0) {
+    int64_t r = ::splice(vc->con.fd, nullptr, sp->fd[1], nullptr, toread, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+    if (r < 0) {
+      r = -errno;
+    }
+    if (r > 0) {
+      NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+      sp->in_pipe += r;
+      s->vio.ndone += r;
+      net_activity(vc, thread);
+      if (s->vio.ntodo() <= 0) {
+        // Done with the coupling, the connection may be reused by a read that wants the data.
+        vc->splice_detach();
+        read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
+        return;
+      }
+      if (read_signal_and_update(VC_EVENT_READ_READY, vc) != EVENT_CONT) {
+        return;
+      }
+      read_reschedule(nh, vc);
+      return;
+    }
+    // EAGAIN is also what a pipe without room gives, which can happen before it holds its
+    // capacity in bytes. Only take it as the socket being drained if the pipe is empty.
+    if ((r == -EAGAIN && sp->in_pipe == 0) || r == -ENOTCONN) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_read_nodata_stat);
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      return;
+    }
+    if (r != -EAGAIN) {
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      vc->splice_detach();
+      if (!r || r == -ECONNRESET) {
+        read_signal_done(VC_EVENT_EOS, nh, vc);
+      } else {
+        read_signal_error(nh, vc, static_cast<int>(-r));
+      }
+      return;
+    }
+  }
+
+  // The pipe is full, the consumer reschedules this once it has written some of it. Until then
+  // this waits on the consumer, as with a full read buffer.
+  sp->producer_blocked           = true;
+  vc->next_inactivity_timeout_at = 0;
+  nh->read_ready_list.remove(vc);
+}
+
+// Write from the pipe of a splice coupling, once the write buffer is drained.
+static void
+write_from_pipe(NetHandler *nh, UnixNetVConnection *vc, EThread *thread, int64_t ntodo)
+{
+  NetState *s       = &vc->write;
+  NetSplice *sp     = vc->splice;
+  ProxyMutex *mutex = thread->mutex.get();
+  int64_t r = ::splice(sp->fd[0], nullptr, vc->con.fd, nullptr, std::min(ntodo, sp->in_pipe), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+  NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+  if (r <= 0) {
+    r = r < 0 ? -errno : -EPIPE;
+    // The pipe has data, so this is the socket.
+    if (r == -EAGAIN) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_write_nodata_stat);
+      vc->write.triggered = 0;
+      nh->write_ready_list.remove(vc);
+      write_reschedule(nh, vc);
+      return;
+    }
+    vc->write.triggered = 0;
+    write_signal_error(nh, vc, static_cast<int>(-r));
+    return;
+  }
+
+  NET_SUM_DYN_STAT(net_write_bytes_stat, r);
+  s->vio.ndone += r;
+  sp->in_pipe -= r;
+  net_activity(vc, thread);
+  if (sp->producer_blocked && sp->producer) {
+    sp->producer_blocked = false;
+    net_activity(sp->producer, thread);
+    read_reschedule(nh, sp->producer);
+  }
+
+  if (s->vio.ntodo() <= 0) {
+    write_signal_done(VC_EVENT_WRITE_COMPLETE, nh, vc);
+    return;
+  }
+  if (write_signal_and_update(VC_EVENT_WRITE_READY, vc) != EVENT_CONT) {
+    return;
+  }
+  if (!vc->splice_pending() && !s->vio.buffer.reader()->is_read_avail_more_than(0)) {
+    write_disable(nh, vc);
+    return;
+  }
+  write_reschedule(nh, vc);
+}
+#endif
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -221,6 +339,12 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     read_disable(nh, vc);
     return;
   }
+#ifdef SPLICE_F_MOVE
+  if (vc->splice && vc->splice->producer == vc) {
+    read_to_pipe(nh, vc, thread, ntodo);
+    return;
+  }
+#endif
   int64_t toread = buf.writer()->write_avail();
   if (toread > ntodo) {
     toread = ntodo;
@@ -451,6 +575,12 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   // if there is nothing to do, disable
   ink_assert(towrite >= 0);
   if (towrite <= 0) {
+#ifdef SPLICE_F_MOVE
+    if (vc->splice_pending()) {
+      write_from_pipe(nh, vc, thread, ntodo);
+      return;
+    }
+#endif
     write_disable(nh, vc);
     return;
   }
@@ -530,7 +660,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       read_reschedule(nh, vc);
     }
 
-    if (!(buf.reader()->is_read_avail_more_than(0))) {
+    if (!(buf.reader()->is_read_avail_more_than(0)) && !vc->splice_pending()) {
       write_disable(nh, vc);
       return;
     }
@@ -569,6 +699,156 @@ UnixNetVConnection::get_data(int id, void *data)
   }
 }
 
+#if TS_HAS_ZEROCOPY
+namespace
+{
+// Holds the buffers of zero copy sends that were not confirmed when their connection closed. The
+// kernel can still be sending from them, there is no completion to wait for any more.
+struct ZeroCopyRelease : public Continuation {
+  explicit ZeroCopyRelease(NetZeroCopy *zc) : Continuation(new_ProxyMutex()), zc(zc)
+  {
+    SET_HANDLER(&ZeroCopyRelease::release);
+  }
+
+  int
+  release(int, void *)
+  {
+    delete zc;
+    delete this;
+    return EVENT_DONE;
+  }
+
+  NetZeroCopy *zc;
+};
+} // namespace
+
+bool
+UnixNetVConnection::_zerocopy_enable()
+{
+  if (zerocopy == nullptr) {
+    zerocopy = new NetZeroCopy;
+    int one  = 1;
+    if (!supports_zerocopy() ||
+        safe_setsockopt(con.fd, SOL_SOCKET, SO_ZEROCOPY, reinterpret_cast<char *>(&one), sizeof(one)) < 0) {
+      Debug("iocore_net", "zero copy writes not available on vc %p", this);
+      zerocopy->usable = false;
+    }
+  }
+  // A fast open connect carries its data in the connect, which goes without.
+  return zerocopy->usable && (this->con.is_connected || !this->options.f_tcp_fastopen);
+}
+
+void
+UnixNetVConnection::_zerocopy_reap()
+{
+  ProxyMutex *mutex = thread->mutex.get();
+  char control[128];
+  struct msghdr msg;
+
+  for (;;) {
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    if (::recvmsg(con.fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      break;
+    }
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      sock_extended_err const *serr = reinterpret_cast<sock_extended_err const *>(CMSG_DATA(cm));
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      // Sends ee_info through ee_data are done, which is mostly the head of the queue.
+      uint32_t lo = serr->ee_info;
+      uint32_t n  = serr->ee_data - lo;
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        NET_SUM_DYN_STAT(net_zerocopy_copied_stat, n + 1);
+      }
+      auto &pending = zerocopy->pending;
+      pending.erase(std::remove_if(pending.begin(), pending.end(), [=](auto const &p) { return p.first - lo <= n; }),
+                    pending.end());
+    }
+  }
+}
+
+void
+UnixNetVConnection::_zerocopy_release()
+{
+  if (zerocopy == nullptr) {
+    return;
+  }
+  if (zerocopy->pending.empty()) {
+    delete zerocopy;
+  } else {
+    this_ethread()->schedule_in(new ZeroCopyRelease(zerocopy), HRTIME_SECONDS(30));
+  }
+  zerocopy = nullptr;
+}
+#endif
+
+bool
+UnixNetVConnection::splice_from(NetVConnection *vc)
+{
+#ifdef SPLICE_F_MOVE
+  UnixNetVConnection *p = dynamic_cast<UnixNetVConnection *>(vc);
+
+  if (p == nullptr || p == this || !supports_splice_write() || !p->supports_splice_read() || splice || p->splice || closed || p->closed ||
+      nh == nullptr || p->nh != nh) {
+    return false;
+  }
+
+  NetSplice *sp = new NetSplice;
+  if (pipe2(sp->fd, O_NONBLOCK | O_CLOEXEC) < 0) {
+    Debug("iocore_net", "splice pipe failed for vc %p: %s", this, strerror(errno));
+    delete sp;
+    return false;
+  }
+#ifdef F_GETPIPE_SZ
+  sp->capacity = fcntl(sp->fd[1], F_GETPIPE_SZ);
+#endif
+  if (sp->capacity <= 0) {
+    sp->capacity = 65536;
+  }
+  sp->producer = p;
+  sp->consumer = this;
+  p->splice    = sp;
+  splice       = sp;
+  Debug("iocore_net", "splice from vc %p to vc %p, pipe of %" PRId64 " bytes", p, this, sp->capacity);
+  return true;
+#else
+  (void)vc;
+  return false;
+#endif
+}
+
+void
+UnixNetVConnection::splice_detach()
+{
+  NetSplice *sp = splice;
+
+  if (sp == nullptr) {
+    return;
+  }
+  splice = nullptr;
+  if (sp->producer == this) {
+    // The consumer still writes out what is in the pipe.
+    sp->producer = nullptr;
+    return;
+  }
+  if (sp->producer) {
+    sp->producer->splice = nullptr;
+  }
+  if (sp->in_pipe) {
+    Debug("iocore_net", "splice to vc %p dropped %" PRId64 " bytes in the pipe", this, sp->in_pipe);
+  }
+  ::close(sp->fd[0]);
+  ::close(sp->fd[1]);
+  delete sp;
+}
+
 VIO *
 UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
 {
@@ -576,6 +856,10 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
     Error("do_io_read invoked on closed vc %p, cont %p, nbytes %" PRId64 ", buf %p", this, c, nbytes, buf);
     return nullptr;
   }
+  // A new read wants its data in the buffer.
+  if (splice && splice->producer == this) {
+    splice_detach();
+  }
   read.vio.op        = VIO::READ;
   read.vio.mutex     = c ? c->mutex : this->mutex;
   read.vio.cont      = c;
@@ -601,6 +885,9 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
     Error("do_io_write invoked on closed vc %p, cont %p, nbytes %" PRId64 ", reader %p", this, c, nbytes, reader);
     return nullptr;
   }
+  if (splice && splice->consumer == this) {
+    splice_detach();
+  }
   write.vio.op        = VIO::WRITE;
   write.vio.mutex     = c ? c->mutex : this->mutex;
   write.vio.cont      = c;
@@ -637,6 +924,8 @@ UnixNetVConnection::do_io_close(int alerrno /* = -1 */)
   // FIXME: the nh must not nullptr.
   ink_assert(nh);
 
+  splice_detach();
+
   // The vio continuations will be cleared in ::clear called from ::free
   read.enabled    = 0;
   write.enabled   = 0;
@@ -898,6 +1187,7 @@ UnixNetVConnection::set_enabled(VIO *vio)
   STATE_FROM_VIO(vio)->enabled = 1;
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+    _reschedule_timeout_check();
   }
 }
 
@@ -924,10 +1214,20 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
   int64_t try_to_write       = 0;
   IOBufferReader *tmp_reader = buf.reader()->clone();
 
+#if TS_HAS_ZEROCOPY
+  if (zerocopy && !zerocopy->pending.empty()) {
+    _zerocopy_reap();
+  }
+#endif
+
   do {
     IOVec tiovec[NET_MAX_IOV];
     unsigned niov = 0;
     try_to_write  = 0;
+#if TS_HAS_ZEROCOPY
+    IOBufferData *zc_data[NET_MAX_IOV];
+    bool zc_send = false;
+#endif
 
     while (niov < NET_MAX_IOV) {
       int64_t wavail = towrite - total_written - try_to_write;
@@ -947,6 +1247,18 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
         break;
       }
 
+#if TS_HAS_ZEROCOPY
+      // A send is either all large blocks without copying or all small ones with, so the small
+      // writes do not pay for a completion notification.
+      bool large = net_config_zerocopy_min_block_size > 0 && len >= net_config_zerocopy_min_block_size && _zerocopy_enable();
+      if (niov == 0) {
+        zc_send = large;
+      } else if (large != zc_send) {
+        break;
+      }
+      zc_data[niov] = tmp_reader->block->data.get();
+#endif
+
       // build an iov entry
       tiovec[niov].iov_len  = len;
       tiovec[niov].iov_base = tmp_reader->start();
@@ -984,6 +1296,25 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
         this->con.is_connected = true;
       }
 
+#if TS_HAS_ZEROCOPY
+    } else if (zc_send) {
+      struct msghdr msg;
+
+      ink_zero(msg);
+      msg.msg_iov    = &tiovec[0];
+      msg.msg_iovlen = niov;
+
+      r = socketManager.sendmsg(con.fd, &msg, MSG_ZEROCOPY);
+      if (r >= 0) {
+        // Each send that succeeds gets a completion, until then the kernel sends from these buffers.
+        for (unsigned i = 0; i < niov; ++i) {
+          zerocopy->pending.emplace_back(zerocopy->next_seq, make_ptr(zc_data[i]));
+        }
+        ++zerocopy->next_seq;
+        ProxyMutex *mutex = thread->mutex.get();
+        NET_INCREMENT_DYN_STAT(net_zerocopy_writes_stat);
+      }
+#endif
     } else {
       r = socketManager.writev(con.fd, &tiovec[0], niov);
     }
@@ -1338,6 +1669,13 @@ UnixNetVConnection::clear()
   ink_assert(!write.ready_link.prev && !write.ready_link.next);
   ink_assert(!write.enable_link.next);
   ink_assert(!link.next && !link.prev);
+  splice_detach();
+#if TS_HAS_ZEROCOPY
+  _zerocopy_release();
+#endif
+  ink_assert(!tcp_info_link.next && !tcp_info_link.prev);
+  delete tcp_info;
+  tcp_info = nullptr;
 }
 
 void
@@ -1347,6 +1685,12 @@ UnixNetVConnection::free(EThread *t)
 
   // cancel OOB
   cancel_OOB();
+#if TS_HAS_ZEROCOPY
+  // Last chance to see what completed, once closed the rest has to be held for a while.
+  if (zerocopy && !zerocopy->pending.empty() && con.fd != NO_FD) {
+    _zerocopy_reap();
+  }
+#endif
   // close socket fd
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
@@ -1377,6 +1721,7 @@ UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  _reschedule_timeout_check();
 }
 
 TS_INLINE void
@@ -1386,6 +1731,24 @@ UnixNetVConnection::set_default_inactivity_timeout(ink_hrtime timeout_in)
   inactivity_timeout_in      = 0;
   default_inactivity_timeout = true;
   next_inactivity_timeout_at = Thread::get_hrtime() + timeout_in;
+  _reschedule_timeout_check();
+}
+
+void
+UnixNetVConnection::_reschedule_timeout_check()
+{
+  // The wheel belongs to the NetHandler thread. From elsewhere the new deadline is seen when the
+  // current check comes due.
+  if (nh == nullptr || timeout_tag < 0 || nh->thread != this_ethread()) {
+    return;
+  }
+  ink_hrtime at = next_inactivity_timeout_at;
+  if (next_activity_timeout_at && (at == 0 || next_activity_timeout_at < at)) {
+    at = next_activity_timeout_at;
+  }
+  if (at) {
+    nh->schedule_timeout_check(this, at);
+  }
 }
 
 TS_INLINE bool
@@ -1470,6 +1833,37 @@ UnixNetVConnection::remove_from_keep_alive_queue()
   }
 }
 
+const TcpInfo *
+UnixNetVConnection::get_tcp_info()
+{
+  // The NetHandler samples it on the thread of the connection, nobody else may look at it.
+  if (closed || nh == nullptr || thread != this_ethread()) {
+    return nullptr;
+  }
+  if (tcp_info == nullptr) {
+    tcp_info = new TcpInfo;
+  }
+
+  // Sampled right away the first time, then with the other connections of the NetHandler.
+  if (!nh->tcp_info_list.in(this)) {
+    if (!tcp_info->sample(con.fd, Thread::get_hrtime())) {
+      return nullptr;
+    }
+    NET_INCREMENT_DYN_STAT(net_tcp_info_samples_stat);
+    MUTEX_TRY_LOCK(lock, nh->mutex, thread);
+    if (lock.is_locked()) {
+      nh->tcp_info_list.enqueue(this);
+    }
+  }
+  return tcp_info->sampled_at ? tcp_info : nullptr;
+}
+
+void
+UnixNetVConnection::sample_tcp_info(ink_hrtime now)
+{
+  tcp_info->sample(con.fd, now);
+}
+
 bool
 UnixNetVConnection::add_to_active_queue()
 {
@@ -0,0 +1,230 @@
+/** @file
+
+  io_uring backend for PollDescriptor.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#if TS_USE_LINUX_IO_URING
+
+#include <algorithm>
+
+namespace
+{
+// User data of requests whose completion carries nothing of interest (poll removals). This is the
+// same value liburing uses for its internal timeout requests so both are dropped the same way.
+constexpr uint64_t URING_IGNORE = UINT64_MAX;
+
+constexpr unsigned URING_SQ_ENTRIES = 4096;
+constexpr unsigned URING_REAP_BATCH = 256;
+} // namespace
+
+bool
+PollDescriptor::uring_init()
+{
+  if (net_config_poll_backend != POLL_BACKEND_IO_URING) {
+    return false;
+  }
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  // Size the completion ring to hold a full poll result so a busy loop does not overflow it.
+  params.flags      = IORING_SETUP_CQSIZE;
+  params.cq_entries = POLL_DESCRIPTOR_SIZE;
+
+  int r = io_uring_queue_init_params(URING_SQ_ENTRIES, &uring, &params);
+  if (r < 0) {
+    Warning("io_uring poll backend unavailable (%s), falling back to epoll", strerror(-r));
+    return false;
+  }
+  uring_slots.reserve(1024);
+  return true;
+}
+
+PollDescriptor::~PollDescriptor()
+{
+  if (uring_enabled) {
+    io_uring_queue_exit(&uring);
+  }
+}
+
+struct io_uring_sqe *
+PollDescriptor::uring_get_sqe()
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe(&uring);
+  if (sqe == nullptr) {
+    // The submission ring is full, hand what we have to the kernel without waiting.
+    io_uring_submit(&uring);
+    sqe = io_uring_get_sqe(&uring);
+  }
+  return sqe;
+}
+
+int
+PollDescriptor::uring_arm(int fd, uint32_t events, void *data)
+{
+  int32_t slot;
+  if (uring_free >= 0) {
+    slot       = uring_free;
+    uring_free = uring_slots[slot].next;
+  } else {
+    slot = static_cast<int32_t>(uring_slots.size());
+    uring_slots.emplace_back();
+  }
+
+  UringSlot &s = uring_slots[slot];
+  s.data       = data;
+  s.fd         = fd;
+  // Multishot polls are already edge style, they trigger on each wake up of the descriptor.
+  s.mask  = events & ~(EPOLLET | EPOLLEXCLUSIVE);
+  s.armed = false;
+  s.next  = -1;
+
+  struct io_uring_sqe *sqe = uring_get_sqe();
+  if (sqe == nullptr) {
+    s.data     = nullptr;
+    s.next     = uring_free;
+    uring_free = slot;
+    errno      = EBUSY;
+    return -1;
+  }
+  io_uring_prep_poll_multishot(sqe, fd, s.mask);
+  io_uring_sqe_set_data64(sqe, slot);
+  s.armed = true;
+  return slot;
+}
+
+int
+PollDescriptor::uring_disarm(int slot)
+{
+  UringSlot &s = uring_slots[slot];
+  s.data       = nullptr;
+
+  if (!s.armed) {
+    s.next     = uring_free;
+    uring_free = slot;
+    return 0;
+  }
+
+  // The slot stays reserved until the kernel posts the final completion for the poll.
+  uring_requeue(slot);
+  return 0;
+}
+
+// Queue what @a slot is missing, a removal once disarmed or a poll while it is still wanted. Without
+// a free SQE the slot is kept in uring_retry, for the next uring_wait.
+void
+PollDescriptor::uring_requeue(int32_t slot)
+{
+  UringSlot &s = uring_slots[slot];
+  if (s.data == nullptr ? !s.armed : s.armed) {
+    return;
+  }
+
+  struct io_uring_sqe *sqe = uring_get_sqe();
+  if (sqe == nullptr) {
+    uring_retry.push_back(slot);
+    return;
+  }
+  if (s.data == nullptr) {
+    io_uring_prep_poll_remove(sqe, slot);
+    io_uring_sqe_set_data64(sqe, URING_IGNORE);
+  } else {
+    io_uring_prep_poll_multishot(sqe, s.fd, s.mask);
+    io_uring_sqe_set_data64(sqe, slot);
+    s.armed = true;
+  }
+}
+
+int
+PollDescriptor::uring_wait(int timeout_ms)
+{
+  if (!uring_retry.empty()) {
+    std::vector<int32_t> retry;
+    retry.swap(uring_retry);
+    for (int32_t slot : retry) {
+      uring_requeue(slot);
+    }
+  }
+
+  int r;
+  if (timeout_ms > 0) {
+    struct io_uring_cqe *cqe = nullptr;
+    struct __kernel_timespec ts;
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = 1000000 * (timeout_ms % 1000);
+    r          = io_uring_submit_and_wait_timeout(&uring, &cqe, 1, &ts, nullptr);
+  } else if (timeout_ms < 0) {
+    r = io_uring_submit_and_wait(&uring, 1);
+  } else {
+    r = io_uring_submit(&uring);
+  }
+  if (r < 0 && r != -ETIME && r != -EINTR && r != -EBUSY) {
+    Debug("iocore_net_poll", "[PollDescriptor::uring_wait] io_uring_enter failed: %s", strerror(-r));
+  }
+
+  int n = 0;
+  struct io_uring_cqe *cqes[URING_REAP_BATCH];
+  while (n < POLL_DESCRIPTOR_SIZE) {
+    unsigned count = io_uring_peek_batch_cqe(&uring, cqes, std::min<unsigned>(URING_REAP_BATCH, POLL_DESCRIPTOR_SIZE - n));
+    if (count == 0) {
+      break;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+      uint64_t ud = io_uring_cqe_get_data64(cqes[i]);
+      if (ud == URING_IGNORE) {
+        continue;
+      }
+
+      UringSlot &s = uring_slots[ud];
+      int res      = cqes[i]->res;
+      bool more    = cqes[i]->flags & IORING_CQE_F_MORE;
+      if (!more) {
+        s.armed = false;
+      }
+
+      if (s.data == nullptr) {
+        // Disarmed while the completion was in flight.
+        if (!more) {
+          s.next     = uring_free;
+          uring_free = static_cast<int32_t>(ud);
+        }
+        continue;
+      }
+
+      if (res != -ECANCELED) {
+        ePoll_Triggered_Events[n].events   = res < 0 ? EPOLLERR : static_cast<uint32_t>(res);
+        ePoll_Triggered_Events[n].data.ptr = s.data;
+        ++n;
+      }
+
+      // The kernel may terminate a multishot poll (e.g. on completion ring overflow), re-arm it.
+      if (!more && res >= 0) {
+        uring_requeue(static_cast<int32_t>(ud));
+      }
+    }
+    io_uring_cq_advance(&uring, count);
+  }
+
+  return n;
+}
+
+#endif
@@ -37,6 +37,19 @@
 #include "P_Net.h"
 #include "P_UDPNet.h"
 
+#include <netinet/udp.h>
+
+// Linux has recvmmsg(2) and sendmmsg(2) where it has MSG_WAITFORONE.
+#if defined(MSG_WAITFORONE)
+#define TS_HAS_UDP_MMSG 1
+#if defined(UDP_SEGMENT)
+#define TS_HAS_UDP_GSO 1
+#endif
+#if defined(UDP_GRO)
+#define TS_HAS_UDP_GRO 1
+#endif
+#endif
+
 using UDPNetContHandler = int (UDPNetHandler::*)(int, void *);
 
 inkcoreapi ClassAllocator<UDPPacketInternal> udpPacketAllocator("udpPacketAllocator");
@@ -52,6 +65,8 @@ UDPNetProcessor &udpNet = udpNetInternal;
 int32_t g_udp_periodicCleanupSlots;
 int32_t g_udp_periodicFreeCancelledPkts;
 int32_t g_udp_numSendRetries;
+int32_t g_udp_enableGSO;
+int32_t g_udp_enableGRO;
 
 //
 // Public functions
@@ -91,6 +106,13 @@ initialize_thread_for_udp_net(EThread *thread)
   REC_ReadConfigInt32(g_udp_numSendRetries, "proxy.config.udp.send_retries");
   g_udp_numSendRetries = g_udp_numSendRetries < 0 ? 0 : g_udp_numSendRetries;
 
+  // Segmentation offload of sends to and coalescing of receives from the same peer.
+  REC_ReadConfigInt32(g_udp_enableGSO, "proxy.config.udp.enable_gso");
+  REC_ReadConfigInt32(g_udp_enableGRO, "proxy.config.udp.enable_gro");
+#if TS_HAS_UDP_GSO
+  nh->udpOutQueue.gso = g_udp_enableGSO != 0;
+#endif
+
   thread->set_tail_handler(nh);
   thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
   new (thread->ep) EventIO();
@@ -119,6 +141,144 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
+// Set the address in @a toaddr to the destination address of the datagram received with @a msg.
+static void
+get_destination_address(struct msghdr *msg, sockaddr_in6 *toaddr)
+{
+  for (auto cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+    switch (cmsg->cmsg_type) {
+#ifdef IP_PKTINFO
+    case IP_PKTINFO:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_pktinfo *pktinfo                               = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
+      }
+      break;
+#endif
+#ifdef IP_RECVDSTADDR
+    case IP_RECVDSTADDR:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_addr *addr                                     = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(toaddr)->sin_addr.s_addr = addr->s_addr;
+      }
+      break;
+#endif
+#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
+    case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
+      if (cmsg->cmsg_level == IPPROTO_IPV6) {
+        struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+        memcpy(toaddr->sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
+      }
+      break;
+#endif
+    }
+  }
+}
+
+#if TS_HAS_UDP_MMSG
+// Datagrams received by one recvmmsg(2). A buffer takes the largest datagram, or a train of
+// datagrams coalesced by GRO.
+static constexpr int UDP_READ_BATCH       = 16;
+static constexpr int UDP_READ_BUFFER_SIZE = 65536;
+
+void
+UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
+{
+  UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
+
+  // receive packets and queue onto UDPConnection.
+  // don't call back connection at this time.
+  int n;
+  int iters = 0;
+
+  struct mmsghdr msgs[UDP_READ_BATCH];
+  struct iovec iov[UDP_READ_BATCH];
+  sockaddr_in6 fromaddr[UDP_READ_BATCH];
+  alignas(struct cmsghdr) char cbuf[UDP_READ_BATCH][1024];
+
+  if (nh->read_buffers == nullptr) {
+    nh->read_buffers = static_cast<char *>(ats_malloc(UDP_READ_BATCH * UDP_READ_BUFFER_SIZE));
+  }
+
+  sockaddr_in6 localaddr;
+  int localaddr_len = sizeof(localaddr);
+  safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&localaddr), &localaddr_len);
+
+  do {
+    for (int i = 0; i < UDP_READ_BATCH; ++i) {
+      iov[i].iov_base                = nh->read_buffers + i * UDP_READ_BUFFER_SIZE;
+      iov[i].iov_len                 = UDP_READ_BUFFER_SIZE;
+      msgs[i].msg_hdr.msg_name       = &fromaddr[i];
+      msgs[i].msg_hdr.msg_namelen    = sizeof(fromaddr[i]);
+      msgs[i].msg_hdr.msg_iov        = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen     = 1;
+      msgs[i].msg_hdr.msg_control    = cbuf[i];
+      msgs[i].msg_hdr.msg_controllen = sizeof(cbuf[i]);
+      msgs[i].msg_hdr.msg_flags      = 0;
+      msgs[i].msg_len                = 0;
+    }
+
+    n = ::recvmmsg(uc->getFd(), msgs, UDP_READ_BATCH, 0, nullptr);
+    if (n <= 0) {
+      // error
+      break;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      struct msghdr *msg = &msgs[i].msg_hdr;
+      int64_t len        = msgs[i].msg_len;
+      int64_t seg_size   = len;
+
+      // truncated check
+      if (msg->msg_flags & MSG_TRUNC) {
+        Debug("udp-read", "The UDP packet is truncated");
+      }
+
+      sockaddr_in6 toaddr = localaddr;
+      get_destination_address(msg, &toaddr);
+#if TS_HAS_UDP_GRO
+      for (auto cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          int gso_size;
+          memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+          if (gso_size > 0) {
+            seg_size = gso_size;
+          }
+        }
+      }
+#endif
+
+      // One packet per datagram, GRO delivers a train of them in one buffer.
+      char const *data = static_cast<char const *>(iov[i].iov_base);
+      for (int64_t offset = 0; offset < len; offset += seg_size) {
+        int64_t size = std::min(seg_size, len - offset);
+        Ptr<IOBufferBlock> chain(new_IOBufferBlock());
+        chain->alloc(iobuffer_size_to_index(size, MAX_BUFFER_SIZE_INDEX));
+        memcpy(chain->end(), data + offset, size);
+        chain->fill(size);
+
+        // create packet
+        UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr[i]), ats_ip_sa_cast(&toaddr), chain);
+        p->setConnection(uc);
+        // queue onto the UDPConnection
+        uc->inQueue.push((UDPPacketInternal *)p);
+        iters++;
+      }
+    }
+  } while (n > 0);
+  if (iters >= 1) {
+    Debug("udp-read", "read %d at a time", iters);
+  }
+  // if not already on to-be-called-back queue, then add it.
+  if (!uc->onCallbackQueue) {
+    ink_assert(uc->callback_link.next == nullptr);
+    ink_assert(uc->callback_link.prev == nullptr);
+    uc->AddRef();
+    nh->udp_callbacks.enqueue(uc);
+    uc->onCallbackQueue = 1;
+  }
+}
+#else
 void
 UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
 {
@@ -206,34 +366,7 @@ UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc
     }
 
     safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
-    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-      switch (cmsg->cmsg_type) {
-#ifdef IP_PKTINFO
-      case IP_PKTINFO:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
-        }
-        break;
-#endif
-#ifdef IP_RECVDSTADDR
-      case IP_RECVDSTADDR:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
-        }
-        break;
-#endif
-#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
-      case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
-        if (cmsg->cmsg_level == IPPROTO_IPV6) {
-          struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
-          memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
-        }
-        break;
-#endif
-      }
-    }
+    get_destination_address(&msg, &toaddr);
 
     // create packet
     UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
@@ -258,6 +391,7 @@ UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc
     uc->onCallbackQueue = 1;
   }
 }
+#endif
 
 int
 UDPNetProcessorInternal::udp_callback(UDPNetHandler *nh, UDPConnection *xuc, EThread *thread)
@@ -793,6 +927,13 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
     }
   }
 
+#if TS_HAS_UDP_GRO
+  // The kernel may coalesce datagrams from the same peer, udp_read_from_net splits them again.
+  if (g_udp_enableGRO && safe_setsockopt(fd, SOL_UDP, UDP_GRO, SOCKOPT_ON, sizeof(int)) < 0) {
+    Debug("udpnet", "setsockopt for UDP_GRO failed: %s", strerror(errno));
+  }
+#endif
+
   // If this is a class D address (i.e. multicast address), use REUSEADDR.
   if (ats_is_ip_multicast(addr)) {
     int enable_reuseaddr = 1;
@@ -833,7 +974,17 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
   pc = get_UDPPollCont(n->ethread);
   pd = pc->pollDescriptor;
 
+#if TS_USE_LINUX_IO_URING
+  // The submission ring of an io_uring event loop is only touched by its own thread, which starts
+  // the connection as it takes it from newconn_list.
+  if (pd->uring_enabled) {
+    n->ethread->tail_cb->signalActivity();
+  } else {
+    n->ep.start(pd, n, EVENTIO_READ);
+  }
+#else
   n->ep.start(pd, n, EVENTIO_READ);
+#endif
 
   cont->handleEvent(NET_EVENT_DATAGRAM_OPEN, n);
   return ACTION_RESULT_DONE;
@@ -922,24 +1073,20 @@ sendPackets:
     p      = pipeInfo.getFirstPacket();
     pktLen = p->getPktLength();
 
-    if (p->conn->shouldDestroy()) {
-      goto next_pkt;
-    }
-    if (p->conn->GetSendGenerationNumber() != p->reqGenerationNum) {
-      goto next_pkt;
+    if (p->conn->shouldDestroy() || p->conn->GetSendGenerationNumber() != p->reqGenerationNum) {
+      p->free();
+    } else {
+      BatchUDPPacket(p);
+      bytesUsed += pktLen;
+      bytesThisPipe -= pktLen;
     }
-
-    SendUDPPacket(p, pktLen);
-    bytesUsed += pktLen;
-    bytesThisPipe -= pktLen;
-  next_pkt:
     sentOne = true;
-    p->free();
 
     if (bytesThisPipe < 0) {
       break;
     }
   }
+  FlushBatch();
 
   bytesThisSlot -= bytesUsed;
 
@@ -1010,6 +1157,144 @@ UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
   }
 }
 
+#if TS_HAS_UDP_MMSG
+// Limits of a segmented datagram, the kernel takes no more than UDP_MAX_SEGMENTS segments.
+static constexpr int UDP_GSO_MAX_SEGMENTS = 64;
+static constexpr int UDP_GSO_MAX_BYTES    = 65507;
+
+void
+UDPQueue::BatchUDPPacket(UDPPacketInternal *p)
+{
+  int niov = 0;
+  for (IOBufferBlock *b = p->chain.get(); b != nullptr; b = b->next.get()) {
+    ++niov;
+  }
+  if (niov > SEND_BATCH_IOVS) {
+    // Too many blocks for a batch, this is not how packets are made.
+    FlushBatch();
+    SendUDPPacket(p, p->pktLength);
+    p->free();
+    return;
+  }
+  if (batch_len == SEND_BATCH_PACKETS || batch_iovs + niov > SEND_BATCH_IOVS || (batch_len > 0 && batch[0]->conn != p->conn)) {
+    FlushBatch();
+  }
+  p->conn->lastSentPktStartTime = p->delivery_time;
+  Debug("udp-send", "Sending %p", p);
+  batch[batch_len++] = p;
+  batch_iovs += niov;
+}
+
+void
+UDPQueue::FlushBatch()
+{
+  struct mmsghdr msgs[SEND_BATCH_PACKETS];
+  struct iovec iov[SEND_BATCH_IOVS];
+  int first[SEND_BATCH_PACKETS + 1]; // First packet of each message, and the end of the batch.
+#if TS_HAS_UDP_GSO
+  alignas(struct cmsghdr) char control[SEND_BATCH_PACKETS][CMSG_SPACE(sizeof(uint16_t))];
+#endif
+  int start = 0;
+  int count = 0;
+
+  while (start < batch_len) {
+    // Build the messages for the packets not sent yet.
+    int nmsg = 0;
+    int niov = 0;
+    for (int i = start; i < batch_len; ++nmsg) {
+      UDPPacketInternal *p = batch[i];
+      struct msghdr *msg   = &msgs[nmsg].msg_hdr;
+      int64_t seg_size     = p->pktLength;
+      int64_t total        = 0;
+      int nseg             = 0;
+
+      first[nmsg]         = i;
+      msg->msg_name       = reinterpret_cast<caddr_t>(&p->to.sa);
+      msg->msg_namelen    = ats_ip_size(p->to);
+      msg->msg_iov        = &iov[niov];
+      msg->msg_control    = nullptr;
+      msg->msg_controllen = 0;
+      msg->msg_flags      = 0;
+      // With GSO, packets of the same size to the same address go as segments of one datagram,
+      // the last of them can be shorter.
+      do {
+        UDPPacketInternal *q = batch[i];
+        for (IOBufferBlock *b = q->chain.get(); b != nullptr; b = b->next.get()) {
+          iov[niov].iov_base = static_cast<caddr_t>(b->start());
+          iov[niov].iov_len  = b->size();
+          ++niov;
+        }
+        total += q->pktLength;
+        ++nseg;
+        ++i;
+      } while (gso && i < batch_len && nseg < UDP_GSO_MAX_SEGMENTS && batch[i - 1]->pktLength == seg_size &&
+               batch[i]->pktLength <= seg_size && total + batch[i]->pktLength <= UDP_GSO_MAX_BYTES &&
+               ats_ip_addr_port_eq(&batch[i]->to.sa, &p->to.sa));
+      msg->msg_iovlen = &iov[niov] - msg->msg_iov;
+#if TS_HAS_UDP_GSO
+      if (nseg > 1) {
+        uint16_t segment    = seg_size;
+        msg->msg_control    = control[nmsg];
+        msg->msg_controllen = sizeof(control[nmsg]);
+        struct cmsghdr *cm  = CMSG_FIRSTHDR(msg);
+        cm->cmsg_level      = SOL_UDP;
+        cm->cmsg_type       = UDP_SEGMENT;
+        cm->cmsg_len        = CMSG_LEN(sizeof(segment));
+        memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+      }
+#endif
+    }
+    first[nmsg] = batch_len;
+
+    int n = ::sendmmsg(batch[start]->conn->getFd(), msgs, nmsg, 0);
+    if (n > 0) {
+      start = first[n];
+      count = 0;
+      continue;
+    }
+    if (errno == EAGAIN) {
+      ++count;
+      if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
+        // tried too many times; give up
+        Debug("udpnet", "Send failed: too many retries");
+        break;
+      }
+      continue;
+    }
+#if TS_HAS_UDP_GSO
+    if (first[1] - first[0] > 1 && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+      // The kernel or the device cannot segment, send the packets one by one from now on.
+      Debug("udpnet", "Segmented send failed, disabling GSO: %s (%d)", strerror(errno), errno);
+      gso = false;
+      continue;
+    }
+#endif
+    // Skip the packets of the failed message.
+    Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+    start = first[1];
+    count = 0;
+  }
+
+  for (int i = 0; i < batch_len; ++i) {
+    batch[i]->free();
+  }
+  batch_len  = 0;
+  batch_iovs = 0;
+}
+#else
+void
+UDPQueue::BatchUDPPacket(UDPPacketInternal *p)
+{
+  SendUDPPacket(p, p->pktLength);
+  p->free();
+}
+
+void
+UDPQueue::FlushBatch()
+{
+}
+#endif
+
 void
 UDPQueue::send(UDPPacket *p)
 {
@@ -1083,6 +1368,11 @@ UDPNetHandler::waitForActivity(ink_hrtime timeout)
     } else {
       ink_assert(uc->mutex && uc->continuation);
       open_list.in_or_enqueue(uc); // due to the above race
+#if TS_USE_LINUX_IO_URING
+      if (pc->pollDescriptor->uring_enabled && uc->ep.event_loop == nullptr) {
+        uc->ep.start(pc->pollDescriptor, uc, EVENTIO_READ);
+      }
+#endif
     }
   }
 
@@ -543,7 +543,7 @@ public:
   }
 
   virtual void
-  on_packet_sent(size_t bytes_sent) override
+  on_packet_sent(QUICSentPacketInfo &packet) override
   {
   }
   virtual void
@@ -576,6 +576,11 @@ public:
   {
     return 0;
   }
+  virtual uint64_t
+  pacing_rate() const override
+  {
+    return 0;
+  }
   virtual uint32_t
   congestion_window() const override
   {
@@ -143,7 +143,7 @@ QUICAckFrameManager::set_max_ack_delay(uint16_t delay)
 void
 QUICAckFrameManager::QUICAckFrameCreator::refresh_state()
 {
-  if (this->_packet_numbers.empty() || !this->_available) {
+  if (this->_ranges.empty() || !this->_available) {
     return;
   }
 
@@ -154,18 +154,21 @@ QUICAckFrameManager::QUICAckFrameCreator::refresh_state()
 void
 QUICAckFrameManager::QUICAckFrameCreator::forget(QUICPacketNumber largest_acknowledged)
 {
-  this->_available = false;
-  this->sort();
-  std::list<RecvdPacket> remove_list;
-  for (auto it = this->_packet_numbers.begin(); it != this->_packet_numbers.end(); it++) {
-    if ((*it).packet_number == largest_acknowledged) {
-      remove_list.splice(remove_list.begin(), this->_packet_numbers, it, this->_packet_numbers.end());
+  // Packets up to the largest one in the ACK frame the peer received don't need to be acknowledged anymore
+  auto it = this->_ranges.begin();
+  for (; it != this->_ranges.end() && it->first <= largest_acknowledged; ++it) {
+    if (it->last > largest_acknowledged) {
+      this->_packet_count -= largest_acknowledged - it->first + 1;
+      it->first = largest_acknowledged + 1;
       break;
     }
-    this->_available |= !(*it).ack_only;
+    this->_packet_count -= it->last - it->first + 1;
   }
+  this->_ranges.erase(this->_ranges.begin(), it);
 
-  if (this->_packet_numbers.empty() || !this->_available) {
+  this->_available = this->_available && this->_largest_ack_eliciting > largest_acknowledged;
+
+  if (this->_ranges.empty() || !this->_available) {
     this->_should_send = false;
   }
 }
@@ -198,6 +201,9 @@ QUICAckFrameManager::QUICAckFrameCreator::push_back(QUICPacketNumber packet_numb
   }
 
   if (!ack_only) {
+    if (!this->_available || packet_number > this->_largest_ack_eliciting) {
+      this->_largest_ack_eliciting = packet_number;
+    }
     this->_available    = true;
     this->_has_new_data = true;
   } else {
@@ -205,19 +211,60 @@ QUICAckFrameManager::QUICAckFrameCreator::push_back(QUICPacketNumber packet_numb
   }
 
   this->_expect_next = packet_number + 1;
-  this->_packet_numbers.push_back({ack_only, packet_number});
+  if (this->_insert(packet_number)) {
+    ++this->_packet_count;
+  }
+}
+
+bool
+QUICAckFrameManager::QUICAckFrameCreator::_insert(QUICPacketNumber packet_number)
+{
+  std::vector<RecvdRange> &ranges = this->_ranges;
+
+  // In order packets only extend the last range
+  if (ranges.empty() || packet_number > ranges.back().last + 1) {
+    ranges.push_back({packet_number, packet_number});
+    return true;
+  } else if (packet_number == ranges.back().last + 1) {
+    ranges.back().last = packet_number;
+    return true;
+  }
+
+  // The first range which ends at or after the packet number
+  auto it = std::lower_bound(ranges.begin(), ranges.end(), packet_number,
+                             [](const RecvdRange &range, QUICPacketNumber pn) { return range.last < pn; });
+  if (it->first <= packet_number) {
+    // duplicated
+    return false;
+  }
+
+  bool joins_prev = it != ranges.begin() && std::prev(it)->last + 1 == packet_number;
+  bool joins_next = it->first == packet_number + 1;
+  if (joins_prev && joins_next) {
+    std::prev(it)->last = it->last;
+    ranges.erase(it);
+  } else if (joins_prev) {
+    std::prev(it)->last = packet_number;
+  } else if (joins_next) {
+    it->first = packet_number;
+  } else {
+    ranges.insert(it, {packet_number, packet_number});
+  }
+
+  return true;
 }
 
 size_t
 QUICAckFrameManager::QUICAckFrameCreator::size() const
 {
-  return this->_packet_numbers.size();
+  return this->_packet_count;
 }
 
 void
 QUICAckFrameManager::QUICAckFrameCreator::clear()
 {
-  this->_packet_numbers.clear();
+  this->_ranges.clear();
+  this->_packet_count                = 0;
   this->_largest_ack_number          = 0;
   this->_largest_ack_received_time   = 0;
   this->_latest_packet_received_time = 0;
@@ -238,13 +285,6 @@ QUICAckFrameManager::QUICAckFrameCreator::largest_ack_received_time() const
   return this->_largest_ack_received_time;
 }
 
-void
-QUICAckFrameManager::QUICAckFrameCreator::sort()
-{
-  //  TODO Find more smart way
-  this->_packet_numbers.sort([](const RecvdPacket &a, const RecvdPacket &b) -> bool { return a.packet_number > b.packet_number; });
-}
-
 QUICAckFrame *
 QUICAckFrameManager::QUICAckFrameCreator::generate_ack_frame(uint8_t *buf, uint16_t maximum_frame_size)
 {
@@ -268,61 +308,33 @@ QUICAckFrameManager::QUICAckFrameCreator::generate_ack_frame(uint8_t *buf, uint1
 QUICAckFrame *
 QUICAckFrameManager::QUICAckFrameCreator::_create_ack_frame(uint8_t *buf)
 {
-  ink_assert(!this->_packet_numbers.empty());
+  ink_assert(!this->_ranges.empty());
   QUICAckFrame *ack_frame = nullptr;
-  this->sort();
-  std::list<RecvdPacket> &list = this->_packet_numbers;
 
   this->_has_new_data = false;
 
-  uint8_t gap     = 0;
-  uint64_t length = 0;
-  auto it         = list.begin();
-
-  // skip ack_only packets
-  for (; it != list.end(); it++) {
-    if (!(*it).ack_only) {
+  // skip ack_only packets above the largest ack-eliciting one
+  auto it = this->_ranges.rbegin();
+  for (; it != this->_ranges.rend(); it++) {
+    if (it->first <= this->_largest_ack_eliciting) {
       break;
     }
   }
 
-  if (it == list.end()) {
+  if (it == this->_ranges.rend()) {
     return ack_frame;
   }
 
-  QUICPacketNumber largest_ack_number = (*it).packet_number;
-  QUICPacketNumber last_ack_number    = largest_ack_number;
+  QUICPacketNumber largest_ack_number = std::min(it->last, this->_largest_ack_eliciting);
+  QUICPacketNumber smallest           = it->first;
+  uint64_t delay                      = this->_calculate_delay();
 
-  while (it != list.end()) {
-    QUICPacketNumber pn = (*it).packet_number;
-    if (pn == last_ack_number) {
-      last_ack_number--;
-      length++;
-      it++;
-      continue;
-    }
-
-    ink_assert(length > 0);
-
-    if (ack_frame) {
-      ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
-    } else {
-      uint64_t delay = this->_calculate_delay();
-      ack_frame      = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1,
-                                                     this->_ack_manager->issue_frame_id(), this->_ack_manager);
-    }
+  ack_frame = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, largest_ack_number - smallest,
+                                                 this->_ack_manager->issue_frame_id(), this->_ack_manager);
 
-    gap             = last_ack_number - pn;
-    last_ack_number = pn;
-    length          = 0;
-  }
-
-  if (ack_frame) {
-    ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
-  } else {
-    uint64_t delay = this->_calculate_delay();
-    ack_frame = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1, this->_ack_manager->issue_frame_id(),
-                                                   this->_ack_manager);
+  for (it++; it != this->_ranges.rend(); it++) {
+    ack_frame->ack_block_section()->add_ack_block({smallest - it->last - 2, it->last - it->first});
+    smallest = it->first;
   }
 
   return ack_frame;
@@ -350,13 +362,13 @@ QUICAckFrameManager::QUICAckFrameCreator::available() const
 bool
 QUICAckFrameManager::QUICAckFrameCreator::is_ack_frame_ready()
 {
-  if (this->_available && this->_has_new_data && !this->_packet_numbers.empty() &&
+  if (this->_available && this->_has_new_data && !this->_ranges.empty() &&
       this->_latest_packet_received_time + this->_max_ack_delay * HRTIME_MSECOND <= Thread::get_hrtime()) {
     // when we has new data and the data is available to send (not ack only). and we delay for too much time. Send it out
     this->_should_send = true;
   }
 
-  return this->_should_send && this->_available && !this->_packet_numbers.empty();
+  return this->_should_send && this->_available && !this->_ranges.empty();
 }
 
 void
@@ -26,7 +26,7 @@
 #include "QUICFrameGenerator.h"
 #include "QUICTypes.h"
 #include "QUICFrame.h"
-#include <list>
+#include <vector>
 
 class QUICConnection;
 
@@ -36,9 +36,10 @@ public:
   class QUICAckFrameCreator
   {
   public:
-    struct RecvdPacket {
-      bool ack_only                  = false;
-      QUICPacketNumber packet_number = 0;
+    // Contiguous packet numbers received, [first, last]
+    struct RecvdRange {
+      QUICPacketNumber first = 0;
+      QUICPacketNumber last  = 0;
     };
     QUICAckFrameCreator(QUICPacketNumberSpace pn_space, QUICAckFrameManager *ack_manager);
     ~QUICAckFrameCreator();
@@ -46,7 +47,6 @@ public:
     void push_back(QUICPacketNumber packet_number, size_t size, bool ack_only);
     size_t size() const;
     void clear();
-    void sort();
     void forget(QUICPacketNumber largest_acknowledged);
     bool available() const;
     bool is_ack_frame_ready();
@@ -64,8 +64,12 @@ public:
   private:
     uint64_t _calculate_delay();
     QUICAckFrame *_create_ack_frame(uint8_t *buf);
+    bool _insert(QUICPacketNumber packet_number);
 
-    std::list<RecvdPacket> _packet_numbers;
+    // Sorted in ascending order and never adjacent to each other
+    std::vector<RecvdRange> _ranges;
+    size_t _packet_count                    = 0;
+    QUICPacketNumber _largest_ack_eliciting = 0;     // valid only if _available
     bool _available                         = false; // packet_number has data to sent
     bool _should_send                       = false; // ack frame should be sent immediately
     bool _has_new_data                      = false; // new data after last sent
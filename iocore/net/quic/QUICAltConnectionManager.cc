@@ -111,7 +111,12 @@ QUICAltConnectionManager::AltConnectionInfo
 QUICAltConnectionManager::_generate_next_alt_con_info()
 {
   QUICConnectionId conn_id;
-  conn_id.randomize();
+  if (this->_qc->direction() == NET_VCONNECTION_IN) {
+    // Alt CIDs stay with the thread that owns the connection
+    conn_id = this->_ctable.issue_connection_id(this->_ctable.owner(this->_qc->connection_id()));
+  } else {
+    conn_id.randomize();
+  }
   QUICStatelessResetToken token(conn_id, this->_instance_id);
   AltConnectionInfo aci = {++this->_alt_quic_connection_id_seq_num, conn_id, token, {false}};
 
@@ -27,6 +27,9 @@
 static constexpr char tag_stream_io[] = "quic_stream_io";
 static constexpr char tag_app[]       = "quic_app";
 
+// Blocks smaller than this are copied into the write buffer instead of being referred
+static constexpr int64_t WRITE_BLOCK_CLONE_THRESHOLD = 1024;
+
 #define QUICStreamIODebug(fmt, ...)                                                                                           \
   Debug(tag_stream_io, "[%s] [%" PRIu64 "] " fmt, this->_stream_vc->connection_info()->cids().data(), this->_stream_vc->id(), \
         ##__VA_ARGS__)
@@ -168,8 +171,26 @@ QUICStreamIO::write(IOBufferReader *r, int64_t len)
 int64_t
 QUICStreamIO::write(IOBufferBlock *b)
 {
-  ink_assert(!"not implemented yet");
-  return 0;
+  SCOPED_MUTEX_LOCK(lock, this->_write_vio->mutex, this_ethread());
+
+  int64_t nwritten = 0;
+  for (; b; b = b->next.get()) {
+    int64_t len = b->read_avail();
+    if (len == 0) {
+      continue;
+    }
+
+    // Small blocks (e.g. frame headers) are copied to share a block, which becomes one STREAM frame, with the data around them
+    if (len < WRITE_BLOCK_CLONE_THRESHOLD) {
+      this->_write_buffer->write(b->start(), len);
+    } else {
+      this->_write_buffer->append_block(b->clone());
+    }
+    nwritten += len;
+  }
+  this->_nwritten += nwritten;
+
+  return nwritten;
 }
 
 void
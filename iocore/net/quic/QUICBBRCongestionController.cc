@@ -0,0 +1,383 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <tscore/Diags.h>
+
+#include "QUICBBRCongestionController.h"
+
+#define QUICBBRDebug(fmt, ...)                                                                                         \
+  Debug("quic_cc", "[%s] bbr %s bw:%" PRIu64 " min_rtt:%" PRId64 " window:%" PRIu32 " in-flight:%" PRIu32 " " fmt,     \
+        this->_context.connection_info()->cids().data(), this->_mode_name(), this->_max_bw(), ink_hrtime_to_msec(this->_min_rtt), \
+        this->_congestion_window, this->_bytes_in_flight, ##__VA_ARGS__)
+
+QUICBBRCongestionController::QUICBBRCongestionController(QUICContext &context) : QUICNewRenoCongestionController(context)
+{
+  this->reset();
+}
+
+void
+QUICBBRCongestionController::reset()
+{
+  QUICNewRenoCongestionController::reset();
+
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+  this->_delivered            = 0;
+  this->_delivered_time       = 0;
+  this->_first_sent_time      = 0;
+  this->_round_count          = 0;
+  this->_next_round_delivered = 0;
+  this->_round_start          = false;
+  for (auto &sample : this->_bw_samples) {
+    sample = 0;
+  }
+  this->_min_rtt              = 0;
+  this->_min_rtt_stamp        = 0;
+  this->_min_rtt_expired      = false;
+  this->_filled_pipe          = false;
+  this->_full_bw              = 0;
+  this->_full_bw_count        = 0;
+  this->_cycle_index          = 0;
+  this->_cycle_stamp          = 0;
+  this->_probe_rtt_done_stamp = 0;
+  this->_probe_rtt_round_done = false;
+  this->_prior_cwnd           = 0;
+  this->_inflight_hi          = UINT64_MAX;
+  this->_enter_startup();
+}
+
+void
+QUICBBRCongestionController::on_packet_sent(QUICSentPacketInfo &packet)
+{
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+
+  // Note how much had been delivered when the packet left, its ack yields a delivery rate sample.
+  if (this->_bytes_in_flight == 0) {
+    this->_first_sent_time = packet.time_sent;
+    this->_delivered_time  = packet.time_sent;
+  }
+  packet.delivered       = this->_delivered;
+  packet.delivered_time  = this->_delivered_time;
+  packet.first_sent_time = this->_first_sent_time;
+
+  QUICNewRenoCongestionController::on_packet_sent(packet);
+}
+
+void
+QUICBBRCongestionController::on_packets_acked(const std::vector<QUICSentPacketInfoUPtr> &packets)
+{
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+
+  ink_hrtime now                   = Thread::get_hrtime();
+  uint64_t acked_bytes             = 0;
+  const QUICSentPacketInfo *sample = nullptr;
+  for (auto &packet : packets) {
+    if (packet->sent_bytes == 0) {
+      continue;
+    }
+    acked_bytes += packet->sent_bytes;
+    // The most recently sent packet gives the freshest sample.
+    if (sample == nullptr || packet->time_sent > sample->time_sent) {
+      sample = packet.get();
+    }
+  }
+
+  // Takes the packets out of flight, the window doesn't grow there because _grow_window does nothing.
+  QUICNewRenoCongestionController::on_packets_acked(packets);
+
+  if (sample == nullptr) {
+    return;
+  }
+
+  this->_delivered += acked_bytes;
+  this->_delivered_time  = now;
+  this->_first_sent_time = sample->time_sent;
+  this->_update_model(*sample, now);
+
+  if (this->_mode == Mode::STARTUP) {
+    this->_check_full_pipe();
+    if (this->_filled_pipe) {
+      this->_enter_drain();
+    }
+  }
+  if (this->_mode == Mode::DRAIN && this->_bytes_in_flight <= this->_bdp(1.0)) {
+    this->_enter_probe_bw(now);
+  }
+  if (this->_mode == Mode::PROBE_BW) {
+    this->_update_probe_bw_cycle(now);
+  }
+  this->_check_probe_rtt(now);
+  this->_set_cwnd(acked_bytes);
+}
+
+uint64_t
+QUICBBRCongestionController::pacing_rate() const
+{
+  uint64_t bw = this->_max_bw();
+  if (bw == 0) {
+    // Until there is a delivery rate, send the window over the smoothed RTT.
+    ink_hrtime srtt = this->_context.rtt_provider()->smoothed_rtt();
+    if (srtt <= 0) {
+      return 0;
+    }
+    return this->_pacing_gain * this->_congestion_window * HRTIME_SECOND / srtt;
+  }
+  return this->_pacing_gain * bw * PACING_MARGIN;
+}
+
+void
+QUICBBRCongestionController::_grow_window(const QUICSentPacketInfo & /* packet ATS_UNUSED */)
+{
+  // The window is set from the model once all the acknowledged packets are accounted for.
+}
+
+void
+QUICBBRCongestionController::_reduce_window()
+{
+  // A loss episode means the path holds less than the model says, bound the data in flight below what was there.
+  uint64_t inflight        = std::max<uint64_t>(this->_bytes_in_flight, this->_bdp(1.0));
+  this->_inflight_hi       = std::max<uint64_t>(inflight * LOSS_BETA, this->_min_pipe_cwnd());
+  this->_congestion_window = std::min<uint64_t>(this->_congestion_window, this->_inflight_hi);
+
+  if (this->_mode == Mode::STARTUP) {
+    this->_filled_pipe = true;
+    this->_enter_drain();
+  } else if (this->_mode == Mode::PROBE_BW && PROBE_BW_GAINS[this->_cycle_index] > 1) {
+    this->_advance_probe_bw_cycle(Thread::get_hrtime());
+  }
+  QUICBBRDebug("loss episode, in-flight capped at %" PRIu64, this->_inflight_hi);
+}
+
+void
+QUICBBRCongestionController::_collapse_window()
+{
+  QUICNewRenoCongestionController::_collapse_window();
+  this->_prior_cwnd = 0;
+}
+
+uint64_t
+QUICBBRCongestionController::_max_bw() const
+{
+  uint64_t bw = 0;
+  for (auto sample : this->_bw_samples) {
+    bw = std::max(bw, sample);
+  }
+  return bw;
+}
+
+uint64_t
+QUICBBRCongestionController::_bdp(double gain) const
+{
+  uint64_t bw = this->_max_bw();
+  if (this->_min_rtt == 0 || bw == 0) {
+    return gain * this->_k_initial_window;
+  }
+  return gain * bw * this->_min_rtt / HRTIME_SECOND;
+}
+
+uint32_t
+QUICBBRCongestionController::_min_pipe_cwnd() const
+{
+  return std::max(MIN_PIPE_PACKETS * this->_max_datagram_size, this->_k_minimum_window);
+}
+
+const char *
+QUICBBRCongestionController::_mode_name() const
+{
+  switch (this->_mode) {
+  case Mode::STARTUP:
+    return "startup";
+  case Mode::DRAIN:
+    return "drain";
+  case Mode::PROBE_BW:
+    return "probe_bw";
+  case Mode::PROBE_RTT:
+    return "probe_rtt";
+  }
+  return "unknown";
+}
+
+void
+QUICBBRCongestionController::_update_model(const QUICSentPacketInfo &packet, ink_hrtime now)
+{
+  // A round trip ends when a packet sent after the previous one ended is acknowledged.
+  this->_round_start = false;
+  if (packet.delivered >= this->_next_round_delivered) {
+    this->_next_round_delivered = this->_delivered;
+    ++this->_round_count;
+    this->_round_start                                          = true;
+    this->_bw_samples[this->_round_count % BW_FILTER_ROUNDS] = 0;
+  }
+
+  // Acks that arrive in a burst would overstate the rate, take the longer of the send and ack intervals.
+  ink_hrtime interval = std::max(packet.time_sent - packet.first_sent_time, now - packet.delivered_time);
+  if (interval > 0 && interval >= this->_min_rtt) {
+    uint64_t bw    = (this->_delivered - packet.delivered) * HRTIME_SECOND / interval;
+    uint64_t &slot = this->_bw_samples[this->_round_count % BW_FILTER_ROUNDS];
+    slot           = std::max(slot, bw);
+  }
+
+  ink_hrtime rtt         = now - packet.time_sent;
+  this->_min_rtt_expired = this->_min_rtt_stamp != 0 && now > this->_min_rtt_stamp + MIN_RTT_WINDOW;
+  if (rtt > 0 && (this->_min_rtt == 0 || rtt <= this->_min_rtt || this->_min_rtt_expired)) {
+    this->_min_rtt       = rtt;
+    this->_min_rtt_stamp = now;
+  }
+}
+
+void
+QUICBBRCongestionController::_check_full_pipe()
+{
+  if (this->_filled_pipe || !this->_round_start) {
+    return;
+  }
+  // The pipe is full once three round trips in a row didn't raise the delivery rate by a quarter.
+  uint64_t bw = this->_max_bw();
+  if (bw >= this->_full_bw * FULL_BW_GROWTH) {
+    this->_full_bw       = bw;
+    this->_full_bw_count = 0;
+    return;
+  }
+  if (++this->_full_bw_count >= FULL_BW_ROUNDS) {
+    this->_filled_pipe = true;
+  }
+}
+
+void
+QUICBBRCongestionController::_enter_startup()
+{
+  this->_mode        = Mode::STARTUP;
+  this->_pacing_gain = STARTUP_GAIN;
+  this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED, QUICCongestionController::State::SLOW_START);
+}
+
+void
+QUICBBRCongestionController::_enter_drain()
+{
+  this->_mode        = Mode::DRAIN;
+  this->_pacing_gain = 1 / STARTUP_GAIN;
+  QUICBBRDebug("pipe is full");
+}
+
+void
+QUICBBRCongestionController::_enter_probe_bw(ink_hrtime now)
+{
+  this->_mode = Mode::PROBE_BW;
+  // Start cruising, the next phase probes.
+  this->_cycle_index = N_PROBE_BW_GAINS - 1;
+  this->_cycle_stamp = now;
+  this->_pacing_gain = PROBE_BW_GAINS[this->_cycle_index];
+  this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
+                         QUICCongestionController::State::CONGESTION_AVOIDANCE);
+  QUICBBRDebug("queue is drained");
+}
+
+void
+QUICBBRCongestionController::_advance_probe_bw_cycle(ink_hrtime now)
+{
+  this->_cycle_index = (this->_cycle_index + 1) % N_PROBE_BW_GAINS;
+  this->_cycle_stamp = now;
+  this->_pacing_gain = PROBE_BW_GAINS[this->_cycle_index];
+
+  if (this->_pacing_gain > 1 && this->_inflight_hi != UINT64_MAX) {
+    // Probing again, let in-flight data grow past the cap left by the last loss episode.
+    this->_inflight_hi += this->_inflight_hi / 4;
+    if (this->_inflight_hi > this->_bdp(CWND_GAIN)) {
+      this->_inflight_hi = UINT64_MAX;
+    }
+  }
+}
+
+void
+QUICBBRCongestionController::_update_probe_bw_cycle(ink_hrtime now)
+{
+  ink_hrtime elapsed = now - this->_cycle_stamp;
+  bool advance       = elapsed > this->_min_rtt;
+
+  if (this->_pacing_gain > 1) {
+    // Probe until the extra data is in flight, unless the sender can't fill it.
+    advance = advance && (this->_bytes_in_flight >= this->_bdp(this->_pacing_gain) || elapsed > 2 * this->_min_rtt);
+  } else if (this->_pacing_gain < 1) {
+    // Stop draining as soon as the queue from the probe is gone.
+    advance = advance || this->_bytes_in_flight <= this->_bdp(1.0);
+  }
+
+  if (advance) {
+    this->_advance_probe_bw_cycle(now);
+  }
+}
+
+void
+QUICBBRCongestionController::_check_probe_rtt(ink_hrtime now)
+{
+  if (this->_mode != Mode::PROBE_RTT && this->_min_rtt_expired) {
+    this->_mode                 = Mode::PROBE_RTT;
+    this->_pacing_gain          = 1;
+    this->_prior_cwnd           = this->_congestion_window;
+    this->_probe_rtt_done_stamp = 0;
+    QUICBBRDebug("measuring the RTT again");
+  }
+  if (this->_mode != Mode::PROBE_RTT) {
+    return;
+  }
+
+  // Hold in-flight data at the minimum for 200ms and a round trip, then go back to the mode the model calls for.
+  if (this->_probe_rtt_done_stamp == 0 && this->_bytes_in_flight <= this->_min_pipe_cwnd()) {
+    this->_probe_rtt_done_stamp = now + PROBE_RTT_DURATION;
+    this->_probe_rtt_round_done = false;
+    this->_next_round_delivered = this->_delivered;
+  } else if (this->_probe_rtt_done_stamp != 0) {
+    if (this->_round_start) {
+      this->_probe_rtt_round_done = true;
+    }
+    if (this->_probe_rtt_round_done && now > this->_probe_rtt_done_stamp) {
+      this->_min_rtt_stamp     = now;
+      this->_congestion_window = std::max(this->_congestion_window, this->_prior_cwnd);
+      if (this->_filled_pipe) {
+        this->_enter_probe_bw(now);
+      } else {
+        this->_enter_startup();
+      }
+    }
+  }
+}
+
+void
+QUICBBRCongestionController::_set_cwnd(uint64_t acked_bytes)
+{
+  uint64_t cwnd = this->_congestion_window;
+
+  if (this->_mode == Mode::PROBE_RTT) {
+    cwnd = std::min<uint64_t>(cwnd, this->_min_pipe_cwnd());
+  } else {
+    // A couple of packets of headroom on top of the BDP keeps the pipe full while acks are delayed.
+    uint64_t target = this->_bdp(CWND_GAIN) + 3 * this->_max_datagram_size;
+    if (this->_filled_pipe) {
+      cwnd = std::min(cwnd + acked_bytes, target);
+    } else if (cwnd < target || this->_delivered < this->_k_initial_window) {
+      cwnd += acked_bytes;
+    }
+    cwnd = std::min(cwnd, this->_inflight_hi);
+  }
+
+  this->_congestion_window = std::min<uint64_t>(std::max<uint64_t>(cwnd, this->_min_pipe_cwnd()), UINT32_MAX);
+}
@@ -0,0 +1,129 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "QUICNewRenoCongestionController.h"
+
+/**
+   BBR, with the loss response of BBRv2.
+
+   The window and the pacing rate come from a model of the path: the highest delivery rate seen
+   over the last ten round trips and the lowest RTT seen over the last ten seconds. The connection
+   starts by doubling its rate each round trip until the delivery rate stops growing, drains the
+   queue that built up, and then cycles the pacing gain to probe for more bandwidth. Every ten
+   seconds without a lower RTT it cuts in-flight data for a moment to measure the RTT again.
+
+   Packet loss doesn't shrink the window as such. As in BBRv2 a loss episode caps the data in
+   flight at 0.7 of what was in flight, ends startup and ends a probe for more bandwidth. The cap is
+   raised by a quarter each time the connection probes again.
+
+   Loss recovery and the persistent congestion check are shared with NewReno.
+ */
+class QUICBBRCongestionController : public QUICNewRenoCongestionController
+{
+public:
+  QUICBBRCongestionController(QUICContext &context);
+
+  void on_packet_sent(QUICSentPacketInfo &packet) override;
+  void on_packets_acked(const std::vector<QUICSentPacketInfoUPtr> &packets) override;
+  void reset() override;
+  uint64_t pacing_rate() const override;
+
+protected:
+  void _grow_window(const QUICSentPacketInfo &packet) override;
+  void _reduce_window() override;
+  void _collapse_window() override;
+
+private:
+  enum class Mode : uint8_t {
+    STARTUP,
+    DRAIN,
+    PROBE_BW,
+    PROBE_RTT,
+  };
+
+  static constexpr double STARTUP_GAIN           = 2.885; // 2 / ln(2), doubles the rate each round trip
+  static constexpr double CWND_GAIN              = 2.0;
+  static constexpr double LOSS_BETA              = 0.7;
+  static constexpr double PACING_MARGIN          = 0.99;
+  static constexpr double PROBE_BW_GAINS[]       = {1.25, 0.75, 1, 1, 1, 1, 1, 1};
+  static constexpr int N_PROBE_BW_GAINS          = sizeof(PROBE_BW_GAINS) / sizeof(*PROBE_BW_GAINS);
+  static constexpr int BW_FILTER_ROUNDS          = 10;
+  static constexpr int FULL_BW_ROUNDS            = 3;
+  static constexpr double FULL_BW_GROWTH         = 1.25;
+  static constexpr ink_hrtime MIN_RTT_WINDOW     = HRTIME_SECONDS(10);
+  static constexpr ink_hrtime PROBE_RTT_DURATION = HRTIME_MSECONDS(200);
+  static constexpr uint32_t MIN_PIPE_PACKETS     = 4;
+
+  uint64_t _max_bw() const;
+  uint64_t _bdp(double gain) const;
+  uint32_t _min_pipe_cwnd() const;
+  const char *_mode_name() const;
+
+  void _update_model(const QUICSentPacketInfo &packet, ink_hrtime now);
+  void _check_full_pipe();
+  void _enter_startup();
+  void _enter_drain();
+  void _enter_probe_bw(ink_hrtime now);
+  void _advance_probe_bw_cycle(ink_hrtime now);
+  void _update_probe_bw_cycle(ink_hrtime now);
+  void _check_probe_rtt(ink_hrtime now);
+  void _set_cwnd(uint64_t acked_bytes);
+
+  Mode _mode          = Mode::STARTUP;
+  double _pacing_gain = STARTUP_GAIN;
+
+  // Delivery rate sampling
+  uint64_t _delivered         = 0;
+  ink_hrtime _delivered_time  = 0;
+  ink_hrtime _first_sent_time = 0;
+
+  // Round trips, counted by deliveries
+  uint64_t _round_count          = 0;
+  uint64_t _next_round_delivered = 0;
+  bool _round_start              = false;
+
+  // Path model, delivery rates are in bytes per second
+  uint64_t _bw_samples[BW_FILTER_ROUNDS] = {0};
+  ink_hrtime _min_rtt                    = 0;
+  ink_hrtime _min_rtt_stamp              = 0;
+  bool _min_rtt_expired                  = false;
+
+  // Startup
+  bool _filled_pipe  = false;
+  uint64_t _full_bw  = 0;
+  int _full_bw_count = 0;
+
+  // ProbeBW
+  int _cycle_index        = 0;
+  ink_hrtime _cycle_stamp = 0;
+
+  // ProbeRTT
+  ink_hrtime _probe_rtt_done_stamp = 0;
+  bool _probe_rtt_round_done       = false;
+  uint32_t _prior_cwnd             = 0;
+
+  // Loss response
+  uint64_t _inflight_hi = UINT64_MAX;
+};
@@ -34,6 +34,8 @@
 
 int QUICConfig::_config_id                   = 0;
 int QUICConfigParams::_connection_table_size = 65521;
+uint32_t QUICConfigParams::_lb_server_id     = 0;
+uint32_t QUICConfigParams::_lb_server_id_len = 0;
 
 SSL_CTX *
 quic_new_ssl_ctx()
@@ -118,6 +120,8 @@ QUICConfigParams::initialize()
 {
   REC_EstablishStaticConfigInt32U(this->_instance_id, "proxy.config.quic.instance_id");
   REC_EstablishStaticConfigInt32(this->_connection_table_size, "proxy.config.quic.connection_table.size");
+  REC_EstablishStaticConfigInt32U(this->_lb_server_id, "proxy.config.quic.lb.server_id");
+  REC_EstablishStaticConfigInt32U(this->_lb_server_id_len, "proxy.config.quic.lb.server_id_len");
   REC_EstablishStaticConfigInt32U(this->_stateless_retry, "proxy.config.quic.server.stateless_retry_enabled");
   REC_EstablishStaticConfigInt32U(this->_vn_exercise_enabled, "proxy.config.quic.client.vn_exercise_enabled");
   REC_EstablishStaticConfigInt32U(this->_cm_exercise_enabled, "proxy.config.quic.client.cm_exercise_enabled");
@@ -131,6 +135,10 @@ QUICConfigParams::initialize()
   REC_ReadConfigStringAlloc(this->_client_session_file, "proxy.config.quic.client.session_file");
   REC_ReadConfigStringAlloc(this->_client_keylog_file, "proxy.config.quic.client.keylog_file");
   REC_ReadConfigStringAlloc(this->_qlog_dir, "proxy.config.quic.qlog_dir");
+  REC_EstablishStaticConfigInt32U(this->_qlog_ring_size, "proxy.config.quic.qlog.ring_size");
+  REC_EstablishStaticConfigInt32U(this->_qlog_slow_rtt, "proxy.config.quic.qlog.slow_rtt");
+  REC_EstablishStaticConfigInt32U(this->_qlog_sample_rate, "proxy.config.quic.qlog.sample_rate");
+  REC_EstablishStaticConfigInt32U(this->_qlog_dump_all, "proxy.config.quic.qlog.dump_all");
 
   // Transport Parameters
   REC_EstablishStaticConfigInt32U(this->_no_activity_timeout_in, "proxy.config.quic.no_activity_timeout_in");
@@ -179,6 +187,8 @@ QUICConfigParams::initialize()
   this->_ld_initial_rtt = HRTIME_MSECONDS(timeout);
 
   // Congestion Control
+  REC_EstablishStaticConfigInt32U(this->_cc_algorithm, "proxy.config.quic.congestion_control.algorithm");
+  REC_EstablishStaticConfigInt32U(this->_cc_max_datagram_size, "proxy.config.quic.congestion_control.max_datagram_size");
   REC_EstablishStaticConfigInt32U(this->_cc_initial_window, "proxy.config.quic.congestion_control.initial_window");
   REC_EstablishStaticConfigInt32U(this->_cc_minimum_window, "proxy.config.quic.congestion_control.minimum_window");
   REC_EstablishStaticConfigFloat(this->_cc_loss_reduction_factor, "proxy.config.quic.congestion_control.loss_reduction_factor");
@@ -232,6 +242,18 @@ QUICConfigParams::connection_table_size()
   return _connection_table_size;
 }
 
+uint32_t
+QUICConfigParams::lb_server_id()
+{
+  return _lb_server_id;
+}
+
+uint8_t
+QUICConfigParams::lb_server_id_len()
+{
+  return _lb_server_id_len;
+}
+
 uint32_t
 QUICConfigParams::stateless_retry() const
 {
@@ -418,6 +440,18 @@ QUICConfigParams::ld_initial_rtt() const
   return _ld_initial_rtt;
 }
 
+QUICCongestionControlAlgorithm
+QUICConfigParams::cc_algorithm() const
+{
+  return static_cast<QUICCongestionControlAlgorithm>(_cc_algorithm);
+}
+
+uint32_t
+QUICConfigParams::cc_max_datagram_size() const
+{
+  return _cc_max_datagram_size;
+}
+
 uint32_t
 QUICConfigParams::cc_initial_window() const
 {
@@ -466,6 +500,30 @@ QUICConfigParams::qlog_dir() const
   return this->_qlog_dir;
 }
 
+uint32_t
+QUICConfigParams::qlog_ring_size() const
+{
+  return this->_qlog_ring_size;
+}
+
+uint32_t
+QUICConfigParams::qlog_slow_rtt() const
+{
+  return this->_qlog_slow_rtt;
+}
+
+uint32_t
+QUICConfigParams::qlog_sample_rate() const
+{
+  return this->_qlog_sample_rate;
+}
+
+uint32_t
+QUICConfigParams::qlog_dump_all() const
+{
+  return this->_qlog_dump_all;
+}
+
 //
 // QUICConfig
 //
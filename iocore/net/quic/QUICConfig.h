@@ -28,6 +28,12 @@
 #include "ProxyConfig.h"
 #include "P_SSLCertLookup.h"
 
+enum class QUICCongestionControlAlgorithm : uint8_t {
+  NEW_RENO,
+  CUBIC,
+  BBR,
+};
+
 class QUICConfigParams : public ConfigInfo
 {
 public:
@@ -48,6 +54,10 @@ public:
   const char *client_session_file() const;
   const char *client_keylog_file() const;
   const char *qlog_dir() const;
+  uint32_t qlog_ring_size() const;
+  uint32_t qlog_slow_rtt() const;
+  uint32_t qlog_sample_rate() const;
+  uint32_t qlog_dump_all() const;
 
   shared_SSL_CTX client_ssl_ctx() const;
 
@@ -83,6 +93,7 @@ public:
   ink_hrtime ld_initial_rtt() const;
 
   // Congestion Control
+  QUICCongestionControlAlgorithm cc_algorithm() const;
   uint32_t cc_max_datagram_size() const;
   uint32_t cc_initial_window() const;
   uint32_t cc_minimum_window() const;
@@ -90,10 +101,14 @@ public:
   uint32_t cc_persistent_congestion_threshold() const;
 
   static int connection_table_size();
+  static uint32_t lb_server_id();
+  static uint8_t lb_server_id_len();
   static uint8_t scid_len();
 
 private:
   static int _connection_table_size;
+  static uint32_t _lb_server_id;
+  static uint32_t _lb_server_id_len;
   // TODO: make configurable
   static const uint8_t _scid_len = 18; //< Length of Source Connection ID
 
@@ -109,6 +124,10 @@ private:
   char *_client_session_file     = nullptr;
   char *_client_keylog_file      = nullptr;
   char *_qlog_dir                = nullptr;
+  uint32_t _qlog_ring_size       = 0;
+  uint32_t _qlog_slow_rtt        = 0;
+  uint32_t _qlog_sample_rate     = 0;
+  uint32_t _qlog_dump_all        = 0;
 
   shared_SSL_CTX _client_ssl_ctx = nullptr;
 
@@ -146,6 +165,8 @@ private:
   ink_hrtime _ld_initial_rtt    = HRTIME_MSECONDS(500);
 
   // [draft-11 recovery] 4.7.1.  Constants of interest
+  uint32_t _cc_algorithm                       = 0;
+  uint32_t _cc_max_datagram_size               = 1200;
   uint32_t _cc_initial_window                  = 1200 * 10;
   uint32_t _cc_minimum_window                  = 1200 * 2;
   float _cc_loss_reduction_factor              = 0.5;
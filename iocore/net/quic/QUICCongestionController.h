@@ -25,6 +25,8 @@
 
 #include "QUICFrame.h"
 
+class QUICContext;
+
 class QUICCongestionController
 {
 public:
@@ -35,9 +37,12 @@ public:
     APPLICATION_LIMITED,
   };
 
+  /// Make the controller selected by proxy.config.quic.congestion_control.algorithm.
+  static QUICCongestionController *create(QUICContext &context);
+
   virtual ~QUICCongestionController() {}
   // Appendix B.  Congestion Control Pseudocode
-  virtual void on_packet_sent(size_t bytes_sent)                                                                               = 0;
+  virtual void on_packet_sent(QUICSentPacketInfo &packet)                                                                      = 0;
   virtual void on_packets_acked(const std::vector<QUICSentPacketInfoUPtr> &packets)                                            = 0;
   virtual void process_ecn(const QUICAckFrame &ack, QUICPacketNumberSpace pn_space, ink_hrtime largest_acked_packet_time_sent) = 0;
   virtual void on_packets_lost(const std::map<QUICPacketNumber, QUICSentPacketInfoUPtr> &packets)                              = 0;
@@ -49,6 +54,7 @@ public:
   virtual void reset()                     = 0;
   virtual uint32_t credit() const          = 0;
   virtual uint32_t bytes_in_flight() const = 0;
+  virtual uint64_t pacing_rate() const     = 0; ///< Bytes per second to pace packets at, 0 if they need no pacing
 
   // Debug
   virtual uint32_t congestion_window() const = 0;
@@ -23,27 +23,112 @@
 
 #include "QUICConnectionTable.h"
 
+#include <openssl/rand.h>
+
+#include "I_Net.h"
+
+QUICConnectionTable::QUICConnectionTable(int hash_table_size, uint32_t server_id, uint8_t server_id_len)
+  : _server_id(server_id), _server_id_len(std::min<uint8_t>(server_id_len, sizeof(server_id)))
+{
+  int n_threads = eventProcessor.thread_group[ET_NET]._count;
+  for (int i = 0; i < n_threads; ++i) {
+    this->_threads.push_back(eventProcessor.thread_group[ET_NET]._thread[i]);
+  }
+
+  size_t n_shards = std::max<size_t>(this->_threads.size(), 1);
+  int shard_size  = std::max<int>(hash_table_size / n_shards, 1);
+  for (size_t i = 0; i < n_shards; ++i) {
+    this->_shards.push_back(std::make_unique<Shard>(shard_size));
+  }
+}
+
 QUICConnectionTable::~QUICConnectionTable()
 {
   // TODO: clear all values.
 }
 
+QUICConnectionId
+QUICConnectionTable::issue_connection_id(const EThread *owner) const
+{
+  uint8_t buf[QUICConnectionId::MAX_LENGTH];
+  uint8_t len = QUICConnectionId::SCID_LEN;
+  ink_assert(len >= 1 + this->_server_id_len + 2);
+
+  RAND_bytes(buf, len);
+
+  uint16_t index = NO_OWNER;
+  for (size_t i = 0; i < this->_threads.size(); ++i) {
+    if (this->_threads[i] == owner) {
+      index = i;
+      break;
+    }
+  }
+
+  // Config rotation bits are always 0 and the rest of the first octet is the length of the CID minus one
+  uint8_t *p = buf;
+  *p++       = (len - 1) & 0x1F;
+  for (int i = this->_server_id_len - 1; i >= 0; --i) {
+    *p++ = (this->_server_id >> (i * 8)) & 0xFF;
+  }
+  *p++ = index >> 8;
+  *p++ = index & 0xFF;
+
+  return QUICConnectionId(buf, len);
+}
+
+EThread *
+QUICConnectionTable::owner(QUICConnectionId cid) const
+{
+  uint16_t index = this->_owner_index(cid);
+  return index < this->_threads.size() ? this->_threads[index] : nullptr;
+}
+
+uint16_t
+QUICConnectionTable::_owner_index(QUICConnectionId cid) const
+{
+  const uint8_t *p = cid;
+  if (cid.length() != QUICConnectionId::SCID_LEN || p[0] != ((cid.length() - 1) & 0x1F)) {
+    return NO_OWNER;
+  }
+
+  p += 1;
+  for (int i = this->_server_id_len - 1; i >= 0; --i) {
+    if (*p++ != ((this->_server_id >> (i * 8)) & 0xFF)) {
+      return NO_OWNER;
+    }
+  }
+
+  return (p[0] << 8) | p[1];
+}
+
+QUICConnectionTable::Shard &
+QUICConnectionTable::_shard(QUICConnectionId cid)
+{
+  uint16_t index = this->_owner_index(cid);
+  if (index < this->_shards.size()) {
+    return *this->_shards[index];
+  }
+  return *this->_shards[static_cast<uint64_t>(cid) % this->_shards.size()];
+}
+
 QUICConnection *
 QUICConnectionTable::insert(QUICConnectionId cid, QUICConnection *connection)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
+  Shard &shard      = this->_shard(cid);
+  Ptr<ProxyMutex> m = shard.lock_for_key(cid);
   SCOPED_MUTEX_LOCK(lock, m, this_ethread());
   // To check whether the return value is nullptr by caller in case memory leak.
   // The return value isn't nullptr, the new value will take up the slot and return old value.
-  return _connections.insert_entry(cid, connection);
+  return shard.insert_entry(cid, connection);
 }
 
 void
 QUICConnectionTable::erase(QUICConnectionId cid, QUICConnection *connection)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
+  Shard &shard      = this->_shard(cid);
+  Ptr<ProxyMutex> m = shard.lock_for_key(cid);
   SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  QUICConnection *ret_connection = _connections.remove_entry(cid);
+  QUICConnection *ret_connection = shard.remove_entry(cid);
   if (ret_connection) {
     ink_assert(ret_connection == connection);
   }
@@ -52,15 +137,17 @@ QUICConnectionTable::erase(QUICConnectionId cid, QUICConnection *connection)
 QUICConnection *
 QUICConnectionTable::erase(QUICConnectionId cid)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
+  Shard &shard      = this->_shard(cid);
+  Ptr<ProxyMutex> m = shard.lock_for_key(cid);
   SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  return _connections.remove_entry(cid);
+  return shard.remove_entry(cid);
 }
 
 QUICConnection *
 QUICConnectionTable::lookup(QUICConnectionId cid)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
+  Shard &shard      = this->_shard(cid);
+  Ptr<ProxyMutex> m = shard.lock_for_key(cid);
   SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  return _connections.lookup_entry(cid);
+  return shard.lookup_entry(cid);
 }
@@ -23,15 +23,41 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "QUICTypes.h"
 #include "QUICConnection.h"
 #include "tscore/MT_hashtable.h"
 
+/*
+ * Connection IDs issued by the table follow QUIC-LB plaintext CID format
+ *
+ * +----------------+---------------------+------------------+--------+
+ * | first octet    | server ID           | owner thread     | random |
+ * | (0 | len - 1)  | (server_id_len)     | (2, big-endian)  |        |
+ * +----------------+---------------------+------------------+--------+
+ *
+ * A load balancer can route by the server ID, and the table keeps one shard per ET_NET thread so a packet is looked up only in
+ * the shard of the thread that owns its connection. IDs that were not issued here (e.g. client chosen original DCIDs) are
+ * spread over the shards by hash.
+ */
 class QUICConnectionTable
 {
 public:
-  QUICConnectionTable(int hash_table_size = 65521) : _connections(hash_table_size) {}
+  QUICConnectionTable(int hash_table_size = 65521, uint32_t server_id = 0, uint8_t server_id_len = 0);
   ~QUICConnectionTable();
+
+  /*
+   * Issue a new connection ID for a connection owned by the thread
+   */
+  QUICConnectionId issue_connection_id(const EThread *owner) const;
+
+  /*
+   * Return the thread that owns connections with the CID, or nullptr if the CID wasn't issued by this table
+   */
+  EThread *owner(QUICConnectionId cid) const;
+
   /*
    * Insert an entry
    *
@@ -54,5 +80,16 @@ public:
   QUICConnection *lookup(QUICConnectionId cid);
 
 private:
-  MTHashTable<QUICConnectionId, QUICConnection *> _connections;
+  using Shard = MTHashTable<QUICConnectionId, QUICConnection *>;
+
+  static constexpr uint16_t NO_OWNER = 0xFFFF;
+
+  uint16_t _owner_index(QUICConnectionId cid) const;
+  Shard &_shard(QUICConnectionId cid);
+
+  uint32_t _server_id    = 0;
+  uint8_t _server_id_len = 0;
+  // ET_NET threads, an issued CID carries the index of its owner in here
+  std::vector<EThread *> _threads;
+  std::vector<std::unique_ptr<Shard>> _shards;
 };
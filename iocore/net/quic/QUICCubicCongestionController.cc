@@ -0,0 +1,122 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cmath>
+
+#include "QUICCubicCongestionController.h"
+
+QUICCubicCongestionController::QUICCubicCongestionController(QUICContext &context) : QUICNewRenoCongestionController(context)
+{
+  this->reset();
+}
+
+void
+QUICCubicCongestionController::reset()
+{
+  QUICNewRenoCongestionController::reset();
+
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+  this->_w_max        = 0;
+  this->_w_est        = 0;
+  this->_k            = 0;
+  this->_origin_point = 0;
+  this->_epoch_start  = 0;
+}
+
+uint64_t
+QUICCubicCongestionController::pacing_rate() const
+{
+  // RFC 9002 7.7, pace a little faster than the window so the sender doesn't become app limited
+  ink_hrtime srtt = this->_context.rtt_provider()->smoothed_rtt();
+  if (srtt <= 0) {
+    return 0;
+  }
+  return 1.25 * this->_congestion_window * HRTIME_SECOND / srtt;
+}
+
+void
+QUICCubicCongestionController::_grow_window(const QUICSentPacketInfo &packet)
+{
+  if (this->_congestion_window < this->_ssthresh) {
+    // Slow start is the same as NewReno
+    QUICNewRenoCongestionController::_grow_window(packet);
+    return;
+  }
+
+  this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
+                         QUICCongestionController::State::CONGESTION_AVOIDANCE);
+
+  double mss     = this->_max_datagram_size;
+  double cwnd    = this->_congestion_window;
+  ink_hrtime now = Thread::get_hrtime();
+
+  // RFC 8312 4.1, the cubic function is anchored at the start of the first ack after a congestion event
+  if (this->_epoch_start == 0) {
+    this->_epoch_start = now;
+    if (cwnd < this->_w_max) {
+      this->_k            = std::cbrt((this->_w_max - cwnd) / mss / C);
+      this->_origin_point = this->_w_max;
+    } else {
+      this->_k            = 0;
+      this->_origin_point = cwnd;
+    }
+    this->_w_est = cwnd;
+  }
+
+  // Aim for the window the cubic function has one RTT from now
+  double t      = static_cast<double>(now - this->_epoch_start + this->_context.rtt_provider()->smoothed_rtt()) / HRTIME_SECOND;
+  double target = this->_origin_point + C * std::pow(t - this->_k, 3) * mss;
+  target        = std::min(target, 1.5 * cwnd);
+
+  // RFC 8312 4.2, don't grow slower than Reno would
+  this->_w_est += mss * (3 * (1 - BETA) / (1 + BETA)) * packet.sent_bytes / cwnd;
+  if (this->_w_est > target) {
+    this->_congestion_window = std::max(cwnd, this->_w_est);
+  } else if (target > cwnd) {
+    this->_congestion_window += (target - cwnd) * packet.sent_bytes / cwnd;
+  }
+}
+
+void
+QUICCubicCongestionController::_reduce_window()
+{
+  double cwnd        = this->_congestion_window;
+  this->_epoch_start = 0;
+
+  // RFC 8312 4.6, fast convergence releases bandwidth to new flows sooner
+  if (cwnd < this->_w_max) {
+    this->_w_max = cwnd * (1 + BETA) / 2;
+  } else {
+    this->_w_max = cwnd;
+  }
+
+  this->_congestion_window = std::max(static_cast<uint32_t>(cwnd * BETA), this->_k_minimum_window);
+  this->_ssthresh          = this->_congestion_window;
+}
+
+void
+QUICCubicCongestionController::_collapse_window()
+{
+  QUICNewRenoCongestionController::_collapse_window();
+  this->_epoch_start = 0;
+}
@@ -0,0 +1,59 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "QUICNewRenoCongestionController.h"
+
+/**
+   CUBIC (RFC 8312) on top of the NewReno loss recovery.
+
+   Slow start, recovery periods and persistent congestion are handled as in NewReno. In congestion
+   avoidance the window follows a cubic function of the time since the last congestion event, and
+   a congestion event shrinks it by @c BETA rather than by the configured loss reduction factor.
+   Packets are paced at 1.25 times the window per smoothed RTT.
+ */
+class QUICCubicCongestionController : public QUICNewRenoCongestionController
+{
+public:
+  QUICCubicCongestionController(QUICContext &context);
+
+  void reset() override;
+  uint64_t pacing_rate() const override;
+
+protected:
+  void _grow_window(const QUICSentPacketInfo &packet) override;
+  void _reduce_window() override;
+  void _collapse_window() override;
+
+private:
+  static constexpr double C    = 0.4;
+  static constexpr double BETA = 0.7;
+
+  // Windows are in bytes, K is in seconds
+  double _w_max           = 0;
+  double _w_est           = 0;
+  double _k               = 0;
+  double _origin_point    = 0;
+  ink_hrtime _epoch_start = 0;
+};
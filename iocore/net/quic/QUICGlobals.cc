@@ -92,6 +92,20 @@ QUIC::_register_stats()
   // Transferred packet counts
   RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_sent", RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(QUICStats::total_packets_sent_stat), RecRawStatSyncSum);
+
+  // Congestion control
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.congestion_events", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::congestion_events_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.persistent_congestion_events", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::persistent_congestion_events_stat), RecRawStatSyncSum);
+  // Averages of the values connections had as they sent packets
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.congestion_window", RECD_FLOAT, RECP_NON_PERSISTENT,
+                     static_cast<int>(QUICStats::congestion_window_stat), RecRawStatSyncAvg);
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.pacing_rate", RECD_FLOAT, RECP_NON_PERSISTENT,
+                     static_cast<int>(QUICStats::pacing_rate_stat), RecRawStatSyncAvg);
+  // The qlogs written of the rings of the connections
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.qlog.dumps", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::qlog_dumps_stat), RecRawStatSyncSum);
   // RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_retransmitted", RECD_INT, RECP_PERSISTENT,
   //                              static_cast<int>(quic_total_packets_retransmitted_stat), RecRawStatSyncSum);
   // RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_received", RECD_INT, RECP_PERSISTENT,
@@ -144,13 +144,15 @@ QUICLossDetector::on_packet_sent(QUICSentPacketInfoUPtr packet_info, bool in_fli
   QUICLDVDebug("%s packet sent : %" PRIu64 " bytes: %lu ack_eliciting: %d", QUICDebugNames::pn_space(packet_info->pn_space),
                packet_number, sent_bytes, ack_eliciting);
 
+  // The list owns the packet from here, the controller notes its delivery state on it.
+  QUICSentPacketInfo &sent_packet = *packet_info;
   this->_add_to_sent_packet_list(packet_number, std::move(packet_info));
 
   if (in_flight) {
     if (ack_eliciting) {
       this->_time_of_last_ack_eliciting_packet[static_cast<int>(pn_space)] = now;
     }
-    this->_cc->on_packet_sent(sent_bytes);
+    this->_cc->on_packet_sent(sent_packet);
     this->_set_loss_detection_timer();
   }
 }
@@ -377,9 +379,32 @@ QUICLossDetector::_peer_completed_address_validation() const
   return this->_context.connection_info()->is_address_validation_completed();
 }
 
+void
+QUICLossDetector::begin_batch()
+{
+  SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
+  this->_in_batch = true;
+}
+
+void
+QUICLossDetector::end_batch()
+{
+  SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
+  this->_in_batch = false;
+  if (this->_timer_update_pending) {
+    this->_timer_update_pending = false;
+    this->_set_loss_detection_timer();
+  }
+}
+
 void
 QUICLossDetector::_set_loss_detection_timer()
 {
+  if (this->_in_batch) {
+    this->_timer_update_pending = true;
+    return;
+  }
+
   std::function<void(ink_hrtime)> update_timer = [this](ink_hrtime time) {
     this->_loss_detection_alarm_at = time;
     if (!this->_loss_detection_timer) {
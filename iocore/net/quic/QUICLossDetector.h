@@ -66,9 +66,19 @@ public:
   void update_ack_delay_exponent(uint8_t ack_delay_exponent);
   void reset();
 
+  /*
+   * Defer updates of the loss detection timer until end_batch() is called, so that the timer is re-armed once for a batch of
+   * received or sent packets instead of once for each of them.
+   */
+  void begin_batch();
+  void end_batch();
+
 private:
   Ptr<ProxyMutex> _loss_detection_mutex;
 
+  bool _in_batch             = false;
+  bool _timer_update_pending = false;
+
   uint8_t _ack_delay_exponent = 3;
 
   // Recovery A.2. Constants of Interest
@@ -24,6 +24,7 @@
 #include <tscore/Diags.h>
 #include <QUICCongestionController.h>
 #include <QUICNewRenoCongestionController.h>
+#include "QUICStats.h"
 
 #define QUICCCDebug(fmt, ...)                                                                                               \
   Debug("quic_cc",                                                                                                          \
@@ -49,6 +50,7 @@ QUICNewRenoCongestionController::QUICNewRenoCongestionController(QUICContext &co
   : _cc_mutex(new_ProxyMutex()), _context(context)
 {
   auto &cc_config                          = context.cc_config();
+  this->_max_datagram_size                 = cc_config.max_datagram_size();
   this->_k_initial_window                  = cc_config.initial_window();
   this->_k_minimum_window                  = cc_config.minimum_window();
   this->_k_loss_reduction_factor           = cc_config.loss_reduction_factor();
@@ -58,14 +60,14 @@ QUICNewRenoCongestionController::QUICNewRenoCongestionController(QUICContext &co
 }
 
 void
-QUICNewRenoCongestionController::on_packet_sent(size_t bytes_sent)
+QUICNewRenoCongestionController::on_packet_sent(QUICSentPacketInfo &packet)
 {
   SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
   if (this->_extra_packets_count > 0) {
     --this->_extra_packets_count;
   }
 
-  this->_bytes_in_flight += bytes_sent;
+  this->_bytes_in_flight += packet.sent_bytes;
 }
 
 bool
@@ -118,9 +120,8 @@ QUICNewRenoCongestionController::_congestion_event(ink_hrtime sent_time)
   // start of the previous congestion recovery period.
   if (!this->_in_congestion_recovery(sent_time)) {
     this->_congestion_recovery_start_time = Thread::get_hrtime();
-    this->_congestion_window *= this->_k_loss_reduction_factor;
-    this->_congestion_window = std::max(this->_congestion_window, this->_k_minimum_window);
-    this->_ssthresh          = this->_congestion_window;
+    this->_reduce_window();
+    QUIC_INCREMENT_DYN_STAT(QUICStats::congestion_events_stat);
     this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED, QUICCongestionController::State::RECOVERY);
     this->_context.trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_window, this->_bytes_in_flight,
                            this->_ssthresh);
@@ -129,6 +130,20 @@ QUICNewRenoCongestionController::_congestion_event(ink_hrtime sent_time)
   }
 }
 
+void
+QUICNewRenoCongestionController::_reduce_window()
+{
+  this->_congestion_window *= this->_k_loss_reduction_factor;
+  this->_congestion_window = std::max(this->_congestion_window, this->_k_minimum_window);
+  this->_ssthresh          = this->_congestion_window;
+}
+
+void
+QUICNewRenoCongestionController::_collapse_window()
+{
+  this->_congestion_window = this->_k_minimum_window;
+}
+
 void
 QUICNewRenoCongestionController::process_ecn(const QUICAckFrame &ack_frame, QUICPacketNumberSpace pn_space,
                                              ink_hrtime largest_acked_time_sent)
@@ -172,21 +187,27 @@ QUICNewRenoCongestionController::on_packets_acked(const std::vector<QUICSentPack
       // limited or flow control limited.
       continue;
     }
-    if (this->_congestion_window < this->_ssthresh) {
-      // Slow start.
-      this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED, QUICCongestionController::State::SLOW_START);
-      this->_congestion_window += packet->sent_bytes;
-      QUICCCVDebug("slow start window changed");
-      continue;
-    }
-    // Congestion avoidance.
-    this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
-                           QUICCongestionController::State::CONGESTION_AVOIDANCE);
-    this->_congestion_window += this->_max_datagram_size * static_cast<double>(packet->sent_bytes) / this->_congestion_window;
-    QUICCCVDebug("Congestion avoidance window changed");
+    this->_grow_window(*packet);
   }
 }
 
+void
+QUICNewRenoCongestionController::_grow_window(const QUICSentPacketInfo &packet)
+{
+  if (this->_congestion_window < this->_ssthresh) {
+    // Slow start.
+    this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED, QUICCongestionController::State::SLOW_START);
+    this->_congestion_window += packet.sent_bytes;
+    QUICCCVDebug("slow start window changed");
+    return;
+  }
+  // Congestion avoidance.
+  this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
+                         QUICCongestionController::State::CONGESTION_AVOIDANCE);
+  this->_congestion_window += this->_max_datagram_size * static_cast<double>(packet.sent_bytes) / this->_congestion_window;
+  QUICCCVDebug("Congestion avoidance window changed");
+}
+
 // additional code
 // the original one is:
 //   OnPacketsLost(lost_packets):
@@ -204,7 +225,8 @@ QUICNewRenoCongestionController::on_packets_lost(const std::map<QUICPacketNumber
 
   // Collapse congestion window if persistent congestion
   if (this->_in_persistent_congestion(lost_packets, largest_lost_packet)) {
-    this->_congestion_window = this->_k_minimum_window;
+    this->_collapse_window();
+    QUIC_INCREMENT_DYN_STAT(QUICStats::persistent_congestion_events_stat);
   }
 }
 
@@ -238,6 +260,12 @@ QUICNewRenoCongestionController::credit() const
   }
 }
 
+uint64_t
+QUICNewRenoCongestionController::pacing_rate() const
+{
+  return 0;
+}
+
 uint32_t
 QUICNewRenoCongestionController::bytes_in_flight() const
 {
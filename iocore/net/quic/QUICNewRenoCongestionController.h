@@ -33,13 +33,14 @@ public:
   QUICNewRenoCongestionController(QUICContext &context);
   virtual ~QUICNewRenoCongestionController() {}
 
-  void on_packet_sent(size_t bytes_sent) override;
+  void on_packet_sent(QUICSentPacketInfo &packet) override;
   void on_packets_acked(const std::vector<QUICSentPacketInfoUPtr> &packets) override;
   virtual void on_packets_lost(const std::map<QUICPacketNumber, QUICSentPacketInfoUPtr> &packets) override;
   void on_packet_number_space_discarded(size_t bytes_in_flight) override;
   void process_ecn(const QUICAckFrame &ack, QUICPacketNumberSpace pn_space, ink_hrtime largest_acked_packet_time_sent) override;
   uint32_t credit() const override;
   void reset() override;
+  uint64_t pacing_rate() const override;
 
   // Debug
   uint32_t bytes_in_flight() const override;
@@ -48,7 +49,17 @@ public:
 
   void add_extra_credit() override;
 
-private:
+protected:
+  // Controllers that only change how the window grows and shrinks override these.
+  // They are called with _cc_mutex held.
+
+  /// Grow the window for an acknowledged packet that was sent outside of a recovery period.
+  virtual void _grow_window(const QUICSentPacketInfo &packet);
+  /// Shrink the window at the start of a recovery period.
+  virtual void _reduce_window();
+  /// Shrink the window on persistent congestion.
+  virtual void _collapse_window();
+
   Ptr<ProxyMutex> _cc_mutex;
   uint32_t _extra_packets_count = 0;
   QUICContext &_context;
@@ -608,6 +608,10 @@ QUICShortHeaderPacket::payload_length() const
 Ptr<IOBufferBlock>
 QUICShortHeaderPacket::header_block() const
 {
+  if (this->_header_block) {
+    return this->_header_block;
+  }
+
   Ptr<IOBufferBlock> block;
   size_t written_len = 0;
 
@@ -648,6 +652,8 @@ QUICShortHeaderPacket::header_block() const
 
   block->fill(written_len);
 
+  this->_header_block = block;
+
   return block;
 }
 
@@ -1112,6 +1118,10 @@ QUICInitialPacket::packet_number() const
 Ptr<IOBufferBlock>
 QUICInitialPacket::header_block() const
 {
+  if (this->_header_block) {
+    return this->_header_block;
+  }
+
   Ptr<IOBufferBlock> block;
   size_t written_len = 0;
   size_t n;
@@ -1158,6 +1168,8 @@ QUICInitialPacket::header_block() const
 
   block->fill(written_len);
 
+  this->_header_block = block;
+
   return block;
 }
 
@@ -1170,6 +1182,7 @@ QUICInitialPacket::payload_block() const
 void
 QUICInitialPacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected)
 {
+  size_t prev_length     = this->_payload_length;
   this->_payload_block   = payload;
   this->_payload_length  = 0;
   Ptr<IOBufferBlock> tmp = payload;
@@ -1180,6 +1193,11 @@ QUICInitialPacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected)
   if (unprotected) {
     this->_payload_length += aead_tag_len;
   }
+
+  // The header has the length of the payload
+  if (this->_payload_length != prev_length) {
+    this->_header_block = nullptr;
+  }
 }
 
 //
@@ -1346,6 +1364,10 @@ QUICZeroRttPacket::packet_number() const
 Ptr<IOBufferBlock>
 QUICZeroRttPacket::header_block() const
 {
+  if (this->_header_block) {
+    return this->_header_block;
+  }
+
   Ptr<IOBufferBlock> block;
   size_t written_len = 0;
   size_t n;
@@ -1384,6 +1406,8 @@ QUICZeroRttPacket::header_block() const
 
   block->fill(written_len);
 
+  this->_header_block = block;
+
   return block;
 }
 
@@ -1396,6 +1420,7 @@ QUICZeroRttPacket::payload_block() const
 void
 QUICZeroRttPacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected)
 {
+  size_t prev_length     = this->_payload_length;
   this->_payload_block   = payload;
   this->_payload_length  = 0;
   Ptr<IOBufferBlock> tmp = payload;
@@ -1406,6 +1431,11 @@ QUICZeroRttPacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected)
   if (unprotected) {
     this->_payload_length += aead_tag_len;
   }
+
+  // The header has the length of the payload
+  if (this->_payload_length != prev_length) {
+    this->_header_block = nullptr;
+  }
 }
 
 //
@@ -1526,6 +1556,10 @@ QUICHandshakePacket::packet_number() const
 Ptr<IOBufferBlock>
 QUICHandshakePacket::header_block() const
 {
+  if (this->_header_block) {
+    return this->_header_block;
+  }
+
   Ptr<IOBufferBlock> block;
   size_t written_len = 0;
   size_t n;
@@ -1564,6 +1598,8 @@ QUICHandshakePacket::header_block() const
 
   block->fill(written_len);
 
+  this->_header_block = block;
+
   return block;
 }
 
@@ -1576,6 +1612,7 @@ QUICHandshakePacket::payload_block() const
 void
 QUICHandshakePacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected)
 {
+  size_t prev_length     = this->_payload_length;
   this->_payload_block   = payload;
   this->_payload_length  = 0;
   Ptr<IOBufferBlock> tmp = payload;
@@ -1586,6 +1623,11 @@ QUICHandshakePacket::attach_payload(Ptr<IOBufferBlock> payload, bool unprotected
   if (unprotected) {
     this->_payload_length += aead_tag_len;
   }
+
+  // The header has the length of the payload
+  if (this->_payload_length != prev_length) {
+    this->_header_block = nullptr;
+  }
 }
 
 //
@@ -183,6 +183,8 @@ protected:
 
   Ptr<IOBufferBlock> _payload_block;
   size_t _payload_length = 0;
+  // Built on first use, the header is read for the size, the protection and the copy to the wire
+  mutable Ptr<IOBufferBlock> _header_block;
 
 private:
   QUICVersion _version;
@@ -248,6 +250,8 @@ private:
 
   Ptr<IOBufferBlock> _payload_block;
   size_t _payload_length;
+  // Built on first use, the header is read for the size, the protection and the copy to the wire
+  mutable Ptr<IOBufferBlock> _header_block;
 };
 
 class QUICShortHeaderPacketR : public QUICPacketR
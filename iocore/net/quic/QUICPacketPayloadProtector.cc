@@ -27,6 +27,12 @@
 
 static constexpr char tag[] = "quic_ppp";
 
+QUICPacketPayloadProtector::~QUICPacketPayloadProtector()
+{
+  EVP_CIPHER_CTX_free(this->_encrypt_ctx);
+  EVP_CIPHER_CTX_free(this->_decrypt_ctx);
+}
+
 Ptr<IOBufferBlock>
 QUICPacketPayloadProtector::protect(const Ptr<IOBufferBlock> unprotected_header, const Ptr<IOBufferBlock> unprotected_payload,
                                     uint64_t pkt_num, QUICKeyPhase phase) const
@@ -46,12 +52,11 @@ QUICPacketPayloadProtector::protect(const Ptr<IOBufferBlock> unprotected_header,
 
   const EVP_CIPHER *cipher = this->_pp_key_info.get_cipher(phase);
 
-  protected_payload              = make_ptr<IOBufferBlock>(new_IOBufferBlock());
   size_t unprotected_payload_len = 0;
   for (Ptr<IOBufferBlock> tmp = unprotected_payload; tmp; tmp = tmp->next) {
     unprotected_payload_len += tmp->size();
   }
-  protected_payload->alloc(iobuffer_size_to_index(unprotected_payload_len + tag_len, BUFFER_SIZE_INDEX_32K));
+  protected_payload = this->_protected_payload_block(unprotected_payload_len + tag_len);
 
   size_t written_len = 0;
   if (!this->_protect(reinterpret_cast<uint8_t *>(protected_payload->start()), written_len, protected_payload->write_avail(),
@@ -99,6 +104,50 @@ QUICPacketPayloadProtector::unprotect(const Ptr<IOBufferBlock> unprotected_heade
   return unprotected_payload;
 }
 
+EVP_CIPHER_CTX *
+QUICPacketPayloadProtector::_cipher_ctx(EVP_CIPHER_CTX *&ctx, const EVP_CIPHER *&ctx_cipher, const EVP_CIPHER *cipher,
+                                        int enc) const
+{
+  if (ctx == nullptr && (ctx = EVP_CIPHER_CTX_new()) == nullptr) {
+    return nullptr;
+  }
+  if (ctx_cipher != cipher) {
+    if (!EVP_CipherInit_ex(ctx, cipher, nullptr, nullptr, nullptr, enc)) {
+      ctx_cipher = nullptr;
+      return nullptr;
+    }
+    ctx_cipher = cipher;
+  }
+  return ctx;
+}
+
+/**
+ * Packets of a flight are protected into slices of one block. They are copied to the UDP payload and freed as soon as they
+ * are sent, so by the next flight no slice refers to the block anymore and it's filled again from the start.
+ */
+Ptr<IOBufferBlock>
+QUICPacketPayloadProtector::_protected_payload_block(size_t len) const
+{
+  Ptr<IOBufferBlock> &arena = this->_protected_payload_arena;
+
+  if (arena && arena->data->refcount() == 1) {
+    arena->reset();
+  }
+  if (!arena || static_cast<size_t>(arena->write_avail()) < len) {
+    arena = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+    arena->alloc(BUFFER_SIZE_INDEX_32K);
+  }
+  // Payloads don't get near the size of a block, but don't let one overrun it
+  len = std::min<size_t>(len, arena->write_avail());
+
+  Ptr<IOBufferBlock> block = make_ptr<IOBufferBlock>(arena->clone());
+  block->_start            = block->_end;
+  block->_buf_end          = block->_end + len;
+  arena->fill(len);
+
+  return block;
+}
+
 /**
  * Example iv_len = 12
  *
@@ -139,10 +188,7 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
+  if (!(aead_ctx = this->_cipher_ctx(this->_encrypt_ctx, this->_encrypt_cipher, aead, 1))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
@@ -176,8 +222,6 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
   }
   cipher_len += tag_len;
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   return true;
 }
 
@@ -193,10 +237,7 @@ QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
+  if (!(aead_ctx = this->_cipher_ctx(this->_decrypt_ctx, this->_decrypt_cipher, aead, 0))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
@@ -224,8 +265,6 @@ QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t
 
   int ret = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   if (ret > 0) {
     plain_len += len;
     return true;
@@ -33,6 +33,10 @@ class QUICPacketPayloadProtector
 {
 public:
   QUICPacketPayloadProtector(const QUICPacketProtectionKeyInfo &pp_key_info) : _pp_key_info(pp_key_info) {}
+  ~QUICPacketPayloadProtector();
+
+  QUICPacketPayloadProtector(const QUICPacketPayloadProtector &) = delete;
+  QUICPacketPayloadProtector &operator=(const QUICPacketPayloadProtector &) = delete;
 
   Ptr<IOBufferBlock> protect(const Ptr<IOBufferBlock> protected_payload, const Ptr<IOBufferBlock> unprotected_payload,
                              uint64_t pkt_num, QUICKeyPhase phase) const;
@@ -42,6 +46,19 @@ public:
 private:
   const QUICPacketProtectionKeyInfo &_pp_key_info;
 
+  // Cipher contexts are kept for the life of the connection instead of being made for every packet. The cipher is only set
+  // again when it changes, setting it frees and allocates the cipher state, packets only change the key and the nonce.
+  mutable EVP_CIPHER_CTX *_encrypt_ctx      = nullptr;
+  mutable const EVP_CIPHER *_encrypt_cipher = nullptr;
+  mutable EVP_CIPHER_CTX *_decrypt_ctx      = nullptr;
+  mutable const EVP_CIPHER *_decrypt_cipher = nullptr;
+
+  // Protected payloads are cut from this block, see _protected_payload_block()
+  mutable Ptr<IOBufferBlock> _protected_payload_arena;
+
+  EVP_CIPHER_CTX *_cipher_ctx(EVP_CIPHER_CTX *&ctx, const EVP_CIPHER *&ctx_cipher, const EVP_CIPHER *cipher, int enc) const;
+  Ptr<IOBufferBlock> _protected_payload_block(size_t len) const;
+
   bool _unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *protected_payload,
                   size_t protected_payload_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
                   const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len) const;
@@ -39,10 +39,7 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
+  if (!(aead_ctx = this->_cipher_ctx(this->_encrypt_ctx, this->_encrypt_cipher, aead, 1))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
@@ -76,8 +73,6 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
   }
   cipher_len += tag_len;
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   return true;
 }
 
@@ -93,10 +88,7 @@ QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
+  if (!(aead_ctx = this->_cipher_ctx(this->_decrypt_ctx, this->_decrypt_cipher, aead, 0))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
@@ -124,8 +116,6 @@ QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t
 
   int ret = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   if (ret > 0) {
     plain_len += len;
     return true;
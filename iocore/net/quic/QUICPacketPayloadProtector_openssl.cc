@@ -39,31 +39,23 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  if (!(aead_ctx = this->_cipher_ctx(this->_encrypt_ctx, this->_encrypt_cipher, aead, 1))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_EncryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_EncryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
   cipher_len           = 0;
   Ptr<IOBufferBlock> b = plain;
   while (b) {
-    if (!EVP_EncryptUpdate(aead_ctx, cipher + cipher_len, &len, reinterpret_cast<unsigned char *>(b->buf()), b->size())) {
-      EVP_CIPHER_CTX_free(aead_ctx);
+    if (!EVP_EncryptUpdate(aead_ctx, cipher + cipher_len, &len, reinterpret_cast<unsigned char *>(b->start()), b->size())) {
       return false;
     }
     cipher_len += len;
@@ -71,23 +63,18 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
   }
 
   if (!EVP_EncryptFinal_ex(aead_ctx, cipher + cipher_len, &len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   cipher_len += len;
 
   if (max_cipher_len < cipher_len + tag_len) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_GET_TAG, tag_len, cipher + cipher_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   cipher_len += tag_len;
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   return true;
 }
 
@@ -103,46 +90,34 @@ QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  if (!(aead_ctx = this->_cipher_ctx(this->_decrypt_ctx, this->_decrypt_cipher, aead, 0))) {
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_DecryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_DecryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
   if (cipher_len < tag_len) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   cipher_len -= tag_len;
   if (!EVP_DecryptUpdate(aead_ctx, plain, &len, cipher, cipher_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   plain_len = len;
 
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_TAG, tag_len, const_cast<uint8_t *>(cipher + cipher_len))) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
   int ret = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
 
-  EVP_CIPHER_CTX_free(aead_ctx);
-
   if (ret > 0) {
     plain_len += len;
     return true;
@@ -29,6 +29,11 @@ extern RecRawStatBlock *quic_rsb;
 
 enum class QUICStats {
   total_packets_sent_stat,
+  congestion_events_stat,
+  persistent_congestion_events_stat,
+  congestion_window_stat,
+  pacing_rate_stat,
+  qlog_dumps_stat,
   count,
 };
 
@@ -548,6 +548,7 @@ class QUICCCConfig
 {
 public:
   virtual ~QUICCCConfig() {}
+  virtual uint32_t max_datagram_size() const               = 0;
   virtual uint32_t initial_window() const                  = 0;
   virtual uint32_t minimum_window() const                  = 0;
   virtual float loss_reduction_factor() const              = 0;
@@ -581,6 +582,10 @@ struct QUICSentPacketInfo {
   QUICPacketType type;
   std::vector<FrameInfo> frames;
   QUICPacketNumberSpace pn_space;
+  // Delivery rate sampling state, set by congestion controllers that estimate bandwidth
+  uint64_t delivered         = 0;
+  ink_hrtime delivered_time  = 0;
+  ink_hrtime first_sent_time = 0;
   // End of additional fields
 };
 
@@ -47,7 +47,7 @@ public:
   };
 
   Trace(const std::string &odcid, const std::string &title = "", const std::string &desc = "")
-    : _reference_time(Thread::get_hrtime()), _odcid(odcid)
+    : _reference_time(Thread::get_hrtime()), _odcid(odcid), _title(title), _desc(desc)
   {
   }
 
@@ -80,6 +80,13 @@ public:
     this->_vp = vp;
   }
 
+  // for the traces made after the fact, the relative times of the events are from this one
+  void
+  set_reference_time(ink_hrtime t)
+  {
+    this->_reference_time = t;
+  }
+
   Trace &
   push_event(QLogEventUPtr e)
   {
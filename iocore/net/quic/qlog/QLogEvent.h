@@ -47,6 +47,13 @@ public:
     return this->_time;
   };
 
+  // for the events made of a record after the fact
+  void
+  set_time(ink_hrtime t)
+  {
+    this->_time = t;
+  }
+
 protected:
   ink_hrtime _time = Thread::get_hrtime();
 };
@@ -278,5 +278,76 @@ namespace Frame
     node["raw_frame_type"] = raw_frame_type;
   }
 
+  void
+  TypeOnlyFrame::encode(YAML::Node &node)
+  {
+    switch (_type) {
+    case QUICFrameType::PADDING:
+      node["frame_type"] = "padding";
+      break;
+    case QUICFrameType::PING:
+      node["frame_type"] = "ping";
+      break;
+    case QUICFrameType::ACK:
+    case QUICFrameType::ACK_WITH_ECN:
+      node["frame_type"] = "ack";
+      break;
+    case QUICFrameType::RESET_STREAM:
+      node["frame_type"] = "reset_stream";
+      break;
+    case QUICFrameType::STOP_SENDING:
+      node["frame_type"] = "stop_sending";
+      break;
+    case QUICFrameType::CRYPTO:
+      node["frame_type"] = "crypto";
+      break;
+    case QUICFrameType::NEW_TOKEN:
+      node["frame_type"] = "new_token";
+      break;
+    case QUICFrameType::STREAM:
+      node["frame_type"] = "stream";
+      break;
+    case QUICFrameType::MAX_DATA:
+      node["frame_type"] = "max_data";
+      break;
+    case QUICFrameType::MAX_STREAM_DATA:
+      node["frame_type"] = "max_stream_data";
+      break;
+    case QUICFrameType::MAX_STREAMS:
+      node["frame_type"] = "max_streams";
+      break;
+    case QUICFrameType::DATA_BLOCKED:
+      node["frame_type"] = "data_blocked";
+      break;
+    case QUICFrameType::STREAM_DATA_BLOCKED:
+      node["frame_type"] = "stream_data_blocked";
+      break;
+    case QUICFrameType::STREAMS_BLOCKED:
+      node["frame_type"] = "streams_blocked";
+      break;
+    case QUICFrameType::NEW_CONNECTION_ID:
+      node["frame_type"] = "new_connection_id";
+      break;
+    case QUICFrameType::RETIRE_CONNECTION_ID:
+      node["frame_type"] = "retire_connection_id";
+      break;
+    case QUICFrameType::PATH_CHALLENGE:
+      node["frame_type"] = "path_challenge";
+      break;
+    case QUICFrameType::PATH_RESPONSE:
+      node["frame_type"] = "path_response";
+      break;
+    case QUICFrameType::CONNECTION_CLOSE:
+      node["frame_type"] = "connection_close";
+      break;
+    case QUICFrameType::HANDSHAKE_DONE:
+      node["frame_type"] = "handshake_done";
+      break;
+    default:
+      node["frame_type"] = "unknown";
+      break;
+    }
+  }
+
 } // namespace Frame
 } // namespace QLog
@@ -295,6 +295,12 @@ namespace Frame
     void encode(YAML::Node &) override;
   };
 
+  // The type of a frame only, as a QLog::Ring keeps it
+  struct TypeOnlyFrame : public QLogFrame {
+    TypeOnlyFrame(QUICFrameType type) : QLogFrame(type) {}
+    void encode(YAML::Node &) override;
+  };
+
   struct UnknownFrame : public QLogFrame {
     UnknownFrame(const QUICUnknownFrame &frame) : QLogFrame(frame.type())
     {
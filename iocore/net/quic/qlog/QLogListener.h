@@ -24,6 +24,7 @@
 #pragma once
 
 #include "QLog.h"
+#include "QLogRing.h"
 #include "QLogUtils.h"
 #include "QUICPacket.h"
 #include "QUICContext.h"
@@ -116,4 +117,117 @@ private:
   QUICContext &_context;
 };
 
+/**
+  Records the events of a connection in a @c Ring, and writes them as a qlog only if it closed
+  with an error, its smoothed RTT was over @c proxy.config.quic.qlog.slow_rtt, or
+  @c proxy.config.quic.qlog.dump_all is set. Those of the first two that are written are a sample
+  of @c proxy.config.quic.qlog.sample_rate percent of them.
+*/
+class QLogRingListener : public QUICCallback
+{
+public:
+  QLogRingListener(QUICContext &ctx, std::string odcid, size_t size) : _ring(size), _odcid(odcid), _context(ctx) {}
+
+  void
+  frame_recv_callback(QUICCallbackContext &, const QUICFrame &frame) override
+  {
+    this->_add_frame(this->_recv_frames, frame);
+  }
+
+  void
+  frame_packetize_callback(QUICCallbackContext &, const QUICFrame &frame) override
+  {
+    this->_add_frame(this->_send_frames, frame);
+  }
+
+  void
+  packet_send_callback(QUICCallbackContext &, const QUICPacket &packet) override
+  {
+    this->_push_packet(Ring::EventType::packet_sent, packet, this->_send_frames);
+  }
+
+  void
+  packet_recv_callback(QUICCallbackContext &, const QUICPacket &packet) override
+  {
+    this->_push_packet(Ring::EventType::packet_received, packet, this->_recv_frames);
+  }
+
+  void
+  packet_lost_callback(QUICCallbackContext &, const QUICSentPacketInfo &packet) override
+  {
+    Ring::Record &r = this->_ring.push(Ring::EventType::packet_lost, Thread::get_hrtime());
+    r.packet_type   = static_cast<uint8_t>(packet.type);
+    r.a             = packet.packet_number;
+  }
+
+  void
+  cc_metrics_update_callback(QUICCallbackContext &, uint64_t congestion_window, uint64_t bytes_in_flight, uint64_t sshresh) override
+  {
+    Ring::Record &r = this->_ring.push(Ring::EventType::metrics_updated, Thread::get_hrtime());
+    r.a             = congestion_window;
+    r.b             = std::min<uint64_t>(bytes_in_flight, UINT32_MAX);
+    r.c             = std::min<uint64_t>(sshresh, UINT32_MAX);
+  }
+
+  void
+  congestion_state_updated_callback(QUICCallbackContext &, QUICCongestionController::State state) override
+  {
+    if (state != this->_state) {
+      Ring::Record &r = this->_ring.push(Ring::EventType::congestion_state_updated, Thread::get_hrtime());
+      r.packet_type   = static_cast<uint8_t>(state);
+      this->_state    = state;
+    }
+  }
+
+  void connection_close_callback(QUICCallbackContext &) override;
+
+  void
+  set_vantage_point(const Trace::VantagePoint &vp)
+  {
+    this->_vp = vp;
+  }
+
+  /// Write the records held as a qlog, @a reason being the description of its trace.
+  void dump(const std::string &reason);
+
+private:
+  struct Frames {
+    uint8_t types[Ring::MAX_FRAMES];
+    uint8_t count = 0;
+  };
+
+  void
+  _add_frame(Frames &frames, const QUICFrame &frame)
+  {
+    if (frames.count < Ring::MAX_FRAMES) {
+      frames.types[frames.count++] = static_cast<uint8_t>(frame.type());
+    }
+    if (frame.type() == QUICFrameType::CONNECTION_CLOSE && this->_error_code == 0) {
+      this->_error_code = static_cast<const QUICConnectionCloseFrame &>(frame).error_code();
+    }
+  }
+
+  void
+  _push_packet(Ring::EventType type, const QUICPacket &packet, Frames &frames)
+  {
+    Ring::Record &r = this->_ring.push(type, Thread::get_hrtime());
+    r.packet_type   = static_cast<uint8_t>(packet.type());
+    r.a             = packet.packet_number();
+    r.b             = packet.size();
+    r.c             = packet.payload_length();
+    r.n_frames      = frames.count;
+    memcpy(r.frames, frames.types, frames.count);
+    frames.count = 0;
+  }
+
+  Ring _ring;
+  std::string _odcid;
+  Trace::VantagePoint _vp;
+  QUICCongestionController::State _state = QUICCongestionController::State::SLOW_START;
+  Frames _recv_frames;
+  Frames _send_frames;
+  uint16_t _error_code = 0; ///< Of the first CONNECTION_CLOSE sent or received
+  QUICContext &_context;
+};
+
 } // namespace QLog
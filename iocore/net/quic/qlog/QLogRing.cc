@@ -0,0 +1,121 @@
+/** @file
+ *
+ *  A ring of the qlog events of a connection, in a compact binary form
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "QLogRing.h"
+#include "QLogListener.h"
+#include "QLogUtils.h"
+#include "QUICStats.h"
+
+namespace QLog
+{
+namespace
+{
+  template <typename Event>
+  void
+  add_frames(Event &e, const Ring::Record &r)
+  {
+    for (int i = 0; i < r.n_frames; ++i) {
+      e.append_frames(std::make_unique<Frame::TypeOnlyFrame>(static_cast<QUICFrameType>(r.frames[i])));
+    }
+  }
+
+  QLogEventUPtr
+  make_event(const Ring::Record &r)
+  {
+    const char *packet_type = PacketTypeToName(static_cast<QUICPacketType>(r.packet_type));
+
+    switch (r.type) {
+    case Ring::EventType::packet_sent:
+    case Ring::EventType::packet_received: {
+      PacketHeader ph;
+      ph.packet_number  = std::to_string(r.a);
+      ph.packet_size    = r.b;
+      ph.payload_length = r.c;
+      std::unique_ptr<Transport::PacketEvent> qe;
+      if (r.type == Ring::EventType::packet_sent) {
+        qe = std::make_unique<Transport::PacketSent>(packet_type, ph);
+      } else {
+        qe = std::make_unique<Transport::PacketReceived>(packet_type, ph);
+      }
+      add_frames(*qe, r);
+      return qe;
+    }
+    case Ring::EventType::packet_lost:
+      return std::make_unique<Recovery::PacketLost>(packet_type, r.a);
+    case Ring::EventType::metrics_updated: {
+      auto qe = std::make_unique<Recovery::MetricsUpdated>();
+      qe->set_congestion_window(static_cast<int>(r.a)).set_bytes_in_flight(r.b).set_ssthresh(r.c);
+      return qe;
+    }
+    case Ring::EventType::congestion_state_updated:
+      return std::make_unique<Recovery::CongestionStateUpdated>(
+        CongestionStateConvert(static_cast<QUICCongestionController::State>(r.packet_type)));
+    }
+    return nullptr;
+  }
+} // namespace
+
+void
+Ring::to_trace(Trace &trace) const
+{
+  trace.set_reference_time(this->_start);
+  this->for_each([&trace](const Record &r) {
+    if (auto qe = make_event(r)) {
+      qe->set_time(r.time);
+      trace.push_event(std::move(qe));
+    }
+  });
+}
+
+void
+QLogRingListener::connection_close_callback(QUICCallbackContext &)
+{
+  auto config    = this->_context.config();
+  ink_hrtime rtt = this->_context.rtt_provider()->smoothed_rtt();
+
+  // 0x100 is H3_NO_ERROR, what HTTP/3 closes with when all went well.
+  char reason[64] = "";
+  if (this->_error_code != 0 && this->_error_code != 0x100) {
+    snprintf(reason, sizeof(reason), "closed with error 0x%x", this->_error_code);
+  } else if (config->qlog_slow_rtt() > 0 && rtt >= HRTIME_MSECONDS(config->qlog_slow_rtt())) {
+    snprintf(reason, sizeof(reason), "smoothed rtt of %" PRId64 "ms", ink_hrtime_to_msec(rtt));
+  }
+
+  if (config->qlog_dump_all()) {
+    this->dump(reason[0] ? reason : "dump_all");
+  } else if (reason[0] && this_ethread()->generator.random() % 100 < config->qlog_sample_rate()) {
+    this->dump(reason);
+  }
+}
+
+void
+QLogRingListener::dump(const std::string &reason)
+{
+  QLog log;
+  Trace &trace = log.new_trace(this->_vp, this->_odcid, "", reason);
+  this->_ring.to_trace(trace);
+  log.dump(this->_context.config()->qlog_dir());
+  QUIC_INCREMENT_DYN_STAT(QUICStats::qlog_dumps_stat);
+}
+
+} // namespace QLog
@@ -0,0 +1,108 @@
+/** @file
+ *
+ *  A ring of the qlog events of a connection, in a compact binary form
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "QLog.h"
+
+namespace QLog
+{
+/**
+  The last events of a connection, as fixed size records in a ring that drops the oldest ones.
+  Recording an event copies a few integers in the place of the oldest, nothing is allocated
+  or formatted until the records are made into a @c Trace with @c to_trace.
+*/
+class Ring
+{
+public:
+  enum class EventType : uint8_t {
+    packet_sent,
+    packet_received,
+    packet_lost,
+    metrics_updated,
+    congestion_state_updated,
+  };
+
+  /// The frame types kept with a packet, the first ones in it.
+  static constexpr int MAX_FRAMES = 8;
+
+  struct Record {
+    ink_hrtime time;
+    EventType type;
+    uint8_t packet_type; ///< QUICPacketType, or QUICCongestionController::State
+    uint8_t n_frames;    ///< Of @a frames
+    uint8_t frames[MAX_FRAMES];
+    uint64_t a; ///< Packet number, or congestion window
+    uint32_t b; ///< Packet size, or bytes in flight
+    uint32_t c; ///< Payload length, or slow start threshold
+  };
+
+  explicit Ring(size_t size) : _records(size) {}
+
+  /// The record of an event of @a type at @a time, in place of the oldest one once the ring is full.
+  Record &
+  push(EventType type, ink_hrtime time)
+  {
+    Record &r = this->_records[this->_pushed++ % this->_records.size()];
+    r         = Record{};
+    r.time    = time;
+    r.type    = type;
+    return r;
+  }
+
+  /// The records held, at most the size of the ring.
+  size_t
+  count() const
+  {
+    return std::min<uint64_t>(this->_pushed, this->_records.size());
+  }
+
+  /// The records dropped to make room for newer ones.
+  uint64_t
+  dropped() const
+  {
+    return this->_pushed - this->count();
+  }
+
+  /// Call @a f with each record held, oldest first.
+  template <typename F>
+  void
+  for_each(F const &f) const
+  {
+    for (uint64_t i = this->_pushed - this->count(); i < this->_pushed; ++i) {
+      f(this->_records[i % this->_records.size()]);
+    }
+  }
+
+  /// Add the events of the records held to @a trace, oldest first.
+  void to_trace(Trace &trace) const;
+
+private:
+  std::vector<Record> _records;
+  uint64_t _pushed  = 0;
+  ink_hrtime _start = Thread::get_hrtime(); ///< The reference time of the trace
+};
+
+} // namespace QLog
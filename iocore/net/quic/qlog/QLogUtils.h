@@ -21,8 +21,11 @@
  *  limitations under the License.
  */
 
+#pragma once
+
 #include "QLog.h"
 #include "QUICPacket.h"
+#include "QUICCongestionController.h"
 
 namespace QLog
 {
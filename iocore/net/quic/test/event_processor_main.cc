@@ -33,6 +33,7 @@
 #include "RecordsConfig.h"
 
 #include "QUICConfig.h"
+#include "QUICGlobals.h"
 
 #define TEST_THREADS 1
 
@@ -53,6 +54,7 @@ struct EventProcessorListener : Catch::TestEventListenerBase {
     LibRecordsConfigInit();
 
     QUICConfig::startup();
+    QUIC::init();
 
     ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
     eventProcessor.start(TEST_THREADS);
@@ -0,0 +1,71 @@
+/** @file
+ *
+ *  Tests of QLog::Ring
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "qlog/QLogRing.h"
+
+using QLog::Ring;
+
+static std::vector<uint64_t>
+packet_numbers(const Ring &ring)
+{
+  std::vector<uint64_t> pns;
+  ring.for_each([&pns](const Ring::Record &r) { pns.push_back(r.a); });
+  return pns;
+}
+
+TEST_CASE("QLogRing", "[quic]")
+{
+  SECTION("not full")
+  {
+    Ring ring(4);
+    REQUIRE(ring.count() == 0);
+    ring.push(Ring::EventType::packet_sent, 1).a = 1;
+    ring.push(Ring::EventType::packet_received, 2).a = 2;
+    REQUIRE(ring.count() == 2);
+    REQUIRE(ring.dropped() == 0);
+    REQUIRE(packet_numbers(ring) == std::vector<uint64_t>{1, 2});
+  }
+
+  SECTION("wrap around")
+  {
+    Ring ring(4);
+    for (uint64_t pn = 1; pn <= 10; ++pn) {
+      ring.push(Ring::EventType::packet_sent, pn).a = pn;
+    }
+    REQUIRE(ring.count() == 4);
+    REQUIRE(ring.dropped() == 6);
+    REQUIRE(packet_numbers(ring) == std::vector<uint64_t>{7, 8, 9, 10});
+  }
+
+  SECTION("a pushed record is reset")
+  {
+    Ring ring(1);
+    ring.push(Ring::EventType::packet_sent, 1).n_frames = 3;
+    const Ring::Record &r = ring.push(Ring::EventType::packet_lost, 2);
+    REQUIRE(r.n_frames == 0);
+    REQUIRE(r.type == Ring::EventType::packet_lost);
+    REQUIRE(r.time == 2);
+  }
+}
@@ -320,6 +320,56 @@ TEST_CASE("QUICAckFrameManager_QUICAckFrameCreator", "[quic]")
   CHECK(packet_numbers.largest_ack_received_time() == 0);
 }
 
+TEST_CASE("QUICAckFrameManager_QUICAckFrameCreator ranges", "[quic]")
+{
+  QUICAckFrameManager ack_manager;
+  QUICAckFrameManager::QUICAckFrameCreator packet_numbers(QUICPacketNumberSpace::INITIAL, &ack_manager);
+  uint8_t frame_buf[QUICFrame::MAX_INSTANCE_SIZE];
+
+  // Out of order, duplicated and far apart packets
+  packet_numbers.push_back(1, 1, false);
+  packet_numbers.push_back(3, 1, false);
+  packet_numbers.push_back(1000, 1, false);
+  packet_numbers.push_back(5, 1, false);
+  packet_numbers.push_back(3, 1, false);
+  packet_numbers.push_back(4, 1, false);
+  CHECK(packet_numbers.size() == 5);
+
+  QUICAckFrame *frame = packet_numbers.generate_ack_frame(frame_buf, UINT16_MAX);
+  CHECK(frame != nullptr);
+  CHECK(frame->largest_acknowledged() == 1000);
+  CHECK(frame->ack_block_section()->first_ack_block() == 0);
+  CHECK(frame->ack_block_count() == 2);
+  auto it = frame->ack_block_section()->begin();
+  CHECK(it->gap() == 1000 - 5 - 2);
+  CHECK(it->length() == 2);
+  ++it;
+  CHECK(it->gap() == 0);
+  CHECK(it->length() == 0);
+  frame->~QUICAckFrame();
+
+  // Filling the hole joins the ranges
+  packet_numbers.push_back(2, 1, false);
+  frame = packet_numbers.generate_ack_frame(frame_buf, UINT16_MAX);
+  CHECK(frame != nullptr);
+  CHECK(frame->ack_block_count() == 1);
+  CHECK(frame->ack_block_section()->begin()->length() == 4);
+  frame->~QUICAckFrame();
+
+  // Packets up to the acknowledged one are forgotten
+  packet_numbers.forget(4);
+  CHECK(packet_numbers.size() == 2);
+  frame = packet_numbers.generate_ack_frame(frame_buf, UINT16_MAX);
+  CHECK(frame != nullptr);
+  CHECK(frame->ack_block_count() == 1);
+  CHECK(frame->ack_block_section()->begin()->length() == 0);
+  frame->~QUICAckFrame();
+
+  packet_numbers.forget(1000);
+  CHECK(packet_numbers.size() == 0);
+  CHECK(packet_numbers.available() == false);
+}
+
 TEST_CASE("QUICAckFrameManager lost_frame", "[quic]")
 {
   QUICAckFrameManager ack_manager;
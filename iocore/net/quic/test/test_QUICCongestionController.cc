@@ -0,0 +1,131 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "QUICCubicCongestionController.h"
+#include "QUICBBRCongestionController.h"
+#include "Mock.h"
+#include "tscore/ink_hrtime.h"
+
+static QUICSentPacketInfoUPtr
+make_sent_packet(QUICPacketNumber pn, size_t size, ink_hrtime time_sent)
+{
+  QUICSentPacketInfoUPtr packet = std::make_unique<QUICSentPacketInfo>();
+  packet->packet_number         = pn;
+  packet->time_sent             = time_sent;
+  packet->ack_eliciting         = true;
+  packet->in_flight             = true;
+  packet->sent_bytes            = size;
+  packet->type                  = QUICPacketType::PROTECTED;
+  packet->pn_space              = QUICPacketNumberSpace::APPLICATION_DATA;
+  return packet;
+}
+
+TEST_CASE("QUICCubicCongestionController", "[quic]")
+{
+  MockQUICContext context;
+  QUICCubicCongestionController cc(context);
+  ink_hrtime now = Thread::get_hrtime();
+
+  SECTION("Slow start grows like NewReno")
+  {
+    uint32_t initial_window = cc.congestion_window();
+    std::vector<QUICSentPacketInfoUPtr> acked;
+    acked.push_back(make_sent_packet(1, 1000, now));
+    cc.on_packet_sent(*acked.back());
+    CHECK(cc.bytes_in_flight() == 1000);
+
+    cc.on_packets_acked(acked);
+    CHECK(cc.bytes_in_flight() == 0);
+    CHECK(cc.congestion_window() == initial_window + 1000);
+  }
+
+  SECTION("Loss reduces the window by beta")
+  {
+    std::vector<QUICSentPacketInfoUPtr> acked;
+    acked.push_back(make_sent_packet(1, 1000, now));
+    cc.on_packet_sent(*acked.back());
+    cc.on_packets_acked(acked);
+    uint32_t window = cc.congestion_window();
+
+    // Not contiguous, so this is not persistent congestion
+    std::map<QUICPacketNumber, QUICSentPacketInfoUPtr> lost;
+    lost[2] = make_sent_packet(2, 100, Thread::get_hrtime());
+    lost[4] = make_sent_packet(4, 100, Thread::get_hrtime());
+    cc.on_packet_sent(*lost[2]);
+    cc.on_packet_sent(*lost[4]);
+    cc.on_packets_lost(lost);
+
+    CHECK(cc.bytes_in_flight() == 0);
+    CHECK(cc.congestion_window() == static_cast<uint32_t>(window * 0.7));
+    CHECK(cc.current_ssthresh() == cc.congestion_window());
+  }
+
+  SECTION("Pacing follows the window over the smoothed RTT")
+  {
+    CHECK(cc.pacing_rate() == 0);
+    static_cast<QUICRTTMeasure *>(context.rtt_provider())->update_rtt(HRTIME_MSECONDS(100), 0);
+    CHECK(cc.pacing_rate() == static_cast<uint64_t>(1.25 * cc.congestion_window() * 10));
+  }
+}
+
+TEST_CASE("QUICBBRCongestionController", "[quic]")
+{
+  MockQUICContext context;
+  QUICBBRCongestionController cc(context);
+  ink_hrtime now = Thread::get_hrtime();
+
+  // Ack a round of packets sent 100ms ago
+  std::vector<QUICSentPacketInfoUPtr> acked;
+  for (int i = 0; i < 10; ++i) {
+    acked.push_back(make_sent_packet(i, 1000, now - HRTIME_MSECONDS(100)));
+    cc.on_packet_sent(*acked.back());
+  }
+  CHECK(acked.front()->delivered == 0);
+  cc.on_packets_acked(acked);
+
+  SECTION("Startup paces at the startup gain")
+  {
+    CHECK(cc.bytes_in_flight() == 0);
+    // Never below four packets
+    CHECK(cc.congestion_window() >= 4 * 1200);
+    CHECK(cc.pacing_rate() > 0);
+  }
+
+  SECTION("Loss caps the data in flight")
+  {
+    std::map<QUICPacketNumber, QUICSentPacketInfoUPtr> lost;
+    for (int i = 10; i < 30; i += 2) {
+      lost[i] = make_sent_packet(i, 1000, Thread::get_hrtime());
+      cc.on_packet_sent(*lost[i]);
+    }
+    CHECK(lost[12]->delivered == 10000);
+    uint32_t window = cc.congestion_window();
+    cc.on_packets_lost(lost);
+
+    CHECK(cc.bytes_in_flight() == 0);
+    CHECK(cc.congestion_window() <= window);
+    CHECK(cc.congestion_window() >= 4 * 1200);
+  }
+}
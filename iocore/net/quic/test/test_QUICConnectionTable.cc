@@ -0,0 +1,85 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "quic/QUICConnectionTable.h"
+#include "quic/Mock.h"
+
+TEST_CASE("QUICConnectionTable", "[quic]")
+{
+  EThread *net_thread = eventProcessor.thread_group[ET_NET]._thread[0];
+
+  SECTION("Issued CID carries the server ID and the owner")
+  {
+    QUICConnectionTable table(64, 0x0a0b0c, 3);
+    QUICConnectionId cid = table.issue_connection_id(net_thread);
+    const uint8_t *p     = cid;
+
+    CHECK(cid.length() == QUICConnectionId::SCID_LEN);
+    CHECK(p[0] == QUICConnectionId::SCID_LEN - 1);
+    CHECK(p[1] == 0x0a);
+    CHECK(p[2] == 0x0b);
+    CHECK(p[3] == 0x0c);
+    CHECK(table.owner(cid) == net_thread);
+
+    // Not an ET_NET thread
+    QUICConnectionId cid2 = table.issue_connection_id(nullptr);
+    CHECK(table.owner(cid2) == nullptr);
+    CHECK(cid != cid2);
+  }
+
+  SECTION("CIDs from other servers have no owner")
+  {
+    QUICConnectionTable table_a(64, 1, 1);
+    QUICConnectionTable table_b(64, 2, 1);
+    QUICConnectionId cid = table_a.issue_connection_id(net_thread);
+
+    CHECK(table_a.owner(cid) == net_thread);
+    CHECK(table_b.owner(cid) == nullptr);
+
+    uint8_t raw[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    CHECK(table_a.owner({raw, sizeof(raw)}) == nullptr);
+  }
+
+  SECTION("Insert, lookup and erase")
+  {
+    QUICConnectionTable table(64);
+    MockQUICConnection conn1(NET_VCONNECTION_IN);
+    MockQUICConnection conn2(NET_VCONNECTION_IN);
+
+    QUICConnectionId cid1 = table.issue_connection_id(net_thread);
+    uint8_t raw[]         = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    QUICConnectionId cid2(raw, sizeof(raw));
+
+    CHECK(table.insert(cid1, &conn1) == nullptr);
+    CHECK(table.insert(cid2, &conn2) == nullptr);
+    CHECK(table.lookup(cid1) == &conn1);
+    CHECK(table.lookup(cid2) == &conn2);
+
+    table.erase(cid1, &conn1);
+    CHECK(table.lookup(cid1) == nullptr);
+    CHECK(table.erase(cid2) == &conn2);
+    CHECK(table.lookup(cid2) == nullptr);
+  }
+}
@@ -116,6 +116,51 @@ TEST_CASE("QUICPacketFactory_Create_Handshake", "[quic]")
   CHECK(handshake_packet.version() == 0x11223344);
 }
 
+TEST_CASE("QUICPacketFactory_Create_ShortHeaderPacket", "[quic]")
+{
+  MockQUICPacketProtectionKeyInfo pp_key_info;
+  pp_key_info.set_encryption_key_available(QUICKeyPhase::PHASE_0);
+  QUICPacketFactory factory(pp_key_info);
+  QUICConnectionId dcid(reinterpret_cast<const uint8_t *>("\x01\x02\x03\x04"), 4);
+
+  uint8_t raw[]              = {0xaa, 0xbb, 0xcc, 0xdd};
+  Ptr<IOBufferBlock> payload = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+  payload->alloc(iobuffer_size_to_index(sizeof(raw), BUFFER_SIZE_INDEX_32K));
+  payload->fill(sizeof(raw));
+  memcpy(payload->start(), raw, sizeof(raw));
+
+  uint8_t packet_buf1[QUICPacket::MAX_INSTANCE_SIZE];
+  uint8_t packet_buf2[QUICPacket::MAX_INSTANCE_SIZE];
+
+  SECTION("Header is built once")
+  {
+    QUICPacketUPtr packet = factory.create_short_header_packet(packet_buf1, dcid, 0, payload, sizeof(raw), true, false);
+    REQUIRE(packet != nullptr);
+    CHECK(packet->header_block().get() == packet->header_block().get());
+    CHECK(memcmp(packet->payload_block()->start(), raw, sizeof(raw)) != 0);
+  }
+
+  SECTION("Protected payloads share a block")
+  {
+    QUICPacketUPtr packet1 = factory.create_short_header_packet(packet_buf1, dcid, 0, payload, sizeof(raw), true, false);
+    QUICPacketUPtr packet2 = factory.create_short_header_packet(packet_buf2, dcid, 0, payload, sizeof(raw), true, false);
+    REQUIRE(packet1 != nullptr);
+    REQUIRE(packet2 != nullptr);
+    const char *start1 = packet1->payload_block()->start();
+    const char *start2 = packet2->payload_block()->start();
+    CHECK(packet1->payload_block()->data.get() == packet2->payload_block()->data.get());
+    CHECK(start2 == start1 + packet1->payload_length());
+
+    // Once the packets of a flight are gone the block is filled from the start again
+    packet1 = QUICPacketFactory::create_null_packet();
+    packet2 = QUICPacketFactory::create_null_packet();
+
+    QUICPacketUPtr packet3 = factory.create_short_header_packet(packet_buf1, dcid, 0, payload, sizeof(raw), true, false);
+    REQUIRE(packet3 != nullptr);
+    CHECK(packet3->payload_block()->start() == start1);
+  }
+}
+
 TEST_CASE("QUICPacketFactory_Create_StatelessResetPacket", "[quic]")
 {
   MockQUICPacketProtectionKeyInfo pp_key_info;
@@ -0,0 +1,99 @@
+/** @file
+
+  Catch based unit tests for AcceptRateLimiter
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "AcceptRateLimiter.h"
+
+namespace
+{
+IpEndpoint
+addr(const char *text)
+{
+  IpEndpoint ep;
+  REQUIRE(ats_ip_pton(text, &ep) == 0);
+  return ep;
+}
+
+int
+admit_n(AcceptRateLimiter &limiter, IpEndpoint const &ep, ink_hrtime now, int n)
+{
+  int admitted = 0;
+  for (int i = 0; i < n; ++i) {
+    admitted += limiter.admit(&ep.sa, now);
+  }
+  return admitted;
+}
+} // namespace
+
+TEST_CASE("AcceptRateLimiter", "[AcceptRateLimiter]")
+{
+  AcceptRateLimiter limiter;
+  ink_hrtime now = HRTIME_SECONDS(1000);
+
+  SECTION("Disabled")
+  {
+    limiter.configure(0, 5, 32, 64, 1024);
+    REQUIRE(admit_n(limiter, addr("192.0.2.1"), now, 100) == 100);
+  }
+
+  SECTION("Burst and rate")
+  {
+    limiter.configure(10, 5, 32, 64, 1024);
+    IpEndpoint client = addr("192.0.2.1");
+    REQUIRE(admit_n(limiter, client, now, 10) == 5);
+    // 10 per second is one per 100ms.
+    REQUIRE(admit_n(limiter, client, now + HRTIME_MSECONDS(100), 10) == 1);
+    // Never more than the burst.
+    REQUIRE(admit_n(limiter, client, now + HRTIME_SECONDS(60), 10) == 5);
+    // Other clients are not affected.
+    REQUIRE(admit_n(limiter, addr("192.0.2.2"), now, 10) == 5);
+  }
+
+  SECTION("Prefixes")
+  {
+    limiter.configure(10, 5, 24, 64, 1024);
+    REQUIRE(admit_n(limiter, addr("192.0.2.1"), now, 3) == 3);
+    REQUIRE(admit_n(limiter, addr("192.0.2.200"), now, 10) == 2);
+    REQUIRE(admit_n(limiter, addr("192.0.3.1"), now, 10) == 5);
+
+    REQUIRE(admit_n(limiter, addr("2001:db8::1"), now, 3) == 3);
+    REQUIRE(admit_n(limiter, addr("2001:db8::ffff:1"), now, 10) == 2);
+    REQUIRE(admit_n(limiter, addr("2001:db8:0:1::1"), now, 10) == 5);
+  }
+
+  SECTION("More clients than tracked")
+  {
+    limiter.configure(10, 5, 32, 64, 1024);
+    IpEndpoint client = addr("192.0.2.1");
+    REQUIRE(admit_n(limiter, client, now, 10) == 5);
+    // Every new client is admitted even when the table overflows.
+    IpEndpoint other = addr("10.0.0.0");
+    int admitted     = 0;
+    for (uint32_t i = 0; i < 100000; ++i) {
+      other.sin.sin_addr.s_addr = htonl(0x0a000000 + i);
+      admitted += limiter.admit(&other.sa, now);
+    }
+    REQUIRE(admitted == 100000);
+  }
+}
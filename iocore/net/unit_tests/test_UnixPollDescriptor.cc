@@ -0,0 +1,136 @@
+/** @file
+
+  Catch based unit tests for the io_uring backend of PollDescriptor
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "P_Net.h"
+
+#if TS_USE_LINUX_IO_URING
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace
+{
+struct Pipe {
+  int fds[2] = {-1, -1};
+
+  Pipe() { REQUIRE(pipe(fds) == 0); }
+  ~Pipe()
+  {
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  void
+  poke()
+  {
+    char c = 'x';
+    REQUIRE(write(fds[1], &c, 1) == 1);
+  }
+
+  void
+  drain()
+  {
+    char buf[64];
+    ATS_UNUSED_RETURN(read(fds[0], buf, sizeof(buf)));
+  }
+};
+
+std::unique_ptr<PollDescriptor>
+make_uring_pd()
+{
+  int backend             = net_config_poll_backend;
+  net_config_poll_backend = POLL_BACKEND_IO_URING;
+  auto pd                 = std::make_unique<PollDescriptor>();
+  net_config_poll_backend = backend;
+  return pd;
+}
+} // namespace
+
+TEST_CASE("PollDescriptor io_uring", "[net][io_uring]")
+{
+  auto pd = make_uring_pd();
+  if (!pd->uring_enabled) {
+    WARN("io_uring is not available, skipping");
+    return;
+  }
+
+  Pipe p;
+  int tag = 0;
+
+  SECTION("readiness is reported with the data of the slot")
+  {
+    REQUIRE(pd->uring_arm(p.fds[0], EPOLLIN, &tag) >= 0);
+    REQUIRE(pd->uring_wait(0) == 0);
+    p.poke();
+    REQUIRE(pd->uring_wait(1000) == 1);
+    REQUIRE(get_ev_data(pd.get(), 0) == &tag);
+    REQUIRE((get_ev_events(pd.get(), 0) & EPOLLIN) != 0);
+  }
+
+  SECTION("a negative timeout blocks until a completion")
+  {
+    REQUIRE(pd->uring_arm(p.fds[0], EPOLLIN, &tag) >= 0);
+    auto start = std::chrono::steady_clock::now();
+    std::thread poker([&p]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      p.poke();
+    });
+    int n = pd->uring_wait(-1);
+    poker.join();
+    REQUIRE(n == 1);
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40));
+  }
+
+  SECTION("a disarmed descriptor reports nothing and its slot is reused")
+  {
+    int slot = pd->uring_arm(p.fds[0], EPOLLIN, &tag);
+    REQUIRE(slot >= 0);
+    REQUIRE(pd->uring_disarm(slot) == 0);
+    p.poke();
+    REQUIRE(pd->uring_wait(50) == 0);
+    REQUIRE(pd->uring_wait(10) == 0);
+    p.drain();
+
+    // The final completion of the removed poll gave the slot back.
+    int other = 0;
+    REQUIRE(pd->uring_arm(p.fds[0], EPOLLIN, &other) == slot);
+    p.poke();
+    REQUIRE(pd->uring_wait(1000) == 1);
+    REQUIRE(get_ev_data(pd.get(), 0) == &other);
+  }
+
+  SECTION("the multishot poll reports each wake up")
+  {
+    REQUIRE(pd->uring_arm(p.fds[0], EPOLLIN, &tag) >= 0);
+    for (int i = 0; i < 3; ++i) {
+      p.poke();
+      REQUIRE(pd->uring_wait(1000) == 1);
+      p.drain();
+    }
+  }
+}
+
+#endif
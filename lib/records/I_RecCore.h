@@ -155,6 +155,26 @@ RecErrT RecGetRecordByte(const char *name, RecByte *rec_byte, bool lock = true);
 // Convenience to allow us to treat the RecInt as a bool internally
 RecErrT RecGetRecordBool(const char *name, RecBool *rec_byte, bool lock = true);
 
+//------------------------------------------------------------------------
+// Record Handles
+//------------------------------------------------------------------------
+
+// A handle is the index of a record in the record array, which records
+// are neither moved in nor removed from. Resolve it once, at plugin init
+// or config load, then read the record by it on hot paths without
+// hashing the name or taking the hash-table rwlock. The numeric reads do
+// not lock at all. The generation of a record changes whenever its
+// value does, e.g. on a config reload, so that a caller can tell whether
+// what it derived from the value is stale.
+typedef int RecHandle;
+
+RecErrT RecGetRecordHandle(const char *name, RecHandle *handle, bool lock = true);
+RecErrT RecGetRecordIntByHandle(RecHandle handle, RecInt *rec_int);
+RecErrT RecGetRecordFloatByHandle(RecHandle handle, RecFloat *rec_float);
+RecErrT RecGetRecordCounterByHandle(RecHandle handle, RecCounter *rec_counter);
+RecErrT RecGetRecordStringByHandle_Xmalloc(RecHandle handle, RecString *rec_string);
+uint32_t RecGetRecordGeneration(RecHandle handle);
+
 //------------------------------------------------------------------------
 // Record Attributes Reading
 //------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 
 #include "tscore/ink_mutex.h"
 #include "tscore/ink_rwlock.h"
+#include "tscore/Histogram.h"
 #include "I_RecMutex.h"
 
 //-------------------------------------------------------------------------
@@ -158,13 +159,61 @@ struct RecRawStat {
   uint32_t version;
 };
 
+// The thread local part of a raw stat. The stats of a block are contiguous
+// in each thread, so that they are summed at once as an array of int64_t.
+struct RecRawStatLocal {
+  int64_t sum;
+  int64_t count;
+};
+
 // WARNING!  It's advised that developers do not modify the contents of
 // the RecRawStatBlock.  ^_^
 struct RecRawStatBlock {
-  off_t ethr_stat_offset; // thread local raw-stat storage
-  RecRawStat **global;    // global raw-stat storage (ptr to RecRecord)
-  int num_stats;          // number of stats in this block
-  int max_stats;          // maximum number of stats for this block
+  off_t ethr_stat_offset;  // thread local raw-stat storage, of RecRawStatLocal
+  RecRawStat **global;     // global raw-stat storage (ptr to RecRecord)
+  int num_stats;           // number of stats in this block, up to the highest id registered
+  int max_stats;           // maximum number of stats for this block
+  RecRawStatLocal *totals; // of all threads, summed at once at the start of each sync
+  int64_t clears;          // of the stats of this block; the totals are stale once it changes
+  int64_t totals_clears;   // clears, when the totals were summed
+  ink_mutex mutex;
+};
+
+//-------------------------------------------------------------------------
+// RawHistogram Structures
+//-------------------------------------------------------------------------
+// A raw histogram counts values in the log-linear buckets of a ts::Histogram.
+// Each value below 2^REC_HISTOGRAM_SUB_BITS has a bucket of its own, and each
+// power of 2 above is split in 2^REC_HISTOGRAM_SUB_BITS buckets. The last
+// bucket also counts the values of 2^REC_HISTOGRAM_MAX_BITS and above, and the
+// first the negative values.
+#define REC_HISTOGRAM_SUB_BITS 3
+#define REC_HISTOGRAM_MAX_BITS 48
+
+using RecHistogram = ts::Histogram<REC_HISTOGRAM_MAX_BITS, REC_HISTOGRAM_SUB_BITS>;
+
+#define REC_HISTOGRAM_BUCKETS RecHistogram::N_BUCKETS
+
+struct RecRawHistogramData {
+  int64_t count;
+  int64_t sum;
+  RecHistogram buckets;
+};
+
+// The records of a raw histogram, "<name>.count", "<name>.sum" and "<name>.p50" and so on.
+#define REC_HISTOGRAM_RECORDS 6
+
+struct RecRecord;
+
+// WARNING!  As with the RecRawStatBlock, do not modify the contents.
+struct RecRawHistogram {
+  off_t ethr_stat_offset;                    // thread local RecRawHistogramData
+  int id;                                    // index of the histogram, for RecGetRawHistogram()
+  char *name;                                // the records are named after it
+  RecRecord *records[REC_HISTOGRAM_RECORDS]; // set at each sync
+  uint32_t versions[REC_HISTOGRAM_RECORDS];  // of the records, changed when one is reset
+  RecRawHistogramData total;                 // of all threads, since the last reset, as of the last sync
+  RecRawHistogramData baseline;              // of all threads, at the last reset
   ink_mutex mutex;
 };
 
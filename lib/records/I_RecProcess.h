@@ -106,25 +106,46 @@ RecRawStat *RecGetGlobalRawStatPtr(RecRawStatBlock *rsb, int id);
 int64_t *RecGetGlobalRawStatSumPtr(RecRawStatBlock *rsb, int id);
 int64_t *RecGetGlobalRawStatCountPtr(RecRawStatBlock *rsb, int id);
 
+//-------------------------------------------------------------------------
+// RawHistogram Registration/Getting
+//-------------------------------------------------------------------------
+#define REC_MAX_RAW_HISTOGRAMS 256
+
+// Register the records of a histogram, named after @a name, which are set from it at each sync:
+// <name>.count, <name>.sum, <name>.p50, <name>.p90, <name>.p99 and <name>.p999. Resetting any of them
+// resets the histogram. Returns nullptr if a record cannot be registered or the histograms are exhausted.
+RecRawHistogram *RecRegisterRawHistogram(RecT rec_type, const char *name);
+RecRawHistogram *RecGetRawHistogram(int id);
+RecRawHistogram *RecFindRawHistogram(const char *name);
+
+// Copy what the histogram counted since its last reset, as of the last sync.
+int RecGetRawHistogramData(RecRawHistogram *rh, RecRawHistogramData *data);
+// The value at @a percentile, 0 to 100, as the upper bound of its bucket. 0 if nothing was counted.
+int64_t RecRawHistogramPercentile(const RecRawHistogramData *data, double percentile);
+
+inline int RecRawHistogramBucket(int64_t value);
+inline int64_t RecRawHistogramBucketLowerBound(int bucket);
+inline int RecRawHistogramRecord(RecRawHistogram *rh, EThread *ethread, int64_t value);
+
 //-------------------------------------------------------------------------
 // RecIncrRawStatXXX
 //-------------------------------------------------------------------------
 // inlined functions that are used very frequently.
 // FIXME: move it to Inline.cc
-inline RecRawStat *
+inline RecRawStatLocal *
 raw_stat_get_tlp(RecRawStatBlock *rsb, int id, EThread *ethread)
 {
   ink_assert((id >= 0) && (id < rsb->max_stats));
   if (ethread == nullptr) {
     ethread = this_ethread();
   }
-  return (((RecRawStat *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
+  return (((RecRawStatLocal *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
 }
 
 inline int
 RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -133,7 +154,7 @@ RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum -= decr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -142,7 +163,7 @@ RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 inline int
 RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   return REC_ERR_OKAY;
 }
@@ -150,7 +171,36 @@ RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecIncrRawStatCount(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->count += incr;
   return REC_ERR_OKAY;
 }
+
+//-------------------------------------------------------------------------
+// RecRawHistogramXXX
+//-------------------------------------------------------------------------
+inline int
+RecRawHistogramBucket(int64_t value)
+{
+  return RecHistogram::index(value < 0 ? 0 : value);
+}
+
+inline int64_t
+RecRawHistogramBucketLowerBound(int bucket)
+{
+  return RecHistogram::lower_bound(bucket);
+}
+
+inline int
+RecRawHistogramRecord(RecRawHistogram *rh, EThread *ethread, int64_t value)
+{
+  if (ethread == nullptr) {
+    ethread = this_ethread();
+  }
+
+  RecRawHistogramData *tlp = reinterpret_cast<RecRawHistogramData *>(reinterpret_cast<char *>(ethread) + rh->ethr_stat_offset);
+  tlp->buckets.record(value < 0 ? 0 : value);
+  tlp->sum += value;
+  tlp->count += 1;
+  return REC_ERR_OKAY;
+}
@@ -0,0 +1,192 @@
+/** @file
+
+  A read-only shared memory segment of the stats of traffic_server.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*-------------------------------------------------------------------------
+  The stats segment
+
+  traffic_server writes a snapshot of its int, counter and float stats to a
+  file it maps, at every raw stat sync, for other processes to map and read
+  without asking traffic_manager. The file is a header followed by fixed size
+  records, in the order the stats were registered in; a record, once there,
+  stays at its index. All the integers are in the byte order of the host.
+
+  A snapshot is guarded by the sequence of the header: it is odd while the
+  snapshot is being written, the snapshot read is consistent if the sequence
+  was the same even number before and after reading it. A new traffic_server
+  replaces the file rather than writing to it, so that a reader sees a new pid
+  and reopens it.
+  -------------------------------------------------------------------------*/
+
+#define REC_STATS_SEGMENT_MAGIC "TSSTATS"
+#define REC_STATS_SEGMENT_VERSION 1
+#define REC_STATS_SEGMENT_NAME_LEN 112
+
+struct RecStatsSegmentHeader {
+  char magic[8];            ///< REC_STATS_SEGMENT_MAGIC
+  uint32_t version;         ///< REC_STATS_SEGMENT_VERSION
+  uint32_t header_size;     ///< the offset of the first record
+  uint32_t record_size;     ///< sizeof(RecStatsSegmentRecord)
+  uint32_t capacity;        ///< the number of records there is room for
+  uint32_t num_records;     ///< in the snapshot
+  uint32_t pid;             ///< of the traffic_server writing the segment
+  uint64_t sequence;        ///< odd while the snapshot is being written
+  int64_t updated_at;       ///< when the snapshot was written, in milliseconds since the epoch
+  uint8_t reserved[16];     ///< zeros, to 64 bytes
+};
+
+struct RecStatsSegmentRecord {
+  char name[REC_STATS_SEGMENT_NAME_LEN]; ///< nul terminated
+  int32_t data_type;                     ///< the RecDataT, RECD_INT, RECD_FLOAT or RECD_COUNTER
+  int32_t reserved;
+  union {
+    int64_t rec_int;     ///< RECD_INT and RECD_COUNTER
+    double rec_float;    ///< RECD_FLOAT
+    int64_t rec_bits;    ///< the value, as it is written and read
+  };
+};
+
+static_assert(sizeof(RecStatsSegmentHeader) == 64, "the layout of the stats segment header is fixed");
+static_assert(sizeof(RecStatsSegmentRecord) == 128, "the layout of the stats segment records is fixed");
+
+/// Maps the stats segment of traffic_server to read snapshots of it.
+class RecStatsSegmentReader
+{
+public:
+  ~RecStatsSegmentReader() { close(); }
+
+  /// Map the segment at @a path. False if it is not there or not a segment of this version.
+  bool
+  open(const char *path)
+  {
+    struct stat st;
+    int fd = ::open(path, O_RDONLY);
+
+    close();
+    if (fd < 0) {
+      return false;
+    }
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(RecStatsSegmentHeader)) {
+      void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (addr != MAP_FAILED) {
+        m_header = static_cast<const RecStatsSegmentHeader *>(addr);
+        m_size   = st.st_size;
+      }
+    }
+    ::close(fd);
+
+    if (m_header && (memcmp(m_header->magic, REC_STATS_SEGMENT_MAGIC, sizeof(m_header->magic)) != 0 ||
+                     m_header->version != REC_STATS_SEGMENT_VERSION || m_header->record_size != sizeof(RecStatsSegmentRecord) ||
+                     m_header->header_size + static_cast<size_t>(m_header->capacity) * m_header->record_size > m_size)) {
+      close();
+    }
+    return m_header != nullptr;
+  }
+
+  void
+  close()
+  {
+    if (m_header) {
+      munmap(const_cast<RecStatsSegmentHeader *>(m_header), m_size);
+      m_header = nullptr;
+      m_size   = 0;
+    }
+  }
+
+  /// The pid of the traffic_server the segment is of, 0 if none is mapped.
+  uint32_t
+  pid() const
+  {
+    return m_header ? m_header->pid : 0;
+  }
+
+  /// Copy a consistent snapshot to @a records, and when it was written to @a updated_at. False if no
+  /// consistent snapshot could be read in @a attempts, with the segment being written all along.
+  bool
+  read(std::vector<RecStatsSegmentRecord> &records, int64_t *updated_at = nullptr, int attempts = 100) const
+  {
+    if (!m_header) {
+      return false;
+    }
+
+    const RecStatsSegmentRecord *segment_records = reinterpret_cast<const RecStatsSegmentRecord *>(
+      reinterpret_cast<const char *>(m_header) + m_header->header_size);
+
+    for (int i = 0; i < attempts; ++i) {
+      uint64_t sequence = __atomic_load_n(&m_header->sequence, __ATOMIC_ACQUIRE);
+      if (sequence & 1) {
+        sched_yield();
+        continue;
+      }
+
+      uint32_t num_records = __atomic_load_n(&m_header->num_records, __ATOMIC_RELAXED);
+      if (num_records > m_header->capacity) {
+        continue;
+      }
+      records.resize(num_records);
+      for (uint32_t n = 0; n < num_records; ++n) {
+        const RecStatsSegmentRecord &r = segment_records[n];
+        memcpy(records[n].name, r.name, sizeof(r.name));
+        records[n].name[sizeof(r.name) - 1] = '\0';
+        records[n].data_type                = __atomic_load_n(&r.data_type, __ATOMIC_RELAXED);
+        records[n].reserved                 = 0;
+        records[n].rec_bits                 = __atomic_load_n(&r.rec_bits, __ATOMIC_RELAXED);
+      }
+      int64_t at = m_header->updated_at;
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&m_header->sequence, __ATOMIC_RELAXED) == sequence) {
+        if (updated_at) {
+          *updated_at = at;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // noncopyable
+  RecStatsSegmentReader()                              = default;
+  RecStatsSegmentReader(const RecStatsSegmentReader &) = delete;
+  RecStatsSegmentReader &operator=(const RecStatsSegmentReader &) = delete;
+
+private:
+  const RecStatsSegmentHeader *m_header = nullptr;
+  size_t m_size                         = 0;
+};
+
+/// Create the segment at @a path, replacing what is there, for RecStatsSegmentUpdate() to write to.
+bool RecStatsSegmentOpen(const char *path);
+
+/// Write a snapshot of the stats to the segment, if it is open.
+void RecStatsSegmentUpdate();
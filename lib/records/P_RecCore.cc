@@ -387,6 +387,7 @@ RecSetRecord(RecT rec_type, const char *name, RecDataT data_type, RecData *data,
         }
 
         if (rec_updated_p) {
+          ink_atomic_increment(&(r1->generation), 1);
           r1->sync_required = REC_SYNC_REQUIRED;
           if (REC_TYPE_IS_CONFIG(r1->rec_type)) {
             r1->config_meta.update_required = REC_UPDATE_REQUIRED;
@@ -699,6 +700,7 @@ reset_stat_record(RecRecord *rec)
     rec_mutex_acquire(&(rec->lock));
     ++(rec->version);
     err = RecDataSet(rec->data_type, &(rec->data), &(rec->data_default)) ? REC_ERR_OKAY : REC_ERR_FAIL;
+    ink_atomic_increment(&(rec->generation), 1);
     rec_mutex_release(&(rec->lock));
   } else {
     RecRecord r2;
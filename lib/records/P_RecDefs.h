@@ -105,6 +105,7 @@ struct RecRecord {
   RecMutex lock;
   unsigned char sync_required;
   uint32_t version;
+  uint32_t generation; // bumped each time the value is changed, for those reading it by handle
   bool registered;
   union {
     RecStatMeta stat_meta;
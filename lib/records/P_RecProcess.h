@@ -37,3 +37,4 @@
 //-------------------------------------------------------------------------
 
 int RecExecRawStatSyncCbs();
+int RecExecRawHistogramSyncs();
@@ -464,6 +464,98 @@ RecGetRecordBool(const char *name, RecBool *rec_bool, bool lock)
   return err;
 }
 
+//-------------------------------------------------------------------------
+// RecGetRecordHandle / RecGetRecordXXXByHandle
+//-------------------------------------------------------------------------
+RecErrT
+RecGetRecordHandle(const char *name, RecHandle *handle, bool lock)
+{
+  RecErrT err = REC_ERR_FAIL;
+
+  if (lock) {
+    ink_rwlock_rdlock(&g_records_rwlock);
+  }
+
+  if (auto it = g_records_ht.find(name); it != g_records_ht.end() && it->second->registered) {
+    *handle = it->second->order;
+    err     = REC_ERR_OKAY;
+  }
+
+  if (lock) {
+    ink_rwlock_unlock(&g_records_rwlock);
+  }
+
+  return err;
+}
+
+// The record of a handle, if it is one of the given type. A record is in the array before its handle is handed out, and
+// stays at its index, so this needs no lock.
+static RecRecord *
+handle_record(RecHandle handle, RecDataT data_type)
+{
+  if (handle < 0 || handle >= g_num_records) {
+    return nullptr;
+  }
+
+  RecRecord *r = &(g_records[handle]);
+  return r->data_type == data_type ? r : nullptr;
+}
+
+RecErrT
+RecGetRecordIntByHandle(RecHandle handle, RecInt *rec_int)
+{
+  if (RecRecord *r = handle_record(handle, RECD_INT); r) {
+    *rec_int = __atomic_load_n(&(r->data.rec_int), __ATOMIC_RELAXED);
+    return REC_ERR_OKAY;
+  }
+  return REC_ERR_FAIL;
+}
+
+RecErrT
+RecGetRecordFloatByHandle(RecHandle handle, RecFloat *rec_float)
+{
+  if (RecRecord *r = handle_record(handle, RECD_FLOAT); r) {
+    __atomic_load(&(r->data.rec_float), rec_float, __ATOMIC_RELAXED);
+    return REC_ERR_OKAY;
+  }
+  return REC_ERR_FAIL;
+}
+
+RecErrT
+RecGetRecordCounterByHandle(RecHandle handle, RecCounter *rec_counter)
+{
+  if (RecRecord *r = handle_record(handle, RECD_COUNTER); r) {
+    *rec_counter = __atomic_load_n(&(r->data.rec_counter), __ATOMIC_RELAXED);
+    return REC_ERR_OKAY;
+  }
+  return REC_ERR_FAIL;
+}
+
+RecErrT
+RecGetRecordStringByHandle_Xmalloc(RecHandle handle, RecString *rec_string)
+{
+  RecRecord *r = handle_record(handle, RECD_STRING);
+
+  if (r == nullptr) {
+    return REC_ERR_FAIL;
+  }
+
+  // the string may be freed by a concurrent set, which holds the lock of the record
+  rec_mutex_acquire(&(r->lock));
+  *rec_string = ats_strdup(r->data.rec_string);
+  rec_mutex_release(&(r->lock));
+  return REC_ERR_OKAY;
+}
+
+uint32_t
+RecGetRecordGeneration(RecHandle handle)
+{
+  if (handle < 0 || handle >= g_num_records) {
+    return 0;
+  }
+  return __atomic_load_n(&(g_records[handle].generation), __ATOMIC_ACQUIRE);
+}
+
 //-------------------------------------------------------------------------
 // RecGetRec Attributes
 //-------------------------------------------------------------------------
@@ -975,7 +1067,9 @@ RecForceInsert(RecRecord *record)
   }
 
   // set the record value
-  RecDataSet(r->data_type, &(r->data), &(record->data));
+  if (RecDataSet(r->data_type, &(r->data), &(record->data))) {
+    ink_atomic_increment(&(r->generation), 1);
+  }
   RecDataSet(r->data_type, &(r->data_default), &(record->data_default));
 
   r->registered = record->registered;
@@ -23,6 +23,8 @@
 
 #include "tscore/ink_platform.h"
 #include "tscore/EventNotify.h"
+#include "tscore/Filenames.h"
+#include "tscore/I_Layout.h"
 
 #include "I_Tasks.h"
 
@@ -32,6 +34,7 @@
 #include "P_RecMessage.h"
 #include "P_RecUtils.h"
 #include "P_RecFile.h"
+#include "I_RecStatsSegment.h"
 
 #include "mgmtapi.h"
 #include "ProcessManager.h"
@@ -139,11 +142,17 @@ recv_message_cb__process(RecMessage *msg, RecMessageT msg_type, void *cookie)
 // raw_stat_sync_cont
 //-------------------------------------------------------------------------
 struct raw_stat_sync_cont : public Continuation {
-  raw_stat_sync_cont(ProxyMutex *m) : Continuation(m) { SET_HANDLER(&raw_stat_sync_cont::exec_callbacks); }
+  raw_stat_sync_cont(ProxyMutex *m) : Continuation(m)
+  {
+    SET_HANDLER(&raw_stat_sync_cont::exec_callbacks);
+    thread_agnostic = true;
+  }
   int
   exec_callbacks(int /* event */, Event * /* e */)
   {
     RecExecRawStatSyncCbs();
+    RecExecRawHistogramSyncs();
+    RecStatsSegmentUpdate();
     Debug("statsproc", "raw_stat_sync_cont() processed");
 
     return EVENT_CONT;
@@ -154,7 +163,11 @@ struct raw_stat_sync_cont : public Continuation {
 // config_update_cont
 //-------------------------------------------------------------------------
 struct config_update_cont : public Continuation {
-  config_update_cont(ProxyMutex *m) : Continuation(m) { SET_HANDLER(&config_update_cont::exec_callbacks); }
+  config_update_cont(ProxyMutex *m) : Continuation(m)
+  {
+    SET_HANDLER(&config_update_cont::exec_callbacks);
+    thread_agnostic = true;
+  }
   int
   exec_callbacks(int /* event */, Event * /* e */)
   {
@@ -174,7 +187,8 @@ struct sync_cont : public Continuation {
   sync_cont(ProxyMutex *m) : Continuation(m)
   {
     SET_HANDLER(&sync_cont::sync);
-    m_tb = new TextBuffer(65536);
+    m_tb            = new TextBuffer(65536);
+    thread_agnostic = true;
   }
 
   ~sync_cont() override
@@ -267,6 +281,12 @@ RecProcessStart()
     return REC_ERR_OKAY;
   }
 
+  RecInt segment_enabled = 0;
+  if (RecGetRecordInt("proxy.config.stats.segment.enabled", &segment_enabled) == REC_ERR_OKAY && segment_enabled) {
+    std::string segment_path = Layout::relative_to(RecConfigReadRuntimeDir(), ts::filename::STATS_SEGMENT);
+    RecStatsSegmentOpen(segment_path.c_str());
+  }
+
   Debug("statsproc", "Starting sync continuations:");
   raw_stat_sync_cont *rssc = new raw_stat_sync_cont(new_ProxyMutex());
   Debug("statsproc", "raw-stat syncer");
@@ -0,0 +1,248 @@
+/** @file
+
+  Record histogram support.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_RecCore.h"
+#include "P_RecProcess.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+namespace
+{
+// The records of a histogram, in the order of RecRawHistogram::records.
+enum {
+  HISTOGRAM_COUNT,
+  HISTOGRAM_SUM,
+};
+
+struct HistogramRecord {
+  const char *suffix;
+  double percentile;
+};
+
+const HistogramRecord histogram_records[REC_HISTOGRAM_RECORDS] = {
+  {".count", 0}, {".sum", 0}, {".p50", 50}, {".p90", 90}, {".p99", 99}, {".p999", 99.9},
+};
+
+ink_mutex g_raw_histograms_mutex = PTHREAD_MUTEX_INITIALIZER;
+RecRawHistogram *g_raw_histograms[REC_MAX_RAW_HISTOGRAMS];
+std::atomic<int> g_num_raw_histograms{0};
+
+inline RecRawHistogramData *
+thread_histogram(EThread *et, RecRawHistogram *rh)
+{
+  return reinterpret_cast<RecRawHistogramData *>(reinterpret_cast<char *>(et) + rh->ethr_stat_offset);
+}
+
+void
+histogram_add(RecRawHistogramData *total, const RecRawHistogramData *data)
+{
+  total->count += data->count;
+  total->sum += data->sum;
+  total->buckets += data->buckets;
+}
+
+void
+histogram_subtract(RecRawHistogramData *total, const RecRawHistogramData *data)
+{
+  total->count -= data->count;
+  total->sum -= data->sum;
+  total->buckets -= data->buckets;
+}
+
+//-------------------------------------------------------------------------
+// raw_histogram_sync
+//-------------------------------------------------------------------------
+void
+raw_histogram_sync(RecRawHistogram *rh)
+{
+  RecRawHistogramData merged{};
+  bool reset = false;
+
+  // the thread local histograms only grow, the baseline is what they were at the last reset
+  for (EThread *et : eventProcessor.active_ethreads()) {
+    histogram_add(&merged, thread_histogram(et, rh));
+  }
+
+  for (EThread *et : eventProcessor.active_dthreads()) {
+    histogram_add(&merged, thread_histogram(et, rh));
+  }
+
+  ink_scoped_mutex_lock lock(rh->mutex);
+
+  for (int i = 0; i < REC_HISTOGRAM_RECORDS; ++i) {
+    if (rh->records[i]->version != rh->versions[i]) {
+      rh->versions[i] = rh->records[i]->version;
+      reset           = true;
+    }
+  }
+  if (reset) {
+    Debug("stats", "raw_histogram_sync(): reset %s", rh->name);
+    rh->baseline = merged;
+  }
+
+  rh->total = merged;
+  histogram_subtract(&rh->total, &rh->baseline);
+
+  for (int i = 0; i < REC_HISTOGRAM_RECORDS; ++i) {
+    RecRecord *r = rh->records[i];
+    int64_t value;
+
+    switch (i) {
+    case HISTOGRAM_COUNT:
+      value = rh->total.count;
+      break;
+    case HISTOGRAM_SUM:
+      value = rh->total.sum;
+      break;
+    default:
+      value = RecRawHistogramPercentile(&rh->total, histogram_records[i].percentile);
+      break;
+    }
+
+    rec_mutex_acquire(&(r->lock));
+    RecDataSetFromInt64(r->data_type, &(r->data), value);
+    r->sync_required = REC_SYNC_REQUIRED;
+    rec_mutex_release(&(r->lock));
+  }
+}
+} // namespace
+
+//-------------------------------------------------------------------------
+// RecRegisterRawHistogram
+//-------------------------------------------------------------------------
+RecRawHistogram *
+RecRegisterRawHistogram(RecT rec_type, const char *name)
+{
+  Debug("stats", "RecRegisterRawHistogram(%s)", name);
+
+  ink_scoped_mutex_lock lock(g_raw_histograms_mutex);
+  int id = g_num_raw_histograms.load();
+  off_t ethr_stat_offset;
+
+  if (id >= REC_MAX_RAW_HISTOGRAMS) {
+    Warning("cannot register histogram %s, there are %d of them already", name, REC_MAX_RAW_HISTOGRAMS);
+    return nullptr;
+  }
+
+  // allocate the thread-local histogram
+  if ((ethr_stat_offset = eventProcessor.allocate(sizeof(RecRawHistogramData))) == -1) {
+    Warning("cannot register histogram %s, the thread local storage is exhausted", name);
+    return nullptr;
+  }
+
+  RecRawHistogram *rh  = new RecRawHistogram();
+  rh->ethr_stat_offset = ethr_stat_offset;
+  rh->id               = id;
+  rh->name             = ats_strdup(name);
+  ink_mutex_init(&(rh->mutex));
+
+  for (int i = 0; i < REC_HISTOGRAM_RECORDS; ++i) {
+    std::string record_name = std::string(name) + histogram_records[i].suffix;
+    RecData data_default;
+    RecRecord *r;
+
+    memset(&data_default, 0, sizeof(RecData));
+    if ((r = RecRegisterStat(rec_type, record_name.c_str(), RECD_INT, data_default, RECP_NON_PERSISTENT)) == nullptr) {
+      // the records registered so far stay, as do those of a raw stat that fails to register
+      ink_mutex_destroy(&(rh->mutex));
+      ats_free(rh->name);
+      delete rh;
+      return nullptr;
+    }
+
+    if (i_am_the_record_owner(r->rec_type)) {
+      r->sync_required = r->sync_required | REC_PEER_SYNC_REQUIRED;
+    } else {
+      send_register_message(r);
+    }
+    rh->records[i]  = r;
+    rh->versions[i] = r->version;
+  }
+
+  g_raw_histograms[id] = rh;
+  g_num_raw_histograms.store(id + 1);
+  return rh;
+}
+
+//-------------------------------------------------------------------------
+// RecGetRawHistogram / RecFindRawHistogram
+//-------------------------------------------------------------------------
+RecRawHistogram *
+RecGetRawHistogram(int id)
+{
+  if (id < 0 || id >= g_num_raw_histograms.load()) {
+    return nullptr;
+  }
+  return g_raw_histograms[id];
+}
+
+RecRawHistogram *
+RecFindRawHistogram(const char *name)
+{
+  int num_histograms = g_num_raw_histograms.load();
+
+  for (int i = 0; i < num_histograms; ++i) {
+    if (strcmp(g_raw_histograms[i]->name, name) == 0) {
+      return g_raw_histograms[i];
+    }
+  }
+  return nullptr;
+}
+
+//-------------------------------------------------------------------------
+// RecGetRawHistogramData
+//-------------------------------------------------------------------------
+int
+RecGetRawHistogramData(RecRawHistogram *rh, RecRawHistogramData *data)
+{
+  ink_scoped_mutex_lock lock(rh->mutex);
+  *data = rh->total;
+  return REC_ERR_OKAY;
+}
+
+//-------------------------------------------------------------------------
+// RecRawHistogramPercentile
+//-------------------------------------------------------------------------
+int64_t
+RecRawHistogramPercentile(const RecRawHistogramData *data, double percentile)
+{
+  // from the buckets rather than the count, which a thread recording may have updated apart from them
+  return data->buckets.percentile(std::clamp(percentile, 0.0, 100.0) / 100.0);
+}
+
+//-------------------------------------------------------------------------
+// RecExecRawHistogramSyncs
+//-------------------------------------------------------------------------
+int
+RecExecRawHistogramSyncs()
+{
+  int num_histograms = g_num_raw_histograms.load();
+
+  for (int i = 0; i < num_histograms; ++i) {
+    raw_histogram_sync(g_raw_histograms[i]);
+  }
+
+  return REC_ERR_OKAY;
+}
@@ -0,0 +1,147 @@
+/** @file
+
+  Writes the stats of traffic_server to a read-only shared memory segment.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_time.h"
+
+#include "RecordsConfig.h"
+#include "P_RecCore.h"
+#include "I_RecStatsSegment.h"
+
+#include <string>
+
+namespace
+{
+RecStatsSegmentHeader *segment = nullptr;
+RecStatsSegmentRecord *segment_records;
+// The index in the segment of each record, -1 if it is not in it; the records up to checked are indexed.
+std::vector<int> segment_index;
+int checked = 0;
+
+bool
+exported(const RecRecord *r)
+{
+  return REC_TYPE_IS_STAT(r->rec_type) && (r->data_type == RECD_INT || r->data_type == RECD_COUNTER || r->data_type == RECD_FLOAT);
+}
+} // namespace
+
+//-------------------------------------------------------------------------
+// RecStatsSegmentOpen
+//-------------------------------------------------------------------------
+bool
+RecStatsSegmentOpen(const char *path)
+{
+  std::string tmp = std::string(path) + "." + std::to_string(getpid());
+  size_t size     = sizeof(RecStatsSegmentHeader) + max_records_entries * sizeof(RecStatsSegmentRecord);
+  int fd          = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0) {
+    Warning("cannot create the stats segment '%s': %s", tmp.c_str(), strerror(errno));
+    return false;
+  }
+
+  void *addr = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (addr == MAP_FAILED) {
+    Warning("cannot map the stats segment '%s': %s", tmp.c_str(), strerror(errno));
+    ::close(fd);
+    unlink(tmp.c_str());
+    return false;
+  }
+  ::close(fd);
+
+  // the file is all zeros, the one of a previous traffic_server is replaced once it is set up
+  RecStatsSegmentHeader *header = static_cast<RecStatsSegmentHeader *>(addr);
+  memcpy(header->magic, REC_STATS_SEGMENT_MAGIC, sizeof(header->magic));
+  header->version     = REC_STATS_SEGMENT_VERSION;
+  header->header_size = sizeof(RecStatsSegmentHeader);
+  header->record_size = sizeof(RecStatsSegmentRecord);
+  header->capacity    = max_records_entries;
+  header->pid         = getpid();
+
+  if (rename(tmp.c_str(), path) < 0) {
+    Warning("cannot replace the stats segment '%s': %s", path, strerror(errno));
+    munmap(addr, size);
+    unlink(tmp.c_str());
+    return false;
+  }
+
+  segment_records = reinterpret_cast<RecStatsSegmentRecord *>(header + 1);
+  segment_index.assign(max_records_entries, -1);
+  segment = header;
+  Note("writing the stats to the segment '%s'", path);
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// RecStatsSegmentUpdate
+//-------------------------------------------------------------------------
+void
+RecStatsSegmentUpdate()
+{
+  if (!segment) {
+    return;
+  }
+
+  int num_records = g_num_records;
+  uint32_t count  = segment->num_records;
+
+  __atomic_store_n(&segment->sequence, segment->sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  // the records registered since, that are stats
+  for (; checked < num_records; ++checked) {
+    RecRecord *r = &(g_records[checked]);
+    if (exported(r) && count < segment->capacity) {
+      RecStatsSegmentRecord &sr = segment_records[count];
+      ink_strlcpy(sr.name, r->name, sizeof(sr.name));
+      __atomic_store_n(&sr.data_type, static_cast<int32_t>(r->data_type), __ATOMIC_RELAXED);
+      segment_index[checked] = count++;
+    }
+  }
+
+  for (int i = 0; i < num_records; ++i) {
+    int index = segment_index[i];
+    if (index < 0) {
+      continue;
+    }
+
+    RecRecord *r = &(g_records[i]);
+    int64_t bits;
+    if (r->data_type == RECD_FLOAT) {
+      RecFloat f;
+      __atomic_load(&(r->data.rec_float), &f, __ATOMIC_RELAXED);
+      double d = f;
+      memcpy(&bits, &d, sizeof(bits));
+    } else {
+      bits = __atomic_load_n(&r->data.rec_int, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&segment_records[index].rec_bits, bits, __ATOMIC_RELAXED);
+  }
+
+  __atomic_store_n(&segment->num_records, count, __ATOMIC_RELAXED);
+  segment->updated_at = ink_hrtime_to_msec(ink_get_hrtime_internal());
+  __atomic_store_n(&segment->sequence, segment->sequence + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,121 @@
+/** @file
+
+   Catch-based tests for the buckets and percentiles of RecRawHistograms.cc
+
+   @section license License
+
+   Licensed to the Apache Software Foundation (ASF) under one or more contributor license agreements.
+   See the NOTICE file distributed with this work for additional information regarding copyright
+   ownership.  The ASF licenses this file to you under the Apache License, Version 2.0 (the
+   "License"); you may not use this file except in compliance with the License.  You may obtain a
+   copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+ */
+
+#include <cstring>
+
+#include "catch.hpp"
+
+#include "records/I_RecProcess.h"
+
+namespace
+{
+void
+add(RecRawHistogramData &data, int64_t value, int64_t times = 1)
+{
+  for (int64_t i = 0; i < times; ++i) {
+    data.buckets.record(value);
+  }
+  data.sum += value * times;
+  data.count += times;
+}
+} // namespace
+
+TEST_CASE("RecRawHistogram buckets", "[librecords][RecRawHistogram]")
+{
+  SECTION("small values are exact")
+  {
+    for (int64_t v = 0; v < (1 << REC_HISTOGRAM_SUB_BITS); ++v) {
+      REQUIRE(RecRawHistogramBucket(v) == v);
+      REQUIRE(RecRawHistogramBucketLowerBound(v) == v);
+    }
+    REQUIRE(RecRawHistogramBucket(-5) == 0);
+  }
+
+  SECTION("each value is within its bucket")
+  {
+    for (int64_t v = 1; v < (int64_t(1) << REC_HISTOGRAM_MAX_BITS); v = v * 3 / 2 + 1) {
+      int bucket = RecRawHistogramBucket(v);
+      REQUIRE(RecRawHistogramBucketLowerBound(bucket) <= v);
+      REQUIRE(v < RecRawHistogramBucketLowerBound(bucket + 1));
+      // at most 1/2^REC_HISTOGRAM_SUB_BITS of the value wide
+      REQUIRE((RecRawHistogramBucketLowerBound(bucket + 1) - RecRawHistogramBucketLowerBound(bucket)) <<
+                REC_HISTOGRAM_SUB_BITS <=
+              std::max<int64_t>(v, 1 << REC_HISTOGRAM_SUB_BITS));
+    }
+  }
+
+  SECTION("the buckets follow each other")
+  {
+    for (int bucket = 1; bucket < REC_HISTOGRAM_BUCKETS; ++bucket) {
+      int64_t lower = RecRawHistogramBucketLowerBound(bucket);
+      REQUIRE(RecRawHistogramBucket(lower) == bucket);
+      REQUIRE(RecRawHistogramBucket(lower - 1) == bucket - 1);
+    }
+  }
+
+  SECTION("large values are in the last bucket")
+  {
+    REQUIRE(RecRawHistogramBucket(int64_t(1) << REC_HISTOGRAM_MAX_BITS) == REC_HISTOGRAM_BUCKETS - 1);
+    REQUIRE(RecRawHistogramBucket(INT64_MAX) == REC_HISTOGRAM_BUCKETS - 1);
+  }
+}
+
+TEST_CASE("RecRawHistogram percentiles", "[librecords][RecRawHistogram]")
+{
+  RecRawHistogramData data{};
+
+  SECTION("empty")
+  {
+    REQUIRE(RecRawHistogramPercentile(&data, 50) == 0);
+  }
+
+  SECTION("exact values")
+  {
+    add(data, 1, 90);
+    add(data, 5, 9);
+    add(data, 7, 1);
+    REQUIRE(RecRawHistogramPercentile(&data, 0) == 1);
+    REQUIRE(RecRawHistogramPercentile(&data, 50) == 1);
+    REQUIRE(RecRawHistogramPercentile(&data, 90) == 1);
+    REQUIRE(RecRawHistogramPercentile(&data, 91) == 5);
+    REQUIRE(RecRawHistogramPercentile(&data, 99) == 5);
+    REQUIRE(RecRawHistogramPercentile(&data, 99.9) == 7);
+    REQUIRE(RecRawHistogramPercentile(&data, 100) == 7);
+  }
+
+  SECTION("a tail")
+  {
+    for (int64_t v = 1; v <= 1000; ++v) {
+      add(data, v);
+    }
+    add(data, 1000000, 2);
+
+    // within the width of a bucket of the exact percentiles
+    int64_t p50 = RecRawHistogramPercentile(&data, 50);
+    REQUIRE(p50 >= 448);
+    REQUIRE(p50 <= 576);
+    int64_t p90 = RecRawHistogramPercentile(&data, 90);
+    REQUIRE(p90 >= 896);
+    REQUIRE(p90 <= 1024);
+    int64_t p999 = RecRawHistogramPercentile(&data, 99.9);
+    REQUIRE(p999 >= 917504);
+    REQUIRE(p999 < 1048576);
+  }
+}
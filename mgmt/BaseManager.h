@@ -59,6 +59,9 @@
 #define MGMT_EVENT_DRAIN 10013
 #define MGMT_EVENT_HOST_STATUS_UP 10014
 #define MGMT_EVENT_HOST_STATUS_DOWN 10015
+#define MGMT_EVENT_CACHE_SCAN 10016
+#define MGMT_EVENT_CACHE_TAG_INVALIDATE 10017
+#define MGMT_EVENT_HANDOFF 10018
 
 /***********************************************************************
  *
@@ -46,6 +46,7 @@
 
 using namespace std::literals;
 static const std::string_view MGMT_OPT{"-M"};
+static const std::string_view HANDOFF_OPT{"--handoff"};
 static const std::string_view RUNROOT_OPT{"--run-root="};
 
 void
@@ -83,6 +84,9 @@ LocalManager::mgmtShutdown()
     mgmt_sleep_msec(1);
 #endif
   }
+  if (handoff_process_pid != -1) {
+    waitpid(handoff_process_pid, nullptr, 0);
+  }
   mgmtCleanup();
 }
 
@@ -114,6 +118,36 @@ LocalManager::processBounce()
   return;
 }
 
+/*
+ * processHotBounce()
+ *   Tells the running traffic_server to hand off and stops watching it, so that the new one is started
+ * on the same listening sockets while it drains. The old process is reaped once it exits.
+ */
+void
+LocalManager::processHotBounce()
+{
+  if (!processRunning() || !listen_for_proxy) {
+    processBounce();
+    return;
+  }
+
+  if (handoff_process_pid != -1) {
+    mgmt_log("[LocalManager::processHotBounce] Process %ld is still handing off, ignoring the request.\n",
+             static_cast<long>(handoff_process_pid));
+    return;
+  }
+
+  mgmt_log("[LocalManager::processHotBounce] Executing process hot bounce request.\n");
+  sendMgmtMsgToProcesses(MGMT_EVENT_HANDOFF, "processHotBounce");
+
+  handoff_process_pid = watched_process_pid;
+  handoff_process_fd  = watched_process_fd;
+  watched_process_fd = watched_process_pid = -1;
+  proxy_running--;
+  proxy_started_at = -1;
+  RecSetRecordInt("proxy.node.proxy_running", 0, REC_SOURCE_DEFAULT);
+}
+
 void
 LocalManager::processDrain(int to_drain)
 {
@@ -333,6 +367,10 @@ LocalManager::pollMgmtProcessServer()
       FD_SET(watched_process_fd, &fdlist);
     }
 
+    if (handoff_process_fd != ts::NO_FD) {
+      FD_SET(handoff_process_fd, &fdlist);
+    }
+
 #if TS_HAS_WCCP
     // Only run WCCP housekeeping while we have a server process.
     // Note: The WCCP socket is opened iff WCCP is configured.
@@ -461,6 +499,37 @@ LocalManager::pollMgmtProcessServer()
         --num;
       }
 
+      // The process handing off is no longer the one managed, what it sends is dropped until it exits.
+      if (ts::NO_FD != handoff_process_fd && FD_ISSET(handoff_process_fd, &fdlist)) {
+        int res;
+        MgmtMessageHdr mh_hdr;
+
+        keep_polling = true;
+
+        if ((res = mgmt_read_pipe(handoff_process_fd, reinterpret_cast<char *>(&mh_hdr), sizeof(MgmtMessageHdr))) > 0 &&
+            mh_hdr.data_len > 0) {
+          char *data_raw = static_cast<char *>(ats_malloc(mh_hdr.data_len));
+          res            = mgmt_read_pipe(handoff_process_fd, data_raw, mh_hdr.data_len);
+          ats_free(data_raw);
+        }
+
+        if (res <= 0) {
+          int estatus = 0;
+
+          close_socket(handoff_process_fd);
+          if (res < 0) {
+            mgmt_log("[LocalManager::pollMgmtProcessServer] Error in read from the process handing off (errno: %d)\n", -res);
+            kill(handoff_process_pid, SIGKILL);
+          }
+          waitpid(handoff_process_pid, &estatus, 0); /* Reap child */
+          mgmt_log("[LocalManager::pollMgmtProcessServer] Server process %ld finished handing off\n",
+                   static_cast<long>(handoff_process_pid));
+          handoff_process_fd = handoff_process_pid = -1;
+        }
+
+        --num;
+      }
+
 #if HAVE_EVENTFD
       if (wakeup_fd != ts::NO_FD && FD_ISSET(wakeup_fd, &fdlist)) {
         if (!keep_polling) {
@@ -863,6 +932,12 @@ LocalManager::startProxy(const char *onetime_options)
       w.write(' ');
     }
 
+    // Tell traffic_server that the previous one is still running, handing off to it
+    if (handoff_process_pid != -1) {
+      w.write(HANDOFF_OPT);
+      w.write(' ');
+    }
+
     // pass the runroot option to traffic_server
     std::string_view runroot_arg = get_runroot();
     if (!runroot_arg.empty()) {
@@ -51,6 +51,7 @@ enum ManagementPendingOperation {
   MGMT_PENDING_IDLE_STOP,    // Stop TS when TS is idle
   MGMT_PENDING_IDLE_DRAIN,   // Drain TS when TS is idle from new connections
   MGMT_PENDING_UNDO_DRAIN,   // Recover TS from drain
+  MGMT_PENDING_HOT_BOUNCE,   // Restart TS, starting the new one while the old one drains
 };
 
 class LocalManager : public BaseManager
@@ -85,6 +86,7 @@ public:
   void processShutdown(bool mainThread = false);
   void processRestart();
   void processBounce();
+  void processHotBounce();
   void processDrain(int to_drain = 1);
   void rollLogFiles();
   void clearStats(const char *name = nullptr);
@@ -120,6 +122,9 @@ public:
 
   int process_server_sockfd = ts::NO_FD;
   int watched_process_fd    = ts::NO_FD;
+  // The process handing off to the watched one, draining until it exits.
+  pid_t handoff_process_pid = -1;
+  int handoff_process_fd    = ts::NO_FD;
 #if HAVE_EVENTFD
   int wakeup_fd = ts::NO_FD; // external trigger to stop polling
 #endif
@@ -460,6 +460,9 @@ ProcessManager::handleMgmtMsgFromLM(MgmtMessageHdr *mh)
   case MGMT_EVENT_DRAIN:
     executeMgmtCallback(MGMT_EVENT_DRAIN, payload);
     break;
+  case MGMT_EVENT_HANDOFF:
+    executeMgmtCallback(MGMT_EVENT_HANDOFF, {});
+    break;
   case MGMT_EVENT_CLEAR_STATS:
     executeMgmtCallback(MGMT_EVENT_CLEAR_STATS, {});
     break;
@@ -503,6 +506,12 @@ ProcessManager::handleMgmtMsgFromLM(MgmtMessageHdr *mh)
   case MGMT_EVENT_LIFECYCLE_MESSAGE:
     executeMgmtCallback(MGMT_EVENT_LIFECYCLE_MESSAGE, payload);
     break;
+  case MGMT_EVENT_CACHE_SCAN:
+    executeMgmtCallback(MGMT_EVENT_CACHE_SCAN, payload);
+    break;
+  case MGMT_EVENT_CACHE_TAG_INVALIDATE:
+    executeMgmtCallback(MGMT_EVENT_CACHE_TAG_INVALIDATE, payload);
+    break;
   default:
     Warning("received unknown message ID %d\n", mh->msg_id);
     break;
@@ -29,17 +29,99 @@
 
 ConfigProcessor configProcessor;
 
+std::atomic<uint64_t> ConfigEpoch::global{1};
+thread_local ConfigEpochSlot *ConfigEpoch::t_slot = nullptr;
+thread_local int ConfigEpoch::t_depth             = 0;
+
+namespace
+{
+// The slots of all the threads that ever entered a section. They are not freed, the slot of a thread that
+// exited is taken by the next new one.
+std::atomic<ConfigEpochSlot *> epoch_slots{nullptr};
+
+// Gives the slot of the thread back when it exits.
+struct ConfigEpochSlotOwner {
+  ConfigEpochSlot *slot = nullptr;
+  ~ConfigEpochSlotOwner()
+  {
+    if (slot) {
+      slot->in_use.store(false, std::memory_order_release);
+    }
+  }
+};
+
+thread_local ConfigEpochSlotOwner epoch_slot_owner;
+} // namespace
+
+ConfigEpochSlot *
+ConfigEpoch::thread_slot()
+{
+  ConfigEpochSlot *slot;
+
+  for (slot = epoch_slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+    bool in_use = false;
+    if (!slot->in_use.load(std::memory_order_relaxed) && slot->in_use.compare_exchange_strong(in_use, true)) {
+      break;
+    }
+  }
+
+  if (slot == nullptr) {
+    slot       = new ConfigEpochSlot;
+    slot->next = epoch_slots.load(std::memory_order_relaxed);
+    while (!epoch_slots.compare_exchange_weak(slot->next, slot)) {
+    }
+  }
+
+  epoch_slot_owner.slot = slot;
+  t_slot                = slot;
+  return slot;
+}
+
+uint64_t
+ConfigEpoch::retire()
+{
+  return global.fetch_add(1) + 1;
+}
+
+bool
+ConfigEpoch::synchronized(uint64_t epoch)
+{
+  for (ConfigEpochSlot *slot = epoch_slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+    uint64_t e = slot->epoch.load();
+    if (e != 0 && e < epoch) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Releases the reference of the ConfigProcessor to a replaced ConfigInfo after the release timeout, once
+// no thread can still be reading it in a ConfigEpoch section, or be about to take a reference to it in
+// ConfigProcessor::get(). The timeout stays for those that keep what they found in a config past the
+// reference they had to it.
 class ConfigInfoReleaser : public Continuation
 {
 public:
-  ConfigInfoReleaser(unsigned int id, ConfigInfo *info) : Continuation(new_ProxyMutex()), m_id(id), m_info(info)
+  ConfigInfoReleaser(unsigned int id, ConfigInfo *info, uint64_t epoch, unsigned timeout_secs)
+    : Continuation(new_ProxyMutex()), m_id(id), m_info(info), m_epoch(epoch), m_timeout(HRTIME_SECONDS(timeout_secs))
   {
     SET_HANDLER(&ConfigInfoReleaser::handle_event);
   }
 
   int
-  handle_event(int /* event ATS_UNUSED */, void * /* edata ATS_UNUSED */)
+  handle_event(int /* event ATS_UNUSED */, Event *e)
   {
+    if (!ConfigEpoch::synchronized(m_epoch)) {
+      if (m_warn_at == 0) {
+        m_warn_at = Thread::get_hrtime() + m_timeout;
+      } else if (m_warn_at > 0 && Thread::get_hrtime() >= m_warn_at) {
+        Warning("config %u 0x%" PRIx64 " is still held back by a thread in a config epoch section", m_id, (uint64_t)m_info);
+        m_warn_at = -1;
+      }
+      e->schedule_in(HRTIME_MSECONDS(ConfigProcessor::CONFIG_PROCESSOR_RELEASE_POLL_MSECS));
+      return EVENT_CONT;
+    }
+
     configProcessor.release(m_id, m_info);
     delete this;
     return EVENT_DONE;
@@ -48,8 +130,90 @@ public:
 public:
   unsigned int m_id;
   ConfigInfo *m_info;
+  uint64_t m_epoch;
+  ink_hrtime m_timeout;
+  ink_hrtime m_warn_at = 0; ///< when to warn that the release is held back, -1 once it was
 };
 
+ConfigReloadStats::ConfigReloadStats(const char *name) : prefix(std::string("proxy.process.config.reload.") + name)
+{
+  for (const char *stat : {".count", ".coalesced", ".time_ms", ".last_time_ms", ".last_cpu_ms", ".last_memory"}) {
+    RecRegisterStatInt(RECT_PROCESS, (prefix + stat).c_str(), 0, RECP_NON_PERSISTENT);
+  }
+}
+
+void
+ConfigReloadStats::set(const char *stat, int64_t value)
+{
+  RecSetRecordInt((prefix + stat).c_str(), value, REC_SOURCE_DEFAULT);
+}
+
+ink_hrtime
+ConfigReloadStats::schedule()
+{
+  if (pending.exchange(true)) {
+    set(".coalesced", ++coalesced);
+    Debug("config", "%s: coalesced into the pending reload", prefix.c_str());
+    return -1;
+  }
+
+  RecInt coalesce_ms = 0;
+  RecGetRecordInt("proxy.config.config_update.coalesce_ms", &coalesce_ms);
+  return HRTIME_MSECONDS(coalesce_ms);
+}
+
+// The bytes the calling thread allocated less those it freed, 0 if the allocator does not tell.
+static int64_t
+thread_allocated()
+{
+#if TS_HAS_JEMALLOC
+  uint64_t allocated = 0, deallocated = 0;
+  size_t size        = sizeof(uint64_t);
+
+  if (mallctl("thread.allocated", &allocated, &size, nullptr, 0) == 0 &&
+      mallctl("thread.deallocated", &deallocated, &size, nullptr, 0) == 0) {
+    return static_cast<int64_t>(allocated - deallocated);
+  }
+#endif
+  return 0;
+}
+
+ConfigReloadStats::Sample
+ConfigReloadStats::begin()
+{
+  struct timespec cpu;
+  Sample sample;
+
+  // updates from now on reload again, the reload may not see them
+  pending = false;
+
+  sample.started        = ink_get_hrtime_internal();
+  sample.cpu_started    = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0 ? ink_hrtime_from_timespec(&cpu) : 0;
+  sample.memory_started = thread_allocated();
+  return sample;
+}
+
+void
+ConfigReloadStats::end(const Sample &sample)
+{
+  struct timespec cpu;
+  int64_t elapsed_ms = ink_hrtime_to_msec(ink_get_hrtime_internal() - sample.started);
+  int64_t cpu_ms     = 0;
+  int64_t memory     = thread_allocated() - sample.memory_started;
+
+  if (sample.cpu_started && clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0) {
+    cpu_ms = ink_hrtime_to_msec(ink_hrtime_from_timespec(&cpu) - sample.cpu_started);
+  }
+
+  Debug("config", "%s: reloaded in %" PRId64 " ms, %" PRId64 " ms of CPU, %" PRId64 " bytes", prefix.c_str(), elapsed_ms, cpu_ms,
+        memory);
+  set(".count", ++reloads);
+  set(".time_ms", total_ms += elapsed_ms);
+  set(".last_time_ms", elapsed_ms);
+  set(".last_cpu_ms", cpu_ms);
+  set(".last_memory", memory);
+}
+
 unsigned int
 ConfigProcessor::set(unsigned int id, ConfigInfo *info, unsigned timeout_secs)
 {
@@ -86,7 +250,8 @@ ConfigProcessor::set(unsigned int id, ConfigInfo *info, unsigned timeout_secs)
     // The ConfigInfoReleaser now takes our refcount, but
     // some other thread might also have one ...
     ink_assert(old_info->refcount() > 0);
-    eventProcessor.schedule_in(new ConfigInfoReleaser(id, old_info), HRTIME_SECONDS(timeout_secs));
+    eventProcessor.schedule_in(new ConfigInfoReleaser(id, old_info, ConfigEpoch::retire(), timeout_secs),
+                               HRTIME_SECONDS(timeout_secs));
   }
 
   return id;
@@ -105,7 +270,10 @@ ConfigProcessor::get(unsigned int id)
     return nullptr;
   }
 
-  idx  = id - 1;
+  idx = id - 1;
+
+  // The section keeps the config from being released between reading it and taking the refcount.
+  ConfigEpoch epoch;
   info = infos[idx];
 
   // Hand out a refcount to the caller. We should still have out
@@ -280,4 +448,21 @@ EXCLUSIVE_REGRESSION_TEST(ProxyConfig_Release)(RegressionTest *test, int /* atyp
   RegressionConfig::defer(2, ProxyConfig_Release_Completion(configid, config));
 }
 
+// Test that a ConfigEpoch section, nested or not, holds back what is retired while the thread is in it.
+REGRESSION_TEST(ProxyConfig_Epoch)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(test, pstatus, REGRESSION_TEST_PASSED);
+  uint64_t epoch;
+
+  {
+    ConfigEpoch outer;
+    {
+      ConfigEpoch inner;
+      epoch = ConfigEpoch::retire();
+      box.check(!ConfigEpoch::synchronized(epoch), "the retired epoch is not held back by the nested section");
+    }
+    box.check(!ConfigEpoch::synchronized(epoch), "the retired epoch is not held back by the outer section");
+  }
+}
+
 #endif /* TS_HAS_TESTS */
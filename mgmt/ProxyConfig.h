@@ -24,6 +24,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <string>
 
 #include "ProcessManager.h"
 #include "I_Tasks.h"
@@ -46,6 +48,61 @@ class ProxyMutex;
 
 typedef RefCountObj ConfigInfo;
 
+// The epoch of a thread, on a cache line of its own.
+struct alignas(64) ConfigEpochSlot {
+  std::atomic<uint64_t> epoch{0}; ///< the global epoch when the thread entered its section, 0 if it is in none
+  std::atomic<bool> in_use{true}; ///< false once the thread exited, until another one takes the slot
+  ConfigEpochSlot *next = nullptr;
+};
+
+// A read-side critical section, in which the configs current when it was entered are not freed. Entering and
+// leaving it only writes the epoch of the calling thread, so unlike a reference count it does not bounce a
+// cache line shared between the threads. A replaced config is freed once every thread that was in a section
+// when it was replaced has left it. A section must not outlast the callback it is entered in: what is kept
+// across events, or passed to another thread, needs a reference count from ConfigProcessor::get().
+// Sections nest.
+class ConfigEpoch
+{
+public:
+  ConfigEpoch() { enter(); }
+  ~ConfigEpoch() { leave(); }
+
+  static void
+  enter()
+  {
+    if (t_depth++ == 0) {
+      ConfigEpochSlot *slot = t_slot ? t_slot : thread_slot();
+      slot->epoch.store(global.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      // the configs must be read after the epoch is published
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  static void
+  leave()
+  {
+    if (--t_depth == 0) {
+      t_slot->epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  /// Advance the global epoch, after a config was replaced. Returns the epoch the threads in a section must reach.
+  static uint64_t retire();
+  /// Whether no thread is in a section it entered before @a epoch.
+  static bool synchronized(uint64_t epoch);
+
+  // noncopyable
+  ConfigEpoch(const ConfigEpoch &) = delete;
+  ConfigEpoch &operator=(const ConfigEpoch &) = delete;
+
+private:
+  static ConfigEpochSlot *thread_slot();
+
+  static std::atomic<uint64_t> global;
+  static thread_local ConfigEpochSlot *t_slot;
+  static thread_local int t_depth;
+};
+
 class ConfigProcessor
 {
 public:
@@ -54,7 +111,10 @@ public:
   enum {
     // The number of seconds to wait before garbage collecting stale ConfigInfo objects. There's
     // no good reason to tune this, outside of regression tests, so don't.
-    CONFIG_PROCESSOR_RELEASE_SECS = 60
+    CONFIG_PROCESSOR_RELEASE_SECS = 60,
+    // How often, in milliseconds, a stale ConfigInfo still held back by a ConfigEpoch section
+    // checks whether it can be released.
+    CONFIG_PROCESSOR_RELEASE_POLL_MSECS = 10,
   };
 
   template <typename ClassType, typename ConfigType> struct scoped_config {
@@ -72,40 +132,123 @@ public:
     ConfigType *ptr;
   };
 
+  // Like scoped_config, in a ConfigEpoch section instead of with a reference count. ClassType::peek()
+  // returns the current config without a reference.
+  template <typename ClassType, typename ConfigType> struct epoch_config {
+    epoch_config() : ptr(ClassType::peek()) {}
+    operator bool() const { return ptr != nullptr; }
+    operator const ConfigType *() const { return ptr; }
+    const ConfigType *
+    operator->() const
+    {
+      return ptr;
+    }
+
+  private:
+    ConfigEpoch epoch; // entered before the config is read
+    ConfigType *ptr;
+  };
+
   unsigned int set(unsigned int id, ConfigInfo *info, unsigned timeout_secs = CONFIG_PROCESSOR_RELEASE_SECS);
   ConfigInfo *get(unsigned int id);
   void release(unsigned int id, ConfigInfo *data);
 
+  /// The current config of @a id, without a reference count. The caller must be in a ConfigEpoch section.
+  ConfigInfo *
+  peek(unsigned int id)
+  {
+    if (id == 0 || id > MAX_CONFIGS) {
+      return nullptr;
+    }
+    return infos[id - 1].load(std::memory_order_acquire);
+  }
+
 public:
   std::atomic<ConfigInfo *> infos[MAX_CONFIGS] = {nullptr};
   std::atomic<int> ninfos{0};
 };
 
+/** The accounting of the reloads of a config, in the proxy.process.config.reload.<name> stats.
+
+    The updates of a config that come while a reload of it is pending are coalesced into that reload,
+    which is delayed by proxy.config.config_update.coalesce_ms for more of them to come.
+ */
+class ConfigReloadStats
+{
+public:
+  explicit ConfigReloadStats(const char *name);
+
+  /// What a reload started from, for end() to account for.
+  struct Sample {
+    ink_hrtime started;
+    int64_t cpu_started;    ///< the CPU time of the thread, in ns
+    int64_t memory_started; ///< the bytes the thread allocated less those it freed, if the allocator tells
+  };
+
+  /// The delay to schedule the reload with, or -1 if one is pending already, that this update is coalesced into.
+  ink_hrtime schedule();
+
+  Sample begin();
+  void end(const Sample &sample);
+
+private:
+  void set(const char *stat, int64_t value);
+
+  std::string prefix;
+  std::atomic<bool> pending{false};
+  std::atomic<int64_t> reloads{0};
+  std::atomic<int64_t> coalesced{0};
+  std::atomic<int64_t> total_ms{0};
+};
+
 // A Continuation wrapper that calls the static reconfigure() method of the given class.
 template <typename UpdateClass> struct ConfigUpdateContinuation : public Continuation {
   int
   update(int /* etype */, void * /* data */)
   {
-    UpdateClass::reconfigure();
+    if (stats) {
+      ConfigReloadStats::Sample sample = stats->begin();
+      UpdateClass::reconfigure();
+      stats->end(sample);
+    } else {
+      UpdateClass::reconfigure();
+    }
     delete this;
     return EVENT_DONE;
   }
 
-  ConfigUpdateContinuation(Ptr<ProxyMutex> &m) : Continuation(m.get()) { SET_HANDLER(&ConfigUpdateContinuation::update); }
+  ConfigUpdateContinuation(Ptr<ProxyMutex> &m, ConfigReloadStats *s = nullptr) : Continuation(m.get()), stats(s)
+  {
+    SET_HANDLER(&ConfigUpdateContinuation::update);
+  }
+
+  ConfigReloadStats *stats;
 };
 
 template <typename UpdateClass>
 int
-ConfigScheduleUpdate(Ptr<ProxyMutex> &mutex)
+ConfigScheduleUpdate(Ptr<ProxyMutex> &mutex, ConfigReloadStats *stats = nullptr)
 {
-  eventProcessor.schedule_imm(new ConfigUpdateContinuation<UpdateClass>(mutex), ET_TASK);
+  ink_hrtime delay = stats ? stats->schedule() : 0;
+
+  if (delay > 0) {
+    eventProcessor.schedule_in(new ConfigUpdateContinuation<UpdateClass>(mutex, stats), delay, ET_TASK);
+  } else if (delay == 0) {
+    eventProcessor.schedule_imm(new ConfigUpdateContinuation<UpdateClass>(mutex, stats), ET_TASK);
+  }
   return 0;
 }
 
 template <typename UpdateClass> struct ConfigUpdateHandler {
-  ConfigUpdateHandler() : mutex(new_ProxyMutex()) {}
+  /// The reloads are accounted for in the proxy.process.config.reload.<name> stats if there is a @a name.
+  explicit ConfigUpdateHandler(const char *name = nullptr) : mutex(new_ProxyMutex())
+  {
+    if (name) {
+      stats = new ConfigReloadStats(name);
+    }
+  }
   // The mutex member is ref-counted so should not explicitly free it
-  ~ConfigUpdateHandler() {}
+  ~ConfigUpdateHandler() { delete stats; }
   int
   attach(const char *name)
   {
@@ -119,10 +262,11 @@ private:
     ConfigUpdateHandler *self = static_cast<ConfigUpdateHandler *>(cookie);
 
     Debug("config", "%s(%s)", __PRETTY_FUNCTION__, name);
-    return ConfigScheduleUpdate<UpdateClass>(self->mutex);
+    return ConfigScheduleUpdate<UpdateClass>(self->mutex, self->stats);
   }
 
   Ptr<ProxyMutex> mutex;
+  ConfigReloadStats *stats = nullptr;
 };
 
 extern ConfigProcessor configProcessor;
@@ -422,7 +422,11 @@ TSMgmtError
 Bounce(unsigned options)
 {
   lmgmt->mgmt_shutdown_triggered_at = time(nullptr);
-  lmgmt->mgmt_shutdown_outstanding  = (options & TS_RESTART_OPT_DRAIN) ? MGMT_PENDING_IDLE_BOUNCE : MGMT_PENDING_BOUNCE;
+  if (options & TS_RESTART_OPT_HOT) {
+    lmgmt->mgmt_shutdown_outstanding = MGMT_PENDING_HOT_BOUNCE;
+  } else {
+    lmgmt->mgmt_shutdown_outstanding = (options & TS_RESTART_OPT_DRAIN) ? MGMT_PENDING_IDLE_BOUNCE : MGMT_PENDING_BOUNCE;
+  }
 
   return TS_ERR_OKAY;
 }
@@ -479,6 +483,28 @@ StorageDeviceCmdOffline(const char *dev)
   lmgmt->signalEvent(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, dev);
   return TS_ERR_OKAY;
 }
+/*-------------------------------------------------------------------------
+ * CacheScan
+ *-------------------------------------------------------------------------
+ * Start a cache scan.
+ */
+TSMgmtError
+CacheScan(const char *options)
+{
+  lmgmt->signalEvent(MGMT_EVENT_CACHE_SCAN, options);
+  return TS_ERR_OKAY;
+}
+/*-------------------------------------------------------------------------
+ * CacheTagInvalidate
+ *-------------------------------------------------------------------------
+ * Remove the documents of cache tags.
+ */
+TSMgmtError
+CacheTagInvalidate(const char *tags)
+{
+  lmgmt->signalEvent(MGMT_EVENT_CACHE_TAG_INVALIDATE, tags);
+  return TS_ERR_OKAY;
+}
 /*-------------------------------------------------------------------------
  * Lifecycle Message
  *-------------------------------------------------------------------------
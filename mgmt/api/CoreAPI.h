@@ -52,6 +52,8 @@ TSMgmtError Bounce(unsigned options);
 TSMgmtError Stop(unsigned options);                                                // stop traffic_server
 TSMgmtError Drain(unsigned options);                                               // drain requests of traffic_server
 TSMgmtError StorageDeviceCmdOffline(const char *dev);                              // Storage device operation.
+TSMgmtError CacheScan(const char *options);                                        // Start a cache scan.
+TSMgmtError CacheTagInvalidate(const char *tags);                                  // Remove the documents of cache tags.
 TSMgmtError LifecycleMessage(const char *tag, void const *data, size_t data_size); // Lifecycle alert to plugins.
 
 /***************************************************************************
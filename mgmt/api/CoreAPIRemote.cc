@@ -483,6 +483,38 @@ StorageDeviceCmdOffline(const char *dev)
   return (ret == TS_ERR_OKAY) ? parse_generic_response(OpType::STORAGE_DEVICE_CMD_OFFLINE, main_socket_fd) : ret;
 }
 
+/*-------------------------------------------------------------------------
+ * CacheScan
+ *-------------------------------------------------------------------------
+ * Start a cache scan.
+ */
+TSMgmtError
+CacheScan(const char *options)
+{
+  TSMgmtError ret;
+  OpType optype            = OpType::CACHE_SCAN;
+  MgmtMarshallString value = const_cast<MgmtMarshallString>(options);
+
+  ret = MGMTAPI_SEND_MESSAGE(main_socket_fd, OpType::CACHE_SCAN, &optype, &value);
+  return (ret == TS_ERR_OKAY) ? parse_generic_response(OpType::CACHE_SCAN, main_socket_fd) : ret;
+}
+
+/*-------------------------------------------------------------------------
+ * CacheTagInvalidate
+ *-------------------------------------------------------------------------
+ * Remove the documents of cache tags.
+ */
+TSMgmtError
+CacheTagInvalidate(const char *tags)
+{
+  TSMgmtError ret;
+  OpType optype            = OpType::CACHE_TAG_INVALIDATE;
+  MgmtMarshallString value = const_cast<MgmtMarshallString>(tags);
+
+  ret = MGMTAPI_SEND_MESSAGE(main_socket_fd, OpType::CACHE_TAG_INVALIDATE, &optype, &value);
+  return (ret == TS_ERR_OKAY) ? parse_generic_response(OpType::CACHE_TAG_INVALIDATE, main_socket_fd) : ret;
+}
+
 /*-------------------------------------------------------------------------
  * Lifecycle Alert
  *-------------------------------------------------------------------------
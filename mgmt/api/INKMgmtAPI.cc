@@ -834,6 +834,18 @@ TSStorageDeviceCmdOffline(const char *dev)
   return StorageDeviceCmdOffline(dev);
 }
 
+tsapi TSMgmtError
+TSCacheScan(const char *options)
+{
+  return CacheScan(options);
+}
+
+tsapi TSMgmtError
+TSCacheTagInvalidate(const char *tags)
+{
+  return CacheTagInvalidate(tags);
+}
+
 tsapi TSMgmtError
 TSLifecycleMessage(const char *tag, void const *data, size_t data_size)
 {
@@ -56,6 +56,8 @@ enum class OpType : MgmtMarshallInt {
   LIFECYCLE_MESSAGE,
   HOST_STATUS_UP,
   HOST_STATUS_DOWN,
+  CACHE_SCAN,
+  CACHE_TAG_INVALIDATE,
   UNDEFINED_OP /* This must be last */
 };
 
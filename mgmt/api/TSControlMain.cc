@@ -642,6 +642,54 @@ handle_storage_device_cmd_offline(int fd, void *req, size_t reqlen)
   return send_mgmt_response(fd, OpType::STORAGE_DEVICE_CMD_OFFLINE, &err);
 }
 
+/**************************************************************************
+ * handle_cache_scan
+ *
+ * purpose: handle cache scan command.
+ * output: TS_ERR_xx
+ * note: the scan itself runs in the server, which reports it to a log file
+ *************************************************************************/
+static TSMgmtError
+handle_cache_scan(int fd, void *req, size_t reqlen)
+{
+  MgmtMarshallInt optype;
+  MgmtMarshallString options = nullptr;
+  MgmtMarshallInt err;
+
+  err = recv_mgmt_request(req, reqlen, OpType::CACHE_SCAN, &optype, &options);
+  if (err == TS_ERR_OKAY) {
+    // forward to server
+    lmgmt->signalEvent(MGMT_EVENT_CACHE_SCAN, options);
+  }
+
+  ats_free(options);
+  return send_mgmt_response(fd, OpType::CACHE_SCAN, &err);
+}
+
+/**************************************************************************
+ * handle_cache_tag_invalidate
+ *
+ * purpose: handle cache tag invalidation command.
+ * output: TS_ERR_xx
+ * note: the documents are removed by the server in the background
+ *************************************************************************/
+static TSMgmtError
+handle_cache_tag_invalidate(int fd, void *req, size_t reqlen)
+{
+  MgmtMarshallInt optype;
+  MgmtMarshallString tags = nullptr;
+  MgmtMarshallInt err;
+
+  err = recv_mgmt_request(req, reqlen, OpType::CACHE_TAG_INVALIDATE, &optype, &tags);
+  if (err == TS_ERR_OKAY) {
+    // forward to server
+    lmgmt->signalEvent(MGMT_EVENT_CACHE_TAG_INVALIDATE, tags);
+  }
+
+  ats_free(tags);
+  return send_mgmt_response(fd, OpType::CACHE_TAG_INVALIDATE, &err);
+}
+
 /**************************************************************************
  * handle_event_resolve
  *
@@ -1040,6 +1088,8 @@ static const control_message_handler handlers[] = {
   /* LIFECYCLE_MESSAGE          */ {MGMT_API_PRIVILEGED, handle_lifecycle_message},
   /* HOST_STATUS_UP             */ {MGMT_API_PRIVILEGED, handle_host_status_up},
   /* HOST_STATUS_DOWN           */ {MGMT_API_PRIVILEGED, handle_host_status_down},
+  /* CACHE_SCAN                 */ {MGMT_API_PRIVILEGED, handle_cache_scan},
+  /* CACHE_TAG_INVALIDATE       */ {MGMT_API_PRIVILEGED, handle_cache_tag_invalidate},
 };
 
 // This should use countof(), but we need a constexpr :-/
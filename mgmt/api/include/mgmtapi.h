@@ -144,6 +144,7 @@ typedef enum {
 typedef enum {
   TS_RESTART_OPT_NONE  = 0x0,
   TS_RESTART_OPT_DRAIN = 0x02, /* Wait for traffic to drain before restarting. */
+  TS_RESTART_OPT_HOT   = 0x04, /* Start the new traffic_server while the old one drains. */
 } TSRestartOptionT;
 
 typedef enum {
@@ -379,6 +380,18 @@ tsapi TSMgmtError TSDrain(unsigned options);
  */
 tsapi TSMgmtError TSStorageDeviceCmdOffline(const char *dev);
 
+/* TSCacheScan: Request a scan of the cache, reported by the server to cache_scan.log.
+ * @arg options The filters of the scan, a "name=value" line each.
+ * @return Success.
+ */
+tsapi TSMgmtError TSCacheScan(const char *options);
+
+/* TSCacheTagInvalidate: Remove the documents of tags of proxy.config.cache.tag_index.header from the cache.
+ * @arg tags The tags to invalidate, one per line.
+ * @return Success.
+ */
+tsapi TSMgmtError TSCacheTagInvalidate(const char *tags);
+
 /* TSLifecycleMessage: Send a lifecycle message to the plugins.
  * @arg tag Alert tag string (null-terminated)
  * @return Success
@@ -28,6 +28,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <deque>
 #include <cinttypes>
 #include <string_view>
 #include <array>
@@ -55,12 +57,19 @@ static const std::array<const std::string_view, 6> FILTER_HEADERS{
 // Hold the global background fetch state. This is currently shared across all
 // configurations, as a singleton. ToDo: Would it ever make sense to do this
 // per remap rule? Maybe for per-remap logging ??
-typedef std::unordered_map<std::string, bool> OutstandingRequests;
+//
+// The outstanding URLs are spread over shards, each with its own lock, so that
+// the check for a fetch already in progress does not serialize all the
+// transactions. The origins are a map of the fetches running to each origin,
+// and of those waiting for one of them to finish.
+typedef std::unordered_set<std::string> OutstandingRequests;
+
+struct BgFetchData;
 
 class BgFetchState
 {
 public:
-  BgFetchState()                     = default;
+  BgFetchState();
   BgFetchState(BgFetchState const &) = delete;
   void operator=(BgFetchState const &) = delete;
 
@@ -71,7 +80,13 @@ public:
     return _instance;
   }
 
-  ~BgFetchState() { TSMutexDestroy(_lock); }
+  ~BgFetchState()
+  {
+    for (auto &shard : _shards) {
+      TSMutexDestroy(shard.lock);
+    }
+    TSMutexDestroy(_origins_lock);
+  }
 
   void
   createLog(const std::string &log_name)
@@ -93,18 +108,17 @@ public:
   bool
   acquire(const std::string &url)
   {
+    UrlShard &shard = getShard(url);
     bool ret;
 
-    TSMutexLock(_lock);
-    if (_urls.end() == _urls.find(url)) {
-      _urls[url] = true;
-      ret        = true;
-    } else {
-      ret = false;
-    }
-    TSMutexUnlock(_lock);
+    TSMutexLock(shard.lock);
+    ret = shard.urls.insert(url).second;
+    TSMutexUnlock(shard.lock);
 
     TSDebug(PLUGIN_NAME, "BgFetchState.acquire(): ret = %d, url = %s", ret, url.c_str());
+    if (!ret) {
+      TSStatIntIncrement(_stat_deduplicated, 1);
+    }
 
     return ret;
   }
@@ -112,32 +126,92 @@ public:
   bool
   release(const std::string &url)
   {
+    UrlShard &shard = getShard(url);
     bool ret;
 
-    TSMutexLock(_lock);
-    if (_urls.end() == _urls.find(url)) {
-      ret = false;
-    } else {
-      _urls.erase(url);
-      ret = true;
-    }
-    TSMutexUnlock(_lock);
+    TSMutexLock(shard.lock);
+    ret = shard.urls.erase(url) > 0;
+    TSMutexUnlock(shard.lock);
 
     return ret;
   }
 
+  // Start the fetch, or queue it when its origin is at the limit. False if the
+  // queue is full, and the fetch is dropped.
+  bool admit(BgFetchData *data);
+
+  // A fetch that was admitted is done, the next one waiting for its origin starts.
+  void finish(const std::string &origin);
+
+  void
+  countRetry()
+  {
+    TSStatIntIncrement(_stat_retried, 1);
+  }
+
 private:
-  OutstandingRequests _urls;
-  TSTextLogObject _log = nullptr;
-  TSMutex _lock        = TSMutexCreate();
+  static constexpr size_t URL_SHARDS = 64;
+
+  struct UrlShard {
+    TSMutex lock = TSMutexCreate();
+    OutstandingRequests urls;
+  };
+
+  struct Origin {
+    int active = 0;
+    std::deque<BgFetchData *> waiting;
+  };
+
+  UrlShard &
+  getShard(const std::string &url)
+  {
+    return _shards[std::hash<std::string>()(url) % URL_SHARDS];
+  }
+
+  std::array<UrlShard, URL_SHARDS> _shards;
+  std::unordered_map<std::string, Origin> _origins;
+  int _queued           = 0;
+  TSMutex _origins_lock = TSMutexCreate();
+  TSTextLogObject _log  = nullptr;
+
+  int _stat_started      = -1;
+  int _stat_queued       = -1;
+  int _stat_dropped      = -1;
+  int _stat_retried      = -1;
+  int _stat_deduplicated = -1;
 };
 
+static int
+create_stat(const char *name)
+{
+  std::string stat_name = std::string("plugin.") + PLUGIN_NAME + "." + name;
+  int stat_id           = -1;
+
+  if (TS_ERROR == TSStatFindName(stat_name.c_str(), &stat_id)) {
+    stat_id = TSStatCreate(stat_name.c_str(), TS_RECORDDATATYPE_INT, TS_STAT_NON_PERSISTENT, TS_STAT_SYNC_SUM);
+    if (TS_ERROR == stat_id) {
+      TSError("[%s] Failed to create stat %s", PLUGIN_NAME, stat_name.c_str());
+    }
+  }
+
+  return stat_id;
+}
+
+BgFetchState::BgFetchState()
+{
+  _stat_started      = create_stat("started");
+  _stat_queued       = create_stat("queued");
+  _stat_dropped      = create_stat("dropped");
+  _stat_retried      = create_stat("retried");
+  _stat_deduplicated = create_stat("deduplicated");
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Hold and manage some state for the TXN background fetch continuation.
 // This is necessary, because the TXN is likely to not be available
 // during the time we fetch from origin.
 struct BgFetchData {
-  BgFetchData() { memset(&client_ip, 0, sizeof(client_ip)); }
+  explicit BgFetchData(const BgFetchLimits &limits) : limits(limits) { memset(&client_ip, 0, sizeof(client_ip)); }
 
   ~BgFetchData()
   {
@@ -155,6 +229,9 @@ struct BgFetchData {
     // If we got schedule, also clean that up
     if (_cont) {
       releaseUrl();
+      if (admitted) {
+        BgFetchState::getInstance().finish(_origin);
+      }
 
       TSContDestroy(_cont);
       _cont = nullptr;
@@ -182,6 +259,12 @@ struct BgFetchData {
     return _url.c_str();
   }
 
+  const std::string &
+  getOrigin() const
+  {
+    return _origin;
+  }
+
   void
   addBytes(int64_t b)
   {
@@ -189,9 +272,14 @@ struct BgFetchData {
   }
 
   bool initialize(TSMBuffer request, TSMLoc req_hdr, TSHttpTxn txnp);
-  void schedule();
+  bool schedule();
+  void start();
+  bool retry();
   void log(TSEvent event) const;
 
+  const BgFetchLimits limits;
+  bool admitted = false; // counted against the limit of the origin
+
   TSMBuffer mbuf = TSMBufferCreate();
   TSMLoc hdr_loc = TS_NULL_MLOC;
   TSMLoc url_loc = TS_NULL_MLOC;
@@ -209,7 +297,9 @@ struct BgFetchData {
 
 private:
   std::string _url;
+  std::string _origin;
   int64_t _bytes = 0;
+  int _attempts  = 0;
   TSCont _cont   = nullptr;
 };
 
@@ -276,6 +366,8 @@ BgFetchData::initialize(TSMBuffer request, TSMLoc req_hdr, TSHttpTxn txnp)
             if (set_header(mbuf, hdr_loc, TS_MIME_FIELD_HOST, TS_MIME_LEN_HOST, hostp, len)) {
               TSDebug(PLUGIN_NAME, "Set header Host: %.*s", len, hostp);
             }
+            _origin.assign(hostp, len);
+            _origin.append(":").append(std::to_string(TSUrlPortGet(mbuf, url_loc)));
 
             // Next, remove the Range headers and IMS (conditional) headers from the request
             for (auto const &header : FILTER_HEADERS) {
@@ -298,8 +390,9 @@ BgFetchData::initialize(TSMBuffer request, TSMLoc req_hdr, TSHttpTxn txnp)
 
 static int cont_bg_fetch(TSCont contp, TSEvent event, void *edata);
 
-// Create, setup and schedule the background fetch continuation.
-void
+// Create, setup and schedule the background fetch continuation. False if the
+// fetch was dropped, for its origin is busy and the queue is full.
+bool
 BgFetchData::schedule()
 {
   TSAssert(nullptr == _cont);
@@ -314,10 +407,99 @@ BgFetchData::schedule()
   resp_io_buf        = TSIOBufferCreate();
   resp_io_buf_reader = TSIOBufferReaderAlloc(resp_io_buf);
 
-  // Schedule
+  return BgFetchState::getInstance().admit(this);
+}
+
+void
+BgFetchData::start()
+{
   TSContScheduleOnPool(_cont, 0, TS_THREAD_POOL_NET);
 }
 
+// Schedule the fetch again after a failure, with a backoff of a second that
+// doubles with each attempt. False if it is out of retries.
+bool
+BgFetchData::retry()
+{
+  if (_attempts >= limits.retries) {
+    return false;
+  }
+
+  TSIOBufferReaderConsume(req_io_buf_reader, TSIOBufferReaderAvail(req_io_buf_reader));
+  TSIOBufferReaderConsume(resp_io_buf_reader, TSIOBufferReaderAvail(resp_io_buf_reader));
+  r_vio  = nullptr;
+  w_vio  = nullptr;
+  _bytes = 0;
+
+  TSHRTime delay = 1000 << _attempts++;
+  TSDebug(PLUGIN_NAME, "Retrying background fetch in %" PRId64 "ms, url = %s", delay, _url.c_str());
+  BgFetchState::getInstance().countRetry();
+  TSContScheduleOnPool(_cont, delay, TS_THREAD_POOL_NET);
+
+  return true;
+}
+
+bool
+BgFetchState::admit(BgFetchData *data)
+{
+  bool start = true;
+
+  if (data->limits.max_per_origin > 0) {
+    TSMutexLock(_origins_lock);
+    Origin &origin = _origins[data->getOrigin()];
+
+    if (origin.active < data->limits.max_per_origin) {
+      ++origin.active;
+    } else if (_queued < data->limits.queue_size) {
+      origin.waiting.push_back(data);
+      ++_queued;
+      start = false;
+    } else {
+      TSMutexUnlock(_origins_lock);
+      TSDebug(PLUGIN_NAME, "Dropped background fetch, the queue is full, url = %s", data->getUrl());
+      TSStatIntIncrement(_stat_dropped, 1);
+      return false;
+    }
+    data->admitted = true;
+    TSMutexUnlock(_origins_lock);
+  }
+
+  if (start) {
+    TSStatIntIncrement(_stat_started, 1);
+    data->start();
+  } else {
+    TSDebug(PLUGIN_NAME, "Queued background fetch for %s, url = %s", data->getOrigin().c_str(), data->getUrl());
+    TSStatIntIncrement(_stat_queued, 1);
+  }
+
+  return true;
+}
+
+void
+BgFetchState::finish(const std::string &origin)
+{
+  BgFetchData *next = nullptr;
+
+  TSMutexLock(_origins_lock);
+  auto it = _origins.find(origin);
+  if (it != _origins.end()) {
+    if (!it->second.waiting.empty()) {
+      // the next fetch takes over the slot
+      next = it->second.waiting.front();
+      it->second.waiting.pop_front();
+      --_queued;
+    } else if (--it->second.active <= 0) {
+      _origins.erase(it);
+    }
+  }
+  TSMutexUnlock(_origins_lock);
+
+  if (next) {
+    TSStatIntIncrement(_stat_started, 1);
+    next->start();
+  }
+}
+
 // Log format is:
 //    remap-tag bytes status url
 void
@@ -399,8 +581,10 @@ cont_bg_fetch(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
       data->r_vio = TSVConnRead(data->vc, contp, data->resp_io_buf, INT64_MAX);
       data->w_vio = TSVConnWrite(data->vc, contp, data->req_io_buf_reader, TSIOBufferReaderAvail(data->req_io_buf_reader));
     } else {
-      delete data;
       TSError("[%s] Failed to connect to internal process, major malfunction", PLUGIN_NAME);
+      if (!data->retry()) {
+        delete data;
+      }
     }
     break;
 
@@ -436,8 +620,11 @@ cont_bg_fetch(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
     TSVIONDoneSet(data->r_vio, TSVIONDoneGet(data->r_vio) + avail);
     data->log(event);
 
-    // Close, release and cleanup
+    // Close, release and cleanup, unless a fetch that failed is tried again
     data->vc = nullptr;
+    if ((TS_EVENT_VCONN_INACTIVITY_TIMEOUT == event || TS_EVENT_ERROR == event) && data->retry()) {
+      break;
+    }
     delete data;
     break;
 
@@ -457,8 +644,8 @@ cont_bg_fetch(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
 static int
 cont_check_cacheable(TSCont contp, TSEvent /* event ATS_UNUSED */, void *edata)
 {
-  // ToDo: If we want to support per-remap configurations, we have to pass along the data here
-  TSHttpTxn txnp = static_cast<TSHttpTxn>(edata);
+  TSHttpTxn txnp              = static_cast<TSHttpTxn>(edata);
+  const BgFetchConfig *config = static_cast<const BgFetchConfig *>(TSContDataGet(contp));
   TSMBuffer response, request;
   TSMLoc resp_hdr, req_hdr;
 
@@ -471,13 +658,12 @@ cont_check_cacheable(TSCont contp, TSEvent /* event ATS_UNUSED */, void *edata)
 
       TSDebug(PLUGIN_NAME, "Testing: request / response is cacheable?");
       if (cacheable) {
-        BgFetchData *data = new BgFetchData();
+        BgFetchData *data = new BgFetchData(config->limits());
 
-        // Initialize the data structure (can fail) and acquire a privileged lock on the URL
-        if (data->initialize(request, req_hdr, txnp) && data->acquireUrl()) {
-          data->schedule();
-        } else {
-          delete data; // Not sure why this would happen, but ok.
+        // Initialize the data structure (can fail), acquire a privileged lock on the URL, and
+        // start or queue the fetch (dropped when the queue is full).
+        if (!(data->initialize(request, req_hdr, txnp) && data->acquireUrl() && data->schedule())) {
+          delete data;
         }
       }
       // Release the request MLoc
@@ -533,6 +719,7 @@ cont_handle_response(TSCont contp, TSEvent event, void *edata)
             // Everything looks good so far, add a TXN hook for SEND_RESPONSE_HDR
             TSCont localcontp = TSContCreate(cont_check_cacheable, nullptr);
 
+            TSContDataSet(localcontp, config);
             TSHttpTxnHookAdd(txnp, TS_HTTP_SEND_RESPONSE_HDR_HOOK, localcontp);
           }
           // Release the response MLoc
@@ -571,6 +758,8 @@ TSPluginInit(int argc, const char *argv[])
 
   gConfig = new BgFetchConfig(cont);
 
+  // The state creates the stats, at initialization.
+  BgFetchState::getInstance();
   if (gConfig->parseOptions(argc, argv)) {
     // Create the global log file. Note that calling this multiple times currently has no
     // effect, only one log file is ever created. The BgFetchState is a singleton.
@@ -619,6 +808,8 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf */, int /
   BgFetchConfig *config = new BgFetchConfig(cont);
   bool success          = true;
 
+  BgFetchState::getInstance();
+
   // The first two arguments are the "from" and "to" URL string. We need to
   // skip them, but we also require that there be an option to masquerade as
   // argv[0], so we increment the argument indexes by 1 rather than by 2.
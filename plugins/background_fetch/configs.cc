@@ -25,6 +25,7 @@
 #include <getopt.h>
 #include <cstdio>
 #include <memory.h>
+#include <algorithm>
 
 #include "configs.h"
 
@@ -37,8 +38,12 @@ BgFetchConfig::parseOptions(int argc, const char *argv[])
   static const struct option longopt[] = {{const_cast<char *>("log"), required_argument, nullptr, 'l'},
                                           {const_cast<char *>("config"), required_argument, nullptr, 'c'},
                                           {const_cast<char *>("allow-304"), no_argument, nullptr, 'a'},
+                                          {const_cast<char *>("max-per-origin"), required_argument, nullptr, 'o'},
+                                          {const_cast<char *>("queue-size"), required_argument, nullptr, 'q'},
+                                          {const_cast<char *>("retries"), required_argument, nullptr, 'r'},
                                           {nullptr, no_argument, nullptr, '\0'}};
 
+  optind = 0; // a new scan for each instance
   while (true) {
     int opt = getopt_long(argc, const_cast<char *const *>(argv), "lc", longopt, nullptr);
 
@@ -62,6 +67,18 @@ BgFetchConfig::parseOptions(int argc, const char *argv[])
       TSDebug(PLUGIN_NAME, "option: --allow-304 set");
       _allow_304 = true;
       break;
+    case 'o':
+      TSDebug(PLUGIN_NAME, "option: --max-per-origin %s", optarg);
+      _limits.max_per_origin = std::max(atoi(optarg), 0);
+      break;
+    case 'q':
+      TSDebug(PLUGIN_NAME, "option: --queue-size %s", optarg);
+      _limits.queue_size = std::max(atoi(optarg), 0);
+      break;
+    case 'r':
+      TSDebug(PLUGIN_NAME, "option: --retries %s", optarg);
+      _limits.retries = std::clamp(atoi(optarg), 0, BgFetchLimits::MAX_RETRIES);
+      break;
     default:
       TSError("[%s] invalid plugin option: %c", PLUGIN_NAME, opt);
       return false;
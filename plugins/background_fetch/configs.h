@@ -33,6 +33,18 @@
 // Constants
 const char PLUGIN_NAME[] = "background_fetch";
 
+///////////////////////////////////////////////////////////////////////////
+// Limits on the background fetches of a rule. A fetch takes a copy of these,
+// it can outlive its rule.
+//
+struct BgFetchLimits {
+  static constexpr int MAX_RETRIES = 10;
+
+  int max_per_origin = 0; // concurrent fetches to an origin, 0 is no limit
+  int queue_size     = 0; // fetches waiting for their origin, over all origins
+  int retries        = 0; // of a fetch that failed, each after twice the delay of the last
+};
+
 ///////////////////////////////////////////////////////////////////////////
 // This holds one complete background fetch rule
 //
@@ -75,6 +87,12 @@ public:
     return _allow_304;
   }
 
+  const BgFetchLimits &
+  limits() const
+  {
+    return _limits;
+  }
+
   // This parses and populates the BgFetchRule linked list (_rules).
   bool readConfig(const char *file_name);
 
@@ -84,5 +102,6 @@ private:
   TSCont _cont        = nullptr;
   BgFetchRule *_rules = nullptr;
   bool _allow_304     = false;
+  BgFetchLimits _limits;
   std::string _log_file;
 };
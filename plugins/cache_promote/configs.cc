@@ -19,6 +19,7 @@
 
 #include "configs.h"
 #include "lru_policy.h"
+#include "sketch_policy.h"
 #include "chance_policy.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -28,7 +29,7 @@ static const struct option longopt[] = {
   {const_cast<char *>("policy"), required_argument, nullptr, 'p'},
   // This is for both Chance and LRU (optional) policy
   {const_cast<char *>("sample"), required_argument, nullptr, 's'},
-  // For the LRU policy
+  // For the LRU and sketch policies
   {const_cast<char *>("buckets"), required_argument, nullptr, 'b'},
   {const_cast<char *>("hits"), required_argument, nullptr, 'h'},
   {const_cast<char *>("stats-enable-with-id"), required_argument, nullptr, 'e'},
@@ -57,6 +58,8 @@ PromotionConfig::factory(int argc, char *argv[])
         _policy = new ChancePolicy();
       } else if (0 == strncasecmp(optarg, "lru", 3)) {
         _policy = new LRUPolicy();
+      } else if (0 == strncasecmp(optarg, "sketch", 6)) {
+        _policy = new SketchPolicy();
       } else {
         TSError("[%s] Unknown policy --policy=%s", PLUGIN_NAME, optarg);
         return false;
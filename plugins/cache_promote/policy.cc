@@ -35,6 +35,30 @@ PromotionPolicy::doSample() const
   return true;
 }
 
+// The cache key URL (for now), since this has better lookup behavior when using e.g.
+// the cachekey plugin. The caller owns it, it's nullptr if there was none.
+char *
+PromotionPolicy::getCacheKeyUrl(TSHttpTxn txnp, int *url_len) const
+{
+  char *url = nullptr;
+  TSMBuffer request;
+  TSMLoc req_hdr;
+
+  if (TS_SUCCESS == TSHttpTxnClientReqGet(txnp, &request, &req_hdr)) {
+    TSMLoc c_url = TS_NULL_MLOC;
+
+    if (TS_SUCCESS == TSUrlCreate(request, &c_url)) {
+      if (TS_SUCCESS == TSHttpTxnCacheLookupUrlGet(txnp, request, c_url)) {
+        url = TSUrlStringGet(request, c_url, url_len);
+        TSHandleMLocRelease(request, TS_NULL_MLOC, c_url);
+      }
+    }
+    TSHandleMLocRelease(request, TS_NULL_MLOC, req_hdr);
+  }
+
+  return url;
+}
+
 int
 PromotionPolicy::create_stat(std::string_view name, std::string_view remap_identifier)
 {
@@ -83,6 +83,7 @@ public:
   }
 
   bool doSample() const;
+  char *getCacheKeyUrl(TSHttpTxn txnp, int *url_len) const;
   int create_stat(std::string_view name, std::string_view remap_identifier);
 
   // These are pure virtual
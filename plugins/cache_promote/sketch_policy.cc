@@ -0,0 +1,216 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+#include <functional>
+#include <string_view>
+
+#include "sketch_policy.h"
+
+#define MINIMUM_SKETCH_BUCKETS 64
+#define MAXIMUM_SKETCH_BUCKETS (1U << 30)
+
+namespace
+{
+// A second hash of the URL, to derive the slots of the rows from
+inline uint64_t
+mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+} // namespace
+
+void
+SketchPolicy::allocate()
+{
+  std::vector<std::atomic<uint8_t>>(ROWS * static_cast<size_t>(_buckets)).swap(_counters);
+  std::vector<std::atomic<uint64_t>>(_buckets / 64).swap(_doorkeeper);
+  _additions = 0;
+}
+
+bool
+SketchPolicy::parseOption(int opt, char *optarg)
+{
+  switch (opt) {
+  case 'b': {
+    unsigned long buckets = strtoul(optarg, nullptr, 10);
+
+    if (buckets < MINIMUM_SKETCH_BUCKETS || buckets > MAXIMUM_SKETCH_BUCKETS) {
+      TSError("%s: Enforcing sketch bucket size between %d and %u", PLUGIN_NAME, MINIMUM_SKETCH_BUCKETS, MAXIMUM_SKETCH_BUCKETS);
+      buckets = buckets < MINIMUM_SKETCH_BUCKETS ? MINIMUM_SKETCH_BUCKETS : MAXIMUM_SKETCH_BUCKETS;
+    }
+    // rounded up to a power of 2, for the slots to be masked
+    _buckets = MINIMUM_SKETCH_BUCKETS;
+    while (_buckets < buckets) {
+      _buckets <<= 1;
+    }
+    TSDebug(PLUGIN_NAME, "sketch of %u buckets", _buckets);
+    allocate();
+  } break;
+  case 'h':
+    _hits = static_cast<unsigned>(strtol(optarg, nullptr, 10));
+    if (_hits > UINT8_MAX) {
+      TSError("%s: Enforcing maximum sketch hits of %d", PLUGIN_NAME, UINT8_MAX);
+      _hits = UINT8_MAX;
+    }
+    break;
+  case 'l':
+    _label = optarg;
+    break;
+  default:
+    // All other options are unsupported for this policy
+    return false;
+  }
+
+  return true;
+}
+
+unsigned
+SketchPolicy::estimate(const uint64_t *slots) const
+{
+  unsigned count = UINT8_MAX;
+
+  for (int row = 0; row < ROWS; ++row) {
+    unsigned n = _counters[row * static_cast<size_t>(_buckets) + slots[row]].load(std::memory_order_relaxed);
+    if (n < count) {
+      count = n;
+    }
+  }
+
+  return count;
+}
+
+// Only the smallest counters of the URL are incremented, the others already count it at least once more.
+void
+SketchPolicy::increment(const uint64_t *slots, unsigned count)
+{
+  if (count >= UINT8_MAX) {
+    return;
+  }
+
+  for (int row = 0; row < ROWS; ++row) {
+    uint8_t expected = count;
+    _counters[row * static_cast<size_t>(_buckets) + slots[row]].compare_exchange_strong(expected, count + 1,
+                                                                                       std::memory_order_relaxed);
+  }
+}
+
+// Halve the counts, and forget which URLs were seen once. Requests racing this only lose a count.
+void
+SketchPolicy::age()
+{
+  TSDebug(PLUGIN_NAME, "aging the sketch of %u buckets", _buckets);
+
+  for (auto &counter : _counters) {
+    counter.store(counter.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+  }
+  for (auto &bits : _doorkeeper) {
+    bits.store(0, std::memory_order_relaxed);
+  }
+  _additions.store(0, std::memory_order_relaxed);
+  incrementStat(aged_id, 1);
+}
+
+bool
+SketchPolicy::doPromote(TSHttpTxn txnp)
+{
+  int url_len = 0;
+  char *url   = getCacheKeyUrl(txnp, &url_len);
+  bool ret    = false;
+
+  // Generally shouldn't happen ...
+  if (!url) {
+    return false;
+  }
+
+  TSDebug(PLUGIN_NAME, "SketchPolicy::doPromote(%.*s%s)", url_len > 100 ? 100 : url_len, url, url_len > 100 ? "..." : "");
+  uint64_t const h1   = std::hash<std::string_view>{}(std::string_view(url, url_len));
+  uint64_t const h2   = mix(h1) | 1;
+  uint64_t const mask = _buckets - 1;
+  uint64_t slots[ROWS + 2];
+
+  TSfree(url);
+
+  // The rows of the sketch, and then the two bits of the doorkeeper
+  for (int i = 0; i < ROWS + 2; ++i) {
+    slots[i] = (h1 + i * h2) & mask;
+  }
+
+  bool seen = true;
+  for (int i = ROWS; i < ROWS + 2; ++i) {
+    uint64_t const bit = static_cast<uint64_t>(1) << (slots[i] & 63);
+    if (!(_doorkeeper[slots[i] >> 6].fetch_or(bit, std::memory_order_relaxed) & bit)) {
+      seen = false;
+    }
+  }
+
+  if (!seen) {
+    // The first request of the URL, only the doorkeeper knows about it
+    incrementStat(doorkeeper_miss_id, 1);
+  } else {
+    incrementStat(doorkeeper_hit_id, 1);
+    increment(slots, estimate(slots));
+
+    // The doorkeeper counts the first request
+    unsigned count = estimate(slots) + 1;
+    TSDebug(PLUGIN_NAME, "%u requests of the URL so far", count);
+    if (count >= _hits) {
+      incrementStat(promoted_id, 1);
+      ret = true;
+    }
+  }
+
+  if (_additions.fetch_add(1, std::memory_order_relaxed) + 1 == 10 * static_cast<uint64_t>(_buckets)) {
+    age();
+  }
+
+  return ret;
+}
+
+bool
+SketchPolicy::stats_add(const char *remap_id)
+
+{
+  std::string_view remap_identifier                 = remap_id;
+  const std::tuple<std::string_view, int *> stats[] = {
+    {"cache_hits", &cache_hits_id},
+    {"doorkeeper_hit", &doorkeeper_hit_id},
+    {"doorkeeper_miss", &doorkeeper_miss_id},
+    {"sketch_aged", &aged_id},
+    {"promoted", &promoted_id},
+    {"total_requests", &total_requests_id},
+  };
+
+  if (nullptr == remap_id) {
+    TSError("[%s] no remap identifier specified for for stats, no stats will be used", PLUGIN_NAME);
+    return false;
+  }
+
+  for (const auto &stat : stats) {
+    std::string_view name = std::get<0>(stat);
+    int *id               = std::get<1>(stat);
+    if ((*(id) = create_stat(name, remap_identifier)) == TS_ERROR) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,83 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "policy.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// The sketch based policy counts the URLs in a count-min sketch of <buckets> counters per row,
+// rather than keeping each of them, and promotes a URL once its count reaches <hits>. The
+// first request of a URL only sets it in a Bloom filter, the doorkeeper, so that the long tail
+// of URLs seen once does not fill the sketch. All the counts are halved, and the doorkeeper is
+// cleared, every 10 * <buckets> requests counted, so that what was popular is forgotten.
+//
+// The memory is fixed, 4 bytes per bucket and a bit per bucket for the doorkeeper, and the
+// counters are updated with atomics, without a lock.
+//
+class SketchPolicy : public PromotionPolicy
+{
+public:
+  SketchPolicy() : PromotionPolicy() { allocate(); }
+
+  bool parseOption(int opt, char *optarg) override;
+  bool doPromote(TSHttpTxn txnp) override;
+  bool stats_add(const char *remap_id) override;
+
+  void
+  usage() const override
+  {
+    TSError("[%s] Usage: @plugin=%s.so @pparam=--policy=sketch @pparam=--buckets=<n> --hits=<m> --sample=<x>", PLUGIN_NAME,
+            PLUGIN_NAME);
+  }
+
+  const char *
+  policyName() const override
+  {
+    return "sketch";
+  }
+
+  const std::string
+  id() const override
+  {
+    return _label + ";sketch=b:" + std::to_string(_buckets) + ",h:" + std::to_string(_hits);
+  }
+
+private:
+  static constexpr int ROWS = 4;
+
+  void allocate();
+  unsigned estimate(const uint64_t *slots) const;
+  void increment(const uint64_t *slots, unsigned count);
+  void age();
+
+  unsigned _buckets = 1 << 16; // counters per row, a power of 2
+  unsigned _hits    = 10;
+
+  std::vector<std::atomic<uint8_t>> _counters;    // ROWS rows of _buckets counters
+  std::vector<std::atomic<uint64_t>> _doorkeeper; // _buckets bits
+  std::atomic<uint64_t> _additions{0};            // requests counted since the last aging
+
+  // internal stats ids
+  int doorkeeper_hit_id  = -1;
+  int doorkeeper_miss_id = -1;
+  int aged_id            = -1;
+};
@@ -21,30 +21,54 @@
  * @brief Cache key manipulation.
  */
 
-#include <cstring> /* strlen() */
-#include <sstream> /* istringstream */
+#include <algorithm> /* std::sort(), std::unique() */
+#include <cstring>   /* strlen() */
+#include <sstream>   /* istringstream */
 #include <utility>
 #include "cachekey.h"
 
+void
+KeyBuffer::grow(size_t n)
+{
+  size_t capacity = std::max(2 * (_capacity + 1), _size + n + 1);
+  if (nullptr != _txn) {
+    /* The previous buffer stays in the arena until the transaction ends, with the key. */
+    char *data = static_cast<char *>(TSHttpTxnArenaAlloc(_txn, capacity));
+    memcpy(data, _data, _size + 1);
+    _data = data;
+  } else {
+    std::unique_ptr<char[]> heap(new char[capacity]);
+    memcpy(heap.get(), _data, _size + 1);
+    _heap = std::move(heap);
+    _data = _heap.get();
+  }
+  _capacity = capacity - 1;
+}
+
 static void
-append(String &target, unsigned n)
+append(KeyBuffer &target, unsigned n)
 {
+  char *dst = target.reserve(sizeof("4294967295") - 1);
   char buf[sizeof("4294967295")];
-  snprintf(buf, sizeof(buf), "%u", n);
-  target.append(buf);
+  char *p = buf + sizeof(buf);
+  do {
+    *--p = '0' + n % 10;
+    n /= 10;
+  } while (0 != n);
+  size_t len = buf + sizeof(buf) - p;
+  memcpy(dst, p, len);
+  target.commit(len);
 }
 
 static void
-appendEncoded(String &target, const char *s, size_t len)
+appendEncoded(KeyBuffer &target, const char *s, size_t len)
 {
   if (0 == len) {
     return;
   }
 
-  char tmp[len * 2];
-  size_t written;
-
-  /* The default table does not encode the comma, so we need to use our own table here. */
+  /* The default table does not encode the comma, so we need to use our own table here.
+   * Same encoding as TSStringPercentEncode() with it, done in one pass right into the key. */
   static const unsigned char map[32] = {
     0xFF, 0xFF, 0xFF,
     0xFF,       // control
@@ -67,13 +91,21 @@ appendEncoded(String &target, const char *s, size_t len)
     0x00 //               .
   };
 
-  if (TSStringPercentEncode(s, len, tmp, sizeof(tmp), &written, map) == TS_SUCCESS) {
-    target.append(tmp, written);
-  } else {
-    /* If the encoding fails (pretty unlikely), then just append what we have.
-     * This is just a best-effort encoding anyway. */
-    target.append(s, len);
+  static const char hex[] = "0123456789ABCDEF";
+
+  char *start = target.reserve(len * 3);
+  char *dst   = start;
+  for (const char *end = s + len; s < end; ++s) {
+    unsigned char c = *s;
+    if (map[c / 8] & (1 << (7 - c % 8))) {
+      *dst++ = '%';
+      *dst++ = hex[c / 16];
+      *dst++ = hex[c % 16];
+    } else {
+      *dst++ = c;
+    }
   }
+  target.commit(dst - start);
 }
 
 template <typename ContainerType, typename Iterator>
@@ -88,36 +120,51 @@ containerToString(ContainerType &c, const String &sdelim, const String &delim)
   return result;
 }
 
-static void
-appendToContainer(StringSet &c, const String &s)
-{
-  c.insert(s);
-}
+/* Query parameters are kept on the stack, only a query with more of them than that uses the heap. */
+static constexpr size_t QUERY_PARAMS_INLINE = 32;
 
+/**
+ * @brief Append the query parameters to be added to the key, in the order of the query or sorted and unique.
+ *
+ * The parameters are views of the query, split on '&' as std::getline() would, to keep the keys as they have been.
+ */
 static void
-appendToContainer(StringList &c, const String &s)
+appendKeyQuery(KeyBuffer &key, StringView query, const ConfigQuery &config)
 {
-  c.push_back(s);
-}
+  StringView inlineParams[QUERY_PARAMS_INLINE];
+  std::vector<StringView> moreParams;
+  StringView *params = inlineParams;
 
-template <typename T>
-static String
-getKeyQuery(const char *query, int length, const ConfigQuery &config)
-{
-  std::istringstream istr(String(query, length));
-  String token;
-  T container;
+  size_t count = std::count(query.begin(), query.end(), '&') + 1;
+  if (count > QUERY_PARAMS_INLINE) {
+    moreParams.resize(count);
+    params = moreParams.data();
+  }
 
-  while (std::getline(istr, token, '&')) {
-    String::size_type pos(token.find_first_of('='));
-    String param(token.substr(0, pos == String::npos ? token.size() : pos));
+  size_t n = 0;
+  for (StringView::size_type start = 0; start < query.size();) {
+    StringView::size_type end = query.find('&', start);
+    if (StringView::npos == end) {
+      end = query.size();
+    }
+    StringView token = query.substr(start, end - start);
+    StringView param = token.substr(0, token.find('='));
 
     if (config.toBeAdded(param)) {
-      ::appendToContainer(container, token);
+      params[n++] = token;
     }
+    start = end + 1;
+  }
+
+  if (config.toBeSorted()) {
+    std::sort(params, params + n);
+    n = std::unique(params, params + n) - params;
   }
 
-  return containerToString<T, typename T::const_iterator>(container, "?", "&");
+  for (size_t i = 0; i < n; ++i) {
+    key.append(0 == i ? "?" : "&", 1);
+    key.append(params[i]);
+  }
 }
 
 static void
@@ -188,49 +235,55 @@ getUri(TSMBuffer buf, TSMLoc url)
   return uri;
 }
 
-static String
-getCanonicalUrl(TSMBuffer buf, TSMLoc url, bool canonicalPrefix, bool provideDefaultKey)
+/**
+ * @brief Append the scheme and authority of the URI to @a target, as the default key prefix or the input of the prefix captures.
+ */
+static void
+appendCanonicalUrl(KeyBuffer &target, TSMBuffer buf, TSMLoc url, bool canonicalPrefix, bool provideDefaultKey)
 {
-  String canonicalUrl;
-
-  String scheme;
   int schemeLen;
   const char *schemePtr = TSUrlSchemeGet(buf, url, &schemeLen);
-  if (nullptr != schemePtr && 0 != schemeLen) {
-    scheme.assign(schemePtr, schemeLen);
-  } else {
+  if (nullptr == schemePtr || 0 == schemeLen) {
     CacheKeyError("failed to get scheme");
-    return canonicalUrl;
+    return;
   }
 
-  String host;
   int hostLen;
   const char *hostPtr = TSUrlHostGet(buf, url, &hostLen);
-  if (nullptr != hostPtr && 0 != hostLen) {
-    host.assign(hostPtr, hostLen);
-  } else {
+  if (nullptr == hostPtr || 0 == hostLen) {
     CacheKeyError("failed to get host");
-    return canonicalUrl;
+    return;
   }
 
-  String port;
-  int portInt = TSUrlPortGet(buf, url);
-  ::append(port, portInt);
+  unsigned port = TSUrlPortGet(buf, url);
 
   if (canonicalPrefix) {
-    /* return the same for both regex input or default key, results in 'scheme://host:port' */
-    canonicalUrl.assign(scheme).append("://").append(host).append(":").append(port);
+    /* the same for both regex input or default key, results in 'scheme://host:port' */
+    target.append(schemePtr, schemeLen);
+    target.append("://", 3);
+    target.append(hostPtr, hostLen);
+    target.append(":", 1);
   } else {
     if (provideDefaultKey) {
-      /* return the key default - results in '/host/port' */
-      canonicalUrl.assign("/").append(host).append("/").append(port);
+      /* the key default - results in '/host/port' */
+      target.append("/", 1);
+      target.append(hostPtr, hostLen);
+      target.append("/", 1);
     } else {
-      /* return regex input string - results in 'host:port' (use-case kept for compatibility reasons) */
-      canonicalUrl.assign(host).append(":").append(port);
+      /* regex input string - results in 'host:port' (use-case kept for compatibility reasons) */
+      target.append(hostPtr, hostLen);
+      target.append(":", 1);
     }
   }
+  ::append(target, port);
+}
 
-  return canonicalUrl;
+static String
+getCanonicalUrl(TSMBuffer buf, TSMLoc url, bool canonicalPrefix, bool provideDefaultKey)
+{
+  KeyBuffer canonicalUrl;
+  appendCanonicalUrl(canonicalUrl, buf, url, canonicalPrefix, provideDefaultKey);
+  return String(canonicalUrl.c_str(), canonicalUrl.size());
 }
 
 /**
@@ -241,10 +294,8 @@ getCanonicalUrl(TSMBuffer buf, TSMLoc url, bool canonicalPrefix, bool provideDef
  * @param rri remap request info
  */
 CacheKey::CacheKey(TSHttpTxn txn, String separator, CacheKeyUriType uriType, CacheKeyKeyType keyType, TSRemapRequestInfo *rri)
-  : _txn(txn), _separator(std::move(separator)), _uriType(uriType), _keyType(keyType)
+  : _txn(txn), _key(txn), _separator(std::move(separator)), _uriType(uriType), _keyType(keyType)
 {
-  _key.reserve(512);
-
   _remap = (nullptr != rri);
 
   /* Get the URI and header to base the cachekey on.
@@ -259,11 +310,9 @@ CacheKey::CacheKey(TSHttpTxn txn, String separator, CacheKeyUriType uriType, Cac
         CacheKeyError("failed to get pristine URI handle");
         return;
       }
-      CacheKeyDebug("using pristine uri '%s'", getUri(_buf, _url).c_str());
     } else {
       _buf = rri->requestBufp;
       _url = rri->requestUrl;
-      CacheKeyDebug("using remap uri '%s'", getUri(_buf, _url).c_str());
     }
     _hdrs = rri->requestHdrp;
   } else {
@@ -279,17 +328,21 @@ CacheKey::CacheKey(TSHttpTxn txn, String separator, CacheKeyUriType uriType, Cac
         CacheKeyError("failed to get pristine URI handle");
         return;
       }
-      CacheKeyDebug("using pristine uri '%s'", getUri(_buf, _url).c_str());
     } else {
       if (TS_SUCCESS != TSHttpHdrUrlGet(_buf, _hdrs, &_url)) {
         TSHandleMLocRelease(_buf, TS_NULL_MLOC, _hdrs);
         CacheKeyError("failed to get URI handle");
         return;
       }
-      CacheKeyDebug("using post-remap uri '%s','", getUri(_buf, _url).c_str());
     }
   }
   _valid = true; /* success, we got all necessary elements - URI, headers, etc. */
+
+  if (TSIsDebugTagSet(PLUGIN_NAME)) {
+    /* Getting the URI string is expensive, only do it for the debug log. */
+    CacheKeyDebug("using %s uri '%s'", PRISTINE == _uriType ? "pristine" : (_remap ? "remap" : "post-remap"),
+                  getUri(_buf, _url).c_str());
+  }
 }
 
 CacheKey::~CacheKey()
@@ -328,14 +381,14 @@ CacheKey::append(unsigned n)
  * @param s string
  */
 void
-CacheKey::append(const String &s)
+CacheKey::append(StringView s)
 {
   _key.append(_separator);
   ::appendEncoded(_key, s.data(), s.size());
 }
 
 void
-CacheKey::append(const String &s, bool useSeparator)
+CacheKey::append(StringView s, bool useSeparator)
 {
   if (useSeparator) {
     append(s);
@@ -420,8 +473,8 @@ CacheKey::appendPrefix(const String &prefix, Pattern &prefixCapture, Pattern &pr
   }
 
   if (!customPrefix) {
-    /* nothing was customized => default prefix */
-    append(getCanonicalUrl(_buf, _url, canonicalPrefix, /* provideDefaultKey */ true), /* useSeparator */ false);
+    /* nothing was customized => default prefix, written right into the key */
+    appendCanonicalUrl(_key, _buf, _url, canonicalPrefix, /* provideDefaultKey */ true);
     CacheKeyDebug("added default prefix, key: '%s'", _key.c_str());
   }
 }
@@ -439,12 +492,12 @@ CacheKey::appendPath(Pattern &pathCapture, Pattern &pathCaptureUri)
 {
   // "true" would mean that the plugin config meant to override the default path.
   bool customPath = false;
-  String path;
+  StringView path;
 
   int pathLen;
   const char *pathPtr = TSUrlPathGet(_buf, _url, &pathLen);
   if (nullptr != pathPtr && 0 != pathLen) {
-    path.assign(pathPtr, pathLen);
+    path = StringView(pathPtr, pathLen);
   }
 
   if (!pathCaptureUri.empty()) {
@@ -468,7 +521,7 @@ CacheKey::appendPath(Pattern &pathCapture, Pattern &pathCaptureUri)
     // If path is empty don't even try to capture/replace.
     if (!path.empty()) {
       StringVector captures;
-      if (pathCapture.process(path, captures)) {
+      if (pathCapture.process(String(path), captures)) {
         for (auto &capture : captures) {
           append(capture);
         }
@@ -654,23 +707,13 @@ CacheKey::appendQuery(const ConfigQuery &config)
 
   /* If need to skip all other rules just append the whole query to the key. */
   if (config.toBeSkipped()) {
-    _key.append("?");
+    _key.append("?", 1);
     _key.append(query, length);
     return;
   }
 
-  /* Use the corresponding container based on whether we need
-   * to sort the parameters (set) or keep the order (list) */
-  String keyQuery;
-  if (config.toBeSorted()) {
-    keyQuery = getKeyQuery<StringSet>(query, length, config);
-  } else {
-    keyQuery = getKeyQuery<StringList>(query, length, config);
-  }
-
-  if (!keyQuery.empty()) {
-    _key.append(keyQuery);
-  }
+  /* Sort the parameters (and make them unique) or keep their order, without copying them */
+  ::appendKeyQuery(_key, StringView(query, length), config);
 }
 
 /**
@@ -752,9 +795,9 @@ CacheKey::finalize() const
                 (_remap ? "remap" : "global"));
   switch (_keyType) {
   case CACHE_KEY: {
-    if (TS_SUCCESS == TSCacheUrlSet(_txn, &(_key[0]), _key.size())) {
+    if (TS_SUCCESS == TSCacheUrlSet(_txn, _key.c_str(), _key.size())) {
       /* Set cache key succesfully */
-      msg.assign("set cache key to ").append(_key);
+      msg.assign("set cache key to ").append(_key.c_str(), _key.size());
       res = true;
     } else {
       if (_remap) {
@@ -771,12 +814,12 @@ CacheKey::finalize() const
   case PARENT_SELECTION_URL: {
     /* parent selection */
     const char *start = _key.c_str();
-    const char *end   = _key.c_str() + _key.length();
+    const char *end   = _key.c_str() + _key.size();
     TSMLoc new_url_loc;
     if (TS_SUCCESS == TSUrlCreate(_buf, &new_url_loc)) {
       if (TS_PARSE_DONE == TSUrlParse(_buf, new_url_loc, &start, end)) {
         if (TS_SUCCESS == TSHttpTxnParentSelectionUrlSet(_txn, _buf, new_url_loc)) {
-          msg.assign("set parent selection URL to ").append(_key);
+          msg.assign("set parent selection URL to ").append(_key.c_str(), _key.size());
           res = true;
         } else {
           msg.assign("failed to set parent selection URL");
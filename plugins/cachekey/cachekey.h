@@ -23,11 +23,94 @@
 
 #pragma once
 
+#include <cstring>
+#include <memory>
+
 #include "ts/ts.h"
 #include "ts/remap.h"
 #include "common.h"
 #include "configs.h"
 
+/**
+ * @brief The key being built, written once, in order, to a buffer inside the object.
+ *
+ * A CacheKey is on the stack, and so is its key: no allocation is needed, but for a key longer than the buffer,
+ * which then moves to the arena of the transaction, or to the heap. The key is always null-terminated.
+ */
+class KeyBuffer
+{
+public:
+  /** @param txn the transaction the key is of, its arena holds the key if it outgrows the inline buffer */
+  explicit KeyBuffer(TSHttpTxn txn = nullptr) : _txn(txn) { _inline[0] = '\0'; }
+
+  /** @brief make room for @a n more characters, to be written from the returned pointer and committed with commit() */
+  char *
+  reserve(size_t n)
+  {
+    if (_size + n > _capacity) {
+      grow(n);
+    }
+    return _data + _size;
+  }
+
+  /** @brief add to the key the @a n characters written after reserve() */
+  void
+  commit(size_t n)
+  {
+    _size += n;
+    _data[_size] = '\0';
+  }
+
+  void
+  append(const char *s, size_t n)
+  {
+    if (0 != n) {
+      memcpy(reserve(n), s, n);
+      commit(n);
+    }
+  }
+
+  void
+  append(StringView s)
+  {
+    append(s.data(), s.size());
+  }
+
+  const char *
+  c_str() const
+  {
+    return _data;
+  }
+
+  size_t
+  size() const
+  {
+    return _size;
+  }
+
+  bool
+  empty() const
+  {
+    return 0 == _size;
+  }
+
+  // noncopyable
+  KeyBuffer(const KeyBuffer &) = delete;            // disallow
+  KeyBuffer &operator=(const KeyBuffer &) = delete; // disallow
+
+private:
+  void grow(size_t n);
+
+  static constexpr size_t INLINE_SIZE = 1024;
+
+  char _inline[INLINE_SIZE];
+  char *_data      = _inline;
+  size_t _size     = 0;
+  size_t _capacity = INLINE_SIZE - 1; /**< @brief room for the characters, not counting the terminating null */
+  std::unique_ptr<char[]> _heap;      /**< @brief the buffer once the key outgrew the inline one, without a transaction */
+  TSHttpTxn _txn = nullptr;           /**< @brief the transaction whose arena holds the key once it outgrew the inline one */
+};
+
 /**
  * @brief Cache key manipulation class.
  *
@@ -55,8 +138,8 @@ public:
   ~CacheKey();
 
   void append(unsigned number);
-  void append(const String &);
-  void append(const String &s, bool useSeparator);
+  void append(StringView s);
+  void append(StringView s, bool useSeparator);
   void append(const char *s);
   void append(const char *n, unsigned s);
   void appendPrefix(const String &prefix, Pattern &prefixCapture, Pattern &prefixCaptureUri, bool canonicalPrefix);
@@ -87,7 +170,7 @@ private:
   bool _valid = false; /**< @brief shows if the constructor discovered the input correctly */
   bool _remap = false; /**< @brief shows if the input URI was from remap info */
 
-  String _key;                          /**< @brief cache key */
+  KeyBuffer _key;                       /**< @brief cache key */
   String _separator;                    /**< @brief a separator used to separate the cache key elements extracted from the URI */
   CacheKeyUriType _uriType = REMAP;     /**< @brief the URI type used as a cachekey base: pristine, remap, etc. */
   CacheKeyKeyType _keyType = CACHE_KEY; /**< @brief the target URI type: cache key, parent selection, etc. */
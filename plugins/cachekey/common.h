@@ -34,6 +34,7 @@
 typedef std::string String;
 typedef std::string_view StringView;
 typedef std::set<std::string> StringSet;
+typedef std::set<std::string, std::less<>> StringViewSet; /* Looked up with a StringView, without making a String of it */
 typedef std::list<std::string> StringList;
 typedef std::vector<std::string> StringVector;
 
@@ -50,13 +50,13 @@ isTrue(const char *arg)
 void
 ConfigElements::setExclude(const char *arg)
 {
-  ::commaSeparateString<StringSet>(_exclude, arg);
+  ::commaSeparateString<StringViewSet>(_exclude, arg);
 }
 
 void
 ConfigElements::setInclude(const char *arg)
 {
-  ::commaSeparateString<StringSet>(_include, arg);
+  ::commaSeparateString<StringViewSet>(_include, arg);
 }
 
 static void
@@ -154,24 +154,27 @@ ConfigElements::toBeSorted() const
 }
 
 bool
-ConfigElements::toBeAdded(const String &element) const
+ConfigElements::toBeAdded(StringView element) const
 {
-  /* Exclude the element if it is in the exclusion list. If the list is empty don't exclude anything. */
+  const int len = static_cast<int>(element.size());
+
+  /* Exclude the element if it is in the exclusion list. If the list is empty don't exclude anything.
+   * Only the patterns need the element as a String. */
   bool exclude = (!_exclude.empty() && _exclude.find(element) != _exclude.end()) ||
-                 (!_excludePatterns.empty() && _excludePatterns.match(element));
-  CacheKeyDebug("%s '%s' %s the 'exclude' rule", name().c_str(), element.c_str(), exclude ? "matches" : "does not match");
+                 (!_excludePatterns.empty() && _excludePatterns.match(String(element)));
+  CacheKeyDebug("%s '%.*s' %s the 'exclude' rule", name().c_str(), len, element.data(), exclude ? "matches" : "does not match");
 
   /* Include the element only if it is in the inclusion list. If the list is empty include everything. */
-  bool include =
-    ((_include.empty() && _includePatterns.empty()) || _include.find(element) != _include.end()) || _includePatterns.match(element);
-  CacheKeyDebug("%s '%s' %s the 'include' rule", name().c_str(), element.c_str(), include ? "matches" : "do not match");
+  bool include = (_include.empty() && _includePatterns.empty()) || _include.find(element) != _include.end() ||
+                 (!_includePatterns.empty() && _includePatterns.match(String(element)));
+  CacheKeyDebug("%s '%.*s' %s the 'include' rule", name().c_str(), len, element.data(), include ? "matches" : "do not match");
 
   if (include && !exclude) {
-    CacheKeyDebug("%s '%s' should be added to cache key", name().c_str(), element.c_str());
+    CacheKeyDebug("%s '%.*s' should be added to cache key", name().c_str(), len, element.data());
     return true;
   }
 
-  CacheKeyDebug("%s '%s' should not be added to cache key", name().c_str(), element.c_str());
+  CacheKeyDebug("%s '%.*s' should not be added to cache key", name().c_str(), len, element.data());
   return false;
 }
 
@@ -252,7 +255,7 @@ ConfigCookies::name() const
  * We would not need to drill this hole in the design if there was an efficient way to iterate through the headers in the traffic
  * server API (inefficiency mentioned in ts/ts.h), iterating through the "include" list should be good enough work-around.
  */
-const StringSet &
+const StringViewSet &
 ConfigHeaders::getInclude() const
 {
   return _include;
@@ -533,7 +536,36 @@ Configs::finalize()
     CacheKeyDebug("setting cache key");
     _keyTypes = {CACHE_KEY};
   }
-  return _query.finalize() && _headers.finalize() && _cookies.finalize();
+  if (!_query.finalize() || !_headers.finalize() || !_cookies.finalize()) {
+    return false;
+  }
+
+  /* Decide once which elements are appended to the key, a request only runs the steps that add something to it. */
+  _steps.clear();
+  if (!_prefixToBeRemoved) {
+    _steps.push_back(STEP_PREFIX);
+  }
+  if (!_classifier.empty()) {
+    _steps.push_back(STEP_UA_CLASS);
+  }
+  if (!_uaCapture.empty()) {
+    _steps.push_back(STEP_UA_CAPTURE);
+  }
+  if ((!_headers.toBeRemoved() && !_headers.toBeSkipped()) || !_headers.getCaptures().empty()) {
+    _steps.push_back(STEP_HEADERS);
+  }
+  if (!_cookies.toBeRemoved() && !_cookies.toBeSkipped()) {
+    _steps.push_back(STEP_COOKIES);
+  }
+  if (!_pathToBeRemoved) {
+    _steps.push_back(STEP_PATH);
+  }
+  if (!_query.toBeRemoved()) {
+    _steps.push_back(STEP_QUERY);
+  }
+  CacheKeyDebug("%zu steps building the key", _steps.size());
+
+  return true;
 }
 
 bool
@@ -621,6 +653,12 @@ Configs::getKeyType()
   return _keyTypes;
 }
 
+const CacheKeySteps &
+Configs::getSteps() const
+{
+  return _steps;
+}
+
 const char *
 getCacheKeyUriTypeName(CacheKeyUriType type)
 {
@@ -43,6 +43,21 @@ const char *getCacheKeyKeyTypeName(CacheKeyKeyType type);
 
 typedef std::set<CacheKeyKeyType> CacheKeyKeyTypeSet;
 
+/**
+ * @brief Cache key construction steps, in the order the elements are appended to the key.
+ */
+enum CacheKeyStep {
+  STEP_PREFIX,
+  STEP_UA_CLASS,
+  STEP_UA_CAPTURE,
+  STEP_HEADERS,
+  STEP_COOKIES,
+  STEP_PATH,
+  STEP_QUERY,
+};
+
+typedef std::vector<CacheKeyStep> CacheKeySteps;
+
 /**
  * @brief Plug-in configuration elements (query / headers / cookies).
  *
@@ -72,7 +87,7 @@ public:
   /** @brief shows if the processing of elements is to be skipped */
   bool toBeSkipped() const;
   /** @brief shows if the element is to be included in the result */
-  bool toBeAdded(const String &element) const;
+  bool toBeAdded(StringView element) const;
   /** @brief returns the configuration element name for debug logging */
   virtual const String &name() const = 0;
 
@@ -86,8 +101,8 @@ protected:
   bool noIncludeExcludeRules() const;
   bool setCapture(const String &name, const String &pattern);
 
-  StringSet _exclude;
-  StringSet _include;
+  StringViewSet _exclude;
+  StringViewSet _include;
 
   MultiPattern _includePatterns;
   MultiPattern _excludePatterns;
@@ -120,7 +135,7 @@ class ConfigHeaders : public ConfigElements
 public:
   bool finalize() override;
 
-  const StringSet &getInclude() const;
+  const StringViewSet &getInclude() const;
 
 private:
   const String &name() const override;
@@ -207,6 +222,11 @@ public:
    */
   CacheKeyKeyTypeSet &getKeyType();
 
+  /**
+   * @brief get the steps building the key, only the ones the configuration needs, decided once in finalize().
+   */
+  const CacheKeySteps &getSteps() const;
+
   /* Make the following members public to avoid unnecessary accessors */
   ConfigQuery _query;        /**< @brief query parameter related configuration */
   ConfigHeaders _headers;    /**< @brief headers related configuration */
@@ -234,4 +254,5 @@ private:
   String _separator        = "/";   /**< @brief a separator used to separate the cache key elements extracted from the URI */
   CacheKeyUriType _uriType = REMAP; /**< @brief shows which URI the cache key will be based on */
   CacheKeyKeyTypeSet _keyTypes;     /**< @brief target URI to be modified, cache key or paren selection */
+  CacheKeySteps _steps;             /**< @brief the steps building the key, in order */
 };
@@ -514,3 +514,13 @@ Classifier::add(MultiPattern *pattern)
 {
   _list.push_back(pattern);
 }
+
+/**
+ * @brief Check if empty.
+ * @return true if the classifier has no multi-patterns, false otherwise
+ */
+bool
+Classifier::empty() const
+{
+  return _list.empty();
+}
@@ -130,6 +130,7 @@ public:
 
   bool classify(const String &subject, String &name) const;
   void add(MultiPattern *pattern);
+  bool empty() const;
 
   // noncopyable
   Classifier(const Classifier &) = delete;            // disallow
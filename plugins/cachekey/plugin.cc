@@ -39,33 +39,45 @@ static void
 setCacheKey(TSHttpTxn txn, Configs *config, TSRemapRequestInfo *rri = nullptr)
 {
   const CacheKeyKeyTypeSet &keyTypes = config->getKeyType();
+  const CacheKeySteps &steps         = config->getSteps();
 
   for (auto type : keyTypes) {
     /* Initial cache key facility from the requested URL. */
     CacheKey cachekey(txn, config->getSeparator(), config->getUriType(), type, rri);
 
-    /* Append custom prefix or the host:port */
-    if (!config->prefixToBeRemoved()) {
-      cachekey.appendPrefix(config->_prefix, config->_prefixCapture, config->_prefixCaptureUri, config->canonicalPrefix());
+    /* Run only the steps the configuration needs, decided when it was loaded, each appending to the key in turn. */
+    for (auto step : steps) {
+      switch (step) {
+      case STEP_PREFIX:
+        /* Append custom prefix or the host:port */
+        cachekey.appendPrefix(config->_prefix, config->_prefixCapture, config->_prefixCaptureUri, config->canonicalPrefix());
+        break;
+      case STEP_UA_CLASS:
+        /* Classify User-Agent and append the class name to the cache key if matched. */
+        cachekey.appendUaClass(config->_classifier);
+        break;
+      case STEP_UA_CAPTURE:
+        /* Capture from User-Agent header. */
+        cachekey.appendUaCaptures(config->_uaCapture);
+        break;
+      case STEP_HEADERS:
+        /* Append headers to the cache key. */
+        cachekey.appendHeaders(config->_headers);
+        break;
+      case STEP_COOKIES:
+        /* Append cookies to the cache key. */
+        cachekey.appendCookies(config->_cookies);
+        break;
+      case STEP_PATH:
+        /* Append the path to the cache key. */
+        cachekey.appendPath(config->_pathCapture, config->_pathCaptureUri);
+        break;
+      case STEP_QUERY:
+        /* Append query parameters to the cache key. */
+        cachekey.appendQuery(config->_query);
+        break;
+      }
     }
-    /* Classify User-Agent and append the class name to the cache key if matched. */
-    cachekey.appendUaClass(config->_classifier);
-
-    /* Capture from User-Agent header. */
-    cachekey.appendUaCaptures(config->_uaCapture);
-
-    /* Append headers to the cache key. */
-    cachekey.appendHeaders(config->_headers);
-
-    /* Append cookies to the cache key. */
-    cachekey.appendCookies(config->_cookies);
-
-    /* Append the path to the cache key. */
-    if (!config->pathToBeRemoved()) {
-      cachekey.appendPath(config->_pathCapture, config->_pathCaptureUri);
-    }
-    /* Append query parameters to the cache key. */
-    cachekey.appendQuery(config->_query);
 
     /* Set the cache key */
     cachekey.finalize();
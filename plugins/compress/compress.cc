@@ -1,6 +1,6 @@
 /** @file
 
-  Transforms content using gzip, deflate or brotli
+  Transforms content using gzip, deflate, brotli or zstd
 
   @section license License
 
@@ -30,12 +30,17 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 #include "ts/ts.h"
 #include "tscore/ink_defs.h"
 
 #include "debug_macros.h"
 #include "misc.h"
 #include "configuration.h"
+#include "precompress.h"
 #include "ts/remap.h"
 
 using namespace std;
@@ -57,6 +62,8 @@ const int ZLIB_COMPRESSION_LEVEL = 6;
 const char *dictionary           = nullptr;
 const char *TS_HTTP_VALUE_BROTLI = "br";
 const int TS_HTTP_LEN_BROTLI     = 2;
+const char *TS_HTTP_VALUE_ZSTD   = "zstd";
+const int TS_HTTP_LEN_ZSTD       = 4;
 
 // brotli compression quality 1-11. Testing proved level '6'
 #if HAVE_BROTLI_ENCODE_H
@@ -64,6 +71,22 @@ const int BROTLI_COMPRESSION_LEVEL = 6;
 const int BROTLI_LGW               = 16;
 #endif
 
+// zstd compression level 1-19, its default is '3'
+#if HAVE_ZSTD_H
+const int ZSTD_COMPRESSION_LEVEL = 3;
+#endif
+
+// The variants fetched for the cache are compressed once for many hits, and no client waits on them:
+// at the best levels rather than the fast ones.
+const int ZLIB_PRECOMPRESS_LEVEL = Z_BEST_COMPRESSION;
+#if HAVE_BROTLI_ENCODE_H
+const int BROTLI_PRECOMPRESS_LEVEL = BROTLI_MAX_QUALITY;
+const int BROTLI_PRECOMPRESS_LGW   = BROTLI_DEFAULT_WINDOW;
+#endif
+#if HAVE_ZSTD_H
+const int ZSTD_PRECOMPRESS_LEVEL = 19;
+#endif
+
 static const char *global_hidden_header_name = nullptr;
 
 static TSMutex compress_config_mutex = TSMutexCreate();
@@ -73,7 +96,7 @@ Configuration *cur_config  = nullptr;
 Configuration *prev_config = nullptr;
 
 static Data *
-data_alloc(int compression_type, int compression_algorithms)
+data_alloc(int compression_type, int compression_algorithms, bool precompress)
 {
   Data *data;
   int err;
@@ -102,7 +125,8 @@ data_alloc(int compression_type, int compression_algorithms)
     window_bits = WINDOW_BITS_DEFLATE;
   }
 
-  err = deflateInit2(&data->zstrm, ZLIB_COMPRESSION_LEVEL, Z_DEFLATED, window_bits, ZLIB_MEMLEVEL, Z_DEFAULT_STRATEGY);
+  err = deflateInit2(&data->zstrm, precompress ? ZLIB_PRECOMPRESS_LEVEL : ZLIB_COMPRESSION_LEVEL, Z_DEFLATED, window_bits,
+                     ZLIB_MEMLEVEL, Z_DEFAULT_STRATEGY);
 
   if (err != Z_OK) {
     fatal("gzip-transform: ERROR: deflateInit (%d)!", err);
@@ -122,8 +146,9 @@ data_alloc(int compression_type, int compression_algorithms)
     if (!data->bstrm.br) {
       fatal("Brotli Encoder Instance Failed");
     }
-    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_QUALITY, BROTLI_COMPRESSION_LEVEL);
-    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_LGWIN, BROTLI_LGW);
+    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_QUALITY,
+                              precompress ? BROTLI_PRECOMPRESS_LEVEL : BROTLI_COMPRESSION_LEVEL);
+    BrotliEncoderSetParameter(data->bstrm.br, BROTLI_PARAM_LGWIN, precompress ? BROTLI_PRECOMPRESS_LGW : BROTLI_LGW);
     data->bstrm.next_in   = nullptr;
     data->bstrm.avail_in  = 0;
     data->bstrm.total_in  = 0;
@@ -131,6 +156,18 @@ data_alloc(int compression_type, int compression_algorithms)
     data->bstrm.avail_out = 0;
     data->bstrm.total_out = 0;
   }
+#endif
+#if HAVE_ZSTD_H
+  data->zstd          = nullptr;
+  data->zstd_total_in = 0;
+  if (compression_type & COMPRESSION_TYPE_ZSTD) {
+    debug("zstd compression. Create zstd compression context.");
+    data->zstd = ZSTD_createCCtx();
+    if (!data->zstd) {
+      fatal("zstd compression context failed");
+    }
+    ZSTD_CCtx_setParameter(data->zstd, ZSTD_c_compressionLevel, precompress ? ZSTD_PRECOMPRESS_LEVEL : ZSTD_COMPRESSION_LEVEL);
+  }
 #endif
   return data;
 }
@@ -152,6 +189,9 @@ data_destroy(Data *data)
 #if HAVE_BROTLI_ENCODE_H
   BrotliEncoderDestroyInstance(data->bstrm.br);
 #endif
+#if HAVE_ZSTD_H
+  ZSTD_freeCCtx(data->zstd);
+#endif
 
   TSfree(data);
 }
@@ -167,6 +207,9 @@ content_encoding_header(TSMBuffer bufp, TSMLoc hdr_loc, const int compression_ty
   if (compression_type & COMPRESSION_TYPE_BROTLI && (algorithm & ALGORITHM_BROTLI)) {
     value     = TS_HTTP_VALUE_BROTLI;
     value_len = TS_HTTP_LEN_BROTLI;
+  } else if (compression_type & COMPRESSION_TYPE_ZSTD && (algorithm & ALGORITHM_ZSTD)) {
+    value     = TS_HTTP_VALUE_ZSTD;
+    value_len = TS_HTTP_LEN_ZSTD;
   } else if (compression_type & COMPRESSION_TYPE_GZIP && (algorithm & ALGORITHM_GZIP)) {
     value     = TS_HTTP_VALUE_GZIP;
     value_len = TS_HTTP_LEN_GZIP;
@@ -402,6 +445,49 @@ brotli_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_l
 }
 #endif
 
+#if HAVE_ZSTD_H
+static bool
+zstd_compress_operation(Data *data, const char *upstream_buffer, int64_t upstream_length, ZSTD_EndDirective op)
+{
+  TSIOBufferBlock downstream_blkp;
+  int64_t downstream_length;
+  ZSTD_inBuffer in = {upstream_buffer, static_cast<size_t>(upstream_length), 0};
+
+  for (;;) {
+    downstream_blkp         = TSIOBufferStart(data->downstream_buffer);
+    char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
+    ZSTD_outBuffer out      = {downstream_buffer, static_cast<size_t>(downstream_length), 0};
+
+    // the number of bytes left to flush, 0 once the input is consumed and, unless continuing, flushed
+    size_t left = ZSTD_compressStream2(data->zstd, &out, &in, op);
+    if (ZSTD_isError(left)) {
+      error("ZSTD_compressStream2(%d) call failed: %s", op, ZSTD_getErrorName(left));
+      return false;
+    }
+
+    TSIOBufferProduce(data->downstream_buffer, out.pos);
+    data->downstream_length += out.pos;
+    if (op == ZSTD_e_continue ? in.pos < in.size : left > 0) {
+      continue;
+    }
+
+    break;
+  }
+
+  return true;
+}
+
+static void
+zstd_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_length)
+{
+  if (!zstd_compress_operation(data, upstream_buffer, upstream_length, data->hc->flush() ? ZSTD_e_flush : ZSTD_e_continue)) {
+    return;
+  }
+
+  data->zstd_total_in += upstream_length;
+}
+#endif
+
 static void
 compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
 {
@@ -428,6 +514,11 @@ compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
     if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
       brotli_transform_one(data, upstream_buffer, upstream_length);
     } else
+#endif
+#if HAVE_ZSTD_H
+      if (data->compression_type & COMPRESSION_TYPE_ZSTD && (data->compression_algorithms & ALGORITHM_ZSTD)) {
+      zstd_transform_one(data, upstream_buffer, upstream_length);
+    } else
 #endif
       if ((data->compression_type & (COMPRESSION_TYPE_GZIP | COMPRESSION_TYPE_DEFLATE)) &&
           (data->compression_algorithms & (ALGORITHM_GZIP | ALGORITHM_DEFLATE))) {
@@ -508,6 +599,25 @@ brotli_transform_finish(Data *data)
 }
 #endif
 
+#if HAVE_ZSTD_H
+static void
+zstd_transform_finish(Data *data)
+{
+  if (data->state != transform_state_output) {
+    return;
+  }
+
+  data->state = transform_state_finished;
+
+  if (!zstd_compress_operation(data, nullptr, 0, ZSTD_e_end)) {
+    return;
+  }
+
+  debug("zstd-transform: Finished zstd");
+  log_compression_ratio(data->zstd_total_in, data->downstream_length);
+}
+#endif
+
 static void
 compress_transform_finish(Data *data)
 {
@@ -516,6 +626,12 @@ compress_transform_finish(Data *data)
     brotli_transform_finish(data);
     debug("compress_transform_finish: brotli compression finish");
   } else
+#endif
+#if HAVE_ZSTD_H
+    if (data->compression_type & COMPRESSION_TYPE_ZSTD && data->compression_algorithms & ALGORITHM_ZSTD) {
+    zstd_transform_finish(data);
+    debug("compress_transform_finish: zstd compression finish");
+  } else
 #endif
     if ((data->compression_type & (COMPRESSION_TYPE_GZIP | COMPRESSION_TYPE_DEFLATE)) &&
         (data->compression_algorithms & (ALGORITHM_GZIP | ALGORITHM_DEFLATE))) {
@@ -620,13 +736,65 @@ compress_transform(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
   return 0;
 }
 
+// The checks of transformable() on the response itself, whatever the client accepts.
+static int
+response_compressible(TSMBuffer bufp, TSMLoc hdr_loc, HostConfiguration *host_configuration)
+{
+  TSMLoc field_loc;
+  const char *value;
+  int len;
+
+  /* If there already exists a content encoding then we don't want
+     to do anything. */
+  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_ENCODING, -1);
+  if (field_loc) {
+    info("response is already content encoded, not compressible");
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    return 0;
+  }
+
+  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_LENGTH, TS_MIME_LEN_CONTENT_LENGTH);
+  if (field_loc != TS_NULL_MLOC) {
+    unsigned int hdr_value = TSMimeHdrFieldValueUintGet(bufp, hdr_loc, field_loc, -1);
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    if (hdr_value == 0) {
+      info("response is 0-length, not compressible");
+      return 0;
+    }
+
+    if (hdr_value < host_configuration->minimum_content_length()) {
+      info("response is is smaller than minimum content length, not compressing");
+      return 0;
+    }
+  }
+
+  /* We only want to do gzip compression on documents that have a
+     content type of "text/" or "application/x-javascript". */
+  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_TYPE, -1);
+  if (!field_loc) {
+    info("no content type header found, not compressible");
+    return 0;
+  }
+
+  value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &len);
+
+  int rv = host_configuration->is_content_type_compressible(value, len);
+
+  if (!rv) {
+    info("content-type [%.*s] not compressible", len, value);
+  }
+
+  TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+
+  return rv;
+}
+
 static int
 transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration, int *compress_type, int *algorithms)
 {
   /* Server response header */
   TSMBuffer bufp;
   TSMLoc hdr_loc;
-  TSMLoc field_loc;
 
   /* Client request header */
   TSMBuffer cbuf;
@@ -702,6 +870,11 @@ transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration
           compression_acceptable = 1;
         }
         *compress_type |= COMPRESSION_TYPE_BROTLI;
+      } else if (strncasecmp(value, "zstd", sizeof("zstd") - 1) == 0) {
+        if (*algorithms & ALGORITHM_ZSTD) {
+          compression_acceptable = 1;
+        }
+        *compress_type |= COMPRESSION_TYPE_ZSTD;
       } else if (strncasecmp(value, "deflate", sizeof("deflate") - 1) == 0) {
         if (*algorithms & ALGORITHM_DEFLATE) {
           compression_acceptable = 1;
@@ -731,54 +904,83 @@ transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration
     return 0;
   }
 
-  /* If there already exists a content encoding then we don't want
-     to do anything. */
-  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_ENCODING, -1);
-  if (field_loc) {
-    info("response is already content encoded, not compressible");
-    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
-    TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
-    return 0;
-  }
+  int rv = response_compressible(bufp, hdr_loc, host_configuration);
 
-  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_LENGTH, TS_MIME_LEN_CONTENT_LENGTH);
-  if (field_loc != TS_NULL_MLOC) {
-    unsigned int hdr_value = TSMimeHdrFieldValueUintGet(bufp, hdr_loc, field_loc, -1);
-    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
-    if (hdr_value == 0) {
-      info("response is 0-length, not compressible");
-      return 0;
-    }
+  TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
 
-    if (hdr_value < host_configuration->minimum_content_length()) {
-      info("response is is smaller than minimum content length, not compressing");
-      return 0;
-    }
-  }
+  return rv;
+}
 
-  /* We only want to do gzip compression on documents that have a
-     content type of "text/" or "application/x-javascript". */
-  field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_TYPE, -1);
-  if (!field_loc) {
-    info("no content type header found, not compressible");
-    TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
-    return 0;
+// The algorithm a response is compressed with, as content_encoding_header() picks it.
+static int
+compression_algorithm(int compress_type, int algorithms)
+{
+  if (compress_type & COMPRESSION_TYPE_BROTLI && algorithms & ALGORITHM_BROTLI) {
+    return ALGORITHM_BROTLI;
+  } else if (compress_type & COMPRESSION_TYPE_ZSTD && algorithms & ALGORITHM_ZSTD) {
+    return ALGORITHM_ZSTD;
+  } else if (compress_type & COMPRESSION_TYPE_GZIP && algorithms & ALGORITHM_GZIP) {
+    return ALGORITHM_GZIP;
+  } else if (compress_type & COMPRESSION_TYPE_DEFLATE && algorithms & ALGORITHM_DEFLATE) {
+    return ALGORITHM_DEFLATE;
   }
+  return ALGORITHM_DEFAULT;
+}
 
-  value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &len);
+// Whether the compressed variants of the origin response of @a txnp are to be fetched for the cache:
+// a cacheable and compressible 200 to a GET, which is not a variant fetch itself.
+static bool
+precompressible(TSHttpTxn txnp, HostConfiguration *hc)
+{
+  TSMBuffer bufp, cbuf;
+  TSMLoc hdr_loc, chdr;
+  bool rv = false;
 
-  int rv = host_configuration->is_content_type_compressible(value, len);
+  if (!hc->precompress() || !hc->cache() || is_precompress_txn(txnp)) {
+    return false;
+  }
+  if (TS_SUCCESS != TSHttpTxnServerRespGet(txnp, &bufp, &hdr_loc)) {
+    return false;
+  }
 
-  if (!rv) {
-    info("content-type [%.*s] not compressible", len, value);
+  if (TSHttpHdrStatusGet(bufp, hdr_loc) == TS_HTTP_STATUS_OK && TS_SUCCESS == TSHttpTxnClientReqGet(txnp, &cbuf, &chdr)) {
+    int method_length;
+    const char *method = TSHttpHdrMethodGet(cbuf, chdr, &method_length);
+    TSMLoc rfield      = TSMimeHdrFieldFind(cbuf, chdr, TS_MIME_FIELD_RANGE, TS_MIME_LEN_RANGE);
+
+    rv = method_length == TS_HTTP_LEN_GET && memcmp(method, TS_HTTP_METHOD_GET, TS_HTTP_LEN_GET) == 0 && rfield == TS_NULL_MLOC;
+    if (rfield != TS_NULL_MLOC) {
+      TSHandleMLocRelease(cbuf, chdr, rfield);
+    }
+    TSHandleMLocRelease(cbuf, TS_NULL_MLOC, chdr);
   }
 
-  TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  rv = rv && response_compressible(bufp, hdr_loc, hc) && TSHttpTxnIsCacheable(txnp, nullptr, nullptr);
   TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
 
   return rv;
 }
 
+// Whether the cached response of @a txnp is content encoded, a variant rather than the original.
+static bool
+cached_response_encoded(TSHttpTxn txnp)
+{
+  TSMBuffer bufp;
+  TSMLoc hdr_loc;
+  bool encoded = false;
+
+  if (TS_SUCCESS == TSHttpTxnCachedRespGet(txnp, &bufp, &hdr_loc)) {
+    TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CONTENT_ENCODING, TS_MIME_LEN_CONTENT_ENCODING);
+    if (field_loc) {
+      encoded = true;
+      TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    }
+    TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
+  }
+
+  return encoded;
+}
+
 static void
 compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type, int algorithms)
 {
@@ -797,7 +999,7 @@ compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type,
   }
 
   connp     = TSTransformCreate(compress_transform, txnp);
-  data      = data_alloc(compress_type, algorithms);
+  data      = data_alloc(compress_type, algorithms, is_precompress_txn(txnp));
   data->txn = txnp;
   data->hc  = hc;
 
@@ -849,8 +1051,17 @@ transform_plugin(TSCont contp, TSEvent event, void *edata)
         }
       }
 
+      int stored = ALGORITHM_DEFAULT;
       if (transformable(txnp, true, hc, &compress_type, &algorithms)) {
         compress_transform_add(txnp, hc, compress_type, algorithms);
+        stored = compression_algorithm(compress_type, algorithms);
+      } else if (is_precompress_txn(txnp)) {
+        // not a variant, the response the cache has is enough
+        TSHttpTxnServerRespNoStoreSet(txnp, 1);
+      }
+
+      if (precompressible(txnp, hc)) {
+        precompress_variants(txnp, hc->compression_algorithms() & ~stored);
       }
     }
     break;
@@ -873,8 +1084,14 @@ transform_plugin(TSCont contp, TSEvent event, void *edata)
 
   case TS_EVENT_HTTP_CACHE_LOOKUP_COMPLETE: {
     int obj_status;
+    bool fresh = TS_ERROR != TSHttpTxnCacheLookupStatusGet(txnp, &obj_status) && (TS_CACHE_LOOKUP_HIT_FRESH == obj_status);
 
-    if (TS_ERROR != TSHttpTxnCacheLookupStatusGet(txnp, &obj_status) && (TS_CACHE_LOOKUP_HIT_FRESH == obj_status)) {
+    if (fresh && is_precompress_txn(txnp) && !cached_response_encoded(txnp)) {
+      // there is no variant for the encoding, fetch it from origin to store it next to the original
+      info("fetching the variant from origin");
+      TSHttpTxnCacheLookupStatusSet(txnp, TS_CACHE_LOOKUP_MISS);
+      TSHttpTxnHookAdd(txnp, TS_HTTP_SEND_REQUEST_HDR_HOOK, contp);
+    } else if (fresh) {
       if (hc != nullptr) {
         info("handling compression of cached object");
         if (transformable(txnp, false, hc, &compress_type, &algorithms)) {
@@ -107,6 +107,7 @@ enum ParserState {
   kParseCache,
   kParseRangeRequest,
   kParseFlush,
+  kParsePrecompress,
   kParseAllow,
   kParseMinimumContentLength
 };
@@ -239,8 +240,14 @@ HostConfiguration::add_compression_algorithms(string &line)
       compression_algorithms_ |= ALGORITHM_GZIP;
     } else if (token == "deflate") {
       compression_algorithms_ |= ALGORITHM_DEFLATE;
+    } else if (token == "zstd") {
+#ifdef HAVE_ZSTD_H
+      compression_algorithms_ |= ALGORITHM_ZSTD;
+#else
+      error("supported-algorithms: zstd support not compiled in.");
+#endif
     } else {
-      error("Unknown compression type. Supported compression-algorithms <br,gzip,deflate>.");
+      error("Unknown compression type. Supported compression-algorithms <br,zstd,gzip,deflate>.");
     }
   }
 }
@@ -352,6 +359,8 @@ Configuration::Parse(const char *path)
           state = kParseRangeRequest;
         } else if (token == "flush") {
           state = kParseFlush;
+        } else if (token == "precompress") {
+          state = kParsePrecompress;
         } else if (token == "supported-algorithms") {
           current_host_configuration->add_compression_algorithms(line);
           state = kParseStart;
@@ -390,6 +399,10 @@ Configuration::Parse(const char *path)
         current_host_configuration->set_flush(token == "true");
         state = kParseStart;
         break;
+      case kParsePrecompress:
+        current_host_configuration->set_precompress(token == "true");
+        state = kParseStart;
+        break;
       case kParseAllow:
         current_host_configuration->add_allow(token);
         state = kParseStart;
@@ -38,7 +38,8 @@ enum CompressionAlgorithm {
   ALGORITHM_DEFAULT = 0,
   ALGORITHM_DEFLATE = 1,
   ALGORITHM_GZIP    = 2,
-  ALGORITHM_BROTLI  = 4 // For bit manipulations
+  ALGORITHM_BROTLI  = 4, // For bit manipulations
+  ALGORITHM_ZSTD    = 8
 };
 
 class HostConfiguration : private atscppapi::noncopyable
@@ -51,6 +52,7 @@ public:
       range_request_(false),
       remove_accept_encoding_(false),
       flush_(false),
+      precompress_(false),
       compression_algorithms_(ALGORITHM_GZIP),
       minimum_content_length_(1024)
   {
@@ -97,6 +99,16 @@ public:
     flush_ = x;
   }
   bool
+  precompress()
+  {
+    return precompress_;
+  }
+  void
+  set_precompress(bool x)
+  {
+    precompress_ = x;
+  }
+  bool
   remove_accept_encoding()
   {
     return remove_accept_encoding_;
@@ -145,6 +157,7 @@ private:
   bool range_request_;
   bool remove_accept_encoding_;
   bool flush_;
+  bool precompress_;
   int compression_algorithms_;
   unsigned int minimum_content_length_;
 
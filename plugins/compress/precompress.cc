@@ -0,0 +1,282 @@
+/** @file
+
+  Fetches the compressed variants of responses for the cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ts/ts.h"
+
+#include "configuration.h"
+#include "debug_macros.h"
+#include "precompress.h"
+
+using namespace Gzip;
+
+namespace
+{
+// The tag of the transactions fetching the variants
+const char PRECOMPRESS_TAG[] = "compress.precompress";
+
+// The headers of the client request the variants are not fetched with
+const struct {
+  const char *name;
+  int len;
+} FILTER_HEADERS[] = {
+  {TS_MIME_FIELD_ACCEPT_ENCODING, TS_MIME_LEN_ACCEPT_ENCODING},
+  {TS_MIME_FIELD_RANGE, TS_MIME_LEN_RANGE},
+  {TS_MIME_FIELD_IF_MATCH, TS_MIME_LEN_IF_MATCH},
+  {TS_MIME_FIELD_IF_MODIFIED_SINCE, TS_MIME_LEN_IF_MODIFIED_SINCE},
+  {TS_MIME_FIELD_IF_NONE_MATCH, TS_MIME_LEN_IF_NONE_MATCH},
+  {TS_MIME_FIELD_IF_RANGE, TS_MIME_LEN_IF_RANGE},
+  {TS_MIME_FIELD_IF_UNMODIFIED_SINCE, TS_MIME_LEN_IF_UNMODIFIED_SINCE},
+};
+
+// The variants being fetched, by cache URL and encoding, so that a burst of misses fetches each once
+std::mutex fetching_lock;
+std::set<std::string> fetching;
+
+struct Fetch {
+  ~Fetch()
+  {
+    if (vc) {
+      TSVConnClose(vc);
+    }
+    if (req_reader) {
+      TSIOBufferReaderFree(req_reader);
+      TSIOBufferDestroy(req_buf);
+    }
+    if (resp_reader) {
+      TSIOBufferReaderFree(resp_reader);
+      TSIOBufferDestroy(resp_buf);
+    }
+    std::lock_guard<std::mutex> guard(fetching_lock);
+    fetching.erase(key);
+  }
+
+  std::string key;     ///< the cache URL and the encoding of the variant
+  std::string request; ///< the request for the variant
+  sockaddr_storage client_addr;
+
+  TSVConn vc                   = nullptr;
+  TSIOBuffer req_buf           = nullptr;
+  TSIOBufferReader req_reader  = nullptr;
+  TSIOBuffer resp_buf          = nullptr;
+  TSIOBufferReader resp_reader = nullptr;
+  TSVIO r_vio                  = nullptr;
+};
+
+void
+fetch_done(TSCont contp, Fetch *fetch)
+{
+  delete fetch;
+  TSContDestroy(contp);
+}
+
+int
+fetch_variant(TSCont contp, TSEvent event, void *edata)
+{
+  Fetch *fetch = static_cast<Fetch *>(TSContDataGet(contp));
+
+  switch (event) {
+  case TS_EVENT_HTTP_TXN_CLOSE:
+    // the response the variant is of is in the cache by now, or will not be
+    TSContScheduleOnPool(contp, 0, TS_THREAD_POOL_NET);
+    TSHttpTxnReenable(static_cast<TSHttpTxn>(edata), TS_EVENT_HTTP_CONTINUE);
+    break;
+
+  case TS_EVENT_IMMEDIATE:
+    fetch->vc = TSHttpConnectWithPluginId(reinterpret_cast<sockaddr *>(&fetch->client_addr), PRECOMPRESS_TAG, 0);
+    if (!fetch->vc) {
+      error("cannot connect to fetch %s", fetch->key.c_str());
+      fetch_done(contp, fetch);
+      break;
+    }
+    info("fetching %s", fetch->key.c_str());
+    fetch->req_buf     = TSIOBufferCreate();
+    fetch->req_reader  = TSIOBufferReaderAlloc(fetch->req_buf);
+    fetch->resp_buf    = TSIOBufferCreate();
+    fetch->resp_reader = TSIOBufferReaderAlloc(fetch->resp_buf);
+    TSIOBufferWrite(fetch->req_buf, fetch->request.data(), fetch->request.size());
+
+    fetch->r_vio = TSVConnRead(fetch->vc, contp, fetch->resp_buf, INT64_MAX);
+    TSVConnWrite(fetch->vc, contp, fetch->req_reader, TSIOBufferReaderAvail(fetch->req_reader));
+    break;
+
+  case TS_EVENT_VCONN_WRITE_COMPLETE:
+    break;
+
+  case TS_EVENT_VCONN_READ_READY: {
+    // the cache has what matters, the response is dropped
+    int64_t avail = TSIOBufferReaderAvail(fetch->resp_reader);
+    TSIOBufferReaderConsume(fetch->resp_reader, avail);
+    TSVIONDoneSet(fetch->r_vio, TSVIONDoneGet(fetch->r_vio) + avail);
+    TSVIOReenable(fetch->r_vio);
+  } break;
+
+  case TS_EVENT_VCONN_INACTIVITY_TIMEOUT:
+    TSVConnAbort(fetch->vc, TS_VC_CLOSE_ABORT);
+    fetch->vc = nullptr;
+    // FALLTHROUGH
+  case TS_EVENT_VCONN_READ_COMPLETE:
+  case TS_EVENT_VCONN_EOS:
+  case TS_EVENT_ERROR:
+    info("fetched %s, %s", fetch->key.c_str(), TSHttpEventNameLookup(event));
+    fetch_done(contp, fetch);
+    break;
+
+  default:
+    warning("unexpected event %s (%d) fetching %s", TSHttpEventNameLookup(event), event, fetch->key.c_str());
+    break;
+  }
+
+  return 0;
+}
+
+// The request of @a txnp, for its pristine URL, without the headers of FILTER_HEADERS and without the
+// empty line ending it. Its cache URL goes to @a cache_url.
+bool
+variant_request(TSHttpTxn txnp, std::string &request, std::string &cache_url)
+{
+  TSMBuffer req_buf, p_buf, mbuf;
+  TSMLoc req_loc, hdr_loc, p_url, url_loc;
+  bool ok = false;
+
+  if (TSHttpTxnClientReqGet(txnp, &req_buf, &req_loc) != TS_SUCCESS) {
+    return false;
+  }
+
+  mbuf    = TSMBufferCreate();
+  hdr_loc = TSHttpHdrCreate(mbuf);
+  if (TSHttpHdrCopy(mbuf, hdr_loc, req_buf, req_loc) == TS_SUCCESS && TSHttpTxnPristineUrlGet(txnp, &p_buf, &p_url) == TS_SUCCESS) {
+    if (TSUrlClone(mbuf, p_buf, p_url, &url_loc) == TS_SUCCESS) {
+      TSMLoc c_url;
+      int len;
+
+      if (TSUrlCreate(req_buf, &c_url) == TS_SUCCESS) {
+        if (TSHttpTxnCacheLookupUrlGet(txnp, req_buf, c_url) == TS_SUCCESS) {
+          char *url = TSUrlStringGet(req_buf, c_url, &len);
+          if (url) {
+            cache_url.assign(url, len);
+            TSfree(url);
+            ok = true;
+          }
+        }
+        TSHandleMLocRelease(req_buf, TS_NULL_MLOC, c_url);
+      }
+
+      if (ok && TSHttpHdrUrlSet(mbuf, hdr_loc, url_loc) == TS_SUCCESS) {
+        const char *host = TSUrlHostGet(mbuf, url_loc, &len);
+        TSMLoc field     = TSMimeHdrFieldFind(mbuf, hdr_loc, TS_MIME_FIELD_HOST, TS_MIME_LEN_HOST);
+
+        if (host && len > 0 && field) {
+          TSMimeHdrFieldValueStringSet(mbuf, hdr_loc, field, -1, host, len);
+        }
+        if (field) {
+          TSHandleMLocRelease(mbuf, hdr_loc, field);
+        }
+        for (auto const &header : FILTER_HEADERS) {
+          while ((field = TSMimeHdrFieldFind(mbuf, hdr_loc, header.name, header.len)) != TS_NULL_MLOC) {
+            TSMimeHdrFieldDestroy(mbuf, hdr_loc, field);
+            TSHandleMLocRelease(mbuf, hdr_loc, field);
+          }
+        }
+
+        TSIOBuffer buf          = TSIOBufferCreate();
+        TSIOBufferReader reader = TSIOBufferReaderAlloc(buf);
+        TSHttpHdrPrint(mbuf, hdr_loc, buf);
+        for (TSIOBufferBlock block = TSIOBufferReaderStart(reader); block; block = TSIOBufferBlockNext(block)) {
+          int64_t avail;
+          const char *data = TSIOBufferBlockReadStart(block, reader, &avail);
+          request.append(data, avail);
+        }
+        TSIOBufferReaderFree(reader);
+        TSIOBufferDestroy(buf);
+      } else {
+        ok = false;
+      }
+      TSHandleMLocRelease(mbuf, TS_NULL_MLOC, url_loc);
+    }
+    TSHandleMLocRelease(p_buf, TS_NULL_MLOC, p_url);
+  }
+
+  TSHandleMLocRelease(mbuf, TS_NULL_MLOC, hdr_loc);
+  TSMBufferDestroy(mbuf);
+  TSHandleMLocRelease(req_buf, TS_NULL_MLOC, req_loc);
+  return ok;
+}
+} // namespace
+
+bool
+is_precompress_txn(TSHttpTxn txnp)
+{
+  const char *tag = TSHttpTxnPluginTagGet(txnp);
+  return tag && strcmp(tag, PRECOMPRESS_TAG) == 0;
+}
+
+void
+precompress_variants(TSHttpTxn txnp, int algorithms)
+{
+  static const struct {
+    int algorithm;
+    const char *encoding;
+  } variants[] = {{ALGORITHM_BROTLI, "br"}, {ALGORITHM_ZSTD, "zstd"}, {ALGORITHM_GZIP, "gzip"}, {ALGORITHM_DEFLATE, "deflate"}};
+
+  sockaddr const *client_addr = TSHttpTxnClientAddrGet(txnp);
+  std::string request, cache_url;
+
+  if (!algorithms || !client_addr || (client_addr->sa_family != AF_INET && client_addr->sa_family != AF_INET6)) {
+    return;
+  }
+  if (!variant_request(txnp, request, cache_url)) {
+    error("cannot build the requests for the compressed variants");
+    return;
+  }
+
+  for (auto const &variant : variants) {
+    if (!(algorithms & variant.algorithm)) {
+      continue;
+    }
+
+    std::string key = cache_url + " " + variant.encoding;
+    {
+      std::lock_guard<std::mutex> guard(fetching_lock);
+      if (!fetching.insert(key).second) {
+        debug("already fetching %s", key.c_str());
+        continue;
+      }
+    }
+
+    Fetch *fetch = new Fetch;
+    fetch->key   = key;
+    fetch->request.append(request).append(TS_MIME_FIELD_ACCEPT_ENCODING).append(": ").append(variant.encoding).append("\r\n\r\n");
+    memcpy(&fetch->client_addr, client_addr, client_addr->sa_family == AF_INET ? sizeof(sockaddr_in) : sizeof(sockaddr_in6));
+
+    TSCont contp = TSContCreate(fetch_variant, TSMutexCreate());
+    TSContDataSet(contp, fetch);
+    TSHttpTxnHookAdd(txnp, TS_HTTP_TXN_CLOSE_HOOK, contp);
+  }
+}
@@ -0,0 +1,38 @@
+/** @file
+
+  Fetches the compressed variants of responses for the cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <ts/ts.h>
+
+/// True if @a txnp is one of the transactions fetching a compressed variant for the cache.
+bool is_precompress_txn(TSHttpTxn txnp);
+
+/**
+  Fetch the variants of the response of @a txnp compressed with each of @a algorithms, as the
+  transaction closes, for the cache to store them as alternates of the uncompressed response.
+
+  The variants are fetched by transactions of their own, sending the request of @a txnp with the
+  Accept-Encoding of the variant, one at a time for each URL and variant.
+ */
+void precompress_variants(TSHttpTxn txnp, int algorithms);
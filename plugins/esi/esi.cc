@@ -23,10 +23,12 @@
 
 #include "tscore/ink_defs.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <climits>
 #include <cstring>
+#include <ctime>
 #include <string>
 #include <list>
 #include <arpa/inet.h>
@@ -46,6 +48,7 @@
 #include "serverIntercept.h"
 #include "Stats.h"
 #include "HttpDataFetcherImpl.h"
+#include "StringCache.h"
 using std::string;
 using std::list;
 using namespace EsiLib;
@@ -56,11 +59,19 @@ struct OptionInfo {
   bool private_response;
   bool disable_gzip_output;
   bool first_byte_flush;
+  int max_concurrent_fetches;
+  int fragment_cache_ttl;
+  int template_cache_ttl;
 };
 
 static HandlerManager *gHandlerManager = nullptr;
 static Utils::HeaderValueList gAllowlistCookies;
 
+// shared by all the transactions and rules, of cache-size bytes each
+#define DEFAULT_CACHE_SIZE (16 * 1024 * 1024)
+static StringCache *gFragmentCache = nullptr;
+static StringCache *gTemplateCache = nullptr;
+
 #define DEBUG_TAG "plugin_esi"
 #define PROCESSOR_DEBUG_TAG "plugin_esi_processor"
 #define GZIP_DEBUG_TAG "plugin_esi_gzip"
@@ -81,8 +92,9 @@ enum DataType {
   DATA_TYPE_RAW_ESI     = 0,
   DATA_TYPE_GZIPPED_ESI = 1,
   DATA_TYPE_PACKED_ESI  = 2,
+  DATA_TYPE_CACHED_ESI  = 3, // parsed before, in the template cache
 };
-static const char *DATA_TYPE_NAMES_[] = {"RAW_ESI", "GZIPPED_ESI", "PACKED_ESI"};
+static const char *DATA_TYPE_NAMES_[] = {"RAW_ESI", "GZIPPED_ESI", "PACKED_ESI", "CACHED_ESI"};
 
 static const char *HEADER_MASK_PREFIX    = "Mask-";
 static const int HEADER_MASK_PREFIX_SIZE = 5;
@@ -111,6 +123,7 @@ struct ContData {
   sockaddr const *client_addr;
   DataType input_type;
   string packed_node_list;
+  string template_key;
   string gzipped_data;
   char debug_tag[32];
   bool gzip_output;
@@ -160,6 +173,12 @@ struct ContData {
 
   void checkXformStatus();
 
+  void createDataFetcher();
+
+  void lookupTemplate(TSMBuffer bufp, TSMLoc hdr_loc);
+
+  void cacheTemplate();
+
   bool init();
 
   ~ContData();
@@ -251,7 +270,7 @@ ContData::init()
 
     string fetcher_tag, vars_tag, expr_tag, proc_tag, gzip_tag, gunzip_tag;
     if (!data_fetcher) {
-      data_fetcher = new HttpDataFetcherImpl(contp, client_addr, createDebugTag(FETCHER_DEBUG_TAG, contp, fetcher_tag));
+      createDataFetcher();
     }
     if (!esi_vars) {
       esi_vars = new Variables(createDebugTag(VARS_DEBUG_TAG, contp, vars_tag), &TSDebug, &TSError, gAllowlistCookies);
@@ -276,6 +295,65 @@ lReturn:
   return retval;
 }
 
+void
+ContData::createDataFetcher()
+{
+  string fetcher_tag;
+
+  data_fetcher = new HttpDataFetcherImpl(contp, client_addr, createDebugTag(FETCHER_DEBUG_TAG, contp, fetcher_tag));
+  data_fetcher->setMaxConcurrentFetches(option_info->max_concurrent_fetches);
+  if (option_info->fragment_cache_ttl > 0) {
+    data_fetcher->useFragmentCache(gFragmentCache, option_info->fragment_cache_ttl);
+  }
+}
+
+static void
+appendHeaderValue(TSMBuffer bufp, TSMLoc hdr_loc, const char *name, int name_len, string &dest)
+{
+  TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, name, name_len);
+
+  if (field_loc) {
+    int value_len;
+    const char *value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &value_len);
+    if (value) {
+      dest.append(value, value_len);
+    }
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  }
+}
+
+// The template is the cached object, or the one about to be: its URL and validators are the key
+// of its parsed nodes, packed. A template without validators is parsed each time.
+void
+ContData::lookupTemplate(TSMBuffer bufp, TSMLoc hdr_loc)
+{
+  string validators;
+
+  appendHeaderValue(bufp, hdr_loc, TS_MIME_FIELD_ETAG, TS_MIME_LEN_ETAG, validators);
+  validators.append(1, '\n');
+  appendHeaderValue(bufp, hdr_loc, TS_MIME_FIELD_LAST_MODIFIED, TS_MIME_LEN_LAST_MODIFIED, validators);
+  if ((validators.size() == 1) || !request_url) {
+    return;
+  }
+
+  template_key.assign(request_url).append(1, '\n').append(validators);
+  if (gTemplateCache->get(template_key, packed_node_list, time(nullptr))) {
+    TSDebug(debug_tag, "[%s] Found parsed template of [%s]", __FUNCTION__, request_url);
+    Stats::increment(Stats::N_TEMPLATE_HITS);
+    input_type = DATA_TYPE_CACHED_ESI;
+  }
+}
+
+void
+ContData::cacheTemplate()
+{
+  string packed;
+
+  esi_proc->packNodeList(packed, false);
+  gTemplateCache->put(template_key, packed, time(nullptr) + option_info->template_cache_ttl);
+  TSDebug(debug_tag, "[%s] Cached parsed template of [%s], %d bytes", __FUNCTION__, request_url, static_cast<int>(packed.size()));
+}
+
 void
 ContData::getClientState()
 {
@@ -291,8 +369,7 @@ ContData::getClientState()
     esi_vars = new Variables(createDebugTag(VARS_DEBUG_TAG, contp, vars_tag), &TSDebug, &TSError, gAllowlistCookies);
   }
   if (!data_fetcher) {
-    string fetcher_tag;
-    data_fetcher = new HttpDataFetcherImpl(contp, client_addr, createDebugTag(FETCHER_DEBUG_TAG, contp, fetcher_tag));
+    createDataFetcher();
   }
   if (req_bufp && req_hdr_loc) {
     TSMBuffer bufp;
@@ -475,6 +552,10 @@ ContData::getServerState()
     fillPostHeader(bufp, hdr_loc);
   }
 
+  if ((option_info->template_cache_ttl > 0) && !head_only) {
+    lookupTemplate(bufp, hdr_loc);
+  }
+
   TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
 }
 
@@ -679,9 +760,9 @@ transformData(TSCont contp)
             string udata = "";
             cont_data->esi_gunzip->stream_decode(data, data_len, udata);
             cont_data->esi_proc->addParseData(udata.data(), udata.size());
-          } else {
+          } else if (cont_data->input_type == DATA_TYPE_PACKED_ESI) {
             cont_data->packed_node_list.append(data, data_len);
-          }
+          } // else the template is parsed already, the document is only drained
           TSDebug(cont_data->debug_tag, "[%s] Added chunk of %" PRId64 " bytes starting with [%.10s] to parse list", __FUNCTION__,
                   data_len, (data_len ? data : "(null)"));
           consumed += data_len;
@@ -709,7 +790,13 @@ transformData(TSCont contp)
   }
   if (process_input_complete) {
     TSDebug(cont_data->debug_tag, "[%s] Completed reading input", __FUNCTION__);
-    if (cont_data->input_type == DATA_TYPE_PACKED_ESI) {
+    if (cont_data->input_type == DATA_TYPE_CACHED_ESI) {
+      if (cont_data->esi_proc->usePackedNodeList(cont_data->packed_node_list) == EsiProcessor::UNPACK_FAILURE) {
+        // the document was not kept, it can't be parsed instead
+        TSError("[esi][%s] Could not use the parsed template of [%s]", __FUNCTION__, cont_data->request_url);
+        gTemplateCache->remove(cont_data->template_key);
+      }
+    } else if (cont_data->input_type == DATA_TYPE_PACKED_ESI) {
       TSDebug(DEBUG_TAG, "[%s] Going to use packed node list of size %d", __FUNCTION__,
               static_cast<int>(cont_data->packed_node_list.size()));
       if (cont_data->esi_proc->usePackedNodeList(cont_data->packed_node_list) == EsiProcessor::UNPACK_FAILURE) {
@@ -721,12 +808,15 @@ transformData(TSCont contp)
       }
     }
 
-    if (cont_data->input_type != DATA_TYPE_PACKED_ESI) {
+    if ((cont_data->input_type == DATA_TYPE_RAW_ESI) || (cont_data->input_type == DATA_TYPE_GZIPPED_ESI)) {
       bool gunzip_complete = true;
       if (cont_data->input_type == DATA_TYPE_GZIPPED_ESI) {
         gunzip_complete = cont_data->esi_gunzip->stream_finish();
       }
       if (cont_data->esi_proc->completeParse() && gunzip_complete) {
+        if (!cont_data->template_key.empty()) {
+          cont_data->cacheTemplate();
+        }
         if (cont_data->option_info->packed_node_support && cont_data->os_response_cacheable && !cont_data->cache_txn &&
             !cont_data->head_only) {
           cacheNodeList(cont_data);
@@ -1577,6 +1667,7 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
 
   memset(pOptionInfo, 0, sizeof(struct OptionInfo));
 
+  int64_t cache_size = 0;
   if (argc > 1) {
     int c;
     static const struct option longopts[] = {
@@ -1585,11 +1676,15 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
       {const_cast<char *>("disable-gzip-output"), no_argument, nullptr, 'z'},
       {const_cast<char *>("first-byte-flush"), no_argument, nullptr, 'b'},
       {const_cast<char *>("handler-filename"), required_argument, nullptr, 'f'},
+      {const_cast<char *>("max-concurrent-fetches"), required_argument, nullptr, 'c'},
+      {const_cast<char *>("fragment-cache-ttl"), required_argument, nullptr, 't'},
+      {const_cast<char *>("template-cache-ttl"), required_argument, nullptr, 'm'},
+      {const_cast<char *>("cache-size"), required_argument, nullptr, 's'},
       {nullptr, 0, nullptr, 0},
     };
 
     int longindex = 0;
-    while ((c = getopt_long(argc, const_cast<char *const *>(argv), "npzbf:", longopts, &longindex)) != -1) {
+    while ((c = getopt_long(argc, const_cast<char *const *>(argv), "npzbf:c:t:m:s:", longopts, &longindex)) != -1) {
       switch (c) {
       case 'n':
         pOptionInfo->packed_node_support = true;
@@ -1609,18 +1704,46 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
         gHandlerManager->loadObjects(handler_conf);
         break;
       }
+      case 'c':
+        pOptionInfo->max_concurrent_fetches = std::max(atoi(optarg), 0);
+        break;
+      case 't':
+        pOptionInfo->fragment_cache_ttl = std::max(atoi(optarg), 0);
+        break;
+      case 'm':
+        pOptionInfo->template_cache_ttl = std::max(atoi(optarg), 0);
+        break;
+      case 's':
+        cache_size = atoll(optarg);
+        if (cache_size <= 0) {
+          TSError("[esi][%s] Invalid cache-size %s, using %d", __FUNCTION__, optarg, DEFAULT_CACHE_SIZE);
+          cache_size = DEFAULT_CACHE_SIZE;
+        }
+        break;
       default:
         break;
       }
     }
   }
 
+  // the caches are shared, the last cache-size given is theirs
+  if (!gFragmentCache) {
+    gFragmentCache = new StringCache(DEFAULT_CACHE_SIZE);
+    gTemplateCache = new StringCache(DEFAULT_CACHE_SIZE);
+  }
+  if (cache_size > 0) {
+    gFragmentCache->setMaxBytes(cache_size);
+    gTemplateCache->setMaxBytes(cache_size);
+  }
+
   TSDebug(DEBUG_TAG,
           "[%s] Plugin started, "
           "packed-node-support: %d, private-response: %d, "
-          "disable-gzip-output: %d, first-byte-flush: %d ",
+          "disable-gzip-output: %d, first-byte-flush: %d, "
+          "max-concurrent-fetches: %d, fragment-cache-ttl: %d, template-cache-ttl: %d ",
           __FUNCTION__, pOptionInfo->packed_node_support, pOptionInfo->private_response, pOptionInfo->disable_gzip_output,
-          pOptionInfo->first_byte_flush);
+          pOptionInfo->first_byte_flush, pOptionInfo->max_concurrent_fetches, pOptionInfo->fragment_cache_ttl,
+          pOptionInfo->template_cache_ttl);
 
   return 0;
 }
@@ -24,9 +24,12 @@
 #include "HttpDataFetcherImpl.h"
 #include "lib/Utils.h"
 #include "lib/gzip.h"
+#include "lib/Stats.h"
 
 #include <arpa/inet.h>
+#include <algorithm>
 #include <cstdlib>
+#include <ctime>
 
 using std::string;
 using namespace EsiLib;
@@ -91,6 +94,22 @@ HttpDataFetcherImpl::addFetchRequest(const string &url, FetchedDataProcessor *ca
     return true;
   }
 
+  // a fragment in the cache is complete right away; a callback would be called back before this returns, so these fetch
+  string cached_response;
+  if (_fragment_cache && !callback_obj && _fragment_cache->get(url, cached_response, time(nullptr))) {
+    RequestData &req_data = insert_result.first->second;
+
+    TSDebug(_debug_tag, "[%s] Found url [%s] in the fragment cache", __FUNCTION__, url.data());
+    Stats::increment(Stats::N_FRAGMENT_HITS);
+    req_data.complete = true;
+    if (_processResponse(url, req_data, cached_response.data(), cached_response.size())) {
+      return true;
+    }
+    // not what was stored, fetch it
+    _fragment_cache->remove(url);
+    req_data.complete = false;
+  }
+
   char buff[1024];
   char *http_req;
   int length;
@@ -114,7 +133,12 @@ HttpDataFetcherImpl::addFetchRequest(const string &url, FetchedDataProcessor *ca
   event_ids.timeout_event_id = _curr_event_id_base + 2;
   _curr_event_id_base += 3;
 
-  TSFetchUrl(http_req, length, reinterpret_cast<sockaddr *>(&_client_addr), _contp, AFTER_BODY, event_ids);
+  if (_max_fetches > 0 && _n_in_flight >= _max_fetches) {
+    TSDebug(_debug_tag, "[%s] %d fetches in flight, queuing request for URL [%s]", __FUNCTION__, _n_in_flight, url.data());
+    _queued_fetches.push_back(QueuedFetch{string(http_req, length), event_ids});
+  } else {
+    _startFetch(http_req, length, event_ids);
+  }
   if (http_req != buff) {
     free(http_req);
   }
@@ -125,6 +149,13 @@ HttpDataFetcherImpl::addFetchRequest(const string &url, FetchedDataProcessor *ca
   return true;
 }
 
+void
+HttpDataFetcherImpl::_startFetch(const char *http_req, int length, TSFetchEvent &event_ids)
+{
+  TSFetchUrl(http_req, length, reinterpret_cast<sockaddr *>(&_client_addr), _contp, AFTER_BODY, event_ids);
+  ++_n_in_flight;
+}
+
 bool
 HttpDataFetcherImpl::_isFetchEvent(TSEvent event, int &base_event_id) const
 {
@@ -159,6 +190,13 @@ HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
   --_n_pending_requests;
   req_data.complete = true;
 
+  --_n_in_flight;
+  if (!_queued_fetches.empty()) {
+    QueuedFetch &next = _queued_fetches.front();
+    _startFetch(next.request.data(), next.request.size(), next.event_ids);
+    _queued_fetches.pop_front();
+  }
+
   int event_id = (static_cast<int>(event) - FETCH_EVENT_ID_BASE) % 3;
   if (event_id != 0) { // failure or timeout
     TSError("[HttpDataFetcherImpl][%s] Received failure/timeout event id %d for request [%s]", __FUNCTION__, event_id,
@@ -168,6 +206,23 @@ HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
 
   int page_data_len;
   const char *page_data = TSFetchRespGet(static_cast<TSHttpTxn>(edata), &page_data_len);
+
+  if (_processResponse(req_str, req_data, page_data, page_data_len) && _fragment_cache &&
+      req_data.resp_status == TS_HTTP_STATUS_OK) {
+    int ttl = _getFragmentTtl(req_data.bufp, req_data.hdr_loc);
+    if (ttl > 0) {
+      TSDebug(_debug_tag, "[%s] Caching url [%s] for %d seconds", __FUNCTION__, req_str.c_str(), ttl);
+      _fragment_cache->put(req_str, req_data.response, time(nullptr) + ttl);
+    }
+  }
+
+  return true;
+}
+
+// parses the response to a fetch into req_data, and hands its body to the callbacks; false if it is not a valid response
+bool
+HttpDataFetcherImpl::_processResponse(const string &req_str, RequestData &req_data, const char *page_data, int page_data_len)
+{
   req_data.response.assign(page_data, page_data_len);
   bool valid_data_received = false;
   const char *startptr = req_data.response.data(), *endptr = startptr + page_data_len;
@@ -224,7 +279,43 @@ HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
     req_data.response.clear();
   }
 
-  return true;
+  return valid_data_received;
+}
+
+// the seconds the response can be kept in the fragment cache for, at most its max-age; 0 if it is not to be shared
+int
+HttpDataFetcherImpl::_getFragmentTtl(TSMBuffer bufp, TSMLoc hdr_loc) const
+{
+  if (_checkHeaderValue(bufp, hdr_loc, TS_MIME_FIELD_SET_COOKIE, TS_MIME_LEN_SET_COOKIE, nullptr, 0, false) ||
+      _checkHeaderValue(bufp, hdr_loc, TS_MIME_FIELD_VARY, TS_MIME_LEN_VARY, nullptr, 0, false)) {
+    return 0;
+  }
+
+  int ttl          = _fragment_ttl;
+  TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, TS_MIME_FIELD_CACHE_CONTROL, TS_MIME_LEN_CACHE_CONTROL);
+  if (field_loc) {
+    int n_values = TSMimeHdrFieldValuesCount(bufp, hdr_loc, field_loc);
+
+    for (int i = 0; (i < n_values) && (ttl > 0); ++i) {
+      int value_len;
+      const char *value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, i, &value_len);
+
+      if (!value) {
+        continue;
+      }
+      if (Utils::areEqual(value, value_len, TS_HTTP_VALUE_PRIVATE, TS_HTTP_LEN_PRIVATE) ||
+          Utils::areEqual(value, value_len, TS_HTTP_VALUE_NO_STORE, TS_HTTP_LEN_NO_STORE) ||
+          Utils::areEqual(value, value_len, TS_HTTP_VALUE_NO_CACHE, TS_HTTP_LEN_NO_CACHE)) {
+        ttl = 0;
+      } else if ((value_len > TS_HTTP_LEN_MAX_AGE) && (strncasecmp(value, TS_HTTP_VALUE_MAX_AGE, TS_HTTP_LEN_MAX_AGE) == 0) &&
+                 (value[TS_HTTP_LEN_MAX_AGE] == '=')) {
+        ttl = std::min(ttl, atoi(value + TS_HTTP_LEN_MAX_AGE + 1));
+      }
+    }
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  }
+
+  return std::max(ttl, 0);
 }
 
 bool
@@ -302,6 +393,8 @@ HttpDataFetcherImpl::clear()
     _release(iter->second);
   }
   _n_pending_requests = 0;
+  _n_in_flight        = 0;
+  _queued_fetches.clear();
   _pages.clear();
   _page_entry_lookup.clear();
   _headers_str.clear();
@@ -25,11 +25,13 @@
 
 #include <string>
 #include <list>
+#include <deque>
 #include <vector>
 #include <netinet/in.h>
 
 #include "ts/ts.h"
 #include "lib/StringHash.h"
+#include "lib/StringCache.h"
 #include "lib/HttpHeader.h"
 #include "HttpDataFetcher.h"
 
@@ -44,6 +46,23 @@ public:
 
   bool addFetchRequest(const std::string &url, FetchedDataProcessor *callback_obj = nullptr) override;
 
+  /** Caps the fetches in flight at @a max_fetches, the others wait for one
+   * of them to complete; 0 is no cap */
+  void
+  setMaxConcurrentFetches(int max_fetches)
+  {
+    _max_fetches = max_fetches;
+  }
+
+  /** Serves the fetches from @a cache, and keeps the responses that can be
+   * shared there for at most @a ttl seconds */
+  void
+  useFragmentCache(EsiLib::StringCache *cache, int ttl)
+  {
+    _fragment_cache = cache;
+    _fragment_ttl   = ttl;
+  }
+
   bool handleFetchEvent(TSEvent event, void *edata);
 
   bool
@@ -132,6 +151,18 @@ private:
   int _curr_event_id_base;
   TSHttpParser _http_parser;
 
+  // the fetches waiting for one in flight to complete
+  struct QueuedFetch {
+    std::string request;
+    TSFetchEvent event_ids;
+  };
+  std::deque<QueuedFetch> _queued_fetches;
+  int _n_in_flight = 0;
+  int _max_fetches = 0;
+
+  EsiLib::StringCache *_fragment_cache = nullptr;
+  int _fragment_ttl                    = 0;
+
   static const int FETCH_EVENT_ID_BASE;
 
   int
@@ -148,6 +179,10 @@ private:
 
   inline void _release(RequestData &req_data);
 
+  void _startFetch(const char *http_req, int length, TSFetchEvent &event_ids);
+  bool _processResponse(const std::string &req_str, RequestData &req_data, const char *page_data, int page_data_len);
+  int _getFragmentTtl(TSMBuffer bufp, TSMLoc hdr_loc) const;
+
   struct sockaddr_storage _client_addr;
 };
 
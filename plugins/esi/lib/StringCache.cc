@@ -0,0 +1,92 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "StringCache.h"
+
+#include <iterator>
+
+using std::string;
+using namespace EsiLib;
+
+bool
+StringCache::get(const string &key, string &value, time_t now)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+
+  if (iter == _entries.end()) {
+    return false;
+  }
+  if (iter->second->expires <= now) {
+    _erase(iter->second);
+    return false;
+  }
+  _lru.splice(_lru.begin(), _lru, iter->second);
+  value = iter->second->value;
+  return true;
+}
+
+void
+StringCache::put(const string &key, const string &value, time_t expires)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+
+  if (iter != _entries.end()) {
+    _erase(iter->second);
+  }
+  if (key.size() + value.size() > _max_bytes) {
+    return;
+  }
+  _lru.push_front(Entry{key, value, expires});
+  _entries[key] = _lru.begin();
+  _bytes += key.size() + value.size();
+  _evict();
+}
+
+void
+StringCache::remove(const string &key)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+
+  if (iter != _entries.end()) {
+    _erase(iter->second);
+  }
+}
+
+void
+StringCache::_erase(EntryList::iterator iter)
+{
+  _bytes -= iter->key.size() + iter->value.size();
+  _entries.erase(iter->key);
+  _lru.erase(iter);
+}
+
+void
+StringCache::_evict()
+{
+  while (_bytes > _max_bytes && !_lru.empty()) {
+    _erase(std::prev(_lru.end()));
+  }
+}
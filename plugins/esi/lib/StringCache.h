@@ -0,0 +1,96 @@
+/** @file
+
+  A size bounded cache of strings, with a time to live per entry.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace EsiLib
+{
+/** A cache of strings by key, shared by the transactions: the least recently
+ *  used entries go when the keys and values are over the size, and an entry
+ *  is a miss once it expires. */
+class StringCache
+{
+public:
+  explicit StringCache(size_t max_bytes) : _max_bytes(max_bytes) {}
+
+  StringCache(const StringCache &) = delete;
+  StringCache &operator=(const StringCache &) = delete;
+
+  /** copies the value of @a key, if it is there and has not expired by @a now */
+  bool get(const std::string &key, std::string &value, time_t now);
+
+  /** sets the value of @a key, until @a expires; a value bigger than the
+   *  cache is not stored */
+  void put(const std::string &key, const std::string &value, time_t expires);
+
+  void remove(const std::string &key);
+
+  void
+  setMaxBytes(size_t max_bytes)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _max_bytes = max_bytes;
+    _evict();
+  }
+
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+  }
+
+  size_t
+  bytes() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+  }
+
+private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    time_t expires;
+  };
+
+  // most recently used first
+  typedef std::list<Entry> EntryList;
+
+  void _erase(EntryList::iterator iter);
+  void _evict();
+
+  size_t _max_bytes;
+  size_t _bytes = 0;
+  EntryList _lru;
+  std::unordered_map<std::string, EntryList::iterator> _entries;
+  mutable std::mutex _mutex;
+};
+}; // namespace EsiLib
@@ -0,0 +1,93 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <iostream>
+#include <cassert>
+#include <string>
+
+#include "StringCache.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using namespace EsiLib;
+
+int
+main()
+{
+  {
+    cout << endl << "===================== Test 1) hit, miss and expiry" << endl;
+    StringCache cache(1024);
+    string value;
+
+    assert(cache.get("a", value, 100) == false);
+    cache.put("a", "alpha", 110);
+    assert(cache.get("a", value, 100) == true);
+    assert(value == "alpha");
+    assert(cache.get("a", value, 110) == false);
+    assert(cache.size() == 0);
+    assert(cache.bytes() == 0);
+  }
+
+  {
+    cout << endl << "===================== Test 2) replace and remove" << endl;
+    StringCache cache(1024);
+    string value;
+
+    cache.put("a", "alpha", 200);
+    cache.put("a", "aleph", 200);
+    assert(cache.size() == 1);
+    assert(cache.bytes() == 6);
+    assert(cache.get("a", value, 100) == true);
+    assert(value == "aleph");
+    cache.remove("a");
+    assert(cache.get("a", value, 100) == false);
+    assert(cache.bytes() == 0);
+  }
+
+  {
+    cout << endl << "===================== Test 3) the least recently used go over the size" << endl;
+    StringCache cache(20);
+    string value;
+
+    cache.put("a", "111111111", 200); // 10 bytes
+    cache.put("b", "222222222", 200);
+    assert(cache.get("a", value, 100) == true);
+    cache.put("c", "333333333", 200); // b is the least recently used
+    assert(cache.size() == 2);
+    assert(cache.get("b", value, 100) == false);
+    assert(cache.get("a", value, 100) == true);
+    assert(cache.get("c", value, 100) == true);
+
+    cache.put("d", string(64, 'd'), 200); // too big, not stored
+    assert(cache.get("d", value, 100) == false);
+    assert(cache.size() == 2);
+
+    cache.setMaxBytes(10);
+    assert(cache.size() == 1);
+    assert(cache.get("c", value, 100) == true);
+  }
+
+  cout << endl << "All tests passed!" << endl;
+  return 0;
+}
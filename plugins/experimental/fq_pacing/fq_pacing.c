@@ -16,7 +16,10 @@
  * limitations under the License.
  */
 
+#include "tscore/ink_config.h"
+
 #include <errno.h>
+#include <stddef.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,20 +28,39 @@
 #include <ts/remap.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+// The delivery rate is only in the tcp_info of linux/tcp.h
+#if HAVE_STRUCT_TCP_INFO_DELIVERY_RATE
+#include <linux/tcp.h>
+#endif
 
 static const char *PLUGIN_NAME = "fq_pacing";
 
 // Sanity check max rate at 100Gbps
 #define MAX_PACING_RATE 100000000000
 
+#define DEFAULT_FACTOR 1.5
+
 typedef struct fq_pacing_config {
   unsigned long pacing_rate;
+  char *bitrate_header; // bits per second of the media, in the response
+  int bitrate_header_len;
+  double factor;
+  int adaptive;
 } fq_pacing_cfg_t;
 
 typedef struct fq_pacing_cont {
   int client_fd;
+  const fq_pacing_cfg_t *cfg;
+  unsigned long pacing_rate; // what the connection is paced at, 0 if it is not
 } fq_pacing_cont_t;
 
+static int paced_stat         = -1;
+static int bitrate_paced_stat = -1;
+static int adapted_stat       = -1;
+static int pacing_rate_stat   = -1;
+static int delivery_rate_stat = -1;
+
 // Copied from ts/ink_sock.cc since that function is not exposed to plugins
 int
 safe_setsockopt(int s, int level, int optname, char *optval, int optlevel)
@@ -80,6 +102,111 @@ fq_is_default_qdisc()
   return (rc);
 }
 
+static void
+create_stat(const char *name, TSStatSync sync, int *id)
+{
+  if (TSStatFindName(name, id) == TS_ERROR) {
+    *id = TSStatCreate(name, TS_RECORDDATATYPE_INT, TS_STAT_NON_PERSISTENT, sync);
+  }
+}
+
+// The rate at which the connection delivered its data lately, in bytes per second, 0 if it is not known
+static unsigned long
+delivery_rate(int fd)
+{
+#if HAVE_STRUCT_TCP_INFO_DELIVERY_RATE
+  struct tcp_info info;
+  socklen_t info_len = sizeof(info);
+
+  memset(&info, 0, sizeof(info));
+  if (fd > 0 && getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &info_len) == 0 &&
+      info_len >= offsetof(struct tcp_info, tcpi_delivery_rate) + sizeof(info.tcpi_delivery_rate)) {
+    return (unsigned long)info.tcpi_delivery_rate;
+  }
+#endif
+  return 0;
+}
+
+static void
+set_pacing_rate(fq_pacing_cont_t *txn_data, unsigned long pacing_rate)
+{
+#ifdef SO_MAX_PACING_RATE
+  int res = 0;
+
+  res = safe_setsockopt(txn_data->client_fd, SOL_SOCKET, SO_MAX_PACING_RATE, (char *)&pacing_rate, sizeof(pacing_rate));
+  if ((res < 0)) {
+    TSError("[fq_pacing] Error setting SO_MAX_PACING_RATE, errno=%d", errno);
+    return;
+  }
+  TSDebug(PLUGIN_NAME, "Setting SO_MAX_PACING_RATE for client_fd=%d to %lu Bps", txn_data->client_fd, pacing_rate);
+  txn_data->pacing_rate = pacing_rate;
+#endif
+}
+
+// The bits per second of the media in the response, 0 if the response does not say
+static unsigned long
+response_bitrate(TSHttpTxn txnp, const fq_pacing_cfg_t *cfg)
+{
+  TSMBuffer bufp;
+  TSMLoc hdr_loc;
+  TSMLoc field_loc;
+  unsigned long bitrate = 0;
+
+  if (TSHttpTxnClientRespGet(txnp, &bufp, &hdr_loc) != TS_SUCCESS) {
+    return 0;
+  }
+
+  if ((field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, cfg->bitrate_header, cfg->bitrate_header_len)) != TS_NULL_MLOC) {
+    int len           = 0;
+    const char *value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, 0, &len);
+    char buf[32];
+
+    if (value && len > 0 && len < (int)sizeof(buf)) {
+      memcpy(buf, value, len);
+      buf[len] = '\0';
+      bitrate  = strtoul(buf, NULL, 10);
+    }
+    TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+  }
+  TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
+  return bitrate;
+}
+
+// Pace at the bitrate of the media times the factor, or at what the connection delivers times the factor
+// when that is less: pacing faster than the path drains only fills the buffers along it. Never slower than
+// the media plays, not to stall it.
+static void
+pace_response(TSHttpTxn txnp, fq_pacing_cont_t *txn_data)
+{
+  const fq_pacing_cfg_t *cfg = txn_data->cfg;
+  unsigned long bitrate      = response_bitrate(txnp, cfg);
+  unsigned long media_rate   = bitrate / 8;
+  unsigned long pacing_rate  = 0;
+
+  if (media_rate == 0) {
+    TSDebug(PLUGIN_NAME, "No %s in the response, keeping the pacing rate", cfg->bitrate_header);
+    return;
+  }
+
+  pacing_rate = (unsigned long)(media_rate * cfg->factor);
+  if (cfg->adaptive) {
+    unsigned long delivered = delivery_rate(txn_data->client_fd);
+    unsigned long adapted   = (unsigned long)(delivered * cfg->factor);
+
+    if (delivered > 0 && adapted < pacing_rate) {
+      pacing_rate = adapted > media_rate ? adapted : media_rate;
+      TSDebug(PLUGIN_NAME, "Connection delivers %lu Bps, adapting the pacing rate to %lu Bps", delivered, pacing_rate);
+      TSStatIntIncrement(adapted_stat, 1);
+    }
+  }
+  if (pacing_rate > MAX_PACING_RATE) {
+    pacing_rate = MAX_PACING_RATE;
+  }
+
+  set_pacing_rate(txn_data, pacing_rate);
+  TSStatIntIncrement(bitrate_paced_stat, 1);
+}
+
 void
 TSPluginInit(int argc, const char *argv[])
 {
@@ -118,6 +245,12 @@ TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
     return TS_ERROR;
   }
 
+  create_stat("plugin.fq_pacing.paced", TS_STAT_SYNC_COUNT, &paced_stat);
+  create_stat("plugin.fq_pacing.bitrate_paced", TS_STAT_SYNC_COUNT, &bitrate_paced_stat);
+  create_stat("plugin.fq_pacing.adapted", TS_STAT_SYNC_COUNT, &adapted_stat);
+  create_stat("plugin.fq_pacing.pacing_rate", TS_STAT_SYNC_AVG, &pacing_rate_stat);
+  create_stat("plugin.fq_pacing.delivery_rate", TS_STAT_SYNC_AVG, &delivery_rate_stat);
+
   TSDebug(PLUGIN_NAME, "plugin is successfully initialized");
   return TS_SUCCESS;
 }
@@ -125,18 +258,25 @@ TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
 TSReturnCode
 TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_size)
 {
-  fq_pacing_cfg_t *cfg      = NULL;
-  unsigned long pacing_rate = 0;
+  fq_pacing_cfg_t *cfg       = NULL;
+  unsigned long pacing_rate  = 0;
+  const char *bitrate_header = NULL;
+  double factor              = DEFAULT_FACTOR;
+  int adaptive               = 0;
 
   TSDebug(PLUGIN_NAME, "Instantiating a new remap.config plugin rule");
 
   if (argc > 1) {
     int c;
-    static const struct option longopts[] = {{"rate", required_argument, NULL, 'r'}, {NULL, 0, NULL, 0}};
+    static const struct option longopts[] = {{"rate", required_argument, NULL, 'r'},
+                                             {"bitrate-header", required_argument, NULL, 'b'},
+                                             {"factor", required_argument, NULL, 'f'},
+                                             {"adaptive", no_argument, NULL, 'a'},
+                                             {NULL, 0, NULL, 0}};
 
     // The "-" in optstring is required to prevent permutation of argv, which
     // makes the plugin loader crashy
-    while ((c = getopt_long(argc, (char *const *)argv, "-r:", longopts, NULL)) != -1) {
+    while ((c = getopt_long(argc, (char *const *)argv, "-r:b:f:a", longopts, NULL)) != -1) {
       switch (c) {
       case 'r':
         errno       = 0;
@@ -146,6 +286,19 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_s
           return TS_ERROR;
         }
 
+        break;
+      case 'b':
+        bitrate_header = optarg;
+        break;
+      case 'f':
+        factor = strtod(optarg, NULL);
+        if (factor < 1.0) {
+          snprintf(errbuf, errbuf_size - 1, "[TsRemapNewInstance] input factor is not a number of at least 1.0");
+          return TS_ERROR;
+        }
+        break;
+      case 'a':
+        adaptive = 1;
         break;
       }
     }
@@ -160,8 +313,15 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_s
   cfg = TSmalloc(sizeof(fq_pacing_cfg_t));
   memset(cfg, 0, sizeof(*cfg));
   cfg->pacing_rate = pacing_rate;
-  *ih              = (void *)cfg;
-  TSDebug(PLUGIN_NAME, "Setting pacing rate to %lu", pacing_rate);
+  cfg->factor      = factor;
+  cfg->adaptive    = adaptive;
+  if (bitrate_header && *bitrate_header) {
+    cfg->bitrate_header     = TSstrdup(bitrate_header);
+    cfg->bitrate_header_len = strlen(bitrate_header);
+  }
+  *ih = (void *)cfg;
+  TSDebug(PLUGIN_NAME, "Setting pacing rate to %lu, bitrate header %s, factor %.2f%s", pacing_rate,
+          cfg->bitrate_header ? cfg->bitrate_header : "none", factor, adaptive ? ", adaptive" : "");
 
   return TS_SUCCESS;
 }
@@ -172,16 +332,38 @@ TSRemapDeleteInstance(void *instance)
   TSError("[fq_pacing] Cleaning up...");
 
   if (instance != NULL) {
-    TSfree((fq_pacing_cfg_t *)instance);
+    fq_pacing_cfg_t *cfg = (fq_pacing_cfg_t *)instance;
+
+    TSfree(cfg->bitrate_header);
+    TSfree(cfg);
   }
 }
 
 static int
-reset_pacing_cont(TSCont contp, TSEvent event, void *edata)
+pacing_cont(TSCont contp, TSEvent event, void *edata)
 {
   TSHttpTxn txnp             = (TSHttpTxn)edata;
   fq_pacing_cont_t *txn_data = TSContDataGet(contp);
 
+  if (event == TS_EVENT_HTTP_SEND_RESPONSE_HDR) {
+    pace_response(txnp, txn_data);
+    TSHttpTxnReenable(txnp, TS_EVENT_HTTP_CONTINUE);
+    return 0;
+  }
+
+  // What the connection achieved while it was paced
+  if (txn_data->pacing_rate > 0) {
+    unsigned long delivered = delivery_rate(txn_data->client_fd);
+
+    TSStatIntIncrement(paced_stat, 1);
+    TSStatIntIncrement(pacing_rate_stat, txn_data->pacing_rate);
+    if (delivered > 0) {
+      TSDebug(PLUGIN_NAME, "client_fd=%d paced at %lu Bps delivered %lu Bps", txn_data->client_fd, txn_data->pacing_rate,
+              delivered);
+      TSStatIntIncrement(delivery_rate_stat, delivered);
+    }
+  }
+
 #ifdef SO_MAX_PACING_RATE
   unsigned int pacing_off = ~0U;
   if (txn_data->client_fd > 0) {
@@ -196,6 +378,7 @@ reset_pacing_cont(TSCont contp, TSEvent event, void *edata)
 #endif
 
   TSfree(txn_data);
+  TSContDestroy(contp);
   TSHttpTxnReenable(txnp, TS_EVENT_HTTP_CONTINUE);
   return 0;
 }
@@ -213,25 +396,26 @@ TSRemapDoRemap(void *instance, TSHttpTxn txnp, TSRemapRequestInfo *rri)
     TSError("[fq_pacing] Error getting client fd");
   }
 
-#ifdef SO_MAX_PACING_RATE
-  fq_pacing_cfg_t *cfg = (fq_pacing_cfg_t *)instance;
-  int res              = 0;
+  fq_pacing_cfg_t *cfg       = (fq_pacing_cfg_t *)instance;
+  fq_pacing_cont_t *txn_data = TSmalloc(sizeof(fq_pacing_cont_t));
+  txn_data->client_fd        = client_fd;
+  txn_data->cfg              = cfg;
+  txn_data->pacing_rate      = 0;
 
-  res = safe_setsockopt(client_fd, SOL_SOCKET, SO_MAX_PACING_RATE, (char *)&cfg->pacing_rate, sizeof(cfg->pacing_rate));
-  if ((res < 0)) {
-    TSError("[fq_pacing] Error setting SO_MAX_PACING_RATE, errno=%d", errno);
+  // Without a bitrate header configured, or until the response says what
+  // its bitrate is, the connection is paced at the configured rate
+  if (cfg->pacing_rate > 0 || !cfg->bitrate_header) {
+    set_pacing_rate(txn_data, cfg->pacing_rate);
   }
-  TSDebug(PLUGIN_NAME, "Setting SO_MAX_PACING_RATE for client_fd=%d to %lu Bps", client_fd, cfg->pacing_rate);
-#endif
 
   // Reset pacing at end of transaction in case session is
   // reused for another delivery service w/o pacing
-  TSCont cont = TSContCreate(reset_pacing_cont, NULL);
-
-  fq_pacing_cont_t *txn_data = TSmalloc(sizeof(fq_pacing_cont_t));
-  txn_data->client_fd        = client_fd;
+  TSCont cont = TSContCreate(pacing_cont, NULL);
   TSContDataSet(cont, txn_data);
 
+  if (cfg->bitrate_header) {
+    TSHttpTxnHookAdd(txnp, TS_HTTP_SEND_RESPONSE_HDR_HOOK, cont);
+  }
   TSHttpTxnHookAdd(txnp, TS_HTTP_TXN_CLOSE_HOOK, cont);
   return TSREMAP_NO_REMAP;
 }
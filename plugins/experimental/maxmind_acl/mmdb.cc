@@ -18,6 +18,20 @@
 
 #include "mmdb.h"
 
+std::atomic<uint64_t> Acl::_ids{0};
+
+namespace
+{
+// The country of a recently looked up IP, for the ruleset and database of an Acl
+struct GeoCacheEntry {
+  uint64_t acl = 0; // the Acl::_id, 0 while the entry is empty
+  IpAddr addr;
+  int country = GEO_NOT_FOUND;
+};
+
+thread_local GeoCacheEntry geo_cache[GEO_CACHE_SIZE];
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // Load the config file from param
 // check for basics
@@ -30,6 +44,9 @@ Acl::init(char const *filename)
 
   YAML::Node maxmind;
 
+  // The cached lookups of a previous ruleset or database no longer apply
+  _id = ++_ids;
+
   configloc.clear();
 
   if (filename[0] != '/') {
@@ -89,7 +106,8 @@ Acl::init(char const *filename)
 
   // Clear out existing data, these may no longer exist in a new config and so we
   // dont want old ones left behind
-  allow_country.clear();
+  listed_country.reset();
+  allow_country.reset();
   allow_ip_map.clear();
   deny_ip_map.clear();
   allow_regex.clear();
@@ -147,16 +165,7 @@ Acl::loaddeny(const YAML::Node &denyNode)
   // Load Allowable Country codes
   try {
     if (denyNode["country"]) {
-      YAML::Node country = denyNode["country"];
-      if (!country.IsNull()) {
-        if (country.IsSequence()) {
-          for (std::size_t i = 0; i < country.size(); i++) {
-            allow_country.insert_or_assign(country[i].as<std::string>(), false);
-          }
-        } else {
-          TSDebug(PLUGIN_NAME, "Invalid country code allow list yaml");
-        }
-      }
+      loadcountries(denyNode["country"], false);
     }
   } catch (const YAML::Exception &e) {
     TSDebug(PLUGIN_NAME, "YAML::Exception %s when parsing YAML config file country code deny list for maxmind", e.what());
@@ -191,14 +200,6 @@ Acl::loaddeny(const YAML::Node &denyNode)
     parseregex(regex, false);
   }
 
-#if 0
-  std::unordered_map<std::string, bool>::iterator cursor;
-  TSDebug(PLUGIN_NAME, "Deny Country List:");
-  for (cursor = allow_country.begin(); cursor != allow_country.end(); cursor++) {
-    TSDebug(PLUGIN_NAME, "%s:%d", cursor->first.c_str(), cursor->second);
-  }
-#endif
-
   return true;
 }
 
@@ -227,17 +228,7 @@ Acl::loadallow(const YAML::Node &allowNode)
   // Load Allowable Country codes
   try {
     if (allowNode["country"]) {
-      YAML::Node country = allowNode["country"];
-      if (!country.IsNull()) {
-        if (country.IsSequence()) {
-          for (std::size_t i = 0; i < country.size(); i++) {
-            allow_country.insert_or_assign(country[i].as<std::string>(), true);
-          }
-
-        } else {
-          TSDebug(PLUGIN_NAME, "Invalid country code allow list yaml");
-        }
-      }
+      loadcountries(allowNode["country"], true);
     }
   } catch (const YAML::Exception &e) {
     TSDebug(PLUGIN_NAME, "YAML::Exception %s when parsing YAML config file country code allow list for maxmind", e.what());
@@ -272,15 +263,45 @@ Acl::loadallow(const YAML::Node &allowNode)
     parseregex(regex, true);
   }
 
-#if 0
-  std::unordered_map<std::string, bool>::iterator cursor;
-  TSDebug(PLUGIN_NAME, "Allow Country List:");
-  for (cursor = allow_country.begin(); cursor != allow_country.end(); cursor++) {
-    TSDebug(PLUGIN_NAME, "%s:%d", cursor->first.c_str(), cursor->second);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The id of a two letter country code, -1 if it is not one
+int
+Acl::country_id(const char *code, size_t len)
+{
+  if (len != 2 || !isalpha(code[0]) || !isalpha(code[1])) {
+    return -1;
   }
-#endif
+  return (toupper(code[0]) - 'A') * 26 + (toupper(code[1]) - 'A');
+}
 
-  return true;
+// Add the countries of an allow or deny list, a country in both is denied
+void
+Acl::loadcountries(const YAML::Node &country, bool allow)
+{
+  if (country.IsNull()) {
+    return;
+  }
+  if (!country.IsSequence()) {
+    TSDebug(PLUGIN_NAME, "Invalid country code %s list yaml", allow ? "allow" : "deny");
+    return;
+  }
+
+  for (std::size_t i = 0; i < country.size(); i++) {
+    std::string code = country[i].as<std::string>();
+    int id           = country_id(code.c_str(), code.size());
+
+    if (id < 0) {
+      TSError("[%s] Invalid country code %s, ignoring it", PLUGIN_NAME, code.c_str());
+      continue;
+    }
+    if (!listed_country[id] || !allow) {
+      allow_country[id] = allow;
+    }
+    listed_country[id] = true;
+  }
 }
 
 void
@@ -311,11 +332,17 @@ Acl::parseregex(const YAML::Node &regex, bool allow)
           }
 
           for (std::size_t y = 0; y < temprule.size() - 1; y++) {
-            TSDebug(PLUGIN_NAME, "Adding regex: %s, for country: %s", temp._regex_s.c_str(), regex[i][y].as<std::string>().c_str());
+            int id = country_id(temprule[y].c_str(), temprule[y].size());
+            if (id < 0) {
+              TSError("[%s] Invalid country code %s for regex %s, ignoring it", PLUGIN_NAME, temprule[y].c_str(),
+                      temp._regex_s.c_str());
+              continue;
+            }
+            TSDebug(PLUGIN_NAME, "Adding regex: %s, for country: %s", temp._regex_s.c_str(), temprule[y].c_str());
             if (allow) {
-              allow_regex[regex[i][y].as<std::string>()].push_back(temp);
+              allow_regex[id].push_back(temp);
             } else {
-              deny_regex[regex[i][y].as<std::string>()].push_back(temp);
+              deny_regex[id].push_back(temp);
             }
           }
         }
@@ -401,69 +428,91 @@ Acl::loaddb(const YAML::Node &dbNode)
   return true;
 }
 
-bool
-Acl::eval(TSRemapRequestInfo *rri, TSHttpTxn txnp)
+///////////////////////////////////////////////////////////////////////////////
+// Look up the country id of an IP in the database, or what else it has for it
+int
+Acl::lookup_country(const sockaddr *addr) const
 {
-  bool ret = default_allow;
   int mmdb_error;
-  MMDB_lookup_result_s result = MMDB_lookup_sockaddr(&_mmdb, TSHttpTxnClientAddrGet(txnp), &mmdb_error);
+  MMDB_lookup_result_s result = MMDB_lookup_sockaddr(&_mmdb, addr, &mmdb_error);
 
   if (MMDB_SUCCESS != mmdb_error) {
     TSDebug(PLUGIN_NAME, "Error during sockaddr lookup: %s", MMDB_strerror(mmdb_error));
-    ret = false;
-    return ret;
+    return GEO_ERROR;
   }
 
-  MMDB_entry_data_list_s *entry_data_list = nullptr;
-  if (result.found_entry) {
-    int status = MMDB_get_entry_data_list(&result.entry, &entry_data_list);
-    if (MMDB_SUCCESS != status) {
-      TSDebug(PLUGIN_NAME, "Error looking up entry data: %s", MMDB_strerror(status));
-      ret = false;
-      return ret;
-    }
+  if (!result.found_entry) {
+    return GEO_NOT_FOUND;
+  }
 
-    if (NULL != entry_data_list) {
-      // This is useful to be able to dump out a full record of a
-      // mmdb entry for debug. Enabling can help if you want to figure
-      // out how to add new fields
-#if 0
-      // Block of test stuff to dump output, remove later
-      char buffer[4096];
-      FILE *temp = fmemopen(&buffer[0], 4096, "wb+");
-      int status = MMDB_dump_entry_data_list(temp, entry_data_list, 0);
-      fflush(temp);
-      TSDebug(PLUGIN_NAME, "Entry: %s, status: %s, type: %d", buffer, MMDB_strerror(status), entry_data_list->entry_data.type);
-#endif
+  // Only the country code is used, it is all that is read from the entry
+  if (listed_country.none() && allow_regex.empty() && deny_regex.empty()) {
+    return GEO_NO_COUNTRY;
+  }
 
-      MMDB_entry_data_s entry_data;
-      int path_len     = 0;
-      const char *path = nullptr;
-      if (!allow_regex.empty() || !deny_regex.empty()) {
-        path = TSUrlPathGet(rri->requestBufp, rri->requestUrl, &path_len);
-      }
-      // Test for country code
-      if (!allow_country.empty() || !allow_regex.empty() || !deny_regex.empty()) {
-        status = MMDB_get_value(&result.entry, &entry_data, "country", "iso_code", NULL);
-        if (MMDB_SUCCESS != status) {
-          TSDebug(PLUGIN_NAME, "err on get country code value: %s", MMDB_strerror(status));
-          return false;
-        }
-        if (entry_data.has_data) {
-          ret = eval_country(&entry_data, path, path_len);
-        }
-      } else {
-        // Country map is empty as well as regexes, use our default rejection
-        ret = default_allow;
-      }
-    }
-  } else {
+  MMDB_entry_data_s entry_data;
+  int status = MMDB_get_value(&result.entry, &entry_data, "country", "iso_code", NULL);
+  if (MMDB_SUCCESS != status) {
+    TSDebug(PLUGIN_NAME, "err on get country code value: %s", MMDB_strerror(status));
+    return GEO_ERROR;
+  }
+  if (!entry_data.has_data || MMDB_DATA_TYPE_UTF8_STRING != entry_data.type) {
+    return GEO_NO_COUNTRY;
+  }
+
+  int id = country_id(entry_data.utf8_string, entry_data.data_size);
+  return id < 0 ? GEO_NO_COUNTRY : id;
+}
+
+// The same, from the lookups this thread made last, the database of an Acl does not change
+int
+Acl::lookup_country_cached(const sockaddr *addr) const
+{
+  IpAddr ip(addr);
+
+  if (!ip.isValid()) {
+    return lookup_country(addr);
+  }
+
+  GeoCacheEntry &entry = geo_cache[(ip.hash() * 2654435761u) % GEO_CACHE_SIZE];
+  if (entry.acl != _id || entry.addr != ip) {
+    entry.acl     = _id;
+    entry.addr    = ip;
+    entry.country = lookup_country(addr);
+  }
+  return entry.country;
+}
+
+bool
+Acl::eval(TSRemapRequestInfo *rri, TSHttpTxn txnp)
+{
+  bool ret             = default_allow;
+  const sockaddr *addr = TSHttpTxnClientAddrGet(txnp);
+  int country          = lookup_country_cached(addr);
+
+  switch (country) {
+  case GEO_ERROR:
+    return false;
+  case GEO_NOT_FOUND:
     TSDebug(PLUGIN_NAME, "No Country Code entry for this IP was found");
     ret = false;
+    break;
+  case GEO_NO_COUNTRY:
+    // Country map is empty as well as regexes, or the entry has no country, use our default rejection
+    ret = default_allow;
+    break;
+  default: {
+    int path_len     = 0;
+    const char *path = nullptr;
+    if (!allow_regex.empty() || !deny_regex.empty()) {
+      path = TSUrlPathGet(rri->requestBufp, rri->requestUrl, &path_len);
+    }
+    ret = eval_country(country, path, path_len);
+  } break;
   }
 
   // Test for allowable IPs based on our lists
-  switch (eval_ip(TSHttpTxnClientAddrGet(txnp))) {
+  switch (eval_ip(addr)) {
   case ALLOW_IP:
     TSDebug(PLUGIN_NAME, "Saw explicit allow of this IP");
     ret = true;
@@ -481,33 +530,20 @@ Acl::eval(TSRemapRequestInfo *rri, TSHttpTxn txnp)
     break;
   }
 
-  if (NULL != entry_data_list) {
-    MMDB_free_entry_data_list(entry_data_list);
-  }
-
   return ret;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Returns true if entry data contains an
-// allowable country code from our map.
-// False otherwise
+// Returns true if the country is allowable from our lists
+// and regexes. False otherwise
 bool
-Acl::eval_country(MMDB_entry_data_s *entry_data, const char *path, int path_len)
+Acl::eval_country(int country, const char *path, int path_len) const
 {
-  bool ret     = false;
-  bool allow   = default_allow;
-  char *output = nullptr;
-  output       = (char *)malloc((sizeof(char) * entry_data->data_size));
-  strncpy(output, entry_data->utf8_string, entry_data->data_size);
-  TSDebug(PLUGIN_NAME, "This IP Country Code: %s", output);
-  auto exists = allow_country.count(output);
+  bool ret           = false;
+  bool allow         = listed_country[country] ? allow_country[country] : default_allow;
+  const char code[3] = {static_cast<char>('A' + country / 26), static_cast<char>('A' + country % 26), '\0'};
 
-  // If the country exists in our map then set its allow value here
-  // Otherwise we will use our default value
-  if (exists) {
-    allow = allow_country[output];
-  }
+  TSDebug(PLUGIN_NAME, "This IP Country Code: %s", code);
 
   if (allow) {
     TSDebug(PLUGIN_NAME, "Found country code of IP in allow list or allow by default");
@@ -515,25 +551,26 @@ Acl::eval_country(MMDB_entry_data_s *entry_data, const char *path, int path_len)
   }
 
   if (nullptr != path && 0 != path_len) {
-    if (!allow_regex[output].empty()) {
-      for (auto &i : allow_regex[output]) {
+    auto regexes = allow_regex.find(country);
+    if (regexes != allow_regex.end()) {
+      for (auto &i : regexes->second) {
         if (PCRE_ERROR_NOMATCH != pcre_exec(i._rex, i._extra, path, path_len, 0, PCRE_NOTEMPTY, nullptr, 0)) {
-          TSDebug(PLUGIN_NAME, "Got a regex allow hit on regex: %s, country: %s", i._regex_s.c_str(), output);
+          TSDebug(PLUGIN_NAME, "Got a regex allow hit on regex: %s, country: %s", i._regex_s.c_str(), code);
           ret = true;
         }
       }
     }
-    if (!deny_regex[output].empty()) {
-      for (auto &i : deny_regex[output]) {
+    regexes = deny_regex.find(country);
+    if (regexes != deny_regex.end()) {
+      for (auto &i : regexes->second) {
         if (PCRE_ERROR_NOMATCH != pcre_exec(i._rex, i._extra, path, path_len, 0, PCRE_NOTEMPTY, nullptr, 0)) {
-          TSDebug(PLUGIN_NAME, "Got a regex deny hit on regex: %s, country: %s", i._regex_s.c_str(), output);
+          TSDebug(PLUGIN_NAME, "Got a regex deny hit on regex: %s, country: %s", i._regex_s.c_str(), code);
           ret = false;
         }
       }
     }
   }
 
-  free(output);
   return ret;
 }
 
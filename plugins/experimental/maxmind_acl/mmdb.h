@@ -30,7 +30,10 @@
 #include <iostream>
 #include <fstream>
 #include <yaml-cpp/yaml.h>
+#include <atomic>
+#include <bitset>
 #include <unordered_map>
+#include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -47,6 +50,11 @@
 #define PLUGIN_NAME "maxmind_acl"
 #define CONFIG_TMOUT 60000
 
+// Country codes are two letters, each has an id from 0 to COUNTRY_IDS - 1
+#define COUNTRY_IDS (26 * 26)
+// The number of recent lookups of client IPs each thread remembers
+#define GEO_CACHE_SIZE 256
+
 typedef struct {
   std::string _regex_s;
   pcre *_rex;
@@ -55,6 +63,13 @@ typedef struct {
 
 typedef enum { ALLOW_IP, DENY_IP, UNKNOWN_IP } ipstate;
 
+// What the database has for an IP, other than the id of its country
+enum {
+  GEO_ERROR      = -1, // the lookup failed
+  GEO_NOT_FOUND  = -2, // no entry for the IP
+  GEO_NO_COUNTRY = -3, // an entry without a country code, or with one we do not know
+};
+
 // Base class for all ACLs
 class Acl
 {
@@ -86,10 +101,17 @@ protected:
   YAML::Node _config;
   MMDB_s _mmdb;
   std::string _html;
-  std::unordered_map<std::string, bool> allow_country;
 
-  std::unordered_map<std::string, std::vector<plugin_regex>> allow_regex;
-  std::unordered_map<std::string, std::vector<plugin_regex>> deny_regex;
+  // By country id, whether the country is in the allow or deny lists, and if it is allowed
+  std::bitset<COUNTRY_IDS> listed_country;
+  std::bitset<COUNTRY_IDS> allow_country;
+
+  std::unordered_map<int, std::vector<plugin_regex>> allow_regex;
+  std::unordered_map<int, std::vector<plugin_regex>> deny_regex;
+
+  // Tells the lookups of this ruleset and database apart from those of others in the per thread cache
+  uint64_t _id = 0;
+  static std::atomic<uint64_t> _ids;
 
   IpMap allow_ip_map;
   IpMap deny_ip_map;
@@ -103,7 +125,12 @@ protected:
   bool loadallow(const YAML::Node &allowNode);
   bool loaddeny(const YAML::Node &denyNode);
   void loadhtml(const YAML::Node &htmlNode);
-  bool eval_country(MMDB_entry_data_s *entry_data, const char *path, int path_len);
+  void loadcountries(const YAML::Node &country, bool allow);
+  int lookup_country(const sockaddr *addr) const;
+  int lookup_country_cached(const sockaddr *addr) const;
+  bool eval_country(int country, const char *path, int path_len) const;
   void parseregex(const YAML::Node &regex, bool allow);
   ipstate eval_ip(const sockaddr *sock) const;
+
+  static int country_id(const char *code, size_t len);
 };
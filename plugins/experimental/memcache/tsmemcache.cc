@@ -182,6 +182,10 @@ MC::die()
   if (tbuf) {
     ats_free(tbuf);
   }
+  if (mget_ops) {
+    mget_clear();
+    delete[] mget_ops;
+  }
   mutex = NULL;
   theMCAllocator.free(this);
   return EVENT_DONE;
@@ -424,32 +428,41 @@ binary_get_key(MC *mc)
   return get_pointer(mc, 0, mc->binary_header.request.keylen);
 }
 
+// the header of the item read of key k, if it is that of a live item
+static MCCacheHeader *
+read_cache_header(CacheVConnection *vc, const char *k, int nk)
+{
+  MCCacheHeader *h = nullptr;
+  int hlen         = 0;
+  if (vc->get_header((void **)&h, &hlen) < 0) {
+    return nullptr;
+  }
+  if (hlen < static_cast<int>(sizeof(MCCacheHeader)) || h->magic != TSMEMCACHE_HEADER_MAGIC) {
+    return nullptr;
+  }
+  if (static_cast<int>(h->nkey) != nk || hlen < static_cast<int>(sizeof(MCCacheHeader) + h->nkey)) {
+    return nullptr;
+  }
+  if (memcmp(k, h->key(), nk)) {
+    return nullptr;
+  }
+  ink_hrtime t = Thread::get_hrtime();
+  if ((static_cast<ink_hrtime>(h->settime)) <= MC::last_flush ||
+      t >= (static_cast<ink_hrtime>(h->settime)) + HRTIME_SECONDS(h->exptime)) {
+    return nullptr;
+  }
+  return h;
+}
+
 int
 MC::cache_read_event(int event, void *data)
 {
   switch (event) {
   case CACHE_EVENT_OPEN_READ: {
-    crvc     = (CacheVConnection *)data;
-    int hlen = 0;
-    if (crvc->get_header((void **)&rcache_header, &hlen) < 0) {
-      goto Lfail;
-    }
-    if (hlen < static_cast<int>(sizeof(MCCacheHeader)) || rcache_header->magic != TSMEMCACHE_HEADER_MAGIC) {
-      goto Lfail;
-    }
-    if (header.nkey != rcache_header->nkey || hlen < static_cast<int>(sizeof(MCCacheHeader) + rcache_header->nkey)) {
-      goto Lfail;
-    }
-    if (memcmp(key, rcache_header->key(), header.nkey)) {
+    crvc = (CacheVConnection *)data;
+    if (!(rcache_header = read_cache_header(crvc, key, header.nkey))) {
       goto Lfail;
     }
-    {
-      ink_hrtime t = Thread::get_hrtime();
-      if ((static_cast<ink_hrtime>(rcache_header->settime)) <= last_flush ||
-          t >= (static_cast<ink_hrtime>(rcache_header->settime)) + HRTIME_SECONDS(rcache_header->exptime)) {
-        goto Lfail;
-      }
-    }
     break;
   Lfail:
     crvc->do_io_close();
@@ -494,51 +507,6 @@ MC::delete_item()
   return EVENT_CONT;
 }
 
-int
-MC::binary_get_event(int event, void *data)
-{
-  ink_assert(!"EVENT_ITEM_GOT is incorrect here");
-  if (event != TSMEMCACHE_EVENT_GOT_ITEM) {
-    CHECK_READ_AVAIL(binary_header.request.keylen, &MC::binary_get);
-    key         = binary_get_key(this);
-    header.nkey = binary_header.request.keylen;
-    return get_item();
-  } else if (event == CACHE_EVENT_OPEN_READ_FAILED) {
-    if (f.noreply) {
-      return read_from_client();
-    }
-    if (binary_header.request.opcode == PROTOCOL_BINARY_CMD_GETK) {
-      add_binary_header(PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, 0, header.nkey, header.nkey);
-      wbuf->write(key, header.nkey);
-      return write_then_read_from_client();
-    } else {
-      return write_binary_error(PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, 0);
-    }
-  } else if (event == CACHE_EVENT_OPEN_READ) {
-    protocol_binary_response_get *rsp = &res.get;
-    uint16_t keylen                   = 0;
-    uint32_t bodylen                  = sizeof(rsp->message.body) + (rcache_header->nbytes - 2);
-    bool getk =
-      (binary_header.request.opcode == PROTOCOL_BINARY_CMD_GETK || binary_header.request.opcode == PROTOCOL_BINARY_CMD_GETKQ);
-    if (getk) {
-      bodylen += header.nkey;
-      keylen = header.nkey;
-    }
-    add_binary_header(0, sizeof(rsp->message.body), keylen, bodylen);
-    rsp->message.header.response.cas = ink_hton64(rcache_header->cas);
-    rsp->message.body.flags          = htonl(rcache_header->flags);
-    wbuf->write(&rsp->message.body, sizeof(rsp->message.body));
-    if (getk) {
-      wbuf->write(key, header.nkey);
-    }
-    crvio = crvc->do_io_read(this, rcache_header->nbytes, wbuf);
-    return stream_then_read_from_client(rcache_header->nbytes);
-  } else {
-    return unexpected_event();
-  }
-  return 0;
-}
-
 int
 MC::bin_read_key()
 {
@@ -580,8 +548,8 @@ MC::read_binary_from_client_event(int event, void *data)
     f.noreply = 1; // fall through
   case PROTOCOL_BINARY_CMD_GETK:
   case PROTOCOL_BINARY_CMD_GET:
-    CHECK_PROTOCOL(extlen == 0 && (int)bodylen == keylen && keylen > 0);
-    return TS_SET_CALL(&MC::binary_get_event, event, data);
+    CHECK_PROTOCOL(extlen == 0 && (int)bodylen == keylen && keylen > 0 && keylen <= TSMEMCACHE_MAX_KEY_LEN);
+    return binary_mget(event, data);
   case PROTOCOL_BINARY_CMD_APPENDQ:
   case PROTOCOL_BINARY_CMD_APPEND:
     f.set_append = 1;
@@ -722,21 +690,7 @@ MC::ascii_get_event(int event, void *data)
     read_offset = 0;
     break;
   case CACHE_EVENT_OPEN_READ: {
-    wbuf->WRITE("VALUE ");
-    wbuf->write(key, header.nkey);
-    wbuf->WRITE(" ");
-    char t[32], *te = t + 32;
-    char *flags = xutoa(rcache_header->flags, te);
-    wbuf->write(flags, te - flags);
-    wbuf->WRITE(" ");
-    char *bytes = xutoa(rcache_header->nbytes, te);
-    wbuf->write(bytes, te - bytes);
-    if (f.return_cas) {
-      wbuf->WRITE(" ");
-      char *pcas = xutoa(rcache_header->cas, te);
-      wbuf->write(pcas, te - pcas);
-    }
-    wbuf->WRITE("\r\n");
+    write_ascii_value_header(key, header.nkey, rcache_header);
     int ntowrite = writer->read_avail() + rcache_header->nbytes;
     crvio        = crvc->do_io_read(this, rcache_header->nbytes, wbuf);
     creader      = reader;
@@ -757,6 +711,310 @@ MC::ascii_get_event(int event, void *data)
   return ascii_gets();
 }
 
+void
+MC::write_ascii_value_header(const char *k, int nk, MCCacheHeader *h)
+{
+  wbuf->WRITE("VALUE ");
+  wbuf->write(k, nk);
+  wbuf->WRITE(" ");
+  char t[32], *te = t + 32;
+  char *flags = xutoa(h->flags, te);
+  wbuf->write(flags, te - flags);
+  wbuf->WRITE(" ");
+  char *bytes = xutoa(h->nbytes, te);
+  wbuf->write(bytes, te - bytes);
+  if (f.return_cas) {
+    wbuf->WRITE(" ");
+    char *pcas = xutoa(h->cas, te);
+    wbuf->write(pcas, te - pcas);
+  }
+  wbuf->WRITE("\r\n");
+}
+
+int
+MCGetOp::open_event(int event, void *data)
+{
+  switch (event) {
+  case CACHE_EVENT_OPEN_READ:
+    pending_action = nullptr;
+    vc             = (CacheVConnection *)data;
+    if ((cache_header = read_cache_header(vc, key, nkey))) {
+      state = MGET_HIT;
+    } else {
+      vc->do_io_close();
+      vc    = nullptr;
+      state = MGET_MISS;
+    }
+    break;
+  case CACHE_EVENT_OPEN_READ_FAILED:
+    pending_action = nullptr;
+    state          = MGET_MISS;
+    break;
+  default:
+    return EVENT_CONT;
+  }
+  // the connection only cares for the key it is to answer next
+  if (!mc->mget_issuing && mc->mget_waiting && this == &mc->mget_ops[mc->mget_next]) {
+    return mc->handleEvent(TSMEMCACHE_EVENT_GOT_ITEM, this);
+  }
+  return EVENT_CONT;
+}
+
+MCGetOp *
+MC::mget_add(const char *k, int nk)
+{
+  if (mget_nops == mget_size) {
+    int size     = mget_size ? mget_size * 2 : 16;
+    MCGetOp *ops = new MCGetOp[size];
+    for (int i = 0; i < size; i++) {
+      ops[i].mc    = this;
+      ops[i].mutex = mutex;
+      if (i < mget_nops) {
+        ops[i].opcode = mget_ops[i].opcode;
+        ops[i].opaque = mget_ops[i].opaque;
+        ops[i].nkey   = mget_ops[i].nkey;
+        memcpy(ops[i].key, mget_ops[i].key, mget_ops[i].nkey);
+      }
+    }
+    delete[] mget_ops;
+    mget_ops  = ops;
+    mget_size = size;
+  }
+  MCGetOp *op = &mget_ops[mget_nops++];
+  op->state   = MCGetOp::MGET_IDLE;
+  op->nkey    = nk;
+  memcpy(op->key, k, nk);
+  return op;
+}
+
+// open the keys that follow, up to TSMEMCACHE_MGET_WINDOW ahead of the one answered
+void
+MC::mget_issue()
+{
+  mget_issuing = true;
+  while (mget_issued < mget_nops && mget_issued - mget_next < TSMEMCACHE_MGET_WINDOW) {
+    MCGetOp *op = &mget_ops[mget_issued++];
+    op->state   = MCGetOp::MGET_OPENING;
+    CryptoContext().hash_immediate(op->cache_key, op->key, op->nkey);
+    Action *a = cacheProcessor.open_read(op, &op->cache_key);
+    if (op->state == MCGetOp::MGET_OPENING) { // not called back yet
+      op->pending_action = a;
+    }
+  }
+  mget_issuing = false;
+}
+
+int
+MC::mget_start(bool binary)
+{
+  mget_binary = binary;
+  mget_next   = 0;
+  mget_issued = 0;
+  SET_HANDLER(&MC::mget_event);
+  mget_issue();
+  return mget_respond();
+}
+
+void
+MC::add_binary_get_header(MCGetOp *op, uint16_t err, uint8_t hdr_len, uint16_t key_len, uint32_t body_len, uint64_t cas)
+{
+  protocol_binary_response_header r;
+
+  r.response.magic    = static_cast<uint8_t>(PROTOCOL_BINARY_RES);
+  r.response.opcode   = op->opcode;
+  r.response.keylen   = (uint16_t)htons(key_len);
+  r.response.extlen   = hdr_len;
+  r.response.datatype = static_cast<uint8_t>(PROTOCOL_BINARY_RAW_BYTES);
+  r.response.status   = (uint16_t)htons(err);
+  r.response.bodylen  = htonl(body_len);
+  r.response.opaque   = op->opaque;
+  r.response.cas      = ink_hton64(cas);
+
+  wbuf->write(&r, sizeof(r));
+}
+
+// answer the keys in order, as far as they are opened
+int
+MC::mget_respond()
+{
+  mget_waiting = false;
+  while (mget_next < mget_nops) {
+    MCGetOp *op = &mget_ops[mget_next];
+    if (op->state == MCGetOp::MGET_OPENING) {
+      mget_waiting = true;
+      return write_to_client();
+    }
+    if (op->state == MCGetOp::MGET_HIT) {
+      rcache_header = op->cache_header;
+      if (mget_binary) {
+        bool getk       = op->opcode == PROTOCOL_BINARY_CMD_GETK || op->opcode == PROTOCOL_BINARY_CMD_GETKQ;
+        uint16_t keylen = getk ? op->nkey : 0;
+        uint32_t flags  = htonl(rcache_header->flags);
+        add_binary_get_header(op, 0, sizeof(flags), keylen, sizeof(flags) + keylen + rcache_header->nbytes, rcache_header->cas);
+        wbuf->write(&flags, sizeof(flags));
+        if (getk) {
+          wbuf->write(op->key, op->nkey);
+        }
+      } else {
+        write_ascii_value_header(op->key, op->nkey, rcache_header);
+      }
+      crvc    = op->vc;
+      op->vc  = nullptr;
+      crvio   = crvc->do_io_read(this, rcache_header->nbytes, wbuf);
+      creader = reader;
+      TS_PUSH_HANDLER(&MC::stream_event);
+      return write_to_client();
+    }
+    // a miss, only answered to the binary requests that are not quiet
+    if (mget_binary && (op->opcode == PROTOCOL_BINARY_CMD_GET || op->opcode == PROTOCOL_BINARY_CMD_GETK)) {
+      if (op->opcode == PROTOCOL_BINARY_CMD_GETK) {
+        add_binary_get_header(op, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, 0, op->nkey, op->nkey, 0);
+        wbuf->write(op->key, op->nkey);
+      } else {
+        add_binary_get_header(op, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, 0, 0, STRLEN("Not found"), 0);
+        wbuf->WRITE("Not found");
+      }
+    }
+    mget_next++;
+    mget_issue();
+  }
+  if (!mget_binary) {
+    wbuf->WRITE("END\r\n");
+  }
+  mget_clear();
+  write_to_client();
+  return read_from_client();
+}
+
+void
+MC::mget_clear()
+{
+  for (int i = 0; i < mget_nops; i++) {
+    MCGetOp *op = &mget_ops[i];
+    if (op->pending_action) {
+      op->pending_action->cancel();
+      op->pending_action = nullptr;
+    }
+    if (op->vc) {
+      op->vc->do_io_close();
+      op->vc = nullptr;
+    }
+    op->state = MCGetOp::MGET_IDLE;
+  }
+  mget_nops   = 0;
+  mget_next   = 0;
+  mget_issued = 0;
+}
+
+int
+MC::mget_event(int event, void *data)
+{
+  switch (event) {
+  case TSMEMCACHE_STREAM_DONE:
+    crvc->do_io_close();
+    crvc  = 0;
+    crvio = NULL;
+    if (!mget_binary) {
+      wbuf->WRITE("\r\n");
+    }
+    mget_next++;
+    mget_issue();
+    return mget_respond();
+  case TSMEMCACHE_EVENT_GOT_ITEM:
+    return mget_respond();
+  case VC_EVENT_READ_READY:
+  case VC_EVENT_EOS: // answer what was asked before the client closed
+  case VC_EVENT_WRITE_READY:
+  case VC_EVENT_WRITE_COMPLETE:
+    return EVENT_CONT;
+  default:
+    return die();
+  }
+}
+
+// get k1 k2 ... kn, all in the block of the reader from s to e, the end of the line
+int
+MC::ascii_mget(char *s, char *e)
+{
+  char *k[TSMEMCACHE_MAX_MGET_KEYS];
+  int nk[TSMEMCACHE_MAX_MGET_KEYS];
+  int n = 0;
+  for (char *t = s; t < e;) {
+    while (t < e && isspace(*t)) {
+      t++;
+    }
+    if (t >= e) {
+      break;
+    }
+    char *b = t;
+    while (t < e && !isspace(*t)) {
+      t++;
+    }
+    if (t - b > TSMEMCACHE_MAX_KEY_LEN) {
+      return ASCII_CLIENT_ERROR("bad command line");
+    }
+    if (n == TSMEMCACHE_MAX_MGET_KEYS) {
+      return ascii_get(s, e); // a key at a time
+    }
+    k[n]  = b;
+    nk[n] = t - b;
+    n++;
+  }
+  if (!n) {
+    return ASCII_CLIENT_ERROR("bad command line");
+  }
+  for (int i = 0; i < n; i++) {
+    mget_add(k[i], nk[i]);
+  }
+  reader->consume(e - s);
+  return mget_start(false);
+}
+
+// GET, GETK, GETQ and GETKQ requests, handled together as far as they are pipelined
+int
+MC::binary_mget(int event, void *data)
+{
+  while (true) {
+    int keylen  = binary_header.request.keylen;
+    int64_t len = sizeof(binary_header) + binary_header.request.bodylen;
+    if (reader->read_avail() < len) {
+      if (!mget_nops) {
+        CHECK_READ_AVAIL(len, &MC::binary_mget);
+      }
+      break; // what is there so far, the rest after
+    }
+    MCGetOp *op = mget_add("", 0);
+    op->opcode  = binary_header.request.opcode;
+    op->opaque  = binary_header.request.opaque;
+    op->nkey    = keylen;
+    reader->memcpy(op->key, keylen, sizeof(binary_header) + binary_header.request.extlen);
+    reader->consume(len);
+    // the client waits for the answer to a request that is not quiet
+    if (op->opcode == PROTOCOL_BINARY_CMD_GET || op->opcode == PROTOCOL_BINARY_CMD_GETK || mget_nops == TSMEMCACHE_MAX_MGET_KEYS) {
+      break;
+    }
+    // the next request, if it is a get too
+    protocol_binary_request_header h;
+    if (reader->read_avail() < static_cast<int64_t>(sizeof(h))) {
+      break;
+    }
+    reader->memcpy(&h, sizeof(h));
+    if (h.request.magic != PROTOCOL_BINARY_REQ ||
+        (h.request.opcode != PROTOCOL_BINARY_CMD_GET && h.request.opcode != PROTOCOL_BINARY_CMD_GETK &&
+         h.request.opcode != PROTOCOL_BINARY_CMD_GETQ && h.request.opcode != PROTOCOL_BINARY_CMD_GETKQ)) {
+      break;
+    }
+    h.request.keylen  = ntohs(h.request.keylen);
+    h.request.bodylen = ntohl(h.request.bodylen);
+    if (h.request.extlen != 0 || h.request.keylen == 0 || h.request.keylen > TSMEMCACHE_MAX_KEY_LEN ||
+        h.request.bodylen != h.request.keylen) {
+      break; // answered as an error after the others
+    }
+    binary_header = h;
+  }
+  return mget_start(true);
+}
+
 int
 MC::ascii_set_event(int event, void *data)
 {
@@ -1306,6 +1564,10 @@ MC::read_ascii_from_client_event(int event, void *data)
     Lget:
       reader->consume(read_offset);
       if (c != tmp_cmd_buffer) { // all in the block
+        char *nl = static_cast<char *>(memchr(s + read_offset, '\n', e - (s + read_offset)));
+        if (nl) { // the whole line, get the keys together
+          return ascii_mget(s + read_offset, nl + 1);
+        }
         return ascii_get(s + read_offset, e);
       } else {
         return ascii_gets();
@@ -38,6 +38,8 @@
 #define TSMEMCACHE_TMP_CMD_BUFFER_SIZE 320
 #define TSMEMCACHE_HEADER_MAGIC 0x8765ACDC
 #define TSMEMCACHE_RETRY_WRITE_INTERVAL HRTIME_MSECONDS(20)
+#define TSMEMCACHE_MGET_WINDOW 32     // cache opens in flight for a multi-get
+#define TSMEMCACHE_MAX_MGET_KEYS 1024 // keys of a multi-get, more are gotten one at a time
 
 #define TSMEMCACHE_WRITE_SYNC 0 // not yet
 
@@ -94,6 +96,32 @@ struct MCAccept : public Continuation {
   }
 };
 
+struct MC;
+
+// A key of a multi-get, opened in the cache with those around it
+struct MCGetOp : public Continuation {
+  enum { MGET_IDLE, MGET_OPENING, MGET_HIT, MGET_MISS };
+
+  MC *mc;
+  Action *pending_action;
+  CacheVConnection *vc;
+  MCCacheHeader *cache_header;
+  CacheKey cache_key;
+  int state;
+  uint8_t opcode;  // of the binary request
+  uint32_t opaque; // of the binary request
+  int nkey;
+  char key[TSMEMCACHE_MAX_KEY_LEN];
+
+  int open_event(int event, void *data);
+
+  MCGetOp()
+    : mc(nullptr), pending_action(nullptr), vc(nullptr), cache_header(nullptr), state(MGET_IDLE), opcode(0), opaque(0), nkey(0)
+  {
+    SET_HANDLER(&MCGetOp::open_event);
+  }
+};
+
 #define TS_PUSH_HANDLER(_h)                    \
   do {                                         \
     handler_stack[ihandler_stack++] = handler; \
@@ -150,6 +178,12 @@ struct MC : Continuation {
   };
   uint64_t nbytes;
   uint64_t delta;
+  // multi-get: the keys are opened TSMEMCACHE_MGET_WINDOW at a time and answered in order
+  MCGetOp *mget_ops; // reused by the multi-gets of the connection
+  int mget_nops, mget_size;
+  int mget_next;   // the key to answer next
+  int mget_issued; // the keys opened so far
+  bool mget_binary, mget_issuing, mget_waiting;
 
   static int32_t verbosity;
   static ink_hrtime last_flush;
@@ -168,7 +202,6 @@ struct MC : Continuation {
   int swallow_cmd_then_read_from_client_event(int event, void *data);
   int read_binary_from_client_event(int event, void *data);
   int read_ascii_from_client_event(int event, void *data);
-  int binary_get_event(int event, void *data);
   int cache_read_event(int event, void *data);
   int write_then_close_event(int event, void *data);
   int stream_event(int event, void *data); // cache <=> client
@@ -186,6 +219,17 @@ struct MC : Continuation {
   int ascii_set_event(int event, void *data);
   int ascii_delete_event(int event, void *data);
   int ascii_incr_decr_event(int event, void *data);
+  void write_ascii_value_header(const char *k, int nk, MCCacheHeader *h);
+  int ascii_mget(char *s, char *e);
+
+  MCGetOp *mget_add(const char *k, int nk);
+  void mget_issue();
+  int mget_start(bool binary);
+  int mget_respond();
+  void mget_clear();
+  int mget_event(int event, void *data);
+  void add_binary_get_header(MCGetOp *op, uint16_t err, uint8_t hdr_len, uint16_t key_len, uint32_t body_len, uint64_t cas);
+  int binary_mget(int event, void *data);
 
   int write_binary_error(protocol_binary_response_status err, int swallow);
   void add_binary_header(uint16_t err, uint8_t hdr_len, uint16_t key_len, uint32_t body_len);
@@ -33,6 +33,7 @@
 #include <cstring>
 #include <cerrno>
 #include <tscore/ink_config.h>
+#include <tscore/ink_queue.h>
 #if TS_HAS_JEMALLOC
 #include <jemalloc/jemalloc.h>
 #endif
@@ -48,6 +49,11 @@ CallbackHandler(TSCont cont, TSEvent id, void *data)
     TSPluginMsg *msg = static_cast<TSPluginMsg *>(data);
     TSDebug(PLUGIN_NAME, "Message to '%s' - %zu bytes of data", msg->tag, msg->data_size);
     if (strcmp(PLUGIN_NAME, msg->tag) == 0) { // Message is for us
+      if (msg->data_size && strncmp((char *)msg->data, "freelist", msg->data_size) == 0) {
+        // Not jemalloc's, available in any build.
+        ink_freelists_dump(stderr);
+        return TS_EVENT_NONE;
+      }
 #if TS_HAS_JEMALLOC
       if (msg->data_size) {
         int retval = 0;
@@ -22,6 +22,7 @@
 #include "tscore/ink_config.h"
 #include "tscore/ink_defs.h"
 #include "tscore/BufferWriter.h"
+#include "tscore/ink_inet.h"
 
 #include "ts/ts.h"
 
@@ -36,6 +37,8 @@
 
 struct config_t {
   bool post_remap_host;
+  bool latency;        // histograms of the transaction phases for each remap host
+  bool origin_latency; // the same for each origin address
   int txn_slot;
   TSStatPersistence persist_type;
   TSMutex stat_creation_mutex;
@@ -152,6 +155,66 @@ create_stat_name(ts::FixedBufferWriter &stat_name, std::string_view h, std::stri
   stat_name.extend(1).write('\0');
 }
 
+// The phases of the latency histograms, as those of proxy.process.http.latency, between two milestones.
+struct latency_phase_t {
+  char const *name;
+  TSMilestonesType start;
+  TSMilestonesType end;
+};
+
+constexpr latency_phase_t latency_phases[] = {
+  {"dns", TS_MILESTONE_DNS_LOOKUP_BEGIN, TS_MILESTONE_DNS_LOOKUP_END},
+  {"connect", TS_MILESTONE_SERVER_CONNECT, TS_MILESTONE_SERVER_CONNECT_END},
+  {"tls", TS_MILESTONE_TLS_HANDSHAKE_START, TS_MILESTONE_TLS_HANDSHAKE_END},
+  {"first_byte", TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_FIRST_READ},
+  {"cache_open", TS_MILESTONE_CACHE_OPEN_READ_BEGIN, TS_MILESTONE_CACHE_OPEN_READ_END},
+  // the plugin time is kept as an offset from the start of the transaction
+  {"plugin", TS_MILESTONE_SM_START, TS_MILESTONE_PLUGIN_TOTAL},
+  // the transaction is not finished when it is closed, it is done with the client
+  {"total", TS_MILESTONE_SM_START, TS_MILESTONE_UA_CLOSE},
+};
+
+char const *
+latency_bucket(TSHRTime t)
+{
+  static char const *const buckets[] = {"1ms", "10ms", "100ms", "1s"};
+  TSHRTime bound                     = 1000000; // 1ms
+  for (char const *bucket : buckets) {
+    if (t <= bound) {
+      return bucket;
+    }
+    bound *= 10;
+  }
+  return "inf";
+}
+
+void
+add_latency_stat(ts::FixedBufferWriter &stat_name, std::string_view key, char const *phase, TSHRTime t, config_t const *config)
+{
+  ts::LocalBufferWriter<64> suffix;
+  suffix.print("latency_{}_{}", phase, latency_bucket(t));
+  create_stat_name(stat_name, key, suffix.view());
+  stat_add(stat_name.data(), 1, config->persist_type, config->stat_creation_mutex);
+}
+
+// Count the transaction in the latency histograms of @a key, for each phase it went through.
+void
+add_latency_stats(TSHttpTxn txn, ts::FixedBufferWriter &stat_name, std::string_view key, config_t const *config)
+{
+  for (auto const &phase : latency_phases) {
+    TSHRTime start = 0, end = 0;
+    TSHttpTxnMilestoneGet(txn, phase.start, &start);
+    TSHttpTxnMilestoneGet(txn, phase.end, &end);
+    if (start != 0 && end != 0) {
+      add_latency_stat(stat_name, key, phase.name, end - start, config);
+    }
+  }
+  TSHRTime cpu = 0;
+  if (TSHttpTxnCpuTimeGet(txn, &cpu) == TS_SUCCESS) {
+    add_latency_stat(stat_name, key, "cpu", cpu, config);
+  }
+}
+
 int
 handle_txn_close(TSCont cont, TSEvent event ATS_UNUSED, void *edata)
 {
@@ -221,6 +284,17 @@ handle_txn_close(TSCont cont, TSEvent event ATS_UNUSED, void *edata)
         stat_add(stat_name.data(), 1, config->persist_type, config->stat_creation_mutex);
       }
 
+      if (config->latency) {
+        add_latency_stats(txn, stat_name, remap, config);
+      }
+      sockaddr const *origin = TSHttpTxnServerAddrGet(txn);
+      if (config->origin_latency && nullptr != origin && ats_is_ip(origin)) {
+        char addr[INET6_ADDRSTRLEN];
+        ts::LocalBufferWriter<MAX_STAT_LENGTH> origin_key;
+        origin_key.print("origin.{}", ats_ip_ntop(origin, addr, sizeof(addr)));
+        add_latency_stats(txn, stat_name, origin_key.view(), config);
+      }
+
       if (nullptr != effective_hostname) {
         TSfree(effective_hostname);
       }
@@ -256,6 +330,8 @@ TSPluginInit(int argc, const char *argv[])
 
   auto config                 = new config_t;
   config->post_remap_host     = false;
+  config->latency             = false;
+  config->origin_latency      = false;
   config->persist_type        = TS_STAT_NON_PERSISTENT;
   config->stat_creation_mutex = TSMutexCreate();
 
@@ -269,6 +345,12 @@ TSPluginInit(int argc, const char *argv[])
       } else if (arg == "-p" || arg == "--persistent") {
         config->persist_type = TS_STAT_PERSISTENT;
         TSDebug(DEBUG_TAG, "Using persistent stats");
+      } else if (arg == "-l" || arg == "--latency") {
+        config->latency = true;
+        TSDebug(DEBUG_TAG, "Using latency histograms");
+      } else if (arg == "-o" || arg == "--origin-latency") {
+        config->origin_latency = true;
+        TSDebug(DEBUG_TAG, "Using latency histograms of the origins");
       }
     }
   }
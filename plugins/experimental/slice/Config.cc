@@ -110,6 +110,7 @@ Config::fromArgs(int const argc, char const *const argv[])
     {const_cast<char *>("blockbytes"), required_argument, nullptr, 'b'},
     {const_cast<char *>("disable-errorlog"), no_argument, nullptr, 'd'},
     {const_cast<char *>("exclude-regex"), required_argument, nullptr, 'e'},
+    {const_cast<char *>("prefetch-count"), required_argument, nullptr, 'f'},
     {const_cast<char *>("include-regex"), required_argument, nullptr, 'i'},
     {const_cast<char *>("ref-relative"), no_argument, nullptr, 'l'},
     {const_cast<char *>("pace-errorlog"), required_argument, nullptr, 'p'},
@@ -120,8 +121,9 @@ Config::fromArgs(int const argc, char const *const argv[])
 
   // getopt assumes args start at '1' so this hack is needed
   char *const *argvp = (const_cast<char *const *>(argv) - 1);
+  optind             = 0; // a new scan for each remap instance
   for (;;) {
-    int const opt = getopt_long(argc + 1, argvp, "b:de:i:lop:r:t:", longopts, nullptr);
+    int const opt = getopt_long(argc + 1, argvp, "b:de:f:i:lop:r:t:", longopts, nullptr);
     if (-1 == opt) {
       break;
     }
@@ -159,6 +161,15 @@ Config::fromArgs(int const argc, char const *const argv[])
         DEBUG_LOG("Using regex for url exclude: '%s'", m_regexstr.c_str());
       }
     } break;
+    case 'f': {
+      int const countread = atoi(optarg);
+      if (0 <= countread) {
+        m_prefetchcount = std::min(countread, prefetchcountmax);
+        DEBUG_LOG("Prefetching %d block(s) ahead", m_prefetchcount);
+      } else {
+        ERROR_LOG("Ignoring prefetch-count argument");
+      }
+    } break;
     case 'i': {
       if (None != m_regex_type) {
         ERROR_LOG("Regex already specified!");
@@ -33,6 +33,7 @@ struct Config {
   static constexpr int64_t const blockbytesmin     = 1024 * 256;       // 256KB
   static constexpr int64_t const blockbytesmax     = 1024 * 1024 * 32; // 32MB
   static constexpr int64_t const blockbytesdefault = 1024 * 1024;      // 1MB
+  static constexpr int const prefetchcountmax      = 32;
 
   int64_t m_blockbytes{blockbytesdefault};
   std::string m_remaphost; // remap host to use for loopback slice GET
@@ -44,6 +45,7 @@ struct Config {
   int m_paceerrsecs{0}; // -1 disable logging, 0 no pacing, max 60s
   enum RefType { First, Relative };
   RefType m_reftype{First}; // reference slice is relative to request
+  int m_prefetchcount{0};   // blocks to fetch into cache ahead of the client
 
   // Convert optarg to bytes
   static int64_t bytesFrom(char const *const valstr);
@@ -76,6 +76,7 @@ struct Data {
   int64_t m_blockexpected{0}; // body bytes expected
   int64_t m_blockskip{0};     // number of bytes to skip in this block
   int64_t m_blockconsumed{0}; // body bytes consumed
+  int64_t m_prefetchnum{-1};  // last block requested for prefetch
 
   BlockState m_blockstate{Pending}; // is there an active slice block
 
@@ -0,0 +1,129 @@
+/** @file
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "prefetch.h"
+
+#include "Config.h"
+#include "Data.h"
+
+#include <algorithm>
+
+void
+BgBlockFetch::schedule(Data *const data)
+{
+  int const count = data->m_config->m_prefetchcount;
+
+  // the content length bounds the blocks, it is only known after block 0
+  if (count <= 0 || data->m_contentlen <= 0) {
+    return;
+  }
+
+  int64_t const blockbytes = data->m_config->m_blockbytes;
+  int64_t const lastnum    = data->m_blocknum + count;
+
+  for (int64_t blocknum = std::max(data->m_blocknum, data->m_prefetchnum) + 1; blocknum <= lastnum; ++blocknum) {
+    if (data->m_contentlen <= blocknum * blockbytes || !data->m_req_range.blockIsInside(blockbytes, blocknum)) {
+      break;
+    }
+
+    BgBlockFetch *const bg = new BgBlockFetch(blocknum);
+    if (!bg->fetch(data)) {
+      delete bg;
+      break;
+    }
+    data->m_prefetchnum = blocknum;
+  }
+}
+
+bool
+BgBlockFetch::fetch(Data *const data)
+{
+  int64_t const blockbeg = data->m_config->m_blockbytes * m_blocknum;
+  Range blockbe(blockbeg, blockbeg + data->m_config->m_blockbytes);
+
+  char rangestr[1024];
+  int rangelen      = sizeof(rangestr);
+  bool const rpstat = blockbe.toStringClosed(rangestr, &rangelen);
+  TSAssert(rpstat);
+
+  // a copy of the client header, with the range of the block, leaves the
+  // header of the block requests alone
+  HdrMgr hdrmgr;
+  hdrmgr.m_buffer = TSMBufferCreate();
+  hdrmgr.m_lochdr = TSHttpHdrCreate(hdrmgr.m_buffer);
+  TSHttpHdrCopy(hdrmgr.m_buffer, hdrmgr.m_lochdr, data->m_req_hdrmgr.m_buffer, data->m_req_hdrmgr.m_lochdr);
+
+  HttpHeader header(hdrmgr.m_buffer, hdrmgr.m_lochdr);
+
+  // the transaction closes the connection when the response is done
+  static char const closestr[] = "close";
+  if (!header.setKeyVal(TS_MIME_FIELD_RANGE, TS_MIME_LEN_RANGE, rangestr, rangelen) ||
+      !header.setKeyVal(TS_MIME_FIELD_CONNECTION, TS_MIME_LEN_CONNECTION, closestr, sizeof(closestr) - 1)) {
+    ERROR_LOG("Error trying to set prefetch request header %s", rangestr);
+    return false;
+  }
+
+  DEBUG_LOG("prefetchBlock: %s", rangestr);
+
+  // create virtual connection back into ATS
+  TSVConn const upvc = TSHttpConnectWithPluginId(reinterpret_cast<sockaddr *>(&data->m_client_ip), PLUGIN_NAME, 0);
+
+  int const hlen = TSHttpHdrLengthGet(header.m_buffer, header.m_lochdr);
+
+  m_cont = TSContCreate(handler, TSMutexCreate());
+  TSContDataSet(m_cont, this);
+
+  // no event for the fetch until it is set up
+  TSMutexLock(TSContMutexGet(m_cont));
+
+  m_stream.setupConnection(upvc);
+  m_stream.setupVioWrite(m_cont, hlen);
+  TSHttpHdrPrint(header.m_buffer, header.m_lochdr, m_stream.m_write.m_iobuf);
+  TSVIOReenable(m_stream.m_write.m_vio);
+
+  m_stream.setupVioRead(m_cont, INT64_MAX);
+
+  TSMutexUnlock(TSContMutexGet(m_cont));
+
+  return true;
+}
+
+int
+BgBlockFetch::handler(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
+{
+  BgBlockFetch *const bg = static_cast<BgBlockFetch *>(TSContDataGet(contp));
+
+  switch (event) {
+  case TS_EVENT_VCONN_WRITE_READY:
+  case TS_EVENT_VCONN_WRITE_COMPLETE:
+    break;
+  case TS_EVENT_VCONN_READ_READY:
+    bg->m_stream.m_read.drainReader();
+    TSVIOReenable(bg->m_stream.m_read.m_vio);
+    break;
+  default: // eos, timeout or error
+    DEBUG_LOG("prefetch of block %" PRId64 " done, event: %d", bg->m_blocknum, event);
+    bg->m_stream.close();
+    TSContDataSet(contp, nullptr);
+    delete bg;
+    TSContDestroy(contp);
+    break;
+  }
+
+  return 0;
+}
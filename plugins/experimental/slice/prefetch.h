@@ -0,0 +1,48 @@
+/** @file
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "ts/ts.h"
+
+#include "Stage.h"
+
+struct Data;
+
+/**
+ * A block fetched into the cache ahead of the client, through its own
+ * loopback connection.  The response is read and dropped, the block is
+ * served later from the cache by the usual block request.
+ */
+struct BgBlockFetch {
+  BgBlockFetch(BgBlockFetch const &) = delete;
+  BgBlockFetch &operator=(BgBlockFetch const &) = delete;
+
+  // schedule the blocks after the current one, up to the prefetch count
+  static void schedule(Data *const data);
+
+  static int handler(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */);
+
+  explicit BgBlockFetch(int64_t const blocknum) : m_blocknum(blocknum) {}
+
+  bool fetch(Data *const data);
+
+  int64_t m_blocknum;
+  TSCont m_cont{nullptr};
+  Stage m_stream;
+};
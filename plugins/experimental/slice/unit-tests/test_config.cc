@@ -84,3 +84,25 @@ TEST_CASE("config bytesfrom invalid parsing", "[AWS][slice][utility]")
     }
   }
 }
+
+TEST_CASE("config prefetch count", "[AWS][slice][utility]")
+{
+  {
+    Config config;
+    char const *const argv[] = {"--prefetch-count=4"};
+    config.fromArgs(1, argv);
+    CHECK(4 == config.m_prefetchcount);
+  }
+  {
+    Config config;
+    char const *const argv[] = {"-f", "1000"};
+    config.fromArgs(2, argv);
+    CHECK(Config::prefetchcountmax == config.m_prefetchcount);
+  }
+  {
+    Config config;
+    char const *const argv[] = {"--prefetch-count=-1"};
+    config.fromArgs(1, argv);
+    CHECK(0 == config.m_prefetchcount);
+  }
+}
@@ -20,6 +20,7 @@
 
 #include "Config.h"
 #include "Data.h"
+#include "prefetch.h"
 
 void
 shutdown(TSCont const contp, Data *const data)
@@ -117,6 +118,7 @@ request_block(TSCont contp, Data *const data)
   switch (data->m_blockstate) {
   case BlockState::Pending:
     data->m_blockstate = BlockState::Active;
+    BgBlockFetch::schedule(data);
     break;
   case BlockState::PendingInt:
     data->m_blockstate = BlockState::ActiveInt;
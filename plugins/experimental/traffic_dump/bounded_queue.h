@@ -0,0 +1,135 @@
+/** @file
+
+  A bounded, lock free, multiple producer queue.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace traffic_dump
+{
+/** A fixed size ring of cells, each with a sequence number saying whether it
+ * is free for the producer or filled for the consumer of its turn.
+ *
+ * Pushing never blocks nor allocates: when the ring is full, push() fails and
+ * the caller decides what to drop. Any number of threads may push and pop.
+ */
+template <typename T> class BoundedQueue
+{
+public:
+  /** @param[in] capacity The number of elements, rounded up to a power of 2. */
+  explicit BoundedQueue(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    _mask  = size - 1;
+    _cells = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(BoundedQueue const &) = delete;
+  BoundedQueue &operator=(BoundedQueue const &) = delete;
+
+  size_t
+  capacity() const
+  {
+    return _mask + 1;
+  }
+
+  /** Move @a value to the queue.
+   *
+   * @return False if the queue is full, @a value is then left as it was.
+   */
+  bool
+  push(T &&value)
+  {
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell              = &_cells[pos & _mask];
+      size_t sequence   = cell->sequence.load(std::memory_order_acquire);
+      intptr_t distance = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (distance == 0) {
+        if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (distance < 0) {
+        return false; // The consumer has not popped the element a lap behind.
+      } else {
+        pos = _enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** Move the oldest element of the queue to @a value.
+   *
+   * @return False if the queue is empty.
+   */
+  bool
+  pop(T &value)
+  {
+    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell              = &_cells[pos & _mask];
+      size_t sequence   = cell->sequence.load(std::memory_order_acquire);
+      intptr_t distance = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (distance == 0) {
+        if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (distance < 0) {
+        return false;
+      } else {
+        pos = _dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    value      = std::move(cell->data);
+    cell->data = T();
+    cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> _cells;
+  size_t _mask = 0;
+  // Apart from each other, not to have the producers and the consumer share a cache line.
+  alignas(64) std::atomic<size_t> _enqueue_pos{0};
+  alignas(64) std::atomic<size_t> _dequeue_pos{0};
+};
+
+} // namespace traffic_dump
@@ -0,0 +1,219 @@
+/** @file
+
+  Traffic Dump writer thread implementation.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ts/ts.h"
+
+#include "bounded_queue.h"
+#include "dump_writer.h"
+#include "global_variables.h"
+
+namespace
+{
+/** The final string used to close a JSON session. */
+char const constexpr *const json_closing = "]}]}";
+
+/// The most transactions written in a batch, for the files to be flushed regularly under load.
+constexpr int max_batch_size = 1024;
+/// How long the writer sleeps when the queue is empty, for the content to gather.
+constexpr std::chrono::milliseconds idle_interval{10};
+
+struct QueueItem {
+  std::shared_ptr<traffic_dump::DumpFile> file;
+  std::string content;
+  bool finish = false;
+};
+
+std::unique_ptr<traffic_dump::BoundedQueue<QueueItem>> write_queue;
+std::atomic<int64_t> *disk_usage = nullptr;
+int dropped_transactions_stat    = -1;
+} // namespace
+
+namespace traffic_dump
+{
+DumpFile::DumpFile(ts::file::path path, std::string beginning) : _path(std::move(path)), _pending(std::move(beginning)) {}
+
+DumpFile::~DumpFile()
+{
+  if (!_finished) {
+    finish();
+  }
+}
+
+void
+DumpFile::flush()
+{
+  if (_failed || _pending.empty()) {
+    _pending.clear();
+    return;
+  }
+
+  if (_fd < 0) {
+    // Create subdir if not existing
+    ts::file::path log_p = _path.parent_path();
+    std::error_code ec;
+    ts::file::status(log_p, ec);
+    if (ec && mkdir(log_p.c_str(), 0755) == -1 && errno != EEXIST) {
+      TSDebug(debug_tag, "DumpFile::flush(): Failed to create dir %s", log_p.c_str());
+      TSError("[%s] Failed to create dir %s", debug_tag, log_p.c_str());
+    }
+
+    _fd = open(_path.c_str(), O_RDWR | O_CREAT, S_IRWXU);
+    if (_fd < 0) {
+      TSDebug(debug_tag, "DumpFile::flush(): Failed to open log file %s, discarding the session.", _path.c_str());
+      _failed = true;
+      _pending.clear();
+      return;
+    }
+  }
+
+  char const *data = _pending.data();
+  size_t left      = _pending.size();
+  while (left > 0) {
+    ssize_t n = write(_fd, data, left);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      TSError("[%s] Failed to write to %s, errno=%d", debug_tag, _path.c_str(), errno);
+      break;
+    }
+    data += n;
+    left -= n;
+    _written += n;
+  }
+  _pending.clear();
+}
+
+void
+DumpFile::finish()
+{
+  _finished = true;
+  if (!_failed) {
+    _pending += json_closing;
+  }
+  flush();
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+    if (disk_usage) {
+      *disk_usage += _written;
+    }
+    TSDebug(debug_tag, "Finish a session with log file of %" PRId64 " bytes", _written);
+  }
+}
+
+bool
+DumpWriter::init(int64_t queue_size, std::atomic<int64_t> *disk_usage_counter)
+{
+  disk_usage  = disk_usage_counter;
+  write_queue = std::make_unique<BoundedQueue<QueueItem>>(queue_size > 0 ? queue_size : default_queue_size);
+
+  if (TSStatFindName("plugin.traffic_dump.dropped_transactions", &dropped_transactions_stat) == TS_ERROR) {
+    dropped_transactions_stat = TSStatCreate("plugin.traffic_dump.dropped_transactions", TS_RECORDDATATYPE_COUNTER,
+                                             TS_STAT_NON_PERSISTENT, TS_STAT_SYNC_SUM);
+  }
+
+  if (!TSThreadCreate(run, nullptr)) {
+    TSError("[%s] Failed to create the writer thread.", debug_tag);
+    return false;
+  }
+  TSDebug(debug_tag, "Initialized the writer with a queue of %zu transactions", write_queue->capacity());
+  return true;
+}
+
+bool
+DumpWriter::write_transaction(std::shared_ptr<DumpFile> const &file, std::string &&content)
+{
+  QueueItem item{file, std::move(content), false};
+  if (!write_queue->push(std::move(item))) {
+    TSDebug(debug_tag, "The writer queue is full, dropping a transaction.");
+    TSStatIntIncrement(dropped_transactions_stat, 1);
+    return false;
+  }
+  return true;
+}
+
+void
+DumpWriter::finish(std::shared_ptr<DumpFile> file)
+{
+  QueueItem item{std::move(file), std::string(), true};
+  // If it is not queued, the file is closed by the last of the references to
+  // it, that of this item or those of its transactions that are queued.
+  write_queue->push(std::move(item));
+}
+
+void *
+DumpWriter::run(void *)
+{
+  std::vector<std::shared_ptr<DumpFile>> batch;
+  std::vector<std::shared_ptr<DumpFile>> finished;
+  QueueItem item;
+
+  while (true) {
+    int count = 0;
+    while (count < max_batch_size && write_queue->pop(item)) {
+      ++count;
+      DumpFile &file = *item.file;
+      if (item.finish) {
+        finished.emplace_back(std::move(item.file));
+      } else {
+        if (file._has_written_first_transaction) {
+          file._pending += ',';
+        }
+        file._pending += item.content;
+        file._has_written_first_transaction = true;
+        if (!file._in_batch) {
+          file._in_batch = true;
+          batch.emplace_back(std::move(item.file));
+        }
+      }
+      item = QueueItem();
+    }
+
+    for (auto &file : batch) {
+      file->flush();
+      file->_in_batch = false;
+    }
+    batch.clear();
+    for (auto &file : finished) {
+      file->finish();
+    }
+    finished.clear();
+
+    if (count == 0) {
+      std::this_thread::sleep_for(idle_interval);
+    }
+  }
+  return nullptr;
+}
+
+} // namespace traffic_dump
@@ -0,0 +1,128 @@
+/** @file
+
+  Traffic Dump writer thread encapsulation.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "tscore/ts_file.h"
+
+namespace traffic_dump
+{
+/** The dump file of a session.
+ *
+ * It is created by the session, then only touched by the writer thread,
+ * through the queue, which opens it, writes to it and finishes it. Whoever
+ * drops the last reference to it finishes it if the writer did not: the
+ * writer if it still has some of its content queued, the session otherwise.
+ */
+class DumpFile
+{
+public:
+  /**
+   * @param[in] path The path of the file, created with its directory.
+   *
+   * @param[in] beginning The JSON that opens the session, before its
+   * transactions.
+   */
+  DumpFile(ts::file::path path, std::string beginning);
+  ~DumpFile();
+
+  DumpFile(DumpFile const &) = delete;
+  DumpFile &operator=(DumpFile const &) = delete;
+
+private:
+  friend class DumpWriter;
+
+  /// Write what is pending, opening the file first if it was not.
+  void flush();
+  /// Write the closing of the session and close the file.
+  void finish();
+
+  ts::file::path _path;
+  /// The content not written yet, starting with the beginning of the session.
+  std::string _pending;
+  int _fd = -1;
+  /// Whether opening the file failed, its content is discarded then.
+  bool _failed = false;
+  /// Whether the file was finished.
+  bool _finished = false;
+  /// Whether a transaction was written, the following ones are preceded by a comma.
+  bool _has_written_first_transaction = false;
+  /// Whether the file has content pending in the current batch of the writer.
+  bool _in_batch = false;
+  int64_t _written = 0;
+};
+
+/** The thread writing the dump files.
+ *
+ * The transaction hooks hand their JSON to the writer through a bounded, lock
+ * free queue, and go on: they never wait for a lock, a disk or the writer.
+ * The writer drains the queue in batches, gathering the content of each file,
+ * and writes each file once a batch. When the queue is full, the transaction
+ * is dropped and counted in the plugin.traffic_dump.dropped_transactions
+ * stat, the dump of its session is then as if it did not have it.
+ */
+class DumpWriter
+{
+public:
+  /// By default, up to 4096 transactions are queued for the writer.
+  static constexpr int64_t default_queue_size = 4096;
+
+  /** Create the queue and start the writer thread.
+   *
+   * @param[in] queue_size The number of transactions the queue holds.
+   *
+   * @param[in] disk_usage The counter of the bytes written, updated as the
+   * files are finished.
+   *
+   * @return True if the thread was started, false otherwise.
+   */
+  static bool init(int64_t queue_size, std::atomic<int64_t> *disk_usage);
+
+  /** Queue a transaction of the session of @a file.
+   *
+   * @param[in] file The dump file of the session.
+   *
+   * @param[in] content The JSON of the transaction, moved to the queue.
+   *
+   * @return True if it was queued, false if it was dropped.
+   */
+  static bool write_transaction(std::shared_ptr<DumpFile> const &file, std::string &&content);
+
+  /** Queue the end of the session of @a file.
+   *
+   * If the queue is full, the file is finished when its last reference is
+   * dropped.
+   */
+  static void finish(std::shared_ptr<DumpFile> file);
+
+private:
+  /** The writer loop. */
+  static void *run(void *);
+};
+
+} // namespace traffic_dump
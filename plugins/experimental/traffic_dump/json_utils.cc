@@ -21,141 +21,105 @@
   limitations under the License.
  */
 
-#include <iomanip>
-#include <sstream>
-
 #include "json_utils.h"
 
 namespace
 {
-/** Write the content of buf to jsonfile between prevIdx (inclusive) and idx (not
- * inclusive).
- *
- * This function is used to help deal with escaped characters with a low number
- * of write calls. This is meant to be used like so: the caller inspects every
- * character in a buffer, doing one of two things with each character:
- *
- *  - The character does not need to be escaped. In this case, no call to
- *  write_buffered_content is made and the idx is advanced and prevIdx is not
- *  advanced. Eventually this character will be written once the contiguous set
- *  of non-escaped characters is collected.
- *
- *  - The character needs to be escaped. In this case, it will call this
- *  function. Anything between prevIdx and up to (but not including) idx is
- *  written. The caller then writes the escaped sequence for the character
- *  pointed to by idx ("\\t" instead of '\t', for instance). Then prevIdx is set
- *  past the escaped character.
- *
- * Finally, once all characters are inspected, a final write_buffered_content
- * call is made with idx set to one past the last character in buf. This
- * results in all characters between prevIdx and the last character in buf
- * (including that character) to be written.
+/** Whether each character needs to be escaped: the quote, the backslash and
+ * the control characters.
+ */
+struct EscapeTable {
+  bool escape[256] = {};
+  constexpr EscapeTable()
+  {
+    for (int c = 0; c < 0x20; ++c) {
+      escape[c] = true;
+    }
+    escape[static_cast<unsigned char>('"')]  = true;
+    escape[static_cast<unsigned char>('\\')] = true;
+  }
+};
+constexpr EscapeTable escape_table;
+
+/** Append the characters of buf to out, escaped for a JSON string.
  *
- * @param[in] buf The buffer containing characters that need to be written to jsonfile.
+ * The runs of characters that need no escaping, most of them, are appended
+ * at once, only those that do are looked at one by one.
  *
- * @param[in,out] prevIdx The pointer to the beginning of the set of characters
- * in buf that have not been written yet. This is always updated before
- * function exit to one past idx.
+ * @param[in] buf The characters to escape.
  *
- * @param[in] idx The current character in buf being inspected.
+ * @param[in] len The number of characters in buf.
  *
- * @param[out] jsonfile The stream to conditionally write buffer content to.
+ * @param[out] out The string to append the escaped characters to.
  */
-inline void
-write_buffered_context(char const *buf, int64_t &prevIdx, int64_t idx, std::ostream &jsonfile)
+void
+esc_json_out(char const *buf, int64_t len, std::string &out)
 {
-  if (prevIdx < idx) {
-    jsonfile.write(buf + prevIdx, idx - prevIdx);
-  }
-  prevIdx = idx + 1;
-}
+  static char const constexpr hex_digits[] = "0123456789abcdef";
 
-int
-esc_json_out(const char *buf, int64_t len, std::ostream &jsonfile)
-{
   if (buf == nullptr) {
-    return 0;
+    return;
   }
-  int64_t idx = 0, prevIdx = 0;
-  // For an explanation of the algorithm here, see the doxygen comment for
-  // write_buffered_content.
-  for (idx = 0; idx < len; idx++) {
-    char c = *(buf + idx);
+  int64_t prevIdx = 0;
+  for (int64_t idx = 0; idx < len; ++idx) {
+    unsigned char const c = static_cast<unsigned char>(buf[idx]);
+    if (!escape_table.escape[c]) {
+      continue;
+    }
+    out.append(buf + prevIdx, idx - prevIdx);
+    prevIdx = idx + 1;
     switch (c) {
     case '"':
-    case '\\': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\" << c;
+    case '\\':
+      out += '\\';
+      out += static_cast<char>(c);
       break;
-    }
-    case '\b': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\b";
+    case '\b':
+      out += "\\b";
       break;
-    }
-    case '\f': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\f";
+    case '\f':
+      out += "\\f";
       break;
-    }
-    case '\n': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\n";
+    case '\n':
+      out += "\\n";
       break;
-    }
-    case '\r': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\r";
+    case '\r':
+      out += "\\r";
       break;
-    }
-    case '\t': {
-      write_buffered_context(buf, prevIdx, idx, jsonfile);
-      jsonfile << "\\t";
+    case '\t':
+      out += "\\t";
       break;
-    }
-    default: {
-      if ('\x00' <= c && c <= '\x1f') {
-        write_buffered_context(buf, prevIdx, idx, jsonfile);
-        jsonfile << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-      }
+    default:
+      out += "\\u00";
+      out += hex_digits[c >> 4];
+      out += hex_digits[c & 0xf];
       break;
-      // else: The character does not need to be escaped. Do not call
-      // write_buffered_content so nothing is written and prevIdx remains
-      // pointing to the first character that needs to be written on the next
-      // call to write_buffered_content.
-    }
     }
   }
-  // Finally, call write_buffered_content to write out any data that has not
-  // been written yet.
-  write_buffered_context(buf, prevIdx, idx, jsonfile);
-
-  return len;
-}
-/** Escape characters in a string as needed and return the resultant escaped string.
- *
- * @param[in] s The characters that need to be escaped.
- */
-std::string
-escape_json(std::string_view s)
-{
-  std::ostringstream o;
-  esc_json_out(s.data(), s.length(), o);
-  return o.str();
+  out.append(buf + prevIdx, len - prevIdx);
 }
 
-/** An escape_json overload for a char buffer.
+/** Create name and value as the quoted, escaped strings of a JSON entry.
+ *
+ * @param[in] open What precedes the name.
  *
- * @param[in] buf The char buffer pointer with characters that need to be escaped.
+ * @param[in] separator What is between the name and the value.
  *
- * @param[in] size The size of the buf char array.
+ * @param[in] close What follows the value.
  */
 std::string
-escape_json(char const *buf, int64_t size)
+json_pair(std::string_view open, std::string_view name, std::string_view separator, char const *value, int64_t size,
+          std::string_view close)
 {
-  std::ostringstream o;
-  esc_json_out(buf, size, o);
-  return o.str();
+  std::string result;
+  // Most fields have only a few characters, if any, to escape.
+  result.reserve(open.size() + name.size() + separator.size() + size + close.size() + 8);
+  result.append(open);
+  esc_json_out(name.data(), name.size(), result);
+  result.append(separator);
+  esc_json_out(value, size, result);
+  result.append(close);
+  return result;
 }
 
 } // anonymous namespace
@@ -165,19 +129,19 @@ namespace traffic_dump
 std::string
 json_entry(std::string_view name, std::string_view value)
 {
-  return "\"" + escape_json(name) + "\":\"" + escape_json(value) + "\"";
+  return json_pair("\"", name, "\":\"", value.data(), value.size(), "\"");
 }
 
 std::string
 json_entry(std::string_view name, char const *value, int64_t size)
 {
-  return "\"" + escape_json(name) + "\":\"" + escape_json(value, size) + "\"";
+  return json_pair("\"", name, "\":\"", value, size, "\"");
 }
 
 std::string
 json_entry_array(std::string_view name, std::string_view value)
 {
-  return "[\"" + escape_json(name) + "\",\"" + escape_json(value) + "\"]";
+  return json_pair("[\"", name, "\",\"", value.data(), value.size(), "\"]");
 }
 
 } // namespace traffic_dump
@@ -23,13 +23,10 @@
 
 #include <arpa/inet.h>
 #include <chrono>
-#include <fcntl.h>
 #include <iomanip>
 #include <netinet/in.h>
 #include <openssl/ssl.h>
 #include <sstream>
-#include <sys/stat.h>
-#include <sys/types.h>
 #include <unordered_map>
 
 #include <tscore/ink_inet.h>
@@ -40,9 +37,6 @@
 
 namespace
 {
-/** The final string used to close a JSON session. */
-char const constexpr *const json_closing = "]}]}";
-
 /**
  * A mapping from IP_PROTO_TAG to the string describing the JSON protocol node.
  */
@@ -180,7 +174,7 @@ SessionData::set_max_disk_usage(int64_t new_max_disk_usage)
 }
 
 bool
-SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size)
+SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, int64_t queue_size)
 {
   SessionData::log_directory    = log_directory;
   SessionData::max_disk_usage   = max_disk_usage;
@@ -191,6 +185,11 @@ SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_
     return false;
   }
 
+  if (!DumpWriter::init(queue_size, &disk_usage)) {
+    TSError("[%s] Unable to initialize plugin (disabled). Failed to start the writer.", traffic_dump::debug_tag);
+    return false;
+  }
+
   TSCont ssncont = TSContCreate(global_session_handler, nullptr);
   TSHttpHookAdd(TS_HTTP_SSN_START_HOOK, ssncont);
   TSHttpHookAdd(TS_HTTP_SSN_CLOSE_HOOK, ssncont);
@@ -202,9 +201,10 @@ SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_
 }
 
 bool
-SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, std::string_view sni_filter)
+SessionData::init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, int64_t queue_size,
+                  std::string_view sni_filter)
 {
-  if (!init(log_directory, max_disk_usage, sample_size)) {
+  if (!init(log_directory, max_disk_usage, sample_size, queue_size)) {
     return false;
   }
   SessionData::sni_filter = sni_filter;
@@ -276,70 +276,20 @@ SessionData::get_server_protocol_description(TSHttpTxn server_txnp)
 
 SessionData::SessionData()
 {
-  aio_cont = TSContCreate(session_aio_handler, TSMutexCreate());
   txn_cont = TSContCreate(TransactionData::global_transaction_handler, nullptr);
 }
 
 SessionData::~SessionData()
 {
-  if (aio_cont) {
-    TSContDestroy(aio_cont);
-  }
   if (txn_cont) {
     TSContDestroy(txn_cont);
   }
 }
 
-/*
- * Note this assumes that the caller holds the disk_io_mutex lock. This is a
- * private member function. The two publicly accessible functions hold the
- * lock before calling this.
- */
-int
-SessionData::write_to_disk_no_lock(std::string_view content)
-{
-  char *pBuf = nullptr;
-  // Allocate a buffer for aio writing
-  if ((pBuf = static_cast<char *>(TSmalloc(sizeof(char) * content.size())))) {
-    memcpy(pBuf, content.data(), content.size());
-    if (TS_SUCCESS == TSAIOWrite(log_fd, write_offset, pBuf, content.size(), aio_cont)) {
-      // Update offset within file and aio events count
-      write_offset += content.size();
-      aio_count += 1;
-
-      return TS_SUCCESS;
-    }
-    TSfree(pBuf);
-  }
-  return TS_ERROR;
-}
-
-int
-SessionData::write_to_disk(std::string_view content)
-{
-  const std::lock_guard<std::recursive_mutex> _(disk_io_mutex);
-  const int result = write_to_disk_no_lock(content);
-  return result;
-}
-
 int
-SessionData::write_transaction_to_disk(std::string_view content)
+SessionData::write_transaction_to_disk(std::string &&content)
 {
-  const std::lock_guard<std::recursive_mutex> _(disk_io_mutex);
-
-  int result = TS_SUCCESS;
-  if (has_written_first_transaction) {
-    // Prepend a comma.
-    std::string with_comma;
-    with_comma.reserve(content.size() + 1);
-    with_comma.insert(0, ",");
-    with_comma.insert(1, content);
-    result = write_to_disk_no_lock(with_comma);
-  } else {
-    result                        = write_to_disk_no_lock(content);
-    has_written_first_transaction = true;
-  }
-  return result;
+  return DumpWriter::write_transaction(dump_file, std::move(content)) ? TS_SUCCESS : TS_ERROR;
 }
 
 std::string
@@ -348,46 +298,6 @@ SessionData::get_http_version_in_client_stack() const
   return http_version_in_client_stack;
 }
 
-int
-SessionData::session_aio_handler(TSCont contp, TSEvent event, void *edata)
-{
-  switch (event) {
-  case TS_EVENT_AIO_DONE: {
-    TSAIOCallback cb     = static_cast<TSAIOCallback>(edata);
-    SessionData *ssnData = static_cast<SessionData *>(TSContDataGet(contp));
-    if (!ssnData) {
-      TSDebug(debug_tag, "session_aio_handler(): No valid ssnData. Abort.");
-      return TS_ERROR;
-    }
-    char *buf = TSAIOBufGet(cb);
-    const std::lock_guard<std::recursive_mutex> _(ssnData->disk_io_mutex);
-
-    // Free the allocated buffer and update aio_count
-    if (buf) {
-      TSfree(buf);
-      if (--ssnData->aio_count == 0 && ssnData->ssn_closed) {
-        // check for ssn close, if closed, do clean up
-        TSContDataSet(contp, nullptr);
-        close(ssnData->log_fd);
-        std::error_code ec;
-        ts::file::file_status st = ts::file::status(ssnData->log_name, ec);
-        if (!ec) {
-          disk_usage += ts::file::file_size(st);
-          TSDebug(debug_tag, "Finish a session with log file of %" PRIuMAX "bytes", ts::file::file_size(st));
-        }
-        delete ssnData;
-        return TS_SUCCESS;
-      }
-    }
-    return TS_SUCCESS;
-  }
-  default:
-    TSDebug(debug_tag, "session_aio_handler(): unhandled events %d", event);
-    return TS_ERROR;
-  }
-  return TS_SUCCESS;
-}
-
 int
 SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
 {
@@ -439,8 +349,6 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
     SessionData *ssnData = new SessionData;
     TSUserArgSet(ssnp, session_arg_index, ssnData);
 
-    TSContDataSet(ssnData->aio_cont, ssnData);
-
     // "protocol":
     // This is the protocol stack for the client side of the session.
     std::string protocol_description = ssnData->get_client_protocol_description(ssnp);
@@ -464,31 +372,11 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
       snprintf(client_str, INET6_ADDRSTRLEN, "unknown");
     }
 
-    // Initialize AIO file
-    const std::lock_guard<std::recursive_mutex> _(ssnData->disk_io_mutex);
-    if (ssnData->log_fd < 0) {
-      ts::file::path log_p = log_directory / ts::file::path(std::string(client_str, 3));
-      ts::file::path log_f = log_p / ts::file::path(session_hex_name);
-
-      // Create subdir if not existing
-      std::error_code ec;
-      ts::file::status(log_p, ec);
-      if (ec && mkdir(log_p.c_str(), 0755) == -1) {
-        TSDebug(debug_tag, "global_session_handler(): Failed to create dir %s", log_p.c_str());
-        TSError("[%s] Failed to create dir %s", debug_tag, log_p.c_str());
-      }
-
-      // Try to open log files for AIO
-      ssnData->log_fd = open(log_f.c_str(), O_RDWR | O_CREAT, S_IRWXU);
-      if (ssnData->log_fd < 0) {
-        TSDebug(debug_tag, "global_session_handler(): Failed to open log files %s. Abort.", log_f.c_str());
-        TSHttpSsnReenable(ssnp, TS_EVENT_HTTP_CONTINUE);
-        return TS_EVENT_HTTP_CONTINUE;
-      }
-      ssnData->log_name = log_f;
-      // Write log file beginning to disk
-      ssnData->write_to_disk(beginning);
-    }
+    // The writer thread creates the directory and the file, and writes the
+    // beginning, with the first batch of content it has for the session.
+    ts::file::path log_p = log_directory / ts::file::path(std::string(client_str, 3));
+    ts::file::path log_f = log_p / ts::file::path(session_hex_name);
+    ssnData->dump_file   = std::make_shared<DumpFile>(log_f, std::move(beginning));
 
     TSHttpSsnHookAdd(ssnp, TS_HTTP_TXN_START_HOOK, ssnData->txn_cont);
     TSHttpSsnHookAdd(ssnp, TS_HTTP_TXN_CLOSE_HOOK, ssnData->txn_cont);
@@ -506,11 +394,9 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
       TSHttpSsnReenable(ssnp, TS_EVENT_HTTP_CONTINUE);
       return TS_SUCCESS;
     }
-    ssnData->write_to_disk(json_closing);
-    {
-      const std::lock_guard<std::recursive_mutex> _(ssnData->disk_io_mutex);
-      ssnData->ssn_closed = true;
-    }
+    DumpWriter::finish(std::move(ssnData->dump_file));
+    TSUserArgSet(ssnp, session_arg_index, nullptr);
+    delete ssnData;
 
     break;
   }
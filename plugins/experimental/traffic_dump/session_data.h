@@ -25,13 +25,16 @@
 
 #include <atomic>
 #include <cstdlib>
-#include <mutex>
+#include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 
 #include "ts/ts.h"
 #include "tscore/ts_file.h"
 
+#include "dump_writer.h"
+
 namespace traffic_dump
 {
 /** The information associated with an individual session.
@@ -54,30 +57,14 @@ private:
   // Instance Variables
   //
 
-  /// Log file descriptor for this session's dump file.
-  int log_fd = -1;
-  /// The count of the currently outstanding AIO operations.
-  int aio_count = 0;
-  /// The offset of the last point written to so for in the dump file for this
-  /// session.
-  int64_t write_offset = 0;
-  /// Whether this session has been closed.
-  bool ssn_closed = false;
-  /// The filename for this session's dump file.
-  ts::file::path log_name;
-  /// Whether the first transaction in this session has been written.
-  bool has_written_first_transaction = false;
+  /// This session's dump file, written by the writer thread.
+  std::shared_ptr<DumpFile> dump_file;
   /// The HTTP version specified in the client protocol stack, or empty string
   /// if it was not specified.
   std::string http_version_in_client_stack;
 
-  TSCont aio_cont = nullptr; /// AIO continuation callback
   TSCont txn_cont = nullptr; /// Transaction continuation callback
 
-  // The following has to be recursive because the stack does not unwind
-  // between event invocations.
-  std::recursive_mutex disk_io_mutex; /// The mutex for guarding IO calls.
-
   //
   // Static Variables
   //
@@ -115,8 +102,9 @@ public:
    *
    * @return True if initialization is successful, false otherwise.
    */
-  static bool init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size);
-  static bool init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, std::string_view sni_filter);
+  static bool init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, int64_t queue_size);
+  static bool init(std::string_view log_directory, int64_t max_disk_usage, int64_t sample_size, int64_t queue_size,
+                   std::string_view sni_filter);
 
   /** Set the sample_pool_size to a new value.
    *
@@ -147,23 +135,15 @@ public:
    */
   std::string get_server_protocol_description(TSHttpTxn txnp);
 
-  /** Write the string to the session's dump file.
-   *
-   * @param[in] content The content to write to the file.
-   *
-   * @return TS_SUCCESS if the write is successfully scheduled with the AIO
-   * system, TS_ERROR otherwise.
-   */
-  int write_to_disk(std::string_view content);
-
   /** Write the transaction to the session's dump file.
    *
-   * @param[in] content The transaction content to write to the file.
+   * @param[in] content The transaction content to write to the file, moved
+   * to the writer thread.
    *
-   * @return TS_SUCCESS if the write is successfully scheduled with the AIO
-   * system, TS_ERROR otherwise.
+   * @return TS_SUCCESS if the write is queued for the writer thread,
+   * TS_ERROR if the queue is full and the transaction was dropped.
    */
-  int write_transaction_to_disk(std::string_view content);
+  int write_transaction_to_disk(std::string &&content);
 
   /** The HTTP version specified in the client-side protocol stack.
    *
@@ -179,17 +159,6 @@ public:
   std::string get_http_version_in_client_stack() const;
 
 private:
-  /** Write the string to the session's dump file.
-   *
-   * This assumes that the caller acquired the required AIO lock.
-   *
-   * @param[in] content The content to write to the file.
-   *
-   * @return TS_SUCCESS if the write is successfully scheduled with the AIO
-   * system, TS_ERROR otherwise.
-   */
-  int write_to_disk_no_lock(std::string_view content);
-
   using get_protocol_stack_f  = std::function<TSReturnCode(int, const char **, int *)>;
   using get_tls_description_f = std::function<std::string()>;
   using handle_http_version_f = std::function<void(std::string_view)>;
@@ -222,9 +191,6 @@ private:
    */
   std::string get_client_protocol_description(TSHttpSsn ssnp);
 
-  /** The handler callback for when async IO is done. Used for cleanup. */
-  static int session_aio_handler(TSCont contp, TSEvent event, void *edata);
-
   /** The handler callback for session events. */
   static int global_session_handler(TSCont contp, TSEvent event, void *edata);
 };
@@ -86,13 +86,15 @@ TSPluginInit(int argc, char const *argv[])
   ts::file::path log_dir{traffic_dump::SessionData::default_log_directory};
   int64_t sample_pool_size = traffic_dump::SessionData::default_sample_pool_size;
   int64_t max_disk_usage   = traffic_dump::SessionData::default_max_disk_usage;
+  int64_t queue_size       = traffic_dump::DumpWriter::default_queue_size;
   std::string sni_filter;
 
   /// Commandline options
   static const struct option longopts[] = {
     {"logdir", required_argument, nullptr, 'l'},     {"sample", required_argument, nullptr, 's'},
     {"limit", required_argument, nullptr, 'm'},      {"sensitive-fields", required_argument, nullptr, 'f'},
-    {"sni-filter", required_argument, nullptr, 'n'}, {nullptr, no_argument, nullptr, 0}};
+    {"sni-filter", required_argument, nullptr, 'n'}, {"queue-size", required_argument, nullptr, 'q'},
+    {nullptr, no_argument, nullptr, 0}};
   int opt = 0;
   while (opt >= 0) {
     opt = getopt_long(argc, const_cast<char *const *>(argv), "l:", longopts, nullptr);
@@ -133,6 +135,11 @@ TSPluginInit(int argc, char const *argv[])
     }
     case 'm': {
       max_disk_usage = static_cast<int64_t>(std::strtol(optarg, nullptr, 0));
+      break;
+    }
+    case 'q': {
+      queue_size = static_cast<int64_t>(std::strtol(optarg, nullptr, 0));
+      break;
     }
     case -1:
     case '?':
@@ -148,12 +155,12 @@ TSPluginInit(int argc, char const *argv[])
     log_dir = ts::file::path(TSInstallDirGet()) / log_dir;
   }
   if (sni_filter.empty()) {
-    if (!traffic_dump::SessionData::init(log_dir.view(), max_disk_usage, sample_pool_size)) {
+    if (!traffic_dump::SessionData::init(log_dir.view(), max_disk_usage, sample_pool_size, queue_size)) {
       TSError("[%s] Failed to initialize session state.", traffic_dump::debug_tag);
       return;
     }
   } else {
-    if (!traffic_dump::SessionData::init(log_dir.view(), max_disk_usage, sample_pool_size, sni_filter)) {
+    if (!traffic_dump::SessionData::init(log_dir.view(), max_disk_usage, sample_pool_size, queue_size, sni_filter)) {
       TSError("[%s] Failed to initialize session state with an SNI filter.", traffic_dump::debug_tag);
       return;
     }
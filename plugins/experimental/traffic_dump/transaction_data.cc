@@ -306,7 +306,7 @@ TransactionData::write_proxy_response_node(TSMBuffer &buffer, TSMLoc &hdr_loc)
                write_message_node(buffer, hdr_loc, TSHttpTxnClientRespBodyBytesGet(_txnp), _http_version_from_client_stack);
 }
 
-// Transaction handler: writes headers to the log file using AIO
+// Transaction handler: hands the headers to the writer thread of the log files
 int
 TransactionData::global_transaction_handler(TSCont contp, TSEvent event, void *edata)
 {
@@ -426,7 +426,7 @@ TransactionData::global_transaction_handler(TSCont contp, TSEvent event, void *e
     }
 
     txnData->_txn_json += "}";
-    ssnData->write_transaction_to_disk(txnData->_txn_json);
+    ssnData->write_transaction_to_disk(std::move(txnData->_txn_json));
     delete txnData;
     break;
   }
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bounded_queue.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+
+using namespace traffic_dump;
+
+TEST_CASE("BoundedQueue", "[BoundedQueue]")
+{
+  SECTION("The capacity is rounded up to a power of 2")
+  {
+    CHECK(BoundedQueue<int>(1).capacity() == 2);
+    CHECK(BoundedQueue<int>(5).capacity() == 8);
+    CHECK(BoundedQueue<int>(4096).capacity() == 4096);
+  }
+
+  SECTION("Elements are popped in order, pushing fails when full")
+  {
+    BoundedQueue<std::string> queue(4);
+    std::string value;
+    CHECK_FALSE(queue.pop(value));
+    for (int i = 0; i < 4; ++i) {
+      std::string s = "value" + std::to_string(i);
+      CHECK(queue.push(std::move(s)));
+    }
+    std::string extra = "extra";
+    CHECK_FALSE(queue.push(std::move(extra)));
+    CHECK(extra == "extra");
+
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(queue.pop(value));
+      CHECK(value == "value" + std::to_string(i));
+    }
+    CHECK_FALSE(queue.pop(value));
+    CHECK(queue.push(std::move(extra)));
+    REQUIRE(queue.pop(value));
+    CHECK(value == "extra");
+  }
+
+  SECTION("Concurrent producers")
+  {
+    constexpr int producers = 4;
+    constexpr int count     = 10000;
+    BoundedQueue<int> queue(64);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&queue, p]() {
+        for (int i = 0; i < count; ++i) {
+          int value = p * count + i;
+          while (!queue.push(std::move(value))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    // Each producer's elements are popped in the order it pushed them.
+    std::vector<int> last(producers, -1);
+    int popped = 0;
+    int value  = 0;
+    while (popped < producers * count) {
+      if (queue.pop(value)) {
+        int p = value / count;
+        CHECK(value % count > last[p]);
+        last[p] = value % count;
+        ++popped;
+      }
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    CHECK_FALSE(queue.pop(value));
+  }
+}
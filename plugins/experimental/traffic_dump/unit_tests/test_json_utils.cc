@@ -50,6 +50,7 @@ TEST_CASE("JsonUtilsMap", "[json_entry]")
     CHECK(std::string(R"("name":"value\f")") == json_entry("name", "value\f"));
     CHECK(std::string(R"("na\rme":"\tva\nlue\f")") == json_entry("na\rme", "\tva\nlue\f"));
     CHECK(std::string(R"("\r":"\t\n\f")") == json_entry("\r", "\t\n\f"));
+    CHECK(std::string(R"("name":"\"va\u0001lue\u001f")") == json_entry("name", "\"va\x01lue\x1f"));
   }
 }
 
@@ -20,6 +20,7 @@
 #include "config.h"
 #include "timing.h"
 #include "jwt.h"
+#include "token_cache.h"
 
 #include <cjose/cjose.h>
 #include <jansson.h>
@@ -32,6 +33,8 @@
 
 #define AUTH_DENY 0
 #define AUTH_ALLOW 1
+
+#define DEFAULT_VERIFY_CACHE_SIZE 16384
 struct auth_directive {
   char auth;
   char *container;
@@ -45,6 +48,8 @@ struct config {
   struct auth_directive *auth_directives;
   char *id;
   bool strip_token;
+  size_t verify_cache_size;
+  struct token_cache *verify_cache;
 };
 
 cjose_jwk_t **
@@ -92,6 +97,12 @@ config_strip_token(struct config *cfg)
   return cfg->strip_token;
 }
 
+struct token_cache *
+config_verify_cache(struct config *cfg)
+{
+  return cfg->verify_cache;
+}
+
 struct config *
 config_new(size_t n)
 {
@@ -121,6 +132,9 @@ config_new(size_t n)
 
   cfg->strip_token = false;
 
+  cfg->verify_cache_size = DEFAULT_VERIFY_CACHE_SIZE;
+  cfg->verify_cache      = NULL;
+
   PluginDebug("New config object created at %p", cfg);
   return cfg;
 }
@@ -161,6 +175,7 @@ config_delete(struct config *cfg)
     }
     free(cfg->auth_directives);
   }
+  token_cache_delete(cfg->verify_cache);
   free(cfg);
 }
 
@@ -295,6 +310,15 @@ read_config(const char *path)
       cfg->strip_token = json_boolean_value(strip_json);
     }
 
+    json_t *verify_cache_json = json_object_get(jwks, "verify_cache_size");
+    if (verify_cache_json) {
+      if (json_is_integer(verify_cache_json) && json_integer_value(verify_cache_json) >= 0) {
+        cfg->verify_cache_size = json_integer_value(verify_cache_json);
+      } else {
+        PluginError("verify_cache_size must be a number of tokens, defaulting to %d", DEFAULT_VERIFY_CACHE_SIZE);
+      }
+    }
+
     size_t jwks_ct     = json_array_size(key_ary);
     cjose_jwk_t **jwks = (*jwkis++ = malloc((jwks_ct + 1) * sizeof *jwks));
     PluginDebug("Created table with size %d", cfg->issuers->size);
@@ -339,6 +363,7 @@ read_config(const char *path)
     PluginError("Cannot load remap without signing key.");
     goto cfg_fail;
   }
+  cfg->verify_cache = token_cache_new(cfg->verify_cache_size);
   json_decref(issuer_json);
   PluginDebug("Loaded config file successfully.");
   return cfg;
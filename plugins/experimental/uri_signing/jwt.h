@@ -43,6 +43,7 @@ void jwt_delete(struct jwt *jwt);
 bool jwt_validate(struct jwt *jwt);
 bool jwt_check_aud(json_t *aud, const char *id);
 bool jwt_check_uri(const char *cdniuc, const char *uri);
+double now(void);
 
 struct _cjose_jwk_int;
 char *renew(struct jwt *jwt, const char *iss, struct _cjose_jwk_int *jwk, const char *alg, const char *package);
@@ -22,6 +22,7 @@
 #include "jwt.h"
 #include "cookie.h"
 #include "timing.h"
+#include "token_cache.h"
 #include <cjose/cjose.h>
 #include <jansson.h>
 #include <string.h>
@@ -145,6 +146,47 @@ get_jws_from_cookie(const char **cookie, size_t *cookie_ct, const char *paramNam
   return jws;
 }
 
+/* Verify the signature of the jws with the key of its kid, or with any key of the issuer. */
+static bool
+verify_jws_signature(cjose_jws_t *jws, struct config *cfg, struct jwt *jwt)
+{
+  cjose_header_t *hdr = cjose_jws_get_protected(jws);
+  if (!hdr) {
+    PluginDebug("Cannot get protected header for %16p", jws);
+    return false;
+  }
+
+  const char *kid = cjose_header_get(hdr, "kid", NULL);
+  if (kid) {
+    cjose_jwk_t *jwk = find_key_by_kid(cfg, jwt->iss, kid);
+    if (!jwk) {
+      PluginDebug("Cannot find key %s for issuer %s for %16p", kid, jwt->iss, jws);
+      return false;
+    }
+    if (!cjose_jws_verify(jws, jwk, NULL)) {
+      PluginDebug("Key %s for issuer %s for %16p does not validate.", kid, jwt->iss, jws);
+      return false;
+    }
+  } else {
+    PluginDebug("Searching all keys for issuer %s for %16p", jwt->iss, jws);
+    cjose_jwk_t **jwks;
+    for (jwks = find_keys(cfg, jwt->iss); jwks && *jwks; ++jwks) {
+      if (cjose_jws_verify(jws, *jwks, NULL)) {
+        break;
+      }
+    }
+    if (!jwks || !*jwks) {
+      if (!jwks) {
+        PluginDebug("No keys found for issuer %s for %16p.", jwt->iss, jws);
+      } else {
+        PluginDebug("No valid key for issuer %s found for %16p", jwt->iss, jws);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
 struct jwt *
 validate_jws(cjose_jws_t *jws, struct config *cfg, const char *uri, size_t uri_ct)
 {
@@ -188,43 +230,27 @@ validate_jws(cjose_jws_t *jws, struct config *cfg, const char *uri, size_t uri_c
   }
   TimerDebug("initial validation of jwt");
 
-  cjose_header_t *hdr = cjose_jws_get_protected(jws);
-  TimerDebug("getting header of jws");
-  if (!hdr) {
-    PluginDebug("Cannot get protected header for %16p", jws);
-    goto jwt_fail;
+  /* The same token is presented again and again, e.g. for the segments of a video. Its claims are checked every time, its
+   * signature only the first time. */
+  struct token_cache *cache = config_verify_cache(cfg);
+  unsigned char digest[TOKEN_DIGEST_LENGTH];
+  const char *token = NULL;
+  if (cache && cjose_jws_export(jws, &token, &cerr) && token) {
+    token_digest(token, strlen(token), digest);
+    TimerDebug("getting the digest of the jws");
+  } else {
+    token = NULL;
   }
 
-  const char *kid = cjose_header_get(hdr, "kid", NULL);
-  TimerDebug("getting kid of jws header");
-  if (kid) {
-    cjose_jwk_t *jwk = find_key_by_kid(cfg, jwt->iss, kid);
-    TimerDebug("finding key for jwt");
-    if (!jwk) {
-      PluginDebug("Cannot find key %s for issuer %s for %16p", kid, jwt->iss, jws);
-      goto jwt_fail;
-    }
-    if (!cjose_jws_verify(jws, jwk, NULL)) {
-      PluginDebug("Key %s for issuer %s for %16p does not validate.", kid, jwt->iss, jws);
+  if (token && token_cache_lookup(cache, digest, now())) {
+    PluginDebug("Signature of %16p was verified before", jws);
+  } else {
+    if (!verify_jws_signature(jws, cfg, jwt)) {
       goto jwt_fail;
     }
     TimerDebug("checking crypto signature for jwt");
-  } else {
-    PluginDebug("Searching all keys for issuer %s for %16p", jwt->iss, jws);
-    cjose_jwk_t **jwks;
-    for (jwks = find_keys(cfg, jwt->iss); jwks && *jwks; ++jwks) {
-      if (cjose_jws_verify(jws, *jwks, NULL)) {
-        break;
-      }
-    }
-    TimerDebug("checking the crypto signature of all possible keys for jwt");
-    if (!jwks || !*jwks) {
-      if (!jwks) {
-        PluginDebug("No keys found for issuer %s for %16p.", jwt->iss, jws);
-      } else {
-        PluginDebug("No valid key for issuer %s found for %16p", jwt->iss, jws);
-      }
-      goto jwt_fail;
+    if (token) {
+      token_cache_insert(cache, digest, jwt->exp);
     }
   }
 
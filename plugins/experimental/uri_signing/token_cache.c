@@ -0,0 +1,153 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common.h"
+#include "token_cache.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <openssl/sha.h>
+
+#define TOKEN_CACHE_SHARDS 16
+#define TOKEN_CACHE_WAYS 4 /* A token is in one of the entries of a set of this many */
+
+struct token_entry {
+  unsigned char digest[TOKEN_DIGEST_LENGTH];
+  double expires; /* NAN if the token does not expire */
+  uint64_t used;  /* 0 if the entry is empty */
+};
+
+struct token_shard {
+  pthread_mutex_t lock;
+  uint64_t clock; /* The last use of an entry of the shard, the least recently used entry of a set is replaced */
+  struct token_entry *entries;
+};
+
+struct token_cache {
+  size_t sets; /* Per shard */
+  struct token_shard shards[TOKEN_CACHE_SHARDS];
+};
+
+struct token_cache *
+token_cache_new(size_t size)
+{
+  if (!size) {
+    return NULL;
+  }
+
+  struct token_cache *cache = malloc(sizeof *cache);
+  cache->sets               = size / (TOKEN_CACHE_SHARDS * TOKEN_CACHE_WAYS);
+  if (!cache->sets) {
+    cache->sets = 1;
+  }
+
+  for (int i = 0; i < TOKEN_CACHE_SHARDS; ++i) {
+    struct token_shard *shard = &cache->shards[i];
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->clock   = 0;
+    shard->entries = calloc(cache->sets * TOKEN_CACHE_WAYS, sizeof *shard->entries);
+  }
+  PluginDebug("Created token cache of %zu tokens", (size_t)TOKEN_CACHE_SHARDS * TOKEN_CACHE_WAYS * cache->sets);
+  return cache;
+}
+
+void
+token_cache_delete(struct token_cache *cache)
+{
+  if (!cache) {
+    return;
+  }
+  for (int i = 0; i < TOKEN_CACHE_SHARDS; ++i) {
+    pthread_mutex_destroy(&cache->shards[i].lock);
+    free(cache->shards[i].entries);
+  }
+  free(cache);
+}
+
+void
+token_digest(const char *token, size_t token_ct, unsigned char digest[TOKEN_DIGEST_LENGTH])
+{
+  SHA256((const unsigned char *)token, token_ct, digest);
+}
+
+/* The shard and the set of entries of a digest, from its bytes, which are as good as random. */
+static struct token_entry *
+token_set(struct token_cache *cache, const unsigned char digest[TOKEN_DIGEST_LENGTH], struct token_shard **shard)
+{
+  uint32_t h;
+
+  memcpy(&h, digest + 1, sizeof h);
+  *shard = &cache->shards[digest[0] % TOKEN_CACHE_SHARDS];
+  return (*shard)->entries + (h % cache->sets) * TOKEN_CACHE_WAYS;
+}
+
+bool
+token_cache_lookup(struct token_cache *cache, const unsigned char digest[TOKEN_DIGEST_LENGTH], double now)
+{
+  if (!cache) {
+    return false;
+  }
+
+  struct token_shard *shard;
+  struct token_entry *set = token_set(cache, digest, &shard);
+  bool found              = false;
+
+  pthread_mutex_lock(&shard->lock);
+  for (struct token_entry *e = set; e < set + TOKEN_CACHE_WAYS; ++e) {
+    if (e->used && !memcmp(e->digest, digest, TOKEN_DIGEST_LENGTH)) {
+      if (now > e->expires) {
+        e->used = 0;
+      } else {
+        e->used = ++shard->clock;
+        found   = true;
+      }
+      break;
+    }
+  }
+  pthread_mutex_unlock(&shard->lock);
+  return found;
+}
+
+void
+token_cache_insert(struct token_cache *cache, const unsigned char digest[TOKEN_DIGEST_LENGTH], double expires)
+{
+  if (!cache) {
+    return;
+  }
+
+  struct token_shard *shard;
+  struct token_entry *set    = token_set(cache, digest, &shard);
+  struct token_entry *victim = set;
+
+  pthread_mutex_lock(&shard->lock);
+  for (struct token_entry *e = set; e < set + TOKEN_CACHE_WAYS; ++e) {
+    if (e->used && !memcmp(e->digest, digest, TOKEN_DIGEST_LENGTH)) {
+      victim = e;
+      break;
+    }
+    if (e->used < victim->used) {
+      victim = e;
+    }
+  }
+  memcpy(victim->digest, digest, TOKEN_DIGEST_LENGTH);
+  victim->expires = expires;
+  victim->used    = ++shard->clock;
+  pthread_mutex_unlock(&shard->lock);
+}
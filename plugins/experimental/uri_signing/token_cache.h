@@ -0,0 +1,36 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/* A cache of the tokens whose signature was verified, so that the requests bearing the same token, such as those for the
+ * segments of a video, do not verify it again. The tokens are known by their SHA-256 digest. The cache holds up to a fixed
+ * number of them, in shards with a lock each, and forgets a token once it expires or to make room for another. */
+
+#define TOKEN_DIGEST_LENGTH 32
+
+struct token_cache;
+
+struct token_cache *token_cache_new(size_t size);
+void token_cache_delete(struct token_cache *cache);
+void token_digest(const char *token, size_t token_ct, unsigned char digest[TOKEN_DIGEST_LENGTH]);
+bool token_cache_lookup(struct token_cache *cache, const unsigned char digest[TOKEN_DIGEST_LENGTH], double now);
+void token_cache_insert(struct token_cache *cache, const unsigned char digest[TOKEN_DIGEST_LENGTH], double expires);
@@ -23,6 +23,8 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <cmath>
+
 extern "C" {
 #include <jansson.h>
 #include <cjose/cjose.h>
@@ -31,6 +33,7 @@ extern "C" {
 #include "../parse.h"
 #include "../match.h"
 #include "../config.h"
+#include "../token_cache.h"
 }
 
 bool
@@ -661,3 +664,57 @@ TEST_CASE("8", "[TestsWithConfig]")
   config_delete(cfg);
   fprintf(stderr, "\n");
 }
+
+TEST_CASE("9", "[TokenCacheTests]")
+{
+  INFO("TEST 9, Token Verification Cache");
+
+  unsigned char a[TOKEN_DIGEST_LENGTH];
+  unsigned char b[TOKEN_DIGEST_LENGTH];
+  token_digest("token a", 7, a);
+  token_digest("token b", 7, b);
+
+  SECTION("Disabled Cache")
+  {
+    struct token_cache *cache = token_cache_new(0);
+    REQUIRE(cache == NULL);
+    token_cache_insert(cache, a, 200);
+    REQUIRE(!token_cache_lookup(cache, a, 100));
+  }
+
+  SECTION("Lookup And Expiry")
+  {
+    struct token_cache *cache = token_cache_new(1024);
+    REQUIRE(!token_cache_lookup(cache, a, 100));
+    token_cache_insert(cache, a, 200);
+    REQUIRE(token_cache_lookup(cache, a, 100));
+    REQUIRE(!token_cache_lookup(cache, b, 100));
+    REQUIRE(!token_cache_lookup(cache, a, 300));
+    REQUIRE(!token_cache_lookup(cache, a, 100));
+    token_cache_insert(cache, b, NAN);
+    REQUIRE(token_cache_lookup(cache, b, 1e12));
+    token_cache_delete(cache);
+  }
+
+  SECTION("Bounded Size")
+  {
+    struct token_cache *cache = token_cache_new(1);
+    unsigned char digest[TOKEN_DIGEST_LENGTH];
+    char token[32];
+    int found = 0;
+    for (int i = 0; i < 1000; ++i) {
+      snprintf(token, sizeof token, "token %d", i);
+      token_digest(token, strlen(token), digest);
+      token_cache_insert(cache, digest, 200);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      snprintf(token, sizeof token, "token %d", i);
+      token_digest(token, strlen(token), digest);
+      found += token_cache_lookup(cache, digest, 100);
+    }
+    REQUIRE(found <= 16 * 4);
+    REQUIRE(token_cache_lookup(cache, digest, 100));
+    token_cache_delete(cache);
+  }
+  fprintf(stderr, "\n");
+}
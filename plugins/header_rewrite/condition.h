@@ -59,32 +59,33 @@ public:
   Condition(const Condition &) = delete;
   void operator=(const Condition &) = delete;
 
-  // Inline this, it's critical for speed (and only used twice)
+  // Inline this, it's critical for speed. This is only this condition, RuleSet::eval() chains them.
   bool
-  do_eval(const Resources &res)
+  test(const Resources &res)
   {
     bool rt = eval(res);
 
-    if (_mods & COND_NOT) {
-      rt = !rt;
-    }
-
-    if (_next) {
-      if (_mods & COND_OR) {
-        return rt || (static_cast<Condition *>(_next)->do_eval(res));
-      } else { // AND is the default
-        // Short circuit if we're an AND and the first condition is FALSE.
-        if (rt) {
-          return static_cast<Condition *>(_next)->do_eval(res);
-        } else {
-          return false;
-        }
-      }
-    } else {
-      return rt;
-    }
-
-    return false; // Shouldn't happen.
+    return (_mods & COND_NOT) ? !rt : rt;
+  }
+
+  // Whether the outcome is known when loading the config, as it is for %{TRUE}, in @a value
+  virtual bool
+  is_constant(bool & /* value ATS_UNUSED */) const
+  {
+    return false;
+  }
+
+  bool
+  negated() const
+  {
+    return _mods & COND_NOT;
+  }
+
+  // OR'ed with the next condition, rather than AND'ed
+  bool
+  or_next() const
+  {
+    return _mods & COND_OR;
   }
 
   bool
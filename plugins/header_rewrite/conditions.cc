@@ -192,7 +192,8 @@ ConditionHeader::initialize(Parser &p)
   MatcherType *match = new MatcherType(_cond_op);
 
   match->set(p.get_arg());
-  _matcher = match;
+  _matcher     = match;
+  _header_name = header_name_token(_qualifier);
 
   require_resources(RSRC_CLIENT_REQUEST_HEADERS);
   require_resources(RSRC_CLIENT_RESPONSE_HEADERS);
@@ -205,7 +206,6 @@ ConditionHeader::append_value(std::string &s, const Resources &res)
 {
   TSMBuffer bufp;
   TSMLoc hdr_loc;
-  int len;
 
   if (_client) {
     bufp    = res.client_bufp;
@@ -216,24 +216,10 @@ ConditionHeader::append_value(std::string &s, const Resources &res)
   }
 
   if (bufp && hdr_loc) {
-    TSMLoc field_loc;
-
-    field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, _qualifier.c_str(), _qualifier.size());
-    TSDebug(PLUGIN_NAME, "Getting Header: %s, field_loc: %p", _qualifier.c_str(), field_loc);
-
-    while (field_loc) {
-      const char *value     = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &len);
-      TSMLoc next_field_loc = TSMimeHdrFieldNextDup(bufp, hdr_loc, field_loc);
+    const std::string &value = res.header_value(bufp, hdr_loc, _header_name, _qualifier.size());
 
-      TSDebug(PLUGIN_NAME, "Appending HEADER(%s) to evaluation value -> %.*s", _qualifier.c_str(), len, value);
-      s.append(value, len);
-      // multiple headers with the same name must be semantically the same as one value which is comma separated
-      if (next_field_loc) {
-        s += ',';
-      }
-      TSHandleMLocRelease(bufp, hdr_loc, field_loc);
-      field_loc = next_field_loc;
-    }
+    TSDebug(PLUGIN_NAME, "Appending HEADER(%s) to evaluation value -> %s", _qualifier.c_str(), value.c_str());
+    s += value;
   }
 }
 
@@ -53,6 +53,13 @@ public:
     s += "TRUE";
   }
 
+  bool
+  is_constant(bool &value) const override
+  {
+    value = true;
+    return true;
+  }
+
 protected:
   bool
   eval(const Resources & /* res ATS_UNUSED */) override
@@ -78,6 +85,13 @@ public:
     s += "FALSE";
   }
 
+  bool
+  is_constant(bool &value) const override
+  {
+    value = false;
+    return true;
+  }
+
 protected:
   bool
   eval(const Resources & /* res ATS_UNUSED */) override
@@ -264,6 +278,7 @@ protected:
 
 private:
   bool _client;
+  const char *_header_name = nullptr; // header_name_token() of the qualifier
 };
 
 // url
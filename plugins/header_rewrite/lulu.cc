@@ -16,7 +16,9 @@
   limitations under the License.
 */
 
+#include <set>
 #include <string>
+#include <strings.h>
 #include <netinet/in.h>
 
 #include "ts/ts.h"
@@ -89,3 +91,48 @@ getPort(sockaddr const *s_sockaddr)
     break;
   }
 }
+
+// The well known headers, and the other names the rules look up
+namespace
+{
+const char *const *const wks_header_names[] = {
+  &TS_MIME_FIELD_ACCEPT, &TS_MIME_FIELD_ACCEPT_CHARSET, &TS_MIME_FIELD_ACCEPT_ENCODING, &TS_MIME_FIELD_ACCEPT_LANGUAGE,
+  &TS_MIME_FIELD_ACCEPT_RANGES, &TS_MIME_FIELD_AGE, &TS_MIME_FIELD_ALLOW, &TS_MIME_FIELD_APPROVED, &TS_MIME_FIELD_AUTHORIZATION,
+  &TS_MIME_FIELD_BYTES, &TS_MIME_FIELD_CACHE_CONTROL, &TS_MIME_FIELD_CLIENT_IP, &TS_MIME_FIELD_CONNECTION,
+  &TS_MIME_FIELD_CONTENT_BASE, &TS_MIME_FIELD_CONTENT_ENCODING, &TS_MIME_FIELD_CONTENT_LANGUAGE, &TS_MIME_FIELD_CONTENT_LENGTH,
+  &TS_MIME_FIELD_CONTENT_LOCATION, &TS_MIME_FIELD_CONTENT_MD5, &TS_MIME_FIELD_CONTENT_RANGE, &TS_MIME_FIELD_CONTENT_TYPE,
+  &TS_MIME_FIELD_CONTROL, &TS_MIME_FIELD_COOKIE, &TS_MIME_FIELD_DATE, &TS_MIME_FIELD_DISTRIBUTION, &TS_MIME_FIELD_ETAG,
+  &TS_MIME_FIELD_EXPECT, &TS_MIME_FIELD_EXPIRES, &TS_MIME_FIELD_FOLLOWUP_TO, &TS_MIME_FIELD_FORWARDED, &TS_MIME_FIELD_FROM,
+  &TS_MIME_FIELD_HOST, &TS_MIME_FIELD_IF_MATCH, &TS_MIME_FIELD_IF_MODIFIED_SINCE, &TS_MIME_FIELD_IF_NONE_MATCH,
+  &TS_MIME_FIELD_IF_RANGE, &TS_MIME_FIELD_IF_UNMODIFIED_SINCE, &TS_MIME_FIELD_KEEP_ALIVE, &TS_MIME_FIELD_KEYWORDS,
+  &TS_MIME_FIELD_LAST_MODIFIED, &TS_MIME_FIELD_LINES, &TS_MIME_FIELD_LOCATION, &TS_MIME_FIELD_MAX_FORWARDS,
+  &TS_MIME_FIELD_MESSAGE_ID, &TS_MIME_FIELD_NEWSGROUPS, &TS_MIME_FIELD_ORGANIZATION, &TS_MIME_FIELD_PATH, &TS_MIME_FIELD_PRAGMA,
+  &TS_MIME_FIELD_PROXY_AUTHENTICATE, &TS_MIME_FIELD_PROXY_AUTHORIZATION, &TS_MIME_FIELD_PROXY_CONNECTION, &TS_MIME_FIELD_PUBLIC,
+  &TS_MIME_FIELD_RANGE, &TS_MIME_FIELD_REFERENCES, &TS_MIME_FIELD_REFERER, &TS_MIME_FIELD_REPLY_TO, &TS_MIME_FIELD_RETRY_AFTER,
+  &TS_MIME_FIELD_SENDER, &TS_MIME_FIELD_SERVER, &TS_MIME_FIELD_SET_COOKIE, &TS_MIME_FIELD_STRICT_TRANSPORT_SECURITY,
+  &TS_MIME_FIELD_SUBJECT, &TS_MIME_FIELD_SUMMARY, &TS_MIME_FIELD_TE, &TS_MIME_FIELD_TRANSFER_ENCODING, &TS_MIME_FIELD_UPGRADE,
+  &TS_MIME_FIELD_USER_AGENT, &TS_MIME_FIELD_VARY, &TS_MIME_FIELD_VIA, &TS_MIME_FIELD_WARNING, &TS_MIME_FIELD_WWW_AUTHENTICATE,
+  &TS_MIME_FIELD_XREF, &TS_MIME_FIELD_X_FORWARDED_FOR};
+
+struct CaseLess {
+  bool
+  operator()(const std::string &a, const std::string &b) const
+  {
+    return strcasecmp(a.c_str(), b.c_str()) < 0;
+  }
+};
+
+std::set<std::string, CaseLess> other_header_names;
+} // namespace
+
+const char *
+header_name_token(const std::string &name)
+{
+  for (const char *const *wks : wks_header_names) {
+    if (strcasecmp(*wks, name.c_str()) == 0) {
+      return *wks;
+    }
+  }
+
+  return other_header_names.insert(name).first->c_str();
+}
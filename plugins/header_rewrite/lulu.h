@@ -33,5 +33,10 @@ std::string getIP(sockaddr const *s_sockaddr);
 char *getIP(sockaddr const *s_sockaddr, char res[INET6_ADDRSTRLEN]);
 uint16_t getPort(sockaddr const *s_sockaddr);
 
+// The name to look up header @a name by: the core's own string for the well known headers, which
+// TSMimeHdrFieldFind() matches without hashing the name, and the same string for all the rules that
+// use a name, for Resources to remember its values by. Only to be called while loading a config.
+const char *header_name_token(const std::string &name);
+
 extern const char PLUGIN_NAME[];
 extern const char PLUGIN_NAME_DBG[];
@@ -56,6 +56,8 @@ public:
   do_exec(const Resources &res) const
   {
     exec(res);
+    // This may have changed the headers the conditions looked at
+    res.forget_header_values();
     if (nullptr != _next) {
       static_cast<Operator *>(_next)->do_exec(res);
     }
@@ -85,6 +87,7 @@ public:
 
 protected:
   std::string _header;
+  const char *_header_name = nullptr; // header_name_token() of _header, to look it up by
 };
 
 ///////////////////////////////////////////////////////////////////////////////
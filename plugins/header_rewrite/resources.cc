@@ -123,3 +123,34 @@ Resources::destroy()
 
   _ready = false;
 }
+
+const std::string &
+Resources::header_value(TSMBuffer hdr_bufp, TSMLoc hdr_hdr_loc, const char *name, int name_len) const
+{
+  for (const HeaderValue &hv : _header_values) {
+    if (hv.name == name && hv.bufp == hdr_bufp && hv.hdr_loc == hdr_hdr_loc) {
+      return hv.value;
+    }
+  }
+
+  _header_values.push_back({hdr_bufp, hdr_hdr_loc, name, std::string()});
+  std::string &s   = _header_values.back().value;
+  TSMLoc field_loc = TSMimeHdrFieldFind(hdr_bufp, hdr_hdr_loc, name, name_len);
+
+  TSDebug(PLUGIN_NAME, "Getting Header: %s, field_loc: %p", name, field_loc);
+  while (field_loc) {
+    int len;
+    const char *value     = TSMimeHdrFieldValueStringGet(hdr_bufp, hdr_hdr_loc, field_loc, -1, &len);
+    TSMLoc next_field_loc = TSMimeHdrFieldNextDup(hdr_bufp, hdr_hdr_loc, field_loc);
+
+    s.append(value, len);
+    // multiple headers with the same name must be semantically the same as one value which is comma separated
+    if (next_field_loc) {
+      s += ',';
+    }
+    TSHandleMLocRelease(hdr_bufp, hdr_hdr_loc, field_loc);
+    field_loc = next_field_loc;
+  }
+
+  return s;
+}
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "ts/ts.h"
 #include "ts/remap.h"
@@ -71,6 +72,16 @@ public:
     return _ready;
   }
 
+  // The value of header @a name, a header_name_token(), in @a bufp / @a hdr_loc: its fields joined by
+  // ',', empty if there are none. The values are remembered until the next operator runs, for the
+  // conditions of all the rules of the hook to share a header lookup.
+  const std::string &header_value(TSMBuffer bufp, TSMLoc hdr_loc, const char *name, int name_len) const;
+  void
+  forget_header_values() const
+  {
+    _header_values.clear();
+  }
+
   TSHttpTxn txnp;
   TSCont contp             = nullptr;
   TSRemapRequestInfo *_rri = nullptr;
@@ -84,5 +95,13 @@ public:
 private:
   void destroy();
 
+  struct HeaderValue {
+    TSMBuffer bufp;
+    TSMLoc hdr_loc;
+    const char *name;
+    std::string value;
+  };
+
   bool _ready = false;
+  mutable std::vector<HeaderValue> _header_values;
 };
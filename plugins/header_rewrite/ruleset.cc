@@ -59,6 +59,7 @@ RuleSet::add_condition(Parser &p, const char *filename, int lineno)
     } else {
       _cond->append(c);
     }
+    compile_condition(c);
 
     // Update some ruleset state based on this new condition
     _last |= c->last();
@@ -70,6 +71,29 @@ RuleSet::add_condition(Parser &p, const char *filename, int lineno)
   return false;
 }
 
+void
+RuleSet::compile_condition(Condition *c)
+{
+  CondStep step = {c, false, c->or_next()};
+
+  if (c->is_constant(step.value)) {
+    step.cond  = nullptr;
+    step.value = c->negated() ? !step.value : step.value;
+  }
+
+  // The last step is no longer the last one, which decides the outcome: it can go if it is a known
+  // TRUE AND'ed with this one, or a known FALSE OR'ed with it.
+  if (!_program.empty()) {
+    const CondStep &prev = _program.back();
+
+    if (nullptr == prev.cond && prev.value != prev.or_next) {
+      _program.pop_back();
+    }
+  }
+
+  _program.push_back(step);
+}
+
 bool
 RuleSet::add_operator(Parser &p, const char *filename, int lineno)
 {
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "matcher.h"
 #include "factory.h"
@@ -85,14 +86,29 @@ public:
     return _ids;
   }
 
+  // Run the conditions, in order, stopping as soon as the outcome is known: at a FALSE one AND'ed
+  // with the rest, or a TRUE one OR'ed with it.
   bool
   eval(const Resources &res) const
   {
-    if (nullptr == _cond) {
-      return true;
-    } else {
-      return _cond->do_eval(res);
+    const CondStep *end = _program.data() + _program.size();
+
+    for (const CondStep *step = _program.data(); step != end; ++step) {
+      bool rt = step->cond ? step->cond->test(res) : step->value;
+
+      if (step + 1 == end) {
+        return rt;
+      }
+      if (step->or_next) {
+        if (rt) {
+          return true;
+        }
+      } else if (!rt) {
+        return false;
+      }
     }
+
+    return true;
   }
 
   bool
@@ -111,6 +127,17 @@ public:
   RuleSet *next = nullptr; // Linked list
 
 private:
+  // One condition of the rule, flattened from the _cond list as it is added. The conditions with
+  // an outcome known when loading, as %{TRUE}, are not called, or dropped when they change nothing.
+  struct CondStep {
+    Condition *cond; // nullptr for a known outcome
+    bool value;      // the known outcome, NOT applied
+    bool or_next;
+  };
+
+  void compile_condition(Condition *c);
+
+  std::vector<CondStep> _program;
   Condition *_cond   = nullptr;                        // First pre-condition (linked list)
   Operator *_oper    = nullptr;                        // First operator (linked list)
   TSHttpHookID _hook = TS_HTTP_READ_RESPONSE_HDR_HOOK; // Which hook is this rule for
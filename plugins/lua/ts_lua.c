@@ -32,17 +32,22 @@
 #define TS_LUA_IND_STATE 0
 #define TS_LUA_IND_GC_BYTES 1
 #define TS_LUA_IND_THREADS 2
-#define TS_LUA_IND_SIZE 3
+#define TS_LUA_IND_GC_LIMIT 3
+#define TS_LUA_IND_SIZE 4
 
-static uint64_t ts_lua_http_next_id   = 0;
-static uint64_t ts_lua_g_http_next_id = 0;
+// each thread runs its transactions on the lua vm of its index, so that the threads do not
+// contend for the vms when there are as many of them
+static int ts_lua_next_thread_index     = 0;
+static __thread int ts_lua_thread_index = -1;
 
 static ts_lua_main_ctx *ts_lua_main_ctx_array   = NULL;
 static ts_lua_main_ctx *ts_lua_g_main_ctx_array = NULL;
 
 // records.config entry injected by plugin
-static char const *const ts_lua_mgmt_state_str   = "proxy.config.plugin.lua.max_states";
-static char const *const ts_lua_mgmt_state_regex = "^[1-9][0-9]*$";
+static char const *const ts_lua_mgmt_state_str      = "proxy.config.plugin.lua.max_states";
+static char const *const ts_lua_mgmt_state_regex    = "^[1-9][0-9]*$";
+static char const *const ts_lua_mgmt_gc_limit_str   = "proxy.config.plugin.lua.state_gc_limit_kb";
+static char const *const ts_lua_mgmt_gc_limit_regex = "^[0-9]+$";
 
 // this is set the first time global configuration is probed.
 static int ts_lua_max_state_count = 0;
@@ -56,12 +61,14 @@ static char const *const ts_lua_stat_strs[] = {
   "plugin.lua.remap.states",
   "plugin.lua.remap.gc_bytes",
   "plugin.lua.remap.threads",
+  "plugin.lua.remap.gc_limit_collections",
   NULL,
 };
 static char const *const ts_lua_g_stat_strs[] = {
   "plugin.lua.global.states",
   "plugin.lua.global.gc_bytes",
   "plugin.lua.global.threads",
+  "plugin.lua.global.gc_limit_collections",
   NULL,
 };
 
@@ -71,6 +78,8 @@ typedef struct {
   int gc_kb;   // last collected gc in kb
   int threads; // last collected number active threads
 
+  int gc_limit_collections; // last collected number of full collections for the gc limit
+
   int stat_inds[TS_LUA_IND_SIZE]; // stats indices
 
 } ts_lua_plugin_stats;
@@ -118,7 +127,19 @@ create_lua_vms()
     } else {
       TSError("[%s][%s] failed to register %s", TS_LUA_DEBUG_TAG, __FUNCTION__, ts_lua_mgmt_state_str);
     }
+    if (TS_SUCCESS == TSMgmtIntCreate(TS_RECORDTYPE_CONFIG, ts_lua_mgmt_gc_limit_str, 0, TS_RECORDUPDATE_RESTART_TS,
+                                      TS_RECORDCHECK_INT, ts_lua_mgmt_gc_limit_regex, TS_RECORDACCESS_READ_ONLY)) {
+      TSDebug(TS_LUA_DEBUG_TAG, "[%s] registered config string %s: with default [0]", __FUNCTION__, ts_lua_mgmt_gc_limit_str);
+    } else {
+      TSError("[%s][%s] failed to register %s", TS_LUA_DEBUG_TAG, __FUNCTION__, ts_lua_mgmt_gc_limit_str);
+    }
     ts_mgt_int_inserted = true;
+
+    TSMgmtInt mgmt_gc_limit = 0;
+    if (TS_SUCCESS == TSMgmtIntGet(ts_lua_mgmt_gc_limit_str, &mgmt_gc_limit) && mgmt_gc_limit > 0) {
+      ts_lua_state_gc_limit_kb = (int)mgmt_gc_limit;
+      TSDebug(TS_LUA_DEBUG_TAG, "[%s] found %s: [%d]", __FUNCTION__, ts_lua_mgmt_gc_limit_str, ts_lua_state_gc_limit_kb);
+    }
   }
 
   if (0 == ts_lua_max_state_count) {
@@ -167,8 +188,9 @@ create_lua_vms()
 static void
 collectStats(ts_lua_plugin_stats *const plugin_stats)
 {
-  TSMgmtInt gc_kb_total   = 0;
-  TSMgmtInt threads_total = 0;
+  TSMgmtInt gc_kb_total    = 0;
+  TSMgmtInt threads_total  = 0;
+  TSMgmtInt gc_limit_total = 0;
 
   ts_lua_main_ctx *const main_ctx_array = plugin_stats->main_ctx_array;
 
@@ -182,12 +204,14 @@ collectStats(ts_lua_plugin_stats *const plugin_stats)
       gc_kb_total += (TSMgmtInt)stats->gc_kb;
       threads_total += (TSMgmtInt)stats->threads;
       TSMutexUnlock(stats->mutexp);
+      gc_limit_total += (TSMgmtInt)__sync_fetch_and_add(&stats->gc_limit_collections, 0);
     }
   }
 
   // set the stats sample slot
-  plugin_stats->gc_kb   = gc_kb_total;
-  plugin_stats->threads = threads_total;
+  plugin_stats->gc_kb                = gc_kb_total;
+  plugin_stats->threads              = threads_total;
+  plugin_stats->gc_limit_collections = gc_limit_total;
 }
 
 static void
@@ -196,6 +220,18 @@ publishStats(ts_lua_plugin_stats *const plugin_stats)
   TSMgmtInt const gc_bytes = plugin_stats->gc_kb * 1024;
   TSStatIntSet(plugin_stats->stat_inds[TS_LUA_IND_GC_BYTES], gc_bytes);
   TSStatIntSet(plugin_stats->stat_inds[TS_LUA_IND_THREADS], plugin_stats->threads);
+  TSStatIntSet(plugin_stats->stat_inds[TS_LUA_IND_GC_LIMIT], plugin_stats->gc_limit_collections);
+}
+
+// the lua vm the current thread runs its transactions on
+static ts_lua_main_ctx *
+thread_main_ctx(ts_lua_main_ctx *const main_ctx_array, int const states)
+{
+  if (ts_lua_thread_index < 0) {
+    ts_lua_thread_index = __sync_fetch_and_add(&ts_lua_next_thread_index, 1);
+  }
+
+  return &main_ctx_array[ts_lua_thread_index % states];
 }
 
 // dump exhaustive per state summary stats
@@ -462,7 +498,6 @@ static TSRemapStatus
 ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
   int ret;
-  uint64_t req_id;
 
   TSCont contp;
   lua_State *L;
@@ -475,9 +510,8 @@ ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 
   int remap     = (rri == NULL ? 0 : 1);
   instance_conf = (ts_lua_instance_conf *)ih;
-  req_id        = __sync_fetch_and_add(&ts_lua_http_next_id, 1);
 
-  main_ctx = &ts_lua_main_ctx_array[req_id % instance_conf->states];
+  main_ctx = thread_main_ctx(ts_lua_main_ctx_array, instance_conf->states);
 
   TSMutexLock(main_ctx->mutexp);
 
@@ -528,6 +562,7 @@ ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
     ts_lua_destroy_http_ctx(http_ctx);
   }
 
+  ts_lua_check_gc_limit(main_ctx);
   TSMutexUnlock(main_ctx->mutexp);
 
   return ret;
@@ -566,7 +601,6 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
   TSMLoc url_loc;
 
   int ret;
-  uint64_t req_id;
   TSCont txn_contp;
 
   lua_State *l;
@@ -577,11 +611,9 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
 
   ts_lua_instance_conf *conf = (ts_lua_instance_conf *)TSContDataGet(contp);
 
-  req_id = __sync_fetch_and_add(&ts_lua_g_http_next_id, 1);
-
-  main_ctx = &ts_lua_g_main_ctx_array[req_id % conf->states];
+  main_ctx = thread_main_ctx(ts_lua_g_main_ctx_array, conf->states);
 
-  TSDebug(TS_LUA_DEBUG_TAG, "[%s] req_id: %" PRId64, __FUNCTION__, req_id);
+  TSDebug(TS_LUA_DEBUG_TAG, "[%s] thread: %d", __FUNCTION__, ts_lua_thread_index);
   TSMutexLock(main_ctx->mutexp);
 
   http_ctx           = ts_lua_create_http_ctx(main_ctx, conf);
@@ -713,6 +745,7 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
     ts_lua_destroy_http_ctx(http_ctx);
   }
 
+  ts_lua_check_gc_limit(main_ctx);
   TSMutexUnlock(main_ctx->mutexp);
 
   if (ret) {
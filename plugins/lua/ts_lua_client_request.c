@@ -26,6 +26,7 @@ static void ts_lua_inject_client_request_server_addr_api(lua_State *L);
 static int ts_lua_client_request_header_get(lua_State *L);
 static int ts_lua_client_request_header_set(lua_State *L);
 static int ts_lua_client_request_get_headers(lua_State *L);
+static int ts_lua_client_request_set_headers(lua_State *L);
 static int ts_lua_client_request_get_url(lua_State *L);
 static int ts_lua_client_request_get_pristine_url(lua_State *L);
 static int ts_lua_client_request_get_url_host(lua_State *L);
@@ -267,6 +268,19 @@ ts_lua_inject_client_request_headers_api(lua_State *L)
 {
   lua_pushcfunction(L, ts_lua_client_request_get_headers);
   lua_setfield(L, -2, "get_headers");
+
+  lua_pushcfunction(L, ts_lua_client_request_set_headers);
+  lua_setfield(L, -2, "set_headers");
+}
+
+static int
+ts_lua_client_request_set_headers(lua_State *L)
+{
+  ts_lua_http_ctx *http_ctx;
+
+  GET_HTTP_CONTEXT(http_ctx, L);
+
+  return ts_lua_set_headers(L, http_ctx->client_request_bufp, http_ctx->client_request_hdrp);
 }
 
 static int
@@ -35,6 +35,8 @@ typedef struct {
   int gc_kb_max;   // maximum recorded gc kbytes
   int threads;     // associated coroutines
   int threads_max; // max coroutines
+
+  int gc_limit_collections; // full collections for being over ts_lua_state_gc_limit_kb, atomic
 } ts_lua_ctx_stats;
 
 /* main context*/
@@ -56,6 +56,7 @@ static void ts_lua_inject_server_request_method_api(lua_State *L);
 static int ts_lua_server_request_header_get(lua_State *L);
 static int ts_lua_server_request_header_set(lua_State *L);
 static int ts_lua_server_request_get_headers(lua_State *L);
+static int ts_lua_server_request_set_headers(lua_State *L);
 static int ts_lua_server_request_get_header_size(lua_State *L);
 static int ts_lua_server_request_get_body_size(lua_State *L);
 static int ts_lua_server_request_get_uri(lua_State *L);
@@ -294,6 +295,21 @@ ts_lua_inject_server_request_headers_api(lua_State *L)
 {
   lua_pushcfunction(L, ts_lua_server_request_get_headers);
   lua_setfield(L, -2, "get_headers");
+
+  lua_pushcfunction(L, ts_lua_server_request_set_headers);
+  lua_setfield(L, -2, "set_headers");
+}
+
+static int
+ts_lua_server_request_set_headers(lua_State *L)
+{
+  ts_lua_http_ctx *http_ctx;
+
+  GET_HTTP_CONTEXT(http_ctx, L);
+
+  TS_LUA_CHECK_SERVER_REQUEST_HDR(http_ctx);
+
+  return ts_lua_set_headers(L, http_ctx->server_request_bufp, http_ctx->server_request_hdrp);
 }
 
 static int
@@ -36,6 +36,7 @@ static int ts_lua_server_response_header_get(lua_State *L);
 static int ts_lua_server_response_header_set(lua_State *L);
 
 static int ts_lua_server_response_get_headers(lua_State *L);
+static int ts_lua_server_response_set_headers(lua_State *L);
 
 static int ts_lua_server_response_get_status(lua_State *L);
 static int ts_lua_server_response_set_status(lua_State *L);
@@ -80,6 +81,21 @@ ts_lua_inject_server_response_headers_api(lua_State *L)
 {
   lua_pushcfunction(L, ts_lua_server_response_get_headers);
   lua_setfield(L, -2, "get_headers");
+
+  lua_pushcfunction(L, ts_lua_server_response_set_headers);
+  lua_setfield(L, -2, "set_headers");
+}
+
+static int
+ts_lua_server_response_set_headers(lua_State *L)
+{
+  ts_lua_http_ctx *http_ctx;
+
+  GET_HTTP_CONTEXT(http_ctx, L);
+
+  TS_LUA_CHECK_SERVER_RESPONSE_HDR(http_ctx);
+
+  return ts_lua_set_headers(L, http_ctx->server_response_bufp, http_ctx->server_response_hdrp);
 }
 
 static int
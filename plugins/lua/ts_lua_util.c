@@ -36,6 +36,8 @@
 #include "ts_lua_fetch.h"
 #include "ts_lua_http_intercept.h"
 
+int ts_lua_state_gc_limit_kb = 0;
+
 static lua_State *ts_lua_new_state();
 static void ts_lua_init_registry(lua_State *L);
 static void ts_lua_init_globals(lua_State *L);
@@ -214,12 +216,58 @@ ts_lua_script_register(lua_State *L, char *script, ts_lua_instance_conf *conf)
   }
 }
 
+/* the compiled chunk of a script: the script is compiled by the first vm, the others load the chunk */
+typedef struct {
+  char *data;
+  size_t size;
+  size_t capacity;
+} ts_lua_chunk;
+
+static int
+ts_lua_chunk_write(lua_State *L ATS_UNUSED, const void *p, size_t sz, void *ud)
+{
+  ts_lua_chunk *chunk = (ts_lua_chunk *)ud;
+
+  if (chunk->size + sz > chunk->capacity) {
+    chunk->capacity = (chunk->size + sz) * 2;
+    chunk->data     = TSrealloc(chunk->data, chunk->capacity);
+  }
+
+  memcpy(chunk->data + chunk->size, p, sz);
+  chunk->size += sz;
+  return 0;
+}
+
+/* push the main function of the script of conf, compiled once in chunk for all the vms */
+static int
+ts_lua_load_script(lua_State *L, ts_lua_instance_conf *conf, ts_lua_chunk *chunk)
+{
+  int ret;
+
+  if (chunk->size) {
+    return luaL_loadbuffer(L, chunk->data, chunk->size, conf->script);
+  }
+
+  if (conf->content) {
+    ret = luaL_loadstring(L, conf->content);
+  } else {
+    ret = luaL_loadfile(L, conf->script);
+  }
+
+  if (ret == 0 && lua_dump(L, ts_lua_chunk_write, chunk) != 0) {
+    chunk->size = 0; /* the next vms compile it themselves */
+  }
+
+  return ret;
+}
+
 int
 ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int argc, char *argv[], char *errbuf, int errbuf_size)
 {
   int i, ret;
   int t;
   lua_State *L;
+  ts_lua_chunk chunk = {NULL, 0, 0};
 
   for (i = 0; i < n; i++) {
     conf->_first = (i == 0) ? 1 : 0;
@@ -240,19 +288,16 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
 
     ts_lua_set_instance_conf(L, conf);
 
-    if (conf->content) {
-      if (luaL_loadstring(L, conf->content)) {
-        snprintf(errbuf, errbuf_size, "[%s] luaL_loadstring failed: %s", __FUNCTION__, lua_tostring(L, -1));
-        lua_pop(L, 1);
-        TSMutexUnlock(arr[i].mutexp);
-        return -1;
-      }
-
-    } else if (strlen(conf->script)) {
-      if (luaL_loadfile(L, conf->script)) {
-        snprintf(errbuf, errbuf_size, "[%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
+    if (conf->content || strlen(conf->script)) {
+      if (ts_lua_load_script(L, conf, &chunk)) {
+        if (conf->content) {
+          snprintf(errbuf, errbuf_size, "[%s] luaL_loadstring failed: %s", __FUNCTION__, lua_tostring(L, -1));
+        } else {
+          snprintf(errbuf, errbuf_size, "[%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
+        }
         lua_pop(L, 1);
         TSMutexUnlock(arr[i].mutexp);
+        TSfree(chunk.data);
         return -1;
       }
     }
@@ -261,6 +306,7 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
       snprintf(errbuf, errbuf_size, "[%s] lua_pcall %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
       lua_pop(L, 1);
       TSMutexUnlock(arr[i].mutexp);
+      TSfree(chunk.data);
       return -1;
     }
 
@@ -283,6 +329,7 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
         snprintf(errbuf, errbuf_size, "[%s] lua_pcall %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
         lua_pop(L, 1);
         TSMutexUnlock(arr[i].mutexp);
+        TSfree(chunk.data);
         return -1;
       }
 
@@ -291,6 +338,7 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
 
       if (ret) {
         TSMutexUnlock(arr[i].mutexp);
+        TSfree(chunk.data);
         return -1; /* script parse error */
       }
 
@@ -308,6 +356,7 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
     TSMutexUnlock(arr[i].mutexp);
   }
 
+  TSfree(chunk.data);
   return 0;
 }
 
@@ -356,6 +405,7 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
 {
   int i;
   lua_State *L;
+  ts_lua_chunk chunk = {NULL, 0, 0};
 
   for (i = 0; i < n; i++) {
     TSMutexLock(arr[i].mutexp);
@@ -390,7 +440,7 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
     ts_lua_set_instance_conf(L, conf);
 
     if (strlen(conf->script)) {
-      if (luaL_loadfile(L, conf->script)) {
+      if (ts_lua_load_script(L, conf, &chunk)) {
         TSError("[ts_lua][%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
       } else {
         if (lua_pcall(L, 0, 0, 0)) {
@@ -409,6 +459,7 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
     TSMutexUnlock(arr[i].mutexp);
   }
 
+  TSfree(chunk.data);
   return 0;
 }
 
@@ -1032,7 +1083,7 @@ ts_lua_http_cont_handler(TSCont contp, TSEvent ev, void *edata)
   }
 
   // current memory in use by this state
-  int const gc_kb = lua_getgccount(L);
+  int const gc_kb = ts_lua_check_gc_limit(main_ctx);
 
   TSMutexUnlock(main_ctx->mutexp);
 
@@ -1060,3 +1111,80 @@ ts_lua_http_cont_handler(TSCont contp, TSEvent ev, void *edata)
 
   return 0;
 }
+
+int
+ts_lua_check_gc_limit(ts_lua_main_ctx *main_ctx)
+{
+  lua_State *L = main_ctx->lua;
+  int gc_kb    = lua_getgccount(L);
+
+  if (ts_lua_state_gc_limit_kb > 0 && gc_kb > ts_lua_state_gc_limit_kb) {
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    gc_kb = lua_getgccount(L);
+    __sync_fetch_and_add(&main_ctx->stats->gc_limit_collections, 1);
+    TSDebug(TS_LUA_DEBUG_TAG, "[%s] lua vm over %d kb, collected to %d kb", __FUNCTION__, ts_lua_state_gc_limit_kb, gc_kb);
+  }
+
+  return gc_kb;
+}
+
+int
+ts_lua_set_headers(lua_State *L, TSMBuffer bufp, TSMLoc hdrp)
+{
+  const char *key;
+  const char *val;
+  size_t key_len;
+  size_t val_len;
+  int first;
+
+  TSMLoc field_loc, tmp;
+
+  luaL_checktype(L, 1, LUA_TTABLE);
+
+  lua_pushnil(L);
+  while (lua_next(L, 1)) {
+    if (lua_type(L, -2) != LUA_TSTRING) {
+      return luaL_error(L, "header names must be strings");
+    }
+    key = lua_tolstring(L, -2, &key_len);
+
+    val = NULL;
+    if (!lua_isboolean(L, -1) || lua_toboolean(L, -1)) {
+      val = luaL_checklstring(L, -1, &val_len);
+    }
+
+    field_loc = TSMimeHdrFieldFind(bufp, hdrp, key, key_len);
+
+    if (val == NULL) {
+      while (field_loc != TS_NULL_MLOC) {
+        tmp = TSMimeHdrFieldNextDup(bufp, hdrp, field_loc);
+        TSMimeHdrFieldDestroy(bufp, hdrp, field_loc);
+        TSHandleMLocRelease(bufp, hdrp, field_loc);
+        field_loc = tmp;
+      }
+    } else if (field_loc != TS_NULL_MLOC) {
+      first = 1;
+      while (field_loc != TS_NULL_MLOC) {
+        tmp = TSMimeHdrFieldNextDup(bufp, hdrp, field_loc);
+        if (first) {
+          first = 0;
+          TSMimeHdrFieldValueStringSet(bufp, hdrp, field_loc, -1, val, val_len);
+        } else {
+          TSMimeHdrFieldDestroy(bufp, hdrp, field_loc);
+        }
+        TSHandleMLocRelease(bufp, hdrp, field_loc);
+        field_loc = tmp;
+      }
+    } else if (TSMimeHdrFieldCreateNamed(bufp, hdrp, key, key_len, &field_loc) == TS_SUCCESS) {
+      TSMimeHdrFieldValueStringSet(bufp, hdrp, field_loc, -1, val, val_len);
+      TSMimeHdrFieldAppend(bufp, hdrp, field_loc);
+      TSHandleMLocRelease(bufp, hdrp, field_loc);
+    } else {
+      TSError("[ts_lua][%s] TSMimeHdrFieldCreateNamed error", __FUNCTION__);
+    }
+
+    lua_pop(L, 1);
+  }
+
+  return 0;
+}
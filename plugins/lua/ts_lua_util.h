@@ -20,6 +20,9 @@
 
 #include "ts_lua_common.h"
 
+/* the memory a lua vm may use in kb, before it is fully collected, 0 for no limit */
+extern int ts_lua_state_gc_limit_kb;
+
 int ts_lua_create_vm(ts_lua_main_ctx *arr, int n);
 void ts_lua_destroy_vm(ts_lua_main_ctx *arr, int n);
 
@@ -66,3 +69,9 @@ ts_lua_http_intercept_ctx *ts_lua_get_http_intercept_ctx(lua_State *L);
 void ts_lua_destroy_http_intercept_ctx(ts_lua_http_intercept_ctx *ictx);
 
 int ts_lua_http_cont_handler(TSCont contp, TSEvent event, void *edata);
+
+/* the memory in use by the vm in kb, after a full collection if it is over the limit: call it with the vm locked */
+int ts_lua_check_gc_limit(ts_lua_main_ctx *main_ctx);
+
+/* set the headers of the table at index 1 of L, a false value removes the header */
+int ts_lua_set_headers(lua_State *L, TSMBuffer bufp, TSMLoc hdrp);
@@ -66,6 +66,7 @@ PrefetchConfig::init(int argc, char *argv[])
                                           {const_cast<char *>("metrics-prefix"), optional_argument, nullptr, 'm'},
                                           {const_cast<char *>("exact-match"), optional_argument, nullptr, 'y'},
                                           {const_cast<char *>("log-name"), optional_argument, nullptr, 'l'},
+                                          {const_cast<char *>("cache-probe"), optional_argument, nullptr, 'b'},
                                           {nullptr, 0, nullptr, 0}};
 
   bool status = true;
@@ -141,6 +142,10 @@ PrefetchConfig::init(int argc, char *argv[])
     case 'l': /* --log-name */
       setLogName(optarg);
       break;
+
+    case 'b': /* --cache-probe */
+      _cacheProbe = ::isTrue(optarg);
+      break;
     }
   }
 
@@ -159,6 +164,7 @@ PrefetchConfig::finalize()
 {
   PrefetchDebug("front-end: %s", (_front ? "true" : "false"));
   PrefetchDebug("exact match: %s", (_exactMatch ? "true" : "false"));
+  PrefetchDebug("cache probe: %s", (_cacheProbe ? "true" : "false"));
   PrefetchDebug("API header name: %s", _apiHeader.c_str());
   PrefetchDebug("next object header name: %s", _nextHeader.c_str());
   PrefetchDebug("fetch policy parameters: %s", _fetchPolicy.c_str());
@@ -111,6 +111,12 @@ public:
     return _exactMatch;
   }
 
+  bool
+  isCacheProbe() const
+  {
+    return _cacheProbe;
+  }
+
   void
   setFetchCount(const char *optarg)
   {
@@ -195,5 +201,6 @@ private:
   unsigned _fetchMax   = 0;
   bool _front          = false;
   bool _exactMatch     = false;
+  bool _cacheProbe     = true;
   MultiPattern _nextPaths;
 };
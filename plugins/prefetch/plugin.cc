@@ -283,6 +283,49 @@ appendCacheKey(const TSHttpTxn txnp, const TSMBuffer reqBuffer, String &key)
   return ret;
 }
 
+/**
+ * @brief Probe the cache directory for an object, without opening the cache.
+ *
+ * The cache lookup URL of the transaction is probed, or the one of the object at @a toPath if the lookup URL path is
+ * @a fromPath. It is cheaper than a lookup, no lock is taken, but says only if the object may be in cache: not if it is
+ * fresh, and a tag collision may make it wrong.
+ *
+ * @param txnp HTTP transaction structure
+ * @param reqBuffer request TSMBuffer
+ * @param fromPath path the lookup URL path should have to be replaced, empty to probe the lookup URL as it is
+ * @param toPath path of the object to probe instead
+ * @param maybeCached where to store the result of the probe
+ * @return true if probed, false if the object could not be probed (cache not ready, different lookup URL path).
+ */
+static bool
+probeCache(TSHttpTxn txnp, TSMBuffer reqBuffer, const String &fromPath, const String &toPath, bool &maybeCached)
+{
+  bool probed   = false;
+  TSMLoc urlLoc = TS_NULL_MLOC;
+  if (TS_SUCCESS == TSUrlCreate(reqBuffer, &urlLoc)) {
+    if (TS_SUCCESS == TSHttpTxnCacheLookupUrlGet(txnp, reqBuffer, urlLoc)) {
+      bool ready = fromPath.empty();
+      if (!ready) {
+        /* The lookup URL tells the object at the path of the next only if it is the one of the request, as the default
+         * cache key, a cache key made of something else can't be guessed */
+        int pathLen      = 0;
+        const char *path = TSUrlPathGet(reqBuffer, urlLoc, &pathLen);
+        if (nullptr != path && 0 == fromPath.compare(0, String::npos, path, pathLen)) {
+          ready = (TS_SUCCESS == TSUrlPathSet(reqBuffer, urlLoc, toPath.c_str(), toPath.length()));
+        }
+      }
+      int found = 0;
+      if (ready && TS_SUCCESS == TSHttpTxnCacheLookupUrlProbe(txnp, reqBuffer, urlLoc, &found)) {
+        maybeCached = (0 != found);
+        probed      = true;
+        PrefetchDebug("cache probe: %s", maybeCached ? "maybe cached" : "not cached");
+      }
+    }
+    TSHandleMLocRelease(reqBuffer, TS_NULL_MLOC, urlLoc);
+  }
+  return probed;
+}
+
 /**
  * @brief Find out if the object was found fresh in cache.
  *
@@ -482,6 +525,16 @@ contHandleFetch(const TSCont contp, TSEvent event, void *edata)
           PrefetchDebug("request is %s fetchable", data->_fetchable ? " " : " not ");
         }
       }
+    } else if (data->firstPass() && config.isCacheProbe()) {
+      /* back-end instance: an object surely not in cache is fetched right away, without opening the cache to find out */
+      bool cached = true;
+      if (probeCache(txnp, reqBuffer, String(), String(), cached) && !cached) {
+        if (BgFetch::schedule(state, config, /* askPermission */ true, reqBuffer, reqHdrLoc, txnp, nullptr, 0, data->_cachekey)) {
+          retEvent = shortcutResponse(data, TS_HTTP_STATUS_OK, "fetch scheduled\n", TS_EVENT_HTTP_ERROR);
+        } else {
+          retEvent = shortcutResponse(data, TS_HTTP_STATUS_ALREADY_REPORTED, "fetch not scheduled\n", TS_EVENT_HTTP_ERROR);
+        }
+      }
     }
   } break;
 
@@ -529,6 +582,9 @@ contHandleFetch(const TSCont contp, TSEvent event, void *edata)
         /* Trigger all necessary background fetches based on the next path pattern */
 
         String currentPath = getPristineUrlPath(txnp);
+        const String pristinePath(currentPath);
+        /* The objects fetched by another host can't be probed from here */
+        bool probe = config.isCacheProbe() && config.getReplaceHost().empty();
         if (!currentPath.empty()) {
           unsigned total = config.getFetchCount();
           for (unsigned i = 0; i < total; ++i) {
@@ -540,8 +596,16 @@ contHandleFetch(const TSCont contp, TSEvent event, void *edata)
               expand(expandedPath);
               PrefetchDebug("expanded: %s", expandedPath.c_str());
 
-              BgFetch::schedule(state, config, /* askPermission */ false, reqBuffer, reqHdrLoc, txnp, expandedPath.c_str(),
-                                expandedPath.length(), data->_cachekey);
+              bool cached = false;
+              if (probe && probeCache(txnp, reqBuffer, pristinePath, expandedPath, cached) && cached) {
+                /* Don't send a request through the cache just to find the object there */
+                PrefetchDebug("object already in cache");
+                state->incrementMetric(FETCH_ALREADY_CACHED);
+                state->incrementMetric(FETCH_TOTAL);
+              } else {
+                BgFetch::schedule(state, config, /* askPermission */ false, reqBuffer, reqHdrLoc, txnp, expandedPath.c_str(),
+                                  expandedPath.length(), data->_cachekey);
+              }
             } else {
               /* We should be here only if the pattern replacement fails (match already checked) */
               PrefetchError("failed to process the pattern");
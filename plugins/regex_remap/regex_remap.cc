@@ -37,6 +37,8 @@
 #include <cctype>
 #include <memory>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 
 // Get some specific stuff from libts, yes, we can do that now that we build inside the core.
 #include "tscore/ink_platform.h"
@@ -56,6 +58,9 @@ static const char *PLUGIN_NAME = "regex_remap";
 static const int OVECCOUNT = 30; // We support $0 - $9 x2 ints, and this needs to be 1.5x that
 static const int MAX_SUBS  = 32; // No more than 32 substitution variables in the subst string
 
+// The most regular expressions combined into one, to stay well below the size limit of a compiled pattern
+static const size_t MAX_SET_RULES = 128;
+
 // Substitutions other than regex matches
 enum ExtraSubstitutions {
   SUB_HOST       = 11,
@@ -106,6 +111,8 @@ struct UrlComponents {
   int url_len = 0; // Full length, of all components
 };
 
+class RemapRegexSet;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Class encapsulating one regular expression (and the linked list).
 //
@@ -226,6 +233,23 @@ public:
   {
     return _lowercase_substitutions;
   }
+  inline bool
+  caseless() const
+  {
+    return _options & PCRE_CASELESS;
+  }
+
+  // The set of regular expressions starting with this one, if it was combined with the next ones
+  inline void
+  set_set(const RemapRegexSet *set)
+  {
+    _set = set;
+  }
+  inline const RemapRegexSet *
+  set() const
+  {
+    return _set;
+  }
 
   // Hold an overridable configurations
   struct Override {
@@ -258,6 +282,8 @@ private:
   RemapRegex *_next    = nullptr;
   TSHttpStatus _status = static_cast<TSHttpStatus>(0);
 
+  const RemapRegexSet *_set = nullptr;
+
   int _active_timeout      = -1;
   int _no_activity_timeout = -1;
   int _connect_timeout     = -1;
@@ -620,6 +646,129 @@ RemapRegex::substitute(char dest[], const char *src, const int ovector[], const
   return 0; // Shouldn't happen.
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Class combining consecutive regular expressions into one alternation, to find
+// the first of them that matches in one pass rather than one match per regex.
+// Each alternative is anchored at the start and marked with the index of its
+// regex, so that the first alternative matching anywhere in the string wins,
+// as the first regex would. The winner is then matched on its own, for the
+// substitution groups.
+//
+class RemapRegexSet
+{
+public:
+  ~RemapRegexSet()
+  {
+    if (_extra) {
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_free_study(_extra);
+#else
+      pcre_free(_extra);
+#endif
+    }
+    if (_rex) {
+      pcre_free(_rex);
+    }
+  }
+
+  // Can the regex be combined with others, without changing what it matches? This is
+  // conservative, back references, named groups, verbs and option settings which could
+  // reach past the group around the regex are left to be matched on their own.
+  static bool
+  combinable(const RemapRegex *re)
+  {
+    for (const char *p = re->regex(); *p; ++p) {
+      if ('\\' == *p) {
+        ++p;
+        if (isdigit(*p) || 'g' == *p || 'k' == *p || 'Q' == *p || '\0' == *p) {
+          return false;
+        }
+      } else if ('(' == *p && ('*' == p[1] || ('?' == p[1] && !strchr(":=!>#<", p[2])) ||
+                               ('?' == p[1] && '<' == p[2] && '=' != p[3] && '!' != p[3]))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool
+  compile(RemapRegex *const *rules, size_t count)
+  {
+    std::string pattern("^(?:");
+    const char *error;
+    int erroffset;
+
+    for (size_t i = 0; i < count; ++i) {
+      pattern += (i > 0 ? "|(*MARK:" : "(*MARK:") + std::to_string(i) + ")(?s:.*?)";
+      pattern += rules[i]->caseless() ? "(?i:" : "(?:";
+      pattern += rules[i]->regex();
+      pattern += ')';
+    }
+    pattern += ')';
+
+    _rex = pcre_compile(pattern.c_str(), 0, &error, &erroffset, nullptr);
+    if (nullptr == _rex) {
+      TSDebug(PLUGIN_NAME, "Can't combine %zu regular expressions from `%s': %s", count, rules[0]->regex(), error);
+      return false;
+    }
+
+    int study_opts = PCRE_STUDY_EXTRA_NEEDED;
+#if defined(PCRE_CONFIG_JIT) && !defined(darwin) // issue with macOS Catalina and pcre 8.43
+    study_opts |= PCRE_STUDY_JIT_COMPILE;
+#endif
+    error  = nullptr;
+    _extra = pcre_study(_rex, study_opts, &error);
+    if (nullptr == _extra || error != nullptr) {
+      return false;
+    }
+    _extra->match_limit_recursion = 1750;
+    _extra->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+
+    _rules.assign(rules, rules + count);
+    return true;
+  }
+
+  // The first regex of the set that matches, nullptr if none does or the match failed,
+  // and the result of the match for that.
+  RemapRegex *
+  first_match(const char *str, int len, int &result) const
+  {
+    // The mark is returned through the extra data, which the threads share
+    pcre_extra extra    = *_extra;
+    unsigned char *mark = nullptr;
+    int ovector[3];
+
+    extra.flags |= PCRE_EXTRA_MARK;
+    extra.mark = &mark;
+    result     = pcre_exec(_rex, &extra, str, len, 0, 0, ovector, 3);
+    if (result >= 0) {
+      size_t ix = mark ? strtoul(reinterpret_cast<const char *>(mark), nullptr, 10) : _rules.size();
+
+      if (ix < _rules.size()) {
+        return _rules[ix];
+      }
+      result = PCRE_ERROR_INTERNAL;
+    }
+    return nullptr;
+  }
+
+  const RemapRegex *
+  last() const
+  {
+    return _rules.back();
+  }
+  size_t
+  size() const
+  {
+    return _rules.size();
+  }
+
+private:
+  std::vector<RemapRegex *> _rules;
+  pcre *_rex         = nullptr;
+  pcre_extra *_extra = nullptr;
+};
+
 // Hold one remap instance
 struct RemapInstance {
   RemapInstance() : filename("unknown") {}
@@ -632,12 +781,58 @@ struct RemapInstance {
   bool query_string  = true;
   bool matrix_params = false;
   bool host          = false;
+  bool single_pass   = false;
   int hits           = 0;
   int misses         = 0;
   int failures       = 0;
   std::string filename;
+  std::vector<std::unique_ptr<RemapRegexSet>> sets;
 };
 
+// Combine the regular expressions rules[begin, end) into sets, halving them until they compile.
+static void
+add_regex_sets(RemapInstance *ri, const std::vector<RemapRegex *> &rules, size_t begin, size_t end)
+{
+  while (end - begin >= 2) {
+    size_t count = std::min(end - begin, MAX_SET_RULES);
+    std::unique_ptr<RemapRegexSet> set(new RemapRegexSet);
+
+    if (set->compile(&rules[begin], count)) {
+      rules[begin]->set_set(set.get());
+      ri->sets.push_back(std::move(set));
+    } else if (count >= 4) {
+      add_regex_sets(ri, rules, begin, begin + count / 2);
+      add_regex_sets(ri, rules, begin + count / 2, begin + count);
+    }
+    begin += count;
+  }
+}
+
+// Combine the runs of regular expressions which can be combined.
+static void
+build_regex_sets(RemapInstance *ri)
+{
+  std::vector<RemapRegex *> run;
+  size_t combined = 0;
+
+  for (RemapRegex *re = ri->first;; re = re->next()) {
+    if (re && RemapRegexSet::combinable(re)) {
+      run.push_back(re);
+      continue;
+    }
+    add_regex_sets(ri, run, 0, run.size());
+    run.clear();
+    if (!re) {
+      break;
+    }
+  }
+
+  for (const auto &set : ri->sets) {
+    combined += set->size();
+  }
+  TSDebug(PLUGIN_NAME, "Combined %zu regular expressions into %zu sets", combined, ri->sets.size());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Helpers for memory management (to make sure pcre uses the TS APIs).
 //
@@ -731,6 +926,10 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
       ri->pristine_url = true;
     } else if (strcmp(argv[i], "no-pristine") == 0) {
       ri->pristine_url = false;
+    } else if (strcmp(argv[i], "single-pass") == 0) {
+      ri->single_pass = true;
+    } else if (strcmp(argv[i], "no-single-pass") == 0) {
+      ri->single_pass = false;
     } else {
       TSError("[%s] invalid option '%s'", PLUGIN_NAME, argv[i]);
     }
@@ -849,6 +1048,10 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
     return TS_ERROR;
   }
 
+  if (ri->single_pass) {
+    build_regex_sets(ri);
+  }
+
   return TS_SUCCESS;
 }
 
@@ -1004,6 +1207,28 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
 
   // Apply the regular expressions, in order. First one wins.
   while (re) {
+    // Go straight to the first regex of a set that matches, or past the set if none does
+    if (re->set()) {
+      int set_result;
+      RemapRegex *first = re->set()->first_match(match_buf, match_len, set_result);
+
+      if (first) {
+        re = first;
+      } else if (PCRE_ERROR_NOMATCH == set_result) {
+        re = re->set()->last()->next();
+        if (re == nullptr) {
+          retval = TSREMAP_NO_REMAP; // No match
+          if (ri->profile) {
+            ink_atomic_increment(&(ri->misses), 1);
+          }
+        }
+        continue;
+      } else {
+        // e.g. the match limit, match the regular expressions of the set one at a time
+        TSDebug(PLUGIN_NAME, "Combined match from rule %d failed with %d", re->order(), set_result);
+      }
+    }
+
     // Since we check substitutions on parse time, we don't need to reset ovector
     auto match_result = re->match(match_buf, match_len, ovector);
     if (match_result >= 0) {
@@ -25,7 +25,6 @@
 #include <cstring>        /* strlen() */
 #include <string>         /* stoi() */
 #include <ctime>          /* strftime(), time(), gmtime_r() */
-#include <iomanip>        /* std::setw */
 #include <sstream>        /* std::stringstream */
 #include <openssl/sha.h>  /* SHA(), sha256_Update(), SHA256_Final, etc. */
 #include <openssl/hmac.h> /* HMAC() */
@@ -49,20 +48,21 @@
 String
 base16Encode(const char *in, size_t inLen)
 {
+  static const char hexDigits[] = "0123456789abcdef";
+
   if (nullptr == in || inLen == 0) {
     return {};
   }
 
-  std::stringstream result;
-
-  const char *src    = in;
-  const char *srcEnd = in + inLen;
+  String result(2 * inLen, '\0');
+  char *dst = &result[0];
 
-  while (src < srcEnd) {
-    result << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>((*src) & 0xFF);
-    src++;
+  for (const char *src = in; src < in + inLen; src++) {
+    unsigned char c = static_cast<unsigned char>(*src);
+    *dst++          = hexDigits[c >> 4];
+    *dst++          = hexDigits[c & 0x0F];
   }
-  return result.str();
+  return result;
 }
 
 /**
@@ -80,26 +80,32 @@ base16Encode(const char *in, size_t inLen)
 String
 uriEncode(const String &in, bool isObjectName)
 {
-  std::stringstream result;
+  static const char hexDigits[] = "0123456789ABCDEF";
+
+  String result;
+  result.reserve(in.length() * 3);
 
   for (char i : in) {
     if (isalnum(i) || i == '-' || i == '_' || i == '.' || i == '~') {
       /* URI encode every byte except the unreserved characters:
        * 'A'-'Z', 'a'-'z', '0'-'9', '-', '.', '_', and '~'. */
-      result << i;
+      result.push_back(i);
     } else if (i == ' ') {
       /* The space character is a reserved character and must be encoded as "%20" (and not as "+"). */
-      result << "%20";
+      result.append("%20");
     } else if (isObjectName && i == '/') {
       /* Encode the forward slash character, '/', everywhere except in the object key name. */
-      result << "/";
+      result.push_back('/');
     } else {
       /* Letters in the hexadecimal value must be upper-case, for example "%1A". */
-      result << "%" << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(i);
+      unsigned char c = static_cast<unsigned char>(i);
+      result.push_back('%');
+      result.push_back(hexDigits[c >> 4]);
+      result.push_back(hexDigits[c & 0x0F]);
     }
   }
 
-  return result.str();
+  return result;
 }
 
 /**
@@ -254,15 +260,14 @@ String
 getPayloadSha256(bool signPayload)
 {
   static const String UNSIGNED_PAYLOAD("UNSIGNED-PAYLOAD");
-
-  if (!signPayload) {
-    return UNSIGNED_PAYLOAD;
-  }
-
-  unsigned char payloadHash[SHA256_DIGEST_LENGTH];
-  SHA256(reinterpret_cast<const unsigned char *>(""), 0, payloadHash); /* empty content */
-
-  return base16Encode(reinterpret_cast<char *>(payloadHash), SHA256_DIGEST_LENGTH);
+  /* the hash of the empty content, the same for every request */
+  static const String EMPTY_PAYLOAD_SHA256 = []() {
+    unsigned char payloadHash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(""), 0, payloadHash);
+    return base16Encode(reinterpret_cast<char *>(payloadHash), SHA256_DIGEST_LENGTH);
+  }();
+
+  return signPayload ? EMPTY_PAYLOAD_SHA256 : UNSIGNED_PAYLOAD;
 }
 
 /**
@@ -311,36 +316,36 @@ getCanonicalRequestSha256Hash(TsInterface &api, bool signPayload, const StringSe
    * <CanonicalQueryString>\n */
   const char *query = api.getQuery(&length);
 
-  StringSet paramNames;
+  /* the map keeps the params sorted by name, the last value of a param wins */
   StringMap paramsMap;
-  std::istringstream istr(String(query, length));
-  String token;
-  StringSet container;
-
-  while (std::getline(istr, token, '&')) {
-    String::size_type pos(token.find_first_of('='));
-    String param(token.substr(0, pos == String::npos ? token.size() : pos));
-    String value(pos == String::npos ? "" : token.substr(pos + 1, token.size()));
-
-    String encodedParam = canonicalEncode(param, /* isObjectName */ false);
-    paramNames.insert(encodedParam);
-    paramsMap[encodedParam] = canonicalEncode(value, /* isObjectName */ false);
+  size_t queryLen = (nullptr == query || length < 0) ? 0 : length;
+
+  for (size_t start = 0; start < queryLen;) {
+    const char *end = static_cast<const char *>(memchr(query + start, '&', queryLen - start));
+    size_t tokenLen = (nullptr == end ? queryLen : end - query) - start;
+    const char *eq  = static_cast<const char *>(memchr(query + start, '=', tokenLen));
+
+    String param(query + start, nullptr == eq ? tokenLen : eq - (query + start));
+    String value = nullptr == eq ? String() : String(eq + 1, query + start + tokenLen - (eq + 1));
+
+    paramsMap[canonicalEncode(param, /* isObjectName */ false)] = canonicalEncode(value, /* isObjectName */ false);
+    start += tokenLen + 1;
   }
 
   String queryStr;
-  for (const auto &paramName : paramNames) {
+  queryStr.reserve(queryLen);
+  for (const auto &param : paramsMap) {
     if (!queryStr.empty()) {
       queryStr.append("&");
     }
-    queryStr.append(paramName);
-    queryStr.append("=").append(paramsMap[paramName]);
+    queryStr.append(param.first).append("=").append(param.second);
   }
   sha256Update(&canonicalRequestSha256Ctx, queryStr);
   sha256Update(&canonicalRequestSha256Ctx, "\n");
 
   /* Sorted Canonical Headers
    *  <CanonicalHeaders>\n */
-  StringSet signedHeadersSet;
+  /* the map keeps the header names sorted and unique */
   StringMap headersMap;
 
   for (HeaderIterator it = api.headerBegin(); it != api.headerEnd(); it++) {
@@ -384,27 +389,27 @@ getCanonicalRequestSha256Hash(TsInterface &api, bool signPayload, const StringSe
     size_t trimValueLen   = 0;
     const char *trimValue = trimWhiteSpaces(value, valueLen, trimValueLen);
 
-    signedHeadersSet.insert(lowercaseName);
-    if (headersMap.find(lowercaseName) == headersMap.end()) {
-      headersMap[lowercaseName] = String(trimValue, trimValueLen);
+    auto header = headersMap.find(lowercaseName);
+    if (header == headersMap.end()) {
+      headersMap.emplace(std::move(lowercaseName), String(trimValue, trimValueLen));
     } else {
-      headersMap[lowercaseName].append(",").append(String(trimValue, trimValueLen));
+      header->second.append(",").append(trimValue, trimValueLen);
     }
   }
 
-  for (const auto &it : signedHeadersSet) {
-    sha256Update(&canonicalRequestSha256Ctx, it);
+  for (const auto &it : headersMap) {
+    sha256Update(&canonicalRequestSha256Ctx, it.first);
     sha256Update(&canonicalRequestSha256Ctx, ":");
-    sha256Update(&canonicalRequestSha256Ctx, headersMap[it]);
+    sha256Update(&canonicalRequestSha256Ctx, it.second);
     sha256Update(&canonicalRequestSha256Ctx, "\n");
   }
   sha256Update(&canonicalRequestSha256Ctx, "\n");
 
-  for (const auto &it : signedHeadersSet) {
+  for (const auto &it : headersMap) {
     if (!signedHeaders.empty()) {
       signedHeaders.append(";");
     }
-    signedHeaders.append(it);
+    signedHeaders.append(it.first);
   }
 
   sha256Update(&canonicalRequestSha256Ctx, signedHeaders);
@@ -620,6 +625,76 @@ getStringToSign(const char *entryPoint, size_t EntryPointLen, const char *dateTi
   return stringToSign;
 }
 
+/**
+ * @brief Derives the signing key, or finds it in a cache of the keys the current thread derived last.
+ *
+ * The key depends only on the secret, the date, the region and the service, so it changes once a day for
+ * a given bucket, while deriving it takes four of the five HMACs of a signature. A few keys are kept per
+ * thread, for the threads signing requests to a few regions or with a few secrets, the oldest replaced.
+ *
+ * @param signingKey set to the key, valid until the next call on the same thread
+ * @param signingKeyLen set to the length of the key
+ * @return true if the key was found or derived
+ */
+static bool
+getSigningKey(const char *awsSecret, size_t awsSecretLen, const char *awsRegion, size_t awsRegionLen, const char *awsService,
+              size_t awsServiceLen, const char *dateTime, size_t dateTimeLen, const unsigned char *&signingKey,
+              unsigned int &signingKeyLen)
+{
+  struct SigningKey {
+    String secret;
+    String date;
+    String region;
+    String service;
+    unsigned int keyLen = 0; /* 0 while the slot is empty */
+    unsigned char key[EVP_MAX_MD_SIZE];
+  };
+  static thread_local SigningKey cache[4];
+  static thread_local unsigned next = 0;
+
+  for (auto &slot : cache) {
+    if (0 != slot.keyLen && 0 == slot.date.compare(0, String::npos, dateTime, dateTimeLen) &&
+        0 == slot.region.compare(0, String::npos, awsRegion, awsRegionLen) &&
+        0 == slot.service.compare(0, String::npos, awsService, awsServiceLen) &&
+        0 == slot.secret.compare(0, String::npos, awsSecret, awsSecretLen)) {
+      signingKey    = slot.key;
+      signingKeyLen = slot.keyLen;
+      return true;
+    }
+  }
+
+  unsigned int dateKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateKey[EVP_MAX_MD_SIZE];
+  unsigned int dateRegionKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateRegionKey[EVP_MAX_MD_SIZE];
+  unsigned int dateRegionServiceKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateRegionServiceKey[EVP_MAX_MD_SIZE];
+
+  String key("AWS4");
+  key.append(awsSecret, awsSecretLen);
+
+  SigningKey &slot = cache[next++ % (sizeof(cache) / sizeof(cache[0]))];
+  slot.keyLen      = EVP_MAX_MD_SIZE;
+  if (!(HMAC(EVP_sha256(), key.data(), key.length(), (unsigned char *)dateTime, dateTimeLen, dateKey, &dateKeyLen) &&
+        HMAC(EVP_sha256(), dateKey, dateKeyLen, (unsigned char *)awsRegion, awsRegionLen, dateRegionKey, &dateRegionKeyLen) &&
+        HMAC(EVP_sha256(), dateRegionKey, dateRegionKeyLen, (unsigned char *)awsService, awsServiceLen, dateRegionServiceKey,
+             &dateRegionServiceKeyLen) &&
+        HMAC(EVP_sha256(), dateRegionServiceKey, dateRegionServiceKeyLen, reinterpret_cast<const unsigned char *>("aws4_request"),
+             12, slot.key, &slot.keyLen))) {
+    slot.keyLen = 0;
+    return false;
+  }
+
+  slot.secret.assign(awsSecret, awsSecretLen);
+  slot.date.assign(dateTime, dateTimeLen);
+  slot.region.assign(awsRegion, awsRegionLen);
+  slot.service.assign(awsService, awsServiceLen);
+
+  signingKey    = slot.key;
+  signingKeyLen = slot.keyLen;
+  return true;
+}
+
 /**
  * @brief Calculates the final signature based on the following parameters and base16 encodes it.
  *
@@ -648,28 +723,16 @@ getSignature(const char *awsSecret, size_t awsSecretLen, const char *awsRegion,
              size_t awsServiceLen, const char *dateTime, size_t dateTimeLen, const char *stringToSign, size_t stringToSignLen,
              char *signature, size_t signatureLen)
 {
-  unsigned int dateKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateKey[EVP_MAX_MD_SIZE];
-  unsigned int dateRegionKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateRegionKey[EVP_MAX_MD_SIZE];
-  unsigned int dateRegionServiceKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateRegionServiceKey[EVP_MAX_MD_SIZE];
-  unsigned int signingKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char signingKey[EVP_MAX_MD_SIZE];
+  const unsigned char *signingKey = nullptr;
+  unsigned int signingKeyLen      = 0;
 
-  size_t keyLen = 4 + awsSecretLen;
-  char key[keyLen];
-  memcpy(key, "AWS4", 4);
-  memcpy(key + 4, awsSecret, awsSecretLen);
+  if (!getSigningKey(awsSecret, awsSecretLen, awsRegion, awsRegionLen, awsService, awsServiceLen, dateTime, dateTimeLen, signingKey,
+                     signingKeyLen)) {
+    return 0;
+  }
 
   unsigned int len = signatureLen;
-  if (HMAC(EVP_sha256(), key, keyLen, (unsigned char *)dateTime, dateTimeLen, dateKey, &dateKeyLen) &&
-      HMAC(EVP_sha256(), dateKey, dateKeyLen, (unsigned char *)awsRegion, awsRegionLen, dateRegionKey, &dateRegionKeyLen) &&
-      HMAC(EVP_sha256(), dateRegionKey, dateRegionKeyLen, (unsigned char *)awsService, awsServiceLen, dateRegionServiceKey,
-           &dateRegionServiceKeyLen) &&
-      HMAC(EVP_sha256(), dateRegionServiceKey, dateRegionServiceKeyLen, reinterpret_cast<const unsigned char *>("aws4_request"), 12,
-           signingKey, &signingKeyLen) &&
-      HMAC(EVP_sha256(), signingKey, signingKeyLen, (unsigned char *)stringToSign, stringToSignLen,
+  if (HMAC(EVP_sha256(), signingKey, signingKeyLen, (unsigned char *)stringToSign, stringToSignLen,
            reinterpret_cast<unsigned char *>(signature), &len)) {
     return len;
   }
@@ -436,6 +436,46 @@ TEST_CASE("AWSAuthSpecByExample: GET Object", "[AWS][auth][SpecByExample]")
   ValidateBench(api, /*signePayload */ true, &now, bench, defaultIncludeHeaders, defaultExcludeHeaders);
 }
 
+/**
+ * The signing keys are cached per thread, the signatures must not depend on what was signed before.
+ * Uses the string to sign and the signature of the example above.
+ */
+TEST_CASE("AWSAuthSpecByExample: GET Object, signing key cache", "[AWS][auth][SpecByExample]")
+{
+  const char *stringToSign = "AWS4-HMAC-SHA256\n"
+                             "20130524T000000Z\n"
+                             "20130524/us-east-1/s3/aws4_request\n"
+                             "7344ae5b7ee6c3e7e6b0fe0640412a37625d1fbfff95c48bbb2dc43964946972";
+  const char *benchSignature = "f0e8bdb87c964420e857bd35b5d6ed310bd44f0170aba48dd91039c6036bdb41";
+  const char *regions[]      = {"us-east-1", "us-west-1", "us-west-2", "eu-west-1", "ap-south-1", "sa-east-1"};
+
+  char signature[EVP_MAX_MD_SIZE];
+  String previous;
+  for (int round = 0; round < 2; round++) {
+    /* more keys than the cache has room for, the example's key is found or derived again */
+    for (const char *region : regions) {
+      size_t signatureLen = getSignature(awsSecretAccessKey, strlen(awsSecretAccessKey), region, strlen(region), awsService,
+                                         strlen(awsService), "20130524", 8, stringToSign, strlen(stringToSign), signature,
+                                         EVP_MAX_MD_SIZE);
+      String base16Signature = base16Encode(signature, signatureLen);
+      CAPTURE(region);
+      CHECK(base16Signature.length() == 64);
+      CHECK(base16Signature != previous);
+      previous = base16Signature;
+
+      signatureLen    = getSignature(awsSecretAccessKey, strlen(awsSecretAccessKey), "us-east-1", 9, awsService, strlen(awsService),
+                                     "20130524", 8, stringToSign, strlen(stringToSign), signature, EVP_MAX_MD_SIZE);
+      base16Signature = base16Encode(signature, signatureLen);
+      CHECK_FALSE(base16Signature.compare(benchSignature));
+    }
+  }
+
+  /* another day, another key */
+  size_t signatureLen = getSignature(awsSecretAccessKey, strlen(awsSecretAccessKey), "us-east-1", 9, awsService, strlen(awsService),
+                                     "20130525", 8, stringToSign, strlen(stringToSign), signature, EVP_MAX_MD_SIZE);
+  CHECK(base16Encode(signature, signatureLen).compare(benchSignature));
+}
+
 /**
  * Test from docs.aws.amazon.com/AmazonS3/latest/API/sig-v4-header-based-auth.html
  * Example: GET Bucket Lifecycle
@@ -30,6 +30,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <ts/ts.h>
+#include <ts/experimental.h>
 #include <string.h>
 #include <inttypes.h>
 #include <getopt.h>
@@ -87,6 +88,19 @@ const int BROTLI_LGW               = 16;
 static bool integer_counters = false;
 static bool wrap_counters    = false;
 
+#define MAX_LABEL_RULES 32
+
+/* A rule to take a component of the names of stats as a label of their Prometheus metric, from a pattern
+   such as proxy.process.cache.volume_*, which makes proxy.process.cache.volume_1.bytes_used the sample
+   proxy_process_cache_bytes_used{volume="1"} */
+typedef struct {
+  char *prefix; /* the name up to the labelled component, "proxy.process.cache." */
+  int prefix_len;
+  char *component; /* the start of the labelled component, "volume_" */
+  int component_len;
+  char *label;
+} label_rule_t;
+
 typedef struct {
   unsigned int recordTypes;
   char *stats_path;
@@ -95,6 +109,8 @@ typedef struct {
   int ipCount;
   char *allowIps6;
   int ip6Count;
+  label_rule_t labels[MAX_LABEL_RULES];
+  int labelCount;
 } config_t;
 typedef struct {
   char *config_path;
@@ -102,7 +118,7 @@ typedef struct {
   config_t *config;
 } config_holder_t;
 
-typedef enum { JSON_OUTPUT, CSV_OUTPUT } output_format;
+typedef enum { JSON_OUTPUT, CSV_OUTPUT, PROMETHEUS_OUTPUT } output_format;
 typedef enum { NONE, DEFLATE, GZIP, BR } encoding_format;
 
 int configReloadRequests = 0;
@@ -142,6 +158,7 @@ typedef struct stats_state_t {
   int body_written;
   output_format output;
   encoding_format encoding;
+  const config_t *config;
   z_stream zstrm;
 #if HAVE_BROTLI_ENCODE_H
   b_stream bstrm;
@@ -258,6 +275,10 @@ static const char RESP_HEADER_CSV_DEFLATE[] =
   "HTTP/1.0 200 Ok\r\nContent-Type: text/csv\r\nContent-Encoding: deflate\r\nCache-Control: no-cache\r\n\r\n";
 static const char RESP_HEADER_CSV_BR[] =
   "HTTP/1.0 200 Ok\r\nContent-Type: text/csv\r\nContent-Encoding: br\r\nCache-Control: no-cache\r\n\r\n";
+static const char RESP_HEADER_PROMETHEUS[] =
+  "HTTP/1.0 200 Ok\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nCache-Control: no-cache\r\n\r\n";
+static const char RESP_HEADER_PROMETHEUS_GZIP[] = "HTTP/1.0 200 Ok\r\nContent-Type: text/plain; version=0.0.4; "
+                                                  "charset=utf-8\r\nContent-Encoding: gzip\r\nCache-Control: no-cache\r\n\r\n";
 
 static int
 stats_add_resp_header(stats_state *my_state)
@@ -285,6 +306,13 @@ stats_add_resp_header(stats_state *my_state)
       return stats_add_data_to_resp_buffer(RESP_HEADER_CSV, my_state);
     }
     break;
+  case PROMETHEUS_OUTPUT:
+    if (my_state->encoding == GZIP) {
+      return stats_add_data_to_resp_buffer(RESP_HEADER_PROMETHEUS_GZIP, my_state);
+    } else {
+      return stats_add_data_to_resp_buffer(RESP_HEADER_PROMETHEUS, my_state);
+    }
+    break;
   default:
     TSError("stats_add_resp_header: Unknown output format");
     break;
@@ -497,6 +525,343 @@ csv_out_stats(stats_state *my_state)
   APPEND_STAT_CSV("version", "%s", version);
 }
 
+/* Prometheus text exposition format, version 0.0.4. Rendering every stat on each scrape costs a net
+   thread several milliseconds, and the stats only change as they sync, so a rendering is kept for the
+   sync interval and every scrape in it is served from it, with a gzip compressed copy made once. */
+typedef struct {
+  char *data;
+  size_t len;
+  size_t size;
+} prom_buffer_t;
+
+typedef struct {
+  char *family;       /* the metric name, of the TYPE line and the order */
+  const char *suffix; /* of the sample name, after the family */
+  char *labels;       /* without the braces, NULL if none */
+  const char *type;
+  char value[64];
+  int order;
+} prom_sample_t;
+
+typedef struct {
+  prom_sample_t *samples;
+  int count;
+  int size;
+  const config_t *config;
+} prom_render_t;
+
+typedef struct {
+  TSMutex mutex;
+  TSHRTime rendered; /* when the text was rendered, 0 if it was not */
+  int config_reloads; /* of the configuration it was rendered with */
+  prom_buffer_t text;
+  prom_buffer_t gzip; /* compressed from the text when first asked for */
+} prom_cache_t;
+
+static prom_cache_t prom_cache;
+static TSHRTime prom_refresh_interval = 5000 * TS_HRTIME_MSECOND;
+
+static const char *const PROM_QUANTILES[][2] = {{".p50", "0.5"}, {".p90", "0.9"}, {".p99", "0.99"}, {".p999", "0.999"}};
+
+static void
+prom_append(prom_buffer_t *buf, const char *s, size_t len)
+{
+  if (buf->len + len > buf->size) {
+    buf->size = (buf->len + len) * 2;
+    buf->data = TSrealloc(buf->data, buf->size);
+  }
+  memcpy(buf->data + buf->len, s, len);
+  buf->len += len;
+}
+
+static void
+prom_append_str(prom_buffer_t *buf, const char *s)
+{
+  prom_append(buf, s, strlen(s));
+}
+
+/* A metric name of the stat name of len bytes, with what is not [a-zA-Z0-9_:] as '_' */
+static char *
+prom_metric_name(const char *name, int len)
+{
+  char *metric = TSmalloc(len + 2);
+  char *p      = metric;
+
+  if (len > 0 && isdigit((unsigned char)name[0])) {
+    *p++ = '_';
+  }
+  for (int i = 0; i < len; ++i) {
+    *p++ = (isalnum((unsigned char)name[i]) || name[i] == ':') ? name[i] : '_';
+  }
+  *p = '\0';
+  return metric;
+}
+
+/* label="value", with the value escaped */
+static char *
+prom_label(const char *label, const char *value, int len)
+{
+  prom_buffer_t buf = {NULL, 0, 0};
+
+  prom_append_str(&buf, label);
+  prom_append(&buf, "=\"", 2);
+  for (int i = 0; i < len; ++i) {
+    if (value[i] == '\\' || value[i] == '"') {
+      prom_append(&buf, "\\", 1);
+      prom_append(&buf, value + i, 1);
+    } else if (value[i] == '\n') {
+      prom_append(&buf, "\\n", 2);
+    } else {
+      prom_append(&buf, value + i, 1);
+    }
+  }
+  prom_append(&buf, "\"", 2); /* with the NUL */
+  return buf.data;
+}
+
+static prom_sample_t *
+prom_add_sample(prom_render_t *render)
+{
+  if (render->count == render->size) {
+    render->size    = render->size ? render->size * 2 : 1024;
+    render->samples = TSrealloc(render->samples, render->size * sizeof(prom_sample_t));
+  }
+
+  prom_sample_t *sample = &render->samples[render->count];
+  memset(sample, 0, sizeof(*sample));
+  sample->order = render->count++;
+  sample->type  = "untyped";
+  sample->suffix = "";
+  return sample;
+}
+
+/* Apply the first label rule matching the name, making the family and labels of the sample. */
+static void
+prom_name_sample(prom_sample_t *sample, const config_t *config, const char *name, int len)
+{
+  for (int i = 0; i < config->labelCount; ++i) {
+    const label_rule_t *rule = &config->labels[i];
+
+    if (len <= rule->prefix_len + rule->component_len || strncmp(name, rule->prefix, rule->prefix_len) ||
+        strncmp(name + rule->prefix_len, rule->component, rule->component_len)) {
+      continue;
+    }
+
+    const char *value = name + rule->prefix_len + rule->component_len;
+    const char *rest  = memchr(value, '.', name + len - value);
+    int value_len     = rest ? rest - value : name + len - value;
+    if (value_len == 0) {
+      continue;
+    }
+
+    /* the name without the labelled component */
+    prom_buffer_t family = {NULL, 0, 0};
+    if (rest) {
+      prom_append(&family, name, rule->prefix_len);
+      prom_append(&family, rest + 1, name + len - rest - 1);
+    } else {
+      prom_append(&family, name, rule->prefix_len - 1);
+    }
+    sample->family = prom_metric_name(family.data, family.len);
+    sample->labels = prom_label(rule->label, value, value_len);
+    TSfree(family.data);
+    return;
+  }
+  sample->family = prom_metric_name(name, len);
+}
+
+static void
+prom_out_stat(TSRecordType rec_type ATS_UNUSED, void *edata, int registered ATS_UNUSED, const char *name,
+              TSRecordDataType data_type, TSRecordData *datum)
+{
+  prom_render_t *render = edata;
+  int len               = strlen(name);
+  const char *quantile  = NULL;
+  const char *suffix    = "";
+  int hist;
+
+  /* the records of a histogram make one summary */
+  for (size_t i = 0; i < sizeof(PROM_QUANTILES) / sizeof(PROM_QUANTILES[0]); ++i) {
+    size_t n = strlen(PROM_QUANTILES[i][0]);
+    if ((size_t)len > n && !strcmp(name + len - n, PROM_QUANTILES[i][0])) {
+      quantile = PROM_QUANTILES[i][1];
+      len -= n;
+      break;
+    }
+  }
+  if (!quantile) {
+    if (len > 6 && !strcmp(name + len - 6, ".count")) {
+      suffix = "_count";
+      len -= 6;
+    } else if (len > 4 && !strcmp(name + len - 4, ".sum")) {
+      suffix = "_sum";
+      len -= 4;
+    }
+  }
+  if (quantile || *suffix) {
+    char base[len + 1];
+    memcpy(base, name, len);
+    base[len] = '\0';
+    if (TSStatHistogramFindName(base, &hist) != TS_SUCCESS) {
+      quantile = NULL;
+      suffix   = "";
+      len      = strlen(name);
+    }
+  }
+
+  prom_sample_t *sample = NULL;
+  switch (data_type) {
+  case TS_RECORDDATATYPE_COUNTER:
+    sample = prom_add_sample(render);
+    snprintf(sample->value, sizeof(sample->value), "%" PRId64, datum->rec_counter);
+    sample->type = "counter";
+    break;
+  case TS_RECORDDATATYPE_INT:
+    sample = prom_add_sample(render);
+    snprintf(sample->value, sizeof(sample->value), "%" PRId64, datum->rec_int);
+    break;
+  case TS_RECORDDATATYPE_FLOAT:
+    sample = prom_add_sample(render);
+    snprintf(sample->value, sizeof(sample->value), "%f", datum->rec_float);
+    break;
+  default: /* strings are not metrics */
+    return;
+  }
+
+  prom_name_sample(sample, render->config, name, len);
+  if (quantile || *suffix) {
+    sample->type   = "summary";
+    sample->suffix = suffix;
+  }
+  if (quantile) {
+    char *q = prom_label("quantile", quantile, strlen(quantile));
+    if (sample->labels) {
+      char *labels = TSmalloc(strlen(sample->labels) + strlen(q) + 2);
+      sprintf(labels, "%s,%s", sample->labels, q);
+      TSfree(sample->labels);
+      TSfree(q);
+      sample->labels = labels;
+    } else {
+      sample->labels = q;
+    }
+  }
+}
+
+static int
+prom_sample_cmp(const void *a, const void *b)
+{
+  const prom_sample_t *sa = a;
+  const prom_sample_t *sb = b;
+  int cmp                 = strcmp(sa->family, sb->family);
+
+  return cmp ? cmp : sa->order - sb->order;
+}
+
+/* Render all the stats to the text of the cache, the samples of each metric together under its TYPE. */
+static void
+prom_render(const config_t *config)
+{
+  prom_render_t render = {NULL, 0, 0, config};
+  prom_buffer_t *text  = &prom_cache.text;
+  const char *family   = NULL;
+
+  TSRecordDump((TSRecordType)(TS_RECORDTYPE_PLUGIN | TS_RECORDTYPE_NODE | TS_RECORDTYPE_PROCESS), prom_out_stat, &render);
+  qsort(render.samples, render.count, sizeof(prom_sample_t), prom_sample_cmp);
+
+  text->len = 0;
+  for (int i = 0; i < render.count; ++i) {
+    prom_sample_t *sample = &render.samples[i];
+
+    if (!family || strcmp(family, sample->family)) {
+      family = sample->family;
+      prom_append_str(text, "# TYPE ");
+      prom_append_str(text, family);
+      prom_append_str(text, " ");
+      prom_append_str(text, sample->type);
+      prom_append_str(text, "\n");
+    }
+    prom_append_str(text, sample->family);
+    prom_append_str(text, sample->suffix);
+    if (sample->labels) {
+      prom_append_str(text, "{");
+      prom_append_str(text, sample->labels);
+      prom_append_str(text, "}");
+    }
+    prom_append_str(text, " ");
+    prom_append_str(text, sample->value);
+    prom_append_str(text, "\n");
+  }
+  prom_append_str(text, "# TYPE trafficserver_build_info gauge\ntrafficserver_build_info{");
+  {
+    const char *version = TSTrafficServerVersionGet();
+    char *label         = prom_label("version", version, strlen(version));
+    prom_append_str(text, label);
+    TSfree(label);
+  }
+  prom_append_str(text, "} 1\n");
+
+  for (int i = 0; i < render.count; ++i) {
+    TSfree(render.samples[i].family);
+    TSfree(render.samples[i].labels);
+  }
+  TSfree(render.samples);
+}
+
+static void
+prom_compress(void)
+{
+  z_stream zstrm;
+  prom_buffer_t *gzip = &prom_cache.gzip;
+
+  memset(&zstrm, 0, sizeof(zstrm));
+  gzip->len = 0;
+  if (deflateInit2(&zstrm, ZLIB_COMPRESSION_LEVEL, Z_DEFLATED, GZIP_MODE, ZLIB_MEMLEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+    TSDebug(PLUGIN_NAME, "gzip intialization failed");
+    return;
+  }
+
+  size_t bound = deflateBound(&zstrm, prom_cache.text.len);
+  if (bound > gzip->size) {
+    gzip->size = bound;
+    gzip->data = TSrealloc(gzip->data, gzip->size);
+  }
+  zstrm.next_in   = (Bytef *)prom_cache.text.data;
+  zstrm.avail_in  = prom_cache.text.len;
+  zstrm.next_out  = (Bytef *)gzip->data;
+  zstrm.avail_out = gzip->size;
+  if (deflate(&zstrm, Z_FINISH) == Z_STREAM_END) {
+    gzip->len = zstrm.total_out;
+  } else {
+    TSDebug(PLUGIN_NAME, "deflate error");
+  }
+  deflateEnd(&zstrm);
+}
+
+static void
+prom_out_stats(stats_state *my_state)
+{
+  TSHRTime now = TShrtime();
+
+  TSMutexLock(prom_cache.mutex);
+  if (prom_cache.rendered == 0 || now - prom_cache.rendered >= prom_refresh_interval ||
+      prom_cache.config_reloads != configReloads) {
+    prom_render(my_state->config);
+    prom_cache.rendered       = now;
+    prom_cache.config_reloads = configReloads;
+    prom_cache.gzip.len       = 0;
+  }
+
+  if (my_state->encoding == GZIP && prom_cache.gzip.len == 0) {
+    prom_compress();
+  }
+  if (my_state->encoding == GZIP && prom_cache.gzip.len > 0) {
+    my_state->output_bytes += TSIOBufferWrite(my_state->resp_buffer, prom_cache.gzip.data, prom_cache.gzip.len);
+  } else {
+    my_state->output_bytes += TSIOBufferWrite(my_state->resp_buffer, prom_cache.text.data, prom_cache.text.len);
+  }
+  TSMutexUnlock(prom_cache.mutex);
+}
+
 static void
 stats_process_write(TSCont contp, TSEvent event, stats_state *my_state)
 {
@@ -510,12 +875,17 @@ stats_process_write(TSCont contp, TSEvent event, stats_state *my_state)
       case CSV_OUTPUT:
         csv_out_stats(my_state);
         break;
+      case PROMETHEUS_OUTPUT:
+        prom_out_stats(my_state); // from the cache, compressed already
+        break;
       default:
         TSError("stats_process_write: Unknown output type\n");
         break;
       }
 
-      if ((my_state->encoding == GZIP) || (my_state->encoding == DEFLATE)) {
+      if (my_state->output == PROMETHEUS_OUTPUT) {
+        // written as it is
+      } else if ((my_state->encoding == GZIP) || (my_state->encoding == DEFLATE)) {
         gzip_out_stats(my_state);
       }
 #if HAVE_BROTLI_ENCODE_H
@@ -552,6 +922,20 @@ stats_dostuff(TSCont contp, TSEvent event, void *edata)
   return 0;
 }
 
+// Whether the header value of len bytes has s in it, ignoring case
+static bool
+accept_has(const char *str, int len, const char *s)
+{
+  int s_len = strlen(s);
+
+  for (int i = 0; i + s_len <= len; ++i) {
+    if (!strncasecmp(str + i, s, s_len)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static int
 stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
 {
@@ -597,6 +981,8 @@ stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
   memset(my_state, 0, sizeof(*my_state));
   icontp = TSContCreate(stats_dostuff, TSMutexCreate());
 
+  my_state->config = config;
+
   accept_field     = TSMimeHdrFieldFind(reqp, hdr_loc, TS_MIME_FIELD_ACCEPT, TS_MIME_LEN_ACCEPT);
   my_state->output = JSON_OUTPUT; // default to json output
   // accept header exists, use it to determine response type
@@ -607,6 +993,8 @@ stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
     // Parse the Accept header, default to JSON output unless its another supported format
     if (!strncasecmp(str, "text/csv", len)) {
       my_state->output = CSV_OUTPUT;
+    } else if (accept_has(str, len, "openmetrics-text") || accept_has(str, len, "text/plain")) {
+      my_state->output = PROMETHEUS_OUTPUT;
     } else {
       my_state->output = JSON_OUTPUT;
     }
@@ -618,7 +1006,10 @@ stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
   if (accept_encoding_field != TS_NULL_MLOC) {
     int len         = -1;
     const char *str = TSMimeHdrFieldValueStringGet(reqp, hdr_loc, accept_encoding_field, -1, &len);
-    if (strstr(str, "deflate") != NULL) {
+    if (my_state->output == PROMETHEUS_OUTPUT) {
+      // only gzip is cached
+      my_state->encoding = accept_has(str, len, "gzip") ? GZIP : NONE;
+    } else if (strstr(str, "deflate") != NULL) {
       TSDebug(PLUGIN_NAME, "Saw deflate in accept encoding");
       my_state->encoding = init_gzip(my_state, DEFLATE_MODE);
     } else if (strstr(str, "gzip") != NULL) {
@@ -665,10 +1056,12 @@ TSPluginInit(int argc, const char *argv[])
 {
   TSPluginRegistrationInfo info;
 
-  static const char usage[]             = PLUGIN_NAME ".so [--integer-counters] [PATH]";
+  static const char usage[]             = PLUGIN_NAME ".so [--integer-counters] [--prometheus-refresh-ms=MS] [PATH]";
   static const struct option longopts[] = {{(char *)("integer-counters"), no_argument, NULL, 'i'},
                                            {(char *)("wrap-counters"), no_argument, NULL, 'w'},
+                                           {(char *)("prometheus-refresh-ms"), required_argument, NULL, 'r'},
                                            {NULL, 0, NULL, 0}};
+  TSMgmtInt sync_interval_ms;
   TSCont main_cont, config_cont;
   config_holder_t *config_holder;
 
@@ -681,14 +1074,23 @@ TSPluginInit(int argc, const char *argv[])
     goto done;
   }
 
+  // a Prometheus rendering is good until the stats are synced again
+  if (TSMgmtIntGet("proxy.config.raw_stat_sync_interval_ms", &sync_interval_ms) == TS_SUCCESS && sync_interval_ms > 0) {
+    prom_refresh_interval = sync_interval_ms * TS_HRTIME_MSECOND;
+  }
+  prom_cache.mutex = TSMutexCreate();
+
   for (;;) {
-    switch (getopt_long(argc, (char *const *)argv, "iw", longopts, NULL)) {
+    switch (getopt_long(argc, (char *const *)argv, "iwr:", longopts, NULL)) {
     case 'i':
       integer_counters = true;
       break;
     case 'w':
       wrap_counters = true;
       break;
+    case 'r':
+      prom_refresh_interval = strtol(optarg, NULL, 10) * TS_HRTIME_MSECOND;
+      break;
     case -1:
       goto init;
     default:
@@ -900,6 +1302,44 @@ parseIps6(config_t *config, char *ipStr)
   }
 }
 
+// Add the label rule of "<pattern>:<label>", where the pattern ends with a component with a '*'
+static void
+parseLabelRule(config_t *config, char *ruleStr)
+{
+  char *colon = strrchr(ruleStr, ':');
+  char *star  = strchr(ruleStr, '*');
+
+  if (config->labelCount >= MAX_LABEL_RULES) {
+    TSError("[%s] too many label rules, ignoring %s", PLUGIN_NAME, ruleStr);
+    return;
+  }
+  if (!colon || !star || star + 1 != colon || colon[1] == '\0') {
+    TSError("[%s] label rule %s is not <pattern ending with *>:<label>", PLUGIN_NAME, ruleStr);
+    return;
+  }
+
+  label_rule_t *rule = &config->labels[config->labelCount++];
+  char *component    = star;
+  while (component > ruleStr && component[-1] != '.') {
+    --component;
+  }
+
+  rule->prefix_len    = component - ruleStr;
+  rule->prefix        = TSstrndup(ruleStr, rule->prefix_len);
+  rule->component_len = star - component;
+  rule->component     = TSstrndup(component, rule->component_len);
+  rule->label         = nstr(colon + 1);
+}
+
+// The label rules of the stats of the core, unless the config file has some
+static void
+parseDefaultLabelRules(config_t *config)
+{
+  char rule[] = "proxy.process.cache.volume_*:volume";
+
+  parseLabelRule(config, rule);
+}
+
 static config_t *
 new_config(TSFile fh)
 {
@@ -913,9 +1353,11 @@ new_config(TSFile fh)
   config->allowIps6      = 0;
   config->ip6Count       = 0;
   config->recordTypes    = DEFAULT_RECORD_TYPES;
+  config->labelCount     = 0;
 
   if (!fh) {
     TSDebug(PLUGIN_NAME, "No config file, using defaults");
+    parseDefaultLabelRules(config);
     return config;
   }
 
@@ -940,8 +1382,14 @@ new_config(TSFile fh)
     } else if ((p = strstr(buffer, "allow_ip6="))) {
       p += strlen("allow_ip6=");
       parseIps6(config, p);
+    } else if ((p = strstr(buffer, "prometheus_label="))) {
+      p += strlen("prometheus_label=");
+      parseLabelRule(config, strtok_r(p, " \n", &p));
     }
   }
+  if (!config->labelCount) {
+    parseDefaultLabelRules(config);
+  }
   if (!config->ipCount) {
     parseIps(config, NULL);
   }
@@ -960,6 +1408,11 @@ delete_config(config_t *config)
   TSfree(config->allowIps);
   TSfree(config->allowIps6);
   TSfree(config->stats_path);
+  for (int i = 0; i < config->labelCount; ++i) {
+    TSfree(config->labels[i].prefix);
+    TSfree(config->labels[i].component);
+    TSfree(config->labels[i].label);
+  }
   TSfree(config);
 }
 
@@ -111,22 +111,19 @@ log_tcp_info(Config *config, const char *event_name, TSHttpSsn ssnp)
   const_sockaddr_ptr server_addr;
 
   struct tcp_info info;
-  socklen_t tcp_info_len = sizeof(info);
-  int fd;
+  int tcp_info_len = sizeof(info);
 
   TSReleaseAssert(config->log != nullptr);
 
-  if (ssnp != nullptr && (TSHttpSsnClientFdGet(ssnp, &fd) != TS_SUCCESS || fd <= 0)) {
-    TSDebug("tcpinfo", "error getting the client socket fd from ssn");
-    return;
-  }
   if (ssnp == nullptr) {
     TSDebug("tcpinfo", "ssn is not specified");
     return;
   }
 
-  if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &tcp_info_len) != 0) {
-    TSDebug("tcpinfo", "getsockopt(%d, TCP_INFO) failed: %s", fd, strerror(errno));
+  // The core samples the TCP_INFO of the connection, and shares it with whoever else asks for it.
+  memset(&info, 0, sizeof(info));
+  if (TSVConnTcpInfoGet(TSHttpSsnClientVConnGet(ssnp), &info, &tcp_info_len) != TS_SUCCESS) {
+    TSDebug("tcpinfo", "no TCP_INFO sample of the client connection");
     return;
   }
 
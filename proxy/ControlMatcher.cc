@@ -375,10 +375,20 @@ RegexMatcher<Data, MatchResult>::RegexMatcher(const char *name, const char *file
 template <class Data, class MatchResult> RegexMatcher<Data, MatchResult>::~RegexMatcher()
 {
   for (int i = 0; i < num_el; i++) {
+    if (re_extra[i]) {
+      pcre_free_study(re_extra[i]);
+    }
     pcre_free(re_array[i]);
     ats_free(re_str[i]);
   }
+  if (re_any_extra) {
+    pcre_free_study(re_any_extra);
+  }
+  if (re_any) {
+    pcre_free(re_any);
+  }
   delete[] re_str;
+  ats_free(re_extra);
   ats_free(re_array);
 }
 
@@ -411,6 +421,9 @@ RegexMatcher<Data, MatchResult>::AllocateSpace(int num_entries)
   re_array = static_cast<pcre **>(ats_malloc(sizeof(pcre *) * num_entries));
   memset(re_array, 0, sizeof(pcre *) * num_entries);
 
+  re_extra = static_cast<pcre_extra **>(ats_malloc(sizeof(pcre_extra *) * num_entries));
+  memset(re_extra, 0, sizeof(pcre_extra *) * num_entries);
+
   data_array = new Data[num_entries];
 
   re_str = new char *[num_entries];
@@ -474,18 +487,108 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
   return error;
 }
 
+//
+// void RegexMatcher<Data,MatchResult>::Compile()
+//
+//    Studies the regexs once every entry is in, and combines them
+//      into one alternation that tells when none of them match
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::Compile()
+{
+  const char *errptr;
+  int erroffset;
+  int study_opts = 0;
+
+#if defined(PCRE_CONFIG_JIT) && !defined(darwin) // issue with macOS Catalina and pcre 8.43
+  study_opts |= PCRE_STUDY_JIT_COMPILE;
+#endif
+
+  for (int i = 0; i < num_el; i++) {
+    if (!re_extra[i]) {
+      re_extra[i] = pcre_study(re_array[i], study_opts, &errptr);
+    }
+  }
+
+  if (re_any != nullptr || num_el < 2) {
+    return;
+  }
+
+  // A regex that refers to its groups by number, or to itself, means something
+  //   else inside the alternation.  The other constructs that do not nest, as
+  //   \Q without \E or a start of pattern option, make it fail to compile.
+  std::string any;
+  for (int i = 0; i < num_el; i++) {
+    int backrefs = 0;
+    if (pcre_fullinfo(re_array[i], nullptr, PCRE_INFO_BACKREFMAX, &backrefs) != 0 || backrefs != 0 ||
+        strstr(re_str[i], "(?R") != nullptr || strstr(re_str[i], "(?P>") != nullptr || strstr(re_str[i], "\\g") != nullptr) {
+      return;
+    }
+    for (const char *s = strstr(re_str[i], "(?"); s != nullptr; s = strstr(s + 2, "(?")) {
+      if (isdigit(static_cast<unsigned char>(s[2])) || s[2] == '+' || s[2] == '-' || s[2] == '&') {
+        return;
+      }
+    }
+    any.append(i == 0 ? "(?:" : "|(?:").append(re_str[i]).append(")");
+  }
+
+  re_any = pcre_compile(any.c_str(), 0, &errptr, &erroffset, nullptr);
+  if (re_any) {
+    re_any_extra = pcre_study(re_any, study_opts, &errptr);
+  } else {
+    Debug("matcher", "%s regexs run one by one, they do not combine: %s", matcher_name, errptr);
+  }
+}
+
+//
+// void RegexMatcher<Data,MatchResult>::MatchString(const char* str, int len, RequestData* rdata, MatchResult* result)
+//
+//   Conducts a linear search through the regex array and
+//     updates arg result for each regex that matches arg str,
+//     unless the combined regex tells none of them do
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::MatchString(const char *str, int len, RequestData *rdata, MatchResult *result) const
+{
+  int r;
+
+  if (re_any != nullptr) {
+    r = pcre_exec(re_any, re_any_extra, str, len, 0, 0, nullptr, 0);
+    if (r == PCRE_ERROR_NOMATCH) {
+      return;
+    } // else one of them matches, or the combined regex hit a limit the others may not
+  }
+
+  for (int i = 0; i < num_el; i++) {
+    r = pcre_exec(re_array[i], re_extra[i], str, len, 0, 0, nullptr, 0);
+#ifdef PCRE_ERROR_JIT_STACKLIMIT
+    if (r == PCRE_ERROR_JIT_STACKLIMIT) {
+      // The JIT code ran out of its stack, the interpreter may not
+      r = pcre_exec(re_array[i], nullptr, str, len, 0, 0, nullptr, 0);
+    }
+#endif
+    if (r > -1) {
+      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, str, data_array[i].line_num);
+      data_array[i].UpdateMatch(result, rdata);
+    } else if (r < -1) {
+      // An error has occured
+      Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
+    } // else it's -1 which means no match was found.
+  }
+}
+
 //
 // void RegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Coduncts a linear search through the regex array and
-//     updates arg result for each regex that matches arg URL
+//   Matches the regexs against arg URL
 //
 template <class Data, class MatchResult>
 void
 RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result) const
 {
   char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -505,16 +608,7 @@ RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
   // The function unescapifyStr() is already called in
   // HttpRequestData::get_string(); therefore, no need to call again here.
 
-  for (int i = 0; i < num_el; i++) {
-    r = pcre_exec(re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r > -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, url_str, data_array[i].line_num);
-      data_array[i].UpdateMatch(result, rdata);
-    } else if (r < -1) {
-      // An error has occured
-      Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
-    } // else it's -1 which means no match was found.
-  }
+  this->MatchString(url_str, strlen(url_str), rdata, result);
   ats_free(url_str);
 }
 
@@ -530,15 +624,13 @@ HostRegexMatcher<Data, MatchResult>::HostRegexMatcher(const char *name, const ch
 //
 // void HostRegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Conducts a linear search through the regex array and
-//     updates arg result for each regex that matches arg host_regex
+//   Matches the regexs against arg host_regex
 //
 template <class Data, class MatchResult>
 void
 HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result) const
 {
   const char *url_str;
-  int r;
 
   // Check to see there is any work to before we copy the
   //   URL
@@ -553,17 +645,7 @@ HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *resu
   if (url_str == nullptr) {
     url_str = "";
   }
-  for (int i = 0; i < this->num_el; i++) {
-    r = pcre_exec(this->re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r != -1) {
-      Debug("matcher", "%s Matched %s with regex at line %d", const_cast<char *>(this->matcher_name), url_str,
-            this->data_array[i].line_num);
-      this->data_array[i].UpdateMatch(result, rdata);
-    } else {
-      // An error has occured
-      Warning("error matching regex at line %d", this->data_array[i].line_num);
-    }
-  }
+  this->MatchString(url_str, strlen(url_str), rdata, result);
 }
 
 //
@@ -644,6 +726,18 @@ IpMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
   return error;
 }
 
+//
+// void IpMatcher<Data,MatchResult>::Compile()
+//
+//    Compiles the lookup table once every entry is in
+//
+template <class Data, class MatchResult>
+void
+IpMatcher<Data, MatchResult>::Compile()
+{
+  ip_map.compile();
+}
+
 //
 // void IpMatcherData,MatchResult>::Match(in_addr_t addr, RequestData* rdata, MatchResult* result)
 //
@@ -926,6 +1020,16 @@ ControlMatcher<Data, MatchResult>::BuildTableFromString(char *file_buf)
 
   ink_assert(second_pass == numEntries);
 
+  if (reMatch != nullptr) {
+    reMatch->Compile();
+  }
+  if (hrMatch != nullptr) {
+    hrMatch->Compile();
+  }
+  if (ipMatch != nullptr) {
+    ipMatch->Compile();
+  }
+
   if (is_debug_tag_set("matcher")) {
     Print();
   }
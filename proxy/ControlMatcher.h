@@ -212,6 +212,7 @@ public:
 
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void Compile();
 
   void Match(RequestData *rdata, MatchResult *result) const;
   void Print() const;
@@ -223,8 +224,13 @@ public:
   using super::array_len;
 
 protected:
-  pcre **re_array = nullptr; // array of compiled regexs
-  char **re_str   = nullptr; // array of uncompiled regex strings
+  void MatchString(const char *str, int len, RequestData *rdata, MatchResult *result) const;
+
+  pcre **re_array          = nullptr; // array of compiled regexs
+  pcre_extra **re_extra    = nullptr; // array of the study data of the compiled regexs
+  char **re_str            = nullptr; // array of uncompiled regex strings
+  pcre *re_any             = nullptr; // all the regexs as one alternation, nullptr if they cannot be combined
+  pcre_extra *re_any_extra = nullptr; // study data of re_any
 };
 
 template <class Data, class MatchResult> class HostRegexMatcher : public RegexMatcher<Data, MatchResult>
@@ -282,6 +288,7 @@ public:
 
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void Compile();
 
   void Match(sockaddr const *ip_addr, RequestData *rdata, MatchResult *result) const;
   void Print() const;
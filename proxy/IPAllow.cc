@@ -126,7 +126,7 @@ IpAllow::startup()
   // Should not have been initialized before
   ink_assert(IpAllow::configid == 0);
 
-  ipAllowUpdate = new ConfigUpdateHandler<IpAllow>();
+  ipAllowUpdate = new ConfigUpdateHandler<IpAllow>("ip_allow");
   ipAllowUpdate->attach("proxy.config.cache.ip_allow.filename");
 
   reconfigure();
@@ -278,6 +278,9 @@ IpAllow::BuildTable()
     for (auto &item : _dst_map) {
       item.setData(&_dst_acls[reinterpret_cast<size_t>(item.data())]);
     }
+    // the maps are complete, look them up in their compiled form
+    _src_map.compile();
+    _dst_map.compile();
     if (is_debug_tag_set("ip-allow")) {
       Print();
     }
@@ -113,7 +113,15 @@ class APIHook
 {
 public:
   INKContInternal *m_cont;
+  /// A fast hook, called in place, instead of the continuation, which is then @c nullptr.
+  TSHttpFastHookFunc m_fast_func;
+  void *m_fast_data;
   int invoke(int event, void *edata) const;
+  TSHttpHookResult
+  invoke_fast(TSHttpTxn txnp, TSHttpHookID id) const
+  {
+    return m_fast_func(txnp, id, m_fast_data);
+  }
   APIHook *next() const;
   APIHook *prev() const;
   LINK(APIHook, m_link);
@@ -124,6 +132,7 @@ class APIHooks
 {
 public:
   void append(INKContInternal *cont);
+  void append(TSHttpFastHookFunc func, void *data);
   /// Get the first hook.
   APIHook *head() const;
   /// Remove all hooks.
@@ -163,6 +172,8 @@ public:
   void clear();
   /// Add the hook @a cont to the end of the hooks for @a id.
   void append(ID id, INKContInternal *cont);
+  /// Add the fast hook @a func to the end of the hooks for @a id.
+  void append(ID id, TSHttpFastHookFunc func, void *data);
   /// Get the list of hooks for @a id.
   APIHook *get(ID id) const;
   /// @return @c true if @a id is a valid id, @c false otherwise.
@@ -217,6 +228,16 @@ FeatureAPIHooks<ID, N>::append(ID id, INKContInternal *cont)
   }
 }
 
+template <typename ID, int N>
+void
+FeatureAPIHooks<ID, N>::append(ID id, TSHttpFastHookFunc func, void *data)
+{
+  if (is_valid(id)) {
+    m_hooks_p = true;
+    m_hooks[id].append(func, data);
+  }
+}
+
 template <typename ID, int N>
 APIHook *
 FeatureAPIHooks<ID, N>::get(ID id) const
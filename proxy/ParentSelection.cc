@@ -262,7 +262,7 @@ int ParentConfig::m_id = 0;
 void
 ParentConfig::startup()
 {
-  parentConfigUpdate = new ConfigUpdateHandler<ParentConfig>();
+  parentConfigUpdate = new ConfigUpdateHandler<ParentConfig>("parent");
 
   // Load the initial configuration
   reconfigure();
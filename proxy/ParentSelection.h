@@ -309,6 +309,8 @@ private:
   // state for consistent hash.
   int last_lookup;
   ATSConsistentHashIter chashIter[MAX_GROUP_RINGS];
+  // state for maglev hash.
+  uint32_t maglevPos[MAX_GROUP_RINGS];
 
   friend class NextHopSelectionStrategy;
   friend class NextHopRoundRobin;
@@ -38,16 +38,17 @@
    for doing operations that affect the shared buffers,
    read state from the PluginVC on the other side or deal with deallocation.
 
-   To simplify the code, all data passing through the system goes initially
-   into a shared buffer.  There are two shared buffers, one for each
-   direction of the connection.  While it's more efficient to transfer
-   the data from one buffer to another directly, this creates a lot
-   of tricky conditions since you must be holding the lock for both
-   sides, in additional this VC's lock.  Additionally, issues like
-   watermarks are very hard to deal with.  Since we try to
-   to move data by IOBufferData references the efficiency penalty shouldn't
-   be too bad and if it is a big penalty, a brave soul can reimplement
-   to move the data directly without the intermediate buffer.
+   To simplify the code, data passing through the system goes into a
+   shared buffer.  There are two shared buffers, one for each
+   direction of the connection.  Transferring the data from one buffer
+   to another directly needs the lock for both sides, in addition to
+   this VC's lock, so it is only done when the writing side finds the
+   lock of the reading side already held by its thread, as when the
+   initiator passed its mutex to PluginVCCore::alloc, and the shared
+   buffer is empty.  The reading side then gets the bytes in its own
+   buffer, with its watermark applied, and is called back right after
+   the writing side.  Otherwise the data moves by IOBufferData references
+   through the shared buffer.
 
    Locking is difficult issue for this multi-headed beast.  In each
    PluginVC, there a two locks. The one we got from our PluginVCCore and
@@ -103,7 +104,8 @@ PluginVC::PluginVC(PluginVCCore *core_obj)
     inactive_timeout_at(0),
     inactive_event(nullptr),
     plugin_tag(nullptr),
-    plugin_id(0)
+    plugin_id(0),
+    response_sink(nullptr)
 {
   ink_assert(core_obj != nullptr);
   SET_HANDLER(&PluginVC::main_handler);
@@ -459,6 +461,58 @@ PluginVC::transfer_bytes(MIOBuffer *transfer_to, IOBufferReader *transfer_from,
   return total_added;
 }
 
+// int64_t PluginVC::transfer_direct(IOBufferReader* transfer_from, int64_t act_on)
+//
+//   Moves up to act_on bytes from the write side of the other side to
+//      the buffer of our read side, if that read side is active and
+//      its lock is held by the calling thread.  The caller must have
+//      made sure the intermediate buffer toward us is empty, so that
+//      the bytes stay in order.
+//
+// Returns number of bytes transfered
+//
+int64_t
+PluginVC::transfer_direct(IOBufferReader *transfer_from, int64_t act_on)
+{
+  if (read_state.vio.op != VIO::READ || closed || read_state.shutdown || !read_state.vio.buffer.writer()) {
+    return 0;
+  }
+  if (!read_state.vio.mutex || read_state.vio.mutex->thread_holding != mutex->thread_holding) {
+    return 0;
+  }
+
+  MIOBuffer *output_buffer = read_state.vio.get_writer();
+  int64_t water_mark       = std::max(output_buffer->water_mark, static_cast<int64_t>(PVC_DEFAULT_MAX_BYTES));
+  int64_t buf_space        = water_mark - output_buffer->max_read_avail();
+  act_on                   = std::min({act_on, buf_space, read_state.vio.ntodo()});
+  if (act_on <= 0) {
+    return 0;
+  }
+
+  int64_t added = transfer_bytes(output_buffer, transfer_from, act_on);
+  read_state.vio.ndone += added;
+  return added;
+}
+
+// void PluginVC::signal_read_done()
+//
+//   Calls back the read side for the bytes transfer_direct moved,
+//      with the lock of the read side held
+//
+void
+PluginVC::signal_read_done()
+{
+  if (read_state.vio.op != VIO::READ || closed || read_state.shutdown) {
+    return;
+  }
+  if (read_state.vio.ntodo() == 0) {
+    read_state.vio.cont->handleEvent(VC_EVENT_READ_COMPLETE, &read_state.vio);
+  } else {
+    read_state.vio.cont->handleEvent(VC_EVENT_READ_READY, &read_state.vio);
+  }
+  update_inactive_time();
+}
+
 // void PluginVC::process_write_side(bool cb_ok)
 //
 //   This function may only be called while holding
@@ -508,18 +562,30 @@ PluginVC::process_write_side(bool other_side_call)
     }
     return;
   }
-  // Bytes available, try to transfer to the PluginVCCore
-  //   intermediate buffer
+  // With the read side of the other side locked, the bytes can go straight to
+  //   its buffer, skipping the intermediate buffer
   //
-  int64_t buf_space = PVC_DEFAULT_MAX_BYTES - core_buffer->max_read_avail();
-  if (buf_space <= 0) {
-    Debug("pvc", "[%u] %s: process_write_side no buffer space", core_obj->id, PVC_TYPE);
-    return;
+  int64_t direct = 0;
+  if (!other_side_call && core_buffer->max_read_avail() == 0) {
+    direct = other_side->transfer_direct(reader, act_on);
+    act_on -= direct;
   }
-  act_on = std::min(act_on, buf_space);
 
-  int64_t added = transfer_bytes(core_buffer, reader, act_on);
-  if (added < 0) {
+  // Bytes left, try to transfer to the PluginVCCore
+  //   intermediate buffer
+  //
+  int64_t added = 0;
+  if (act_on > 0) {
+    int64_t buf_space = PVC_DEFAULT_MAX_BYTES - core_buffer->max_read_avail();
+    if (buf_space <= 0 && direct == 0) {
+      Debug("pvc", "[%u] %s: process_write_side no buffer space", core_obj->id, PVC_TYPE);
+      return;
+    }
+    if (buf_space > 0) {
+      added = transfer_bytes(core_buffer, reader, std::min(act_on, buf_space));
+    }
+  }
+  if (added + direct <= 0) {
     // Couldn't actually get the buffer space.  This only
     //   happens on small transfers with the above
     //   PVC_DEFAULT_MAX_BYTES factor doesn't apply
@@ -527,9 +593,9 @@ PluginVC::process_write_side(bool other_side_call)
     return;
   }
 
-  write_state.vio.ndone += added;
+  write_state.vio.ndone += added + direct;
 
-  Debug("pvc", "[%u] %s: process_write_side; added %" PRId64 "", core_obj->id, PVC_TYPE, added);
+  Debug("pvc", "[%u] %s: process_write_side; added %" PRId64 ", direct %" PRId64 "", core_obj->id, PVC_TYPE, added, direct);
 
   if (write_state.vio.ntodo() == 0) {
     write_state.vio.cont->handleEvent(VC_EVENT_WRITE_COMPLETE, &write_state.vio);
@@ -541,7 +607,10 @@ PluginVC::process_write_side(bool other_side_call)
 
   // Wake up the read side on the other side to process these bytes
   if (!other_side->closed) {
-    if (!other_side_call) {
+    if (direct > 0 && added == 0) {
+      // Nothing left in the intermediate buffer, only the bytes already moved to signal
+      other_side->signal_read_done();
+    } else if (!other_side_call) {
       /* To clear the `need_read_process`, the mutexes must be obtained:
        *
        *   - PluginVC::mutex
@@ -1054,18 +1123,18 @@ int32_t PluginVCCore::nextid;
 PluginVCCore::~PluginVCCore() = default;
 
 PluginVCCore *
-PluginVCCore::alloc(Continuation *acceptor)
+PluginVCCore::alloc(Continuation *acceptor, ProxyMutex *mutex)
 {
   PluginVCCore *pvc = new PluginVCCore;
-  pvc->init();
+  pvc->init(mutex);
   pvc->connect_to = acceptor;
   return pvc;
 }
 
 void
-PluginVCCore::init()
+PluginVCCore::init(ProxyMutex *shared_mutex)
 {
-  mutex = new_ProxyMutex();
+  mutex = shared_mutex ? shared_mutex : new_ProxyMutex();
 
   active_vc.vc_type    = PLUGIN_VC_ACTIVE;
   active_vc.other_side = &passive_vc;
@@ -40,6 +40,7 @@
 #include "tscore/ink_atomic.h"
 
 class PluginVCCore;
+class HTTPHdr;
 
 struct PluginVCState {
   PluginVCState();
@@ -66,6 +67,21 @@ enum {
   PLUGIN_VC_MAGIC_DEAD  = 0xaabbdead,
 };
 
+/** Takes the HTTP response header of the transaction on the passive side of a PluginVC.
+
+    The transaction hands its parsed header over instead of writing it to the connection, the
+    body follows on the connection as usual. The sink is called under the mutex of the
+    transaction, it can only be set by an initiator sharing that mutex, see PluginVCCore::alloc.
+ */
+class PluginVCResponseSink
+{
+public:
+  virtual void response_header(HTTPHdr *hdr) = 0;
+
+protected:
+  virtual ~PluginVCResponseSink() = default;
+};
+
 class PluginVC : public NetVConnection, public PluginIdentity
 {
   friend class PluginVCCore;
@@ -118,6 +134,18 @@ public:
     return other_side;
   }
 
+  /// The sink of the response header of the transaction on this side, if any.
+  PluginVCResponseSink *
+  get_response_sink() const
+  {
+    return response_sink;
+  }
+  void
+  set_response_sink(PluginVCResponseSink *sink)
+  {
+    response_sink = sink;
+  }
+
   //@{ @name Plugin identity.
   /// Override for @c PluginIdentity.
   const char *
@@ -162,6 +190,8 @@ private:
 
   void update_inactive_time();
   int64_t transfer_bytes(MIOBuffer *transfer_to, IOBufferReader *transfer_from, int64_t act_on);
+  int64_t transfer_direct(IOBufferReader *transfer_from, int64_t act_on);
+  void signal_read_done();
 
   uint32_t magic;
   PluginVC_t vc_type;
@@ -191,6 +221,8 @@ private:
 
   const char *plugin_tag;
   int64_t plugin_id;
+
+  PluginVCResponseSink *response_sink;
 };
 
 class PluginVCCore : public Continuation
@@ -202,8 +234,11 @@ public:
   ~PluginVCCore() override;
 
   // Allocate a PluginVCCore object, passing the continuation which
-  // will receive NET_EVENT_ACCEPT to accept the new session.
-  static PluginVCCore *alloc(Continuation *acceptor);
+  // will receive NET_EVENT_ACCEPT to accept the new session. With
+  // a mutex, the core and both sides use it instead of their own,
+  // the initiator passing its own mutex so that the data moves
+  // between the two sides without lock retries.
+  static PluginVCCore *alloc(Continuation *acceptor, ProxyMutex *mutex = nullptr);
 
   int state_send_accept(int event, void *data);
   int state_send_accept_failed(int event, void *data);
@@ -246,7 +281,7 @@ public:
   PluginVC passive_vc;
 
 private:
-  void init();
+  void init(ProxyMutex *mutex);
   void destroy();
 
   Continuation *connect_to = nullptr;
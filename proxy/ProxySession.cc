@@ -80,6 +80,7 @@ ProxySession::free()
   this->mutex.clear();
   this->acl.clear();
   this->_ssl.reset();
+  this->buffer_account = nullptr;
 }
 
 int
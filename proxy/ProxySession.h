@@ -165,6 +165,9 @@ public:
   ink_hrtime ssn_start_time    = 0;
   ink_hrtime ssn_last_txn_time = 0;
 
+  /// Buffer memory of the session, charged for its transactions as well. Null if the session has none.
+  Ptr<IOBufferAccount> buffer_account;
+
 protected:
   // Hook dispatching state
   HttpHookState hook_state;
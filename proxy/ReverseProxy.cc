@@ -44,6 +44,7 @@
 
 // Global Ptrs
 static Ptr<ProxyMutex> reconfig_mutex;
+static ConfigReloadStats *reload_stats                = nullptr;
 UrlRewrite *rewrite_table                             = nullptr;
 thread_local PluginThreadContext *pluginThreadContext = nullptr;
 
@@ -63,6 +64,7 @@ init_reverse_proxy()
 {
   ink_assert(rewrite_table == nullptr);
   reconfig_mutex = new_ProxyMutex();
+  reload_stats   = new ConfigReloadStats("remap");
   rewrite_table  = new UrlRewrite();
 
   Note("%s loading ...", ts::filename::REMAP);
@@ -108,7 +110,9 @@ struct UR_UpdateContinuation : public Continuation {
   int
   file_update_handler(int /* etype ATS_UNUSED */, void * /* data ATS_UNUSED */)
   {
+    ConfigReloadStats::Sample sample = reload_stats->begin();
     static_cast<void>(reloadUrlRewrite());
+    reload_stats->end(sample);
     delete this;
     return EVENT_DONE;
   }
@@ -135,7 +139,7 @@ reloadUrlRewrite()
   Note("%s loading ...", ts::filename::REMAP);
   Debug("url_rewrite", "%s updated, reloading...", ts::filename::REMAP);
   newTable = new UrlRewrite();
-  if (newTable->load()) {
+  if (newTable->load(rewrite_table)) {
     static const char *msg_format = "%s finished loading";
 
     // Hold at least one lease, until we reload the configuration
@@ -174,9 +178,15 @@ url_rewrite_CB(const char * /* name ATS_UNUSED */, RecDataT /* data_type ATS_UNU
 
   case TSNAME_CHANGED:
   case FILE_CHANGED:
-  case HTTP_DEFAULT_REDIRECT_CHANGED:
-    eventProcessor.schedule_imm(new UR_UpdateContinuation(reconfig_mutex), ET_TASK);
+  case HTTP_DEFAULT_REDIRECT_CHANGED: {
+    ink_hrtime delay = reload_stats->schedule();
+    if (delay > 0) {
+      eventProcessor.schedule_in(new UR_UpdateContinuation(reconfig_mutex), delay, ET_TASK);
+    } else if (delay == 0) {
+      eventProcessor.schedule_imm(new UR_UpdateContinuation(reconfig_mutex), ET_TASK);
+    }
     break;
+  }
 
   case URL_REMAP_MODE_CHANGED:
     // You need to restart TS.
@@ -361,6 +361,26 @@ http_hdr_clone(HTTPHdrImpl *s_hh, HdrHeap *s_heap, HdrHeap *d_heap)
   return (d_hh);
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+http_hdr_clone_heap_size(HTTPHdrImpl *hh)
+{
+  auto obj_size = [](size_t nbytes) -> intmax_t { return HdrHeapMarshalBlocks{ts::round_up(nbytes)}; };
+
+  intmax_t size = HDR_HEAP_HDR_SIZE + obj_size(sizeof(HTTPHdrImpl)) + obj_size(sizeof(MIMEHdrImpl));
+  if (hh->m_polarity == HTTP_TYPE_REQUEST) {
+    size += obj_size(sizeof(URLImpl));
+  }
+  for (MIMEFieldBlockImpl *fblock = hh->m_fields_impl->m_first_fblock.m_next; fblock != nullptr; fblock = fblock->m_next) {
+    size += obj_size(sizeof(MIMEFieldBlockImpl));
+  }
+
+  // Leave the clone as much room to grow as a default heap would have
+  return size <= HdrHeap::DEFAULT_SIZE ? HdrHeap::DEFAULT_SIZE : ts::round_up<HdrHeap::DEFAULT_SIZE>(size);
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -921,11 +941,8 @@ http_parser_parse_req(HTTPParser *parser, HdrHeap *heap, HTTPHdrImpl *hh, const
     must_copy_strings = (must_copy_strings || (!line_is_real));
 
 #if (ENABLE_PARSER_FAST_PATHS)
-    // first try fast path
+    // first try fast path, for "<method> <url> HTTP/d.d\r\n"
     if (end - cur >= 16) {
-      if (((cur[0] ^ 'G') | (cur[1] ^ 'E') | (cur[2] ^ 'T')) != 0) {
-        goto slow_case;
-      }
       if (((end[-10] ^ 'H') | (end[-9] ^ 'T') | (end[-8] ^ 'T') | (end[-7] ^ 'P') | (end[-6] ^ '/') | (end[-4] ^ '.') |
            (end[-2] ^ '\r') | (end[-1] ^ '\n')) != 0) {
         goto slow_case;
@@ -933,20 +950,34 @@ http_parser_parse_req(HTTPParser *parser, HdrHeap *heap, HTTPHdrImpl *hh, const
       if (!(is_digit(end[-5]) && is_digit(end[-3]))) {
         goto slow_case;
       }
-      if (!(ParseRules::is_space(cur[3]) && (!ParseRules::is_space(cur[4])) && (!ParseRules::is_space(end[-12])) &&
-            ParseRules::is_space(end[-11]))) {
+
+      // The method ends at the first space, which memchr finds with vector instructions. Any other white space or
+      // non-token character before it is left to the slow case.
+      int method_len;
+      bool is_get = ((cur[0] ^ 'G') | (cur[1] ^ 'E') | (cur[2] ^ 'T') | (cur[3] ^ ' ')) == 0;
+      if (is_get) {
+        method_len = 3;
+      } else {
+        const char *sp = static_cast<const char *>(memchr(cur, ' ', &(end[-11]) - cur));
+        if (sp == nullptr || sp == cur || !std::all_of(cur, sp, &ParseRules::is_token)) {
+          goto slow_case;
+        }
+        method_len = sp - cur;
+      }
+      if (!((!ParseRules::is_space(cur[method_len + 1])) && (!ParseRules::is_space(end[-12])) && ParseRules::is_space(end[-11]))) {
         goto slow_case;
       }
-      if (&(cur[4]) >= &(end[-11])) {
+      if (&(cur[method_len + 1]) >= &(end[-11])) {
         goto slow_case;
       }
 
       int32_t version = HTTP_VERSION(end[-5] - '0', end[-3] - '0');
 
-      http_hdr_method_set(heap, hh, &(cur[0]), hdrtoken_wks_to_index(HTTP_METHOD_GET), 3, must_copy_strings);
+      int method_wks_idx = is_get ? hdrtoken_wks_to_index(HTTP_METHOD_GET) : hdrtoken_tokenize(cur, method_len);
+      http_hdr_method_set(heap, hh, &(cur[0]), method_wks_idx, method_len, must_copy_strings);
       ink_assert(hh->u.req.m_url_impl != nullptr);
       url       = hh->u.req.m_url_impl;
-      url_start = &(cur[4]);
+      url_start = &(cur[method_len + 1]);
       err       = ::url_parse(heap, url, &url_start, &(end[-11]), must_copy_strings, strict_uri_parsing);
       if (err < 0) {
         return err;
@@ -419,6 +419,8 @@ void http_init();
 inkcoreapi HTTPHdrImpl *http_hdr_create(HdrHeap *heap, HTTPType polarity);
 void http_hdr_init(HdrHeap *heap, HTTPHdrImpl *hh, HTTPType polarity);
 HTTPHdrImpl *http_hdr_clone(HTTPHdrImpl *s_hh, HdrHeap *s_heap, HdrHeap *d_heap);
+/// Size of a heap that holds a clone of @a hh without chaining another heap block.
+int http_hdr_clone_heap_size(HTTPHdrImpl *hh);
 void http_hdr_copy_onto(HTTPHdrImpl *s_hh, HdrHeap *s_heap, HTTPHdrImpl *d_hh, HdrHeap *d_heap, bool inherit_strs);
 
 inkcoreapi int http_hdr_print(HdrHeap *heap, HTTPHdrImpl *hh, char *buf, int bufsize, int *bufindex, int *dumpoffset);
@@ -811,7 +813,7 @@ HTTPHdr::copy(const HTTPHdr *hdr)
   if (valid()) {
     http_hdr_copy_onto(hdr->m_http, hdr->m_heap, m_http, m_heap, (m_heap != hdr->m_heap) ? true : false);
   } else {
-    m_heap = new_HdrHeap();
+    m_heap = new_HdrHeap(http_hdr_clone_heap_size(hdr->m_http));
     m_http = http_hdr_clone(hdr->m_http, hdr->m_heap, m_heap);
     m_mime = m_http->m_fields_impl;
   }
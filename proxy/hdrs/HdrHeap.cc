@@ -36,12 +36,156 @@
 #include "MIME.h"
 #include "HTTP.h"
 #include "I_EventSystem.h"
+#include "tscore/JeAllocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 static constexpr size_t MAX_LOST_STR_SPACE        = 1024;
 static constexpr uint32_t MAX_HDR_HEAP_OBJ_LENGTH = (1 << 20) - 1; ///< m_length is 20 bit
 
 Allocator hdrHeapAllocator("hdrHeap", HdrHeap::DEFAULT_SIZE);
-Allocator strHeapAllocator("hdrStrHeap", HdrStrHeap::DEFAULT_SIZE);
+Allocator strHeapAllocator[HDR_STR_HEAP_SIZE_CLASSES] = {
+  {"hdrStrHeap[2048]", HdrStrHeap::DEFAULT_SIZE, 128},
+  {"hdrStrHeap[4096]", HdrStrHeap::DEFAULT_SIZE << 1, 64},
+  {"hdrStrHeap[8192]", HdrStrHeap::DEFAULT_SIZE << 2, 32},
+  {"hdrStrHeap[16384]", HdrStrHeap::DEFAULT_SIZE << 3, 16},
+};
+
+/// Of the heaps, and their string heaps, nullptr for the default.
+static jearena::Arena *hdr_heap_arena = nullptr;
+
+void
+hdr_heap_init()
+{
+  hdr_heap_arena = jearena::Arena::get("hdrheap");
+  hdrHeapAllocator.set_arena(hdr_heap_arena);
+  for (auto &a : strHeapAllocator) {
+    a.set_arena(hdr_heap_arena);
+  }
+}
+
+namespace
+{
+/// The heaps too large for the allocators, freed with ats_free().
+void *
+hdr_heap_malloc(size_t size)
+{
+  return hdr_heap_arena ? hdr_heap_arena->allocate(size) : ats_malloc(size);
+}
+
+/// Size class of a string heap of @a size bytes, HDR_STR_HEAP_SIZE_CLASSES if it is too large for any.
+int
+str_heap_size_class(int size)
+{
+  int idx = 0;
+  while (idx < HDR_STR_HEAP_SIZE_CLASSES && (HdrStrHeap::DEFAULT_SIZE << idx) < size) {
+    ++idx;
+  }
+  return idx;
+}
+
+void
+stat_add(std::atomic<int64_t> &stat, int64_t n)
+{
+  // Only the owning thread writes, so this needs no read-modify-write
+  stat.store(stat.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/** How large the string heaps of headers on this thread get, and the string heap stats of this thread.
+
+    The first read/write string heap of a header is taken from the size class that covers the 90th percentile of the
+    string heaps recently destroyed on the same thread. Where headers routinely balloon, with large cookies for example,
+    they then start in a heap big enough for them instead of demoting and coalescing their way up from the default size.
+ */
+class StrHeapSizer
+{
+public:
+  StrHeapSizer();
+  ~StrHeapSizer();
+
+  int
+  first_heap_size() const
+  {
+    return HdrStrHeap::DEFAULT_SIZE << _first_class;
+  }
+
+  void record(int used_bytes);
+
+  std::atomic<int64_t> demotions{0};
+  std::atomic<int64_t> coalesces{0};
+  std::atomic<int64_t> evacuated_bytes{0};
+  std::atomic<int64_t> wasted_bytes{0};
+
+private:
+  static constexpr uint32_t PERCENTILE    = 90;
+  static constexpr uint32_t DECAY_SAMPLES = 1024; ///< Counts are halved at this many, so the percentile follows the traffic.
+
+  uint32_t _counts[HDR_STR_HEAP_SIZE_CLASSES] = {}; ///< Heaps larger than the last class count towards it.
+  uint32_t _samples                           = 0;
+  int _first_class                            = 0;
+};
+
+std::mutex sizers_mutex;
+std::vector<StrHeapSizer *> sizers;
+HdrStrHeapStats exited_threads_stats;
+
+thread_local StrHeapSizer str_heap_sizer;
+
+StrHeapSizer::StrHeapSizer()
+{
+  std::lock_guard<std::mutex> lock(sizers_mutex);
+  sizers.push_back(this);
+}
+
+StrHeapSizer::~StrHeapSizer()
+{
+  std::lock_guard<std::mutex> lock(sizers_mutex);
+  exited_threads_stats.demotions += demotions.load(std::memory_order_relaxed);
+  exited_threads_stats.coalesces += coalesces.load(std::memory_order_relaxed);
+  exited_threads_stats.evacuated_bytes += evacuated_bytes.load(std::memory_order_relaxed);
+  exited_threads_stats.wasted_bytes += wasted_bytes.load(std::memory_order_relaxed);
+  sizers.erase(std::find(sizers.begin(), sizers.end(), this));
+}
+
+void
+StrHeapSizer::record(int used_bytes)
+{
+  ++_counts[std::min(str_heap_size_class(used_bytes), HDR_STR_HEAP_SIZE_CLASSES - 1)];
+
+  if (++_samples >= DECAY_SAMPLES) {
+    _samples = 0;
+    for (uint32_t &count : _counts) {
+      count /= 2;
+      _samples += count;
+    }
+  }
+
+  uint32_t target = (_samples * PERCENTILE + 99) / 100;
+  uint32_t seen   = 0;
+  _first_class    = 0;
+  while (_first_class < HDR_STR_HEAP_SIZE_CLASSES - 1 && (seen += _counts[_first_class]) < target) {
+    ++_first_class;
+  }
+}
+} // namespace
+
+HdrStrHeapStats
+hdr_str_heap_stats()
+{
+  std::lock_guard<std::mutex> lock(sizers_mutex);
+  HdrStrHeapStats stats = exited_threads_stats;
+
+  for (StrHeapSizer const *sizer : sizers) {
+    stats.demotions += sizer->demotions.load(std::memory_order_relaxed);
+    stats.coalesces += sizer->coalesces.load(std::memory_order_relaxed);
+    stats.evacuated_bytes += sizer->evacuated_bytes.load(std::memory_order_relaxed);
+    stats.wasted_bytes += sizer->wasted_bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
 
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
@@ -118,7 +262,7 @@ new_HdrHeap(int size)
     size = HdrHeap::DEFAULT_SIZE;
     h    = static_cast<HdrHeap *>(THREAD_ALLOC(hdrHeapAllocator, this_ethread()));
   } else {
-    h = static_cast<HdrHeap *>(ats_malloc(size));
+    h = static_cast<HdrHeap *>(hdr_heap_malloc(size));
   }
 
   h->m_size = size;
@@ -136,14 +280,15 @@ new_HdrStrHeap(int requested_size)
   //  our calculations
 
   int alloc_size = requested_size + sizeof(HdrStrHeap);
+  int size_class = str_heap_size_class(alloc_size);
 
   HdrStrHeap *sh;
-  if (alloc_size <= HdrStrHeap::DEFAULT_SIZE) {
-    alloc_size = HdrStrHeap::DEFAULT_SIZE;
-    sh         = static_cast<HdrStrHeap *>(THREAD_ALLOC(strHeapAllocator, this_ethread()));
+  if (size_class < HDR_STR_HEAP_SIZE_CLASSES) {
+    alloc_size = HdrStrHeap::DEFAULT_SIZE << size_class;
+    sh         = static_cast<HdrStrHeap *>(THREAD_ALLOC(strHeapAllocator[size_class], this_ethread()));
   } else {
     alloc_size = ts::round_up<HdrStrHeap::DEFAULT_SIZE * 2>(alloc_size);
-    sh         = static_cast<HdrStrHeap *>(ats_malloc(alloc_size));
+    sh         = static_cast<HdrStrHeap *>(hdr_heap_malloc(alloc_size));
   }
 
   //    Debug("hdrs", "Allocated string heap in size %d", alloc_size);
@@ -169,6 +314,13 @@ HdrHeap::destroy()
     m_next->destroy();
   }
 
+  if (m_read_write_heap) {
+    str_heap_sizer.record(m_read_write_heap->m_heap_size - m_read_write_heap->m_free_size);
+    if (m_read_write_heap->refcount() == 1) {
+      stat_add(str_heap_sizer.wasted_bytes, m_read_write_heap->m_free_size);
+    }
+  }
+
   m_read_write_heap = nullptr;
   for (auto &i : m_ronly_heap) {
     i.m_ref_count_ptr = nullptr;
@@ -253,7 +405,7 @@ RETRY:
   // First check to see if we have a read/write
   //   string heap
   if (!m_read_write_heap) {
-    int next_size     = (last_size * 2) - sizeof(HdrStrHeap);
+    int next_size     = (last_size ? last_size * 2 : str_heap_sizer.first_heap_size()) - sizeof(HdrStrHeap);
     next_size         = next_size > nbytes ? next_size : nbytes;
     m_read_write_heap = new_HdrStrHeap(next_size);
   }
@@ -333,6 +485,7 @@ HdrHeap::demote_rw_str_heap()
 
       //          Debug("hdrs", "Demoted rw heap of %d size", m_read_write_heap->m_heap_size);
       m_read_write_heap = nullptr;
+      stat_add(str_heap_sizer.demotions, 1);
       return 0;
     }
   }
@@ -358,10 +511,14 @@ HdrHeap::coalesce_str_heaps(int incoming_size)
   ink_assert(incoming_size >= 0);
   ink_assert(m_writeable);
 
-  new_heap_size += required_space_for_evacuation();
+  int evacuated_size = required_space_for_evacuation();
+  new_heap_size += evacuated_size;
 
   HdrStrHeap *new_heap = new_HdrStrHeap(new_heap_size);
   evacuate_from_str_heaps(new_heap);
+  stat_add(str_heap_sizer.coalesces, 1);
+  stat_add(str_heap_sizer.evacuated_bytes, evacuated_size);
+  stat_add(str_heap_sizer.wasted_bytes, m_lost_string_space);
   m_lost_string_space = 0;
 
   // At this point none of the currently used string
@@ -1157,8 +1314,10 @@ HdrHeap::total_used_size() const
 void
 HdrStrHeap::free()
 {
-  if (m_heap_size == HdrStrHeap::DEFAULT_SIZE) {
-    THREAD_FREE(this, strHeapAllocator, this_thread());
+  int size_class = str_heap_size_class(m_heap_size);
+
+  if (size_class < HDR_STR_HEAP_SIZE_CLASSES) {
+    THREAD_FREE(this, strHeapAllocator[size_class], this_thread());
   } else {
     ats_free(this);
   }
@@ -504,4 +504,17 @@ HdrHeapSDKHandle::set(const HdrHeapSDKHandle *from)
 HdrStrHeap *new_HdrStrHeap(int requested_size);
 inkcoreapi HdrHeap *new_HdrHeap(int size = HdrHeap::DEFAULT_SIZE);
 
+/// Counts of string heap reorganizations, summed over all threads.
+struct HdrStrHeapStats {
+  int64_t demotions       = 0; ///< Full read/write string heaps demoted to read only.
+  int64_t coalesces       = 0; ///< Times the string heaps of a header were coalesced into a new one.
+  int64_t evacuated_bytes = 0; ///< Live string bytes copied by those coalesces.
+  int64_t wasted_bytes    = 0; ///< Dead strings dropped by coalesces plus space left unused in destroyed string heaps.
+};
+
+HdrStrHeapStats hdr_str_heap_stats();
+
+/// Allocate the heaps from their arena, if the arenas are enabled. Before any heap is allocated.
+void hdr_heap_init();
+
 void hdr_heap_test();
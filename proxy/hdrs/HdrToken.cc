@@ -22,7 +22,6 @@
  */
 
 #include "tscore/ink_platform.h"
-#include "tscore/HashFNV.h"
 #include "tscore/Diags.h"
 #include "tscore/ink_memory.h"
 #include <cstdio>
@@ -265,33 +264,36 @@ DFA *hdrtoken_strs_dfa = nullptr;
  *                                                                     *
  ***********************************************************************/
 
-#define HDRTOKEN_HASH_TABLE_SIZE 65536
+// The table is sized so that a seed which maps every commonly tokenized string to a slot of its own is found quickly. A
+// lookup is then one hash and one comparison against the string in the slot.
+#define HDRTOKEN_HASH_TABLE_SIZE 4096
+#define HDRTOKEN_HASH_MAX_SEEDS 4096
 
 struct HdrTokenHashBucket {
   const char *wks;
-  uint32_t hash;
+  int length;
 };
 
 HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_SIZE];
-
-/**
-  basic FNV hash
-**/
-#define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
+static uint32_t hdrtoken_hash_seed = 0;
 
 inline uint32_t
 hash_to_slot(uint32_t hash)
 {
-  return ((hash >> 15) ^ hash) & TINY_MASK(15);
+  return ((hash >> 16) ^ hash) & (HDRTOKEN_HASH_TABLE_SIZE - 1);
 }
 
+/**
+  case insensitive FNV-1a hash, with the offset basis perturbed by the seed
+**/
 inline uint32_t
-hdrtoken_hash(const unsigned char *string, unsigned int length)
+hdrtoken_hash(const unsigned char *string, unsigned int length, uint32_t seed)
 {
-  ATSHash32FNV1a fnv;
-  fnv.update(string, length, ATSHash::nocase());
-  fnv.final();
-  return fnv.get();
+  uint32_t hash = 0x811c9dc5 ^ (seed * 0x9e3779b9);
+  for (unsigned int i = 0; i < length; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(ParseRules::ink_tolower(string[i]))) * 0x01000193;
+  }
+  return hash;
 }
 
 /*-------------------------------------------------------------------------
@@ -375,34 +377,39 @@ void
 hdrtoken_hash_init()
 {
   uint32_t i;
-  int num_collisions;
-
-  memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
-  num_collisions = 0;
-
-  for (i = 0; i < static_cast<int> SIZEOF(_hdrtoken_commonly_tokenized_strs); i++) {
-    // convert the common string to the well-known token
-    unsigned const char *wks;
-    int wks_idx =
-      hdrtoken_tokenize_dfa(_hdrtoken_commonly_tokenized_strs[i], static_cast<int>(strlen(_hdrtoken_commonly_tokenized_strs[i])),
-                            reinterpret_cast<const char **>(&wks));
-    ink_release_assert(wks_idx >= 0);
-
-    uint32_t hash = hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx]);
-    uint32_t slot = hash_to_slot(hash);
-
-    if (hdrtoken_hash_table[slot].wks) {
-      printf("ERROR: hdrtoken_hash_table[%u] collision: '%s' replacing '%s'\n", slot, reinterpret_cast<const char *>(wks),
-             hdrtoken_hash_table[slot].wks);
-      ++num_collisions;
+
+  for (uint32_t seed = 0; seed < HDRTOKEN_HASH_MAX_SEEDS; ++seed) {
+    bool collided = false;
+
+    memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
+
+    for (i = 0; i < static_cast<int> SIZEOF(_hdrtoken_commonly_tokenized_strs); i++) {
+      // convert the common string to the well-known token
+      unsigned const char *wks;
+      int wks_idx =
+        hdrtoken_tokenize_dfa(_hdrtoken_commonly_tokenized_strs[i], static_cast<int>(strlen(_hdrtoken_commonly_tokenized_strs[i])),
+                              reinterpret_cast<const char **>(&wks));
+      ink_release_assert(wks_idx >= 0);
+
+      uint32_t slot = hash_to_slot(hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx], seed));
+
+      if (hdrtoken_hash_table[slot].wks) {
+        collided = true;
+        break;
+      }
+      hdrtoken_hash_table[slot].wks    = reinterpret_cast<const char *>(wks);
+      hdrtoken_hash_table[slot].length = hdrtoken_str_lengths[wks_idx];
     }
-    hdrtoken_hash_table[slot].wks  = reinterpret_cast<const char *>(wks);
-    hdrtoken_hash_table[slot].hash = hash;
-  }
 
-  if (num_collisions > 0) {
-    abort();
+    if (!collided) {
+      hdrtoken_hash_seed = seed;
+      return;
+    }
   }
+
+  // Only reachable if strings are added until no seed spreads them out, then HDRTOKEN_HASH_TABLE_SIZE has to grow.
+  printf("ERROR: no perfect hash seed for hdrtoken_hash_table of %d slots\n", HDRTOKEN_HASH_TABLE_SIZE);
+  abort();
 }
 
 /***********************************************************************
@@ -567,11 +574,13 @@ hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_ou
     return wks_idx;
   }
 
-  uint32_t hash = hdrtoken_hash(reinterpret_cast<const unsigned char *>(string), static_cast<unsigned int>(string_len));
+  uint32_t hash =
+    hdrtoken_hash(reinterpret_cast<const unsigned char *>(string), static_cast<unsigned int>(string_len), hdrtoken_hash_seed);
   uint32_t slot = hash_to_slot(hash);
 
+  // The hash is perfect over the well-known strings, so the string in the slot is the only possible match
   bucket = &(hdrtoken_hash_table[slot]);
-  if ((bucket->wks != nullptr) && (bucket->hash == hash) && (hdrtoken_wks_to_length(bucket->wks) == string_len)) {
+  if ((bucket->wks != nullptr) && (bucket->length == string_len) && (strncasecmp(bucket->wks, string, string_len) == 0)) {
     wks_idx = hdrtoken_wks_to_index(bucket->wks);
     if (wks_string_out) {
       *wks_string_out = bucket->wks;
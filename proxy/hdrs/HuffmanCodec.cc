@@ -72,20 +72,43 @@ static const huffman_entry huffman_table[] = {
 
 typedef struct node {
   node *left, *right;
-  char ascii_code;
+  uint16_t symbol;
+  uint8_t state;
   bool leaf_node;
 } Node;
 
-Node *HUFFMAN_TREE_ROOT;
+/*
+  The decoder is a state machine which consumes 4 bits at a time (like nghttp2). A state is an internal node of the Huffman tree,
+  and each entry says which state follows a 4-bit input and whether a symbol was completed on the way. Codes are at least 5 bits
+  long, so at most one symbol comes out of an input.
+ */
+enum HuffmanDecodeFlag : uint8_t {
+  HUFFMAN_DECODE_SYMBOL = 0x01, ///< A symbol was decoded
+  HUFFMAN_DECODE_ACCEPT = 0x02, ///< The input may end here, bits since the last symbol are a valid padding
+  HUFFMAN_DECODE_FAIL   = 0x04, ///< The input contains EOS
+};
+
+struct huffman_decode_entry {
+  uint8_t state;
+  uint8_t flags;
+  uint8_t symbol;
+};
+
+static constexpr int HUFFMAN_EOS          = 256;
+static constexpr int HUFFMAN_DECODE_STATE = 256; ///< There are 257 symbols, so there are 256 internal nodes
+
+static huffman_decode_entry huffman_decode_table[HUFFMAN_DECODE_STATE][16];
+static bool huffman_decode_table_ready = false;
 
 static Node *
 make_huffman_tree_node()
 {
-  Node *n       = static_cast<Node *>(ats_malloc(sizeof(Node)));
-  n->left       = nullptr;
-  n->right      = nullptr;
-  n->ascii_code = '\0';
-  n->leaf_node  = false;
+  Node *n      = static_cast<Node *>(ats_malloc(sizeof(Node)));
+  n->left      = nullptr;
+  n->right     = nullptr;
+  n->symbol    = 0;
+  n->state     = 0;
+  n->leaf_node = false;
   return n;
 }
 
@@ -94,7 +117,7 @@ make_huffman_tree()
 {
   Node *root = make_huffman_tree_node();
 
-  // insert leafs for each ascii code
+  // insert leafs for each ascii code and EOS
   for (unsigned i = 0; i < countof(huffman_table); i++) {
     uint32_t bit_len = huffman_table[i].bit_len;
     Node *current    = root;
@@ -113,8 +136,8 @@ make_huffman_tree()
       }
       bit_len--;
     }
-    current->ascii_code = i;
-    current->leaf_node  = true;
+    current->symbol    = i;
+    current->leaf_node = true;
   }
 
   return root;
@@ -133,111 +156,142 @@ free_huffman_tree(Node *node)
   ats_free(node);
 }
 
+// Number internal nodes in depth first order and remember which of them are a valid padding (all 1s and shorter than 8 bits)
+static void
+number_huffman_tree(Node *node, Node **states, bool *accept, int &n_states, int depth, bool all_ones)
+{
+  if (node->leaf_node) {
+    return;
+  }
+
+  node->state         = n_states;
+  states[n_states]    = node;
+  accept[node->state] = all_ones && depth < 8;
+  ++n_states;
+
+  number_huffman_tree(node->left, states, accept, n_states, depth + 1, false);
+  number_huffman_tree(node->right, states, accept, n_states, depth + 1, all_ones);
+}
+
+static void
+make_huffman_decode_table(Node *root)
+{
+  Node *states[HUFFMAN_DECODE_STATE];
+  bool accept[HUFFMAN_DECODE_STATE];
+  int n_states = 0;
+
+  number_huffman_tree(root, states, accept, n_states, 0, true);
+  ink_release_assert(n_states == HUFFMAN_DECODE_STATE);
+
+  for (int state = 0; state < HUFFMAN_DECODE_STATE; ++state) {
+    for (int input = 0; input < 16; ++input) {
+      huffman_decode_entry &entry = huffman_decode_table[state][input];
+      Node *current               = states[state];
+
+      entry = {0, 0, 0};
+      for (int bit = 3; bit >= 0; --bit) {
+        current = (input & (1 << bit)) ? current->right : current->left;
+        if (current->leaf_node) {
+          if (current->symbol == HUFFMAN_EOS) {
+            entry.flags = HUFFMAN_DECODE_FAIL;
+            break;
+          }
+          entry.flags |= HUFFMAN_DECODE_SYMBOL;
+          entry.symbol = current->symbol;
+          current      = root;
+        }
+      }
+
+      if (!(entry.flags & HUFFMAN_DECODE_FAIL)) {
+        entry.state = current->state;
+        if (accept[entry.state]) {
+          entry.flags |= HUFFMAN_DECODE_ACCEPT;
+        }
+      }
+    }
+  }
+}
+
 void
 hpack_huffman_init()
 {
-  if (!HUFFMAN_TREE_ROOT) {
-    HUFFMAN_TREE_ROOT = make_huffman_tree();
+  if (!huffman_decode_table_ready) {
+    Node *root = make_huffman_tree();
+    make_huffman_decode_table(root);
+    free_huffman_tree(root);
+    huffman_decode_table_ready = true;
   }
 }
 
 void
 hpack_huffman_fin()
 {
-  if (HUFFMAN_TREE_ROOT) {
-    free_huffman_tree(HUFFMAN_TREE_ROOT);
-  }
+  // The decode table is static, nothing to free
 }
 
 int64_t
 huffman_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
 {
-  char *dst_end             = dst_start;
-  uint8_t shift             = 7;
-  Node *current             = HUFFMAN_TREE_ROOT;
-  int byte_boundary_crossed = 0;
-  bool includes_zero        = false;
-
-  while (src_len) {
-    if (*src & (1 << shift)) {
-      current = current->right;
-    } else {
-      current       = current->left;
-      includes_zero = true;
-    }
+  char *dst     = dst_start;
+  uint8_t state = 0;
+  bool accept   = true;
 
-    if (current->leaf_node == true) {
-      *dst_end = current->ascii_code;
-      ++dst_end;
-      current               = HUFFMAN_TREE_ROOT;
-      byte_boundary_crossed = 0;
-      includes_zero         = false;
-    }
-    if (shift) {
-      --shift;
-    } else {
-      shift = 7;
-      ++src;
-      --src_len;
-      ++byte_boundary_crossed;
-    }
-    if (byte_boundary_crossed > 3) {
-      return -1;
+  for (uint32_t i = 0; i < src_len; ++i) {
+    // The upper 4 bits first
+    for (int shift = 4; shift >= 0; shift -= 4) {
+      const huffman_decode_entry &entry = huffman_decode_table[state][(src[i] >> shift) & 0x0f];
+      if (entry.flags & HUFFMAN_DECODE_FAIL) {
+        return -1;
+      }
+      if (entry.flags & HUFFMAN_DECODE_SYMBOL) {
+        *dst++ = entry.symbol;
+      }
+      state  = entry.state;
+      accept = entry.flags & HUFFMAN_DECODE_ACCEPT;
     }
   }
-  if (byte_boundary_crossed > 1) {
-    return -1;
-  }
-  if (includes_zero) {
+
+  // [RFC 7541] 5.2. Padding longer than 7 bits or not all 1s is a decoding error
+  if (!accept) {
     return -1;
   }
 
-  return dst_end - dst_start;
-}
-
-uint8_t *
-huffman_encode_append(uint8_t *dst, uint32_t src, int n = 0)
-{
-  for (int j = 3; j >= n; --j) {
-    *dst++ = ((src >> (8 * j)) & 255);
-  }
-  return dst;
+  return dst - dst_start;
 }
 
 int64_t
 huffman_encode(uint8_t *dst_start, const uint8_t *src, uint32_t src_len)
 {
   uint8_t *dst = dst_start;
-  // NOTE: The maximum length of Huffman Code is 30, thus using uint32_t as buffer.
-  uint32_t buf         = 0;
-  uint32_t remain_bits = 32;
+  // NOTE: The maximum length of Huffman Code is 30, so the accumulator never holds more than 61 bits.
+  uint64_t buf  = 0;
+  uint32_t bits = 0;
 
   for (uint32_t i = 0; i < src_len; ++i) {
-    const uint32_t hex     = huffman_table[src[i]].code_as_hex;
-    const uint32_t bit_len = huffman_table[src[i]].bit_len;
-
-    if (remain_bits > bit_len) {
-      remain_bits = remain_bits - bit_len;
-      buf |= hex << remain_bits;
-    } else if (remain_bits == bit_len) {
-      buf |= hex;
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = 32;
-      buf         = 0;
-    } else {
-      buf |= hex >> (bit_len - remain_bits);
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = (32 - (bit_len - remain_bits));
-      buf         = hex << remain_bits;
+    const huffman_entry &entry = huffman_table[src[i]];
+
+    buf = (buf << entry.bit_len) | entry.code_as_hex;
+    bits += entry.bit_len;
+
+    if (bits >= 32) {
+      bits -= 32;
+      uint32_t out = buf >> bits;
+      dst[0]       = out >> 24;
+      dst[1]       = out >> 16;
+      dst[2]       = out >> 8;
+      dst[3]       = out;
+      dst += 4;
     }
   }
 
-  dst = huffman_encode_append(dst, buf, remain_bits / 8);
+  while (bits >= 8) {
+    bits -= 8;
+    *dst++ = buf >> bits;
+  }
 
   // NOTE: Add padding w/ EOS
-  uint32_t pad_len = remain_bits % 8;
-  if (pad_len) {
-    *(dst - 1) |= 0xff >> (8 - pad_len);
+  if (bits) {
+    *dst++ = (buf << (8 - bits)) | (0xff >> bits);
   }
 
   return dst - dst_start;
@@ -443,6 +443,7 @@ mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index)
 inline void
 mime_hdr_init_accelerators_and_presence_bits(MIMEHdrImpl *mh)
 {
+  mh->m_field_name_bits      = 0;
   mh->m_presence_bits        = 0;
   mh->m_slot_accelerators[0] = 0xFFFFFFFF;
   mh->m_slot_accelerators[1] = 0xFFFFFFFF;
@@ -527,6 +528,53 @@ mime_hdr_unset_accelerators_and_presence_bits(MIMEHdrImpl *mh, MIMEField *field)
   }
 }
 
+/***********************************************************************
+ *                                                                     *
+ *                     F I E L D    N A M E    B I T S                 *
+ *                                                                     *
+ ***********************************************************************/
+
+// The presence bits only cover well-known fields that have a presence mask. m_field_name_bits covers every live field: the
+// low 31 bits are a presence bitmap over hashed field names and the top bit says whether the bitmap has been built. It is
+// built by the first lookup the accelerators can't answer, kept current as fields are attached and dropped when a field
+// is detached, since a bit can't be cleared while another name may share it. A clear bit proves a name is absent, a set
+// bit still needs the field list walk.
+#define MIME_FIELD_NAME_BITS_BUILT (1U << 31)
+
+inline uint32_t
+mime_field_name_bit(const char *name, int length)
+{
+  uint32_t hash = 0x811c9dc5;
+  for (int i = 0; i < length; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(ParseRules::ink_tolower(name[i]))) * 0x01000193;
+  }
+  return 1U << ((hash ^ (hash >> 16)) % 31);
+}
+
+static void
+mime_hdr_field_name_bits_build(MIMEHdrImpl *mh)
+{
+  uint32_t bits = MIME_FIELD_NAME_BITS_BUILT;
+
+  for (MIMEFieldBlockImpl *fblock = &(mh->m_first_fblock); fblock != nullptr; fblock = fblock->m_next) {
+    for (MIMEField *field = fblock->m_field_slots, *limit = field + fblock->m_freetop; field < limit; ++field) {
+      if (field->is_live()) {
+        bits |= mime_field_name_bit(field->m_ptr_name, field->m_len_name);
+      }
+    }
+  }
+  mh->m_field_name_bits = bits;
+}
+
+inline bool
+mime_hdr_field_name_maybe_present(MIMEHdrImpl *mh, const char *name, int length)
+{
+  if (!(mh->m_field_name_bits & MIME_FIELD_NAME_BITS_BUILT)) {
+    mime_hdr_field_name_bits_build(mh);
+  }
+  return (mh->m_field_name_bits & mime_field_name_bit(name, length)) != 0;
+}
+
 /// Reset data in the header.
 /// Clear all the presence bits and accelerators.
 /// Update all the m_wks_idx values, presence bits and accelerators.
@@ -1358,6 +1406,13 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
     // search by well-known string index or by case-insensitive string match //
     ///////////////////////////////////////////////////////////////////////////
 
+    if (!mime_hdr_field_name_maybe_present(mh, field_name_str, field_name_len)) {
+#if TRACK_FIELD_FIND_CALLS
+      Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): MISS (due to field name bits)", mh, field_name_len, field_name_str);
+#endif
+      return nullptr;
+    }
+
     MIMEField *f = _mime_hdr_field_list_search_by_wks(mh, token_info->wks_idx);
     ink_assert((f == nullptr) || f->is_live());
 #if TRACK_FIELD_FIND_CALLS
@@ -1366,6 +1421,13 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
 #endif
     return f;
   } else {
+    if (!mime_hdr_field_name_maybe_present(mh, field_name_str, field_name_len)) {
+#if TRACK_FIELD_FIND_CALLS
+      Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): MISS (due to field name bits)", mh, field_name_len, field_name_str);
+#endif
+      return nullptr;
+    }
+
     MIMEField *f = _mime_hdr_field_list_search_by_string(mh, field_name_str, field_name_len);
 
     ink_assert((f == nullptr) || f->is_live());
@@ -1493,6 +1555,9 @@ mime_hdr_field_attach(MIMEHdrImpl *mh, MIMEField *field, int check_for_dups, MIM
   }
 
   field->m_readiness = MIME_FIELD_SLOT_READINESS_LIVE;
+  if (mh->m_field_name_bits & MIME_FIELD_NAME_BITS_BUILT) {
+    mh->m_field_name_bits |= mime_field_name_bit(field->m_ptr_name, field->m_len_name);
+  }
 
   ////////////////////////////////////////////////////////////////////
   // now, attach the new field --- if there are dups, make sure the //
@@ -1620,8 +1685,9 @@ mime_hdr_field_detach(MIMEHdrImpl *mh, MIMEField *field, bool detach_all_dups)
   }
 
   // Field is now detached and alone
-  field->m_readiness = MIME_FIELD_SLOT_READINESS_DETACHED;
-  field->m_next_dup  = nullptr;
+  field->m_readiness    = MIME_FIELD_SLOT_READINESS_DETACHED;
+  field->m_next_dup     = nullptr;
+  mh->m_field_name_bits = 0;
 
   // Because we changed the values through detaching,update the cooked cache
   if (field->is_cooked()) {
@@ -2979,8 +3045,8 @@ mime_days_since_epoch_to_mdy(unsigned int days_since_jan_1_1970, int *m_return,
   mime_days_since_epoch_to_mdy_slowcase(days_since_jan_1_1970, m_return, d_return, y_return);
 }
 
-int
-mime_format_date(char *buffer, time_t value)
+static int
+mime_format_date_uncached(char *buffer, time_t value)
 {
   // must be 3 characters!
   static const char *daystrs[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
@@ -3101,6 +3167,40 @@ mime_format_date(char *buffer, time_t value)
   return buf - buffer; // not counting NUL
 }
 
+/*-------------------------------------------------------------------------
+
+  Dates formatted within the same minute differ only in the seconds, and
+  most are formatted for the current time, so the last minute formatted on
+  this thread is kept and only the two digits of the seconds are patched in.
+
+  -------------------------------------------------------------------------*/
+int
+mime_format_date(char *buffer, time_t value)
+{
+  struct FormattedMinute {
+    time_t minute = -1;
+    char date[MIME_FIXDATE_LENGTH + 1];
+  };
+  static thread_local FormattedMinute cache;
+
+  if (value < 0) {
+    return mime_format_date_uncached(buffer, value);
+  }
+
+  time_t minute = value - value % 60;
+  int sec       = static_cast<int>(value % 60);
+
+  if (minute != cache.minute) {
+    ink_release_assert(mime_format_date_uncached(cache.date, minute) == MIME_FIXDATE_LENGTH);
+    cache.minute = minute;
+  }
+  memcpy(buffer, cache.date, MIME_FIXDATE_LENGTH + 1);
+  buffer[23] = '0' + sec / 10;
+  buffer[24] = '0' + sec % 10;
+
+  return MIME_FIXDATE_LENGTH;
+}
+
 int32_t
 mime_parse_int(const char *buf, const char *end)
 {
@@ -3383,11 +3483,20 @@ mime_parse_date(const char *buf, const char *end)
   static const int DAYS_OFFSET = 25508;
   static const int days[12]    = {305, 336, -1, 30, 60, 91, 121, 152, 183, 213, 244, 274};
 
+  // Cached responses carry the same Date and Last-Modified values every time they are
+  // served, so the last fixed format date parsed on this thread is remembered.
+  struct ParsedFixdate {
+    char date[MIME_FIXDATE_LENGTH] = {0};
+    time_t value                   = 0;
+  };
+  static thread_local ParsedFixdate last_fixdate;
+
   struct tm tp;
   time_t t;
   int year;
   int month;
   int mday;
+  bool fixdate = false;
 
   if (!buf) {
     return static_cast<time_t>(0);
@@ -3410,11 +3519,16 @@ mime_parse_date(const char *buf, const char *end)
     if (!mime_parse_time(buf, end, &tp.tm_hour, &tp.tm_min, &tp.tm_sec)) {
       return static_cast<time_t>(0);
     }
-  } else if (end && (end - buf >= 29) && (buf[3] == ',')) {
-    if (!mime_parse_rfc822_date_fastcase(buf, end - buf, &tp)) {
-      return static_cast<time_t>(0);
-    }
+  } else if (end && (end - buf >= MIME_FIXDATE_LENGTH) && (buf[3] == ',') &&
+             memcmp(buf, last_fixdate.date, MIME_FIXDATE_LENGTH) == 0) {
+    return last_fixdate.value;
+  } else if (end && (end - buf >= MIME_FIXDATE_LENGTH) && (buf[3] == ',') &&
+             mime_parse_rfc822_date_fastcase(buf, end - buf, &tp)) {
+    fixdate = true;
   } else {
+    // Either not a fixed format date or one the fast case could not take, let the
+    // general parser have it.
+
     if (!mime_parse_day(buf, end, &tp.tm_wday)) {
       return static_cast<time_t>(0);
     }
@@ -3477,6 +3591,11 @@ mime_parse_date(const char *buf, const char *end)
 
   t = ((mday * 24 + tp.tm_hour) * 60 + tp.tm_min) * 60 + tp.tm_sec;
 
+  if (fixdate) {
+    memcpy(last_fixdate.date, buf, MIME_FIXDATE_LENGTH);
+    last_fixdate.value = t;
+  }
+
   return t;
 }
 
@@ -3771,6 +3890,8 @@ MIMEHdrImpl::unmarshal(intptr_t offset)
 {
   HDR_UNMARSHAL_PTR(m_fblock_list_tail, MIMEFieldBlockImpl, offset);
   m_first_fblock.unmarshal(offset);
+  // Headers cached before m_field_name_bits existed hold padding here
+  m_field_name_bits = 0;
 }
 
 void
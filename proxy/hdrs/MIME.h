@@ -252,7 +252,8 @@ struct MIMECooked {
  ***********************************************************************/
 
 struct MIMEHdrImpl : public HdrHeapObjImpl {
-  // HdrHeapObjImpl is 4 bytes, so this will result in 4 bytes padding
+  // HdrHeapObjImpl is 4 bytes, m_field_name_bits fills what would otherwise be padding
+  uint32_t m_field_name_bits;
   uint64_t m_presence_bits;
   uint32_t m_slot_accelerators[4];
 
@@ -783,6 +784,10 @@ int mime_format_int64(char *buf, int64_t val, size_t buf_len);
 
 void mime_days_since_epoch_to_mdy_slowcase(unsigned int days_since_jan_1_1970, int *m_return, int *d_return, int *y_return);
 void mime_days_since_epoch_to_mdy(unsigned int days_since_jan_1_1970, int *m_return, int *d_return, int *y_return);
+
+/// Length of an IMF-fixdate such as "Sun, 06 Nov 1994 08:49:37 GMT".
+constexpr int MIME_FIXDATE_LENGTH = 29;
+
 int mime_format_date(char *buffer, time_t value);
 
 int32_t mime_parse_int(const char *buf, const char *end = nullptr);
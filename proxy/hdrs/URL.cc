@@ -21,8 +21,10 @@
   limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <new>
+#include <thread>
 #include "tscore/ink_platform.h"
 #include "tscore/ink_memory.h"
 #include "tscore/TsBuffer.h"
@@ -216,6 +218,7 @@ url_create(HdrHeap *heap)
   url->m_url_type       = URL_TYPE_NONE;
   url->m_scheme_wks_idx = -1;
   url_clear_string_ref(url);
+  url_serial_renew(url);
   return url;
 }
 
@@ -228,6 +231,7 @@ url_clear(URLImpl *url_impl)
   obj_clear_data((HdrHeapObjImpl *)url_impl);
   url_impl->m_url_type       = URL_TYPE_NONE;
   url_impl->m_scheme_wks_idx = -1;
+  url_serial_renew(url_impl);
 }
 
 /*-------------------------------------------------------------------------
@@ -249,6 +253,7 @@ url_copy_onto(URLImpl *s_url, HdrHeap *s_heap, URLImpl *d_url, HdrHeap *d_heap,
 {
   if (s_url != d_url) {
     obj_copy_data((HdrHeapObjImpl *)s_url, (HdrHeapObjImpl *)d_url);
+    url_serial_renew(d_url);
     if (inherit_strs && (s_heap != d_heap)) {
       d_heap->inherit_string_heaps(s_heap);
     }
@@ -275,6 +280,7 @@ url_nuke_proxy_stuff(URLImpl *d_url)
 
   d_url->m_scheme_wks_idx = -1;
   d_url->m_port           = 0;
+  url_serial_renew(d_url);
 }
 
 /*-------------------------------------------------------------------------
@@ -598,6 +604,20 @@ void
 url_called_set(URLImpl *url)
 {
   url->m_clean = !url->m_ptr_printed_string;
+  url_serial_renew(url);
+}
+
+/**
+  Give @a url a serial it has not had recently. The serials come from a per thread counter
+  rather than the URL's own value, so that an object copied or cleared in place never ends
+  up with a serial a URL handle already cached a hash for.
+*/
+void
+url_serial_renew(URLImpl *url)
+{
+  static thread_local uint32_t serial = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+  url->m_serial = ++serial;
 }
 
 void
@@ -970,8 +990,11 @@ unescape_str(char *&buf, char *buf_e, const char *&str, const char *str_e, int &
         str += 1;
         state = 1;
       } else {
-        *buf++ = str[0];
-        str += 1;
+        // Copy the whole run of plain characters up to the next escape.
+        min_len  = std::min(static_cast<int>(str_e - str), static_cast<int>(buf_e - buf));
+        copy_len = static_cast<int>(ink_memcpy_until_char(buf, const_cast<char *>(str), min_len, '%') - str);
+        str += copy_len;
+        buf += copy_len;
       }
       break;
     case 1:
@@ -1105,14 +1128,6 @@ url_unescapify(Arena *arena, const char *str, int length)
  *                                                                     *
  ***********************************************************************/
 
-#define GETNEXT(label) \
-  {                    \
-    cur += 1;          \
-    if (cur >= end) {  \
-      goto label;      \
-    }                  \
-  }
-
 ParseResult
 url_parse_scheme(HdrHeap *heap, URLImpl *url, const char **start, const char *end, bool copy_strings_p)
 {
@@ -1362,6 +1377,24 @@ url_parse_internet(HdrHeap *heap, URLImpl *url, const char **start, char const *
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
+/**
+  Find the first of @a delimiters in [@a start, @a end), or @a end if there is none.
+
+  Each delimiter is located with memchr, which the C library vectorizes, and every hit
+  narrows the range for the next one. For the long paths and query strings of signed URLs
+  that is much cheaper than testing each character against every delimiter.
+*/
+static inline const char *
+url_find_delimiter(const char *start, const char *end, std::string_view delimiters)
+{
+  for (char c : delimiters) {
+    if (const char *found = static_cast<const char *>(memchr(start, c, end - start)); found != nullptr) {
+      end = found;
+    }
+  }
+  return end;
+}
+
 // empties params/query/fragment component
 
 ParseResult
@@ -1377,7 +1410,6 @@ url_parse_http(HdrHeap *heap, URLImpl *url, const char **start, const char *end,
   const char *query_end      = nullptr;
   const char *fragment_start = nullptr;
   const char *fragment_end   = nullptr;
-  char mask;
 
   err = url_parse_internet(heap, url, start, end, copy_strings, verify_host_characters);
   if (err < 0) {
@@ -1394,57 +1426,33 @@ url_parse_http(HdrHeap *heap, URLImpl *url, const char **start, const char *end,
   if (*cur == '/') {
     path_start = cur;
   }
-  mask = ';' & '?' & '#';
-parse_path2:
-  if ((*cur & mask) == mask) {
-    if (*cur == ';') {
-      path_end = cur;
-      goto parse_params1;
-    }
-    if (*cur == '?') {
-      path_end = cur;
-      goto parse_query1;
-    }
-    if (*cur == '#') {
-      path_end = cur;
-      goto parse_fragment1;
-    }
-  } else {
-    ink_assert((*cur != ';') && (*cur != '?') && (*cur != '#'));
+  cur = url_find_delimiter(cur, end, ";?#");
+  if (cur == end) {
+    goto done;
   }
-  GETNEXT(done);
-  goto parse_path2;
+  path_end = cur;
 
-parse_params1:
-  params_start = cur + 1;
-  GETNEXT(done);
-parse_params2:
-  if (*cur == '?') {
-    params_end = cur;
-    goto parse_query1;
-  }
-  if (*cur == '#') {
+  if (*cur == ';') {
+    params_start = cur + 1;
+    cur          = url_find_delimiter(params_start, end, "?#");
+    if (cur == end) {
+      goto done;
+    }
     params_end = cur;
-    goto parse_fragment1;
   }
-  GETNEXT(done);
-  goto parse_params2;
 
-parse_query1:
-  query_start = cur + 1;
-  GETNEXT(done);
-parse_query2:
-  if (*cur == '#') {
+  if (*cur == '?') {
+    query_start = cur + 1;
+    cur         = url_find_delimiter(query_start, end, "#");
+    if (cur == end) {
+      goto done;
+    }
     query_end = cur;
-    goto parse_fragment1;
   }
-  GETNEXT(done);
-  goto parse_query2;
 
-parse_fragment1:
-  fragment_start = cur + 1;
-  GETNEXT(done);
-  fragment_end = end;
+  ink_assert(*cur == '#');
+  fragment_start = ++cur;
+  fragment_end   = end;
 
 done:
   if (path_start) {
@@ -76,7 +76,9 @@ struct URLImpl : public HdrHeapObjImpl {
   uint32_t m_clean : 1;
   /// Whether the URI had an absolutely empty path, not even an initial '/'.
   uint32_t m_path_is_empty : 1;
-  // 8 bytes + 2 bits, will result in padding
+  /// Changes on every modification, lets URL handles tell whether their cached hash is stale.
+  uint32_t m_serial : 30;
+  // 8 bytes, will result in padding
 
   // Marshaling Functions
   int marshal(MarshalXlate *str_xlate, int num_xlate);
@@ -174,6 +176,7 @@ char *url_string_get(URLImpl *url, Arena *arena, int *length, HdrHeap *heap, boo
 void url_clear_string_ref(URLImpl *url);
 char *url_string_get_ref(HdrHeap *heap, URLImpl *url, int *length, bool normalized = false);
 void url_called_set(URLImpl *url);
+void url_serial_renew(URLImpl *url);
 char *url_string_get_buf(URLImpl *url, char *dstbuf, int dstbuf_size, int *length);
 
 void url_CryptoHash_get(const URLImpl *url, CryptoHash *hash, cache_generation_t generation = -1);
@@ -232,6 +235,12 @@ class URL : public HdrHeapSDKHandle
 public:
   URLImpl *m_url_impl = nullptr;
 
+  // Last cache key computed by hash_get(), valid while the impl and its serial are unchanged.
+  mutable CryptoHash m_hash;
+  mutable const URLImpl *m_hash_impl           = nullptr;
+  mutable uint32_t m_hash_serial               = 0;
+  mutable cache_generation_t m_hash_generation = -1;
+
   URL();
   ~URL();
 
@@ -472,7 +481,13 @@ inline void
 URL::hash_get(CryptoHash *hash, cache_generation_t generation) const
 {
   ink_assert(valid());
-  url_CryptoHash_get(m_url_impl, hash, generation);
+  if (m_hash_impl != m_url_impl || m_hash_serial != m_url_impl->m_serial || m_hash_generation != generation) {
+    url_CryptoHash_get(m_url_impl, &m_hash, generation);
+    m_hash_impl       = m_url_impl;
+    m_hash_serial     = m_url_impl->m_serial;
+    m_hash_generation = generation;
+  }
+  *hash = m_hash;
 }
 
 /*-------------------------------------------------------------------------
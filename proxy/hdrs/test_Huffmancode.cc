@@ -134,13 +134,57 @@ values_test()
     encoded_mapped.y[2] = encoded.y[1];
     encoded_mapped.y[3] = encoded.y[0];
 
-    int bytes        = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    int bytes = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    if (i / 2 == 256) {
+      // EOS must be treated as a decoding error
+      assert(bytes == -1);
+      continue;
+    }
     char ascii_value = i / 2;
     assert(dst_start[0] == ascii_value);
     assert(bytes == 1);
   }
 }
 
+void
+padding_test()
+{
+  char dst_start[8];
+
+  // "0" (00000) with 3 bits of padding
+  assert(huffman_decode(dst_start, (const uint8_t *)"\x07", 1) == 1);
+  assert(dst_start[0] == '0');
+  // padding is not all 1s
+  assert(huffman_decode(dst_start, (const uint8_t *)"\x06", 1) == -1);
+  // padding is longer than 7 bits
+  assert(huffman_decode(dst_start, (const uint8_t *)"\x07\xff", 2) == -1);
+  // "302" followed by a truncated code
+  assert(huffman_decode(dst_start, (const uint8_t *)"\x64\x02", 2) == 3);
+  assert(huffman_decode(dst_start, (const uint8_t *)"\x64", 1) == -1);
+}
+
+void
+round_trip_test()
+{
+  uint8_t src[256];
+  uint8_t encoded[256 * 4];
+  char decoded[256];
+
+  for (int i = 0; i < 1000; i++) {
+    uint32_t src_len = lrand48() % sizeof(src);
+    for (uint32_t j = 0; j < src_len; j++) {
+      // coverity[dont_call]
+      src[j] = lrand48();
+    }
+
+    int64_t encoded_len = huffman_encode(encoded, src, src_len);
+    assert(encoded_len >= 0);
+    int64_t decoded_len = huffman_decode(decoded, encoded, encoded_len);
+    assert(decoded_len == src_len);
+    assert(memcmp(src, decoded, src_len) == 0);
+  }
+}
+
 // NOTE: Test data from "C.6.1 First Response" in RFC 7541.
 const static struct {
   uint8_t *src;
@@ -180,9 +224,11 @@ main()
     random_test();
   }
   values_test();
-
-  hpack_huffman_fin();
+  padding_test();
 
   encode_test();
+  round_trip_test();
+
+  hpack_huffman_fin();
   return 0;
 }
@@ -0,0 +1,208 @@
+/** @file
+
+   Catch-based benchmarks for header parsing, marshaling and string coding
+
+   @section license License
+
+   Licensed to the Apache Software Foundation (ASF) under one or more contributor license agreements.
+   See the NOTICE file distributed with this work for additional information regarding copyright
+   ownership.  The ASF licenses this file to you under the Apache License, Version 2.0 (the
+   "License"); you may not use this file except in compliance with the License.  You may obtain a
+   copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software distributed under the License
+   is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+   or implied. See the License for the specific language governing permissions and limitations under
+   the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "HTTP.h"
+#include "HuffmanCodec.h"
+#include "XPACK.h"
+
+#include "benchmark_corpus.h"
+
+namespace
+{
+ParseResult
+parse_message(HTTPHdr &hdr, std::string_view message)
+{
+  HTTPParser parser;
+  const char *start = message.data();
+  const char *end   = message.data() + message.size();
+  ParseResult result;
+
+  http_parser_init(&parser);
+  if (hdr.type_get() == HTTP_TYPE_REQUEST) {
+    result = hdr.parse_req(&parser, &start, end, true);
+  } else {
+    result = hdr.parse_resp(&parser, &start, end, true);
+  }
+  http_parser_clear(&parser);
+
+  return result;
+}
+
+// The field values of the whole corpus, the input of the string coders
+template <size_t N>
+void
+collect_values(std::vector<std::string> &values, const std::string_view (&messages)[N], HTTPType type)
+{
+  for (std::string_view message : messages) {
+    HTTPHdr hdr;
+    hdr.create(type);
+    REQUIRE(parse_message(hdr, message) == PARSE_RESULT_DONE);
+
+    MIMEFieldIter iter;
+    for (MIMEField *field = hdr.iter_get_first(&iter); field != nullptr; field = hdr.iter_get_next(&iter)) {
+      values.emplace_back(field->value_get());
+    }
+    hdr.destroy();
+  }
+}
+} // namespace
+
+TEST_CASE("HdrParseBenchmark", "[proxy][benchmark]")
+{
+  BENCHMARK("http_parser_parse_req")
+  {
+    int fields = 0;
+    for (std::string_view message : benchmark_corpus::requests) {
+      HTTPHdr hdr;
+      hdr.create(HTTP_TYPE_REQUEST);
+      parse_message(hdr, message);
+      fields += hdr.fields_count();
+      hdr.destroy();
+    }
+    return fields;
+  };
+
+  BENCHMARK("http_parser_parse_resp")
+  {
+    int fields = 0;
+    for (std::string_view message : benchmark_corpus::responses) {
+      HTTPHdr hdr;
+      hdr.create(HTTP_TYPE_RESPONSE);
+      parse_message(hdr, message);
+      fields += hdr.fields_count();
+      hdr.destroy();
+    }
+    return fields;
+  };
+
+  // The request targets alone, through the URL parser
+  std::vector<std::string_view> targets;
+  for (std::string_view message : benchmark_corpus::requests) {
+    std::string_view::size_type start = message.find(' ') + 1;
+    targets.push_back(message.substr(start, message.find(' ', start) - start));
+  }
+
+  BENCHMARK("url_parse")
+  {
+    int length = 0;
+    for (std::string_view target : targets) {
+      HdrHeap *heap = new_HdrHeap();
+      URL url;
+      url.create(heap);
+      url.parse(target);
+      length += url.length_get();
+      heap->destroy();
+    }
+    return length;
+  };
+}
+
+TEST_CASE("HdrHeapMarshalBenchmark", "[proxy][benchmark]")
+{
+  for (std::string_view message : benchmark_corpus::responses) {
+    HTTPHdr hdr;
+    hdr.create(HTTP_TYPE_RESPONSE);
+    REQUIRE(parse_message(hdr, message) == PARSE_RESULT_DONE);
+
+    int size = hdr.m_heap->marshal_length();
+    std::unique_ptr<char[]> image(new char[size]);
+    std::unique_ptr<char[]> work(new char[size]);
+    int length = hdr.m_heap->marshal(image.get(), size);
+    REQUIRE(length > 0);
+
+    RefCountObj ref;
+    // Pretend to pin the buffer with a refcount.
+    ref.refcount_inc();
+
+    BENCHMARK("HdrHeap::marshal " + std::to_string(hdr.fields_count()) + " fields")
+    {
+      return hdr.m_heap->marshal(work.get(), size);
+    };
+
+    // Unmarshaling rewrites the image in place, so every run starts from a fresh copy of it.
+    BENCHMARK("HdrHeap::unmarshal " + std::to_string(hdr.fields_count()) + " fields")
+    {
+      HTTPHdr copy;
+      memcpy(work.get(), image.get(), length);
+      return copy.unmarshal(work.get(), length, &ref);
+    };
+
+    hdr.destroy();
+  }
+}
+
+TEST_CASE("HuffmanBenchmark", "[proxy][benchmark]")
+{
+  std::vector<std::string> values;
+  collect_values(values, benchmark_corpus::requests, HTTP_TYPE_REQUEST);
+  collect_values(values, benchmark_corpus::responses, HTTP_TYPE_RESPONSE);
+
+  size_t total = 0;
+  for (std::string const &value : values) {
+    total += value.size();
+  }
+
+  std::unique_ptr<uint8_t[]> encoded(new uint8_t[total * 4]);
+  std::unique_ptr<uint8_t[]> scratch(new uint8_t[total * 4]);
+  std::unique_ptr<char[]> decoded(new char[total * 2]);
+  std::vector<std::pair<const uint8_t *, int64_t>> codes;
+  uint8_t *cursor = encoded.get();
+  for (std::string const &value : values) {
+    int64_t length = huffman_encode(cursor, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+    REQUIRE(length >= 0);
+    codes.emplace_back(cursor, length);
+    cursor += length;
+  }
+
+  BENCHMARK("huffman_encode")
+  {
+    int64_t length = 0;
+    for (std::string const &value : values) {
+      length += huffman_encode(scratch.get(), reinterpret_cast<const uint8_t *>(value.data()), value.size());
+    }
+    return length;
+  };
+
+  BENCHMARK("huffman_decode")
+  {
+    int64_t length = 0;
+    for (auto const &[code, code_length] : codes) {
+      length += huffman_decode(decoded.get(), code, code_length);
+    }
+    return length;
+  };
+
+  BENCHMARK("xpack_encode_string")
+  {
+    int64_t length = 0;
+    for (std::string const &value : values) {
+      length += xpack_encode_string(scratch.get(), scratch.get() + total * 4, value.data(), value.size());
+    }
+    return length;
+  };
+}
@@ -130,3 +130,27 @@ TEST_CASE("HdrHeap", "[proxy][hdrheap]")
   // Clean up
   heap->destroy();
 }
+
+TEST_CASE("HdrStrHeapSizing", "[proxy][hdrheap]")
+{
+  // String heaps come in power of two size classes
+  HdrStrHeap *str_heap = new_HdrStrHeap(3000);
+  CHECK(str_heap->m_heap_size == 4096);
+  str_heap->free();
+
+  // Once most headers on this thread need an 8K string heap, new headers start with one
+  char buf[6000];
+  memset(buf, 'a', sizeof(buf));
+  for (int i = 0; i < 1024; ++i) {
+    HdrHeap *heap = new_HdrHeap();
+    URLImpl *url  = url_create(heap);
+    url_path_set(heap, url, buf, sizeof(buf), true);
+    heap->destroy();
+  }
+
+  HdrHeap *heap = new_HdrHeap();
+  URLImpl *url  = url_create(heap);
+  url_path_set(heap, url, "/", 1, true);
+  CHECK(heap->m_read_write_heap->m_heap_size == 8192);
+  heap->destroy();
+}
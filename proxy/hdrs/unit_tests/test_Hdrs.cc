@@ -91,6 +91,134 @@ TEST_CASE("HdrTestHttpParse", "[proxy][hdrtest]")
   }
 }
 
+// The request line fast path must give the same results as the slow path, which the extra spaces force
+TEST_CASE("HdrTestHttpParseRequestLine", "[proxy][hdrtest]")
+{
+  struct Test {
+    ts::TextView fast;
+    ts::TextView slow;
+    const char *method;
+    int method_wks_idx;
+  };
+  static const std::array<Test, 5> tests = {{
+    {"GET /index.html HTTP/1.1\r\n\r\n", "GET  /index.html  HTTP/1.1\r\n\r\n", "GET", hdrtoken_wks_to_index(HTTP_METHOD_GET)},
+    {"POST /index.html HTTP/1.1\r\n\r\n", "POST  /index.html  HTTP/1.1\r\n\r\n", "POST", hdrtoken_wks_to_index(HTTP_METHOD_POST)},
+    {"OPTIONS /index.html HTTP/1.1\r\n\r\n", "OPTIONS  /index.html  HTTP/1.1\r\n\r\n", "OPTIONS",
+     hdrtoken_wks_to_index(HTTP_METHOD_OPTIONS)},
+    {"GETX /index.html HTTP/1.1\r\n\r\n", "GETX  /index.html  HTTP/1.1\r\n\r\n", "GETX", -1},
+    {"PROPFIND /index.html HTTP/1.0\r\n\r\n", "PROPFIND  /index.html  HTTP/1.0\r\n\r\n", "PROPFIND", -1},
+  }};
+
+  HTTPParser parser;
+
+  http_parser_init(&parser);
+
+  for (auto const &test : tests) {
+    for (ts::TextView msg : {test.fast, test.slow}) {
+      HTTPHdr req_hdr;
+      HdrHeap *heap = new_HdrHeap(HdrHeap::DEFAULT_SIZE + 64); // extra to prevent proxy allocation.
+
+      req_hdr.create(HTTP_TYPE_REQUEST, heap);
+
+      http_parser_clear(&parser);
+
+      auto start = msg.data();
+      REQUIRE(req_hdr.parse_req(&parser, &start, msg.data_end(), true) == PARSE_RESULT_DONE);
+
+      int len;
+      const char *str = req_hdr.method_get(&len);
+      CHECK(ts::TextView(str, len) == ts::TextView(test.method, strlen(test.method)));
+      CHECK(req_hdr.method_get_wksidx() == test.method_wks_idx);
+      str = req_hdr.url_get()->path_get(&len);
+      CHECK(ts::TextView(str, len) == "index.html");
+      CHECK(req_hdr.version_get() == HTTPVersion(1, msg.find("HTTP/1.1") == ts::TextView::npos ? 0 : 1));
+
+      req_hdr.destroy();
+    }
+  }
+}
+
+// Every commonly tokenized string must be found in any case, and nothing that merely hashes alike may match
+TEST_CASE("HdrTokenTokenize", "[proxy][hdrtoken]")
+{
+  struct Test {
+    ts::TextView text;
+    const char *wks;
+  };
+  static const std::array<Test, 8> tests = {{
+    {"Content-Length", MIME_FIELD_CONTENT_LENGTH},
+    {"content-length", MIME_FIELD_CONTENT_LENGTH},
+    {"CONTENT-LENGTH", MIME_FIELD_CONTENT_LENGTH},
+    {"Accept", MIME_FIELD_ACCEPT},
+    {"Accept-Ranges", MIME_FIELD_ACCEPT_RANGES},
+    {"Content-Lengtx", nullptr},
+    {"Accep", nullptr},
+    {"X-Not-A-Well-Known-String", nullptr},
+  }};
+
+  for (auto const &test : tests) {
+    const char *wks = nullptr;
+    int idx         = hdrtoken_tokenize(test.text.data(), test.text.size(), &wks);
+    if (test.wks) {
+      CHECK(idx == hdrtoken_wks_to_index(test.wks));
+      CHECK(wks == test.wks);
+    } else {
+      CHECK(idx == -1);
+    }
+  }
+}
+
+// A copied header lands in one heap block, however many field blocks it has
+TEST_CASE("HdrTestHttpCopyHeap", "[proxy][hdrtest]")
+{
+  HTTPHdr src;
+  src.create(HTTP_TYPE_REQUEST);
+
+  char name[32];
+  for (int i = 0; i < 64; ++i) {
+    int len = snprintf(name, sizeof(name), "X-Field-%d", i);
+    src.value_set(name, len, "value", 5);
+  }
+  REQUIRE(src.m_mime->m_first_fblock.m_next != nullptr);
+
+  HTTPHdr dst;
+  dst.copy(&src);
+
+  CHECK(dst.m_heap->m_next == nullptr);
+  CHECK(dst.m_heap->m_size > static_cast<uint32_t>(HdrHeap::DEFAULT_SIZE));
+  CHECK(dst.fields_count() == 64);
+  CHECK(dst.value_get(std::string_view{"X-Field-63"}) == "value");
+
+  dst.destroy();
+  src.destroy();
+}
+
+// Dates come from the per thread caches without changing how they read
+TEST_CASE("HdrTestDateCache", "[proxy][hdrtest]")
+{
+  static const time_t t = 784111777; // Sun, 06 Nov 1994 08:49:37 GMT
+  char buffer[MIME_FIXDATE_LENGTH + 1];
+
+  CHECK(mime_format_date(buffer, t) == MIME_FIXDATE_LENGTH);
+  CHECK(std::string_view{buffer} == "Sun, 06 Nov 1994 08:49:37 GMT");
+  mime_format_date(buffer, t + 1);
+  CHECK(std::string_view{buffer} == "Sun, 06 Nov 1994 08:49:38 GMT");
+  mime_format_date(buffer, t + 23);
+  CHECK(std::string_view{buffer} == "Sun, 06 Nov 1994 08:50:00 GMT");
+  mime_format_date(buffer, t);
+  CHECK(std::string_view{buffer} == "Sun, 06 Nov 1994 08:49:37 GMT");
+
+  std::string_view fixdate{"Sun, 06 Nov 1994 08:49:37 GMT"};
+  CHECK(mime_parse_date(fixdate.data(), fixdate.data() + fixdate.size()) == t);
+  CHECK(mime_parse_date(fixdate.data(), fixdate.data() + fixdate.size()) == t);
+  std::string_view later{"Sun, 06 Nov 1994 08:49:38 GMT"};
+  CHECK(mime_parse_date(later.data(), later.data() + later.size()) == t + 1);
+
+  // Long enough for the fast case but not laid out for it, the general parser takes it
+  std::string_view loose{"Sun, 6 Nov 1994 08:49:37 GMT  "};
+  CHECK(mime_parse_date(loose.data(), loose.data() + loose.size()) == t);
+}
+
 TEST_CASE("MIMEScanner_fragments", "[proxy][mimescanner_fragments]")
 {
   constexpr ts::TextView const message = "GET /index.html HTTP/1.0\r\n";
@@ -19,6 +19,8 @@
  */
 
 #include <cstdio>
+#include <random>
+#include <string>
 
 #include "catch.hpp"
 
@@ -483,3 +485,182 @@ TEST_CASE("UrlParse", "[proxy][parseurl]")
     test_parse(test_case, URL_PARSE_REGEX);
   }
 }
+
+TEST_CASE("UrlHashCached", "[proxy][urlhash]")
+{
+  HdrHeap *heap = new_HdrHeap();
+  URL url;
+  URL alias;
+  URL other;
+  CryptoHash hash, again, fresh;
+
+  url.create(heap);
+  REQUIRE(url.parse("http://example.com/a/path") == PARSE_RESULT_DONE);
+  url.hash_get(&hash);
+  url.hash_get(&again);
+  CHECK(hash == again);
+
+  // A change through another handle on the same object must not be masked by the cached hash.
+  alias.copy_shallow(&url);
+  alias.path_set("other/path", 10);
+  url.hash_get(&again);
+  CHECK(hash != again);
+  alias.hash_get(&fresh);
+  CHECK(again == fresh);
+
+  // The generation is part of the key.
+  url.hash_get(&fresh, 1);
+  CHECK(again != fresh);
+
+  // Copying onto the object in place invalidates it as well.
+  other.create(heap);
+  REQUIRE(other.parse("http://example.com/a/path") == PARSE_RESULT_DONE);
+  url.copy(&other);
+  url.hash_get(&again);
+  CHECK(hash == again);
+
+  heap->destroy();
+}
+
+namespace
+{
+// unescape_str() as it was before it copied runs of plain characters in bulk, kept as the
+// reference the current implementation is checked against.
+void
+unescape_str_reference(char *&buf, char *buf_e, const char *&str, const char *str_e, int &state)
+{
+  int buf_len = static_cast<int>(buf_e - buf);
+  int str_len = static_cast<int>(str_e - str);
+  int min_len = (str_len < buf_len ? str_len : buf_len);
+  int copy_len;
+
+  for (copy_len = 0; copy_len < min_len && str[copy_len] != '%'; ++copy_len) {
+    buf[copy_len] = str[copy_len];
+  }
+  str += copy_len;
+  buf += copy_len;
+  if (copy_len == min_len) {
+    return;
+  }
+
+  while (str < str_e && (buf != buf_e)) {
+    switch (state) {
+    case 0:
+      if (str[0] == '%') {
+        str += 1;
+        state = 1;
+      } else {
+        *buf++ = str[0];
+        str += 1;
+      }
+      break;
+    case 1:
+      if (ParseRules::is_hex(str[0])) {
+        str += 1;
+        state = 2;
+      } else {
+        *buf++ = str[-1];
+        state  = 0;
+      }
+      break;
+    case 2:
+      if (ParseRules::is_hex(str[0])) {
+        int tmp;
+
+        if (ParseRules::is_alpha(str[-1])) {
+          tmp = (ParseRules::ink_toupper(str[-1]) - 'A' + 10) * 16;
+        } else {
+          tmp = (str[-1] - '0') * 16;
+        }
+        if (ParseRules::is_alpha(str[0])) {
+          tmp += (ParseRules::ink_toupper(str[0]) - 'A' + 10);
+        } else {
+          tmp += str[0] - '0';
+        }
+
+        *buf++ = tmp;
+        str += 1;
+        state = 0;
+      } else {
+        *buf++ = str[-2];
+        state  = 3;
+      }
+      break;
+    case 3:
+      *buf++ = str[-1];
+      state  = 0;
+      break;
+    }
+  }
+}
+
+// Decode @a input through an output buffer of @a buf_size bytes, flushing it whenever it fills
+// the way url_CryptoHash_get() does, so that escapes split across calls are exercised too.
+template <typename F>
+std::string
+unescape_chunked(F &&unescape, const std::string &input, size_t buf_size)
+{
+  std::string out;
+  char buffer[64];
+  const char *str   = input.data();
+  const char *str_e = str + input.size();
+  int state         = 0;
+
+  while (str < str_e) {
+    char *p = buffer;
+    unescape(p, buffer + buf_size, str, str_e, state);
+    out.append(buffer, p - buffer);
+  }
+  return out;
+}
+} // namespace
+
+TEST_CASE("UrlUnescapeFuzz", "[proxy][urlunescape]")
+{
+  static const char alphabet[] = "%%%0aF9g/?#Z";
+  std::mt19937 rng(1717);
+
+  for (int i = 0; i < 20000; ++i) {
+    std::string input(rng() % 96, ' ');
+    for (char &c : input) {
+      c = alphabet[rng() % (sizeof(alphabet) - 1)];
+    }
+    size_t buf_size = 1 + rng() % 64;
+
+    std::string expected = unescape_chunked(unescape_str_reference, input, buf_size);
+    std::string actual   = unescape_chunked(unescape_str, input, buf_size);
+    if (expected != actual) {
+      std::printf("unescape \"%s\" through %zu bytes: expected \"%s\", got \"%s\"\n", input.c_str(), buf_size, expected.c_str(),
+                  actual.c_str());
+      CHECK(false);
+    }
+  }
+}
+
+TEST_CASE("UrlParseLongComponents", "[proxy][parseurl]")
+{
+  std::string path(2048, 'p');
+  std::string query(3000, 'q');
+  path[100]  = '/';
+  query[500] = '&';
+  query[900] = '?';
+  query[901] = ';';
+  std::string input = "http://example.com/" + path + ";type=a?" + query + "#frag";
+
+  HdrHeap *heap = new_HdrHeap();
+  URL url;
+  int length;
+
+  url.create(heap);
+  REQUIRE(url.parse(input) == PARSE_RESULT_DONE);
+  const char *value = url.path_get(&length);
+  CHECK(std::string(value, length) == path);
+  value = url.params_get(&length);
+  CHECK(std::string(value, length) == "type=a");
+  value = url.query_get(&length);
+  CHECK(std::string(value, length) == query);
+  value = url.fragment_get(&length);
+  CHECK(std::string(value, length) == "frag");
+
+  heap->destroy();
+}
@@ -247,3 +247,44 @@ TEST_CASE("MimeParsers", "[proxy][mimeparsers]")
   std::printf("Date1: %d\n", d1);
   std::printf("Date2: %d\n", d2);
 }
+
+TEST_CASE("MimeFieldFindAllFields", "[proxy][mime]")
+{
+  MIMEHdr hdr;
+  hdr.create(NULL);
+
+  // Enough fields to spill out of the inline field block, most of them without a well-known name
+  char name[32];
+  for (int i = 0; i < 40; ++i) {
+    int len = snprintf(name, sizeof(name), "X-Custom-%d", i);
+    hdr.value_set(name, len, "v", 1);
+  }
+  hdr.value_set("Content-Length", 14, "10", 2);
+  hdr.value_set("Via", 3, "1.1 ats", 7);
+
+  for (int i = 0; i < 40; ++i) {
+    int len = snprintf(name, sizeof(name), "x-CUSTOM-%d", i);
+    CHECK(hdr.field_find(name, len) != nullptr);
+  }
+  CHECK(hdr.field_find("content-length", 14) != nullptr);
+  CHECK(hdr.field_find("VIA", 3) != nullptr);
+  CHECK(hdr.field_find("X-Custom-40", 11) == nullptr);
+  CHECK(hdr.field_find("Age", 3) == nullptr);
+
+  // Lookups after a delete must not see the removed field, lookups after an add must see the new one
+  hdr.field_delete("X-Custom-7", 10);
+  CHECK(hdr.field_find("X-Custom-7", 10) == nullptr);
+  CHECK(hdr.field_find("X-Custom-8", 10) != nullptr);
+  hdr.value_set("X-Added", 7, "v", 1);
+  CHECK(hdr.field_find("x-added", 7) != nullptr);
+
+  // A copy shares the same fields
+  MIMEHdr copy;
+  copy.create(NULL);
+  copy.copy(&hdr);
+  CHECK(copy.field_find("X-Custom-39", 11) != nullptr);
+  CHECK(copy.field_find("X-Custom-7", 10) == nullptr);
+
+  copy.destroy();
+  hdr.destroy();
+}
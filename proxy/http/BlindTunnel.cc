@@ -0,0 +1,272 @@
+/** @file
+
+  Blind tunnels of client connections to their origin, without a transaction
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "BlindTunnel.h"
+#include "HttpConfig.h"
+#include "HttpTransact.h"
+#include "HTTP.h"
+#include "InkAPIInternal.h"
+#include "P_Net.h"
+#include "P_SSLNetVConnection.h"
+#include "I_OneWayTunnel.h"
+#include "P_HostDB.h"
+
+ClassAllocator<BlindTunnel> blindTunnelAllocator("blindTunnelAllocator");
+
+namespace
+{
+// The hooks a transaction runs for a blind tunnel, a plugin on any of them needs the HttpSM.
+const TSHttpHookID TUNNEL_HOOKS[] = {TS_HTTP_SSN_START_HOOK,  TS_HTTP_TXN_START_HOOK, TS_HTTP_PRE_REMAP_HOOK,
+                                     TS_HTTP_POST_REMAP_HOOK, TS_HTTP_OS_DNS_HOOK,    TS_HTTP_TXN_CLOSE_HOOK,
+                                     TS_HTTP_SSN_CLOSE_HOOK};
+} // namespace
+
+bool
+BlindTunnel::eligible(NetVConnection *netvc, const HttpSessionAccept::Options *options, const IpAllow::ACL &acl)
+{
+  if (netvc->attributes != HttpProxyPort::TRANSPORT_BLIND_TUNNEL || options->f_outbound_transparent ||
+      !acl.isMethodAllowed(HTTP_WKSIDX_CONNECT)) {
+    return false;
+  }
+
+  // The origin connection limits need a transaction to wait for a connection.
+  HttpConfigParams *params = HttpConfig::acquire();
+  const auto &conntrack    = params->oride.outbound_conntrack;
+  bool enabled             = params->blind_tunnel_fast_path && conntrack.max == 0 && conntrack.min == 0;
+  HttpConfig::release(params);
+  if (!enabled) {
+    return false;
+  }
+
+  for (TSHttpHookID id : TUNNEL_HOOKS) {
+    if (http_global_hooks->has_hooks_for(id)) {
+      return false;
+    }
+  }
+
+  // A forward or partial blind route talks TLS with the client or with the origin, the HttpSM does that.
+  if (SSLNetVConnection *ssl_vc = dynamic_cast<SSLNetVConnection *>(netvc)) {
+    if (ssl_vc->decrypt_tunnel()) {
+      return false;
+    }
+    if (!ssl_vc->has_tunnel_destination()) {
+      const char *server_name = ssl_vc->get_server_name();
+      return server_name && *server_name && strlen(server_name) <= MAXDNAME;
+    }
+    return strlen(ssl_vc->get_tunnel_host()) <= MAXDNAME;
+  }
+  return true;
+}
+
+void
+BlindTunnel::start(NetVConnection *netvc, MIOBuffer *iobuf, IOBufferReader *reader, const HttpSessionAccept::Options *options)
+{
+  BlindTunnel *tunnel = blindTunnelAllocator.alloc();
+  tunnel->init(netvc, iobuf, reader, options);
+}
+
+void
+BlindTunnel::init(NetVConnection *netvc, MIOBuffer *iobuf, IOBufferReader *reader, const HttpSessionAccept::Options *options)
+{
+  mutex      = netvc->mutex;
+  _client_vc = netvc;
+  _options   = options;
+  _buffer    = iobuf ? iobuf : new_MIOBuffer(BUFFER_SIZE_INDEX);
+  _reader    = reader ? reader : _buffer->alloc_reader();
+
+  // The destination a transaction would have, see HttpSM::setup_blind_tunnel_port.
+  _port = netvc->get_local_port();
+  if (SSLNetVConnection *ssl_vc = dynamic_cast<SSLNetVConnection *>(netvc)) {
+    if (ssl_vc->has_tunnel_destination()) {
+      ink_strlcpy(_host, ssl_vc->get_tunnel_host(), sizeof(_host));
+      if (ssl_vc->get_tunnel_port() > 0) {
+        _port = ssl_vc->get_tunnel_port();
+      }
+    } else {
+      ink_strlcpy(_host, ssl_vc->get_server_name(), sizeof(_host));
+    }
+  } else {
+    ats_ip_ntop(netvc->get_local_addr(), _host, sizeof(_host));
+  }
+
+  HTTP_INCREMENT_DYN_STAT(http_blind_tunnel_total_stat);
+  HTTP_INCREMENT_DYN_STAT(http_blind_tunnel_current_stat);
+  Debug("http_blind_tunnel", "[%p] tunnel to %s:%d", this, _host, _port);
+
+  // Keep what the client sent so far, the client hello of a TLS route is put in the buffer of the read.
+  _client_vc->do_io_read(this, 0, _buffer);
+
+  IpAddr ip;
+  if (ip.load(_host) == 0) {
+    SET_HANDLER(&BlindTunnel::state_connect);
+    connect(IpEndpoint().assign(ip, htons(_port)));
+  } else {
+    lookup();
+  }
+}
+
+void
+BlindTunnel::lookup()
+{
+  HttpConfigParams *params = HttpConfig::acquire();
+  HostDBProcessor::Options opt;
+  opt.port           = _port;
+  opt.host_res_style = ats_host_res_from(_client_vc->get_remote_addr()->sa_family, params->oride.host_res_data.order);
+  HttpConfig::release(params);
+
+  SET_HANDLER(&BlindTunnel::state_lookup);
+  hostDBProcessor.getbyname_re(this, _host, strlen(_host), opt);
+}
+
+int
+BlindTunnel::state_lookup(int event, void *data)
+{
+  switch (event) {
+  case EVENT_HOST_DB_LOOKUP: {
+    HostDBInfo *info = static_cast<HostDBInfo *>(data);
+    if (info && info->round_robin) {
+      HttpConfigParams *params = HttpConfig::acquire();
+      int32_t fail_window      = static_cast<int32_t>(params->oride.down_server_timeout);
+      HttpConfig::release(params);
+      HostDBRoundRobin *rr = info->rr();
+      info                 = rr ? rr->select_best_http(_client_vc->get_remote_addr(), ink_local_time(), fail_window) : nullptr;
+    }
+    if (!info || info->is_failed()) {
+      fail("no address");
+      break;
+    }
+    IpEndpoint addr;
+    addr.assign(info->ip());
+    addr.port() = htons(_port);
+    SET_HANDLER(&BlindTunnel::state_connect);
+    connect(addr);
+    break;
+  }
+  default:
+    // The client read is not enabled, a TLS route signals only the completion of its handshake.
+    break;
+  }
+  return EVENT_DONE;
+}
+
+void
+BlindTunnel::connect(IpEndpoint const &addr)
+{
+  // As the transaction would, the methods of the destination must allow a tunnel.
+  IpAllow::ACL acl = IpAllow::match(&addr.sa, IpAllow::DST_ADDR);
+  if (acl.isValid() && (acl.isDenyAll() || !acl.isMethodAllowed(HTTP_WKSIDX_CONNECT))) {
+    fail("denied by ip_allow");
+    return;
+  }
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  const auto &oride        = params->oride;
+  NetVCOptions opt;
+  opt.f_blocking_connect = false;
+  opt.ip_family          = addr.family();
+  opt.set_sock_param(oride.sock_recv_buffer_size_out, oride.sock_send_buffer_size_out, oride.sock_option_flag_out,
+                     oride.sock_packet_mark_out, oride.sock_packet_tos_out);
+  HttpConfig::release(params);
+
+  opt.local_port            = _options->outbound_port;
+  const IpAddr &outbound_ip = AF_INET6 == opt.ip_family ? _options->outbound_ip6 : _options->outbound_ip4;
+  if (outbound_ip.isValid()) {
+    opt.addr_binding = NetVCOptions::INTF_ADDR;
+    opt.local_ip     = outbound_ip;
+  }
+
+  netProcessor.connect_re(this, &addr.sa, &opt);
+}
+
+int
+BlindTunnel::state_connect(int event, void *data)
+{
+  switch (event) {
+  case NET_EVENT_OPEN:
+    run(static_cast<NetVConnection *>(data));
+    break;
+  case NET_EVENT_OPEN_FAILED:
+    fail("connect failed");
+    break;
+  default:
+    break;
+  }
+  return EVENT_DONE;
+}
+
+void
+BlindTunnel::run(NetVConnection *server_vc)
+{
+  HttpConfigParams *params = HttpConfig::acquire();
+  _client_vc->set_inactivity_timeout(HRTIME_SECONDS(params->oride.transaction_no_activity_timeout_in));
+  server_vc->set_inactivity_timeout(HRTIME_SECONDS(params->oride.transaction_no_activity_timeout_out));
+  HttpConfig::release(params);
+
+  // The tunnels free the buffer and close both connections.
+  _client_bytes    = _reader->read_avail();
+  _client_read_vio = _client_vc->do_io_read(this, INT64_MAX, _buffer);
+
+  _client_to_server = OneWayTunnel::OneWayTunnel_alloc();
+  _server_to_client = OneWayTunnel::OneWayTunnel_alloc();
+  _client_to_server->init(_client_vc, server_vc, this, _client_read_vio, _reader);
+  _server_to_client->init(server_vc, _client_vc, this, BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX));
+  _server_read_vio = _server_to_client->vioSource;
+  OneWayTunnel::SetupTwoWayTunnel(_client_to_server, _server_to_client);
+
+  SET_HANDLER(&BlindTunnel::state_tunnel);
+}
+
+int
+BlindTunnel::state_tunnel(int event, void *data)
+{
+  ink_assert(event == VC_EVENT_EOS || event == VC_EVENT_ERROR);
+
+  // The first tunnel done is the peer of the one that ended, both connections are still open.
+  if (++_tunnels_done == 1) {
+    HTTP_SUM_DYN_STAT(http_blind_tunnel_client_bytes_stat, _client_bytes + _client_read_vio->ndone);
+    HTTP_SUM_DYN_STAT(http_blind_tunnel_server_bytes_stat, _server_read_vio->ndone);
+  }
+  OneWayTunnel::OneWayTunnel_free(static_cast<OneWayTunnel *>(data));
+  if (_tunnels_done == 2) {
+    destroy();
+  }
+  return EVENT_DONE;
+}
+
+void
+BlindTunnel::fail(const char *what)
+{
+  Debug("http_blind_tunnel", "[%p] %s:%d: %s", this, _host, _port, what);
+  HTTP_INCREMENT_DYN_STAT(http_blind_tunnel_connect_failures_stat);
+  _client_vc->do_io_close();
+  free_MIOBuffer(_buffer);
+  destroy();
+}
+
+void
+BlindTunnel::destroy()
+{
+  HTTP_DECREMENT_DYN_STAT(http_blind_tunnel_current_stat);
+  mutex = nullptr;
+  blindTunnelAllocator.free(this);
+}
@@ -0,0 +1,88 @@
+/** @file
+
+  Blind tunnels of client connections to their origin, without a transaction
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_inet.h"
+#include "I_EventSystem.h"
+#include "HttpSessionAccept.h"
+#include "IPAllow.h"
+
+class NetVConnection;
+struct OneWayTunnel;
+
+/**
+  With @c proxy.config.http.blind_tunnel.fast_path, the blind tunnels of @c sni.yaml routes, of
+  plugins that tunnel from a TLS hook and of blind tunnel ports skip the client session and the
+  HttpSM. They resolve their destination, connect to it, then copy the bytes both ways with a
+  @c OneWayTunnel each, over two buffers of @c BUFFER_SIZE_INDEX, as @c SocksProxy does.
+
+  Only the connections that a transaction would tunnel without running a plugin or going through
+  a parent take this path, see @c eligible. There is no transaction log entry for them, the stats
+  @c proxy.process.http.blind_tunnel.* count them instead.
+*/
+class BlindTunnel : public Continuation
+{
+public:
+  /// The buffer of each direction, what a TLS record at most takes.
+  static constexpr int64_t BUFFER_SIZE_INDEX = BUFFER_SIZE_INDEX_16K;
+
+  /// Whether the connection @a netvc, accepted with @a options and allowed by @a acl, can be tunneled without a transaction.
+  static bool eligible(NetVConnection *netvc, const HttpSessionAccept::Options *options, const IpAllow::ACL &acl);
+
+  /**
+    Tunnel @a netvc to its destination. @a iobuf and @a reader hold what was already read from
+    it, if not @c nullptr, and are then owned by the tunnel.
+  */
+  static void start(NetVConnection *netvc, MIOBuffer *iobuf, IOBufferReader *reader, const HttpSessionAccept::Options *options);
+
+  void init(NetVConnection *netvc, MIOBuffer *iobuf, IOBufferReader *reader, const HttpSessionAccept::Options *options);
+
+private:
+  int state_lookup(int event, void *data);
+  int state_connect(int event, void *data);
+  int state_tunnel(int event, void *data);
+
+  void lookup();
+  void connect(IpEndpoint const &addr);
+  void run(NetVConnection *server_vc);
+  void fail(const char *what);
+  void destroy();
+
+  NetVConnection *_client_vc = nullptr;
+  MIOBuffer *_buffer         = nullptr; ///< What the client sends, until the tunnels take it over
+  IOBufferReader *_reader    = nullptr;
+
+  const HttpSessionAccept::Options *_options = nullptr; ///< Of the accept, which outlives the tunnel
+  char _host[MAXDNAME + 1]                   = {0};
+  in_port_t _port                            = 0;
+
+  OneWayTunnel *_client_to_server = nullptr;
+  OneWayTunnel *_server_to_client = nullptr;
+  VIO *_client_read_vio           = nullptr;
+  VIO *_server_read_vio           = nullptr;
+  int64_t _client_bytes           = 0; ///< Read from the client before the tunnel started
+  int _tunnels_done               = 0;
+};
+
+extern ClassAllocator<BlindTunnel> blindTunnelAllocator;
@@ -415,6 +415,11 @@ Http1ClientSession::release(ProxyTransaction *trans)
     new_transaction();
   } else {
     HttpSsnDebug("[%" PRId64 "] initiating io for next header", con_id);
+    if (sm && sm->t_state.http_config_param->keep_alive_release_buffer) {
+      // Nothing is buffered, hold no memory while idle. The read allocates a header sized block
+      // when the next request arrives.
+      read_buffer->release_blocks(std::min(read_buffer->size_index, static_cast<int64_t>(HTTP_HEADER_BUFFER_SIZE_INDEX)));
+    }
     read_state = HCS_KEEP_ALIVE;
     SET_HANDLER(&Http1ClientSession::state_keep_alive);
     ka_vio = this->do_io_read(this, INT64_MAX, read_buffer);
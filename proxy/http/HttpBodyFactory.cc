@@ -40,6 +40,9 @@
 #include "URL.h"
 #include "logging/Log.h"
 #include "logging/LogAccess.h"
+#include "logging/LogBuffer.h"
+#include "logging/LogFormat.h"
+#include "logging/LogUtils.h"
 #include "HttpCompat.h"
 #include "tscore/I_Layout.h"
 
@@ -1075,6 +1078,13 @@ HttpBodyTemplate::reset()
   template_buffer = nullptr;
   byte_count      = 0;
   ats_free(template_pathname);
+  template_pathname = nullptr;
+  ats_free(printf_str);
+  printf_str = nullptr;
+  printf_len = 0;
+  delete field_list;
+  field_list = nullptr;
+  n_fields   = 0;
 }
 
 int
@@ -1143,9 +1153,46 @@ HttpBodyTemplate::load_from_file(char *dir, char *file)
   byte_count        = new_byte_count;
   template_pathname = ats_strdup(path);
 
+  compile();
+
   return 1;
 }
 
+// Split the template into the text around its log fields and the list of the fields, as
+// resolve_logfield_string does for each call, so that instantiating it only resolves them.
+void
+HttpBodyTemplate::compile()
+{
+  char *fields_str = nullptr;
+  bool contains_aggregates;
+
+  n_fields = LogFormat::parse_format_string(template_buffer, &printf_str, &fields_str);
+  if (n_fields == 0) {
+    Debug("body_factory", "    no log fields in '%s', the template is the body", template_pathname);
+    ats_free(printf_str);
+    printf_str = nullptr;
+    ats_free(fields_str);
+    return;
+  }
+
+  field_list      = new LogFieldList;
+  int field_count = LogFormat::parse_symbol_string(fields_str, field_list, &contains_aggregates);
+  ats_free(fields_str);
+
+  if (field_count != n_fields) {
+    Warning("template file '%s' contains %d invalid log field symbols", template_pathname, n_fields - field_count);
+    ats_free(printf_str);
+    printf_str = nullptr;
+    delete field_list;
+    field_list = nullptr;
+    n_fields   = -1;
+    return;
+  }
+
+  printf_len = strlen(printf_str);
+  Debug("body_factory", "    %d log fields in '%s'", n_fields, template_pathname);
+}
+
 char *
 HttpBodyTemplate::build_instantiated_buffer(HttpTransact::State *context, int64_t *buflen_return)
 {
@@ -1153,11 +1200,37 @@ HttpBodyTemplate::build_instantiated_buffer(HttpTransact::State *context, int64_
 
   Debug("body_factory_instantiation", "    before instantiation: [%s]", template_buffer);
 
-  LogAccess la(context->state_machine);
-
-  buffer = resolve_logfield_string(&la, template_buffer);
+  if (n_fields == 0) {
+    buffer = static_cast<char *>(ats_malloc(byte_count + 1));
+    memcpy(buffer, template_buffer, byte_count + 1);
+    *buflen_return = byte_count;
+  } else if (n_fields > 0) {
+    LogAccess la(context->state_machine);
+    la.init();
+
+    char marshal_buf[1024];
+    unsigned marshal_len = field_list->marshal_len(&la);
+    char *marshaled      = marshal_len <= sizeof(marshal_buf) ? marshal_buf : static_cast<char *>(ats_malloc(marshal_len));
+    field_list->marshal(&la, marshaled);
+
+    // A field takes no more than its marshaled bytes as text, or 64 bytes for the numbers and addresses.
+    int size       = printf_len + marshal_len + n_fields * 64 + 1;
+    buffer         = static_cast<char *>(ats_malloc(size));
+    int64_t length = LogBuffer::resolve_custom_entry(field_list, printf_str, marshaled, buffer, size - 1, LogUtils::timestamp(), 0,
+                                                     LOG_SEGMENT_VERSION);
+    if (marshaled != marshal_buf) {
+      ats_free(marshaled);
+    }
 
-  *buflen_return = ((buffer == nullptr) ? 0 : strlen(buffer));
+    if (length == 0) {
+      buffer = static_cast<char *>(ats_free_null(buffer));
+    } else {
+      buffer[length] = '\0';
+    }
+    *buflen_return = length;
+  } else {
+    *buflen_return = 0;
+  }
   Debug("body_factory_instantiation", "    after instantiation: [%s]", buffer);
   Debug("body_factory", "  returning %" PRId64 " byte instantiated buffer", *buflen_return);
 
@@ -48,6 +48,7 @@
 
     HttpBodyTemplate      The template loaded from the directory to be
                           instantiated with variables, producing a body.
+                          Its log fields are parsed once as it is loaded.
 
 
  ****************************************************************************/
@@ -66,6 +67,8 @@
 #include <memory>
 #include <unordered_map>
 
+class LogFieldList;
+
 #define HTTP_BODY_TEMPLATE_MAGIC 0xB0DFAC00
 #define HTTP_BODY_SET_MAGIC 0xB0DFAC55
 #define HTTP_BODY_FACTORY_MAGIC 0xB0DFACFF
@@ -79,6 +82,12 @@
 //      to dump out the contents of the template, and to instantiate
 //      the template into a buffer given a context.
 //
+//      The log fields are parsed as the template is loaded, into the
+//      text around them and the list of the fields.  A template with
+//      no log fields is its own body, which is copied as it is, and
+//      the others are resolved in a single pass, into a buffer sized
+//      for the fields of the transaction.
+//
 ////////////////////////////////////////////////////////////////////////
 
 class HttpBodyTemplate
@@ -100,6 +109,14 @@ public:
   int64_t byte_count;
   char *template_buffer;
   char *template_pathname;
+
+private:
+  void compile();
+
+  int n_fields             = 0;       // log fields of the template, -1 if some are invalid
+  char *printf_str         = nullptr; // the template, with a marker in the place of each log field
+  int printf_len           = 0;
+  LogFieldList *field_list = nullptr; // the log fields, in the order of the markers
 };
 
 ////////////////////////////////////////////////////////////////////////
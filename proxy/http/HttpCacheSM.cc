@@ -117,13 +117,17 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
   case CACHE_EVENT_OPEN_READ_FAILED:
     if ((intptr_t)data == -ECACHE_DOC_BUSY) {
       // Somebody else is writing the object
-      if (open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries) {
+      if (collapse_deadline ? Thread::get_hrtime() < collapse_deadline :
+                              open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries) {
         // Retry to read; maybe the update finishes in time
         open_read_cb = false;
         do_schedule_in();
       } else {
         // Give up; the update didn't finish in time
         // HttpSM will inform HttpTransact to 'proxy-only'
+        if (collapse_deadline) {
+          HTTP_INCREMENT_DYN_STAT(http_cache_open_write_collapse_timeout_stat);
+        }
         open_read_cb = true;
         master_sm->handleEvent(event, data);
       }
@@ -138,7 +142,7 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
     // Retry the cache open read if the number retries is less
     // than or equal to the max number of open read retries,
     // else treat as a cache miss.
-    ink_assert(open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries || write_locked);
+    ink_assert(open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries || write_locked || collapse_deadline);
     Debug("http_cache",
           "[%" PRId64 "] [state_cache_open_read] cache open read failure %d. "
           "retrying cache open read...",
@@ -172,7 +176,19 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     break;
 
   case CACHE_EVENT_OPEN_WRITE_FAILED:
-    if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
+    if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_COLLAPSE) {
+      // Wait on the writer once, reading while it writes, until the collapse timeout.
+      // If it goes away without a document, the next write failure goes to the origin.
+      if (!collapse_deadline) {
+        Debug("http_cache", "[%" PRId64 "] [state_cache_open_write] cache open write failure %d. collapsing on the writer",
+              master_sm->sm_id, open_write_tries);
+        collapse_deadline =
+          Thread::get_hrtime() + HRTIME_MSECONDS(master_sm->t_state.http_config_param->cache_collapse_timeout);
+        open_read_tries          = 0;
+        read_retry_on_write_fail = true;
+        open_write_tries         = master_sm->t_state.txn_conf->max_cache_open_write_retries + 1;
+      }
+    } else if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
       // fall back to open_read_tries
       // Note that when CACHE_WL_FAIL_ACTION_READ_RETRY is configured, max_cache_open_write_retries
       // is automatically ignored. Make sure to not disable max_cache_open_read_retries
@@ -212,7 +228,8 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     break;
 
   case EVENT_INTERVAL:
-    if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
+    if (master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY ||
+        master_sm->t_state.txn_conf->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_COLLAPSE) {
       Debug("http_cache",
             "[%" PRId64 "] [state_cache_open_write] cache open write failure %d. "
             "falling back to read retry...",
@@ -108,6 +108,12 @@ public:
     return cache_read_vc ? (cache_read_vc->is_compressed_in_ram()) : false;
   }
 
+  const HttpCacheKey *
+  get_cache_key() const
+  {
+    return &cache_key;
+  }
+
   inline void
   set_open_read_tries(int value)
   {
@@ -199,6 +205,7 @@ private:
   HTTPHdr *read_request_hdr                      = nullptr;
   const OverridableHttpConfigParams *http_params = nullptr;
   time_t read_pin_in_cache                       = 0;
+  ink_hrtime collapse_deadline                   = 0; // end of the wait on the writer, for a collapsed request
 
   // Open write parameters
   bool retry_write     = true;
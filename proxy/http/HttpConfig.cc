@@ -293,6 +293,36 @@ http_insert_forwarded_cb(const char *name, RecDataT dtype, RecData data, void *c
   return REC_ERR_OKAY;
 }
 
+// The header heap counters are kept per thread by HdrHeap, outside any stat block
+static int
+hdr_str_heap_stat_sync(const char * /* name ATS_UNUSED */, RecDataT data_type, RecData *data,
+                       RecRawStatBlock * /* rsb ATS_UNUSED */, int id)
+{
+  HdrStrHeapStats stats = hdr_str_heap_stats();
+  int64_t value         = 0;
+
+  switch (id) {
+  case http_hdr_str_heap_demotions_stat:
+    value = stats.demotions;
+    break;
+  case http_hdr_str_heap_coalesces_stat:
+    value = stats.coalesces;
+    break;
+  case http_hdr_str_heap_evacuated_bytes_stat:
+    value = stats.evacuated_bytes;
+    break;
+  case http_hdr_str_heap_wasted_bytes_stat:
+    value = stats.wasted_bytes;
+    break;
+  default:
+    ink_assert(!"unknown header string heap stat");
+    break;
+  }
+  RecDataSetFromInt64(data_type, data, value);
+
+  return REC_ERR_OKAY;
+}
+
 void
 register_stat_callbacks()
 {
@@ -390,6 +420,15 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_shutdown.tunnel_abort", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_shutdown_tunnel_abort, RecRawStatSyncCount);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.hdr_str_heap.demotions", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_hdr_str_heap_demotions_stat, hdr_str_heap_stat_sync);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.hdr_str_heap.coalesces", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_hdr_str_heap_coalesces_stat, hdr_str_heap_stat_sync);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.hdr_str_heap.evacuated_bytes", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_hdr_str_heap_evacuated_bytes_stat, hdr_str_heap_stat_sync);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.hdr_str_heap.wasted_bytes", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_hdr_str_heap_wasted_bytes_stat, hdr_str_heap_stat_sync);
+
   // Upstream current connections stats
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_parent_proxy_connections", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_current_parent_proxy_connections_stat, RecRawStatSyncSum);
@@ -988,6 +1027,103 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.open_write.adjust_thread", RECD_COUNTER, RECP_NON_PERSISTENT,
                      (int)http_cache_open_write_adjust_thread_stat, RecRawStatSyncCount);
   HTTP_CLEAR_DYN_STAT(http_cache_open_write_adjust_thread_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.open_write.collapse_timeout", RECD_COUNTER,
+                     RECP_NON_PERSISTENT, (int)http_cache_open_write_collapse_timeout_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_cache_open_write_collapse_timeout_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.revalidate.background", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_cache_revalidate_background_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_cache_revalidate_background_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.revalidate.in_flight", RECD_COUNTER, RECP_NON_PERSISTENT,
+                     (int)http_cache_revalidate_in_flight_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_cache_revalidate_in_flight_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache.hit_fast_path", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_hit_fast_path_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_cache_hit_fast_path_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_prewarm.opened", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_prewarm_opened_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_prewarm_opened_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_prewarm.failed", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_prewarm_failed_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_prewarm_failed_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_pool.thread_hits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_pool_thread_hits_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_pool_thread_hits_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_pool.global_hits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_pool_global_hits_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_pool_global_hits_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_pool.migrated", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_pool_migrated_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_pool_migrated_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.server_session_pool.overflow", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_server_session_pool_overflow_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_server_session_pool_overflow_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.sm.size", RECD_INT, RECP_NON_PERSISTENT, (int)http_sm_size_stat,
+                     RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_sm_size_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.sm.extension_bytes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_sm_extension_bytes_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_sm_extension_bytes_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_16K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_16K_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_16K_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_64K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_64K_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_64K_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_256K", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_256K_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_256K_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_1M", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_1M_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_1M_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_4M", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_4M_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_4M_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.tunnel.buffered_inf", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_tunnel_buffered_inf_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_tunnel_buffered_inf_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.transaction_cpu_time", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_transaction_cpu_time_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_transaction_cpu_time_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.blind_tunnel.total_tunnels", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_blind_tunnel_total_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_blind_tunnel_total_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.blind_tunnel.current_tunnels", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)http_blind_tunnel_current_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_blind_tunnel_current_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.blind_tunnel.connect_failures", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_blind_tunnel_connect_failures_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_blind_tunnel_connect_failures_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.blind_tunnel.client_bytes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_blind_tunnel_client_bytes_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_blind_tunnel_client_bytes_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.blind_tunnel.server_bytes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_blind_tunnel_server_bytes_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_blind_tunnel_server_bytes_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.races", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_races_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_happy_eyeballs_races_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.ipv4_wins", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_ipv4_wins_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_happy_eyeballs_ipv4_wins_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.ipv6_wins", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_ipv6_wins_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_happy_eyeballs_ipv6_wins_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.fallbacks", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_fallbacks_stat, RecRawStatSyncCount);
+  HTTP_CLEAR_DYN_STAT(http_happy_eyeballs_fallbacks_stat);
+  // latency histograms, proxy.process.http.latency.<phase>_<bucket>
+  static const char *const latency_phases[HTTP_LATENCY_PHASES] = {"dns",        "connect", "tls",   "first_byte",
+                                                                  "cache_open", "plugin",  "total", "cpu"};
+  static const char *const latency_buckets[HTTP_LATENCY_BUCKETS] = {"1ms", "10ms", "100ms", "1s", "inf"};
+  for (int phase = 0; phase < HTTP_LATENCY_PHASES; phase++) {
+    for (int bucket = 0; bucket < HTTP_LATENCY_BUCKETS; bucket++) {
+      char name[64];
+      int id = http_latency_histogram_stat + phase * HTTP_LATENCY_BUCKETS + bucket;
+      snprintf(name, sizeof(name), "proxy.process.http.latency.%s_%s", latency_phases[phase], latency_buckets[bucket]);
+      RecRegisterRawStat(http_rsb, RECT_PROCESS, name, RECD_COUNTER, RECP_PERSISTENT, id, RecRawStatSyncCount);
+      HTTP_CLEAR_DYN_STAT(id);
+    }
+  }
   // milestones
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.milestone.ua_begin", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_ua_begin_time_stat, RecRawStatSyncSum);
@@ -1156,6 +1292,14 @@ HttpConfig::startup()
   HttpEstablishStaticConfigStringAlloc(c.oride.server_session_sharing_match_str, "proxy.config.http.server_session_sharing.match");
   http_config_enum_read("proxy.config.http.server_session_sharing.pool", SessionSharingPoolStrings, c.server_session_sharing_pool);
   httpSessionManager.set_pool_type(c.server_session_sharing_pool);
+  HttpEstablishStaticConfigLongLong(c.server_session_sharing_global_shards,
+                                    "proxy.config.http.server_session_sharing.global_shards");
+  httpSessionManager.set_global_shards(c.server_session_sharing_global_shards);
+  HttpEstablishStaticConfigLongLong(c.server_session_sharing_thread_max_idle,
+                                    "proxy.config.http.server_session_sharing.thread_max_idle");
+  httpSessionManager.set_thread_max_idle(c.server_session_sharing_thread_max_idle);
+  HttpEstablishStaticConfigStringAlloc(c.server_session_prewarm_origins, "proxy.config.http.server_session_prewarm.origins");
+  HttpEstablishStaticConfigLongLong(c.server_session_prewarm_min_idle, "proxy.config.http.server_session_prewarm.min_idle");
 
   RecRegisterConfigUpdateCb("proxy.config.http.insert_forwarded", &http_insert_forwarded_cb, &c);
   {
@@ -1279,8 +1423,19 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.disallow_post_100_continue, "proxy.config.http.disallow_post_100_continue");
 
   HttpEstablishStaticConfigByte(c.keepalive_internal_vc, "proxy.config.http.keepalive_internal_vc");
+  HttpEstablishStaticConfigByte(c.splice_server_transfer, "proxy.config.http.splice_server_transfer");
+  HttpEstablishStaticConfigByte(c.blind_tunnel_fast_path, "proxy.config.http.blind_tunnel.fast_path");
+  HttpEstablishStaticConfigLongLong(c.transaction_buffer_limit, "proxy.config.http.transaction_buffer_limit");
+  HttpEstablishStaticConfigLongLong(c.flow_drain_time, "proxy.config.http.flow_control.drain_time");
+  HttpEstablishStaticConfigLongLong(c.http_chunking_batch_size, "proxy.config.http.chunking.batch_size");
+  HttpEstablishStaticConfigByte(c.transaction_cpu_time, "proxy.config.http.transaction_cpu_time");
+  HttpEstablishStaticConfigByte(c.keep_alive_release_buffer, "proxy.config.http.keep_alive_release_buffer");
+  HttpEstablishStaticConfigByte(c.happy_eyeballs_enabled, "proxy.config.http.happy_eyeballs.enabled");
+  HttpEstablishStaticConfigLongLong(c.happy_eyeballs_attempt_delay, "proxy.config.http.happy_eyeballs.attempt_delay");
 
   HttpEstablishStaticConfigByte(c.oride.cache_open_write_fail_action, "proxy.config.http.cache.open_write_fail_action");
+  HttpEstablishStaticConfigLongLong(c.cache_collapse_timeout, "proxy.config.http.cache.collapse_timeout");
+  HttpEstablishStaticConfigByte(c.cache_stale_while_revalidate, "proxy.config.http.cache.stale_while_revalidate");
 
   HttpEstablishStaticConfigByte(c.oride.cache_when_to_revalidate, "proxy.config.http.cache.when_to_revalidate");
   HttpEstablishStaticConfigByte(c.oride.cache_required_headers, "proxy.config.http.cache.required_headers");
@@ -1449,6 +1604,10 @@ HttpConfig::reconfigure()
   params->oride.server_session_sharing_match_str = ats_strdup(m_master.oride.server_session_sharing_match_str);
   params->oride.server_min_keep_alive_conns      = m_master.oride.server_min_keep_alive_conns;
   params->server_session_sharing_pool            = m_master.server_session_sharing_pool;
+  params->server_session_sharing_global_shards   = m_master.server_session_sharing_global_shards;
+  params->server_session_sharing_thread_max_idle = m_master.server_session_sharing_thread_max_idle;
+  params->server_session_prewarm_origins         = ats_strdup(m_master.server_session_prewarm_origins);
+  params->server_session_prewarm_min_idle        = m_master.server_session_prewarm_min_idle;
   params->oride.keep_alive_post_out              = m_master.oride.keep_alive_post_out;
 
   params->oride.keep_alive_no_activity_timeout_in   = m_master.oride.keep_alive_no_activity_timeout_in;
@@ -1557,8 +1716,20 @@ HttpConfig::reconfigure()
   params->send_100_continue_response = INT_TO_BOOL(m_master.send_100_continue_response);
   params->disallow_post_100_continue = INT_TO_BOOL(m_master.disallow_post_100_continue);
   params->keepalive_internal_vc      = INT_TO_BOOL(m_master.keepalive_internal_vc);
+  params->splice_server_transfer     = INT_TO_BOOL(m_master.splice_server_transfer);
+  params->blind_tunnel_fast_path     = INT_TO_BOOL(m_master.blind_tunnel_fast_path);
+  params->transaction_buffer_limit   = m_master.transaction_buffer_limit;
+  params->flow_drain_time            = m_master.flow_drain_time;
+  params->http_chunking_batch_size   = m_master.http_chunking_batch_size;
+  params->transaction_cpu_time       = INT_TO_BOOL(m_master.transaction_cpu_time);
+  params->keep_alive_release_buffer  = INT_TO_BOOL(m_master.keep_alive_release_buffer);
+
+  params->happy_eyeballs_enabled       = INT_TO_BOOL(m_master.happy_eyeballs_enabled);
+  params->happy_eyeballs_attempt_delay = m_master.happy_eyeballs_attempt_delay;
 
   params->oride.cache_open_write_fail_action = m_master.oride.cache_open_write_fail_action;
+  params->cache_collapse_timeout             = m_master.cache_collapse_timeout;
+  params->cache_stale_while_revalidate       = INT_TO_BOOL(m_master.cache_stale_while_revalidate);
   if (params->oride.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
     if (params->oride.max_cache_open_read_retries <= 0 || params->oride.max_cache_open_write_retries <= 0) {
       Warning("Invalid config, cache_open_write_fail_action (%d), max_cache_open_read_retries (%" PRIu64 "), "
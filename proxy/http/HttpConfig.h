@@ -54,6 +54,33 @@
 static const unsigned HTTP_STATUS_NUMBER = 600;
 using HttpStatusBitset                   = std::bitset<HTTP_STATUS_NUMBER>;
 
+/// The phases of a transaction counted in the latency histograms, measured from its milestones.
+enum HttpLatencyPhase {
+  HTTP_LATENCY_DNS,        ///< DNS_LOOKUP_BEGIN to DNS_LOOKUP_END
+  HTTP_LATENCY_CONNECT,    ///< SERVER_CONNECT to SERVER_CONNECT_END
+  HTTP_LATENCY_TLS,        ///< TLS_HANDSHAKE_START to TLS_HANDSHAKE_END, of the client
+  HTTP_LATENCY_FIRST_BYTE, ///< SERVER_BEGIN_WRITE to SERVER_FIRST_READ
+  HTTP_LATENCY_CACHE_OPEN, ///< CACHE_OPEN_READ_BEGIN to CACHE_OPEN_READ_END
+  HTTP_LATENCY_PLUGIN,     ///< PLUGIN_TOTAL
+  HTTP_LATENCY_TOTAL,      ///< SM_START to SM_FINISH
+  HTTP_LATENCY_CPU,        ///< thread CPU time, with proxy.config.http.transaction_cpu_time
+  HTTP_LATENCY_PHASES
+};
+
+/// The buckets of a latency histogram, up to 1ms, 10ms, 100ms, 1s and beyond.
+static constexpr int HTTP_LATENCY_BUCKETS = 5;
+
+/// The bucket of a latency histogram counting @a t.
+inline int
+http_latency_bucket(ink_hrtime t)
+{
+  int b = 0;
+  for (ink_hrtime bound = HRTIME_MSECONDS(1); b < HTTP_LATENCY_BUCKETS - 1 && t > bound; bound *= 10) {
+    ++b;
+  }
+  return b;
+}
+
 /* Instead of enumerating the stats in DynamicStats.h, each module needs
    to enumerate its stats separately and register them with librecords
    */
@@ -327,6 +354,37 @@ enum {
 
   http_origin_connect_adjust_thread_stat,
   http_cache_open_write_adjust_thread_stat,
+  http_cache_open_write_collapse_timeout_stat,
+  http_cache_revalidate_background_stat,
+  http_cache_revalidate_in_flight_stat,
+  http_cache_hit_fast_path_stat,
+  http_server_session_prewarm_opened_stat,
+  http_server_session_prewarm_failed_stat,
+  http_server_session_pool_thread_hits_stat,
+  http_server_session_pool_global_hits_stat,
+  http_server_session_pool_migrated_stat,
+  http_server_session_pool_overflow_stat,
+  http_sm_size_stat,
+  http_sm_extension_bytes_stat,
+  http_tunnel_buffered_16K_stat,
+  http_tunnel_buffered_64K_stat,
+  http_tunnel_buffered_256K_stat,
+  http_tunnel_buffered_1M_stat,
+  http_tunnel_buffered_4M_stat,
+  http_tunnel_buffered_inf_stat,
+  http_transaction_cpu_time_stat,
+  http_blind_tunnel_total_stat,
+  http_blind_tunnel_current_stat,
+  http_blind_tunnel_connect_failures_stat,
+  http_blind_tunnel_client_bytes_stat,
+  http_blind_tunnel_server_bytes_stat,
+  http_happy_eyeballs_races_stat,
+  http_happy_eyeballs_ipv4_wins_stat,
+  http_happy_eyeballs_ipv6_wins_stat,
+  http_happy_eyeballs_fallbacks_stat,
+  // HTTP_LATENCY_BUCKETS counters for each HttpLatencyPhase, in order
+  http_latency_histogram_stat,
+  http_latency_histogram_last_stat = http_latency_histogram_stat + HTTP_LATENCY_PHASES * HTTP_LATENCY_BUCKETS - 1,
 
   http_origin_shutdown_pool_lock_contention,
   http_origin_shutdown_migration_failure,
@@ -347,6 +405,11 @@ enum {
   http_origin_shutdown_cleanup_entry,
   http_origin_shutdown_tunnel_abort,
 
+  http_hdr_str_heap_demotions_stat,
+  http_hdr_str_heap_coalesces_stat,
+  http_hdr_str_heap_evacuated_bytes_stat,
+  http_hdr_str_heap_wasted_bytes_stat,
+
   http_stat_count
 };
 
@@ -357,6 +420,7 @@ enum CacheOpenWriteFailAction_t {
   CACHE_WL_FAIL_ACTION_ERROR_ON_MISS_STALE_ON_REVALIDATE = 0x03,
   CACHE_WL_FAIL_ACTION_ERROR_ON_MISS_OR_REVALIDATE       = 0x04,
   CACHE_WL_FAIL_ACTION_READ_RETRY                        = 0x05,
+  CACHE_WL_FAIL_ACTION_COLLAPSE                          = 0x06,
   TOTAL_CACHE_WL_FAIL_ACTION_TYPES
 };
 
@@ -806,8 +870,25 @@ public:
   MgmtByte send_100_continue_response = 0;
   MgmtByte disallow_post_100_continue = 0;
   MgmtByte keepalive_internal_vc      = 0;
-
-  MgmtByte server_session_sharing_pool = TS_SERVER_SESSION_SHARING_POOL_THREAD;
+  MgmtByte splice_server_transfer     = 0;
+  MgmtByte blind_tunnel_fast_path     = 0;
+
+  MgmtInt transaction_buffer_limit      = 0;    ///< Most buffer memory of a transaction, 0 for no limit.
+  MgmtInt flow_drain_time               = 0;    ///< Adaptive flow control: msec of client drain to buffer, 0 for fixed marks.
+  MgmtInt http_chunking_batch_size      = 0;    ///< Largest chunk made of the data available at once, 0 for none.
+  MgmtByte transaction_cpu_time         = 0;    ///< Measure the thread CPU time of each transaction.
+  MgmtByte keep_alive_release_buffer    = 0;    ///< Free the read buffer of idle client sessions.
+  MgmtInt cache_collapse_timeout        = 2000; ///< Longest wait on the writer of a collapsed request, in msec.
+  MgmtByte cache_stale_while_revalidate = 0;    ///< Honor stale-while-revalidate in cached responses.
+  MgmtByte happy_eyeballs_enabled       = 0;    ///< Race the origin addresses of both families, see HttpConnectRace.
+  MgmtInt happy_eyeballs_attempt_delay  = 250;  ///< Wait in msec for an attempt before the race starts the next one.
+
+  MgmtByte server_session_sharing_pool           = TS_SERVER_SESSION_SHARING_POOL_THREAD;
+  MgmtInt server_session_sharing_global_shards   = 1; ///< Shards of the global session pool.
+  MgmtInt server_session_sharing_thread_max_idle = 0; ///< Idle sessions to an origin a hybrid pool keeps per thread.
+
+  char *server_session_prewarm_origins    = nullptr; ///< Origins to keep idle sessions to.
+  MgmtInt server_session_prewarm_min_idle = 0;       ///< Idle sessions to each of them, per thread.
 
   OutboundConnTrack::GlobalConfig outbound_conntrack;
 
@@ -886,6 +967,7 @@ inline HttpConfigParams::~HttpConfigParams()
   ats_free(connect_ports_string);
   ats_free(reverse_proxy_no_host_redirect);
   ats_free(redirect_actions_string);
+  ats_free(server_session_prewarm_origins);
   ats_free(oride.ssl_client_sni_policy);
   ats_free(oride.host_res_data.conf_value);
 
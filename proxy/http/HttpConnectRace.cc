@@ -0,0 +1,384 @@
+/** @file
+
+  Happy Eyeballs connection racing of the origin addresses of a transaction
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "HttpConnectRace.h"
+#include "HttpSM.h"
+#include "HttpConfig.h"
+#include "HTTP.h"
+#include "IPAllow.h"
+#include "P_Net.h"
+#include "P_HostDB.h"
+#include "I_Machine.h"
+
+HttpConnectRace::Attempt::Attempt(HttpConnectRace *race, IpEndpoint const &addr) : Continuation(race->mutex), race(race), addr(addr)
+{
+  SET_HANDLER(&HttpConnectRace::Attempt::handle);
+}
+
+int
+HttpConnectRace::Attempt::handle(int event, void *data)
+{
+  switch (event) {
+  case NET_EVENT_OPEN:
+    // The connect is under way, the write is ready once the handshake is done, see HttpSM::state_http_server_open.
+    connect_action = nullptr;
+    vc             = static_cast<NetVConnection *>(data);
+    vc->set_inactivity_timeout(race->_connect_timeout);
+    vc->do_io_write(this, 1, race->_reader);
+    break;
+  case NET_EVENT_OPEN_FAILED:
+    connect_action = nullptr;
+    race->attempt_done(this, -reinterpret_cast<intptr_t>(data));
+    break;
+  case VC_EVENT_WRITE_READY:
+  case VC_EVENT_WRITE_COMPLETE:
+    race->finish(this);
+    break;
+  case VC_EVENT_INACTIVITY_TIMEOUT:
+  case VC_EVENT_ACTIVE_TIMEOUT:
+    vc->do_io_close();
+    vc = nullptr;
+    race->attempt_done(this, ETIMEDOUT);
+    break;
+  default:
+    vc->do_io_close();
+    vc = nullptr;
+    race->attempt_done(this, ECONNABORTED);
+    break;
+  }
+  return EVENT_DONE;
+}
+
+void
+HttpConnectRace::RaceAction::cancel(Continuation *c)
+{
+  Action::cancel(c);
+  race->finish(nullptr);
+}
+
+bool
+HttpConnectRace::eligible(HttpSM *sm, NetVCOptions const &opt)
+{
+  HttpTransact::State &s = sm->t_state;
+  if (!s.http_config_param->happy_eyeballs_enabled || !s.hostdb_entry || !s.dns_info.lookup_name) {
+    return false;
+  }
+
+  // The address of the client, of an SRV record or of a transparent connection is not to race others.
+  auto addr_style = s.dns_info.os_addr_style;
+  if (s.dns_info.srv_lookup_success || addr_style == HttpTransact::DNSLookupInfo::OS_Addr::OS_ADDR_TRY_CLIENT ||
+      addr_style == HttpTransact::DNSLookupInfo::OS_Addr::OS_ADDR_USE_CLIENT || opt.addr_binding == NetVCOptions::FOREIGN_ADDR) {
+    return false;
+  }
+
+  // A SOCKS server connects for us, the origin connection limits count one connection per transaction.
+  if (NetProcessor::socks_conf_stuff && NetProcessor::socks_conf_stuff->socks_needed && opt.socks_support != NO_SOCKS) {
+    return false;
+  }
+  return s.txn_conf->outbound_conntrack.max == 0;
+}
+
+Action *
+HttpConnectRace::start(HttpSM *sm, NetProcessor &processor, NetVCOptions const &opt, IpAddr const &outbound_ip4,
+                       IpAddr const &outbound_ip6)
+{
+  HttpConnectRace *race = new HttpConnectRace();
+  race->init(sm, processor, opt, outbound_ip4, outbound_ip6);
+  race->_started = true;
+  return race->attempt_next() ? &race->_action : ACTION_RESULT_DONE;
+}
+
+void
+HttpConnectRace::init(HttpSM *sm, NetProcessor &processor, NetVCOptions const &opt, IpAddr const &outbound_ip4,
+                      IpAddr const &outbound_ip6)
+{
+  HttpTransact::State &s = sm->t_state;
+
+  mutex            = sm->mutex;
+  _action          = sm;
+  _action.race     = this;
+  _sm              = sm;
+  _processor       = &processor;
+  _opt             = opt;
+  _outbound_ip4    = outbound_ip4;
+  _outbound_ip6    = outbound_ip6;
+  _connect_timeout = sm->get_server_connect_timeout();
+  _attempt_delay   = HRTIME_MSECONDS(s.http_config_param->happy_eyeballs_attempt_delay);
+  _family          = s.current.server->dst_addr.family();
+  _buffer          = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+  _reader          = _buffer->alloc_reader();
+  SET_HANDLER(&HttpConnectRace::state_race);
+
+  _addresses.push_back(s.current.server->dst_addr);
+  add_addresses(s.hostdb_entry.get(), true);
+  HTTP_INCREMENT_DYN_STAT(http_happy_eyeballs_races_stat);
+
+  // The host resolution preference decides whether the origin may be connected to over the other family.
+  int other = AF_INET6 == _family ? AF_INET : AF_INET6;
+  for (HostResPreference pref : s.txn_conf->host_res_data.order) {
+    if ((AF_INET == other && HOST_RES_PREFER_IPV4 == pref) || (AF_INET6 == other && HOST_RES_PREFER_IPV6 == pref)) {
+      HostDBProcessor::Options hopt;
+      hopt.port           = s.current.server->dst_addr.host_order_port();
+      hopt.host_res_style = AF_INET == other ? HOST_RES_IPV4_ONLY : HOST_RES_IPV6_ONLY;
+      hopt.timeout        = s.api_txn_dns_timeout_value != -1 ? s.api_txn_dns_timeout_value : 0;
+
+      Action *lookup = hostDBProcessor.getbyname_re(this, s.dns_info.lookup_name, 0, hopt);
+      if (lookup != ACTION_RESULT_DONE) {
+        _lookup = lookup;
+      }
+      break;
+    }
+  }
+}
+
+// Add the addresses of @a r that are not down. Those of the record of the transaction, the @a lead, follow the address
+// it picked. Those of the other family are interleaved with the ones not attempted yet, starting with the other family.
+void
+HttpConnectRace::add_addresses(HostDBInfo *r, bool lead)
+{
+  if (!r || r->is_failed()) {
+    return;
+  }
+
+  HttpTransact::State &s = _sm->t_state;
+  in_port_t port         = s.current.server->dst_addr.port();
+  ink_time_t now         = ink_local_time();
+  int32_t fail_window    = static_cast<int32_t>(s.txn_conf->down_server_timeout);
+
+  std::vector<IpEndpoint> found;
+  HostDBRoundRobin *rr = r->round_robin ? r->rr() : nullptr;
+  for (int i = 0, n = rr ? rr->rrcount : 1; i < n; ++i) {
+    HostDBInfo *info = rr ? &rr->info(i) : r;
+    if (rr && !info->is_alive(now, fail_window)) {
+      continue;
+    }
+    IpEndpoint addr;
+    addr.assign(info->ip());
+    addr.port() = port;
+    if (!ats_ip_addr_eq(&addr.sa, &_addresses.front().sa)) {
+      found.push_back(addr);
+    }
+  }
+
+  if (lead) {
+    _addresses.insert(_addresses.end(), found.begin(), found.end());
+    return;
+  }
+
+  std::vector<IpEndpoint> merged(_addresses.begin(), _addresses.begin() + _next);
+  auto a = found.begin();
+  auto b = _addresses.begin() + _next;
+  while (a != found.end() || b != _addresses.end()) {
+    if (a != found.end()) {
+      merged.push_back(*a++);
+    }
+    if (b != _addresses.end()) {
+      merged.push_back(*b++);
+    }
+  }
+  _addresses.swap(merged);
+}
+
+// What HttpSM::do_http_server_open checks of the address it picked: the ip_allow rules of the method (a method not
+// well known is to the address it picked only) and the loops to this proxy.
+bool
+HttpConnectRace::allowed(IpEndpoint const &addr) const
+{
+  HttpTransact::State &s = _sm->t_state;
+
+  if (!s.url_remap_success || s.url_map.getMapping()->ip_allow_check_enabled_p) {
+    IpAllow::ACL acl = IpAllow::match(&addr.sa, IpAllow::DST_ADDR);
+    int method       = s.hdr_info.server_request.method_get_wksidx();
+    if (acl.isValid() && (acl.isDenyAll() || (!acl.isAllowAll() && (method == -1 || !acl.isMethodAllowed(method))))) {
+      return false;
+    }
+  }
+
+  if (addr.host_order_port() == s.client_info.dst_addr.host_order_port() &&
+      (ats_ip_addr_eq(&addr.sa, &Machine::instance()->ip.sa) || ats_ip_addr_eq(&addr.sa, &s.client_info.dst_addr.sa))) {
+    return false;
+  }
+  return true;
+}
+
+// Start the next attempt, and the ones after it as long as they fail right away. Returns @c false if that ended the race.
+bool
+HttpConnectRace::attempt_next()
+{
+  bool started = false;
+
+  _starting = true;
+  while (!started && _next < _addresses.size()) {
+    IpEndpoint const &addr = _addresses[_next++];
+    if (!allowed(addr)) {
+      continue;
+    }
+
+    NetVCOptions opt;
+    opt                       = _opt;
+    opt.ip_family             = addr.family();
+    const IpAddr &outbound_ip = AF_INET6 == opt.ip_family ? _outbound_ip6 : _outbound_ip4;
+    if (outbound_ip.isValid()) {
+      opt.addr_binding = NetVCOptions::INTF_ADDR;
+      opt.local_ip     = outbound_ip;
+    } else {
+      opt.addr_binding = NetVCOptions::ANY_ADDR;
+      opt.local_ip.invalidate();
+    }
+
+    Attempt *attempt = new Attempt(this, addr);
+    _attempts.push_back(attempt);
+
+    // A connect that fails right away calls back before it returns, attempt_done has then removed the attempt.
+    Action *connect_action = _processor->connect_re(attempt, &attempt->addr.sa, &opt);
+    if (!_attempts.empty() && _attempts.back() == attempt) {
+      started = true;
+      if (connect_action != ACTION_RESULT_DONE) {
+        attempt->connect_action = connect_action;
+      }
+    }
+  }
+  _starting = false;
+
+  if (started) {
+    if (_attempt_event) {
+      _attempt_event->cancel();
+      _attempt_event = nullptr;
+    }
+    if (_next < _addresses.size()) {
+      _attempt_event = this_ethread()->schedule_in(this, _attempt_delay);
+    }
+  } else if (_attempts.empty() && !_lookup) {
+    finish(nullptr);
+    return false;
+  }
+  return true;
+}
+
+void
+HttpConnectRace::attempt_done(Attempt *attempt, int error)
+{
+  char addrbuf[INET6_ADDRPORTSTRLEN];
+  Debug("http_happy_eyeballs", "[%" PRId64 "] attempt to %s failed: %d", _sm->sm_id,
+        ats_ip_nptop(&attempt->addr.sa, addrbuf, sizeof(addrbuf)), error);
+
+  _error = error;
+  _attempts.erase(std::find(_attempts.begin(), _attempts.end(), attempt));
+  delete attempt;
+
+  // A failure starts the next attempt without waiting for the delay.
+  if (!_starting) {
+    attempt_next();
+  }
+}
+
+int
+HttpConnectRace::state_race(int event, void *data)
+{
+  switch (event) {
+  case EVENT_INTERVAL:
+    _attempt_event = nullptr;
+    attempt_next();
+    break;
+  case EVENT_HOST_DB_LOOKUP:
+    lookup_done(static_cast<HostDBInfo *>(data));
+    break;
+  default:
+    ink_assert(!"unexpected event");
+    break;
+  }
+  return EVENT_DONE;
+}
+
+void
+HttpConnectRace::lookup_done(HostDBInfo *r)
+{
+  _lookup = nullptr;
+  add_addresses(r, false);
+  Debug("http_happy_eyeballs", "[%" PRId64 "] %zu addresses to race", _sm->sm_id, _addresses.size());
+
+  // The addresses of the other family come in once the race has started, or before its first attempt.
+  if (_started) {
+    if (_attempts.empty()) {
+      attempt_next();
+    } else if (!_attempt_event && _next < _addresses.size()) {
+      _attempt_event = this_ethread()->schedule_in(this, _attempt_delay);
+    }
+  }
+}
+
+// End the race with @a winner, or with no winner once all the attempts have failed or the race is cancelled.
+void
+HttpConnectRace::finish(Attempt *winner)
+{
+  if (_attempt_event) {
+    _attempt_event->cancel();
+    _attempt_event = nullptr;
+  }
+  if (_lookup) {
+    _lookup->cancel();
+    _lookup = nullptr;
+  }
+  for (Attempt *attempt : _attempts) {
+    if (attempt == winner) {
+      continue;
+    }
+    if (attempt->connect_action) {
+      attempt->connect_action->cancel();
+    }
+    if (attempt->vc) {
+      attempt->vc->do_io_close();
+    }
+    delete attempt;
+  }
+  _attempts.clear();
+
+  HttpSM *sm         = _sm;
+  bool cancelled     = _action.cancelled;
+  NetVConnection *vc = nullptr;
+  intptr_t error     = _error;
+  if (winner) {
+    char addrbuf[INET6_ADDRPORTSTRLEN];
+    Debug("http_happy_eyeballs", "[%" PRId64 "] won by %s", sm->sm_id, ats_ip_nptop(&winner->addr.sa, addrbuf, sizeof(addrbuf)));
+    HTTP_INCREMENT_DYN_STAT(winner->addr.isIp6() ? http_happy_eyeballs_ipv6_wins_stat : http_happy_eyeballs_ipv4_wins_stat);
+    if (!ats_ip_addr_port_eq(&winner->addr.sa, &sm->t_state.current.server->dst_addr.sa)) {
+      HTTP_INCREMENT_DYN_STAT(http_happy_eyeballs_fallbacks_stat);
+      ats_ip_copy(&sm->t_state.current.server->dst_addr, &winner->addr);
+    }
+    vc = winner->vc;
+    vc->do_io_write(nullptr, 0, nullptr);
+    delete winner;
+  }
+
+  free_MIOBuffer(_buffer);
+  mutex = nullptr;
+  delete this;
+
+  // The race is over as a connect that calls back would be, the HttpSM drops it before it is called back.
+  if (!cancelled) {
+    sm->pending_action = nullptr;
+    sm->handleEvent(vc ? NET_EVENT_OPEN : NET_EVENT_OPEN_FAILED, vc ? static_cast<void *>(vc) : reinterpret_cast<void *>(-error));
+  }
+}
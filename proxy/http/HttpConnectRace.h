@@ -0,0 +1,115 @@
+/** @file
+
+  Happy Eyeballs connection racing of the origin addresses of a transaction
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "tscore/ink_inet.h"
+#include "I_EventSystem.h"
+#include "I_NetVConnection.h"
+#include "I_NetProcessor.h"
+
+class HttpSM;
+struct HostDBInfo;
+
+/**
+  With @c proxy.config.http.happy_eyeballs.enabled, the connection of a transaction to its origin
+  races the addresses of the origin as RFC 8305 describes: the first attempt goes to the address
+  the transaction picked, then another one starts every @c proxy.config.http.happy_eyeballs.attempt_delay
+  milliseconds, or as soon as one fails, alternating between the families. The first connection to
+  complete its handshake wins, the other attempts are cancelled or closed.
+
+  The addresses are those of the HostDB record of the transaction, which are of a single family.
+  The race looks up those of the other family at the same time and adds them as they come in, so
+  that an origin with a broken IPv6 path does not hold the transaction for a connect timeout.
+
+  The race calls back the HttpSM with @c NET_EVENT_OPEN and the winning connection, or with
+  @c NET_EVENT_OPEN_FAILED once all the attempts have failed, as @c connect_re would. The
+  address of the winner is then that of the server of the transaction.
+*/
+class HttpConnectRace : public Continuation
+{
+public:
+  /// Whether the connection of @a sm, with @a opt, is raced.
+  static bool eligible(HttpSM *sm, NetVCOptions const &opt);
+
+  /**
+    Start the race of @a sm to its server, with the connections made by @a processor with @a opt.
+    @a outbound_ip4 and @a outbound_ip6 are the local addresses to bind for each family, if valid.
+    Returns the action to cancel the race, which ends all its attempts.
+  */
+  static Action *start(HttpSM *sm, NetProcessor &processor, NetVCOptions const &opt, IpAddr const &outbound_ip4,
+                       IpAddr const &outbound_ip6);
+
+private:
+  /// A connection attempt, from its connect to the end of its TCP handshake, under the mutex of the race.
+  struct Attempt : public Continuation {
+    Attempt(HttpConnectRace *race, IpEndpoint const &addr);
+    int handle(int event, void *data);
+
+    HttpConnectRace *race;
+    IpEndpoint addr;
+    Action *connect_action = nullptr; ///< Until the connection is open
+    NetVConnection *vc     = nullptr; ///< Until its handshake is complete
+  };
+
+  void init(HttpSM *sm, NetProcessor &processor, NetVCOptions const &opt, IpAddr const &outbound_ip4, IpAddr const &outbound_ip6);
+  void add_addresses(HostDBInfo *r, bool lead);
+  bool allowed(IpEndpoint const &addr) const;
+  bool attempt_next();
+  void attempt_done(Attempt *attempt, int error);
+  void lookup_done(HostDBInfo *r);
+  void finish(Attempt *winner);
+
+  /// The attempt delay and the lookup of the other family.
+  int state_race(int event, void *data);
+
+  /// Cancelled under the mutex of the HttpSM, which is that of the race, it ends the race right away.
+  struct RaceAction : public Action {
+    using Action::operator=;
+    void cancel(Continuation *c = nullptr) override;
+    HttpConnectRace *race = nullptr;
+  };
+
+  RaceAction _action;
+  HttpSM *_sm              = nullptr;
+  NetProcessor *_processor = nullptr;
+  NetVCOptions _opt;
+  IpAddr _outbound_ip4;
+  IpAddr _outbound_ip6;
+  ink_hrtime _connect_timeout = 0;
+  ink_hrtime _attempt_delay   = 0;
+  int _family                 = AF_UNSPEC; ///< Of the address the transaction picked
+
+  std::vector<IpEndpoint> _addresses; ///< To attempt, in order
+  size_t _next = 0;                   ///< The next of @a _addresses to attempt
+  std::vector<Attempt *> _attempts;   ///< In flight
+  int _error              = ECONNREFUSED; ///< Of the last attempt that failed
+  Action *_lookup         = nullptr;      ///< Of the addresses of the other family
+  Event *_attempt_event   = nullptr;
+  MIOBuffer *_buffer      = nullptr; ///< The handshake writes nothing, it waits for the write to be ready
+  IOBufferReader *_reader = nullptr;
+  bool _starting          = false; ///< In @c attempt_next, whose connects may fail before they return
+  bool _started           = false; ///< Past the lookup of the other family, if it called back right away
+};
@@ -0,0 +1,170 @@
+/** @file
+
+  Accounting of the time plugins spend on the hooks of HTTP transactions
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <dlfcn.h>
+
+#include <array>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "HttpPluginStats.h"
+#include "HttpDebugNames.h"
+#include "P_EventSystem.h"
+#include "records/P_RecProcess.h"
+#include "ts/InkAPIPrivateIOCore.h"
+
+namespace
+{
+RecRawStatBlock *plugin_rsb = nullptr;
+
+// The stats of the plugins, created under the lock, and the first free stat.
+std::mutex plugin_lock;
+std::map<std::pair<std::string, TSHttpHookID>, HttpPluginStats *> plugin_stats;
+int plugin_next_stat = 0;
+
+// A plugin and hook pair with no stats, out of room.
+HttpPluginStats *const UNACCOUNTED = reinterpret_cast<HttpPluginStats *>(uintptr_t(1));
+
+// The stats of the handlers seen by this thread, for each hook.
+using HookStats = std::array<HttpPluginStats *, TS_HTTP_LAST_HOOK>;
+thread_local std::unordered_map<void const *, HookStats> handler_stats;
+
+// The name of the shared object holding @a func, without its directory and suffix.
+std::string
+plugin_name(void const *func)
+{
+  Dl_info info;
+  if (!func || !dladdr(func, &info) || !info.dli_fname) {
+    return "unknown";
+  }
+  std::string_view name = info.dli_fname;
+  if (auto slash = name.rfind('/'); slash != name.npos) {
+    name.remove_prefix(slash + 1);
+  }
+  if (auto dot = name.find('.'); dot != name.npos && dot > 0) {
+    name = name.substr(0, dot);
+  }
+  return std::string(name);
+}
+
+// TS_HTTP_READ_REQUEST_HDR_HOOK as read_request_hdr.
+std::string
+hook_name(TSHttpHookID hook)
+{
+  std::string_view name = HttpDebugNames::get_api_hook_name(hook);
+  if (name.substr(0, 8) == "TS_HTTP_") {
+    name.remove_prefix(8);
+  }
+  if (name.size() > 5 && name.substr(name.size() - 5) == "_HOOK") {
+    name.remove_suffix(5);
+  }
+  std::string s(name);
+  for (char &c : s) {
+    c = tolower(c);
+  }
+  return s;
+}
+} // namespace
+
+void
+HttpPluginStats::init()
+{
+  int enabled = 0;
+  REC_ReadConfigInteger(enabled, "proxy.config.plugin.hook_stats");
+  if (enabled) {
+    plugin_rsb = RecAllocateRawStatBlock(MAX_STATS);
+    if (!plugin_rsb) {
+      Warning("cannot allocate the plugin hook stats");
+    }
+  }
+}
+
+HttpPluginStats *
+HttpPluginStats::create(const char *plugin, TSHttpHookID hook)
+{
+  static const char *const stat_names[STATS] = {"calls",      "time",     "wait",      "time_10us",
+                                                "time_100us", "time_1ms", "time_10ms", "time_inf"};
+
+  std::string name = hook_name(hook);
+  if (plugin_next_stat + STATS > MAX_STATS) {
+    Warning("no room left for the stats of plugin %s on hook %s", plugin, name.c_str());
+    return UNACCOUNTED;
+  }
+  int base = plugin_next_stat;
+  plugin_next_stat += STATS;
+  for (int i = 0; i < STATS; i++) {
+    char stat[256];
+    snprintf(stat, sizeof(stat), "proxy.process.plugin.%s.%s.%s", plugin, name.c_str(), stat_names[i]);
+    RecRegisterRawStat(plugin_rsb, RECT_PROCESS, stat, RECD_COUNTER, RECP_NON_PERSISTENT, base + i,
+                       i == TIME || i == WAIT ? RecRawStatSyncSum : RecRawStatSyncCount);
+  }
+  return new HttpPluginStats(base);
+}
+
+HttpPluginStats *
+HttpPluginStats::get(INKContInternal const *cont, TSHttpHookID hook)
+{
+  return get(reinterpret_cast<void const *>(cont->m_event_func), hook);
+}
+
+HttpPluginStats *
+HttpPluginStats::get(void const *handler, TSHttpHookID hook)
+{
+  if (!plugin_rsb || hook < 0 || hook >= TS_HTTP_LAST_HOOK) {
+    return nullptr;
+  }
+  HttpPluginStats *&stats = handler_stats[handler][hook];
+  if (!stats) {
+    std::string plugin = plugin_name(handler);
+    std::lock_guard<std::mutex> guard(plugin_lock);
+    HttpPluginStats *&shared = plugin_stats[{plugin, hook}];
+    if (!shared) {
+      shared = create(plugin.c_str(), hook);
+    }
+    stats = shared;
+  }
+  return stats == UNACCOUNTED ? nullptr : stats;
+}
+
+void
+HttpPluginStats::called(ink_hrtime t)
+{
+  int bucket = 0;
+  for (ink_hrtime bound = HRTIME_USECONDS(10); bucket < STATS - TIME_HISTOGRAM - 1 && t > bound; bound *= 10) {
+    ++bucket;
+  }
+  EThread *thread = this_ethread();
+  RecIncrRawStat(plugin_rsb, thread, _base + CALLS, 1);
+  RecIncrRawStat(plugin_rsb, thread, _base + TIME, ink_hrtime_to_usec(t));
+  RecIncrRawStat(plugin_rsb, thread, _base + TIME_HISTOGRAM + bucket, 1);
+}
+
+void
+HttpPluginStats::waited(ink_hrtime t)
+{
+  RecIncrRawStat(plugin_rsb, this_ethread(), _base + WAIT, ink_hrtime_to_usec(t));
+}
@@ -0,0 +1,79 @@
+/** @file
+
+  Accounting of the time plugins spend on the hooks of HTTP transactions
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_hrtime.h"
+#include "ts/apidefs.h"
+
+class INKContInternal;
+
+/**
+  With @c proxy.config.plugin.hook_stats, counts for each plugin, named after its shared
+  object, and each transaction hook it is called on
+  @c proxy.process.plugin.<plugin>.<hook>.<stat>:
+
+  - @c calls, the invocations of the hook.
+  - @c time, the microseconds spent in the hook, until it reenabled the transaction or returned.
+  - @c time_10us to @c time_inf, a histogram of these times.
+  - @c wait, the microseconds the transaction then waited to be reenabled.
+
+  The stats of a plugin on a hook are created as it is first called there. The plugin of a
+  continuation, or of a fast hook, is looked up from the address of its handler, once per handler
+  and thread.
+*/
+class HttpPluginStats
+{
+public:
+  /// Allocate the stats, before the threads start.
+  static void init();
+
+  /// The stats of the plugin of @a cont on @a hook, @c nullptr if not accounted.
+  static HttpPluginStats *get(INKContInternal const *cont, TSHttpHookID hook);
+
+  /// The stats of the plugin of the fast hook @a func on @a hook.
+  static HttpPluginStats *
+  get(TSHttpFastHookFunc func, TSHttpHookID hook)
+  {
+    return get(reinterpret_cast<void const *>(func), hook);
+  }
+
+  /// The hook ran for @a t.
+  void called(ink_hrtime t);
+
+  /// The transaction waited @a t for the plugin to reenable it.
+  void waited(ink_hrtime t);
+
+private:
+  enum { CALLS, TIME, WAIT, TIME_HISTOGRAM, STATS = TIME_HISTOGRAM + 5 };
+
+  /// The most stats, the plugin and hook pairs accounted are those that first fit.
+  static constexpr int MAX_STATS = 1024;
+
+  static HttpPluginStats *create(const char *plugin, TSHttpHookID hook);
+  static HttpPluginStats *get(void const *handler, TSHttpHookID hook);
+
+  explicit HttpPluginStats(int base) : _base(base) {}
+
+  int _base; ///< The id of the first stat
+};
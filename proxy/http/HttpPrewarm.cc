@@ -0,0 +1,329 @@
+/** @file
+
+  Pre-warming of server sessions to configured origins
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpPrewarm.h"
+#include "HttpConfig.h"
+#include "HttpSM.h"
+#include "HttpSessionManager.h"
+#include "Http1ServerSession.h"
+#include "P_Net.h"
+#include "tscpp/util/TextView.h"
+
+namespace
+{
+bool
+is_origin_separator(char c)
+{
+  return c == ',' || ParseRules::is_ws(c);
+}
+
+/*
+  Opens one session for a pre-warmer: connects, waits for the handshakes to be done, which
+  the first write ready event tells as for a transaction, then releases the session to the
+  pool of the thread.
+*/
+struct HttpPrewarmConnect : public Continuation {
+  HttpPrewarm *owner;
+  const char *host;
+  MgmtByte sharing_match;
+  MgmtInt connect_timeout;
+  MgmtInt keep_alive_timeout;
+  OutboundConnTrack::TxnState ct_state;
+  Http1ServerSession *session = nullptr;
+
+  HttpPrewarmConnect(HttpPrewarm *aowner, const char *ahost, const HttpConfigParams *params)
+    : Continuation(new_ProxyMutex()),
+      owner(aowner),
+      host(ahost),
+      sharing_match(params->oride.server_session_sharing_match),
+      connect_timeout(params->oride.connect_attempts_timeout),
+      keep_alive_timeout(params->oride.keep_alive_no_activity_timeout_out)
+  {
+    SET_HANDLER(&HttpPrewarmConnect::state_open);
+  }
+
+  int
+  state_open(int event, void *data)
+  {
+    if (event != NET_EVENT_OPEN) {
+      Debug("http_prewarm", "connect to %s failed, event %d", host, event);
+      failed();
+      return EVENT_DONE;
+    }
+    NetVConnection *vc = static_cast<NetVConnection *>(data);
+    // allocated as Http1ServerSession::destroy() frees it
+    session = (TS_SERVER_SESSION_SHARING_POOL_THREAD == httpSessionManager.get_pool_type()) ?
+                THREAD_ALLOC_INIT(httpServerSessionAllocator, mutex->thread_holding) :
+                httpServerSessionAllocator.alloc();
+    session->sharing_pool    = TS_SERVER_SESSION_SHARING_POOL_THREAD;
+    session->sharing_match   = static_cast<TSServerSessionSharingMatchMask>(sharing_match);
+    session->to_parent_proxy = false;
+    session->attach_hostname(host);
+    session->new_connection(vc, nullptr, nullptr);
+    if (ct_state.is_active()) {
+      session->enable_outbound_connection_tracking(ct_state.drop());
+    }
+    session->set_inactivity_timeout(HRTIME_SECONDS(connect_timeout));
+    SET_HANDLER(&HttpPrewarmConnect::state_handshake);
+    // as for a transaction, the first write ready tells the handshakes are done
+    session->do_io_write(this, 1, session->get_reader());
+    return EVENT_DONE;
+  }
+
+  int
+  state_handshake(int event, void * /* data ATS_UNUSED */)
+  {
+    switch (event) {
+    case VC_EVENT_READ_COMPLETE:
+    case VC_EVENT_WRITE_READY:
+    case VC_EVENT_WRITE_COMPLETE:
+      Debug("http_prewarm", "[%" PRId64 "] session to %s pre-warmed", session->connection_id(), host);
+      session->set_inactivity_timeout(HRTIME_SECONDS(keep_alive_timeout));
+      session->release(nullptr);
+      HTTP_INCREMENT_DYN_STAT(http_server_session_prewarm_opened_stat);
+      done();
+      break;
+    default:
+      Debug("http_prewarm", "[%" PRId64 "] session to %s failed, event %d", session->connection_id(), host, event);
+      session->do_io_close();
+      failed();
+      break;
+    }
+    return EVENT_DONE;
+  }
+
+  void
+  failed()
+  {
+    ct_state.clear();
+    HTTP_INCREMENT_DYN_STAT(http_server_session_prewarm_failed_stat);
+    done();
+  }
+
+  void
+  done()
+  {
+    owner->session_done();
+    mutex.clear();
+    delete this;
+  }
+};
+} // namespace
+
+bool
+HttpPrewarm::parse(std::string_view text, std::vector<Origin> &origins)
+{
+  ts::TextView list{text};
+  while (list) {
+    ts::TextView item = list.ltrim_if(&is_origin_separator).take_prefix_if(&is_origin_separator);
+    if (item.empty()) {
+      continue;
+    }
+    Origin origin;
+    ts::TextView spec = item;
+    if (spec.size() > 8 && strncasecmp(spec.data(), "https://", 8) == 0) {
+      origin.tls = true;
+      spec.remove_prefix(8);
+    } else if (spec.size() > 7 && strncasecmp(spec.data(), "http://", 7) == 0) {
+      spec.remove_prefix(7);
+    }
+    // a host name or an address, bracketed if IPv6, with an optional port
+    std::string_view host, port, rest;
+    if (ats_ip_parse(spec, &host, &port, &rest) != 0 || !rest.empty()) {
+      host = {};
+    }
+    if (host.empty()) {
+      Error("%s: invalid origin '%.*s'", "proxy.config.http.server_session_prewarm.origins", static_cast<int>(item.size()),
+            item.data());
+      return false;
+    }
+    if (port.empty()) {
+      origin.port = origin.tls ? 443 : 80;
+    } else {
+      ts::TextView parsed;
+      intmax_t n = ts::svtoi(port, &parsed);
+      if (parsed.size() != port.size() || n <= 0 || n > 65535) {
+        Error("%s: invalid port in origin '%.*s'", "proxy.config.http.server_session_prewarm.origins",
+              static_cast<int>(item.size()), item.data());
+        return false;
+      }
+      origin.port = n;
+    }
+    origin.host.assign(host.data(), host.size());
+    CryptoContext().hash_immediate(origin.host_hash, origin.host.data(), origin.host.size());
+    origins.push_back(std::move(origin));
+  }
+  return true;
+}
+
+void
+HttpPrewarm::start()
+{
+  HttpConfigParams *params = HttpConfig::acquire();
+  std::vector<Origin> origins;
+  if (params->server_session_prewarm_min_idle > 0 && params->server_session_prewarm_origins) {
+    parse(params->server_session_prewarm_origins, origins);
+  }
+  bool shared = params->oride.server_session_sharing_match != 0 &&
+                params->server_session_sharing_pool != TS_SERVER_SESSION_SHARING_POOL_GLOBAL;
+  HttpConfig::release(params);
+
+  if (origins.empty()) {
+    return;
+  }
+  if (!shared) {
+    Warning("server session pre-warming needs sessions shared in the thread pools, it is disabled");
+    return;
+  }
+  EventProcessor::ThreadGroupDescriptor &group = eventProcessor.thread_group[ET_NET];
+  for (int i = 0; i < group._count; i++) {
+    for (const Origin &origin : origins) {
+      EThread *thread = group._thread[i];
+      thread->schedule_every(new HttpPrewarm(origin, thread), PERIOD);
+    }
+  }
+  Note("pre-warming server sessions to %zu origins", origins.size());
+}
+
+HttpPrewarm::HttpPrewarm(const Origin &origin, EThread *thread) : Continuation(new_ProxyMutex()), _origin(origin), _thread(thread)
+{
+  SET_HANDLER(&HttpPrewarm::state_main);
+}
+
+int
+HttpPrewarm::state_main(int event, void *data)
+{
+  switch (event) {
+  case EVENT_INTERVAL:
+    if (!_pending_lookup) {
+      HttpConfigParams *params = HttpConfig::acquire();
+      HostDBProcessor::Options opt;
+      opt.port           = _origin.port;
+      opt.host_res_style = ats_host_res_from(AF_INET, params->oride.host_res_data.order);
+      HttpConfig::release(params);
+      Action *lookup = hostDBProcessor.getbyname_re(this, _origin.host.c_str(), _origin.host.size(), opt);
+      if (lookup != ACTION_RESULT_DONE) {
+        _pending_lookup = lookup;
+      }
+    }
+    break;
+  case EVENT_HOST_DB_LOOKUP:
+    _pending_lookup = nullptr;
+    refill(static_cast<HostDBInfo *>(data));
+    break;
+  default:
+    break;
+  }
+  return EVENT_CONT;
+}
+
+void
+HttpPrewarm::refill(HostDBInfo *info)
+{
+  if (!info) {
+    Debug("http_prewarm", "no address for %s", _origin.host.c_str());
+    return;
+  }
+  int idle = 0;
+  {
+    ServerSessionPool *pool = _thread->server_session_pool;
+    MUTEX_TRY_LOCK(lock, pool->mutex, _thread);
+    if (!lock.is_locked()) {
+      return;
+    }
+    idle = pool->count(_origin.host_hash, htons(_origin.port));
+  }
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  int missing              = params->server_session_prewarm_min_idle - idle - _connecting;
+  HttpConfig::release(params);
+  if (missing <= 0) {
+    return;
+  }
+
+  std::vector<IpEndpoint> addrs;
+  if (info->round_robin) {
+    HostDBRoundRobin *rr = info->rr();
+    for (int i = 0; rr && i < rr->rrcount; i++) {
+      addrs.emplace_back().assign(rr->info(i).ip());
+    }
+  } else {
+    addrs.emplace_back().assign(info->ip());
+  }
+  for (IpEndpoint &addr : addrs) {
+    addr.port() = htons(_origin.port);
+  }
+  Debug("http_prewarm", "%s:%d has %d idle sessions, opening %d", _origin.host.c_str(), _origin.port, idle, missing);
+  while (missing-- > 0) {
+    connect(addrs[_next_addr++ % addrs.size()]);
+  }
+}
+
+void
+HttpPrewarm::connect(const IpEndpoint &addr)
+{
+  HttpConfigParams *params   = HttpConfig::acquire();
+  const auto &oride          = params->oride;
+  HttpPrewarmConnect *ssn_op = new HttpPrewarmConnect(this, _origin.host.c_str(), params);
+
+  // the origin connection limits bind pre-warmed sessions as any other
+  if (oride.outbound_conntrack.max > 0 || oride.outbound_conntrack.min > 0) {
+    ssn_op->ct_state = OutboundConnTrack::obtain(oride.outbound_conntrack, _origin.host, addr);
+  }
+  if (oride.outbound_conntrack.max > 0 && ssn_op->ct_state.reserve() > oride.outbound_conntrack.max) {
+    ssn_op->ct_state.release();
+    HttpConfig::release(params);
+    ssn_op->mutex.clear();
+    delete ssn_op;
+    return;
+  }
+
+  NetVCOptions opt;
+  opt.f_blocking_connect = false;
+  opt.ip_family          = addr.family();
+  opt.set_sock_param(oride.sock_recv_buffer_size_out, oride.sock_send_buffer_size_out, oride.sock_option_flag_out,
+                     oride.sock_packet_mark_out, oride.sock_packet_tos_out);
+  if (_origin.tls) {
+    set_tls_options(opt, &oride);
+    opt.set_ssl_client_cert_name(oride.ssl_client_cert_filename);
+    opt.ssl_client_private_key_name = oride.ssl_client_private_key_filename;
+    opt.ssl_client_ca_cert_name     = oride.ssl_client_ca_cert_filename;
+    opt.set_sni_servername(_origin.host.data(), _origin.host.size());
+    opt.set_ssl_servername(_origin.host.c_str());
+  }
+  HttpConfig::release(params);
+
+  ++_connecting;
+  SCOPED_MUTEX_LOCK(lock, ssn_op->mutex, this_ethread());
+  if (_origin.tls) {
+    sslNetProcessor.connect_re(ssn_op, &addr.sa, &opt);
+  } else {
+    netProcessor.connect_re(ssn_op, &addr.sa, &opt);
+  }
+}
+
+void
+HttpPrewarm::session_done()
+{
+  --_connecting;
+}
@@ -0,0 +1,84 @@
+/** @file
+
+  Pre-warming of server sessions to configured origins
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tscore/CryptoHash.h"
+#include "tscore/ink_inet.h"
+#include "I_EventSystem.h"
+
+struct HostDBInfo;
+
+/**
+  Keeps @c proxy.config.http.server_session_prewarm.min_idle idle server sessions to each
+  origin of @c proxy.config.http.server_session_prewarm.origins in the session pool of every
+  net thread. The sessions are opened ahead of the transactions, through the TCP and, for
+  @c https origins, the TLS handshake, and released to the pool as if a transaction was done
+  with them. Each thread checks its pool every second and opens what is missing, spreading
+  the connections over the addresses of the origin.
+*/
+class HttpPrewarm : public Continuation
+{
+public:
+  /// An origin to pre-warm sessions to.
+  struct Origin {
+    std::string host;
+    in_port_t port = 0;
+    bool tls       = false;
+    CryptoHash host_hash;
+  };
+
+  /// How often a thread refills its pool.
+  static constexpr ink_hrtime PERIOD = HRTIME_SECONDS(1);
+
+  /**
+    Parse the origins of @a text, @c [scheme://]host[:port] separated by white space or commas.
+    The scheme is @c http or @c https, @c http if missing, and sets the default port.
+    @return @c false if an origin is malformed, the origins parsed so far are kept.
+  */
+  static bool parse(std::string_view text, std::vector<Origin> &origins);
+
+  /// Start pre-warming on every net thread, if configured.
+  static void start();
+
+  /// A session opened by this pre-warmer is done, released to the pool or failed.
+  void session_done();
+
+private:
+  HttpPrewarm(const Origin &origin, EThread *thread);
+
+  int state_main(int event, void *data);
+  void refill(HostDBInfo *info);
+  void connect(const IpEndpoint &addr);
+
+  Origin _origin;
+  EThread *_thread;
+  Action *_pending_lookup = nullptr;
+  unsigned _next_addr     = 0;
+  std::atomic<int> _connecting{0};
+};
@@ -27,6 +27,8 @@
 #include "HttpSessionAccept.h"
 #include "ReverseProxy.h"
 #include "HttpSessionManager.h"
+#include "HttpSM.h"
+#include "HttpPrewarm.h"
 #ifdef USE_HTTP_DEBUG_LISTS
 #include "Http1ClientSession.h"
 #endif
@@ -266,6 +268,7 @@ void
 prep_HttpProxyServer()
 {
   httpSessionManager.init();
+  HTTP_SUM_GLOBAL_DYN_STAT(http_sm_size_stat, sizeof(HttpSM));
 }
 
 /** Set up all the accepts and sockets.
@@ -275,7 +278,6 @@ init_accept_HttpProxyServer(int n_accept_threads)
 {
   HttpProxyPort::Group &proxy_ports = HttpProxyPort::global();
 
-  init_reverse_proxy();
   http_pages_init();
 
 #ifdef USE_HTTP_DEBUG_LISTS
@@ -375,6 +377,9 @@ start_HttpProxyServer()
   // Set up stat page for http connection count
   statPagesManager.register_http("connection_count", register_ShowConnectionCount);
 
+  // Fill the session pools to the origins configured for it
+  HttpPrewarm::start();
+
   // Alert plugins that connections will be accepted.
   APIHook *hook = lifecycle_hooks->get(TS_LIFECYCLE_PORTS_READY_HOOK);
   while (hook) {
@@ -0,0 +1,165 @@
+/** @file
+
+  Background revalidation of documents served stale while revalidating
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "HttpRevalidate.h"
+#include "HttpSM.h"
+#include "PluginVC.h"
+
+extern HttpSessionAccept *plugin_http_accept;
+
+std::mutex HttpRevalidate::_in_flight_lock;
+std::unordered_set<CryptoHash, HttpRevalidate::KeyHasher> HttpRevalidate::_in_flight;
+
+HttpRevalidate::HttpRevalidate(const CryptoHash &key) : Continuation(new_ProxyMutex()), _key(key)
+{
+  SET_HANDLER(&HttpRevalidate::state_main);
+}
+
+HttpRevalidate::~HttpRevalidate()
+{
+  if (_req_buffer) {
+    free_MIOBuffer(_req_buffer);
+  }
+  if (_resp_buffer) {
+    free_MIOBuffer(_resp_buffer);
+  }
+}
+
+void
+HttpRevalidate::launch(HttpSM *sm)
+{
+  const CryptoHash &key = sm->get_cache_sm().get_cache_key()->hash;
+  if (!plugin_http_accept) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(_in_flight_lock);
+    if (!_in_flight.insert(key).second) {
+      HTTP_INCREMENT_DYN_STAT(http_cache_revalidate_in_flight_stat);
+      return;
+    }
+  }
+
+  HttpRevalidate *r = new HttpRevalidate(key);
+  SCOPED_MUTEX_LOCK(lock, r->mutex, this_ethread());
+  if (!r->start(&sm->t_state.client_info.src_addr.sa, &sm->t_state.hdr_info.client_request, &sm->t_state.unmapped_url)) {
+    r->done();
+    return;
+  }
+  HTTP_INCREMENT_DYN_STAT(http_cache_revalidate_background_stat);
+  Debug("http_revalidate", "[%" PRId64 "] revalidating in the background", sm->sm_id);
+}
+
+// The request is the client's before remap, stripped of what would make the origin answer
+// anything but the full document, and closing the internal session after the response.
+bool
+HttpRevalidate::start(sockaddr const *client, HTTPHdr *client_request, URL *url)
+{
+  PluginVCCore *core = PluginVCCore::alloc(plugin_http_accept, mutex.get());
+  core->set_active_addr(client);
+  core->set_plugin_tag(TAG);
+  _vc = core->connect();
+  if (!_vc) {
+    return false;
+  }
+  if (PluginVC *other_side = _vc->get_other_side(); other_side) {
+    other_side->set_is_internal_request(true);
+  }
+
+  HTTPHdr request;
+  request.copy(client_request);
+  request.method_set(HTTP_METHOD_GET, HTTP_LEN_GET);
+  if (url->valid()) {
+    int host_len     = 0;
+    const char *host = url->host_get(&host_len);
+    request.url_set(url);
+    if (host_len) {
+      char host_port[MAXDNAME + 8];
+      int n = url->port_get_raw() ? snprintf(host_port, sizeof(host_port), "%.*s:%d", host_len, host, url->port_get_raw()) :
+                                    snprintf(host_port, sizeof(host_port), "%.*s", host_len, host);
+      request.value_set(MIME_FIELD_HOST, MIME_LEN_HOST, host_port, std::min<int>(n, sizeof(host_port) - 1));
+    }
+  }
+  request.field_delete(MIME_FIELD_IF_MODIFIED_SINCE, MIME_LEN_IF_MODIFIED_SINCE);
+  request.field_delete(MIME_FIELD_IF_NONE_MATCH, MIME_LEN_IF_NONE_MATCH);
+  request.field_delete(MIME_FIELD_IF_RANGE, MIME_LEN_IF_RANGE);
+  request.field_delete(MIME_FIELD_RANGE, MIME_LEN_RANGE);
+  request.field_delete(MIME_FIELD_CONTENT_LENGTH, MIME_LEN_CONTENT_LENGTH);
+  request.field_delete(MIME_FIELD_TRANSFER_ENCODING, MIME_LEN_TRANSFER_ENCODING);
+  request.field_delete(MIME_FIELD_EXPECT, MIME_LEN_EXPECT);
+  request.value_set(MIME_FIELD_CONNECTION, MIME_LEN_CONNECTION, "close", 5);
+
+  int len    = request.length_get();
+  char *text = static_cast<char *>(ats_malloc(len + 1));
+  int index  = 0;
+  int offset = 0;
+  request.print(text, len + 1, &index, &offset);
+  request.destroy();
+
+  _req_buffer                = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  _resp_buffer               = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _resp_reader               = _resp_buffer->alloc_reader();
+  IOBufferReader *req_reader = _req_buffer->alloc_reader();
+  _req_buffer->write(text, index);
+  ats_free(text);
+
+  _vc->do_io_write(this, index, req_reader);
+  _vc->do_io_read(this, INT64_MAX, _resp_buffer);
+  return true;
+}
+
+int
+HttpRevalidate::state_main(int event, void * /* data ATS_UNUSED */)
+{
+  switch (event) {
+  case VC_EVENT_WRITE_READY:
+  case VC_EVENT_WRITE_COMPLETE:
+    break;
+  case VC_EVENT_READ_READY:
+    // the internal transaction wrote the cache, the response itself is not wanted
+    _resp_reader->consume(_resp_reader->read_avail());
+    break;
+  default:
+    Debug("http_revalidate", "revalidation done, event %d", event);
+    done();
+    break;
+  }
+  return EVENT_CONT;
+}
+
+void
+HttpRevalidate::done()
+{
+  if (_vc) {
+    _vc->do_io_close();
+    _vc = nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> guard(_in_flight_lock);
+    _in_flight.erase(_key);
+  }
+  mutex.clear();
+  delete this;
+}
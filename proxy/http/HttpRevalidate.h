@@ -0,0 +1,78 @@
+/** @file
+
+  Background revalidation of documents served stale while revalidating
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+
+#include "tscore/CryptoHash.h"
+#include "I_EventSystem.h"
+
+class HttpSM;
+class HTTPHdr;
+class URL;
+class PluginVC;
+struct sockaddr;
+
+/**
+  Reissues a request whose stale cached response was just served, within the
+  stale-while-revalidate window of that response, through an internal
+  transaction. That transaction revalidates the document with the origin and
+  updates the cache, its response is discarded. At most one revalidation of a
+  cache key is in flight at any time, later requests keep being served the
+  stale copy meanwhile.
+*/
+class HttpRevalidate : public Continuation
+{
+public:
+  /// Plugin tag of the internal transactions, which never serve stale themselves.
+  static constexpr const char *TAG = "stale-while-revalidate";
+
+  /// Revalidate the document @a sm is serving from cache, unless it is already being revalidated.
+  static void launch(HttpSM *sm);
+
+private:
+  HttpRevalidate(const CryptoHash &key);
+  ~HttpRevalidate() override;
+
+  bool start(sockaddr const *client, HTTPHdr *request, URL *url);
+  int state_main(int event, void *data);
+  void done();
+
+  CryptoHash _key;
+  PluginVC *_vc                = nullptr;
+  MIOBuffer *_req_buffer       = nullptr;
+  MIOBuffer *_resp_buffer      = nullptr;
+  IOBufferReader *_resp_reader = nullptr;
+
+  struct KeyHasher {
+    size_t
+    operator()(const CryptoHash &key) const
+    {
+      return key.fold();
+    }
+  };
+  static std::mutex _in_flight_lock;
+  static std::unordered_set<CryptoHash, KeyHasher> _in_flight;
+};
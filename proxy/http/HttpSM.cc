@@ -29,6 +29,7 @@
 #include "ProxyConfig.h"
 #include "Http1ServerSession.h"
 #include "HttpDebugNames.h"
+#include "HttpRevalidate.h"
 #include "HttpSessionManager.h"
 #include "P_Cache.h"
 #include "P_Net.h"
@@ -42,6 +43,8 @@
 #include "P_SSLConfig.h"
 #include "P_SSLSNI.h"
 #include "HttpPages.h"
+#include "HttpPluginStats.h"
+#include "HttpConnectRace.h"
 #include "IPAllow.h"
 #include "tscore/I_Layout.h"
 #include "tscore/bwf_std_format.h"
@@ -125,17 +128,22 @@ milestone_update_api_time(TransactionMilestones &milestones, ink_hrtime &api_tim
   }
 }
 
+/// The CPU time of the calling thread.
+inline ink_hrtime
+thread_cpu_time()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ink_hrtime_from_timespec(&ts);
+}
+
 // Unique state machine identifier
 std::atomic<int64_t> next_sm_id(0);
 } // namespace
 
 ClassAllocator<HttpSM> httpSMAllocator("httpSMAllocator");
 
-HttpVCTable::HttpVCTable(HttpSM *mysm)
-{
-  memset(&vc_table, 0, sizeof(vc_table));
-  sm = mysm;
-}
+HttpVCTable::HttpVCTable(HttpSM *mysm) : sm(mysm) {}
 
 HttpVCTableEntry *
 HttpVCTable::new_entry()
@@ -323,6 +331,11 @@ HttpSM::HttpSM() : Continuation(nullptr), vc_table(this) {}
 void
 HttpSM::cleanup()
 {
+  // before the strategy of the next hop goes with the remap table
+  if (t_state.next_hop_load) {
+    t_state.next_hop_load->load_end(0, -1, false);
+    t_state.next_hop_load = nullptr;
+  }
   t_state.destroy();
   api_hooks.clear();
   http_parser_clear(&http_parser);
@@ -333,7 +346,13 @@ HttpSM::cleanup()
   mutex.clear();
   tunnel.mutex.clear();
   cache_sm.mutex.clear();
-  transform_cache_sm.mutex.clear();
+  buffer_account = nullptr;
+  if (transform_cache_sm) {
+    transform_cache_sm->mutex.clear();
+    delete transform_cache_sm;
+    transform_cache_sm = nullptr;
+  }
+  arena.clear(ARENA_BLOCK_SIZE);
   magic    = HTTP_SM_MAGIC_DEAD;
   debug_on = false;
 }
@@ -356,6 +375,7 @@ HttpSM::init(bool from_early_data)
 
   // Unique state machine identifier
   sm_id                    = next_sm_id++;
+  ATS_PROBE1(http_sm_start, sm_id);
   t_state.state_machine_id = sm_id;
   t_state.state_machine    = this;
 
@@ -479,7 +499,18 @@ HttpSM::start_sub_sm()
 {
   tunnel.init(this, mutex);
   cache_sm.init(this, mutex);
-  transform_cache_sm.init(this, mutex);
+}
+
+// Only transactions whose transformed response is cached have a cache state machine for it.
+HttpCacheSM &
+HttpSM::get_transform_cache_sm()
+{
+  if (!transform_cache_sm) {
+    transform_cache_sm = new HttpCacheSM();
+    transform_cache_sm->init(this, mutex);
+    HTTP_SUM_DYN_STAT(http_sm_extension_bytes_stat, sizeof(HttpCacheSM));
+  }
+  return *transform_cache_sm;
 }
 
 void
@@ -506,6 +537,8 @@ HttpSM::attach_client_session(ProxyTransaction *client_vc, IOBufferReader *buffe
     if (p) {
       _client_connection_id = p->connection_id();
     }
+    buffer_account = new IOBufferAccount("HttpSM", t_state.http_config_param->transaction_buffer_limit,
+                                         p ? p->buffer_account.get() : nullptr);
   }
 
   // Collect log & stats information. We've already verified that the netvc is !nullptr above,
@@ -515,6 +548,7 @@ HttpSM::attach_client_session(ProxyTransaction *client_vc, IOBufferReader *buffe
   is_internal       = netvc->get_is_internal_request();
   mptcp_state       = netvc->get_mptcp_state();
   client_tcp_reused = !(ua_txn->is_first_transaction());
+  sample_client_tcp_info();
 
   if (ssl_vc != nullptr) {
     client_connection_is_ssl = true;
@@ -541,13 +575,15 @@ HttpSM::attach_client_session(ProxyTransaction *client_vc, IOBufferReader *buffe
     debug_on = true;
   }
 
-  t_state.setup_per_txn_configs();
-
   ink_assert(ua_txn->get_proxy_ssn());
   ink_assert(ua_txn->get_proxy_ssn()->accept_options);
 
-  // default the upstream IP style host resolution order from inbound
-  t_state.my_txn_conf().host_res_data.order = ua_txn->get_proxy_ssn()->accept_options->host_res_preference;
+  // default the upstream IP style host resolution order from inbound, the configuration is
+  // only copied for the transaction if the port orders differently
+  const HostResPreferenceOrder &order = ua_txn->get_proxy_ssn()->accept_options->host_res_preference;
+  if (order != t_state.txn_conf->host_res_data.order) {
+    t_state.my_txn_conf().host_res_data.order = order;
+  }
 
   start_sub_sm();
 
@@ -847,7 +883,7 @@ HttpSM::state_read_client_request_header(int event, void *data)
           free_MIOBuffer(ua_entry->write_buffer);
           ua_entry->write_buffer = nullptr;
         }
-        ua_entry->write_buffer    = new_MIOBuffer(alloc_index);
+        ua_entry->write_buffer    = new_MIOBuffer(alloc_index, buffer_account.get());
         IOBufferReader *buf_start = ua_entry->write_buffer->alloc_reader();
 
         t_state.hdr_info.client_request.m_100_continue_required = true;
@@ -899,7 +935,7 @@ HttpSM::wait_for_full_body()
   } else {
     alloc_index = buffer_size_to_index(t_state.hdr_info.request_content_length, t_state.http_config_param->max_payload_iobuf_index);
   }
-  MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index);
+  MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = post_buffer->alloc_reader();
 
   this->_postbuf.init(post_buffer->clone_reader(buf_start));
@@ -1380,13 +1416,27 @@ HttpSM::state_api_callback(int event, void *data)
 
   ink_assert(reentrancy_count >= 0);
   reentrancy_count++;
+  bool timed = cpu_time_start();
 
+  if (api_hook_stats) {
+    ink_hrtime now = Thread::get_hrtime_updated();
+    if (api_hook_start > 0) { // reenabled from the hook
+      api_hook_stats->called(now - api_hook_start);
+    } else {
+      api_hook_stats->waited(now + api_hook_start);
+    }
+    api_hook_stats = nullptr;
+  }
   milestone_update_api_time(milestones, api_timer);
 
   STATE_ENTER(&HttpSM::state_api_callback, event);
 
   state_api_callout(event, data);
 
+  if (timed) {
+    cpu_time_stop();
+  }
+
   // The sub-handler signals when it is time for the state
   //  machine to exit.  We can only exit if we are not reentrantly
   //  called otherwise when the our call unwinds, we will be
@@ -1481,6 +1531,36 @@ plugins required to work with sni_routing.
     if (nullptr == cur_hook) {
       cur_hook = hook_state.getNext();
     }
+    if (cur_hook && cur_hook->m_fast_func) {
+      // Fast hooks are called in place, there is no lock to take and no reenable to wait for
+      if (callout_state == HTTP_API_NO_CALLOUT) {
+        callout_state = HTTP_API_IN_CALLOUT;
+      }
+      if (!api_timer) {
+        api_timer = Thread::get_hrtime();
+      }
+      do {
+        APIHook const *hook = cur_hook;
+        cur_hook            = nullptr;
+
+        SMDebug("http", "[%" PRId64 "] calling fast plugin hook on hook %s at hook %p", sm_id,
+                HttpDebugNames::get_api_hook_name(cur_hook_id), hook);
+
+        HttpPluginStats *stats  = HttpPluginStats::get(hook->m_fast_func, cur_hook_id);
+        ink_hrtime hook_start   = stats ? Thread::get_hrtime_updated() : 0;
+        TSHttpHookResult result = hook->invoke_fast(reinterpret_cast<TSHttpTxn>(this), cur_hook_id);
+        if (stats) {
+          stats->called(Thread::get_hrtime_updated() - hook_start);
+        }
+
+        if (result == TS_HOOK_RESULT_ERROR) {
+          milestone_update_api_time(milestones, api_timer);
+          return state_api_callout(HTTP_API_ERROR, nullptr);
+        }
+        cur_hook = hook_state.getNext();
+      } while (cur_hook && cur_hook->m_fast_func);
+      milestone_update_api_time(milestones, api_timer);
+    }
     if (cur_hook) {
       if (callout_state == HTTP_API_NO_CALLOUT) {
         callout_state = HTTP_API_IN_CALLOUT;
@@ -1509,7 +1589,19 @@ plugins required to work with sni_routing.
         api_timer = Thread::get_hrtime();
       }
 
+      // A hook reenabling the transaction is accounted for as it does, a nested hook may then be called
+      ink_hrtime hook_start = 0;
+      api_hook_stats        = HttpPluginStats::get(hook->m_cont, cur_hook_id);
+      if (api_hook_stats) {
+        hook_start = api_hook_start = Thread::get_hrtime_updated();
+      }
+
       hook->invoke(TS_EVENT_HTTP_READ_REQUEST_HDR + cur_hook_id, this);
+      if (api_hook_stats && api_hook_start == hook_start) { // still waiting on this hook
+        ink_hrtime now = Thread::get_hrtime_updated();
+        api_hook_stats->called(now - hook_start);
+        api_hook_start = -now;
+      }
       if (api_timer > 0) { // true if the hook did not call TxnReenable()
         milestone_update_api_time(milestones, api_timer);
         api_timer = -Thread::get_hrtime(); // set in order to track non-active callout duration
@@ -1555,7 +1647,9 @@ plugins required to work with sni_routing.
       t_state.api_http_sm_shutdown   = false;
       t_state.cache_info.object_read = nullptr;
       cache_sm.close_read();
-      transform_cache_sm.close_read();
+      if (transform_cache_sm) {
+        transform_cache_sm->close_read();
+      }
       release_server_session();
       terminate_sm                 = true;
       api_next                     = API_RETURN_SHUTDOWN;
@@ -1639,7 +1733,9 @@ HttpSM::handle_api_return()
       t_state.request_sent_time      = UNDEFINED_TIME;
       t_state.response_received_time = UNDEFINED_TIME;
       cache_sm.close_read();
-      transform_cache_sm.close_read();
+      if (transform_cache_sm) {
+        transform_cache_sm->close_read();
+      }
     }
     // fallthrough
 
@@ -1718,6 +1814,7 @@ HttpSM::handle_api_return()
       HttpTunnelProducer *p = setup_server_transfer();
       perform_cache_write_action();
       tunnel.tunnel_run(p);
+      setup_server_splice(p);
     }
     break;
   }
@@ -2501,7 +2598,8 @@ HttpSM::state_cache_open_write(int event, void *data)
       t_state.cache_open_write_fail_action = t_state.txn_conf->cache_open_write_fail_action;
       // Note that CACHE_LOOKUP_COMPLETE may be invoked more than once
       // if CACHE_WL_FAIL_ACTION_READ_RETRY is configured
-      ink_assert(t_state.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY);
+      ink_assert(t_state.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY ||
+                 t_state.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_COLLAPSE);
       t_state.cache_lookup_result         = HttpTransact::CACHE_LOOKUP_NONE;
       t_state.cache_info.write_lock_state = HttpTransact::CACHE_WL_READ_RETRY;
       break;
@@ -2609,6 +2707,7 @@ HttpSM::state_cache_open_read(int event, void *data)
       t_state.cache_lookup_result = HttpTransact::CACHE_LOOKUP_DOC_BUSY;
     } else {
       t_state.cache_lookup_result = HttpTransact::CACHE_LOOKUP_MISS;
+      t_state.cache_info.admitted = cacheProcessor.admit(cache_sm.get_cache_key());
     }
 
     ink_assert(t_state.transact_return_point == nullptr);
@@ -2632,6 +2731,7 @@ HttpSM::main_handler(int event, void *data)
   HttpSMHandler jump_point = nullptr;
   ink_assert(reentrancy_count >= 0);
   reentrancy_count++;
+  bool timed = cpu_time_start();
 
   // Don't use the state enter macro since it uses history
   //  space that we don't care about
@@ -2658,6 +2758,10 @@ HttpSM::main_handler(int event, void *data)
     (this->*default_handler)(event, data);
   }
 
+  if (timed) {
+    cpu_time_stop();
+  }
+
   // The sub-handler signals when it is time for the state
   //  machine to exit.  We can only exit if we are not reentrantly
   //  called otherwise when the our call unwinds, we will be
@@ -3263,6 +3367,7 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
   STATE_ENTER(&HttpSM::tunnel_handler_ua, event);
   ink_assert(c->vc == ua_txn);
   milestones[TS_MILESTONE_UA_CLOSE] = Thread::get_hrtime();
+  sample_client_tcp_info();
 
   switch (event) {
   case VC_EVENT_EOS:
@@ -4565,7 +4670,12 @@ HttpSM::do_range_setup_if_necessary()
           t_state.hdr_info.client_request.field_delete(MIME_FIELD_RANGE, MIME_LEN_RANGE); // ... and nuke the Range header too
           t_state.num_range_fields = 0;
         } else if (1 == t_state.txn_conf->allow_multi_range) {
-          do_transform = true;
+          if (cache_sm.cache_read_vc->is_pread_capable()) {
+            // The ranges are ascending and apart, the tunnel seeks from one to the next
+            t_state.range_setup = HttpTransact::RANGE_NOT_TRANSFORM_REQUESTED;
+          } else {
+            do_transform = true;
+          }
         } else {
           t_state.num_range_fields = 0;
           t_state.range_setup      = HttpTransact::RANGE_NOT_SATISFIABLE;
@@ -4683,9 +4793,9 @@ inline void
 HttpSM::do_cache_prepare_write_transform()
 {
   if (cache_sm.cache_write_vc != nullptr || tunnel.has_cache_writer()) {
-    do_cache_prepare_action(&transform_cache_sm, nullptr, false, true);
+    do_cache_prepare_action(&get_transform_cache_sm(), nullptr, false, true);
   } else {
-    do_cache_prepare_action(&transform_cache_sm, nullptr, false);
+    do_cache_prepare_action(&get_transform_cache_sm(), nullptr, false);
   }
 }
 
@@ -4770,7 +4880,7 @@ HttpSM::send_origin_throttled_response()
   call_transact_and_set_next_state(HttpTransact::HandleResponse);
 }
 
-static void
+void
 set_tls_options(NetVCOptions &opt, const OverridableHttpConfigParams *txn_conf)
 {
   char *verify_server = nullptr;
@@ -5192,15 +5302,17 @@ HttpSM::do_http_server_open(bool raw)
     if (t_state.server_info.name) {
       opt.set_ssl_servername(t_state.server_info.name);
     }
-
-    connect_action_handle = sslNetProcessor.connect_re(this,                                 // state machine
-                                                       &t_state.current.server->dst_addr.sa, // addr + port
-                                                       &opt);
   } else {
     SMDebug("http", "calling netProcessor.connect_re");
-    connect_action_handle = netProcessor.connect_re(this,                                 // state machine
-                                                    &t_state.current.server->dst_addr.sa, // addr + port
-                                                    &opt);
+  }
+
+  NetProcessor &processor = tls_upstream ? sslNetProcessor : netProcessor;
+  if (ua_txn && HttpConnectRace::eligible(this, opt)) {
+    connect_action_handle = HttpConnectRace::start(this, processor, opt, ua_txn->get_outbound_ip4(), ua_txn->get_outbound_ip6());
+  } else {
+    connect_action_handle = processor.connect_re(this,                                 // state machine
+                                                 &t_state.current.server->dst_addr.sa, // addr + port
+                                                 &opt);
   }
 
   if (connect_action_handle != ACTION_RESULT_DONE) {
@@ -5344,6 +5456,18 @@ HttpSM::mark_host_failure(HostDBInfo *info, time_t time_down)
           ats_ip_nptop(&t_state.current.server->dst_addr.sa, addrbuf, sizeof(addrbuf)));
 }
 
+// The TCP_INFO of the client connection for the log, taken as the transaction starts and again once the response is done.
+void
+HttpSM::sample_client_tcp_info()
+{
+  NetVConnection *netvc = ua_txn ? ua_txn->get_netvc() : nullptr;
+  const TcpInfo *info   = netvc ? netvc->get_tcp_info() : nullptr;
+  if (info) {
+    client_rtt      = ink_hrtime_to_usec(info->rtt);
+    client_snd_cwnd = info->snd_cwnd;
+  }
+}
+
 void
 HttpSM::set_ua_abort(HttpTransact::AbortState_t ua_abort, int event)
 {
@@ -5719,7 +5843,7 @@ HttpSM::setup_transform_to_server_transfer()
 
   int64_t nbytes            = t_state.hdr_info.transform_request_cl;
   int64_t alloc_index       = buffer_size_to_index(nbytes, t_state.http_config_param->max_payload_iobuf_index);
-  MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index);
+  MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = post_buffer->alloc_reader();
 
   HTTP_SM_SET_DEFAULT_HANDLER(&HttpSM::tunnel_handler_post);
@@ -5782,7 +5906,8 @@ HttpSM::do_setup_post_tunnel(HttpVC_t to_vc_type)
       (t_state.redirect_info.redirect_in_process && enable_redirection && this->_postbuf.postdata_copy_buffer_start != nullptr)) {
     post_redirect = true;
     // copy the post data into a new producer buffer for static producer
-    MIOBuffer *postdata_producer_buffer      = new_empty_MIOBuffer(t_state.http_config_param->max_payload_iobuf_index);
+    MIOBuffer *postdata_producer_buffer =
+      new_empty_MIOBuffer(t_state.http_config_param->max_payload_iobuf_index, buffer_account.get());
     IOBufferReader *postdata_producer_reader = postdata_producer_buffer->alloc_reader();
 
     postdata_producer_buffer->write(this->_postbuf.postdata_copy_buffer_start);
@@ -5802,7 +5927,7 @@ HttpSM::do_setup_post_tunnel(HttpVC_t to_vc_type)
       alloc_index =
         buffer_size_to_index(t_state.hdr_info.request_content_length, t_state.http_config_param->max_payload_iobuf_index);
     }
-    MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index);
+    MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index, buffer_account.get());
     IOBufferReader *buf_start = post_buffer->alloc_reader();
     int64_t post_bytes        = chunked ? INT64_MAX : t_state.hdr_info.request_content_length;
 
@@ -5893,14 +6018,16 @@ HttpSM::perform_transform_cache_write_action()
   switch (t_state.cache_info.transform_action) {
   case HttpTransact::CACHE_DO_NO_ACTION: {
     // Nothing to do
-    transform_cache_sm.end_both();
+    if (transform_cache_sm) {
+      transform_cache_sm->end_both();
+    }
     break;
   }
 
   case HttpTransact::CACHE_DO_WRITE: {
-    transform_cache_sm.close_read();
+    get_transform_cache_sm().close_read();
     t_state.cache_info.transform_write_status = HttpTransact::CACHE_WRITE_IN_PROGRESS;
-    setup_cache_write_transfer(&transform_cache_sm, transform_info.entry->vc, &t_state.cache_info.transform_store,
+    setup_cache_write_transfer(transform_cache_sm, transform_info.entry->vc, &t_state.cache_info.transform_store,
                                client_response_hdr_bytes, "cache write t");
     break;
   }
@@ -5973,9 +6100,9 @@ HttpSM::perform_cache_write_action()
     } else {
       // We are not caching the untransformed.  We might want to
       //  use the cache writevc to cache the transformed copy
-      ink_assert(transform_cache_sm.cache_write_vc == nullptr);
-      transform_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
-      cache_sm.cache_write_vc           = nullptr;
+      ink_assert(get_transform_cache_sm().cache_write_vc == nullptr);
+      transform_cache_sm->cache_write_vc = cache_sm.cache_write_vc;
+      cache_sm.cache_write_vc            = nullptr;
     }
     break;
 
@@ -6001,6 +6128,21 @@ HttpSM::issue_cache_update()
   cache_sm.close_write();
 }
 
+int
+HttpSM::write_response_header_into_buffer(HTTPHdr *h, MIOBuffer *b)
+{
+  if (t_state.client_info.http_version == HTTPVersion(0, 9)) {
+    return 0;
+  }
+  // An internal client taking the parsed header gets none of its bytes.
+  PluginVC *pvc = ua_txn ? dynamic_cast<PluginVC *>(ua_txn->get_netvc()) : nullptr;
+  if (pvc && pvc->get_response_sink()) {
+    pvc->get_response_sink()->response_header(h);
+    return 0;
+  }
+  return write_header_into_buffer(h, b);
+}
+
 int
 HttpSM::write_header_into_buffer(HTTPHdr *h, MIOBuffer *b)
 {
@@ -6146,7 +6288,7 @@ HttpSM::setup_server_send_request()
 
   // Send the request header
   server_entry->vc_handler   = &HttpSM::state_send_server_request_header;
-  server_entry->write_buffer = new_MIOBuffer(HTTP_HEADER_BUFFER_SIZE_INDEX);
+  server_entry->write_buffer = new_MIOBuffer(HTTP_HEADER_BUFFER_SIZE_INDEX, buffer_account.get());
 
   if (t_state.api_server_request_body_set) {
     msg_len = t_state.internal_msg_buffer_size;
@@ -6231,9 +6373,9 @@ HttpSM::setup_cache_read_transfer()
                                      t_state.http_config_param->max_payload_iobuf_index);
 
 #ifndef USE_NEW_EMPTY_MIOBUFFER
-  MIOBuffer *buf = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf = new_MIOBuffer(alloc_index, buffer_account.get());
 #else
-  MIOBuffer *buf = new_empty_MIOBuffer(alloc_index);
+  MIOBuffer *buf = new_empty_MIOBuffer(alloc_index, buffer_account.get());
   buf->append_block(HTTP_HEADER_BUFFER_SIZE_INDEX);
 #endif
 
@@ -6282,7 +6424,7 @@ HttpSM::setup_cache_transfer_to_transform()
 
   doc_size                  = t_state.cache_info.object_read->object_size_get();
   alloc_index               = buffer_size_to_index(doc_size, t_state.http_config_param->max_payload_iobuf_index);
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   HTTP_SM_SET_DEFAULT_HANDLER(&HttpSM::state_response_wait_for_transform_read);
@@ -6320,7 +6462,7 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
 void
 HttpSM::setup_100_continue_transfer()
 {
-  MIOBuffer *buf            = new_MIOBuffer(HTTP_HEADER_BUFFER_SIZE_INDEX);
+  MIOBuffer *buf            = new_MIOBuffer(HTTP_HEADER_BUFFER_SIZE_INDEX, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   // First write the client response header into the buffer
@@ -6426,7 +6568,8 @@ HttpSM::setup_internal_transfer(HttpSMHandler handler_arg)
   int64_t buf_size =
     index_to_buffer_size(HTTP_HEADER_BUFFER_SIZE_INDEX) + (is_msg_buf_present ? t_state.internal_msg_buffer_size : 0);
 
-  MIOBuffer *buf            = new_MIOBuffer(buffer_size_to_index(buf_size, t_state.http_config_param->max_payload_iobuf_index));
+  MIOBuffer *buf =
+    new_MIOBuffer(buffer_size_to_index(buf_size, t_state.http_config_param->max_payload_iobuf_index), buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   // First write the client response header into the buffer
@@ -6551,7 +6694,7 @@ HttpSM::setup_server_transfer_to_transform()
   int64_t nbytes;
 
   alloc_index               = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
   nbytes                    = server_transfer_init(buf, 0);
 
@@ -6580,7 +6723,7 @@ HttpSM::setup_transfer_from_transform()
   int64_t alloc_index = find_server_buffer_size();
 
   // TODO change this call to new_empty_MIOBuffer()
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   buf->water_mark           = static_cast<int>(t_state.txn_conf->default_buffer_water_mark);
   IOBufferReader *buf_start = buf->alloc_reader();
 
@@ -6618,7 +6761,7 @@ HttpTunnelProducer *
 HttpSM::setup_transfer_from_transform_to_cache_only()
 {
   int64_t alloc_index       = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   HttpTunnelConsumer *c = tunnel.get_consumer(transform_info.vc);
@@ -6649,7 +6792,7 @@ HttpSM::setup_server_transfer_to_cache_only()
   int64_t nbytes;
 
   alloc_index               = find_server_buffer_size();
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   action = (t_state.current.server && t_state.current.server->transfer_encoding == HttpTransact::CHUNKED_ENCODING) ?
@@ -6680,9 +6823,9 @@ HttpSM::setup_server_transfer()
 
   alloc_index = find_server_buffer_size();
 #ifndef USE_NEW_EMPTY_MIOBUFFER
-  MIOBuffer *buf = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf = new_MIOBuffer(alloc_index, buffer_account.get());
 #else
-  MIOBuffer *buf = new_empty_MIOBuffer(alloc_index);
+  MIOBuffer *buf = new_empty_MIOBuffer(alloc_index, buffer_account.get());
   buf->append_block(HTTP_HEADER_BUFFER_SIZE_INDEX);
 #endif
   buf->water_mark           = static_cast<int>(t_state.txn_conf->default_buffer_water_mark);
@@ -6763,13 +6906,36 @@ HttpSM::setup_server_transfer()
   return p;
 }
 
+// Move the body of a response that goes to the client unchanged from the server socket to the
+// client socket with splice. This has to follow tunnel_run, which sets up the VIOs it works on.
+void
+HttpSM::setup_server_splice(HttpTunnelProducer *p)
+{
+  if (!t_state.http_config_param->splice_server_transfer || !p->alive || p->read_vio == nullptr || p->read_vio->ntodo() <= 0 ||
+      p->num_consumers != 1 || p->chunking_action != TCA_PASSTHRU_DECHUNKED_CONTENT || has_active_plugin_agents ||
+      ua_txn == nullptr || server_session == nullptr) {
+    return;
+  }
+  HttpTunnelConsumer *c = p->consumer_list.head;
+  if (c->vc != ua_entry->vc || !c->alive || c->write_vio == nullptr) {
+    return;
+  }
+  // Only an HTTP/1 session sends the body as is on its connection, which is what chunked
+  // encoding support stands for here.
+  NetVConnection *client = ua_txn->get_netvc();
+  NetVConnection *server = server_session->get_netvc();
+  if (client && server && ua_txn->is_chunked_encoding_supported() && client->splice_from(server)) {
+    SMDebug("http", "splicing the response body from the server");
+  }
+}
+
 HttpTunnelProducer *
 HttpSM::setup_push_transfer_to_cache()
 {
   int64_t nbytes, alloc_index;
 
   alloc_index               = find_http_resp_buffer_size(t_state.hdr_info.request_content_length);
-  MIOBuffer *buf            = new_MIOBuffer(alloc_index);
+  MIOBuffer *buf            = new_MIOBuffer(alloc_index, buffer_account.get());
   IOBufferReader *buf_start = buf->alloc_reader();
 
   ink_release_assert(t_state.hdr_info.request_content_length != HTTP_UNDEFINED_CL);
@@ -6812,8 +6978,8 @@ HttpSM::setup_blind_tunnel(bool send_response_hdr, IOBufferReader *initial)
   HttpTunnelConsumer *c_os;
   HttpTunnelProducer *p_ua;
   HttpTunnelProducer *p_os;
-  MIOBuffer *from_ua_buf = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
-  MIOBuffer *to_ua_buf   = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  MIOBuffer *from_ua_buf = new_MIOBuffer(BUFFER_SIZE_INDEX_32K, buffer_account.get());
+  MIOBuffer *to_ua_buf   = new_MIOBuffer(BUFFER_SIZE_INDEX_32K, buffer_account.get());
   IOBufferReader *r_from = from_ua_buf->alloc_reader();
   IOBufferReader *r_to   = to_ua_buf->alloc_reader();
 
@@ -6946,7 +7112,9 @@ HttpSM::kill_this()
     }
 
     cache_sm.end_both();
-    transform_cache_sm.end_both();
+    if (transform_cache_sm) {
+      transform_cache_sm->end_both();
+    }
     vc_table.cleanup_all();
 
     // tunnel.deallocate_buffers();
@@ -7015,6 +7183,7 @@ HttpSM::kill_this()
     //////////////
     // Log Data //
     //////////////
+    ATS_PROBE1(http_sm_finish, sm_id);
     SMDebug("http_seq", "[HttpSM::update_stats] Logging transaction");
     if (Log::transaction_logging_enabled() && t_state.api_info.logging_enabled) {
       LogAccess accessor(this);
@@ -7059,11 +7228,67 @@ HttpSM::kill_this()
     ink_mutex_release(&debug_sm_list_mutex);
 #endif
 
+    if (buffer_account) {
+      SMDebug("http", "[%" PRId64 "] buffer memory %" PRId64 " bytes, peak %" PRId64, sm_id, buffer_account->bytes(),
+              buffer_account->peak());
+    }
     SMDebug("http", "[%" PRId64 "] deallocating sm", sm_id);
     destroy();
   }
 }
 
+/*
+  Starts measuring the thread CPU time of a handler of the transaction, unless
+  proxy.config.http.transaction_cpu_time is off or an outer handler is measured.
+  @return true if cpu_time_stop() is to be called as the handler returns.
+*/
+bool
+HttpSM::cpu_time_start()
+{
+  if (cpu_time_mark || !t_state.http_config_param->transaction_cpu_time) {
+    return false;
+  }
+  if (cpu_time < 0) {
+    cpu_time = 0;
+  }
+  cpu_time_mark = thread_cpu_time();
+  return true;
+}
+
+void
+HttpSM::cpu_time_stop()
+{
+  cpu_time += thread_cpu_time() - cpu_time_mark;
+  cpu_time_mark = 0;
+}
+
+// Counts the transaction in the latency histogram of each phase it went through.
+void
+HttpSM::update_latency_stats()
+{
+  auto count = [](HttpLatencyPhase phase, ink_hrtime t) {
+    HTTP_INCREMENT_DYN_STAT(http_latency_histogram_stat + phase * HTTP_LATENCY_BUCKETS + http_latency_bucket(t));
+  };
+  auto count_span = [&](HttpLatencyPhase phase, TSMilestonesType start, TSMilestonesType end) {
+    if (milestones[start] != 0 && milestones[end] != 0) {
+      count(phase, milestones.elapsed(start, end));
+    }
+  };
+
+  count_span(HTTP_LATENCY_DNS, TS_MILESTONE_DNS_LOOKUP_BEGIN, TS_MILESTONE_DNS_LOOKUP_END);
+  count_span(HTTP_LATENCY_CONNECT, TS_MILESTONE_SERVER_CONNECT, TS_MILESTONE_SERVER_CONNECT_END);
+  count_span(HTTP_LATENCY_TLS, TS_MILESTONE_TLS_HANDSHAKE_START, TS_MILESTONE_TLS_HANDSHAKE_END);
+  count_span(HTTP_LATENCY_FIRST_BYTE, TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_FIRST_READ);
+  count_span(HTTP_LATENCY_CACHE_OPEN, TS_MILESTONE_CACHE_OPEN_READ_BEGIN, TS_MILESTONE_CACHE_OPEN_READ_END);
+  // the plugin time is kept as an offset from the start of the transaction
+  count_span(HTTP_LATENCY_PLUGIN, TS_MILESTONE_SM_START, TS_MILESTONE_PLUGIN_TOTAL);
+  count_span(HTTP_LATENCY_TOTAL, TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH);
+  if (cpu_time >= 0) {
+    count(HTTP_LATENCY_CPU, cpu_time);
+    HTTP_SUM_DYN_STAT(http_transaction_cpu_time_stat, ink_hrtime_to_usec(cpu_time));
+  }
+}
+
 void
 HttpSM::update_stats()
 {
@@ -7122,6 +7347,7 @@ HttpSM::update_stats()
     &t_state, total_time, ua_write_time, os_read_time, client_request_hdr_bytes, client_request_body_bytes,
     client_response_hdr_bytes, client_response_body_bytes, server_request_hdr_bytes, server_request_body_bytes,
     server_response_hdr_bytes, server_response_body_bytes, pushed_response_hdr_bytes, pushed_response_body_bytes, milestones);
+  update_latency_stats();
   /*
       if (is_action_tag_set("http_handler_times")) {
           print_all_http_handler_times();
@@ -7329,6 +7555,8 @@ HttpSM::call_transact_and_set_next_state(TransactEntryFunc_t f)
 void
 HttpSM::set_next_state()
 {
+  ATS_PROBE2(http_sm_state, sm_id, t_state.next_action);
+
   ///////////////////////////////////////////////////////////////////////
   // Use the returned "next action" code to set the next state handler //
   ///////////////////////////////////////////////////////////////////////
@@ -7551,6 +7779,9 @@ HttpSM::set_next_state()
                t_state.cache_info.action == HttpTransact::CACHE_DO_SERVE_AND_UPDATE);
     release_server_session(true);
     t_state.source = HttpTransact::SOURCE_CACHE;
+    if (t_state.stale_while_revalidate) {
+      HttpRevalidate::launch(this);
+    }
 
     if (transform_info.vc) {
       ink_assert(t_state.hdr_info.client_response.valid() == 0);
@@ -7681,7 +7912,7 @@ HttpSM::set_next_state()
   case HttpTransact::SM_ACTION_CACHE_ISSUE_WRITE_TRANSFORM: {
     ink_assert(t_state.cache_info.transform_action == HttpTransact::CACHE_PREPARE_TO_WRITE);
 
-    if (transform_cache_sm.cache_write_vc) {
+    if (transform_cache_sm && transform_cache_sm->cache_write_vc) {
       // We've already got the write_vc that
       //  didn't use for the untransformed copy
       ink_assert(cache_sm.cache_write_vc == nullptr);
@@ -8255,7 +8486,7 @@ PostDataBuffers::init(IOBufferReader *ua_reader)
   if (this->postdata_copy_buffer == nullptr) {
     this->post_data_buffer_done = false;
     ink_assert(this->postdata_copy_buffer_start == nullptr);
-    this->postdata_copy_buffer       = new_empty_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    this->postdata_copy_buffer       = new_empty_MIOBuffer(BUFFER_SIZE_INDEX_4K, ua_reader->mbuf->_account.get());
     this->postdata_copy_buffer_start = this->postdata_copy_buffer->alloc_reader();
   }
 
@@ -44,6 +44,7 @@
 #include "../ProxyTransaction.h"
 #include "HdrUtils.h"
 #include "tscore/History.h"
+#include "tscore/MemArena.h"
 
 #define HTTP_API_CONTINUE (INK_API_EVENT_EVENTS_START + 0)
 #define HTTP_API_ERROR (INK_API_EVENT_EVENTS_START + 1)
@@ -61,6 +62,7 @@ static size_t const HTTP_SERVER_RESP_HDR_BUFFER_INDEX = BUFFER_SIZE_INDEX_8K;
 
 class Http1ServerSession;
 class AuthHttpAdapter;
+class HttpPluginStats;
 
 class HttpSM;
 typedef int (HttpSM::*HttpSMHandler)(int event, void *data);
@@ -84,17 +86,20 @@ enum BackgroundFill_t {
 
 extern ink_mutex debug_sm_list_mutex;
 
+/// Set the TLS verification options of the origin connection @a opt from @a txn_conf.
+void set_tls_options(NetVCOptions &opt, const OverridableHttpConfigParams *txn_conf);
+
 struct HttpVCTableEntry {
-  VConnection *vc;
-  MIOBuffer *read_buffer;
-  MIOBuffer *write_buffer;
-  VIO *read_vio;
-  VIO *write_vio;
-  HttpSMHandler vc_handler;
-  HttpVC_t vc_type;
-  HttpSM *sm;
-  bool eos;
-  bool in_tunnel;
+  VConnection *vc          = nullptr;
+  MIOBuffer *read_buffer   = nullptr;
+  MIOBuffer *write_buffer  = nullptr;
+  VIO *read_vio            = nullptr;
+  VIO *write_vio           = nullptr;
+  HttpSMHandler vc_handler = nullptr;
+  HttpVC_t vc_type         = HTTP_UNKNOWN;
+  HttpSM *sm               = nullptr;
+  bool eos                 = false;
+  bool in_tunnel           = false;
 };
 
 struct HttpVCTable {
@@ -203,6 +208,7 @@ class HttpSM : public Continuation, public PluginUserArgs<TS_USER_ARGS_TXN>
 {
   friend class HttpPagesHandler;
   friend class CoreUtils;
+  friend class HttpConnectRace;
 
 public:
   HttpSM();
@@ -358,6 +364,8 @@ protected:
 public:
   ProxyTransaction *ua_txn         = nullptr;
   BackgroundFill_t background_fill = BACKGROUND_FILL_NONE;
+  /// Buffer memory of the transaction, charged to the account of the client session as well.
+  Ptr<IOBufferAccount> buffer_account;
   void set_http_schedule(Continuation *);
   int get_http_schedule(int event, void *data);
 
@@ -386,7 +394,9 @@ protected:
   bool has_active_plugin_agents = false;
 
   HttpCacheSM cache_sm;
-  HttpCacheSM transform_cache_sm;
+  /// Allocated by @c get_transform_cache_sm() for the transactions caching a transformed response.
+  HttpCacheSM *transform_cache_sm = nullptr;
+  HttpCacheSM &get_transform_cache_sm();
 
   HttpSMHandler default_handler = nullptr;
   Action *pending_action        = nullptr;
@@ -481,6 +491,7 @@ protected:
   void mark_server_down_on_client_abort();
   void release_server_session(bool serve_from_cache = false);
   void set_ua_abort(HttpTransact::AbortState_t ua_abort, int event);
+  void sample_client_tcp_info();
   int write_header_into_buffer(HTTPHdr *h, MIOBuffer *b);
   int write_response_header_into_buffer(HTTPHdr *h, MIOBuffer *b);
   void setup_blind_tunnel_port();
@@ -492,6 +503,7 @@ protected:
   void setup_server_send_request();
   void setup_server_send_request_api();
   HttpTunnelProducer *setup_server_transfer();
+  void setup_server_splice(HttpTunnelProducer *p);
   void setup_server_transfer_to_cache_only();
   HttpTunnelProducer *setup_cache_read_transfer();
   void setup_internal_transfer(HttpSMHandler handler);
@@ -539,6 +551,8 @@ public:
   int pushed_response_hdr_bytes       = 0;
   int64_t pushed_response_body_bytes  = 0;
   int server_connection_provided_cert = 0;
+  int64_t client_rtt                  = -1; ///< Microseconds, of the client connection, -1 if unknown
+  int64_t client_snd_cwnd             = -1; ///< Segments, of the client connection, -1 if unknown
   bool client_tcp_reused              = false;
   bool client_ssl_reused              = false;
   bool client_connection_is_ssl       = false;
@@ -555,12 +569,29 @@ public:
 
   TransactionMilestones milestones;
   ink_hrtime api_timer = 0;
+  // The stats of the plugin hook called, with when it was called, or
+  // negated, when it returned without reenabling the transaction.
+  HttpPluginStats *api_hook_stats = nullptr;
+  ink_hrtime api_hook_start       = 0;
+  // Thread CPU time spent in the handlers of the transaction, with
+  // proxy.config.http.transaction_cpu_time. cpu_time_mark is when the
+  // outermost handler running started, 0 if none is measured.
+  ink_hrtime cpu_time      = -1;
+  ink_hrtime cpu_time_mark = 0;
+  bool cpu_time_start();
+  void cpu_time_stop();
   // The next two enable plugins to tag the state machine for
   // the purposes of logging so the instances can be correlated
   // with the source plugin.
   const char *plugin_tag = nullptr;
   int64_t plugin_id      = 0;
 
+  // Memory that lives as long as the transaction, for the core and for the
+  // plugins (TSHttpTxnArenaAlloc). Nothing of it is freed on its own, all of
+  // it is released at once when the state machine is cleaned up.
+  static constexpr size_t ARENA_BLOCK_SIZE = 4000;
+  ts::MemArena arena{ARENA_BLOCK_SIZE};
+
   // hooks_set records whether there are any hooks relevant
   //  to this transaction.  Used to avoid costly calls
   //  do_api_callout_internal()
@@ -591,6 +622,7 @@ protected:
   bool parse_range_done     = false;
   void kill_this();
   void update_stats();
+  void update_latency_stats();
   void transform_cleanup(TSHttpHookID hook, HttpTransformInfo *info);
   bool is_transparent_passthrough_allowed();
   void plugin_agents_cleanup();
@@ -656,16 +688,6 @@ HttpSM::allocate()
   return httpSMAllocator.alloc();
 }
 
-inline int
-HttpSM::write_response_header_into_buffer(HTTPHdr *h, MIOBuffer *b)
-{
-  if (t_state.client_info.http_version == HTTPVersion(0, 9)) {
-    return 0;
-  } else {
-    return write_header_into_buffer(h, b);
-  }
-}
-
 inline int
 HttpSM::find_server_buffer_size()
 {
@@ -22,6 +22,7 @@
  */
 
 #include "HttpSessionAccept.h"
+#include "BlindTunnel.h"
 #include "IPAllow.h"
 #include "Http1ClientSession.h"
 #include "I_Machine.h"
@@ -49,6 +50,11 @@ HttpSessionAccept::accept(NetVConnection *netvc, MIOBuffer *iobuf, IOBufferReade
           ats_ip_nptop(client_ip, ipb, sizeof(ipb)), netvc->attributes);
   }
 
+  if (BlindTunnel::eligible(netvc, this, acl)) {
+    BlindTunnel::start(netvc, iobuf, reader, this);
+    return true;
+  }
+
   Http1ClientSession *new_session = THREAD_ALLOC_INIT(http1ClientSessionAllocator, this_ethread());
 
   new_session->accept_options = static_cast<Options *>(this);
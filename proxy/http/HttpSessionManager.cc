@@ -34,6 +34,7 @@
 #include "../ProxySession.h"
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
+#include "ts/sdt.h"
 
 // Initialize a thread to handle HTTP session management
 void
@@ -61,6 +62,18 @@ ServerSessionPool::purge()
   m_fqdn_pool.clear();
 }
 
+int
+ServerSessionPool::count(CryptoHash const &host_hash, in_port_t port)
+{
+  int n = 0;
+  FQDNTable::iterator first, last;
+  std::tie(first, last) = static_cast<const decltype(m_fqdn_pool)::range::super_type &>(m_fqdn_pool.equal_range(host_hash));
+  for (; first != last; ++first) {
+    n += port == ats_ip_port_cast(first->get_remote_addr());
+  }
+  return n;
+}
+
 bool
 ServerSessionPool::match(PoolableSession *ss, sockaddr const *addr, CryptoHash const &hostname_hash,
                          TSServerSessionSharingMatchMask match_style)
@@ -312,10 +325,25 @@ ServerSessionPool::eventHandler(int event, void *data)
 void
 HttpSessionManager::init()
 {
-  m_g_pool = new ServerSessionPool;
+  for (int i = 0; i < m_global_shards; i++) {
+    m_g_pools.push_back(new ServerSessionPool);
+  }
   eventProcessor.schedule_spawn(&initialize_thread_for_http_sessions, ET_NET);
 }
 
+// Sessions matched on the host name are spread over the shards on it, the others on their
+// address, so that the session a transaction matches is in the shard it searches.
+ServerSessionPool *
+HttpSessionManager::_global_pool(sockaddr const *addr, CryptoHash const &hostname_hash,
+                                 TSServerSessionSharingMatchMask match_style) const
+{
+  if (m_g_pools.size() == 1) {
+    return m_g_pools[0];
+  }
+  uint64_t h = (TS_SERVER_SESSION_SHARING_MATCH_MASK_HOSTONLY & match_style) ? hostname_hash.fold() : ats_ip_port_hash(addr);
+  return m_g_pools[h % m_g_pools.size()];
+}
+
 // TODO: Should this really purge all keep-alive sessions?
 // Does this make any sense, since we always do the global pool and not the per thread?
 void
@@ -323,10 +351,12 @@ HttpSessionManager::purge_keepalives()
 {
   EThread *ethread = this_ethread();
 
-  MUTEX_TRY_LOCK(lock, m_g_pool->mutex, ethread);
-  if (lock.is_locked()) {
-    m_g_pool->purge();
-  } // should we do something clever if we don't get the lock?
+  for (ServerSessionPool *pool : m_g_pools) {
+    MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
+    if (lock.is_locked()) {
+      pool->purge();
+    } // should we do something clever if we don't get the lock?
+  }
 }
 
 HSMresult_t
@@ -361,6 +391,7 @@ HttpSessionManager::acquire_session(Continuation * /* cont ATS_UNUSED */, sockad
       Debug("http_ss", "[%" PRId64 "] [acquire session] returning attached session ", to_return->connection_id());
       to_return->state = PoolableSession::SSN_IN_USE;
       sm->attach_server_session(to_return);
+      ATS_PROBE3(http_ss_acquire, sm->sm_id, hostname, HSM_DONE);
       return HSM_DONE;
     }
     // Release this session back to the main session pool and
@@ -384,6 +415,7 @@ HttpSessionManager::acquire_session(Continuation * /* cont ATS_UNUSED */, sockad
                              TS_SERVER_SESSION_SHARING_POOL_HYBRID == this->get_pool_type())) {
     retval = _acquire_session(ip, hostname_hash, sm, match_style, TS_SERVER_SESSION_SHARING_POOL_GLOBAL);
   }
+  ATS_PROBE3(http_ss_acquire, sm->sm_id, hostname, retval);
   return retval;
 }
 
@@ -400,15 +432,15 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
   {
     // Now check to see if we have a connection in our shared connection pool
     EThread *ethread = this_ethread();
-    Ptr<ProxyMutex> pool_mutex =
-      (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) ? ethread->server_session_pool->mutex : m_g_pool->mutex;
-    MUTEX_TRY_LOCK(lock, pool_mutex, ethread);
+    ServerSessionPool *pool = (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) ? ethread->server_session_pool :
+                                                                                     _global_pool(ip, hostname_hash, match_style);
+    MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
     if (lock.is_locked()) {
       if (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) {
-        retval = ethread->server_session_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
+        retval = pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
         Debug("http_ss", "[acquire session] thread pool search %s", to_return ? "successful" : "failed");
       } else {
-        retval = m_g_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
+        retval = pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
         Debug("http_ss", "[acquire session] global pool search %s", to_return ? "successful" : "failed");
         // At this point to_return has been removed from the pool. Do we need to move it
         // to the same thread?
@@ -417,8 +449,8 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
           if (server_vc) {
             // Disable i/o on this vc now, but, hold onto the g_pool cont
             // and the mutex to stop any stray events from getting in
-            server_vc->do_io_read(m_g_pool, 0, nullptr);
-            server_vc->do_io_write(m_g_pool, 0, nullptr);
+            server_vc->do_io_read(pool, 0, nullptr);
+            server_vc->do_io_write(pool, 0, nullptr);
             UnixNetVConnection *new_vc = server_vc->migrateToCurrentThread(sm, ethread);
             // The VC moved, free up the original one
             if (new_vc != server_vc) {
@@ -433,6 +465,7 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
                 // Keep things from timing out on us
                 new_vc->set_inactivity_timeout(new_vc->get_inactivity_timeout());
                 to_return->set_netvc(new_vc);
+                HTTP_INCREMENT_DYN_STAT(http_server_session_pool_migrated_stat);
               }
             } else {
               // Keep things from timing out on us
@@ -447,6 +480,8 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
 
     if (to_return) {
       Debug("http_ss", "[%" PRId64 "] [acquire session] return session from shared pool", to_return->connection_id());
+      HTTP_INCREMENT_DYN_STAT(TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type ? http_server_session_pool_thread_hits_stat :
+                                                                                   http_server_session_pool_global_hits_stat);
       to_return->state = PoolableSession::SSN_IN_USE;
       // the attach_server_session will issue the do_io_read under the sm lock
       sm->attach_server_session(to_return);
@@ -459,11 +494,28 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
 HSMresult_t
 HttpSessionManager::release_session(PoolableSession *to_release)
 {
-  EThread *ethread = this_ethread();
-  ServerSessionPool *pool =
-    TS_SERVER_SESSION_SHARING_POOL_THREAD == to_release->sharing_pool ? ethread->server_session_pool : m_g_pool;
+  EThread *ethread        = this_ethread();
+  ServerSessionPool *pool = TS_SERVER_SESSION_SHARING_POOL_THREAD == to_release->sharing_pool ?
+                              ethread->server_session_pool :
+                              _global_pool(to_release->get_remote_addr(), to_release->hostname_hash, to_release->sharing_match);
   bool released_p = true;
 
+  // A hybrid pool keeps the first idle sessions to an origin in the thread pool, the others overflow
+  // to the global pool where the transactions of any thread find them.
+  if (TS_SERVER_SESSION_SHARING_POOL_HYBRID == this->get_pool_type() && pool != ethread->server_session_pool &&
+      m_thread_max_idle > 0) {
+    ServerSessionPool *local = ethread->server_session_pool;
+    MUTEX_TRY_LOCK(local_lock, local->mutex, ethread);
+    if (local_lock.is_locked()) {
+      if (local->count(to_release->hostname_hash, ats_ip_port_cast(to_release->get_remote_addr())) < m_thread_max_idle) {
+        local->releaseSession(to_release);
+        ATS_PROBE2(http_ss_release, to_release->connection_id(), HSM_DONE);
+        return HSM_DONE;
+      }
+      HTTP_INCREMENT_DYN_STAT(http_server_session_pool_overflow_stat);
+    }
+  }
+
   // The per thread lock looks like it should not be needed but if it's not locked the close checking I/O op will crash.
   MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
   if (lock.is_locked()) {
@@ -478,5 +530,6 @@ HttpSessionManager::release_session(PoolableSession *to_release)
     released_p = false;
   }
 
+  ATS_PROBE2(http_ss_release, to_release->connection_id(), released_p ? HSM_DONE : HSM_RETRY);
   return released_p ? HSM_DONE : HSM_RETRY;
 }
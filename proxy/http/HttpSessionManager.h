@@ -32,6 +32,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "P_EventSystem.h"
 #include "PoolableSession.h"
 #include "tscore/IntrusiveHashMap.h"
@@ -72,6 +74,8 @@ public:
   {
     return m_ip_pool.count();
   }
+  /// The number of sessions in the pool to the host of @a host_hash on @a port, in network order.
+  int count(CryptoHash const &host_hash, in_port_t port);
 
 protected:
   using IPTable   = IntrusiveHashMap<PoolableSession::IPLinkage>;
@@ -125,14 +129,31 @@ public:
   {
     return m_pool_type;
   }
+  /// Set the number of shards of the global pool, before @c init().
+  void
+  set_global_shards(int shards)
+  {
+    m_global_shards = shards < 1 ? 1 : shards;
+  }
+  /// Set the most idle sessions to an origin a thread pool keeps in a hybrid pool before the global pool, 0 for none.
+  void
+  set_thread_max_idle(int max_idle)
+  {
+    m_thread_max_idle = max_idle;
+  }
 
 private:
-  /// Global pool, used if not per thread pools.
+  /// Global pool, used if not per thread pools, in shards each with its own lock.
   /// @internal We delay creating this because the session manager is created during global statics init.
-  ServerSessionPool *m_g_pool = nullptr;
+  std::vector<ServerSessionPool *> m_g_pools;
+  /// The shard of the global pool that holds the sessions to @a addr and @a hostname_hash.
+  ServerSessionPool *_global_pool(sockaddr const *addr, CryptoHash const &hostname_hash,
+                                  TSServerSessionSharingMatchMask match_style) const;
   HSMresult_t _acquire_session(sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
                                TSServerSessionSharingMatchMask match_style, TSServerSessionSharingPoolType pool_type);
   TSServerSessionSharingPoolType m_pool_type = TS_SERVER_SESSION_SHARING_POOL_THREAD;
+  int m_global_shards                        = 1;
+  int m_thread_max_idle                      = 0;
 };
 
 extern HttpSessionManager httpSessionManager;
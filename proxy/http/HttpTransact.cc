@@ -31,6 +31,7 @@
 #include "HttpTransactHeaders.h"
 #include "HttpSM.h"
 #include "HttpCacheSM.h" //Added to get the scope of HttpCacheSM object - YTS Team, yamsat
+#include "HttpRevalidate.h"
 #include "HttpDebugNames.h"
 #include <ctime>
 #include "tscore/ParseRules.h"
@@ -57,6 +58,8 @@ const MgmtConverter HttpTransact::HOST_RES_CONV{[](const void *data) -> std::str
                                                   parse_host_res_preference(src.data(), res_data->order);
                                                 }};
 
+ClassAllocator<OverridableHttpConfigParams> httpTxnConfAllocator("httpTxnConfAllocator");
+
 static char range_type[] = "multipart/byteranges; boundary=RANGE_SEPARATOR";
 #define RANGE_NUMBERS_LENGTH 60
 
@@ -174,13 +177,39 @@ retry_type(HttpTransact::State *s)
 
 // wrapper to choose between a remap next hop strategy or use parent.config
 // remap next hop strategy is preferred
+inline static void
+endNextHopLoad(HttpTransact::State *s, bool answered, bool failed)
+{
+  if (s->next_hop_load) {
+    ink_hrtime now   = Thread::get_hrtime();
+    ink_hrtime start = s->state_machine->milestones[TS_MILESTONE_SERVER_CONNECT];
+    s->next_hop_load->load_end(now, answered && start ? now - start : -1, failed);
+    s->next_hop_load = nullptr;
+  }
+}
+
+// counts the request to the next hop selected by a strategy that tracks their load in flight,
+// until it is answered, a new one is selected or the transaction ends.
+inline static void
+startNextHopLoad(HttpTransact::State *s, NextHopSelectionStrategy *strategy)
+{
+  endNextHopLoad(s, false, false);
+  if (s->parent_result.result == PARENT_SPECIFIED) {
+    s->next_hop_load = strategy->loadOf(&s->parent_result);
+    if (s->next_hop_load) {
+      s->next_hop_load->load_start();
+    }
+  }
+}
+
 inline static void
 findParent(HttpTransact::State *s)
 {
   url_mapping *mp = s->url_map.getMapping();
 
   if (mp && mp->strategy) {
-    return mp->strategy->findNextHop(reinterpret_cast<TSHttpTxn>(s->state_machine));
+    mp->strategy->findNextHop(reinterpret_cast<TSHttpTxn>(s->state_machine));
+    return startNextHopLoad(s, mp->strategy.get());
   } else if (s->parent_params) {
     return s->parent_params->findParent(&s->request_data, &s->parent_result, s->txn_conf->parent_fail_threshold,
                                         s->txn_conf->parent_retry_time);
@@ -239,7 +268,8 @@ nextParent(HttpTransact::State *s)
   url_mapping *mp = s->url_map.getMapping();
   if (mp && mp->strategy) {
     // NextHop only has a findNextHop() function.
-    return mp->strategy->findNextHop(reinterpret_cast<TSHttpTxn>(s->state_machine));
+    mp->strategy->findNextHop(reinterpret_cast<TSHttpTxn>(s->state_machine));
+    return startNextHopLoad(s, mp->strategy.get());
   } else if (s->parent_params) {
     return s->parent_params->nextParent(&s->request_data, &s->parent_result, s->txn_conf->parent_fail_threshold,
                                         s->txn_conf->parent_retry_time);
@@ -2571,7 +2601,7 @@ HttpTransact::HandleCacheOpenReadHitFreshness(State *s)
   }
 
   if (!s->force_dns) { // If DNS is not performed before
-    if (need_to_revalidate(s)) {
+    if (!is_simple_fresh_hit(s, obj) && need_to_revalidate(s)) {
       TRANSACT_RETURN(SM_ACTION_API_CACHE_LOOKUP_COMPLETE,
                       CallOSDNSLookup); // content needs to be revalidated and we did not perform a dns ....calling DNS lookup
     } else {                            // document can be served can cache
@@ -2730,6 +2760,22 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
     obj = s->cache_info.object_read;
   }
 
+  if (is_simple_fresh_hit(s, obj)) {
+    TxnDebug("http_trans", "CacheOpenRead --- HIT-FRESH, fast path");
+    HTTP_INCREMENT_DYN_STAT(http_cache_hit_fast_path_stat);
+    SET_VIA_STRING(VIA_CACHE_RESULT, SQUID_HIT_RAM == s->cache_info.hit_miss_code ? VIA_IN_RAM_CACHE_FRESH : VIA_IN_CACHE_FRESH);
+    SET_VIA_STRING(VIA_DETAIL_CACHE_LOOKUP, VIA_DETAIL_HIT_SERVED);
+    build_response(s, obj->response_get(), &s->hdr_info.client_response, s->client_info.http_version);
+    if (s->method == HTTP_WKSIDX_GET) {
+      s->cache_info.action = CACHE_DO_SERVE;
+      s->next_action       = SM_ACTION_SERVE_FROM_CACHE;
+    } else {
+      s->cache_info.action = CACHE_DO_NO_ACTION;
+      s->next_action       = SM_ACTION_INTERNAL_CACHE_NOOP;
+    }
+    return;
+  }
+
   // do we have to authenticate with the server before
   // sending back the cached response to the client?
   Authentication_t authentication_needed = AuthenticationNeeded(s->txn_conf, &s->hdr_info.client_request, obj->response_get());
@@ -2928,7 +2974,8 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
   }
 
   if (s->cache_lookup_result == CACHE_LOOKUP_HIT_WARNING) {
-    build_response_from_cache(s, HTTP_WARNING_CODE_HERUISTIC_EXPIRATION);
+    HTTPWarningCode warning = s->stale_while_revalidate ? HTTP_WARNING_CODE_RESPONSE_STALE : HTTP_WARNING_CODE_HERUISTIC_EXPIRATION;
+    build_response_from_cache(s, warning);
   } else if (s->cache_lookup_result == CACHE_LOOKUP_HIT_STALE) {
     ink_assert(server_up == false);
     build_response_from_cache(s, HTTP_WARNING_CODE_REVALIDATION_FAILED);
@@ -3146,7 +3193,8 @@ HttpTransact::handle_cache_write_lock(State *s)
       //  Write failed and read retry triggered
       //  Clean up server_request and re-initiate
       //  Cache Lookup
-      ink_assert(s->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY);
+      ink_assert(s->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY ||
+                 s->cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_COLLAPSE);
       s->cache_info.write_status = CACHE_WRITE_LOCK_MISS;
       StateMachineAction_t next;
       next           = SM_ACTION_CACHE_LOOKUP;
@@ -3255,6 +3303,8 @@ HttpTransact::HandleCacheOpenReadMiss(State *s)
     s->cache_info.action = CACHE_DO_NO_ACTION;
   } else if (s->api_server_response_no_store) { // plugin may have decided not to cache the response
     s->cache_info.action = CACHE_DO_NO_ACTION;
+  } else if (!s->cache_info.admitted) { // not requested often enough yet to displace other documents
+    s->cache_info.action = CACHE_DO_NO_ACTION;
   } else {
     s->cache_info.action = CACHE_PREPARE_TO_WRITE;
   }
@@ -3548,6 +3598,7 @@ HttpTransact::handle_response_from_parent(State *s)
   HTTP_RELEASE_ASSERT(s->current.server == &s->parent_info);
 
   simple_or_unavailable_server_retry(s);
+  endNextHopLoad(s, true, s->current.state != CONNECTION_ALIVE);
 
   s->parent_info.state = s->current.state;
   switch (s->current.state) {
@@ -5866,6 +5917,46 @@ HttpTransact::initialize_state_variables_from_response(State *s, HTTPHdr *incomi
   s->current.server->transfer_encoding = NO_TRANSFER_ENCODING;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Name       : is_simple_fresh_hit()
+// Description: check if a fresh cached response is served as is
+//
+// Input      : State, the cached object
+// Output     : true or false
+//
+// Details    :
+//
+// A fresh hit on a GET or HEAD with no conditional, range, credential,
+// cookie or cache directive in the request, and no Vary, authentication,
+// cookie or no-cache in the cached 200 response, with no response
+// transform. All the checks of need_to_revalidate(), HandleCacheOpenReadHit()
+// and build_response_from_cache() pass for such a hit, they are skipped.
+//
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::is_simple_fresh_hit(State *s, CacheHTTPInfo *obj)
+{
+  static constexpr uint64_t REQUEST_FIELDS =
+    MIME_PRESENCE_IF_MATCH | MIME_PRESENCE_IF_MODIFIED_SINCE | MIME_PRESENCE_IF_NONE_MATCH | MIME_PRESENCE_IF_RANGE |
+    MIME_PRESENCE_IF_UNMODIFIED_SINCE | MIME_PRESENCE_RANGE | MIME_PRESENCE_AUTHORIZATION | MIME_PRESENCE_COOKIE |
+    MIME_PRESENCE_CACHE_CONTROL | MIME_PRESENCE_PRAGMA;
+  static constexpr uint64_t RESPONSE_FIELDS = MIME_PRESENCE_VARY | MIME_PRESENCE_SET_COOKIE | MIME_PRESENCE_WWW_AUTHENTICATE;
+
+  if (s->cache_lookup_result != CACHE_LOOKUP_HIT_FRESH || s->api_update_cached_object != UPDATE_CACHED_OBJECT_NONE ||
+      (s->method != HTTP_WKSIDX_GET && s->method != HTTP_WKSIDX_HEAD) || s->cache_control.never_cache ||
+      !s->cache_info.directives.does_client_permit_lookup || s->hdr_info.client_request.presence(REQUEST_FIELDS)) {
+    return false;
+  }
+  HTTPHdr *response = obj->response_get();
+  if (response->status_get() != HTTP_STATUS_OK || response->presence(RESPONSE_FIELDS) ||
+      ((response->get_cooked_cc_mask() & MIME_COOKED_MASK_CC_NO_CACHE) && !s->cache_control.ignore_server_no_cache) ||
+      response->field_find("@WWW-Auth", 9)) {
+    return false;
+  }
+  // build_response_from_cache() opens the transforms
+  return !s->state_machine->txn_hook_get(TS_HTTP_RESPONSE_TRANSFORM_HOOK) && !is_action_tag_set("http_nullt");
+}
+
 bool
 HttpTransact::is_cache_response_returnable(State *s)
 {
@@ -7199,6 +7290,50 @@ HttpTransact::calculate_document_freshness_limit(State *s, HTTPHdr *response, ti
   return (freshness_limit);
 }
 
+// The stale-while-revalidate window of a cached response (RFC 5861), in seconds, 0 if it has none.
+static int
+stale_while_revalidate_window(HTTPHdr *response)
+{
+  MIMEField *field = response->field_find(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL);
+  if (field == nullptr) {
+    return 0;
+  }
+
+  static constexpr ts::TextView DIRECTIVE{"stale-while-revalidate"};
+  HdrCsvIter iter;
+  int len;
+  for (const char *value = iter.get_first(field, &len); value; value = iter.get_next(&len)) {
+    ts::TextView text{value, static_cast<size_t>(len)};
+    ts::TextView name = text.split_prefix_at('=');
+    if (strcasecmp(name.trim_if(&ParseRules::is_ws), DIRECTIVE) == 0) {
+      return std::max<intmax_t>(0, std::min<intmax_t>(INT_MAX, ts::svtoi(text.trim_if(&ParseRules::is_ws))));
+    }
+  }
+  return 0;
+}
+
+// Whether the stale response can be served while it is revalidated in the background.
+static bool
+is_stale_while_revalidate_allowed(HttpTransact::State *s, HTTPHdr *cached_response, time_t staleness)
+{
+  if (!s->http_config_param->cache_stale_while_revalidate) {
+    return false;
+  }
+  // the background revalidations themselves must reach the origin
+  const char *tag = s->state_machine->plugin_tag;
+  if (tag && strcmp(tag, HttpRevalidate::TAG) == 0) {
+    return false;
+  }
+  if (s->method != HTTP_WKSIDX_GET && s->method != HTTP_WKSIDX_HEAD) {
+    return false;
+  }
+  HTTPHdr *client_request = &s->hdr_info.client_request;
+  if (client_request->is_pragma_no_cache_set() || client_request->is_cache_control_set(HTTP_VALUE_NO_CACHE)) {
+    return false;
+  }
+  return staleness <= stale_while_revalidate_window(cached_response);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //
@@ -7392,6 +7527,13 @@ HttpTransact::what_is_document_freshness(State *s, HTTPHdr *client_request, HTTP
   // now, see if the age is "fresh enough" //
   ///////////////////////////////////////////
 
+  if (!do_revalidate && age_limit == fresh_limit && current_age > age_limit && !os_specifies_revalidate &&
+      is_stale_while_revalidate_allowed(s, cached_obj_response, current_age - fresh_limit)) {
+    TxnDebug("http_match", "[..._document_freshness] document is stale within its stale-while-revalidate window; "
+                           "returning FRESHNESS_WARNING");
+    s->stale_while_revalidate = true;
+    return (FRESHNESS_WARNING);
+  }
   if (do_revalidate || !age_limit || current_age > age_limit) { // client-modified limit
     TxnDebug("http_match", "[..._document_freshness] document needs revalidate/too old; "
                            "returning FRESHNESS_STALE");
@@ -70,6 +70,7 @@
 typedef time_t ink_time_t;
 
 struct HttpConfigParams;
+struct HostRecord;
 class HttpSM;
 
 #include "tscore/InkErrno.h"
@@ -202,6 +203,9 @@ struct HttpApiInfo {
 
 const int32_t HTTP_UNDEFINED_CL = -1;
 
+/// The copies of the configuration changed for a transaction.
+extern ClassAllocator<OverridableHttpConfigParams> httpTxnConfAllocator;
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //  HttpTransact
@@ -506,6 +510,7 @@ public:
     SquidHitMissCode hit_miss_code    = SQUID_MISS_NONE;
     URL *parent_selection_url         = nullptr;
     URL parent_selection_url_storage;
+    bool admitted = true; // false if the cache admission filter turned the miss away
 
     _CacheLookupInfo() {}
   } CacheLookupInfo;
@@ -675,6 +680,7 @@ public:
     bool force_dns                                            = false;
     MgmtByte cache_open_write_fail_action                     = 0;
     bool is_revalidation_necessary = false; // Added to check if revalidation is necessary - YTS Team, yamsat
+    bool stale_while_revalidate    = false; // stale response served, revalidated in the background
     ConnectionAttributes client_info;
     ConnectionAttributes parent_info;
     ConnectionAttributes server_info;
@@ -694,6 +700,7 @@ public:
     HttpRequestData request_data;
     ParentConfigParams *parent_params                           = nullptr;
     std::shared_ptr<NextHopSelectionStrategy> next_hop_strategy = nullptr;
+    HostRecord *next_hop_load                                   = nullptr; // in flight, for the peak_ewma policy
     ParentResult parent_result;
     CacheControlResult cache_control;
     CacheLookupResult_t cache_lookup_result = CACHE_LOOKUP_NONE;
@@ -800,13 +807,10 @@ public:
 
     OverridableHttpConfigParams const *txn_conf = nullptr;
     OverridableHttpConfigParams &
-    my_txn_conf() // Storage for plugins, to avoid malloc
+    my_txn_conf() // The copy of the configuration for the transaction, made for the first change
     {
-      auto p = reinterpret_cast<OverridableHttpConfigParams *>(_my_txn_conf);
-
-      ink_assert(p == txn_conf);
-
-      return *p;
+      setup_per_txn_configs();
+      return *_my_txn_conf;
     }
 
     bool transparent_passthrough = false;
@@ -875,6 +879,11 @@ public:
       unmapped_url.clear();
       hostdb_entry.clear();
       outbound_conn_track_state.clear();
+      if (_my_txn_conf) {
+        httpTxnConfAllocator.free(_my_txn_conf);
+        _my_txn_conf = nullptr;
+        txn_conf     = nullptr;
+      }
 
       delete[] ranges;
       ranges      = nullptr;
@@ -886,10 +895,12 @@ public:
     void
     setup_per_txn_configs()
     {
-      if (txn_conf != reinterpret_cast<OverridableHttpConfigParams *>(_my_txn_conf)) {
-        txn_conf = reinterpret_cast<OverridableHttpConfigParams *>(_my_txn_conf);
-        memcpy(_my_txn_conf, &http_config_param->oride, sizeof(_my_txn_conf));
+      if (!_my_txn_conf) {
+        _my_txn_conf = httpTxnConfAllocator.alloc();
+        memcpy(static_cast<void *>(_my_txn_conf), &http_config_param->oride, sizeof(*_my_txn_conf));
+        HTTP_SUM_DYN_STAT(http_sm_extension_bytes_stat, sizeof(*_my_txn_conf));
       }
+      txn_conf = _my_txn_conf;
     }
 
     void
@@ -909,8 +920,9 @@ public:
     ProxyProtocol pp_info;
 
   private:
-    // Make this a raw byte array, so it will be accessed through the my_txn_conf() member function.
-    alignas(OverridableHttpConfigParams) char _my_txn_conf[sizeof(OverridableHttpConfigParams)];
+    // Allocated on the first change, most transactions run with the global configuration.
+    // Accessed through the my_txn_conf() member function.
+    OverridableHttpConfigParams *_my_txn_conf = nullptr;
 
   }; // End of State struct.
 
@@ -1002,6 +1014,7 @@ public:
   static void initialize_state_variables_from_response(State *s, HTTPHdr *incoming_response);
   static bool is_server_negative_cached(State *s);
   static bool is_cache_response_returnable(State *s);
+  static bool is_simple_fresh_hit(State *s, CacheHTTPInfo *obj);
   static bool is_stale_cache_response_returnable(State *s);
   static bool need_to_revalidate(State *s);
   static bool url_looks_dynamic(URL *url);
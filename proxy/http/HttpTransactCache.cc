@@ -29,7 +29,9 @@
 #include <ctime>
 #include "HTTP.h"
 #include "HttpCompat.h"
+#include "HdrUtils.h"
 #include "tscore/InkErrno.h"
+#include "tscore/HashFNV.h"
 
 /**
   Find the pointer and length of an etag, after stripping off any leading
@@ -150,6 +152,141 @@ is_empty(char *s)
   return (s[0] == NUL);
 }
 
+/**
+  Hash the values @a request has for the fields named by the Vary of @a response, comparing
+  them the way CalcVariability() does, so two requests that do not vary for @a response get the
+  same @a fingerprint. The names taken into account go to @a names, which tells apart the
+  fingerprints of alternates with different Vary headers.
+
+  @return @c false if @a response has no Vary, or varies on everything.
+
+*/
+static bool
+vary_fingerprint(const OverridableHttpConfigParams *http_config_params, HTTPHdr *request, HTTPHdr *response, uint64_t *names,
+                 uint64_t *fingerprint)
+{
+  StrList vary_list;
+  ATSHash64FNV1a names_hash, values_hash;
+
+  if (!response->presence(MIME_PRESENCE_VARY) || response->value_get_comma_list(MIME_FIELD_VARY, MIME_LEN_VARY, &vary_list) <= 0) {
+    return false;
+  }
+
+  for (Str *field = vary_list.head; field != nullptr; field = field->next) {
+    if (field->len == 0) {
+      continue;
+    }
+    if ((field->str[0] == '*') && (field->str[1] == NUL)) {
+      return false;
+    }
+    if (http_config_params->global_user_agent_header && !strcasecmp(field->str, "User-Agent")) {
+      continue;
+    }
+    if (http_config_params->ignore_accept_encoding_mismatch && !strcasecmp(field->str, "Accept-Encoding")) {
+      continue;
+    }
+    names_hash.update(field->str, field->len, ATSHash::nocase());
+    names_hash.update(",", 1);
+
+    const char *field_name_str = hdrtoken_string_to_wks(field->str, field->len);
+    if (field_name_str == nullptr) {
+      field_name_str = field->str;
+    }
+
+    // An absent field only matches an absent one, a present one hashes at least the separator.
+    MIMEField *request_field = request->field_find(field_name_str, field->len);
+    values_hash.update(request_field ? ":" : "!", 1);
+    if (request_field) {
+      HdrCsvIter iter;
+      int value_len;
+      for (const char *value = iter.get_first(request_field, &value_len); value; value = iter.get_next(&value_len)) {
+        values_hash.update(value, value_len, ATSHash::nocase());
+        values_hash.update(",", 1);
+      }
+    }
+  }
+
+  names_hash.final();
+  values_hash.final();
+  *names       = names_hash.get();
+  *fingerprint = values_hash.get();
+  return true;
+}
+
+/**
+  Look for an alternate stored for a request with the same values in the fields named by its Vary,
+  which RFC 7234 allows to be served without comparing any other header. Fingerprints of these
+  values are compared first, so the Accept headers of the alternates are never parsed, and a
+  fingerprint match is confirmed by CalcVariability() before it is taken. The freshest of several
+  matching alternates wins.
+
+  @return index in cache alternates vector, -1 if no alternate matches exactly.
+
+*/
+static int
+select_by_vary_fingerprint(CacheHTTPInfoVector *cache_vector, HTTPHdr *client_request,
+                           const OverridableHttpConfigParams *http_config_params)
+{
+  int alt_count         = cache_vector->count();
+  int best_index        = -1;
+  time_t best_age       = CacheHighAgeWatermark;
+  time_t t_now          = 0;
+  uint64_t client_names = 0, client_fingerprint = 0;
+  bool client_valid     = false;
+
+  for (int i = 0; i < alt_count; i++) {
+    vec_info &alt      = cache_vector->data[i];
+    CacheHTTPInfo *obj = &alt.alternate;
+    if (obj->object_key_get() == zero_key) {
+      continue;
+    }
+
+    HTTPHdr *cached_request  = obj->request_get();
+    HTTPHdr *cached_response = obj->response_get();
+    if (alt.vary_state == 0) {
+      bool found     = vary_fingerprint(http_config_params, cached_request, cached_response, &alt.vary_names,
+                                    &alt.vary_fingerprint);
+      alt.vary_state = found ? 1 : -1;
+    }
+    if (alt.vary_state < 0) {
+      continue;
+    }
+
+    // Alternates nearly always share one Vary, the client fingerprint is recomputed only when it changes.
+    if (!client_valid || client_names != alt.vary_names) {
+      client_valid = vary_fingerprint(http_config_params, client_request, cached_response, &client_names, &client_fingerprint);
+      if (!client_valid || client_names != alt.vary_names) {
+        continue;
+      }
+    }
+    if (client_fingerprint != alt.vary_fingerprint) {
+      continue;
+    }
+    // Fingerprints can collide, a false match could serve the wrong content.
+    Variability_t variability = HttpTransactCache::CalcVariability(http_config_params, client_request, cached_request,
+                                                                   cached_response);
+    if (variability != VARIABILITY_NONE) {
+      continue;
+    }
+
+    if (t_now == 0) {
+      t_now = ink_local_time();
+    }
+    time_t current_age = HttpTransactHeaders::calculate_document_age(obj->request_sent_time_get(),
+                                                                     obj->response_received_time_get(), cached_response,
+                                                                     cached_response->get_date(), t_now);
+    if (current_age < 0) {
+      current_age = CacheHighAgeWatermark;
+    }
+    if (best_index == -1 || current_age <= best_age) {
+      best_age   = current_age;
+      best_index = i;
+    }
+  }
+
+  return best_index;
+}
+
 /**
   Given a set of alternates, select the best match.
 
@@ -189,6 +326,15 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
+  // Plugins selecting alternates and PURGE requests need every alternate to be scored.
+  if (client_request->method_get_wksidx() != HTTP_WKSIDX_PURGE && http_global_hooks->get(TS_HTTP_SELECT_ALT_HOOK) == nullptr) {
+    int exact_index = select_by_vary_fingerprint(cache_vector, client_request, http_config_params);
+    if (exact_index != -1) {
+      Debug("http_seq", "[SelectFromAlternates] Alternate # %d matches the Vary of the request", exact_index);
+      return exact_index;
+    }
+  }
+
   for (int i = 0; i < alt_count; i++) {
     float Q;
     CacheHTTPInfo *obj       = cache_vector->get(i);
@@ -37,6 +37,8 @@
 #include "HttpDebugNames.h"
 #include "tscore/ParseRules.h"
 
+#include <algorithm>
+
 static const int min_block_transfer_bytes = 256;
 static const char *const CHUNK_HEADER_FMT = "%" PRIx64 "\r\n";
 // This should be as small as possible because it will only hold the
@@ -44,6 +46,41 @@ static const char *const CHUNK_HEADER_FMT = "%" PRIx64 "\r\n";
 // a block in the input stream.
 static int const CHUNK_IOBUFFER_SIZE_INDEX = MIN_IOBUFFER_SIZE;
 
+// The parts of a multi range response, as RangeTransform writes them.
+static const char RANGE_BOUNDARY[]     = "--RANGE_SEPARATOR\r\n";
+static const char RANGE_BOUNDARY_END[] = "\r\n--RANGE_SEPARATOR--\r\n";
+static const char RANGE_CONT_TYPE[]    = "Content-type: ";
+static const char RANGE_CONT_RANGE[]   = "\r\nContent-range: bytes ";
+
+// The value of hex digit @a c, -1 if it is not one.
+static inline int
+hex_value(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c |= 0x20;
+  return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// Format a chunk header for @a size in @a buf, large enough for 16 digits and the CRLF.
+// @return The length of the header.
+static inline int
+format_chunk_header(char *buf, int64_t size)
+{
+  static const char digits[] = "0123456789abcdef";
+  int n                      = 1;
+  for (uint64_t v = size; v >>= 4;) {
+    ++n;
+  }
+  for (int i = n - 1; i >= 0; --i, size >>= 4) {
+    buf[i] = digits[size & 0xf];
+  }
+  buf[n]     = '\r';
+  buf[n + 1] = '\n';
+  return n + 2;
+}
+
 ChunkedHandler::ChunkedHandler() : max_chunk_size(DEFAULT_MAX_CHUNK_SIZE) {}
 
 void
@@ -73,12 +110,12 @@ ChunkedHandler::init_by_action(IOBufferReader *buffer_in, Action action)
   case ACTION_DOCHUNK:
     dechunked_reader                   = buffer_in->mbuf->clone_reader(buffer_in);
     dechunked_reader->mbuf->water_mark = min_block_transfer_bytes;
-    chunked_buffer                     = new_MIOBuffer(CHUNK_IOBUFFER_SIZE_INDEX);
+    chunked_buffer                     = new_MIOBuffer(CHUNK_IOBUFFER_SIZE_INDEX, buffer_in->mbuf->_account.get());
     chunked_size                       = 0;
     break;
   case ACTION_DECHUNK:
     chunked_reader   = buffer_in->mbuf->clone_reader(buffer_in);
-    dechunked_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_256);
+    dechunked_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_256, buffer_in->mbuf->_account.get());
     dechunked_size   = 0;
     break;
   case ACTION_PASSTHRU:
@@ -116,62 +153,66 @@ ChunkedHandler::set_max_chunk_size(int64_t size)
   max_chunk_header_len = snprintf(max_chunk_header, sizeof(max_chunk_header), CHUNK_HEADER_FMT, max_chunk_size);
 }
 
+// Parse the size line of the next chunk, a block at a time. The digits are accumulated in a
+// tight loop and the line feeds, ending the CRLF after the previous chunk and the size line
+// with its extensions, are found with memchr().
 void
 ChunkedHandler::read_size()
 {
-  int64_t bytes_used;
   bool done = false;
 
   while (chunked_reader->read_avail() > 0 && !done) {
-    const char *tmp   = chunked_reader->start();
-    int64_t data_size = chunked_reader->block_read_avail();
+    const char *start = chunked_reader->start();
+    const char *end   = start + chunked_reader->block_read_avail();
+    const char *tmp   = start;
 
-    ink_assert(data_size > 0);
-    bytes_used = 0;
+    ink_assert(end > start);
 
-    while (data_size > 0) {
-      bytes_used++;
+    while (tmp < end && !done) {
       if (state == CHUNK_READ_SIZE) {
         // The http spec says the chunked size is always in hex
-        if (ParseRules::is_hex(*tmp)) {
-          num_digits++;
-          running_sum *= 16;
-
-          if (ParseRules::is_digit(*tmp)) {
-            running_sum += *tmp - '0';
-          } else {
-            running_sum += ParseRules::ink_tolower(*tmp) - 'a' + 10;
-          }
-        } else {
-          // We are done parsing size
-          if (num_digits == 0 || running_sum < 0) {
-            // Bogus chunk size
-            state = CHUNK_READ_ERROR;
-            done  = true;
+        int digit;
+        while (tmp < end && (digit = hex_value(*tmp)) >= 0) {
+          if (running_sum > (INT_MAX - digit) / 16) {
+            running_sum = -1;
             break;
-          } else {
-            state = CHUNK_READ_SIZE_CRLF; // now look for CRLF
           }
+          running_sum = running_sum * 16 + digit;
+          num_digits++;
+          tmp++;
+        }
+        if (tmp == end) {
+          break;
+        }
+        // We are done parsing size, the character ending it is consumed
+        tmp++;
+        if (num_digits == 0 || running_sum < 0) {
+          // Bogus chunk size
+          state = CHUNK_READ_ERROR;
+          done  = true;
+        } else {
+          state = CHUNK_READ_SIZE_CRLF; // now look for CRLF
         }
-      } else if (state == CHUNK_READ_SIZE_CRLF) { // Scan for a linefeed
-        if (ParseRules::is_lf(*tmp)) {
+      } else {
+        const char *lf = static_cast<const char *>(memchr(tmp, '\n', end - tmp));
+        if (lf == nullptr) {
+          tmp = end;
+          break;
+        }
+        tmp = lf + 1;
+        if (state == CHUNK_READ_SIZE_CRLF) {
           Debug("http_chunk", "read chunk size of %d bytes", running_sum);
           bytes_left = (cur_chunk_size = running_sum);
           state      = (running_sum == 0) ? CHUNK_READ_TRAILER_BLANK : CHUNK_READ_CHUNK;
           done       = true;
-          break;
-        }
-      } else if (state == CHUNK_READ_SIZE_START) {
-        if (ParseRules::is_lf(*tmp)) {
+        } else if (state == CHUNK_READ_SIZE_START) {
           running_sum = 0;
           num_digits  = 0;
           state       = CHUNK_READ_SIZE;
         }
       }
-      tmp++;
-      data_size--;
     }
-    chunked_reader->consume(bytes_used);
+    chunked_reader->consume(tmp - start);
   }
 }
 
@@ -314,7 +355,7 @@ ChunkedHandler::process_chunked_content()
 bool
 ChunkedHandler::generate_chunked_content()
 {
-  char tmp[16];
+  char tmp[20];
   bool server_done = false;
   int64_t r_avail;
 
@@ -330,13 +371,17 @@ ChunkedHandler::generate_chunked_content()
 
   while ((r_avail = dechunked_reader->read_avail()) > 0 && state != CHUNK_WRITE_DONE) {
     int64_t write_val = std::min(max_chunk_size, r_avail);
+    // What is available beyond a chunk goes out as one larger chunk, if allowed.
+    if (r_avail > max_chunk_size && max_batch_size > max_chunk_size) {
+      write_val = std::min(max_batch_size, r_avail);
+    }
 
     state = CHUNK_WRITE_CHUNK;
     Debug("http_chunk", "creating a chunk of size %" PRId64 " bytes", write_val);
 
     // Output the chunk size.
     if (write_val != max_chunk_size) {
-      int len = snprintf(tmp, sizeof(tmp), CHUNK_HEADER_FMT, write_val);
+      int len = format_chunk_header(tmp, write_val);
       chunked_buffer->write(tmp, len);
       chunked_size += len;
     } else {
@@ -462,6 +507,9 @@ HttpTunnel::init(HttpSM *sm_arg, Ptr<ProxyMutex> &amutex)
   }
   // This should always be true, we handled default cases back in HttpConfig::reconfigure()
   ink_assert(flow_state.low_water <= flow_state.high_water);
+  flow_state.max_water  = flow_state.high_water;
+  flow_state.min_water  = flow_state.low_water;
+  flow_state.drain_time = HRTIME_MSECONDS(params->flow_drain_time);
 }
 
 void
@@ -477,11 +525,14 @@ HttpTunnel::reset()
   }
 #endif
 
-  call_sm       = false;
-  num_producers = 0;
-  num_consumers = 0;
-  ink_zero(consumers);
-  ink_zero(producers);
+  // entries are allocated from the start of the tables, only those in use need clearing
+  memset(static_cast<void *>(consumers), 0, sizeof(consumers[0]) * num_consumers);
+  memset(static_cast<void *>(producers), 0, sizeof(producers[0]) * num_producers);
+  call_sm               = false;
+  num_producers         = 0;
+  num_consumers         = 0;
+  flow_state.high_water = flow_state.max_water;
+  flow_state.low_water  = flow_state.min_water;
 }
 
 void
@@ -581,6 +632,7 @@ void
 HttpTunnel::set_producer_chunking_size(HttpTunnelProducer *p, int64_t size)
 {
   p->chunked_handler.set_max_chunk_size(size);
+  p->chunked_handler.max_batch_size = sm->t_state.http_config_param->http_chunking_batch_size;
 }
 
 // HttpTunnelProducer* HttpTunnel::add_producer
@@ -801,10 +853,16 @@ HttpTunnel::producer_run(HttpTunnelProducer *p)
 
   int64_t read_start_pos = 0;
   if (p->vc_type == HT_CACHE_READ && sm->t_state.range_setup == HttpTransact::RANGE_NOT_TRANSFORM_REQUESTED) {
-    ink_assert(sm->t_state.num_range_fields == 1); // we current just support only one range entry
     read_start_pos = sm->t_state.ranges[0]._start;
     producer_n     = (sm->t_state.ranges[0]._end - sm->t_state.ranges[0]._start) + 1;
-    consumer_n     = (producer_n + sm->client_response_hdr_bytes);
+    if (sm->t_state.num_range_fields == 1) {
+      consumer_n = (producer_n + sm->client_response_hdr_bytes);
+    } else {
+      // The ranges are read one after the other, see read_next_range()
+      consumer_n    = (sm->t_state.range_output_cl + sm->client_response_hdr_bytes);
+      p->next_range = 1;
+      write_range_part_header(p, 0);
+    }
   } else if (p->nbytes >= 0) {
     consumer_n = p->nbytes;
     producer_n = p->ntodo;
@@ -1092,6 +1150,57 @@ HttpTunnel::producer_handler_chunked(int event, HttpTunnelProducer *p)
 //    it calls back the state machine and returns true
 //
 //
+/** Write the boundary and the header of part @a index of a multi range response to the buffer of @a p.
+    The parts after the first are separated from the data of the previous one by a CRLF.
+*/
+void
+HttpTunnel::write_range_part_header(HttpTunnelProducer *p, int index)
+{
+  HttpTransact::State &s = sm->t_state;
+  MIOBuffer *buf         = p->read_buffer;
+  char numbers[64];
+  int content_type_len = 0;
+  const char *content_type =
+    s.cache_info.object_read->response_get()->value_get(MIME_FIELD_CONTENT_TYPE, MIME_LEN_CONTENT_TYPE, &content_type_len);
+
+  if (index > 0) {
+    buf->write("\r\n", 2);
+  }
+  buf->write(RANGE_BOUNDARY, sizeof(RANGE_BOUNDARY) - 1);
+  buf->write(RANGE_CONT_TYPE, sizeof(RANGE_CONT_TYPE) - 1);
+  if (content_type) {
+    buf->write(content_type, content_type_len);
+  }
+  buf->write(RANGE_CONT_RANGE, sizeof(RANGE_CONT_RANGE) - 1);
+  int len = snprintf(numbers, sizeof(numbers), "%" PRId64 "-%" PRId64 "/%" PRId64 "\r\n\r\n", s.ranges[index]._start,
+                     s.ranges[index]._end, s.cache_info.object_read->object_size_get());
+  buf->write(numbers, len);
+}
+
+/** A range of a multi range read of the cache by @a p is done, seek to the next one.
+    The data is referenced from the cache buffers, only the part headers are written.
+    @return @c false if it was the last range, the end of the response is written then.
+*/
+bool
+HttpTunnel::read_next_range(HttpTunnelProducer *p)
+{
+  HttpTransact::State &s = sm->t_state;
+  if (p->next_range >= s.num_range_fields) {
+    p->read_buffer->write(RANGE_BOUNDARY_END, sizeof(RANGE_BOUNDARY_END) - 1);
+    return false;
+  }
+
+  int index = p->next_range++;
+  write_range_part_header(p, index);
+  Debug("http_range", "[%" PRId64 "] reading range %d, %" PRId64 "-%" PRId64, sm->sm_id, index, s.ranges[index]._start,
+        s.ranges[index]._end);
+  p->read_vio = static_cast<CacheVC *>(p->vc)->do_io_pread(this, s.ranges[index]._end - s.ranges[index]._start + 1,
+                                                           p->read_buffer, s.ranges[index]._start);
+  // called back by the cache, which does not resume itself then
+  p->read_vio->reenable();
+  return true;
+}
+
 bool
 HttpTunnel::producer_handler(int event, HttpTunnelProducer *p)
 {
@@ -1145,6 +1254,11 @@ HttpTunnel::producer_handler(int event, HttpTunnelProducer *p)
   Debug("http_redirect", "[HttpTunnel::producer_handler] enable_redirection: [%d %d %d] event: %d, state: %d", p->alive == true,
         sm->enable_redirection, (p->self_consumer && p->self_consumer->alive == true), event, p->chunked_handler.state);
 
+  // A multi range read of the cache goes on while there are ranges left
+  if (event == VC_EVENT_READ_COMPLETE && p->next_range > 0 && this->read_next_range(p)) {
+    event = VC_EVENT_READ_READY;
+  }
+
   switch (event) {
   case VC_EVENT_READ_READY:
     // Data read from producer, reenable consumers
@@ -1229,6 +1343,85 @@ HttpTunnel::producer_handler(int event, HttpTunnelProducer *p)
   return sm_callback;
 }
 
+/** Whether the transaction is above its buffer memory limit while @a p has data waiting for its consumers.
+    Without such data nothing would reenable the producer, so it is not throttled then.
+*/
+bool
+HttpTunnel::over_buffer_limit(HttpTunnelProducer *p)
+{
+  IOBufferAccount *account = sm->buffer_account.get();
+  return account != nullptr && p->is_source() && account->over_limit() && p->backlog(1) > 0;
+}
+
+/** Measure how fast the client of @a c takes data, at most every @c FlowControl::DRAIN_SAMPLE_PERIOD.
+    Only the periods it had data waiting tell its rate, otherwise it is the origin that is slow.
+    Every sample also counts how much the tunnel buffers for the client, by size.
+*/
+void
+HttpTunnel::sample_drain_rate(HttpTunnelConsumer *c)
+{
+  ink_hrtime now = Thread::get_hrtime();
+  int64_t done   = c->write_vio->ndone;
+
+  if (c->drain_sample_time == 0) {
+    c->drain_sample_time = now;
+    c->drain_sample_done = done;
+    return;
+  }
+  ink_hrtime elapsed = now - c->drain_sample_time;
+  if (elapsed < FlowControl::DRAIN_SAMPLE_PERIOD) {
+    return;
+  }
+
+  uint64_t buffered = c->producer ? c->producer->backlog() : 0;
+  if (buffered <= (16 << 10)) {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_16K_stat);
+  } else if (buffered <= (64 << 10)) {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_64K_stat);
+  } else if (buffered <= (256 << 10)) {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_256K_stat);
+  } else if (buffered <= (1 << 20)) {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_1M_stat);
+  } else if (buffered <= (4 << 20)) {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_4M_stat);
+  } else {
+    HTTP_INCREMENT_DYN_STAT(http_tunnel_buffered_inf_stat);
+  }
+
+  if (flow_state.enabled_p && flow_state.drain_time > 0 && c->buffer_reader->read_avail() > 0) {
+    int64_t rate  = (done - c->drain_sample_done) * HRTIME_SECOND / elapsed;
+    c->drain_rate = c->drain_rate ? (3 * c->drain_rate + rate) / 4 : rate;
+    NetVConnection *netvc = dynamic_cast<NetVConnection *>(c->write_vio->vc_server);
+    if (const TcpInfo *info = netvc ? netvc->get_tcp_info() : nullptr) {
+      c->rtt = info->rtt;
+    }
+    this->adapt_water_marks();
+  }
+  c->drain_sample_time = now;
+  c->drain_sample_done = done;
+}
+
+/** Set the water marks to what the slowest client drains in the drain time and a round trip,
+    within the configured marks, low water being half of high water.
+*/
+void
+HttpTunnel::adapt_water_marks()
+{
+  uint64_t window = UINT64_MAX;
+  for (auto &consumer : consumers) {
+    if (consumer.alive && consumer.drain_rate > 0) {
+      uint64_t msec = (flow_state.drain_time + consumer.rtt) / HRTIME_MSECOND;
+      window        = std::min(window, static_cast<uint64_t>(consumer.drain_rate) * msec / 1000);
+    }
+  }
+  if (window == UINT64_MAX) {
+    return;
+  }
+  flow_state.high_water = std::clamp(window, flow_state.min_water, flow_state.max_water);
+  flow_state.low_water  = std::max(flow_state.min_water, flow_state.high_water / 2);
+  Debug("http_tunnel", "[%" PRId64 "] water marks %" PRIu64 " / %" PRIu64, sm->sm_id, flow_state.high_water, flow_state.low_water);
+}
+
 void
 HttpTunnel::consumer_reenable(HttpTunnelConsumer *c)
 {
@@ -1240,10 +1433,12 @@ HttpTunnel::consumer_reenable(HttpTunnelConsumer *c)
     // the backlog short cuts quit when the value is equal (or
     // greater) to the target, we use strict comparison only for
     // checking low water, otherwise the flow control can stall out.
+    // Independently the producer is throttled while the transaction
+    // holds more buffer memory than its limit.
     uint64_t backlog         = (flow_state.enabled_p && p->is_source()) ? p->backlog(flow_state.high_water) : 0;
     HttpTunnelProducer *srcp = p->flow_control_source;
 
-    if (backlog >= flow_state.high_water) {
+    if (backlog >= flow_state.high_water || this->over_buffer_limit(p)) {
       if (is_debug_tag_set("http_tunnel")) {
         Debug("http_tunnel", "Throttle   %p %" PRId64 " / %" PRId64, p, backlog, p->backlog());
       }
@@ -1258,7 +1453,7 @@ HttpTunnel::consumer_reenable(HttpTunnelConsumer *c)
         if (srcp != p) {
           backlog = srcp->backlog(flow_state.low_water);
         }
-        if (backlog < flow_state.low_water) {
+        if (backlog < flow_state.low_water && !this->over_buffer_limit(srcp)) {
           if (is_debug_tag_set("http_tunnel")) {
             Debug("http_tunnel", "Unthrottle %p %" PRId64 " / %" PRId64, p, backlog, p->backlog());
           }
@@ -1311,6 +1506,9 @@ HttpTunnel::consumer_handler(int event, HttpTunnelConsumer *c)
 
   switch (event) {
   case VC_EVENT_WRITE_READY:
+    if (HT_HTTP_CLIENT == c->vc_type) {
+      this->sample_drain_rate(c);
+    }
     this->consumer_reenable(c);
     break;
 
@@ -1619,6 +1817,7 @@ HttpTunnel::main_handler(int event, void *data)
   ++reentrancy_count;
 
   ink_assert(sm->magic == HTTP_SM_MAGIC_ALIVE);
+  bool timed = sm->cpu_time_start();
 
   // Find the appropriate entry
   if ((p = get_producer(static_cast<VIO *>(data))) != nullptr) {
@@ -1633,6 +1832,11 @@ HttpTunnel::main_handler(int event, void *data)
     }
   }
 
+  // The state machine may be gone once called back, it measures its own handler
+  if (timed) {
+    sm->cpu_time_stop();
+  }
+
   // We called a vc handler, the tunnel might be
   //  finished.  Check to see if there are any remaining
   //  VConnections alive.  If not, notifiy the state machine
@@ -126,6 +126,9 @@ struct ChunkedHandler {
   /// almost all output chunks.
   char max_chunk_header[16];
   int max_chunk_header_len = 0;
+  /// When more than @a max_chunk_size is available, up to this much is sent as one chunk.
+  /// No larger chunks are made unless it is more than @a max_chunk_size.
+  int64_t max_batch_size = 0;
   //@}
   ChunkedHandler();
 
@@ -169,6 +172,12 @@ struct HttpTunnelConsumer {
   bool write_success = false;
   const char *name   = nullptr;
 
+  /// Drain rate sampling of a client sink, for adaptive flow control.
+  ink_hrtime drain_sample_time = 0;
+  int64_t drain_sample_done    = 0;
+  int64_t drain_rate           = 0; ///< Smoothed bytes per second written while data was waiting, 0 until measured.
+  ink_hrtime rtt               = 0; ///< Round trip time of the connection, 0 if unknown.
+
   /** Check if this consumer is downstream from @a vc.
       @return @c true if any producer in the tunnel eventually feeds
       data to this consumer.
@@ -207,6 +216,8 @@ struct HttpTunnelProducer {
   int last_event          = 0; ///< Tracking for flow control restarts.
 
   int num_consumers = 0;
+  /// In a multi range read of the cache, the next range to read, 0 if it is not one.
+  int next_range = 0;
 
   bool alive        = false;
   bool read_success = false;
@@ -256,13 +267,21 @@ class HttpTunnel : public Continuation
       transaction flowing through the tunnel to (roughly) between the
       @a high_water and @a low_water water marks. Due to the chunky nater of data
       flow this always approximate.
+
+      With a @a drain_time the marks adapt to the slowest client of the tunnel, to buffer
+      about what it drains in @a drain_time plus a round trip, between the configured marks.
   */
   struct FlowControl {
     // Default value for high and low water marks.
     static uint64_t const DEFAULT_WATER_MARK = 1 << 16;
+    // Shortest interval the drain rate of a client is measured over.
+    static constexpr ink_hrtime DRAIN_SAMPLE_PERIOD = HRTIME_MSECONDS(100);
 
     uint64_t high_water;    ///< Buffered data limit - throttle if more than this.
     uint64_t low_water;     ///< Unthrottle if less than this buffered.
+    uint64_t max_water;     ///< Configured high water mark, the most adaptive marks grow to.
+    uint64_t min_water;     ///< Configured low water mark, the least adaptive marks shrink to.
+    ink_hrtime drain_time;  ///< Client drain time to buffer, 0 for fixed marks.
     bool enabled_p = false; ///< Flow control state (@c false means disabled).
 
     /// Default constructor.
@@ -302,6 +321,11 @@ public:
 
   int main_handler(int event, void *data);
   void consumer_reenable(HttpTunnelConsumer *c);
+  bool over_buffer_limit(HttpTunnelProducer *p);
+  void sample_drain_rate(HttpTunnelConsumer *c);
+  void write_range_part_header(HttpTunnelProducer *p, int index);
+  bool read_next_range(HttpTunnelProducer *p);
+  void adapt_water_marks();
   bool consumer_handler(int event, HttpTunnelConsumer *c);
   bool producer_handler(int event, HttpTunnelProducer *p);
   int producer_handler_dechunked(int event, HttpTunnelProducer *p);
@@ -577,4 +601,8 @@ HttpTunnelProducer::unthrottle()
   }
 }
 
-inline HttpTunnel::FlowControl::FlowControl() : high_water(DEFAULT_WATER_MARK), low_water(DEFAULT_WATER_MARK) {}
+inline HttpTunnel::FlowControl::FlowControl()
+  : high_water(DEFAULT_WATER_MARK), low_water(DEFAULT_WATER_MARK), max_water(DEFAULT_WATER_MARK), min_water(DEFAULT_WATER_MARK),
+    drain_time(0)
+{
+}
@@ -0,0 +1,82 @@
+/** @file
+
+  An index of the regex remap rules by the literal host suffix they require
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HostSuffixIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+// whether the character at @a i of @a pattern is escaped, by an odd number of backslashes
+bool
+is_escaped(std::string_view pattern, size_t i)
+{
+  size_t n = 0;
+  while (i > n && pattern[i - n - 1] == '\\') {
+    ++n;
+  }
+  return n % 2 == 1;
+}
+} // namespace
+
+std::string
+host_regex_suffix(std::string_view pattern)
+{
+  // an alternation can end in any branch, even inside a group
+  if (pattern.find('|') != std::string_view::npos) {
+    return {};
+  }
+  if (pattern.empty() || pattern.back() != '$' || is_escaped(pattern, pattern.size() - 1)) {
+    return {};
+  }
+
+  // the literal characters before the anchor, backwards, an escaped dot or dash as the character
+  std::string suffix;
+  size_t i = pattern.size() - 1;
+  while (i > 0) {
+    char c = pattern[i - 1];
+    if (is_escaped(pattern, i - 1)) {
+      if (c != '.' && c != '-') {
+        break;
+      }
+      suffix.push_back(c);
+      i -= 2;
+    } else if (isalnum(static_cast<unsigned char>(c)) || c == '-') {
+      suffix.push_back(c);
+      i -= 1;
+    } else {
+      break;
+    }
+  }
+  std::reverse(suffix.begin(), suffix.end());
+
+  // a quantifier or a class before the anchor stopped the loop, the characters after it are required
+  bool whole = (i == 1 && pattern[0] == '^');
+  if (!whole) {
+    // the first label can be the end of a longer one
+    size_t dot = suffix.find('.');
+    suffix.erase(0, dot == std::string::npos ? suffix.size() : dot + 1);
+  }
+  return suffix;
+}
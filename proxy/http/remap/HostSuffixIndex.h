@@ -0,0 +1,141 @@
+/** @file
+
+  An index of the regex remap rules by the literal host suffix they require
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+  The host suffix, on a label boundary, that every host matched by the host regex @a pattern ends with,
+  found from the literal characters the pattern ends with before its @c $ anchor. The partial first
+  label of the suffix is dropped unless the pattern is also anchored with @c ^ right before it.
+
+  @return The suffix, empty if the pattern does not require one, as when it is not anchored at its end
+  or has an alternation.
+*/
+std::string host_regex_suffix(std::string_view pattern);
+
+/**
+  The regex remap rules of a store, indexed by the host suffix their pattern requires, so that a
+  request only runs the patterns that can match its host. A @c Cursor walks the rules indexed by the
+  label suffixes of a host, and the rules that could not be indexed, in the order of their rank.
+
+  The rules are added in the order of their rank, as they are configured.
+*/
+template <class T> class HostSuffixIndex
+{
+  struct Entry {
+    int rank;
+    T *rule;
+  };
+
+public:
+  /// Add the @a rule of @a rank for the host regex @a pattern.
+  void add(std::string_view pattern, int rank, T *rule);
+
+  /// The rules that can match a host, in the order of their rank.
+  class Cursor
+  {
+  public:
+    /// The rules for @a host, lower case, which must outlive the cursor.
+    Cursor(const HostSuffixIndex &index, std::string_view host);
+
+    /// @return The next rule, @c nullptr when there are none left.
+    T *next();
+
+  private:
+    struct Range {
+      const Entry *cur;
+      const Entry *end;
+    };
+
+    // a host name has at most a label every two characters, and the rules not indexed
+    static constexpr int MAX_RANGES = 130;
+
+    Range _ranges[MAX_RANGES];
+    int _count = 0;
+  };
+
+  bool
+  empty() const
+  {
+    return _unindexed.empty() && _suffixes.empty();
+  }
+
+private:
+  std::deque<std::string> _keys; // the storage of the keys of _suffixes
+  std::unordered_map<std::string_view, std::vector<Entry>> _suffixes;
+  std::vector<Entry> _unindexed;
+};
+
+template <class T>
+void
+HostSuffixIndex<T>::add(std::string_view pattern, int rank, T *rule)
+{
+  std::string suffix = host_regex_suffix(pattern);
+  if (suffix.empty()) {
+    _unindexed.push_back({rank, rule});
+    return;
+  }
+  auto spot = _suffixes.find(suffix);
+  if (spot == _suffixes.end()) {
+    _keys.push_back(std::move(suffix));
+    spot = _suffixes.emplace(_keys.back(), std::vector<Entry>()).first;
+  }
+  spot->second.push_back({rank, rule});
+}
+
+template <class T> HostSuffixIndex<T>::Cursor::Cursor(const HostSuffixIndex &index, std::string_view host)
+{
+  if (!index._unindexed.empty()) {
+    _ranges[_count++] = {index._unindexed.data(), index._unindexed.data() + index._unindexed.size()};
+  }
+  if (index._suffixes.empty()) {
+    return;
+  }
+  while (!host.empty() && _count < MAX_RANGES) {
+    auto spot = index._suffixes.find(host);
+    if (spot != index._suffixes.end()) {
+      _ranges[_count++] = {spot->second.data(), spot->second.data() + spot->second.size()};
+    }
+    size_t dot = host.find('.');
+    host.remove_prefix(dot == std::string_view::npos ? host.size() : dot + 1);
+  }
+}
+
+template <class T>
+T *
+HostSuffixIndex<T>::Cursor::next()
+{
+  int best = -1;
+  for (int i = 0; i < _count; i++) {
+    if (_ranges[i].cur != _ranges[i].end && (best == -1 || _ranges[i].cur->rank < _ranges[best].cur->rank)) {
+      best = i;
+    }
+  }
+  return best == -1 ? nullptr : (_ranges[best].cur++)->rule;
+}
@@ -56,6 +56,27 @@ chash_lookup(const std::shared_ptr<ATSConsistentHash> &ring, uint64_t hash_key,
   return host_rec;
 }
 
+static HostRecord *
+maglev_lookup(const std::shared_ptr<ATSMaglevHash> &table, uint64_t hash_key, uint32_t *pos, bool *wrapped, bool *hash_init,
+              bool *mapWrapped)
+{
+  HostRecord *host_rec = nullptr;
+
+  if (*hash_init == false) {
+    host_rec   = static_cast<HostRecord *>(table->lookup_by_hashval(hash_key, pos));
+    *hash_init = true;
+  } else {
+    host_rec = static_cast<HostRecord *>(table->lookup_next(pos, wrapped));
+  }
+  bool wrap_around = *wrapped;
+  *wrapped         = (*mapWrapped && *wrapped) ? true : false;
+  if (!*mapWrapped && wrap_around) {
+    *mapWrapped = true;
+  }
+
+  return host_rec;
+}
+
 NextHopConsistentHash::~NextHopConsistentHash()
 {
   NH_Debug(NH_DEBUG_TAG, "destructor called for strategy named: %s", strategy_name.c_str());
@@ -100,6 +121,7 @@ NextHopConsistentHash::Init(const YAML::Node &n)
   // load up the hash rings.
   for (uint32_t i = 0; i < groups; i++) {
     std::shared_ptr<ATSConsistentHash> hash_ring = std::make_shared<ATSConsistentHash>();
+    std::shared_ptr<ATSMaglevHash> hash_table    = std::make_shared<ATSMaglevHash>();
     for (uint32_t j = 0; j < host_groups[i].size(); j++) {
       // ATSConsistentHash needs the raw pointer.
       HostRecord *p = host_groups[i][j].get();
@@ -111,16 +133,86 @@ NextHopConsistentHash::Init(const YAML::Node &n)
       }
       p->group_index = host_groups[i][j]->group_index;
       p->host_index  = host_groups[i][j]->host_index;
-      hash_ring->insert(p, p->weight, &hash);
+      if (policy_type == NH_MAGLEV_HASH) {
+        hash_table->insert(p, p->weight, &hash);
+      } else {
+        hash_ring->insert(p, p->weight, &hash);
+      }
       NH_Debug(NH_DEBUG_TAG, "Loading hash rings - ring: %d, host record: %d, name: %s, hostname: %s, stategy: %s", i, j, p->name,
                p->hostname.c_str(), strategy_name.c_str());
     }
     hash.clear();
-    rings.push_back(std::move(hash_ring));
+    if (policy_type == NH_MAGLEV_HASH) {
+      hash_table->build();
+      NH_Debug(NH_DEBUG_TAG, "Loading hash tables - table: %d, slots: %zu, strategy: %s", i, hash_table->size(),
+               strategy_name.c_str());
+      tables.push_back(std::move(hash_table));
+    } else {
+      rings.push_back(std::move(hash_ring));
+    }
   }
   return true;
 }
 
+// looks up the ring, or the maglev table, of the group 'cur_ring'.
+HostRecord *
+NextHopConsistentHash::ringLookup(ParentResult *result, uint32_t cur_ring, uint64_t hash_key, bool *wrapped, ATSHash64Sip24 *hash,
+                                  uint64_t sm_id)
+{
+  if (policy_type == NH_MAGLEV_HASH) {
+    return maglev_lookup(tables[cur_ring], hash_key, &result->maglevPos[cur_ring], wrapped, &result->chash_init[cur_ring],
+                         &result->mapWrapped[cur_ring]);
+  }
+  return chash_lookup(rings[cur_ring], hash_key, &result->chashIter[cur_ring], wrapped, hash, &result->chash_init[cur_ring],
+                      &result->mapWrapped[cur_ring], sm_id);
+}
+
+// for the peak_ewma policy, returns the next available host of the ring after 'pRec' when it is much less
+// loaded, 'pRec' if not.  The requests for a key stay on the two hosts, for cache affinity.
+std::shared_ptr<HostRecord>
+NextHopConsistentHash::lessLoaded(ParentResult *result, uint32_t cur_ring, uint64_t hash_key,
+                                  const std::shared_ptr<HostRecord> &pRec, ATSHash64Sip24 *hash, uint64_t sm_id)
+{
+  constexpr double load_ratio  = 1.5; // how much less loaded the next host must be
+  constexpr uint32_t max_steps = 16;  // lookups for a host other than 'pRec'
+
+  // the ring is left where it is when 'pRec' is kept, a retry goes on from it.
+  ATSConsistentHashIter iter = result->chashIter[cur_ring];
+  bool map_wrapped           = result->mapWrapped[cur_ring];
+  bool wrapped               = false;
+  HostStatus &pStatus        = HostStatus::instance();
+  std::shared_ptr<HostRecord> alt;
+
+  for (uint32_t i = 0; i < max_steps && !wrapped; i++) {
+    HostRecord *hostRec = ringLookup(result, cur_ring, hash_key, &wrapped, hash, sm_id);
+    if (hostRec == nullptr) {
+      break;
+    }
+    if (hostRec != pRec.get()) {
+      alt              = host_groups[hostRec->group_index][hostRec->host_index];
+      HostStatRec *hst = pStatus.getHostStatus(alt->hostname.c_str());
+      if (!alt->available || (hst && hst->status == HOST_STATUS_DOWN)) {
+        alt = nullptr;
+      }
+      break;
+    }
+  }
+
+  ink_hrtime now = ink_get_hrtime_internal();
+  if (alt) {
+    double cost     = pRec->load_cost(now, *alt);
+    double alt_cost = alt->load_cost(now, *pRec);
+    NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] load of %s: %.0f, of the next host %s: %.0f", sm_id, pRec->hostname.c_str(), cost,
+             alt->hostname.c_str(), alt_cost);
+    if (alt_cost * load_ratio < cost) {
+      return alt;
+    }
+  }
+  result->chashIter[cur_ring]  = iter;
+  result->mapWrapped[cur_ring] = map_wrapped;
+  return pRec;
+}
+
 // returns a hash key calculated from the request and 'hash_key' configuration
 // parameter.
 uint64_t
@@ -269,9 +361,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
   hash_key = getHashKey(sm_id, &request_info, &hash);
 
   do { // search until we've selected a different parent if !firstcall
-    std::shared_ptr<ATSConsistentHash> r = rings[cur_ring];
-    hostRec               = chash_lookup(r, hash_key, &result->chashIter[cur_ring], &wrapped, &hash, &result->chash_init[cur_ring],
-                           &result->mapWrapped[cur_ring], sm_id);
+    hostRec               = ringLookup(result, cur_ring, hash_key, &wrapped, &hash, sm_id);
     wrap_around[cur_ring] = wrapped;
     lookups++;
     // the 'available' flag is maintained in 'host_groups' and not the hash ring.
@@ -331,9 +421,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
         }
         break;
       }
-      std::shared_ptr<ATSConsistentHash> r = rings[cur_ring];
-      hostRec = chash_lookup(r, hash_key, &result->chashIter[cur_ring], &wrapped, &hash, &result->chash_init[cur_ring],
-                             &result->mapWrapped[cur_ring], sm_id);
+      hostRec               = ringLookup(result, cur_ring, hash_key, &wrapped, &hash, sm_id);
       wrap_around[cur_ring] = wrapped;
       lookups++;
       if (hostRec) {
@@ -372,6 +460,14 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
     } while (!pRec || (pRec && !pRec->available) || host_stat == HOST_STATUS_DOWN);
   }
 
+  // ----------------------------------------------------------------------------------------------------
+  // For peak_ewma, move away from the selected host when it is much more loaded than the next one.
+  // ----------------------------------------------------------------------------------------------------
+
+  if (policy_type == NH_PEAK_EWMA && firstcall && !nextHopRetry && pRec && pRec->available && host_stat == HOST_STATUS_UP) {
+    pRec = lessLoaded(result, cur_ring, hash_key, pRec, &hash, sm_id);
+  }
+
   // ----------------------------------------------------------------------------------------------------
   // Validate and return the final result.
   // ----------------------------------------------------------------------------------------------------
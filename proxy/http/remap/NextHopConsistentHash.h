@@ -25,6 +25,8 @@
 
 #include <map>
 #include <vector>
+#include "tscore/HashSip.h"
+#include "tscore/MaglevHash.h"
 #include "NextHopSelectionStrategy.h"
 
 enum NHHashKeyType {
@@ -39,8 +41,13 @@ enum NHHashKeyType {
 class NextHopConsistentHash : public NextHopSelectionStrategy
 {
   std::vector<std::shared_ptr<ATSConsistentHash>> rings;
+  std::vector<std::shared_ptr<ATSMaglevHash>> tables; // in place of the rings, for NH_MAGLEV_HASH
 
   uint64_t getHashKey(uint64_t sm_id, HttpRequestData *hrdata, ATSHash64 *h);
+  HostRecord *ringLookup(ParentResult *result, uint32_t cur_ring, uint64_t hash_key, bool *wrapped, ATSHash64Sip24 *hash,
+                         uint64_t sm_id);
+  std::shared_ptr<HostRecord> lessLoaded(ParentResult *result, uint32_t cur_ring, uint64_t hash_key,
+                                         const std::shared_ptr<HostRecord> &pRec, ATSHash64Sip24 *hash, uint64_t sm_id);
 
 public:
   NHHashKeyType hash_key = NH_PATH_HASH_KEY;
@@ -111,31 +111,27 @@ NextHopHealthStatus::markNextHop(TSHttpTxn txn, const char *hostname, const int
   // Mark the host down.
   case NH_MARK_DOWN:
     if (h->failedAt == 0 || result.retry == true) {
-      { // lock guard
-        std::lock_guard<std::mutex> guard(h->_mutex);
-        if (h->failedAt == 0) {
-          h->failedAt = _now;
-          if (result.retry == false) {
-            new_fail_count = h->failCount = 1;
-          }
-        } else if (result.retry == true) {
-          h->failedAt = _now;
+      // only the thread that stores the first failure time starts the count
+      time_t failed = 0;
+      if (h->failedAt.compare_exchange_strong(failed, _now)) {
+        if (result.retry == false) {
+          new_fail_count = h->failCount = 1;
         }
-      } // end lock guard
+      } else if (result.retry == true) {
+        h->failedAt = _now;
+      } else {
+        new_fail_count = ++h->failCount;
+      }
       NH_Note("[%" PRId64 "] NextHop %s marked as down %s", sm_id, (result.retry) ? "retry" : "initially", h->hostname.c_str());
     } else {
-      int old_count = 0;
-      // if the last failure was outside the retry window, set the failcount to 1 and failedAt to now.
-      { // lock guard
-        std::lock_guard<std::mutex> lock(h->_mutex);
-        if ((h->failedAt + retry_time) < static_cast<unsigned>(_now)) {
-          h->failCount = 1;
-          h->failedAt  = _now;
-        } else {
-          old_count = h->failCount = 1;
-        }
-        new_fail_count = old_count + 1;
-      } // end of lock_guard
+      // if the last failure was outside the retry window, set the failcount to 1 and failedAt to now, once, the threads
+      // that lose the race count their failure in the new window.
+      time_t failed = h->failedAt;
+      if ((failed + retry_time) < static_cast<unsigned>(_now) && h->failedAt.compare_exchange_strong(failed, _now)) {
+        new_fail_count = h->failCount = 1;
+      } else {
+        new_fail_count = ++h->failCount;
+      }
       NH_Debug(NH_DEBUG_TAG, "[%" PRId64 "] Parent fail count increased to %d for %s", sm_id, new_fail_count, h->hostname.c_str());
     }
 
@@ -70,12 +70,10 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
       result->start_parent = cur_hst_index = 0;
       cur_grp_index                        = 0;
       break;
-    case NH_RR_STRICT: {
-      std::lock_guard<std::mutex> lock(_mutex);
-      cur_hst_index = result->start_parent = this->hst_index;
+    case NH_RR_STRICT:
+      cur_hst_index = result->start_parent = rr_index.fetch_add(1, std::memory_order_relaxed) % hst_size;
       cur_grp_index                        = 0;
-      this->hst_index                      = (this->hst_index + 1) % hst_size;
-    } break;
+      break;
     case NH_RR_IP:
       cur_grp_index = 0;
       if (request_info.get_client_ip() != nullptr) {
@@ -134,7 +132,7 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
     NH_Debug(NH_DEBUG_TAG,
              "[%" PRIu64 "] Selected a parent, %s,  failCount (faileAt: %d failCount: %d), FailThreshold: %" PRIu64
              ", request_info->xact_start: %ld",
-             sm_id, cur_host->hostname.c_str(), (unsigned)cur_host->failedAt, cur_host->failCount, fail_threshold,
+             sm_id, cur_host->hostname.c_str(), (unsigned)cur_host->failedAt.load(), cur_host->failCount.load(), fail_threshold,
              request_info.xact_start);
     // check if 'cur_host' is available, mark it up if it is.
     if ((cur_host->failedAt == 0) || (cur_host->failCount < fail_threshold)) {
@@ -142,7 +140,8 @@ NextHopRoundRobin::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
         NH_Debug(NH_DEBUG_TAG,
                  "[%" PRIu64
                  "] Selecting a parent, %s,  due to little failCount (faileAt: %d failCount: %d), FailThreshold: %" PRIu64,
-                 sm_id, cur_host->hostname.c_str(), (unsigned)cur_host->failedAt, cur_host->failCount, fail_threshold);
+                 sm_id, cur_host->hostname.c_str(), (unsigned)cur_host->failedAt.load(), cur_host->failCount.load(),
+                 fail_threshold);
         parentUp = true;
       }
     } else { // if not available, check to see if it can be retried.  If so, set the retry flag and temporairly mark it as
@@ -23,13 +23,13 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
 #include "NextHopSelectionStrategy.h"
 
 class NextHopRoundRobin : public NextHopSelectionStrategy
 {
-  std::mutex _mutex;
-  uint32_t latched_index = 0;
+  std::atomic<uint32_t> rr_index{0}; // the count of the strict round robin, taken by every thread without a lock
+  std::atomic<uint32_t> latched_index{0};
 
 public:
   NextHopRoundRobin() = delete;
@@ -21,6 +21,8 @@
   limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <yaml-cpp/yaml.h>
 #include "I_Machine.h"
 #include "HttpSM.h"
@@ -34,8 +36,11 @@ constexpr std::string_view exhaust_rings   = "exhaust_ring";
 constexpr std::string_view active_health_check  = "active";
 constexpr std::string_view passive_health_check = "passive";
 
-constexpr const char *policy_strings[] = {"NH_UNDEFINED", "NH_FIRST_LIVE", "NH_RR_STRICT",
-                                          "NH_RR_IP",     "NH_RR_LATCHED", "NH_CONSISTENT_HASH"};
+constexpr const char *policy_strings[] = {"NH_UNDEFINED",  "NH_FIRST_LIVE",      "NH_RR_STRICT",   "NH_RR_IP",
+                                          "NH_RR_LATCHED", "NH_CONSISTENT_HASH", "NH_MAGLEV_HASH", "NH_PEAK_EWMA"};
+
+// the time over which the load of a host decays, samples or not.
+constexpr ink_hrtime load_decay = HRTIME_SECONDS(10);
 
 NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name, const NHPolicyType &policy)
 {
@@ -232,6 +237,53 @@ NextHopSelectionStrategy::onFailureMarkParentDown(HTTPStatus response_code)
   return static_cast<int>(response_code) >= 500 && static_cast<int>(response_code) <= 599;
 }
 
+// returns the next hop in 'result' when its load is tracked, by the peak_ewma policy.
+HostRecord *
+NextHopSelectionStrategy::loadOf(const ParentResult *result)
+{
+  if (policy_type != NH_PEAK_EWMA || result->last_lookup < 0 || static_cast<uint32_t>(result->last_lookup) >= groups ||
+      result->last_parent >= host_groups[result->last_lookup].size()) {
+    return nullptr;
+  }
+  return host_groups[result->last_lookup][result->last_parent].get();
+}
+
+void
+HostRecord::load_end(ink_hrtime now, ink_hrtime latency, bool failed)
+{
+  --load_inflight;
+  if (latency < 0) {
+    return;
+  }
+
+  // the weight of the average so far decays with the time since the last sample, a slower one replaces it.
+  ink_hrtime last = load_stamp.exchange(now);
+  double w        = last ? exp(-static_cast<double>(std::max<ink_hrtime>(now - last, 0)) / load_decay) : 0;
+  int64_t prev    = load_latency.load();
+  while (!load_latency.compare_exchange_weak(
+    prev, latency > prev ? latency : static_cast<int64_t>(prev * w + static_cast<double>(latency) * (1 - w)))) {
+  }
+  int32_t errors = load_errors.load();
+  while (!load_errors.compare_exchange_weak(errors, static_cast<int32_t>(errors * w + (failed ? 1000000 : 0) * (1 - w)))) {
+  }
+}
+
+double
+HostRecord::load_cost(ink_hrtime now, const HostRecord &other) const
+{
+  const HostRecord &sampled = load_stamp.load() ? *this : other;
+  ink_hrtime stamp          = sampled.load_stamp.load();
+  if (!stamp) {
+    return load_inflight.load() + 1;
+  }
+
+  // the load of an idle host decays with its samples, so that it is tried again.
+  double decay   = exp(-static_cast<double>(std::max<ink_hrtime>(now - stamp, 0)) / load_decay);
+  double latency = sampled.load_latency.load() * decay + 1;
+  double errors  = sampled.load_errors.load() * decay / 1000000;
+  return latency * (load_inflight.load() + 1) / std::max(1 - errors, 0.05);
+}
+
 namespace YAML
 {
 template <> struct convert<HostRecord> {
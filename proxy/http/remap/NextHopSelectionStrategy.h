@@ -23,6 +23,10 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "tscore/ink_atomic.h"
+#include "tscore/ink_hrtime.h"
 #include "ts/nexthop.h"
 #include "ParentSelection.h"
 
@@ -48,7 +52,9 @@ enum NHPolicyType {
   NH_RR_STRICT,      // strict round robin
   NH_RR_IP,          // round robin by client ip.
   NH_RR_LATCHED,     // latched to available next hop.
-  NH_CONSISTENT_HASH // consistent hashing strategy.
+  NH_CONSISTENT_HASH, // consistent hashing strategy.
+  NH_MAGLEV_HASH,     // consistent hashing strategy, over maglev lookup tables.
+  NH_PEAK_EWMA        // consistent hashing strategy, away from a next hop much more loaded than the next one.
 };
 
 enum NHSchemeType { NH_SCHEME_NONE = 0, NH_SCHEME_HTTP, NH_SCHEME_HTTPS };
@@ -90,24 +96,28 @@ struct NHProtocol {
 };
 
 struct HostRecord : ATSConsistentHashNode {
-  std::mutex _mutex;
   std::string hostname;
-  time_t failedAt;
-  uint32_t failCount;
-  time_t upAt;
   float weight;
   std::string hash_string;
   int host_index;
   int group_index;
   std::vector<std::shared_ptr<NHProtocol>> protocols;
 
-  // construct without locking the _mutex.
+  // the health of the host, marked by every transaction thread without a lock. It starts a cache line of its own so the
+  // writes to one host do not invalidate the line of the read mostly fields above or of the next host.
+  alignas(64) std::atomic<time_t> failedAt{0};
+  std::atomic<uint32_t> failCount{0};
+  std::atomic<time_t> upAt{0};
+
+  // the load of the host for the peak_ewma policy, not copied.
+  std::atomic<int32_t> load_inflight{0};
+  std::atomic<int64_t> load_latency{0}; // peak ewma of the response time, nanoseconds
+  std::atomic<int32_t> load_errors{0};  // ewma of the failures, parts per million
+  std::atomic<ink_hrtime> load_stamp{0};
+
   HostRecord()
   {
     hostname    = "";
-    failedAt    = 0;
-    failCount   = 0;
-    upAt        = 0;
     weight      = 0;
     hash_string = "";
     host_index  = -1;
@@ -115,13 +125,13 @@ struct HostRecord : ATSConsistentHashNode {
     available   = true;
   }
 
-  // copy constructor to avoid copying the _mutex.
+  // copy the values of the atomics, they are not copyable.
   HostRecord(const HostRecord &o)
   {
     hostname    = o.hostname;
-    failedAt    = o.failedAt;
-    failCount   = o.failCount;
-    upAt        = o.upAt;
+    failedAt    = o.failedAt.load();
+    failCount   = o.failCount.load();
+    upAt        = o.upAt.load();
     weight      = o.weight;
     hash_string = o.hash_string;
     host_index  = -1;
@@ -130,13 +140,12 @@ struct HostRecord : ATSConsistentHashNode {
     protocols   = o.protocols;
   }
 
-  // assign without copying the _mutex.
   HostRecord &
   operator=(const HostRecord &o)
   {
     hostname    = o.hostname;
-    failedAt    = o.failedAt;
-    upAt        = o.upAt;
+    failedAt    = o.failedAt.load();
+    upAt        = o.upAt.load();
     weight      = o.weight;
     hash_string = o.hash_string;
     host_index  = o.host_index;
@@ -146,27 +155,25 @@ struct HostRecord : ATSConsistentHashNode {
     return *this;
   }
 
-  // locks the record when marking this host down.
+  // marks this host down, the failure time is stored before the host is seen down so a reader never finds it down
+  // with the time of an older failure.
   void
   set_unavailable()
   {
     if (available) {
-      std::lock_guard<std::mutex> lock(_mutex);
-      failedAt  = time(nullptr);
-      available = false;
+      failedAt = time(nullptr);
+      ink_atomic_swap(&available, false);
     }
   }
 
-  // locks the record when marking this host up.
+  // marks this host up, only the thread that finds it down resets the failures.
   void
   set_available()
   {
-    if (!available) {
-      std::lock_guard<std::mutex> lock(_mutex);
-      failedAt  = 0;
+    if (!available && ink_atomic_cas(&available, false, true)) {
       failCount = 0;
+      failedAt  = 0;
       upAt      = time(nullptr);
-      available = true;
     }
   }
 
@@ -194,6 +201,19 @@ struct HostRecord : ATSConsistentHashNode {
   {
     return makeHostPort(this->hostname, port);
   }
+
+  // a request to this host starts, it is in flight until load_end().
+  void
+  load_start()
+  {
+    ++load_inflight;
+  }
+
+  // the request ends at 'now', answered or 'failed' after 'latency', no sample if it is negative.
+  void load_end(ink_hrtime now, ink_hrtime latency, bool failed);
+
+  // the cost of sending a request to this host at 'now', the latency of 'other' if this one has none.
+  double load_cost(ink_hrtime now, const HostRecord &other) const;
 };
 
 class NextHopHealthStatus : public NHHealthStatus
@@ -220,6 +240,7 @@ public:
   void markNextHop(TSHttpTxn txnp, const char *hostname, const int port, const NHCmd status, void *ih = nullptr,
                    const time_t now = 0);
   bool nextHopExists(TSHttpTxn txnp, void *ih = nullptr);
+  HostRecord *loadOf(const ParentResult *result);
 
   virtual bool responseIsRetryable(unsigned int current_retry_attempts, HTTPStatus response_code);
   virtual bool onFailureMarkParentDown(HTTPStatus response_code);
@@ -40,6 +40,8 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file)
 
   // strategy policies.
   constexpr std::string_view consistent_hash = "consistent_hash";
+  constexpr std::string_view maglev_hash     = "maglev_hash";
+  constexpr std::string_view peak_ewma       = "peak_ewma";
   constexpr std::string_view first_live      = "first_live";
   constexpr std::string_view rr_strict       = "rr_strict";
   constexpr std::string_view rr_ip           = "rr_ip";
@@ -78,6 +80,10 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file)
 
       if (policy_value == consistent_hash) {
         policy_type = NH_CONSISTENT_HASH;
+      } else if (policy_value == maglev_hash) {
+        policy_type = NH_MAGLEV_HASH;
+      } else if (policy_value == peak_ewma) {
+        policy_type = NH_PEAK_EWMA;
       } else if (policy_value == first_live) {
         policy_type = NH_FIRST_LIVE;
       } else if (policy_value == rr_strict) {
@@ -134,6 +140,8 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
     }
     break;
   case NH_CONSISTENT_HASH:
+  case NH_MAGLEV_HASH:
+  case NH_PEAK_EWMA:
     strat_chash = std::make_shared<NextHopConsistentHash>(name, policy_type);
     if (strat_chash->Init(node)) {
       _strategies.emplace(std::make_pair(std::string(name), strat_chash));
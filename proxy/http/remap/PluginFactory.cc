@@ -51,6 +51,7 @@ RemapPluginInst *
 RemapPluginInst::init(RemapPluginInfo *plugin, int argc, char **argv, std::string &error)
 {
   RemapPluginInst *inst = new RemapPluginInst(*plugin);
+  inst->_args           = argsKey(argc, argv);
   if (plugin->initInstance(argc, argv, &(inst->_instance), error)) {
     plugin->incInstanceCount();
     return inst;
@@ -59,6 +60,16 @@ RemapPluginInst::init(RemapPluginInfo *plugin, int argc, char **argv, std::strin
   return nullptr;
 }
 
+std::string
+RemapPluginInst::argsKey(int argc, char **argv)
+{
+  std::string key;
+  for (int i = 0; i < argc; ++i) {
+    key.append(argv[i]).push_back('\0');
+  }
+  return key;
+}
+
 void
 RemapPluginInst::done()
 {
@@ -99,8 +110,15 @@ PluginFactory::PluginFactory()
 
 PluginFactory::~PluginFactory()
 {
-  _instList.apply([](RemapPluginInst *pluginInst) -> void { delete pluginInst; });
+  auto release = [](RemapPluginInst *pluginInst) -> void {
+    if (0 == --pluginInst->_factories) {
+      delete pluginInst;
+    }
+  };
+  _instList.apply(release);
   _instList.clear();
+  std::for_each(_reusedList.begin(), _reusedList.end(), release);
+  _reusedList.clear();
 
   fs::remove(_runtimeDir, _ec);
 
@@ -215,15 +233,59 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
     }
   } else {
     PluginDebug(_tag, "plugin '%s' has already been loaded", configPath.c_str());
-    inst = RemapPluginInst::init(plugin, argc, argv, error);
-    if (nullptr != inst) {
-      _instList.append(inst);
+    inst = reuseInstance(plugin, argc, argv);
+    if (nullptr == inst) {
+      inst = RemapPluginInst::init(plugin, argc, argv, error);
+      if (nullptr != inst) {
+        _instList.append(inst);
+      }
     }
   }
 
   return inst;
 }
 
+/**
+ * @brief Let the instances of the @a previous factory, of the config being reloaded, be reused by this one
+ * instead of initializing new ones, for the same DSO and the same parameters. Each instance is reused once.
+ *
+ * @param previous factory, which must outlive the loading of the config, nullptr to stop reusing instances.
+ */
+void
+PluginFactory::reuseInstancesFrom(PluginFactory *previous)
+{
+  _reusable.clear();
+  if (nullptr != previous) {
+    for (auto &inst : previous->_instList) {
+      _reusable.emplace(inst._args, &inst);
+    }
+    for (auto inst : previous->_reusedList) {
+      _reusable.emplace(inst->_args, inst);
+    }
+  }
+}
+
+RemapPluginInst *
+PluginFactory::reuseInstance(RemapPluginInfo *plugin, int argc, char **argv)
+{
+  if (_reusable.empty()) {
+    return nullptr;
+  }
+  auto [first, last] = _reusable.equal_range(RemapPluginInst::argsKey(argc, argv));
+  for (auto spot = first; spot != last; ++spot) {
+    RemapPluginInst *inst = spot->second;
+    if (&inst->_plugin == plugin) {
+      _reusable.erase(spot);
+      ++inst->_factories;
+      ++inst->_active;
+      _reusedList.push_back(inst);
+      PluginDebug(_tag, "reusing instance of plugin '%s'", plugin->effectivePath().c_str());
+      return inst;
+    }
+  }
+  return nullptr;
+}
+
 /**
  * @brief full path to the first plugin found in the search path which will be used to be copied to runtime location and loaded.
  *
@@ -278,7 +340,15 @@ PluginFactory::deactivate()
 {
   PluginDebug(_tag, "deactivate configuration used by factory '%s'", getUuid());
 
-  _instList.apply([](RemapPluginInst &pluginInst) -> void { pluginInst.done(); });
+  auto done = [](RemapPluginInst &pluginInst) -> void {
+    if (0 == --pluginInst._active) {
+      pluginInst.done();
+    }
+  };
+  _instList.apply(done);
+  for (auto inst : _reusedList) {
+    done(*inst);
+  }
 }
 
 /**
@@ -301,6 +371,9 @@ PluginFactory::indicatePostReload(bool reloadSuccessful)
   for (auto &inst : _instList) {
     pluginUsed[&(inst._plugin)]++;
   }
+  for (auto inst : _reusedList) {
+    pluginUsed[&(inst->_plugin)]++;
+  }
 
   PluginDso::loadedPlugins()->indicatePostReload(reloadSuccessful, pluginUsed, getUuid());
 }
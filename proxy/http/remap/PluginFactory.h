@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tscore/Ptr.h"
@@ -63,6 +66,14 @@ public:
   /* Plugin instance = the plugin info + the data returned by the init callback */
   RemapPluginInfo &_plugin;
   void *_instance = nullptr;
+
+  /* The parameters of the instance, to tell the next config reload it can reuse it */
+  static std::string argsKey(int argc, char **argv);
+  std::string _args;
+
+  /* The factories holding the instance, and those of them still active, as a reload can reuse it */
+  std::atomic<int> _factories{1};
+  std::atomic<int> _active{1};
 };
 
 /**
@@ -98,6 +109,8 @@ public:
 
   RemapPluginInst *getRemapPlugin(const fs::path &configPath, int argc, char **argv, std::string &error, bool dynamicReloadEnabled);
 
+  void reuseInstancesFrom(PluginFactory *previous);
+
   virtual const char *getUuid();
   void clean(std::string &error);
 
@@ -113,6 +126,10 @@ protected:
   fs::path _runtimeDir;              /** @brief the path where we would create a temporary copies of the plugins to load */
 
   PluginInstList _instList;
+  std::vector<RemapPluginInst *> _reusedList; /** @brief instances taken over from the previous factory */
+  std::unordered_multimap<std::string, RemapPluginInst *> _reusable;
+
+  RemapPluginInst *reuseInstance(RemapPluginInfo *plugin, int argc, char **argv);
 
   ATSUuid *_uuid = nullptr;
   std::error_code _ec;
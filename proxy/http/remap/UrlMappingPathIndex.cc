@@ -23,36 +23,87 @@
 
 #include "UrlMappingPathIndex.h"
 
+#include <cstring>
+
 UrlMappingPathIndex::~UrlMappingPathIndex()
 {
-  for (auto &m_trie : m_tries) {
-    delete m_trie.second; // Delete the Trie
+  for (url_mapping *value : m_values) {
+    delete value;
+  }
+  m_values.clear();
+}
+
+bool
+UrlMappingPathIndex::Key::match(const std::string &label, int offset) const
+{
+  if (size() - offset < static_cast<int>(label.size())) {
+    return false;
   }
-  m_tries.clear();
+  for (size_t i = 0; i < label.size(); ++i) {
+    if ((*this)[offset + i] != label[i]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool
 UrlMappingPathIndex::Insert(url_mapping *mapping)
 {
-  int scheme_idx;
-  int port = (mapping->fromURL).port_get();
-  UrlMappingTrie *trie;
-  int from_path_len;
-  const char *from_path;
-
-  trie = _GetTrie(&(mapping->fromURL), scheme_idx, port);
-
-  if (!trie) {
-    trie = new UrlMappingTrie();
-    m_tries.insert(UrlMappingGroup::value_type(UrlMappingTrieKey(scheme_idx, port), trie));
-    Debug("UrlMappingPathIndex::Insert", "Created new trie for scheme index, port combo <%d, %d>", scheme_idx, port);
+  Key key;
+  _SetGroup(&(mapping->fromURL), mapping->fromURL.port_get(), key.group);
+  key.path = mapping->fromURL.path_get(&key.path_len);
+
+  uint32_t node = 0;
+  int i         = 0;
+  while (i < key.size()) {
+    size_t pos = m_nodes[node].child_bytes.find(key[i]);
+    if (pos == std::string::npos) {
+      // the rest of the key is the label of a new leaf
+      uint32_t leaf = m_nodes.size();
+      m_nodes.emplace_back();
+      for (; i < key.size(); ++i) {
+        m_nodes[leaf].label.push_back(key[i]);
+      }
+      m_nodes[node].child_bytes.push_back(m_nodes[leaf].label[0]);
+      m_nodes[node].children.push_back(leaf);
+      node = leaf;
+      break;
+    }
+
+    uint32_t child = m_nodes[node].children[pos];
+    size_t common  = 0;
+    size_t len     = m_nodes[child].label.size();
+    while (common < len && i + static_cast<int>(common) < key.size() && m_nodes[child].label[common] == key[i + common]) {
+      ++common;
+    }
+    if (common < len) {
+      // the key ends or leaves in the middle of the label, split the edge there
+      uint32_t middle = m_nodes.size();
+      m_nodes.emplace_back();
+      Node &split = m_nodes.back();
+      split.label.assign(m_nodes[child].label, 0, common);
+      m_nodes[child].label.erase(0, common);
+      split.child_bytes.push_back(m_nodes[child].label[0]);
+      split.children.push_back(child);
+      m_nodes[node].children[pos] = middle;
+      child                       = middle;
+    }
+    node = child;
+    i += common;
   }
 
-  from_path = mapping->fromURL.path_get(&from_path_len);
-  if (!trie->Insert(from_path, mapping, mapping->getRank(), from_path_len)) {
-    Error("Couldn't insert into trie!");
+  Node &found = m_nodes[node];
+  if (found.value) {
+    Error("Couldn't insert into path index, duplicate path!");
     return false;
   }
+  found.value = mapping;
+  found.rank  = mapping->getRank();
+  m_values.push_back(mapping);
+  if (m_values.size() == 1 || memcmp(key.group, m_first_group, GROUP_LEN) < 0) {
+    memcpy(m_first_group, key.group, GROUP_LEN);
+  }
   Debug("UrlMappingPathIndex::Insert", "Inserted new element!");
   return true;
 }
@@ -60,34 +111,50 @@ UrlMappingPathIndex::Insert(url_mapping *mapping)
 url_mapping *
 UrlMappingPathIndex::Search(URL *request_url, int request_port, bool normal_search /* = true */) const
 {
-  url_mapping *retval = nullptr;
-  int scheme_idx;
-  UrlMappingTrie *trie;
-  int path_len;
-  const char *path;
-
-  trie = _GetTrie(request_url, scheme_idx, request_port, normal_search);
-
-  if (!trie) {
-    Debug("UrlMappingPathIndex::Search", "No mappings exist for scheme index, port combo <%d, %d>", scheme_idx, request_port);
-    goto lFail;
+  Key key;
+  if (normal_search) {
+    _SetGroup(request_url, request_port, key.group);
+  } else { // use the first group arbitrarily
+    Debug("UrlMappingPathIndex::Search", "Not performing search; will use first available group");
+    memcpy(key.group, m_first_group, GROUP_LEN);
   }
-
-  path = request_url->path_get(&path_len);
-  if (!(retval = trie->Search(path, path_len))) {
-    Debug("UrlMappingPathIndex::Search", "Couldn't find entry for url with path [%.*s]", path_len, path);
-    goto lFail;
+  key.path = request_url->path_get(&key.path_len);
+
+  const Node *found = nullptr;
+  const Node *node  = &m_nodes[0];
+  int i             = 0;
+  while (true) {
+    if (node->value && (!found || node->rank <= found->rank)) {
+      found = node;
+    }
+    if (i == key.size()) {
+      break;
+    }
+    // children are few, except at the branching of the paths
+    const void *spot = memchr(node->child_bytes.data(), key[i], node->child_bytes.size());
+    if (!spot) {
+      break;
+    }
+    const Node *child = &m_nodes[node->children[static_cast<const char *>(spot) - node->child_bytes.data()]];
+    if (!key.match(child->label, i)) {
+      break;
+    }
+    i += child->label.size();
+    node = child;
   }
-  return retval;
 
-lFail:
-  return nullptr;
+  if (!found) {
+    Debug("UrlMappingPathIndex::Search", "Couldn't find entry for url with path [%.*s]", key.path_len, key.path);
+    return nullptr;
+  }
+  Debug("UrlMappingPathIndex::Search", "Returning element with rank %d", found->rank);
+  return found->value;
 }
 
 void
 UrlMappingPathIndex::Print() const
 {
-  for (auto &m_trie : m_tries) {
-    m_trie.second->Print();
+  for (url_mapping *value : m_values) {
+    value->Print();
   }
 }
@@ -24,12 +24,23 @@
 
 #include "tscore/ink_platform.h"
 
-#include <map>
+#include <string>
+#include <vector>
 
 #include "URL.h"
 #include "UrlMapping.h"
-#include "tscore/Trie.h"
 
+/**
+  The mappings of a host, by scheme, port and path prefix, in a single radix tree keyed by the
+  scheme and port of a mapping followed by its path. The edges of the tree are labelled with
+  strings, a node only existing where paths branch or a mapping ends, so a host with thousands
+  of paths costs a node per path rather than one per character. The nodes are kept in a vector
+  and refer to their children by index, with the first byte of the label of each child next to
+  them for the lookup to scan.
+
+  A lookup returns the mapping of lowest rank among those whose path is a prefix of the path of
+  the request, the longest on a tie, for the scheme and port of the request.
+*/
 class UrlMappingPathIndex
 {
 public:
@@ -40,25 +51,40 @@ public:
   void Print() const;
 
 private:
-  typedef Trie<url_mapping> UrlMappingTrie;
+  /// The bytes of the scheme and port that lead the key of a mapping.
+  static constexpr int GROUP_LEN = 4;
 
-  struct UrlMappingTrieKey {
-    int scheme_wks_idx;
-    int port;
+  /// The key of a mapping or of a request, its group then its path.
+  struct Key {
+    char group[GROUP_LEN];
+    const char *path;
+    int path_len;
 
-    UrlMappingTrieKey(int idx, int p) : scheme_wks_idx(idx), port(p) {}
-    bool
-    operator<(const UrlMappingTrieKey &rhs) const
+    int
+    size() const
     {
-      if (scheme_wks_idx == rhs.scheme_wks_idx) {
-        return (port < rhs.port);
-      }
-      return (scheme_wks_idx < rhs.scheme_wks_idx);
+      return GROUP_LEN + path_len;
+    }
+    char
+    operator[](int i) const
+    {
+      return i < GROUP_LEN ? group[i] : path[i - GROUP_LEN];
     }
+    /// The bytes of @a label match the key from @a offset.
+    bool match(const std::string &label, int offset) const;
   };
 
-  typedef std::map<UrlMappingTrieKey, UrlMappingTrie *> UrlMappingGroup;
-  UrlMappingGroup m_tries;
+  struct Node {
+    std::string label;              ///< The edge from the parent.
+    std::string child_bytes;        ///< The first byte of the label of each child.
+    std::vector<uint32_t> children; ///< The index of each child in m_nodes.
+    url_mapping *value = nullptr;
+    int rank           = 0;
+  };
+
+  std::vector<Node> m_nodes{1}; ///< The root first.
+  std::vector<url_mapping *> m_values;
+  char m_first_group[GROUP_LEN] = {0}; ///< The lowest group inserted, for the searches without a host.
 
   // make copy-constructor and assignment operator private
   // till we properly implement them
@@ -69,10 +95,10 @@ private:
     return *this;
   }
 
-  inline UrlMappingTrie *
-  _GetTrie(URL *url, int &idx, int port, bool search = true) const
+  inline void
+  _SetGroup(URL *url, int port, char *group) const
   {
-    idx = url->scheme_get_wksidx();
+    int idx = url->scheme_get_wksidx();
     // If the scheme is empty (e.g. because of a CONNECT method), guess it
     // based on port
     if (idx == -1) {
@@ -82,16 +108,10 @@ private:
         idx = URL_WKSIDX_HTTPS;
       }
     }
-    UrlMappingGroup::const_iterator group_iter;
-    if (search) { // normal search
-      group_iter = m_tries.find(UrlMappingTrieKey(idx, port));
-    } else { // return the first trie arbitrarily
-      Debug("UrlMappingPathIndex::_GetTrie", "Not performing search; will return first available trie");
-      group_iter = m_tries.begin();
-    }
-    if (group_iter != m_tries.end()) {
-      return group_iter->second;
-    }
-    return nullptr;
+    // big endian, so that the groups sort as the scheme index then the port
+    group[0] = (idx >> 8) & 0xff;
+    group[1] = idx & 0xff;
+    group[2] = (port >> 8) & 0xff;
+    group[3] = port & 0xff;
   }
 };
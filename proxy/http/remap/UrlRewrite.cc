@@ -52,7 +52,7 @@ SetHomePageRedirectFlag(url_mapping *new_mapping, URL &new_to_url)
 }
 
 bool
-UrlRewrite::load()
+UrlRewrite::load(UrlRewrite *previous)
 {
   ats_scoped_str config_file_path;
 
@@ -89,7 +89,17 @@ UrlRewrite::load()
   Debug("url_rewrite_regex", "strategyFactory file: %s", sf.c_str());
   strategyFactory = new NextHopStrategyFactory(sf.c_str());
 
-  if (0 == this->BuildTable(config_file_path)) {
+  /* Reuse the plugin instances of the configuration being reloaded for the unchanged rules */
+  int reuse_plugin_instances = 0;
+  REC_ReadConfigInteger(reuse_plugin_instances, "proxy.config.url_remap.reuse_plugin_instances");
+  if (previous && reuse_plugin_instances) {
+    pluginFactory.reuseInstancesFrom(&previous->pluginFactory);
+  }
+
+  int build_result = this->BuildTable(config_file_path);
+  pluginFactory.reuseInstancesFrom(nullptr);
+
+  if (0 == build_result) {
     _valid = true;
     if (is_debug_tag_set("url_rewrite")) {
       Print();
@@ -553,6 +563,7 @@ UrlRewrite::_addToStore(MappingsStore &store, url_mapping *new_mapping, RegexMap
   new_mapping->setRank(count); // Use the mapping rules number count for rank
   if (is_cur_mapping_regex) {
     store.regex_list.enqueue(reg_map);
+    store.regex_index.add(src_host, count, reg_map);
     retval = true;
   } else {
     retval = TableInsert(store.hash_lookup, new_mapping, src_host);
@@ -759,7 +770,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings.regex_index, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Debug("url_rewrite", "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -816,8 +827,9 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
-                                int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
+UrlRewrite::_regexMappingLookup(const HostSuffixIndex<RegexMapping> &regex_mappings, URL *request_url, int request_port,
+                                const char *request_host, int request_host_len, int rank_ceiling,
+                                UrlMappingContainer &mapping_container)
 {
   bool retval = false;
 
@@ -841,9 +853,9 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
     request_scheme_len = hdrtoken_wks_to_length(request_scheme);
   }
 
-  // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
-  {
+  // Loop over the regexes that can match the host, in rank order, until we're satisfied
+  HostSuffixIndex<RegexMapping>::Cursor candidates(regex_mappings, std::string_view(request_host, request_host_len));
+  for (RegexMapping *list_iter = candidates.next(); list_iter != nullptr; list_iter = candidates.next()) {
     int reg_map_rank = list_iter->url_map->getRank();
 
     if (reg_map_rank > rank_ceiling) {
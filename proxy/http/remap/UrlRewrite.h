@@ -31,6 +31,7 @@
 #include "tscore/Regex.h"
 #include "PluginFactory.h"
 #include "NextHopStrategyFactory.h"
+#include "HostSuffixIndex.h"
 
 #include <memory>
 
@@ -67,9 +68,10 @@ public:
    *
    * This access data in librecords to obtain the information needed for loading the configuration.
    *
+   * @param previous The configuration being reloaded, if any, whose plugin instances can be reused.
    * @return @c true if the instance state is valid, @c false if not.
    */
-  bool load();
+  bool load(UrlRewrite *previous = nullptr);
 
   /** Build the internal url write tables.
    *
@@ -137,6 +139,7 @@ public:
   struct MappingsStore {
     std::unique_ptr<URLTable> hash_lookup;
     RegexMappingList regex_list;
+    HostSuffixIndex<RegexMapping> regex_index; // the rules of regex_list by the host suffix they need
     bool
     empty()
     {
@@ -220,8 +223,9 @@ private:
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(std::unique_ptr<URLTable> &h_table, URL *request_url, int request_port, char *request_host,
                             int request_host_len);
-  bool _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
-                           int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
+  bool _regexMappingLookup(const HostSuffixIndex<RegexMapping> &regex_mappings, URL *request_url, int request_port,
+                           const char *request_host, int request_host_len, int rank_ceiling,
+                           UrlMappingContainer &mapping_container);
   int _expandSubstitutions(int *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                            int dest_buf_size);
   void _destroyTable(std::unique_ptr<URLTable> &h_table);
@@ -0,0 +1,80 @@
+/** @file
+
+  Unit tests for the index of the regex remap rules by host suffix.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN /* include main function */
+
+#include <catch.hpp> /* catch unit-test framework */
+
+#include <vector>
+
+#include "HostSuffixIndex.h"
+
+TEST_CASE("host_regex_suffix", "[HostSuffixIndex]")
+{
+  CHECK(host_regex_suffix(R"(^(.*)\.example\.com$)") == "example.com");
+  CHECK(host_regex_suffix(R"(.*\.example\.com$)") == "example.com");
+  CHECK(host_regex_suffix(R"(^www\.example-1\.com$)") == "www.example-1.com");
+  // the first label can be the end of a longer one
+  CHECK(host_regex_suffix(R"(www\.example\.com$)") == "example.com");
+  CHECK(host_regex_suffix(R"([a-z]+example\.com$)") == "com");
+  CHECK(host_regex_suffix(R"(^x[0-9]\.example\.com$)") == "example.com");
+  // nothing required
+  CHECK(host_regex_suffix(R"(^(.*)\.example\.com)") == "");
+  CHECK(host_regex_suffix(R"(example\.com\$)") == "");
+  CHECK(host_regex_suffix(R"(^(a|b)\.example\.com$)") == "");
+  CHECK(host_regex_suffix(R"(.*\.example\.co(m)?$)") == "");
+  CHECK(host_regex_suffix(R"(.*\.com?$)") == "");
+  CHECK(host_regex_suffix(R"(.*\.example.com$)") == "");
+  CHECK(host_regex_suffix(R"(.*\.example\.c\w$)") == "");
+  CHECK(host_regex_suffix(R"(.*\\example\.com$)") == "com");
+  CHECK(host_regex_suffix("$") == "");
+}
+
+TEST_CASE("HostSuffixIndex", "[HostSuffixIndex]")
+{
+  int rules[6];
+  HostSuffixIndex<int> index;
+  REQUIRE(index.empty());
+  index.add(R"(^(.*)\.example\.com$)", 0, &rules[0]);
+  index.add(R"(^(.*)\.other\.org$)", 1, &rules[1]);
+  index.add(R"(^img(.*))", 2, &rules[2]);
+  index.add(R"(^www\.example\.com$)", 3, &rules[3]);
+  index.add(R"(.*\.com$)", 4, &rules[4]);
+  index.add(R"(^(.*)\.example\.com$)", 5, &rules[5]);
+  REQUIRE(!index.empty());
+
+  auto walk = [&](std::string_view host) {
+    std::vector<int> ranks;
+    HostSuffixIndex<int>::Cursor cursor(index, host);
+    for (int *rule = cursor.next(); rule != nullptr; rule = cursor.next()) {
+      ranks.push_back(rule - rules);
+    }
+    return ranks;
+  };
+
+  CHECK(walk("www.example.com") == std::vector<int>{0, 2, 3, 4, 5});
+  CHECK(walk("a.b.example.com") == std::vector<int>{0, 2, 4, 5});
+  CHECK(walk("a.other.org") == std::vector<int>{1, 2});
+  CHECK(walk("example.org") == std::vector<int>{2});
+  CHECK(walk("") == std::vector<int>{2});
+}
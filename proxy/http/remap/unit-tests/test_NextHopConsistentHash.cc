@@ -31,6 +31,9 @@
 #include <catch.hpp> /* catch unit-test framework */
 #include <yaml-cpp/yaml.h>
 
+#include <set>
+#include <string>
+
 #include "HttpSM.h"
 #include "nexthop_test_stubs.h"
 #include "NextHopSelectionStrategy.h"
@@ -620,3 +623,141 @@ SCENARIO("Testing NextHopConsistentHash class (alternating rings), using policy
     }
   }
 }
+
+SCENARIO("Testing NextHopConsistentHash class, using policy 'maglev_hash'", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'maglev_hash' tests.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/consistent-hash-tests.yaml");
+    strategy = nhf.strategyInstance("maglev-hash-1");
+
+    WHEN("the config is loaded.")
+    {
+      THEN("then testing maglev hash.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->policy_type == NH_MAGLEV_HASH);
+        REQUIRE(strategy->groups == 3);
+      }
+    }
+
+    WHEN("requests are received.")
+    {
+      // Walk through making requests then marking the selected host
+      // down, each host is selected once, the primary group first,
+      // until all are down and the origin is finally chosen.
+      THEN("when making requests and taking nodes down.")
+      {
+        HttpSM sm;
+        ParentResult *result = &sm.t_state.parent_result;
+        TSHttpTxn txnp       = reinterpret_cast<TSHttpTxn>(&sm);
+        std::set<std::string> selected;
+
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+
+        result->reset();
+        for (int i = 0; i < 5; i++) {
+          build_request(40001 + i, &sm, nullptr, "rabbit.net", nullptr);
+          strategy->findNextHop(txnp);
+
+          REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+          CHECK(selected.insert(result->hostname).second);
+          if (i < 2) {
+            CHECK(strstr(result->hostname, ".foo.com") != nullptr);
+          }
+          strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN);
+        }
+
+        build_request(40006, &sm, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp);
+        CHECK(result->result == ParentResultType::PARENT_DIRECT);
+        CHECK(result->hostname == nullptr);
+
+        // the same request gets the same first choice, once it is retryable.
+        time_t now = time(nullptr) + 5;
+        result->reset();
+        build_request(40007, &sm, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(strstr(result->hostname, ".foo.com") != nullptr);
+
+        // free up request resources.
+        br_destroy(sm);
+      }
+    }
+  }
+}
+
+SCENARIO("Testing NextHopConsistentHash class, using policy 'peak_ewma'", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'peak_ewma' tests.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/consistent-hash-tests.yaml");
+    strategy = nhf.strategyInstance("peak-ewma-1");
+
+    WHEN("requests are received.")
+    {
+      THEN("the selected host is kept unless it is much slower than the next one.")
+      {
+        HttpSM sm;
+        ParentResult *result = &sm.t_state.parent_result;
+        TSHttpTxn txnp       = reinterpret_cast<TSHttpTxn>(&sm);
+
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->policy_type == NH_PEAK_EWMA);
+
+        // with no load known, the consistent hash selection.
+        build_request(50001, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+        std::string first = result->hostname;
+        HostRecord *slow  = strategy->loadOf(result);
+        REQUIRE(slow != nullptr);
+        CHECK(slow->hostname == first);
+
+        // similar loads keep it.
+        ink_hrtime now = ink_get_hrtime_internal();
+        for (auto &host : strategy->host_groups[0]) {
+          host->load_start();
+          host->load_end(now, HRTIME_MSECONDS(10), false);
+        }
+        build_request(50002, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(first == result->hostname);
+
+        // a slow one is moved away from, to the other host of the group.
+        slow->load_start();
+        slow->load_end(now, HRTIME_SECONDS(2), false);
+        build_request(50003, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp);
+        REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(first != result->hostname);
+        CHECK(strstr(result->hostname, ".foo.com") != nullptr);
+
+        // free up request resources.
+        br_destroy(sm);
+      }
+    }
+  }
+}
@@ -1427,3 +1427,74 @@ SCENARIO("notifying plugins of config reload", "[plugin][core]")
     }
   }
 }
+
+SCENARIO("reusing plugin instances across config reloads", "[plugin][core]")
+{
+  REQUIRE_FALSE(sandboxDir.empty());
+  enablePluginDynamicReload();
+
+  fs::path configName = fs::path("plugin_testing_calls.so");
+  fs::path buildPath  = pluginBuildDir / fs::path("plugin_testing_calls.so");
+
+  static fs::path uuid_t1 = fs::path("c71e2bab-90dc-4770-9535-c9304c3de381"); /* UUID at moment t1 */
+  static fs::path uuid_t2 = fs::path("c71e2bab-90dc-4770-9535-e7304c3ee732"); /* UUID at moment t2 */
+
+  fs::path effectivePath;
+  fs::path runtimePath;
+
+  std::string error;
+
+  char arg1[]   = "http://example.com/";
+  char arg2[]   = "http://origin.example.com/";
+  char arg3[]   = "http://other.example.com/";
+  char *argv1[] = {arg1, arg2};
+  char *argv2[] = {arg1, arg3};
+
+  GIVEN("a configuration with 2 instances of the same plugin reloaded with one of them unchanged")
+  {
+    WHEN("the new factory reuses the instances of the old one")
+    {
+      setupConfigPathTest(configName, buildPath, uuid_t1, effectivePath, runtimePath, 1556825556);
+      PluginFactoryUnitTest *factory1 = getFactory(uuid_t1);
+      RemapPluginInst *pluginInst1    = factory1->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *pluginInst2    = factory1->getRemapPlugin(configName, 2, argv2, error, isPluginDynamicReloadEnabled());
+      CHECK_FALSE(nullptr == pluginInst1);
+      CHECK_FALSE(nullptr == pluginInst2);
+
+      PluginDebugObject *debugObject = getDebugObject(pluginInst1->_plugin);
+      debugObject->clear();
+
+      /* Same DSO, no file change, so the second factory finds the plugin already loaded */
+      PluginFactoryUnitTest *factory2 = getFactory(uuid_t2);
+      factory2->reuseInstancesFrom(factory1);
+      RemapPluginInst *pluginInst3 = factory2->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *pluginInst4 = factory2->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+      factory2->reuseInstancesFrom(nullptr);
+
+      THEN("expect the unchanged instance to be reused once, and only deleted with the last factory using it")
+      {
+        CHECK(pluginInst1 == pluginInst3);
+        CHECK_FALSE(nullptr == pluginInst4);
+        CHECK(pluginInst1 != pluginInst4);
+        CHECK(1 == debugObject->initInstanceCalled);
+
+        /* The old config deactivated, only its instance that was not reused is deleted */
+        debugObject->clear();
+        factory1->deactivate();
+        CHECK(1 == debugObject->deleteInstanceCalled);
+        CHECK(0 == debugObject->doneCalled);
+        delete factory1;
+
+        CHECK(TSREMAP_NO_REMAP == pluginInst3->doRemap(nullptr, nullptr));
+
+        debugObject->clear();
+        factory2->deactivate();
+        CHECK(2 == debugObject->deleteInstanceCalled);
+        CHECK(1 == debugObject->doneCalled);
+        delete factory2;
+      }
+
+      clean();
+    }
+  }
+}
@@ -165,20 +165,29 @@ constexpr HpackHeaderField STATIC_TABLE[] = {{"", ""},
 constexpr std::string_view HPACK_HDR_FIELD_COOKIE        = STATIC_TABLE[TS_HPACK_STATIC_TABLE_COOKIE].name;
 constexpr std::string_view HPACK_HDR_FIELD_AUTHORIZATION = STATIC_TABLE[TS_HPACK_STATIC_TABLE_AUTHORIZATION].name;
 
-/**
-  Threshold for total HdrHeap size which used by HPAK Dynamic Table.
-  The HdrHeap is filled by MIMEHdrImpl and MIMEFieldBlockImpl like below.
-  This threshold allow to allocate 3 HdrHeap at maximum.
-
-                     +------------------+-----------------------------+
-   HdrHeap 1 (2048): | MIMEHdrImpl(592) | MIMEFieldBlockImpl(528) x 2 |
-                     +------------------+-----------------------------+--...--+
-   HdrHeap 2 (4096): | MIMEFieldBlockImpl(528) x 7                            |
-                     +------------------------------------------------+--...--+--...--+
-   HdrHeap 3 (8192): | MIMEFieldBlockImpl(528) x 15                                   |
-                     +------------------------------------------------+--...--+--...--+
-*/
-static constexpr uint32_t HPACK_HDR_HEAP_THRESHOLD = sizeof(MIMEHdrImpl) + sizeof(MIMEFieldBlockImpl) * (2 + 7 + 15);
+// FNV-1a, names are hashed case insensitively as they are compared with strcasecmp
+constexpr uint64_t HPACK_HASH_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t HPACK_HASH_PRIME        = 1099511628211ULL;
+
+uint64_t
+hpack_hash_name(std::string_view name)
+{
+  uint64_t h = HPACK_HASH_OFFSET_BASIS;
+  for (char c : name) {
+    h = (h ^ static_cast<uint8_t>(ParseRules::ink_tolower(c))) * HPACK_HASH_PRIME;
+  }
+  return h;
+}
+
+uint64_t
+hpack_hash_field(std::string_view name, std::string_view value)
+{
+  uint64_t h = hpack_hash_name(name);
+  for (char c : value) {
+    h = (h ^ static_cast<uint8_t>(c)) * HPACK_HASH_PRIME;
+  }
+  return h;
+}
 
 //
 // Local functions
@@ -287,14 +296,10 @@ HpackIndexingTable::get_header_field(uint32_t index, MIMEFieldWrapper &field) co
     field.value_set(STATIC_TABLE[index].value.data(), STATIC_TABLE[index].value.size());
   } else if (index < TS_HPACK_STATIC_TABLE_ENTRY_NUM + _dynamic_table.length()) {
     // dynamic table
-    const MIMEField *m_field = _dynamic_table.get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-
-    int name_len, value_len;
-    const char *name  = m_field->name_get(&name_len);
-    const char *value = m_field->value_get(&value_len);
+    HpackHeaderField d_field = _dynamic_table.get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
 
-    field.name_set(name, name_len);
-    field.value_set(value, value_len);
+    field.name_set(d_field.name.data(), d_field.name.size());
+    field.value_set(d_field.value.data(), d_field.value.size());
   } else {
     // [RFC 7541] 2.3.3. Index Address Space
     // Indices strictly greater than the sum of the lengths of both tables
@@ -332,31 +337,17 @@ HpackIndexingTable::update_maximum_size(uint32_t new_size)
 //
 // HpackDynamicTable
 //
-HpackDynamicTable::HpackDynamicTable(uint32_t size) : _maximum_size(size)
-{
-  _mhdr = new MIMEHdr();
-  _mhdr->create();
-}
-
-HpackDynamicTable::~HpackDynamicTable()
-{
-  this->_headers.clear();
-
-  this->_mhdr->fields_clear();
-  this->_mhdr->destroy();
-  delete this->_mhdr;
+HpackDynamicTable::HpackDynamicTable(uint32_t size) : _maximum_size(size) {}
 
-  if (this->_mhdr_old != nullptr) {
-    this->_mhdr_old->fields_clear();
-    this->_mhdr_old->destroy();
-    delete this->_mhdr_old;
-  }
-}
+HpackDynamicTable::~HpackDynamicTable() {}
 
-const MIMEField *
+HpackHeaderField
 HpackDynamicTable::get_header_field(uint32_t index) const
 {
-  return this->_headers.at(index);
+  ink_release_assert(index < this->_length);
+  // Index 0 is the newest entry
+  const Entry &entry = this->_entry(this->_next_seq - 1 - index);
+  return {entry.name(), entry.value()};
 }
 
 void
@@ -369,25 +360,32 @@ HpackDynamicTable::add_header_field(const HpackHeaderField &header)
     // It is not an error to attempt to add an entry that is larger than
     // the maximum size; an attempt to add an entry larger than the entire
     // table causes the table to be emptied of all existing entries.
-    this->_headers.clear();
-    this->_mhdr->fields_clear();
-
-    if (this->_mhdr_old) {
-      this->_mhdr_old->fields_clear();
-      this->_mhdr_old->destroy();
-      delete this->_mhdr_old;
-      this->_mhdr_old = nullptr;
+    while (this->_length > 0) {
+      this->_evict_oldest_entry();
     }
-
-    this->_current_size = 0;
   } else {
     this->_current_size += header_size;
     this->_evict_overflowed_entries();
 
-    MIMEField *new_field = this->_mhdr->field_create(header.name.data(), header.name.size());
-    new_field->value_set(this->_mhdr->m_heap, this->_mhdr->m_mime, header.value.data(), header.value.size());
-    this->_mhdr->field_attach(new_field);
-    this->_headers.push_front(new_field);
+    if (this->_length == this->_entries.size()) {
+      // Grow the ring, the oldest entry goes to the first slot
+      std::vector<Entry> entries(std::max<size_t>(this->_entries.size() * 2, 16));
+      for (size_t i = 0; i < this->_length; ++i) {
+        entries[i] = std::move(this->_entries[(this->_head + i) % this->_entries.size()]);
+      }
+      this->_entries.swap(entries);
+      this->_head = 0;
+    }
+
+    Entry &entry   = this->_entries[(this->_head + this->_length) % this->_entries.size()];
+    entry.seq      = this->_next_seq++;
+    entry.name_len = header.name.size();
+    entry.field.assign(header.name.data(), header.name.size());
+    entry.field.append(header.value.data(), header.value.size());
+    ++this->_length;
+
+    this->_name_index[hpack_hash_name(header.name)]                 = entry.seq;
+    this->_field_index[hpack_hash_field(header.name, header.value)] = entry.seq;
   }
 }
 
@@ -395,26 +393,25 @@ HpackLookupResult
 HpackDynamicTable::lookup(const HpackHeaderField &header) const
 {
   HpackLookupResult result;
-  const unsigned int entry_num = TS_HPACK_STATIC_TABLE_ENTRY_NUM + this->length();
-
-  for (unsigned int index = TS_HPACK_STATIC_TABLE_ENTRY_NUM; index < entry_num; ++index) {
-    const MIMEField *m_field = this->_headers.at(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-    std::string_view name    = m_field->name_get();
-    std::string_view value   = m_field->value_get();
-
-    // TODO: replace `strcasecmp` with `memcmp`
-    // Check whether name (and value) are matched
-    if (strcasecmp(header.name, name) == 0) {
-      if (memcmp(header.value, value) == 0) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::EXACT;
-        break;
-      } else if (!result.index) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::NAME;
-      }
+
+  // Check whether name and value are matched
+  if (auto it = this->_field_index.find(hpack_hash_field(header.name, header.value)); it != this->_field_index.end()) {
+    const Entry &entry = this->_entry(it->second);
+    if (strcasecmp(header.name, entry.name()) == 0 && memcmp(header.value, entry.value()) == 0) {
+      result.index      = this->_index(entry);
+      result.index_type = HpackIndex::DYNAMIC;
+      result.match_type = HpackMatch::EXACT;
+      return result;
+    }
+  }
+
+  // Check whether name is matched
+  if (auto it = this->_name_index.find(hpack_hash_name(header.name)); it != this->_name_index.end()) {
+    const Entry &entry = this->_entry(it->second);
+    if (strcasecmp(header.name, entry.name()) == 0) {
+      result.index      = this->_index(entry);
+      result.index_type = HpackIndex::DYNAMIC;
+      result.match_type = HpackMatch::NAME;
     }
   }
 
@@ -450,59 +447,47 @@ HpackDynamicTable::update_maximum_size(uint32_t new_size)
 uint32_t
 HpackDynamicTable::length() const
 {
-  return this->_headers.size();
+  return this->_length;
 }
 
-void
-HpackDynamicTable::_evict_overflowed_entries()
+const HpackDynamicTable::Entry &
+HpackDynamicTable::_entry(uint64_t seq) const
 {
-  if (this->_current_size <= this->_maximum_size) {
-    // Do nothing
-    return;
-  }
-
-  for (auto h = this->_headers.rbegin(); h != this->_headers.rend(); ++h) {
-    int name_len, value_len;
-    (*h)->name_get(&name_len);
-    (*h)->value_get(&value_len);
+  uint64_t oldest_seq = this->_next_seq - this->_length;
+  return this->_entries[(this->_head + (seq - oldest_seq)) % this->_entries.size()];
+}
 
-    this->_current_size -= ADDITIONAL_OCTETS + name_len + value_len;
+uint32_t
+HpackDynamicTable::_index(const Entry &entry) const
+{
+  return TS_HPACK_STATIC_TABLE_ENTRY_NUM + (this->_next_seq - 1 - entry.seq);
+}
 
-    if (this->_mhdr_old && this->_mhdr_old->fields_count() != 0) {
-      this->_mhdr_old->field_delete(*h, false);
-    } else {
-      this->_mhdr->field_delete(*h, false);
-    }
+void
+HpackDynamicTable::_evict_oldest_entry()
+{
+  const Entry &entry = this->_entries[this->_head];
 
-    this->_headers.pop_back();
+  this->_current_size -= ADDITIONAL_OCTETS + entry.field.size();
 
-    if (this->_current_size <= this->_maximum_size) {
-      break;
-    }
+  // Indexes may already point to a newer entry which has the same name or field
+  if (auto it = this->_name_index.find(hpack_hash_name(entry.name())); it != this->_name_index.end() && it->second == entry.seq) {
+    this->_name_index.erase(it);
+  }
+  if (auto it = this->_field_index.find(hpack_hash_field(entry.name(), entry.value()));
+      it != this->_field_index.end() && it->second == entry.seq) {
+    this->_field_index.erase(it);
   }
 
-  this->_mime_hdr_gc();
+  this->_head = (this->_head + 1) % this->_entries.size();
+  --this->_length;
 }
 
-/**
-   When HdrHeap size of current MIMEHdr exceeds the threshold, allocate new MIMEHdr and HdrHeap.
-   The old MIMEHdr and HdrHeap will be freed, when all MIMEFiled are deleted by HPACK Entry Eviction.
- */
 void
-HpackDynamicTable::_mime_hdr_gc()
+HpackDynamicTable::_evict_overflowed_entries()
 {
-  if (this->_mhdr_old == nullptr) {
-    if (this->_mhdr->m_heap->total_used_size() >= HPACK_HDR_HEAP_THRESHOLD) {
-      this->_mhdr_old = this->_mhdr;
-      this->_mhdr     = new MIMEHdr();
-      this->_mhdr->create();
-    }
-  } else {
-    if (this->_mhdr_old->fields_count() == 0) {
-      this->_mhdr_old->destroy();
-      delete this->_mhdr_old;
-      this->_mhdr_old = nullptr;
-    }
+  while (this->_current_size > this->_maximum_size && this->_length > 0) {
+    this->_evict_oldest_entry();
   }
 }
 
@@ -28,8 +28,10 @@
 #include "HTTP.h"
 #include "../hdrs/XPACK.h"
 
-#include <deque>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 // It means that any header field can be compressed/decompressed by ATS
 const static int HPACK_ERROR_COMPRESSION_ERROR   = -1;
@@ -108,6 +110,9 @@ private:
 };
 
 // [RFC 7541] 2.3.2. Dynamic Table
+//
+// Entries are kept in a ring buffer. Two hash indexes map a name, and a name and value, to the newest entry that has them, so
+// lookup() doesn't have to scan the table.
 class HpackDynamicTable
 {
 public:
@@ -118,7 +123,7 @@ public:
   HpackDynamicTable(HpackDynamicTable &) = delete;
   HpackDynamicTable &operator=(const HpackDynamicTable &) = delete;
 
-  const MIMEField *get_header_field(uint32_t index) const;
+  HpackHeaderField get_header_field(uint32_t index) const;
   void add_header_field(const HpackHeaderField &header);
 
   HpackLookupResult lookup(const HpackHeaderField &header) const;
@@ -129,15 +134,41 @@ public:
   uint32_t length() const;
 
 private:
+  struct Entry {
+    uint64_t seq      = 0; // position in insertion order
+    uint32_t name_len = 0;
+    std::string field;     // name followed by value
+
+    std::string_view
+    name() const
+    {
+      return {field.data(), name_len};
+    }
+
+    std::string_view
+    value() const
+    {
+      return {field.data() + name_len, field.size() - name_len};
+    }
+  };
+
+  const Entry &_entry(uint64_t seq) const;
+  uint32_t _index(const Entry &entry) const;
+  void _evict_oldest_entry();
   void _evict_overflowed_entries();
-  void _mime_hdr_gc();
 
   uint32_t _current_size = 0;
   uint32_t _maximum_size = 0;
 
-  MIMEHdr *_mhdr     = nullptr;
-  MIMEHdr *_mhdr_old = nullptr;
-  std::deque<MIMEField *> _headers;
+  // Slots keep the capacity of their strings when they are reused, so adding entries doesn't allocate once the table is warm
+  std::vector<Entry> _entries;
+  size_t _head       = 0; // slot of the oldest entry
+  size_t _length     = 0;
+  uint64_t _next_seq = 0;
+
+  // Hash of a name, or of a name and value, to seq of the newest entry that has it. A hash collision only loses a match.
+  std::unordered_map<uint64_t, uint64_t> _name_index;
+  std::unordered_map<uint64_t, uint64_t> _field_index;
 };
 
 // [RFC 7541] 2.3. Indexing Table
@@ -84,6 +84,7 @@ static const char *const HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED_NAME =
 static const char *const HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED_NAME =
   "proxy.process.http2.max_priority_frames_per_minute_exceeded";
 static const char *const HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME = "proxy.process.http2.insufficient_avg_window_update";
+static const char *const HTTP2_STAT_SESSION_COST_LIMIT_EXCEEDED_NAME     = "proxy.process.http2.session_cost_limit_exceeded";
 
 union byte_pointer {
   byte_pointer(void *p) : ptr(p) {}
@@ -355,6 +356,65 @@ http2_parse_priority_parameter(IOVec iov, Http2Priority &priority)
   return true;
 }
 
+// [RFC 9218] 4. Priority Parameters
+// Parse the urgency and incremental parameters of a "priority" header field value, a Structured Fields
+// Dictionary such as "u=1, i". Unknown parameters and out of range values are ignored, as the RFC requires.
+// Returns false if the value contains neither parameter.
+bool
+http2_parse_priority_field(const char *value, int len, uint8_t &urgency, bool &incremental)
+{
+  const char *p   = value;
+  const char *end = value + len;
+  bool found      = false;
+
+  while (p < end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) {
+      ++p;
+    }
+    if (p == end) {
+      break;
+    }
+
+    const char *key = p;
+    while (p < end && *p != '=' && *p != ',' && *p != ';' && *p != ' ') {
+      ++p;
+    }
+    const int key_len = p - key;
+
+    const char *member_value = nullptr;
+    int member_value_len     = 0;
+    if (p < end && *p == '=') {
+      member_value = ++p;
+      while (p < end && *p != ',' && *p != ';' && *p != ' ') {
+        ++p;
+      }
+      member_value_len = p - member_value;
+    }
+    // Skip member parameters, they carry nothing for either key
+    while (p < end && *p != ',') {
+      ++p;
+    }
+
+    if (key_len != 1) {
+      continue;
+    }
+    if (key[0] == 'u' && member_value_len == 1 && member_value[0] >= '0' && member_value[0] < '0' + HTTP2_PRIORITY_URGENCY_LEVELS) {
+      urgency = member_value[0] - '0';
+      found   = true;
+    } else if (key[0] == 'i') {
+      if (member_value == nullptr || (member_value_len == 2 && member_value[0] == '?' && member_value[1] == '1')) {
+        incremental = true;
+        found       = true;
+      } else if (member_value_len == 2 && member_value[0] == '?' && member_value[1] == '0') {
+        incremental = false;
+        found       = true;
+      }
+    }
+  }
+
+  return found;
+}
+
 bool
 http2_parse_rst_stream(IOVec iov, Http2RstStream &rst_stream)
 {
@@ -786,7 +846,11 @@ uint32_t Http2::min_concurrent_streams_in      = 10;
 uint32_t Http2::max_active_streams_in          = 0;
 bool Http2::throttling                         = false;
 uint32_t Http2::stream_priority_enabled        = 0;
+uint32_t Http2::extensible_priorities_enabled  = 0;
 uint32_t Http2::initial_window_size            = 65535;
+uint32_t Http2::window_auto_tuning_enabled     = 0;
+uint32_t Http2::max_stream_window_size_in      = 16777216;
+uint32_t Http2::max_connection_window_size_in  = 33554432;
 uint32_t Http2::max_frame_size                 = 16384;
 uint32_t Http2::header_table_size              = 4096;
 uint32_t Http2::max_header_list_size           = 4294967295;
@@ -801,11 +865,13 @@ uint32_t Http2::max_settings_per_minute        = 14;
 uint32_t Http2::max_settings_frames_per_minute = 14;
 uint32_t Http2::max_ping_frames_per_minute     = 60;
 uint32_t Http2::max_priority_frames_per_minute = 120;
+uint32_t Http2::session_cost_limit             = 0;
 float Http2::min_avg_window_update             = 2560.0;
 uint32_t Http2::con_slow_log_threshold         = 0;
 uint32_t Http2::stream_slow_log_threshold      = 0;
 uint32_t Http2::header_table_size_limit        = 65536;
 uint32_t Http2::write_buffer_block_size        = 262144;
+int64_t Http2::session_buffer_limit            = 0;
 float Http2::write_size_threshold              = 0.5;
 uint32_t Http2::write_time_threshold           = 100;
 
@@ -816,7 +882,11 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(min_concurrent_streams_in, "proxy.config.http2.min_concurrent_streams_in");
   REC_EstablishStaticConfigInt32U(max_active_streams_in, "proxy.config.http2.max_active_streams_in");
   REC_EstablishStaticConfigInt32U(stream_priority_enabled, "proxy.config.http2.stream_priority_enabled");
+  REC_EstablishStaticConfigInt32U(extensible_priorities_enabled, "proxy.config.http2.extensible_priorities_enabled");
   REC_EstablishStaticConfigInt32U(initial_window_size, "proxy.config.http2.initial_window_size_in");
+  REC_EstablishStaticConfigInt32U(window_auto_tuning_enabled, "proxy.config.http2.window_auto_tuning_enabled");
+  REC_EstablishStaticConfigInt32U(max_stream_window_size_in, "proxy.config.http2.max_stream_window_size_in");
+  REC_EstablishStaticConfigInt32U(max_connection_window_size_in, "proxy.config.http2.max_connection_window_size_in");
   REC_EstablishStaticConfigInt32U(max_frame_size, "proxy.config.http2.max_frame_size");
   REC_EstablishStaticConfigInt32U(header_table_size, "proxy.config.http2.header_table_size");
   REC_EstablishStaticConfigInt32U(max_header_list_size, "proxy.config.http2.max_header_list_size");
@@ -831,11 +901,13 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(max_settings_frames_per_minute, "proxy.config.http2.max_settings_frames_per_minute");
   REC_EstablishStaticConfigInt32U(max_ping_frames_per_minute, "proxy.config.http2.max_ping_frames_per_minute");
   REC_EstablishStaticConfigInt32U(max_priority_frames_per_minute, "proxy.config.http2.max_priority_frames_per_minute");
+  REC_EstablishStaticConfigInt32U(session_cost_limit, "proxy.config.http2.session_cost_limit");
   REC_EstablishStaticConfigFloat(min_avg_window_update, "proxy.config.http2.min_avg_window_update");
   REC_EstablishStaticConfigInt32U(con_slow_log_threshold, "proxy.config.http2.connection.slow.log.threshold");
   REC_EstablishStaticConfigInt32U(stream_slow_log_threshold, "proxy.config.http2.stream.slow.log.threshold");
   REC_EstablishStaticConfigInt32U(header_table_size_limit, "proxy.config.http2.header_table_size_limit");
   REC_EstablishStaticConfigInt32U(write_buffer_block_size, "proxy.config.http2.write_buffer_block_size");
+  REC_EstablishStaticConfigInteger(session_buffer_limit, "proxy.config.http2.session_buffer_limit");
   REC_EstablishStaticConfigFloat(write_size_threshold, "proxy.config.http2.write_size_threshold");
   REC_EstablishStaticConfigInt32U(write_time_threshold, "proxy.config.http2.write_time_threshold");
 
@@ -900,6 +972,8 @@ Http2::init()
                      static_cast<int>(HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED), RecRawStatSyncSum);
   RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME, RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_SESSION_COST_LIMIT_EXCEEDED_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_SESSION_COST_LIMIT_EXCEEDED), RecRawStatSyncSum);
 
   http2_init();
 }
@@ -82,6 +82,10 @@ const uint32_t HTTP2_MAX_BUFFER_USAGE       = 524288;
 const uint32_t HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY = 0;
 const uint8_t HTTP2_PRIORITY_DEFAULT_WEIGHT             = 15;
 
+// [RFC 9218] 4. Priority Parameters
+const uint8_t HTTP2_PRIORITY_URGENCY_LEVELS  = 8;
+const uint8_t HTTP2_PRIORITY_DEFAULT_URGENCY = 3;
+
 // Statistics
 enum {
   HTTP2_STAT_CURRENT_CLIENT_SESSION_COUNT,           // Current # of HTTP2 connections
@@ -105,6 +109,7 @@ enum {
   HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE,
+  HTTP2_STAT_SESSION_COST_LIMIT_EXCEEDED,
 
   HTTP2_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
@@ -354,6 +359,8 @@ bool http2_parse_headers_parameter(IOVec, Http2HeadersParameter &);
 
 bool http2_parse_priority_parameter(IOVec, Http2Priority &);
 
+bool http2_parse_priority_field(const char *, int, uint8_t &, bool &);
+
 bool http2_parse_rst_stream(IOVec, Http2RstStream &);
 
 bool http2_parse_settings_parameter(IOVec, Http2SettingsParameter &);
@@ -384,7 +391,11 @@ public:
   static uint32_t max_active_streams_in;
   static bool throttling;
   static uint32_t stream_priority_enabled;
+  static uint32_t extensible_priorities_enabled;
   static uint32_t initial_window_size;
+  static uint32_t window_auto_tuning_enabled;
+  static uint32_t max_stream_window_size_in;
+  static uint32_t max_connection_window_size_in;
   static uint32_t max_frame_size;
   static uint32_t header_table_size;
   static uint32_t max_header_list_size;
@@ -399,11 +410,13 @@ public:
   static uint32_t max_settings_frames_per_minute;
   static uint32_t max_ping_frames_per_minute;
   static uint32_t max_priority_frames_per_minute;
+  static uint32_t session_cost_limit;
   static float min_avg_window_update;
   static uint32_t con_slow_log_threshold;
   static uint32_t stream_slow_log_threshold;
   static uint32_t header_table_size_limit;
   static uint32_t write_buffer_block_size;
+  static int64_t session_buffer_limit;
   static float write_size_threshold;
   static uint32_t write_time_threshold;
 
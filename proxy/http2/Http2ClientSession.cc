@@ -213,13 +213,15 @@ Http2ClientSession::new_connection(NetVConnection *new_vc, MIOBuffer *iobuf, IOB
 
   this->_vc->set_tcp_congestion_control(CLIENT_SIDE);
 
-  this->read_buffer             = iobuf ? iobuf : new_MIOBuffer(HTTP2_HEADER_BUFFER_SIZE_INDEX);
+  this->buffer_account = new IOBufferAccount("Http2ClientSession", Http2::session_buffer_limit);
+
+  this->read_buffer             = iobuf ? iobuf : new_MIOBuffer(HTTP2_HEADER_BUFFER_SIZE_INDEX, this->buffer_account.get());
   this->read_buffer->water_mark = connection_state.server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE);
   this->_reader                 = reader ? reader : this->read_buffer->alloc_reader();
 
   // This block size is the buffer size that we pass to SSLWriteBuffer
   auto buffer_block_size_index = iobuffer_size_to_index(Http2::write_buffer_block_size, MAX_BUFFER_SIZE_INDEX);
-  this->write_buffer           = new_MIOBuffer(buffer_block_size_index);
+  this->write_buffer           = new_MIOBuffer(buffer_block_size_index, this->buffer_account.get());
   this->sm_writer              = this->write_buffer->alloc_reader();
   this->_write_size_threshold  = index_to_buffer_size(buffer_block_size_index) * Http2::write_size_threshold;
 
@@ -586,6 +588,17 @@ Http2ClientSession::state_process_frame_read(int event, VIO *vio, bool inside_fr
     }
     do_complete_frame_read();
 
+    // Stop reading for a while if the client has made us do too much work recently
+    if (ink_hrtime throttle_time = this->connection_state.get_session_throttle_time(); throttle_time > 0) {
+      if (this->_reenable_event == nullptr) {
+        HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_SESSION_COST_LIMIT_EXCEEDED, this_ethread());
+        Http2SsnDebug("Session cost exceeded the limit, pausing reading for %" PRId64 " ms", ink_hrtime_to_msec(throttle_time));
+        vio->disable();
+        this->_reenable_event = mutex->thread_holding->schedule_in(this, throttle_time, HTTP2_SESSION_EVENT_REENABLE, vio);
+        return 0;
+      }
+    }
+
     if (this->_should_do_something_else()) {
       if (this->_reenable_event == nullptr) {
         vio->disable();
@@ -35,6 +35,8 @@
 #include <sstream>
 #include <numeric>
 
+#include <netinet/tcp.h>
+
 #define REMEMBER(e, r)                                        \
   {                                                           \
     if (this->ua_session) {                                   \
@@ -50,6 +52,14 @@
 
 using http2_frame_dispatch = Http2Error (*)(Http2ConnectionState &, const Http2Frame &);
 
+// Upper bound of the header heap shared by the request headers of a session's streams
+static constexpr uint64_t HTTP2_STREAM_HDR_HEAP_LIMIT = 64 * 1024;
+
+// Weights of the work a client makes a session do, in the unit of one header block byte to be HPACK decoded
+static constexpr uint32_t HTTP2_COST_STREAM_OPEN        = 1024;
+static constexpr uint32_t HTTP2_COST_PRIORITY_MUTATION  = 256;
+static constexpr uint32_t HTTP2_COST_CONTINUATION_FRAME = 256;
+
 static const int buffer_size_index[HTTP2_FRAME_TYPE_MAX] = {
   BUFFER_SIZE_INDEX_16K, // HTTP2_FRAME_TYPE_DATA
   BUFFER_SIZE_INDEX_16K, // HTTP2_FRAME_TYPE_HEADERS
@@ -78,6 +88,30 @@ read_rcv_buffer(char *buf, size_t bufsize, unsigned &nbytes, const Http2Frame &f
   return end - buf;
 }
 
+// [RFC 9218] 5. The Priority HTTP Header Field
+static void
+update_urgency_from_request(Http2ConnectionState &cstate, Http2Stream *stream)
+{
+  Http2UrgencyScheduler::Node *node = stream->urgency_node;
+  if (node == nullptr) {
+    return;
+  }
+
+  const MIMEField *field = stream->get_request_headers()->field_find("priority", 8);
+  if (field == nullptr) {
+    return;
+  }
+
+  int value_len;
+  const char *value = field->value_get(&value_len);
+  uint8_t urgency   = node->urgency;
+  bool incremental  = node->incremental;
+  if (http2_parse_priority_field(value, value_len, urgency, incremental)) {
+    Http2StreamDebug(cstate.ua_session, stream->get_id(), "PRIORITY FIELD - u: %u, i: %d", urgency, incremental);
+    cstate.urgency_scheduler->reprioritize(node, urgency, incremental);
+  }
+}
+
 static Http2Error
 rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 {
@@ -317,7 +351,11 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     header_block_fragment_length -= HTTP2_PRIORITY_LEN;
   }
 
-  if (new_stream && Http2::stream_priority_enabled) {
+  if (new_stream) {
+    cstate.select_priority_scheduler();
+  }
+
+  if (new_stream && cstate.dependency_tree) {
     Http2DependencyTree::Node *node = cstate.dependency_tree->find(stream_id);
     if (node != nullptr) {
       stream->priority_node = node;
@@ -329,10 +367,14 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
       stream->priority_node = cstate.dependency_tree->add(params.priority.stream_dependency, stream_id, params.priority.weight,
                                                           params.priority.exclusive_flag, stream);
+      cstate.add_session_cost(HTTP2_COST_PRIORITY_MUTATION);
     }
+  } else if (new_stream && cstate.urgency_scheduler) {
+    stream->urgency_node = cstate.urgency_scheduler->add(stream_id, HTTP2_PRIORITY_DEFAULT_URGENCY, false, stream);
   }
 
   stream->header_blocks_length = header_block_fragment_length;
+  cstate.add_session_cost(header_block_fragment_length);
 
   // ATS advertises SETTINGS_MAX_HEADER_LIST_SIZE as a limit of total header blocks length. (Details in [RFC 7560] 10.5.1.)
   // Make it double to relax the limit in cases of 1) HPACK is used naively, or 2) Huffman Encoding generates large header blocks.
@@ -384,6 +426,8 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
     // Set up the State Machine
     if (!empty_request) {
+      update_urgency_from_request(cstate, stream);
+
       SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
       stream->mark_milestone(Http2StreamMilestone::START_TXN);
       stream->new_transaction(frame.is_from_early_data());
@@ -448,7 +492,8 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "PRIORITY frame depends on itself");
   }
 
-  if (!Http2::stream_priority_enabled) {
+  // The dependency tree is dropped for the session once the urgency scheduler has been selected
+  if (cstate.dependency_tree == nullptr) {
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
@@ -467,6 +512,7 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
   Http2StreamDebug(cstate.ua_session, stream_id, "PRIORITY - dep: %d, weight: %d, excl: %d, tree size: %d",
                    priority.stream_dependency, priority.weight, priority.exclusive_flag, cstate.dependency_tree->size());
+  cstate.add_session_cost(HTTP2_COST_PRIORITY_MUTATION);
 
   Http2DependencyTree::Node *node = cstate.dependency_tree->find(stream_id);
 
@@ -904,6 +950,7 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
   uint32_t header_blocks_offset = stream->header_blocks_length;
   stream->header_blocks_length += payload_length;
+  cstate.add_session_cost(HTTP2_COST_CONTINUATION_FRAME + payload_length);
 
   // ATS advertises SETTINGS_MAX_HEADER_LIST_SIZE as a limit of total header blocks length. (Details in [RFC 7560] 10.5.1.)
   // Make it double to relax the limit in cases of 1) HPACK is used naively, or 2) Huffman Encoding generates large header blocks.
@@ -941,6 +988,8 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
       }
     }
 
+    update_urgency_from_request(cstate, stream);
+
     // Set up the State Machine
     SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
     stream->mark_milestone(Http2StreamMilestone::START_TXN);
@@ -1218,7 +1267,7 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
   }
 
   Http2Stream *new_stream = THREAD_ALLOC_INIT(http2StreamAllocator, this_ethread());
-  new_stream->init(new_id, client_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+  new_stream->init(new_id, client_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE), this->_acquire_stream_hdr_heap());
 
   ink_assert(nullptr != new_stream);
   ink_assert(!stream_list.in(new_stream));
@@ -1234,6 +1283,7 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
     ++client_streams_out_count;
   }
   ++total_client_streams_count;
+  this->add_session_cost(HTTP2_COST_STREAM_OPEN);
 
   if (zombie_event != nullptr) {
     zombie_event->cancel();
@@ -1248,6 +1298,34 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
   return new_stream;
 }
 
+// Request headers of all streams are allocated from one heap per session so that streams do not each allocate a heap
+// of their own. Nothing is freed in the shared heap until its last user goes away, so streams get private heaps once
+// it has grown past the limit.
+HdrHeap *
+Http2ConnectionState::_acquire_stream_hdr_heap()
+{
+  if (this->_stream_hdr_heap == nullptr) {
+    ink_assert(this->_stream_hdr_heap_users == 0);
+    this->_stream_hdr_heap = new_HdrHeap();
+  } else if (this->_stream_hdr_heap->total_used_size() >= HTTP2_STREAM_HDR_HEAP_LIMIT) {
+    return nullptr;
+  }
+
+  ++this->_stream_hdr_heap_users;
+  return this->_stream_hdr_heap;
+}
+
+void
+Http2ConnectionState::_release_stream_hdr_heap()
+{
+  ink_assert(this->_stream_hdr_heap_users > 0);
+
+  if (--this->_stream_hdr_heap_users == 0) {
+    this->_stream_hdr_heap->destroy();
+    this->_stream_hdr_heap = nullptr;
+  }
+}
+
 Http2Stream *
 Http2ConnectionState::find_stream(Http2StreamId id) const
 {
@@ -1302,32 +1380,89 @@ Http2ConnectionState::restart_streams()
 void
 Http2ConnectionState::restart_receiving(Http2Stream *stream)
 {
-  uint32_t initial_rwnd = this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
-  uint32_t min_rwnd     = std::min(initial_rwnd, this->server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE));
+  uint32_t initial_rwnd      = this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
+  uint32_t min_rwnd          = std::min(initial_rwnd, this->server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE));
+  uint32_t connection_rwnd   = std::max(initial_rwnd, this->_connection_rwnd_target);
+  uint32_t stream_rwnd       = std::max(initial_rwnd, this->_stream_rwnd_target);
+  uint32_t connection_refill = min_rwnd;
+  uint32_t stream_refill     = min_rwnd;
+
+  // With auto-tuning a window is refilled once half of it is used, so that its growth takes effect before the peer stalls
+  if (Http2::window_auto_tuning_enabled) {
+    connection_refill = std::max(min_rwnd, connection_rwnd / 2);
+    stream_refill     = std::max(min_rwnd, stream_rwnd / 2);
+  }
 
   // Connection level WINDOW UPDATE
-  if (this->server_rwnd() < min_rwnd) {
-    Http2WindowSize diff_size = initial_rwnd - this->server_rwnd();
+  if (this->server_rwnd() < connection_refill) {
+    connection_rwnd = this->_tune_rwnd(connection_rwnd, Http2::max_connection_window_size_in, this->_connection_window_update_time);
+    this->_connection_rwnd_target = connection_rwnd;
+
+    Http2WindowSize diff_size = connection_rwnd - this->server_rwnd();
     this->increment_server_rwnd(diff_size);
     this->send_window_update_frame(0, diff_size);
   }
 
   // Stream level WINDOW UPDATE
-  if (stream == nullptr || stream->server_rwnd() >= min_rwnd) {
+  if (stream == nullptr || stream->server_rwnd() >= stream_refill) {
     return;
   }
 
   // If read_vio is buffering data, do not fully update window
   int64_t data_size = stream->read_vio_read_avail();
-  if (data_size >= initial_rwnd) {
+  if (data_size >= stream_rwnd) {
     return;
   }
 
-  Http2WindowSize diff_size = initial_rwnd - std::max(static_cast<int64_t>(stream->server_rwnd()), data_size);
+  // Grow only while the reader drains the buffer, otherwise the consumer rather than the window limits the upload
+  if (data_size < stream_rwnd / 2) {
+    stream_rwnd = this->_tune_rwnd(stream_rwnd, Http2::max_stream_window_size_in, stream->window_update_time);
+    if (stream_rwnd > this->_stream_rwnd_target) {
+      this->_stream_rwnd_target = stream_rwnd;
+      // The connection window has to cover at least one stream window
+      this->_connection_rwnd_target = std::max(connection_rwnd, std::min(stream_rwnd, Http2::max_connection_window_size_in));
+    }
+  }
+
+  Http2WindowSize diff_size = stream_rwnd - std::max(static_cast<int64_t>(stream->server_rwnd()), data_size);
   stream->increment_server_rwnd(diff_size);
   this->send_window_update_frame(stream->get_id(), diff_size);
 }
 
+// Double a receive window, up to the ceiling, when it was refilled less than two round trips after the previous refill.
+// The peer then used the whole window faster than an update could reach it, so the window limits the transfer rather
+// than the path.
+uint32_t
+Http2ConnectionState::_tune_rwnd(uint32_t rwnd, uint32_t ceiling, ink_hrtime &last_update)
+{
+  ink_hrtime now      = Thread::get_hrtime();
+  ink_hrtime previous = last_update;
+  last_update         = now;
+
+  ceiling = std::min(ceiling, static_cast<uint32_t>(HTTP2_MAX_WINDOW_SIZE));
+  if (!Http2::window_auto_tuning_enabled || previous == 0 || rwnd >= ceiling) {
+    return rwnd;
+  }
+
+  ink_hrtime rtt = this->_peer_rtt();
+  if (rtt == 0 || now - previous >= 2 * rtt) {
+    return rwnd;
+  }
+
+  uint32_t new_rwnd = std::min(static_cast<uint64_t>(rwnd) * 2, static_cast<uint64_t>(ceiling));
+  Http2ConDebug(ua_session, "Grow receive window %u -> %u, rtt=%" PRId64 "us", rwnd, new_rwnd, ink_hrtime_to_usec(rtt));
+  return new_rwnd;
+}
+
+// Smoothed RTT of the client connection as measured by the kernel, from the samples of its NetHandler
+ink_hrtime
+Http2ConnectionState::_peer_rtt()
+{
+  NetVConnection *netvc = this->ua_session ? this->ua_session->get_netvc() : nullptr;
+  const TcpInfo *info   = netvc ? netvc->get_tcp_info() : nullptr;
+  return info ? info->rtt : 0;
+}
+
 void
 Http2ConnectionState::cleanup_streams()
 {
@@ -1369,7 +1504,11 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
   Http2StreamDebug(ua_session, stream->get_id(), "Delete stream");
   REMEMBER(NO_EVENT, this->recursion);
 
-  if (Http2::stream_priority_enabled) {
+  if (stream->detach_shared_request_headers()) {
+    this->_release_stream_hdr_heap();
+  }
+
+  if (dependency_tree) {
     Http2DependencyTree::Node *node = stream->priority_node;
     if (node != nullptr) {
       if (node->active) {
@@ -1385,6 +1524,10 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
     }
     stream->priority_node = nullptr;
   }
+  if (urgency_scheduler && stream->urgency_node != nullptr) {
+    urgency_scheduler->remove(stream->urgency_node);
+    stream->urgency_node = nullptr;
+  }
 
   if (stream->get_state() != Http2StreamState::HTTP2_STREAM_STATE_CLOSED) {
     send_rst_stream_frame(stream->get_id(), Http2ErrorCode::HTTP2_ERROR_NO_ERROR);
@@ -1455,16 +1598,45 @@ Http2ConnectionState::update_initial_rwnd(Http2WindowSize new_size)
   }
 }
 
+// The urgency scheduler is used unless the client builds a dependency tree with PRIORITY frames before its
+// first request; the choice is made once per session and the unused scheduler is released.
+void
+Http2ConnectionState::select_priority_scheduler()
+{
+  if (_priority_scheduler_selected) {
+    return;
+  }
+  _priority_scheduler_selected = true;
+
+  if (dependency_tree == nullptr || urgency_scheduler == nullptr) {
+    return;
+  }
+
+  if (dependency_tree->size() > 0) {
+    Http2ConDebug(ua_session, "Use the dependency tree for stream scheduling");
+    delete urgency_scheduler;
+    urgency_scheduler = nullptr;
+  } else {
+    Http2ConDebug(ua_session, "Use the urgency scheduler for stream scheduling");
+    delete dependency_tree;
+    dependency_tree = nullptr;
+  }
+}
+
 void
 Http2ConnectionState::schedule_stream(Http2Stream *stream)
 {
   Http2StreamDebug(ua_session, stream->get_id(), "Scheduled");
 
-  Http2DependencyTree::Node *node = stream->priority_node;
-  ink_release_assert(node != nullptr);
-
   SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
-  dependency_tree->activate(node);
+  if (urgency_scheduler) {
+    ink_release_assert(stream->urgency_node != nullptr);
+    urgency_scheduler->activate(stream->urgency_node);
+  } else {
+    Http2DependencyTree::Node *node = stream->priority_node;
+    ink_release_assert(node != nullptr);
+    dependency_tree->activate(node);
+  }
 
   if (!_scheduled) {
     _scheduled = true;
@@ -1477,6 +1649,11 @@ Http2ConnectionState::schedule_stream(Http2Stream *stream)
 void
 Http2ConnectionState::send_data_frames_depends_on_priority()
 {
+  if (urgency_scheduler) {
+    _send_data_frames_depends_on_urgency();
+    return;
+  }
+
   Http2DependencyTree::Node *node = dependency_tree->top();
 
   // No node to send or no connection level window left
@@ -1519,6 +1696,50 @@ Http2ConnectionState::send_data_frames_depends_on_priority()
   return;
 }
 
+void
+Http2ConnectionState::_send_data_frames_depends_on_urgency()
+{
+  Http2UrgencyScheduler::Node *node = urgency_scheduler->top();
+
+  // No node to send or no connection level window left
+  if (node == nullptr || _client_rwnd <= 0) {
+    return;
+  }
+
+  Http2Stream *stream = static_cast<Http2Stream *>(node->t);
+  ink_release_assert(stream != nullptr);
+  Http2StreamDebug(ua_session, stream->get_id(), "top node, urgency=%u", node->urgency);
+
+  size_t len                      = 0;
+  Http2SendDataFrameResult result = send_a_data_frame(stream, len);
+
+  switch (result) {
+  case Http2SendDataFrameResult::NO_ERROR: {
+    // No response body to send
+    if (len == 0 && !stream->is_write_vio_done()) {
+      urgency_scheduler->deactivate(node);
+    } else {
+      urgency_scheduler->update(node);
+
+      SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
+      stream->signal_write_event(true);
+    }
+    break;
+  }
+  case Http2SendDataFrameResult::DONE: {
+    urgency_scheduler->deactivate(node);
+    stream->initiating_close();
+    break;
+  }
+  default:
+    // When no stream level window left, deactivate node once and wait window_update frame
+    urgency_scheduler->deactivate(node);
+    break;
+  }
+
+  this_ethread()->schedule_imm_local((Continuation *)this, HTTP2_SESSION_EVENT_XMIT);
+}
+
 Http2SendDataFrameResult
 Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_length)
 {
@@ -1782,7 +2003,7 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
   }
 
   SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
-  if (Http2::stream_priority_enabled) {
+  if (this->dependency_tree) {
     Http2DependencyTree::Node *node = this->dependency_tree->find(id);
     if (node != nullptr) {
       stream->priority_node = node;
@@ -1794,6 +2015,8 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
       stream->priority_node =
         this->dependency_tree->add(HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY, id, HTTP2_PRIORITY_DEFAULT_WEIGHT, false, stream);
     }
+  } else if (this->urgency_scheduler) {
+    stream->urgency_node = this->urgency_scheduler->add(id, HTTP2_PRIORITY_DEFAULT_URGENCY, false, stream);
   }
   stream->change_state(HTTP2_FRAME_TYPE_PUSH_PROMISE, HTTP2_FLAGS_PUSH_PROMISE_END_HEADERS);
   stream->set_request_headers(hdr);
@@ -1951,6 +2174,27 @@ Http2ConnectionState::get_received_priority_frame_count()
   return this->_received_priority_frame_counter.get_count();
 }
 
+void
+Http2ConnectionState::add_session_cost(uint32_t cost)
+{
+  if (Http2::session_cost_limit == 0) {
+    return;
+  }
+  this->_session_cost.set_drain_rate(Http2::session_cost_limit);
+  this->_session_cost.add(cost);
+}
+
+// How long the session should stop reading for the accumulated cost to drain below the limit. Reading is resumed at
+// least once a second so that the session keeps making progress on what was already read.
+ink_hrtime
+Http2ConnectionState::get_session_throttle_time()
+{
+  if (Http2::session_cost_limit == 0) {
+    return 0;
+  }
+  return std::min(this->_session_cost.time_until(Http2::session_cost_limit), HRTIME_SECOND);
+}
+
 // Return min_concurrent_streams_in when current client streams number is larger than max_active_streams_in.
 // Main purpose of this is preventing DDoS Attacks.
 unsigned
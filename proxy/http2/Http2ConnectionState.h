@@ -122,10 +122,11 @@ public:
 
   ProxyError rx_error_code;
   ProxyError tx_error_code;
-  Http2ClientSession *ua_session   = nullptr;
-  HpackHandle *local_hpack_handle  = nullptr;
-  HpackHandle *remote_hpack_handle = nullptr;
-  DependencyTree *dependency_tree  = nullptr;
+  Http2ClientSession *ua_session      = nullptr;
+  HpackHandle *local_hpack_handle     = nullptr;
+  HpackHandle *remote_hpack_handle    = nullptr;
+  DependencyTree *dependency_tree     = nullptr;
+  UrgencyScheduler *urgency_scheduler = nullptr;
   ActivityCop<Http2Stream> _cop;
 
   // Settings.
@@ -142,6 +143,9 @@ public:
     if (Http2::stream_priority_enabled) {
       dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in);
     }
+    if (Http2::extensible_priorities_enabled) {
+      urgency_scheduler = new UrgencyScheduler();
+    }
 
     _cop = ActivityCop<Http2Stream>(this->mutex, &stream_list, 1);
     _cop.start();
@@ -168,9 +172,16 @@ public:
     local_hpack_handle = nullptr;
     delete remote_hpack_handle;
     remote_hpack_handle = nullptr;
+    if (_stream_hdr_heap) {
+      ink_assert(_stream_hdr_heap_users == 0);
+      _stream_hdr_heap->destroy();
+      _stream_hdr_heap = nullptr;
+    }
     delete dependency_tree;
-    dependency_tree  = nullptr;
-    this->ua_session = nullptr;
+    dependency_tree = nullptr;
+    delete urgency_scheduler;
+    urgency_scheduler = nullptr;
+    this->ua_session  = nullptr;
 
     if (fini_event) {
       fini_event->cancel();
@@ -267,6 +278,14 @@ public:
     return shutdown_reason;
   }
 
+  // Stream scheduling
+  void select_priority_scheduler();
+  bool
+  is_priority_scheduling() const
+  {
+    return dependency_tree != nullptr || urgency_scheduler != nullptr;
+  }
+
   // HTTP/2 frame sender
   void schedule_stream(Http2Stream *stream);
   void send_data_frames_depends_on_priority();
@@ -344,6 +363,8 @@ public:
   uint32_t get_received_ping_frame_count();
   void increment_received_priority_frame_count();
   uint32_t get_received_priority_frame_count();
+  void add_session_cost(uint32_t cost);
+  ink_hrtime get_session_throttle_time();
 
   ssize_t client_rwnd() const;
   Http2ErrorCode increment_client_rwnd(size_t amount);
@@ -354,6 +375,11 @@ public:
 
 private:
   unsigned _adjust_concurrent_stream();
+  void _send_data_frames_depends_on_urgency();
+  uint32_t _tune_rwnd(uint32_t rwnd, uint32_t ceiling, ink_hrtime &last_update);
+  ink_hrtime _peer_rtt();
+  HdrHeap *_acquire_stream_hdr_heap();
+  void _release_stream_hdr_heap();
 
   // NOTE: 'stream_list' has only active streams.
   //   If given Stream Identifier is not found in stream_list and it is less
@@ -378,10 +404,21 @@ private:
   // Counter for stream errors ATS sent
   uint32_t stream_error_count = 0;
 
+  // Header heap shared by the request headers of the session's streams, destroyed in one go when the last of them is
+  // deleted
+  HdrHeap *_stream_hdr_heap       = nullptr;
+  uint32_t _stream_hdr_heap_users = 0;
+
   // Connection level window size
   ssize_t _client_rwnd = HTTP2_INITIAL_WINDOW_SIZE;
   ssize_t _server_rwnd = 0;
 
+  // Receive windows grown by auto-tuning, 0 until the first growth. The stream target is shared by all streams of the
+  // session since they share the path to the client.
+  uint32_t _connection_rwnd_target          = 0;
+  uint32_t _stream_rwnd_target              = 0;
+  ink_hrtime _connection_window_update_time = 0;
+
   std::vector<size_t> _recent_rwnd_increment = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};
   int _recent_rwnd_increment_index           = 0;
 
@@ -389,6 +426,7 @@ private:
   Http2FrequencyCounter _received_settings_frame_counter;
   Http2FrequencyCounter _received_ping_frame_counter;
   Http2FrequencyCounter _received_priority_frame_counter;
+  Http2CostCounter _session_cost;
 
   // NOTE: Id of stream which MUST receive CONTINUATION frame.
   //   - [RFC 7540] 6.2 HEADERS
@@ -399,6 +437,7 @@ private:
   //     another CONTINUATION frame."
   Http2StreamId continued_stream_id = 0;
   bool _scheduled                   = false;
+  bool _priority_scheduler_selected = false;
   bool fini_received                = false;
   bool in_destroy                   = false;
   int recursion                     = 0;
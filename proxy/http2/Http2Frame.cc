@@ -23,6 +23,10 @@
 
 #include "Http2Frame.h"
 
+// DATA payloads of at least this size are added to the write buffer by reference to the response blocks. Smaller
+// ones are copied so that runs of small frames stay coalesced in a single block instead of a chain of tiny clones.
+static constexpr uint32_t HTTP2_DATA_FRAME_CLONE_THRESHOLD = 4096;
+
 //
 // Http2Frame
 //
@@ -50,13 +54,26 @@ Http2Frame::is_from_early_data() const
 int64_t
 Http2DataFrame::write_to(MIOBuffer *iobuffer) const
 {
+  const bool by_reference = this->_reader && this->_payload_len >= HTTP2_DATA_FRAME_CLONE_THRESHOLD;
+
   // Write frame header
   uint8_t buf[HTTP2_FRAME_HEADER_LEN];
   http2_write_frame_header(this->_hdr, make_iovec(buf));
+  // The tail of the buffer is a cloned block after a by-reference payload. Give the header a small block of its own rather
+  // than letting write() add a full size block for nine bytes.
+  if (by_reference && iobuffer->block_write_avail() < static_cast<int64_t>(sizeof(buf))) {
+    IOBufferBlock *block = new_IOBufferBlock();
+    block->alloc(BUFFER_SIZE_INDEX_128);
+    iobuffer->append_block(block);
+  }
   int64_t len = iobuffer->write(buf, sizeof(buf));
 
   // Write frame payload
-  if (this->_reader && this->_payload_len > 0) {
+  if (by_reference) {
+    int64_t written = iobuffer->write(this->_reader, this->_payload_len);
+    this->_reader->consume(written);
+    len += written;
+  } else if (this->_reader && this->_payload_len > 0) {
     int64_t written = 0;
     // Fill current IOBufferBlock as much as possible to reduce SSL_write() calls
     while (written < this->_payload_len) {
@@ -59,3 +59,57 @@ Http2FrequencyCounter::_get_hrtime()
 {
   return ink_hrtime_to_sec(Thread::get_hrtime());
 }
+
+//
+// Http2CostCounter
+//
+void
+Http2CostCounter::set_drain_rate(uint32_t rate)
+{
+  this->_drain();
+  this->_rate = rate;
+}
+
+void
+Http2CostCounter::add(uint32_t cost)
+{
+  this->_drain();
+  this->_cost += cost;
+}
+
+uint64_t
+Http2CostCounter::get_cost()
+{
+  this->_drain();
+  return this->_cost;
+}
+
+ink_hrtime
+Http2CostCounter::time_until(uint64_t limit)
+{
+  this->_drain();
+  if (this->_cost <= limit || this->_rate == 0) {
+    return 0;
+  }
+  return static_cast<ink_hrtime>(HRTIME_SECOND * (this->_cost - limit) / this->_rate);
+}
+
+void
+Http2CostCounter::_drain()
+{
+  ink_hrtime now = this->_get_hrtime();
+
+  if (this->_cost > 0 && now > this->_last_update) {
+    this->_cost -= static_cast<double>(now - this->_last_update) * this->_rate / HRTIME_SECOND;
+    if (this->_cost < 0) {
+      this->_cost = 0;
+    }
+  }
+  this->_last_update = now;
+}
+
+ink_hrtime
+Http2CostCounter::_get_hrtime()
+{
+  return Thread::get_hrtime();
+}
@@ -40,3 +40,27 @@ protected:
 private:
   virtual ink_hrtime _get_hrtime();
 };
+
+/**
+ * Leaky bucket for the work a peer makes a session do. Costs are added as the work is done, and
+ * the accumulated cost drains at a fixed rate per second.
+ */
+class Http2CostCounter
+{
+public:
+  void set_drain_rate(uint32_t rate);
+  void add(uint32_t cost);
+  uint64_t get_cost();
+  /// Time until the accumulated cost drains to @a limit, 0 if it is already within it.
+  ink_hrtime time_until(uint64_t limit);
+  virtual ~Http2CostCounter() {}
+
+protected:
+  double _cost            = 0;
+  uint32_t _rate          = 0;
+  ink_hrtime _last_update = 0;
+
+private:
+  void _drain();
+  virtual ink_hrtime _get_hrtime();
+};
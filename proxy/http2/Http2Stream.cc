@@ -45,7 +45,7 @@ Http2Stream::Http2Stream(Http2StreamId sid, ssize_t initial_rwnd) : _id(sid), _c
 }
 
 void
-Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd)
+Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd, HdrHeap *req_hdr_heap)
 {
   this->mark_milestone(Http2StreamMilestone::OPEN);
 
@@ -57,7 +57,8 @@ Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd)
 
   this->_reader = this->_request_buffer.alloc_reader();
 
-  _req_header.create(HTTP_TYPE_REQUEST);
+  _req_header.create(HTTP_TYPE_REQUEST, req_hdr_heap);
+  _req_header_shared = req_hdr_heap != nullptr;
   response_header.create(HTTP_TYPE_RESPONSE);
   // TODO: init _req_header instead of response_header if this Http2Stream is outgoing
   http2_init_pseudo_headers(response_header);
@@ -148,8 +149,15 @@ Http2Stream::main_event_handler(int event, void *edata)
 Http2ErrorCode
 Http2Stream::decode_header_blocks(HpackHandle &hpack_handle, uint32_t maximum_table_size)
 {
-  return http2_decode_header_blocks(&_req_header, (const uint8_t *)header_blocks, header_blocks_length, nullptr, hpack_handle,
-                                    trailing_header, maximum_table_size);
+  Http2ErrorCode result = http2_decode_header_blocks(&_req_header, (const uint8_t *)header_blocks, header_blocks_length, nullptr,
+                                                     hpack_handle, trailing_header, maximum_table_size);
+
+  // The encoded blocks are not needed once decoded, and a trailing HEADERS frame allocates its own
+  ats_free(header_blocks);
+  header_blocks        = nullptr;
+  header_blocks_length = 0;
+
+  return result;
 }
 
 void
@@ -711,7 +719,7 @@ Http2Stream::send_response_body(bool call_update)
   Http2ClientSession *h2_proxy_ssn = static_cast<Http2ClientSession *>(this->_proxy_ssn);
   _timeout.update_inactivity();
 
-  if (Http2::stream_priority_enabled) {
+  if (h2_proxy_ssn->connection_state.is_priority_scheduling()) {
     SCOPED_MUTEX_LOCK(lock, h2_proxy_ssn->connection_state.mutex, this_ethread());
     h2_proxy_ssn->connection_state.schedule_stream(this);
     // signal_write_event() will be called from `Http2ConnectionState::send_data_frames_depends_on_priority()`
@@ -813,9 +821,8 @@ Http2Stream::destroy()
   read_vio.mutex.clear();
   write_vio.mutex.clear();
 
-  if (header_blocks) {
-    ats_free(header_blocks);
-  }
+  ats_free(header_blocks);
+  header_blocks = nullptr;
   _clear_timers();
   clear_io_events();
   http_parser_clear(&http_parser);
@@ -29,6 +29,7 @@
 #include "ProxyTransaction.h"
 #include "Http2DebugNames.h"
 #include "Http2DependencyTree.h"
+#include "Http2UrgencyScheduler.h"
 #include "tscore/History.h"
 #include "Milestones.h"
 
@@ -36,6 +37,7 @@ class Http2Stream;
 class Http2ConnectionState;
 
 typedef Http2DependencyTree::Tree<Http2Stream *> DependencyTree;
+typedef Http2UrgencyScheduler::Scheduler<Http2Stream *> UrgencyScheduler;
 
 enum class Http2StreamMilestone {
   OPEN = 0,
@@ -56,7 +58,7 @@ public:
 
   Http2Stream(Http2StreamId sid = 0, ssize_t initial_rwnd = Http2::initial_window_size);
 
-  void init(Http2StreamId sid, ssize_t initial_rwnd);
+  void init(Http2StreamId sid, ssize_t initial_rwnd, HdrHeap *req_hdr_heap = nullptr);
 
   int main_event_handler(int event, void *edata);
 
@@ -127,6 +129,8 @@ public:
   void update_initial_rwnd(Http2WindowSize new_size);
   bool has_trailing_header() const;
   void set_request_headers(HTTPHdr &h2_headers);
+  const HTTPHdr *get_request_headers() const;
+  bool detach_shared_request_headers();
   MIOBuffer *read_vio_writer() const;
   int64_t read_vio_read_avail();
 
@@ -144,7 +148,9 @@ public:
   bool is_first_transaction_flag = false;
 
   HTTPHdr response_header;
-  Http2DependencyTree::Node *priority_node = nullptr;
+  ink_hrtime window_update_time             = 0;
+  Http2DependencyTree::Node *priority_node  = nullptr;
+  Http2UrgencyScheduler::Node *urgency_node = nullptr;
 
 private:
   bool response_is_data_available() const;
@@ -167,6 +173,7 @@ private:
   int64_t _http_sm_id     = -1;
 
   HTTPHdr _req_header;
+  bool _req_header_shared = false; ///< _req_header lives in the session's header heap
   MIOBuffer _request_buffer = CLIENT_CONNECTION_FIRST_READ_BUFFER_SIZE_INDEX;
   int64_t read_vio_nbytes;
   VIO read_vio;
@@ -278,6 +285,26 @@ Http2Stream::set_request_headers(HTTPHdr &h2_headers)
   _req_header.copy(&h2_headers);
 }
 
+inline const HTTPHdr *
+Http2Stream::get_request_headers() const
+{
+  return &_req_header;
+}
+
+// Drop the request headers held in the session's header heap, which the session releases.
+// Returns whether the headers were shared.
+inline bool
+Http2Stream::detach_shared_request_headers()
+{
+  if (!_req_header_shared) {
+    return false;
+  }
+
+  _req_header.reset();
+  _req_header_shared = false;
+  return true;
+}
+
 // Check entire DATA payload length if content-length: header is exist
 inline void
 Http2Stream::increment_data_length(uint64_t length)
@@ -0,0 +1,212 @@
+/** @file
+
+  HTTP/2 Urgency Scheduler
+
+  Stream scheduler for the Extensible Prioritization Scheme (RFC 9218). Streams are kept in
+  one round-robin queue per urgency level and a bitmask of non-empty levels, so selecting the
+  next stream is a single bit scan instead of a walk over the dependency tree.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/List.h"
+#include "tscore/ink_assert.h"
+
+#include "HTTP2.h"
+
+namespace Http2UrgencyScheduler
+{
+class Node
+{
+public:
+  Node(uint32_t i, uint8_t u, bool inc, void *t = nullptr) : id(i), urgency(u), incremental(inc), t(t) {}
+
+  Node(const Node &) = delete;
+  Node &operator=(const Node &) = delete;
+
+  LINK(Node, link);
+
+  bool active      = false;
+  uint32_t id      = 0;
+  uint8_t urgency  = HTTP2_PRIORITY_DEFAULT_URGENCY;
+  bool incremental = false;
+  void *t          = nullptr;
+};
+
+/**
+ * Every node is in exactly one queue: the queue of its urgency level while it is active, the idle
+ * queue otherwise. Within a level nodes are served in activation order; a non-incremental node
+ * keeps the head of its level until it is deactivated, an incremental one moves to the tail
+ * after each frame so that incremental streams of the same urgency share the bandwidth.
+ */
+template <typename T> class Scheduler
+{
+public:
+  Scheduler() = default;
+  ~Scheduler();
+
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  Node *add(uint32_t id, uint8_t urgency, bool incremental, T t);
+  void reprioritize(Node *node, uint8_t urgency, bool incremental);
+  Node *top();
+  void remove(Node *node);
+  void activate(Node *node);
+  void deactivate(Node *node);
+  void update(Node *node);
+  uint32_t size() const;
+
+private:
+  Queue<Node> &_queue_of(Node *node);
+
+  Queue<Node> _levels[HTTP2_PRIORITY_URGENCY_LEVELS];
+  Queue<Node> _idle;
+  uint32_t _active_levels = 0;
+  uint32_t _node_count    = 0;
+};
+
+template <typename T> Scheduler<T>::~Scheduler()
+{
+  for (Queue<Node> &queue : _levels) {
+    while (Node *node = queue.pop()) {
+      delete node;
+    }
+  }
+  while (Node *node = _idle.pop()) {
+    delete node;
+  }
+}
+
+template <typename T>
+Queue<Node> &
+Scheduler<T>::_queue_of(Node *node)
+{
+  return node->active ? _levels[node->urgency] : _idle;
+}
+
+template <typename T>
+Node *
+Scheduler<T>::add(uint32_t id, uint8_t urgency, bool incremental, T t)
+{
+  ink_assert(urgency < HTTP2_PRIORITY_URGENCY_LEVELS);
+
+  Node *node = new Node(id, urgency, incremental, t);
+  _idle.enqueue(node);
+  ++_node_count;
+
+  return node;
+}
+
+template <typename T>
+void
+Scheduler<T>::reprioritize(Node *node, uint8_t urgency, bool incremental)
+{
+  ink_assert(urgency < HTTP2_PRIORITY_URGENCY_LEVELS);
+
+  if (node->active && node->urgency != urgency) {
+    deactivate(node);
+    node->urgency = urgency;
+    activate(node);
+  } else {
+    node->urgency = urgency;
+  }
+  node->incremental = incremental;
+}
+
+template <typename T>
+Node *
+Scheduler<T>::top()
+{
+  if (_active_levels == 0) {
+    return nullptr;
+  }
+
+  // Lower urgency values are more urgent
+  return _levels[__builtin_ctz(_active_levels)].head;
+}
+
+template <typename T>
+void
+Scheduler<T>::remove(Node *node)
+{
+  _queue_of(node).remove(node);
+  if (node->active && _levels[node->urgency].empty()) {
+    _active_levels &= ~(1U << node->urgency);
+  }
+
+  --_node_count;
+  delete node;
+}
+
+template <typename T>
+void
+Scheduler<T>::activate(Node *node)
+{
+  if (node->active) {
+    return;
+  }
+
+  _idle.remove(node);
+  node->active = true;
+  _levels[node->urgency].enqueue(node);
+  _active_levels |= 1U << node->urgency;
+}
+
+template <typename T>
+void
+Scheduler<T>::deactivate(Node *node)
+{
+  if (!node->active) {
+    return;
+  }
+
+  Queue<Node> &queue = _levels[node->urgency];
+  queue.remove(node);
+  if (queue.empty()) {
+    _active_levels &= ~(1U << node->urgency);
+  }
+  node->active = false;
+  _idle.enqueue(node);
+}
+
+template <typename T>
+void
+Scheduler<T>::update(Node *node)
+{
+  if (!node->active || !node->incremental) {
+    return;
+  }
+
+  Queue<Node> &queue = _levels[node->urgency];
+  if (queue.tail != node) {
+    queue.remove(node);
+    queue.enqueue(node);
+  }
+}
+
+template <typename T>
+uint32_t
+Scheduler<T>::size() const
+{
+  return _node_count;
+}
+} // namespace Http2UrgencyScheduler
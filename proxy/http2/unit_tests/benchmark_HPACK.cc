@@ -0,0 +1,91 @@
+/** @file
+
+    Catch-based benchmarks for HPACK header block coding
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string_view>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "HPACK.h"
+
+#include "unit_tests/benchmark_corpus.h"
+
+static constexpr int BUFSIZE_FOR_BENCHMARK = 16384;
+static constexpr int MAX_HEADER_SIZE       = 131072;
+static constexpr int MAX_TABLE_SIZE        = 4096;
+
+// Every run codes the whole corpus on one connection, so the dynamic table fills as it would
+// over a session instead of starting out empty for each header block.
+TEST_CASE("HpackBenchmark", "[hpack][benchmark]")
+{
+  std::vector<HTTPHdr> headers(std::size(benchmark_corpus::responses));
+  for (size_t i = 0; i < headers.size(); ++i) {
+    HTTPParser parser;
+    const char *start = benchmark_corpus::responses[i].data();
+    const char *end   = start + benchmark_corpus::responses[i].size();
+
+    http_parser_init(&parser);
+    headers[i].create(HTTP_TYPE_RESPONSE);
+    REQUIRE(headers[i].parse_resp(&parser, &start, end, true) == PARSE_RESULT_DONE);
+    http_parser_clear(&parser);
+  }
+
+  std::vector<std::vector<uint8_t>> blocks;
+  {
+    HpackIndexingTable indexing_table(MAX_TABLE_SIZE);
+    uint8_t buf[BUFSIZE_FOR_BENCHMARK];
+    for (HTTPHdr &hdr : headers) {
+      int64_t len = hpack_encode_header_block(indexing_table, buf, sizeof(buf), &hdr);
+      REQUIRE(len > 0);
+      blocks.emplace_back(buf, buf + len);
+    }
+  }
+
+  BENCHMARK("hpack_encode_header_block")
+  {
+    HpackIndexingTable indexing_table(MAX_TABLE_SIZE);
+    uint8_t buf[BUFSIZE_FOR_BENCHMARK];
+    int64_t total = 0;
+    for (HTTPHdr &hdr : headers) {
+      total += hpack_encode_header_block(indexing_table, buf, sizeof(buf), &hdr);
+    }
+    return total;
+  };
+
+  BENCHMARK("hpack_decode_header_block")
+  {
+    HpackIndexingTable indexing_table(MAX_TABLE_SIZE);
+    int64_t total = 0;
+    for (std::vector<uint8_t> const &block : blocks) {
+      HTTPHdr hdr;
+      hdr.create(HTTP_TYPE_RESPONSE);
+      total += hpack_decode_header_block(indexing_table, &hdr, block.data(), block.size(), MAX_HEADER_SIZE, MAX_TABLE_SIZE);
+      hdr.destroy();
+    }
+    return total;
+  };
+
+  for (HTTPHdr &hdr : headers) {
+    hdr.destroy();
+  }
+}
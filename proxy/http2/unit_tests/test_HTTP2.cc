@@ -23,6 +23,8 @@
 
 #include "catch.hpp"
 
+#include <cstring>
+
 #include "HTTP2.h"
 
 #include "tscpp/util/PostScript.h"
@@ -167,3 +169,42 @@ TEST_CASE("Convert HTTPHdr", "[HTTP2]")
     CHECK_THAT(buf, Catch::StartsWith("HTTP/1.1 200 OK\r\n\r\n"));
   }
 }
+
+TEST_CASE("Parse priority field", "[HTTP2]")
+{
+  auto parse = [](const char *value, uint8_t &urgency, bool &incremental) {
+    urgency     = HTTP2_PRIORITY_DEFAULT_URGENCY;
+    incremental = false;
+    return http2_parse_priority_field(value, strlen(value), urgency, incremental);
+  };
+  uint8_t urgency;
+  bool incremental;
+
+  SECTION("urgency and incremental")
+  {
+    REQUIRE(parse("u=1, i", urgency, incremental));
+    CHECK(urgency == 1);
+    CHECK(incremental == true);
+
+    REQUIRE(parse("i=?1,u=7", urgency, incremental));
+    CHECK(urgency == 7);
+    CHECK(incremental == true);
+
+    REQUIRE(parse("u=0, i=?0", urgency, incremental));
+    CHECK(urgency == 0);
+    CHECK(incremental == false);
+  }
+
+  SECTION("unknown and invalid members are ignored")
+  {
+    REQUIRE(parse("x=5, u=2;p=1, urgent", urgency, incremental));
+    CHECK(urgency == 2);
+    CHECK(incremental == false);
+
+    CHECK_FALSE(parse("u=8", urgency, incremental));
+    CHECK_FALSE(parse("u=10, i=?2", urgency, incremental));
+    CHECK_FALSE(parse("", urgency, incremental));
+    CHECK(urgency == HTTP2_PRIORITY_DEFAULT_URGENCY);
+    CHECK(incremental == false);
+  }
+}
@@ -537,3 +537,54 @@ TEST_CASE("HPACK high level APIs", "[hpack]")
     }
   }
 }
+
+TEST_CASE("HPACK dynamic table lookup", "[hpack]")
+{
+  // The table fits two entries of "x-name: <20 bytes>" (32 + 6 + 20 = 58) at a time
+  HpackIndexingTable indexing_table(120);
+  const uint32_t first = 62; // The first index of the dynamic table
+
+  indexing_table.add_header_field({"x-name", "aaaaaaaaaaaaaaaaaaaa"});
+  indexing_table.add_header_field({"x-name", "bbbbbbbbbbbbbbbbbbbb"});
+  REQUIRE(indexing_table.size() == 116);
+
+  // Both entries have the name, the newest one has the smallest index
+  HpackLookupResult result = indexing_table.lookup({"x-name", "aaaaaaaaaaaaaaaaaaaa"});
+  CHECK(result.match_type == HpackMatch::EXACT);
+  CHECK(result.index == first + 1);
+  result = indexing_table.lookup({"X-Name", "bbbbbbbbbbbbbbbbbbbb"});
+  CHECK(result.match_type == HpackMatch::EXACT);
+  CHECK(result.index == first);
+  result = indexing_table.lookup({"x-name", "cccccccccccccccccccc"});
+  CHECK(result.match_type == HpackMatch::NAME);
+  CHECK(result.index == first);
+
+  // Adding an entry evicts the oldest one
+  indexing_table.add_header_field({"x-name", "cccccccccccccccccccc"});
+  REQUIRE(indexing_table.size() == 116);
+  result = indexing_table.lookup({"x-name", "aaaaaaaaaaaaaaaaaaaa"});
+  CHECK(result.match_type == HpackMatch::NAME);
+  CHECK(result.index == first);
+  result = indexing_table.lookup({"x-name", "bbbbbbbbbbbbbbbbbbbb"});
+  CHECK(result.match_type == HpackMatch::EXACT);
+  CHECK(result.index == first + 1);
+
+  ats_scoped_obj<HTTPHdr> headers(new HTTPHdr);
+  headers->create(HTTP_TYPE_REQUEST);
+  MIMEField *field = mime_field_create(headers->m_heap, headers->m_http->m_fields_impl);
+  MIMEFieldWrapper header(field, headers->m_heap, headers->m_http->m_fields_impl);
+  REQUIRE(indexing_table.get_header_field(first + 1, header) == 0);
+  int value_len;
+  CHECK(std::string_view(header.value_get(&value_len), 20) == "bbbbbbbbbbbbbbbbbbbb");
+  CHECK(indexing_table.get_header_field(first + 2, header) == HPACK_ERROR_COMPRESSION_ERROR);
+
+  // Names no longer in the table aren't found
+  indexing_table.add_header_field({"x-other", "dddddddddddddddddddd"});
+  indexing_table.add_header_field({"x-other", "eeeeeeeeeeeeeeeeeeee"});
+  CHECK(indexing_table.lookup({"x-name", "cccccccccccccccccccc"}).match_type == HpackMatch::NONE);
+
+  // An entry larger than the table empties it
+  indexing_table.add_header_field({"x-other", std::string(200, 'f')});
+  CHECK(indexing_table.size() == 0);
+  CHECK(indexing_table.lookup({"x-other", "eeeeeeeeeeeeeeeeeeee"}).match_type == HpackMatch::NONE);
+}
@@ -23,6 +23,8 @@
 
 #include "catch.hpp"
 
+#include <string>
+
 #include "Http2Frame.h"
 
 TEST_CASE("Http2Frame", "[http2][Http2Frame]")
@@ -60,6 +62,44 @@ TEST_CASE("Http2Frame", "[http2][Http2Frame]")
     CHECK(memcmp(buf, expected, written) == 0);
   }
 
+  SECTION("DATA")
+  {
+    MIOBuffer *payload        = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+    IOBufferReader *payload_r = payload->alloc_reader();
+
+    // Below the clone threshold the payload is copied, above it the payload blocks are shared
+    uint32_t payload_len = GENERATE(as<uint32_t>{}, 100, 16384);
+    std::string body(payload_len * 2, 'a');
+    for (size_t i = 0; i < body.size(); ++i) {
+      body[i] = 'a' + i % 26;
+    }
+    payload->write(body.data(), body.size());
+
+    for (int i = 0; i < 2; ++i) {
+      uint8_t flags = i == 1 ? HTTP2_FLAGS_DATA_END_STREAM : 0;
+      Http2DataFrame frame(1, flags, payload_r, payload_len);
+      int64_t written = frame.write_to(miob);
+      CHECK(written == HTTP2_FRAME_HEADER_LEN + payload_len);
+    }
+    CHECK(payload_r->read_avail() == 0);
+
+    // The response buffer may be reused once consumed; the frames must not change with it
+    free_MIOBuffer(payload);
+
+    REQUIRE(miob_r->read_avail() == 2 * (HTTP2_FRAME_HEADER_LEN + payload_len));
+    for (int i = 0; i < 2; ++i) {
+      uint8_t hdr[HTTP2_FRAME_HEADER_LEN];
+      miob_r->read(hdr, sizeof(hdr));
+      CHECK(((hdr[0] << 16) | (hdr[1] << 8) | hdr[2]) == payload_len);
+      CHECK(hdr[3] == HTTP2_FRAME_TYPE_DATA);
+      CHECK(hdr[4] == (i == 1 ? HTTP2_FLAGS_DATA_END_STREAM : 0));
+
+      std::string data(payload_len, '\0');
+      miob_r->read(data.data(), payload_len);
+      CHECK(data == body.substr(i * payload_len, payload_len));
+    }
+  }
+
   free_MIOBuffer(miob);
 }
 
@@ -219,3 +219,66 @@ TEST_CASE("Http2FrequencyCounter_basic", "[http2][Http2FrequencyCounter]")
     CHECK(counter.get_count() == 1);
   }
 }
+
+class TestHttp2CostCounter : public Http2CostCounter
+{
+public:
+  void
+  set_now(ink_hrtime now)
+  {
+    this->_now = now;
+  }
+
+private:
+  ink_hrtime
+  _get_hrtime() override
+  {
+    return this->_now;
+  }
+
+  ink_hrtime _now = 0;
+};
+
+TEST_CASE("Http2CostCounter_basic", "[http2][Http2CostCounter]")
+{
+  TestHttp2CostCounter counter;
+  counter.set_now(HRTIME_SECONDS(100));
+  counter.set_drain_rate(1000);
+
+  SECTION("basic")
+  {
+    REQUIRE(counter.get_cost() == 0);
+    counter.add(100);
+    REQUIRE(counter.get_cost() == 100);
+    counter.add(200);
+    REQUIRE(counter.get_cost() == 300);
+  }
+
+  SECTION("drain")
+  {
+    counter.add(3000);
+
+    counter.set_now(HRTIME_SECONDS(100) + HRTIME_MSECONDS(500));
+    CHECK(counter.get_cost() == 2500);
+
+    counter.set_now(HRTIME_SECONDS(102));
+    CHECK(counter.get_cost() == 1500);
+
+    counter.set_now(HRTIME_SECONDS(110));
+    CHECK(counter.get_cost() == 0);
+
+    counter.add(10);
+    CHECK(counter.get_cost() == 10);
+  }
+
+  SECTION("time_until")
+  {
+    counter.add(3000);
+    CHECK(counter.time_until(5000) == 0);
+    CHECK(counter.time_until(2000) == HRTIME_SECONDS(1));
+    CHECK(counter.time_until(1500) == HRTIME_MSECONDS(1500));
+
+    counter.set_now(HRTIME_SECONDS(101));
+    CHECK(counter.time_until(2000) == 0);
+  }
+}
@@ -0,0 +1,135 @@
+/** @file
+
+    Unit tests for Http2UrgencyScheduler
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <string>
+
+#include "Http2UrgencyScheduler.h"
+
+using namespace std;
+
+using Scheduler = Http2UrgencyScheduler::Scheduler<string *>;
+using Node      = Http2UrgencyScheduler::Node;
+
+static string
+send_order(Scheduler &scheduler, int n)
+{
+  string order;
+  for (int i = 0; i < n; ++i) {
+    Node *node = scheduler.top();
+    if (node == nullptr) {
+      break;
+    }
+    order += *static_cast<string *>(node->t);
+    scheduler.update(node);
+  }
+  return order;
+}
+
+TEST_CASE("Http2UrgencyScheduler urgency", "[http2][Http2UrgencyScheduler]")
+{
+  Scheduler scheduler;
+  string a("A"), b("B"), c("C");
+
+  Node *node_a = scheduler.add(1, 5, false, &a);
+  Node *node_b = scheduler.add(3, 1, false, &b);
+  Node *node_c = scheduler.add(5, 3, false, &c);
+
+  REQUIRE(scheduler.size() == 3);
+  REQUIRE(scheduler.top() == nullptr);
+
+  scheduler.activate(node_a);
+  scheduler.activate(node_c);
+  REQUIRE(scheduler.top() == node_c);
+
+  scheduler.activate(node_b);
+  REQUIRE(scheduler.top() == node_b);
+
+  scheduler.deactivate(node_b);
+  REQUIRE(scheduler.top() == node_c);
+
+  scheduler.remove(node_c);
+  REQUIRE(scheduler.top() == node_a);
+  REQUIRE(scheduler.size() == 2);
+
+  scheduler.deactivate(node_a);
+  REQUIRE(scheduler.top() == nullptr);
+}
+
+TEST_CASE("Http2UrgencyScheduler incremental", "[http2][Http2UrgencyScheduler]")
+{
+  Scheduler scheduler;
+  string a("A"), b("B"), c("C"), d("D");
+
+  SECTION("non-incremental streams are sent one after another")
+  {
+    Node *node_a = scheduler.add(1, 3, false, &a);
+    Node *node_b = scheduler.add(3, 3, false, &b);
+    scheduler.activate(node_a);
+    scheduler.activate(node_b);
+
+    REQUIRE(send_order(scheduler, 3) == "AAA");
+    scheduler.deactivate(node_a);
+    REQUIRE(send_order(scheduler, 3) == "BBB");
+  }
+
+  SECTION("incremental streams are interleaved")
+  {
+    Node *node_a = scheduler.add(1, 3, true, &a);
+    Node *node_b = scheduler.add(3, 3, true, &b);
+    Node *node_c = scheduler.add(5, 3, true, &c);
+    Node *node_d = scheduler.add(7, 4, true, &d);
+    scheduler.activate(node_a);
+    scheduler.activate(node_b);
+    scheduler.activate(node_c);
+    scheduler.activate(node_d);
+
+    REQUIRE(send_order(scheduler, 6) == "ABCABC");
+    scheduler.remove(node_b);
+    REQUIRE(send_order(scheduler, 4) == "ACAC");
+  }
+}
+
+TEST_CASE("Http2UrgencyScheduler reprioritize", "[http2][Http2UrgencyScheduler]")
+{
+  Scheduler scheduler;
+  string a("A"), b("B");
+
+  Node *node_a = scheduler.add(1, HTTP2_PRIORITY_DEFAULT_URGENCY, false, &a);
+  Node *node_b = scheduler.add(3, HTTP2_PRIORITY_DEFAULT_URGENCY, false, &b);
+
+  // Inactive node keeps the new priority for its next activation
+  scheduler.reprioritize(node_b, 0, false);
+  scheduler.activate(node_a);
+  scheduler.activate(node_b);
+  REQUIRE(scheduler.top() == node_b);
+
+  // Active node moves to the queue of its new urgency
+  scheduler.reprioritize(node_a, 0, true);
+  scheduler.reprioritize(node_b, 7, false);
+  REQUIRE(scheduler.top() == node_a);
+
+  scheduler.remove(node_a);
+  REQUIRE(scheduler.top() == node_b);
+}
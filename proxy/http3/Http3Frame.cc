@@ -107,6 +107,18 @@ Http3Frame::store(uint8_t *buf, size_t *len) const
   ink_assert(!"Not supported");
 }
 
+Ptr<IOBufferBlock>
+Http3Frame::to_io_buffer_block() const
+{
+  size_t len               = 0;
+  Ptr<IOBufferBlock> block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+  block->alloc(iobuffer_size_to_index(MAX_FRAM_HEADER_OVERHEAD + this->_length, BUFFER_SIZE_INDEX_32K));
+  this->store(reinterpret_cast<uint8_t *>(block->start()), &len);
+  block->fill(len);
+
+  return block;
+}
+
 void
 Http3Frame::reset(const uint8_t *buf, size_t len)
 {
@@ -142,8 +154,42 @@ Http3DataFrame::Http3DataFrame(ats_unique_buf payload, size_t payload_len)
   this->_payload = this->_payload_uptr.get();
 }
 
-void
-Http3DataFrame::store(uint8_t *buf, size_t *len) const
+Http3DataFrame::Http3DataFrame(IOBufferReader *reader, size_t payload_len)
+  : Http3Frame(Http3FrameType::DATA), _payload_len(payload_len)
+{
+  this->_length = this->_payload_len;
+
+  IOBufferBlock *tail   = nullptr;
+  IOBufferBlock *block  = reader->get_current_block();
+  int64_t offset        = reader->start_offset;
+  int64_t remaining_len = payload_len;
+
+  while (remaining_len > 0 && block) {
+    if (block->read_avail() > offset) {
+      IOBufferBlock *clone = block->clone();
+      clone->consume(offset);
+      if (clone->read_avail() > remaining_len) {
+        clone->_end = clone->_start + remaining_len;
+      }
+      remaining_len -= clone->read_avail();
+
+      if (tail) {
+        tail->next = clone;
+      } else {
+        this->_payload_block = clone;
+      }
+      tail = clone;
+    }
+    block  = block->next.get();
+    offset = 0;
+  }
+
+  ink_assert(remaining_len == 0);
+  reader->consume(payload_len);
+}
+
+size_t
+Http3DataFrame::_store_header(uint8_t *buf) const
 {
   size_t written = 0;
   size_t n;
@@ -151,11 +197,41 @@ Http3DataFrame::store(uint8_t *buf, size_t *len) const
   written += n;
   QUICVariableInt::encode(buf + written, UINT64_MAX, n, this->_length);
   written += n;
-  memcpy(buf + written, this->_payload, this->_payload_len);
-  written += this->_payload_len;
+  return written;
+}
+
+void
+Http3DataFrame::store(uint8_t *buf, size_t *len) const
+{
+  size_t written = this->_store_header(buf);
+  if (this->_payload_block) {
+    for (IOBufferBlock *b = this->_payload_block.get(); b; b = b->next.get()) {
+      memcpy(buf + written, b->start(), b->read_avail());
+      written += b->read_avail();
+    }
+  } else {
+    memcpy(buf + written, this->_payload, this->_payload_len);
+    written += this->_payload_len;
+  }
   *len = written;
 }
 
+Ptr<IOBufferBlock>
+Http3DataFrame::to_io_buffer_block() const
+{
+  if (!this->_payload_block) {
+    return Http3Frame::to_io_buffer_block();
+  }
+
+  // Only the frame header is written, the payload blocks are chained as they are
+  Ptr<IOBufferBlock> header = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+  header->alloc(BUFFER_SIZE_INDEX_128);
+  header->fill(this->_store_header(reinterpret_cast<uint8_t *>(header->start())));
+  header->next = this->_payload_block;
+
+  return header;
+}
+
 void
 Http3DataFrame::reset(const uint8_t *buf, size_t len)
 {
@@ -466,29 +542,11 @@ Http3FrameFactory::create_data_frame(const uint8_t *payload, size_t payload_len)
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
 
-// TODO: This should clone IOBufferBlock chain to avoid memcpy
 Http3DataFrameUPtr
 Http3FrameFactory::create_data_frame(IOBufferReader *reader, size_t payload_len)
 {
-  ats_unique_buf buf = ats_unique_malloc(payload_len);
-  size_t written     = 0;
-
-  while (written < payload_len) {
-    int64_t len = reader->block_read_avail();
-
-    if (written + len > payload_len) {
-      len = payload_len - written;
-    }
-
-    memcpy(buf.get() + written, reinterpret_cast<uint8_t *>(reader->start()), len);
-    reader->consume(len);
-    written += len;
-  }
-
-  ink_assert(written == payload_len);
-
   Http3DataFrame *frame = http3DataFrameAllocator.alloc();
-  new (frame) Http3DataFrame(std::move(buf), payload_len);
+  new (frame) Http3DataFrame(reader, payload_len);
 
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
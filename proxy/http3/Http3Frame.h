@@ -43,6 +43,7 @@ public:
   uint64_t length() const;
   Http3FrameType type() const;
   virtual void store(uint8_t *buf, size_t *len) const;
+  virtual Ptr<IOBufferBlock> to_io_buffer_block() const;
   virtual void reset(const uint8_t *buf, size_t len);
   static int length(const uint8_t *buf, size_t buf_len, uint64_t &length);
   static Http3FrameType type(const uint8_t *buf, size_t buf_len);
@@ -76,17 +77,26 @@ public:
   Http3DataFrame() : Http3Frame() {}
   Http3DataFrame(const uint8_t *buf, size_t len);
   Http3DataFrame(ats_unique_buf payload, size_t payload_len);
+  /*
+   * Refers payload_len bytes of the blocks of reader instead of copying them, and consumes them from reader.
+   * payload() returns nullptr for such a frame.
+   */
+  Http3DataFrame(IOBufferReader *reader, size_t payload_len);
 
   void store(uint8_t *buf, size_t *len) const override;
+  Ptr<IOBufferBlock> to_io_buffer_block() const override;
   void reset(const uint8_t *buf, size_t len) override;
 
   const uint8_t *payload() const;
   uint64_t payload_length() const;
 
 private:
+  size_t _store_header(uint8_t *buf) const;
+
   const uint8_t *_payload      = nullptr;
   ats_unique_buf _payload_uptr = {nullptr};
-  size_t _payload_len          = 0;
+  Ptr<IOBufferBlock> _payload_block;
+  size_t _payload_len = 0;
 };
 
 //
@@ -29,17 +29,29 @@ Http3ErrorUPtr
 Http3FrameCollector::on_write_ready(QUICStreamIO *stream_io, size_t &nwritten)
 {
   bool all_done = true;
-  uint8_t tmp[32768];
-  nwritten = 0;
+  nwritten      = 0;
+
+  // Frames are chained as blocks so that DATA payload is passed to the stream by reference
+  Ptr<IOBufferBlock> head;
+  IOBufferBlock *tail = nullptr;
 
   for (auto g : this->_generators) {
     if (g->is_done()) {
       continue;
     }
-    size_t len           = 0;
-    Http3FrameUPtr frame = g->generate_frame(sizeof(tmp) - nwritten);
+    Http3FrameUPtr frame = g->generate_frame(MAX_WRITE_SIZE - nwritten);
     if (frame) {
-      frame->store(tmp + nwritten, &len);
+      Ptr<IOBufferBlock> block = frame->to_io_buffer_block();
+      size_t len               = 0;
+      if (tail) {
+        tail->next = block;
+      } else {
+        head = block;
+      }
+      for (tail = block.get(); tail->next; tail = tail->next.get()) {
+        len += tail->read_avail();
+      }
+      len += tail->read_avail();
       nwritten += len;
 
       Debug("http3", "[TX] [%d] | %s size=%zu", stream_io->stream_id(), Http3DebugNames::frame_type(frame->type()), len);
@@ -49,7 +61,7 @@ Http3FrameCollector::on_write_ready(QUICStreamIO *stream_io, size_t &nwritten)
   }
 
   if (nwritten) {
-    int64_t len = stream_io->write(tmp, nwritten);
+    int64_t len = stream_io->write(head.get());
     ink_assert(len > 0 && (uint64_t)len == nwritten);
   }
 
@@ -36,5 +36,7 @@ public:
   void add_generator(Http3FrameGenerator *generator);
 
 private:
+  static constexpr size_t MAX_WRITE_SIZE = 32768;
+
   std::vector<Http3FrameGenerator *> _generators;
 };
@@ -30,6 +30,33 @@
 #define QPACKDebug(fmt, ...) Debug("qpack", "[%s] " fmt, this->_qc->cids().data(), ##__VA_ARGS__)
 #define QPACKDTDebug(fmt, ...) Debug("qpack", "" fmt, ##__VA_ARGS__)
 
+// FNV-1a, as used by the HPACK dynamic table index. Names are lowered before they reach the tables.
+static constexpr uint64_t QPACK_HASH_OFFSET_BASIS = 14695981039346656037ULL;
+static constexpr uint64_t QPACK_HASH_PRIME        = 1099511628211ULL;
+
+// Forget the seen fields once this many are tracked, so that one-off values don't accumulate
+static constexpr size_t QPACK_SEEN_FIELDS_MAX = 512;
+
+static uint64_t
+qpack_hash_name(const char *name, int name_len)
+{
+  uint64_t h = QPACK_HASH_OFFSET_BASIS;
+  for (int i = 0; i < name_len; ++i) {
+    h = (h ^ static_cast<uint8_t>(name[i])) * QPACK_HASH_PRIME;
+  }
+  return h;
+}
+
+static uint64_t
+qpack_hash_field(const char *name, int name_len, const char *value, int value_len)
+{
+  uint64_t h = qpack_hash_name(name, name_len);
+  for (int i = 0; i < value_len; ++i) {
+    h = (h ^ static_cast<uint8_t>(value[i])) * QPACK_HASH_PRIME;
+  }
+  return h;
+}
+
 // qpack-05 Appendix A.
 const QPACK::Header QPACK::StaticTable::STATIC_HEADER_FIELDS[] = {
   {":authority", ""},
@@ -184,6 +211,10 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
 
   uint16_t base_index = this->_largest_known_received_index;
 
+  // Referring an entry the decoder has not acknowledged may block this stream. Only do that while
+  // the number of potentially blocked streams stays under SETTINGS_QPACK_BLOCKED_STREAMS.
+  bool may_block = this->_count_blocking_streams() < this->_max_blocking_streams;
+
   // Compress headers and record the largest reference
   uint16_t referred_index           = 0;
   uint16_t largest_reference        = 0;
@@ -193,7 +224,7 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
 
   MIMEFieldIter field_iter;
   for (MIMEField *field = header_set.iter_get_first(&field_iter); field != nullptr; field = header_set.iter_get_next(&field_iter)) {
-    int ret            = this->_encode_header(*field, base_index, compressed_headers, referred_index);
+    int ret            = this->_encode_header(*field, base_index, may_block, compressed_headers, referred_index);
     largest_reference  = std::max(largest_reference, referred_index);
     smallest_reference = std::min(smallest_reference, referred_index);
     if (ret < 0) {
@@ -317,7 +348,8 @@ QPACK::_encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferB
 }
 
 int
-QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index)
+QPACK::_encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                      uint16_t &referred_index)
 {
   Arena arena;
   int name_len;
@@ -350,7 +382,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
         }
       }
     } else if (lookup_result_static.match_type == LookupResult::MatchType::NAME) {
-      if (never_index) {
+      if (never_index || !this->_should_insert(lowered_name, name_len, value, value_len)) {
         // Name in static table is always available. Do nothing.
       } else {
         // Insert both the name and the value
@@ -383,7 +415,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
             QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
             this->_dynamic_table.ref_entry(current_index);
           }
-        } else {
+        } else if (this->_should_insert(lowered_name, name_len, value, value_len)) {
           // Insert both the name and the value
           uint16_t current_index = lookup_result_dynamic.index;
           lookup_result_dynamic  = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
@@ -401,7 +433,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
           this->_write_insert_without_name_ref(lowered_name, name_len, "", 0);
           QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", name_len, lowered_name, 0, "");
         }
-      } else {
+      } else if (this->_should_insert(lowered_name, name_len, value, value_len)) {
         // Insert both the name and the value
         lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
         if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
@@ -412,6 +444,12 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
     }
   }
 
+  // The entry stays in the table for later header blocks, but this one can't wait for it
+  if (!may_block && lookup_result_dynamic.match_type != LookupResult::MatchType::NONE &&
+      lookup_result_dynamic.index > this->_largest_known_received_index) {
+    lookup_result_dynamic.match_type = LookupResult::MatchType::NONE;
+  }
+
   // Encode
   if (lookup_result_static.match_type == LookupResult::MatchType::EXACT) {
     this->_encode_indexed_header_field(lookup_result_static.index, base_index, false, compressed_header);
@@ -419,7 +457,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
                base_index, false);
     referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
-    if (lookup_result_dynamic.index < this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
       this->_encode_indexed_header_field(lookup_result_dynamic.index, base_index, true, compressed_header);
       QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_dynamic.index,
                  base_index, true);
@@ -972,6 +1010,42 @@ QPACK::_update_reference_counts(uint64_t stream_id)
   }
 }
 
+bool
+QPACK::_should_insert(const char *name, int name_len, const char *value, int value_len)
+{
+  // A large entry would evict most of the table, and be evicted again before it pays off
+  if ((name_len + value_len) * 4 > this->_max_table_size) {
+    return false;
+  }
+
+  // The authority and cookies are sent again on almost every request of a connection
+  if ((name_len == 10 && memcmp(name, ":authority", 10) == 0) || (name_len == 6 && memcmp(name, "cookie", 6) == 0)) {
+    return true;
+  }
+
+  // Anything else is inserted the second time it is seen
+  if (this->_seen_fields.size() >= QPACK_SEEN_FIELDS_MAX) {
+    this->_seen_fields.clear();
+  }
+  uint8_t &count = this->_seen_fields[qpack_hash_field(name, name_len, value, value_len)];
+  if (count < UINT8_MAX) {
+    ++count;
+  }
+  return count > 1;
+}
+
+uint16_t
+QPACK::_count_blocking_streams() const
+{
+  uint16_t count = 0;
+  for (const auto &ref : this->_references) {
+    if (ref.second.largest > this->_largest_known_received_index) {
+      ++count;
+    }
+  }
+  return count;
+}
+
 void
 QPACK::_resume_decode()
 {
@@ -1254,38 +1328,34 @@ QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, co
 const QPACK::LookupResult
 QPACK::DynamicTable::lookup(const char *name, int name_len, const char *value, int value_len)
 {
-  QPACK::LookupResult::MatchType match_type = QPACK::LookupResult::MatchType::NONE;
-  uint16_t i                                = this->_entries_tail + 1;
-  int end                                   = this->_entries_head;
-  uint16_t candidate_index                  = 0;
-  const char *tmp_name                      = nullptr;
-  const char *tmp_value                     = nullptr;
+  const char *tmp_name  = nullptr;
+  int tmp_name_len      = 0;
+  const char *tmp_value = nullptr;
+  int tmp_value_len     = 0;
 
   // DynamicTable is empty
-  if (this->_entries_inserted == 0) {
-    return {candidate_index, match_type};
-  }
-
-  // TODO Use a tree for better performance
-  for (; i <= end; i = (i + 1) % this->_max_entries) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage->read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value,
-                           this->_entries[i].value_len);
-      if (memcmp(name, tmp_name, name_len) == 0) {
-        candidate_index = this->_entries[i].index;
-        if (value_len == this->_entries[i].value_len && memcmp(value, tmp_value, value_len) == 0) {
-          // Exact match
-          match_type = QPACK::LookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matchs
-          match_type = QPACK::LookupResult::MatchType::NAME;
-        }
-      }
+  if (this->_entries_inserted == 0 || name_len == 0) {
+    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
+  }
+
+  // Check whether name and value are matched
+  if (auto it = this->_field_index.find(qpack_hash_field(name, name_len, value, value_len)); it != this->_field_index.end()) {
+    this->lookup(it->second, &tmp_name, &tmp_name_len, &tmp_value, &tmp_value_len);
+    if (tmp_name_len == name_len && tmp_value_len == value_len && memcmp(name, tmp_name, name_len) == 0 &&
+        memcmp(value, tmp_value, value_len) == 0) {
+      return {it->second, QPACK::LookupResult::MatchType::EXACT};
     }
   }
 
-  return {candidate_index, match_type};
+  // Check whether name is matched
+  if (auto it = this->_name_index.find(qpack_hash_name(name, name_len)); it != this->_name_index.end()) {
+    this->lookup(it->second, &tmp_name, &tmp_name_len, &tmp_value, &tmp_value_len);
+    if (tmp_name_len == name_len && memcmp(name, tmp_name, name_len) == 0) {
+      return {it->second, QPACK::LookupResult::MatchType::NAME};
+    }
+  }
+
+  return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
 }
 
 const QPACK::LookupResult
@@ -1331,6 +1401,9 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
   if (this->_available != available) {
     QPACKDTDebug("Evict entries: from %u to %u", this->_entries[(this->_entries_tail + 1) % this->_max_entries].index,
                  this->_entries[tail - 1].index);
+    for (uint16_t pos = (this->_entries_tail + 1) % this->_max_entries; pos != tail; pos = (pos + 1) % this->_max_entries) {
+      this->_evict_entry(pos);
+    }
     this->_available    = available;
     this->_entries_tail = tail - 1;
     QPACKDTDebug("Available size: %u", this->_available);
@@ -1342,6 +1415,9 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
                                          name_len, value_len, 0};
   this->_available -= required_len;
 
+  this->_name_index[qpack_hash_name(name, name_len)]                     = this->_entries_inserted;
+  this->_field_index[qpack_hash_field(name, name_len, value, value_len)] = this->_entries_inserted;
+
   QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, name_len + value_len);
   QPACKDTDebug("Available size: %u", this->_available);
   return {this->_entries_inserted, value_len ? LookupResult::MatchType::EXACT : LookupResult::MatchType::NAME};
@@ -1368,6 +1444,26 @@ QPACK::DynamicTable::duplicate_entry(uint16_t current_index)
   return result;
 }
 
+void
+QPACK::DynamicTable::_evict_entry(uint16_t pos)
+{
+  const char *name;
+  const char *value;
+  const DynamicTableEntry &entry = this->_entries[pos];
+
+  this->_storage->read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+
+  // Indexes may already point to a newer entry which has the same name or field
+  if (auto it = this->_name_index.find(qpack_hash_name(name, entry.name_len));
+      it != this->_name_index.end() && it->second == entry.index) {
+    this->_name_index.erase(it);
+  }
+  if (auto it = this->_field_index.find(qpack_hash_field(name, entry.name_len, value, entry.value_len));
+      it != this->_field_index.end() && it->second == entry.index) {
+    this->_field_index.erase(it);
+  }
+}
+
 bool
 QPACK::DynamicTable::should_duplicate(uint16_t index)
 {
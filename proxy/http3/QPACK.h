@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 
 #include "I_EventSystem.h"
 #include "I_Event.h"
@@ -142,6 +143,8 @@ private:
     uint16_t largest_index() const;
 
   private:
+    void _evict_entry(uint16_t pos);
+
     uint16_t _available        = 0;
     uint16_t _entries_inserted = 0;
 
@@ -151,6 +154,10 @@ private:
     uint16_t _entries_head             = 0;
     uint16_t _entries_tail             = 0;
     DynamicTableStorage *_storage      = nullptr;
+
+    // Hash of name / name and value -> absolute index of the newest entry that has it
+    std::unordered_map<uint64_t, uint16_t> _name_index;
+    std::unordered_map<uint64_t, uint16_t> _field_index;
   };
 
   class DecodeRequest
@@ -265,6 +272,11 @@ private:
 
   void _update_reference_counts(uint64_t stream_id);
 
+  // Fields seen in header blocks so far, to insert only those that repeat
+  std::unordered_map<uint64_t, uint8_t> _seen_fields;
+  bool _should_insert(const char *name, int name_len, const char *value, int value_len);
+  uint16_t _count_blocking_streams() const;
+
   // Encoder Stream
   int _read_insert_with_name_ref(QUICStreamIO &stream_io, bool &is_static, uint16_t &index, Arena &arena, char **value,
                                  uint16_t &value_len);
@@ -287,7 +299,8 @@ private:
 
   // Request and Push Streams
   int _encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferBlock *prefix);
-  int _encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index);
+  int _encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                     uint16_t &referred_index);
   int _encode_indexed_header_field(uint16_t index, uint16_t base_index, bool dynamic_table, IOBufferBlock *compressed_header);
   int _encode_indexed_header_field_with_postbase_index(uint16_t index, uint16_t base_index, bool never_index,
                                                        IOBufferBlock *compressed_header);
@@ -94,6 +94,40 @@ TEST_CASE("Store DATA Frame", "[http3]")
     CHECK(len == 6);
     CHECK(memcmp(buf, expected1, len) == 0);
   }
+
+  SECTION("Payload by reference")
+  {
+    uint8_t buf[32] = {0};
+    size_t len;
+    uint8_t expected1[] = {
+      0x00,                   // Type
+      0x04,                   // Length
+      0x22, 0x33, 0x44, 0x55, // Payload
+    };
+
+    MIOBuffer *mbuf        = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    IOBufferReader *reader = mbuf->alloc_reader();
+    mbuf->write("\x11\x22\x33\x44\x55\x66", 6);
+    reader->consume(1);
+
+    Http3DataFrame data_frame(reader, 4);
+    CHECK(data_frame.length() == 4);
+    CHECK(reader->read_avail() == 1);
+
+    data_frame.store(buf, &len);
+    CHECK(len == 6);
+    CHECK(memcmp(buf, expected1, len) == 0);
+
+    // The payload block refers the data in mbuf
+    Ptr<IOBufferBlock> block = data_frame.to_io_buffer_block();
+    CHECK(block->read_avail() == 2);
+    REQUIRE(block->next);
+    CHECK(block->next->read_avail() == 4);
+    CHECK(block->next->start() == mbuf->first_write_block()->start() + 1);
+
+    block = nullptr;
+    free_MIOBuffer(mbuf);
+  }
 }
 
 TEST_CASE("Store HEADERS Frame", "[http3]")
@@ -469,3 +469,40 @@ TEST_CASE("Decoding", "[qpack-decode]")
     }
   }
 }
+
+TEST_CASE("Encoding with blocked streams limit", "[qpack-encode]")
+{
+  QUICApplicationDriver driver;
+  QPACK *qpack                   = new QPACK(driver.get_connection(), UINT32_MAX, 4096, 1);
+  TestQUICStream *encoder_stream = new TestQUICStream(0);
+  TestQUICStream *decoder_stream = new TestQUICStream(9999);
+  qpack->set_stream(encoder_stream);
+  qpack->set_stream(decoder_stream);
+
+  HTTPHdr hdr;
+  hdr.create(HTTP_TYPE_REQUEST);
+  MIMEField *field = hdr.field_create("cookie", 6);
+  hdr.field_attach(field);
+  hdr.field_value_set(field, "session=0123456789abcdef", 24);
+
+  MIOBuffer *header_block             = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *header_block_reader = header_block->alloc_reader();
+  uint64_t header_block_len           = 0;
+  uint8_t prefix;
+
+  // The cookie is inserted and referred, which may block the stream
+  REQUIRE(qpack->encode(1, hdr, header_block, header_block_len) == 0);
+  header_block_reader->read(&prefix, 1);
+  CHECK(prefix == 1);
+  header_block_reader->consume(header_block_reader->read_avail());
+
+  // Stream 1 is not acknowledged yet, so stream 2 must not refer the unacknowledged entry
+  header_block_len = 0;
+  REQUIRE(qpack->encode(2, hdr, header_block, header_block_len) == 0);
+  header_block_reader->read(&prefix, 1);
+  CHECK(prefix == 0);
+
+  hdr.destroy();
+  free_MIOBuffer(header_block);
+  delete qpack;
+}
@@ -32,6 +32,9 @@
  class.
 
  ***************************************************************************/
+#include <algorithm>
+#include <vector>
+
 #include "tscore/ink_platform.h"
 #include "tscore/TSSystemState.h"
 #include "P_EventSystem.h"
@@ -190,6 +193,7 @@ struct PeriodicWakeup : Continuation {
     : Continuation(new_ProxyMutex()), m_preproc_threads(preproc_threads), m_flush_threads(flush_threads)
   {
     SET_HANDLER((PeriodicWakeupHandler)&PeriodicWakeup::wakeup);
+    thread_agnostic = true;
   }
 };
 
@@ -518,6 +522,15 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("cqmpt", field);
 
+  field = new LogField("client_rtt", "crtt", LogField::sINT, &LogAccess::marshal_client_rtt, &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("crtt", field);
+
+  field = new LogField("client_snd_cwnd", "ccwnd", LogField::sINT, &LogAccess::marshal_client_snd_cwnd,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("ccwnd", field);
+
   field = new LogField("client_sec_protocol", "cqssv", LogField::STRING, &LogAccess::marshal_client_security_protocol,
                        reinterpret_cast<LogField::UnmarshalFunc>(&LogAccess::unmarshal_str));
   global_field_list.add(field, false);
@@ -1332,6 +1345,8 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
   ink_hrtime now, last_time = 0;
   int len, total_bytes;
   SLL<LogFlushData, LogFlushData::Link_link> link, invert_link;
+  std::string compressed;
+  std::vector<Ptr<LogFile>> written_files; // to write out what is staged with O_DIRECT, once they are all written
   ProxyMutex *mutex = this_thread()->mutex.get();
 
   Log::flush_notify->lock();
@@ -1363,7 +1378,8 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
         buf         = reinterpret_cast<char *>(buffer_header);
         total_bytes = buffer_header->byte_count;
 
-      } else if (logfile->m_file_format == LOG_FILE_ASCII || logfile->m_file_format == LOG_FILE_PIPE) {
+      } else if (logfile->m_file_format == LOG_FILE_ASCII || logfile->m_file_format == LOG_FILE_PIPE ||
+                 logfile->m_file_format == LOG_FILE_COLUMNAR) {
         buf         = static_cast<char *>(fdata->m_data);
         total_bytes = fdata->m_len;
 
@@ -1381,9 +1397,21 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
         continue;
       }
 
-      int logfilefd = logfile->get_fd();
       // This should always be true because we just checked it.
-      ink_assert(logfilefd >= 0);
+      ink_assert(logfile->get_fd() >= 0);
+
+      // a columnar stream is compressed as it is written, a message that is not written is dropped whole
+      if (logfile->m_file_format == LOG_FILE_COLUMNAR) {
+        if (Log::config->logging_space_exhausted || !logfile->columnar_compress(buf, total_bytes, compressed)) {
+          Debug("log", "failed to compress for file:%s, have dropped (%d) bytes.", logfile->get_name(), total_bytes);
+
+          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes);
+          delete fdata;
+          continue;
+        }
+        buf         = compressed.data();
+        total_bytes = compressed.size();
+      }
 
       // write *all* data to target file as much as possible
       //
@@ -1397,7 +1425,7 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
           break;
         }
 
-        len = ::write(logfilefd, &buf[bytes_written], total_bytes - bytes_written);
+        len = logfile->write_data(&buf[bytes_written], total_bytes - bytes_written);
 
         if (len < 0) {
           Error("Failed to write log to %s: [tried %d, wrote %d, %s]", logfile->get_name(), total_bytes - bytes_written,
@@ -1416,10 +1444,18 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
       if (logfile->m_log) {
         ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
       }
+      if (std::find(written_files.begin(), written_files.end(), fdata->m_logfile) == written_files.end()) {
+        written_files.push_back(fdata->m_logfile);
+      }
 
       delete fdata;
     }
 
+    for (auto &file : written_files) {
+      file->sync_direct();
+    }
+    written_files.clear();
+
     // Time to work on periodic events??
     //
     now = Thread::get_hrtime() / HRTIME_SECOND;
@@ -94,6 +94,9 @@ public:
     case LOG_FILE_PIPE:
       free(m_data);
       break;
+    case LOG_FILE_COLUMNAR:
+      ats_free(m_data);
+      break;
     case N_LOGFILE_TYPES:
     default:
       ink_release_assert(!"Unknown file format type!");
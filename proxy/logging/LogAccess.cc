@@ -1881,6 +1881,24 @@ LogAccess::marshal_client_req_mptcp_state(char *buf)
   return INK_MIN_ALIGN;
 }
 
+int
+LogAccess::marshal_client_rtt(char *buf)
+{
+  if (buf) {
+    marshal_int(buf, m_http_sm->client_rtt);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_client_snd_cwnd(char *buf)
+{
+  if (buf) {
+    marshal_int(buf, m_http_sm->client_snd_cwnd);
+  }
+  return INK_MIN_ALIGN;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -2783,7 +2801,7 @@ LogAccess::marshal_cache_collapsed_connection_success(char *buf)
   -------------------------------------------------------------------------*/
 
 int
-LogAccess::marshal_http_header_field(LogField::Container container, char *field, char *buf)
+LogAccess::marshal_http_header_field(LogField::Container container, const char *field, char *buf)
 {
   char *str        = nullptr;
   int padded_len   = INK_MIN_ALIGN;
@@ -2884,7 +2902,7 @@ LogAccess::marshal_http_header_field(LogField::Container container, char *field,
 }
 
 int
-LogAccess::marshal_http_header_field_escapify(LogField::Container container, char *field, char *buf)
+LogAccess::marshal_http_header_field_escapify(LogField::Container container, const char *field, char *buf)
 {
   char *str = nullptr, *new_str = nullptr;
   int padded_len = INK_MIN_ALIGN;
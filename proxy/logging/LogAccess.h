@@ -151,6 +151,8 @@ public:
   inkcoreapi int marshal_client_req_ssl_reused(char *);         // INT
   inkcoreapi int marshal_client_req_is_internal(char *);        // INT
   inkcoreapi int marshal_client_req_mptcp_state(char *);        // INT
+  inkcoreapi int marshal_client_rtt(char *);                    // INT
+  inkcoreapi int marshal_client_snd_cwnd(char *);               // INT
   inkcoreapi int marshal_client_security_protocol(char *);      // STR
   inkcoreapi int marshal_client_security_cipher_suite(char *);  // STR
   inkcoreapi int marshal_client_security_curve(char *);         // STR
@@ -263,8 +265,8 @@ public:
 
   // named fields from within a http header
   //
-  inkcoreapi int marshal_http_header_field(LogField::Container container, char *field, char *buf);
-  inkcoreapi int marshal_http_header_field_escapify(LogField::Container container, char *field, char *buf);
+  inkcoreapi int marshal_http_header_field(LogField::Container container, const char *field, char *buf);
+  inkcoreapi int marshal_http_header_field_escapify(LogField::Container container, const char *field, char *buf);
 
   //
   // named records.config int variables
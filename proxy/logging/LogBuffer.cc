@@ -276,15 +276,7 @@ LogBuffer::checkout_write(size_t *write_offset, size_t write_size)
     // ink_release_assert(mutex->thread_holding == this_ethread());
     // SUM_DYN_STAT(log_stat_bytes_buffered_stat, actual_write_size);
 
-    LogEntryHeader *entry_header = reinterpret_cast<LogEntryHeader *>(&m_buffer[offset]);
-    // entry_header->timestamp = LogUtils::timestamp();
-    struct timeval tp = ink_gettimeofday();
-
-    entry_header->timestamp      = tp.tv_sec;
-    entry_header->timestamp_usec = tp.tv_usec;
-    entry_header->entry_len      = actual_write_size;
-
-    *write_offset = offset + sizeof(LogEntryHeader);
+    *write_offset = add_entry_header(offset, actual_write_size);
   }
   //    Debug("log-logbuffer","[%p] %s for buffer %u (%s) returning %d",
   //        this_ethread(),
@@ -294,6 +286,48 @@ LogBuffer::checkout_write(size_t *write_offset, size_t write_size)
   return ret_val;
 }
 
+/*-------------------------------------------------------------------------
+  LogBuffer::checkout_write_private
+  -------------------------------------------------------------------------*/
+
+LogBuffer::LB_ResultCode
+LogBuffer::checkout_write_private(size_t *write_offset, size_t write_size)
+{
+  ink_assert(m_unaligned_buffer);
+  ink_assert(m_state.s.num_writers == 0);
+
+  size_t actual_write_size = INK_ALIGN(write_size + sizeof(LogEntryHeader), m_write_align);
+
+  if (m_state.s.offset + actual_write_size > m_size) {
+    if (m_state.s.num_entries == 0) {
+      return LB_BUFFER_TOO_SMALL;
+    }
+    m_state.s.full = 1;
+    return LB_FULL_NO_WRITERS;
+  }
+
+  size_t offset = m_state.s.offset;
+  m_state.s.offset += actual_write_size;
+  ++m_state.s.num_entries;
+
+  *write_offset = add_entry_header(offset, actual_write_size);
+  return LB_OK;
+}
+
+size_t
+LogBuffer::add_entry_header(size_t offset, size_t actual_write_size)
+{
+  LogEntryHeader *entry_header = reinterpret_cast<LogEntryHeader *>(&m_buffer[offset]);
+  // The cached time, the entry is timed to within the pass of the event loop that logged it.
+  struct timeval tp = ink_hrtime_to_timeval(Thread::get_hrtime());
+
+  entry_header->timestamp      = tp.tv_sec;
+  entry_header->timestamp_usec = tp.tv_usec;
+  entry_header->entry_len      = actual_write_size;
+
+  return offset + sizeof(LogEntryHeader);
+}
+
 /*-------------------------------------------------------------------------
   LogBuffer::checkin_write
   -------------------------------------------------------------------------*/
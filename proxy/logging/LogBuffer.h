@@ -152,6 +152,10 @@ public:
 
   LB_ResultCode checkout_write(size_t *write_offset, size_t write_size);
   LB_ResultCode checkin_write(size_t write_offset);
+
+  // checkout_write for a buffer only the calling thread writes to, the state is updated without an atomic switch and the
+  // entry needs no checkin_write.
+  LB_ResultCode checkout_write_private(size_t *write_offset, size_t write_size);
   void force_full();
 
   LogBufferHeader *
@@ -236,6 +240,7 @@ private:
   // private functions
   size_t _add_buffer_header(const LogConfig *cfg);
   unsigned add_header_str(const char *str, char *buf_ptr, unsigned buf_len);
+  size_t add_entry_header(size_t offset, size_t actual_write_size);
   void freeLogBuffer();
 
   // -- member functions that are not allowed --
@@ -0,0 +1,743 @@
+/** @file
+
+  Columnar log batches, written as an Apache Arrow IPC stream compressed with zstd
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_config.h"
+#include "LogColumnar.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#define LOG_COLUMNAR_ZSTD_LEVEL 3 // the zstd default, fast with a ratio close to libz
+
+namespace
+{
+// the values of the Arrow flatbuffer schema (format/Message.fbs, format/Schema.fbs) that are written
+constexpr int16_t METADATA_V5         = 4;
+constexpr uint8_t HEADER_SCHEMA       = 1;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+constexpr uint8_t TYPE_INT            = 2;
+constexpr uint8_t TYPE_BINARY         = 4;
+constexpr uint8_t TYPE_UTF8           = 5;
+constexpr uint8_t TYPE_TIMESTAMP      = 10;
+constexpr int16_t UNIT_MICROSECOND    = 2;
+constexpr uint32_t CONTINUATION       = 0xFFFFFFFF;
+
+template <typename T>
+T
+load(const uint8_t *p)
+{
+  T v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+size_t
+align8(size_t n)
+{
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+/*
+  Builds a flatbuffer front to back: the root offset first, then each table before the tables,
+  vectors and strings it refers to, which are linked to it as they are added. The offsets of a
+  flatbuffer are unsigned, a reader only follows them forward, so this order is as valid as the
+  back to front order of the flatbuffers library.
+ */
+class FlatBuilder
+{
+public:
+  struct Field {
+    int id;
+    int size;          ///< of the value, 8, 4, 2 or 1 bytes
+    int64_t value = 0; ///< of a scalar, an offset is linked once what it refers to is added
+  };
+
+  FlatBuilder() : _buf(4, '\0') {}
+
+  /// the slot of the root table offset
+  static constexpr size_t ROOT = 0;
+
+  /// Point the offset at @a slot to @a target, which was added after it
+  void
+  link(size_t slot, size_t target)
+  {
+    put<uint32_t>(slot, target - slot);
+  }
+
+  /// Add a table of @a fields, @a slots set to where each field is, by id
+  size_t
+  table(std::initializer_list<Field> fields, size_t *slots)
+  {
+    int n_ids = 0;
+    for (const Field &f : fields) {
+      n_ids = std::max(n_ids, f.id + 1);
+    }
+
+    // the widest fields first, each aligned to its size after the offset to the vtable
+    std::vector<Field> order(fields);
+    std::stable_sort(order.begin(), order.end(), [](const Field &a, const Field &b) { return a.size > b.size; });
+    std::vector<uint16_t> at(n_ids, 0);
+    size_t size = 4;
+    for (const Field &f : order) {
+      size      = (size + f.size - 1) & ~static_cast<size_t>(f.size - 1);
+      at[f.id]  = size;
+      size     += f.size;
+    }
+
+    pad(2);
+    size_t vtable = _buf.size();
+    push<uint16_t>(4 + 2 * n_ids);
+    push<uint16_t>(size);
+    for (uint16_t a : at) {
+      push<uint16_t>(a);
+    }
+
+    pad(8);
+    size_t table = _buf.size();
+    _buf.resize(table + size);
+    put<int32_t>(table, table - vtable);
+    for (const Field &f : order) {
+      size_t slot   = table + at[f.id];
+      slots[f.id]   = slot;
+      uint64_t bits = f.value;
+      memcpy(&_buf[slot], &bits, f.size); // little endian, as the flatbuffer
+    }
+    return table;
+  }
+
+  size_t
+  string(std::string_view s)
+  {
+    pad(4);
+    size_t pos = push<uint32_t>(s.size());
+    _buf.append(s.data(), s.size());
+    _buf.push_back('\0');
+    return pos;
+  }
+
+  /// Add a vector of @a n offsets, @a first set to the slot of the first
+  size_t
+  offsets(size_t n, size_t *first)
+  {
+    pad(4);
+    size_t pos = push<uint32_t>(n);
+    *first     = _buf.size();
+    _buf.append(4 * n, '\0');
+    return pos;
+  }
+
+  /// Add a vector of @a n structs of two 64 bit integers, as FieldNode and Buffer are
+  size_t
+  structs(const std::vector<int64_t> &pairs)
+  {
+    while (_buf.size() % 8 != 4) {
+      _buf.push_back('\0');
+    }
+    size_t pos = push<uint32_t>(pairs.size() / 2);
+    _buf.append(reinterpret_cast<const char *>(pairs.data()), pairs.size() * sizeof(int64_t));
+    return pos;
+  }
+
+  const std::string &
+  data()
+  {
+    pad(8);
+    return _buf;
+  }
+
+private:
+  void
+  pad(size_t align)
+  {
+    while (_buf.size() % align) {
+      _buf.push_back('\0');
+    }
+  }
+
+  template <typename T>
+  size_t
+  push(T v)
+  {
+    size_t pos = _buf.size();
+    _buf.append(reinterpret_cast<const char *>(&v), sizeof(v));
+    return pos;
+  }
+
+  template <typename T>
+  void
+  put(size_t at, T v)
+  {
+    memcpy(&_buf[at], &v, sizeof(v));
+  }
+
+  std::string _buf;
+};
+
+/// A table of a flatbuffer as it is read, every access checked against the end of the buffer
+class FlatTable
+{
+public:
+  FlatTable() = default;
+
+  FlatTable(const uint8_t *buf, size_t len, size_t pos) : _buf(buf), _len(len), _pos(pos)
+  {
+    if (pos == 0 || pos + 4 > len) {
+      return;
+    }
+    int64_t vtable = static_cast<int64_t>(pos) - load<int32_t>(buf + pos);
+    if (vtable < 0 || static_cast<size_t>(vtable) + 4 > len) {
+      return;
+    }
+    _vtable      = vtable;
+    _vtable_size = load<uint16_t>(buf + vtable);
+    _valid       = _vtable_size >= 4 && _vtable + _vtable_size <= len;
+  }
+
+  /// the table the root offset of the buffer refers to
+  static FlatTable
+  root(const uint8_t *buf, size_t len)
+  {
+    return len < 4 ? FlatTable() : FlatTable(buf, len, load<uint32_t>(buf));
+  }
+
+  bool
+  valid() const
+  {
+    return _valid;
+  }
+
+  const uint8_t *
+  base() const
+  {
+    return _buf;
+  }
+
+  bool
+  has(int id) const
+  {
+    return field(id) != 0;
+  }
+
+  template <typename T>
+  T
+  scalar(int id, T def) const
+  {
+    size_t p = field(id);
+    return (p == 0 || p + sizeof(T) > _len) ? def : load<T>(_buf + p);
+  }
+
+  FlatTable
+  table(int id) const
+  {
+    size_t p = deref(field(id));
+    return p ? FlatTable(_buf, _len, p) : FlatTable();
+  }
+
+  /// The vector of @a id, @a elems set to its first element. False if it is not there or is past the end.
+  bool
+  vector(int id, size_t elem_size, size_t *elems, uint32_t *n) const
+  {
+    size_t p = deref(field(id));
+    if (p == 0 || p + 4 > _len) {
+      return false;
+    }
+    *n     = load<uint32_t>(_buf + p);
+    *elems = p + 4;
+    return *n <= (_len - *elems) / elem_size;
+  }
+
+  std::string_view
+  string(int id) const
+  {
+    size_t elems;
+    uint32_t n;
+    if (!vector(id, 1, &elems, &n)) {
+      return {};
+    }
+    return {reinterpret_cast<const char *>(_buf + elems), n};
+  }
+
+  /// the table element @a i of a vector of offsets starting at @a elems
+  FlatTable
+  element(size_t elems, uint32_t i) const
+  {
+    size_t p = deref(elems + 4 * i);
+    return p ? FlatTable(_buf, _len, p) : FlatTable();
+  }
+
+private:
+  size_t
+  field(int id) const
+  {
+    if (!_valid || 4 + 2 * static_cast<size_t>(id) + 2 > _vtable_size) {
+      return 0;
+    }
+    uint16_t off = load<uint16_t>(_buf + _vtable + 4 + 2 * id);
+    return off ? _pos + off : 0;
+  }
+
+  size_t
+  deref(size_t p) const
+  {
+    if (p == 0 || p + 4 > _len) {
+      return 0;
+    }
+    size_t target = p + load<uint32_t>(_buf + p);
+    return target < _len ? target : 0;
+  }
+
+  const uint8_t *_buf  = nullptr;
+  size_t _len          = 0;
+  size_t _pos          = 0;
+  size_t _vtable       = 0;
+  uint16_t _vtable_size = 0;
+  bool _valid          = false;
+};
+
+/// Frame the flatbuffer of a message and its body, the metadata padded so that the body is 8 byte aligned
+void
+frame_message(const std::string &meta, const std::string &body, std::string &out)
+{
+  uint32_t cont = CONTINUATION;
+  int32_t len   = meta.size();
+  out.append(reinterpret_cast<const char *>(&cont), sizeof(cont));
+  out.append(reinterpret_cast<const char *>(&len), sizeof(len));
+  out.append(meta);
+  out.append(body);
+}
+
+size_t
+message_table(FlatBuilder &b, uint8_t header_type, int64_t body_len, size_t *header_slot)
+{
+  size_t slots[4];
+  size_t message = b.table({{0, 2, METADATA_V5}, {1, 1, header_type}, {2, 4}, {3, 8, body_len}}, slots);
+  b.link(FlatBuilder::ROOT, message);
+  *header_slot = slots[2];
+  return message;
+}
+
+bool
+read_schema(const FlatTable &schema, LogColumnarBatch &batch)
+{
+  size_t elems;
+  uint32_t n;
+
+  batch.columns.clear();
+  batch.metadata.clear();
+  if (!schema.valid() || !schema.vector(1, 4, &elems, &n)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    FlatTable field = schema.element(elems, i);
+    FlatTable type  = field.table(3);
+    if (!field.valid() || field.has(4)) { // dictionary encoded
+      return false;
+    }
+    LogColumn::Type column_type;
+    switch (field.scalar<uint8_t>(2, 0)) {
+    case TYPE_INT:
+      if (type.scalar<int32_t>(0, 0) != 64 || type.scalar<uint8_t>(1, 0) == 0) {
+        return false;
+      }
+      column_type = LogColumn::INT64;
+      break;
+    case TYPE_TIMESTAMP:
+      if (type.scalar<int16_t>(0, 0) != UNIT_MICROSECOND) {
+        return false;
+      }
+      column_type = LogColumn::TIMESTAMP;
+      break;
+    case TYPE_UTF8:
+      column_type = LogColumn::UTF8;
+      break;
+    case TYPE_BINARY:
+      column_type = LogColumn::BINARY;
+      break;
+    default:
+      return false;
+    }
+    batch.columns.emplace_back(field.string(0), column_type);
+  }
+
+  if (schema.vector(2, 4, &elems, &n)) {
+    for (uint32_t i = 0; i < n; i++) {
+      FlatTable kv = schema.element(elems, i);
+      batch.metadata.emplace_back(kv.string(0), kv.string(1));
+    }
+  }
+  return true;
+}
+
+bool
+read_batch(const FlatTable &rb, const uint8_t *body, size_t body_len, LogColumnarBatch &batch)
+{
+  size_t node_elems, buffer_elems;
+  uint32_t n_nodes, n_buffers;
+
+  batch.clear_values();
+  if (!rb.valid() || rb.has(3)) { // compressed bodies are not written
+    return false;
+  }
+  int64_t rows = rb.scalar<int64_t>(0, 0);
+  if (rows < 0 || !rb.vector(1, 16, &node_elems, &n_nodes) || !rb.vector(2, 16, &buffer_elems, &n_buffers) ||
+      n_nodes != batch.columns.size()) {
+    return false;
+  }
+  if (rows == 0) {
+    return true;
+  }
+
+  // the FieldNode and Buffer structs are inline in their vectors
+  uint32_t next_buffer = 0;
+  auto buffer          = [&](const uint8_t **data, int64_t *len) -> bool {
+    if (next_buffer >= n_buffers) {
+      return false;
+    }
+    int64_t offset = load<int64_t>(rb.base() + buffer_elems + 16 * next_buffer);
+    *len           = load<int64_t>(rb.base() + buffer_elems + 16 * next_buffer + 8);
+    next_buffer++;
+    if (offset < 0 || *len < 0 || static_cast<uint64_t>(offset) > body_len ||
+        static_cast<uint64_t>(*len) > body_len - offset) {
+      return false;
+    }
+    *data = body + offset;
+    return true;
+  };
+
+  for (uint32_t i = 0; i < n_nodes; i++) {
+    LogColumn &column = batch.columns[i];
+    int64_t length    = load<int64_t>(rb.base() + node_elems + 16 * i);
+    int64_t nulls     = load<int64_t>(rb.base() + node_elems + 16 * i + 8);
+    const uint8_t *validity, *values;
+    int64_t validity_len, values_len;
+    if (length != rows || nulls != 0 || !buffer(&validity, &validity_len) || !buffer(&values, &values_len)) {
+      return false;
+    }
+    if (column.is_int()) {
+      if (values_len < rows * 8) {
+        return false;
+      }
+      column.ints.resize(rows);
+      memcpy(column.ints.data(), values, rows * 8);
+      continue;
+    }
+
+    const uint8_t *chars;
+    int64_t chars_len;
+    if (values_len < (rows + 1) * 4 || !buffer(&chars, &chars_len)) {
+      return false;
+    }
+    column.offsets.resize(rows + 1);
+    memcpy(column.offsets.data(), values, (rows + 1) * 4);
+    int32_t first = column.offsets[0];
+    for (int64_t r = 0; r <= rows; r++) {
+      if (column.offsets[r] < first || (r > 0 && column.offsets[r] < column.offsets[r - 1]) || column.offsets[r] > chars_len) {
+        return false;
+      }
+      column.offsets[r] -= first;
+    }
+    column.chars.assign(reinterpret_cast<const char *>(chars) + first, column.offsets[rows]);
+  }
+  return true;
+}
+} // namespace
+
+const std::string *
+LogColumnarBatch::find_metadata(std::string_view key) const
+{
+  for (const auto &kv : metadata) {
+    if (kv.first == key) {
+      return &kv.second;
+    }
+  }
+  return nullptr;
+}
+
+void
+LogColumnarBatch::clear_values()
+{
+  for (LogColumn &column : columns) {
+    column.clear();
+  }
+}
+
+void
+LogColumnarIPC::schema_message(const LogColumnarBatch &batch, std::string &out)
+{
+  FlatBuilder b;
+  size_t header_slot, schema_slots[3], first_field, first_kv;
+
+  message_table(b, HEADER_SCHEMA, 0, &header_slot);
+  b.link(header_slot, b.table({{0, 2, 0}, {1, 4}, {2, 4}}, schema_slots)); // little endian
+  b.link(schema_slots[1], b.offsets(batch.columns.size(), &first_field));
+  b.link(schema_slots[2], b.offsets(batch.metadata.size(), &first_kv));
+
+  for (size_t i = 0; i < batch.columns.size(); i++) {
+    const LogColumn &column = batch.columns[i];
+    size_t field_slots[6], type_slots[2], no_children;
+    uint8_t type_type = 0;
+    switch (column.type) {
+    case LogColumn::INT64:
+      type_type = TYPE_INT;
+      break;
+    case LogColumn::TIMESTAMP:
+      type_type = TYPE_TIMESTAMP;
+      break;
+    case LogColumn::UTF8:
+      type_type = TYPE_UTF8;
+      break;
+    case LogColumn::BINARY:
+      type_type = TYPE_BINARY;
+      break;
+    }
+
+    b.link(first_field + 4 * i, b.table({{0, 4}, {1, 1, 0}, {2, 1, type_type}, {3, 4}, {5, 4}}, field_slots));
+    b.link(field_slots[0], b.string(column.name));
+    switch (column.type) {
+    case LogColumn::INT64:
+      b.link(field_slots[3], b.table({{0, 4, 64}, {1, 1, 1}}, type_slots));
+      break;
+    case LogColumn::TIMESTAMP:
+      b.link(field_slots[3], b.table({{0, 2, UNIT_MICROSECOND}, {1, 4}}, type_slots));
+      b.link(type_slots[1], b.string("UTC"));
+      break;
+    case LogColumn::UTF8:
+    case LogColumn::BINARY:
+      b.link(field_slots[3], b.table({}, type_slots));
+      break;
+    }
+    b.link(field_slots[5], b.offsets(0, &no_children));
+  }
+
+  for (size_t i = 0; i < batch.metadata.size(); i++) {
+    size_t kv_slots[2];
+    b.link(first_kv + 4 * i, b.table({{0, 4}, {1, 4}}, kv_slots));
+    b.link(kv_slots[0], b.string(batch.metadata[i].first));
+    b.link(kv_slots[1], b.string(batch.metadata[i].second));
+  }
+
+  frame_message(b.data(), std::string(), out);
+}
+
+void
+LogColumnarIPC::batch_message(const LogColumnarBatch &batch, std::string &out)
+{
+  int64_t rows = batch.rows();
+  std::string body;
+  std::vector<int64_t> nodes, buffers;
+
+  auto add_buffer = [&](const void *data, size_t len) {
+    buffers.push_back(body.size());
+    buffers.push_back(len);
+    body.append(static_cast<const char *>(data), len);
+    body.resize(align8(body.size()), '\0');
+  };
+
+  for (const LogColumn &column : batch.columns) {
+    nodes.push_back(rows);
+    nodes.push_back(0);
+    add_buffer(nullptr, 0); // no validity bitmap, none is null
+    if (column.is_int()) {
+      add_buffer(column.ints.data(), rows * sizeof(int64_t));
+    } else {
+      add_buffer(column.offsets.data(), (rows + 1) * sizeof(int32_t));
+      add_buffer(column.chars.data(), column.chars.size());
+    }
+  }
+
+  FlatBuilder b;
+  size_t header_slot, rb_slots[3];
+  message_table(b, HEADER_RECORD_BATCH, body.size(), &header_slot);
+  b.link(header_slot, b.table({{0, 8, rows}, {1, 4}, {2, 4}}, rb_slots));
+  b.link(rb_slots[1], b.structs(nodes));
+  b.link(rb_slots[2], b.structs(buffers));
+
+  frame_message(b.data(), body, out);
+}
+
+LogColumnarIPC::Reader::Result
+LogColumnarIPC::Reader::next(LogColumnarBatch &batch)
+{
+  // the messages read are dropped once they are a good part of what is kept
+  if (_pos > 0 && _pos * 2 >= _pending.size()) {
+    _pending.erase(0, _pos);
+    _pos = 0;
+  }
+
+  for (;;) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(_pending.data()) + _pos;
+    size_t avail     = _pending.size() - _pos;
+    if (avail < 8) {
+      return NEED_MORE;
+    }
+    if (load<uint32_t>(p) != CONTINUATION || load<int32_t>(p + 4) < 0) {
+      return ERROR;
+    }
+    size_t meta_len = load<int32_t>(p + 4);
+    if (meta_len == 0) {
+      _pos += 8;
+      return END;
+    }
+    if (avail - 8 < meta_len) {
+      return NEED_MORE;
+    }
+
+    const uint8_t *meta = p + 8;
+    FlatTable message   = FlatTable::root(meta, meta_len);
+    int64_t body_len    = message.scalar<int64_t>(3, 0);
+    if (!message.valid() || body_len < 0) {
+      return ERROR;
+    }
+    if (avail - 8 - meta_len < static_cast<uint64_t>(body_len)) {
+      return NEED_MORE;
+    }
+    _pos += 8 + meta_len + body_len;
+
+    switch (message.scalar<uint8_t>(1, 0)) {
+    case HEADER_SCHEMA:
+      if (!read_schema(message.table(2), batch)) {
+        return ERROR;
+      }
+      _has_schema = true;
+      break;
+    case HEADER_RECORD_BATCH:
+      if (!_has_schema || !read_batch(message.table(2), meta + meta_len, body_len, batch)) {
+        return ERROR;
+      }
+      return BATCH;
+    default: // dictionary batches and tensors are not written
+      break;
+    }
+  }
+}
+
+LogColumnarCompressor::LogColumnarCompressor()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  if (cctx) {
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, LOG_COLUMNAR_ZSTD_LEVEL);
+  }
+  _cctx = cctx;
+#endif
+}
+
+LogColumnarCompressor::~LogColumnarCompressor()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_freeCCtx(static_cast<ZSTD_CCtx *>(_cctx));
+#endif
+}
+
+bool
+LogColumnarCompressor::compress(const char *data, size_t len, std::string &out, bool end)
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_CCtx *cctx = static_cast<ZSTD_CCtx *>(_cctx);
+  if (cctx == nullptr) {
+    return false;
+  }
+
+  ZSTD_inBuffer in = {data, len, 0};
+  size_t remaining;
+  do {
+    size_t at = out.size();
+    out.resize(at + ZSTD_CStreamOutSize());
+    ZSTD_outBuffer o = {&out[at], out.size() - at, 0};
+    remaining        = ZSTD_compressStream2(cctx, &o, &in, end ? ZSTD_e_end : ZSTD_e_flush);
+    out.resize(at + o.pos);
+    if (ZSTD_isError(remaining)) {
+      ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+      _in_frame = false;
+      return false;
+    }
+  } while (remaining != 0);
+  _in_frame = !end;
+  return true;
+#else
+  (void)data;
+  (void)len;
+  (void)out;
+  (void)end;
+  return false;
+#endif
+}
+
+LogColumnarDecompressor::LogColumnarDecompressor()
+{
+#ifdef HAVE_ZSTD_H
+  _dctx = ZSTD_createDCtx();
+#endif
+}
+
+LogColumnarDecompressor::~LogColumnarDecompressor()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_freeDCtx(static_cast<ZSTD_DCtx *>(_dctx));
+#endif
+}
+
+bool
+LogColumnarDecompressor::decompress(const char *data, size_t len, std::string &out)
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_DCtx *dctx = static_cast<ZSTD_DCtx *>(_dctx);
+  if (dctx == nullptr) {
+    return false;
+  }
+
+  // what is decompressed of the input can fill the output, which is grown until it does not
+  ZSTD_inBuffer in = {data, len, 0};
+  bool full        = false;
+  while (in.pos < in.size || full) {
+    size_t at = out.size();
+    out.resize(at + ZSTD_DStreamOutSize());
+    ZSTD_outBuffer o = {&out[at], out.size() - at, 0};
+    size_t ret       = ZSTD_decompressStream(dctx, &o, &in);
+    out.resize(at + o.pos);
+    if (ZSTD_isError(ret)) {
+      return false;
+    }
+    full      = o.pos == o.size;
+    _in_frame = ret != 0;
+  }
+  return true;
+#else
+  (void)data;
+  (void)len;
+  (void)out;
+  return false;
+#endif
+}
+
+bool
+log_columnar_magic(const char *data, size_t len)
+{
+  static const unsigned char magic[] = {0x28, 0xB5, 0x2F, 0xFD};
+  return len >= sizeof(magic) && memcmp(data, magic, sizeof(magic)) == 0;
+}
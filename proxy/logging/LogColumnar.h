@@ -0,0 +1,215 @@
+/** @file
+
+  Columnar log batches, written as an Apache Arrow IPC stream compressed with zstd
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+  A columnar log file is an Arrow IPC stream (format version 5): a schema message, then a record
+  batch message for each log buffer flushed. The stream is compressed as zstd frames, flushed
+  after every message, so that a file can be read up to the last batch written while it is still
+  being written. No end of stream marker is written, a reader takes the end of the file as the end
+  of the stream, and a file can be appended to after a restart.
+
+  Only the column types logging needs are written and read: signed 64 bit integers, timestamps in
+  microseconds, UTF-8 strings and binary values, none of them nullable.
+ */
+
+struct LogColumn {
+  enum Type {
+    INT64,
+    TIMESTAMP, ///< microseconds since the epoch, UTC
+    UTF8,
+    BINARY,
+  };
+
+  LogColumn() = default;
+  LogColumn(std::string_view n, Type t) : name(n), type(t) {}
+
+  std::string name;
+  Type type = INT64;
+
+  std::vector<int64_t> ints;      ///< of INT64 and TIMESTAMP columns
+  std::vector<int32_t> offsets{0}; ///< of UTF8 and BINARY columns, one more than the rows
+  std::string chars;              ///< of UTF8 and BINARY columns
+
+  bool
+  is_int() const
+  {
+    return type == INT64 || type == TIMESTAMP;
+  }
+
+  size_t
+  rows() const
+  {
+    return is_int() ? ints.size() : offsets.size() - 1;
+  }
+
+  void
+  append(int64_t v)
+  {
+    ints.push_back(v);
+  }
+
+  void
+  append(std::string_view s)
+  {
+    chars.append(s.data(), s.size());
+    offsets.push_back(chars.size());
+  }
+
+  std::string_view
+  value(size_t row) const
+  {
+    return {chars.data() + offsets[row], static_cast<size_t>(offsets[row + 1] - offsets[row])};
+  }
+
+  void
+  clear()
+  {
+    ints.clear();
+    offsets.assign(1, 0);
+    chars.clear();
+  }
+};
+
+/// The columns of a schema, and their values when a batch
+struct LogColumnarBatch {
+  std::vector<LogColumn> columns;
+  std::vector<std::pair<std::string, std::string>> metadata; ///< of the schema
+
+  size_t
+  rows() const
+  {
+    return columns.empty() ? 0 : columns[0].rows();
+  }
+
+  const std::string *find_metadata(std::string_view key) const;
+  void clear_values();
+};
+
+namespace LogColumnarIPC
+{
+/// Append the schema message of the columns and metadata of @a batch to @a out
+void schema_message(const LogColumnarBatch &batch, std::string &out);
+/// Append the record batch message of the values of @a batch to @a out, every column of as many rows
+void batch_message(const LogColumnarBatch &batch, std::string &out);
+
+/**
+  Parses the messages of a stream as they are given.
+
+  The schema message sets the columns and the metadata of the batches that follow.
+ */
+class Reader
+{
+public:
+  enum Result {
+    BATCH,     ///< the next batch was read
+    NEED_MORE, ///< the stream read so far ends within a message
+    END,       ///< the end of stream marker was read
+    ERROR,     ///< the stream is not a stream of the types written
+  };
+
+  void
+  feed(const char *data, size_t len)
+  {
+    _pending.append(data, len);
+  }
+
+  Result next(LogColumnarBatch &batch);
+
+  /// the bytes given that are not part of a message read yet
+  size_t
+  pending() const
+  {
+    return _pending.size() - _pos;
+  }
+
+private:
+  std::string _pending;
+  size_t _pos      = 0;
+  bool _has_schema = false;
+};
+} // namespace LogColumnarIPC
+
+/**
+  A zstd stream, compressed as it is written. Each write ends with a flush, so that what is written
+  can be read back before the frame ends; the frame is ended when the file it is written to is
+  closed or rolled.
+ */
+class LogColumnarCompressor
+{
+public:
+  LogColumnarCompressor();
+  ~LogColumnarCompressor();
+
+  /// Append @a data compressed to @a out, and the end of the frame if @a end. False if zstd fails.
+  bool compress(const char *data, size_t len, std::string &out, bool end = false);
+
+  /// whether data was written since the frame started
+  bool
+  in_frame() const
+  {
+    return _in_frame;
+  }
+
+  LogColumnarCompressor(const LogColumnarCompressor &) = delete;
+  LogColumnarCompressor &operator=(const LogColumnarCompressor &) = delete;
+
+private:
+  void *_cctx    = nullptr;
+  bool _in_frame = false;
+};
+
+/// The zstd frames of a stream, decompressed as they are given
+class LogColumnarDecompressor
+{
+public:
+  LogColumnarDecompressor();
+  ~LogColumnarDecompressor();
+
+  /// Append @a data decompressed to @a out. False if the data is not a zstd stream.
+  bool decompress(const char *data, size_t len, std::string &out);
+
+  /// whether the data given so far ends within a frame
+  bool
+  in_frame() const
+  {
+    return _in_frame;
+  }
+
+  LogColumnarDecompressor(const LogColumnarDecompressor &) = delete;
+  LogColumnarDecompressor &operator=(const LogColumnarDecompressor &) = delete;
+
+private:
+  void *_dctx    = nullptr;
+  bool _in_frame = false;
+};
+
+/// whether @a data starts as a zstd frame does, that is as a columnar log file
+bool log_columnar_magic(const char *data, size_t len);
@@ -0,0 +1,413 @@
+/** @file
+
+  The columns of the fields of a log format, and the log buffers they are encoded from
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_inet.h"
+#include "tscpp/util/TextView.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "LogAccess.h"
+#include "LogBuffer.h"
+#include "LogColumnarFields.h"
+#include "LogField.h"
+#include "LogFormat.h"
+#include "LogLimits.h"
+
+namespace
+{
+const char *
+header_str(LogBufferHeader *header, uint32_t offset)
+{
+  return offset ? reinterpret_cast<char *>(header) + offset : "";
+}
+
+// the header strings of a log buffer, in the order LogBuffer lays them down
+const char *const HEADER_KEYS[] = {"ats.format_name", "ats.fieldlist", "ats.printf", "ats.hostname", "ats.filename"};
+
+int
+string_size(std::string_view s)
+{
+  return LogAccess::round_strlen((s.empty() ? DEFAULT_STR_LEN : s.size()) + 1);
+}
+
+void
+write_string(char *dest, std::string_view s)
+{
+  if (s.empty()) {
+    memcpy(dest, DEFAULT_STR, DEFAULT_STR_LEN);
+  } else {
+    memcpy(dest, s.data(), s.size());
+  }
+}
+
+int
+write_address(char *dest, std::string_view s)
+{
+  IpEndpoint ip;
+  if (s.empty() || ats_ip_pton(s, &ip) != 0) {
+    return LogAccess::marshal_ip(dest, nullptr);
+  }
+  return LogAccess::marshal_ip(dest, &ip.sa);
+}
+} // namespace
+
+LogColumnarFields::~LogColumnarFields()
+{
+  delete m_fieldlist;
+}
+
+bool
+LogColumnarFields::init(LogBufferHeader *header)
+{
+  LogBufferIterator iter(header);
+  LogEntryHeader *entry = iter.next();
+  std::string layout;
+
+  if (entry == nullptr) {
+    return false;
+  }
+
+  m_schema.columns.clear();
+  m_schema.metadata.clear();
+  m_slots.clear();
+  m_schema.columns.emplace_back("timestamp", LogColumn::TIMESTAMP);
+
+  m_text = header->format_type == LOG_FORMAT_TEXT;
+  if (m_text) {
+    m_schema.columns.emplace_back("text", LogColumn::UTF8);
+    layout = "text";
+  } else {
+    if (header->fmt_fieldlist() == nullptr || header->fmt_printf() == nullptr) {
+      return false;
+    }
+    delete m_fieldlist;
+    m_fieldlist              = new LogFieldList;
+    bool contains_aggregates = false;
+    LogFormat::parse_symbol_string(header->fmt_fieldlist(), m_fieldlist, &contains_aggregates);
+
+    // the size each field is marshalled to is how far its unmarshal routine reads
+    std::string scratch(LOG_MAX_FORMATTED_LINE, '\0');
+    char *read_from = reinterpret_cast<char *>(entry) + sizeof(LogEntryHeader);
+    char *end       = reinterpret_cast<char *>(entry) + entry->entry_len;
+    for (LogField *field = m_fieldlist->first(); field; field = m_fieldlist->next(field)) {
+      char *start = read_from;
+      if (field->unmarshal(&read_from, &scratch[0], scratch.size()) < 0 || read_from > end) {
+        return false;
+      }
+      size_t span = read_from - start;
+
+      Slot slot = {BYTES, 0};
+      if (field->type() == LogField::IP) {
+        slot.kind = ADDRESS;
+      } else if (field->type() == LogField::STRING && span == static_cast<size_t>(LogAccess::strlen(start))) {
+        slot.kind = STRING;
+      } else if ((field->type() == LogField::sINT || field->type() == LogField::dINT) && span > 0 && span % sizeof(int64_t) == 0) {
+        slot = {INTS, static_cast<int>(span / sizeof(int64_t))};
+      }
+      m_slots.push_back(slot);
+
+      if (!layout.empty()) {
+        layout += ',';
+      }
+      if (slot.kind == INTS) {
+        layout += std::to_string(slot.ints);
+        for (int i = 0; i < slot.ints; i++) {
+          std::string name = field->symbol();
+          if (slot.ints > 1) {
+            name += "_" + std::to_string(i);
+          }
+          m_schema.columns.emplace_back(name, LogColumn::INT64);
+        }
+      } else {
+        layout += static_cast<char>(slot.kind);
+        m_schema.columns.emplace_back(field->symbol(), slot.kind == BYTES ? LogColumn::BINARY : LogColumn::UTF8);
+      }
+    }
+  }
+
+  const uint32_t offsets[] = {header->fmt_name_offset, header->fmt_fieldlist_offset, header->fmt_printf_offset,
+                              header->src_hostname_offset, header->log_filename_offset};
+  for (size_t i = 0; i < countof(HEADER_KEYS); i++) {
+    m_schema.metadata.emplace_back(HEADER_KEYS[i], header_str(header, offsets[i]));
+  }
+  m_schema.metadata.emplace_back("ats.format_type", std::to_string(header->format_type));
+  m_schema.metadata.emplace_back("ats.signature", std::to_string(header->log_object_signature));
+  m_schema.metadata.emplace_back("ats.flags", std::to_string(header->log_object_flags));
+  m_schema.metadata.emplace_back("ats.layout", layout);
+  return true;
+}
+
+bool
+LogColumnarFields::init(const LogColumnarBatch &schema)
+{
+  const std::string *layout = schema.find_metadata("ats.layout");
+
+  m_schema = schema;
+  m_schema.clear_values();
+  m_slots.clear();
+  if (layout == nullptr || schema.columns.empty() || schema.columns[0].type != LogColumn::TIMESTAMP) {
+    return false;
+  }
+
+  m_text = *layout == "text";
+  if (m_text) {
+    return schema.columns.size() == 2 && schema.columns[1].type == LogColumn::UTF8;
+  }
+
+  size_t column = 1;
+  ts::TextView tokens(*layout);
+  while (tokens) {
+    ts::TextView token = tokens.take_prefix_at(',');
+    Slot slot          = {BYTES, 0};
+    LogColumn::Type type;
+    if (token.size() == 1 && (token[0] == STRING || token[0] == ADDRESS || token[0] == BYTES)) {
+      slot.kind = static_cast<Kind>(token[0]);
+      type      = slot.kind == BYTES ? LogColumn::BINARY : LogColumn::UTF8;
+    } else {
+      slot = {INTS, static_cast<int>(ts::svtoi(token))};
+      type = LogColumn::INT64;
+      if (slot.ints <= 0) {
+        return false;
+      }
+    }
+    for (int i = 0; i < std::max(slot.ints, 1); i++, column++) {
+      if (column >= schema.columns.size() || schema.columns[column].type != type) {
+        return false;
+      }
+    }
+    m_slots.push_back(slot);
+  }
+  return column == schema.columns.size();
+}
+
+bool
+LogColumnarFields::encode_entry(char *read_from, char *end, std::string &scratch, std::vector<std::string_view> &values) const
+{
+  values.clear();
+  if (m_text) {
+    values.emplace_back(read_from, strnlen(read_from, end - read_from));
+    return true;
+  }
+
+  LogField *field = m_fieldlist->first();
+  for (size_t i = 0; i < m_slots.size() && field; i++, field = m_fieldlist->next(field)) {
+    const Slot &slot = m_slots[i];
+    size_t left      = end - read_from;
+    char *start      = read_from;
+
+    switch (slot.kind) {
+    case INTS:
+      if (left < slot.ints * sizeof(int64_t)) {
+        return false;
+      }
+      read_from += slot.ints * sizeof(int64_t);
+      values.emplace_back(start, read_from - start);
+      break;
+    case STRING: {
+      size_t len = strnlen(read_from, left);
+      if (len == left) {
+        return false;
+      }
+      read_from += LogAccess::strlen(read_from);
+      values.emplace_back(start, len);
+      break;
+    }
+    case ADDRESS: {
+      IpEndpoint ip;
+      char *text = &scratch[i * INET6_ADDRSTRLEN];
+      if (left < sizeof(LogFieldIp)) {
+        return false;
+      }
+      LogAccess::unmarshal_ip(&read_from, &ip);
+      values.emplace_back(text, ats_is_ip(&ip) ? ::strlen(ats_ip_ntop(&ip, text, INET6_ADDRSTRLEN)) : 0);
+      break;
+    }
+    case BYTES: {
+      char *unused = &scratch[m_slots.size() * INET6_ADDRSTRLEN];
+      if (field->unmarshal(&read_from, unused, LOG_MAX_FORMATTED_LINE) < 0) {
+        return false;
+      }
+      values.emplace_back(start, read_from - start);
+      break;
+    }
+    }
+    if (read_from > end) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+LogColumnarFields::encode(LogBufferHeader *header, LogColumnarBatch &batch) const
+{
+  LogBufferIterator iter(header);
+  std::string scratch(m_slots.size() * INET6_ADDRSTRLEN + LOG_MAX_FORMATTED_LINE, '\0');
+  std::vector<std::string_view> values;
+  int dropped = 0;
+
+  while (LogEntryHeader *entry = iter.next()) {
+    char *read_from = reinterpret_cast<char *>(entry) + sizeof(LogEntryHeader);
+    char *end       = reinterpret_cast<char *>(entry) + entry->entry_len;
+    if (!encode_entry(read_from, end, scratch, values)) {
+      dropped++;
+      continue;
+    }
+
+    batch.columns[0].append(entry->timestamp * 1000000 + entry->timestamp_usec);
+    size_t column = 1;
+    for (size_t i = 0; i < values.size(); i++) {
+      if (m_text || m_slots[i].kind != INTS) {
+        batch.columns[column++].append(values[i]);
+        continue;
+      }
+      for (int j = 0; j < m_slots[i].ints; j++) {
+        int64_t v;
+        memcpy(&v, values[i].data() + j * sizeof(int64_t), sizeof(v));
+        batch.columns[column++].append(v);
+      }
+    }
+  }
+  return dropped;
+}
+
+LogBufferHeader *
+LogColumnarFields::decode(const LogColumnarBatch &batch) const
+{
+  size_t rows = batch.rows();
+  if (rows == 0 || batch.columns.size() != m_schema.columns.size()) {
+    return nullptr;
+  }
+
+  size_t header_len = sizeof(LogBufferHeader);
+  const std::string *strs[countof(HEADER_KEYS)];
+  for (size_t i = 0; i < countof(HEADER_KEYS); i++) {
+    strs[i] = m_schema.find_metadata(HEADER_KEYS[i]);
+    if (strs[i] && !strs[i]->empty()) {
+      header_len += strs[i]->size() + 1;
+    }
+  }
+  header_len = INK_ALIGN_DEFAULT(header_len);
+
+  // the size of each entry, field by field
+  std::vector<uint32_t> sizes(rows, sizeof(LogEntryHeader));
+  size_t column = 1;
+  for (size_t i = 0; i < (m_text ? 1 : m_slots.size()); i++) {
+    Kind kind               = m_text ? STRING : m_slots[i].kind;
+    const LogColumn &values = batch.columns[column];
+    for (size_t r = 0; r < rows; r++) {
+      switch (kind) {
+      case INTS:
+        sizes[r] += m_slots[i].ints * sizeof(int64_t);
+        break;
+      case STRING:
+        sizes[r] += string_size(values.value(r));
+        break;
+      case ADDRESS:
+        sizes[r] += write_address(nullptr, values.value(r));
+        break;
+      case BYTES:
+        sizes[r] += values.value(r).size();
+        break;
+      }
+    }
+    column += kind == INTS ? m_slots[i].ints : 1;
+  }
+  size_t total = header_len;
+  for (uint32_t &size : sizes) {
+    size   = INK_ALIGN_DEFAULT(size);
+    total += size;
+  }
+  if (total > UINT32_MAX) {
+    return nullptr;
+  }
+
+  char *buf               = static_cast<char *>(ats_malloc(total));
+  LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(buf);
+  const std::string *v;
+  memset(buf, 0, total);
+  header->cookie               = LOG_SEGMENT_COOKIE;
+  header->version              = LOG_SEGMENT_VERSION;
+  header->format_type          = (v = m_schema.find_metadata("ats.format_type")) ? atoi(v->c_str()) : LOG_FORMAT_CUSTOM;
+  header->byte_count           = total;
+  header->entry_count          = rows;
+  header->log_object_signature = (v = m_schema.find_metadata("ats.signature")) ? strtoull(v->c_str(), nullptr, 10) : 0;
+  header->log_object_flags     = (v = m_schema.find_metadata("ats.flags")) ? strtoul(v->c_str(), nullptr, 10) : 0;
+  header->data_offset          = header_len;
+
+  uint32_t *offsets[] = {&header->fmt_name_offset, &header->fmt_fieldlist_offset, &header->fmt_printf_offset,
+                         &header->src_hostname_offset, &header->log_filename_offset};
+  size_t at           = sizeof(LogBufferHeader);
+  for (size_t i = 0; i < countof(HEADER_KEYS); i++) {
+    if (strs[i] && !strs[i]->empty()) {
+      *offsets[i] = at;
+      memcpy(buf + at, strs[i]->c_str(), strs[i]->size() + 1);
+      at += strs[i]->size() + 1;
+    }
+  }
+
+  const LogColumn &timestamps = batch.columns[0];
+  header->low_timestamp       = UINT32_MAX;
+  at                          = header_len;
+  for (size_t r = 0; r < rows; r++) {
+    LogEntryHeader *entry = reinterpret_cast<LogEntryHeader *>(buf + at);
+    int64_t usec          = timestamps.ints[r];
+    entry->timestamp      = usec / 1000000 - (usec % 1000000 < 0);
+    entry->timestamp_usec = usec - entry->timestamp * 1000000;
+    entry->entry_len      = sizes[r];
+    header->low_timestamp  = std::min<uint32_t>(header->low_timestamp, entry->timestamp);
+    header->high_timestamp = std::max<uint32_t>(header->high_timestamp, entry->timestamp);
+
+    char *write_to = buf + at + sizeof(LogEntryHeader);
+    column         = 1;
+    for (size_t i = 0; i < (m_text ? 1 : m_slots.size()); i++) {
+      Kind kind = m_text ? STRING : m_slots[i].kind;
+      switch (kind) {
+      case INTS:
+        for (int j = 0; j < m_slots[i].ints; j++) {
+          memcpy(write_to, &batch.columns[column++].ints[r], sizeof(int64_t));
+          write_to += sizeof(int64_t);
+        }
+        break;
+      case STRING:
+        write_string(write_to, batch.columns[column].value(r));
+        write_to += string_size(batch.columns[column++].value(r));
+        break;
+      case ADDRESS:
+        write_to += write_address(write_to, batch.columns[column++].value(r));
+        break;
+      case BYTES: {
+        std::string_view bytes = batch.columns[column++].value(r);
+        memcpy(write_to, bytes.data(), bytes.size());
+        write_to += bytes.size();
+        break;
+      }
+      }
+    }
+    at += sizes[r];
+  }
+  return header;
+}
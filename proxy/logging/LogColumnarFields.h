@@ -0,0 +1,95 @@
+/** @file
+
+  The columns of the fields of a log format, and the log buffers they are encoded from
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LogColumnar.h"
+
+struct LogBufferHeader;
+class LogFieldList;
+
+/*
+  Each entry of a log buffer is a row, the first column its timestamp. Each field of the format is
+  stored as the value it was marshalled to, so that a row can be put back into a log buffer as it
+  was and printed by the same code that prints binary logs:
+
+    - an integer field as a column of Int64, or more than one if it marshals more than one integer,
+      named <symbol>_0, <symbol>_1 ...
+    - a string field as a column of Utf8, before any slice of the format is taken
+    - an IP address field as a column of Utf8, the address as text, empty if there is none
+    - a field marshalled as anything else, such as cqtx, as a column of Binary, the bytes as they
+      are in the log buffer
+
+  The layout is learned from the first entry of the first buffer and stored in the schema metadata,
+  as are the format and the header strings of the log buffers. A text format is a single Utf8
+  column of the text.
+ */
+class LogColumnarFields
+{
+public:
+  LogColumnarFields() = default;
+  ~LogColumnarFields();
+
+  /// Learn the columns of the buffers of @a header. False if it has no entries or is not of a log format.
+  bool init(LogBufferHeader *header);
+  /// Learn the columns of the buffers of a stream from its schema. False if the schema was not written by init().
+  bool init(const LogColumnarBatch &schema);
+
+  /// the columns and metadata, without values
+  const LogColumnarBatch &
+  schema() const
+  {
+    return m_schema;
+  }
+
+  /// Append the entries of @a header to the rows of @a batch, the number of entries of another layout returned
+  int encode(LogBufferHeader *header, LogColumnarBatch &batch) const;
+  /// The rows of @a batch as a log buffer, ats_malloc()ed, or nullptr if it has none
+  LogBufferHeader *decode(const LogColumnarBatch &batch) const;
+
+  LogColumnarFields(const LogColumnarFields &) = delete;
+  LogColumnarFields &operator=(const LogColumnarFields &) = delete;
+
+private:
+  enum Kind : char {
+    INTS    = 'i',
+    STRING  = 's',
+    ADDRESS = 'a',
+    BYTES   = 'b',
+  };
+
+  struct Slot {
+    Kind kind;
+    int ints; ///< of an INTS field
+  };
+
+  bool encode_entry(char *read_from, char *end, std::string &scratch, std::vector<std::string_view> &values) const;
+
+  LogFieldList *m_fieldlist = nullptr; ///< of the buffers encoded
+  bool m_text               = false;
+  std::vector<Slot> m_slots;
+  LogColumnarBatch m_schema;
+};
@@ -76,6 +76,8 @@ LogConfig::setup_default_values()
 
   log_buffer_size       = static_cast<int>(10 * LOG_KILOBYTE);
   max_secs_per_buffer   = 5;
+  thread_buffers        = false;
+  direct_io             = false;
   max_space_mb_for_logs = 100;
   max_space_mb_headroom = 10;
   logfile_perm          = 0644;
@@ -136,6 +138,9 @@ LogConfig::read_configuration_variables()
     max_secs_per_buffer = val;
   }
 
+  thread_buffers = REC_ConfigReadInteger("proxy.config.log.thread_buffers") != 0;
+  direct_io      = REC_ConfigReadInteger("proxy.config.log.direct_io") != 0;
+
   val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.max_space_mb_for_logs"));
   if (val > 0) {
     max_space_mb_for_logs = val;
@@ -347,6 +352,8 @@ LogConfig::display(FILE *fd)
   fprintf(fd, "Config variables:\n");
   fprintf(fd, "   log_buffer_size = %d\n", log_buffer_size);
   fprintf(fd, "   max_secs_per_buffer = %d\n", max_secs_per_buffer);
+  fprintf(fd, "   thread_buffers = %d\n", thread_buffers);
+  fprintf(fd, "   direct_io = %d\n", direct_io);
   fprintf(fd, "   max_space_mb_for_logs = %d\n", max_space_mb_for_logs);
   fprintf(fd, "   max_space_mb_headroom = %d\n", max_space_mb_headroom);
   fprintf(fd, "   hostname = %s\n", hostname);
@@ -441,7 +448,8 @@ LogConfig::register_config_callbacks()
     "proxy.config.log.rolling_offset_hr",     "proxy.config.log.rolling_size_mb",     "proxy.config.log.auto_delete_rolled_files",
     "proxy.config.log.rolling_max_count",     "proxy.config.log.rolling_allow_empty", "proxy.config.log.config.filename",
     "proxy.config.log.sampling_frequency",    "proxy.config.log.file_stat_frequency", "proxy.config.log.space_used_frequency",
-    "proxy.config.log.io.max_buffer_index",
+    "proxy.config.log.io.max_buffer_index",   "proxy.config.log.thread_buffers",
+    "proxy.config.log.direct_io",
   };
 
   for (unsigned i = 0; i < countof(names); ++i) {
@@ -512,6 +520,15 @@ LogConfig::register_stat_callbacks()
   RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.bytes_lost_before_written_to_disk", RECD_INT, RECP_PERSISTENT,
                      (int)log_stat_bytes_lost_before_written_to_disk_stat, RecRawStatSyncSum);
   //
+  // remote log collectors
+  //
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.batches_sent_to_network", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_batches_sent_to_network_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.network_queue_bytes", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)log_stat_network_queue_bytes_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.network_connect_failures", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_network_connect_failures_stat, RecRawStatSyncSum);
+  //
   // I/O
   //
   RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.log_files_open", RECD_COUNTER, RECP_NON_PERSISTENT,
@@ -67,6 +67,11 @@ enum {
   log_stat_bytes_written_to_disk_stat,
   log_stat_bytes_lost_before_written_to_disk_stat,
 
+  // remote log collectors
+  log_stat_batches_sent_to_network_stat,
+  log_stat_network_queue_bytes_stat,
+  log_stat_network_connect_failures_stat,
+
   // Logging I/O
   log_stat_log_files_open_stat,
   log_stat_log_files_space_used_stat,
@@ -184,6 +189,8 @@ public:
 
   int log_buffer_size;
   int max_secs_per_buffer;
+  bool thread_buffers;
+  bool direct_io;
   int max_space_mb_for_logs;
   int max_space_mb_headroom;
   int logfile_perm;
@@ -0,0 +1,176 @@
+/** @file
+
+  Appends to a log file with O_DIRECT, in aligned blocks
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_memory.h"
+
+#include "LogDirectWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LogDirectWriter::LogDirectWriter(size_t buffer_size, size_t align)
+  : m_align(align), m_size((buffer_size + align - 1) & ~(align - 1))
+{
+  if (m_size < m_align) {
+    m_size = m_align;
+  }
+  m_buffer = static_cast<char *>(ats_memalign(m_align, m_size));
+}
+
+LogDirectWriter::~LogDirectWriter()
+{
+  close();
+  ats_free(m_buffer);
+}
+
+bool
+LogDirectWriter::open(const char *path, bool direct)
+{
+  struct stat st;
+  int flags = O_RDWR;
+
+  close();
+#ifdef O_DIRECT
+  if (direct) {
+    flags |= O_DIRECT;
+  }
+#endif
+  if ((m_fd = ::open(path, flags)) < 0) {
+    return false;
+  }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+  if (direct && fcntl(m_fd, F_NOCACHE, 1) < 0) {
+    close();
+    return false;
+  }
+#endif
+
+  if (fstat(m_fd, &st) < 0) {
+    close();
+    return false;
+  }
+
+  // start from the block of the end of the file, staging what it has of it
+  m_offset = st.st_size & ~static_cast<off_t>(m_align - 1);
+  m_used   = st.st_size - m_offset;
+  m_synced = true;
+  if (m_used > 0) {
+    ssize_t n = pread(m_fd, m_buffer, m_align, m_offset);
+    if (n < static_cast<ssize_t>(m_used)) {
+      if (n >= 0) {
+        errno = EIO;
+      }
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+LogDirectWriter::close()
+{
+  if (m_fd >= 0) {
+    sync();
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_used   = 0;
+  m_offset = 0;
+}
+
+// Write the first @a len bytes of the buffer, a multiple of the alignment, at the offset.
+bool
+LogDirectWriter::write_blocks(size_t len)
+{
+  for (size_t written = 0; written < len;) {
+    ssize_t n = pwrite(m_fd, m_buffer + written, len - written, m_offset + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+ssize_t
+LogDirectWriter::write(const char *data, size_t len)
+{
+  if (m_fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+
+  for (size_t copied = 0; copied < len;) {
+    size_t n = std::min(len - copied, m_size - m_used);
+
+    memcpy(m_buffer + m_used, data + copied, n);
+    m_used += n;
+    copied += n;
+    m_synced = false;
+    if (m_used == m_size) {
+      if (!write_blocks(m_size)) {
+        // drop what failed to be written, as a failed write() would
+        m_used = 0;
+        return -1;
+      }
+      m_offset += m_size;
+      m_used   = 0;
+      m_synced = true;
+    }
+  }
+  return len;
+}
+
+bool
+LogDirectWriter::sync()
+{
+  if (m_fd < 0 || m_synced) {
+    return true;
+  }
+
+  size_t full   = m_used & ~(m_align - 1);
+  size_t padded = (m_used + m_align - 1) & ~(m_align - 1);
+
+  memset(m_buffer + m_used, 0, padded - m_used);
+  if (!write_blocks(padded) || ftruncate(m_fd, size()) < 0) {
+    return false;
+  }
+  m_synced = true;
+
+  // only the partial block is written again
+  if (full > 0) {
+    memmove(m_buffer, m_buffer + full, m_used - full);
+    m_offset += full;
+    m_used -= full;
+  }
+  return true;
+}
@@ -0,0 +1,89 @@
+/** @file
+
+  Appends to a log file with O_DIRECT, in aligned blocks
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <sys/types.h>
+
+/*-------------------------------------------------------------------------
+  LogDirectWriter
+
+  Appends to a log file bypassing the page cache, so that writing logs
+  neither evicts the pages of the rest of the system nor stalls it in
+  writeback. What is written is staged in an aligned buffer and written in
+  whole blocks at aligned offsets, as O_DIRECT requires. sync() writes the
+  partial block at the end, padded with zeros, and truncates the file back
+  to its length; the block is written again once more data follows it.
+
+  A writer is used by the flush thread only.
+  -------------------------------------------------------------------------*/
+class LogDirectWriter
+{
+public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+  static constexpr size_t DEFAULT_ALIGN       = 4096; ///< the logical block size of most devices, or a multiple of it
+
+  /// @a buffer_size is rounded up to a multiple of @a align, which is a power of 2
+  LogDirectWriter(size_t buffer_size = DEFAULT_BUFFER_SIZE, size_t align = DEFAULT_ALIGN);
+  ~LogDirectWriter();
+
+  /// Open @a path to append to it, with O_DIRECT if @a direct. False with errno set if it cannot be,
+  /// EINVAL if the file system does not support O_DIRECT.
+  bool open(const char *path, bool direct = true);
+  void close();
+
+  bool
+  is_open() const
+  {
+    return m_fd >= 0;
+  }
+
+  /// Append @a len bytes of @a data. Returns @a len, or -1 with errno set if a block failed to be written.
+  ssize_t write(const char *data, size_t len);
+
+  /// Write what is staged, so that the file has all that was appended. False if it failed to.
+  bool sync();
+
+  /// the length of the file, with what is staged
+  off_t
+  size() const
+  {
+    return m_offset + static_cast<off_t>(m_used);
+  }
+
+  // noncopyable
+  LogDirectWriter(const LogDirectWriter &) = delete;
+  LogDirectWriter &operator=(const LogDirectWriter &) = delete;
+
+private:
+  bool write_blocks(size_t len);
+
+  int m_fd = -1;
+  size_t m_align;
+  size_t m_size;
+  char *m_buffer;
+  size_t m_used  = 0; ///< bytes staged
+  off_t m_offset = 0; ///< of the file, where the buffer is written to; aligned
+  bool m_synced  = true;
+};
@@ -311,6 +311,16 @@ LogField::milestones_from_m_name(TSMilestonesType *ms1, TSMilestonesType *ms2)
   return 0;
 }
 
+// The name of a header field as the well known string of it if there is one, so that looking it up
+// in a header can use the presence bits and slot accelerators rather than comparing the names of
+// the fields of the header.
+static const char *
+header_field_name(const char *name)
+{
+  const char *wks = hdrtoken_string_to_wks(name);
+  return wks ? wks : name;
+}
+
 // Container field ctor
 LogField::LogField(const char *field, Container container, SetFunc _setfunc)
   : m_name(ats_strdup(field)),
@@ -347,6 +357,9 @@ LogField::LogField(const char *field, Container container, SetFunc _setfunc)
   case EPQH:
   case ESSH:
   case ECSSH:
+    m_header_name = header_field_name(m_name);
+    // fallthrough
+
   case SCFG:
     m_unmarshal_func = reinterpret_cast<UnmarshalFunc>(&(LogAccess::unmarshal_str));
     break;
@@ -399,6 +412,10 @@ LogField::LogField(const LogField &rhs)
     m_alias_map(rhs.m_alias_map),
     m_set_func(rhs.m_set_func)
 {
+  if (rhs.m_header_name) {
+    m_header_name = header_field_name(m_name);
+  }
+
   ink_assert(m_name != nullptr);
   ink_assert(m_symbol != nullptr);
   ink_assert(m_type >= 0 && m_type < N_TYPES);
@@ -434,14 +451,14 @@ LogField::marshal_len(LogAccess *lad)
   case PQH:
   case SSH:
   case CSSH:
-    return lad->marshal_http_header_field(m_container, m_name, nullptr);
+    return lad->marshal_http_header_field(m_container, m_header_name, nullptr);
 
   case ECQH:
   case EPSH:
   case EPQH:
   case ESSH:
   case ECSSH:
-    return lad->marshal_http_header_field_escapify(m_container, m_name, nullptr);
+    return lad->marshal_http_header_field_escapify(m_container, m_header_name, nullptr);
 
   case ICFG:
     return lad->marshal_config_int_var(m_name, nullptr);
@@ -463,6 +480,25 @@ LogField::marshal_len(LogAccess *lad)
   }
 }
 
+unsigned
+LogField::fixed_marshal_len() const
+{
+  if (m_type == sINT) {
+    return INK_MIN_ALIGN;
+  }
+
+  // containers of integers are strings until they are unmarshalled
+  switch (m_container) {
+  case ICFG:
+  case MS:
+  case MSDMS:
+    return INK_MIN_ALIGN;
+
+  default:
+    return 0;
+  }
+}
+
 bool
 LogField::isContainerUpdateFieldSupported(Container container)
 {
@@ -516,14 +552,14 @@ LogField::marshal(LogAccess *lad, char *buf)
   case PQH:
   case SSH:
   case CSSH:
-    return lad->marshal_http_header_field(m_container, m_name, buf);
+    return lad->marshal_http_header_field(m_container, m_header_name, buf);
 
   case ECQH:
   case EPSH:
   case EPQH:
   case ESSH:
   case ECSSH:
-    return lad->marshal_http_header_field_escapify(m_container, m_name, buf);
+    return lad->marshal_http_header_field_escapify(m_container, m_header_name, buf);
 
   case ICFG:
     return lad->marshal_config_int_var(m_name, buf);
@@ -748,6 +784,8 @@ LogFieldList::clear()
   while ((f = m_field_list.dequeue())) {
     delete f; // safe given the semantics stated above
   }
+  m_marshal_plan.clear();
+  m_variable_fields.clear();
   m_marshal_len = 0;
   _badSymbols.clear();
 }
@@ -758,13 +796,15 @@ LogFieldList::add(LogField *field, bool copy)
   ink_assert(field != nullptr);
 
   if (copy) {
-    m_field_list.enqueue(new LogField(*field));
-  } else {
-    m_field_list.enqueue(field);
+    field = new LogField(*field);
   }
+  m_field_list.enqueue(field);
 
-  if (field->type() == LogField::sINT) {
-    m_marshal_len += INK_MIN_ALIGN;
+  m_marshal_plan.push_back(field);
+  if (const unsigned len = field->fixed_marshal_len(); len > 0) {
+    m_marshal_len += len;
+  } else {
+    m_variable_fields.push_back(field);
   }
 }
 
@@ -804,12 +844,10 @@ unsigned
 LogFieldList::marshal_len(LogAccess *lad)
 {
   int bytes = 0;
-  for (LogField *f = first(); f; f = next(f)) {
-    if (f->type() != LogField::sINT) {
-      const int len = f->marshal_len(lad);
-      ink_release_assert(len >= INK_MIN_ALIGN);
-      bytes += len;
-    }
+  for (LogField *f : m_variable_fields) {
+    const int len = f->marshal_len(lad);
+    ink_release_assert(len >= INK_MIN_ALIGN);
+    bytes += len;
   }
   return m_marshal_len + bytes;
 }
@@ -819,7 +857,7 @@ LogFieldList::marshal(LogAccess *lad, char *buf)
 {
   char *ptr;
   int bytes = 0;
-  for (LogField *f = first(); f; f = next(f)) {
+  for (LogField *f : m_marshal_plan) {
     ptr = &buf[bytes];
     bytes += f->marshal(lad, ptr);
     ink_assert(bytes % INK_MIN_ALIGN == 0);
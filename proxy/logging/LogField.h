@@ -25,6 +25,7 @@
 
 #include <string_view>
 #include <string>
+#include <vector>
 
 #include "tscore/ink_platform.h"
 #include "tscore/List.h"
@@ -131,6 +132,8 @@ public:
   ~LogField();
 
   unsigned marshal_len(LogAccess *lad);
+  /// The length of every entry of this field, or 0 if it varies by entry and marshal_len() has to be asked.
+  unsigned fixed_marshal_len() const;
   unsigned marshal(LogAccess *lad, char *buf);
   unsigned marshal_agg(char *buf);
   unsigned unmarshal(char **buf, char *dest, int len);
@@ -198,6 +201,7 @@ private:
   TSMilestonesType m_milestone1; ///< Used for MS and MSDMS as the first (or only) milestone.
   TSMilestonesType m_milestone2; ///< Second milestone for MSDMS
   bool m_time_field;
+  const char *m_header_name = nullptr; ///< of a header container, the well known string of m_name if it is one
   Ptr<LogFieldAliasMap> m_alias_map; // map sINT <--> string
   SetFunc m_set_func;
   TSMilestonesType milestone_from_m_name();
@@ -266,8 +270,12 @@ public:
   LogFieldList &operator=(const LogFieldList &rhs) = delete;
 
 private:
-  unsigned m_marshal_len = 0;
+  unsigned m_marshal_len = 0; ///< of the fields of a fixed length
   Queue<LogField> m_field_list;
+  // The plan entries are marshalled by, compiled as the fields are added: all the fields in order,
+  // and the fields of a length that varies by entry, the only ones marshal_len() has to look at.
+  std::vector<LogField *> m_marshal_plan;
+  std::vector<LogField *> m_variable_fields;
   std::string _badSymbols;
 };
 
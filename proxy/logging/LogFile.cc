@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <mutex>
 
 #include "tscore/ink_platform.h"
 #include "tscore/SimpleTokenizer.h"
@@ -53,8 +54,22 @@
 #include "LogObject.h"
 #include "LogUtils.h"
 #include "LogConfig.h"
+#include "LogColumnar.h"
+#include "LogColumnarFields.h"
+#include "LogDirectWriter.h"
 #include "Log.h"
 
+// The layout of a columnar file is learned from the first buffer a preproc thread writes to it, and is
+// read by every preproc thread after; the stream is compressed by the flush thread as it writes.
+struct LogFile::Columnar {
+  std::mutex mutex;
+  bool ready = false;
+  LogColumnarFields fields;
+  std::string schema; ///< message, written first to a new file
+  bool new_file = false;
+  LogColumnarCompressor compressor;
+};
+
 /*-------------------------------------------------------------------------
   LogFile::LogFile
 
@@ -77,6 +92,9 @@ LogFile::LogFile(const char *name, const char *header, LogFileFormat format, uin
   } else {
     m_log = nullptr;
   }
+  if (m_file_format == LOG_FILE_COLUMNAR) {
+    m_columnar = new Columnar;
+  }
 
   m_fd                = -1;
   m_ascii_buffer_size = (ascii_buffer_size < max_line_size ? max_line_size : ascii_buffer_size);
@@ -108,6 +126,9 @@ LogFile::LogFile(const LogFile &copy)
   } else {
     m_log = nullptr;
   }
+  if (copy.m_columnar) {
+    m_columnar = new Columnar;
+  }
 
   Debug("log-file", "exiting LogFile copy constructor, m_name=%s, this=%p", m_name, this);
 }
@@ -124,6 +145,8 @@ LogFile::~LogFile()
   // close_file() here ensures that we do not leak file descriptors.
   close_file();
 
+  delete m_direct;
+  delete m_columnar;
   delete m_log;
   ats_free(m_header);
   ats_free(m_name);
@@ -235,11 +258,15 @@ LogFile::open_file()
   // file.
   //
   if (!file_exists) {
-    if (m_file_format != LOG_FILE_BINARY && m_header && m_log) {
+    if (m_file_format != LOG_FILE_BINARY && m_file_format != LOG_FILE_COLUMNAR && m_header && m_log) {
       Debug("log-file", "writing header to LogFile %s", m_name);
       writeln(m_header, strlen(m_header), fileno(m_log->m_fp), m_name);
     }
+    if (m_columnar) {
+      m_columnar->new_file = true;
+    }
   }
+  open_direct();
 
   RecIncrRawStat(log_rsb, this_thread()->mutex->thread_holding, log_stat_log_files_open_stat, 1);
 
@@ -266,6 +293,8 @@ LogFile::close_file()
       }
       m_fd = -1;
     } else if (m_log) {
+      columnar_finish();
+      close_direct();
       if (m_log->close_file()) {
         Error("Error closing LogFile %s: %s.", m_log->get_name(), strerror(errno));
       } else {
@@ -375,6 +404,8 @@ LogFile::roll(long interval_start, long interval_end, bool reopen_after_rolling)
     // Since these two methods of using BaseLogFile are not compatible, we perform the logging log file specific
     // close file operation here within the containing LogFile object.
     if (m_log->roll(interval_start, interval_end)) {
+      columnar_finish();
+      close_direct();
       if (m_log->close_file()) {
         Error("Error closing LogFile %s: %s.", m_log->get_name(), strerror(errno));
       }
@@ -382,6 +413,7 @@ LogFile::roll(long interval_start, long interval_end, bool reopen_after_rolling)
       if (reopen_after_rolling) {
         /* If we re-open now log file will be created even if there is nothing being logged */
         m_log->open_file();
+        open_direct();
       }
 
       return 1;
@@ -489,6 +521,9 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
   } else if (m_file_format == LOG_FILE_ASCII || m_file_format == LOG_FILE_PIPE) {
     write_ascii_logbuffer3(buffer_header);
     ret = 0;
+  } else if (m_file_format == LOG_FILE_COLUMNAR) {
+    write_columnar_logbuffer(buffer_header);
+    ret = 0;
   } else {
     Note("Cannot write LogBuffer to LogFile %s; invalid file format: %d", m_name, m_file_format);
   }
@@ -670,6 +705,164 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
   return total_bytes;
 }
 
+/*-------------------------------------------------------------------------
+  LogFile::write_columnar_logbuffer
+
+  This routine encodes the entries of the given LogBuffer as a record batch
+  of the Arrow stream of a columnar file, and hands the message to the flush
+  thread, which compresses it as it writes it. The return value is the number
+  of bytes of the message.
+  -------------------------------------------------------------------------*/
+
+int
+LogFile::write_columnar_logbuffer(LogBufferHeader *buffer_header)
+{
+  ink_assert(m_columnar != nullptr);
+
+  {
+    std::lock_guard<std::mutex> lock(m_columnar->mutex);
+    if (!m_columnar->ready) {
+      if (!m_columnar->fields.init(buffer_header)) {
+        Note("Cannot write LogBuffer to LogFile %s; its format has no columnar layout", m_name);
+        return 0;
+      }
+      LogColumnarIPC::schema_message(m_columnar->fields.schema(), m_columnar->schema);
+      m_columnar->ready = true;
+    }
+  }
+
+  LogColumnarBatch batch = m_columnar->fields.schema();
+  if (int dropped = m_columnar->fields.encode(buffer_header, batch); dropped > 0) {
+    Note("Skipped %d entries of a LogBuffer for LogFile %s, not of its columnar layout", dropped, m_name);
+  }
+  if (batch.rows() == 0) {
+    return 0;
+  }
+
+  std::string message;
+  LogColumnarIPC::batch_message(batch, message);
+  char *data = static_cast<char *>(ats_malloc(message.size()));
+  memcpy(data, message.data(), message.size());
+
+  LogFlushData *flush_data = new LogFlushData(this, data, message.size());
+  ProxyMutex *mutex        = this_thread()->mutex.get();
+
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_num_flush_to_disk_stat, batch.rows());
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_flush_to_disk_stat, message.size());
+
+  ink_atomiclist_push(Log::flush_data_list, flush_data);
+  Log::flush_notify->signal();
+
+  return message.size();
+}
+
+/*-------------------------------------------------------------------------
+  LogFile::columnar_compress
+
+  Compress a message of a columnar file, after the schema if the file is
+  new, for the flush thread to write. The stream is flushed at the end of
+  each message, so that what is written can be read before the file rolls.
+  -------------------------------------------------------------------------*/
+
+bool
+LogFile::columnar_compress(const char *data, int len, std::string &out)
+{
+  out.clear();
+  if (m_columnar->new_file) {
+    std::lock_guard<std::mutex> lock(m_columnar->mutex);
+    if (!m_columnar->compressor.compress(m_columnar->schema.data(), m_columnar->schema.size(), out)) {
+      return false;
+    }
+    m_columnar->new_file = false;
+  }
+  return m_columnar->compressor.compress(data, len, out);
+}
+
+/*-------------------------------------------------------------------------
+  LogFile::columnar_finish
+
+  End the zstd frame of a columnar file that is about to be closed.
+  -------------------------------------------------------------------------*/
+
+void
+LogFile::columnar_finish()
+{
+  std::string out;
+  int fd = get_fd();
+
+  if (m_columnar == nullptr || !m_columnar->compressor.in_frame() || fd < 0) {
+    return;
+  }
+  if (m_columnar->compressor.compress(nullptr, 0, out, true)) {
+    for (size_t written = 0; written < out.size();) {
+      ssize_t len = write_data(out.data() + written, out.size() - written);
+      if (len < 0) {
+        Error("Failed to end the compressed stream of %s: %s", m_name, strerror(errno));
+        break;
+      }
+      written += len;
+    }
+  }
+}
+
+/*-------------------------------------------------------------------------
+  LogFile::open_direct
+
+  With proxy.config.log.direct_io, open the file just opened again with
+  O_DIRECT for the flush thread to write it through. If the file system does
+  not support O_DIRECT, the file is written as usual.
+  -------------------------------------------------------------------------*/
+
+void
+LogFile::open_direct()
+{
+  static bool unsupported_noted = false;
+
+  if (!Log::config->direct_io || m_file_format == LOG_FILE_PIPE || m_log == nullptr) {
+    return;
+  }
+  if (m_direct == nullptr) {
+    m_direct = new LogDirectWriter;
+  }
+  if (!m_direct->open(m_name)) {
+    if (errno != EINVAL) {
+      Warning("Could not open LogFile %s with O_DIRECT, writing it as usual: %s", m_name, strerror(errno));
+    } else if (!unsupported_noted) {
+      Note("The file system of LogFile %s does not support O_DIRECT, writing it as usual", m_name);
+      unsupported_noted = true;
+    }
+    delete m_direct;
+    m_direct = nullptr;
+  }
+}
+
+void
+LogFile::close_direct()
+{
+  if (m_direct) {
+    sync_direct();
+    delete m_direct;
+    m_direct = nullptr;
+  }
+}
+
+ssize_t
+LogFile::write_data(const char *data, size_t len)
+{
+  if (m_direct) {
+    return m_direct->write(data, len);
+  }
+  return ::write(get_fd(), data, len);
+}
+
+void
+LogFile::sync_direct()
+{
+  if (m_direct && !m_direct->sync()) {
+    Error("Failed to write log to %s: %s", m_name, strerror(errno));
+  }
+}
+
 bool
 LogFile::rolled_logfile(char *file)
 {
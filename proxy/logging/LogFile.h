@@ -25,6 +25,7 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <string>
 
 #include "tscore/ink_platform.h"
 #include "LogBufferSink.h"
@@ -34,6 +35,7 @@ struct LogBufferHeader;
 class LogObject;
 class BaseLogFile;
 class BaseMetaInfo;
+class LogDirectWriter;
 
 /*-------------------------------------------------------------------------
   LogFile
@@ -86,11 +88,22 @@ public:
   const char *
   get_format_name() const
   {
-    return (m_file_format == LOG_FILE_BINARY ? "binary" : (m_file_format == LOG_FILE_PIPE ? "ascii_pipe" : "ascii"));
+    switch (m_file_format) {
+    case LOG_FILE_BINARY:
+      return "binary";
+    case LOG_FILE_PIPE:
+      return "ascii_pipe";
+    case LOG_FILE_COLUMNAR:
+      return "columnar";
+    default:
+      return "ascii";
+    }
   }
 
   static int write_ascii_logbuffer(LogBufferHeader *buffer_header, int fd, const char *path, const char *alt_format = nullptr);
   int write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_format = nullptr);
+  int write_columnar_logbuffer(LogBufferHeader *buffer_header);
+  bool columnar_compress(const char *data, int len, std::string &out);
   static bool rolled_logfile(char *file);
   static bool exists(const char *pathname);
 
@@ -114,6 +127,10 @@ public:
   void check_fd();
   int get_fd();
   static int writeln(char *data, int len, int fd, const char *path);
+  /// Write @a len bytes of @a data to the open file, as ::write() does, staged with O_DIRECT if it was opened so.
+  ssize_t write_data(const char *data, size_t len);
+  /// Write out what is staged with O_DIRECT, so the file has all that was written to it.
+  void sync_direct();
 
 public:
   LogFileFormat m_file_format;
@@ -130,6 +147,15 @@ public:
   int m_pipe_buffer_size;     // this is the size of the pipe buffer set by fcntl
   int m_fd;                   // this could back m_log or a pipe, depending on the situation
 
+private:
+  struct Columnar;
+  Columnar *m_columnar = nullptr; // of a columnar file, the layout learned and the compressed stream
+  void columnar_finish();
+
+  LogDirectWriter *m_direct = nullptr; // of proxy.config.log.direct_io, what is written bypasses the page cache
+  void open_direct();
+  void close_direct();
+
 public:
   Link<LogFile> link;
   // noncopyable
@@ -0,0 +1,441 @@
+/** @file
+
+  A log buffer sink that ships the buffers of a log object to a collector over the network
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_inet.h"
+
+#include "LogNetSink.h"
+#include "LogBuffer.h"
+#include "LogConfig.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+namespace
+{
+// the compression level of a frame, fast as a frame is compressed on the thread of the sink
+constexpr int LOG_NET_ZSTD_LEVEL = 1;
+// the time a connection or a write may take before the collector is taken to be down
+constexpr int LOG_NET_IO_TIMEOUT_SEC = 5;
+constexpr std::chrono::seconds LOG_NET_MAX_BACKOFF{30};
+
+void
+put_uint32(char *p, uint32_t v)
+{
+  v = htonl(v);
+  memcpy(p, &v, sizeof(v));
+}
+} // namespace
+
+bool
+LogNetSink::Options::operator==(const Options &rhs) const
+{
+  return host == rhs.host && port == rhs.port && protocol == rhs.protocol && compress == rhs.compress && ca_file == rhs.ca_file &&
+         verify == rhs.verify && queue_limit == rhs.queue_limit && batch_size == rhs.batch_size &&
+         batch_interval_ms == rhs.batch_interval_ms;
+}
+
+LogNetSink::LogNetSink(const char *name, const Options &options) : m_name(name), m_options(options)
+{
+  if (m_options.protocol == UDP) {
+    m_options.batch_size = std::min<int64_t>(m_options.batch_size, UDP_FRAME_LIMIT - FRAME_HEADER_SIZE);
+  }
+#ifndef HAVE_ZSTD_H
+  if (m_options.compress) {
+    Warning("log collector %s:%d of %s: this build has no zstd, the frames are not compressed", m_options.host.c_str(),
+            m_options.port, m_name.c_str());
+    m_options.compress = false;
+  }
+#endif
+}
+
+LogNetSink::~LogNetSink()
+{
+  bool started;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop  = true;
+    started = m_started;
+  }
+  m_cond.notify_one();
+  if (started) {
+    ink_thread_join(m_thread);
+  }
+
+  // what the thread did not send
+  for (LogBuffer *lb : m_queue) {
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_num_lost_before_sent_to_network_stat, lb->header()->entry_count);
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_lost_before_sent_to_network_stat, lb->header()->byte_count);
+    LogBuffer::destroy(lb);
+  }
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_network_queue_bytes_stat, -m_queued_bytes);
+
+  disconnect();
+  if (m_ssl_ctx) {
+    SSL_CTX_free(m_ssl_ctx);
+  }
+}
+
+void
+LogNetSink::frame(const char *payload, size_t len, uint32_t buffers, bool compressed, std::string &out)
+{
+  char header[FRAME_HEADER_SIZE] = {'A', 'T', 'S', 'L', 1, static_cast<char>(compressed ? 1 : 0), 0, 0};
+
+  put_uint32(header + 8, static_cast<uint32_t>(len));
+  put_uint32(header + 12, buffers);
+  out.append(header, sizeof(header));
+  out.append(payload, len);
+}
+
+/*-------------------------------------------------------------------------
+  LogNetSink::preproc_and_try_delete
+
+  Queue the buffer for the thread of the sink, which starts with the first
+  buffer so that a sink of a configuration that is not used costs nothing.
+  -------------------------------------------------------------------------*/
+int
+LogNetSink::preproc_and_try_delete(LogBuffer *lb)
+{
+  if (lb == nullptr) {
+    Note("Cannot send LogBuffer to the collector of %s; LogBuffer is NULL", m_name.c_str());
+    return -1;
+  }
+
+  ink_atomic_increment(&lb->m_references, 1);
+
+  LogBufferHeader *buffer_header = lb->header();
+  if (buffer_header == nullptr || buffer_header->entry_count == 0) {
+    LogBuffer::destroy(lb);
+    return -1;
+  }
+
+  int64_t bytes = buffer_header->byte_count;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queued_bytes + bytes > m_options.queue_limit) {
+      Debug("log-net", "queue of %s is full, dropping a buffer of %" PRId64 " bytes", m_name.c_str(), bytes);
+      RecIncrGlobalRawStatSum(log_rsb, log_stat_num_lost_before_sent_to_network_stat, buffer_header->entry_count);
+      RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_lost_before_sent_to_network_stat, bytes);
+      LogBuffer::destroy(lb);
+      return -1;
+    }
+
+    if (m_queue.empty()) {
+      m_oldest = Clock::now();
+    }
+    m_queue.push_back(lb);
+    m_queued_bytes += bytes;
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_network_queue_bytes_stat, bytes);
+
+    if (!m_started) {
+      m_started = true;
+      ink_thread_create(&m_thread, &LogNetSink::thread_main, this, 0, 0, nullptr);
+    }
+  }
+  m_cond.notify_one();
+
+  return 0;
+}
+
+void *
+LogNetSink::thread_main(void *arg)
+{
+  ink_set_thread_name("[LOG_NET]");
+  static_cast<LogNetSink *>(arg)->run();
+  return nullptr;
+}
+
+void
+LogNetSink::run()
+{
+  std::string payload;
+  std::vector<LogBuffer *> batch;
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true) {
+    if (m_queue.empty()) {
+      if (m_stop) {
+        break;
+      }
+      m_cond.wait(lock);
+      continue;
+    }
+
+    if (m_stop) {
+      // send what is left only while the collector is up, the rest is dropped by the destructor
+      if (m_fd < 0) {
+        break;
+      }
+    } else if (m_queued_bytes < m_options.batch_size) {
+      // wait for a full batch, or for the oldest buffer to have waited long enough
+      auto deadline = m_oldest + std::chrono::milliseconds(m_options.batch_interval_ms);
+      m_cond.wait_until(lock, deadline, [this] { return m_stop || m_queued_bytes >= m_options.batch_size; });
+      if (m_stop) {
+        continue;
+      }
+    }
+
+    int64_t bytes   = 0;
+    int64_t entries = 0;
+    while (!m_queue.empty()) {
+      LogBuffer *lb = m_queue.front();
+      int64_t n     = lb->header()->byte_count;
+      if (!batch.empty() && bytes + n > m_options.batch_size) {
+        break;
+      }
+      m_queue.pop_front();
+      batch.push_back(lb);
+      bytes += n;
+      entries += lb->header()->entry_count;
+    }
+    m_queued_bytes -= bytes;
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_network_queue_bytes_stat, -bytes);
+    if (!m_queue.empty()) {
+      m_oldest = Clock::now();
+    }
+    lock.unlock();
+
+    payload.clear();
+    for (LogBuffer *lb : batch) {
+      payload.append(reinterpret_cast<char *>(lb->header()), lb->header()->byte_count);
+      LogBuffer::destroy(lb);
+    }
+    send_batch(payload, batch.size(), entries);
+    batch.clear();
+
+    lock.lock();
+  }
+}
+
+void
+LogNetSink::send_batch(std::string &payload, uint32_t buffers, int64_t entries)
+{
+  bool compressed = false;
+
+#ifdef HAVE_ZSTD_H
+  if (m_options.compress) {
+    m_compressed.resize(ZSTD_compressBound(payload.size()));
+    size_t n = ZSTD_compress(m_compressed.data(), m_compressed.size(), payload.data(), payload.size(), LOG_NET_ZSTD_LEVEL);
+    if (!ZSTD_isError(n)) {
+      m_compressed.resize(n);
+      compressed = true;
+    }
+  }
+#endif
+
+  const std::string &data = compressed ? m_compressed : payload;
+  m_frame.clear();
+  frame(data.data(), data.size(), buffers, compressed, m_frame);
+
+  if (m_options.protocol == UDP && m_frame.size() > static_cast<size_t>(UDP_FRAME_LIMIT)) {
+    Debug("log-net", "frame of %zu bytes of %s is too large for a datagram, dropped", m_frame.size(), m_name.c_str());
+    drop(entries, payload.size());
+    return;
+  }
+
+  if (m_fd < 0 && !connect_collector()) {
+    drop(entries, payload.size());
+    return;
+  }
+
+  if (!write_frame(m_frame)) {
+    if (!m_failed) {
+      Warning("log collector %s:%d of %s: write failed: %s", m_options.host.c_str(), m_options.port, m_name.c_str(),
+              strerror(errno));
+      m_failed = true;
+    }
+    disconnect();
+    m_retry = Clock::now() + m_backoff;
+    drop(entries, payload.size());
+    return;
+  }
+
+  if (m_failed) {
+    Note("log collector %s:%d of %s: sending again", m_options.host.c_str(), m_options.port, m_name.c_str());
+    m_failed = false;
+  }
+  m_backoff = std::chrono::seconds(1);
+
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_num_sent_to_network_stat, entries);
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_sent_to_network_stat, m_frame.size());
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_batches_sent_to_network_stat, 1);
+}
+
+void
+LogNetSink::drop(int64_t entries, int64_t bytes)
+{
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_num_lost_before_sent_to_network_stat, entries);
+  RecIncrGlobalRawStatSum(log_rsb, log_stat_bytes_lost_before_sent_to_network_stat, bytes);
+}
+
+/*-------------------------------------------------------------------------
+  LogNetSink::connect_collector
+
+  Connect to the collector, unless the last attempt failed too recently, in
+  which case the batch is dropped rather than kept, so that the queue keeps
+  taking the buffers that are the most recent.
+  -------------------------------------------------------------------------*/
+bool
+LogNetSink::connect_collector()
+{
+  if (Clock::now() < m_retry) {
+    return false;
+  }
+
+  auto fail = [this](const char *what, const char *why) {
+    if (!m_failed) {
+      Warning("log collector %s:%d of %s: %s: %s", m_options.host.c_str(), m_options.port, m_name.c_str(), what, why);
+      m_failed = true;
+    }
+    disconnect();
+    m_retry   = Clock::now() + m_backoff;
+    m_backoff = std::min(m_backoff * 2, LOG_NET_MAX_BACKOFF);
+    RecIncrGlobalRawStatSum(log_rsb, log_stat_network_connect_failures_stat, 1);
+    return false;
+  };
+
+  addrinfo hints;
+  addrinfo *ai = nullptr;
+  char port[8];
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = m_options.protocol == UDP ? SOCK_DGRAM : SOCK_STREAM;
+  snprintf(port, sizeof(port), "%d", m_options.port);
+  if (int e = getaddrinfo(m_options.host.c_str(), port, &hints, &ai); e != 0) {
+    return fail("cannot resolve", gai_strerror(e));
+  }
+
+  for (addrinfo *p = ai; p; p = p->ai_next) {
+    m_fd = socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC, p->ai_protocol);
+    if (m_fd < 0) {
+      continue;
+    }
+    timeval tv = {LOG_NET_IO_TIMEOUT_SEC, 0};
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    // connect() of a blocking socket is bounded by the send timeout on Linux
+    if (::connect(m_fd, p->ai_addr, p->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  freeaddrinfo(ai);
+  if (m_fd < 0) {
+    return fail("cannot connect", strerror(errno));
+  }
+
+  if (m_options.protocol == TLS) {
+    if (!m_ssl_ctx) {
+      m_ssl_ctx = SSL_CTX_new(TLS_client_method());
+      if (!m_ssl_ctx) {
+        return fail("cannot create the TLS context", "out of memory");
+      }
+      SSL_CTX_set_min_proto_version(m_ssl_ctx, TLS1_2_VERSION);
+      if (!m_options.ca_file.empty()) {
+        if (!SSL_CTX_load_verify_locations(m_ssl_ctx, m_options.ca_file.c_str(), nullptr)) {
+          Error("log collector of %s: cannot load the CA certificates of %s", m_name.c_str(), m_options.ca_file.c_str());
+        }
+      } else {
+        SSL_CTX_set_default_verify_paths(m_ssl_ctx);
+      }
+      SSL_CTX_set_verify(m_ssl_ctx, m_options.verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+    }
+
+    m_ssl = SSL_new(m_ssl_ctx);
+    if (!m_ssl) {
+      return fail("cannot create the TLS session", "out of memory");
+    }
+    SSL_set_fd(m_ssl, m_fd);
+    SSL_set_tlsext_host_name(m_ssl, m_options.host.c_str());
+    if (m_options.verify) {
+      SSL_set_hostflags(m_ssl, X509_CHECK_FLAG_NO_PARTIAL_WILDCARDS);
+      SSL_set1_host(m_ssl, m_options.host.c_str());
+    }
+    if (SSL_connect(m_ssl) != 1) {
+      char why[256];
+      ERR_error_string_n(ERR_get_error(), why, sizeof(why));
+      ERR_clear_error();
+      return fail("TLS handshake failed", why);
+    }
+  }
+
+  Debug("log-net", "connected to the collector %s:%d of %s", m_options.host.c_str(), m_options.port, m_name.c_str());
+  return true;
+}
+
+bool
+LogNetSink::write_frame(const std::string &frame)
+{
+  if (m_options.protocol == UDP) {
+    return ::send(m_fd, frame.data(), frame.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(frame.size());
+  }
+
+  size_t written = 0;
+  while (written < frame.size()) {
+    ssize_t n;
+    if (m_ssl) {
+      n = SSL_write(m_ssl, frame.data() + written, frame.size() - written);
+      if (n <= 0) {
+        ERR_clear_error();
+        errno = EIO;
+        return false;
+      }
+    } else {
+      n = ::send(m_fd, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+    }
+    written += n;
+  }
+  return true;
+}
+
+void
+LogNetSink::disconnect()
+{
+  if (m_ssl) {
+    SSL_free(m_ssl);
+    m_ssl = nullptr;
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
@@ -0,0 +1,131 @@
+/** @file
+
+  A log buffer sink that ships the buffers of a log object to a collector over the network
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "tscore/ink_thread.h"
+#include "tscore/Ptr.h"
+#include "LogBufferSink.h"
+#include "LogLimits.h"
+
+/*-------------------------------------------------------------------------
+  LogNetSink
+
+  Ships the buffers of a log object to a collector instead of writing them
+  to a file. The preprocess thread queues a buffer as it is, and a thread of
+  the sink takes the queue in batches, each sent as one frame:
+
+    offset  size
+         0     4  "ATSL"
+         4     1  version, 1
+         5     1  flags, 1 if the payload is zstd compressed
+         6     2  0
+         8     4  the length of the payload, in network order
+        12     4  the number of log buffers of the payload, in network order
+        16        the payload, the log buffers as they are in a binary log file
+
+  Over TCP and TLS the frames follow each other on one connection; over UDP
+  each frame is a datagram. The queue is bounded, and a buffer that does not
+  fit, or a batch that cannot be sent, is dropped and counted in the stats.
+  -------------------------------------------------------------------------*/
+class LogNetSink : public LogBufferSink, public RefCountObj
+{
+public:
+  enum Protocol { TCP, TLS, UDP };
+
+  struct Options {
+    std::string host;
+    int port          = 0;
+    Protocol protocol = TCP;
+    bool compress     = true;
+    std::string ca_file; ///< of TLS, the system default certificates if empty
+    bool verify           = true;
+    int64_t queue_limit   = 16 * LOG_MEGABYTE; ///< bytes of buffers waiting to be sent
+    int64_t batch_size    = 64 * LOG_KILOBYTE; ///< bytes of buffers of a frame, at most
+    int batch_interval_ms = 250;               ///< to wait for a batch to fill
+
+    bool operator==(const Options &rhs) const;
+  };
+
+  static constexpr int FRAME_HEADER_SIZE = 16;
+  static constexpr int UDP_FRAME_LIMIT   = 65507; ///< the largest UDP payload of IPv4
+
+  LogNetSink(const char *name, const Options &options);
+  ~LogNetSink() override;
+
+  int preproc_and_try_delete(LogBuffer *lb) override;
+
+  const Options &
+  options() const
+  {
+    return m_options;
+  }
+
+  /// Append the frame of @a payload of @a buffers log buffers to @a out.
+  static void frame(const char *payload, size_t len, uint32_t buffers, bool compressed, std::string &out);
+
+  // noncopyable
+  LogNetSink(const LogNetSink &) = delete;
+  LogNetSink &operator=(const LogNetSink &) = delete;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static void *thread_main(void *arg);
+  void run();
+  void send_batch(std::string &payload, uint32_t buffers, int64_t entries);
+  bool connect_collector();
+  bool write_frame(const std::string &frame);
+  void disconnect();
+  void drop(int64_t entries, int64_t bytes);
+
+  std::string m_name;
+  Options m_options;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<LogBuffer *> m_queue;
+  int64_t m_queued_bytes = 0;
+  Clock::time_point m_oldest; ///< when the first buffer of the queue was queued
+  bool m_started         = false;
+  bool m_stop            = false;
+  ink_thread m_thread;
+
+  // of the thread of the sink only
+  int m_fd            = -1;
+  SSL_CTX *m_ssl_ctx  = nullptr;
+  SSL *m_ssl          = nullptr;
+  bool m_failed       = false; ///< whether the last connection or send failed, to report a failure once
+  Clock::time_point m_retry;   ///< when to connect again after a failure
+  std::chrono::seconds m_backoff{1};
+  std::string m_compressed;
+  std::string m_frame;
+};
@@ -114,6 +114,8 @@ LogObject::LogObject(LogConfig *cfg, const LogFormat *format, const char *log_di
     m_flags |= BINARY;
   } else if (file_format == LOG_FILE_PIPE) {
     m_flags |= WRITES_TO_PIPE;
+  } else if (file_format == LOG_FILE_COLUMNAR) {
+    m_flags |= COLUMNAR;
   }
 
   generate_filenames(log_dir, basename, file_format);
@@ -131,6 +133,7 @@ LogObject::LogObject(LogConfig *cfg, const LogFormat *format, const char *log_di
   LogBuffer *b = new LogBuffer(cfg, this, cfg->log_buffer_size);
   ink_assert(b);
   SET_FREELIST_POINTER_VERSION(m_log_buffer, b, 0);
+  _init_thread_buffers(cfg);
 
   _setup_rolling(cfg, rolling_enabled, rolling_interval_sec, rolling_offset_hr, rolling_size_mb);
 
@@ -173,12 +176,15 @@ LogObject::LogObject(LogObject &rhs)
   for (filter = rhs.m_filter_list.first(); filter; filter = rhs.m_filter_list.next(filter)) {
     add_filter(filter);
   }
+  m_sampler  = rhs.m_sampler;
+  m_net_sink = rhs.m_net_sink;
 
   // copy gets a fresh log buffer
   //
   LogBuffer *b = new LogBuffer(Log::config, this, Log::config->log_buffer_size);
   ink_assert(b);
   SET_FREELIST_POINTER_VERSION(m_log_buffer, b, 0);
+  _init_thread_buffers(Log::config);
 
   Debug("log-config",
         "exiting LogObject copy constructor, "
@@ -197,6 +203,10 @@ LogObject::~LogObject()
   delete m_format;
   delete[] m_buffer_manager;
   delete static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
+  for (int i = 0; i < m_thread_buffers_count; i++) {
+    delete m_thread_buffers[i].buffer.load();
+  }
+  delete[] m_thread_buffers;
 }
 
 //-----------------------------------------------------------------------------
@@ -244,6 +254,10 @@ LogObject::generate_filenames(const char *log_dir, const char *basename, LogFile
       ext     = LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION;
       ext_len = 5;
       break;
+    case LOG_FILE_COLUMNAR:
+      ext     = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+      ext_len = 11;
+      break;
     default:
       ink_assert(!"unknown file format");
     }
@@ -479,6 +493,99 @@ LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
   return buffer;
 }
 
+void
+LogObject::_init_thread_buffers(const LogConfig *cfg)
+{
+  // the threads that exist when the object is configured, the event threads started later share the work buffer
+  if (cfg->thread_buffers && eventProcessor.n_ethreads > 0) {
+    m_thread_buffers_count = eventProcessor.n_ethreads;
+    m_thread_buffers       = new ThreadBuffer[m_thread_buffers_count];
+  }
+}
+
+LogObject::ThreadBuffer *
+LogObject::_thread_buffer()
+{
+  EThread *t = this_ethread();
+
+  // dedicated threads and threads of plugins have no id
+  if (t == nullptr || t->id < 0 || t->id >= m_thread_buffers_count) {
+    return nullptr;
+  }
+  return &m_thread_buffers[t->id];
+}
+
+LogBuffer *
+LogObject::_checkout_thread_write(ThreadBuffer *tb, size_t *write_offset, size_t bytes_needed)
+{
+  // only this thread puts a buffer in its slot, the exchange is never contended but by the periodic expiration
+  LogBuffer *buffer = tb->buffer.exchange(nullptr, std::memory_order_acquire);
+
+  for (;;) {
+    if (buffer == nullptr) {
+      buffer = new LogBuffer(Log::config, this, Log::config->log_buffer_size);
+    }
+
+    switch (buffer->checkout_write_private(write_offset, bytes_needed)) {
+    case LogBuffer::LB_OK:
+      return buffer;
+
+    case LogBuffer::LB_BUFFER_TOO_SMALL:
+      // return a null buffer to signal the caller that this transaction cannot be logged
+      _checkin_thread_write(tb, buffer);
+      return nullptr;
+
+    default:
+      // no more room, flush it and start a new one
+      _flush_thread_buffer(buffer);
+      buffer = nullptr;
+      break;
+    }
+  }
+}
+
+void
+LogObject::_checkin_thread_write(ThreadBuffer *tb, LogBuffer *buffer)
+{
+  // the periodic expiration puts back a buffer that has not expired, if that one came back while this one was written
+  LogBuffer *other = tb->buffer.exchange(buffer, std::memory_order_release);
+  if (other != nullptr) {
+    _flush_thread_buffer(other);
+  }
+}
+
+void
+LogObject::_flush_thread_buffer(LogBuffer *buffer)
+{
+  if (buffer->m_state.s.num_entries == 0) {
+    delete buffer;
+    return;
+  }
+
+  int idx = add_to_flush_queue(buffer);
+  Debug("log-logbuffer", "adding thread buffer %d to flush list", buffer->get_id());
+  Log::preproc_notify[idx].signal();
+}
+
+void
+LogObject::_flush_thread_buffers(long time_now)
+{
+  // flush the buffers that expired before 'time_now', or every buffer if it is 0. A buffer that is being written is not in
+  // its slot, its thread flushes it once it is full or it is found again here.
+  for (int i = 0; i < m_thread_buffers_count; i++) {
+    ThreadBuffer *tb  = &m_thread_buffers[i];
+    LogBuffer *buffer = tb->buffer.exchange(nullptr, std::memory_order_acquire);
+    if (buffer == nullptr) {
+      continue;
+    }
+    if (time_now == 0 || time_now > buffer->expiration_time()) {
+      _flush_thread_buffer(buffer);
+    } else {
+      _checkin_thread_write(tb, buffer);
+    }
+  }
+}
+
 int
 LogObject::va_log(LogAccess *lad, const char *fmt, va_list ap)
 {
@@ -527,7 +634,7 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
   // log to a pipe even if space is exhausted since pipe uses no space
   // likewise, send data to a remote client even if local space is exhausted
   // (if there is a remote client, m_logFile will be NULL
-  if (Log::config->logging_space_exhausted && !writes_to_pipe() && m_logFile) {
+  if (Log::config->logging_space_exhausted && !writes_to_pipe() && !writes_to_network() && m_logFile) {
     Debug("log", "logging space exhausted, can't write to:%s, drop this entry", m_logFile->get_name());
     return Log::FULL;
   }
@@ -543,6 +650,11 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
     return Log::SKIP;
   }
 
+  if (lad && m_sampler && !m_sampler->keep_this_entry(lad)) {
+    Debug("log-sample", "entry not sampled, skipping ...");
+    return Log::SKIP;
+  }
+
   if (lad && m_filter_list.wipe_this_entry(lad)) {
     Debug("log", "entry wiped, ...");
   }
@@ -592,8 +704,9 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
     return Log::SKIP;
   }
 
-  // Now try to place this entry in the current LogBuffer.
-  buffer = _checkout_write(&offset, bytes_needed);
+  // Now try to place this entry in the current LogBuffer, the one of this thread if it has one.
+  ThreadBuffer *tb = _thread_buffer();
+  buffer           = tb ? _checkout_thread_write(tb, &offset, bytes_needed) : _checkout_write(&offset, bytes_needed);
 
   if (!buffer) {
     Note("Skipping the current log entry for %s because its size (%zu) exceeds "
@@ -623,7 +736,11 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
     memset(dst + text_entry.size(), 0, bytes_needed - text_entry.size());
   }
 
-  buffer->checkin_write(offset);
+  if (tb) {
+    _checkin_thread_write(tb, buffer);
+  } else {
+    buffer->checkin_write(offset);
+  }
 
   return Log::LOG_OK;
 }
@@ -761,8 +878,8 @@ LogObject::_roll_files(long last_roll_time, long time_now)
   unsigned num_rolled = 0;
 
   if (m_logFile) {
-    // no need to roll if object writes to a pipe
-    if (!writes_to_pipe()) {
+    // no need to roll if object writes to a pipe or a collector
+    if (!writes_to_pipe() && !writes_to_network()) {
       num_rolled += m_logFile->roll(last_roll_time, time_now, m_reopen_after_rolling);
 
       if (Log::config->auto_delete_rolled_files && m_max_rolled > 0) {
@@ -780,8 +897,9 @@ LogObject::check_buffer_expiration(long time_now)
 {
   LogBuffer *b = static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
   if (b && time_now > b->expiration_time()) {
-    force_new_buffer();
+    _checkout_write(nullptr, 0);
   }
+  _flush_thread_buffers(time_now);
 }
 
 /*-------------------------------------------------------------------------
@@ -877,7 +995,11 @@ LogObjectManager::_manage_object(LogObject *log_object, bool is_api_object, int
   int retVal = _solve_internal_filename_conflicts(log_object, maxConflicts);
 
   if (retVal == NO_FILENAME_CONFLICTS) {
-    if (retVal = _solve_filename_conflicts(log_object, maxConflicts), retVal == NO_FILENAME_CONFLICTS) {
+    // an object sent to a collector has no file to conflict with
+    if (!log_object->writes_to_network()) {
+      retVal = _solve_filename_conflicts(log_object, maxConflicts);
+    }
+    if (retVal == NO_FILENAME_CONFLICTS) {
       // do filesystem checks
       //
       {
@@ -1245,7 +1367,9 @@ void
 LogObjectManager::reopen_moved_log_files()
 {
   for (auto &_object : this->_objects) {
-    _object->m_logFile->reopen_if_moved();
+    if (!_object->writes_to_network()) {
+      _object->m_logFile->reopen_if_moved();
+    }
   }
 
   ACQUIRE_API_MUTEX("A LogObjectManager::reopen_moved_log_files");
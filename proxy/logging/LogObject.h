@@ -31,6 +31,9 @@
 #include "LogBuffer.h"
 #include "LogAccess.h"
 #include "LogFilter.h"
+#include "LogSampler.h"
+#include "LogNetSink.h"
+#include <atomic>
 #include <vector>
 
 /*-------------------------------------------------------------------------
@@ -48,6 +51,7 @@
 #define LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION ".log"
 #define LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION ".blog"
 #define LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION ".pipe"
+#define LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION ".arrows.zst"
 
 #define FLUSH_ARRAY_SIZE (512 * 4)
 
@@ -88,10 +92,12 @@ public:
     BINARY                   = 1,
     WRITES_TO_PIPE           = 4,
     LOG_OBJECT_FMT_TIMESTAMP = 8, // always format a timestamp into each log line (for raw text logs)
+    COLUMNAR                 = 16,
   };
 
   // BINARY: log is written in binary format (rather than ascii)
   // WRITES_TO_PIPE: object writes to a named pipe rather than to a file
+  // COLUMNAR: log is written as a compressed Arrow stream
 
   LogObject(LogConfig *cfg, const LogFormat *format, const char *log_dir, const char *basename, LogFileFormat file_format,
             const char *header, Log::RollingEnabledValues rolling_enabled, int flush_threads, int rolling_interval_sec = 0,
@@ -103,6 +109,20 @@ public:
   void add_filter(LogFilter *filter, bool copy = true);
   void set_filter_list(const LogFilterList &list, bool copy = true);
 
+  /// Keep only the entries @a sampler keeps, of those the filters accept
+  void
+  set_sampler(LogSampler *sampler)
+  {
+    m_sampler = sampler;
+  }
+
+  /// Send the buffers to the collector of @a sink rather than writing them to the file
+  void
+  set_net_sink(LogNetSink *sink)
+  {
+    m_net_sink = sink;
+  }
+
   inline void
   set_fmt_timestamps()
   {
@@ -144,7 +164,7 @@ public:
       idx = m_buffer_manager_idx++ % m_flush_threads;
     }
 
-    nfb = m_buffer_manager[idx].preproc_buffers(m_logFile.get());
+    nfb = m_buffer_manager[idx].preproc_buffers(m_net_sink ? static_cast<LogBufferSink *>(m_net_sink.get()) : m_logFile.get());
 
     return nfb;
   }
@@ -222,7 +242,12 @@ public:
   inline bool
   writes_to_disk()
   {
-    return (m_logFile && !(m_flags & WRITES_TO_PIPE) ? true : false);
+    return (m_logFile && !(m_flags & WRITES_TO_PIPE) && !m_net_sink ? true : false);
+  }
+  inline bool
+  writes_to_network() const
+  {
+    return m_net_sink ? true : false;
   }
 
   inline unsigned int
@@ -249,6 +274,7 @@ public:
   force_new_buffer()
   {
     _checkout_write(nullptr, 0);
+    _flush_thread_buffers(0);
   }
 
   bool operator==(LogObject &rhs);
@@ -257,6 +283,8 @@ public:
   LogFormat *m_format;
   Ptr<LogFile> m_logFile;
   LogFilterList m_filter_list;
+  Ptr<LogSampler> m_sampler;
+  Ptr<LogNetSink> m_net_sink;
 
 private:
   char *m_basename; // the name of the file associated
@@ -287,6 +315,14 @@ private:
   unsigned m_buffer_manager_idx;
   LogBufferManager *m_buffer_manager;
 
+  // the work buffer of each event thread, see proxy.config.log.thread_buffers. A thread takes its buffer out of the slot
+  // while it writes an entry, so the periodic expiration only ever flushes a buffer nobody writes to.
+  struct alignas(64) ThreadBuffer {
+    std::atomic<LogBuffer *> buffer{nullptr};
+  };
+  ThreadBuffer *m_thread_buffers = nullptr;
+  int m_thread_buffers_count     = 0;
+
   int m_pipe_buffer_size;
 
   void generate_filenames(const char *log_dir, const char *basename, LogFileFormat file_format);
@@ -296,6 +332,13 @@ private:
 
   LogBuffer *_checkout_write(size_t *write_offset, size_t write_size);
 
+  void _init_thread_buffers(const LogConfig *cfg);
+  ThreadBuffer *_thread_buffer();
+  LogBuffer *_checkout_thread_write(ThreadBuffer *tb, size_t *write_offset, size_t write_size);
+  void _checkin_thread_write(ThreadBuffer *tb, LogBuffer *buffer);
+  void _flush_thread_buffer(LogBuffer *buffer);
+  void _flush_thread_buffers(long time_now);
+
   // noncopyable
   LogObject(const LogObject &) = delete;
   LogObject &operator=(const LogObject &) = delete;
@@ -415,6 +458,8 @@ LogObject::operator==(LogObject &old)
 {
   return (get_signature() == old.get_signature() && m_logFile && old.m_logFile &&
           strcmp(m_logFile->get_name(), old.m_logFile->get_name()) == 0 && (m_filter_list == old.m_filter_list) &&
+          (m_sampler ? old.m_sampler && *m_sampler == *old.m_sampler : !old.m_sampler) &&
+          (m_net_sink ? old.m_net_sink && m_net_sink->options() == old.m_net_sink->options() : !old.m_net_sink) &&
           (m_rolling_interval_sec == old.m_rolling_interval_sec && m_rolling_offset_hr == old.m_rolling_offset_hr &&
            m_rolling_size_mb == old.m_rolling_size_mb && m_reopen_after_rolling == old.m_reopen_after_rolling &&
            m_max_rolled == old.m_max_rolled && m_min_rolled == old.m_min_rolled));
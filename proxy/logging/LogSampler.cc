@@ -0,0 +1,205 @@
+/** @file
+
+  Sampling of the entries of a log object
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/HashFNV.h"
+
+#include "LogSampler.h"
+#include "LogAccess.h"
+#include "LogFormat.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// the finalizer of splitmix64, so that the bits of a hash of short, similar keys are spread evenly
+inline uint64_t
+mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// a random value for an entry sampled without a key, from a generator of each thread
+uint64_t
+next_random()
+{
+  thread_local uint64_t state = static_cast<uint64_t>(ink_get_hrtime_internal()) ^ reinterpret_cast<uintptr_t>(&state);
+  state += 0x9e3779b97f4a7c15ULL;
+  return mix(state);
+}
+} // namespace
+
+struct LogSampler::KeepRule {
+  enum Op { EQ, NE, LT, LE, GT, GE };
+
+  LogFieldList field;
+  Op op;
+  int64_t value;
+
+  bool
+  matches(LogAccess *lad)
+  {
+    int64_t v = 0;
+    field.marshal(lad, reinterpret_cast<char *>(&v));
+    switch (op) {
+    case EQ:
+      return v == value;
+    case NE:
+      return v != value;
+    case LT:
+      return v < value;
+    case LE:
+      return v <= value;
+    case GT:
+      return v > value;
+    case GE:
+      return v >= value;
+    }
+    return false;
+  }
+};
+
+LogSampler::LogSampler(double rate) : m_keep_all(rate >= 1.0), m_threshold(rate_threshold(rate))
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "rate=%g", rate);
+  m_description = buf;
+}
+
+LogSampler::~LogSampler() = default;
+
+uint64_t
+LogSampler::rate_threshold(double rate)
+{
+  if (!(rate > 0.0)) {
+    return 0;
+  }
+  if (rate >= 1.0) {
+    return UINT64_MAX;
+  }
+  // 2^64 * rate, which is below 2^64 for any rate below 1
+  return static_cast<uint64_t>(rate * 18446744073709551616.0);
+}
+
+bool
+LogSampler::set_key(const char *symbols)
+{
+  bool contains_aggregates = false;
+
+  m_key.clear();
+  if (LogFormat::parse_symbol_string(symbols, &m_key, &contains_aggregates) == 0 || !m_key.badSymbols().empty() ||
+      contains_aggregates) {
+    m_key.clear();
+    return false;
+  }
+  m_description.append(" key=").append(symbols);
+  return true;
+}
+
+bool
+LogSampler::add_keep_rule(const char *rule)
+{
+  static const struct {
+    const char *name;
+    KeepRule::Op op;
+  } ops[] = {
+    {"==", KeepRule::EQ}, {"!=", KeepRule::NE}, {"<=", KeepRule::LE},
+    {">=", KeepRule::GE}, {"<", KeepRule::LT},  {">", KeepRule::GT},
+  };
+
+  char symbol[256], op[3], *end = nullptr;
+  char value[32];
+  if (sscanf(rule, " %255s %2s %31s", symbol, op, value) != 3) {
+    return false;
+  }
+
+  auto keep = std::make_unique<KeepRule>();
+  auto it   = std::find_if(std::begin(ops), std::end(ops), [&op](const auto &o) { return strcmp(o.name, op) == 0; });
+  if (it == std::end(ops)) {
+    return false;
+  }
+  keep->op = it->op;
+
+  errno       = 0;
+  keep->value = strtoll(value, &end, 10);
+  if (errno != 0 || end == value || *end != '\0') {
+    return false;
+  }
+
+  // the field has to be a single integer, which is what every entry marshals to the same length as an integer
+  bool contains_aggregates = false;
+  if (LogFormat::parse_symbol_string(symbol, &keep->field, &contains_aggregates) != 1 || !keep->field.badSymbols().empty() ||
+      contains_aggregates || keep->field.first()->fixed_marshal_len() != INK_MIN_ALIGN) {
+    return false;
+  }
+
+  m_description.append(" keep=[").append(symbol).append(" ").append(op).append(" ").append(value).append("]");
+  m_keep_rules.push_back(std::move(keep));
+  return true;
+}
+
+uint64_t
+LogSampler::key_hash(LogAccess *lad)
+{
+  char local[512];
+  unsigned len = m_key.marshal_len(lad);
+  char *buf    = len <= sizeof(local) ? local : static_cast<char *>(ats_malloc(len));
+
+  // the padding of a string is not written, and would make the hash of the same values differ
+  memset(buf, 0, len);
+  len = m_key.marshal(lad, buf);
+
+  ATSHash64FNV1a hash;
+  hash.update(buf, len);
+  hash.final();
+
+  if (buf != local) {
+    ats_free(buf);
+  }
+  return mix(hash.get());
+}
+
+bool
+LogSampler::keep_this_entry(LogAccess *lad)
+{
+  if (m_keep_all) {
+    return true;
+  }
+
+  for (auto const &rule : m_keep_rules) {
+    if (rule->matches(lad)) {
+      return true;
+    }
+  }
+
+  return sampled(m_key.first() ? key_hash(lad) : next_random(), m_threshold);
+}
@@ -0,0 +1,100 @@
+/** @file
+
+  Sampling of the entries of a log object
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tscore/Ptr.h"
+#include "LogField.h"
+
+class LogAccess;
+
+/*-------------------------------------------------------------------------
+  LogSampler
+
+  Keeps a fraction of the entries of a log object, decided before an entry
+  is marshalled so that an entry which is not kept costs no more than the
+  decision. An entry is kept if it matches any of the keep rules, such as
+  "pssc >= 500" or "ttms >= 1000", and otherwise with the probability of the
+  rate. If there is a key, the decision is a hash of the values of its fields
+  rather than random, so that all the entries with the same key, say the
+  same client address or request id, are kept or not together.
+
+  A sampler is not changed once the configuration is loaded and may be
+  shared by the copies of a log object.
+  -------------------------------------------------------------------------*/
+class LogSampler : public RefCountObj
+{
+public:
+  explicit LogSampler(double rate);
+  ~LogSampler() override;
+
+  /// Sample by the values of the fields of the comma separated @a symbols. False if one is not a field.
+  bool set_key(const char *symbols);
+  /// Keep every entry matching @a rule, "<field> <op> <integer>" where op is one of == != < <= > >=.
+  /// False if it is not a rule of an integer field.
+  bool add_keep_rule(const char *rule);
+
+  bool keep_this_entry(LogAccess *lad);
+
+  /// the rate, key and rules, as configured
+  const std::string &
+  description() const
+  {
+    return m_description;
+  }
+
+  bool
+  operator==(const LogSampler &rhs) const
+  {
+    return m_description == rhs.m_description;
+  }
+
+  /// Whether an entry of @a hash is kept at the rate of @a threshold.
+  static bool
+  sampled(uint64_t hash, uint64_t threshold)
+  {
+    return hash < threshold;
+  }
+
+  /// The threshold of the hashes kept at @a rate, a fraction of UINT64_MAX.
+  static uint64_t rate_threshold(double rate);
+
+  // noncopyable
+  LogSampler(const LogSampler &rhs) = delete;
+  LogSampler &operator=(const LogSampler &rhs) = delete;
+
+private:
+  struct KeepRule;
+
+  uint64_t key_hash(LogAccess *lad);
+
+  bool m_keep_all;
+  uint64_t m_threshold;
+  LogFieldList m_key;
+  std::vector<std::unique_ptr<KeepRule>> m_keep_rules;
+  std::string m_description;
+};
@@ -121,7 +121,115 @@ std::set<std::string> valid_log_object_keys = {"filename",
                                                "rolling_min_count",
                                                "rolling_max_count",
                                                "rolling_allow_empty",
-                                               "pipe_buffer_size"};
+                                               "pipe_buffer_size",
+                                               "sampling",
+                                               "collector"};
+
+std::set<std::string> valid_sampling_keys = {"rate", "key", "keep"};
+
+std::set<std::string> valid_collector_keys = {"host",        "port",          "protocol",      "compress",         "tls_ca_file",
+                                              "tls_verify",  "queue_size_mb", "batch_size_kb", "batch_interval_ms"};
+
+TsEnumDescriptor COLLECTOR_PROTOCOL = {{{"tcp", LogNetSink::TCP}, {"tls", LogNetSink::TLS}, {"udp", LogNetSink::UDP}}};
+
+// The sink of the "collector" object of a log object
+static Ptr<LogNetSink>
+decodeCollector(const YAML::Node &node, const std::string &filename)
+{
+  if (!node.IsMap()) {
+    throw YAML::ParserException(node.Mark(), "'collector' should be an object");
+  }
+  for (auto const &item : node) {
+    if (valid_collector_keys.count(item.first.as<std::string>()) == 0) {
+      throw YAML::ParserException(item.first.Mark(), "collector: unsupported key '" + item.first.as<std::string>() + "'");
+    }
+  }
+
+  LogNetSink::Options options;
+  if (!node["host"] || !node["port"]) {
+    throw YAML::ParserException(node.Mark(), "collector: missing 'host' or 'port' argument");
+  }
+  options.host = node["host"].as<std::string>();
+  options.port = node["port"].as<int>();
+  if (options.port <= 0 || options.port > 65535) {
+    throw YAML::ParserException(node["port"].Mark(), "collector: invalid 'port'");
+  }
+  if (node["protocol"]) {
+    auto value = node["protocol"].as<std::string>();
+    int p      = COLLECTOR_PROTOCOL.get(value);
+    if (p < 0) {
+      throw YAML::ParserException(node["protocol"].Mark(), "collector: unknown protocol " + value);
+    }
+    options.protocol = static_cast<LogNetSink::Protocol>(p);
+  }
+  if (node["compress"]) {
+    options.compress = node["compress"].as<bool>();
+  }
+  if (node["tls_ca_file"]) {
+    options.ca_file = node["tls_ca_file"].as<std::string>();
+  }
+  if (node["tls_verify"]) {
+    options.verify = node["tls_verify"].as<bool>();
+  }
+  if (node["queue_size_mb"]) {
+    options.queue_limit = node["queue_size_mb"].as<int64_t>() * LOG_MEGABYTE;
+  }
+  if (node["batch_size_kb"]) {
+    options.batch_size = node["batch_size_kb"].as<int64_t>() * LOG_KILOBYTE;
+  }
+  if (node["batch_interval_ms"]) {
+    options.batch_interval_ms = node["batch_interval_ms"].as<int>();
+  }
+  if (options.queue_limit <= 0 || options.batch_size <= 0 || options.batch_interval_ms < 0) {
+    throw YAML::ParserException(node.Mark(), "collector: the queue and batch sizes should be positive");
+  }
+
+  return make_ptr(new LogNetSink(filename.c_str(), options));
+}
+
+// The sampler of the "sampling" object of a log object
+static Ptr<LogSampler>
+decodeSampling(const YAML::Node &node)
+{
+  if (!node.IsMap()) {
+    throw YAML::ParserException(node.Mark(), "'sampling' should be an object");
+  }
+  for (auto const &item : node) {
+    if (valid_sampling_keys.count(item.first.as<std::string>()) == 0) {
+      throw YAML::ParserException(item.first.Mark(), "sampling: unsupported key '" + item.first.as<std::string>() + "'");
+    }
+  }
+
+  if (!node["rate"]) {
+    throw YAML::ParserException(node.Mark(), "sampling: missing 'rate' argument");
+  }
+  double rate = node["rate"].as<double>();
+  if (rate < 0.0 || rate > 1.0) {
+    throw YAML::ParserException(node["rate"].Mark(), "sampling: 'rate' should be between 0 and 1");
+  }
+
+  Ptr<LogSampler> sampler = make_ptr(new LogSampler(rate));
+  if (node["key"]) {
+    auto key = node["key"].as<std::string>();
+    if (!sampler->set_key(key.c_str())) {
+      throw YAML::ParserException(node["key"].Mark(), "sampling: invalid 'key' " + key);
+    }
+  }
+
+  if (auto keep = node["keep"]; keep) {
+    if (!keep.IsSequence()) {
+      throw YAML::ParserException(keep.Mark(), "sampling: 'keep' should be a list");
+    }
+    for (auto const &rule : keep) {
+      auto text = rule.as<std::string>();
+      if (!sampler->add_keep_rule(text.c_str())) {
+        throw YAML::ParserException(rule.Mark(), "sampling: invalid 'keep' rule '" + text + "'");
+      }
+    }
+  }
+
+  return sampler;
+}
 
 LogObject *
 YamlLogConfig::decodeLogObject(const YAML::Node &node)
@@ -161,6 +269,14 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
     file_type        = (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b') ?
                    LOG_FILE_BINARY :
                    (0 == strcasecmp(mode.c_str(), "ascii_pipe") ? LOG_FILE_PIPE : LOG_FILE_ASCII));
+    if (0 == strcasecmp(mode.c_str(), "columnar")) {
+#ifdef HAVE_ZSTD_H
+      file_type = LOG_FILE_COLUMNAR;
+#else
+      Error("Columnar mode of %s needs zstd, which this build does not have; logging in binary mode instead", filename.c_str());
+      file_type = LOG_FILE_BINARY;
+#endif
+    }
   }
 
   int obj_rolling_enabled      = cfg->rolling_enabled;
@@ -206,6 +322,20 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
     Warning("Invalid log rolling value '%d' in log object", obj_rolling_enabled);
   }
 
+  Ptr<LogSampler> sampler;
+  if (node["sampling"]) {
+    sampler = decodeSampling(node["sampling"]);
+  }
+
+  // a log sent to a collector is never written to its file, so there is nothing to roll
+  Ptr<LogNetSink> net_sink;
+  if (node["collector"]) {
+    net_sink                = decodeCollector(node["collector"], filename);
+    file_type               = LOG_FILE_BINARY;
+    obj_rolling_enabled     = Log::NO_ROLLING;
+    obj_rolling_allow_empty = 0;
+  }
+
   // get buffer for pipe
   int pipe_buffer_size = 0;
   if (node["pipe_buffer_size"]) {
@@ -221,6 +351,13 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
                                  obj_rolling_interval_sec, obj_rolling_offset_hr, obj_rolling_size_mb, /* auto_created */ false,
                                  /* rolling_max_count */ obj_rolling_max_count, /* rolling_min_count */ obj_rolling_min_count,
                                  /* reopen_after_rolling */ obj_rolling_allow_empty > 0, pipe_buffer_size);
+  if (net_sink) {
+    logObject->set_net_sink(net_sink.get());
+  }
+  if (sampler) {
+    logObject->set_sampler(sampler.get());
+    Debug("log-sample", "%s is sampled, %s", filename.c_str(), sampler->description().c_str());
+  }
 
   // Generate LogDeletingInfo entry for later use
   std::string ext;
@@ -234,6 +371,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   case LOG_FILE_BINARY:
     ext = LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION;
     break;
+  case LOG_FILE_COLUMNAR:
+    ext = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+    break;
   default:
     break;
   }
@@ -0,0 +1,188 @@
+/** @file
+
+  Catch-based tests for LogColumnar.h.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "tscore/ink_config.h"
+#include <LogColumnar.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+namespace
+{
+LogColumnarBatch
+sample_schema()
+{
+  LogColumnarBatch batch;
+  batch.columns.emplace_back("timestamp", LogColumn::TIMESTAMP);
+  batch.columns.emplace_back("pssc", LogColumn::INT64);
+  batch.columns.emplace_back("cqu", LogColumn::UTF8);
+  batch.columns.emplace_back("cqtx", LogColumn::BINARY);
+  batch.metadata.emplace_back("ats.fieldlist", "pssc,cqu,cqtx");
+  batch.metadata.emplace_back("ats.layout", "1,s,b");
+  return batch;
+}
+
+void
+fill(LogColumnarBatch &batch, int rows, int first)
+{
+  batch.clear_values();
+  for (int i = first; i < first + rows; i++) {
+    batch.columns[0].append(int64_t{1600000000000000} + i);
+    batch.columns[1].append(int64_t{200 + i % 3});
+    batch.columns[2].append("http://example.com/" + std::to_string(i));
+    batch.columns[3].append(std::string_view("GET\0\0\0\0\0", i % 2 ? 8 : 0));
+  }
+}
+
+void
+check_same(const LogColumnarBatch &a, const LogColumnarBatch &b)
+{
+  REQUIRE(a.columns.size() == b.columns.size());
+  REQUIRE(a.rows() == b.rows());
+  for (size_t c = 0; c < a.columns.size(); c++) {
+    CHECK(a.columns[c].name == b.columns[c].name);
+    REQUIRE(a.columns[c].type == b.columns[c].type);
+    for (size_t r = 0; r < a.rows(); r++) {
+      if (a.columns[c].is_int()) {
+        CHECK(a.columns[c].ints[r] == b.columns[c].ints[r]);
+      } else {
+        CHECK(a.columns[c].value(r) == b.columns[c].value(r));
+      }
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("LogColumnarIPC messages", "[LogColumnar]")
+{
+  LogColumnarBatch written = sample_schema();
+  std::string stream;
+  LogColumnarIPC::schema_message(written, stream);
+  REQUIRE(stream.size() % 8 == 0);
+  fill(written, 5, 0);
+  LogColumnarIPC::batch_message(written, stream);
+  REQUIRE(stream.size() % 8 == 0);
+
+  SECTION("read back")
+  {
+    LogColumnarIPC::Reader reader;
+    LogColumnarBatch read;
+    reader.feed(stream.data(), stream.size());
+    REQUIRE(reader.next(read) == LogColumnarIPC::Reader::BATCH);
+    check_same(written, read);
+    REQUIRE(read.find_metadata("ats.layout") != nullptr);
+    CHECK(*read.find_metadata("ats.layout") == "1,s,b");
+    CHECK(read.find_metadata("ats.printf") == nullptr);
+    CHECK(reader.next(read) == LogColumnarIPC::Reader::NEED_MORE);
+    CHECK(reader.pending() == 0);
+  }
+
+  SECTION("read a byte at a time")
+  {
+    LogColumnarIPC::Reader reader;
+    LogColumnarBatch read;
+    int batches = 0;
+    for (char c : stream) {
+      reader.feed(&c, 1);
+      auto result = reader.next(read);
+      REQUIRE(result != LogColumnarIPC::Reader::ERROR);
+      batches += result == LogColumnarIPC::Reader::BATCH;
+    }
+    CHECK(batches == 1);
+    check_same(written, read);
+  }
+
+  SECTION("end of stream and errors")
+  {
+    LogColumnarIPC::Reader reader;
+    LogColumnarBatch read;
+    std::string eos("\xff\xff\xff\xff\0\0\0\0", 8);
+    reader.feed(stream.data(), stream.size());
+    reader.feed(eos.data(), eos.size());
+    CHECK(reader.next(read) == LogColumnarIPC::Reader::BATCH);
+    CHECK(reader.next(read) == LogColumnarIPC::Reader::END);
+
+    // a batch before any schema
+    LogColumnarIPC::Reader no_schema;
+    std::string batch_only;
+    LogColumnarIPC::batch_message(written, batch_only);
+    no_schema.feed(batch_only.data(), batch_only.size());
+    CHECK(no_schema.next(read) == LogColumnarIPC::Reader::ERROR);
+
+    LogColumnarIPC::Reader garbage;
+    garbage.feed("not an arrow stream", 19);
+    CHECK(garbage.next(read) == LogColumnarIPC::Reader::ERROR);
+  }
+}
+
+#ifdef HAVE_ZSTD_H
+TEST_CASE("LogColumnar compressed stream", "[LogColumnar]")
+{
+  LogColumnarBatch written = sample_schema();
+  LogColumnarCompressor compressor;
+  std::string file, message;
+
+  // the schema and a batch in a frame that is not ended, as a file being written
+  LogColumnarIPC::schema_message(written, message);
+  REQUIRE(compressor.compress(message.data(), message.size(), file));
+  fill(written, 100, 0);
+  message.clear();
+  LogColumnarIPC::batch_message(written, message);
+  REQUIRE(compressor.compress(message.data(), message.size(), file));
+  CHECK(compressor.in_frame());
+  CHECK(log_columnar_magic(file.data(), file.size()));
+  size_t flushed = file.size();
+
+  // another batch, in a frame that is ended, as a file rolled
+  fill(written, 250, 100);
+  message.clear();
+  LogColumnarIPC::batch_message(written, message);
+  REQUIRE(compressor.compress(message.data(), message.size(), file, true));
+  CHECK(!compressor.in_frame());
+
+  LogColumnarDecompressor decompressor;
+  LogColumnarIPC::Reader reader;
+  LogColumnarBatch read;
+  std::string plain;
+  REQUIRE(decompressor.decompress(file.data(), flushed, plain));
+  CHECK(decompressor.in_frame());
+  reader.feed(plain.data(), plain.size());
+  REQUIRE(reader.next(read) == LogColumnarIPC::Reader::BATCH);
+  CHECK(read.rows() == 100);
+  CHECK(reader.next(read) == LogColumnarIPC::Reader::NEED_MORE);
+
+  plain.clear();
+  REQUIRE(decompressor.decompress(file.data() + flushed, file.size() - flushed, plain));
+  CHECK(!decompressor.in_frame());
+  reader.feed(plain.data(), plain.size());
+  REQUIRE(reader.next(read) == LogColumnarIPC::Reader::BATCH);
+  check_same(written, read);
+
+  LogColumnarDecompressor other;
+  CHECK(!log_columnar_magic("\xac\xef\xac\x0a", 4));
+  CHECK(!other.decompress("\xac\xef\xac\x0a", 4, plain));
+}
+#endif
@@ -0,0 +1,112 @@
+/** @file
+
+  Catch-based tests for LogDirectWriter.h.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "LogDirectWriter.h"
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+namespace
+{
+std::string
+temp_log()
+{
+  char path[] = "/tmp/test_LogDirectWriter.XXXXXX";
+  int fd      = mkstemp(path);
+  REQUIRE(fd >= 0);
+  close(fd);
+  return path;
+}
+
+std::string
+contents(const std::string &path)
+{
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Open with O_DIRECT where the file system allows it, as tmpfs does not.
+void
+open_writer(LogDirectWriter &writer, const std::string &path)
+{
+  if (!writer.open(path.c_str(), true)) {
+    REQUIRE(errno == EINVAL);
+    REQUIRE(writer.open(path.c_str(), false));
+  }
+}
+} // namespace
+
+TEST_CASE("LogDirectWriter appends in blocks and syncs the tail", "[LogDirectWriter]")
+{
+  std::string path = temp_log();
+  std::string expected;
+  LogDirectWriter writer(8192, 4096);
+
+  open_writer(writer, path);
+  for (int i = 0; i < 1000; ++i) {
+    std::string line = "entry " + std::to_string(i) + " of the log\n";
+    REQUIRE(writer.write(line.data(), line.size()) == static_cast<ssize_t>(line.size()));
+    expected += line;
+    if (i % 97 == 0) {
+      REQUIRE(writer.sync());
+      CHECK(contents(path) == expected);
+    }
+  }
+  CHECK(writer.size() == static_cast<off_t>(expected.size()));
+  REQUIRE(writer.sync());
+  CHECK(contents(path) == expected);
+
+  writer.close();
+  CHECK(contents(path) == expected);
+  unlink(path.c_str());
+}
+
+TEST_CASE("LogDirectWriter appends to an existing file", "[LogDirectWriter]")
+{
+  std::string path = temp_log();
+  std::string expected(5000, 'a');
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << expected;
+  }
+
+  LogDirectWriter writer(4096, 4096);
+  open_writer(writer, path);
+  CHECK(writer.size() == 5000);
+
+  std::string more(10000, 'b');
+  REQUIRE(writer.write(more.data(), more.size()) == static_cast<ssize_t>(more.size()));
+  expected += more;
+  writer.close();
+  CHECK(contents(path) == expected);
+  unlink(path.c_str());
+}
@@ -0,0 +1,847 @@
+/** @file
+
+    Replay of access logs against models of the cache, to compare configurations offline.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#include "CacheSim.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "tscore/List.h"
+#include "tscore/ParseRules.h"
+#include "tscpp/util/TextView.h"
+
+#include "CacheDefs.h"
+#include "../../iocore/cache/P_CacheAdmission.h"
+
+using ts::Errata;
+using ts::TextView;
+
+namespace ct
+{
+SimStats &
+SimStats::operator+=(SimStats const &that)
+{
+  requests += that.requests;
+  bytes += that.bytes;
+  hits += that.hits;
+  hit_bytes += that.hit_bytes;
+  ram_lookups += that.ram_lookups;
+  ram_hits += that.ram_hits;
+  ram_hit_bytes += that.ram_hit_bytes;
+  writes += that.writes;
+  write_bytes += that.write_bytes;
+  not_admitted += that.not_admitted;
+  overwritten += that.overwritten;
+  dir_evicted += that.dir_evicted;
+  return *this;
+}
+
+namespace
+{
+struct SimKeyHash {
+  size_t
+  operator()(CryptoHash const &key) const
+  {
+    return key.fold();
+  }
+};
+
+struct SimRequest {
+  CryptoHash key;
+  int64_t size;
+};
+
+/// The requests of a log the cache could serve, the GETs with a 200 response.
+struct SimTrace {
+  std::vector<SimRequest> requests;
+  int64_t skipped = 0;
+  int64_t first   = 0; ///< Timestamp of the first request
+  int64_t last    = 0; ///< Timestamp of the last request
+};
+
+/// The size of the IOBufferData a fragment is read into, which the RAM cache accounts for.
+uint32_t
+sim_block_size(int64_t len)
+{
+  static constexpr int64_t MAX_BLOCK = 2097152; // BUFFER_SIZE_FOR_INDEX(MAX_BUFFER_SIZE_INDEX)
+  if (len > MAX_BLOCK) {
+    return len;
+  }
+  int64_t size = 128;
+  while (size < len) {
+    size <<= 1;
+  }
+  return size;
+}
+
+// The sizes of the hash tables of the RAM caches, whose seen filters have as many slots.
+const int bucket_sizes[] = {127,      251,      509,       1021,      2039,      4093,       8191,      16381,   32749,
+                            65521,    131071,   262139,    524287,    1048573,   2097143,    4194301,   8388593, 16777213,
+                            33554393, 67108859, 134217689, 268435399, 536870909, 1073741789, 2147483647};
+
+/** The model of a RAM cache: the keys and sizes the RAM cache of a volume would hold, without their
+    data. A fragment is looked up by its key and its offset on the disk, as in the cache.
+ */
+class SimRamCache
+{
+public:
+  virtual ~SimRamCache() = default;
+
+  virtual bool get(CryptoHash const &key, uint64_t auxkey)                = 0;
+  virtual void put(CryptoHash const &key, uint32_t size, uint64_t auxkey) = 0;
+};
+
+/// RamCacheLRU, see RamCacheLRU.cc.
+class SimRamCacheLRU : public SimRamCache
+{
+public:
+  SimRamCacheLRU(int64_t max_bytes, bool seen_filter) : _max_bytes(max_bytes), _seen_filter(seen_filter) { _resize(); }
+
+  ~SimRamCacheLRU() override
+  {
+    while (Entry *e = _lru.dequeue()) {
+      delete e;
+    }
+  }
+
+  bool
+  get(CryptoHash const &key, uint64_t auxkey) override
+  {
+    auto spot = _index.find(key);
+    if (!_max_bytes || spot == _index.end() || spot->second->auxkey != auxkey) {
+      return false;
+    }
+    _lru.remove(spot->second);
+    _lru.enqueue(spot->second);
+    return true;
+  }
+
+  void
+  put(CryptoHash const &key, uint32_t size, uint64_t auxkey) override
+  {
+    if (!_max_bytes) {
+      return;
+    }
+    if (_seen_filter) {
+      uint16_t k  = key.slice32(3) >> 16;
+      uint16_t &s = _seen[key.slice32(3) % bucket_sizes[_ibuckets]];
+      uint16_t kk = s;
+      s           = k;
+      if (kk != k) {
+        return;
+      }
+    }
+    auto spot = _index.find(key);
+    if (spot != _index.end()) {
+      if (spot->second->auxkey == auxkey) {
+        _lru.remove(spot->second);
+        _lru.enqueue(spot->second);
+        return;
+      }
+      _remove(spot->second); // discard when aux keys conflict
+    }
+    Entry *e  = new Entry;
+    e->key    = key;
+    e->auxkey = auxkey;
+    e->size   = size;
+    _index.emplace(key, e);
+    _lru.enqueue(e);
+    _bytes += ENTRY_OVERHEAD + size;
+    while (_bytes > _max_bytes) {
+      if (Entry *ee = _lru.head) {
+        _remove(ee);
+      } else {
+        break;
+      }
+    }
+    if (static_cast<int64_t>(_index.size()) > bucket_sizes[_ibuckets]) {
+      ++_ibuckets;
+      _resize();
+    }
+  }
+
+private:
+  static constexpr int ENTRY_OVERHEAD = 128;
+
+  struct Entry {
+    CryptoHash key;
+    uint64_t auxkey;
+    uint32_t size;
+    LINK(Entry, lru_link);
+  };
+
+  void
+  _remove(Entry *e)
+  {
+    _lru.remove(e);
+    _index.erase(e->key);
+    _bytes -= ENTRY_OVERHEAD + e->size;
+    delete e;
+  }
+
+  // The seen filter is cleared as the hash table grows.
+  void
+  _resize()
+  {
+    if (_seen_filter) {
+      _seen.assign(bucket_sizes[_ibuckets], 0);
+    }
+  }
+
+  int64_t _max_bytes;
+  bool _seen_filter;
+  int64_t _bytes = 0;
+  int _ibuckets  = 0;
+  std::vector<uint16_t> _seen;
+  std::unordered_map<CryptoHash, Entry *, SimKeyHash> _index;
+  Que(Entry, lru_link) _lru;
+};
+
+/** RamCacheCLFUS, see RamCacheCLFUS.cc, without the compression: the entries are valued by their
+    hits and sizes, and those that were evicted are remembered in a history, in which the hits of a
+    key are counted until it is worth more than what it would evict.
+ */
+class SimRamCacheCLFUS : public SimRamCache
+{
+public:
+  SimRamCacheCLFUS(int64_t max_bytes, bool seen_filter) : _max_bytes(max_bytes), _seen_filter(seen_filter) { _resize(); }
+
+  ~SimRamCacheCLFUS() override
+  {
+    for (auto &lru : _lru) {
+      while (Entry *e = lru.dequeue()) {
+        delete e;
+      }
+    }
+  }
+
+  bool
+  get(CryptoHash const &key, uint64_t auxkey) override
+  {
+    auto spot = _index.find(key);
+    if (!_max_bytes || spot == _index.end() || spot->second->auxkey != auxkey) {
+      return false;
+    }
+    Entry *e = spot->second;
+    if (e->history) {
+      return false;
+    }
+    if (_value(e) > _average_value) {
+      _lru[0].remove(e);
+      _lru[0].enqueue(e);
+    }
+    e->hits++;
+    return true;
+  }
+
+  void
+  put(CryptoHash const &key, uint32_t size, uint64_t auxkey) override
+  {
+    if (!_max_bytes) {
+      return;
+    }
+    Entry *e            = nullptr;
+    Entry *victim       = nullptr;
+    double victim_value = 0;
+    int requeue_limit   = REQUEUE_LIMIT;
+    Que(Entry, lru_link) victims;
+
+    auto spot = _index.find(key);
+    if (spot != _index.end()) {
+      e = spot->second;
+      if (e->auxkey != auxkey) {
+        _destroy(e); // discard when aux keys conflict
+        e = nullptr;
+      }
+    }
+    if (e) {
+      e->hits++;
+      if (!e->history) { // already in cache
+        _lru[0].remove(e);
+        _lru[0].enqueue(e);
+        _bytes += static_cast<int64_t>(size) - e->size;
+        e->size = size;
+        return;
+      }
+      _lru[1].remove(e);
+      if (_value(e) < _average_value) {
+        _lru[1].enqueue(e);
+        return;
+      }
+    }
+    if (!_lru[1].head) { // initial fill
+      if (_bytes + size <= _max_bytes) {
+        goto Linsert;
+      }
+    }
+    if (!e && _seen_filter) {
+      uint16_t k  = key.slice32(3) >> 16;
+      uint16_t &s = _seen[key.slice32(3) % bucket_sizes[_ibuckets]];
+      uint16_t kk = s;
+      s           = k;
+      if (_history >= _objects && kk != k) {
+        return;
+      }
+    }
+    while (true) {
+      victim = _lru[0].dequeue();
+      if (!victim) {
+        if (_bytes + size <= _max_bytes) {
+          goto Linsert;
+        }
+        if (e) {
+          _lru[1].enqueue(e);
+        }
+        _requeue_victims(victims);
+        return;
+      }
+      _average_value = (_value(victim) + (_average_value * (AVERAGE_VALUE_OVER - 1))) / AVERAGE_VALUE_OVER;
+      if (_value(victim) > _average_value && requeue_limit-- > 0) {
+        _lru[0].enqueue(victim);
+        continue;
+      }
+      _bytes -= victim->size + ENTRY_OVERHEAD;
+      victims.enqueue(victim);
+      victim_value += _value(victim);
+      _tick();
+      if (!e) {
+        _requeue_victims(victims);
+        e          = new Entry;
+        e->key     = key;
+        e->auxkey  = auxkey;
+        e->hits    = 1;
+        e->size    = size;
+        e->history = true;
+        _index.emplace(key, e);
+        _lru[1].enqueue(e);
+        _history++;
+        return;
+      } else if (_bytes + victim->size + size > _max_bytes && victim_value > _value(e)) { // e from history
+        _requeue_victims(victims);
+        _lru[1].enqueue(e);
+        return;
+      }
+      if (_bytes + size <= _max_bytes) {
+        goto Linsert;
+      }
+    }
+  Linsert:
+    while ((victim = victims.dequeue())) {
+      if (_bytes + size + victim->size <= _max_bytes) {
+        _bytes += victim->size + ENTRY_OVERHEAD;
+        victim->hits = REQUEUE_HITS(victim->hits);
+        _lru[0].enqueue(victim);
+      } else {
+        _victimize(victim);
+      }
+    }
+    if (e) {
+      _history--; // move from history
+    } else {
+      e         = new Entry;
+      e->key    = key;
+      e->auxkey = auxkey;
+      e->hits   = 1;
+      _index.emplace(key, e);
+      if (_objects > bucket_sizes[_ibuckets]) {
+        ++_ibuckets;
+        _resize();
+      }
+    }
+    e->history = false;
+    e->size    = size;
+    _bytes += size + ENTRY_OVERHEAD;
+    _objects++;
+    _lru[0].enqueue(e);
+  }
+
+private:
+  static constexpr int ENTRY_OVERHEAD     = 256;
+  static constexpr int HISTORY_HYSTERIA   = 10;
+  static constexpr int AVERAGE_VALUE_OVER = 100;
+  static constexpr int REQUEUE_LIMIT      = 100;
+
+  struct Entry {
+    CryptoHash key;
+    uint64_t auxkey;
+    uint64_t hits;
+    uint32_t size;
+    bool history; ///< Only remembered, not in memory
+    LINK(Entry, lru_link);
+  };
+
+  static uint64_t
+  REQUEUE_HITS(uint64_t hits)
+  {
+    return hits ? hits - 1 : 0;
+  }
+
+  static double
+  _value(Entry const *e)
+  {
+    return static_cast<double>(e->hits + 1) / (e->size + ENTRY_OVERHEAD);
+  }
+
+  void
+  _resize()
+  {
+    if (_seen_filter) {
+      _seen.assign(bucket_sizes[_ibuckets], 0);
+    }
+  }
+
+  void
+  _free(Entry *e)
+  {
+    _index.erase(e->key);
+    delete e;
+  }
+
+  // move CLOCK on history
+  void
+  _tick()
+  {
+    Entry *e = _lru[1].dequeue();
+    if (!e) {
+      return;
+    }
+    e->hits >>= 1;
+    if (e->hits) {
+      e->hits = REQUEUE_HITS(e->hits);
+      _lru[1].enqueue(e);
+      if (_history <= _objects + HISTORY_HYSTERIA) {
+        return;
+      }
+      if (!(e = _lru[1].dequeue())) {
+        return;
+      }
+    }
+    _history--;
+    _free(e);
+  }
+
+  void
+  _victimize(Entry *e)
+  {
+    _objects--;
+    e->history = true;
+    _lru[1].enqueue(e);
+    _history++;
+  }
+
+  void
+  _destroy(Entry *e)
+  {
+    _lru[e->history].remove(e);
+    if (!e->history) {
+      _objects--;
+      _bytes -= e->size + ENTRY_OVERHEAD;
+    } else {
+      _history--;
+    }
+    _free(e);
+  }
+
+  void
+  _requeue_victims(Que(Entry, lru_link) & victims)
+  {
+    while (Entry *victim = victims.dequeue()) {
+      _bytes += victim->size + ENTRY_OVERHEAD;
+      victim->hits = REQUEUE_HITS(victim->hits);
+      _lru[0].enqueue(victim);
+    }
+  }
+
+  int64_t _max_bytes;
+  bool _seen_filter;
+  int64_t _bytes        = 0;
+  int64_t _objects      = 0;
+  int64_t _history      = 0;
+  double _average_value = 0;
+  int _ibuckets         = 0;
+  std::vector<uint16_t> _seen;
+  std::unordered_map<CryptoHash, Entry *, SimKeyHash> _index;
+  Que(Entry, lru_link) _lru[2];
+};
+
+/// The LRU policy of cache_promote: a miss is written once it was requested @a hits times while
+/// among the @a buckets URLs most recently requested, see plugins/cache_promote/lru_policy.cc.
+class SimLRUPromotion
+{
+public:
+  SimLRUPromotion(unsigned buckets, unsigned hits) : _buckets(std::max(buckets, 10U)), _hits(hits) {}
+
+  bool
+  promote(CryptoHash const &key)
+  {
+    auto spot = _map.find(key);
+    if (spot != _map.end()) {
+      if (++spot->second->second >= _hits) {
+        _list.erase(spot->second);
+        _map.erase(spot);
+        return true;
+      }
+      _list.splice(_list.begin(), _list, spot->second);
+      return false;
+    }
+    if (_list.size() >= _buckets) {
+      _map.erase(_list.back().first);
+      _list.pop_back();
+    }
+    _list.emplace_front(key, 1);
+    _map.emplace(key, _list.begin());
+    return _hits <= 1;
+  }
+
+private:
+  using List = std::list<std::pair<CryptoHash, unsigned>>;
+
+  unsigned _buckets;
+  unsigned _hits;
+  List _list;
+  std::unordered_map<CryptoHash, List::iterator, SimKeyHash> _map;
+};
+
+/** A volume of a candidate: its directory, its disk, a cyclic log of the documents as they are
+    written, and its RAM cache.
+
+    A document is found while the directory has it and the disk has not wrapped around over it.
+    The directory has an entry for each fragment, as many as the disk size over the average object
+    size, and loses its oldest when it is full. The fragments that are read from the disk are put in
+    the RAM cache, up to the RAM cache cutoff. Misses are written, if the promotion policy agrees.
+ */
+class SimVolume
+{
+public:
+  SimVolume(SimCandidate const &c) : _c(c)
+  {
+    _disk_size    = c.disk_size / c.volumes;
+    _dir_capacity = std::max<int64_t>(_disk_size / std::max<int64_t>(c.aos, CACHE_BLOCK_SIZE), 1);
+    if (c.ram_algorithm == SimCandidate::CLFUS) {
+      _ram.reset(new SimRamCacheCLFUS(c.ram_size / c.volumes, c.seen_filter));
+    } else {
+      _ram.reset(new SimRamCacheLRU(c.ram_size / c.volumes, c.seen_filter));
+    }
+    // The policies are for the whole cache, each volume gets its share of the memory.
+    if (c.promotion == SimCandidate::PROMOTE_LRU) {
+      unsigned buckets = c.promote_buckets ? c.promote_buckets : 1000;
+      _lru_promotion.reset(new SimLRUPromotion(buckets / c.volumes, c.promote_hits));
+    } else if (c.promotion == SimCandidate::PROMOTE_SKETCH) {
+      unsigned buckets = c.promote_buckets ? c.promote_buckets : 65536;
+      _sketch_promotion.reset(new CacheAdmissionFilter(buckets / c.volumes, c.promote_hits));
+    }
+  }
+
+  void
+  request(CryptoHash const &key, int64_t size)
+  {
+    stats.requests++;
+    stats.bytes += size;
+
+    int fragments = std::max<int64_t>((size + _c.fragment_size - 1) / _c.fragment_size, 1);
+    auto spot     = _dir.find(key);
+    if (spot != _dir.end()) {
+      stats.hits++;
+      stats.hit_bytes += size;
+      for (int i = 0; i < fragments; ++i) {
+        int64_t len = std::min<int64_t>(size - i * _c.fragment_size, _c.fragment_size);
+        CryptoHash fragment_key(key);
+        fragment_key.u64[0] += i; // a key for each fragment, as next_CacheKey() derives them
+        stats.ram_lookups++;
+        if (_ram->get(fragment_key, spot->second + i)) {
+          stats.ram_hits++;
+          stats.ram_hit_bytes += len;
+        } else if (!_c.ram_cutoff || size < _c.ram_cutoff) {
+          _ram->put(fragment_key, sim_block_size(len + sizeof(Doc)), spot->second + i);
+        }
+      }
+      return;
+    }
+
+    if ((_lru_promotion && !_lru_promotion->promote(key)) || (_sketch_promotion && !_sketch_promotion->admit(key))) {
+      stats.not_admitted++;
+      return;
+    }
+    int64_t length = 0;
+    for (int i = 0; i < fragments; ++i) {
+      int64_t len = std::min<int64_t>(size - i * _c.fragment_size, _c.fragment_size) + sizeof(Doc);
+      length += (len + CACHE_BLOCK_SIZE - 1) / CACHE_BLOCK_SIZE * CACHE_BLOCK_SIZE;
+    }
+    _dir[key] = _write_pos;
+    _log.push_back({key, _write_pos, fragments});
+    _write_pos += length;
+    _dir_entries += fragments;
+    stats.writes++;
+    stats.write_bytes += length;
+
+    // Drop what the write went over, then the oldest entries if the directory overflows.
+    while (!_log.empty() && (_log.front().offset < _write_pos - _disk_size || _dir_entries > _dir_capacity)) {
+      Written &w = _log.front();
+      auto d     = _dir.find(w.key);
+      if (d != _dir.end() && d->second == w.offset) {
+        _dir.erase(d);
+        (w.offset < _write_pos - _disk_size ? stats.overwritten : stats.dir_evicted)++;
+      }
+      _dir_entries -= w.fragments;
+      _log.pop_front();
+    }
+  }
+
+  SimStats stats;
+
+private:
+  struct Written {
+    CryptoHash key;
+    int64_t offset;
+    int fragments;
+  };
+
+  SimCandidate const &_c;
+  int64_t _disk_size;
+  int64_t _dir_capacity;
+  int64_t _write_pos   = 0;
+  int64_t _dir_entries = 0;
+  std::unordered_map<CryptoHash, int64_t, SimKeyHash> _dir; ///< The offset of each document.
+  std::deque<Written> _log;
+  std::unique_ptr<SimRamCache> _ram;
+  std::unique_ptr<SimLRUPromotion> _lru_promotion;
+  std::unique_ptr<CacheAdmissionFilter> _sketch_promotion;
+};
+
+// The fields of the squid format: time elapsed client code/status bytes method url ...
+Errata
+load_trace(ts::file::path const &path, SimTrace &trace)
+{
+  Errata zret;
+  std::ifstream file;
+  std::istream *in = &std::cin;
+
+  if (path.string() != "-") {
+    file.open(path.string());
+    if (!file) {
+      return Errata::Message(0, EBADF, "Unable to open the log ", path.string());
+    }
+    in = &file;
+  }
+
+  std::string text;
+  while (std::getline(*in, text)) {
+    TextView line(text);
+    auto field = [&line]() -> TextView {
+      line.ltrim_if(&isspace);
+      return line.take_prefix_if(&isspace);
+    };
+    TextView time = field();
+    field(); // elapsed
+    field(); // client
+    TextView status = field().take_suffix_at('/');
+    TextView bytes  = field();
+    TextView method = field();
+    TextView url    = field();
+    int64_t size    = ts::svtoi(bytes);
+
+    if (url.empty() || method != "GET" || status != "200" || size <= 0) {
+      trace.skipped++;
+      continue;
+    }
+    int64_t t = ts::svtoi(time);
+    if (trace.requests.empty()) {
+      trace.first = t;
+    }
+    trace.last = t;
+
+    SimRequest r;
+    CryptoContext ctx;
+    r.size = size;
+    ctx.hash_immediate(r.key, url.data(), url.size());
+    trace.requests.push_back(r);
+  }
+  return zret;
+}
+
+void
+report(std::vector<SimCandidate> const &candidates, std::vector<SimStats> const &results, SimTrace const &trace)
+{
+  int64_t seconds = trace.last - trace.first;
+  int width       = 9;
+  auto percent    = [](int64_t n, int64_t d) { return d ? 100.0 * n / d : 0.0; };
+
+  for (auto const &c : candidates) {
+    width = std::max<int>(width, c.name.size());
+  }
+
+  printf("%zu requests over %" PRId64 " seconds, %" PRId64 " other lines skipped\n", trace.requests.size(), seconds,
+         trace.skipped);
+  printf("%-*s %9s %9s %9s %9s %11s %11s %11s %11s\n", width, "candidate", "hit %", "byte hit", "ram hit", "admitted", "writes/s",
+         "write MB/s", "overwritten", "dir evicted");
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    SimStats const &s = results[i];
+    int64_t misses    = s.requests - s.hits;
+    printf("%-*s %8.2f%% %8.2f%% %8.2f%% %8.2f%% %11.1f %11.2f %11" PRId64 " %11" PRId64 "\n", width, candidates[i].name.c_str(),
+           percent(s.hits, s.requests), percent(s.hit_bytes, s.bytes), percent(s.ram_hits, s.ram_lookups),
+           percent(misses - s.not_admitted, misses), seconds ? static_cast<double>(s.writes) / seconds : 0.0,
+           seconds ? s.write_bytes / 1048576.0 / seconds : 0.0, s.overwritten, s.dir_evicted);
+  }
+}
+} // namespace
+
+Errata
+ParseCandidates(std::string_view content, std::vector<SimCandidate> &candidates)
+{
+  Errata zret;
+  TextView text(content);
+  int ln = 0;
+
+  while (text) {
+    ++ln;
+    TextView line = text.take_prefix_at('\n');
+    line.ltrim_if(&isspace);
+    if (line.empty() || '#' == *line) {
+      continue;
+    }
+
+    SimCandidate c;
+    c.name = std::string(line.take_prefix_if(&isspace));
+    while (line.ltrim_if(&isspace)) {
+      TextView value(line.take_prefix_if(&isspace));
+      TextView tag(value.take_prefix_at('='));
+      int64_t n = ink_atoi64(value.data(), value.size());
+
+      if (tag == "disk") {
+        c.disk_size = n;
+      } else if (tag == "volumes") {
+        c.volumes = n;
+      } else if (tag == "ram") {
+        c.ram_size = n;
+      } else if (tag == "ram_algorithm") {
+        if (0 == strcasecmp(value, "clfus") || value == "0") {
+          c.ram_algorithm = SimCandidate::CLFUS;
+        } else if (0 == strcasecmp(value, "lru") || value == "1") {
+          c.ram_algorithm = SimCandidate::LRU;
+        } else {
+          zret.push(0, 3, "Line ", ln, " has invalid value '", value, "' for ", tag);
+        }
+      } else if (tag == "seen_filter") {
+        c.seen_filter = n != 0;
+      } else if (tag == "ram_cutoff") {
+        c.ram_cutoff = n;
+      } else if (tag == "aos") {
+        c.aos = n;
+      } else if (tag == "fragment") {
+        c.fragment_size = n;
+      } else if (tag == "promote") {
+        if (0 == strcasecmp(value, "none")) {
+          c.promotion = SimCandidate::PROMOTE_NONE;
+        } else if (0 == strcasecmp(value, "lru")) {
+          c.promotion = SimCandidate::PROMOTE_LRU;
+        } else if (0 == strcasecmp(value, "sketch")) {
+          c.promotion = SimCandidate::PROMOTE_SKETCH;
+        } else {
+          zret.push(0, 3, "Line ", ln, " has invalid value '", value, "' for ", tag);
+        }
+      } else if (tag == "buckets") {
+        c.promote_buckets = n;
+      } else if (tag == "hits") {
+        c.promote_hits = n;
+      } else {
+        zret.push(0, 1, "Line ", ln, " has unknown field '", tag, "'");
+      }
+    }
+    if (c.volumes < 1 || c.disk_size < c.volumes || c.ram_size < 0 || c.fragment_size < 1) {
+      zret.push(0, 2, "Line ", ln, " has invalid sizes");
+    } else {
+      candidates.push_back(std::move(c));
+    }
+  }
+  return zret;
+}
+
+Errata
+Simulate(ts::file::path const &log, ts::file::path const &candidates_path, int threads)
+{
+  Errata zret;
+  std::vector<SimCandidate> candidates;
+  SimTrace trace;
+
+  if (log.empty() || candidates_path.empty()) {
+    return Errata::Message(0, EINVAL, "simulate needs a log, --input, and candidates, --candidates");
+  }
+  std::error_code ec;
+  std::string content = ts::file::load(candidates_path, ec);
+  if (ec) {
+    return Errata::Message(0, EBADF, "Unable to load ", candidates_path.string());
+  }
+  if (!(zret = ParseCandidates(content, candidates)) || !(zret = load_trace(log, trace))) {
+    return zret;
+  }
+
+  // A task replays the requests of a volume of a candidate, the volumes are independent.
+  struct Task {
+    size_t candidate;
+    int volume;
+  };
+  std::vector<Task> tasks;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    for (int v = 0; v < candidates[i].volumes; ++v) {
+      tasks.push_back({i, v});
+    }
+  }
+
+  std::vector<SimStats> results(candidates.size());
+  std::atomic<size_t> next{0};
+  std::mutex results_mutex;
+  auto replay = [&]() {
+    for (size_t t; (t = next++) < tasks.size();) {
+      SimCandidate const &c = candidates[tasks[t].candidate];
+      SimVolume volume(c);
+      for (auto const &r : trace.requests) {
+        if (static_cast<int>(r.key.slice32(2) % c.volumes) == tasks[t].volume) {
+          volume.request(r.key, r.size);
+        }
+      }
+      std::lock_guard<std::mutex> lock(results_mutex);
+      results[tasks[t].candidate] += volume.stats;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 0; i < std::max(threads, 1); ++i) {
+    pool.emplace_back(replay);
+  }
+  for (auto &th : pool) {
+    th.join();
+  }
+
+  report(candidates, results, trace);
+  return zret;
+}
+} // namespace ct
@@ -0,0 +1,85 @@
+/** @file
+
+    Replay of access logs against models of the cache, to compare configurations offline.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tscore/CryptoHash.h"
+#include "tscore/Errata.h"
+#include "tscore/ts_file.h"
+
+namespace ct
+{
+/** A configuration of the cache to simulate, a line of the candidates file.
+
+    The defaults are those of records.config, but for the sizes, which have none that would fit.
+ */
+struct SimCandidate {
+  enum RamAlgorithm { CLFUS = 0, LRU = 1 };                     ///< As proxy.config.cache.ram_cache.algorithm
+  enum Promotion { PROMOTE_NONE, PROMOTE_LRU, PROMOTE_SKETCH }; ///< The cache_promote policy, if any
+
+  std::string name;
+  int64_t disk_size        = int64_t(100) << 30; ///< The storage, split evenly in volumes
+  int volumes              = 1;
+  int64_t ram_size         = int64_t(1) << 30; ///< proxy.config.cache.ram_cache.size, split as the disk
+  int ram_algorithm        = LRU;
+  bool seen_filter         = true;    ///< proxy.config.cache.ram_cache.use_seen_filter
+  int64_t ram_cutoff       = 4194304; ///< proxy.config.cache.ram_cache_cutoff
+  int64_t aos              = 8000;    ///< proxy.config.cache.min_average_object_size
+  int64_t fragment_size    = 1048576; ///< proxy.config.cache.target_fragment_size
+  int promotion            = PROMOTE_NONE;
+  unsigned promote_buckets = 0; ///< 0 for the default of the policy
+  unsigned promote_hits    = 10;
+};
+
+/// What a replay measured for a candidate, summed over its volumes.
+struct SimStats {
+  int64_t requests      = 0;
+  int64_t bytes         = 0; ///< Served, by the cache or the origin
+  int64_t hits          = 0; ///< Found on the disk, or in RAM
+  int64_t hit_bytes     = 0;
+  int64_t ram_lookups   = 0; ///< Fragments read
+  int64_t ram_hits      = 0;
+  int64_t ram_hit_bytes = 0;
+  int64_t writes        = 0; ///< Documents written, the misses that were admitted
+  int64_t write_bytes   = 0; ///< Written to the disk, in blocks
+  int64_t not_admitted  = 0; ///< Misses the promotion policy did not write
+  int64_t overwritten   = 0; ///< Documents lost as the disk wrapped around over them
+  int64_t dir_evicted   = 0; ///< Documents lost because the directory was full
+
+  SimStats &operator+=(SimStats const &that);
+};
+
+/** Replay the access log @a log, in the squid format, against each configuration of @a candidates
+    with @a threads threads, and print the hit ratios and disk write rates.
+
+    Binary logs are replayed through @c traffic_logcat @c -S, with @a log "-" for the standard input.
+ */
+ts::Errata Simulate(ts::file::path const &log, ts::file::path const &candidates, int threads);
+
+/// Parse the candidates of @a content, one per line: a name, then @c key=value fields.
+ts::Errata ParseCandidates(std::string_view content, std::vector<SimCandidate> &candidates);
+} // namespace ct
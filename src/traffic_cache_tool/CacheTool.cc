@@ -45,9 +45,11 @@
 
 #include "CacheDefs.h"
 #include "CacheScan.h"
+#include "CacheSim.h"
 
 using ts::Bytes;
 using ts::Megabytes;
+using ts::Gigabytes;
 using ts::CacheStoreBlocks;
 using ts::CacheStripeBlocks;
 using ts::StripeMeta;
@@ -64,6 +66,10 @@ extern int OPEN_RW_FLAG;
 const Bytes ts::CacheSpan::OFFSET{CacheStoreBlocks{1}};
 ts::file::path SpanFile;
 ts::file::path VolumeFile;
+ts::file::path CandidatesFile;
+int SimulateThreads         = std::thread::hardware_concurrency();
+int LayoutStripes           = 0;           // proxy.config.cache.span.stripes
+int64_t LayoutMinStripeSize = 17179869184; // proxy.config.cache.span.min_stripe_size
 ts::ArgParser parser;
 
 Errata err;
@@ -198,6 +204,7 @@ struct Cache {
   enum class SpanDumpDepth { SPAN, STRIPE, DIRECTORY };
   void dumpSpans(SpanDumpDepth depth);
   void dumpVolumes();
+  void dumpLayout();
   void build_stripe_hash_table();
   Stripe *key_to_stripe(CryptoHash *key, const char *hostname, int host_len);
   //  ts::CacheStripeBlocks calcTotalSpanPhysicalSize();
@@ -660,6 +667,40 @@ Cache::dumpVolumes()
   }
 }
 
+/// Show the stripes of each span next to the stripes traffic_server would split a volume into
+/// when it allocates the span again.
+void
+Cache::dumpLayout()
+{
+  for (auto span : _spans) {
+    ink_device_queue queue;
+    bool known     = ink_file_get_device_queue(span->_fd, queue);
+    int64_t bytes  = span->_len.count() * CacheStoreBlocks::SCALE;
+    int stripes    = LayoutStripes;
+    int64_t chunks = bytes / CacheStripeBlocks::SCALE;
+
+    if (stripes <= 0) {
+      stripes = known ? ink_device_stripe_count(queue, bytes, LayoutMinStripeSize, std::thread::hardware_concurrency()) : 1;
+    }
+    stripes = std::max<int64_t>(1, std::min<int64_t>(stripes, chunks));
+
+    std::cout << "Span: " << span->_path.string() << " " << bytes / Gigabytes::SCALE << " GB, ";
+    if (known) {
+      std::cout << (queue.rotational ? "rotational" : "solid state") << ", queue depth " << queue.depth << std::endl;
+    } else {
+      std::cout << "device queue unknown" << std::endl;
+    }
+    if (span->_header) {
+      std::cout << "  now:     " << span->_header->num_used << " stripes in use, " << span->_header->num_free << " free"
+                << std::endl;
+    } else {
+      std::cout << "  now:     uninitialized" << std::endl;
+    }
+    std::cout << "  planned: " << stripes << " stripes of " << bytes / stripes / Gigabytes::SCALE << " GB for a volume filling it"
+              << std::endl;
+  }
+}
+
 ts::CacheStripeBlocks
 Cache::calcTotalSpanConfiguredSize()
 {
@@ -1122,6 +1163,16 @@ List_Stripes(Cache::SpanDumpDepth depth)
   }
 }
 
+void
+Show_Layout()
+{
+  Cache cache;
+
+  if ((err = cache.loadSpan(SpanFile))) {
+    cache.dumpLayout();
+  }
+}
+
 void
 Cmd_Allocate_Empty_Spans()
 {
@@ -1376,7 +1427,11 @@ main(int argc, const char *argv[])
     .add_option("--write", "-w", "")
     .add_option("--input", "-i", "", "", 1)
     .add_option("--device", "-d", "", "", 1)
-    .add_option("--aos", "-o", "", "", 1);
+    .add_option("--aos", "-o", "", "", 1)
+    .add_option("--stripes", "-n", "", "", 1)
+    .add_option("--min-stripe-size", "-m", "", "", 1)
+    .add_option("--candidates", "-c", "", "", 1)
+    .add_option("--threads", "-t", "", "", 1);
 
   parser.add_command("list", "List elements of the cache", []() { List_Stripes(Cache::SpanDumpDepth::SPAN); })
     .add_command("stripes", "List the stripes", []() { List_Stripes(Cache::SpanDumpDepth::STRIPE); });
@@ -1388,6 +1443,7 @@ main(int argc, const char *argv[])
   c.add_command("freelist", "check the freelist for loop", [&]() { Check_Freelist(inputFile); });
   c.add_command("bucket_chain", "walk bucket chains for loops", [&]() { walk_bucket_chain(inputFile); });
   parser.add_command("volumes", "Volumes", &Simulate_Span_Allocation);
+  parser.add_command("layout", "Show the current and planned stripes of the spans", &Show_Layout);
   parser.add_command("alloc", "Storage allocation")
     .require_commands()
     .add_command("free", "Allocate storage on free (empty) spans", &Cmd_Allocate_Empty_Spans);
@@ -1397,6 +1453,8 @@ main(int argc, const char *argv[])
   parser.add_command("init", " Initializes uninitialized span", [&]() { Init_disk(input_url_file); });
   parser.add_command("scan", " Scans the whole cache and lists the urls of the cached contents",
                      [&]() { Scan_Cache(input_url_file); });
+  parser.add_command("simulate", " Replays an access log against models of the cache, for each candidate configuration",
+                     [&]() { err = ct::Simulate(input_url_file, CandidatesFile, SimulateThreads); });
 
   // parse the arguments
   auto arguments = parser.parse(argv);
@@ -1412,6 +1470,18 @@ main(int argc, const char *argv[])
   if (auto data = arguments.get("aos")) {
     cache_config_min_average_object_size = std::stoi(data.value());
   }
+  if (auto data = arguments.get("stripes")) {
+    LayoutStripes = std::stoi(data.value());
+  }
+  if (auto data = arguments.get("min-stripe-size")) {
+    LayoutMinStripeSize = std::stoll(data.value());
+  }
+  if (auto data = arguments.get("candidates")) {
+    CandidatesFile = data.value();
+  }
+  if (auto data = arguments.get("threads")) {
+    SimulateThreads = std::stoi(data.value());
+  }
   if (auto data = arguments.get("device")) {
     inputFile = data.value();
   }
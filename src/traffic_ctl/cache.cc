@@ -0,0 +1,107 @@
+/** @file
+
+  traffic_ctl
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "traffic_ctl.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+
+void
+CtrlEngine::cache_scan()
+{
+  static const char *const numeric[] = {"min-size", "max-size", "min-age", "max-age", "rate"};
+  std::string options;
+
+  for (const char *name : numeric) {
+    std::string value = arguments.get(name).value();
+    if (value.empty()) {
+      continue;
+    }
+    char *end;
+    intmax_t n = strtoimax(value.c_str(), &end, 10);
+    if (*end || n < 0) {
+      fprintf(stderr, "invalid --%s '%s'\n", name, value.c_str());
+      status_code = CTRL_EX_USAGE;
+      return;
+    }
+    // the server takes the names with underscores
+    std::string option{name};
+    std::replace(option.begin(), option.end(), '-', '_');
+    options += option + "=" + std::to_string(n) + "\n";
+  }
+
+  std::string url = arguments.get("url").value();
+  if (url.find('\n') != std::string::npos) {
+    fprintf(stderr, "the --url regular expression cannot span lines\n");
+    status_code = CTRL_EX_USAGE;
+    return;
+  }
+  if (!url.empty()) {
+    options += "url=" + url + "\n";
+  }
+
+  if (arguments.get("directory")) {
+    if (!url.empty() || arguments.get("remove") || !arguments.get("min-age").value().empty() ||
+        !arguments.get("max-age").value().empty()) {
+      fprintf(stderr, "a --directory scan only filters on sizes\n");
+      status_code = CTRL_EX_USAGE;
+      return;
+    }
+    options += "directory=1\n";
+  }
+  if (arguments.get("remove")) {
+    options += "remove=1\n";
+  }
+
+  TSMgmtError error = TSCacheScan(options.c_str());
+  if (error != TS_ERR_OKAY) {
+    CtrlMgmtError(error, "failed to start the cache scan");
+    status_code = CTRL_EX_ERROR;
+    return;
+  }
+  std::cout << "cache scan started, see cache_scan.log in the log directory" << std::endl;
+}
+
+void
+CtrlEngine::cache_invalidate_tag()
+{
+  std::string tags;
+
+  for (const auto &it : arguments.get("invalidate-tag")) {
+    if (it.find('\n') != std::string::npos) {
+      fprintf(stderr, "a tag cannot span lines\n");
+      status_code = CTRL_EX_USAGE;
+      return;
+    }
+    tags += it + "\n";
+  }
+
+  TSMgmtError error = TSCacheTagInvalidate(tags.c_str());
+  if (error != TS_ERR_OKAY) {
+    CtrlMgmtError(error, "failed to invalidate the cache tags");
+    status_code = CTRL_EX_ERROR;
+    return;
+  }
+  std::cout << "cache tags invalidated, the objects are removed in the background" << std::endl;
+}
@@ -22,6 +22,7 @@
  */
 
 #include "traffic_ctl.h"
+#include "records/P_RecUtils.h"
 
 void
 CtrlEngine::plugin_msg()
@@ -41,3 +42,35 @@ CtrlEngine::plugin_msg()
     return;
   }
 }
+
+void
+CtrlEngine::plugin_stats()
+{
+  CtrlMgmtRecordList reclist;
+  TSMgmtError error;
+  std::string regex = "^proxy\\.process\\.plugin\\.";
+
+  // the stats are proxy.process.plugin.<plugin>.<hook>.<stat>
+  auto plugins = arguments.get("stats");
+  if (plugins.size() > 0) {
+    std::string alternatives;
+    for (const auto &it : plugins) {
+      alternatives += (alternatives.empty() ? "" : "|") + it;
+    }
+    regex += "(" + alternatives + ")\\.";
+  }
+
+  error = reclist.match(regex.c_str());
+  if (error != TS_ERR_OKAY) {
+    CtrlMgmtError(error, "failed to fetch the plugin stats");
+    status_code = CTRL_EX_ERROR;
+    return;
+  }
+
+  while (!reclist.empty()) {
+    CtrlMgmtRecord record(reclist.next());
+    if (REC_TYPE_IS_STAT(record.rclass())) {
+      std::cout << record.name() << ' ' << CtrlMgmtRecordValue(record).c_str() << std::endl;
+    }
+  }
+}
@@ -22,6 +22,11 @@
  */
 
 #include "traffic_ctl.h"
+#include "records/P_RecUtils.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <map>
 
 void
 CtrlEngine::server_restart()
@@ -33,6 +38,10 @@ CtrlEngine::server_restart()
     flags |= TS_RESTART_OPT_DRAIN;
   }
 
+  if (arguments.get("hot")) {
+    flags |= TS_RESTART_OPT_HOT;
+  }
+
   if (arguments.get("manager")) {
     error = TSRestart(flags);
   } else {
@@ -63,6 +72,76 @@ CtrlEngine::server_backtrace()
   TSfree(trace);
 }
 
+void
+CtrlEngine::server_locks()
+{
+  struct Site {
+    int64_t acquires = 0, try_failures = 0, waits = 0, wait_time = 0, holds = 0, hold_time = 0;
+  };
+  static const std::string prefix = "proxy.process.lock.";
+
+  CtrlMgmtRecordList reclist;
+  std::map<std::string, Site> sites;
+  TSMgmtError error;
+
+  // the stats are proxy.process.lock.<file>.<line>.<stat>
+  error = reclist.match("^proxy\\.process\\.lock\\.");
+  if (error != TS_ERR_OKAY) {
+    CtrlMgmtError(error, "failed to fetch the lock profile");
+    status_code = CTRL_EX_ERROR;
+    return;
+  }
+
+  auto files = arguments.get("locks");
+  while (!reclist.empty()) {
+    CtrlMgmtRecord record(reclist.next());
+    std::string name = record.name();
+    auto dot         = name.rfind('.');
+    if (!REC_TYPE_IS_STAT(record.rclass()) || dot == std::string::npos || dot < prefix.size()) {
+      continue;
+    }
+    std::string site = name.substr(prefix.size(), dot - prefix.size());
+    std::string stat = name.substr(dot + 1);
+    if (files.size() > 0 && std::none_of(files.begin(), files.end(), [&](const std::string &file) {
+          return site.compare(0, file.size(), file) == 0 && site.size() > file.size() && site[file.size()] == '.';
+        })) {
+      continue;
+    }
+
+    Site &s = sites[site];
+    if (stat == "acquires") {
+      s.acquires = record.as_int();
+    } else if (stat == "try_failures") {
+      s.try_failures = record.as_int();
+    } else if (stat == "waits") {
+      s.waits = record.as_int();
+    } else if (stat == "wait_time") {
+      s.wait_time = record.as_int();
+    } else if (stat == "holds") {
+      s.holds = record.as_int();
+    } else if (stat == "hold_time") {
+      s.hold_time = record.as_int();
+    }
+  }
+
+  // The most contended first.
+  std::vector<std::pair<std::string, Site>> sorted(sites.begin(), sites.end());
+  std::stable_sort(sorted.begin(), sorted.end(), [](auto const &a, auto const &b) {
+    return a.second.try_failures + a.second.waits > b.second.try_failures + b.second.waits;
+  });
+
+  printf("%-32s %14s %12s %7s %12s %7s %12s %12s\n", "SITE", "ACQUIRES", "TRY_FAILURES", "FAIL%", "WAITS", "WAIT%",
+         "AVG_WAIT_US", "AVG_HOLD_NS");
+  for (auto const &[site, s] : sorted) {
+    // The failures are of all the attempts, the waits of the acquires.
+    int64_t attempts = s.acquires + s.try_failures;
+    printf("%-32s %14" PRId64 " %12" PRId64 " %7.2f %12" PRId64 " %7.2f %12.1f %12" PRId64 "\n", site.c_str(), s.acquires,
+           s.try_failures, attempts > 0 ? s.try_failures * 100.0 / attempts : 0.0, s.waits,
+           s.acquires > 0 ? s.waits * 100.0 / s.acquires : 0.0, s.waits > 0 ? s.wait_time / 1000.0 / s.waits : 0.0,
+           s.holds > 0 ? s.hold_time / s.holds : 0);
+  }
+}
+
 void
 CtrlEngine::server_status()
 {
@@ -164,6 +164,7 @@ main(int argc, const char **argv)
     .add_option("--run-root", "", "using TS_RUNROOT as sandbox", "TS_RUNROOT", 1);
 
   auto &alarm_command   = engine.parser.add_command("alarm", "Manipulate alarms").require_commands();
+  auto &cache_command   = engine.parser.add_command("cache", "Inspect the cache").require_commands();
   auto &config_command  = engine.parser.add_command("config", "Manipulate configuration records").require_commands();
   auto &metric_command  = engine.parser.add_command("metric", "Manipulate performance metrics").require_commands();
   auto &server_command  = engine.parser.add_command("server", "Stop, restart and examine the server").require_commands();
@@ -179,6 +180,23 @@ main(int argc, const char **argv)
   alarm_command.add_command("resolve", "Resolve the listed alarms", "", MORE_THAN_ONE_ARG_N, [&]() { engine.alarm_resolve(); })
     .add_example_usage("traffic_ctl alarm resolve ALARM [ALARM ...]");
 
+  // cache commands
+  cache_command
+    .add_command("scan", "Scan all the cache volumes at once, reporting to cache_scan.log", [&]() { engine.cache_scan(); })
+    .add_example_usage("traffic_ctl cache scan [OPTIONS]")
+    .add_option("--url", "", "Regular expression the URLs must match", "", 1)
+    .add_option("--min-size", "", "Smallest object size, in bytes", "", 1)
+    .add_option("--max-size", "", "Largest object size, in bytes", "", 1)
+    .add_option("--min-age", "", "Youngest object age, in seconds", "", 1)
+    .add_option("--max-age", "", "Oldest object age, in seconds", "", 1)
+    .add_option("--rate", "", "Disk read rate over all the volumes, in KB/s", "", 1)
+    .add_option("--directory", "", "Only go through the directory, without reading the disks")
+    .add_option("--remove", "", "Remove the matching objects from the cache");
+  cache_command
+    .add_command("invalidate-tag", "Remove the objects of the listed tags from the cache", "", MORE_THAN_ONE_ARG_N,
+                 [&]() { engine.cache_invalidate_tag(); })
+    .add_example_usage("traffic_ctl cache invalidate-tag TAG [TAG ...]");
+
   // config commands
   config_command.add_command("defaults", "Show default information configuration values", [&]() { engine.config_defaults(); })
     .add_example_usage("traffic_ctl config defaults [OPTIONS]")
@@ -233,13 +251,22 @@ main(int argc, const char **argv)
     .add_command("msg", "Send message to plugins - a TAG and the message DATA(optional)", "", MORE_THAN_ONE_ARG_N,
                  [&]() { engine.plugin_msg(); })
     .add_example_usage("traffic_ctl plugin msg TAG DATA");
+  plugin_command
+    .add_command("stats", "Show the time plugins spend on the transaction hooks, of all or the given PLUGINs", "",
+                 MORE_THAN_ZERO_ARG_N, [&]() { engine.plugin_stats(); })
+    .add_example_usage("traffic_ctl plugin stats [PLUGIN ...]");
 
   // server commands
   server_command.add_command("backtrace", "Show a full stack trace of the traffic_server process",
                              [&]() { engine.server_backtrace(); });
+  server_command
+    .add_command("locks", "Show the contention of the mutexes, of all or the given FILEs they were created in", "",
+                 MORE_THAN_ZERO_ARG_N, [&]() { engine.server_locks(); })
+    .add_example_usage("traffic_ctl server locks [FILE ...]");
   server_command.add_command("restart", "Restart Traffic Server", [&]() { engine.server_restart(); })
     .add_example_usage("traffic_ctl server restart [OPTIONS]")
     .add_option("--drain", "", "Wait for client connections to drain before restarting")
+    .add_option("--hot", "", "Start the new traffic_server while the old one drains")
     .add_option("--manager", "", "Restart traffic_manager as well as traffic_server");
   server_command.add_command("start", "Start the proxy", [&]() { engine.server_start(); })
     .add_example_usage("traffic_ctl server start [OPTIONS]")
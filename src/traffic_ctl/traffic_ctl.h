@@ -178,6 +178,10 @@ struct CtrlEngine {
   // unimplemented command
   void CtrlUnimplementedCommand(std::string_view command);
 
+  // cache methods
+  void cache_scan();
+  void cache_invalidate_tag();
+
   // alarm methods
   void alarm_list();
   void alarm_clear();
@@ -206,10 +210,12 @@ struct CtrlEngine {
 
   // metric methods
   void plugin_msg();
+  void plugin_stats();
 
   // server methods
   void server_restart();
   void server_backtrace();
+  void server_locks();
   void server_status();
   void server_stop();
   void server_start();
@@ -113,6 +113,7 @@ produce_features(bool json)
   print_feature("TS_USE_TLS13", TS_USE_TLS13, json);
   print_feature("TS_USE_QUIC", TS_USE_QUIC, json);
   print_feature("TS_USE_LINUX_NATIVE_AIO", TS_USE_LINUX_NATIVE_AIO, json);
+  print_feature("TS_USE_LINUX_IO_URING", TS_USE_LINUX_IO_URING, json);
   print_feature("TS_HAS_SO_PEERCRED", TS_HAS_SO_PEERCRED, json);
   print_feature("TS_USE_REMOTE_UNWINDING", TS_USE_REMOTE_UNWINDING, json);
   print_feature("TS_USE_TLS_OCSP", TS_USE_TLS_OCSP, json);
@@ -41,9 +41,13 @@
 #include "LogObject.h"
 #include "LogConfig.h"
 #include "LogBuffer.h"
+#include "LogColumnar.h"
+#include "LogColumnarFields.h"
 #include "LogUtils.h"
 #include "Log.h"
 
+#include <memory>
+
 // logcat-specific command-line flags
 static int squid_flag              = 0;
 static int follow_flag             = 0;
@@ -114,6 +118,71 @@ follow_rotate(const char *input_file, ino_t old_inode_num)
   }
 }
 
+// the state of a columnar file, kept between the reads of a file that is followed
+struct ColumnarInput {
+  LogColumnarDecompressor decompressor;
+  LogColumnarIPC::Reader reader;
+  LogColumnarFields fields;
+  bool has_fields = false;
+};
+
+static int
+process_columnar_file(int in_fd, int out_fd, ColumnarInput &input, const char *prefix = nullptr, int prefix_len = 0)
+{
+  char buffer[MAX_LOGBUFFER_SIZE];
+  std::string plain;
+  LogColumnarBatch batch;
+
+  while (true) {
+    int nread = prefix_len;
+    if (prefix_len) {
+      memcpy(buffer, prefix, prefix_len);
+      prefix_len = 0;
+    } else {
+      nread = read(in_fd, buffer, sizeof(buffer));
+    }
+    if (nread < 0) {
+      fprintf(stderr, "Bad columnar log read!\n");
+      return 1;
+    }
+    if (nread == 0) {
+      return 0;
+    }
+
+    plain.clear();
+    if (!input.decompressor.decompress(buffer, nread, plain)) {
+      fprintf(stderr, "Bad zstd stream!\n");
+      return 1;
+    }
+    input.reader.feed(plain.data(), plain.size());
+
+    // print each batch as the log buffer it was written from
+    while (true) {
+      LogColumnarIPC::Reader::Result result = input.reader.next(batch);
+      if (result == LogColumnarIPC::Reader::NEED_MORE) {
+        break;
+      } else if (result == LogColumnarIPC::Reader::END) {
+        return 0;
+      } else if (result == LogColumnarIPC::Reader::ERROR) {
+        fprintf(stderr, "Bad Arrow stream!\n");
+        return 1;
+      }
+      if (!input.has_fields) {
+        if (!input.fields.init(batch)) {
+          fprintf(stderr, "Arrow stream is not a Traffic Server log!\n");
+          return 1;
+        }
+        input.has_fields = true;
+      }
+      LogBufferHeader *header = input.fields.decode(batch);
+      if (header) {
+        LogFile::write_ascii_logbuffer(header, out_fd, ".", nullptr);
+        ats_free(header);
+      }
+    }
+  }
+}
+
 static int
 process_file(int in_fd, int out_fd)
 {
@@ -139,6 +208,13 @@ process_file(int in_fd, int out_fd)
       return 0;
     }
 
+    // a columnar log, from stdin
+    //
+    if (log_columnar_magic(buffer, nread)) {
+      ColumnarInput input;
+      return process_columnar_file(in_fd, out_fd, input, buffer, nread);
+    }
+
     // ensure that this is a valid logbuffer header
     //
     if (header->cookie != LOG_SEGMENT_COOKIE) {
@@ -294,8 +370,9 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
   int error = NO_ERROR;
 
   if (n_file_arguments) {
-    int bin_ext_len   = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
-    int ascii_ext_len = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
+    int bin_ext_len      = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
+    int columnar_ext_len = strlen(LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION);
+    int ascii_ext_len    = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
 
     for (unsigned i = 0; i < n_file_arguments; ++i) {
       int in_fd = open(file_arguments[i], O_RDONLY);
@@ -315,14 +392,26 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
         // We're always reading the file sequentially so this will always help
         posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
+        // a columnar log is a stream that can only be read from its start
+        //
+        char magic[4];
+        std::unique_ptr<ColumnarInput> columnar;
+        if (pread(in_fd, magic, sizeof(magic), 0) == sizeof(magic) && log_columnar_magic(magic, sizeof(magic))) {
+          columnar = std::make_unique<ColumnarInput>();
+        }
+
         if (auto_filenames) {
-          // change .blog to .log
+          // change .blog or .arrows.zst to .log
           //
           int n = strlen(file_arguments[i]);
           int copy_len =
             (n >= bin_ext_len ?
                (strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0 ? n - bin_ext_len : n) :
                n);
+          if (n >= columnar_ext_len &&
+              strcmp(&file_arguments[i][n - columnar_ext_len], LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION) == 0) {
+            copy_len = n - columnar_ext_len;
+          }
 
           char *out_filename = (char *)ats_malloc(copy_len + ascii_ext_len + 1);
 
@@ -338,13 +427,13 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
             continue;
           }
         }
-        if (follow_flag) {
+        if (follow_flag && !columnar) {
           lseek(in_fd, 0, SEEK_END);
         }
 
         ino_t inode_num = get_inode_num(file_arguments[i]);
         while (true) {
-          if (process_file(in_fd, out_fd) != 0) {
+          if ((columnar ? process_columnar_file(in_fd, out_fd, *columnar) : process_file(in_fd, out_fd)) != 0) {
             error = DATA_PROCESSING_ERROR;
             break;
           }
@@ -366,6 +455,9 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
                 Debug("logcat", "Detected logfile rotation. Following to new file");
                 close(in_fd);
                 in_fd = fd;
+                if (columnar) {
+                  columnar = std::make_unique<ColumnarInput>();
+                }
 
                 // update the inode number for the log file
                 inode_num = get_inode_num(file_arguments[i]);
@@ -35,9 +35,12 @@
 #include "LogStandalone.cc"
 
 #include "LogObject.h"
+#include "LogColumnar.h"
+#include "LogColumnarFields.h"
 #include "hdrs/HTTP.h"
 
 #include <sys/utsname.h>
+#include <sys/mman.h>
 #if defined(solaris)
 #include <sys/types.h>
 #include <unistd.h>
@@ -50,13 +53,19 @@
 #include <string>
 #include <algorithm>
 #include <vector>
-#include <list>
 #include <cmath>
 #include <functional>
 #include <fcntl.h>
 #include <unordered_map>
 #include <unordered_set>
 #include <string_view>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+#if HAVE_ZLIB_H
+#include <zlib.h>
+#endif
 
 #ifndef _XOPEN_SOURCE
 #define _XOPEN_SOURCE 600
@@ -292,12 +301,6 @@ struct OriginStats {
 };
 
 struct UrlStats {
-  bool
-  operator<(const UrlStats &rhs) const
-  {
-    return req.count > rhs.req.count;
-  } // Reverse order
-
   const char *url;
   StatsCounter req;
   ElapsedStats time;
@@ -336,10 +339,8 @@ struct hash_fnv32 {
   }
 };
 
-using LruStack      = std::list<UrlStats>;
 using OriginStorage = std::unordered_map<const char *, OriginStats *, hash_fnv32, eqstr>;
 using OriginSet     = std::unordered_set<const char *, hash_fnv32, eqstr>;
-using LruHash       = std::unordered_map<const char *, LruStack::iterator, hash_fnv32, eqstr>;
 
 // Resize a hash-based container.
 template <class T, class N>
@@ -349,44 +350,52 @@ rehash(T &container, N size)
   container.rehash(size);
 }
 
-// LRU class for the URL data
+// The top URLs by requests, kept in a space-saving sketch of a fixed number of counters: a URL
+// which is not counted takes the counter of the least requested one, and its estimate of
+// requests starts from the estimate of that one. Every URL of more than 1 / size of the
+// requests is counted, and the stats of a URL are those since it last took a counter. The
+// sketches of several threads are merged into one of the same size. A size of 0 counts every URL.
 void update_elapsed(ElapsedStats &stat, const int elapsed, const StatsCounter &counter);
+void merge_elapsed(ElapsedStats &stat, int64_t count, const ElapsedStats &other, int64_t other_count);
 
-class UrlLru
+class UrlTopK
 {
 public:
-  UrlLru(int size = 1000000, int show_urls = 0) : _size(size)
+  UrlTopK(int size = 1000000, int show_urls = 0) : _size(size > 0 ? size : 0), _show_urls(show_urls)
   {
-    _show_urls = size > 0 ? (show_urls >= size ? size - 1 : show_urls) : show_urls;
-    _init();
-    _reset(false);
-    _cur = _stack.begin();
+    if (_size > 0) {
+      _entries.reserve(_size);
+      _heap.reserve(_size);
+      rehash(_hash, _size);
+    }
   }
 
-  void
-  resize(int size = 0)
+  ~UrlTopK()
   {
-    if (0 != size) {
-      _size = size;
+    for (auto &e : _entries) {
+      ats_free(const_cast<char *>(e.stats.url));
     }
-
-    _init();
-    _reset(true);
-    _cur = _stack.begin();
   }
 
   void
   dump(int as_object = 0)
   {
-    int show = _stack.size();
+    std::vector<const Entry *> sorted;
+    size_t show = _entries.size();
 
-    if (_show_urls > 0 && _show_urls < show) {
+    if (_show_urls > 0 && static_cast<size_t>(_show_urls) < show) {
       show = _show_urls;
     }
 
-    _stack.sort();
-    for (LruStack::iterator u = _stack.begin(); nullptr != u->url && --show >= 0; ++u) {
-      _dump_url(u, as_object);
+    sorted.reserve(_entries.size());
+    for (auto const &e : _entries) {
+      sorted.push_back(&e);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b) {
+      return a->estimate != b->estimate ? a->estimate > b->estimate : a->stats.req.count > b->stats.req.count;
+    });
+    for (size_t i = 0; i < show; ++i) {
+      _dump_url(sorted[i]->stats, as_object);
     }
     if (as_object) {
       std::cout << "  \"_timestamp\" : \"" << static_cast<int>(ink_time_wall_seconds()) << "\"" << std::endl;
@@ -396,182 +405,256 @@ public:
   }
 
   void
-  add_stat(const char *url, int64_t bytes, int time, int result, int http_code, int as_object = 0)
+  add_stat(const char *url, int64_t bytes, int time, int result, int http_code)
   {
-    LruHash::iterator h = _hash.find(url);
+    UrlHash::iterator h = _hash.find(url);
+    size_t i;
 
     if (h != _hash.end()) {
-      LruStack::iterator &l = h->second;
-
-      ++(l->req.count);
-      l->req.bytes += bytes;
-
-      if ((http_code >= 600) || (http_code < 200)) {
-        ++(l->c_000);
-      } else if (http_code >= 500) {
-        ++(l->c_5xx);
-      } else if (http_code >= 400) {
-        ++(l->c_4xx);
-      } else if (http_code >= 300) {
-        ++(l->c_3xx);
-      } else { // http_code >= 200
-        ++(l->c_2xx);
-      }
+      i = h->second;
+      ++_entries[i].estimate;
+      _count(_entries[i].stats, bytes, time, result, http_code);
+      _sift_down(_entries[i].heap);
+    } else if (_size == 0 || _entries.size() < _size) {
+      i = _add(url, 1);
+      _count(_entries[i].stats, bytes, time, result, http_code);
+    } else {
+      // take the counter of the least requested URL
+      i          = _heap[0];
+      Entry &e   = _entries[i];
+      int64_t at = e.estimate;
+
+      _hash.erase(e.stats.url);
+      ats_free(const_cast<char *>(e.stats.url));
+      e            = Entry();
+      e.stats.url  = ats_strdup(url);
+      e.estimate   = at + 1;
+      e.heap       = 0;
+      _hash[e.stats.url] = i;
+      _init_url(e.stats);
+      _count(e.stats, bytes, time, result, http_code);
+      _sift_down(0);
+    }
+  }
 
-      switch (result) {
-      case SQUID_LOG_TCP_HIT:
-      case SQUID_LOG_TCP_IMS_HIT:
-      case SQUID_LOG_TCP_REFRESH_HIT:
-      case SQUID_LOG_TCP_DISK_HIT:
-      case SQUID_LOG_TCP_MEM_HIT:
-      case SQUID_LOG_TCP_REF_FAIL_HIT:
-      case SQUID_LOG_UDP_HIT:
-      case SQUID_LOG_UDP_WEAK_HIT:
-      case SQUID_LOG_UDP_HIT_OBJ:
-        ++(l->hits);
-        break;
-      case SQUID_LOG_TCP_MISS:
-      case SQUID_LOG_TCP_IMS_MISS:
-      case SQUID_LOG_TCP_REFRESH_MISS:
-      case SQUID_LOG_TCP_EXPIRED_MISS:
-      case SQUID_LOG_TCP_WEBFETCH_MISS:
-      case SQUID_LOG_UDP_MISS:
-        ++(l->misses);
-        break;
-      case SQUID_LOG_ERR_CLIENT_ABORT:
-      case SQUID_LOG_ERR_CLIENT_READ_ERROR:
-      case SQUID_LOG_ERR_CONNECT_FAIL:
-      case SQUID_LOG_ERR_INVALID_REQ:
-      case SQUID_LOG_ERR_UNKNOWN:
-      case SQUID_LOG_ERR_READ_TIMEOUT:
-        ++(l->errors);
-        break;
-      }
+  // Merge the sketch of @a other into this one, keeping the size of this one.
+  void
+  merge(const UrlTopK &other)
+  {
+    // a URL not counted by a full sketch may have had up to its least estimate of requests
+    int64_t least       = _full() ? _entries[_heap[0]].estimate : 0;
+    int64_t other_least = other._full() ? other._entries[other._heap[0]].estimate : 0;
 
-      update_elapsed(l->time, time, l->req);
-      // Move this entry to the top of the stack (hence, LRU)
-      if (_size > 0) {
-        _stack.splice(_stack.begin(), _stack, l);
+    for (auto &e : _entries) {
+      if (other._hash.find(e.stats.url) == other._hash.end()) {
+        e.estimate += other_least;
       }
-    } else {                                  // "new" URL
-      const char *u        = ats_strdup(url); // We own it.
-      LruStack::iterator l = _stack.end();
+    }
+    for (auto const &o : other._entries) {
+      UrlHash::iterator h = _hash.find(o.stats.url);
 
-      if (_size > 0) {
-        if (_cur == l) { // LRU is full, take the last one
-          --l;
-          h = _hash.find(l->url);
-          if (h != _hash.end()) {
-            _hash.erase(h);
-          }
-          if (0 == _show_urls) {
-            _dump_url(l, as_object);
-          }
-        } else {
-          l = _cur++;
-        }
-        ats_free(const_cast<char *>(l->url)); // We no longer own this string.
+      if (h != _hash.end()) {
+        Entry &e = _entries[h->second];
+        e.estimate += o.estimate;
+        _merge_url(e.stats, o.stats);
       } else {
-        l = _stack.insert(l, UrlStats()); // This seems faster than having a static "template" ...
-      }
-
-      // Setup this URL stat
-      l->url       = u;
-      l->req.bytes = bytes;
-      l->req.count = 1;
-
-      if ((http_code >= 600) || (http_code < 200)) {
-        l->c_000 = 1;
-      } else if (http_code >= 500) {
-        l->c_5xx = 1;
-      } else if (http_code >= 400) {
-        l->c_4xx = 1;
-      } else if (http_code >= 300) {
-        l->c_3xx = 1;
-      } else { // http_code >= 200
-        l->c_2xx = 1;
+        Entry e     = o;
+        e.estimate  = o.estimate + least;
+        e.stats.url = ats_strdup(o.stats.url);
+        _entries.push_back(e);
       }
+    }
 
-      switch (result) {
-      case SQUID_LOG_TCP_HIT:
-      case SQUID_LOG_TCP_IMS_HIT:
-      case SQUID_LOG_TCP_REFRESH_HIT:
-      case SQUID_LOG_TCP_DISK_HIT:
-      case SQUID_LOG_TCP_MEM_HIT:
-      case SQUID_LOG_TCP_REF_FAIL_HIT:
-      case SQUID_LOG_UDP_HIT:
-      case SQUID_LOG_UDP_WEAK_HIT:
-      case SQUID_LOG_UDP_HIT_OBJ:
-        l->hits = 1;
-        break;
-      case SQUID_LOG_TCP_MISS:
-      case SQUID_LOG_TCP_IMS_MISS:
-      case SQUID_LOG_TCP_REFRESH_MISS:
-      case SQUID_LOG_TCP_EXPIRED_MISS:
-      case SQUID_LOG_TCP_WEBFETCH_MISS:
-      case SQUID_LOG_UDP_MISS:
-        l->misses = 1;
-        break;
-      case SQUID_LOG_ERR_CLIENT_ABORT:
-      case SQUID_LOG_ERR_CLIENT_READ_ERROR:
-      case SQUID_LOG_ERR_CONNECT_FAIL:
-      case SQUID_LOG_ERR_INVALID_REQ:
-      case SQUID_LOG_ERR_UNKNOWN:
-      case SQUID_LOG_ERR_READ_TIMEOUT:
-        l->errors = 1;
-        break;
+    if (_size > 0 && _entries.size() > _size) {
+      std::nth_element(_entries.begin(), _entries.begin() + _size, _entries.end(),
+                       [](const Entry &a, const Entry &b) { return a.estimate > b.estimate; });
+      for (size_t i = _size; i < _entries.size(); ++i) {
+        ats_free(const_cast<char *>(_entries[i].stats.url));
       }
+      _entries.resize(_size);
+    }
 
-      l->time.min = -1;
-      l->time.max = -1;
-      update_elapsed(l->time, time, l->req);
-      _hash[u] = l;
-
-      // We running a real LRU or not?
+    // the entries moved, so index them again
+    _hash.clear();
+    _heap.clear();
+    for (size_t i = 0; i < _entries.size(); ++i) {
+      _hash[_entries[i].stats.url] = i;
       if (_size > 0) {
-        _stack.splice(_stack.begin(), _stack, l); // Move this to the top of the stack
+        _entries[i].heap = i;
+        _heap.push_back(i);
       }
     }
+    for (size_t i = _heap.size() / 2; i-- > 0;) {
+      _sift_down(i);
+    }
   }
 
 private:
-  void
-  _init()
+  struct Entry {
+    UrlStats stats;
+    int64_t estimate; // requests of the URL, and of the URLs which had its counter before
+    size_t heap;      // position of the entry in _heap
+  };
+  using UrlHash = std::unordered_map<const char *, size_t, hash_fnv32, eqstr>;
+
+  bool
+  _full() const
   {
+    return _size > 0 && _entries.size() >= _size;
+  }
+
+  size_t
+  _add(const char *url, int64_t estimate)
+  {
+    size_t i = _entries.size();
+
+    _entries.emplace_back();
+    Entry &e    = _entries.back();
+    e.stats.url = ats_strdup(url); // We own it.
+    e.estimate  = estimate;
+    _init_url(e.stats);
+    _hash[e.stats.url] = i;
     if (_size > 0) {
-      _stack.resize(_size);
-      rehash(_hash, _size);
+      e.heap = _heap.size();
+      _heap.push_back(i);
+      _sift_up(e.heap);
+    }
+    return i;
+  }
+
+  static void
+  _init_url(UrlStats &u)
+  {
+    u.time.min = -1;
+    u.time.max = -1;
+  }
+
+  static void
+  _count(UrlStats &u, int64_t bytes, int time, int result, int http_code)
+  {
+    ++(u.req.count);
+    u.req.bytes += bytes;
+
+    if ((http_code >= 600) || (http_code < 200)) {
+      ++(u.c_000);
+    } else if (http_code >= 500) {
+      ++(u.c_5xx);
+    } else if (http_code >= 400) {
+      ++(u.c_4xx);
+    } else if (http_code >= 300) {
+      ++(u.c_3xx);
+    } else { // http_code >= 200
+      ++(u.c_2xx);
+    }
+
+    switch (result) {
+    case SQUID_LOG_TCP_HIT:
+    case SQUID_LOG_TCP_IMS_HIT:
+    case SQUID_LOG_TCP_REFRESH_HIT:
+    case SQUID_LOG_TCP_DISK_HIT:
+    case SQUID_LOG_TCP_MEM_HIT:
+    case SQUID_LOG_TCP_REF_FAIL_HIT:
+    case SQUID_LOG_UDP_HIT:
+    case SQUID_LOG_UDP_WEAK_HIT:
+    case SQUID_LOG_UDP_HIT_OBJ:
+      ++(u.hits);
+      break;
+    case SQUID_LOG_TCP_MISS:
+    case SQUID_LOG_TCP_IMS_MISS:
+    case SQUID_LOG_TCP_REFRESH_MISS:
+    case SQUID_LOG_TCP_EXPIRED_MISS:
+    case SQUID_LOG_TCP_WEBFETCH_MISS:
+    case SQUID_LOG_UDP_MISS:
+      ++(u.misses);
+      break;
+    case SQUID_LOG_ERR_CLIENT_ABORT:
+    case SQUID_LOG_ERR_CLIENT_READ_ERROR:
+    case SQUID_LOG_ERR_CONNECT_FAIL:
+    case SQUID_LOG_ERR_INVALID_REQ:
+    case SQUID_LOG_ERR_UNKNOWN:
+    case SQUID_LOG_ERR_READ_TIMEOUT:
+      ++(u.errors);
+      break;
+    }
+
+    update_elapsed(u.time, time, u.req);
+  }
+
+  static void
+  _merge_url(UrlStats &u, const UrlStats &o)
+  {
+    merge_elapsed(u.time, u.req.count, o.time, o.req.count);
+    u.req.count += o.req.count;
+    u.req.bytes += o.req.bytes;
+    u.c_000 += o.c_000;
+    u.c_2xx += o.c_2xx;
+    u.c_3xx += o.c_3xx;
+    u.c_4xx += o.c_4xx;
+    u.c_5xx += o.c_5xx;
+    u.hits += o.hits;
+    u.misses += o.misses;
+    u.errors += o.errors;
+  }
+
+  // The heap keeps the least requested URL first.
+  bool
+  _before(size_t a, size_t b) const
+  {
+    return _entries[_heap[a]].estimate < _entries[_heap[b]].estimate;
+  }
+
+  void
+  _swap(size_t a, size_t b)
+  {
+    std::swap(_heap[a], _heap[b]);
+    _entries[_heap[a]].heap = a;
+    _entries[_heap[b]].heap = b;
+  }
+
+  void
+  _sift_up(size_t p)
+  {
+    while (p > 0 && _before(p, (p - 1) / 2)) {
+      _swap(p, (p - 1) / 2);
+      p = (p - 1) / 2;
     }
   }
 
   void
-  _reset(bool free = false)
+  _sift_down(size_t p)
   {
-    for (LruStack::iterator l = _stack.begin(); l != _stack.end(); ++l) {
-      if (free && l->url) {
-        ats_free(const_cast<char *>(l->url));
+    if (_size == 0) {
+      return;
+    }
+    for (size_t c = 2 * p + 1; c < _heap.size(); c = 2 * p + 1) {
+      if (c + 1 < _heap.size() && _before(c + 1, c)) {
+        ++c;
       }
-      memset(&(*l), 0, sizeof(UrlStats));
+      if (!_before(c, p)) {
+        break;
+      }
+      _swap(c, p);
+      p = c;
     }
   }
 
   void
-  _dump_url(LruStack::iterator &u, int as_object)
+  _dump_url(const UrlStats &u, int as_object)
   {
     if (as_object) {
-      std::cout << "  \"" << u->url << "\" : { ";
+      std::cout << "  \"" << u.url << "\" : { ";
     } else {
-      std::cout << "  { \"" << u->url << "\" : { ";
+      std::cout << "  { \"" << u.url << "\" : { ";
       // Requests
     }
-    std::cout << "\"req\" : { \"total\" : \"" << u->req.count << "\", \"hits\" : \"" << u->hits << "\", \"misses\" : \""
-              << u->misses << "\", \"errors\" : \"" << u->errors << "\", \"000\" : \"" << u->c_000 << "\", \"2xx\" : \"" << u->c_2xx
-              << "\", \"3xx\" : \"" << u->c_3xx << "\", \"4xx\" : \"" << u->c_4xx << "\", \"5xx\" : \"" << u->c_5xx << "\" }, ";
-    std::cout << "\"bytes\" : \"" << u->req.bytes << "\", ";
+    std::cout << "\"req\" : { \"total\" : \"" << u.req.count << "\", \"hits\" : \"" << u.hits << "\", \"misses\" : \"" << u.misses
+              << "\", \"errors\" : \"" << u.errors << "\", \"000\" : \"" << u.c_000 << "\", \"2xx\" : \"" << u.c_2xx
+              << "\", \"3xx\" : \"" << u.c_3xx << "\", \"4xx\" : \"" << u.c_4xx << "\", \"5xx\" : \"" << u.c_5xx << "\" }, ";
+    std::cout << "\"bytes\" : \"" << u.req.bytes << "\", ";
     // Service times
-    std::cout << "\"svc_t\" : { \"min\" : \"" << u->time.min << "\", \"max\" : \"" << u->time.max << "\", \"avg\" : \""
-              << std::setiosflags(ios::fixed) << std::setprecision(2) << u->time.avg << "\", \"dev\" : \""
-              << std::setiosflags(ios::fixed) << std::setprecision(2) << u->time.stddev;
+    std::cout << "\"svc_t\" : { \"min\" : \"" << u.time.min << "\", \"max\" : \"" << u.time.max << "\", \"avg\" : \""
+              << std::setiosflags(ios::fixed) << std::setprecision(2) << u.time.avg << "\", \"dev\" : \""
+              << std::setiosflags(ios::fixed) << std::setprecision(2) << u.time.stddev;
 
     if (as_object) {
       std::cout << "\" } }," << std::endl;
@@ -580,19 +663,37 @@ private:
     }
   }
 
-  LruHash _hash;
-  LruStack _stack;
-  int _size, _show_urls;
-  LruStack::iterator _cur;
+  UrlHash _hash;
+  std::vector<Entry> _entries;
+  std::vector<size_t> _heap;
+  size_t _size;
+  int _show_urls;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// The stats accumulated by a thread of the parse, merged into those of the
+// main thread once all the logs are parsed.
+struct LogStats {
+  LogStats();
+  ~LogStats();
+
+  void merge(LogStats &other);
+
+  OriginStats totals;
+  OriginStorage origins;
+  std::unique_ptr<UrlTopK> urls;
+  std::unique_ptr<LogFieldList> fieldlist; // of the first log buffer parsed
+  int parse_errors = 0;
+
+  // noncopyable
+  LogStats(const LogStats &) = delete;
+  LogStats &operator=(const LogStats &) = delete;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 // Globals, holding the accumulated stats (ok, I'm lazy ...)
-static OriginStats totals;
-static OriginStorage origins;
+static LogStats main_stats;
 static OriginSet *origin_set;
-static UrlLru *urls;
-static int parse_errors;
 
 // Command line arguments (parsing)
 struct CommandLineArgs {
@@ -609,12 +710,13 @@ struct CommandLineArgs {
   int summary         = 0; // Summary only
   int json            = 0; // JSON output
   int cgi             = 0; // CGI output (typically with json)
-  int urls            = 0; // Produce JSON output of URL stats, arg is LRU size
+  int urls            = 0; // Produce JSON output of URL stats, arg is the size of the top URLs sketch
   int show_urls       = 0; // Max URLs to show
   int as_object       = 0; // Show the URL stats as a single JSON object (not array)
   int concise         = 0; // Eliminate metrics that can be inferred by other values
   int report_per_user = 0; // A flag to aggregate and report stats per user instead of per host if 'true' (default 'false')
   int no_format_check = 0; // A flag to skip the log format check if any of the fields is not a standard squid log format field.
+  int threads         = 0; // Threads parsing the logs, 0 for one per CPU
 
   CommandLineArgs() : line_len(DEFAULT_LINE_LEN)
 
@@ -635,7 +737,7 @@ static ArgumentDescription argument_descriptions[] = {
   {"origin_list", 'o', "Only show stats for listed Origins", "S4095", cl.origin_list, nullptr, nullptr},
   {"origin_file", 'O', "File listing Origins to show", "S1023", cl.origin_file, nullptr, nullptr},
   {"max_origins", 'M', "Max number of Origins to show", "I", &cl.max_origins, nullptr, nullptr},
-  {"urls", 'u', "Produce JSON stats for URLs, argument is LRU size", "I", &cl.urls, nullptr, nullptr},
+  {"urls", 'u', "Produce JSON stats for the top URLs, argument is how many are counted", "I", &cl.urls, nullptr, nullptr},
   {"show_urls", 'U', "Only show max this number of URLs", "I", &cl.show_urls, nullptr, nullptr},
   {"as_object", 'A', "Produce URL stats as a JSON object instead of array", "T", &cl.as_object, nullptr, nullptr},
   {"concise", 'C', "Eliminate metrics that can be inferred from other values", "T", &cl.concise, nullptr, nullptr},
@@ -651,11 +753,13 @@ static ArgumentDescription argument_descriptions[] = {
   {"debug_tags", 'T', "Colon-Separated Debug Tags", "S1023", &error_tags, nullptr, nullptr},
   {"report_per_user", 'r', "Report stats per user instead of host", "T", &cl.report_per_user, nullptr, nullptr},
   {"no_format_check", 'n', "Don't validate the log format field names", "T", &cl.no_format_check, nullptr, nullptr},
+  {"threads", 'N', "Number of threads parsing the logs, 0 for one per CPU", "I", &cl.threads, nullptr, nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
   RUNROOT_ARGUMENT_DESCRIPTION()};
 
-static const char *USAGE_LINE = "Usage: " PROGRAM_NAME " [-f logfile] [-o origin[,...]] [-O originfile] [-m minhits] [-binshv]";
+static const char *USAGE_LINE =
+  "Usage: " PROGRAM_NAME " [-f logfile] [-o origin[,...]] [-O originfile] [-m minhits] [-binshv] [logfile ...]";
 
 void
 CommandLineArgs::parse_arguments(const char **argv)
@@ -1183,10 +1287,106 @@ update_protocols(OriginStats *stat, bool ipv6, int size)
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Merge the stats of another thread, of @a other_count events, into @a stat of @a count events
+void
+merge_elapsed(ElapsedStats &stat, int64_t count, const ElapsedStats &other, int64_t other_count)
+{
+  int64_t newcount = count + other_count;
+  double avg, sum_of_squares;
+
+  if (-1 != other.min && (-1 == stat.min || stat.min > other.min)) {
+    stat.min = other.min;
+  }
+  if (stat.max < other.max) {
+    stat.max = other.max;
+  }
+  if (0 == newcount) {
+    return;
+  }
+
+  avg            = (static_cast<double>(stat.avg) * count + static_cast<double>(other.avg) * other_count) / newcount;
+  sum_of_squares = count * (static_cast<double>(stat.stddev) * stat.stddev + static_cast<double>(stat.avg) * stat.avg) +
+                   other_count * (static_cast<double>(other.stddev) * other.stddev + static_cast<double>(other.avg) * other.avg);
+  stat.stddev = sqrt(std::max(0.0, sum_of_squares / newcount - avg * avg));
+  stat.avg    = avg;
+}
+
+inline void
+merge_counter(StatsCounter &counter, const StatsCounter &other)
+{
+  counter.count += other.count;
+  counter.bytes += other.bytes;
+}
+
+void
+merge_origin_stats(OriginStats *stat, const OriginStats *other)
+{
+  // The elapsed stats are those of the hits and misses results, in the same order. They are
+  // merged first, by the counts of the results before these are merged.
+  constexpr size_t n_elapsed = sizeof(stat->elapsed) / sizeof(ElapsedStats);
+  static_assert(n_elapsed == (sizeof(stat->results.hits) + sizeof(stat->results.misses)) / sizeof(StatsCounter),
+                "an elapsed stat for each hit and miss result");
+  ElapsedStats *elapsed             = reinterpret_cast<ElapsedStats *>(&stat->elapsed);
+  const ElapsedStats *other_elapsed = reinterpret_cast<const ElapsedStats *>(&other->elapsed);
+  StatsCounter *counters            = reinterpret_cast<StatsCounter *>(&stat->results);
+  const StatsCounter *other_counter = reinterpret_cast<const StatsCounter *>(&other->results);
+
+  for (size_t i = 0; i < n_elapsed; ++i) {
+    merge_elapsed(elapsed[i], counters[i].count, other_elapsed[i], other_counter[i].count);
+  }
+
+  // Everything from the results on is a StatsCounter.
+  constexpr size_t counters_size = sizeof(OriginStats) - offsetof(OriginStats, results);
+  static_assert(counters_size % sizeof(StatsCounter) == 0, "only counters after the elapsed stats");
+  for (size_t i = 0; i < counters_size / sizeof(StatsCounter); ++i) {
+    merge_counter(counters[i], other_counter[i]);
+  }
+  merge_counter(stat->total, other->total);
+}
+
+LogStats::LogStats()
+{
+  memset(&totals, 0, sizeof(totals));
+  init_elapsed(&totals);
+}
+
+LogStats::~LogStats()
+{
+  for (auto &i : origins) {
+    ats_free(i.second);
+    ats_free(const_cast<char *>(i.first));
+  }
+}
+
+void
+LogStats::merge(LogStats &other)
+{
+  merge_origin_stats(&totals, &other.totals);
+  for (auto &i : other.origins) {
+    OriginStorage::iterator o_iter = origins.find(i.first);
+
+    if (origins.end() == o_iter) {
+      // take it over from the other thread
+      origins[i.first] = i.second;
+    } else {
+      merge_origin_stats(o_iter->second, i.second);
+      ats_free(i.second);
+      ats_free(const_cast<char *>(i.first));
+    }
+  }
+  other.origins.clear();
+
+  if (urls && other.urls) {
+    urls->merge(*other.urls);
+  }
+  parse_errors += other.parse_errors;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Finds or creates a stats structures if missing
 OriginStats *
-find_or_create_stats(const char *key)
+find_or_create_stats(LogStats &stats, const char *key)
 {
   OriginStats *o_stats = nullptr;
   OriginStorage::iterator o_iter;
@@ -1195,15 +1395,15 @@ find_or_create_stats(const char *key)
   // TODO: If we save state (struct) for a run, we probably need to always
   // update the origin data, no matter what the origin_set is.
   if (origin_set->empty() || (origin_set->find(key) != origin_set->end())) {
-    o_iter = origins.find(key);
-    if (origins.end() == o_iter) {
+    o_iter = stats.origins.find(key);
+    if (stats.origins.end() == o_iter) {
       o_stats = static_cast<OriginStats *>(ats_malloc(sizeof(OriginStats)));
       memset(o_stats, 0, sizeof(OriginStats));
       init_elapsed(o_stats);
       o_server = ats_strdup(key);
       if (o_server) {
-        o_stats->server   = o_server;
-        origins[o_server] = o_stats;
+        o_stats->server         = o_server;
+        stats.origins[o_server] = o_stats;
       }
     } else {
       o_stats = o_iter->second;
@@ -1215,15 +1415,15 @@ find_or_create_stats(const char *key)
 ///////////////////////////////////////////////////////////////////////////////
 // Update the stats
 void
-update_stats(OriginStats *o_stats, const HTTPMethod method, URLScheme scheme, int http_code, int size, int result, int hier,
-             int elapsed, bool ipv6)
+update_stats(LogStats &stats, OriginStats *o_stats, const HTTPMethod method, URLScheme scheme, int http_code, int size, int result,
+             int hier, int elapsed, bool ipv6)
 {
-  update_results_elapsed(&totals, result, elapsed, size);
-  update_codes(&totals, http_code, size);
-  update_methods(&totals, method, size);
-  update_schemes(&totals, scheme, size);
-  update_protocols(&totals, ipv6, size);
-  update_counter(totals.total, size);
+  update_results_elapsed(&stats.totals, result, elapsed, size);
+  update_codes(&stats.totals, http_code, size);
+  update_methods(&stats.totals, method, size);
+  update_schemes(&stats.totals, scheme, size);
+  update_protocols(&stats.totals, ipv6, size);
+  update_counter(stats.totals.total, size);
   if (nullptr != o_stats) {
     update_results_elapsed(o_stats, result, elapsed, size);
     update_codes(o_stats, http_code, size);
@@ -1237,10 +1437,8 @@ update_stats(OriginStats *o_stats, const HTTPMethod method, URLScheme scheme, in
 ///////////////////////////////////////////////////////////////////////////////
 // Parse a log buffer
 int
-parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate_per_userid = false)
+parse_log_buff(LogStats &stats, LogBufferHeader *buf_header, bool summary = false, bool aggregate_per_userid = false)
 {
-  static LogFieldList *fieldlist = nullptr;
-
   LogEntryHeader *entry;
   LogBufferIterator buf_iter(buf_header);
   LogField *field = nullptr;
@@ -1259,12 +1457,12 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
   HTTPMethod method;
   URLScheme scheme;
 
-  if (!fieldlist) {
-    fieldlist = new LogFieldList;
-    ink_assert(fieldlist != nullptr);
+  if (!stats.fieldlist) {
+    stats.fieldlist.reset(new LogFieldList);
     bool agg = false;
-    LogFormat::parse_symbol_string(buf_header->fmt_fieldlist(), fieldlist, &agg);
+    LogFormat::parse_symbol_string(buf_header->fmt_fieldlist(), stats.fieldlist.get(), &agg);
   }
+  LogFieldList *fieldlist = stats.fieldlist.get();
 
   if (!cl.no_format_check) {
     // Validate the fieldlist
@@ -1397,8 +1595,8 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
 
       case P_STATE_URL:
         state = P_STATE_RFC931;
-        if (urls) {
-          urls->add_stat(read_from, size, elapsed, result, http_code, cl.as_object);
+        if (stats.urls) {
+          stats.urls->add_stat(read_from, size, elapsed, result, http_code);
         }
 
         // TODO check for read_from being empty string
@@ -1431,7 +1629,7 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
             *ptr = '\0';
           }
           if (!aggregate_per_userid && !summary) {
-            o_stats = find_or_create_stats(tok);
+            o_stats = find_or_create_stats(stats, tok);
           }
         } else {
           // No method given
@@ -1442,7 +1640,7 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
         }
         read_from += LogAccess::round_strlen(tok_len + 1);
         if (!aggregate_per_userid) {
-          update_stats(o_stats, method, scheme, http_code, size, result, hier, elapsed, ipv6);
+          update_stats(stats, o_stats, method, scheme, http_code, size, result, hier, elapsed, ipv6);
         }
         break;
 
@@ -1451,9 +1649,9 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
 
         if (aggregate_per_userid) {
           if (!summary) {
-            o_stats = find_or_create_stats(read_from);
+            o_stats = find_or_create_stats(stats, read_from);
           }
-          update_stats(o_stats, method, scheme, http_code, size, result, hier, elapsed, ipv6);
+          update_stats(stats, o_stats, method, scheme, http_code, size, result, hier, elapsed, ipv6);
         }
 
         if ('-' == *read_from) {
@@ -1468,43 +1666,43 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
         hier  = *((int64_t *)(read_from));
         switch (hier) {
         case SQUID_HIER_NONE:
-          update_counter(totals.hierarchies.none, size);
+          update_counter(stats.totals.hierarchies.none, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->hierarchies.none, size);
           }
           break;
         case SQUID_HIER_DIRECT:
-          update_counter(totals.hierarchies.direct, size);
+          update_counter(stats.totals.hierarchies.direct, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->hierarchies.direct, size);
           }
           break;
         case SQUID_HIER_SIBLING_HIT:
-          update_counter(totals.hierarchies.sibling, size);
+          update_counter(stats.totals.hierarchies.sibling, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->hierarchies.sibling, size);
           }
           break;
         case SQUID_HIER_PARENT_HIT:
-          update_counter(totals.hierarchies.parent, size);
+          update_counter(stats.totals.hierarchies.parent, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->hierarchies.direct, size);
           }
           break;
         case SQUID_HIER_EMPTY:
-          update_counter(totals.hierarchies.empty, size);
+          update_counter(stats.totals.hierarchies.empty, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->hierarchies.empty, size);
           }
           break;
         default:
           if ((hier >= SQUID_HIER_EMPTY) && (hier < SQUID_HIER_INVALID_ASSIGNED_CODE)) {
-            update_counter(totals.hierarchies.other, size);
+            update_counter(stats.totals.hierarchies.other, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->hierarchies.other, size);
             }
           } else {
-            update_counter(totals.hierarchies.invalid, size);
+            update_counter(stats.totals.hierarchies.invalid, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->hierarchies.invalid, size);
             }
@@ -1526,7 +1724,7 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
       case P_STATE_TYPE:
         state = P_STATE_END;
         if (IMAG_AS_INT == *reinterpret_cast<int *>(read_from)) {
-          update_counter(totals.content.image.total, size);
+          update_counter(stats.totals.content.image.total, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.image.total, size);
           }
@@ -1534,42 +1732,42 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           switch (*reinterpret_cast<int *>(tok)) {
           case JPEG_AS_INT:
             tok_len = 10;
-            update_counter(totals.content.image.jpeg, size);
+            update_counter(stats.totals.content.image.jpeg, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.jpeg, size);
             }
             break;
           case JPG_AS_INT:
             tok_len = 9;
-            update_counter(totals.content.image.jpeg, size);
+            update_counter(stats.totals.content.image.jpeg, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.jpeg, size);
             }
             break;
           case GIF_AS_INT:
             tok_len = 9;
-            update_counter(totals.content.image.gif, size);
+            update_counter(stats.totals.content.image.gif, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.gif, size);
             }
             break;
           case PNG_AS_INT:
             tok_len = 9;
-            update_counter(totals.content.image.png, size);
+            update_counter(stats.totals.content.image.png, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.png, size);
             }
             break;
           case BMP_AS_INT:
             tok_len = 9;
-            update_counter(totals.content.image.bmp, size);
+            update_counter(stats.totals.content.image.bmp, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.bmp, size);
             }
             break;
           default:
             tok_len = 6 + strlen(tok);
-            update_counter(totals.content.image.other, size);
+            update_counter(stats.totals.content.image.other, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.image.other, size);
             }
@@ -1577,7 +1775,7 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           }
         } else if (TEXT_AS_INT == *reinterpret_cast<int *>(read_from)) {
           tok = read_from + 5;
-          update_counter(totals.content.text.total, size);
+          update_counter(stats.totals.content.text.total, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.text.total, size);
           }
@@ -1585,42 +1783,42 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           case JAVA_AS_INT:
             // TODO verify if really "javascript"
             tok_len = 15;
-            update_counter(totals.content.text.javascript, size);
+            update_counter(stats.totals.content.text.javascript, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.javascript, size);
             }
             break;
           case CSS_AS_INT:
             tok_len = 8;
-            update_counter(totals.content.text.css, size);
+            update_counter(stats.totals.content.text.css, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.css, size);
             }
             break;
           case XML_AS_INT:
             tok_len = 8;
-            update_counter(totals.content.text.xml, size);
+            update_counter(stats.totals.content.text.xml, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.xml, size);
             }
             break;
           case HTML_AS_INT:
             tok_len = 9;
-            update_counter(totals.content.text.html, size);
+            update_counter(stats.totals.content.text.html, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.html, size);
             }
             break;
           case PLAI_AS_INT:
             tok_len = 10;
-            update_counter(totals.content.text.plain, size);
+            update_counter(stats.totals.content.text.plain, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.plain, size);
             }
             break;
           default:
             tok_len = 5 + strlen(tok);
-            update_counter(totals.content.text.other, size);
+            update_counter(stats.totals.content.text.other, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.text.other, size);
             }
@@ -1628,28 +1826,28 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           }
         } else if (0 == strncmp(read_from, "application", 11)) {
           tok = read_from + 12;
-          update_counter(totals.content.application.total, size);
+          update_counter(stats.totals.content.application.total, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.application.total, size);
           }
           switch (*reinterpret_cast<int *>(tok)) {
           case ZIP_AS_INT:
             tok_len = 15;
-            update_counter(totals.content.application.zip, size);
+            update_counter(stats.totals.content.application.zip, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.application.zip, size);
             }
             break;
           case JAVA_AS_INT:
             tok_len = 22;
-            update_counter(totals.content.application.javascript, size);
+            update_counter(stats.totals.content.application.javascript, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.application.javascript, size);
             }
             break;
           case X_JA_AS_INT:
             tok_len = 24;
-            update_counter(totals.content.application.javascript, size);
+            update_counter(stats.totals.content.application.javascript, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.application.javascript, size);
             }
@@ -1657,19 +1855,19 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           case RSSp_AS_INT:
             if (0 == strcmp(tok + 4, "xml")) {
               tok_len = 19;
-              update_counter(totals.content.application.rss_xml, size);
+              update_counter(stats.totals.content.application.rss_xml, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.rss_xml, size);
               }
             } else if (0 == strcmp(tok + 4, "atom")) {
               tok_len = 20;
-              update_counter(totals.content.application.rss_atom, size);
+              update_counter(stats.totals.content.application.rss_atom, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.rss_atom, size);
               }
             } else {
               tok_len = 12 + strlen(tok);
-              update_counter(totals.content.application.rss_other, size);
+              update_counter(stats.totals.content.application.rss_other, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.rss_other, size);
               }
@@ -1678,19 +1876,19 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
           default:
             if (0 == strcmp(tok, "x-shockwave-flash")) {
               tok_len = 29;
-              update_counter(totals.content.application.shockwave_flash, size);
+              update_counter(stats.totals.content.application.shockwave_flash, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.shockwave_flash, size);
               }
             } else if (0 == strcmp(tok, "x-quicktimeplayer")) {
               tok_len = 29;
-              update_counter(totals.content.application.quicktime, size);
+              update_counter(stats.totals.content.application.quicktime, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.quicktime, size);
               }
             } else {
               tok_len = 12 + strlen(tok);
-              update_counter(totals.content.application.other, size);
+              update_counter(stats.totals.content.application.other, size);
               if (o_stats != nullptr) {
                 update_counter(o_stats->content.application.other, size);
               }
@@ -1699,35 +1897,35 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
         } else if (0 == strncmp(read_from, "audio", 5)) {
           tok     = read_from + 6;
           tok_len = 6 + strlen(tok);
-          update_counter(totals.content.audio.total, size);
+          update_counter(stats.totals.content.audio.total, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.audio.total, size);
           }
           if ((0 == strcmp(tok, "x-wav")) || (0 == strcmp(tok, "wav"))) {
-            update_counter(totals.content.audio.wav, size);
+            update_counter(stats.totals.content.audio.wav, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.audio.wav, size);
             }
           } else if ((0 == strcmp(tok, "x-mpeg")) || (0 == strcmp(tok, "mpeg"))) {
-            update_counter(totals.content.audio.mpeg, size);
+            update_counter(stats.totals.content.audio.mpeg, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.audio.mpeg, size);
             }
           } else {
-            update_counter(totals.content.audio.other, size);
+            update_counter(stats.totals.content.audio.other, size);
             if (o_stats != nullptr) {
               update_counter(o_stats->content.audio.other, size);
             }
           }
         } else if ('-' == *read_from) {
           tok_len = 1;
-          update_counter(totals.content.none, size);
+          update_counter(stats.totals.content.none, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.none, size);
           }
         } else {
           tok_len = strlen(read_from);
-          update_counter(totals.content.other, size);
+          update_counter(stats.totals.content.other, size);
           if (o_stats != nullptr) {
             update_counter(o_stats->content.other, size);
           }
@@ -1739,7 +1937,7 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
       case P_STATE_END:
         // Nothing to do really
         if (flag) {
-          parse_errors++;
+          stats.parse_errors++;
         }
         break;
       }
@@ -1751,12 +1949,75 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
 
 ///////////////////////////////////////////////////////////////////////////////
 // Process a file (FD)
+///////////////////////////////////////////////////////////////////////////////
+// Process a columnar log, each batch as the log buffer it was written from.
+int
+process_columnar_file(LogStats &stats, int in_fd, unsigned max_age)
+{
+  char buffer[MAX_LOGBUFFER_SIZE];
+  LogColumnarDecompressor decompressor;
+  LogColumnarIPC::Reader reader;
+  LogColumnarFields fields;
+  LogColumnarBatch batch;
+  std::string plain;
+  bool has_fields = false;
+
+  Debug("logstats", "Processing columnar file.");
+  while (true) {
+    int nread = read(in_fd, buffer, sizeof(buffer));
+    if (nread <= 0) {
+      return nread < 0 ? 1 : 0;
+    }
+    plain.clear();
+    if (!decompressor.decompress(buffer, nread, plain)) {
+      Debug("logstats", "Invalid zstd stream.");
+      return 1;
+    }
+    reader.feed(plain.data(), plain.size());
+
+    while (true) {
+      LogColumnarIPC::Reader::Result result = reader.next(batch);
+      if (result == LogColumnarIPC::Reader::NEED_MORE) {
+        break;
+      } else if (result != LogColumnarIPC::Reader::BATCH) {
+        Debug("logstats", "Arrow stream ended or is invalid (%d).", result);
+        return result == LogColumnarIPC::Reader::END ? 0 : 1;
+      }
+      if (!has_fields && !(has_fields = fields.init(batch))) {
+        Debug("logstats", "Arrow stream is not of a log.");
+        return 1;
+      }
+
+      LogBufferHeader *header = fields.decode(batch);
+      int error               = 0;
+      // Possibly skip too old entries (the entire buffer is skipped)
+      if (header && header->high_timestamp >= max_age) {
+        error = parse_log_buff(stats, header, cl.summary != 0, cl.report_per_user != 0);
+      }
+      ats_free(header);
+      if (error != 0) {
+        Debug("logstats", "Failed to parse log buffer.");
+        return 1;
+      }
+    }
+  }
+}
+
 int
-process_file(int in_fd, off_t offset, unsigned max_age)
+process_file(LogStats &stats, int in_fd, off_t offset, unsigned max_age)
 {
   char buffer[MAX_LOGBUFFER_SIZE];
   int nread, buffer_bytes;
 
+  // a columnar log is a compressed stream, which can only be read from its start
+  if (pread(in_fd, buffer, 4, 0) == 4 && log_columnar_magic(buffer, 4)) {
+    if (offset > 0) {
+      cerr << "Incremental processing of a columnar log is not supported" << endl;
+      return 1;
+    }
+    return process_columnar_file(stats, in_fd, max_age);
+  }
+
   Debug("logstats", "Processing file [offset=%" PRId64 "].", (int64_t)offset);
   while (true) {
     Debug("logstats", "Reading initial header.");
@@ -1860,7 +2121,7 @@ process_file(int in_fd, off_t offset, unsigned max_age)
 
     // Possibly skip too old entries (the entire buffer is skipped)
     if (header->high_timestamp >= max_age) {
-      if (parse_log_buff(header, cl.summary != 0, cl.report_per_user != 0) != 0) {
+      if (parse_log_buff(stats, header, cl.summary != 0, cl.report_per_user != 0) != 0) {
         Debug("logstats", "Failed to parse log buffer.");
         return 1;
       }
@@ -1872,6 +2133,366 @@ process_file(int in_fd, off_t offset, unsigned max_age)
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Parallel parsing of several logs, and of ranges of the large ones. A log
+// buffer is parsed by the thread of the range it starts in.
+const size_t LOG_RANGE_SIZE = 64 * 1024 * 1024;
+
+struct LogWork {
+  enum Kind {
+    RANGE,  // a range of a binary log, mapped in memory
+    GZIP,   // a binary log compressed by gzip
+    ZSTD,   // a binary log compressed by zstd, or a columnar log
+    STREAM, // a pipe, read as process_file() does
+  };
+
+  Kind kind;
+  const char *name;
+  int fd;
+  const char *data;
+  size_t size;
+  size_t start;
+  size_t end;
+};
+
+static bool
+valid_log_header(const LogBufferHeader *header)
+{
+  return LOG_SEGMENT_COOKIE == header->cookie && LOG_SEGMENT_VERSION == header->version &&
+         header->byte_count > sizeof(LogBufferHeader) && header->byte_count <= MAX_LOGBUFFER_SIZE;
+}
+
+// Whether the log buffer at @a pos of the log of @a size is a valid one
+static bool
+valid_log_buffer(const char *data, size_t pos, size_t size)
+{
+  LogBufferHeader header;
+
+  if (size - pos < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, data + pos, sizeof(header));
+  return valid_log_header(&header) && header.byte_count <= size - pos;
+}
+
+// The offset of the first log buffer at or after @a pos: a valid header followed by
+// another one, or by the end of the log, so that a cookie in the data is not taken for one.
+static size_t
+find_log_buffer(const char *data, size_t pos, size_t size)
+{
+  const uint32_t cookie = LOG_SEGMENT_COOKIE;
+
+  for (; pos + sizeof(LogBufferHeader) <= size; ++pos) {
+    const char *found = static_cast<const char *>(memmem(data + pos, size - pos, &cookie, sizeof(cookie)));
+
+    if (nullptr == found) {
+      break;
+    }
+    pos = found - data;
+    if (valid_log_buffer(data, pos, size)) {
+      const LogBufferHeader *header = reinterpret_cast<const LogBufferHeader *>(found);
+      uint32_t byte_count;
+
+      memcpy(&byte_count, &header->byte_count, sizeof(byte_count));
+      if (pos + byte_count == size || valid_log_buffer(data, pos + byte_count, size)) {
+        return pos;
+      }
+    }
+  }
+  return size;
+}
+
+// Parse the log buffers starting within [start, end) of a binary log
+static int
+process_log_range(LogStats &stats, const LogWork &work, unsigned max_age)
+{
+  alignas(LogBufferHeader) char buffer[MAX_LOGBUFFER_SIZE];
+  LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(buffer);
+  size_t pos              = work.start > 0 ? find_log_buffer(work.data, work.start, work.size) : 0;
+
+  Debug("logstats", "Processing %s [%zu, %zu), from %zu.", work.name, work.start, work.end, pos);
+  while (pos < work.end && work.size - pos >= sizeof(LogBufferHeader)) {
+    memcpy(buffer, work.data + pos, sizeof(LogBufferHeader));
+    if (!header->cookie) {
+      return 0;
+    }
+    if (!valid_log_buffer(work.data, pos, work.size)) {
+      Debug("logstats", "Invalid log buffer at offset %zu of %s.", pos, work.name);
+      return 1;
+    }
+    memcpy(buffer, work.data + pos, header->byte_count);
+    pos += header->byte_count;
+
+    // Possibly skip too old entries (the entire buffer is skipped)
+    if (header->high_timestamp >= max_age && parse_log_buff(stats, header, cl.summary != 0, cl.report_per_user != 0) != 0) {
+      Debug("logstats", "Failed to parse log buffer.");
+      return 1;
+    }
+  }
+  return 0;
+}
+
+#if HAVE_ZLIB_H
+// Decompresses the gzip members of a log rotated and compressed by gzip
+class GzipDecompressor
+{
+public:
+  GzipDecompressor()
+  {
+    memset(&_zs, 0, sizeof(_zs));
+    _ok = (Z_OK == inflateInit2(&_zs, 16 + MAX_WBITS));
+  }
+
+  ~GzipDecompressor()
+  {
+    if (_ok) {
+      inflateEnd(&_zs);
+    }
+  }
+
+  // Append @a data decompressed to @a out. False if the data is not a gzip stream.
+  bool
+  decompress(const char *data, size_t len, std::string &out)
+  {
+    char chunk[MAX_LOGBUFFER_SIZE];
+
+    if (!_ok) {
+      return false;
+    }
+    _zs.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    _zs.avail_in = len;
+    do {
+      _zs.next_out  = reinterpret_cast<Bytef *>(chunk);
+      _zs.avail_out = sizeof(chunk);
+
+      int ret = inflate(&_zs, Z_NO_FLUSH);
+      if (Z_OK != ret && Z_STREAM_END != ret && Z_BUF_ERROR != ret) {
+        return false;
+      }
+      out.append(chunk, sizeof(chunk) - _zs.avail_out);
+      _in_member = (Z_STREAM_END != ret);
+      // a file may be several members, one after the other
+      if (Z_STREAM_END == ret && Z_OK != inflateReset(&_zs)) {
+        return false;
+      }
+    } while (_zs.avail_in > 0 || 0 == _zs.avail_out);
+    return true;
+  }
+
+  // whether the data given so far ends within a member
+  bool
+  in_member() const
+  {
+    return _in_member;
+  }
+
+  GzipDecompressor(const GzipDecompressor &) = delete;
+  GzipDecompressor &operator=(const GzipDecompressor &) = delete;
+
+private:
+  z_stream _zs;
+  bool _ok        = false;
+  bool _in_member = false;
+};
+#endif
+
+// Parse a compressed binary log, from its start. A zstd stream which is not of a
+// binary log is that of a columnar log.
+static int
+process_compressed_file(LogStats &stats, const LogWork &work, unsigned max_age)
+{
+  char input[MAX_LOGBUFFER_SIZE];
+  alignas(LogBufferHeader) char buffer[MAX_LOGBUFFER_SIZE];
+  LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(buffer);
+  LogColumnarDecompressor zstd;
+#if HAVE_ZLIB_H
+  GzipDecompressor gzip;
+#else
+  if (LogWork::GZIP == work.kind) {
+    cerr << "Reading gzip compressed logs requires " PROGRAM_NAME " to be built with zlib" << endl;
+    return 1;
+  }
+#endif
+  std::string plain;
+  bool in_frame = false;
+  bool checked  = false;
+
+  Debug("logstats", "Processing compressed file %s.", work.name);
+  while (true) {
+    int nread = read(work.fd, input, sizeof(input));
+
+    if (nread < 0) {
+      return 1;
+    } else if (0 == nread) {
+      break;
+    }
+#if HAVE_ZLIB_H
+    if (LogWork::GZIP == work.kind) {
+      if (!gzip.decompress(input, nread, plain)) {
+        Debug("logstats", "Invalid gzip stream.");
+        return 1;
+      }
+      in_frame = gzip.in_member();
+    }
+#endif
+    if (LogWork::ZSTD == work.kind) {
+      if (!zstd.decompress(input, nread, plain)) {
+        Debug("logstats", "Invalid zstd stream.");
+        return 1;
+      }
+      in_frame = zstd.in_frame();
+    }
+
+    if (!checked && plain.size() >= sizeof(uint32_t)) {
+      uint32_t cookie;
+
+      checked = true;
+      memcpy(&cookie, plain.data(), sizeof(cookie));
+      if (LOG_SEGMENT_COOKIE != cookie && LogWork::ZSTD == work.kind) {
+        if (lseek(work.fd, 0, SEEK_SET) < 0) {
+          return 1;
+        }
+        return process_columnar_file(stats, work.fd, max_age);
+      }
+    }
+
+    size_t pos = 0;
+    while (plain.size() - pos >= sizeof(LogBufferHeader)) {
+      memcpy(buffer, plain.data() + pos, sizeof(LogBufferHeader));
+      if (!header->cookie) {
+        return 0;
+      }
+      if (!valid_log_header(header)) {
+        Debug("logstats", "Invalid log buffer in %s.", work.name);
+        return 1;
+      }
+      if (header->byte_count > plain.size() - pos) {
+        break; // the rest of this buffer is still to be decompressed
+      }
+      memcpy(buffer, plain.data() + pos, header->byte_count);
+      pos += header->byte_count;
+
+      // Possibly skip too old entries (the entire buffer is skipped)
+      if (header->high_timestamp >= max_age && parse_log_buff(stats, header, cl.summary != 0, cl.report_per_user != 0) != 0) {
+        Debug("logstats", "Failed to parse log buffer.");
+        return 1;
+      }
+    }
+    plain.erase(0, pos);
+  }
+
+  if (in_frame || !plain.empty()) {
+    Debug("logstats", "Compressed log %s is truncated.", work.name);
+    return 1;
+  }
+  return 0;
+}
+
+static int
+process_work(LogStats &stats, const LogWork &work, unsigned max_age)
+{
+  switch (work.kind) {
+  case LogWork::RANGE:
+    return process_log_range(stats, work, max_age);
+  case LogWork::GZIP:
+  case LogWork::ZSTD:
+    return process_compressed_file(stats, work, max_age);
+  case LogWork::STREAM:
+    return process_file(stats, work.fd, 0, max_age);
+  }
+  return 1;
+}
+
+// Add the work of parsing the log @a fd of @a name. A binary log is mapped in memory,
+// in ranges of LOG_RANGE_SIZE.
+static bool
+add_log_work(std::vector<LogWork> &work, const char *name, int fd)
+{
+  static const unsigned char gzip_magic[] = {0x1f, 0x8b};
+  char magic[4];
+  struct stat stat_buf;
+  LogWork w = {LogWork::STREAM, name, fd, nullptr, 0, 0, 0};
+
+  if (fstat(fd, &stat_buf) < 0) {
+    return false;
+  }
+  if (!S_ISREG(stat_buf.st_mode)) {
+    work.push_back(w);
+    return true;
+  }
+  if (0 == stat_buf.st_size) {
+    return true;
+  }
+
+  if (pread(fd, magic, sizeof(magic), 0) == sizeof(magic)) {
+    if (0 == memcmp(magic, gzip_magic, sizeof(gzip_magic))) {
+      w.kind = LogWork::GZIP;
+    } else if (log_columnar_magic(magic, sizeof(magic))) {
+      w.kind = LogWork::ZSTD;
+    }
+  }
+  if (LogWork::STREAM != w.kind) {
+    work.push_back(w);
+    return true;
+  }
+
+  void *data = mmap(nullptr, stat_buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (MAP_FAILED == data) {
+    return false;
+  }
+  ats_madvise(static_cast<caddr_t>(data), stat_buf.st_size, MADV_SEQUENTIAL);
+  w.kind = LogWork::RANGE;
+  w.data = static_cast<const char *>(data);
+  w.size = stat_buf.st_size;
+  for (w.start = 0; w.start < w.size; w.start += LOG_RANGE_SIZE) {
+    w.end = std::min(w.start + LOG_RANGE_SIZE, w.size);
+    work.push_back(w);
+  }
+  return true;
+}
+
+// Parse all the @a work, on cl.threads threads, into main_stats. Returns the name of a
+// log which failed to parse, or nullptr.
+static const char *
+process_logs(const std::vector<LogWork> &work, unsigned max_age)
+{
+  size_t n_threads = cl.threads > 0 ? cl.threads : std::thread::hardware_concurrency();
+  std::atomic<size_t> next{0};
+  std::atomic<const char *> failed{nullptr};
+
+  auto parse = [&](LogStats *stats) {
+    for (size_t i; (i = next++) < work.size();) {
+      if (process_work(*stats, work[i], max_age) != 0) {
+        const char *none = nullptr;
+        failed.compare_exchange_strong(none, work[i].name);
+      }
+    }
+  };
+
+  n_threads = std::max<size_t>(1, std::min(n_threads, work.size()));
+  Debug("logstats", "Parsing %zu ranges of logs on %zu threads.", work.size(), n_threads);
+  if (1 == n_threads) {
+    parse(&main_stats);
+  } else {
+    std::vector<std::unique_ptr<LogStats>> stats;
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < n_threads; ++i) {
+      stats.emplace_back(new LogStats);
+      if (main_stats.urls) {
+        stats.back()->urls.reset(new UrlTopK(cl.urls, cl.show_urls));
+      }
+      threads.emplace_back(parse, stats.back().get());
+    }
+    for (size_t i = 0; i < n_threads; ++i) {
+      threads[i].join();
+      main_stats.merge(*stats[i]);
+    }
+  }
+
+  return failed.load();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Determine if this "stat" (Origin Server) is worthwhile to produce a
 // report for.
@@ -2274,8 +2895,8 @@ my_exit(const ExitStatus &status)
   int max_origins;
 
   // Special case for URLs output.
-  if (urls) {
-    urls->dump(cl.as_object);
+  if (main_stats.urls) {
+    main_stats.urls->dump(cl.as_object);
     if (cl.as_object) {
       std::cout << "}" << std::endl;
     } else {
@@ -2304,9 +2925,9 @@ my_exit(const ExitStatus &status)
     }
   }
 
-  if (!origins.empty()) {
+  if (!main_stats.origins.empty()) {
     // Sort the Origins by 'traffic'
-    for (OriginStorage::iterator i = origins.begin(); i != origins.end(); i++) {
+    for (OriginStorage::iterator i = main_stats.origins.begin(); i != main_stats.origins.end(); i++) {
       if (use_origin(i->second)) {
         vec.push_back(*i);
       }
@@ -2343,11 +2964,11 @@ my_exit(const ExitStatus &status)
     first = false;
     if (cl.json) {
       std::cout << "{ \"total\": {" << std::endl;
-      print_detail_stats(&totals, cl.json, cl.concise);
+      print_detail_stats(&main_stats.totals, cl.json, cl.concise);
       std::cout << "  }";
     } else {
       format_center("Totals (all Origins combined)");
-      print_detail_stats(&totals, cl.json, cl.concise);
+      print_detail_stats(&main_stats.totals, cl.json, cl.concise);
       std::cout << std::endl << std::endl << std::endl;
     }
   }
@@ -2431,11 +3052,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
   // Before accessing file system initialize Layout engine
   Layout::create();
 
-  memset(&totals, 0, sizeof(totals));
-  init_elapsed(&totals);
-
-  origin_set   = new OriginSet;
-  parse_errors = 0;
+  origin_set = new OriginSet;
 
   // Command line parsing
   cl.parse_arguments(argv);
@@ -2507,7 +3124,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
 
   // Should we calculate per URL data;
   if (cl.urls != 0) {
-    urls = new UrlLru(cl.urls, cl.show_urls);
+    main_stats.urls.reset(new UrlTopK(cl.urls, cl.show_urls));
     if (cl.as_object) {
       std::cout << "{" << std::endl;
     } else {
@@ -2639,7 +3256,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
               break; // Don't attempt any more files
             }
             // Process it
-            if (process_file(old_fd, last_state.offset, max_age) != 0) {
+            if (process_file(main_stats, old_fd, last_state.offset, max_age) != 0) {
               exit_status.set(EXIT_WARNING, " can't read ");
               exit_status.append(dp->d_name);
             }
@@ -2658,7 +3275,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
     }
 
     // Process the main file (always)
-    if (process_file(main_fd, last_state.offset, max_age) != 0) {
+    if (process_file(main_stats, main_fd, last_state.offset, max_age) != 0) {
       exit_status.set(EXIT_CRITICAL, " can't parse log");
       last_state.offset = 0;
       last_state.st_ino = 0;
@@ -2686,7 +3303,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
     }
     close(main_fd);
     close(state_fd);
-  } else {
+  } else if (cl.tail > 0) {
     main_fd = cl.log_file[0] ? open(cl.log_file, O_RDONLY) : open_main_log(exit_status);
     if (main_fd < 0) {
       exit_status.set(EXIT_CRITICAL, " can't open log file ");
@@ -2694,21 +3311,72 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
       my_exit(exit_status);
     }
 
-    if (cl.tail > 0) {
-      if (lseek(main_fd, 0, SEEK_END) < 0) {
-        exit_status.set(EXIT_CRITICAL, " can't lseek squid.blog");
-        my_exit(exit_status);
-      }
-      sleep(cl.tail);
+    if (lseek(main_fd, 0, SEEK_END) < 0) {
+      exit_status.set(EXIT_CRITICAL, " can't lseek squid.blog");
+      my_exit(exit_status);
     }
+    sleep(cl.tail);
 
-    if (process_file(main_fd, 0, max_age) != 0) {
+    if (process_file(main_stats, main_fd, 0, max_age) != 0) {
       close(main_fd);
       exit_status.set(EXIT_CRITICAL, " can't parse log file ");
       exit_status.append(cl.log_file);
       my_exit(exit_status);
     }
     close(main_fd);
+  } else {
+    // Parse the logs given, or the default one, across threads.
+    std::vector<const char *> names;
+    std::vector<LogWork> work;
+    std::vector<int> fds;
+
+    if (cl.log_file[0]) {
+      names.push_back(cl.log_file);
+    }
+    for (unsigned i = 0; i < n_file_arguments; ++i) {
+      names.push_back(file_arguments[i]);
+    }
+
+    if (names.empty()) {
+      if ((main_fd = open_main_log(exit_status)) < 0) {
+        exit_status.set(EXIT_CRITICAL, " can't open log file ");
+        my_exit(exit_status);
+      }
+      fds.push_back(main_fd);
+      if (!add_log_work(work, "squid.blog", main_fd)) {
+        exit_status.set(EXIT_CRITICAL, " can't read squid.blog");
+        my_exit(exit_status);
+      }
+    }
+    for (auto name : names) {
+      if ((main_fd = open(name, O_RDONLY)) < 0) {
+        exit_status.set(EXIT_CRITICAL, " can't open log file ");
+        exit_status.append(name);
+        my_exit(exit_status);
+      }
+      fds.push_back(main_fd);
+      if (!add_log_work(work, name, main_fd)) {
+        exit_status.set(EXIT_CRITICAL, " can't read log file ");
+        exit_status.append(name);
+        my_exit(exit_status);
+      }
+    }
+
+    const char *failed = process_logs(work, max_age);
+
+    for (auto const &w : work) {
+      if (LogWork::RANGE == w.kind && 0 == w.start) {
+        munmap(const_cast<char *>(w.data), w.size);
+      }
+    }
+    for (auto fd : fds) {
+      close(fd);
+    }
+    if (failed) {
+      exit_status.set(EXIT_CRITICAL, " can't parse log file ");
+      exit_status.append(failed);
+      my_exit(exit_status);
+    }
   }
 
   // All done.
@@ -775,6 +775,10 @@ main(int argc, const char **argv)
         lmgmt->mgmt_shutdown_outstanding = MGMT_PENDING_NONE;
       }
       break;
+    case MGMT_PENDING_HOT_BOUNCE:
+      lmgmt->processHotBounce();
+      lmgmt->mgmt_shutdown_outstanding = MGMT_PENDING_NONE;
+      break;
     case MGMT_PENDING_STOP:
       lmgmt->processShutdown();
       lmgmt->mgmt_shutdown_outstanding = MGMT_PENDING_NONE;
@@ -954,6 +958,12 @@ SignalHandler(int sig)
         waitpid(lmgmt->watched_process_pid, &status, 0);
       }
     }
+    if (lmgmt->handoff_process_pid != -1) {
+      if (sig == SIGTERM || sig == SIGINT) {
+        kill(lmgmt->handoff_process_pid, sig);
+        waitpid(lmgmt->handoff_process_pid, &status, 0);
+      }
+    }
     lmgmt->mgmtCleanup();
   }
 
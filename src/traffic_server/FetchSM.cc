@@ -27,11 +27,23 @@
 #include "HTTP.h"
 #include "PluginVC.h"
 #include "ts/ts.h" // Ugly, but we need a bunch of the public APIs here ... :-/
+#include "HttpSessionAccept.h"
+
+extern HttpSessionAccept *plugin_http_accept;
 
 #define DEBUG_TAG "FetchSM"
 #define FETCH_LOCK_RETRY_TIME HRTIME_MSECONDS(10)
 
-ClassAllocator<FetchSM> FetchSMAllocator("FetchSMAllocator");
+ClassAllocator<FetchSM> fetchSMAllocator("fetchSMAllocator");
+
+FetchSM *
+FetchSM::allocate()
+{
+  // The fetches of plugin threads that are not event threads use the global freelist.
+  EThread *thread = this_ethread();
+  return thread ? THREAD_ALLOC_INIT(fetchSMAllocator, thread) : fetchSMAllocator.alloc();
+}
+
 void
 FetchSM::cleanUp()
 {
@@ -46,6 +58,14 @@ FetchSM::cleanUp()
     chunked_handler.clear();
   }
 
+  if (header_event) {
+    header_event->cancel();
+    header_event = nullptr;
+  }
+  if (PluginVC *other_side = http_vc->get_other_side(); other_side) {
+    other_side->set_response_sink(nullptr);
+  }
+
   free_MIOBuffer(req_buffer);
   free_MIOBuffer(resp_buffer);
   mutex.clear();
@@ -54,7 +74,11 @@ FetchSM::cleanUp()
   ats_free(client_response);
   cont_mutex.clear();
   http_vc->do_io_close();
-  FetchSMAllocator.free(this);
+  if (EThread *thread = this_ethread(); thread) {
+    THREAD_FREE(this, fetchSMAllocator, thread);
+  } else {
+    fetchSMAllocator.free(this);
+  }
 }
 
 void
@@ -65,7 +89,24 @@ FetchSM::httpConnect()
   int64_t id         = pi ? pi->getPluginId() : 0;
 
   Debug(DEBUG_TAG, "[%s] calling httpconnect write pi=%p tag=%s id=%" PRId64, __FUNCTION__, pi, tag, id);
-  http_vc = reinterpret_cast<PluginVC *>(TSHttpConnectWithPluginId(&_addr.sa, tag, id));
+  if (mutex != contp->mutex && plugin_http_accept) {
+    // With a mutex of its own, the fetch shares it with the internal connection, the response
+    // then moves straight to resp_buffer.
+    PluginVCCore *core = PluginVCCore::alloc(plugin_http_accept, mutex.get());
+    core->set_active_addr(&_addr.sa);
+    core->set_plugin_id(id);
+    core->set_plugin_tag(tag);
+    http_vc = core->connect();
+    if (PluginVC *other_side = http_vc->get_other_side(); other_side) {
+      other_side->set_is_internal_request(true);
+      // A streaming fetch reads the header object, not its text, it needs it as parsed.
+      if (fetch_flags & TS_FETCH_FLAGS_STREAM) {
+        other_side->set_response_sink(this);
+      }
+    }
+  } else {
+    http_vc = reinterpret_cast<PluginVC *>(TSHttpConnectWithPluginId(&_addr.sa, tag, id));
+  }
 
   /*
    * TS-2906: We need a way to unset internal request when using FetchSM, the use case for this
@@ -267,7 +308,7 @@ FetchSM::InvokePluginExt(int fetch_event)
   }
 
   if (!has_sent_header) {
-    if (fetch_event != TS_EVENT_VCONN_EOS) {
+    if (fetch_event != TS_EVENT_VCONN_EOS || header_done) {
       contp->handleEvent(TS_FETCH_EVENT_EXT_HEAD_DONE, this);
       has_sent_header = true;
     } else {
@@ -467,6 +508,18 @@ FetchSM::get_info_from_buffer(IOBufferReader *reader)
   return;
 }
 
+void
+FetchSM::response_header(HTTPHdr *hdr)
+{
+  Debug(DEBUG_TAG, "[%s] took the response header of the transaction", __FUNCTION__);
+  client_response_hdr.copy(hdr);
+  header_done = true;
+  // There may be no body bytes to call us back, have the header processed as they would.
+  if (!header_event) {
+    header_event = this_ethread()->schedule_imm_local(this);
+  }
+}
+
 void
 FetchSM::process_fetch_read(int event)
 {
@@ -567,7 +620,10 @@ FetchSM::fetch_handler(int event, void *edata)
 {
   Debug(DEBUG_TAG, "[%s] calling fetch_plugin", __FUNCTION__);
 
-  if (edata == read_vio) {
+  if (header_event && edata == header_event) {
+    header_event = nullptr;
+    process_fetch_read(TS_EVENT_VCONN_READ_READY);
+  } else if (edata == read_vio) {
     process_fetch_read(event);
   } else if (edata == write_vio) {
     process_fetch_write(event);
@@ -32,13 +32,15 @@
 #include "P_Net.h"
 #include "HttpSM.h"
 #include "HttpTunnel.h"
+#include "PluginVC.h"
 
-class PluginVC;
-
-class FetchSM : public Continuation
+class FetchSM : public Continuation, public PluginVCResponseSink
 {
 public:
   FetchSM() {}
+
+  /// A FetchSM from the pool of the thread.
+  static FetchSM *allocate();
   void
   init_comm()
   {
@@ -89,6 +91,9 @@ public:
   void get_info_from_buffer(IOBufferReader *reader);
   char *resp_get(int *length);
 
+  /// Override for @c PluginVCResponseSink, a streaming fetch takes the header of its transaction.
+  void response_header(HTTPHdr *hdr) override;
+
   TSMBuffer resp_hdr_bufp();
   TSMLoc resp_hdr_mloc();
 
@@ -146,6 +151,7 @@ private:
 
   int recursion               = 0;
   PluginVC *http_vc           = nullptr;
+  Event *header_event         = nullptr; ///< Signals the header taken from the transaction
   VIO *read_vio               = nullptr;
   VIO *write_vio              = nullptr;
   MIOBuffer *req_buffer       = nullptr;
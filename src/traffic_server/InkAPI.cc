@@ -21,6 +21,7 @@
   limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <atomic>
 #include <string_view>
@@ -64,6 +65,7 @@
 #include "PluginVC.h"
 #include "FetchSM.h"
 #include "HttpDebugNames.h"
+#include "HttpPluginStats.h"
 #include "I_AIO.h"
 #include "I_Tasks.h"
 
@@ -1385,8 +1387,23 @@ APIHooks::append(INKContInternal *cont)
 {
   APIHook *api_hook;
 
-  api_hook         = apiHookAllocator.alloc();
-  api_hook->m_cont = cont;
+  api_hook              = apiHookAllocator.alloc();
+  api_hook->m_cont      = cont;
+  api_hook->m_fast_func = nullptr;
+  api_hook->m_fast_data = nullptr;
+
+  m_hooks.enqueue(api_hook);
+}
+
+void
+APIHooks::append(TSHttpFastHookFunc func, void *data)
+{
+  APIHook *api_hook;
+
+  api_hook              = apiHookAllocator.alloc();
+  api_hook->m_cont      = nullptr;
+  api_hook->m_fast_func = func;
+  api_hook->m_fast_data = data;
 
   m_hooks.enqueue(api_hook);
 }
@@ -1818,6 +1835,7 @@ api_init()
     } else {
       api_rsb = nullptr;
     }
+    HttpPluginStats::init();
 
     // Setup the version string for returning to plugins
     ink_strlcpy(traffic_server_version, appVersionInfo.VersionStr, sizeof(traffic_server_version));
@@ -4559,6 +4577,52 @@ TSMgmtSourceGet(const char *var_name, TSMgmtSource *source)
   return REC_ERR_OKAY == RecGetRecordSource(var_name, reinterpret_cast<RecSourceT *>(source)) ? TS_SUCCESS : TS_ERROR;
 }
 
+TSReturnCode
+TSMgmtRecordFind(const char *var_name, TSMgmtRecord *record)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)var_name) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr((void *)record) == TS_SUCCESS);
+
+  return RecGetRecordHandle(var_name, record) == REC_ERR_OKAY ? TS_SUCCESS : TS_ERROR;
+}
+
+TSReturnCode
+TSMgmtRecordIntGet(TSMgmtRecord record, TSMgmtInt *result)
+{
+  return RecGetRecordIntByHandle(record, (RecInt *)result) == REC_ERR_OKAY ? TS_SUCCESS : TS_ERROR;
+}
+
+TSReturnCode
+TSMgmtRecordCounterGet(TSMgmtRecord record, TSMgmtCounter *result)
+{
+  return RecGetRecordCounterByHandle(record, (RecCounter *)result) == REC_ERR_OKAY ? TS_SUCCESS : TS_ERROR;
+}
+
+TSReturnCode
+TSMgmtRecordFloatGet(TSMgmtRecord record, TSMgmtFloat *result)
+{
+  return RecGetRecordFloatByHandle(record, (RecFloat *)result) == REC_ERR_OKAY ? TS_SUCCESS : TS_ERROR;
+}
+
+TSReturnCode
+TSMgmtRecordStringGet(TSMgmtRecord record, TSMgmtString *result)
+{
+  RecString tmp = nullptr;
+
+  if (RecGetRecordStringByHandle_Xmalloc(record, &tmp) != REC_ERR_OKAY || tmp == nullptr) {
+    return TS_ERROR;
+  }
+
+  *result = tmp;
+  return TS_SUCCESS;
+}
+
+unsigned int
+TSMgmtRecordGenerationGet(TSMgmtRecord record)
+{
+  return RecGetRecordGeneration(record);
+}
+
 TSReturnCode
 TSMgmtDataTypeGet(const char *var_name, TSRecordDataType *result)
 {
@@ -4811,6 +4875,16 @@ TSContThreadAffinityClear(TSCont contp)
   i->clearThreadAffinity();
 }
 
+void
+TSContThreadAgnosticSet(TSCont contp, bool agnostic)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(contp) == TS_SUCCESS);
+
+  INKContInternal *i = reinterpret_cast<INKContInternal *>(contp);
+
+  i->thread_agnostic = agnostic;
+}
+
 TSAction
 TSHttpSchedule(TSCont contp, TSHttpTxn txnp, TSHRTime timeout)
 {
@@ -4880,6 +4954,32 @@ TSHttpHookAdd(TSHttpHookID id, TSCont contp)
   }
 }
 
+TSReturnCode
+TSHttpFastHookAdd(TSHttpHookID id, TSHttpFastHookFunc funcp, void *data)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)funcp) == TS_SUCCESS);
+
+  // Only the hooks the transaction calls out to, the others have to be continuations
+  switch (id) {
+  case TS_HTTP_TXN_START_HOOK:
+  case TS_HTTP_READ_REQUEST_HDR_HOOK:
+  case TS_HTTP_PRE_REMAP_HOOK:
+  case TS_HTTP_POST_REMAP_HOOK:
+  case TS_HTTP_REQUEST_BUFFER_READ_COMPLETE_HOOK:
+  case TS_HTTP_OS_DNS_HOOK:
+  case TS_HTTP_CACHE_LOOKUP_COMPLETE_HOOK:
+  case TS_HTTP_READ_CACHE_HDR_HOOK:
+  case TS_HTTP_SEND_REQUEST_HDR_HOOK:
+  case TS_HTTP_READ_RESPONSE_HDR_HOOK:
+  case TS_HTTP_SEND_RESPONSE_HDR_HOOK:
+  case TS_HTTP_TXN_CLOSE_HOOK:
+    http_global_hooks->append(id, funcp, data);
+    return TS_SUCCESS;
+  default:
+    return TS_ERROR;
+  }
+}
+
 void
 TSLifecycleHookAdd(TSLifecycleHookID id, TSCont contp)
 {
@@ -5532,6 +5632,30 @@ TSHttpTxnCacheLookupUrlSet(TSHttpTxn txnp, TSMBuffer bufp, TSMLoc obj)
   return TS_SUCCESS;
 }
 
+TSReturnCode
+TSHttpTxnCacheLookupUrlProbe(TSHttpTxn txnp, TSMBuffer bufp, TSMLoc obj, int *maybe_cached)
+{
+  sdk_assert(sdk_sanity_check_txn(txnp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_mbuffer(bufp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_url_handle(obj) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr((void *)maybe_cached) == TS_SUCCESS);
+
+  HttpSM *sm = (HttpSM *)txnp;
+  URL u;
+  HttpCacheKey key;
+
+  u.m_heap     = ((HdrHeapSDKHandle *)bufp)->m_heap;
+  u.m_url_impl = (URLImpl *)obj;
+  if (!u.valid() || !cacheProcessor.IsCacheReady(CACHE_FRAG_TYPE_HTTP)) {
+    return TS_ERROR;
+  }
+
+  // The key the state machine would look the URL up with, see HttpSM::do_cache_lookup_and_read().
+  Cache::generate_key(&key, &u, sm->t_state.txn_conf->cache_generation_number);
+  *maybe_cached = cacheProcessor.maybe_cached(&key) ? 1 : 0;
+  return TS_SUCCESS;
+}
+
 /**
  * timeout is in msec
  * overrides as proxy.config.http.transaction_active_timeout_out
@@ -6712,6 +6836,20 @@ TSHttpTxnMilestoneGet(TSHttpTxn txnp, TSMilestonesType milestone, ink_hrtime *ti
   return ret;
 }
 
+TSReturnCode
+TSHttpTxnCpuTimeGet(TSHttpTxn txnp, ink_hrtime *time)
+{
+  sdk_assert(sdk_sanity_check_txn(txnp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr(time) == TS_SUCCESS);
+  HttpSM *sm = (HttpSM *)txnp;
+
+  if (sm->cpu_time < 0) {
+    return TS_ERROR;
+  }
+  *time = sm->cpu_time;
+  return TS_SUCCESS;
+}
+
 TSReturnCode
 TSHttpTxnCachedRespTimeGet(TSHttpTxn txnp, time_t *resp_time)
 {
@@ -7582,6 +7720,69 @@ TSStatFindName(const char *name, int *idp)
   return TS_SUCCESS;
 }
 
+/**********************   REC Histograms API    ***********************/
+int
+TSStatHistogramCreate(const char *the_name)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)the_name) == TS_SUCCESS);
+
+  RecRawHistogram *rh = RecRegisterRawHistogram(RECT_PLUGIN, the_name);
+  return rh ? rh->id : TS_ERROR;
+}
+
+void
+TSStatHistogramRecord(int id, TSMgmtInt value)
+{
+  RecRawHistogram *rh = RecGetRawHistogram(id);
+
+  sdk_assert(sdk_sanity_check_null_ptr(rh) == TS_SUCCESS);
+  RecRawHistogramRecord(rh, nullptr, value);
+}
+
+TSReturnCode
+TSStatHistogramFindName(const char *name, int *idp)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)name) == TS_SUCCESS);
+
+  RecRawHistogram *rh = RecFindRawHistogram(name);
+  if (rh == nullptr) {
+    return TS_ERROR;
+  }
+
+  *idp = rh->id;
+  return TS_SUCCESS;
+}
+
+int
+TSStatHistogramBucketsGet(int id, TSMgmtInt *counts, int nbuckets)
+{
+  RecRawHistogram *rh = RecGetRawHistogram(id);
+  RecRawHistogramData data;
+
+  sdk_assert(sdk_sanity_check_null_ptr(rh) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr(counts) == TS_SUCCESS);
+
+  RecGetRawHistogramData(rh, &data);
+  nbuckets = std::clamp(nbuckets, 0, REC_HISTOGRAM_BUCKETS);
+  for (int i = 0; i < nbuckets; ++i) {
+    counts[i] = data.buckets.bucket(i);
+  }
+  return nbuckets;
+}
+
+int
+TSStatHistogramBucketCount()
+{
+  return REC_HISTOGRAM_BUCKETS;
+}
+
+TSMgmtInt
+TSStatHistogramBucketLowerBound(int bucket)
+{
+  sdk_assert(bucket >= 0 && bucket < REC_HISTOGRAM_BUCKETS);
+  return RecRawHistogramBucketLowerBound(bucket);
+}
+
 /**************************    Stats API    ****************************/
 // THESE APIS ARE DEPRECATED, USE THE REC APIs INSTEAD
 // #define ink_sanity_check_stat_structure(_x) TS_SUCCESS
@@ -8027,7 +8228,6 @@ TSFetchPageRespGet(TSHttpTxn txnp, TSMBuffer *bufp, TSMLoc *obj)
 }
 
 // Fetchpages SM
-extern ClassAllocator<FetchSM> FetchSMAllocator;
 
 void
 TSFetchPages(TSFetchUrlParams_t *params)
@@ -8035,7 +8235,7 @@ TSFetchPages(TSFetchUrlParams_t *params)
   TSFetchUrlParams_t *myparams = params;
 
   while (myparams != nullptr) {
-    FetchSM *fetch_sm = FetchSMAllocator.alloc();
+    FetchSM *fetch_sm = FetchSM::allocate();
     sockaddr *addr    = ats_ip_sa_cast(&myparams->ip);
 
     fetch_sm->init((Continuation *)myparams->contp, myparams->options, myparams->events, myparams->request, myparams->request_len,
@@ -8053,7 +8253,7 @@ TSFetchUrl(const char *headers, int request_len, sockaddr const *ip, TSCont cont
     sdk_assert(sdk_sanity_check_continuation(contp) == TS_SUCCESS);
   }
 
-  FetchSM *fetch_sm = FetchSMAllocator.alloc();
+  FetchSM *fetch_sm = FetchSM::allocate();
 
   fetch_sm->init((Continuation *)contp, callback_options, events, headers, request_len, ip);
   fetch_sm->httpConnect();
@@ -8074,7 +8274,7 @@ TSFetchCreate(TSCont contp, const char *method, const char *url, const char *ver
   sdk_assert(sdk_sanity_check_continuation(contp) == TS_SUCCESS);
   sdk_assert(ats_is_ip(client_addr));
 
-  FetchSM *fetch_sm = FetchSMAllocator.alloc();
+  FetchSM *fetch_sm = FetchSM::allocate();
 
   fetch_sm->ext_init((Continuation *)contp, method, url, version, client_addr, flags);
 
@@ -8325,7 +8525,7 @@ TSAIOWrite(int fd, off_t offset, char *buf, const size_t bufSize, TSCont contp)
 TSReturnCode
 TSAIOThreadNumSet(int thread_num)
 {
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
   (void)thread_num;
   return TS_SUCCESS;
 #else
@@ -9307,7 +9507,7 @@ TSSslContextFindByName(const char *name)
   if (lookup != nullptr) {
     SSLCertContext *cc = lookup->find(name);
     if (cc) {
-      shared_SSL_CTX ctx = cc->getCtx();
+      shared_SSL_CTX ctx = cc->loadCtx();
       if (ctx) {
         ret = reinterpret_cast<TSSslContext>(ctx.get());
       }
@@ -9542,7 +9742,7 @@ TSSslServerCertUpdate(const char *cert_path, const char *key_path)
 
     // Update context to use cert
     cc = lookup->find(common_name_str);
-    if (cc && cc->getCtx()) {
+    if (cc && cc->loadCtx()) {
       test_ctx = shared_SSL_CTX(SSLCreateServerContext(config, cc->userconfig.get(), cert_path, key_path), SSLReleaseContext);
       if (!test_ctx) {
         return TS_ERROR;
@@ -9636,6 +9836,23 @@ TSVConnProvidedSslCert(TSVConn sslp)
   return vc->provided_cert();
 }
 
+tsapi TSReturnCode
+TSVConnTcpInfoGet(TSVConn vconnp, void *info, int *lenp)
+{
+  sdk_assert(sdk_sanity_check_null_ptr(info) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr(lenp) == TS_SUCCESS);
+
+  NetVConnection *vc  = reinterpret_cast<NetVConnection *>(vconnp);
+  const TcpInfo *tcpi = vc->get_tcp_info();
+  if (tcpi == nullptr || *lenp < 0) {
+    return TS_ERROR;
+  }
+
+  *lenp = std::min(*lenp, static_cast<int>(tcpi->raw_len));
+  memcpy(info, tcpi->raw, *lenp);
+  return TS_SUCCESS;
+}
+
 void
 TSVConnReenable(TSVConn vconn)
 {
@@ -9830,6 +10047,16 @@ TSHttpTxnIdGet(TSHttpTxn txnp)
   return (uint64_t)sm->sm_id;
 }
 
+void *
+TSHttpTxnArenaAlloc(TSHttpTxn txnp, size_t size)
+{
+  sdk_assert(sdk_sanity_check_txn(txnp) == TS_SUCCESS);
+  HttpSM *sm = reinterpret_cast<HttpSM *>(txnp);
+
+  // Every allocation is a multiple of 16, so that each one is aligned as the first one is.
+  return sm->arena.alloc((size + 15) & ~static_cast<size_t>(15)).data();
+}
+
 // Returns unique client session identifier
 int64_t
 TSHttpSsnIdGet(TSHttpSsn ssnp)
@@ -3600,6 +3600,207 @@ EXCLUSIVE_REGRESSION_TEST(SDK_API_HttpHookAdd)(RegressionTest *test, int /* atyp
   return;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//     SDK_API_HttpFastHookAdd
+//
+// Unit Test for API: TSHttpFastHookAdd
+//
+// Two transactions go through fast hooks and a continuation on the same
+// hook. The first checks they are called in the order they were added,
+// the second that TS_HOOK_RESULT_ERROR skips the hooks after it and
+// sends an error response.
+//////////////////////////////////////////////////////////////////////////////
+
+struct FastHookTest {
+  RegressionTest *regtest;
+  int *pstatus;
+  SocketServer *os;
+  ClientTxn *browser;
+  int phase; ///< 0 once the test is over, the hooks stay global
+  char called[16];
+  int n_called;
+};
+
+static FastHookTest fast_hook_test;
+
+static void
+fast_hook_record(FastHookTest *test, char c)
+{
+  if (test->n_called < static_cast<int>(sizeof(test->called)) - 1) {
+    test->called[test->n_called++] = c;
+  }
+}
+
+static TSHttpHookResult
+fast_hook_first(TSHttpTxn txnp, TSHttpHookID /* id ATS_UNUSED */, void *data)
+{
+  FastHookTest *test = static_cast<FastHookTest *>(data);
+
+  if (test->phase == 0) {
+    return TS_HOOK_RESULT_CONTINUE;
+  }
+  fast_hook_record(test, 'a');
+  TSSkipRemappingSet(txnp, 1);
+  return test->phase == 2 ? TS_HOOK_RESULT_ERROR : TS_HOOK_RESULT_CONTINUE;
+}
+
+static TSHttpHookResult
+fast_hook_second(TSHttpTxn /* txnp ATS_UNUSED */, TSHttpHookID /* id ATS_UNUSED */, void *data)
+{
+  FastHookTest *test = static_cast<FastHookTest *>(data);
+
+  if (test->phase != 0) {
+    fast_hook_record(test, 'b');
+  }
+  return TS_HOOK_RESULT_CONTINUE;
+}
+
+static TSHttpHookResult
+fast_hook_third(TSHttpTxn /* txnp ATS_UNUSED */, TSHttpHookID /* id ATS_UNUSED */, void *data)
+{
+  FastHookTest *test = static_cast<FastHookTest *>(data);
+
+  if (test->phase != 0) {
+    fast_hook_record(test, 'c');
+  }
+  return TS_HOOK_RESULT_CONTINUE;
+}
+
+static TSHttpHookResult
+fast_hook_send_response(TSHttpTxn /* txnp ATS_UNUSED */, TSHttpHookID id, void *data)
+{
+  FastHookTest *test = static_cast<FastHookTest *>(data);
+
+  if (test->phase != 0 && id == TS_HTTP_SEND_RESPONSE_HDR_HOOK) {
+    fast_hook_record(test, 'r');
+  }
+  return TS_HOOK_RESULT_CONTINUE;
+}
+
+static void
+fast_hook_send_request(FastHookTest *test)
+{
+  test->n_called = 0;
+  memset(test->called, 0, sizeof(test->called));
+
+  test->browser = synclient_txn_create();
+  char *request = generate_request(HTTP_HOOK_TEST_REQUEST_ID); // this request has a no-cache that prevents caching
+  synclient_txn_send_request(test->browser, request);
+  TSfree(request);
+}
+
+// Called between the fast hooks on READ_REQUEST_HDR, and to wait for each transaction
+static int
+fast_hook_handler(TSCont contp, TSEvent event, void *data)
+{
+  FastHookTest *test = static_cast<FastHookTest *>(TSContDataGet(contp));
+
+  switch (event) {
+  case TS_EVENT_HTTP_READ_REQUEST_HDR:
+    if (test->phase != 0) {
+      fast_hook_record(test, 'C');
+    }
+    TSHttpTxnReenable(static_cast<TSHttpTxn>(data), TS_EVENT_HTTP_CONTINUE);
+    break;
+
+  case TS_EVENT_IMMEDIATE:
+  case TS_EVENT_TIMEOUT:
+    if (test->browser->status == REQUEST_INPROGRESS) {
+      TSContScheduleOnPool(contp, 25, TS_THREAD_POOL_NET);
+      break;
+    }
+
+    if (test->phase == 1) {
+      if (test->browser->status == REQUEST_SUCCESS && strcmp(test->called, "aCbcr") == 0) {
+        SDK_RPRINT(test->regtest, "TSHttpFastHookAdd", "TestCase2", TC_PASS, "ok");
+      } else {
+        *(test->pstatus) = REGRESSION_TEST_FAILED;
+        SDK_RPRINT(test->regtest, "TSHttpFastHookAdd", "TestCase2", TC_FAIL, "Hooks called \"%s\", expected \"aCbcr\"",
+                   test->called);
+      }
+      synclient_txn_delete(test->browser);
+
+      test->phase = 2;
+      fast_hook_send_request(test);
+      TSContScheduleOnPool(contp, 25, TS_THREAD_POOL_NET);
+      break;
+    }
+
+    if (test->browser->status == REQUEST_SUCCESS && strcmp(test->called, "ar") == 0 &&
+        strstr(test->browser->response, "500 INKApi Error") != nullptr) {
+      SDK_RPRINT(test->regtest, "TSHttpFastHookAdd", "TestCase3", TC_PASS, "ok");
+    } else {
+      *(test->pstatus) = REGRESSION_TEST_FAILED;
+      SDK_RPRINT(test->regtest, "TSHttpFastHookAdd", "TestCase3", TC_FAIL, "Hooks called \"%s\", expected \"ar\"\n %s",
+                 test->called, test->browser->response);
+    }
+    if (*(test->pstatus) == REGRESSION_TEST_INPROGRESS) {
+      *(test->pstatus) = REGRESSION_TEST_PASSED;
+    }
+
+    // transaction is over. clean up.
+    synclient_txn_delete(test->browser);
+    synserver_delete(test->os);
+    test->os    = nullptr;
+    test->phase = 0;
+    break;
+
+  default:
+    *(test->pstatus) = REGRESSION_TEST_FAILED;
+    SDK_RPRINT(test->regtest, "TSHttpFastHookAdd", "TestCase2", TC_FAIL, "Unexpected event %d", event);
+    break;
+  }
+
+  return 0;
+}
+
+EXCLUSIVE_REGRESSION_TEST(SDK_API_HttpFastHookAdd)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  *pstatus = REGRESSION_TEST_INPROGRESS;
+
+  FastHookTest *fasttest = &fast_hook_test;
+  fasttest->regtest      = test;
+  fasttest->pstatus      = pstatus;
+
+  // Hooks the transaction does not call out to take continuations only
+  TSHttpHookID unsupported[] = {TS_HTTP_SSN_START_HOOK, TS_HTTP_SSN_CLOSE_HOOK, TS_HTTP_SELECT_ALT_HOOK,
+                                TS_HTTP_RESPONSE_TRANSFORM_HOOK, TS_VCONN_START_HOOK};
+  for (TSHttpHookID id : unsupported) {
+    if (TSHttpFastHookAdd(id, fast_hook_second, fasttest) != TS_ERROR) {
+      *pstatus = REGRESSION_TEST_FAILED;
+      SDK_RPRINT(test, "TSHttpFastHookAdd", "TestCase1", TC_FAIL, "Hook %s accepted a fast hook", TSHttpHookNameLookup(id));
+      return;
+    }
+  }
+  SDK_RPRINT(test, "TSHttpFastHookAdd", "TestCase1", TC_PASS, "ok");
+
+  TSCont cont = TSContCreate(fast_hook_handler, TSMutexCreate());
+  TSContDataSet(cont, fasttest);
+
+  // The hooks stay global, they do nothing once the test is over
+  if (TSHttpFastHookAdd(TS_HTTP_READ_REQUEST_HDR_HOOK, fast_hook_first, fasttest) != TS_SUCCESS) {
+    *pstatus = REGRESSION_TEST_FAILED;
+    SDK_RPRINT(test, "TSHttpFastHookAdd", "TestCase2", TC_FAIL, "Unable to add a fast hook to READ_REQUEST_HDR");
+    TSContDestroy(cont);
+    return;
+  }
+  TSHttpHookAdd(TS_HTTP_READ_REQUEST_HDR_HOOK, cont);
+  TSHttpFastHookAdd(TS_HTTP_READ_REQUEST_HDR_HOOK, fast_hook_second, fasttest);
+  TSHttpFastHookAdd(TS_HTTP_READ_REQUEST_HDR_HOOK, fast_hook_third, fasttest);
+  TSHttpFastHookAdd(TS_HTTP_SEND_RESPONSE_HDR_HOOK, fast_hook_send_response, fasttest);
+
+  /* Create a new synthetic server */
+  fasttest->os = synserver_create(SYNSERVER_LISTEN_PORT);
+  synserver_start(fasttest->os);
+
+  fasttest->phase = 1;
+  fast_hook_send_request(fasttest);
+
+  /* Wait until transaction is done */
+  TSContScheduleOnPool(cont, 25, TS_THREAD_POOL_NET);
+}
+
+
 //////////////////////////////////////////////
 //       SDK_API_TSUrl
 //
@@ -6459,6 +6660,8 @@ REGRESSION_TEST(SDK_API_TSTextLog)(RegressionTest *test, int /* atype ATS_UNUSED
 //                     TSMgmtIntGet
 //                     TSMgmtStringGet
 //                     TSMgmtDataTypeGet
+//                     TSMgmtRecordFind
+//                     TSMgmtRecordIntGet
 //////////////////////////////////////////////
 
 REGRESSION_TEST(SDK_API_TSMgmtGet)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
@@ -6535,6 +6738,23 @@ REGRESSION_TEST(SDK_API_TSMgmtGet)(RegressionTest *test, int /* atype ATS_UNUSED
     }
   }
 
+  {
+    TSMgmtRecord record;
+    TSMgmtInt value = -1;
+    if (TSMgmtRecordFind(CONFIG_PARAM_INT_NAME, &record) != TS_SUCCESS) {
+      SDK_RPRINT(test, "TSMgmtRecordFind", "TestCase1.6", TC_FAIL, "can not find param %s", CONFIG_PARAM_INT_NAME);
+      err = 1;
+    } else if (TSMgmtRecordIntGet(record, &value) != TS_SUCCESS || value != CONFIG_PARAM_INT_VALUE) {
+      SDK_RPRINT(test, "TSMgmtRecordIntGet", "TestCase1.6", TC_FAIL, "can not get value of param %s", CONFIG_PARAM_INT_NAME);
+      err = 1;
+    } else if (TSMgmtRecordFloatGet(record, &fvalue) == TS_SUCCESS) {
+      SDK_RPRINT(test, "TSMgmtRecordFloatGet", "TestCase1.6", TC_FAIL, "got a float of the int param %s", CONFIG_PARAM_INT_NAME);
+      err = 1;
+    } else {
+      SDK_RPRINT(test, "TSMgmtRecordIntGet", "TestCase1.6", TC_PASS, "ok");
+    }
+  }
+
   if (err) {
     *pstatus = REGRESSION_TEST_FAILED;
     return;
@@ -593,6 +593,44 @@ TSIOBufferDestroy(TSIOBuffer bufp)
   free_MIOBuffer((MIOBuffer *)bufp);
 }
 
+TSIOBufferAccount
+TSIOBufferAccountCreate(const char *name)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)name) == TS_SUCCESS);
+
+  IOBufferAccount *account = new IOBufferAccount(name);
+  account->refcount_inc();
+  return reinterpret_cast<TSIOBufferAccount>(account);
+}
+
+void
+TSIOBufferAccountDestroy(TSIOBufferAccount account)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)account) == TS_SUCCESS);
+
+  // Buffer blocks still charged to the account keep it until they are freed.
+  IOBufferAccount *a = reinterpret_cast<IOBufferAccount *>(account);
+  if (a->refcount_dec() == 0) {
+    a->free();
+  }
+}
+
+void
+TSIOBufferAccountSet(TSIOBuffer bufp, TSIOBufferAccount account)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(bufp) == TS_SUCCESS);
+
+  reinterpret_cast<MIOBuffer *>(bufp)->_account = reinterpret_cast<IOBufferAccount *>(account);
+}
+
+int64_t
+TSIOBufferAccountBytesGet(TSIOBufferAccount account)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)account) == TS_SUCCESS);
+
+  return reinterpret_cast<IOBufferAccount *>(account)->bytes();
+}
+
 TSIOBufferBlock
 TSIOBufferStart(TSIOBuffer bufp)
 {
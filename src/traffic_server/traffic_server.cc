@@ -37,6 +37,7 @@
 #include "tscore/ink_stack_trace.h"
 #include "tscore/ink_syslog.h"
 #include "tscore/hugepages.h"
+#include "tscore/JeAllocator.h"
 #include "tscore/runroot.h"
 #include "tscore/Filenames.h"
 #include "tscore/ts_file.h"
@@ -46,8 +47,10 @@
 #include <syslog.h>
 #include <algorithm>
 #include <atomic>
+#include <functional>
 #include <list>
 #include <string>
+#include <thread>
 
 #if !defined(linux)
 #include <sys/lock.h>
@@ -82,6 +85,7 @@ extern "C" int plock(int);
 #include "ProxyConfig.h"
 #include "HttpProxyServerMain.h"
 #include "HttpBodyFactory.h"
+#include "ReverseProxy.h"
 #include "ProxySession.h"
 #include "logging/Log.h"
 #include "CacheControl.h"
@@ -128,6 +132,7 @@ static const long MAX_LOGIN = ink_login_name_max();
 
 static void mgmt_restart_shutdown_callback(ts::MemSpan<void>);
 static void mgmt_drain_callback(ts::MemSpan<void>);
+static void mgmt_handoff_callback(ts::MemSpan<void>);
 static void mgmt_storage_device_cmd_callback(int cmd, std::string_view const &arg);
 static void mgmt_lifecycle_msg_callback(ts::MemSpan<void>);
 static void init_ssl_ctx_callback(void *ctx, bool server);
@@ -155,6 +160,10 @@ static int regression_list        = 0;
 static int regression_level       = REGRESSION_TEST_NONE;
 #endif
 int auto_clear_hostdb_flag = 0;
+static int handoff_flag    = 0;
+
+// When main() started, what the startup times are measured from.
+static ink_hrtime startup_began_at = 0;
 extern int fds_limit;
 
 static char command_string[512] = "";
@@ -216,6 +225,7 @@ static ArgumentDescription argument_descriptions[] = {
   {"bind_stdout", '-', "Regular file to bind stdout to", "S512", &bind_stdout, "PROXY_BIND_STDOUT", nullptr},
   {"bind_stderr", '-', "Regular file to bind stderr to", "S512", &bind_stderr, "PROXY_BIND_STDERR", nullptr},
   {"accept_mss", '-', "MSS for client connections", "I", &accept_mss, nullptr, nullptr},
+  {"handoff", '-', "Take over from a traffic_server handing off to this one", "F", &handoff_flag, nullptr, nullptr},
   {"poll_timeout", 't', "poll timeout in milliseconds", "I", &poll_timeout, nullptr, nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
@@ -244,6 +254,71 @@ struct AutoStopCont : public Continuation {
   AutoStopCont() : Continuation(new_ProxyMutex()) { SET_HANDLER(&AutoStopCont::mainEvent); }
 };
 
+// Stops a traffic_server handing off to the next one, once its clients are gone or the hand-off timed out.
+struct HandoffStopCont : public Continuation {
+  int
+  mainEvent(int /* event */, Event *e)
+  {
+    RecInt active    = 0;
+    RecInt threshold = 0;
+
+    RecGetRecordInt("proxy.process.http.current_active_client_connections", &active);
+    RecGetRecordInt("proxy.config.restart.active_client_threshold", &threshold);
+    if (active > threshold && ink_hrtime_to_sec(Thread::get_hrtime() - started) < timeout) {
+      return EVENT_CONT;
+    }
+
+    Note("handing off with %" PRId64 " active clients, shutting down", active);
+    e->cancel();
+    // the cache is closed by the exit of this process, which releases the server lock
+    sync_cache_dir_on_shutdown();
+    eventProcessor.schedule_imm(new AutoStopCont(), ET_CALL);
+    delete this;
+    return EVENT_DONE;
+  }
+
+  explicit HandoffStopCont(RecInt timeout_secs)
+    : Continuation(new_ProxyMutex()), started(Thread::get_hrtime()), timeout(timeout_secs)
+  {
+    SET_HANDLER(&HandoffStopCont::mainEvent);
+  }
+
+  ink_hrtime started;
+  RecInt timeout;
+};
+
+// Opens the cache of a traffic_server taken over from another, once that one released the server lock.
+struct HandoffCacheCont : public Continuation {
+  int
+  mainEvent(int /* event */, Event *e)
+  {
+    pid_t holding_pid = -1;
+
+    if (server_lockfile.Get(&holding_pid) != 1) {
+      if (!waiting) {
+        Note("waiting for process %ld to release the cache", static_cast<long>(holding_pid));
+        waiting = true;
+      }
+      return EVENT_CONT;
+    }
+
+    Note("took over the server lock, starting the cache");
+    e->cancel();
+    cacheProcessor.start();
+    delete this;
+    return EVENT_DONE;
+  }
+
+  explicit HandoffCacheCont(const std::string &lockfile) : Continuation(new_ProxyMutex()), server_lockfile(lockfile.c_str())
+  {
+    SET_HANDLER(&HandoffCacheCont::mainEvent);
+  }
+
+  // not closed once taken, the lock is held until the process exits
+  Lockfile server_lockfile;
+  bool waiting = false;
+};
+
 class SignalContinuation : public Continuation
 {
 public:
@@ -459,6 +534,43 @@ private:
   struct rusage _usage;
 };
 
+/// Copy the stats of the jemalloc arenas of the subsystems to proxy.process.allocator.arena.<name>.*
+class ArenaStats : public Continuation
+{
+public:
+  ArenaStats() : Continuation(new_ProxyMutex()) { SET_HANDLER(&ArenaStats::periodic); }
+
+  int
+  periodic(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    jearena::Arena::for_each([this](jearena::Arena &arena) {
+      jearena::Arena::Stats stats;
+      if (!arena.stats(stats)) {
+        return;
+      }
+      set(arena, "allocated", stats.allocated);
+      set(arena, "active", stats.active);
+      set(arena, "dirty", stats.dirty);
+      set(arena, "resident", stats.resident);
+      set(arena, "mapped", stats.mapped);
+    });
+    return EVENT_CONT;
+  }
+
+private:
+  void
+  set(jearena::Arena &arena, const char *stat, size_t value)
+  {
+    char name[128];
+
+    snprintf(name, sizeof(name), "proxy.process.allocator.arena.%s.%s", arena.name(), stat);
+    // The arenas are created as the subsystems start, so the stats are registered as they are first seen.
+    if (RecSetRecordInt(name, static_cast<RecInt>(value), REC_SOURCE_DEFAULT) != REC_ERR_OKAY) {
+      RecRegisterStatInt(RECT_PROCESS, name, static_cast<RecInt>(value), RECP_NON_PERSISTENT);
+    }
+  }
+};
+
 /** Gate the emission of the "Traffic Server is fuly initialized" log message.
  *
  * This message is intended to be helpful to users who want to know that
@@ -495,6 +607,68 @@ emit_fully_initialized_message()
   }
 }
 
+// Set the startup time @a stat to the milliseconds since main() started.
+static void
+record_startup_time(const char *stat)
+{
+  RecSetRecordInt(stat, ink_hrtime_to_msec(ink_get_hrtime_internal() - startup_began_at), REC_SOURCE_DEFAULT);
+}
+
+/** A stage of the startup, run on a thread of its own if the startup is parallel.
+ *
+ * The time the stage took is recorded in @c proxy.node.restarts.proxy.startup.<name>_ms. A stage
+ * running on a thread of its own has an EThread, as the main thread does, for what it initializes
+ * to allocate from.
+ */
+class StartupStage
+{
+public:
+  explicit StartupStage(const char *name) : stat(std::string("proxy.node.restarts.proxy.startup.") + name + "_ms") {}
+
+  void
+  run(std::function<void()> fn, bool parallel)
+  {
+    ink_hrtime started = ink_get_hrtime_internal();
+
+    if (!parallel) {
+      fn();
+      finish(started);
+      return;
+    }
+
+    thread = std::thread([this, fn, started]() {
+      Thread *t = new EThread;
+      t->set_specific();
+      fn();
+      finish(started);
+    });
+  }
+
+  /// Wait for the stage to be done.
+  void
+  join()
+  {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  ~StartupStage() { join(); }
+
+private:
+  void
+  finish(ink_hrtime started)
+  {
+    ink_hrtime elapsed = ink_get_hrtime_internal() - started;
+
+    Debug("startup", "%s took %" PRId64 " ms", stat.c_str(), ink_hrtime_to_msec(elapsed));
+    RecSetRecordInt(stat.c_str(), ink_hrtime_to_msec(elapsed), REC_SOURCE_DEFAULT);
+  }
+
+  std::string stat;
+  std::thread thread;
+};
+
 void
 set_debug_ip(const char *ip_string)
 {
@@ -753,6 +927,7 @@ CB_After_Cache_Init()
   int start;
 
   start = ink_atomic_swap(&delay_listen_for_cache, -1);
+  record_startup_time("proxy.node.restarts.proxy.startup.cache_ms");
   emit_fully_initialized_message();
 
 #if TS_ENABLE_FIPS == 0
@@ -773,6 +948,7 @@ CB_After_Cache_Init()
     // call accept on the ports now that the cache is initialized.
     Debug("http_listen", "Delayed listen enable, cache initialization finished");
     start_HttpProxyServer();
+    record_startup_time("proxy.node.restarts.proxy.startup.serving_ms");
     emit_fully_initialized_message();
   }
 
@@ -1517,6 +1693,7 @@ check_system_constants()
 static void
 init_http_header()
 {
+  hdr_heap_init();
   url_init();
   mime_init();
   http_init();
@@ -1725,6 +1902,8 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 #endif
   bool admin_user_p = false;
 
+  startup_began_at = ink_get_hrtime_internal();
+
 #if defined(DEBUG) && defined(HAVE_MCHECK_PEDANTIC)
   mcheck_pedantic(NULL);
 #endif
@@ -1819,6 +1998,23 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   Debug("hugepages", "ats_pagesize reporting %zu", ats_pagesize());
   Debug("hugepages", "ats_hugepage_size reporting %zu", ats_hugepage_size());
 
+  // Before the subsystems that allocate from the arenas are initialized.
+  int arenas = 0;
+  REC_ReadConfigInteger(arenas, "proxy.config.allocator.arenas");
+  if (arenas && !jearena::Arena::enable(arenas == 2)) {
+    Warning("proxy.config.allocator.arenas needs jemalloc 5, the subsystems allocate from the default arena");
+  }
+
+  // Before the event threads start reading the clock.
+  int tsc_clock = 0;
+  REC_ReadConfigInteger(tsc_clock, "proxy.config.system.tsc_clock");
+  if (tsc_clock && !ink_hrtime_tsc_init()) {
+    Warning("proxy.config.system.tsc_clock needs an invariant TSC, the time is read from the system clock");
+  }
+
+  // Before the subsystems create the mutexes to profile.
+  LockProfile::init();
+
   if (!num_accept_threads) {
     REC_ReadConfigInteger(num_accept_threads, "proxy.config.accept_threads");
   }
@@ -1857,7 +2053,8 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
   // Ensure only one copy of traffic server is running, unless it's a command
   // that doesn't require a lock.
-  if (!(command_valid && commands[command_index].no_process_lock)) {
+  // A process taken over from another takes the lock when that one exits.
+  if (!(command_valid && commands[command_index].no_process_lock) && !handoff_flag) {
     check_lockfile();
   }
 
@@ -1980,6 +2177,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   }
 
   REC_ReadConfigInteger(thread_max_heartbeat_mseconds, "proxy.config.thread.max_heartbeat_mseconds");
+  REC_ReadConfigInteger(thread_work_stealing, "proxy.config.exec_thread.work_stealing");
+  REC_ReadConfigInteger(thread_handler_timing, "proxy.config.exec_thread.handler_timing");
+  REC_ReadConfigInteger(thread_slow_handler_mseconds, "proxy.config.exec_thread.slow_handler_ms");
 
   ink_event_system_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
   ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
@@ -2020,6 +2220,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   eventProcessor.schedule_every(new SignalContinuation, HRTIME_MSECOND * 500, ET_CALL);
   eventProcessor.schedule_every(new DiagsLogContinuation, HRTIME_SECOND, ET_TASK);
   eventProcessor.schedule_every(new MemoryLimit, HRTIME_SECOND * 10, ET_TASK);
+  if (arenas) {
+    eventProcessor.schedule_every(new ArenaStats, HRTIME_SECOND * 10, ET_TASK);
+  }
   REC_RegisterConfigUpdateFunc("proxy.config.dump_mem_info_frequency", init_memory_tracker, nullptr);
   init_memory_tracker(nullptr, RECD_NULL, RecData(), nullptr);
 
@@ -2069,9 +2272,23 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     }
     HttpProxyPort::loadDefaultIfEmpty();
 
+    // The HostDB load and the remap load run alongside the rest of the startup if it is parallel. They
+    // are done before the ports are opened.
+    int parallel_startup = 0;
+    REC_ReadConfigInteger(parallel_startup, "proxy.config.startup.parallel");
+    StartupStage hostdb_stage("hostdb");
+    StartupStage plugins_stage("plugins");
+    StartupStage remap_stage("remap");
+    StartupStage ssl_stage("ssl");
+
     dnsProcessor.start(0, stacksize);
-    if (hostDBProcessor.start() < 0)
-      SignalWarning(MGMT_SIGNAL_SYSTEM_ERROR, "bad hostdb or storage configuration, hostdb disabled");
+    hostdb_stage.run(
+      []() {
+        if (hostDBProcessor.start() < 0) {
+          SignalWarning(MGMT_SIGNAL_SYSTEM_ERROR, "bad hostdb or storage configuration, hostdb disabled");
+        }
+      },
+      parallel_startup);
 
     // initialize logging (after event and net processor)
     Log::init(remote_management_flag ? 0 : Log::NO_REMOTE_MANAGEMENT);
@@ -2079,18 +2296,28 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     (void)parsePluginConfig();
 
     // Init plugins as soon as logging is ready.
-    (void)plugin_init(); // plugin.config
+    plugins_stage.run([]() { (void)plugin_init(); }, false); // plugin.config
+
+    // The remap plugins are loaded after the global ones, while the certificates are.
+    remap_stage.run([]() { init_reverse_proxy(); }, parallel_startup);
 
     SSLConfigParams::init_ssl_ctx_cb  = init_ssl_ctx_callback;
     SSLConfigParams::load_ssl_file_cb = load_ssl_file_callback;
-    sslNetProcessor.start(-1, stacksize);
+    ssl_stage.run([stacksize]() { sslNetProcessor.start(-1, stacksize); }, false);
 #if TS_USE_QUIC == 1
     quic_NetProcessor.start(-1, stacksize);
 #endif
     pmgmt->registerPluginCallbacks(global_config_cbs);
 
     cacheProcessor.afterInitCallbackSet(&CB_After_Cache_Init);
-    cacheProcessor.start();
+    if (handoff_flag) {
+      // the process handing off still has the cache open, it is started once that one exits
+      std::string rundir(RecConfigReadRuntimeDir());
+      eventProcessor.schedule_every(new HandoffCacheCont(Layout::relative_to(rundir, SERVER_LOCK)), HRTIME_MSECONDS(100),
+                                    ET_CALL);
+    } else {
+      cacheProcessor.start();
+    }
 
     // UDP net-threads are turned off by default.
     if (!num_of_udp_threads) {
@@ -2113,6 +2340,8 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     // main server logic initiated here //
     //////////////////////////////////////
 
+    hostdb_stage.join();
+    remap_stage.join();
     init_accept_HttpProxyServer(num_accept_threads);
     transformProcessor.start();
 
@@ -2129,6 +2358,12 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
       int delay_p = 0;
       REC_ReadConfigInteger(delay_p, "proxy.config.http.wait_for_cache");
+      if (delay_p && handoff_flag) {
+        // The cache opens once the process handing off has exited, which stopped accepting already.
+        Warning("proxy.config.http.wait_for_cache is ignored when taking over from another traffic_server, "
+                "accepting before the cache is ready");
+        delay_p = 0;
+      }
 
       // Check the condition variable.
       {
@@ -2156,6 +2391,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
         // In either case we should not delay to accept the ports.
         Debug("http_listen", "Not delaying listen");
         start_HttpProxyServer(); // PORTS_READY_HOOK called from in here
+        record_startup_time("proxy.node.restarts.proxy.startup.serving_ms");
         emit_fully_initialized_message();
       }
     }
@@ -2176,6 +2412,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     pmgmt->registerMgmtCallback(MGMT_EVENT_SHUTDOWN, &mgmt_restart_shutdown_callback);
     pmgmt->registerMgmtCallback(MGMT_EVENT_RESTART, &mgmt_restart_shutdown_callback);
     pmgmt->registerMgmtCallback(MGMT_EVENT_DRAIN, &mgmt_drain_callback);
+    pmgmt->registerMgmtCallback(MGMT_EVENT_HANDOFF, &mgmt_handoff_callback);
 
     // Callback for various storage commands. These all go to the same function so we
     // pass the event code along so it can do the right thing. We cast that to <int> first
@@ -2184,6 +2421,9 @@ main(int /* argc ATS_UNUSED */, const char **argv)
       mgmt_storage_device_cmd_callback(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, span.view());
     });
     pmgmt->registerMgmtCallback(MGMT_EVENT_LIFECYCLE_MESSAGE, &mgmt_lifecycle_msg_callback);
+    pmgmt->registerMgmtCallback(MGMT_EVENT_CACHE_SCAN, [](ts::MemSpan<void> span) -> void { cache_scan_request(span.view()); });
+    pmgmt->registerMgmtCallback(MGMT_EVENT_CACHE_TAG_INVALIDATE,
+                                [](ts::MemSpan<void> span) -> void { cache_tag_invalidate_request(span.view()); });
 
     ink_set_thread_name("[TS_MAIN]");
 
@@ -2226,6 +2466,21 @@ mgmt_drain_callback(ts::MemSpan<void> span)
   RecSetRecordInt("proxy.node.config.draining", TSSystemState::is_draining() ? 1 : 0, REC_SOURCE_DEFAULT);
 }
 
+static void
+mgmt_handoff_callback(ts::MemSpan<void>)
+{
+  RecInt timeout = 0;
+
+  RecGetRecordInt("proxy.config.restart.handoff_timeout", &timeout);
+  Note("handing off to a new traffic_server, draining for at most %" PRId64 " seconds", timeout);
+
+  // the listening sockets stay open in traffic_manager, the new process accepts on them
+  RecSetRecordInt("proxy.node.config.draining", 1, REC_SOURCE_DEFAULT);
+  TSSystemState::drain(true);
+  stop_HttpProxyServer();
+  eventProcessor.schedule_every(new HandoffStopCont(timeout), HRTIME_SECONDS(1), ET_CALL);
+}
+
 static void
 mgmt_storage_device_cmd_callback(int cmd, std::string_view const &arg)
 {
@@ -25,12 +25,15 @@
 #endif
 #include <map>
 #include <string>
+#include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <cinttypes>
 #include <sys/time.h>
 #include "mgmtapi.h"
+#include "records/I_RecDefs.h"
+#include "records/I_RecStatsSegment.h"
 
 struct LookupItem {
   LookupItem(const char *s, const char *n, const int t) : pretty(s), name(n), numerator(""), denominator(""), type(t) {}
@@ -55,6 +58,8 @@ const char global[]    = "\"global\": {\n";
 const char start[]     = "\"proxy.process.";
 const char separator[] = "\": \"";
 const char end[]       = "\",\n";
+// the stats there are a number of, one for each thread, volume or plugin hook
+const char dynamic[] = "^proxy\\.process\\.(eventloop\\.thread|cache\\.volume_[0-9]+|plugin)\\.";
 }; // namespace constant
 
 //----------------------------------------------------------------------------
@@ -264,12 +269,55 @@ public:
     // ratio
     lookup_table.insert(make_pair("client_req_time", LookupItem("Resp (ms)", "total_time", "client_req", 3)));
     lookup_table.insert(make_pair("client_dyn_ka", LookupItem("Dynamic KA", "ka_total", "ka_count", 3)));
+
+    // event loop latency in microseconds
+    lookup_table.insert(make_pair("loop_p50", LookupItem("Loop p50", "proxy.process.eventloop.latency.loop.p50", 1)));
+    lookup_table.insert(make_pair("loop_p99", LookupItem("Loop p99", "proxy.process.eventloop.latency.loop.p99", 1)));
+    lookup_table.insert(make_pair("loop_p999", LookupItem("Loop p999", "proxy.process.eventloop.latency.loop.p999", 1)));
+    lookup_table.insert(make_pair("loop_max", LookupItem("Loop max", "proxy.process.eventloop.latency.loop.max", 1)));
+    lookup_table.insert(make_pair("late_p50", LookupItem("Late p50", "proxy.process.eventloop.latency.lateness.p50", 1)));
+    lookup_table.insert(make_pair("late_p99", LookupItem("Late p99", "proxy.process.eventloop.latency.lateness.p99", 1)));
+    lookup_table.insert(make_pair("late_p999", LookupItem("Late p999", "proxy.process.eventloop.latency.lateness.p999", 1)));
+    lookup_table.insert(make_pair("late_max", LookupItem("Late max", "proxy.process.eventloop.latency.lateness.max", 1)));
+    lookup_table.insert(make_pair("handler_p50", LookupItem("Hndlr p50", "proxy.process.eventloop.latency.handler.p50", 1)));
+    lookup_table.insert(make_pair("handler_p99", LookupItem("Hndlr p99", "proxy.process.eventloop.latency.handler.p99", 1)));
+    lookup_table.insert(make_pair("handler_p999", LookupItem("Hndlr p999", "proxy.process.eventloop.latency.handler.p999", 1)));
+    lookup_table.insert(make_pair("handler_max", LookupItem("Hndlr max", "proxy.process.eventloop.latency.handler.max", 1)));
+
+    // cache locks and disk queues
+    lookup_table.insert(make_pair("lock_retry", LookupItem("Lock Retry", "proxy.process.cache.lock_retry", 2)));
+    lookup_table.insert(make_pair("read_busy_fail", LookupItem("Busy Fail", "proxy.process.cache.read_busy.failure", 2)));
+    lookup_table.insert(make_pair("aio_queued", LookupItem("AIO Queued", "proxy.process.cache.aio.queued", 1)));
+    lookup_table.insert(make_pair("aio_bg_wait", LookupItem("BG Wait us", "proxy.process.cache.aio.background_read_wait", 2)));
+
+    // origin connection reuse
+    lookup_table.insert(
+      make_pair("pool_thread", LookupItem("Thread Hits", "proxy.process.http.server_session_pool.thread_hits", 2)));
+    lookup_table.insert(
+      make_pair("pool_global", LookupItem("Global Hits", "proxy.process.http.server_session_pool.global_hits", 2)));
+    lookup_table.insert(make_pair("pool_hits", LookupItem("Pool Hits", "pool_thread", "pool_global", 6)));
+    lookup_table.insert(make_pair("pool_reuse", LookupItem("Reuse", "pool_hits", "server_req", 4)));
+    lookup_table.insert(make_pair("pool_migrated", LookupItem("Migrated", "proxy.process.http.server_session_pool.migrated", 2)));
+    lookup_table.insert(make_pair("pool_overflow", LookupItem("Overflow", "proxy.process.http.server_session_pool.overflow", 2)));
+    lookup_table.insert(
+      make_pair("prewarm_opened", LookupItem("Prewarmed", "proxy.process.http.server_session_prewarm.opened", 2)));
+    lookup_table.insert(
+      make_pair("prewarm_failed", LookupItem("Prewarm Fail", "proxy.process.http.server_session_prewarm.failed", 2)));
+  }
+
+  /// Read the stats from the stats segment of traffic_server at @a path, instead of asking traffic_manager.
+  bool
+  useSegment(const string &path)
+  {
+    return _segment.open(path.c_str());
   }
 
   void
   getStats()
   {
-    if (_url == "") {
+    if (_segment.pid() != 0) {
+      getSegmentStats();
+    } else if (_url == "") {
       int64_t value = 0;
       if (_old_stats != nullptr) {
         delete _old_stats;
@@ -311,6 +359,7 @@ public:
           }
         }
       }
+      getMatchingStats(constant::dynamic);
       _old_time  = _now;
       _now       = now;
       _time_diff = _now - _old_time;
@@ -359,6 +408,13 @@ public:
     }
   }
 
+  string
+  getString(const string &key, const map<string, string> *stats) const
+  {
+    map<string, string>::const_iterator stats_it = stats->find(key);
+    return stats_it == stats->end() ? string() : stats_it->second;
+  }
+
   int64_t
   getValue(const string &key, const map<string, string> *stats) const
   {
@@ -370,6 +426,37 @@ public:
     return value;
   }
 
+  /// The part between @a prefix and @a suffix of the names of the stats that have both, for the stats
+  /// there are one of for each thread, volume or plugin hook.
+  std::vector<string>
+  getNames(const string &prefix, const string &suffix) const
+  {
+    std::vector<string> names;
+
+    for (auto it = _stats->lower_bound(prefix); it != _stats->end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+      const string &name = it->first;
+      if (name.size() > prefix.size() + suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        names.push_back(name.substr(prefix.size(), name.size() - prefix.size() - suffix.size()));
+      }
+    }
+    return names;
+  }
+
+  /// The value of the stat @a name, which need not be in the lookup table, or its rate per second if @a rate.
+  double
+  getRecord(const string &name, bool rate) const
+  {
+    double value = atof(getString(name, _stats).c_str());
+
+    if (rate && _old_stats != nullptr && _absolute == false) {
+      if (_time_diff <= 0) {
+        return 0;
+      }
+      value = (value - atof(getString(name, _old_stats).c_str())) / _time_diff;
+    }
+    return value;
+  }
+
   void
   getStat(const string &key, double &value, int overrideType = 0)
   {
@@ -519,6 +606,71 @@ public:
     }
   }
 
+  /// Add the stats matching @a regex to the stats asked traffic_manager for.
+  void
+  getMatchingStats(const char *regex)
+  {
+    TSList list = TSListCreate();
+
+    if (TSRecordGetMatchMlt(regex, list) == TS_ERR_OKAY) {
+      for (TSRecordEle *ele = (TSRecordEle *)TSListDequeue(list); ele; ele = (TSRecordEle *)TSListDequeue(list)) {
+        char buffer[32];
+        switch (ele->rec_type) {
+        case TS_REC_INT:
+          snprintf(buffer, sizeof(buffer), "%" PRId64, ele->valueT.int_val);
+          (*_stats)[ele->rec_name] = buffer;
+          break;
+        case TS_REC_COUNTER:
+          snprintf(buffer, sizeof(buffer), "%" PRId64, ele->valueT.counter_val);
+          (*_stats)[ele->rec_name] = buffer;
+          break;
+        case TS_REC_FLOAT:
+          snprintf(buffer, sizeof(buffer), "%f", ele->valueT.float_val);
+          (*_stats)[ele->rec_name] = buffer;
+          break;
+        default:
+          break;
+        }
+        TSRecordEleDestroy(ele);
+      }
+    }
+    TSListDestroy(list);
+  }
+
+  void
+  getSegmentStats()
+  {
+    std::vector<RecStatsSegmentRecord> records;
+
+    // keep the stats there are if it is being written all along
+    if (!_segment.read(records)) {
+      return;
+    }
+
+    if (_old_stats != nullptr) {
+      delete _old_stats;
+      _old_stats = nullptr;
+    }
+    _old_stats = _stats;
+    _stats     = new map<string, string>;
+
+    gettimeofday(&_time, nullptr);
+    double now = _time.tv_sec + (double)_time.tv_usec / 1000000;
+
+    for (const RecStatsSegmentRecord &r : records) {
+      char buffer[32];
+      if (r.data_type == RECD_FLOAT) {
+        snprintf(buffer, sizeof(buffer), "%f", r.rec_float);
+      } else {
+        snprintf(buffer, sizeof(buffer), "%" PRId64, r.rec_int);
+      }
+      (*_stats)[r.name] = buffer;
+    }
+    _old_time  = _now;
+    _now       = now;
+    _time_diff = _now - _old_time;
+  }
+
   const string &
   getHost() const
   {
@@ -547,6 +699,7 @@ private:
   map<string, LookupItem> lookup_table;
   string _url;
   string _host;
+  RecStatsSegmentReader _segment;
   double _old_time;
   double _now;
   double _time_diff;
@@ -22,9 +22,11 @@
 */
 
 #include "tscore/ink_config.h"
+#include <algorithm>
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <iostream>
 #include <cassert>
@@ -55,6 +57,7 @@
 
 #include "tscore/I_Layout.h"
 #include "tscore/ink_args.h"
+#include "tscore/Filenames.h"
 #include "records/I_RecProcess.h"
 #include "RecordsConfig.h"
 #include "tscore/runroot.h"
@@ -220,6 +223,225 @@ response_code_page(Stats &stats)
   makeTable(42, 1, response3, stats);
 }
 
+//----------------------------------------------------------------------------
+static void
+latency_page(Stats &stats)
+{
+  attron(COLOR_PAIR(colorPair::border));
+  attron(A_BOLD);
+  mvprintw(0, 0, "     EVENT LOOP (us)                LATENESS (us)           HANDLER (us)          ");
+  attroff(COLOR_PAIR(colorPair::border));
+  attroff(A_BOLD);
+
+  list<string> loop;
+  loop.push_back("loop_p50");
+  loop.push_back("loop_p99");
+  loop.push_back("loop_p999");
+  loop.push_back("loop_max");
+  makeTable(0, 1, loop, stats);
+
+  list<string> late;
+  late.push_back("late_p50");
+  late.push_back("late_p99");
+  late.push_back("late_p999");
+  late.push_back("late_max");
+  makeTable(27, 1, late, stats);
+
+  list<string> handler;
+  handler.push_back("handler_p50");
+  handler.push_back("handler_p99");
+  handler.push_back("handler_p999");
+  handler.push_back("handler_max");
+  makeTable(54, 1, handler, stats);
+}
+
+//----------------------------------------------------------------------------
+// The rows of the per thread, volume and plugin pages, below the title and above the status line.
+static const int MAX_ROWS = 22;
+
+static vector<int>
+numberedNames(const Stats &stats, const string &prefix, const string &suffix)
+{
+  vector<int> numbers;
+  for (const string &name : stats.getNames(prefix, suffix)) {
+    numbers.push_back(atoi(name.c_str()));
+  }
+  sort(numbers.begin(), numbers.end());
+  return numbers;
+}
+
+static void
+noStats(const char *what)
+{
+  mvprintw(2, 0, "There are no %s stats yet.", what);
+}
+
+//----------------------------------------------------------------------------
+static void
+thread_page(Stats &stats)
+{
+  attron(COLOR_PAIR(colorPair::border));
+  attron(A_BOLD);
+  mvprintw(0, 0, "  THREAD    BUSY      LOOP p999     max  LATE p999     max  HNDLR p999     max  ");
+  attroff(COLOR_PAIR(colorPair::border));
+  attroff(A_BOLD);
+
+  static const char *const latency[] = {"loop", "lateness", "handler"};
+  struct Row {
+    int thread;
+    double busy;
+  };
+  vector<Row> rows;
+
+  for (int thread : numberedNames(stats, "proxy.process.eventloop.thread.", ".busy")) {
+    rows.push_back({thread, stats.getRecord("proxy.process.eventloop.thread." + to_string(thread) + ".busy", false)});
+  }
+  if (rows.empty()) {
+    noStats("per thread");
+    return;
+  }
+
+  // the busiest threads first
+  stable_sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.busy > b.busy; });
+  for (size_t i = 0; i < rows.size() && i < MAX_ROWS; ++i) {
+    string prefix = "proxy.process.eventloop.thread." + to_string(rows[i].thread) + ".latency.";
+    int y         = i + 1;
+
+    mvprintw(y, 0, "ET_NET %d", rows[i].thread);
+    prettyPrint(9, y, rows[i].busy, 4);
+    for (int s = 0; s < 3; ++s) {
+      prettyPrint(20 + s * 20, y, stats.getRecord(prefix + latency[s] + ".p999", false), 1);
+      prettyPrint(28 + s * 20, y, stats.getRecord(prefix + latency[s] + ".max", false), 1);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+static void
+cache_volume_page(Stats &stats)
+{
+  attron(COLOR_PAIR(colorPair::border));
+  attron(A_BOLD);
+  mvprintw(0, 0, "  VOLUME   LOOKUPS    READS   WRITES  READ ACT WRITE ACT  LOCK RETRY BUSY FAIL ");
+  mvprintw(17, 0, "         CACHE LOCKS                   ");
+  mvprintw(17, 40, "            DISK QUEUES                 ");
+  attroff(COLOR_PAIR(colorPair::border));
+  attroff(A_BOLD);
+
+  vector<int> volumes = numberedNames(stats, "proxy.process.cache.volume_", ".lookup.active");
+  if (volumes.empty()) {
+    noStats("per volume");
+  }
+
+  // there is room for the totals below the volumes
+  for (size_t i = 0; i < volumes.size() && i < 16; ++i) {
+    string prefix = "proxy.process.cache.volume_" + to_string(volumes[i]) + ".";
+    auto rate     = [&](const char *success, const char *failure) {
+      return stats.getRecord(prefix + success, true) + stats.getRecord(prefix + failure, true);
+    };
+    int y = i + 1;
+
+    mvprintw(y, 0, "Volume %d", volumes[i]);
+    prettyPrint(10, y, rate("lookup.success", "lookup.failure"), 2);
+    prettyPrint(19, y, rate("read.success", "read.failure"), 2);
+    prettyPrint(28, y, rate("write.success", "write.failure"), 2);
+    prettyPrint(38, y, stats.getRecord(prefix + "read.active", false), 1);
+    prettyPrint(48, y, stats.getRecord(prefix + "write.active", false), 1);
+    prettyPrint(60, y, stats.getRecord(prefix + "lock_retry", true), 2);
+    prettyPrint(70, y, stats.getRecord(prefix + "read_busy.failure", true), 2);
+  }
+
+  list<string> locks;
+  locks.push_back("lock_retry");
+  locks.push_back("read_busy_fail");
+  locks.push_back("read_active");
+  locks.push_back("write_active");
+  makeTable(0, 18, locks, stats);
+
+  list<string> queues;
+  queues.push_back("aio_queued");
+  queues.push_back("aio_bg_wait");
+  makeTable(41, 18, queues, stats);
+}
+
+//----------------------------------------------------------------------------
+static void
+plugin_page(Stats &stats)
+{
+  attron(COLOR_PAIR(colorPair::border));
+  attron(A_BOLD);
+  mvprintw(0, 0, "  PLUGIN.HOOK                  CALLS  US/CALL     CPU  WAIT US/CALL  >10MS CALLS");
+  attroff(COLOR_PAIR(colorPair::border));
+  attroff(A_BOLD);
+
+  struct Row {
+    string name;
+    double calls;
+    double time;
+  };
+  vector<Row> rows;
+
+  for (const string &name : stats.getNames("proxy.process.plugin.", ".calls")) {
+    string prefix = "proxy.process.plugin." + name + ".";
+    rows.push_back({name, stats.getRecord(prefix + "calls", true), stats.getRecord(prefix + "time", true)});
+  }
+  if (rows.empty()) {
+    noStats("plugin hook");
+    mvprintw(3, 0, "They are kept when proxy.config.plugin.hook_stats is set.");
+    return;
+  }
+
+  // where the time goes first
+  stable_sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.time > b.time; });
+  for (size_t i = 0; i < rows.size() && i < MAX_ROWS; ++i) {
+    const Row &row = rows[i];
+    string prefix  = "proxy.process.plugin." + row.name + ".";
+    int y          = i + 1;
+
+    mvprintw(y, 0, "%-30.30s", row.name.c_str());
+    prettyPrint(30, y, row.calls, 2);
+    prettyPrint(39, y, row.calls > 0 ? row.time / row.calls : 0, 1);
+    // microseconds each second, as a share of a thread
+    prettyPrint(47, y, row.time / 10000, 4);
+    prettyPrint(59, y, row.calls > 0 ? stats.getRecord(prefix + "wait", true) / row.calls : 0, 1);
+    prettyPrint(71, y, stats.getRecord(prefix + "time_inf", true), 2);
+  }
+}
+
+//----------------------------------------------------------------------------
+static void
+origin_page(Stats &stats)
+{
+  attron(COLOR_PAIR(colorPair::border));
+  attron(A_BOLD);
+  mvprintw(0, 0, "         ORIGIN CONNECTIONS            ");
+  mvprintw(0, 40, "          CONNECTION POOL               ");
+  for (int i = 0; i <= 22; ++i) {
+    mvprintw(i, 39, " ");
+  }
+  attroff(COLOR_PAIR(colorPair::border));
+  attroff(A_BOLD);
+
+  list<string> origin;
+  origin.push_back("server_req");
+  origin.push_back("server_conn");
+  origin.push_back("server_req_conn");
+  origin.push_back("server_curr_conn");
+  origin.push_back("conn_fail");
+  makeTable(0, 1, origin, stats);
+
+  list<string> pool;
+  pool.push_back("pool_reuse");
+  pool.push_back("pool_hits");
+  pool.push_back("pool_thread");
+  pool.push_back("pool_global");
+  pool.push_back("pool_migrated");
+  pool.push_back("pool_overflow");
+  pool.push_back("prewarm_opened");
+  pool.push_back("prewarm_failed");
+  makeTable(41, 1, pool, stats);
+}
+
 //----------------------------------------------------------------------------
 static void
 help(const string &host, const string &version)
@@ -388,13 +610,14 @@ int
 main(int argc, const char **argv)
 {
 #if HAS_CURL
-  static const char USAGE[] = "Usage: traffic_top [-s seconds] [URL|hostname|hostname:port]";
+  static const char USAGE[] = "Usage: traffic_top [-s seconds] [-m] [URL|hostname|hostname:port]";
 #else
-  static const char USAGE[] = "Usage: traffic_top [-s seconds]";
+  static const char USAGE[] = "Usage: traffic_top [-s seconds] [-m]";
 #endif
 
-  int sleep_time = 6; // In seconds
-  bool absolute  = false;
+  int sleep_time  = 6; // In seconds
+  bool absolute   = false;
+  int use_segment = 0;
   string url;
 
   AppVersionInfo version;
@@ -402,6 +625,7 @@ main(int argc, const char **argv)
 
   const ArgumentDescription argument_descriptions[] = {
     {"sleep", 's', "Sets the delay between updates (in seconds)", "I", &sleep_time, nullptr, nullptr},
+    {"segment", 'm', "Reads the stats from the stats segment of traffic_server", "F", &use_segment, nullptr, nullptr},
     HELP_ARGUMENT_DESCRIPTION(),
     VERSION_ARGUMENT_DESCRIPTION(),
     RUNROOT_ARGUMENT_DESCRIPTION(),
@@ -416,6 +640,10 @@ main(int argc, const char **argv)
 
   switch (n_file_arguments) {
   case 0: {
+    if (use_segment) {
+      break;
+    }
+
     ats_scoped_str rundir(RecConfigReadRuntimeDir());
 
     TSMgmtError err = TSInit(rundir, static_cast<TSInitOptionT>(TS_MGMT_OPT_NO_EVENTS | TS_MGMT_OPT_NO_SOCK_TESTS));
@@ -439,6 +667,14 @@ main(int argc, const char **argv)
   }
 
   Stats stats(url);
+  if (use_segment) {
+    std::string segment_path = Layout::relative_to(RecConfigReadRuntimeDir(), ts::filename::STATS_SEGMENT);
+    if (!url.empty() || !stats.useSegment(segment_path)) {
+      fprintf(stderr, "Error: cannot read the stats segment %s, is proxy.config.stats.segment.enabled set?\n",
+              segment_path.c_str());
+      exit(1);
+    }
+  }
   stats.getStats();
   const string &host = stats.getHost();
 
@@ -459,9 +695,13 @@ main(int argc, const char **argv)
   enum Page {
     MAIN_PAGE,
     RESPONSE_PAGE,
+    LATENCY_PAGE,
+    THREAD_PAGE,
+    CACHE_VOLUME_PAGE,
+    PLUGIN_PAGE,
+    ORIGIN_PAGE,
   };
-  Page page       = MAIN_PAGE;
-  string page_alt = "(r)esponse";
+  Page page = MAIN_PAGE;
 
   while (true) {
     attron(COLOR_PAIR(colorPair::border));
@@ -475,7 +715,8 @@ main(int argc, const char **argv)
     strftime(timeBuf, sizeof(timeBuf), "%H:%M:%S", &nowtm);
     stats.getStat("version", version);
 
-    mvprintw(23, 0, "%-20.20s   %30s (q)uit (h)elp (%c)bsolute  ", host.c_str(), page_alt.c_str(), absolute ? 'A' : 'a');
+    mvprintw(23, 0, "%-10.10s (m)ain (r)esp (l)at (t)hr (c)ache (p)lug (o)rig (q)uit (h)elp (%c)bs ", host.c_str(),
+             absolute ? 'A' : 'a');
     attroff(COLOR_PAIR(colorPair::border));
     attroff(A_BOLD);
 
@@ -483,6 +724,16 @@ main(int argc, const char **argv)
       main_stats_page(stats);
     } else if (page == RESPONSE_PAGE) {
       response_code_page(stats);
+    } else if (page == LATENCY_PAGE) {
+      latency_page(stats);
+    } else if (page == THREAD_PAGE) {
+      thread_page(stats);
+    } else if (page == CACHE_VOLUME_PAGE) {
+      cache_volume_page(stats);
+    } else if (page == PLUGIN_PAGE) {
+      plugin_page(stats);
+    } else if (page == ORIGIN_PAGE) {
+      origin_page(stats);
     }
 
     curs_set(0);
@@ -497,12 +748,25 @@ main(int argc, const char **argv)
     case 'q':
       goto quit;
     case 'm':
-      page     = MAIN_PAGE;
-      page_alt = "(r)esponse";
+      page = MAIN_PAGE;
       break;
     case 'r':
-      page     = RESPONSE_PAGE;
-      page_alt = "(m)ain";
+      page = RESPONSE_PAGE;
+      break;
+    case 'l':
+      page = LATENCY_PAGE;
+      break;
+    case 't':
+      page = THREAD_PAGE;
+      break;
+    case 'c':
+      page = CACHE_VOLUME_PAGE;
+      break;
+    case 'p':
+      page = PLUGIN_PAGE;
+      break;
+    case 'o':
+      page = ORIGIN_PAGE;
       break;
     case 'a':
       absolute = stats.toggleAbsolute();
@@ -47,8 +47,9 @@
 #include "tscore/BufferWriter.h"
 #include "tscore/Diags.h"
 
-int diags_on_for_plugins         = 0;
-int DiagsConfigState::enabled[2] = {0, 0};
+int diags_on_for_plugins                    = 0;
+int DiagsConfigState::enabled[2]            = {0, 0};
+std::atomic<uint64_t> Diags::tag_generation = {1};
 
 // Global, used for all diagnostics
 inkcoreapi Diags *diags = nullptr;
@@ -141,6 +142,7 @@ Diags::Diags(std::string_view prefix_string, const char *bdt, const char *bat, B
 
   activated_tags[DiagsTagType_Debug]  = nullptr;
   activated_tags[DiagsTagType_Action] = nullptr;
+  tag_generation.fetch_add(1, std::memory_order_release);
 
   outputlog_rolling_enabled  = RollingEnabledValues::NO_ROLLING;
   outputlog_rolling_interval = -1;
@@ -373,6 +375,7 @@ Diags::activate_taglist(const char *taglist, DiagsTagType mode)
     }
     activated_tags[mode] = new DFA;
     activated_tags[mode]->compile(taglist);
+    tag_generation.fetch_add(1, std::memory_order_release);
     unlock();
   }
 }
@@ -395,6 +398,7 @@ Diags::deactivate_all(DiagsTagType mode)
     delete activated_tags[mode];
     activated_tags[mode] = nullptr;
   }
+  tag_generation.fetch_add(1, std::memory_order_release);
   unlock();
 }
 
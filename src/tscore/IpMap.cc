@@ -1115,10 +1115,18 @@ bwformat(BufferWriter &w, BWFSpec const &spec, detail::IpMapBase<N> const &map)
 
 } // namespace ts
 //----------------------------------------------------------------------------
-IpMap::IpMap(IpMap::self_type &&that) noexcept : _m4(that._m4), _m6(that._m6)
+IpMap::IpMap(IpMap::self_type &&that) noexcept
+  : _m4(that._m4),
+    _m6(that._m6),
+    _compiled(that._compiled),
+    _c4_min(std::move(that._c4_min)),
+    _c4_range(std::move(that._c4_range)),
+    _c6_min(std::move(that._c6_min)),
+    _c6_range(std::move(that._c6_range))
 {
-  that._m4 = nullptr;
-  that._m6 = nullptr;
+  that._m4       = nullptr;
+  that._m6       = nullptr;
+  that._compiled = false;
 }
 
 IpMap::self_type &
@@ -1128,6 +1136,11 @@ IpMap::operator=(IpMap::self_type &&that)
     this->clear();
     std::swap(_m4, that._m4);
     std::swap(_m6, that._m6);
+    std::swap(_compiled, that._compiled);
+    _c4_min.swap(that._c4_min);
+    _c4_range.swap(that._c4_range);
+    _c6_min.swap(that._c6_min);
+    _c6_range.swap(that._c6_range);
   }
   return *this;
 }
@@ -1156,14 +1169,71 @@ IpMap::force6()
   return _m6;
 }
 
+namespace
+{
+inline bool
+operator<=(IpMap::Ip6Key const &lhs, IpMap::Ip6Key const &rhs)
+{
+  // no branch, as for the integers of IPv4
+  return (lhs._hi < rhs._hi) | ((lhs._hi == rhs._hi) & (lhs._lo <= rhs._lo));
+}
+
+inline IpMap::Ip6Key
+ip6_key(in6_addr const &addr)
+{
+  IpMap::Ip6Key key{0, 0};
+  for (int i = 0; i < 8; ++i) {
+    key._hi = (key._hi << 8) | addr.s6_addr[i];
+    key._lo = (key._lo << 8) | addr.s6_addr[i + 8];
+  }
+  return key;
+}
+
+/* Search the compiled ranges for @a target: the last range starting at or before it, if it ends at
+   or after it. The halving step is a conditional move, the loop runs log2(n) times whatever the
+   target, so the search does not mispredict.
+*/
+template <typename K>
+bool
+compiled_contains(std::vector<K> const &mins, std::vector<IpMap::CompiledRange<K>> const &ranges, K const &target, void **ptr)
+{
+  size_t n = mins.size();
+  if (n == 0 || !(mins[0] <= target)) {
+    return false;
+  }
+  K const *base = mins.data();
+  while (n > 1) {
+    size_t half = n / 2;
+    base        = (base[half] <= target) ? base + half : base;
+    n -= half;
+  }
+  auto const &range = ranges[base - mins.data()];
+  if (!(target <= range._max)) {
+    return false;
+  }
+  if (ptr) {
+    *ptr = range._data;
+  }
+  return true;
+}
+} // namespace
+
 bool
 IpMap::contains(sockaddr const *target, void **ptr) const
 {
   bool zret = false;
   if (AF_INET == target->sa_family) {
-    zret = _m4 && _m4->contains(ntohl(ats_ip4_addr_cast(target)), ptr);
+    if (_compiled) {
+      zret = compiled_contains(_c4_min, _c4_range, static_cast<in_addr_t>(ntohl(ats_ip4_addr_cast(target))), ptr);
+    } else {
+      zret = _m4 && _m4->contains(ntohl(ats_ip4_addr_cast(target)), ptr);
+    }
   } else if (AF_INET6 == target->sa_family) {
-    zret = _m6 && _m6->contains(ats_ip6_cast(target), ptr);
+    if (_compiled) {
+      zret = compiled_contains(_c6_min, _c6_range, ip6_key(ats_ip6_addr_cast(target)), ptr);
+    } else {
+      zret = _m6 && _m6->contains(ats_ip6_cast(target), ptr);
+    }
   }
   return zret;
 }
@@ -1171,12 +1241,44 @@ IpMap::contains(sockaddr const *target, void **ptr) const
 bool
 IpMap::contains(in_addr_t target, void **ptr) const
 {
+  if (_compiled) {
+    return compiled_contains(_c4_min, _c4_range, static_cast<in_addr_t>(ntohl(target)), ptr);
+  }
   return _m4 && _m4->contains(ntohl(target), ptr);
 }
 
+IpMap &
+IpMap::compile()
+{
+  this->uncompile();
+  for (auto &node : *this) {
+    sockaddr const *min = node.min();
+    if (AF_INET == min->sa_family) {
+      _c4_min.push_back(ntohl(ats_ip4_addr_cast(min)));
+      _c4_range.push_back({static_cast<in_addr_t>(ntohl(ats_ip4_addr_cast(node.max()))), node.data()});
+    } else {
+      _c6_min.push_back(ip6_key(ats_ip6_addr_cast(min)));
+      _c6_range.push_back({ip6_key(ats_ip6_addr_cast(node.max())), node.data()});
+    }
+  }
+  _compiled = true;
+  return *this;
+}
+
+void
+IpMap::uncompile()
+{
+  _compiled = false;
+  _c4_min.clear();
+  _c4_range.clear();
+  _c6_min.clear();
+  _c6_range.clear();
+}
+
 IpMap &
 IpMap::mark(sockaddr const *min, sockaddr const *max, void *data)
 {
+  this->uncompile();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     this->force4()->mark(ntohl(ats_ip4_addr_cast(min)), ntohl(ats_ip4_addr_cast(max)), data);
@@ -1189,6 +1291,7 @@ IpMap::mark(sockaddr const *min, sockaddr const *max, void *data)
 IpMap &
 IpMap::mark(in_addr_t min, in_addr_t max, void *data)
 {
+  this->uncompile();
   this->force4()->mark(ntohl(min), ntohl(max), data);
   return *this;
 }
@@ -1196,6 +1299,7 @@ IpMap::mark(in_addr_t min, in_addr_t max, void *data)
 IpMap &
 IpMap::unmark(sockaddr const *min, sockaddr const *max)
 {
+  this->uncompile();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     if (_m4) {
@@ -1212,6 +1316,7 @@ IpMap::unmark(sockaddr const *min, sockaddr const *max)
 IpMap &
 IpMap::unmark(in_addr_t min, in_addr_t max)
 {
+  this->uncompile();
   if (_m4) {
     _m4->unmark(ntohl(min), ntohl(max));
   }
@@ -1221,6 +1326,7 @@ IpMap::unmark(in_addr_t min, in_addr_t max)
 IpMap &
 IpMap::fill(sockaddr const *min, sockaddr const *max, void *data)
 {
+  this->uncompile();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     this->force4()->fill(ntohl(ats_ip4_addr_cast(min)), ntohl(ats_ip4_addr_cast(max)), data);
@@ -1233,6 +1339,7 @@ IpMap::fill(sockaddr const *min, sockaddr const *max, void *data)
 IpMap &
 IpMap::fill(in_addr_t min, in_addr_t max, void *data)
 {
+  this->uncompile();
   this->force4()->fill(ntohl(min), ntohl(max), data);
   return *this;
 }
@@ -1253,6 +1360,7 @@ IpMap::count() const
 IpMap &
 IpMap::clear()
 {
+  this->uncompile();
   if (_m4) {
     _m4->clear();
   }
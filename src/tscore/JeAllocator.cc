@@ -16,8 +16,12 @@
 
 #include <unistd.h>
 #include <sys/types.h>
+#include <atomic>
+#include <climits>
 #include <cstring>
 #include <cstdlib>
+#include <mutex>
+#include <string>
 #include <iostream>
 #include "tscore/ink_memory.h"
 #include "tscore/ink_error.h"
@@ -146,4 +150,248 @@ globalJemallocNodumpAllocator()
   static auto instance = new JemallocNodumpAllocator();
   return *instance;
 }
+
+namespace
+{
+bool arenas_enabled   = false;
+bool arenas_hugepages = false;
+std::mutex arenas_mutex;
+Arena *arenas[Arena::MAX_ARENAS];
+std::atomic<int> arenas_count{0};
+
+#if JEMALLOC_ARENA_SUPPORTED
+/// The transparent huge pages of x86_64 and aarch64.
+constexpr size_t ARENA_HUGEPAGE_SIZE = 2 * 1024 * 1024;
+
+/// The tcaches of the thread for the arenas, destroyed with the thread.
+struct ArenaTcaches {
+  unsigned tcache[Arena::MAX_ARENAS] = {}; ///< The index + 1, 0 if it was not created, UINT_MAX if it could not be.
+  bool destroyed                     = false;
+
+  ~ArenaTcaches()
+  {
+    for (unsigned &tc : tcache) {
+      if (tc != 0 && tc != UINT_MAX) {
+        unsigned index = tc - 1;
+        mallctl("tcache.destroy", nullptr, nullptr, &index, sizeof(index));
+      }
+    }
+    destroyed = true;
+  }
+};
+thread_local ArenaTcaches arena_tcaches;
+#endif /* JEMALLOC_ARENA_SUPPORTED */
+} // namespace
+
+#if JEMALLOC_ARENA_SUPPORTED
+
+extent_hooks_t Arena::extent_hooks_;
+extent_alloc_t *Arena::original_alloc_ = nullptr;
+
+void *
+Arena::alloc(extent_hooks_t *extent, void *new_addr, size_t size, size_t alignment, bool *zero, bool *commit, unsigned arena_ind)
+{
+  // Extents of whole huge pages on huge page boundaries, for the kernel to back them with huge pages.
+  if (arenas_hugepages && new_addr == nullptr && size % ARENA_HUGEPAGE_SIZE == 0 && alignment < ARENA_HUGEPAGE_SIZE) {
+    alignment = ARENA_HUGEPAGE_SIZE;
+  }
+
+  void *result = original_alloc_(extent, new_addr, size, alignment, zero, commit, arena_ind);
+
+  if (result != nullptr) {
+    for (int i = 0; i < count(); ++i) {
+      if (arenas[i]->index_ == arena_ind) {
+        if (arenas[i]->dontdump_) {
+          ats_madvise(static_cast<caddr_t>(result), size, MADV_DONTDUMP);
+        }
+        break;
+      }
+    }
+#ifdef MADV_HUGEPAGE
+    if (arenas_hugepages) {
+      ats_madvise(static_cast<caddr_t>(result), size, MADV_HUGEPAGE);
+    }
+#endif
+  }
+
+  return result;
+}
+
+#endif /* JEMALLOC_ARENA_SUPPORTED */
+
+bool
+Arena::enable(bool hugepages)
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  arenas_enabled   = true;
+  arenas_hugepages = hugepages;
+  return true;
+#else
+  (void)hugepages;
+  return false;
+#endif
+}
+
+Arena *
+Arena::get(const char *name, bool dontdump)
+{
+  if (!arenas_enabled) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(arenas_mutex);
+  int n = count();
+  for (int i = 0; i < n; ++i) {
+    if (strcmp(arenas[i]->name_, name) == 0) {
+      return arenas[i];
+    }
+  }
+  if (n == MAX_ARENAS) {
+    return nullptr;
+  }
+
+#if JEMALLOC_ARENA_SUPPORTED
+  unsigned index;
+  size_t index_len = sizeof(index);
+  if (auto ret = mallctl("arenas.create", &index, &index_len, nullptr, 0)) {
+    ink_abort("Unable to create the %s arena: %s", name, std::strerror(ret));
+  }
+
+  // Known to the hook before it is set.
+  arenas[n]        = new Arena(name, index, dontdump);
+  arenas[n]->slot_ = n;
+  arenas_count.store(n + 1, std::memory_order_release);
+
+  const auto key = "arena." + std::to_string(index) + ".extent_hooks";
+  extent_hooks_t *hooks;
+  size_t hooks_len = sizeof(hooks);
+  if (auto ret = mallctl(key.c_str(), &hooks, &hooks_len, nullptr, 0)) {
+    ink_abort("Unable to get the hooks: %s", std::strerror(ret));
+  }
+  if (original_alloc_ == nullptr) {
+    original_alloc_     = hooks->alloc;
+    extent_hooks_       = *hooks;
+    extent_hooks_.alloc = &Arena::alloc;
+  } else {
+    ink_release_assert(original_alloc_ == hooks->alloc);
+  }
+  extent_hooks_t *new_hooks = &extent_hooks_;
+  if (auto ret = mallctl(key.c_str(), nullptr, nullptr, &new_hooks, sizeof(new_hooks))) {
+    ink_abort("Unable to set the hooks: %s", std::strerror(ret));
+  }
+
+  return arenas[n];
+#else
+  (void)dontdump;
+  return nullptr;
+#endif /* JEMALLOC_ARENA_SUPPORTED */
+}
+
+Arena::Arena(const char *name, unsigned index, bool dontdump)
+  : name_(ats_strdup(name)), index_(index), dontdump_(dontdump), slot_(0)
+{
+}
+
+int
+Arena::count()
+{
+  return arenas_count.load(std::memory_order_acquire);
+}
+
+Arena *
+Arena::at(int i)
+{
+  return arenas[i];
+}
+
+int
+Arena::flags()
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  unsigned &tc = arena_tcaches.tcache[slot_];
+
+  if (unlikely(tc == 0)) {
+    unsigned index;
+    size_t index_len = sizeof(index);
+    // There is a limit to the tcaches of a process, past it the thread does without.
+    if (!arena_tcaches.destroyed && mallctl("tcache.create", &index, &index_len, nullptr, 0) == 0) {
+      tc = index + 1;
+    } else {
+      tc = UINT_MAX;
+    }
+  }
+  return MALLOCX_ARENA(index_) | (tc == UINT_MAX ? MALLOCX_TCACHE_NONE : MALLOCX_TCACHE(tc - 1));
+#else
+  return 0;
+#endif
+}
+
+void *
+Arena::allocate(size_t size, size_t alignment)
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  int flags = this->flags();
+  void *newp;
+
+  if (alignment > 1) {
+    flags |= MALLOCX_ALIGN(alignment);
+  }
+  if (unlikely((newp = mallocx(size, flags)) == nullptr)) {
+    ink_abort("couldn't allocate %zu bytes from the %s arena", size, name_);
+  }
+  return newp;
+#else
+  return alignment > 1 ? ats_memalign(alignment, size) : ats_malloc(size);
+#endif
+}
+
+void
+Arena::deallocate(void *ptr)
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  if (likely(ptr)) {
+    dallocx(ptr, this->flags());
+  }
+#else
+  ats_free(ptr);
+#endif
+}
+
+void
+Arena::refresh_stats()
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  uint64_t epoch = 1;
+  size_t len     = sizeof(epoch);
+  mallctl("epoch", &epoch, &len, &epoch, len);
+#endif
+}
+
+bool
+Arena::stats(Stats &stats) const
+{
+#if JEMALLOC_ARENA_SUPPORTED
+  const std::string prefix = "stats.arenas." + std::to_string(index_) + ".";
+  size_t page;
+  size_t small, large, pactive, pdirty;
+  size_t len = sizeof(size_t);
+
+  if (mallctl("arenas.page", &page, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "small.allocated").c_str(), &small, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "large.allocated").c_str(), &large, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "pactive").c_str(), &pactive, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "pdirty").c_str(), &pdirty, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "resident").c_str(), &stats.resident, &len, nullptr, 0) != 0 ||
+      mallctl((prefix + "mapped").c_str(), &stats.mapped, &len, nullptr, 0) != 0) {
+    return false; // jemalloc built without --enable-stats
+  }
+  stats.allocated = small + large;
+  stats.active    = pactive * page;
+  stats.dirty     = pdirty * page;
+  return true;
+#else
+  (void)stats;
+  return false;
+#endif
+}
 } // namespace jearena
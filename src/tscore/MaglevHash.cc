@@ -0,0 +1,153 @@
+/** @file
+
+  A Maglev lookup table of consistent hash nodes
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/MaglevHash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// slots per node at least, enough for the shares of the nodes to be close to their weight
+constexpr uint32_t SLOTS_PER_NODE = 101;
+constexpr uint32_t EMPTY          = UINT32_MAX;
+
+uint32_t
+next_prime(uint32_t n)
+{
+  for (;; ++n) {
+    bool prime = n > 1;
+    for (uint32_t d = 2; prime && d * d <= n; ++d) {
+      prime = n % d != 0;
+    }
+    if (prime) {
+      return n;
+    }
+  }
+}
+} // namespace
+
+ATSMaglevHash::ATSMaglevHash(ATSHash64 *h) : hash(h) {}
+
+void
+ATSMaglevHash::insert(ATSConsistentHashNode *node, float weight, ATSHash64 *h)
+{
+  ATSHash64 *thash;
+
+  if (h) {
+    thash = h;
+  } else if (hash) {
+    thash = hash;
+  } else {
+    return;
+  }
+
+  // as the ring does not give a node of no weight any replica
+  if (!(weight > 0)) {
+    return;
+  }
+
+  thash->update(node->name, strlen(node->name));
+  thash->final();
+  members.push_back({node, weight, thash->get()});
+  thash->clear();
+}
+
+void
+ATSMaglevHash::build()
+{
+  table.clear();
+  if (members.empty()) {
+    return;
+  }
+
+  // the size only grows in steps, a node added or taken out only moves the keys it takes or gives
+  uint32_t m = 1;
+  while (m < SLOTS_PER_NODE * members.size()) {
+    m <<= 1;
+  }
+  m                = next_prime(m);
+  float max_weight = 0;
+  for (const Member &member : members) {
+    max_weight = std::max(max_weight, member.weight);
+  }
+
+  // each member's permutation is offset + j * skip, the skip is never 0 and co-prime with the prime size
+  std::vector<uint32_t> offset(members.size());
+  std::vector<uint32_t> skip(members.size());
+  std::vector<uint32_t> next(members.size(), 0);
+  std::vector<double> credit(members.size(), 0);
+  for (size_t i = 0; i < members.size(); i++) {
+    offset[i] = (members[i].hashval >> 32) % m;
+    skip[i]   = (members[i].hashval & 0xffffffff) % (m - 1) + 1;
+  }
+
+  // a member takes a turn each time it has saved a whole one, at the rate of its share of the heaviest weight
+  table.assign(m, EMPTY);
+  for (uint32_t filled = 0; filled < m;) {
+    for (size_t i = 0; i < members.size() && filled < m; i++) {
+      credit[i] += members[i].weight / max_weight;
+      if (credit[i] < 1) {
+        continue;
+      }
+      credit[i] -= 1;
+      uint32_t slot;
+      do {
+        slot = (offset[i] + static_cast<uint64_t>(next[i]) * skip[i]) % m;
+        next[i]++;
+      } while (table[slot] != EMPTY);
+      table[slot] = i;
+      filled++;
+    }
+  }
+}
+
+ATSConsistentHashNode *
+ATSMaglevHash::lookup_by_hashval(uint64_t hashval, uint32_t *pos) const
+{
+  if (table.empty()) {
+    return nullptr;
+  }
+  *pos = hashval % table.size();
+  return members[table[*pos]].node;
+}
+
+ATSConsistentHashNode *
+ATSMaglevHash::lookup_next(uint32_t *pos, bool *w) const
+{
+  bool wrapped = false;
+  bool *wptr   = w ? w : &wrapped;
+
+  if (table.empty()) {
+    return nullptr;
+  }
+
+  // walking past the end starts again from the first slot, once
+  if (++(*pos) >= table.size()) {
+    if (*wptr) {
+      return nullptr;
+    }
+    *wptr = true;
+    *pos  = 0;
+  }
+  return members[table[*pos]].node;
+}
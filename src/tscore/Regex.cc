@@ -22,6 +22,10 @@
  */
 
 #include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 #include "tscore/ink_platform.h"
 #include "tscore/ink_thread.h"
@@ -56,6 +60,14 @@ Regex::Regex(Regex &&that) noexcept : regex(that.regex), regex_extra(that.regex_
   that.regex_extra = nullptr;
 }
 
+Regex &
+Regex::operator=(Regex &&that) noexcept
+{
+  std::swap(regex, that.regex);
+  std::swap(regex_extra, that.regex_extra);
+  return *this;
+}
+
 bool
 Regex::compile(const char *pattern, const unsigned flags)
 {
@@ -124,6 +136,27 @@ Regex::exec(std::string_view const &str, int *ovector, int ovecsize)
   return rv > 0;
 }
 
+int
+Regex::exec_mark(std::string_view const &str, const char *&mark) const
+{
+  // The study data is shared by the threads, the mark is asked for through a copy of it.
+  pcre_extra extra;
+  unsigned char *name = nullptr;
+  std::array<int, 3> ovector;
+
+  if (regex_extra) {
+    extra = *regex_extra;
+  } else {
+    memset(&extra, 0, sizeof(extra));
+  }
+  extra.flags |= PCRE_EXTRA_MARK;
+  extra.mark = &name;
+
+  int rv = pcre_exec(regex, &extra, str.data(), int(str.size()), 0, 0, ovector.data(), ovector.size());
+  mark   = reinterpret_cast<const char *>(name);
+  return rv;
+}
+
 Regex::~Regex()
 {
   if (regex_extra) {
@@ -140,6 +173,67 @@ Regex::~Regex()
 
 DFA::~DFA() {}
 
+// Whether @a pattern means the same as an alternative of the combined pattern: it must not refer to
+// groups by number nor to the whole pattern, and must not have verbs, which would act on all of the
+// alternatives. This errs on the side of not combining.
+static bool
+combinable(std::string_view const &pattern)
+{
+  for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+    char c    = pattern[i];
+    char next = pattern[i + 1];
+
+    if (c == '\\') {
+      if (next == 'g') { // \g1, \g{-1}, \g<name>
+        return false;
+      }
+      ++i; // the escaped character
+    } else if (c == '(' && next == '*') {
+      return false;
+    } else if (c == '(' && next == '?' && i + 2 < pattern.size()) {
+      char kind  = pattern[i + 2];
+      char after = i + 3 < pattern.size() ? pattern[i + 3] : '\0';
+      if (isdigit(static_cast<unsigned char>(kind)) || kind == 'R' || kind == '&' || kind == '+' ||
+          (kind == '-' && isdigit(static_cast<unsigned char>(after))) || (kind == 'P' && after == '>')) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void
+DFA::combine(unsigned flags)
+{
+  std::string alternation;
+  int captures = 0;
+
+  _combined = Regex();
+  // Unanchored, a later pattern matching earlier in the string would win over the first pattern.
+  if (_patterns.size() < 2 || (flags & RE_UNANCHORED)) {
+    return;
+  }
+
+  for (size_t i = 0; i < _patterns.size(); ++i) {
+    Pattern &p   = _patterns[i];
+    int backrefs = 0;
+
+    if (!combinable(p._p) || pcre_fullinfo(p._re.regex, p._re.regex_extra, PCRE_INFO_BACKREFMAX, &backrefs) != 0 ||
+        backrefs != 0) {
+      return;
+    }
+    captures += p._re.get_capture_count();
+    // The \E closes a \Q quote left open by the pattern, it is ignored otherwise.
+    alternation.append(i ? "|(?:" : "(?:").append(p._p).append("\\E)(*MARK:").append(std::to_string(i)).append(")");
+  }
+
+  Regex rxp;
+  // The same number of groups is one more check that no pattern leaked into the others.
+  if (rxp.compile(alternation.c_str(), flags | RE_ANCHORED) && rxp.get_capture_count() == captures) {
+    _combined = std::move(rxp);
+  }
+}
+
 bool
 DFA::build(std::string_view const &pattern, unsigned flags)
 {
@@ -172,6 +266,7 @@ DFA::compile(std::string_view *patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->combine(flags);
   return _patterns.size();
 }
 
@@ -182,6 +277,7 @@ DFA::compile(const char **patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->combine(flags);
   return _patterns.size();
 }
 
@@ -190,6 +286,18 @@ DFA::match(std::string_view const &str) const
 {
   // This is ugly, but the external interface needs to be @c const even though it's not really.
   // This handles making the iterator non-const.
+  if (_combined.regex) {
+    const char *mark = nullptr;
+    int rv           = _combined.exec_mark(str, mark);
+
+    if (rv == PCRE_ERROR_NOMATCH) {
+      return -1;
+    } else if (rv >= 0 && mark) {
+      return atoi(mark);
+    }
+    // Out of a limit on the whole alternation, the patterns may still be matched one at a time.
+  }
+
   auto &pv{const_cast<decltype(_patterns) &>(_patterns)};
   for (auto spot = pv.begin(), limit = pv.end(); spot != limit; ++spot) {
     if (spot->_re.exec(str)) {
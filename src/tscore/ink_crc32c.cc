@@ -0,0 +1,145 @@
+/** @file
+
+  CRC32C (Castagnoli) checksums
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace
+{
+constexpr uint32_t POLY = 0x82F63B78; // reflected Castagnoli polynomial
+
+// Slicing by 8: tables[k][b] is the CRC of byte b followed by k zero bytes.
+struct Tables {
+  uint32_t t[8][256];
+};
+
+constexpr Tables
+make_tables()
+{
+  Tables tables{};
+  for (uint32_t b = 0; b < 256; b++) {
+    uint32_t crc = b;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (crc & 1 ? POLY : 0);
+    }
+    tables.t[0][b] = crc;
+  }
+  for (uint32_t b = 0; b < 256; b++) {
+    for (int k = 1; k < 8; k++) {
+      tables.t[k][b] = (tables.t[k - 1][b] >> 8) ^ tables.t[0][tables.t[k - 1][b] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables TABLES = make_tables();
+
+uint32_t
+crc32c_sw(uint32_t crc, const uint8_t *p, size_t len)
+{
+  auto const &t = TABLES.t;
+  for (; len >= 8; p += 8, len -= 8) {
+    uint32_t lo, hi;
+    memcpy(&lo, p, 4);
+    memcpy(&hi, p + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    lo = __builtin_bswap32(lo);
+    hi = __builtin_bswap32(hi);
+#endif
+    lo ^= crc;
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^
+          t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; len; p++, len--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t
+crc32c_hw(uint32_t crc, const uint8_t *p, size_t len)
+{
+  uint64_t crc64 = crc;
+  for (; len >= 8; p += 8, len -= 8) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    crc64 = _mm_crc32_u64(crc64, v);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; len; p++, len--) {
+    crc = _mm_crc32_u8(crc, *p);
+  }
+  return crc;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+uint32_t
+crc32c_hw(uint32_t crc, const uint8_t *p, size_t len)
+{
+  for (; len >= 8; p += 8, len -= 8) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    crc = __crc32cd(crc, v);
+  }
+  for (; len; p++, len--) {
+    crc = __crc32cb(crc, *p);
+  }
+  return crc;
+}
+#endif
+
+using Impl = uint32_t (*)(uint32_t crc, const uint8_t *p, size_t len);
+
+Impl
+select_impl()
+{
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("sse4.2")) {
+    return &crc32c_hw;
+  }
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  return &crc32c_hw;
+#endif
+  return &crc32c_sw;
+}
+} // namespace
+
+uint32_t
+ink_crc32c(const void *data, size_t len, uint32_t crc)
+{
+  static const Impl impl = select_impl();
+  return ~impl(~crc, static_cast<const uint8_t *>(data), len);
+}
+
+uint32_t
+ink_crc32c_sw(const void *data, size_t len, uint32_t crc)
+{
+  return ~crc32c_sw(~crc, static_cast<const uint8_t *>(data), len);
+}
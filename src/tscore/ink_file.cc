@@ -23,6 +23,7 @@
 
 #include <unistd.h>
 #include <climits>
+#include <algorithm>
 #include "tscore/ink_platform.h"
 #include "tscore/ink_file.h"
 #include "tscore/ink_string.h"
@@ -511,6 +512,70 @@ ink_file_get_geometry(int fd ATS_UNUSED, ink_device_geometry &geometry)
   return true;
 }
 
+#if defined(linux)
+// Read a number from the queue attributes of the device @a dev. A partition has no queue of its own,
+// it takes the one of the disk it is on.
+static bool
+ink_device_queue_attribute(dev_t dev, const char *name, unsigned &value)
+{
+  char path[PATH_NAME_MAX];
+
+  for (const char *fmt : {"/sys/dev/block/%u:%u/queue/%s", "/sys/dev/block/%u:%u/../queue/%s"}) {
+    snprintf(path, sizeof(path), fmt, major(dev), minor(dev), name);
+    if (FILE *f = fopen(path, "r"); f != nullptr) {
+      bool found = fscanf(f, "%u", &value) == 1;
+      fclose(f);
+      return found;
+    }
+  }
+  return false;
+}
+#endif
+
+bool
+ink_file_get_device_queue(int fd ATS_UNUSED, ink_device_queue &queue)
+{
+  queue.rotational = true;
+  queue.depth      = 0;
+
+#if defined(linux)
+  struct stat sbuf;
+  unsigned rotational;
+
+  if (fstat(fd, &sbuf) != 0) {
+    return false;
+  }
+
+  dev_t dev = S_ISBLK(sbuf.st_mode) ? sbuf.st_rdev : sbuf.st_dev;
+  if (!ink_device_queue_attribute(dev, "rotational", rotational)) {
+    return false;
+  }
+  queue.rotational = rotational != 0;
+  ink_device_queue_attribute(dev, "nr_requests", queue.depth);
+  return true;
+#else
+  errno = ENOTSUP;
+  return false;
+#endif
+}
+
+int
+ink_device_stripe_count(const ink_device_queue &queue, uint64_t size, uint64_t min_stripe_size, int processors)
+{
+  if (queue.rotational) {
+    return 1;
+  }
+
+  uint64_t count = processors > 1 ? processors : 1;
+  if (queue.depth) {
+    count = std::min<uint64_t>(count, std::max(queue.depth / 8, 1U));
+  }
+  if (min_stripe_size) {
+    count = std::min<uint64_t>(count, std::max<uint64_t>(size / min_stripe_size, 1));
+  }
+  return static_cast<int>(count);
+}
+
 size_t
 ink_file_namemax(const char *path)
 {
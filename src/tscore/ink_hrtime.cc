@@ -41,6 +41,9 @@
 #endif
 #include <cstring>
 #include <sys/time.h>
+#if INK_HRTIME_TSC_SUPPORTED
+#include <cpuid.h>
+#endif
 
 char *
 int64_to_str(char *buf, unsigned int buf_size, int64_t val, unsigned int *total_chars, unsigned int req_width, char pad_char)
@@ -233,3 +236,131 @@ init_hrtime_basis()
   return b;
 }
 #endif
+
+#if INK_HRTIME_TSC_SUPPORTED
+InkHrtimeTscAnchor ink_hrtime_tsc_anchor;
+std::atomic<bool> ink_hrtime_tsc_enabled{false};
+
+namespace
+{
+constexpr ink_hrtime TSC_ANCHOR_PERIOD = HRTIME_SECOND;
+constexpr ink_hrtime TSC_CALIBRATION   = HRTIME_MSECONDS(50);
+// More than this between the counter reads around clock_gettime, the thread was interrupted.
+constexpr uint64_t TSC_ANCHOR_MAX_TICKS = 20000;
+
+uint64_t calibrated_mult = 0;
+
+ink_hrtime
+realtime()
+{
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ink_hrtime_from_timespec(&ts);
+}
+
+// A counter value and the time it was read at, as close together as they can be read.
+bool
+read_anchor(uint64_t &tsc, ink_hrtime &time)
+{
+  for (int i = 0; i < 4; ++i) {
+    uint64_t before = __builtin_ia32_rdtsc();
+    time            = realtime();
+    uint64_t after  = __builtin_ia32_rdtsc();
+    if (after - before < TSC_ANCHOR_MAX_TICKS) {
+      tsc = before + (after - before) / 2;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t
+tsc_mult(ink_hrtime elapsed, uint64_t ticks)
+{
+  return (static_cast<unsigned __int128>(elapsed) << 32) / ticks;
+}
+
+void
+publish_anchor(uint64_t tsc, ink_hrtime time, uint64_t mult)
+{
+  InkHrtimeTscAnchor &anchor = ink_hrtime_tsc_anchor;
+  uint64_t sequence          = anchor.sequence.load(std::memory_order_relaxed);
+
+  anchor.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  anchor.tsc.store(tsc, std::memory_order_relaxed);
+  anchor.time.store(time, std::memory_order_relaxed);
+  anchor.mult.store(mult, std::memory_order_relaxed);
+  anchor.sequence.store(sequence + 2, std::memory_order_release);
+}
+} // namespace
+
+bool
+ink_hrtime_tsc_init()
+{
+  unsigned eax, ebx, ecx, edx;
+  uint64_t tsc_start, tsc_end;
+  ink_hrtime time_start, time_end;
+
+  // CPUID 0x80000007, EDX bit 8: the invariant TSC.
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+    return false;
+  }
+  if (!read_anchor(tsc_start, time_start)) {
+    return false;
+  }
+  ink_hrtime_sleep(TSC_CALIBRATION);
+  if (!read_anchor(tsc_end, time_end) || time_end <= time_start || tsc_end <= tsc_start) {
+    return false;
+  }
+
+  calibrated_mult              = tsc_mult(time_end - time_start, tsc_end - tsc_start);
+  ink_hrtime_tsc_anchor.period = (static_cast<unsigned __int128>(TSC_ANCHOR_PERIOD) << 32) / calibrated_mult;
+  publish_anchor(tsc_end, time_end, calibrated_mult);
+  ink_hrtime_tsc_enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+ink_hrtime
+ink_hrtime_tsc_reanchor()
+{
+  InkHrtimeTscAnchor &anchor = ink_hrtime_tsc_anchor;
+  uint64_t tsc;
+  ink_hrtime time;
+
+  // Also here when the anchor was read while it was being taken, or when the counter of this core is
+  // a few ticks behind the one the anchor was taken on: the time then comes from clock_gettime.
+  if (anchor.updating.exchange(true, std::memory_order_acquire)) {
+    return realtime();
+  }
+  if (!read_anchor(tsc, time)) {
+    anchor.updating.store(false, std::memory_order_release);
+    return realtime();
+  }
+
+  uint64_t previous_tsc       = anchor.tsc.load(std::memory_order_relaxed);
+  ink_hrtime previous_time    = anchor.time.load(std::memory_order_relaxed);
+  uint64_t mult               = anchor.mult.load(std::memory_order_relaxed);
+  uint64_t const since_anchor = tsc - previous_tsc;
+
+  if (tsc > previous_tsc && since_anchor >= anchor.period) {
+    if (time > previous_time) {
+      // Off by more than a percent of the calibrated rate, the system clock was set rather than
+      // adjusted, and the rate stays as it was.
+      uint64_t measured = tsc_mult(time - previous_time, since_anchor);
+      if (measured > calibrated_mult - calibrated_mult / 100 && measured < calibrated_mult + calibrated_mult / 100) {
+        mult = measured;
+      }
+    }
+    publish_anchor(tsc, time, mult);
+  }
+  anchor.updating.store(false, std::memory_order_release);
+  return time;
+}
+#else
+bool
+ink_hrtime_tsc_init()
+{
+  return false;
+}
+#endif
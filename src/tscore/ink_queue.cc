@@ -37,6 +37,7 @@
   ****************************************************************************/
 
 #include "tscore/ink_config.h"
+#include <atomic>
 #include <cassert>
 #include <memory.h>
 #include <cstdlib>
@@ -52,6 +53,7 @@
 #include "tscore/hugepages.h"
 #include "tscore/Diags.h"
 #include "tscore/JeAllocator.h"
+#include "tscore/ink_mutex.h"
 
 #define DEBUG_TAG "freelist"
 
@@ -91,9 +93,16 @@ static const ink_freelist_ops malloc_ops   = {malloc_new, malloc_free, malloc_bu
 static const ink_freelist_ops freelist_ops = {freelist_new, freelist_free, freelist_bulkfree};
 static const ink_freelist_ops *default_ops = &freelist_ops;
 
+thread_local int ink_thread_numa_node = -1;
+
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
 
+static void magazine_init(InkFreeList *f);
+static void *magazine_new(InkFreeList *f);
+static bool magazine_free(InkFreeList *f, void *item);
+static uint64_t magazine_cached(const InkFreeList *f, uint64_t *hits, uint64_t *misses);
+
 const InkFreeListOps *
 ink_freelist_malloc_ops()
 {
@@ -152,6 +161,7 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
   }
   Debug(DEBUG_TAG "_init", "<%s> Chunk Size request/actual (%" PRIu32 "/%" PRIu32 ")", name, chunk_size, f->chunk_size);
   SET_FREELIST_POINTER_VERSION(f->head, FROM_PTR(0), 0);
+  magazine_init(f);
 
   *fl = f;
 }
@@ -164,6 +174,17 @@ ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type_size
   (*fl)->advice = advice;
 }
 
+InkFreeList *
+ink_freelist_clone(const InkFreeList *f, const char *name)
+{
+  InkFreeList *c;
+
+  ink_freelist_init(&c, name, f->type_size, f->chunk_size, f->alignment);
+  c->advice = f->advice;
+  c->arena  = f->arena;
+  return c;
+}
+
 InkFreeList *
 ink_freelist_create(const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment)
 {
@@ -184,6 +205,9 @@ ink_freelist_new(InkFreeList *f)
 {
   void *ptr;
 
+  if (likely(ptr = magazine_new(f))) {
+    return ptr;
+  }
   if (likely(ptr = freelist_global_ops->fl_new(f))) {
     ink_atomic_increment(reinterpret_cast<int *>(&f->used), 1);
   }
@@ -206,7 +230,10 @@ freelist_new(InkFreeList *f)
       size_t alloc_size = f->chunk_size * f->type_size;
       size_t alignment  = 0;
 
-      if (ats_hugepage_enabled()) {
+      if (f->arena) {
+        alignment = ats_pagesize();
+        newp      = f->arena->allocate(INK_ALIGN(alloc_size, alignment), alignment);
+      } else if (ats_hugepage_enabled()) {
         alignment = ats_hugepage_size();
         newp      = ats_alloc_hugepage(alloc_size);
       }
@@ -264,7 +291,9 @@ malloc_new(InkFreeList *f)
 {
   void *newp = nullptr;
 
-  if (f->alignment) {
+  if (f->arena) {
+    newp = f->arena->allocate(f->type_size, f->alignment);
+  } else if (f->alignment) {
     newp = jna.allocate(f);
   } else {
     newp = ats_malloc(f->type_size);
@@ -278,6 +307,9 @@ ink_freelist_free(InkFreeList *f, void *item)
 {
   if (likely(item != nullptr)) {
     ink_assert(f->used != 0);
+    if (likely(magazine_free(f, item))) {
+      return;
+    }
     freelist_global_ops->fl_free(f, item);
     ink_atomic_decrement(reinterpret_cast<int *>(&f->used), 1);
   }
@@ -327,7 +359,9 @@ freelist_free(InkFreeList *f, void *item)
 static void
 malloc_free(InkFreeList *f, void *item)
 {
-  if (f->alignment) {
+  if (f->arena) {
+    f->arena->deallocate(item);
+  } else if (f->alignment) {
     jna.deallocate(f, item);
   } else {
     ats_free(item);
@@ -398,7 +432,12 @@ malloc_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   // Avoid compiler warnings
   (void)tail;
 
-  if (f->alignment) {
+  if (f->arena) {
+    for (size_t i = 0; i < num_item && item; ++i, item = next) {
+      next = *static_cast<void **>(item); // find next item before freeing current item
+      f->arena->deallocate(item);
+    }
+  } else if (f->alignment) {
     for (size_t i = 0; i < num_item && item; ++i, item = next) {
       next = *static_cast<void **>(item); // find next item before freeing current item
       jna.deallocate(f, item);
@@ -411,6 +450,274 @@ malloc_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   }
 }
 
+/*
+ * Thread magazines
+ *
+ * A magazine is a stack of free items linked through their first word, and
+ * only touched by its thread. The freelist counts the items of the magazines
+ * as used, the in-use count of the dumps is that minus the items cached in the
+ * magazines. A full magazine in the depot is linked to the next one through
+ * the second word of its first item, and is back on the books of the freelist:
+ * the depot is a list of lists, exchanged whole with the threads.
+ */
+
+namespace
+{
+struct Magazine {
+  void *head     = nullptr;
+  uint32_t count = 0;
+};
+
+struct MagazineSlot {
+  Magazine loaded;   ///< Allocated from and freed to.
+  Magazine previous; ///< Swapped with loaded when it is empty or full.
+  // Only written by the thread, read by the dumps.
+  std::atomic<uint64_t> hits{0}, misses{0};
+  std::atomic<uint32_t> cached{0};
+};
+
+struct MagazineTable {
+  MagazineSlot slots[INK_FREELIST_MAX_MAGAZINE_LISTS];
+  MagazineTable *next = nullptr;
+};
+
+/// Flush the magazines of the thread to the freelists when it exits.
+struct MagazineTableOwner {
+  MagazineTable *table = nullptr;
+  ~MagazineTableOwner();
+};
+
+inline void
+bump(std::atomic<uint64_t> &counter)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void
+add(std::atomic<uint32_t> &counter, int32_t n)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+} // namespace
+
+static std::atomic<uint32_t> magazine_lists{0};
+static InkFreeList *magazine_freelists[INK_FREELIST_MAX_MAGAZINE_LISTS];
+static ink_mutex magazine_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
+static MagazineTable *magazine_tables  = nullptr;
+
+static thread_local MagazineTable *magazine_table = nullptr;
+static thread_local bool magazine_table_retired   = false;
+
+static void
+magazine_init(InkFreeList *f)
+{
+  uint32_t size = std::min(INK_FREELIST_MAGAZINE_ITEMS, INK_FREELIST_MAGAZINE_BYTES / f->type_size);
+
+  SET_FREELIST_POINTER_VERSION(f->depot, FROM_PTR(0), 0);
+  f->index = magazine_lists.fetch_add(1, std::memory_order_relaxed);
+  // Small magazines would go to the depot about as often as items go to the freelist.
+  if (size < 4 || f->type_size < 2 * sizeof(void *) || f->index >= INK_FREELIST_MAX_MAGAZINE_LISTS) {
+    f->magazine_size = 0;
+    return;
+  }
+  f->magazine_size              = size;
+  magazine_freelists[f->index] = f;
+}
+
+static void
+depot_push(InkFreeList *f, void *magazine)
+{
+  void **adr_of_next = ADDRESS_OF_NEXT(magazine, sizeof(void *));
+  head_p head;
+  head_p item_pair;
+  int result = 0;
+
+  do {
+    INK_QUEUE_LD(head, f->depot);
+    *adr_of_next = FREELIST_POINTER(head);
+    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(magazine), FREELIST_VERSION(head));
+    INK_MEMORY_BARRIER;
+    result = ink_atomic_cas(&f->depot.data, head.data, item_pair.data);
+  } while (result == 0);
+}
+
+static void *
+depot_pop(InkFreeList *f)
+{
+  head_p item;
+  head_p next;
+  int result = 0;
+
+  do {
+    INK_QUEUE_LD(item, f->depot);
+    if (TO_PTR(FREELIST_POINTER(item)) == nullptr) {
+      return nullptr;
+    }
+    SET_FREELIST_POINTER_VERSION(next, *ADDRESS_OF_NEXT(TO_PTR(FREELIST_POINTER(item)), sizeof(void *)),
+                                 FREELIST_VERSION(item) + 1);
+    result = ink_atomic_cas(&f->depot.data, item.data, next.data);
+  } while (result == 0);
+
+  return TO_PTR(FREELIST_POINTER(item));
+}
+
+static MagazineSlot *
+magazine_slot(InkFreeList *f)
+{
+  // Not with malloc, the items are not ours to keep then.
+  if (f->magazine_size == 0 || freelist_global_ops != &freelist_ops) {
+    return nullptr;
+  }
+  if (unlikely(magazine_table == nullptr)) {
+    static thread_local MagazineTableOwner owner;
+
+    // Or thread local destructors freeing items after the flush would leak them.
+    if (magazine_table_retired) {
+      return nullptr;
+    }
+    magazine_table = new MagazineTable;
+    owner.table    = magazine_table;
+    ink_mutex_acquire(&magazine_tables_mutex);
+    magazine_table->next = magazine_tables;
+    magazine_tables      = magazine_table;
+    ink_mutex_release(&magazine_tables_mutex);
+  }
+  return &magazine_table->slots[f->index];
+}
+
+static void
+magazine_flush(InkFreeList *f, Magazine &m)
+{
+  if (m.count) {
+    void *tail = m.head;
+    while (*ADDRESS_OF_NEXT(tail, 0)) {
+      tail = *ADDRESS_OF_NEXT(tail, 0);
+    }
+    freelist_bulkfree(f, m.head, tail, m.count);
+    ink_atomic_decrement(reinterpret_cast<int *>(&f->used), m.count);
+    m = Magazine();
+  }
+}
+
+MagazineTableOwner::~MagazineTableOwner()
+{
+  if (table == nullptr) {
+    return;
+  }
+
+  ink_mutex_acquire(&magazine_tables_mutex);
+  for (MagazineTable **t = &magazine_tables; *t; t = &(*t)->next) {
+    if (*t == table) {
+      *t = table->next;
+      break;
+    }
+  }
+  uint32_t lists = std::min(magazine_lists.load(std::memory_order_relaxed), INK_FREELIST_MAX_MAGAZINE_LISTS);
+  for (uint32_t i = 0; i < lists; ++i) {
+    InkFreeList *f  = magazine_freelists[i];
+    MagazineSlot &s = table->slots[i];
+    if (f) {
+      magazine_flush(f, s.loaded);
+      magazine_flush(f, s.previous);
+      f->retired_hits += s.hits.load(std::memory_order_relaxed);
+      f->retired_misses += s.misses.load(std::memory_order_relaxed);
+    }
+  }
+  ink_mutex_release(&magazine_tables_mutex);
+
+  delete table;
+  magazine_table         = nullptr;
+  magazine_table_retired = true;
+}
+
+static void *
+magazine_new(InkFreeList *f)
+{
+  MagazineSlot *s = magazine_slot(f);
+  void *item;
+
+  if (s == nullptr) {
+    return nullptr;
+  }
+  if (likely(s->loaded.count)) {
+    bump(s->hits);
+  } else if (s->previous.count) {
+    std::swap(s->loaded, s->previous);
+    bump(s->hits);
+  } else if ((item = depot_pop(f)) != nullptr) {
+    // A miss too, the depot is shared.
+    s->loaded.head  = item;
+    s->loaded.count = f->magazine_size;
+    add(s->cached, f->magazine_size);
+    ink_atomic_increment(reinterpret_cast<int *>(&f->used), f->magazine_size);
+    bump(s->misses);
+  } else {
+    // Let the caller get one from the freelist.
+    bump(s->misses);
+    return nullptr;
+  }
+
+  item           = s->loaded.head;
+  s->loaded.head = *ADDRESS_OF_NEXT(item, 0);
+  --s->loaded.count;
+  add(s->cached, -1);
+  return item;
+}
+
+static bool
+magazine_free(InkFreeList *f, void *item)
+{
+  MagazineSlot *s = magazine_slot(f);
+
+  if (s == nullptr) {
+    return false;
+  }
+#ifdef SANITY
+  if (s->loaded.head == item || s->previous.head == item) {
+    ink_abort("ink_freelist_free: trying to free item twice");
+  }
+#endif /* SANITY */
+  if (unlikely(s->loaded.count == f->magazine_size)) {
+    if (s->previous.count) {
+      depot_push(f, s->previous.head);
+      add(s->cached, -static_cast<int32_t>(f->magazine_size));
+      ink_atomic_decrement(reinterpret_cast<int *>(&f->used), f->magazine_size);
+      s->previous = s->loaded;
+      s->loaded   = Magazine();
+    } else {
+      std::swap(s->loaded, s->previous);
+    }
+  }
+
+  *ADDRESS_OF_NEXT(item, 0) = s->loaded.head;
+  s->loaded.head            = item;
+  ++s->loaded.count;
+  add(s->cached, 1);
+  return true;
+}
+
+/// The items of @a f in the magazines of the threads, and the hits and misses of the magazines.
+static uint64_t
+magazine_cached(const InkFreeList *f, uint64_t *hits, uint64_t *misses)
+{
+  uint64_t cached = 0;
+
+  *hits   = f->retired_hits;
+  *misses = f->retired_misses;
+  if (f->magazine_size == 0) {
+    return 0;
+  }
+  ink_mutex_acquire(&magazine_tables_mutex);
+  for (MagazineTable *t = magazine_tables; t; t = t->next) {
+    const MagazineSlot &s = t->slots[f->index];
+    cached += s.cached.load(std::memory_order_relaxed);
+    *hits += s.hits.load(std::memory_order_relaxed);
+    *misses += s.misses.load(std::memory_order_relaxed);
+  }
+  ink_mutex_release(&magazine_tables_mutex);
+  return cached;
+}
+
 void
 ink_freelists_snap_baseline()
 {
@@ -457,23 +764,30 @@ ink_freelists_dump(FILE *f)
     f = stderr;
   }
 
-  fprintf(f, "     Allocated      |        In-Use      | Type Size  |   Free List Name\n");
-  fprintf(f, "--------------------|--------------------|------------|----------------------------------\n");
+  fprintf(f, "     Allocated      |        In-Use      |       Cached       | Type Size  | Hit Rate |   Free List Name\n");
+  fprintf(f, "--------------------|--------------------|--------------------|------------|----------|------------------------\n");
 
   uint64_t total_allocated = 0;
   uint64_t total_used      = 0;
+  uint64_t total_cached    = 0;
   fll                      = freelists;
   while (fll) {
-    fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %10u | memory/%s\n",
+    uint64_t hits, misses;
+    uint64_t cached = magazine_cached(fll->fl, &hits, &misses);
+    uint64_t used   = fll->fl->used > cached ? fll->fl->used - cached : 0;
+
+    fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %18" PRIu64 " | %10u | %7.2f%% | memory/%s\n",
             static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size),
-            static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size), fll->fl->type_size,
-            fll->fl->name ? fll->fl->name : "<unknown>");
+            used * static_cast<uint64_t>(fll->fl->type_size), cached * static_cast<uint64_t>(fll->fl->type_size),
+            fll->fl->type_size, hits + misses ? 100.0 * hits / (hits + misses) : 0.0, fll->fl->name ? fll->fl->name : "<unknown>");
     total_allocated += static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size);
-    total_used += static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size);
+    total_used += used * static_cast<uint64_t>(fll->fl->type_size);
+    total_cached += cached * static_cast<uint64_t>(fll->fl->type_size);
     fll = fll->next;
   }
-  fprintf(f, " %18" PRIu64 " | %18" PRIu64 " |            | TOTAL\n", total_allocated, total_used);
-  fprintf(f, "-----------------------------------------------------------------------------------------\n");
+  fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %18" PRIu64 " |            |          | TOTAL\n", total_allocated, total_used,
+          total_cached);
+  fprintf(f, "-----------------------------------------------------------------------------------------------------------------\n");
 }
 
 void
@@ -553,6 +867,27 @@ ink_atomiclist_push(InkAtomicList *l, void *item)
   return TO_PTR(h);
 }
 
+void *
+ink_atomiclist_push_chain(InkAtomicList *l, void *head_item, void *tail_item)
+{
+  void **adr_of_next = ADDRESS_OF_NEXT(tail_item, l->offset);
+  head_p head;
+  head_p item_pair;
+  int result = 0;
+  void *h    = nullptr;
+  do {
+    INK_QUEUE_LD(head, l->head);
+    h            = FREELIST_POINTER(head);
+    *adr_of_next = h;
+    ink_assert(head_item != TO_PTR(h));
+    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(head_item), FREELIST_VERSION(head));
+    INK_MEMORY_BARRIER;
+    result = ink_atomic_cas(&l->head.data, head.data, item_pair.data);
+  } while (result == 0);
+
+  return TO_PTR(h);
+}
+
 void *
 ink_atomiclist_remove(InkAtomicList *l, void *item)
 {
@@ -0,0 +1,104 @@
+/** @file
+
+    Unit tests for Histogram
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/Histogram.h"
+#include "catch.hpp"
+
+using H = ts::Histogram<20, 3>;
+
+TEST_CASE("Histogram buckets", "[libts][Histogram]")
+{
+  // Every value lands in a bucket whose bounds contain it, and buckets tile the range.
+  for (int idx = 0; idx < H::N_BUCKETS - 1; ++idx) {
+    REQUIRE(H::lower_bound(idx) <= H::upper_bound(idx));
+    REQUIRE(H::upper_bound(idx) + 1 == H::lower_bound(idx + 1));
+  }
+  for (uint64_t v : {0ul, 1ul, 7ul, 8ul, 9ul, 15ul, 16ul, 17ul, 1000ul, 65535ul, 65536ul, H::MAX}) {
+    int idx = H::index(v);
+    REQUIRE(H::lower_bound(idx) <= v);
+    REQUIRE(v <= H::upper_bound(idx));
+  }
+  REQUIRE(H::index(H::MAX + 1) == H::N_BUCKETS - 1);
+  REQUIRE(H::index(UINT64_MAX) == H::N_BUCKETS - 1);
+
+  // Relative precision is bounded by the sub-bucket count.
+  for (uint64_t v = 8; v < H::MAX; v = v * 3 + 1) {
+    int idx = H::index(v);
+    REQUIRE(H::upper_bound(idx) - H::lower_bound(idx) < v / 8 + 1);
+  }
+}
+
+TEST_CASE("Histogram percentiles", "[libts][Histogram]")
+{
+  H h;
+  REQUIRE(h.count() == 0);
+  REQUIRE(h.percentile(0.5) == 0);
+  REQUIRE(h.max() == 0);
+
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    h.record(v);
+  }
+  REQUIRE(h.count() == 1000);
+
+  auto p50 = h.percentile(0.5);
+  REQUIRE(p50 >= 500);
+  REQUIRE(p50 <= 500 + 500 / 8);
+  auto p99 = h.percentile(0.99);
+  REQUIRE(p99 >= 990);
+  REQUIRE(p99 <= 990 + 990 / 8);
+  REQUIRE(h.percentile(1.0) >= 1000);
+  REQUIRE(h.percentile(1.0) == h.max());
+
+  // One outlier shows up in the tail but not the median.
+  h.record(500000);
+  REQUIRE(h.percentile(0.5) == p50);
+  REQUIRE(h.max() >= 500000);
+  REQUIRE(h.percentile(0.9999) >= 500000);
+
+  // Values past the range are clipped.
+  h.record(UINT64_MAX);
+  REQUIRE(h.max() == H::MAX);
+}
+
+TEST_CASE("Histogram deltas", "[libts][Histogram]")
+{
+  H a, b;
+  for (uint64_t v = 0; v < 100; ++v) {
+    a.record(v);
+  }
+  H snapshot = a;
+  a.record(12345);
+  a.record(7);
+
+  H delta = a;
+  delta -= snapshot;
+  REQUIRE(delta.count() == 2);
+  REQUIRE(delta.max() >= 12345);
+  REQUIRE(delta.percentile(0.5) == H::upper_bound(H::index(7)));
+
+  b += a;
+  b += a;
+  REQUIRE(b.count() == 2 * a.count());
+  b.clear();
+  REQUIRE(b.count() == 0);
+}
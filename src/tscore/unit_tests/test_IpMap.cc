@@ -631,3 +631,72 @@ TEST_CASE("IpMap CloseIntersection", "[libts][ipmap]")
   std::cout << w.print("{::x}", m2).view() << std::endl;
 #endif
 };
+
+TEST_CASE("IpMap Compile", "[libts][ipmap]")
+{
+  IpMap map;
+  void *const markA = reinterpret_cast<void *>(1);
+  void *const markB = reinterpret_cast<void *>(2);
+  void *const markC = reinterpret_cast<void *>(3);
+
+  IpEndpoint a_0, a_0_255, a_1_4, a_1_9, b_0, b_max, c_0, c_1, c_2, c_3, d_0, d_max, x_0, x_1;
+  ats_ip_pton("0.0.0.0", &a_0);
+  ats_ip_pton("10.0.0.255", &a_0_255);
+  ats_ip_pton("10.0.1.4", &a_1_4);
+  ats_ip_pton("10.0.1.9", &a_1_9);
+  ats_ip_pton("192.168.0.0", &b_0);
+  ats_ip_pton("255.255.255.255", &b_max);
+  ats_ip_pton("2001:db8::", &c_0);
+  ats_ip_pton("2001:db8::1", &c_1);
+  ats_ip_pton("2001:db8:0:1::", &c_2);
+  ats_ip_pton("2001:db8:1::", &c_3);
+  ats_ip_pton("ffff::", &d_0);
+  ats_ip_pton("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", &d_max);
+  ats_ip_pton("10.0.1.5", &x_0);
+  ats_ip_pton("2001:db8:0:1::1", &x_1);
+
+  map.mark(&a_0_255, &a_1_4, markA);
+  map.mark(&a_1_9, markB);
+  map.mark(&b_0, &b_max, markC);
+  map.mark(&c_1, &c_2, markA);
+  map.mark(&c_3, markB);
+  map.mark(&d_0, &d_max, markC);
+
+  IpEndpoint const *probes[] = {&a_0, &a_0_255, &a_1_4, &a_1_9, &b_0, &b_max, &c_0, &c_1, &c_2, &c_3, &d_0, &d_max, &x_0, &x_1};
+  std::vector<std::pair<bool, void *>> expected;
+  for (auto probe : probes) {
+    void *mark = nullptr;
+    bool found = map.contains(probe, &mark);
+    expected.emplace_back(found, mark);
+  }
+
+  map.compile();
+  REQUIRE(map.is_compiled());
+  for (size_t i = 0; i < std::size(probes); ++i) {
+    void *mark = nullptr;
+    bool found = map.contains(probes[i], &mark);
+    CHECK(found == expected[i].first);
+    CHECK(mark == expected[i].second);
+  }
+  CHECK_THAT(map, IsMarkedWith(a_1_4, markA));
+  CHECK_THAT(map, IsMarkedWith(b_max, markC));
+  CHECK_THAT(map, IsMarkedWith(c_2, markA));
+  CHECK_THAT(map, IsMarkedWith(d_0, markC));
+  CHECK_THAT(map, !IsMarkedAt(x_0));
+  CHECK_THAT(map, !IsMarkedAt(c_0));
+  CHECK(map.contains(a_1_9.sin.sin_addr.s_addr));
+
+  // Changing the map drops the compiled form.
+  map.unmark(&a_1_9, &a_1_9);
+  CHECK_FALSE(map.is_compiled());
+  CHECK_THAT(map, !IsMarkedAt(a_1_9));
+  map.compile();
+  CHECK_THAT(map, !IsMarkedAt(a_1_9));
+  CHECK_THAT(map, IsMarkedWith(a_0_255, markA));
+
+  // The compiled form moves with the map.
+  IpMap m2{std::move(map)};
+  CHECK(m2.is_compiled());
+  CHECK_FALSE(map.is_compiled());
+  CHECK_THAT(m2, IsMarkedWith(c_3, markB));
+}
@@ -0,0 +1,169 @@
+/** @file
+
+    Unit tests for MaglevHash
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/MaglevHash.h"
+#include "tscore/HashSip.h"
+#include "catch.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Nodes {
+  explicit Nodes(int n)
+  {
+    names.reserve(n);
+    nodes.resize(n);
+    for (int i = 0; i < n; i++) {
+      names.push_back("parent" + std::to_string(i) + ".example.com");
+      nodes[i].available = true;
+      nodes[i].name      = const_cast<char *>(names[i].c_str());
+    }
+  }
+  std::vector<std::string> names;
+  std::vector<ATSConsistentHashNode> nodes;
+};
+
+// the node of each hash value of a sample
+std::vector<ATSConsistentHashNode *>
+sample(const ATSMaglevHash &table, int n)
+{
+  std::vector<ATSConsistentHashNode *> picks;
+  ATSHash64Sip24 hash;
+  for (int i = 0; i < n; i++) {
+    std::string key = "/object/" + std::to_string(i);
+    hash.update(key.data(), key.size());
+    hash.final();
+    uint32_t pos;
+    picks.push_back(table.lookup_by_hashval(hash.get(), &pos));
+    hash.clear();
+  }
+  return picks;
+}
+} // namespace
+
+TEST_CASE("MaglevHash balance", "[libts][MaglevHash]")
+{
+  Nodes n(50);
+  ATSHash64Sip24 hash;
+  ATSMaglevHash table;
+  for (auto &node : n.nodes) {
+    table.insert(&node, 1.0, &hash);
+  }
+  table.build();
+  REQUIRE(table.size() >= 50 * 101);
+
+  std::map<ATSConsistentHashNode *, int> count;
+  for (auto *node : sample(table, 100000)) {
+    REQUIRE(node != nullptr);
+    count[node]++;
+  }
+  REQUIRE(count.size() == n.nodes.size());
+  for (auto &c : count) {
+    CHECK(c.second > 2000 * 0.85);
+    CHECK(c.second < 2000 * 1.15);
+  }
+}
+
+TEST_CASE("MaglevHash weights", "[libts][MaglevHash]")
+{
+  Nodes n(4);
+  ATSHash64Sip24 hash;
+  ATSMaglevHash table;
+  table.insert(&n.nodes[0], 1.0, &hash);
+  table.insert(&n.nodes[1], 2.0, &hash);
+  table.insert(&n.nodes[2], 1.0, &hash);
+  table.insert(&n.nodes[3], 0.0, &hash);
+  table.build();
+
+  std::map<ATSConsistentHashNode *, int> count;
+  for (auto *node : sample(table, 40000)) {
+    count[node]++;
+  }
+  CHECK(count.count(&n.nodes[3]) == 0);
+  CHECK(count[&n.nodes[1]] > 20000 * 0.9);
+  CHECK(count[&n.nodes[1]] < 20000 * 1.1);
+  CHECK(count[&n.nodes[0]] > 10000 * 0.9);
+  CHECK(count[&n.nodes[2]] > 10000 * 0.9);
+}
+
+TEST_CASE("MaglevHash disruption", "[libts][MaglevHash]")
+{
+  Nodes n(20);
+  ATSHash64Sip24 hash;
+  ATSMaglevHash all, less;
+  for (int i = 0; i < 20; i++) {
+    all.insert(&n.nodes[i], 1.0, &hash);
+    if (i != 7) {
+      less.insert(&n.nodes[i], 1.0, &hash);
+    }
+  }
+  all.build();
+  less.build();
+
+  // the keys of the node taken out move, few of the others do
+  auto before = sample(all, 20000);
+  auto after  = sample(less, 20000);
+  int moved   = 0;
+  for (size_t i = 0; i < before.size(); i++) {
+    if (before[i] == &n.nodes[7]) {
+      CHECK(after[i] != &n.nodes[7]);
+    } else if (before[i] != after[i]) {
+      moved++;
+    }
+  }
+  CHECK(moved < 20000 / 20);
+}
+
+TEST_CASE("MaglevHash walk", "[libts][MaglevHash]")
+{
+  Nodes n(3);
+  ATSHash64Sip24 hash;
+  ATSMaglevHash table;
+
+  uint32_t pos = 0;
+  bool wrapped = false;
+  CHECK(table.lookup_by_hashval(42, &pos) == nullptr);
+
+  for (auto &node : n.nodes) {
+    table.insert(&node, 1.0, &hash);
+  }
+  table.build();
+
+  // every node is found walking from any slot, and the walk ends after wrapping around once
+  std::set<ATSConsistentHashNode *> seen;
+  ATSConsistentHashNode *node = table.lookup_by_hashval(table.size() - 2, &pos);
+  CHECK(pos == table.size() - 2);
+  size_t steps = 0;
+  while (node != nullptr) {
+    seen.insert(node);
+    node = table.lookup_next(&pos, &wrapped);
+    steps++;
+  }
+  CHECK(wrapped);
+  CHECK(steps == table.size() + 2);
+  CHECK(seen.size() == 3);
+}
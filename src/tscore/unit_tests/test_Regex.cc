@@ -52,3 +52,29 @@ TEST_CASE("Regex", "[libts][Regex]")
     }
   }
 }
+
+TEST_CASE("DFA", "[libts][DFA]")
+{
+  // The first pattern to match wins, whether the patterns are matched in one pass or one at a time.
+  std::array<const char *, 4> patterns{{"foo", "foobar", "(ba)r", "b.z"}};
+  std::array<const char *, 4> with_backref{{"foo", "foobar", "(ba)r\\1", "b.z"}};
+
+  for (auto *list : {patterns.data(), with_backref.data()}) {
+    DFA dfa;
+    REQUIRE(dfa.compile(list, 4) == 4);
+    REQUIRE(dfa.match("foobar") == 0);
+    REQUIRE(dfa.match("bazfoo") == 3);
+    REQUIRE(dfa.match("xfoo") == -1);
+  }
+
+  DFA dfa;
+  std::array<const char *, 2> quoted{{"\\Qa(b", "c"}};
+  REQUIRE(dfa.compile(quoted.data(), 2) == 2);
+  REQUIRE(dfa.match("a(b") == 0);
+  REQUIRE(dfa.match("c") == 1);
+
+  DFA caseless;
+  std::array<const char *, 2> names{{"accept", "content-type"}};
+  REQUIRE(caseless.compile(names.data(), 2, RE_CASE_INSENSITIVE) == 2);
+  REQUIRE(caseless.match("Content-Type") == 1);
+}
@@ -0,0 +1,188 @@
+/** @file
+
+    Unit tests for TimerWheel
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <vector>
+
+#include "tscore/TimerWheel.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Timer {
+  ink_hrtime at  = 0;
+  int tag        = -1;
+  bool cancelled = false;
+  LINK(Timer, link);
+};
+
+struct TimerTraits {
+  static ink_hrtime
+  at(Timer const *t)
+  {
+    return t->at;
+  }
+  static int
+  tag(Timer const *t)
+  {
+    return t->tag;
+  }
+  static void
+  set_tag(Timer *t, int tag)
+  {
+    t->tag = tag;
+  }
+  static bool
+  expire_early(Timer const *t)
+  {
+    return t->cancelled;
+  }
+};
+
+using Wheel = TimerWheel<Timer, Timer::Link_link, TimerTraits>;
+
+constexpr ink_hrtime TICK = HRTIME_MSECOND;
+
+int
+drain(Wheel &w)
+{
+  int n = 0;
+  while (w.pop_ready()) {
+    ++n;
+  }
+  return n;
+}
+} // namespace
+
+TEST_CASE("TimerWheel expiration", "[libts][TimerWheel]")
+{
+  ink_hrtime start = HRTIME_SECONDS(1000);
+  Wheel w(TICK, start);
+
+  // Spread across every level, including the overflow list.
+  std::vector<ink_hrtime> delays = {HRTIME_MSECONDS(1), HRTIME_MSECONDS(63),  HRTIME_MSECONDS(64), HRTIME_MSECONDS(5000),
+                                    HRTIME_SECONDS(300), HRTIME_HOURS(5),      HRTIME_DAYS(3),     HRTIME_DAYS(20)};
+  std::vector<Timer> timers(delays.size());
+  for (size_t i = 0; i < delays.size(); ++i) {
+    timers[i].at = start + delays[i];
+    w.insert(&timers[i]);
+  }
+  REQUIRE(!w.empty());
+  REQUIRE(w.next_expiry(start, HRTIME_FOREVER) <= start + HRTIME_MSECONDS(1));
+
+  for (size_t i = 0; i < delays.size(); ++i) {
+    w.advance(timers[i].at - TICK);
+    REQUIRE(drain(w) == 0);
+    w.advance(timers[i].at);
+    Timer *t = w.pop_ready();
+    REQUIRE(t == &timers[i]);
+    REQUIRE(w.pop_ready() == nullptr);
+  }
+  REQUIRE(w.empty());
+  REQUIRE(w.next_expiry(start, HRTIME_FOREVER) == HRTIME_FOREVER);
+}
+
+TEST_CASE("TimerWheel remove", "[libts][TimerWheel]")
+{
+  ink_hrtime start = HRTIME_SECONDS(1);
+  Wheel w(TICK, start);
+  Timer a, b, c;
+
+  a.at = start - HRTIME_SECONDS(1); // already due
+  b.at = start + HRTIME_MSECONDS(10);
+  c.at = start + HRTIME_SECONDS(10);
+  w.insert(&a);
+  w.insert(&b);
+  w.insert(&c);
+  REQUIRE(a.tag == Wheel::TAG_READY);
+  REQUIRE(w.next_expiry(start, HRTIME_FOREVER) == start);
+
+  w.remove(&a);
+  w.remove(&b);
+  // Only a cascade is pending, which comes no later than the timer itself.
+  ink_hrtime next = w.next_expiry(start, HRTIME_FOREVER);
+  REQUIRE(next > start);
+  REQUIRE(next <= c.at);
+  w.remove(&c);
+  REQUIRE(w.empty());
+
+  w.advance(start + HRTIME_SECONDS(20));
+  REQUIRE(drain(w) == 0);
+}
+
+TEST_CASE("TimerWheel early expiration and clock steps", "[libts][TimerWheel]")
+{
+  ink_hrtime start = HRTIME_SECONDS(100);
+  Wheel w(TICK, start);
+  Timer a, b;
+
+  a.at = start + HRTIME_SECONDS(3);
+  b.at = start + HRTIME_SECONDS(3);
+  w.insert(&a);
+  w.insert(&b);
+  a.cancelled = true;
+
+  // The cascade of its slot hands back the cancelled timer without waiting for its expiration.
+  w.advance(start + HRTIME_MSECONDS(2990));
+  REQUIRE(w.pop_ready() == &a);
+  REQUIRE(w.pop_ready() == nullptr);
+
+  // Stepping the clock back re-bases the wheel, the remaining timer is still found.
+  w.advance(start - HRTIME_SECONDS(30));
+  REQUIRE(drain(w) == 0);
+  w.advance(b.at);
+  REQUIRE(w.pop_ready() == &b);
+}
+
+TEST_CASE("TimerWheel random", "[libts][TimerWheel]")
+{
+  ink_hrtime now = HRTIME_SECONDS(12345);
+  Wheel w(TICK, now);
+  std::vector<Timer> timers(2000);
+  uint64_t seed = 42;
+  auto next     = [&seed]() { return seed = seed * 6364136223846793005ULL + 1442695040888963407ULL, seed >> 33; };
+
+  for (auto &t : timers) {
+    t.at = now + static_cast<ink_hrtime>(next() % HRTIME_SECONDS(600));
+    w.insert(&t);
+  }
+  // Remove every third one.
+  for (size_t i = 0; i < timers.size(); i += 3) {
+    w.remove(&timers[i]);
+    timers[i].tag = -1;
+  }
+
+  size_t fired = 0;
+  while (!w.empty()) {
+    ink_hrtime prev = now;
+    now += static_cast<ink_hrtime>(next() % HRTIME_MSECONDS(2000));
+    w.advance(now);
+    while (Timer *t = w.pop_ready()) {
+      REQUIRE(t->tag == Wheel::TAG_READY);
+      REQUIRE(t->at / TICK <= now / TICK);
+      REQUIRE(t->at / TICK > prev / TICK); // Not held back past an earlier advance.
+      t->tag = -1;
+      ++fired;
+    }
+  }
+  REQUIRE(fired == timers.size() - (timers.size() + 2) / 3);
+}
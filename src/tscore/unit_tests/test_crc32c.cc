@@ -0,0 +1,72 @@
+/**
+  @file Test for ink_crc32c.cc
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <cstring>
+#include <vector>
+
+#include "tscore/ink_crc32c.h"
+#include "catch.hpp"
+
+TEST_CASE("CRC32C", "[libts][crc32c]")
+{
+  SECTION("check values")
+  {
+    // RFC 3720, B.4
+    std::vector<uint8_t> zeros(32, 0x00), ones(32, 0xFF), incr(32);
+    for (int i = 0; i < 32; i++) {
+      incr[i] = i;
+    }
+    REQUIRE(ink_crc32c("123456789", 9) == 0xE3069283);
+    REQUIRE(ink_crc32c(zeros.data(), zeros.size()) == 0x8A9136AA);
+    REQUIRE(ink_crc32c(ones.data(), ones.size()) == 0x62A8AB43);
+    REQUIRE(ink_crc32c(incr.data(), incr.size()) == 0x46DD794E);
+    REQUIRE(ink_crc32c("", 0) == 0);
+  }
+
+  SECTION("hardware and table driven agree")
+  {
+    std::vector<uint8_t> data(4099);
+    uint32_t x = 12345;
+    for (auto &b : data) {
+      x = x * 1103515245 + 12345;
+      b = x >> 24;
+    }
+    // every length and alignment around the 8 byte steps
+    for (size_t offset = 0; offset < 8; offset++) {
+      for (size_t len = 0; len < 40; len++) {
+        REQUIRE(ink_crc32c(data.data() + offset, len) == ink_crc32c_sw(data.data() + offset, len));
+      }
+    }
+    REQUIRE(ink_crc32c(data.data(), data.size()) == ink_crc32c_sw(data.data(), data.size()));
+  }
+
+  SECTION("continued")
+  {
+    const char *text = "The quick brown fox jumps over the lazy dog";
+    size_t len       = strlen(text);
+    uint32_t whole   = ink_crc32c(text, len);
+    for (size_t split = 0; split <= len; split++) {
+      REQUIRE(ink_crc32c(text + split, len - split, ink_crc32c(text, split)) == whole);
+    }
+    REQUIRE(whole == 0x22620404);
+  }
+}
@@ -0,0 +1,44 @@
+/** @file
+
+    ink_file tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/ink_file.h"
+
+#include <catch.hpp>
+
+TEST_CASE("ink_device_stripe_count", "[libts][ink_file]")
+{
+  constexpr uint64_t GB = uint64_t(1) << 30;
+
+  ink_device_queue disk{true, 64};
+  ink_device_queue nvme{false, 1023};
+  ink_device_queue sata{false, 32};
+  ink_device_queue unknown{false, 0};
+
+  REQUIRE(ink_device_stripe_count(disk, 4096 * GB, 16 * GB, 32) == 1);
+  REQUIRE(ink_device_stripe_count(nvme, 4096 * GB, 16 * GB, 32) == 32);
+  REQUIRE(ink_device_stripe_count(nvme, 4096 * GB, 16 * GB, 0) == 1);
+  REQUIRE(ink_device_stripe_count(nvme, 100 * GB, 16 * GB, 32) == 6);
+  REQUIRE(ink_device_stripe_count(nvme, 8 * GB, 16 * GB, 32) == 1);
+  REQUIRE(ink_device_stripe_count(sata, 4096 * GB, 16 * GB, 32) == 4);
+  REQUIRE(ink_device_stripe_count(unknown, 4096 * GB, 0, 12) == 12);
+}
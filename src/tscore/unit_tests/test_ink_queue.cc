@@ -0,0 +1,143 @@
+/** @file
+
+    Unit tests for the atomic lists of ink_queue.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "tscore/ink_queue.h"
+
+namespace
+{
+struct Item {
+  int pusher = 0;
+  int value  = 0;
+  Item *next = nullptr;
+};
+
+/// Link @a items newest first, the way a chain is pushed, and return the head.
+Item *
+link_chain(Item *items, int n)
+{
+  for (int i = n - 1; i > 0; --i) {
+    items[i].next = &items[i - 1];
+  }
+  items[0].next = nullptr;
+  return &items[n - 1];
+}
+} // namespace
+
+TEST_CASE("ink_atomiclist_push_chain", "[libts][ink_queue]")
+{
+  InkAtomicList l;
+  ink_atomiclist_init(&l, "test_ink_queue", offsetof(Item, next));
+
+  Item items[5];
+  for (int i = 0; i < 5; ++i) {
+    items[i].value = i;
+  }
+
+  SECTION("a chain pops in the order of single pushes from its tail")
+  {
+    REQUIRE(ink_atomiclist_push_chain(&l, link_chain(items, 5), &items[0]) == nullptr);
+    for (int i = 4; i >= 0; --i) {
+      REQUIRE(ink_atomiclist_pop(&l) == &items[i]);
+    }
+    REQUIRE(INK_ATOMICLIST_EMPTY(l));
+  }
+
+  SECTION("a chain goes on top of the items there")
+  {
+    Item first, last;
+    ink_atomiclist_push(&l, &first);
+    REQUIRE(ink_atomiclist_push_chain(&l, link_chain(items, 5), &items[0]) == &first);
+    ink_atomiclist_push(&l, &last);
+
+    Item *e = static_cast<Item *>(ink_atomiclist_popall(&l));
+    REQUIRE(e == &last);
+    e = e->next;
+    for (int i = 4; i >= 0; --i, e = e->next) {
+      REQUIRE(e == &items[i]);
+    }
+    REQUIRE(e == &first);
+    REQUIRE(e->next == nullptr);
+  }
+
+  SECTION("a chain of one is a push")
+  {
+    items[0].next = nullptr;
+    REQUIRE(ink_atomiclist_push_chain(&l, &items[0], &items[0]) == nullptr);
+    REQUIRE(ink_atomiclist_pop(&l) == &items[0]);
+    REQUIRE(INK_ATOMICLIST_EMPTY(l));
+  }
+}
+
+TEST_CASE("ink_atomiclist_push_chain concurrent", "[libts][ink_queue]")
+{
+  constexpr int N_PUSHERS = 4;
+  constexpr int N_CHAINS  = 2000;
+  constexpr int CHAIN_LEN = 3;
+
+  InkAtomicList l;
+  ink_atomiclist_init(&l, "test_ink_queue_concurrent", offsetof(Item, next));
+
+  std::vector<std::vector<Item>> items(N_PUSHERS, std::vector<Item>(N_CHAINS * CHAIN_LEN));
+  std::vector<std::thread> pushers;
+  for (int p = 0; p < N_PUSHERS; ++p) {
+    pushers.emplace_back([&l, &mine = items[p], p]() {
+      for (int c = 0; c < N_CHAINS; ++c) {
+        Item *chain = &mine[c * CHAIN_LEN];
+        for (int i = 0; i < CHAIN_LEN; ++i) {
+          chain[i].pusher = p;
+          chain[i].value  = c * CHAIN_LEN + i;
+        }
+        ink_atomiclist_push_chain(&l, link_chain(chain, CHAIN_LEN), &chain[0]);
+      }
+    });
+  }
+  for (auto &t : pushers) {
+    t.join();
+  }
+
+  // Every item is there once, each chain in one piece and the chains of a pusher newest first.
+  int last_chain[N_PUSHERS];
+  for (int &c : last_chain) {
+    c = N_CHAINS;
+  }
+  int n = 0;
+  for (Item *e = static_cast<Item *>(ink_atomiclist_popall(&l)); e; e = e->next) {
+    int c = e->value / CHAIN_LEN;
+    REQUIRE(e->value % CHAIN_LEN == CHAIN_LEN - 1);
+    REQUIRE(c == last_chain[e->pusher] - 1);
+    last_chain[e->pusher] = c;
+    for (int i = CHAIN_LEN - 2; i >= 0; --i) {
+      e = e->next;
+      REQUIRE(e != nullptr);
+      REQUIRE(e->value == c * CHAIN_LEN + i);
+    }
+    n += CHAIN_LEN;
+  }
+  REQUIRE(n == N_PUSHERS * N_CHAINS * CHAIN_LEN);
+}
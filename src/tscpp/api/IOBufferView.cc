@@ -0,0 +1,108 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+/**
+ * @file IOBufferView.cc
+ */
+
+#include "tscpp/api/IOBufferView.h"
+
+#include <algorithm>
+#include "ts/ts.h"
+
+using namespace atscppapi;
+
+IOBufferReaderView::iterator::iterator(TSIOBufferReader reader, TSIOBufferBlock block, int64_t left)
+  : reader_(reader), block_(block), left_(left)
+{
+  load();
+}
+
+void
+IOBufferReaderView::iterator::load()
+{
+  view_ = std::string_view();
+  while (block_ != nullptr && left_ > 0) {
+    int64_t avail    = 0;
+    const char *data = TSIOBufferBlockReadStart(block_, reader_, &avail);
+    if (avail > 0) {
+      view_ = std::string_view(data, std::min(avail, left_));
+      return;
+    }
+    block_ = TSIOBufferBlockNext(block_);
+  }
+  block_ = nullptr;
+}
+
+IOBufferReaderView::iterator &
+IOBufferReaderView::iterator::operator++()
+{
+  left_ -= view_.size();
+  block_ = TSIOBufferBlockNext(block_);
+  load();
+  return *this;
+}
+
+IOBufferReaderView::IOBufferReaderView(TSIOBufferReader reader, int64_t length)
+  : reader_(reader), length_(std::max<int64_t>(length, 0))
+{
+}
+
+IOBufferReaderView::iterator
+IOBufferReaderView::begin() const
+{
+  return iterator(reader_, TSIOBufferReaderStart(reader_), size());
+}
+
+int64_t
+IOBufferReaderView::size() const
+{
+  return std::min(TSIOBufferReaderAvail(reader_), length_);
+}
+
+int64_t
+atscppapi::moveBlocks(TSIOBuffer out, TSIOBufferReader reader, int64_t length)
+{
+  int64_t moved = TSIOBufferCopy(out, reader, std::min(TSIOBufferReaderAvail(reader), length), 0);
+  TSIOBufferReaderConsume(reader, moved);
+  return moved;
+}
+
+int64_t
+atscppapi::cloneBlocks(TSIOBuffer out, TSIOBufferReader reader, int64_t length, int64_t offset)
+{
+  int64_t avail = TSIOBufferReaderAvail(reader);
+  if (offset >= avail) {
+    return 0;
+  }
+  return TSIOBufferCopy(out, reader, std::min(avail - offset, length), offset);
+}
+
+int64_t
+atscppapi::replaceAt(TSIOBuffer out, TSIOBufferReader reader, int64_t offset, int64_t length, std::string_view with)
+{
+  if (offset < 0 || length < 0 || TSIOBufferReaderAvail(reader) < offset + length) {
+    return -1;
+  }
+
+  int64_t written = moveBlocks(out, reader, offset);
+  if (!with.empty()) {
+    written += TSIOBufferWrite(out, with.data(), with.size());
+  }
+  TSIOBufferReaderConsume(reader, length);
+  return written;
+}
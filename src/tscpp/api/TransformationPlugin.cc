@@ -21,6 +21,7 @@
  */
 
 #include "tscpp/api/TransformationPlugin.h"
+#include "tscpp/api/IOBufferView.h"
 
 #include "ts/ts.h"
 #include <cstddef>
@@ -168,17 +169,13 @@ handleTransformationPluginRead(TSCont contp, TransformationPluginState *state)
         /* Modify the read VIO to reflect how much data we've completed. */
         TSVIONDoneSet(write_vio, TSVIONDoneGet(write_vio) + to_read);
 
-        std::string in_data = utils::internal::consumeFromTSIOBufferReader(input_reader);
-        LOG_DEBUG("Transformation contp=%p write_vio=%p consumed %ld bytes from bufferreader", contp, write_vio, in_data.length());
+        /* Now call the client to tell them about data, the blocks are shared with the read buffer */
+        LOG_DEBUG("Transformation contp=%p write_vio=%p consuming %" PRId64 " bytes from bufferreader", contp, write_vio, to_read);
+        state->transformation_plugin_.consumeBlocks(input_reader);
 
         /* Clean up the buffer and reader */
         TSIOBufferReaderFree(input_reader);
         TSIOBufferDestroy(input_buffer);
-
-        /* Now call the client to tell them about data */
-        if (in_data.length() > 0) {
-          state->transformation_plugin_.consume(in_data);
-        }
       }
 
       /* now that we've finished reading we will check if there is anything left to read. */
@@ -333,15 +330,18 @@ ResumeAfterPauseCont::_run(TSEvent event, void *edata)
   return TS_SUCCESS;
 }
 
-size_t
-TransformationPlugin::doProduce(std::string_view data)
+void
+TransformationPlugin::consumeBlocks(TSIOBufferReader reader)
 {
-  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p producing output with length=%ld", this, state_->txn_, data.length());
-  int64_t write_length = static_cast<int64_t>(data.length());
-  if (!write_length) {
-    return 0;
+  std::string data = utils::internal::consumeFromTSIOBufferReader(reader);
+  if (data.length() > 0) {
+    consume(data);
   }
+}
 
+bool
+TransformationPlugin::startOutput()
+{
   if (!state_->output_vio_) {
     TSVConn output_vconn = TSTransformOutputVConnGet(state_->vconn_);
     LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p will issue a TSVConnWrite, output_vconn=%p.", this, state_->txn_, output_vconn);
@@ -352,15 +352,42 @@ TransformationPlugin::doProduce(std::string_view data)
     } else {
       LOG_ERROR("TransformationPlugin=%p tshttptxn=%p output_vconn=%p cannot issue TSVConnWrite due to null output vconn.", this,
                 state_->txn_, output_vconn);
-      return 0;
+      return false;
     }
 
     if (!state_->output_vio_) {
       LOG_ERROR("TransformationPlugin=%p tshttptxn=%p state_->output_vio=%p, TSVConnWrite failed.", this, state_->txn_,
                 state_->output_vio_);
-      return 0;
+      return false;
     }
   }
+  return true;
+}
+
+void
+TransformationPlugin::reenableOutput()
+{
+  int connection_closed = TSVConnClosedGet(state_->vconn_);
+  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p vconn=%p connection_closed=%d", this, state_->txn_, state_->vconn_,
+            connection_closed);
+
+  if (!connection_closed) {
+    TSVIOReenable(state_->output_vio_); // Wake up the downstream vio
+  } else {
+    LOG_ERROR(
+      "TransformationPlugin=%p tshttptxn=%p output_vio=%p connection_closed=%d : Couldn't reenable output vio (connection closed).",
+      this, state_->txn_, state_->output_vio_, connection_closed);
+  }
+}
+
+size_t
+TransformationPlugin::doProduce(std::string_view data)
+{
+  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p producing output with length=%ld", this, state_->txn_, data.length());
+  int64_t write_length = static_cast<int64_t>(data.length());
+  if (!write_length || !startOutput()) {
+    return 0;
+  }
 
   // Finally we can copy this data into the output_buffer
   int64_t bytes_written = TSIOBufferWrite(state_->output_buffer_, data.data(), write_length);
@@ -374,21 +401,48 @@ TransformationPlugin::doProduce(std::string_view data)
               this, state_->txn_, bytes_written, write_length);
   }
 
-  int connection_closed = TSVConnClosedGet(state_->vconn_);
-  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p vconn=%p connection_closed=%d", this, state_->txn_, state_->vconn_,
-            connection_closed);
+  reenableOutput();
+  return static_cast<size_t>(bytes_written);
+}
 
-  if (!connection_closed) {
-    TSVIOReenable(state_->output_vio_); // Wake up the downstream vio
-  } else {
-    LOG_ERROR(
-      "TransformationPlugin=%p tshttptxn=%p output_vio=%p connection_closed=%d : Couldn't reenable output vio (connection closed).",
-      this, state_->txn_, state_->output_vio_, connection_closed);
+size_t
+TransformationPlugin::doProduce(TSIOBufferReader reader, int64_t length)
+{
+  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p producing blocks with length=%" PRId64, this, state_->txn_, length);
+  if (length <= 0 || !startOutput()) {
+    return 0;
   }
 
+  // The blocks are shared with the output_buffer rather than copied
+  int64_t bytes_written = moveBlocks(state_->output_buffer_, reader, length);
+  state_->bytes_written_ += bytes_written; // So we can set BytesDone on outputComplete().
+  LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p moved to TSIOBuffer %" PRId64 " bytes total bytes written %" PRId64, this,
+            state_->txn_, bytes_written, state_->bytes_written_);
+
+  reenableOutput();
   return static_cast<size_t>(bytes_written);
 }
 
+size_t
+TransformationPlugin::produce(TSIOBufferReader reader, int64_t length)
+{
+  if (state_->type_ == REQUEST_TRANSFORMATION) {
+    size_t copied = 0;
+    for (std::string_view block : IOBufferReaderView(reader, length)) {
+      state_->request_xform_output_.append(block.data(), block.size());
+      copied += block.size();
+    }
+    TSIOBufferReaderConsume(reader, copied);
+    return copied;
+  } else if (state_->type_ == SINK_TRANSFORMATION) {
+    LOG_DEBUG("produce TransformationPlugin=%p tshttptxn=%p : This is a sink transform. Not producing any output", this,
+              state_->txn_);
+    return 0;
+  } else {
+    return doProduce(reader, length);
+  }
+}
+
 size_t
 TransformationPlugin::produce(std::string_view data)
 {
@@ -0,0 +1,74 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+Test.Summary = '''
+Test that traffic_ctl server restart --hot hands off to a new traffic_server that serves right away
+'''
+
+Test.ContinueOnFail = True
+
+server = Test.MakeOriginServer("server")
+ts = Test.MakeATSProcess("ts", command="traffic_manager", select_ports=True)
+
+request_header = {"headers": "GET / HTTP/1.1\r\nHost: www.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""}
+response_header = {"headers": "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n",
+                   "timestamp": "1469733493.993", "body": ""}
+server.addResponse("sessionfile.log", request_header, response_header)
+
+ts.Disk.remap_config.AddLine('map / http://127.0.0.1:{}/'.format(server.Variables.Port))
+ts.Disk.records_config.update({
+    # The new process must not wait for the cache the old one still has open.
+    'proxy.config.http.wait_for_cache': 1,
+    'proxy.config.restart.handoff_timeout': 5,
+    'proxy.config.restart.active_client_threshold': 0,
+})
+
+curl = 'curl -s -o /dev/null -w "%{{http_code}}" -H "Host: www.example.com" http://127.0.0.1:{}/'.format(ts.Variables.port)
+
+tr = Test.AddTestRun("Served before the hand-off")
+tr.Processes.Default.StartBefore(server, ready=When.PortOpen(server.Variables.Port))
+tr.Processes.Default.StartBefore(Test.Processes.ts)
+tr.Processes.Default.Command = curl
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("200", "served by the first traffic_server")
+tr.StillRunningAfter = ts
+
+tr = Test.AddTestRun("Hand off")
+tr.Processes.Default.Command = "traffic_ctl server restart --hot"
+tr.Processes.Default.Env = ts.Env
+tr.Processes.Default.ReturnCode = 0
+tr.StillRunningAfter = ts
+
+# Well within the hand-off timeout, while the old process still holds the cache.
+tr = Test.AddTestRun("Served by the new traffic_server while the old one drains")
+tr.DelayStart = 3
+tr.Processes.Default.Command = curl
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("200", "served after the hand-off")
+tr.StillRunningAfter = ts
+
+tr = Test.AddTestRun("Served once the new traffic_server has the cache")
+tr.DelayStart = 10
+tr.Processes.Default.Command = curl
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("200", "served with the cache")
+tr.StillRunningAfter = ts
+
+ts.Disk.diags_log.Content = Testers.ContainsExpression("handing off to a new traffic_server", "the old process hands off")
+ts.Disk.diags_log.Content += Testers.ContainsExpression("wait_for_cache is ignored", "the new process does not wait for the cache")
+ts.Disk.diags_log.Content += Testers.ContainsExpression("took over the server lock", "the new process opens the cache")
@@ -0,0 +1,79 @@
+'''
+Compare the results of the performance scenarios of two runs, such as those
+of two commits, and fail if one regressed.
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+# The metrics compared, and whether more is better.
+METRICS = [
+    ('rps', lambda r: r['rps'], True),
+    ('cpu/req', lambda r: r['cpu_usec_per_request'], False),
+    ('p50', lambda r: r['latency_ns']['total']['p50'], False),
+    ('p99', lambda r: r['latency_ns']['total']['p99'], False),
+    ('p99.9', lambda r: r['latency_ns']['total']['p99.9'], False),
+]
+
+
+def load(directory):
+    results = {}
+    for path in glob.glob(os.path.join(directory, '*.json')):
+        with open(path) as f:
+            r = json.load(f)
+        results[r['scenario']] = r
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('base', help='The directory of the results to compare to')
+    parser.add_argument('new', help='The directory of the new results')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='The change, in percent, for a metric to be a regression')
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    regressions = 0
+    print('{:<16}'.format('scenario') + ''.join('{:>18}'.format(m[0]) for m in METRICS))
+    for scenario in sorted(set(base) & set(new)):
+        line = '{:<16}'.format(scenario)
+        for name, get, more_is_better in METRICS:
+            b, n = get(base[scenario]), get(new[scenario])
+            if not b or n is None:
+                line += '{:>18}'.format('-')
+                continue
+            change = (n - b) * 100.0 / b
+            worse = -change if more_is_better else change
+            mark = ' !' if worse > args.threshold else '  '
+            regressions += worse > args.threshold
+            line += '{:>16}'.format('{:+.1f}%'.format(change)) + mark
+        print(line)
+    for scenario in sorted(set(base) ^ set(new)):
+        print('{:<16} only in {}'.format(scenario, args.base if scenario in base else args.new))
+    if regressions:
+        print('{} regressions over {}%'.format(regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
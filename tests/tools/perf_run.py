@@ -0,0 +1,116 @@
+'''
+Run jtest for a performance scenario, and write its throughput, the CPU time
+of traffic_server per request and the latency percentiles as JSON.
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def cpu_seconds(pid):
+    '''The user and system CPU time of the process pid.'''
+    with open('/proc/{}/stat'.format(pid)) as f:
+        # The command may have spaces, the fields after it start with the third.
+        fields = f.read().rsplit(')', 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf('SC_CLK_TCK')
+
+
+def commit():
+    try:
+        return subprocess.check_output(['git', 'rev-parse', 'HEAD'], cwd=os.path.dirname(os.path.abspath(__file__)),
+                                       stderr=subprocess.DEVNULL).decode('utf-8').strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def run_jtest(jtest, jtest_args, seconds, json_file=None):
+    command = [jtest] + jtest_args + ['--test_time', str(seconds)]
+    if json_file:
+        command += ['--json', json_file]
+    print(' '.join(command), flush=True)
+    return subprocess.run(command).returncode
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--name', required=True, help='The name of the scenario')
+    parser.add_argument('--jtest', default='jtest', help='The jtest program')
+    parser.add_argument('--pid-file', help='The lock file of traffic_server, which has its pid')
+    parser.add_argument('--seconds', type=int, default=30, help='How long the scenario is measured')
+    parser.add_argument('--warmup', type=int, default=0, help='How long jtest runs before, to fill the cache')
+    parser.add_argument('--max-error-rate', type=float, default=0.001, help='The errors for the scenario to fail')
+    parser.add_argument('--output', required=True, help='The JSON file of the results')
+    parser.add_argument('jtest_args', nargs=argparse.REMAINDER, help='The arguments of jtest, after --')
+    args = parser.parse_args()
+    jtest_args = args.jtest_args[1:] if args.jtest_args[:1] == ['--'] else args.jtest_args
+
+    if args.warmup and run_jtest(args.jtest, jtest_args, args.warmup):
+        print('{}: the warmup failed'.format(args.name))
+        return 1
+
+    pid = None
+    if args.pid_file:
+        with open(args.pid_file) as f:
+            pid = int(f.read().strip())
+    cpu = cpu_seconds(pid) if pid else None
+    with tempfile.NamedTemporaryFile(suffix='.json') as f:
+        if run_jtest(args.jtest, jtest_args, args.seconds, f.name):
+            print('{}: jtest failed'.format(args.name))
+            return 1
+        jtest = json.load(f)
+    if pid:
+        cpu = cpu_seconds(pid) - cpu
+
+    ops = jtest['ops']
+    results = {
+        'scenario': args.name,
+        'commit': commit(),
+        'seconds': jtest['seconds'],
+        'rps': jtest['rps'],
+        'ops': ops,
+        'errors': jtest['errors'],
+        'bytes': jtest['bytes'],
+        'connections': jtest['connections'],
+        'tls_handshakes': jtest['tls_handshakes'],
+        'tls_resumed': jtest['tls_resumed'],
+        'cpu_seconds': cpu,
+        'cpu_usec_per_request': cpu * 1e6 / ops if cpu is not None and ops else None,
+        'latency_ns': jtest['latency_ns'],
+    }
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+        f.write('\n')
+
+    total = jtest['latency_ns']['total']
+    print('{}: {:.1f} rps, {} usec of CPU per request, p50 {:.3f} p99 {:.3f} p99.9 {:.3f} msec, {} errors'.format(
+        args.name, results['rps'],
+        '{:.1f}'.format(results['cpu_usec_per_request']) if results['cpu_usec_per_request'] is not None else '?',
+        total['p50'] / 1e6, total['p99'] / 1e6, total['p99.9'] / 1e6, results['errors']))
+    if not ops or results['errors'] > args.max_error_rate * (ops + results['errors']):
+        print('{}: FAIL, too many errors'.format(args.name))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
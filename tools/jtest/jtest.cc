@@ -43,8 +43,18 @@
 #include <sys/resource.h>
 #include <limits.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
 #include <cmath>
 #include <openssl/md5.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <inttypes.h>
 
@@ -62,6 +72,9 @@
 #include "tscore/ink_args.h"
 #include "tscore/I_Version.h"
 #include "tscpp/util/TextView.h"
+#include "tscore/Arena.h"
+#include "XPACK.h"
+#include "HuffmanCodec.h"
 
 /*
  FTP - Traffic Server Template
@@ -136,6 +149,18 @@ static void done();
 static int is_done();
 static int open_server(unsigned short int port, accept_fn_t accept_fn);
 static int accept_ftp_data(int sock);
+static int tls_handshake(int sock);
+static int client_read(int sock, char *buf, int len);
+static int client_write(int sock, const char *buf, int len);
+static int make_h2_client();
+static void h2_arrival(ink_hrtime start);
+static void h2_free(int sock);
+static int h2_read(int sock);
+static int h2_write(int sock);
+static void summary_report();
+static bool reap_processes();
+static void collect_processes();
+static void publish_stats();
 
 static char **defered_urls     = nullptr;
 static int n_defered_urls      = 0;
@@ -242,6 +267,11 @@ static int zipf_bucket_size    = 1;
 static int range_mode          = 0;
 static int post_support        = 0;
 static int post_size           = 0;
+static int tls_mode            = 0;
+static int h2_streams          = 0;
+static int arrival_rate        = 0;
+static int processes           = 1;
+static char json_file[256]     = "";
 
 static const ArgumentDescription argument_descriptions[] = {
   {"proxy_port", 'p', "Proxy Port", "I", &proxy_port, "JTEST_PROXY_PORT", nullptr},
@@ -313,10 +343,147 @@ static const ArgumentDescription argument_descriptions[] = {
   {"post_support", ' ', "POST Mode (0 disable(default), 1 random, 2 specified size by post_size)", "I", &post_support,
    "JTEST_POST_MODE", nullptr},
   {"post_size", ' ', "POST SIZE", "I", &post_size, "JTEST_POST_SIZE", nullptr},
+  {"tls", ' ', "TLS to the Proxy (0 none, 1 full handshakes, 2 resume sessions)", "I", &tls_mode, "JTEST_TLS", nullptr},
+  {"h2", ' ', "HTTP/2 to the Proxy over TLS, Streams per Connection (0:HTTP/1)", "I", &h2_streams, "JTEST_H2", nullptr},
+  {"arrival_rate", ' ', "Requests Per Sec, open loop (0:closed loop)", "I", &arrival_rate, "JTEST_ARRIVAL_RATE", nullptr},
+  {"processes", ' ', "Client Processes, sharing clients and rates", "I", &processes, "JTEST_PROCESSES", nullptr},
+  {"json", ' ', "Write the Summary as JSON to File", "S256", json_file, "JTEST_JSON", nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION()};
 int n_argument_descriptions = countof(argument_descriptions);
 
+/*-------------------------------------------------------------------------
+  Latency histograms
+
+  The buckets are log-linear, like those of HdrHistogram: the values up to
+  256 nanoseconds have a bucket each, and each power of 2 above that is cut
+  into 128 buckets, which keeps a value within 1% of those in its bucket, up
+  to about 9 hours. A histogram is a fixed array, that the client processes
+  keep in shared memory for the parent to merge.
+  -------------------------------------------------------------------------*/
+
+struct LatencyHistogram {
+  static constexpr int LINEAR_BITS = 8;
+  static constexpr int SUB_BITS    = 7;
+  static constexpr int MAGNITUDES  = 38;
+  static constexpr int BUCKETS     = (1 << LINEAR_BITS) + MAGNITUDES * (1 << SUB_BITS);
+
+  uint64_t counts[BUCKETS];
+  uint64_t total;
+  uint64_t sum;
+  uint64_t max;
+
+  static int
+  index(uint64_t v)
+  {
+    if (v < (1 << LINEAR_BITS)) {
+      return v;
+    }
+    int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    if (shift > MAGNITUDES) {
+      return BUCKETS - 1;
+    }
+    return (1 << LINEAR_BITS) + (shift - 1) * (1 << SUB_BITS) + ((v >> shift) - (1 << SUB_BITS));
+  }
+
+  // The highest value of the bucket @a i.
+  static uint64_t
+  value(int i)
+  {
+    if (i < (1 << LINEAR_BITS)) {
+      return i;
+    }
+    int shift    = (i - (1 << LINEAR_BITS)) / (1 << SUB_BITS) + 1;
+    uint64_t sub = (i - (1 << LINEAR_BITS)) % (1 << SUB_BITS) + (1 << SUB_BITS);
+    return ((sub + 1) << shift) - 1;
+  }
+
+  void
+  record(ink_hrtime t)
+  {
+    uint64_t v = t > 0 ? t : 0;
+    counts[index(v)]++;
+    total++;
+    sum += v;
+    max = std::max(max, v);
+  }
+
+  void
+  add(const LatencyHistogram &h)
+  {
+    for (int i = 0; i < BUCKETS; i++) {
+      counts[i] += h.counts[i];
+    }
+    total += h.total;
+    sum += h.sum;
+    max = std::max(max, h.max);
+  }
+
+  // The value below which @a p percent of the values are.
+  uint64_t
+  percentile(double p) const
+  {
+    uint64_t rank = (uint64_t)ceil(p / 100.0 * total), seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        return std::min(value(i), max);
+      }
+    }
+    return max;
+  }
+};
+
+enum { PHASE_CONNECT, PHASE_TLS, PHASE_TTFB, PHASE_TOTAL, N_PHASES };
+static const char *const phase_names[N_PHASES] = {"connect", "tls", "ttfb", "total"};
+static const double report_percentiles[]        = {50, 90, 99, 99.9, 99.99};
+
+// What a client process accounts for, in shared memory with several processes.
+struct ClientStats {
+  uint64_t ops;
+  uint64_t errors;
+  uint64_t bytes;
+  uint64_t connections;
+  uint64_t tls_handshakes;
+  uint64_t tls_resumed;
+  int current_clients;
+  LatencyHistogram phases[N_PHASES];
+
+  void
+  add(const ClientStats &s)
+  {
+    ops += s.ops;
+    errors += s.errors;
+    bytes += s.bytes;
+    connections += s.connections;
+    tls_handshakes += s.tls_handshakes;
+    tls_resumed += s.tls_resumed;
+    current_clients += s.current_clients;
+    for (int i = 0; i < N_PHASES; i++) {
+      phases[i].add(s.phases[i]);
+    }
+  }
+};
+
+static ClientStats local_stats;
+static ClientStats *client_stats         = &local_stats; // of this process
+static ClientStats *process_stats        = nullptr;      // of all the processes, in the parent
+static int process_index                 = -1;           // of this client process, -1 if there is none
+static int processes_exited              = 0;
+static ink_hrtime scheduled_start        = 0; // of the request being made, in the open loop
+static uint64_t arrivals                 = 0;
+static SSL_CTX *client_ssl_ctx           = nullptr;
+static SSL_SESSION *client_session       = nullptr;
+static volatile sig_atomic_t interrupted = 0;
+
+static void
+record_phase(int phase, ink_hrtime t)
+{
+  client_stats->phases[phase].record(t);
+}
+
+struct H2Connection;
+
 struct FD {
   int fd;
   poll_cb read_cb;
@@ -363,6 +530,12 @@ struct FD {
   int send_header;
   int header_size;
 
+  // Of the connection, kept across its keep-alive requests.
+  ink_hrtime connect_start;   // until it is connected
+  ink_hrtime handshake_start; // until the TLS handshake is done
+  SSL *ssl;
+  H2Connection *h2;
+
   void
   reset()
   {
@@ -425,6 +598,16 @@ FD::close()
   if (verbose) {
     printf("close: %d\n", fd);
   }
+  if (ssl) {
+    SSL_set_quiet_shutdown(ssl, 1);
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    ssl = nullptr;
+  }
+  if (h2) {
+    h2_free(fd);
+  }
+  connect_start = 0;
   ::close(fd);
   if (is_done()) {
     done();
@@ -1787,8 +1970,9 @@ poll_loop()
     }
   }
   pollfd pfd[POLL_GROUP_SIZE];
-  int ip = 0;
-  now    = ink_get_hrtime_internal();
+  int ip       = 0;
+  bool pending = false; // TLS records already read and not consumed, which poll does not see
+  now          = ink_get_hrtime_internal();
   for (int i = 0; i <= last_fd; i++) {
     if (fd[i].fd > 0 && (!fd[i].ready || now >= fd[i].ready)) {
       pfd[ip].fd      = i;
@@ -1796,6 +1980,9 @@ poll_loop()
       pfd[ip].revents = 0;
       if (fd[i].read_cb) {
         pfd[ip].events |= POLLIN;
+        if (fd[i].ssl && SSL_pending(fd[i].ssl) > 0) {
+          pending = true;
+        }
       }
       if (fd[i].write_cb) {
         pfd[ip].events |= POLLOUT;
@@ -1803,9 +1990,13 @@ poll_loop()
       ip++;
     }
     if (ip >= POLL_GROUP_SIZE || i == last_fd) {
-      int n = poll(pfd, ip, POLL_TIMEOUT);
-      if (n > 0) {
+      // The arrivals of the open loop are made to the millisecond.
+      int n = poll(pfd, ip, pending ? 0 : arrival_rate ? 1 : POLL_TIMEOUT);
+      if (n > 0 || pending) {
         for (int j = 0; j < ip; j++) {
+          if (fd[pfd[j].fd].ssl && SSL_pending(fd[pfd[j].fd].ssl) > 0) {
+            pfd[j].revents |= POLLIN;
+          }
           if (pfd[j].revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) {
             if (verbose) {
               printf("poll read %d %X\n", pfd[j].fd, pfd[j].revents);
@@ -1826,7 +2017,8 @@ poll_loop()
           }
         }
       }
-      ip = 0;
+      ip      = 0;
+      pending = false;
     }
   }
   return 0;
@@ -1971,7 +2163,17 @@ throttling_connections()
 static void
 done()
 {
+  if (process_index >= 0) { // the parent reports
+    publish_stats();
+    exit(0);
+  }
+  if (process_stats) {
+    while (!reap_processes()) {
+      poll_loop(); // serve the clients until they are done
+    }
+  }
   interval_report();
+  summary_report();
   exit(0);
 }
 
@@ -2004,7 +2206,7 @@ static void
 init_client(int sock)
 {
   poll_init(sock);
-  fd[sock].start = now;
+  fd[sock].start = scheduled_start ? scheduled_start : now;
   fd[sock].ready = now;
   fd[sock].count = &clients;
   poll_set(sock, nullptr, write_request);
@@ -2345,7 +2547,7 @@ read_response_error(int sock)
 {
   errors++;
   fd[sock].close();
-  if (!urls_mode) {
+  if (!urls_mode && !arrival_rate) {
     make_bfc_client(proxy_addr, proxy_port);
   }
   return 0;
@@ -2369,7 +2571,7 @@ read_response(int sock)
         }
         return read_response_error(sock);
       }
-      err = read(sock, fd[sock].req_header + fd[sock].req_pos, HEADER_SIZE - fd[sock].req_pos - 1);
+      err = client_read(sock, fd[sock].req_header + fd[sock].req_pos, HEADER_SIZE - fd[sock].req_pos - 1);
     } while ((err == -1) && (errno == EINTR));
     if (err <= 0) {
       if (!err) {
@@ -2385,7 +2587,7 @@ read_response(int sock)
       if (errno == ECONNRESET) {
         if (!fd[sock].req_pos && keepalive > 0 && fd[sock].keepalive != keepalive) {
           fd[sock].close();
-          if (!urls_mode) {
+          if (!urls_mode && !arrival_rate) {
             make_bfc_client(proxy_addr, proxy_port);
           }
           return 0;
@@ -2404,7 +2606,11 @@ read_response(int sock)
 
     strcpy(fd[sock].response_header, fd[sock].req_header);
 
+    if (!fd[sock].req_pos) {
+      record_phase(PHASE_TTFB, ink_get_hrtime_internal() - fd[sock].start);
+    }
     b1latency += (int)elapsed_from_start(sock);
+    client_stats->bytes += err;
     new_cbytes += err;
     new_tbytes += err;
     fd[sock].req_pos += err;
@@ -2571,13 +2777,13 @@ read_response(int sock)
         !faster_than(sock, abort_retry_speed, fd[sock].bytes)) {
       fd[sock].client_abort = 1;
       fd[sock].keepalive    = 0;
-      if (!urls_mode && !client_rate) {
+      if (!urls_mode && !client_rate && !arrival_rate) {
         make_bfc_client(proxy_addr, proxy_port);
       }
       goto Ldone;
     }
     do {
-      err = read(sock, r, toread);
+      err = client_read(sock, r, toread);
     } while ((err == -1) && (errno == EINTR));
     if (err < 0) {
       if (errno == EAGAIN || errno == ENOTCONN) {
@@ -2601,6 +2807,7 @@ read_response(int sock)
       return read_response_error(sock);
     }
     total_proxy_response_body_bytes += err;
+    client_stats->bytes += err;
     new_cbytes += err;
     new_tbytes += err;
     fd[sock].response_remaining += err;
@@ -2633,6 +2840,8 @@ Ldone:
     printf("read %d done\n", sock);
   }
   new_ops++;
+  client_stats->ops++;
+  record_phase(PHASE_TOTAL, ink_get_hrtime_internal() - fd[sock].start);
   double thislatency = elapsed_from_start(sock);
   latency += (int)thislatency;
   lat_ops++;
@@ -2647,7 +2856,7 @@ Ldone:
   } else {
     fd[sock].close();
   }
-  if (!urls_mode && !client_rate) {
+  if (!urls_mode && !client_rate && !arrival_rate) {
     make_bfc_client(proxy_addr, proxy_port);
   }
   return 0;
@@ -2661,7 +2870,7 @@ write_request(int sock)
   // send request header
   if (!fd[sock].send_header) {
     do {
-      err = write(sock, fd[sock].req_header + fd[sock].req_pos, fd[sock].length - fd[sock].req_pos);
+      err = client_write(sock, fd[sock].req_header + fd[sock].req_pos, fd[sock].length - fd[sock].req_pos);
     } while ((err == -1) && (errno == EINTR));
     if (err <= 0) {
       if (!err) {
@@ -2679,6 +2888,10 @@ write_request(int sock)
     if (verbose) {
       printf("write %d %d\n", sock, err);
     }
+    if (fd[sock].connect_start) {
+      record_phase(PHASE_CONNECT, ink_get_hrtime_internal() - fd[sock].connect_start);
+      fd[sock].connect_start = 0;
+    }
 
     new_tbytes += err;
     total_client_request_bytes += err;
@@ -2704,7 +2917,7 @@ write_request(int sock)
 
   if (fd[sock].send_header) {
     do {
-      err = write(sock, response_buffer + fd[sock].req_pos, fd[sock].post_size - fd[sock].req_pos);
+      err = client_write(sock, response_buffer + fd[sock].req_pos, fd[sock].post_size - fd[sock].req_pos);
     } while ((err == -1) && (errno == EINTR));
     if (err <= 0) {
       if (!err) {
@@ -2865,10 +3078,24 @@ make_client(unsigned int addr, int port)
   }
 
   init_client(sock);
-  fd[sock].ip = addr;
+  fd[sock].ip            = addr;
+  fd[sock].connect_start = ink_get_hrtime_internal();
   clients++;
   current_clients++;
   new_clients++;
+  client_stats->connections++;
+
+  if (tls_mode) {
+    SSL *ssl = SSL_new(client_ssl_ctx);
+    SSL_set_fd(ssl, sock);
+    SSL_set_connect_state(ssl);
+    SSL_set_tlsext_host_name(ssl, proxy_host);
+    if (tls_mode == 2 && client_session) {
+      SSL_set_session(ssl, client_session);
+    }
+    fd[sock].ssl = ssl;
+    poll_set(sock, nullptr, tls_handshake);
+  }
   return sock;
 }
 
@@ -3219,6 +3446,968 @@ make_bfc_client(unsigned int addr, int port)
   }
 }
 
+/*-------------------------------------------------------------------------
+  TLS
+
+  The connections of the clients are all TLS with --tls, the sessions of
+  the full handshakes are resumed with --tls 2. The certificate of the
+  proxy is not verified.
+  -------------------------------------------------------------------------*/
+
+static int
+new_client_session(SSL *, SSL_SESSION *session)
+{
+  if (client_session) {
+    SSL_SESSION_free(client_session);
+  }
+  client_session = session;
+  return 1;
+}
+
+static void
+init_tls()
+{
+  client_ssl_ctx = SSL_CTX_new(TLS_client_method());
+  if (!client_ssl_ctx) {
+    panic("unable to create the TLS context\n");
+  }
+  SSL_CTX_set_verify(client_ssl_ctx, SSL_VERIFY_NONE, nullptr);
+  SSL_CTX_set_mode(client_ssl_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+  if (tls_mode == 2) {
+    SSL_CTX_set_session_cache_mode(client_ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(client_ssl_ctx, new_client_session);
+  }
+  if (h2_streams) {
+    static const unsigned char alpn[] = {2, 'h', '2'};
+    SSL_CTX_set_alpn_protos(client_ssl_ctx, alpn, sizeof(alpn));
+  }
+}
+
+// Like read(), EAGAIN while the TLS records are not complete, ECONNRESET when they are wrong.
+static int
+client_read(int sock, char *buf, int len)
+{
+  SSL *ssl = fd[sock].ssl;
+  if (!ssl) {
+    return read(sock, buf, len);
+  }
+  int r = SSL_read(ssl, buf, len);
+  if (r > 0) {
+    return r;
+  }
+  switch (SSL_get_error(ssl, r)) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    errno = EAGAIN;
+    return -1;
+  case SSL_ERROR_ZERO_RETURN:
+    return 0;
+  default:
+    ERR_clear_error();
+    errno = ECONNRESET;
+    return -1;
+  }
+}
+
+static int
+client_write(int sock, const char *buf, int len)
+{
+  SSL *ssl = fd[sock].ssl;
+  if (!ssl) {
+    return write(sock, buf, len);
+  }
+  int r = SSL_write(ssl, buf, len);
+  if (r > 0) {
+    return r;
+  }
+  switch (SSL_get_error(ssl, r)) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    errno = EAGAIN;
+    return -1;
+  default:
+    ERR_clear_error();
+    errno = ECONNRESET;
+    return -1;
+  }
+}
+
+/*-------------------------------------------------------------------------
+  HTTP/2
+
+  With --h2, each client is a TLS connection that negotiates h2 by ALPN and
+  keeps up to that many streams open, a GET each, as many as the server
+  allows. The requests are those of HTTP/1, translated. A connection makes
+  --keepalive requests on each of its streams before it is replaced, it is
+  never replaced if --keepalive is 0.
+  -------------------------------------------------------------------------*/
+
+enum {
+  H2_DATA          = 0x0,
+  H2_HEADERS       = 0x1,
+  H2_RST_STREAM    = 0x3,
+  H2_SETTINGS      = 0x4,
+  H2_PUSH_PROMISE  = 0x5,
+  H2_PING          = 0x6,
+  H2_GOAWAY        = 0x7,
+  H2_WINDOW_UPDATE = 0x8,
+  H2_CONTINUATION  = 0x9,
+};
+
+enum {
+  H2_FLAG_END_STREAM  = 0x1,
+  H2_FLAG_ACK         = 0x1,
+  H2_FLAG_END_HEADERS = 0x4,
+  H2_FLAG_PADDED      = 0x8,
+  H2_FLAG_PRIORITY    = 0x20,
+};
+
+enum {
+  H2_SETTINGS_HEADER_TABLE_SIZE      = 0x1,
+  H2_SETTINGS_ENABLE_PUSH            = 0x2,
+  H2_SETTINGS_MAX_CONCURRENT_STREAMS = 0x3,
+  H2_SETTINGS_INITIAL_WINDOW_SIZE    = 0x4,
+  H2_SETTINGS_MAX_FRAME_SIZE         = 0x5,
+};
+
+static const uint32_t H2_MAX_WINDOW       = 0x7fffffff;
+static const uint32_t H2_WINDOW_REFILL    = 1 << 30; // received before the window is given back
+static const uint32_t H2_DEFAULT_FRAME    = 16384;
+static const uint32_t H2_DEFAULT_TABLE    = 4096;
+static const uint32_t H2_HPACK_STATIC_MAX = 61;
+
+static const char *const hpack_static_table[H2_HPACK_STATIC_MAX][2] = {
+  {":authority", ""},
+  {":method", "GET"},
+  {":method", "POST"},
+  {":path", "/"},
+  {":path", "/index.html"},
+  {":scheme", "http"},
+  {":scheme", "https"},
+  {":status", "200"},
+  {":status", "204"},
+  {":status", "206"},
+  {":status", "304"},
+  {":status", "400"},
+  {":status", "404"},
+  {":status", "500"},
+  {"accept-charset", ""},
+  {"accept-encoding", "gzip, deflate"},
+  {"accept-language", ""},
+  {"accept-ranges", ""},
+  {"accept", ""},
+  {"access-control-allow-origin", ""},
+  {"age", ""},
+  {"allow", ""},
+  {"authorization", ""},
+  {"cache-control", ""},
+  {"content-disposition", ""},
+  {"content-encoding", ""},
+  {"content-language", ""},
+  {"content-length", ""},
+  {"content-location", ""},
+  {"content-range", ""},
+  {"content-type", ""},
+  {"cookie", ""},
+  {"date", ""},
+  {"etag", ""},
+  {"expect", ""},
+  {"expires", ""},
+  {"from", ""},
+  {"host", ""},
+  {"if-match", ""},
+  {"if-modified-since", ""},
+  {"if-none-match", ""},
+  {"if-range", ""},
+  {"if-unmodified-since", ""},
+  {"last-modified", ""},
+  {"link", ""},
+  {"location", ""},
+  {"max-forwards", ""},
+  {"proxy-authenticate", ""},
+  {"proxy-authorization", ""},
+  {"range", ""},
+  {"referer", ""},
+  {"refresh", ""},
+  {"retry-after", ""},
+  {"server", ""},
+  {"set-cookie", ""},
+  {"strict-transport-security", ""},
+  {"transfer-encoding", ""},
+  {"user-agent", ""},
+  {"vary", ""},
+  {"via", ""},
+  {"www-authenticate", ""},
+};
+
+// The dynamic table of an HPACK context, of an encoder or of a decoder.
+struct HpackTable {
+  std::deque<std::pair<std::string, std::string>> entries; // the newest first
+  size_t size     = 0;
+  size_t max_size = H2_DEFAULT_TABLE;
+
+  void
+  add(std::string name, std::string value)
+  {
+    size += name.size() + value.size() + 32;
+    entries.emplace_front(std::move(name), std::move(value));
+    evict();
+  }
+
+  void
+  resize(size_t s)
+  {
+    max_size = s;
+    evict();
+  }
+
+  void
+  evict()
+  {
+    while (size > max_size && !entries.empty()) {
+      size -= entries.back().first.size() + entries.back().second.size() + 32;
+      entries.pop_back();
+    }
+  }
+
+  // The field at @a index of the static table and then of this one.
+  bool
+  get(uint64_t index, std::string &name, std::string &value) const
+  {
+    if (!index) {
+      return false;
+    }
+    if (index <= H2_HPACK_STATIC_MAX) {
+      name  = hpack_static_table[index - 1][0];
+      value = hpack_static_table[index - 1][1];
+      return true;
+    }
+    index -= H2_HPACK_STATIC_MAX + 1;
+    if (index >= entries.size()) {
+      return false;
+    }
+    name  = entries[index].first;
+    value = entries[index].second;
+    return true;
+  }
+
+  // The index of the field @a name: @a value, 0 if there is none, with @a name_index that of its name.
+  uint64_t
+  find(std::string_view name, std::string_view value, uint64_t &name_index) const
+  {
+    name_index = 0;
+    for (uint64_t i = 0; i < H2_HPACK_STATIC_MAX; i++) {
+      if (name == hpack_static_table[i][0]) {
+        if (value == hpack_static_table[i][1]) {
+          return i + 1;
+        }
+        if (!name_index) {
+          name_index = i + 1;
+        }
+      }
+    }
+    for (uint64_t i = 0; i < entries.size(); i++) {
+      if (name == entries[i].first) {
+        if (value == entries[i].second) {
+          return H2_HPACK_STATIC_MAX + 1 + i;
+        }
+        if (!name_index) {
+          name_index = H2_HPACK_STATIC_MAX + 1 + i;
+        }
+      }
+    }
+    return 0;
+  }
+};
+
+struct H2Stream {
+  ink_hrtime start;       // of the request, or of its arrival in the open loop
+  int status;             // of the final response, 0 until its headers are read
+  int64_t content_length; // -1 if the response has none
+  int64_t bytes;          // of the body
+  uint32_t unacked;       // received and not given back to the window of the stream
+};
+
+struct H2Connection {
+  std::string in;  // read and not parsed yet
+  std::string out; // not written yet
+  uint32_t next_stream_id = 1;
+  std::unordered_map<uint32_t, H2Stream> streams;
+  std::deque<ink_hrtime> queued; // the arrivals of the open loop waiting for the connection
+  HpackTable encoder;
+  HpackTable decoder;
+  bool encoder_resized      = false; // the next header block tells the size of the table
+  uint32_t max_streams      = UINT32_MAX;
+  uint32_t max_frame        = H2_DEFAULT_FRAME;
+  int requests_left         = -1; // -1 without limit
+  bool started              = false;
+  bool goaway               = false;
+  uint32_t continued        = 0; // the stream whose header block goes on in CONTINUATION frames
+  bool continued_end_stream = false;
+  std::string header_block;
+  uint32_t unacked = 0; // received and not given back to the window of the connection
+};
+
+static std::vector<int> h2_connections;
+
+static int
+h2_closed_loop()
+{
+  return !client_rate && !arrival_rate;
+}
+
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+static uint32_t
+get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static void
+h2_send(H2Connection *c, uint8_t type, uint8_t flags, uint32_t stream_id, const void *payload, uint32_t len)
+{
+  uint8_t h[9] = {(uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len, type, flags};
+  put32(h + 5, stream_id & 0x7fffffff);
+  c->out.append((const char *)h, sizeof(h));
+  c->out.append((const char *)payload, len);
+}
+
+static void
+h2_window_update(H2Connection *c, uint32_t stream_id, uint32_t increment)
+{
+  uint8_t p[4];
+  put32(p, increment);
+  h2_send(c, H2_WINDOW_UPDATE, 0, stream_id, p, sizeof(p));
+}
+
+static void
+hpack_encode(H2Connection *c, std::string &block, std::string_view name, std::string_view value)
+{
+  std::vector<uint8_t> buf(4 * (name.size() + value.size()) + 32);
+  uint8_t *p = buf.data(), *end = p + buf.size();
+  uint64_t name_index;
+  uint64_t index = c->encoder.find(name, value, name_index);
+  if (index) {
+    *p = 0x80;
+    p += xpack_encode_integer(p, end, index, 7);
+  } else {
+    // The paths vary too much to be indexed, the other fields are mostly those of the previous requests.
+    bool indexing = name != ":path";
+    *p            = indexing ? 0x40 : 0;
+    p += xpack_encode_integer(p, end, name_index, indexing ? 6 : 4);
+    if (!name_index) {
+      *p = 0;
+      p += xpack_encode_string(p, end, name.data(), name.size());
+    }
+    *p = 0;
+    p += xpack_encode_string(p, end, value.data(), value.size());
+    if (indexing) {
+      c->encoder.add(std::string(name), std::string(value));
+    }
+  }
+  block.append((const char *)buf.data(), p - buf.data());
+}
+
+// Decode the header block of a response, false if it is wrong.
+static bool
+hpack_decode(H2Connection *c, int &status, int64_t &content_length)
+{
+  Arena arena;
+  const uint8_t *p   = (const uint8_t *)c->header_block.data();
+  const uint8_t *end = p + c->header_block.size();
+  std::string name, value;
+  while (p < end) {
+    uint64_t index = 0;
+    int64_t n;
+    if (*p & 0x80) {
+      if ((n = xpack_decode_integer(index, p, end, 7)) < 0 || !c->decoder.get(index, name, value)) {
+        return false;
+      }
+      p += n;
+    } else if ((*p & 0xe0) == 0x20) {
+      if ((n = xpack_decode_integer(index, p, end, 5)) < 0 || index > H2_DEFAULT_TABLE) {
+        return false;
+      }
+      c->decoder.resize(index);
+      p += n;
+      continue;
+    } else {
+      bool indexing = *p & 0x40;
+      char *s;
+      uint64_t len;
+      if ((n = xpack_decode_integer(index, p, end, indexing ? 6 : 4)) < 0) {
+        return false;
+      }
+      p += n;
+      if (index) {
+        if (!c->decoder.get(index, name, value)) {
+          return false;
+        }
+      } else {
+        if ((n = xpack_decode_string(arena, &s, len, p, end)) < 0) {
+          return false;
+        }
+        name.assign(s, len);
+        p += n;
+      }
+      if ((n = xpack_decode_string(arena, &s, len, p, end)) < 0) {
+        return false;
+      }
+      value.assign(s, len);
+      p += n;
+      if (indexing) {
+        c->decoder.add(name, value);
+      }
+    }
+    if (name == ":status") {
+      status = atoi(value.c_str());
+    } else if (name == "content-length") {
+      content_length = atoll(value.c_str());
+    }
+  }
+  return true;
+}
+
+// Send the request, made as for HTTP/1, on a new stream.
+static void
+h2_request(int sock, ink_hrtime start)
+{
+  H2Connection *c = fd[sock].h2;
+  uint32_t sid    = c->next_stream_id;
+  c->next_stream_id += 2;
+  if (c->requests_left > 0) {
+    c->requests_left--;
+  }
+  if (c->next_stream_id > H2_MAX_WINDOW) {
+    c->requests_left = 0;
+  }
+
+  build_request(sock);
+  if (verbose) {
+    printf("request %d stream %u [%s]\n", sock, sid, fd[sock].req_header);
+  }
+  ts::TextView text(fd[sock].req_header, strlen(fd[sock].req_header));
+  ts::TextView line   = text.take_prefix_at('\n').rtrim('\r');
+  ts::TextView method = line.take_prefix_at(' ');
+  ts::TextView path   = line.take_prefix_at(' ');
+  ts::TextView scheme = "https", authority;
+  if (path.find("://") != ts::TextView::npos && path[0] != '/') {
+    scheme = path.take_prefix_at(':');
+    path.remove_prefix(2);
+    authority = path.prefix(path.find('/'));
+    path.remove_prefix(authority.size());
+    if (path.empty()) {
+      path = "/";
+    }
+  }
+  std::vector<std::pair<std::string, ts::TextView>> fields;
+  while (text) {
+    ts::TextView value = text.take_prefix_at('\n').rtrim('\r');
+    if (value.empty()) {
+      break;
+    }
+    ts::TextView name = value.take_prefix_at(':');
+    value.trim(' ');
+    if (!strcasecmp(name, "Host")) {
+      if (authority.empty()) {
+        authority = value;
+      }
+      continue;
+    }
+    if (!strcasecmp(name, "Connection") || !strcasecmp(name, "Proxy-Connection") ||
+        !strcasecmp(name, "Keep-Alive") || !strcasecmp(name, "Transfer-Encoding") || !strcasecmp(name, "Upgrade")) {
+      continue;
+    }
+    std::string lower(name.data(), name.size());
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    fields.emplace_back(std::move(lower), value);
+  }
+
+  std::string block;
+  if (c->encoder_resized) {
+    uint8_t b[16] = {0x20};
+    block.append((const char *)b, xpack_encode_integer(b, b + sizeof(b), c->encoder.max_size, 5));
+    c->encoder_resized = false;
+  }
+  hpack_encode(c, block, ":method", method);
+  hpack_encode(c, block, ":scheme", scheme);
+  hpack_encode(c, block, ":authority", authority);
+  hpack_encode(c, block, ":path", path);
+  for (auto &f : fields) {
+    hpack_encode(c, block, f.first, f.second);
+  }
+  uint32_t n = std::min<size_t>(block.size(), c->max_frame);
+  h2_send(c, H2_HEADERS, H2_FLAG_END_STREAM | (n == block.size() ? H2_FLAG_END_HEADERS : 0), sid, block.data(), n);
+  for (size_t i = n; i < block.size(); i += n) {
+    n = std::min<size_t>(block.size() - i, c->max_frame);
+    h2_send(c, H2_CONTINUATION, i + n == block.size() ? H2_FLAG_END_HEADERS : 0, sid, block.data() + i, n);
+  }
+  c->streams[sid] = H2Stream{start, 0, -1, 0, 0};
+}
+
+// Open as many streams as the connection may, for the queued arrivals in the open loop.
+static void
+h2_fill(int sock)
+{
+  H2Connection *c = fd[sock].h2;
+  uint32_t most   = std::min<uint32_t>(h2_streams, c->max_streams);
+  while (c->started && !c->goaway && c->requests_left && c->streams.size() < most) {
+    ink_hrtime start;
+    if (!c->queued.empty()) {
+      start = c->queued.front();
+      c->queued.pop_front();
+    } else if (h2_closed_loop()) {
+      start = ink_get_hrtime_internal();
+    } else {
+      break;
+    }
+    h2_request(sock, start);
+  }
+  if (!c->out.empty()) {
+    poll_set(sock, h2_read, h2_write);
+  }
+}
+
+static void
+h2_stream_done(int sock, uint32_t stream_id, bool ok)
+{
+  H2Connection *c = fd[sock].h2;
+  auto s          = c->streams.find(stream_id);
+  if (s == c->streams.end()) {
+    return;
+  }
+  H2Stream &stream = s->second;
+  if (ok && stream.status / 100 != 2) {
+    if (verbose_errors) {
+      printf("error response %d stream %u: %d\n", sock, stream_id, stream.status);
+    }
+    ok = false;
+  }
+  if (ok && stream.content_length >= 0 && stream.bytes != stream.content_length && !nocheck_length) {
+    if (verbose_errors) {
+      printf("bad length %" PRId64 " wanted %" PRId64 " stream %u\n", stream.bytes, stream.content_length, stream_id);
+    }
+    ok = false;
+  }
+  if (ok) {
+    ink_hrtime t = ink_get_hrtime_internal() - stream.start;
+    new_ops++;
+    client_stats->ops++;
+    record_phase(PHASE_TOTAL, t);
+    latency += (int)(t / HRTIME_MSECOND);
+    lat_ops++;
+  } else {
+    errors++;
+  }
+  c->streams.erase(s);
+}
+
+static bool
+h2_headers(int sock, uint32_t stream_id, bool end_stream)
+{
+  H2Connection *c        = fd[sock].h2;
+  int status             = 0;
+  int64_t content_length = -1;
+  // Even those of the streams that were reset, for the table to be right.
+  if (!hpack_decode(c, status, content_length)) {
+    return false;
+  }
+  auto s = c->streams.find(stream_id);
+  if (s == c->streams.end()) {
+    return true;
+  }
+  H2Stream &stream = s->second;
+  if (!stream.status) {
+    if (status / 100 == 1 && !end_stream) {
+      return true;
+    }
+    ink_hrtime t = ink_get_hrtime_internal() - stream.start;
+    record_phase(PHASE_TTFB, t);
+    b1latency += (int)(t / HRTIME_MSECOND);
+    b1_ops++;
+    stream.status         = status;
+    stream.content_length = content_length;
+    if (verbose) {
+      printf("read %d stream %u status %d\n", sock, stream_id, status);
+    }
+  }
+  if (end_stream) {
+    h2_stream_done(sock, stream_id, true);
+  }
+  return true;
+}
+
+// Handle a frame, false if it is an error of the connection.
+static bool
+h2_frame(int sock, uint8_t type, uint8_t flags, uint32_t stream_id, const uint8_t *p, uint32_t len)
+{
+  H2Connection *c = fd[sock].h2;
+  if (c->continued && (type != H2_CONTINUATION || stream_id != c->continued)) {
+    return false;
+  }
+  switch (type) {
+  case H2_DATA: {
+    uint32_t pad = 0;
+    if (flags & H2_FLAG_PADDED) {
+      if (!len || (pad = p[0] + 1) > len) {
+        return false;
+      }
+    }
+    c->unacked += len;
+    if (c->unacked >= H2_WINDOW_REFILL) {
+      h2_window_update(c, 0, c->unacked);
+      c->unacked = 0;
+    }
+    auto s = c->streams.find(stream_id);
+    if (s == c->streams.end()) {
+      return true;
+    }
+    s->second.bytes += len - pad;
+    s->second.unacked += len;
+    if (flags & H2_FLAG_END_STREAM) {
+      h2_stream_done(sock, stream_id, true);
+    } else if (s->second.unacked >= H2_WINDOW_REFILL) {
+      h2_window_update(c, stream_id, s->second.unacked);
+      s->second.unacked = 0;
+    }
+    return true;
+  }
+  case H2_HEADERS: {
+    uint32_t skip = 0, pad = 0;
+    if (flags & H2_FLAG_PADDED) {
+      if (!len) {
+        return false;
+      }
+      pad  = p[0];
+      skip = 1;
+    }
+    if (flags & H2_FLAG_PRIORITY) {
+      skip += 5;
+    }
+    if (skip + pad > len) {
+      return false;
+    }
+    c->header_block.assign((const char *)p + skip, len - skip - pad);
+    c->continued_end_stream = flags & H2_FLAG_END_STREAM;
+    if (!(flags & H2_FLAG_END_HEADERS)) {
+      c->continued = stream_id;
+      return true;
+    }
+    return h2_headers(sock, stream_id, c->continued_end_stream);
+  }
+  case H2_CONTINUATION:
+    if (!c->continued) {
+      return false;
+    }
+    c->header_block.append((const char *)p, len);
+    if (flags & H2_FLAG_END_HEADERS) {
+      c->continued = 0;
+      return h2_headers(sock, stream_id, c->continued_end_stream);
+    }
+    return true;
+  case H2_RST_STREAM:
+    if (verbose_errors && c->streams.count(stream_id)) {
+      printf("reset %d stream %u: %u\n", sock, stream_id, len >= 4 ? get32(p) : 0);
+    }
+    h2_stream_done(sock, stream_id, false);
+    return true;
+  case H2_SETTINGS:
+    if (flags & H2_FLAG_ACK) {
+      return true;
+    }
+    if (len % 6) {
+      return false;
+    }
+    for (uint32_t i = 0; i < len; i += 6) {
+      uint32_t value = get32(p + i + 2);
+      switch (p[i] << 8 | p[i + 1]) {
+      case H2_SETTINGS_HEADER_TABLE_SIZE:
+        if (value < c->encoder.max_size) {
+          c->encoder.resize(value);
+          c->encoder_resized = true;
+        }
+        break;
+      case H2_SETTINGS_MAX_CONCURRENT_STREAMS:
+        c->max_streams = value;
+        break;
+      case H2_SETTINGS_MAX_FRAME_SIZE:
+        c->max_frame = value;
+        break;
+      }
+    }
+    h2_send(c, H2_SETTINGS, H2_FLAG_ACK, 0, nullptr, 0);
+    return true;
+  case H2_PING:
+    if (len != 8) {
+      return false;
+    }
+    if (!(flags & H2_FLAG_ACK)) {
+      h2_send(c, H2_PING, H2_FLAG_ACK, 0, p, len);
+    }
+    return true;
+  case H2_GOAWAY: {
+    if (len < 8) {
+      return false;
+    }
+    uint32_t last = get32(p) & 0x7fffffff;
+    if (verbose_errors && get32(p + 4)) {
+      printf("goaway %d after stream %u: %u\n", sock, last, get32(p + 4));
+    }
+    // The streams after the last are not processed, they are errors as are the arrivals still queued.
+    c->goaway = true;
+    errors += c->queued.size();
+    c->queued.clear();
+    for (auto s = c->streams.begin(); s != c->streams.end();) {
+      if (s->first > last) {
+        errors++;
+        s = c->streams.erase(s);
+      } else {
+        ++s;
+      }
+    }
+    return true;
+  }
+  case H2_PUSH_PROMISE: // disabled by the SETTINGS
+    return false;
+  default: // PRIORITY, WINDOW_UPDATE, the extensions
+    return true;
+  }
+}
+
+static int
+h2_finished(H2Connection *c)
+{
+  return c->streams.empty() && c->queued.empty() && (c->goaway || !c->requests_left);
+}
+
+static int
+h2_close(int sock)
+{
+  fd[sock].close();
+  if (h2_closed_loop()) {
+    make_h2_client();
+  }
+  return 0;
+}
+
+// The connection failed, with all its streams.
+static int
+h2_error(int sock)
+{
+  H2Connection *c = fd[sock].h2;
+  errors += std::max<size_t>(c->streams.size() + c->queued.size(), 1);
+  return h2_close(sock);
+}
+
+static int
+h2_read(int sock)
+{
+  H2Connection *c = fd[sock].h2;
+  char buf[MAX_BUFSIZE];
+  int err = 0;
+  do {
+    err = client_read(sock, buf, cbuffersize);
+  } while ((err == -1) && (errno == EINTR));
+  if (err < 0 && (errno == EAGAIN || errno == ENOTCONN)) {
+    return 0;
+  }
+  if (err <= 0) {
+    if (c->streams.empty() && c->queued.empty()) {
+      return h2_close(sock);
+    }
+    if (verbose_errors) {
+      printf("read %d closed with %zu streams\n", sock, c->streams.size());
+    }
+    return h2_error(sock);
+  }
+  client_stats->bytes += err;
+  new_cbytes += err;
+  new_tbytes += err;
+  fd[sock].active = ink_get_hrtime_internal();
+
+  c->in.append(buf, err);
+  size_t pos = 0;
+  while (c->in.size() - pos >= 9) {
+    const uint8_t *h = (const uint8_t *)c->in.data() + pos;
+    uint32_t len     = h[0] << 16 | h[1] << 8 | h[2];
+    if (len > H2_DEFAULT_FRAME) {
+      return h2_error(sock);
+    }
+    if (c->in.size() - pos - 9 < len) {
+      break;
+    }
+    if (!h2_frame(sock, h[3], h[4], get32(h + 5) & 0x7fffffff, h + 9, len)) {
+      if (verbose_errors) {
+        printf("bad frame %d type %d\n", sock, h[3]);
+      }
+      return h2_error(sock);
+    }
+    pos += 9 + len;
+  }
+  c->in.erase(0, pos);
+  h2_fill(sock);
+  if (h2_finished(c) && c->out.empty()) {
+    return h2_close(sock);
+  }
+  return 0;
+}
+
+static int
+h2_write(int sock)
+{
+  H2Connection *c = fd[sock].h2;
+  while (!c->out.empty()) {
+    int err = 0;
+    do {
+      err = client_write(sock, c->out.data(), c->out.size());
+    } while ((err == -1) && (errno == EINTR));
+    if (err < 0 && (errno == EAGAIN || errno == ENOTCONN)) {
+      return 0;
+    }
+    if (err <= 0) {
+      if (verbose_errors) {
+        perror("write");
+      }
+      return h2_error(sock);
+    }
+    new_tbytes += err;
+    total_client_request_bytes += err;
+    c->out.erase(0, err);
+  }
+  poll_set(sock, h2_read);
+  return 0;
+}
+
+// Once the handshake is done.
+static void
+h2_start(int sock)
+{
+  H2Connection *c             = fd[sock].h2;
+  static const char preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+  uint8_t settings[12]        = {0, H2_SETTINGS_ENABLE_PUSH, 0, 0, 0, 0, 0, H2_SETTINGS_INITIAL_WINDOW_SIZE};
+  put32(settings + 8, H2_MAX_WINDOW);
+  c->out.append(preface, sizeof(preface) - 1);
+  h2_send(c, H2_SETTINGS, 0, 0, settings, sizeof(settings));
+  h2_window_update(c, 0, H2_MAX_WINDOW - 65535);
+  c->started = true;
+  h2_fill(sock);
+  poll_set(sock, h2_read, h2_write);
+}
+
+static int
+make_h2_client()
+{
+  int sock = make_client(proxy_addr, proxy_port);
+  if (sock < 0) {
+    panic("unable to open client connection\n");
+  }
+  H2Connection *c  = new H2Connection;
+  c->requests_left = keepalive > 0 ? keepalive * h2_streams : -1;
+  fd[sock].h2      = c;
+  h2_connections.push_back(sock);
+  return sock;
+}
+
+// An arrival of the open loop, on a connection that has room for it, or on a new one.
+static void
+h2_arrival(ink_hrtime start)
+{
+  for (int sock : h2_connections) {
+    H2Connection *c = fd[sock].h2;
+    size_t n        = c->streams.size() + c->queued.size();
+    if (!c->goaway && (c->requests_left < 0 || (size_t)c->requests_left > c->queued.size()) &&
+        n < std::min<uint32_t>(h2_streams, c->max_streams)) {
+      c->queued.push_back(start);
+      h2_fill(sock);
+      return;
+    }
+  }
+  fd[make_h2_client()].h2->queued.push_back(start);
+}
+
+static void
+h2_free(int sock)
+{
+  h2_connections.erase(std::find(h2_connections.begin(), h2_connections.end(), sock));
+  delete fd[sock].h2;
+  fd[sock].h2 = nullptr;
+}
+
+static int
+connection_error(int sock)
+{
+  if (fd[sock].h2) {
+    return h2_error(sock);
+  }
+  return read_response_error(sock);
+}
+
+// The callback of a TLS connection until its handshake is done.
+static int
+tls_handshake(int sock)
+{
+  ink_hrtime t = ink_get_hrtime_internal();
+  SSL *ssl     = fd[sock].ssl;
+  if (fd[sock].connect_start) {
+    int error     = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error) {
+      if (verbose_errors) {
+        printf("connect %d failed: %s\n", sock, strerror(error));
+      }
+      return connection_error(sock);
+    }
+    record_phase(PHASE_CONNECT, t - fd[sock].connect_start);
+    fd[sock].connect_start   = 0;
+    fd[sock].handshake_start = t;
+  }
+  int r = SSL_do_handshake(ssl);
+  if (r != 1) {
+    switch (SSL_get_error(ssl, r)) {
+    case SSL_ERROR_WANT_READ:
+      poll_set(sock, tls_handshake);
+      return 0;
+    case SSL_ERROR_WANT_WRITE:
+      poll_set(sock, nullptr, tls_handshake);
+      return 0;
+    default:
+      if (verbose_errors) {
+        printf("TLS handshake %d failed: %s\n", sock, ERR_error_string(ERR_get_error(), nullptr));
+      }
+      ERR_clear_error();
+      return connection_error(sock);
+    }
+  }
+  record_phase(PHASE_TLS, ink_get_hrtime_internal() - fd[sock].handshake_start);
+  client_stats->tls_handshakes++;
+  if (SSL_session_reused(ssl)) {
+    client_stats->tls_resumed++;
+  }
+  if (fd[sock].h2) {
+    const unsigned char *proto = nullptr;
+    unsigned int len           = 0;
+    SSL_get0_alpn_selected(ssl, &proto, &len);
+    if (len != 2 || memcmp(proto, "h2", 2)) {
+      if (verbose_errors) {
+        printf("TLS handshake %d did not select h2\n", sock);
+      }
+      return connection_error(sock);
+    }
+    h2_start(sock);
+  } else {
+    poll_set(sock, nullptr, write_request);
+  }
+  return 0;
+}
+
 #define RUNNING(_n)                                                               \
   total_##_n   = (((total_##_n * (average_over - 1)) / average_over) + new_##_n); \
   running_##_n = total_##_n / average_over;                                       \
@@ -3233,6 +4422,9 @@ interval_report()
 {
   static int here = 0;
   now             = ink_get_hrtime_internal();
+  if (process_stats) {
+    collect_processes();
+  }
   if (!(here++ % 20)) {
     printf(" con  new     ops   1B  lat      bytes/per     svrs  new  ops      total   time  err\n");
   }
@@ -3262,6 +4454,191 @@ interval_report()
   }
 }
 
+/*-------------------------------------------------------------------------
+  Client processes
+
+  With --processes, the clients are forked into that many processes, each
+  with its share of the clients and of the rates, as a single process runs
+  out of CPU well before a proxy does. They account for their requests in
+  shared memory, the parent runs the server and reports for all of them.
+  -------------------------------------------------------------------------*/
+
+static pid_t *process_pids = nullptr;
+
+static int
+process_share(int n, int i)
+{
+  return n / processes + (i < n % processes);
+}
+
+static void
+start_processes()
+{
+  void *shared = mmap(nullptr, processes * sizeof(ClientStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    panic_perror("mmap");
+  }
+  process_stats = static_cast<ClientStats *>(shared);
+  process_pids  = (pid_t *)malloc(processes * sizeof(pid_t));
+  for (int i = 0; i < processes; i++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      panic_perror("fork");
+    }
+    if (!pid) {
+      process_index  = i;
+      client_stats   = &process_stats[i];
+      process_stats  = nullptr;
+      nclients       = process_share(nclients, i);
+      client_rate    = process_share(client_rate, i);
+      arrival_rate   = process_share(arrival_rate, i);
+      bandwidth_test = process_share(bandwidth_test, i);
+      // coverity[dont_call]
+      srand48((long)(drand_seed ? drand_seed : time(nullptr)) + i + 1);
+      if (server_fd > 0) {
+        ::close(server_fd);
+        fd[server_fd].reset();
+        server_fd = 0;
+      }
+      return;
+    }
+    process_pids[i] = pid;
+  }
+  nclients = client_rate = arrival_rate = bandwidth_test = 0;
+}
+
+// Whether all the client processes exited.
+static bool
+reap_processes()
+{
+  while (processes_exited < processes && waitpid(-1, nullptr, WNOHANG) > 0) {
+    processes_exited++;
+  }
+  return processes_exited >= processes;
+}
+
+// Add what the client processes did since the last interval to the counters of the report.
+static void
+collect_processes()
+{
+  static uint64_t last_ops = 0, last_bytes = 0, last_errors = 0;
+  static uint64_t last_lat_ops = 0, last_lat_sum = 0, last_b1_ops = 0, last_b1_sum = 0;
+  ClientStats *p = process_stats;
+  uint64_t ops = 0, bytes = 0, errs = 0, lat_n = 0, lat_sum = 0, b1_n = 0, b1_sum = 0;
+  int clients = 0;
+  for (int i = 0; i < processes; i++) {
+    ops += p[i].ops;
+    bytes += p[i].bytes;
+    errs += p[i].errors;
+    clients += p[i].current_clients;
+    lat_n += p[i].phases[PHASE_TOTAL].total;
+    lat_sum += p[i].phases[PHASE_TOTAL].sum;
+    b1_n += p[i].phases[PHASE_TTFB].total;
+    b1_sum += p[i].phases[PHASE_TTFB].sum;
+  }
+  new_ops += ops - last_ops;
+  new_cbytes += bytes - last_bytes;
+  new_tbytes += bytes - last_bytes;
+  errors += errs - last_errors;
+  latency += (lat_sum - last_lat_sum) / HRTIME_MSECOND;
+  lat_ops += lat_n - last_lat_ops;
+  b1latency += (b1_sum - last_b1_sum) / HRTIME_MSECOND;
+  b1_ops += b1_n - last_b1_ops;
+  current_clients = clients;
+  last_ops        = ops;
+  last_bytes      = bytes;
+  last_errors     = errs;
+  last_lat_ops    = lat_n;
+  last_lat_sum    = lat_sum;
+  last_b1_ops     = b1_n;
+  last_b1_sum     = b1_sum;
+}
+
+// What a client process reports to the parent, as it goes.
+static void
+publish_stats()
+{
+  client_stats->errors          = errors;
+  client_stats->current_clients = current_clients;
+}
+
+/*-------------------------------------------------------------------------
+  Summary
+
+  At the end of a run, the latency percentiles of each phase of the
+  requests, and with --json the same as a JSON object, for the scripts
+  that compare the runs.
+  -------------------------------------------------------------------------*/
+
+static void
+summary_report()
+{
+  static ClientStats total;
+  if (process_stats) {
+    collect_processes();
+    for (int i = 0; i < processes; i++) {
+      total.add(process_stats[i]);
+    }
+    total.errors = errors; // with those of the server
+  } else {
+    publish_stats();
+    total = *client_stats;
+  }
+  double secs = (double)(ink_get_hrtime_internal() - start_time) / HRTIME_SECOND;
+  double rps  = secs > 0 ? total.ops / secs : 0;
+
+  printf("Summary: %" PRIu64 " ops in %.1f sec, %.1f ops/sec, %" PRIu64 " errors, %" PRIu64 " bytes, %" PRIu64 " connections\n",
+         total.ops, secs, rps, total.errors, total.bytes, total.connections);
+  if (tls_mode) {
+    printf("TLS handshakes: %" PRIu64 ", resumed %" PRIu64 "\n", total.tls_handshakes, total.tls_resumed);
+  }
+  printf("%-8s %10s %10s", "msec", "count", "mean");
+  for (double p : report_percentiles) {
+    char name[16];
+    snprintf(name, sizeof(name), "p%g", p);
+    printf(" %10s", name);
+  }
+  printf(" %10s\n", "max");
+  for (int i = 0; i < N_PHASES; i++) {
+    const LatencyHistogram &h = total.phases[i];
+    if (!h.total) {
+      continue;
+    }
+    printf("%-8s %10" PRIu64 " %10.3f", phase_names[i], h.total, (double)h.sum / h.total / HRTIME_MSECOND);
+    for (double p : report_percentiles) {
+      printf(" %10.3f", (double)h.percentile(p) / HRTIME_MSECOND);
+    }
+    printf(" %10.3f\n", (double)h.max / HRTIME_MSECOND);
+  }
+
+  if (!*json_file) {
+    return;
+  }
+  FILE *fp = fopen(json_file, "w");
+  if (!fp) {
+    perror("fopen json file");
+    return;
+  }
+  fprintf(fp, "{\n  \"seconds\": %.3f,\n  \"ops\": %" PRIu64 ",\n  \"rps\": %.1f,\n  \"errors\": %" PRIu64 ",\n", secs, total.ops,
+          rps, total.errors);
+  fprintf(fp, "  \"bytes\": %" PRIu64 ",\n  \"connections\": %" PRIu64 ",\n", total.bytes, total.connections);
+  fprintf(fp, "  \"tls_handshakes\": %" PRIu64 ",\n  \"tls_resumed\": %" PRIu64 ",\n", total.tls_handshakes, total.tls_resumed);
+  fprintf(fp, "  \"latency_ns\": {");
+  const char *sep = "";
+  for (int i = 0; i < N_PHASES; i++) {
+    const LatencyHistogram &h = total.phases[i];
+    fprintf(fp, "%s\n    \"%s\": {\"count\": %" PRIu64 ", \"mean\": %" PRIu64, sep, phase_names[i], h.total,
+            h.total ? h.sum / h.total : 0);
+    for (double p : report_percentiles) {
+      fprintf(fp, ", \"p%g\": %" PRIu64, p, h.percentile(p));
+    }
+    fprintf(fp, ", \"max\": %" PRIu64 "}", h.max);
+    sep = ",";
+  }
+  fprintf(fp, "\n  }\n}\n");
+  fclose(fp);
+}
+
 #define URL_HASH_ENTRIES url_hash_entries
 #define BYTES_PER_ENTRY 3
 #define ENTRIES_PER_BUCKET 16
@@ -3657,6 +5034,16 @@ main(int argc __attribute__((unused)), const char *argv[])
   fd = (FD *)malloc(MAXFDS * sizeof(FD));
   memset(static_cast<void *>(fd), 0, MAXFDS * sizeof(FD));
   process_args(&appVersionInfo, argument_descriptions, n_argument_descriptions, argv);
+  if (h2_streams) {
+    if (post_support) {
+      panic("--h2 does not send request bodies\n");
+    }
+    tls_mode = tls_mode ? tls_mode : 1;
+    hpack_huffman_init();
+  }
+  if (tls_mode) {
+    init_tls();
+  }
 
   if (!drand_seed) {
     // coverity[dont_call]
@@ -3673,10 +5060,12 @@ main(int argc __attribute__((unused)), const char *argv[])
     printf("maximum of %d connections\n", max_fds);
   }
   signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, [](int) { interrupted = 1; });
   start_time = now = ink_get_hrtime_internal();
 
   urls_mode = n_file_arguments || *urls_file;
-  nclients  = client_rate ? 0 : nclients;
+  nclients  = (client_rate || arrival_rate) ? 0 : nclients;
+  processes = urls_mode ? 1 : std::max(processes, 1);
 
   if (!local_host[0]) {
     if (gethostname(local_host, sizeof(local_host)) != 0) {
@@ -3714,11 +5103,18 @@ main(int argc __attribute__((unused)), const char *argv[])
           break;
         }
       }
+      if (processes > 1 && !only_server) {
+        start_processes();
+      }
       bandwidth_test_to_go = bandwidth_test;
       if (!only_server) {
         if (proxy_port) {
           for (int i = 0; i < nclients; i++) {
-            make_bfc_client(proxy_addr, proxy_port);
+            if (h2_streams) {
+              make_h2_client();
+            } else {
+              make_bfc_client(proxy_addr, proxy_port);
+            }
           }
         }
       }
@@ -3763,13 +5159,35 @@ main(int argc __attribute__((unused)), const char *argv[])
     }
   }
 
-  int t       = now / HRTIME_SECOND;
-  int tclient = now / HRTIME_SECOND;
-  int start   = now / HRTIME_SECOND;
+  int t                   = now / HRTIME_SECOND;
+  int tclient             = now / HRTIME_SECOND;
+  int start               = now / HRTIME_SECOND;
+  ink_hrtime arrival_base = ink_get_hrtime_internal();
   while (1) {
     if (poll_loop()) {
       break;
     }
+    // The open loop makes the requests at their time, whether or not those before are done, and
+    // their latency is from that time.
+    if (arrival_rate && proxy_port) {
+      for (ink_hrtime arrival; (arrival = arrival_base + arrivals * HRTIME_SECOND / arrival_rate) <= now; arrivals++) {
+        scheduled_start = arrival;
+        if (h2_streams) {
+          h2_arrival(arrival);
+        } else {
+          make_bfc_client(proxy_addr, proxy_port);
+        }
+      }
+      scheduled_start = 0;
+    }
+    if (process_index >= 0) {
+      publish_stats();
+    } else if (process_stats && reap_processes()) {
+      done();
+    }
+    if (interrupted) {
+      done();
+    }
     int t2 = now / HRTIME_SECOND;
     if (urls_fp && n_defered_urls < MAX_DEFERED_URLS - DEFERED_URLS_BLOCK - 2) {
       if (get_defered_urls(urls_fp)) {
@@ -3777,16 +5195,18 @@ main(int argc __attribute__((unused)), const char *argv[])
         urls_fp = nullptr;
       }
     }
-    if ((!urls_mode || client_rate) && interval && t + interval <= t2) {
+    if ((!urls_mode || client_rate) && interval && t + interval <= t2 && process_index < 0) {
       t = t2;
       interval_report();
     }
     if (t2 != tclient) {
       for (int i = 0; i < client_rate * (t2 - tclient); i++) {
-        if (!urls_mode) {
-          make_bfc_client(proxy_addr, proxy_port);
-        } else {
+        if (urls_mode) {
           undefer_url(true);
+        } else if (h2_streams) {
+          make_h2_client();
+        } else {
+          make_bfc_client(proxy_addr, proxy_port);
         }
       }
       tclient = t2;